@@ -26,6 +26,8 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+#include "common/NioUtils.h"
+
 using namespace filament;
 using namespace filament::math;
 
@@ -246,6 +248,59 @@ Java_com_google_android_filament_MaterialInstance_nSetFloatParameterArray(JNIEnv
     env->ReleaseStringUTFChars(name_, name);
 }
 
+template<typename T>
+static void setParameters(jlong const* nativeMaterialInstances, size_t count, const char* name,
+        void const* values) {
+    T const* v = static_cast<T const*>(values);
+    for (size_t i = 0; i < count; i++) {
+        MaterialInstance* instance = (MaterialInstance*) nativeMaterialInstances[i];
+        instance->setParameter(name, v[i]);
+    }
+}
+
+// Sets the same parameter on many material instances in a single JNI call, `values` contains one
+// element per instance.
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_google_android_filament_MaterialInstance_nSetFloatParameters(JNIEnv *env, jclass,
+        jlongArray nativeMaterialInstances, jstring name_, jint element,
+        jobject values, jint remaining) {
+    constexpr jint sizes[] = { 1, 2, 3, 4, 9, 16 };
+    jsize const count = env->GetArrayLength(nativeMaterialInstances);
+    AutoBuffer nioBuffer(env, values, count * sizes[element]);
+    if (nioBuffer.getSize() > (remaining << nioBuffer.getShift())) {
+        // BufferOverflowException
+        return -1;
+    }
+
+    jlong* instances = env->GetLongArrayElements(nativeMaterialInstances, nullptr);
+    const char* name = env->GetStringUTFChars(name_, 0);
+    void const* data = nioBuffer.getData();
+    switch ((FloatElement) element) {
+        case FLOAT:
+            setParameters<float>(instances, count, name, data);
+            break;
+        case FLOAT2:
+            setParameters<float2>(instances, count, name, data);
+            break;
+        case FLOAT3:
+            setParameters<float3>(instances, count, name, data);
+            break;
+        case FLOAT4:
+            setParameters<float4>(instances, count, name, data);
+            break;
+        case MAT3:
+            setParameters<mat3f>(instances, count, name, data);
+            break;
+        case MAT4:
+            setParameters<mat4f>(instances, count, name, data);
+            break;
+    }
+    env->ReleaseStringUTFChars(name_, name);
+    env->ReleaseLongArrayElements(nativeMaterialInstances, instances, JNI_ABORT);
+    return 0;
+}
+
 // defined in TextureSampler.cpp
 namespace filament::JniUtils {
     TextureSampler from_long(jlong params) noexcept;
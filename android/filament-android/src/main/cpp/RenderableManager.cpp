@@ -327,6 +327,29 @@ Java_com_google_android_filament_RenderableManager_nSetMorphWeights(JNIEnv* env,
     env->ReleaseFloatArrayElements(weights, vec, JNI_ABORT);
 }
 
+// Sets `count` morph weights for each of the given instances, the weights of all instances are
+// packed in `weights`.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_google_android_filament_RenderableManager_nSetMorphWeightsArray(JNIEnv* env, jclass,
+        jlong nativeRenderableManager, jintArray instances_, jobject weights, jint remaining,
+        jint count, jint offset) {
+    RenderableManager *rm = (RenderableManager *) nativeRenderableManager;
+    jsize const instanceCount = env->GetArrayLength(instances_);
+    AutoBuffer nioBuffer(env, weights, instanceCount * count);
+    if (nioBuffer.getSize() > (remaining << nioBuffer.getShift())) {
+        // BufferOverflowException
+        return -1;
+    }
+    float const* data = static_cast<float const*>(nioBuffer.getData());
+    jint* instances = env->GetIntArrayElements(instances_, nullptr);
+    for (jsize j = 0; j < instanceCount; j++) {
+        rm->setMorphWeights((RenderableManager::Instance) instances[j],
+                data + j * count, (size_t) count, (size_t) offset);
+    }
+    env->ReleaseIntArrayElements(instances_, instances, JNI_ABORT);
+    return 0;
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_google_android_filament_RenderableManager_nSetMorphTargetBufferOffsetAt(JNIEnv*,
         jclass, jlong nativeRenderableManager, jint i, int level, jint primitiveIndex,
@@ -352,6 +375,29 @@ Java_com_google_android_filament_RenderableManager_nSetAxisAlignedBoundingBox(JN
                                                                     {ex, ey, ez}});
 }
 
+// Sets the bounding boxes of the given instances, each box is packed as 6 floats: its center
+// followed by its half extent.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_google_android_filament_RenderableManager_nSetAxisAlignedBoundingBoxes(JNIEnv* env,
+        jclass, jlong nativeRenderableManager, jintArray instances_, jobject boxes,
+        jint remaining) {
+    RenderableManager *rm = (RenderableManager *) nativeRenderableManager;
+    jsize const instanceCount = env->GetArrayLength(instances_);
+    AutoBuffer nioBuffer(env, boxes, instanceCount * 6);
+    if (nioBuffer.getSize() > (remaining << nioBuffer.getShift())) {
+        // BufferOverflowException
+        return -1;
+    }
+    auto const* data = static_cast<filament::math::float3 const*>(nioBuffer.getData());
+    jint* instances = env->GetIntArrayElements(instances_, nullptr);
+    for (jsize j = 0; j < instanceCount; j++) {
+        rm->setAxisAlignedBoundingBox((RenderableManager::Instance) instances[j],
+                { data[j * 2], data[j * 2 + 1] });
+    }
+    env->ReleaseIntArrayElements(instances_, instances, JNI_ABORT);
+    return 0;
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_google_android_filament_RenderableManager_nSetLayerMask(JNIEnv*, jclass,
         jlong nativeRenderableManager, jint i, jint select, jint value) {
@@ -23,6 +23,8 @@
 
 #include <math/mat4.h>
 
+#include "common/NioUtils.h"
+
 using namespace utils;
 using namespace filament;
 
@@ -141,6 +143,29 @@ Java_com_google_android_filament_TransformManager_nSetTransform(JNIEnv* env,
     env->ReleaseFloatArrayElements(localTransform_, localTransform, JNI_ABORT);
 }
 
+// Sets the local transforms of `count` instances in a single JNI call, wrapped in a local
+// transform transaction so that the world transforms are only updated once at the end.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_google_android_filament_TransformManager_nSetTransforms(JNIEnv* env,
+        jclass, jlong nativeTransformManager, jintArray instances_,
+        jobject localTransforms, jint remaining, jint count) {
+    TransformManager* tm = (TransformManager*) nativeTransformManager;
+    AutoBuffer nioBuffer(env, localTransforms, count * 16);
+    if (nioBuffer.getSize() > (remaining << nioBuffer.getShift())) {
+        // BufferOverflowException
+        return -1;
+    }
+    auto const* transforms = static_cast<filament::math::mat4f const*>(nioBuffer.getData());
+    jint* instances = env->GetIntArrayElements(instances_, nullptr);
+    tm->openLocalTransformTransaction();
+    for (jint j = 0; j < count; j++) {
+        tm->setTransform((TransformManager::Instance) instances[j], transforms[j]);
+    }
+    tm->commitLocalTransformTransaction();
+    env->ReleaseIntArrayElements(instances_, instances, JNI_ABORT);
+    return 0;
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_google_android_filament_TransformManager_nSetTransformFp64(JNIEnv* env,
         jclass, jlong nativeTransformManager, jint i,
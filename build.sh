@@ -52,6 +52,9 @@ function print_help {
     echo "        For macOS, this builds universal binaries for both Apple silicon and Intel-based Macs."
     echo "    -w"
     echo "        Build Web documents (compiles .md.html files to .html)."
+    echo "    -W"
+    echo "        When building for WebGL, also build the multithreaded variant (filament-mt.js),"
+    echo "        which uses wasm threads for the JobSystem and wasm SIMD."
     echo "    -k sample1,sample2,..."
     echo "        When building for Android, also build select sample APKs."
     echo "        sampleN is an Android sample, e.g., sample-gltf-viewer."
@@ -141,6 +144,7 @@ ISSUE_ANDROID_BUILD=false
 ISSUE_IOS_BUILD=false
 ISSUE_DESKTOP_BUILD=true
 ISSUE_WEBGL_BUILD=false
+ISSUE_WEBGL_MT_BUILD=false
 
 # Default: all
 ABI_ARMEABI_V7A=true
@@ -274,9 +278,39 @@ function build_desktop {
     fi
 }
 
+function build_webgl_mt_with_target {
+    local lc_target=$(echo "$1" | tr '[:upper:]' '[:lower:]')
+
+    echo "Building WebGL multithreaded ${lc_target}..."
+    mkdir -p "out/cmake-webgl-mt-${lc_target}"
+    pushd "out/cmake-webgl-mt-${lc_target}" > /dev/null
+
+    # Apply the emscripten environment within a subshell.
+    (
+    # shellcheck disable=SC1090
+    source "${EMSDK}/emsdk_env.sh"
+    cmake \
+        -G "${BUILD_GENERATOR}" \
+        -DIMPORT_EXECUTABLES_DIR=out \
+        -DCMAKE_TOOLCHAIN_FILE="${EMSDK}/upstream/emscripten/cmake/Modules/Platform/Emscripten.cmake" \
+        -DCMAKE_BUILD_TYPE="$1" \
+        -DWEBGL=1 \
+        -DWEBGL_MT=1 \
+        ${BACKEND_DEBUG_FLAG_OPTION} \
+        ../..
+    ${BUILD_COMMAND} filament-js
+    )
+
+    popd > /dev/null
+}
+
 function build_webgl_with_target {
     local lc_target=$(echo "$1" | tr '[:upper:]' '[:lower:]')
 
+    if [[ "${ISSUE_WEBGL_MT_BUILD}" == "true" ]]; then
+        build_webgl_mt_with_target "$1"
+    fi
+
     echo "Building WebGL ${lc_target}..."
     mkdir -p "out/cmake-webgl-${lc_target}"
     pushd "out/cmake-webgl-${lc_target}" > /dev/null
@@ -317,12 +351,23 @@ function build_webgl_with_target {
                 --build-folder "${PWD}"
         fi
 
+        # The multithreaded variant is published alongside the single-threaded one, which is its
+        # fallback.
+        local mt_folder="../cmake-webgl-mt-${lc_target}/web/filament-js"
+        if [[ "${ISSUE_WEBGL_MT_BUILD}" == "true" ]]; then
+            cp "${mt_folder}/filament-mt.js" "${mt_folder}/filament-mt.wasm" web/filament-js
+        fi
+
         if [[ "${ISSUE_ARCHIVES}" == "true" ]]; then
             echo "Generating out/filament-${lc_target}-web.tgz..."
             pushd web/filament-js > /dev/null
             tar -cvf "../../../filament-${lc_target}-web.tar" filament.js
             tar -rvf "../../../filament-${lc_target}-web.tar" filament.wasm
             tar -rvf "../../../filament-${lc_target}-web.tar" filament.d.ts
+            if [[ "${ISSUE_WEBGL_MT_BUILD}" == "true" ]]; then
+                tar -rvf "../../../filament-${lc_target}-web.tar" filament-mt.js
+                tar -rvf "../../../filament-${lc_target}-web.tar" filament-mt.wasm
+            fi
             popd > /dev/null
             gzip -c "../filament-${lc_target}-web.tar" > "../filament-${lc_target}-web.tgz"
             rm "../filament-${lc_target}-web.tar"
@@ -796,7 +841,7 @@ function check_debug_release_build {
 
 pushd "$(dirname "$0")" > /dev/null
 
-while getopts ":hacCfgijmp:q:uvslwedk:bx:S:" opt; do
+while getopts ":hacCfgijmp:q:uvslwWedk:bx:S:" opt; do
     case ${opt} in
         h)
             print_help
@@ -927,6 +972,9 @@ while getopts ":hacCfgijmp:q:uvslwedk:bx:S:" opt; do
         w)
             ISSUE_WEB_DOCS=true
             ;;
+        W)
+            ISSUE_WEBGL_MT_BUILD=true
+            ;;
         k)
             BUILD_ANDROID_SAMPLES=true
             ANDROID_SAMPLES=$(echo "${OPTARG}" | tr ',' '\n')
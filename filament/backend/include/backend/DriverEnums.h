@@ -420,6 +420,21 @@ enum class BufferObjectBinding : uint8_t {
     SHADER_STORAGE
 };
 
+/**
+ * Arguments of a single indexed draw sourced from a buffer object, see
+ * DriverApi::draw2Indirect(). This layout is shared by OpenGL ES 3.1, Vulkan and Metal, so that
+ * the same buffer (typically written by a compute shader) can be consumed by all backends.
+ */
+struct DrawIndexedIndirectCommand {
+    uint32_t indexCount;        //!< number of indices to draw
+    uint32_t instanceCount;     //!< number of instances, 0 skips the draw
+    uint32_t firstIndex;        //!< first index, in indices (not bytes)
+    int32_t baseVertex;         //!< value added to each index
+    uint32_t baseInstance;      //!< first instance, must be 0 on OpenGL ES
+};
+
+static_assert(sizeof(DrawIndexedIndirectCommand) == 20);
+
 //! Face culling Mode
 enum class CullingMode : uint8_t {
     NONE,               //!< No culling, front and back faces are visible
@@ -693,6 +708,7 @@ enum class TextureUsage : uint16_t {
     BLIT_SRC            = 0x0040,            //!< Texture can be used the source of a blit()
     BLIT_DST            = 0x0080,            //!< Texture can be used the destination of a blit()
     PROTECTED           = 0x0100,            //!< Texture can be used for protected content
+    MEMORYLESS          = 0x0200,            //!< Texture content doesn't outlive a render pass
     DEFAULT             = UPLOADABLE | SAMPLEABLE   //!< Default texture usage
 };
 
@@ -1120,6 +1136,17 @@ struct RenderPassFlags {
     TargetBufferFlags discardEnd;
 };
 
+/**
+ * Size in pixels of the area shaded by each fragment shader invocation, when variable rate shading
+ * is supported. Larger rates lower the cost of shading, at the expense of details.
+ */
+enum class ShadingRate : uint8_t {
+    RATE_1x1,   //!< one invocation per pixel, i.e. regular shading
+    RATE_1x2,   //!< one invocation for 1 pixel wide, 2 pixels high areas
+    RATE_2x1,   //!< one invocation for 2 pixels wide, 1 pixel high areas
+    RATE_2x2,   //!< one invocation for 2x2 pixels areas
+};
+
 /**
  * Parameters of a render pass.
  */
@@ -1157,6 +1184,12 @@ struct RenderPassParams {
 
     static constexpr uint16_t READONLY_DEPTH = 1 << 0;
     static constexpr uint16_t READONLY_STENCIL = 1 << 1;
+
+    /**
+     * Shading rate of all the draw calls of this pass. This is ignored if variable rate shading is
+     * not supported, see DriverApi::isVariableRateShadingSupported().
+     */
+    ShadingRate shadingRate = ShadingRate::RATE_1x1;
 };
 
 struct PolygonOffset {
@@ -83,6 +83,20 @@ public:
          */
         bool disableParallelShaderCompile = false;
 
+        /**
+         * Number of threads, each with its own shared context, used to compile and link
+         * programs in parallel. 0 lets the backend pick a value suitable for the GPU.
+         * Currently only honored by the GL backend.
+         */
+        uint32_t shaderCompilerThreadCount = 0;
+
+        /**
+         * Time budget, in microseconds, spent each frame releasing the GPU memory of destroyed
+         * textures and buffers. 0 releases it immediately.
+         * Currently only honored by the GL backend.
+         */
+        uint32_t deferredDestructionBudgetUs = 0;
+
         /**
          * Disable backend handles use-after-free checks.
          */
@@ -98,6 +112,17 @@ public:
          * Sets the technique for stereoscopic rendering.
          */
         StereoscopicType stereoscopicType = StereoscopicType::NONE;
+
+        /**
+         * Create pipelines asynchronously and skip the draw calls using them until they are ready.
+         * Currently only honored by the Vulkan backend.
+         */
+        bool vulkanAsyncPipelineCreation = false;
+
+        /**
+         * Count the work executed, see Driver::getStatistics(). Only honored by the NOOP backend.
+         */
+        bool noopStatistics = false;
     };
 
     Platform() noexcept;
@@ -26,6 +26,7 @@
 #include <EGL/eglplatform.h>
 
 #include <utils/Invocable.h>
+#include <utils/Mutex.h>
 
 #include <initializer_list>
 #include <utility>
@@ -161,6 +162,8 @@ protected:
     // mEGLConfig is valid only if ext.egl.KHR_no_config_context is false
     EGLConfig mEGLConfig = EGL_NO_CONFIG_KHR;
     Config mContextAttribs;
+    // contexts are created and released concurrently by the compiler threads
+    utils::Mutex mAdditionalContextsLock;
     std::vector<EGLContext> mAdditionalContexts;
 
     // supported extensions detected at runtime
@@ -26,6 +26,9 @@
 
 #include <backend/DriverEnums.h>
 
+#include <utils/Mutex.h>
+
+#include <utility>
 #include <vector>
 
 namespace filament::backend {
@@ -48,6 +51,10 @@ protected:
 
     void terminate() noexcept override;
 
+    bool isExtraContextSupported() const noexcept override;
+    void createContext(bool shared) override;
+    void releaseContext() noexcept override;
+
     SwapChain* createSwapChain(void* nativewindow, uint64_t flags) noexcept override;
     SwapChain* createSwapChain(uint32_t width, uint32_t height, uint64_t flags) noexcept override;
     void destroySwapChain(SwapChain* swapChain) noexcept override;
@@ -60,6 +67,10 @@ private:
     GLXFBConfig* mGLXConfig;
     GLXPbuffer mDummySurface;
     std::vector<GLXPbuffer> mPBuffers;
+    // contexts are created and released concurrently by the compiler threads, each with the
+    // pbuffer it's current on.
+    utils::Mutex mAdditionalContextsLock;
+    std::vector<std::pair<GLXContext, GLXPbuffer>> mAdditionalContexts;
 };
 
 } // namespace filament::backend
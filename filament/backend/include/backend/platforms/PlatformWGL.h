@@ -25,6 +25,8 @@
 #include <backend/platforms/OpenGLPlatform.h>
 #include <backend/DriverEnums.h>
 
+#include <utils/Mutex.h>
+
 #include <vector>
 
 namespace filament::backend {
@@ -49,6 +51,7 @@ protected:
 
     bool isExtraContextSupported() const noexcept override;
     void createContext(bool shared) override;
+    void releaseContext() noexcept override;
 
     SwapChain* createSwapChain(void* nativewindow, uint64_t flags) noexcept override;
     SwapChain* createSwapChain(uint32_t width, uint32_t height, uint64_t flags) noexcept override;
@@ -61,6 +64,8 @@ protected:
     HWND mHWnd = NULL;
     HDC mWhdc = NULL;
     PIXELFORMATDESCRIPTOR mPfd = {};
+    // contexts are created and released concurrently by the compiler threads
+    utils::Mutex mAdditionalContextsLock;
     std::vector<HGLRC> mAdditionalContexts;
     std::vector<int> mAttribs;
 };
@@ -147,6 +147,21 @@ public:
          * presentation. Default is true.
          */
         bool transitionSwapChainImageLayoutForPresent = true;
+
+        /**
+         * Whether render passes without subpasses should use VK_KHR_dynamic_rendering, instead of
+         * VkRenderPass and VkFramebuffer objects, when the device supports it. This avoids
+         * creating these objects when the render targets change, e.g. with dynamic resolution.
+         * Default is false.
+         */
+        bool useDynamicRendering = false;
+
+        /**
+         * Whether texture and buffer uploads should be recorded on a dedicated transfer queue,
+         * when the device has a queue family that only supports transfers, so that they can
+         * overlap with rendering. This is ignored with a shared context. Default is false.
+         */
+        bool useTransferQueue = false;
     };
 
     /**
@@ -267,6 +282,17 @@ public:
      */
     VkQueue getGraphicsQueue() const noexcept;
 
+    /**
+     * @return The family index of the transfer queue used for uploads, or 0xFFFFFFFF if uploads
+     *         use the graphics queue (see Customization::useTransferQueue).
+     */
+    uint32_t getTransferQueueFamilyIndex() const noexcept;
+
+    /**
+     * @return The transfer queue used for uploads, or VK_NULL_HANDLE if there is none.
+     */
+    VkQueue getTransferQueue() const noexcept;
+
 private:
     static ExtensionSet getSwapchainInstanceExtensions();
 
@@ -30,7 +30,9 @@ public:
     //      This must be at least 2*requiredSize to avoid blocking on flush, however
     //      because sometimes the display can get ahead of the render() thread, it's good
     //      to set it to 3*requiredSize to avoid blocking the render thread (usually the UI thread).
-    explicit CircularBuffer(size_t bufferSize);
+    // hugePages: ask the system to back the buffer with transparent huge pages, this is only
+    //      a hint and is ignored where not supported.
+    explicit CircularBuffer(size_t bufferSize, bool hugePages = false);
 
     // can't be moved or copy-constructed
     CircularBuffer(CircularBuffer const& rhs) = delete;
@@ -72,7 +74,7 @@ public:
     Range getBuffer() noexcept;
 
 private:
-    void* alloc(size_t size) noexcept;
+    void* alloc(size_t size, bool hugePages) noexcept;
     void dealloc() noexcept;
 
     // pointer to the beginning of the circular buffer (constant)
@@ -19,9 +19,10 @@
 
 #include "private/backend/CircularBuffer.h"
 
-#include <utils/Condition.h>
-#include <utils/Mutex.h>
+#include <utils/Futex.h>
+#include <utils/SpscQueue.h>
 
+#include <atomic>
 #include <vector>
 
 #include <stddef.h>
@@ -30,7 +31,11 @@
 namespace filament::backend {
 
 /*
- * A producer-consumer command queue that uses a CircularBuffer as main storage
+ * A producer-consumer command queue that uses a CircularBuffer as main storage.
+ *
+ * The producer (the thread calling flush()) and the consumer (the thread calling
+ * waitForCommands()) communicate through a lock-free queue, and only sleep on a futex when the
+ * consumer runs out of commands or the producer runs out of space.
  */
 class CommandBufferQueue {
     struct Range {
@@ -38,25 +43,51 @@ class CommandBufferQueue {
         void* end;
     };
 
+    // maximum number of flushed buffers waiting to be executed before flush() blocks
+    static constexpr size_t MAX_PENDING_BUFFERS = 1024;
+
     const size_t mRequiredSize;
 
     CircularBuffer mCircularBuffer;
 
+    mutable utils::SpscQueue<Range> mCommandBuffersToExecute;
+
+    // incremented when commands are flushed, or the queue is resumed or exited; the consumer
+    // sleeps on it
+    mutable utils::Futex mProducerEvents;
+
+    // incremented when a buffer is released; the producer sleeps on it when it's out of space
+    utils::Futex mConsumerEvents;
+
     // space available in the circular buffer
+    std::atomic<size_t> mFreeSpace;
+    std::atomic<uint32_t> mExitRequested = 0;
+    std::atomic<bool> mPaused;
 
-    mutable utils::Mutex mLock;
-    mutable utils::Condition mCondition;
-    mutable std::vector<Range> mCommandBuffersToExecute;
-    size_t mFreeSpace = 0;
+    // these are only accessed by the producer
     size_t mHighWatermark = 0;
-    uint32_t mExitRequested = 0;
-    bool mPaused = false;
+    size_t mFlushedSize = 0;
+    uint32_t mFlushCount = 0;
+    uint32_t mWaitCount = 0;
+    uint64_t mWaitDuration = 0;
 
     static constexpr uint32_t EXIT_REQUESTED = 0x31415926;
 
+    template<typename Predicate>
+    void waitForConsumer(Predicate predicate) noexcept;
+
 public:
+    struct Stats {
+        size_t flushedSize;     // bytes of commands flushed
+        uint32_t flushCount;    // number of non-empty flush()
+        uint32_t waitCount;     // number of flush() that blocked waiting for the consumer
+        uint64_t waitDuration;  // time spent blocked in flush(), in ns
+    };
+
     // requiredSize: guaranteed available space after flush()
-    CommandBufferQueue(size_t requiredSize, size_t bufferSize, bool paused);
+    // hugePages: back the circular buffer with huge pages if possible
+    CommandBufferQueue(size_t requiredSize, size_t bufferSize, bool paused,
+            bool hugePages = false);
     ~CommandBufferQueue();
 
     CircularBuffer& getCircularBuffer() noexcept { return mCircularBuffer; }
@@ -66,6 +97,9 @@ public:
 
     size_t getHighWatermark() const noexcept { return mHighWatermark; }
 
+    // returns the statistics accumulated since the last call, this must be called by the producer
+    Stats getStats() noexcept;
+
     // wait for commands to be available and returns an array containing these commands
     std::vector<Range> waitForCommands() const;
 
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_BACKEND_PRIVATE_COMMANDCAPTURE_H
+#define TNT_FILAMENT_BACKEND_PRIVATE_COMMANDCAPTURE_H
+
+#include <backend/BufferDescriptor.h>
+#include <backend/DriverEnums.h>
+#include <backend/Handle.h>
+#include <backend/PipelineState.h>
+#include <backend/PixelBufferDescriptor.h>
+#include <backend/Program.h>
+#include <backend/TargetBufferInfo.h>
+
+#include <utils/CString.h>
+#include <utils/compiler.h>
+#include <utils/Invocable.h>
+
+#include <type_traits>
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace filament::backend {
+
+/*
+ * CommandCapture writes the commands issued to a CommandStream into a file, so they can be
+ * played back later by CommandReplay, without the application that issued them.
+ *
+ * The file is a header (CommandCapture::Header) followed by one record per command: the
+ * Command, the size of its parameters and the parameters themselves. Handles are written as
+ * their id, the content of BufferDescriptors and Programs is copied, and the pointers (native
+ * windows, callbacks, user data) are dropped since they only mean something to the process
+ * that issued them.
+ *
+ * Synchronous commands and CommandStream::queueCommand() are not captured.
+ */
+class CommandCapture {
+public:
+    // one entry per asynchronous command of DriverAPI.inc, in the same order
+    enum class Command : uint32_t {
+#define DECL_DRIVER_API(methodName, paramsDecl, params) methodName,
+#define DECL_DRIVER_API_RETURN(RetType, methodName, paramsDecl, params) methodName,
+#define DECL_DRIVER_API_SYNCHRONOUS(RetType, methodName, paramsDecl, params)
+#include "private/backend/DriverAPI.inc"
+        COUNT
+    };
+
+    struct Header {
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        // guards against replaying a capture made with a different DriverAPI.inc
+        uint32_t commandCount = uint32_t(Command::COUNT);
+        uint32_t reserved = 0;
+    };
+
+    struct RecordHeader {
+        Command command;
+        uint32_t size;      // size of the parameters following this header, in bytes
+    };
+
+    static constexpr uint32_t MAGIC = 0x50414346;    // 'FCAP'
+    static constexpr uint32_t VERSION = 1;
+
+    // BufferDescriptor payloads are aligned to this many bytes from the start of the file
+    static constexpr size_t PAYLOAD_ALIGNMENT = 16;
+
+    // Opens `path` for writing and captures the commands until `frameCount` frames have ended.
+    CommandCapture(const char* path, uint32_t frameCount) noexcept;
+    ~CommandCapture() noexcept;
+
+    CommandCapture(CommandCapture const&) = delete;
+    CommandCapture& operator=(CommandCapture const&) = delete;
+
+    // false once the requested frames are captured, or if the file couldn't be opened
+    bool isCapturing() const noexcept { return mFile != nullptr; }
+
+    // called by CommandStream on the thread that issues the commands
+    template<typename... ARGS>
+    void record(Command command, ARGS const&... args) {
+        if (UTILS_LIKELY(mFile)) {
+            mRecord.clear();
+            (write(args), ...);
+            flush(command);
+        }
+    }
+
+private:
+    void flush(Command command) noexcept;
+    void writeBytes(void const* data, size_t size);
+    void writeString(const char* s, size_t length);
+
+    template<typename T, typename = std::enable_if_t<
+            std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>>>
+    void write(T const& value) {
+        writeBytes(&value, sizeof(T));
+    }
+
+    template<typename T>
+    void write(Handle<T> const& handle) {
+        write(handle.getId());
+    }
+
+    // pointers are meaningless in another process, the commands are replayed without them
+    template<typename T>
+    void write(T* const&) { }
+    void write(utils::Invocable<void()> const&) { }
+    void write(FrameScheduledCallback const&) { }
+
+    void write(const char* s);
+    void write(utils::CString const& s);
+    void write(BufferDescriptor const& data);
+    void write(PixelBufferDescriptor const& data);
+    void write(PipelineState const& state);
+    void write(TargetBufferInfo const& info);
+    void write(MRT const& mrt);
+    void write(Program const& program);
+
+    FILE* mFile = nullptr;
+    uint64_t mFileSize = 0;
+    uint32_t mFramesLeft;
+    std::vector<uint8_t> mRecord;
+};
+
+} // namespace filament::backend
+
+#endif // TNT_FILAMENT_BACKEND_PRIVATE_COMMANDCAPTURE_H
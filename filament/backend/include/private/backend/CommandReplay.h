@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_BACKEND_PRIVATE_COMMANDREPLAY_H
+#define TNT_FILAMENT_BACKEND_PRIVATE_COMMANDREPLAY_H
+
+#include "private/backend/CommandCapture.h"
+#include "private/backend/CommandStream.h"
+
+#include <backend/Handle.h>
+
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament::backend {
+
+/*
+ * CommandReplay plays back a file written by CommandCapture into a CommandStream.
+ *
+ * The commands preceding the last captured frame are replayed once by replaySetup(), which
+ * recreates the resources that frame uses, then the frame itself can be replayed as many times
+ * as needed by replayFrame(), e.g. to profile it on another backend or device.
+ *
+ * What belongs to the captured process is replaced or skipped: the SwapChains become headless,
+ * the imported textures become regular textures, the external images and streams and the frame
+ * callbacks are ignored.
+ */
+class CommandReplay {
+public:
+    struct Config {
+        // size of the headless SwapChains that replace the captured ones
+        uint32_t width = 1920;
+        uint32_t height = 1080;
+        // the commands are flushed when they use this many bytes, this must be smaller than
+        // the required size of the CommandBufferQueue
+        size_t flushSize = 512 * 1024;
+    };
+
+    // flushes the CommandStream and executes its commands
+    using FlushCallback = std::function<void()>;
+
+    explicit CommandReplay(Config const& config) noexcept;
+    ~CommandReplay() noexcept;
+
+    CommandReplay(CommandReplay const&) = delete;
+    CommandReplay& operator=(CommandReplay const&) = delete;
+
+    // Loads a capture, returns false if it can't be read or was made by another version.
+    bool load(const char* path);
+
+    // number of captured frames
+    size_t getFrameCount() const noexcept { return mFrameCount; }
+
+    // Replays the commands preceding the last captured frame, must be called once first.
+    void replaySetup(CommandStream& stream, FlushCallback const& flush);
+
+    // Replays the last captured frame. The resources it destroys are kept alive if they were
+    // created before it, so it can be replayed again.
+    void replayFrame(CommandStream& stream, FlushCallback const& flush);
+
+private:
+    using Command = CommandCapture::Command;
+    using HandleId = HandleBase::HandleId;
+
+    struct Record {
+        Command command;
+        uint32_t size;
+        uint8_t* data;
+    };
+
+    void replay(Record const& record, CommandStream& stream, bool frame);
+
+    Config const mConfig;
+    uint8_t* mData = nullptr;
+    std::vector<Record> mRecords;
+    size_t mFrameBegin = 0;
+    size_t mFrameEnd = 0;
+    size_t mFrameCount = 0;
+    // maps the captured handles ids to the replayed ones
+    std::unordered_map<HandleId, HandleId> mHandles;
+    std::unordered_map<HandleId, HandleId> mSetupHandles;
+    // the captured ids of the handles created by the current replayFrame()
+    std::unordered_set<HandleId> mFrameHandles;
+};
+
+} // namespace filament::backend
+
+#endif // TNT_FILAMENT_BACKEND_PRIVATE_COMMANDREPLAY_H
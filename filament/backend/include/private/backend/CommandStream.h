@@ -18,6 +18,7 @@
 #define TNT_FILAMENT_BACKEND_PRIVATE_COMMANDSTREAM_H
 
 #include "private/backend/CircularBuffer.h"
+#include "private/backend/CommandCapture.h"
 #include "private/backend/Dispatcher.h"
 #include "private/backend/Driver.h"
 
@@ -33,13 +34,17 @@
 
 #include <utils/compiler.h>
 #include <utils/debug.h>
+#include <utils/Mutex.h>
 #include <utils/ThreadUtils.h>
 
+#include <atomic>
 #include <cstddef>
 #include <functional>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #ifndef NDEBUG
 #include <thread>
@@ -79,6 +84,9 @@ public:
         return reinterpret_cast<CommandBase*>(reinterpret_cast<intptr_t>(this) + next);
     }
 
+    // identifies the type of this command
+    Execute getExecute() const noexcept { return mExecute; }
+
     inline ~CommandBase() noexcept = default;
 
 private:
@@ -208,6 +216,13 @@ class CommandStream {
     };
 
 public:
+    struct CommandStats {
+        const char* name;       // DriverApi method, or "other" for queueCommand() and allocate()
+        uint32_t count;         // number of commands executed
+        uint32_t bytes;         // space they used in the CommandStream
+        uint64_t duration;      // time spent executing them on the driver thread, in ns
+    };
+
     CommandStream(Driver& driver, CircularBuffer& buffer) noexcept;
 
     CommandStream(CommandStream const& rhs) noexcept = delete;
@@ -219,6 +234,9 @@ public:
 #define DECL_DRIVER_API(methodName, paramsDecl, params)                                         \
     inline void methodName(paramsDecl) {                                                        \
         DEBUG_COMMAND_BEGIN(methodName, false, params);                                         \
+        if (UTILS_UNLIKELY(mCapture)) {                                                         \
+            mCapture->record(CommandCapture::Command::methodName, params);                      \
+        }                                                                                       \
         using Cmd = COMMAND_TYPE(methodName);                                                   \
         void* const p = allocateCommand(CommandBase::align(sizeof(Cmd)));                       \
         new(p) Cmd(mDispatcher.methodName##_, APPLY(std::move, params));                        \
@@ -238,6 +256,9 @@ public:
     inline RetType methodName(paramsDecl) {                                                     \
         DEBUG_COMMAND_BEGIN(methodName, false, params);                                         \
         RetType result = mDriver.methodName##S();                                               \
+        if (UTILS_UNLIKELY(mCapture)) {                                                         \
+            mCapture->record(CommandCapture::Command::methodName, result, params);              \
+        }                                                                                       \
         using Cmd = COMMAND_TYPE(methodName##R);                                                \
         void* const p = allocateCommand(CommandBase::align(sizeof(Cmd)));                       \
         new(p) Cmd(mDispatcher.methodName##_, RetType(result), APPLY(std::move, params));       \
@@ -259,12 +280,45 @@ public:
 
     void execute(void* buffer);
 
+    /*
+     * Records the asynchronous commands issued from now on into `capture`, which must outlive
+     * this CommandStream or be reset to nullptr first. Must be called from the thread that
+     * issues the commands.
+     */
+    void setCapture(CommandCapture* capture) noexcept { mCapture = capture; }
+
+    /*
+     * When enabled, execute() records the count, size and duration of each type of command,
+     * which slows down the driver thread noticeably. Can be called from any thread.
+     */
+    void setProfilingEnabled(bool enabled) noexcept {
+        mProfilingEnabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool isProfilingEnabled() const noexcept {
+        return mProfilingEnabled.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * Returns the statistics of the commands executed since the last call, one entry per type
+     * of command, sorted by decreasing duration. Can be called from any thread.
+     */
+    std::vector<CommandStats> getProfilingStats();
+
     /*
      * queueCommand() allows to queue a lambda function as a command.
      * This is much less efficient than using the Driver* API.
      */
     void queueCommand(std::function<void()> command);
 
+    /*
+     * Moves the commands recorded in `buffer` by another CommandStream at the end of this one,
+     * which allows several threads to record commands concurrently, each in its own buffer.
+     * The commands are relocated by this call, so they must not reference memory returned by
+     * allocate(), and must not be executed from `buffer`.
+     */
+    void append(CircularBuffer& buffer) noexcept;
+
     /*
      * Allocates memory associated to the current CommandStreamBuffer.
      * This memory will be automatically freed after this command buffer is processed.
@@ -291,6 +345,7 @@ private:
     Driver& UTILS_RESTRICT mDriver;
     CircularBuffer& UTILS_RESTRICT mCurrentBuffer;
     Dispatcher mDispatcher;
+    CommandCapture* mCapture = nullptr;
 
 #ifndef NDEBUG
     // just for debugging...
@@ -298,6 +353,16 @@ private:
 #endif
 
     bool mUsePerformanceCounter = false;
+
+    void executeProfiled(void* buffer) noexcept;
+
+    std::atomic_bool mProfilingEnabled{ false };
+    // only accessed from the driver thread
+    std::unordered_map<Dispatcher::Execute, uint32_t> mCommandTypes;
+    std::vector<CommandStats> mExecutedStats;
+    // accumulates mExecutedStats until getProfilingStats() is called
+    utils::Mutex mProfilingLock;
+    std::vector<CommandStats> mProfilingStats;
 };
 
 void* CommandStream::allocate(size_t size, size_t alignment) noexcept {
@@ -78,6 +78,24 @@ public:
     // the default implementation simply calls fn
     virtual void execute(std::function<void(void)> const& fn);
 
+    // Work executed by the driver since its creation, see Engine::DriverStats.
+    struct Statistics {
+        uint64_t frameCount = 0;
+        uint64_t renderPassCount = 0;
+        uint64_t drawCount = 0;
+        uint64_t pipelineBindCount = 0;
+        uint64_t redundantPipelineBindCount = 0;
+        uint64_t primitiveBindCount = 0;
+        uint64_t redundantPrimitiveBindCount = 0;
+        uint64_t bufferUploadCount = 0;
+        uint64_t bufferUploadSize = 0;
+        uint64_t textureUploadCount = 0;
+        uint64_t textureUploadSize = 0;
+    };
+
+    // called from the main thread, the default implementation doesn't collect anything
+    virtual Statistics getStatistics() const noexcept;
+
     // This is called on debug build, or when enabled manually on the backend thread side.
     virtual void debugCommandBegin(CommandStream* cmds,
             bool synchronous, const char* methodName) noexcept = 0;
@@ -29,6 +29,8 @@
 
 #include <tsl/robin_map.h>
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <exception>
 #include <type_traits>
@@ -216,6 +218,25 @@ public:
         }
     }
 
+    struct PoolStatistics {
+        size_t size;            // size of the objects in this pool
+        uint32_t count;         // number of handles the pool can hold
+        uint32_t live;          // number of handles currently allocated
+        uint32_t highWatermark; // maximum number of handles allocated at once
+    };
+
+    /*
+     * Returns the usage of each pool, from the smallest to the largest objects. Handles that
+     * overflowed to the system heap are not counted.
+     */
+    std::array<PoolStatistics, 3> getStatistics() const noexcept {
+        Allocator const& allocator = mHandleArena.getAllocator();
+        return {
+                allocator.getStatistics(0, P0),
+                allocator.getStatistics(1, P1),
+                allocator.getStatistics(2, P2) };
+    }
+
     utils::CString getHandleTag(HandleBase::HandleId id) const noexcept {
         if (!isPoolHandle(id)) {
             return "(no tag)";
@@ -243,13 +264,39 @@ private:
         struct Node { uint8_t age; };
         // Note: using the `extra` parameter of PoolAllocator<>, even with a 1-byte structure,
         // generally increases all pool allocations by 8-bytes because of alignment restrictions.
+        // Handles are allocated on the user thread and freed on the driver thread, the pools
+        // use a lock-free list so that neither has to wait for the other.
         template<size_t SIZE>
-        using Pool = utils::PoolAllocator<SIZE, MIN_ALIGNMENT, sizeof(Node)>;
+        using Pool = utils::PoolAllocator<SIZE, MIN_ALIGNMENT, sizeof(Node),
+                utils::AtomicFreeList>;
+        struct Counters {
+            std::atomic<uint32_t> live{};
+            std::atomic<uint32_t> highWatermark{};
+        };
+        UTILS_UNUSED_IN_RELEASE const utils::AreaPolicy::HeapArea& mArea;
+        bool mUseAfterFreeCheckDisabled;
+        // number of handles in each pool, this must be initialized before the pools
+        size_t const mCount;
         Pool<P0> mPool0;
         Pool<P1> mPool1;
         Pool<P2> mPool2;
-        UTILS_UNUSED_IN_RELEASE const utils::AreaPolicy::HeapArea& mArea;
-        bool mUseAfterFreeCheckDisabled;
+        Counters mCounters[3];
+
+        static size_t initializeArea(const utils::AreaPolicy::HeapArea& area);
+
+        inline void onAlloc(size_t index) noexcept {
+            Counters& counters = mCounters[index];
+            uint32_t const live = counters.live.fetch_add(1, std::memory_order_relaxed) + 1;
+            uint32_t highWatermark = counters.highWatermark.load(std::memory_order_relaxed);
+            while (live > highWatermark && !counters.highWatermark.compare_exchange_weak(
+                    highWatermark, live, std::memory_order_relaxed)) {
+            }
+        }
+
+        inline void onFree(size_t index) noexcept {
+            mCounters[index].live.fetch_sub(1, std::memory_order_relaxed);
+        }
+
     public:
         explicit Allocator(const utils::AreaPolicy::HeapArea& area, bool disableUseAfterFreeCheck);
 
@@ -258,10 +305,12 @@ private:
         // this is in fact always called with a constexpr size argument
         [[nodiscard]] inline void* alloc(size_t size, size_t, size_t, uint8_t* outAge) noexcept {
             void* p = nullptr;
-            if      (size <= mPool0.getSize()) p = mPool0.alloc(size);
-            else if (size <= mPool1.getSize()) p = mPool1.alloc(size);
-            else if (size <= mPool2.getSize()) p = mPool2.alloc(size);
+            size_t index = 0;
+            if      (size <= mPool0.getSize()) { p = mPool0.alloc(size); index = 0; }
+            else if (size <= mPool1.getSize()) { p = mPool1.alloc(size); index = 1; }
+            else if (size <= mPool2.getSize()) { p = mPool2.alloc(size); index = 2; }
             if (UTILS_LIKELY(p)) {
+                onAlloc(index);
                 Node const* const pNode = static_cast<Node const*>(p);
                 // we are guaranteed to have at least sizeof<Node> bytes of extra storage before
                 // the allocation address.
@@ -283,22 +332,28 @@ private:
             }
             expectedAge = (expectedAge + 1) & 0xF; // fixme
 
-            if (size <= mPool0.getSize()) { mPool0.free(p); return; }
-            if (size <= mPool1.getSize()) { mPool1.free(p); return; }
-            if (size <= mPool2.getSize()) { mPool2.free(p); return; }
+            if (size <= mPool0.getSize()) { mPool0.free(p); onFree(0); return; }
+            if (size <= mPool1.getSize()) { mPool1.free(p); onFree(1); return; }
+            if (size <= mPool2.getSize()) { mPool2.free(p); onFree(2); return; }
+        }
+
+        PoolStatistics getStatistics(size_t index, size_t size) const noexcept {
+            Counters const& counters = mCounters[index];
+            return { size, uint32_t(mCount),
+                    counters.live.load(std::memory_order_relaxed),
+                    counters.highWatermark.load(std::memory_order_relaxed) };
         }
     };
 
-// FIXME: We should be using a Spinlock here, at least on platforms where mutexes are not
-//        efficient (i.e. non-Linux). However, we've seen some hangs on that spinlock, which
-//        we don't understand well (b/308029108).
+// The pools are lock-free, but the debug tracking policy isn't thread-safe, so in debug
+// builds the arena is still synchronized.
 #ifndef NDEBUG
     using HandleArena = utils::Arena<Allocator,
             utils::LockingPolicy::Mutex,
             utils::TrackingPolicy::DebugAndHighWatermark>;
 #else
     using HandleArena = utils::Arena<Allocator,
-            utils::LockingPolicy::Mutex>;
+            utils::LockingPolicy::NoLock>;
 #endif
 
     // allocateHandle()/deallocateHandle() selects the pool to use at compile-time based on the
@@ -317,7 +372,7 @@ private:
     }
 
     // allocateHandleInPool()/deallocateHandleFromPool() is NOT inlined, which will cause three
-    // versions to be generated, one for each pool. Because the arena is synchronized,
+    // versions to be generated, one for each pool. Because the pools are lock-free,
     // the code generated is not trivial (even if it's not insane either).
     template<size_t SIZE>
     UTILS_NOINLINE
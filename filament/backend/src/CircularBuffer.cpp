@@ -44,9 +44,9 @@ namespace filament::backend {
 
 size_t CircularBuffer::sPageSize = arch::getPageSize();
 
-CircularBuffer::CircularBuffer(size_t size)
+CircularBuffer::CircularBuffer(size_t size, bool hugePages)
     : mSize(size) {
-    mData = alloc(size);
+    mData = alloc(size, hugePages);
     mTail = mData;
     mHead = mData;
 }
@@ -63,9 +63,23 @@ CircularBuffer::~CircularBuffer() noexcept {
 //
 // If the system does not support mmap, emulate soft circular buffer with two buffers next
 // to each others and a special case in circularize()
+//
+// Huge pages are only requested with madvise(), because the double mapping needs a shared
+// memory region, which can't use MAP_HUGETLB. Whether they're used for shared memory depends on
+// the system's configuration; they are for the 'soft' buffer whenever transparent huge pages
+// are enabled.
+
+static void adviseHugePages(void* addr, size_t size, bool hugePages) noexcept {
+#if HAS_MMAP && defined(MADV_HUGEPAGE)
+    if (hugePages) {
+        // this is only a hint, failure isn't an error
+        madvise(addr, size, MADV_HUGEPAGE);
+    }
+#endif
+}
 
 UTILS_NOINLINE
-void* CircularBuffer::alloc(size_t size) noexcept {
+void* CircularBuffer::alloc(size_t size, bool hugePages) noexcept {
 #if HAS_MMAP
     void* data = nullptr;
     void* vaddr = MAP_FAILED;
@@ -82,6 +96,7 @@ void* CircularBuffer::alloc(size_t size) noexcept {
             // map the circular buffer once...
             vaddr = mmap(reserve_vaddr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
             if (vaddr != MAP_FAILED) {
+                adviseHugePages(vaddr, size, hugePages);
                 // populate the address space with pages (because this is a circular buffer,
                 // all the pages will be allocated eventually, might as well do it now)
                 memset(vaddr, 0, size);
@@ -129,12 +144,15 @@ void* CircularBuffer::alloc(size_t size) noexcept {
 
         slog.w << "Using 'soft' CircularBuffer (" << (size * 2 / 1024) << " KiB)" << io::endl;
 
+        adviseHugePages(data, size * 2, hugePages);
+
         // guard page at the end
         void* guard = (void*)(uintptr_t(data) + size * 2);
         mprotect(guard, BLOCK_SIZE, PROT_NONE);
     }
     return data;
 #else
+    (void)hugePages;
     return ::malloc(2 * size);
 #endif
 }
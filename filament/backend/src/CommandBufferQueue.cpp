@@ -19,15 +19,16 @@
 #include "private/backend/CommandStream.h"
 
 #include <utils/compiler.h>
+#include <utils/Futex.h>
 #include <utils/Log.h>
-#include <utils/Mutex.h>
 #include <utils/ostream.h>
 #include <utils/Panic.h>
 #include <utils/Systrace.h>
 #include <utils/debug.h>
 
 #include <algorithm>
-#include <mutex>
+#include <atomic>
+#include <chrono>
 #include <iterator>
 #include <utility>
 #include <vector>
@@ -39,9 +40,11 @@ using namespace utils;
 
 namespace filament::backend {
 
-CommandBufferQueue::CommandBufferQueue(size_t requiredSize, size_t bufferSize, bool paused)
+CommandBufferQueue::CommandBufferQueue(size_t requiredSize, size_t bufferSize, bool paused,
+        bool hugePages)
         : mRequiredSize((requiredSize + (CircularBuffer::getBlockSize() - 1u)) & ~(CircularBuffer::getBlockSize() -1u)),
-          mCircularBuffer(bufferSize),
+          mCircularBuffer(bufferSize, hugePages),
+          mCommandBuffersToExecute(MAX_PENDING_BUFFERS),
           mFreeSpace(mCircularBuffer.size()),
           mPaused(paused) {
     assert_invariant(mCircularBuffer.size() > requiredSize);
@@ -52,28 +55,24 @@ CommandBufferQueue::~CommandBufferQueue() {
 }
 
 void CommandBufferQueue::requestExit() {
-    std::lock_guard<utils::Mutex> const lock(mLock);
     mExitRequested = EXIT_REQUESTED;
-    mCondition.notify_one();
+    mProducerEvents.fetch_add(1);
+    mProducerEvents.notify_one();
 }
 
 bool CommandBufferQueue::isPaused() const noexcept {
-    std::lock_guard<utils::Mutex> const lock(mLock);
     return mPaused;
 }
 
 void CommandBufferQueue::setPaused(bool paused) {
-    std::lock_guard<utils::Mutex> const lock(mLock);
-    if (paused) {
-        mPaused = true;
-    } else {
-        mPaused = false;
-        mCondition.notify_one();
+    mPaused = paused;
+    if (!paused) {
+        mProducerEvents.fetch_add(1);
+        mProducerEvents.notify_one();
     }
 }
 
 bool CommandBufferQueue::isExitRequested() const {
-    std::lock_guard<utils::Mutex> const lock(mLock);
     return (bool)mExitRequested;
 }
 
@@ -101,29 +100,43 @@ void CommandBufferQueue::flush() noexcept {
     size_t const used = std::distance(
             static_cast<char const*>(begin), static_cast<char const*>(end));
 
-
-    std::unique_lock<utils::Mutex> lock(mLock);
+    // the consumer only ever adds space, so this can only be an underestimate
+    size_t const freeSpace = mFreeSpace.load(std::memory_order_acquire);
 
     // circular buffer is too small, we corrupted the stream
-    FILAMENT_CHECK_POSTCONDITION(used <= mFreeSpace) <<
+    FILAMENT_CHECK_POSTCONDITION(used <= freeSpace) <<
             "Backend CommandStream overflow. Commands are corrupted and unrecoverable.\n"
             "Please increase minCommandBufferSizeMB inside the Config passed to Engine::create.\n"
             "Space used at this time: " << used <<
-            " bytes, overflow: " << used - mFreeSpace << " bytes";
+            " bytes, overflow: " << used - freeSpace << " bytes";
+
+    mFreeSpace.fetch_sub(used, std::memory_order_relaxed);
+    mFlushedSize += used;
+    mFlushCount++;
+
+    // this only blocks if the consumer is MAX_PENDING_BUFFERS flushes behind
+    if (UTILS_UNLIKELY(!mCommandBuffersToExecute.push({ begin, end }))) {
+        SYSTRACE_NAME("waiting: CircularBuffer::flush() pending buffers");
 
-    mFreeSpace -= used;
-    mCommandBuffersToExecute.push_back({ begin, end });
-    mCondition.notify_one();
+        FILAMENT_CHECK_POSTCONDITION(!mPaused) <<
+                "Too many CommandStream flushes are pending, but since the rendering thread is "
+                "paused, they cannot execute and we will deadlock. Instead, abort.";
+
+        waitForConsumer([this, begin = begin, end = end]() {
+            return mCommandBuffersToExecute.push({ begin, end });
+        });
+    }
+    mProducerEvents.fetch_add(1);
+    mProducerEvents.notify_one();
 
     // wait until there is enough space in the buffer
-    if (UTILS_UNLIKELY(mFreeSpace < requiredSize)) {
+    if (UTILS_UNLIKELY(mFreeSpace.load(std::memory_order_acquire) < requiredSize)) {
 
 #ifndef NDEBUG
-        size_t const totalUsed = circularBuffer.size() - mFreeSpace;
+        size_t const totalUsed = circularBuffer.size() - mFreeSpace.load();
         slog.d << "CommandStream used too much space (will block): "
-                << "needed space " << requiredSize << " out of " << mFreeSpace
+                << "needed space " << requiredSize << " out of " << mFreeSpace.load()
                 << ", totalUsed=" << totalUsed << ", current=" << used
-                << ", queue size=" << mCommandBuffersToExecute.size() << " buffers"
                 << io::endl;
 
         mHighWatermark = std::max(mHighWatermark, totalUsed);
@@ -135,30 +148,62 @@ void CommandBufferQueue::flush() noexcept {
                 "CommandStream is full, but since the rendering thread is paused, "
                 "the buffer cannot flush and we will deadlock. Instead, abort.";
 
-        mCondition.wait(lock, [this, requiredSize]() -> bool {
+        auto const start = std::chrono::steady_clock::now();
+        waitForConsumer([this, requiredSize]() -> bool {
             // TODO: on macOS, we need to call pumpEvents from time to time
-            return mFreeSpace >= requiredSize;
+            return mFreeSpace.load(std::memory_order_acquire) >= requiredSize;
         });
+        mWaitDuration += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        mWaitCount++;
+    }
+}
+
+template<typename Predicate>
+void CommandBufferQueue::waitForConsumer(Predicate predicate) noexcept {
+    while (true) {
+        // read the event count first, so that we can't miss a release happening after the test
+        uint32_t const events = mConsumerEvents.load();
+        if (predicate()) {
+            return;
+        }
+        mConsumerEvents.wait(events);
     }
 }
 
+CommandBufferQueue::Stats CommandBufferQueue::getStats() noexcept {
+    Stats const stats{ mFlushedSize, mFlushCount, mWaitCount, mWaitDuration };
+    mFlushedSize = 0;
+    mFlushCount = 0;
+    mWaitCount = 0;
+    mWaitDuration = 0;
+    return stats;
+}
+
 std::vector<CommandBufferQueue::Range> CommandBufferQueue::waitForCommands() const {
-    if (!UTILS_HAS_THREADING) {
-        return std::move(mCommandBuffersToExecute);
+    if (UTILS_HAS_THREADING) {
+        while (true) {
+            // read the event count first, so that we can't miss a flush happening after the test
+            uint32_t const events = mProducerEvents.load();
+            if ((!mCommandBuffersToExecute.empty() && !mPaused) || mExitRequested) {
+                break;
+            }
+            mProducerEvents.wait(events);
+        }
     }
-    std::unique_lock<utils::Mutex> lock(mLock);
-    while ((mCommandBuffersToExecute.empty() || mPaused) && !mExitRequested) {
-        mCondition.wait(lock);
+    std::vector<Range> buffers;
+    for (Range range{}; mCommandBuffersToExecute.pop(range);) {
+        buffers.push_back(range);
     }
-    return std::move(mCommandBuffersToExecute);
+    return buffers;
 }
 
 void CommandBufferQueue::releaseBuffer(CommandBufferQueue::Range const& buffer) {
     size_t const used = std::distance(
             static_cast<char const*>(buffer.begin), static_cast<char const*>(buffer.end));
-    std::lock_guard<utils::Mutex> const lock(mLock);
-    mFreeSpace += used;
-    mCondition.notify_one();
+    mFreeSpace.fetch_add(used, std::memory_order_release);
+    mConsumerEvents.fetch_add(1);
+    mConsumerEvents.notify_one();
 }
 
 } // namespace filament::backend
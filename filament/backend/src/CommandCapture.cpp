@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "private/backend/CommandCapture.h"
+
+#include <utils/Log.h>
+
+#include <string.h>
+
+using namespace utils;
+
+namespace filament::backend {
+
+CommandCapture::CommandCapture(const char* path, uint32_t frameCount) noexcept
+        : mFramesLeft(frameCount) {
+    mFile = fopen(path, "wb");
+    if (!mFile) {
+        slog.e << "Couldn't open " << path << " to capture the commands" << io::endl;
+        return;
+    }
+    Header const header;
+    fwrite(&header, sizeof(header), 1, mFile);
+    mFileSize = sizeof(header);
+    slog.i << "Capturing the commands of " << frameCount << " frame(s) into " << path << io::endl;
+}
+
+CommandCapture::~CommandCapture() noexcept {
+    if (mFile) {
+        fclose(mFile);
+    }
+}
+
+void CommandCapture::flush(Command command) noexcept {
+    RecordHeader const header{ command, uint32_t(mRecord.size()) };
+    fwrite(&header, sizeof(header), 1, mFile);
+    fwrite(mRecord.data(), 1, mRecord.size(), mFile);
+    mFileSize += sizeof(header) + mRecord.size();
+    if (command == Command::endFrame && --mFramesLeft == 0) {
+        fclose(mFile);
+        mFile = nullptr;
+        slog.i << "Command capture done, " << mFileSize << " bytes written" << io::endl;
+    }
+}
+
+void CommandCapture::writeBytes(void const* data, size_t size) {
+    uint8_t const* const p = static_cast<uint8_t const*>(data);
+    mRecord.insert(mRecord.end(), p, p + size);
+}
+
+void CommandCapture::writeString(const char* s, size_t length) {
+    // the terminator lets the strings be replayed in place
+    write(uint32_t(length));
+    writeBytes(s, length);
+    mRecord.push_back(0);
+}
+
+void CommandCapture::write(const char* s) {
+    writeString(s ? s : "", s ? strlen(s) : 0);
+}
+
+void CommandCapture::write(CString const& s) {
+    writeString(s.c_str_safe(), s.size());
+}
+
+void CommandCapture::write(BufferDescriptor const& data) {
+    write(uint64_t(data.size));
+    // the payload is replayed in place, so it must be aligned in the file
+    size_t const offset = mFileSize + sizeof(RecordHeader) + mRecord.size();
+    size_t const padding = (PAYLOAD_ALIGNMENT - offset % PAYLOAD_ALIGNMENT) % PAYLOAD_ALIGNMENT;
+    mRecord.resize(mRecord.size() + padding);
+    writeBytes(data.buffer, data.buffer ? data.size : 0);
+    if (!data.buffer) {
+        mRecord.resize(mRecord.size() + data.size);
+    }
+}
+
+void CommandCapture::write(PixelBufferDescriptor const& data) {
+    write(static_cast<BufferDescriptor const&>(data));
+    write(data.left);
+    write(data.top);
+    write(data.type);
+    write(data.alignment);
+    if (data.type == PixelDataType::COMPRESSED) {
+        write(data.imageSize);
+        write(data.compressedFormat);
+    } else {
+        write(data.stride);
+        write(data.format);
+    }
+}
+
+void CommandCapture::write(PipelineState const& state) {
+    write(state.program);
+    write(state.vertexBufferInfo);
+    write(state.rasterState);
+    write(state.stencilState);
+    write(state.polygonOffset);
+    write(state.primitiveType);
+}
+
+void CommandCapture::write(TargetBufferInfo const& info) {
+    write(info.handle);
+    write(info.baseViewIndex);
+    write(info.level);
+    write(info.layer);
+}
+
+void CommandCapture::write(MRT const& mrt) {
+    for (size_t i = 0; i < MRT::MAX_SUPPORTED_RENDER_TARGET_COUNT; i++) {
+        write(mrt[i]);
+    }
+}
+
+void CommandCapture::write(Program const& program) {
+    write(program.getName());
+    write(program.getShaderLanguage());
+    write(program.getCacheId());
+    write(program.isMultiview());
+    write(program.getPriorityQueue());
+    for (auto const& blob : program.getShadersSource()) {
+        write(uint32_t(blob.size()));
+        writeBytes(blob.data(), blob.size());
+    }
+    for (auto const& name : program.getUniformBlockBindings()) {
+        write(name);
+    }
+    for (auto const& uniforms : program.getBindingUniformInfo()) {
+        write(uint32_t(uniforms.size()));
+        for (auto const& uniform : uniforms) {
+            write(uniform.name);
+            write(uniform.offset);
+            write(uniform.size);
+            write(uniform.type);
+        }
+    }
+    for (auto const& group : program.getSamplerGroupInfo()) {
+        write(group.stageFlags);
+        write(uint32_t(group.samplers.size()));
+        for (auto const& sampler : group.samplers) {
+            write(sampler.name);
+            write(sampler.binding);
+        }
+    }
+    write(uint32_t(program.getAttributes().size()));
+    for (auto const& [name, location] : program.getAttributes()) {
+        write(name);
+        write(location);
+    }
+    write(uint32_t(program.getSpecializationConstants().size()));
+    for (auto const& constant : program.getSpecializationConstants()) {
+        write(constant.id);
+        write(constant.value);
+    }
+    for (size_t i = 0; i < Program::SHADER_TYPE_COUNT; i++) {
+        auto const& constants = program.getPushConstants(ShaderStage(i));
+        write(uint32_t(constants.size()));
+        for (auto const& constant : constants) {
+            write(constant.name);
+            write(constant.type);
+        }
+    }
+}
+
+} // namespace filament::backend
@@ -0,0 +1,434 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "private/backend/CommandReplay.h"
+
+#include <backend/SamplerDescriptor.h>
+
+#include <utils/CString.h>
+#include <utils/FixedCapacityVector.h>
+#include <utils/Log.h>
+#include <utils/memalign.h>
+
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace utils;
+
+namespace filament::backend {
+
+namespace {
+
+using Command = CommandCapture::Command;
+using HandleId = HandleBase::HandleId;
+
+template<typename T>
+struct Type {};
+
+// reads the parameters of a record in the order CommandCapture wrote them
+class Reader {
+public:
+    Reader(uint8_t const* base, uint8_t* cursor,
+            std::unordered_map<HandleId, HandleId>& handles,
+            std::unordered_set<HandleId>* created) noexcept
+            : mBase(base), mCursor(cursor), mHandles(handles), mCreated(created) {
+    }
+
+    template<typename T>
+    T read() {
+        return read(Type<T>{});
+    }
+
+    uint8_t const* getCursor() const noexcept { return mCursor; }
+
+    void setHandle(HandleId captured, HandleId replayed) {
+        mHandles[captured] = replayed;
+        if (mCreated) {
+            mCreated->insert(captured);
+        }
+    }
+
+    HandleId getHandle(HandleId captured) const noexcept {
+        auto const pos = mHandles.find(captured);
+        return pos == mHandles.end() ? HandleBase::nullid : pos->second;
+    }
+
+private:
+    uint8_t* bytes(size_t size) noexcept {
+        uint8_t* const p = mCursor;
+        mCursor += size;
+        return p;
+    }
+
+    template<typename T, typename = std::enable_if_t<
+            std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>>>
+    T read(Type<T>) {
+        T value;
+        memcpy(&value, bytes(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    Handle<T> read(Type<Handle<T>>) {
+        // handles created by synchronous commands, e.g. streams, are unknown and replayed as null
+        HandleId const id = getHandle(read<HandleId>());
+        return id == HandleBase::nullid ? Handle<T>{} : Handle<T>{ id };
+    }
+
+    template<typename T>
+    T* read(Type<T*>) { return nullptr; }
+    Invocable<void()> read(Type<Invocable<void()>>) { return {}; }
+    FrameScheduledCallback read(Type<FrameScheduledCallback>) { return {}; }
+
+    const char* read(Type<const char*>) {
+        uint32_t const length = read<uint32_t>();
+        return reinterpret_cast<const char*>(bytes(length + 1));
+    }
+
+    CString read(Type<CString>) {
+        uint32_t const length = read<uint32_t>();
+        return { reinterpret_cast<const char*>(bytes(length + 1)), length };
+    }
+
+    BufferDescriptor read(Type<BufferDescriptor>) {
+        size_t const size = read<uint64_t>();
+        size_t const offset = mCursor - mBase;
+        bytes((CommandCapture::PAYLOAD_ALIGNMENT - offset % CommandCapture::PAYLOAD_ALIGNMENT) %
+                CommandCapture::PAYLOAD_ALIGNMENT);
+        // replayed in place, the data is owned by CommandReplay
+        return { bytes(size), size };
+    }
+
+    PixelBufferDescriptor read(Type<PixelBufferDescriptor>) {
+        BufferDescriptor const data = read<BufferDescriptor>();
+        uint32_t const left = read<uint32_t>();
+        uint32_t const top = read<uint32_t>();
+        PixelDataType const type = read<PixelDataType>();
+        uint8_t const alignment = read<uint8_t>();
+        if (type == PixelDataType::COMPRESSED) {
+            uint32_t const imageSize = read<uint32_t>();
+            PixelBufferDescriptor result(data.buffer, data.size,
+                    read<CompressedPixelDataType>(), imageSize, nullptr);
+            result.left = left;
+            result.top = top;
+            return result;
+        }
+        uint32_t const stride = read<uint32_t>();
+        return { data.buffer, data.size, read<PixelDataFormat>(), type, alignment,
+                 left, top, stride };
+    }
+
+    PipelineState read(Type<PipelineState>) {
+        PipelineState state;
+        state.program = read<ProgramHandle>();
+        state.vertexBufferInfo = read<VertexBufferInfoHandle>();
+        state.rasterState = read<RasterState>();
+        state.stencilState = read<StencilState>();
+        state.polygonOffset = read<PolygonOffset>();
+        state.primitiveType = read<PrimitiveType>();
+        return state;
+    }
+
+    TargetBufferInfo read(Type<TargetBufferInfo>) {
+        TargetBufferInfo info;
+        info.handle = read<TextureHandle>();
+        info.baseViewIndex = read<uint8_t>();
+        info.level = read<uint8_t>();
+        info.layer = read<uint16_t>();
+        return info;
+    }
+
+    MRT read(Type<MRT>) {
+        MRT mrt;
+        for (size_t i = 0; i < MRT::MAX_SUPPORTED_RENDER_TARGET_COUNT; i++) {
+            mrt[i] = read<TargetBufferInfo>();
+        }
+        return mrt;
+    }
+
+    Program read(Type<Program>) {
+        Program program;
+        program.getName() = read<CString>();
+        program.shaderLanguage(read<ShaderLanguage>());
+        program.cacheId(read<uint64_t>());
+        program.multiview(read<bool>());
+        program.priorityQueue(read<CompilerPriorityQueue>());
+        for (auto& blob : program.getShadersSource()) {
+            uint32_t const size = read<uint32_t>();
+            blob = Program::ShaderBlob(size);
+            memcpy(blob.data(), bytes(size), size);
+        }
+        for (auto& name : program.getUniformBlockBindings()) {
+            name = read<CString>();
+        }
+        for (auto& uniforms : program.getBindingUniformInfo()) {
+            uniforms = Program::UniformInfo::with_capacity(read<uint32_t>());
+            for (size_t i = 0, c = uniforms.capacity(); i < c; i++) {
+                // braced initialization reads the fields in order
+                uniforms.push_back({ read<CString>(), read<uint16_t>(), read<uint8_t>(),
+                                     read<UniformType>() });
+            }
+        }
+        for (auto& group : program.getSamplerGroupInfo()) {
+            group.stageFlags = read<ShaderStageFlags>();
+            group.samplers = FixedCapacityVector<Program::Sampler>::with_capacity(
+                    read<uint32_t>());
+            for (size_t i = 0, c = group.samplers.capacity(); i < c; i++) {
+                group.samplers.push_back({ read<CString>(), read<uint32_t>() });
+            }
+        }
+        auto& attributes = program.getAttributes();
+        attributes = FixedCapacityVector<std::pair<CString, uint8_t>>::with_capacity(
+                read<uint32_t>());
+        for (size_t i = 0, c = attributes.capacity(); i < c; i++) {
+            attributes.push_back({ read<CString>(), read<uint8_t>() });
+        }
+        auto& constants = program.getSpecializationConstants();
+        constants = FixedCapacityVector<Program::SpecializationConstant>::with_capacity(
+                read<uint32_t>());
+        for (size_t i = 0, c = constants.capacity(); i < c; i++) {
+            using Value = Program::SpecializationConstant::Type;
+            constants.push_back({ read<uint32_t>(), read<Value>() });
+        }
+        for (size_t stage = 0; stage < Program::SHADER_TYPE_COUNT; stage++) {
+            auto& pushConstants = program.getPushConstants(ShaderStage(stage));
+            pushConstants = FixedCapacityVector<Program::PushConstant>::with_capacity(
+                    read<uint32_t>());
+            for (size_t i = 0, c = pushConstants.capacity(); i < c; i++) {
+                pushConstants.push_back({ read<CString>(), read<ConstantType>() });
+            }
+        }
+        return program;
+    }
+
+    uint8_t const* const mBase;
+    uint8_t* mCursor;
+    std::unordered_map<HandleId, HandleId>& mHandles;
+    std::unordered_set<HandleId>* const mCreated;
+};
+
+template<typename T>
+struct Method;
+
+template<typename R, typename... ARGS>
+struct Method<R (CommandStream::*)(ARGS...)> {
+    template<R (CommandStream::*method)(ARGS...)>
+    static R call(Reader& reader, CommandStream& stream) {
+        // braced initialization reads the parameters in order
+        std::tuple<std::decay_t<ARGS>...> args{ reader.read<std::decay_t<ARGS>>()... };
+        return std::apply([&stream](auto&... arg) {
+            return (stream.*method)(std::move(arg)...);
+        }, args);
+    }
+};
+
+template<auto method>
+auto call(Reader& reader, CommandStream& stream) {
+    return Method<decltype(method)>::template call<method>(reader, stream);
+}
+
+template<auto method>
+void replayCommand(Reader& reader, CommandStream& stream) {
+    if constexpr (std::is_void_v<decltype(call<method>(reader, stream))>) {
+        call<method>(reader, stream);
+    } else {
+        HandleId const id = reader.read<HandleId>();
+        reader.setHandle(id, call<method>(reader, stream).getId());
+    }
+}
+
+using ReplayFunction = void(*)(Reader& reader, CommandStream& stream);
+
+constexpr ReplayFunction sReplayFunctions[] = {
+#define DECL_DRIVER_API(methodName, paramsDecl, params)                                         \
+        &replayCommand<&CommandStream::methodName>,
+#define DECL_DRIVER_API_RETURN(RetType, methodName, paramsDecl, params)                         \
+        &replayCommand<&CommandStream::methodName>,
+#define DECL_DRIVER_API_SYNCHRONOUS(RetType, methodName, paramsDecl, params)
+#include "private/backend/DriverAPI.inc"
+};
+
+static_assert(std::size(sReplayFunctions) == size_t(Command::COUNT));
+
+constexpr bool sDestroyCommands[] = {
+#define DECL_DRIVER_API(methodName, paramsDecl, params)                                         \
+        std::string_view(#methodName).substr(0, 7) == "destroy",
+#define DECL_DRIVER_API_RETURN(RetType, methodName, paramsDecl, params) false,
+#define DECL_DRIVER_API_SYNCHRONOUS(RetType, methodName, paramsDecl, params)
+#include "private/backend/DriverAPI.inc"
+};
+
+} // anonymous namespace
+
+CommandReplay::CommandReplay(Config const& config) noexcept : mConfig(config) {
+}
+
+CommandReplay::~CommandReplay() noexcept {
+    utils::aligned_free(mData);
+}
+
+bool CommandReplay::load(const char* path) {
+    FILE* const file = fopen(path, "rb");
+    if (!file) {
+        slog.e << "Couldn't open " << path << io::endl;
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    size_t const size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    // the BufferDescriptor payloads are aligned relative to the start of the file
+    mData = static_cast<uint8_t*>(utils::aligned_alloc(size, CommandCapture::PAYLOAD_ALIGNMENT));
+    size_t const read = fread(mData, 1, size, file);
+    fclose(file);
+
+    CommandCapture::Header header;
+    if (read != size || size < sizeof(header)) {
+        slog.e << "Couldn't read " << path << io::endl;
+        return false;
+    }
+    memcpy(&header, mData, sizeof(header));
+    if (header.magic != CommandCapture::MAGIC || header.version != CommandCapture::VERSION ||
+            header.commandCount != uint32_t(Command::COUNT)) {
+        slog.e << path << " wasn't captured by this version of filament" << io::endl;
+        return false;
+    }
+
+    size_t offset = sizeof(header);
+    while (offset + sizeof(CommandCapture::RecordHeader) <= size) {
+        CommandCapture::RecordHeader record;
+        memcpy(&record, mData + offset, sizeof(record));
+        offset += sizeof(record);
+        if (record.command >= Command::COUNT || offset + record.size > size) {
+            slog.e << path << " is truncated or corrupted" << io::endl;
+            return false;
+        }
+        if (record.command == Command::beginFrame) {
+            mFrameBegin = mRecords.size();
+            mFrameCount++;
+        } else if (record.command == Command::endFrame) {
+            mFrameEnd = mRecords.size() + 1;
+        }
+        mRecords.push_back({ record.command, record.size, mData + offset });
+        offset += record.size;
+    }
+
+    if (!mFrameCount || mFrameEnd <= mFrameBegin) {
+        slog.e << path << " doesn't contain a complete frame" << io::endl;
+        return false;
+    }
+    return true;
+}
+
+void CommandReplay::replaySetup(CommandStream& stream, FlushCallback const& flush) {
+    for (size_t i = 0; i < mFrameBegin; i++) {
+        replay(mRecords[i], stream, false);
+        if (stream.getCircularBuffer().getUsed() >= mConfig.flushSize) {
+            flush();
+        }
+    }
+    flush();
+    mSetupHandles = mHandles;
+}
+
+void CommandReplay::replayFrame(CommandStream& stream, FlushCallback const& flush) {
+    // each replay starts from the state left by the setup
+    mHandles = mSetupHandles;
+    mFrameHandles.clear();
+    for (size_t i = mFrameBegin; i < mFrameEnd; i++) {
+        replay(mRecords[i], stream, true);
+        if (stream.getCircularBuffer().getUsed() >= mConfig.flushSize) {
+            flush();
+        }
+    }
+    flush();
+}
+
+void CommandReplay::replay(Record const& record, CommandStream& stream, bool frame) {
+    Reader reader{ mData, record.data, mHandles, frame ? &mFrameHandles : nullptr };
+    switch (record.command) {
+        case Command::setFrameScheduledCallback:
+        case Command::setFrameCompletedCallback:
+        case Command::setExternalImage:
+        case Command::setExternalImagePlane:
+        case Command::setExternalStream:
+            // these only make sense in the captured process
+            return;
+
+        case Command::createSwapChain: {
+            HandleId const id = reader.read<HandleId>();
+            reader.read<void*>();
+            uint64_t const flags = reader.read<uint64_t>();
+            reader.setHandle(id,
+                    stream.createSwapChainHeadless(mConfig.width, mConfig.height, flags).getId());
+            break;
+        }
+
+        case Command::importTexture: {
+            HandleId const id = reader.read<HandleId>();
+            reader.read<intptr_t>();
+            reader.setHandle(id, call<&CommandStream::createTexture>(reader, stream).getId());
+            break;
+        }
+
+        case Command::setDebugTag: {
+            HandleId const id = reader.getHandle(reader.read<HandleId>());
+            CString tag = reader.read<CString>();
+            if (id != HandleBase::nullid) {
+                stream.setDebugTag(id, std::move(tag));
+            }
+            break;
+        }
+
+        case Command::updateSamplerGroup: {
+            SamplerGroupHandle const sgh = reader.read<SamplerGroupHandle>();
+            BufferDescriptor const data = reader.read<BufferDescriptor>();
+            // the samplers reference textures by handle, they need to be remapped, in a copy
+            // since the frame can be replayed again
+            auto* const samplers = static_cast<SamplerDescriptor*>(malloc(data.size));
+            memcpy(static_cast<void*>(samplers), data.buffer, data.size);
+            for (size_t i = 0, c = data.size / sizeof(SamplerDescriptor); i < c; i++) {
+                HandleId const id = reader.getHandle(samplers[i].t.getId());
+                samplers[i].t = id == HandleBase::nullid ? TextureHandle{} : TextureHandle{ id };
+            }
+            stream.updateSamplerGroup(sgh, { samplers, data.size,
+                    [](void* buffer, size_t, void*) { free(buffer); }});
+            break;
+        }
+
+        default: {
+            if (frame && sDestroyCommands[size_t(record.command)]) {
+                // keep the resources created before this frame, the next replay needs them
+                HandleId id;
+                memcpy(&id, record.data, sizeof(id));
+                if (!mFrameHandles.count(id)) {
+                    return;
+                }
+            }
+            sReplayFunctions[size_t(record.command)](reader, stream);
+            break;
+        }
+    }
+    assert_invariant(reader.getCursor() == record.data + record.size);
+}
+
+} // namespace filament::backend
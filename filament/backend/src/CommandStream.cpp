@@ -26,10 +26,16 @@
 #include <utils/Profiler.h>
 #include <utils/Systrace.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <functional>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include <string.h>
 
 #ifdef __ANDROID__
 #include <sys/system_properties.h>
@@ -93,6 +99,10 @@ void CommandStream::execute(void* buffer) {
     }
 
     mDriver.execute([this, buffer]() {
+        if (UTILS_UNLIKELY(isProfilingEnabled())) {
+            executeProfiled(buffer);
+            return;
+        }
         Driver& UTILS_RESTRICT driver = mDriver;
         CommandBase* UTILS_RESTRICT base = static_cast<CommandBase*>(buffer);
         while (UTILS_LIKELY(base)) {
@@ -116,10 +126,82 @@ void CommandStream::execute(void* buffer) {
     }
 }
 
+UTILS_NOINLINE
+void CommandStream::executeProfiled(void* buffer) noexcept {
+    using clock = std::chrono::steady_clock;
+
+    if (UTILS_UNLIKELY(mCommandTypes.empty())) {
+        // index 0 is for everything that isn't a DriverApi command
+        mExecutedStats.push_back({ "other" });
+#define DECL_DRIVER_API(methodName, paramsDecl, params)                                         \
+        mCommandTypes.emplace(mDispatcher.methodName##_, uint32_t(mExecutedStats.size()));      \
+        mExecutedStats.push_back({ #methodName });
+#define DECL_DRIVER_API_RETURN(RetType, methodName, paramsDecl, params)                         \
+        mCommandTypes.emplace(mDispatcher.methodName##_, uint32_t(mExecutedStats.size()));      \
+        mExecutedStats.push_back({ #methodName });
+#define DECL_DRIVER_API_SYNCHRONOUS(RetType, methodName, paramsDecl, params)
+#include "private/backend/DriverAPI.inc"
+    }
+
+    Driver& UTILS_RESTRICT driver = mDriver;
+    CommandBase* UTILS_RESTRICT base = static_cast<CommandBase*>(buffer);
+    while (UTILS_LIKELY(base)) {
+        auto const pos = mCommandTypes.find(base->getExecute());
+        CommandStats& stats = mExecutedStats[pos == mCommandTypes.end() ? 0 : pos->second];
+        clock::time_point const start = clock::now();
+        CommandBase* const next = base->execute(driver);
+        stats.duration += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                clock::now() - start).count();
+        stats.count++;
+        // the last command of the buffer doesn't have a successor, its size doesn't matter
+        stats.bytes += next ? uint32_t((char const*)next - (char const*)base) : 0;
+        base = next;
+    }
+
+    std::lock_guard<utils::Mutex> const lock(mProfilingLock);
+    mProfilingStats.resize(mExecutedStats.size());
+    for (size_t i = 0, c = mExecutedStats.size(); i < c; i++) {
+        CommandStats& stats = mExecutedStats[i];
+        mProfilingStats[i].name = stats.name;
+        mProfilingStats[i].count += stats.count;
+        mProfilingStats[i].bytes += stats.bytes;
+        mProfilingStats[i].duration += stats.duration;
+        stats.count = 0;
+        stats.bytes = 0;
+        stats.duration = 0;
+    }
+}
+
+std::vector<CommandStream::CommandStats> CommandStream::getProfilingStats() {
+    std::vector<CommandStats> result;
+    {
+        std::lock_guard<utils::Mutex> const lock(mProfilingLock);
+        for (CommandStats& stats : mProfilingStats) {
+            if (stats.count) {
+                result.push_back(stats);
+                stats = { stats.name };
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), [](CommandStats const& lhs, CommandStats const& rhs) {
+        return lhs.duration > rhs.duration;
+    });
+    return result;
+}
+
 void CommandStream::queueCommand(std::function<void()> command) {
     new(allocateCommand(CustomCommand::align(sizeof(CustomCommand)))) CustomCommand(std::move(command));
 }
 
+void CommandStream::append(CircularBuffer& buffer) noexcept {
+    auto const [tail, head] = buffer.getBuffer();
+    size_t const size = static_cast<char const*>(head) - static_cast<char const*>(tail);
+    if (size) {
+        // all commands have a size multiple of the alignment, so this preserves it
+        memcpy(allocateCommand(size), tail, size);
+    }
+}
+
 template<typename... ARGS>
 template<void (Driver::*METHOD)(ARGS...)>
 template<std::size_t... I>
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DataReshaper.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define FILAMENT_RESHAPER_SSE2 1
+#   include <emmintrin.h>
+#   if defined(__SSSE3__)
+#       define FILAMENT_RESHAPER_SSSE3 1
+#       include <tmmintrin.h>
+#   endif
+#elif defined(__ARM_NEON)
+#   define FILAMENT_RESHAPER_NEON 1
+#   include <arm_neon.h>
+#endif
+
+namespace filament::backend {
+
+// All the kernels below assume a little-endian host, like the rest of the backend.
+
+void DataReshaper::expandRGB8ToRGBA8(uint8_t* UTILS_RESTRICT dst,
+        uint8_t const* UTILS_RESTRICT src, size_t width) noexcept {
+    size_t i = 0;
+#if defined(FILAMENT_RESHAPER_NEON)
+    for (; i + 16 <= width; i += 16, src += 48, dst += 64) {
+        uint8x16x3_t const rgb = vld3q_u8(src);
+        uint8x16x4_t const rgba = { rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(0xff) };
+        vst4q_u8(dst, rgba);
+    }
+#elif defined(FILAMENT_RESHAPER_SSSE3)
+    // each 16 bytes load covers 4 pixels plus 4 bytes of the next ones, which we don't touch
+    // but must be in bounds.
+    __m128i const shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    __m128i const alpha = _mm_set1_epi32(int32_t(0xff000000));
+    for (; i + 6 <= width; i += 4, src += 12, dst += 16) {
+        __m128i const rgb = _mm_loadu_si128((__m128i const*)src);
+        _mm_storeu_si128((__m128i*)dst, _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+    }
+#endif
+    // Without a byte shuffle, loading each pixel as a word and forcing its alpha byte is what
+    // vectorizes best. The last pixel can't be loaded that way, it'd read past the end.
+    for (; i + 1 < width; i++, src += 3, dst += 4) {
+        uint32_t rgb;
+        memcpy(&rgb, src, sizeof(rgb));
+        rgb |= 0xff000000u;
+        memcpy(dst, &rgb, sizeof(rgb));
+    }
+    if (i < width) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 0xff;
+    }
+}
+
+void DataReshaper::swizzleRGBA8(uint8_t* UTILS_RESTRICT dst,
+        uint8_t const* UTILS_RESTRICT src, size_t width) noexcept {
+    size_t i = 0;
+#if defined(FILAMENT_RESHAPER_NEON)
+    for (; i + 16 <= width; i += 16, src += 64, dst += 64) {
+        uint8x16x4_t rgba = vld4q_u8(src);
+        std::swap(rgba.val[0], rgba.val[2]);
+        vst4q_u8(dst, rgba);
+    }
+#elif defined(FILAMENT_RESHAPER_SSE2)
+    __m128i const maskAG = _mm_set1_epi32(int32_t(0xff00ff00));
+    __m128i const maskRB = _mm_set1_epi32(0x00ff00ff);
+    for (; i + 4 <= width; i += 4, src += 16, dst += 16) {
+        __m128i const rgba = _mm_loadu_si128((__m128i const*)src);
+        // R and B end up in the low byte of each 16-bits word, swapping the words swaps them.
+        __m128i rb = _mm_and_si128(rgba, maskRB);
+        rb = _mm_shufflehi_epi16(_mm_shufflelo_epi16(rb, 0xB1), 0xB1);
+        _mm_storeu_si128((__m128i*)dst, _mm_or_si128(_mm_and_si128(rgba, maskAG), rb));
+    }
+#endif
+    for (; i < width; i++, src += 4, dst += 4) {
+        uint32_t p;
+        memcpy(&p, src, sizeof(p));
+        p = (p & 0xff00ff00u) | ((p >> 16u) & 0xffu) | ((p & 0xffu) << 16u);
+        memcpy(dst, &p, sizeof(p));
+    }
+}
+
+void DataReshaper::convertRGBA32FToRGBA8(uint8_t* UTILS_RESTRICT dst,
+        float const* UTILS_RESTRICT src, size_t width) noexcept {
+    // This truncates like the scalar reshapeImage<uint8_t, float>, but values outside of [0, 1]
+    // (and NaNs) are saturated instead of wrapping around.
+    size_t i = 0;
+#if defined(FILAMENT_RESHAPER_NEON)
+    float32x4_t const scale = vdupq_n_f32(255.0f);
+    for (; i + 4 <= width; i += 4, src += 16, dst += 16) {
+        uint32x4_t const p0 = vcvtq_u32_f32(vmulq_f32(vld1q_f32(src +  0), scale));
+        uint32x4_t const p1 = vcvtq_u32_f32(vmulq_f32(vld1q_f32(src +  4), scale));
+        uint32x4_t const p2 = vcvtq_u32_f32(vmulq_f32(vld1q_f32(src +  8), scale));
+        uint32x4_t const p3 = vcvtq_u32_f32(vmulq_f32(vld1q_f32(src + 12), scale));
+        uint16x8_t const p01 = vcombine_u16(vqmovn_u32(p0), vqmovn_u32(p1));
+        uint16x8_t const p23 = vcombine_u16(vqmovn_u32(p2), vqmovn_u32(p3));
+        vst1q_u8(dst, vcombine_u8(vqmovn_u16(p01), vqmovn_u16(p23)));
+    }
+#elif defined(FILAMENT_RESHAPER_SSE2)
+    __m128 const scale = _mm_set1_ps(255.0f);
+    // _mm_min_ps() returns its second operand when either is a NaN, NaNs then convert to
+    // 0x80000000, which saturates to 0 below.
+    auto const convert = [scale](float const* p) {
+        return _mm_cvttps_epi32(_mm_min_ps(scale, _mm_mul_ps(_mm_loadu_ps(p), scale)));
+    };
+    for (; i + 4 <= width; i += 4, src += 16, dst += 16) {
+        __m128i const p0 = convert(src +  0);
+        __m128i const p1 = convert(src +  4);
+        __m128i const p2 = convert(src +  8);
+        __m128i const p3 = convert(src + 12);
+        __m128i const p01 = _mm_packs_epi32(p0, p1);
+        __m128i const p23 = _mm_packs_epi32(p2, p3);
+        _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(p01, p23));
+    }
+#endif
+    for (size_t n = (width - i) * 4; n; n--) {
+        float const v = *src++ * 255.0f;
+        *dst++ = uint8_t(v > 0.0f ? std::min(v, 255.0f) : 0.0f);
+    }
+}
+
+} // namespace filament::backend
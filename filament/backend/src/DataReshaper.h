@@ -19,10 +19,14 @@
 
 #include <backend/PixelBufferDescriptor.h>
 
+#include <algorithm>
 #include <cstring>
+#include <type_traits>
+
 #include <stddef.h>
 #include <stdint.h>
 
+#include <math/half.h>
 #include <math/scalar.h>
 
 #include <utils/debug.h>
@@ -37,12 +41,27 @@ template<typename componentType> inline componentType getMaxValue();
 class DataReshaper {
 public:
 
+    // Row kernels for the most common conversions, vectorized with NEON or SSE2 (SSSE3 when
+    // enabled). These are used by reshape() and reshapeImage() below when they apply.
+    static void expandRGB8ToRGBA8(uint8_t* UTILS_RESTRICT dst,
+            uint8_t const* UTILS_RESTRICT src, size_t width) noexcept;
+    // swaps the R and B channels, e.g. BGRA8 to RGBA8
+    static void swizzleRGBA8(uint8_t* UTILS_RESTRICT dst,
+            uint8_t const* UTILS_RESTRICT src, size_t width) noexcept;
+    static void convertRGBA32FToRGBA8(uint8_t* UTILS_RESTRICT dst,
+            float const* UTILS_RESTRICT src, size_t width) noexcept;
+
     // Adds padding to multi-channel interleaved data by inserting dummy values, or discards
     // trailing channels. This is useful for platforms that only accept 4-component data, since
     // users often wish to submit (or receive) 3-component data.
     template<typename componentType, size_t srcChannelCount, size_t dstChannelCount>
     static void reshape(void* UTILS_RESTRICT dest, const void* UTILS_RESTRICT src,
             size_t numSrcBytes) {
+        if constexpr (std::is_same_v<componentType, uint8_t> &&
+                srcChannelCount == 3 && dstChannelCount == 4) {
+            expandRGB8ToRGBA8((uint8_t*) dest, (const uint8_t*) src, numSrcBytes / 3);
+            return;
+        }
         const componentType maxValue = getMaxValue<componentType>();
         const componentType* in = (const componentType*) src;
         componentType* out = (componentType*) dest;
@@ -86,6 +105,27 @@ public:
         const size_t minChannelCount = math::min(srcChannelCount, dstChannelCount);
         assert_invariant(minChannelCount <= 4);
         UTILS_ASSUME(minChannelCount <= 4);
+        if constexpr (std::is_same_v<dstComponentType, uint8_t> &&
+                (std::is_same_v<srcComponentType, uint8_t> ||
+                 std::is_same_v<srcComponentType, float>)) {
+            if (srcChannelCount == 4 && dstChannelCount == 4 &&
+                    (std::is_same_v<srcComponentType, uint8_t> || !swizzle)) {
+                for (size_t row = 0; row < height; ++row) {
+                    if constexpr (std::is_same_v<srcComponentType, uint8_t>) {
+                        if (swizzle) {
+                            swizzleRGBA8(dest, src, width);
+                        } else {
+                            std::memcpy(dest, src, width * 4);
+                        }
+                    } else {
+                        convertRGBA32FToRGBA8(dest, (const float*) src, width);
+                    }
+                    src += srcBytesPerRow;
+                    dest += dstBytesPerRow;
+                }
+                return;
+            }
+        }
         const int inds[4] = { swizzle ? 2 : 0, 1, swizzle ? 0 : 2, 3 };
         for (size_t row = 0; row < height; ++row) {
             const srcComponentType* in = (const srcComponentType*)src;
@@ -111,7 +151,33 @@ public:
         }
     }
 
-    // Converts a n-channel image of UBYTE, INT, UINT, or FLOAT to a different type.
+    // Converts a n-channel image of HALF to a different type, by expanding it to FLOAT a few
+    // pixels at a time.
+    template<typename dstComponentType>
+    static void reshapeHalfImage(uint8_t* UTILS_RESTRICT dest, const uint8_t* UTILS_RESTRICT src,
+            size_t srcBytesPerRow,
+            size_t srcChannelCount, size_t dstBytesPerRow, size_t dstChannelCount,
+            size_t width, size_t height, bool swizzle) {
+        constexpr size_t CHUNK_SIZE = 64;
+        assert_invariant(srcChannelCount <= 4);
+        float temp[CHUNK_SIZE * 4];
+        for (size_t row = 0; row < height; ++row) {
+            const math::half* in = (const math::half*)src;
+            dstComponentType* out = (dstComponentType*)dest;
+            for (size_t column = 0; column < width; column += CHUNK_SIZE) {
+                const size_t count = std::min(CHUNK_SIZE, width - column);
+                math::halfToFloat(temp, in, count * srcChannelCount);
+                reshapeImage<dstComponentType, float>((uint8_t*) out, (const uint8_t*) temp, 0,
+                        srcChannelCount, 0, dstChannelCount, count, 1, swizzle);
+                in += count * srcChannelCount;
+                out += count * dstChannelCount;
+            }
+            src += srcBytesPerRow;
+            dest += dstBytesPerRow;
+        }
+    }
+
+    // Converts a n-channel image of UBYTE, INT, UINT, HALF or FLOAT to a different type.
     static bool reshapeImage(PixelBufferDescriptor* UTILS_RESTRICT dst, PixelDataType srcType,
             uint32_t srcChannelCount,  const uint8_t* UTILS_RESTRICT srcBytes, int srcBytesPerRow,
             int width, int height, bool swizzle) {
@@ -131,7 +197,7 @@ public:
                 size_t srcChannelCount, size_t dstBytesPerRow, size_t dstChannelCount,
                 size_t width, size_t height, bool swizzle) = nullptr;
         constexpr auto UBYTE = PixelDataType::UBYTE, FLOAT = PixelDataType::FLOAT,
-                UINT = PixelDataType::UINT, INT = PixelDataType::INT;
+                UINT = PixelDataType::UINT, INT = PixelDataType::INT, HALF = PixelDataType::HALF;
         switch (dst->type) {
             case UBYTE:
                 switch (srcType) {
@@ -145,6 +211,7 @@ public:
                     case FLOAT: reshaper = reshapeImage<uint8_t, float>; break;
                     case INT: reshaper = reshapeImage<uint8_t, int32_t>; break;
                     case UINT: reshaper = reshapeImage<uint8_t, uint32_t>; break;
+                    case HALF: reshaper = reshapeHalfImage<uint8_t>; break;
                     default: return false;
                 }
                 break;
@@ -154,6 +221,7 @@ public:
                     case FLOAT: reshaper = reshapeImage<float, float>; break;
                     case INT: reshaper = reshapeImage<float, int32_t>; break;
                     case UINT: reshaper = reshapeImage<float, uint32_t>; break;
+                    case HALF: reshaper = reshapeHalfImage<float>; break;
                     default: return false;
                 }
                 break;
@@ -163,6 +231,7 @@ public:
                     case FLOAT: reshaper = reshapeImage<int32_t, float>; break;
                     case INT: reshaper = reshapeImage<int32_t, int32_t>; break;
                     case UINT: reshaper = reshapeImage<int32_t, uint32_t>; break;
+                    case HALF: reshaper = reshapeHalfImage<int32_t>; break;
                     default: return false;
                 }
                 break;
@@ -172,6 +241,7 @@ public:
                     case FLOAT: reshaper = reshapeImage<uint32_t, float>; break;
                     case INT: reshaper = reshapeImage<uint32_t, int32_t>; break;
                     case UINT: reshaper = reshapeImage<uint32_t, uint32_t>; break;
+                    case HALF: reshaper = reshapeHalfImage<uint32_t>; break;
                     default: return false;
                 }
                 break;
@@ -36,7 +36,10 @@
 
 #include <functional>
 #include <mutex>
+#include <thread>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -46,27 +49,28 @@ using namespace filament::math;
 
 namespace filament::backend {
 
-DriverBase::DriverBase() noexcept {
+DriverBase::DriverBase() noexcept
+        : mCallbacks(MAX_PENDING_CALLBACKS),
+          mServiceThreadCallbackQueue(MAX_PENDING_CALLBACKS) {
     if constexpr (UTILS_HAS_THREADING) {
         // This thread services user callbacks
         mServiceThread = std::thread([this]() {
+            auto& serviceThreadCallbackQueue = mServiceThreadCallbackQueue;
+            std::tuple<CallbackHandler*, CallbackHandler::Callback, void*> item;
             do {
-                auto& serviceThreadCondition = mServiceThreadCondition;
-                auto& serviceThreadCallbackQueue = mServiceThreadCallbackQueue;
-
-                // wait for some callbacks to dispatch
-                std::unique_lock<std::mutex> lock(mServiceThreadLock);
-                while (serviceThreadCallbackQueue.empty() && !mExitRequested) {
-                    serviceThreadCondition.wait(lock);
-                }
+                // read the event count first, so that we can't miss a callback scheduled after
+                // the test
+                uint32_t const events = mServiceThreadEvents.load();
                 if (mExitRequested) {
                     break;
                 }
-                // move the callbacks to a temporary vector
-                auto callbacks(std::move(serviceThreadCallbackQueue));
-                lock.unlock();
-                // and make sure to call them without our lock held
-                for (auto[handler, callback, user]: callbacks) {
+                // wait for some callbacks to dispatch
+                if (serviceThreadCallbackQueue.empty()) {
+                    mServiceThreadEvents.wait(events);
+                    continue;
+                }
+                while (serviceThreadCallbackQueue.pop(item)) {
+                    auto const [handler, callback, user] = item;
                     handler->post(user, callback);
                 }
             } while (true);
@@ -75,14 +79,13 @@ DriverBase::DriverBase() noexcept {
 }
 
 DriverBase::~DriverBase() noexcept {
-    assert_invariant(mCallbacks.empty());
+    assert_invariant(mCallbacks.empty() && mOverflowCallbacks.empty());
     assert_invariant(mServiceThreadCallbackQueue.empty());
     if constexpr (UTILS_HAS_THREADING) {
         // quit our service thread
-        std::unique_lock<std::mutex> lock(mServiceThreadLock);
         mExitRequested = true;
-        mServiceThreadCondition.notify_one();
-        lock.unlock();
+        mServiceThreadEvents.fetch_add(1);
+        mServiceThreadEvents.notify_one();
         mServiceThread.join();
     }
 }
@@ -109,20 +112,35 @@ void DriverBase::CallbackData::release(CallbackData* data) {
 
 void DriverBase::scheduleCallback(CallbackHandler* handler, void* user, CallbackHandler::Callback callback) {
     if (handler && UTILS_HAS_THREADING) {
-        std::lock_guard<std::mutex> const lock(mServiceThreadLock);
-        mServiceThreadCallbackQueue.emplace_back(handler, callback, user);
-        mServiceThreadCondition.notify_one();
+        // the service thread drains this queue continuously, it can't stay full for long
+        while (UTILS_UNLIKELY(!mServiceThreadCallbackQueue.push({ handler, callback, user }))) {
+            std::this_thread::yield();
+        }
+        mServiceThreadEvents.fetch_add(1);
+        mServiceThreadEvents.notify_one();
     } else {
+        if (UTILS_LIKELY(!mOverflowing.load(std::memory_order_acquire)) &&
+                mCallbacks.push({ user, callback })) {
+            return;
+        }
         std::lock_guard<std::mutex> const lock(mPurgeLock);
-        mCallbacks.emplace_back(user, callback);
+        mOverflowing.store(true, std::memory_order_relaxed);
+        mOverflowCallbacks.emplace_back(user, callback);
     }
 }
 
 void DriverBase::purge() noexcept {
-    decltype(mCallbacks) callbacks;
-    std::unique_lock<std::mutex> lock(mPurgeLock);
-    std::swap(callbacks, mCallbacks);
-    lock.unlock(); // don't remove this, it ensures callbacks are called without lock held
+    // callbacks scheduled by the callbacks themselves are deferred to the next purge()
+    std::vector<std::pair<void*, CallbackHandler::Callback>> callbacks;
+    for (std::pair<void*, CallbackHandler::Callback> item; mCallbacks.pop(item);) {
+        callbacks.push_back(item);
+    }
+    if (UTILS_UNLIKELY(mOverflowing.load(std::memory_order_acquire))) {
+        std::lock_guard<std::mutex> const lock(mPurgeLock);
+        callbacks.insert(callbacks.end(), mOverflowCallbacks.begin(), mOverflowCallbacks.end());
+        mOverflowCallbacks.clear();
+        mOverflowing.store(false, std::memory_order_release);
+    }
     for (auto& item : callbacks) {
         item.second(item.first);
     }
@@ -218,4 +236,8 @@ void Driver::execute(std::function<void(void)> const& fn) {
     fn();
 }
 
+Driver::Statistics Driver::getStatistics() const noexcept {
+    return {};
+}
+
 } // namespace filament::backend
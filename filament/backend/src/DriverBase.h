@@ -19,6 +19,8 @@
 
 #include <utils/compiler.h>
 #include <utils/CString.h>
+#include <utils/Futex.h>
+#include <utils/MpscQueue.h>
 
 #include <backend/Platform.h>
 
@@ -29,10 +31,11 @@
 #include "private/backend/Dispatcher.h"
 #include "private/backend/Driver.h"
 
-#include <condition_variable>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -217,14 +220,24 @@ protected:
     void debugCommandEnd(CommandStream* cmds, bool synchronous, const char* methodName) noexcept override;
 
 private:
+    // maximum number of callbacks waiting to be dispatched by purge() or the service thread
+    static constexpr size_t MAX_PENDING_CALLBACKS = 4096;
+
+    // Callbacks dispatched by purge(). They can be scheduled from any thread, and only spill to
+    // the locked overflow list (until the next purge(), to preserve their order) when more than
+    // MAX_PENDING_CALLBACKS are pending, since purge() can't be waited on.
+    utils::MpscQueue<std::pair<void*, CallbackHandler::Callback>> mCallbacks;
     std::mutex mPurgeLock;
-    std::vector<std::pair<void*, CallbackHandler::Callback>> mCallbacks;
+    std::vector<std::pair<void*, CallbackHandler::Callback>> mOverflowCallbacks;
+    std::atomic<bool> mOverflowing = false;
 
+    // Callbacks dispatched to their handler by the service thread, which sleeps on
+    // mServiceThreadEvents when there are none.
     std::thread mServiceThread;
-    std::mutex mServiceThreadLock;
-    std::condition_variable mServiceThreadCondition;
-    std::vector<std::tuple<CallbackHandler*, CallbackHandler::Callback, void*>> mServiceThreadCallbackQueue;
-    bool mExitRequested = false;
+    utils::Futex mServiceThreadEvents;
+    utils::MpscQueue<std::tuple<CallbackHandler*, CallbackHandler::Callback, void*>>
+            mServiceThreadCallbackQueue;
+    std::atomic<bool> mExitRequested = false;
 };
 
 
@@ -42,8 +42,16 @@ UTILS_NOINLINE
 HandleAllocator<P0, P1, P2>::Allocator::Allocator(AreaPolicy::HeapArea const& area,
         bool disableUseAfterFreeCheck)
         : mArea(area),
-          mUseAfterFreeCheckDisabled(disableUseAfterFreeCheck) {
+          mUseAfterFreeCheckDisabled(disableUseAfterFreeCheck),
+          mCount(initializeArea(area)),
+          // size the different pools so that they can all contain the same number of handles
+          mPool0(static_cast<char*>(area.begin()), mCount * P0),
+          mPool1(static_cast<char*>(area.begin()) + mCount * P0, mCount * P1),
+          mPool2(static_cast<char*>(area.begin()) + mCount * (P0 + P1), mCount * P2) {
+}
 
+template <size_t P0, size_t P1, size_t P2>
+size_t HandleAllocator<P0, P1, P2>::Allocator::initializeArea(AreaPolicy::HeapArea const& area) {
     // The largest handle this allocator can generate currently depends on the architecture's
     // min alignment, typically 8 or 16 bytes.
     // e.g. On Android armv8, the alignment is 16 bytes, so for a 1 MiB heap, the largest handle
@@ -62,15 +70,7 @@ HandleAllocator<P0, P1, P2>::Allocator::Allocator(AreaPolicy::HeapArea const& ar
     // with an age of 0.
     memset(area.data(), 0, maxHeapSize);
 
-    // size the different pools so that they can all contain the same number of handles
-    size_t const count = maxHeapSize / (P0 + P1 + P2);
-    char* const p0 = static_cast<char*>(area.begin());
-    char* const p1 = p0 + count * P0;
-    char* const p2 = p1 + count * P1;
-
-    mPool0 = Pool<P0>(p0, count * P0);
-    mPool1 = Pool<P1>(p1, count * P1);
-    mPool2 = Pool<P2>(p2, count * P2);
+    return maxHeapSize / (P0 + P1 + P2);
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -87,6 +87,12 @@ HandleAllocator<P0, P1, P2>::HandleAllocator(const char* name, size_t size,
 
 template <size_t P0, size_t P1, size_t P2>
 HandleAllocator<P0, P1, P2>::~HandleAllocator() {
+#ifndef NDEBUG
+    for (PoolStatistics const& stats : getStatistics()) {
+        slog.d << "HandleAllocator pool of " << stats.size << " bytes: " << stats.highWatermark
+               << " / " << stats.count << " handles used at most" << io::endl;
+    }
+#endif
     auto& overflowMap = mOverflowMap;
     if (!overflowMap.empty()) {
         PANIC_LOG("Not all handles have been freed. Probably leaking memory.");
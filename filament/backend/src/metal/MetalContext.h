@@ -85,6 +85,7 @@ struct MetalContext {
     bool supportsTextureSwizzling = false;
     bool supportsAutoDepthResolve = false;
     bool supportsMemorylessRenderTargets = false;
+    bool supportsDrawIndirect = false;
     uint8_t maxColorRenderTargets = 4;
     struct {
         uint8_t common;
@@ -149,6 +149,11 @@ MetalDriver::MetalDriver(MetalPlatform* platform, const Platform::DriverConfig&
     // On iOS, it's available on all OS versions.
     mContext->supportsMemorylessRenderTargets = mContext->highestSupportedGpuFamily.apple >= 1;
 
+    // Indirect draw arguments are available starting with the A9 GPU family on iOS.
+    mContext->supportsDrawIndirect =
+        mContext->highestSupportedGpuFamily.apple >= 3 ||
+        mContext->highestSupportedGpuFamily.mac   >= 1;
+
     mContext->maxColorRenderTargets = 4;
     if (mContext->highestSupportedGpuFamily.apple >= 2 ||
         mContext->highestSupportedGpuFamily.mac >= 1) {
@@ -861,6 +866,20 @@ bool MetalDriver::isDepthClampSupported() {
     return true;
 }
 
+bool MetalDriver::isDrawIndirectSupported() {
+    return mContext->supportsDrawIndirect;
+}
+
+bool MetalDriver::isVariableRateShadingSupported() {
+    // Rasterization rate maps change the size of the render targets, which the shading rate of
+    // a pass can't express.
+    return false;
+}
+
+size_t MetalDriver::getAllocatedMemorySize() {
+    return mContext->device.currentAllocatedSize;
+}
+
 bool MetalDriver::isWorkaroundNeeded(Workaround workaround) {
     switch (workaround) {
         case Workaround::SPLIT_EASU:
@@ -1901,10 +1920,7 @@ void MetalDriver::bindRenderPrimitive(Handle<HwRenderPrimitive> rph) {
                                                atIndex:ZERO_VERTEX_BUFFER_BINDING];
 }
 
-void MetalDriver::draw2(uint32_t indexOffset, uint32_t indexCount, uint32_t instanceCount) {
-    FILAMENT_CHECK_PRECONDITION(mContext->currentRenderPassEncoder != nullptr)
-            << "draw() without a valid command encoder.";
-
+void MetalDriver::bindDrawResources() {
     // Bind uniform buffers.
     MetalBuffer* uniformsToBind[Program::UNIFORM_BINDING_COUNT] = { nil };
     NSUInteger offsets[Program::UNIFORM_BINDING_COUNT] = { 0 };
@@ -1926,6 +1942,13 @@ void MetalDriver::draw2(uint32_t indexOffset, uint32_t indexCount, uint32_t inst
             pushConstants.setBytes(mContext->currentRenderPassEncoder, static_cast<ShaderStage>(i));
         }
     }
+}
+
+void MetalDriver::draw2(uint32_t indexOffset, uint32_t indexCount, uint32_t instanceCount) {
+    FILAMENT_CHECK_PRECONDITION(mContext->currentRenderPassEncoder != nullptr)
+            << "draw() without a valid command encoder.";
+
+    bindDrawResources();
 
     auto primitive = handle_cast<MetalRenderPrimitive>(mContext->currentRenderPrimitive);
 
@@ -1941,6 +1964,34 @@ void MetalDriver::draw2(uint32_t indexOffset, uint32_t indexCount, uint32_t inst
                                                 instanceCount:instanceCount];
 }
 
+void MetalDriver::draw2Indirect(Handle<HwBufferObject> ibh, uint32_t byteOffset,
+        uint32_t drawCount, uint32_t byteStride) {
+    FILAMENT_CHECK_PRECONDITION(mContext->currentRenderPassEncoder != nullptr)
+            << "draw2Indirect() without a valid command encoder.";
+    assert_invariant(byteStride >= sizeof(DrawIndexedIndirectCommand));
+
+    bindDrawResources();
+
+    auto primitive = handle_cast<MetalRenderPrimitive>(mContext->currentRenderPrimitive);
+    MetalIndexBuffer* indexBuffer = primitive->indexBuffer;
+    auto* bo = handle_cast<MetalBufferObject>(ibh);
+
+    id<MTLCommandBuffer> cmdBuffer = getPendingCommandBuffer(mContext);
+    id<MTLBuffer> metalIndexBuffer = indexBuffer->buffer.getGpuBufferForDraw(cmdBuffer);
+    id<MTLBuffer> metalIndirectBuffer = bo->getBuffer()->getGpuBufferForDraw(cmdBuffer);
+
+    // MTLDrawIndexedPrimitivesIndirectArguments::indexStart already accounts for the index
+    // offset, so the index buffer is always bound at offset 0.
+    for (uint32_t i = 0; i < drawCount; i++) {
+        [mContext->currentRenderPassEncoder drawIndexedPrimitives:getMetalPrimitiveType(primitive->type)
+                                                        indexType:getIndexType(indexBuffer->elementSize)
+                                                      indexBuffer:metalIndexBuffer
+                                                indexBufferOffset:0
+                                                   indirectBuffer:metalIndirectBuffer
+                                             indirectBufferOffset:byteOffset + i * byteStride];
+    }
+}
+
 void MetalDriver::draw(PipelineState ps, Handle<HwRenderPrimitive> rph,
         uint32_t const indexOffset, uint32_t const indexCount, uint32_t const instanceCount) {
     MetalRenderPrimitive const* const rp = handle_cast<MetalRenderPrimitive>(rph);
@@ -547,6 +547,14 @@ MetalTexture::MetalTexture(MetalContext& context, SamplerType target, uint8_t le
             descriptor.sampleCount = multisampled ? samples : 1;
             descriptor.usage = getMetalTextureUsage(usage);
             descriptor.storageMode = MTLStorageModePrivate;
+            // memoryless textures can only be render targets
+            if (any(usage & TextureUsage::MEMORYLESS) &&
+                    descriptor.usage == MTLTextureUsageRenderTarget &&
+                    context.supportsMemorylessRenderTargets) {
+                if (@available(macOS 11.0, *)) {
+                    descriptor.storageMode = MTLStorageModeMemoryless;
+                }
+            }
             texture = [context.device newTextureWithDescriptor:descriptor];
             break;
         case SamplerType::SAMPLER_CUBEMAP:
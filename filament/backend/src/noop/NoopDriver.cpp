@@ -17,13 +17,19 @@
 #include "noop/NoopDriver.h"
 #include "CommandStreamDispatcher.h"
 
+#include <mutex>
+
+#include <string.h>
+
 namespace filament::backend {
 
-Driver* NoopDriver::create() {
-    return new NoopDriver();
+Driver* NoopDriver::create(Platform::DriverConfig const& driverConfig) {
+    return new NoopDriver(driverConfig);
 }
 
-NoopDriver::NoopDriver() noexcept = default;
+NoopDriver::NoopDriver(Platform::DriverConfig const& driverConfig) noexcept
+        : mStatisticsEnabled(driverConfig.noopStatistics) {
+}
 
 NoopDriver::~NoopDriver() noexcept = default;
 
@@ -39,6 +45,18 @@ ShaderModel NoopDriver::getShaderModel() const noexcept {
 #endif
 }
 
+Driver::Statistics NoopDriver::getStatistics() const noexcept {
+    std::lock_guard const lock(mStatisticsLock);
+    return mPublishedStatistics;
+}
+
+void NoopDriver::publishStatistics() noexcept {
+    if (mStatisticsEnabled) {
+        std::lock_guard const lock(mStatisticsLock);
+        mPublishedStatistics = mStatistics;
+    }
+}
+
 // explicit instantiation of the Dispatcher
 template class ConcreteDispatcher<NoopDriver>;
 
@@ -67,12 +85,16 @@ void NoopDriver::setPresentationTime(int64_t monotonic_clock_ns) {
 }
 
 void NoopDriver::endFrame(uint32_t frameId) {
+    mStatistics.frameCount++;
+    publishStatistics();
 }
 
 void NoopDriver::flush(int) {
+    publishStatistics();
 }
 
 void NoopDriver::finish(int) {
+    publishStatistics();
 }
 
 void NoopDriver::destroyRenderPrimitive(Handle<HwRenderPrimitive> rph) {
@@ -206,6 +228,18 @@ bool NoopDriver::isDepthClampSupported() {
     return false;
 }
 
+bool NoopDriver::isDrawIndirectSupported() {
+    return false;
+}
+
+bool NoopDriver::isVariableRateShadingSupported() {
+    return false;
+}
+
+size_t NoopDriver::getAllocatedMemorySize() {
+    return 0;
+}
+
 bool NoopDriver::isWorkaroundNeeded(Workaround) {
     return false;
 }
@@ -228,16 +262,22 @@ size_t NoopDriver::getMaxUniformBufferSize() {
 
 void NoopDriver::updateIndexBuffer(Handle<HwIndexBuffer> ibh, BufferDescriptor&& p,
         uint32_t byteOffset) {
+    mStatistics.bufferUploadCount++;
+    mStatistics.bufferUploadSize += p.size;
     scheduleDestroy(std::move(p));
 }
 
 void NoopDriver::updateBufferObject(Handle<HwBufferObject> ibh, BufferDescriptor&& p,
         uint32_t byteOffset) {
+    mStatistics.bufferUploadCount++;
+    mStatistics.bufferUploadSize += p.size;
     scheduleDestroy(std::move(p));
 }
 
 void NoopDriver::updateBufferObjectUnsynchronized(Handle<HwBufferObject> ibh, BufferDescriptor&& p,
         uint32_t byteOffset) {
+    mStatistics.bufferUploadCount++;
+    mStatistics.bufferUploadSize += p.size;
     scheduleDestroy(std::move(p));
 }
 
@@ -255,6 +295,8 @@ void NoopDriver::update3DImage(Handle<HwTexture> th,
         uint32_t level, uint32_t xoffset, uint32_t yoffset, uint32_t zoffset,
         uint32_t width, uint32_t height, uint32_t depth,
         PixelBufferDescriptor&& data) {
+    mStatistics.textureUploadCount++;
+    mStatistics.textureUploadSize += data.size;
     scheduleDestroy(std::move(data));
 }
 
@@ -289,6 +331,10 @@ void NoopDriver::compilePrograms(CompilerPriorityQueue priority,
 }
 
 void NoopDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassParams& params) {
+    // bindings don't carry over render passes
+    mStatistics.renderPassCount++;
+    mHasPipelineState = false;
+    mLastRenderPrimitive.clear();
 }
 
 void NoopDriver::endRenderPass(int) {
@@ -364,16 +410,38 @@ void NoopDriver::blit(
 }
 
 void NoopDriver::bindPipeline(PipelineState const& pipelineState) {
+    mStatistics.pipelineBindCount++;
+    // PipelineState has no implicit padding, so it can be compared bytewise
+    if (mHasPipelineState &&
+            !memcmp(&mLastPipelineState, &pipelineState, sizeof(PipelineState))) {
+        mStatistics.redundantPipelineBindCount++;
+    }
+    mLastPipelineState = pipelineState;
+    mHasPipelineState = true;
 }
 
 void NoopDriver::bindRenderPrimitive(Handle<HwRenderPrimitive> rph) {
+    mStatistics.primitiveBindCount++;
+    if (mLastRenderPrimitive && mLastRenderPrimitive == rph) {
+        mStatistics.redundantPrimitiveBindCount++;
+    }
+    mLastRenderPrimitive = rph;
 }
 
 void NoopDriver::draw2(uint32_t indexOffset, uint32_t indexCount, uint32_t instanceCount) {
+    mStatistics.drawCount++;
+}
+
+void NoopDriver::draw2Indirect(Handle<HwBufferObject> ibh, uint32_t byteOffset,
+        uint32_t drawCount, uint32_t byteStride) {
+    mStatistics.drawCount += drawCount;
 }
 
 void NoopDriver::draw(PipelineState pipelineState, Handle<HwRenderPrimitive> rph,
         uint32_t indexOffset, uint32_t indexCount, uint32_t instanceCount) {
+    bindPipeline(pipelineState);
+    bindRenderPrimitive(rph);
+    draw2(indexOffset, indexCount, instanceCount);
 }
 
 void NoopDriver::dispatchCompute(Handle<HwProgram> program, math::uint3 workGroupCount) {
@@ -20,23 +20,40 @@
 #include "private/backend/Driver.h"
 #include "DriverBase.h"
 
+#include <backend/Platform.h>
+
 #include <utils/compiler.h>
+#include <utils/Mutex.h>
 
 namespace filament::backend {
 
 class NoopDriver final : public DriverBase {
-    NoopDriver() noexcept;
+    explicit NoopDriver(Platform::DriverConfig const& driverConfig) noexcept;
     ~NoopDriver() noexcept override;
     Dispatcher getDispatcher() const noexcept final;
 
 public:
-    static Driver* create();
+    static Driver* create(Platform::DriverConfig const& driverConfig);
 
 private:
     ShaderModel getShaderModel() const noexcept final;
+    Statistics getStatistics() const noexcept final;
+
+    // makes the statistics counted so far visible to getStatistics()
+    void publishStatistics() noexcept;
 
     uint64_t nextFakeHandle = 1;
 
+    // The statistics are counted on the driver thread and published at the end of each frame
+    // and when the command stream is flushed.
+    bool const mStatisticsEnabled;
+    Statistics mStatistics;
+    PipelineState mLastPipelineState{};
+    Handle<HwRenderPrimitive> mLastRenderPrimitive;
+    bool mHasPipelineState = false;
+    mutable utils::Mutex mStatisticsLock;
+    Statistics mPublishedStatistics;
+
     /*
      * Driver interface
      */
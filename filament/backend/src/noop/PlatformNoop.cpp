@@ -21,7 +21,7 @@
 namespace filament::backend {
 
 Driver* PlatformNoop::createDriver(void* const sharedGLContext, const Platform::DriverConfig& driverConfig) noexcept {
-    return NoopDriver::create();
+    return NoopDriver::create(driverConfig);
 }
 
 } // namespace filament
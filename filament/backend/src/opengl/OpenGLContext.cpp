@@ -270,10 +270,10 @@ void OpenGLContext::terminate() noexcept {
     // note: this is called from the backend thread
 #ifndef FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2
     if (!isES2()) {
-        for (auto& item: mSamplerMap) {
-            unbindSampler(item.second);
-            glDeleteSamplers(1, &item.second);
-        }
+        mSamplerMap.forEach([this](SamplerParams const&, GLuint& sampler) {
+            unbindSampler(sampler);
+            glDeleteSamplers(1, &sampler);
+        });
         mSamplerMap.clear();
     }
 #endif
@@ -974,7 +974,6 @@ void OpenGLContext::deleteVertexArray(GLuint vao) noexcept {
 
 #ifndef FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2
 GLuint OpenGLContext::getSamplerSlow(SamplerParams params) const noexcept {
-    assert_invariant(mSamplerMap.find(params) == mSamplerMap.end());
 
     using namespace GLUtils;
 
@@ -997,7 +996,7 @@ GLuint OpenGLContext::getSamplerSlow(SamplerParams params) const noexcept {
     }
 #endif
     CHECK_GL_ERROR(utils::slog.e)
-    mSamplerMap[params] = s;
+    mSamplerMap.insert(params, s);
     return s;
 }
 #endif
@@ -30,12 +30,11 @@
 #include <utils/compiler.h>
 #include <utils/bitset.h>
 #include <utils/debug.h>
+#include <utils/GenerationalCache.h>
 
 #include <math/vec2.h>
 #include <math/vec4.h>
 
-#include <tsl/robin_map.h>
-
 #include <array>
 #include <functional>
 #include <optional>
@@ -426,7 +425,7 @@ public:
                     GLsizeiptr size = 0;
                 } buffers[MAX_BUFFER_BINDINGS];
             } targets[3];   // there are only 3 indexed buffer targets
-            GLuint genericBinding[7] = {};
+            GLuint genericBinding[8] = {};
         } buffers;
 
         struct {
@@ -488,12 +487,11 @@ public:
         assert_invariant(!sp.padding0);
         assert_invariant(!sp.padding1);
         assert_invariant(!sp.padding2);
-        auto& samplerMap = mSamplerMap;
-        auto pos = samplerMap.find(sp);
-        if (UTILS_UNLIKELY(pos == samplerMap.end())) {
+        GLuint const* sampler = mSamplerMap.find(sp);
+        if (UTILS_UNLIKELY(!sampler)) {
             return getSamplerSlow(sp);
         }
-        return pos->second;
+        return *sampler;
     }
 #endif
 
@@ -509,7 +507,7 @@ private:
     std::array<
             std::tuple<GLuint, void const*, uint16_t>,
             CONFIG_UNIFORM_BINDING_COUNT> mUniformBindings = {};
-    mutable tsl::robin_map<SamplerParams, GLuint,
+    mutable utils::GenerationalCache<SamplerParams, GLuint,
             SamplerParams::Hasher, SamplerParams::EqualTo> mSamplerMap;
 
     Platform::DriverConfig const mDriverConfig;
@@ -651,6 +649,9 @@ constexpr size_t OpenGLContext::getIndexForBufferTarget(GLenum target) noexcept
 #ifndef FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2
         case GL_PIXEL_PACK_BUFFER:          index = 5; break;
         case GL_PIXEL_UNPACK_BUFFER:        index = 6; break;
+#endif
+#if defined(BACKEND_OPENGL_LEVEL_GLES31)
+        case GL_DRAW_INDIRECT_BUFFER:       index = 7; break;
 #endif
         default: break;
     }
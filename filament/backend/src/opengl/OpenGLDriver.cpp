@@ -310,8 +310,19 @@ void OpenGLDriver::terminate() {
 
     // because we called glFinish(), all callbacks should have been executed
     assert_invariant(mGpuCommandCompleteOps.empty());
+
+    for (PixelBuffer const& buffer : mReadbackBuffers) {
+        glDeleteBuffers(1, &buffer.id);
+    }
+    mReadbackBuffers.clear();
+    for (PixelBuffer const& buffer : mUploadBuffers) {
+        glDeleteBuffers(1, &buffer.id);
+    }
+    mUploadBuffers.clear();
 #endif
 
+    executeDeferredDeletes(true);
+
     delete mCurrentPushConstants;
     mCurrentPushConstants = nullptr;
 
@@ -1604,7 +1615,7 @@ void OpenGLDriver::destroyIndexBuffer(Handle<HwIndexBuffer> ibh) {
     if (ibh) {
         auto& gl = mContext;
         GLIndexBuffer const* ib = handle_cast<const GLIndexBuffer*>(ibh);
-        gl.deleteBuffers(1, &ib->gl.buffer, GL_ELEMENT_ARRAY_BUFFER);
+        deferDelete(DeferredDelete::Type::BUFFER, ib->gl.buffer, GL_ELEMENT_ARRAY_BUFFER);
         destruct(ibh, ib);
     }
 }
@@ -1617,7 +1628,7 @@ void OpenGLDriver::destroyBufferObject(Handle<HwBufferObject> boh) {
         if (UTILS_UNLIKELY(bo->bindingType == BufferObjectBinding::UNIFORM && gl.isES2())) {
             free(bo->gl.buffer);
         } else {
-            gl.deleteBuffers(1, &bo->gl.id, bo->gl.binding);
+            deferDelete(DeferredDelete::Type::BUFFER, bo->gl.id, bo->gl.binding);
         }
         destruct(boh, bo);
     }
@@ -1683,14 +1694,14 @@ void OpenGLDriver::destroyTexture(Handle<HwTexture> th) {
                 if (UTILS_UNLIKELY(t->target == SamplerType::SAMPLER_EXTERNAL)) {
                     mPlatform.destroyExternalImage(t->externalTexture);
                 } else {
-                    glDeleteTextures(1, &t->gl.id);
+                    deferDelete(DeferredDelete::Type::TEXTURE, t->gl.id);
                 }
             } else {
                 assert_invariant(t->gl.target == GL_RENDERBUFFER);
-                glDeleteRenderbuffers(1, &t->gl.id);
+                deferDelete(DeferredDelete::Type::RENDERBUFFER, t->gl.id);
             }
             if (t->gl.sidecarRenderBufferMS) {
-                glDeleteRenderbuffers(1, &t->gl.sidecarRenderBufferMS);
+                deferDelete(DeferredDelete::Type::RENDERBUFFER, t->gl.sidecarRenderBufferMS);
             }
         } else {
             gl.unbindTexture(t->gl.target, t->gl.id);
@@ -1773,6 +1784,12 @@ void OpenGLDriver::destroyStream(Handle<HwStream> sh) {
             mPlatform.destroyStream(s->stream);
         }
 
+        // give back the image we were holding on to, so the producer can recycle it. The user
+        // thread doesn't access this stream anymore at this point.
+        if (s->streamType == StreamType::ACQUIRED && s->user_thread.acquired.image) {
+            releaseAcquiredImage(s->user_thread.acquired);
+        }
+
         // finally destroy the HwStream handle
         destruct(sh, s);
     }
@@ -1863,7 +1880,7 @@ void OpenGLDriver::updateStreams(DriverApi* driver) {
                 }
 
                 if (previousImage.image) {
-                    scheduleRelease(AcquiredImage(previousImage));
+                    releaseAcquiredImage(previousImage);
                 }
             });
         }
@@ -1871,6 +1888,21 @@ void OpenGLDriver::updateStreams(DriverApi* driver) {
     }
 }
 
+void OpenGLDriver::releaseAcquiredImage(AcquiredImage const& image) noexcept {
+#ifndef FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2
+    if (UTILS_LIKELY(!mContext.isES2())) {
+        // The image can still be sampled by the commands of the previous frame, which might not
+        // have executed yet. Only hand it back once they're complete, so the producer can write
+        // into it again without tearing, and without us having to copy it.
+        whenGpuCommandsComplete([this, image]() {
+            scheduleRelease(image);
+        });
+        return;
+    }
+#endif
+    scheduleRelease(image);
+}
+
 void OpenGLDriver::setStreamDimensions(Handle<HwStream> sh, uint32_t width, uint32_t height) {
     if (sh) {
         GLStream* s = handle_cast<GLStream*>(sh);
@@ -2131,6 +2163,29 @@ bool OpenGLDriver::isDepthClampSupported() {
     return getContext().ext.EXT_depth_clamp;
 }
 
+bool OpenGLDriver::isVariableRateShadingSupported() {
+    return false;
+}
+
+bool OpenGLDriver::isDrawIndirectSupported() {
+    // indirect draws are core in ES3.1 and GL4.0, but the arguments are only useful if they
+    // can be written by a compute shader, which requires GL4.3.
+#if defined(BACKEND_OPENGL_LEVEL_GLES31)
+    auto const& gl = getContext();
+    return gl.isAtLeastGLES<3, 1>() || gl.isAtLeastGL<4, 3>();
+#else
+    // draw2Indirect() is compiled out without the GLES 3.1 entry points
+    return false;
+#endif
+}
+
+size_t OpenGLDriver::getAllocatedMemorySize() {
+    // GL has no portable way to query this, and the vendor extensions that do
+    // (GL_NVX_gpu_memory_info, GL_ATI_meminfo) need the context to be current on the calling
+    // thread.
+    return 0;
+}
+
 bool OpenGLDriver::isWorkaroundNeeded(Workaround workaround) {
     switch (workaround) {
         case Workaround::SPLIT_EASU:
@@ -2319,31 +2374,32 @@ void OpenGLDriver::updateBufferObjectUnsynchronized(
         assert_invariant(bo->gl.id);
         assert_invariant(bd.size + byteOffset <= bo->byteCount);
 
-        if (bo->gl.binding != GL_UNIFORM_BUFFER) {
-            // TODO: use updateBuffer() for all types of buffer? Make sure GL supports that.
-            updateBufferObject(boh, std::move(bd), byteOffset);
-        } else {
-            auto& gl = mContext;
-            gl.bindBuffer(bo->gl.binding, bo->gl.id);
+        auto& gl = mContext;
+        if (bo->gl.binding == GL_ARRAY_BUFFER) {
+            gl.bindVertexArray(nullptr);
+        }
+        // mapping unsynchronized never waits for the GPU, unlike glBufferSubData() which
+        // can stall on some drivers when the buffer is still in use. This is also valid
+        // for vertex and index data (e.g. streamed every frame into different ranges).
+        gl.bindBuffer(bo->gl.binding, bo->gl.id);
 retry:
-            void* const vaddr = glMapBufferRange(bo->gl.binding, byteOffset, (GLsizeiptr)bd.size,
-                    GL_MAP_WRITE_BIT |
-                    GL_MAP_INVALIDATE_RANGE_BIT |
-                    GL_MAP_UNSYNCHRONIZED_BIT);
-            if (UTILS_LIKELY(vaddr)) {
-                memcpy(vaddr, bd.buffer, bd.size);
-                if (UTILS_UNLIKELY(glUnmapBuffer(bo->gl.binding) == GL_FALSE)) {
-                    // According to the spec, UnmapBuffer can return FALSE in rare conditions (e.g.
-                    // during a screen mode change). Note that this is not a GL error, and we can handle
-                    // it by simply making a second attempt.
-                    goto retry; // NOLINT(cppcoreguidelines-avoid-goto,hicpp-avoid-goto)
-                }
-            } else {
-                // handle mapping error, revert to glBufferSubData()
-                glBufferSubData(bo->gl.binding, byteOffset, (GLsizeiptr)bd.size, bd.buffer);
+        void* const vaddr = glMapBufferRange(bo->gl.binding, byteOffset, (GLsizeiptr)bd.size,
+                GL_MAP_WRITE_BIT |
+                GL_MAP_INVALIDATE_RANGE_BIT |
+                GL_MAP_UNSYNCHRONIZED_BIT);
+        if (UTILS_LIKELY(vaddr)) {
+            memcpy(vaddr, bd.buffer, bd.size);
+            if (UTILS_UNLIKELY(glUnmapBuffer(bo->gl.binding) == GL_FALSE)) {
+                // According to the spec, UnmapBuffer can return FALSE in rare conditions (e.g.
+                // during a screen mode change). Note that this is not a GL error, and we can handle
+                // it by simply making a second attempt.
+                goto retry; // NOLINT(cppcoreguidelines-avoid-goto,hicpp-avoid-goto)
             }
-            scheduleDestroy(std::move(bd));
+        } else {
+            // handle mapping error, revert to glBufferSubData()
+            glBufferSubData(bo->gl.binding, byteOffset, (GLsizeiptr)bd.size, bd.buffer);
         }
+        scheduleDestroy(std::move(bd));
     }
     CHECK_GL_ERROR(utils::slog.e)
 #endif
@@ -2564,8 +2620,36 @@ void OpenGLDriver::setTextureData(GLTexture* t, uint32_t level,
     size_t const bpp = PBD::computeDataSize(p.format, p.type, 1, 1, 1);
     size_t const bpr = PBD::computeDataSize(p.format, p.type, stride, 1, p.alignment);
     size_t const bpl = bpr * height; // TODO: PBD should have a "layer stride"
-    void const* const buffer = static_cast<char const*>(p.buffer)
-            + bpp* p.left + bpr * p.top + bpl * 0; // TODO: PBD should have a p.depth
+    size_t const offset = bpp* p.left + bpr * p.top + bpl * 0; // TODO: PBD should have a p.depth
+    void const* buffer = static_cast<char const*>(p.buffer) + offset;
+
+#ifndef FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2
+    // Large uploads are copied into a pixel unpack buffer first. glTexSubImage*() then only
+    // schedules the copy into the texture, instead of blocking until the data is converted to
+    // the texture's layout, or until the GPU is done with the texture.
+    PixelBuffer pbo;
+    if (!gl.isES2() && p.size >= MIN_UPLOAD_BUFFER_SIZE) {
+        pbo = acquireUploadBuffer(GLsizeiptr(p.size));
+#if defined(__EMSCRIPTEN__)
+        glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(p.size), p.buffer);
+        buffer = reinterpret_cast<void const*>(uintptr_t(offset));
+#else
+        // buffers in the pool aren't used by the GPU anymore, no need to synchronize
+        void* const vaddr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(p.size),
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (UTILS_LIKELY(vaddr)) {
+            memcpy(vaddr, p.buffer, p.size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            buffer = reinterpret_cast<void const*>(uintptr_t(offset));
+        } else {
+            // upload from client memory instead
+            gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            releaseUploadBuffer(pbo);
+            pbo = {};
+        }
+#endif
+    }
+#endif
 
     switch (t->target) {
         case SamplerType::SAMPLER_EXTERNAL:
@@ -2629,6 +2713,13 @@ void OpenGLDriver::setTextureData(GLTexture* t, uint32_t level,
     }
 
 #ifndef FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2
+    if (pbo.id) {
+        gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        whenGpuCommandsComplete([this, pbo]() {
+            releaseUploadBuffer(pbo);
+        });
+    }
+
     if (!gl.isES2()) {
         // Update the base/max LOD, so we don't access undefined LOD. this allows the app to
         // specify levels as they become available.
@@ -3326,10 +3417,7 @@ void OpenGLDriver::readPixels(Handle<HwRenderTarget> src,
     // which we're always emulating. So if we have a resolved fbo (fbo_read), use that instead.
     gl.bindFramebuffer(GL_READ_FRAMEBUFFER, s->gl.fbo_read ? s->gl.fbo_read : s->gl.fbo);
 
-    GLuint pbo;
-    glGenBuffers(1, &pbo);
-    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
-    glBufferData(GL_PIXEL_PACK_BUFFER, pboSize, nullptr, GL_STATIC_DRAW);
+    PixelBuffer const pbo = acquireReadbackBuffer(pboSize);
     glReadPixels(GLint(x), GLint(y), GLint(width), GLint(height), glFormat, glType, nullptr);
     gl.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
     CHECK_GL_ERROR(utils::slog.e)
@@ -3340,7 +3428,7 @@ void OpenGLDriver::readPixels(Handle<HwRenderTarget> src,
     whenGpuCommandsComplete([this, width, height, pbo, pboSize, pUserBuffer]() mutable {
         PixelBufferDescriptor& p = *pUserBuffer;
         auto& gl = mContext;
-        gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbo.id);
         void* vaddr = nullptr;
 #if defined(__EMSCRIPTEN__)
         std::unique_ptr<uint8_t[]> clientBuffer = std::make_unique<uint8_t[]>(pboSize);
@@ -3369,7 +3457,7 @@ void OpenGLDriver::readPixels(Handle<HwRenderTarget> src,
 #endif
         }
         gl.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-        glDeleteBuffers(1, &pbo);
+        releaseReadbackBuffer(pbo);
         scheduleDestroy(std::move(p));
         delete pUserBuffer;
         CHECK_GL_ERROR(utils::slog.e)
@@ -3389,10 +3477,7 @@ void OpenGLDriver::readBufferSubData(backend::BufferObjectHandle boh,
     if constexpr (true) {
         // schedule a copy of the buffer we're reading into a PBO, this *should* happen
         // asynchronously without stalling the CPU.
-        GLuint pbo;
-        glGenBuffers(1, &pbo);
-        gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
-        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, nullptr, GL_STATIC_DRAW);
+        PixelBuffer const pbo = acquireReadbackBuffer((GLsizeiptr)size);
         gl.bindBuffer(bo->gl.binding, bo->gl.id);
         glCopyBufferSubData(bo->gl.binding, GL_PIXEL_PACK_BUFFER, offset, 0, size);
         gl.bindBuffer(bo->gl.binding, 0);
@@ -3404,14 +3489,14 @@ void OpenGLDriver::readBufferSubData(backend::BufferObjectHandle boh,
         whenGpuCommandsComplete([this, size, pbo, pUserBuffer]() mutable {
             BufferDescriptor& p = *pUserBuffer;
             auto& gl = mContext;
-            gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+            gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbo.id);
             void* vaddr = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
             if (vaddr) {
                 memcpy(p.buffer, vaddr, size);
                 glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
             }
             gl.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-            glDeleteBuffers(1, &pbo);
+            releaseReadbackBuffer(pbo);
             scheduleDestroy(std::move(p));
             delete pUserBuffer;
             CHECK_GL_ERROR(utils::slog.e)
@@ -3433,6 +3518,106 @@ void OpenGLDriver::readBufferSubData(backend::BufferObjectHandle boh,
 }
 
 
+#ifndef FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2
+OpenGLDriver::PixelBuffer OpenGLDriver::acquirePixelBuffer(std::vector<PixelBuffer>& pool,
+        GLenum target, GLenum usage, GLsizeiptr size) noexcept {
+    auto& gl = mContext;
+    auto& v = pool;
+
+    // use the smallest free buffer that is large enough
+    auto best = v.end();
+    for (auto it = v.begin(); it != v.end(); ++it) {
+        if (it->size >= size && (best == v.end() || it->size < best->size)) {
+            best = it;
+        }
+    }
+
+    PixelBuffer buffer;
+    if (best != v.end()) {
+        buffer = *best;
+        v.erase(best);
+        gl.bindBuffer(target, buffer.id);
+    } else {
+        buffer.size = size;
+        glGenBuffers(1, &buffer.id);
+        gl.bindBuffer(target, buffer.id);
+        glBufferData(target, size, nullptr, usage);
+    }
+    return buffer;
+}
+
+void OpenGLDriver::releasePixelBuffer(std::vector<PixelBuffer>& pool,
+        PixelBuffer buffer) noexcept {
+    auto& v = pool;
+    if (v.size() == MAX_PIXEL_BUFFER_COUNT) {
+        // evict the smallest buffer, keeping the large ones avoids reallocating for big transfers
+        auto smallest = std::min_element(v.begin(), v.end(),
+                [](PixelBuffer const& lhs, PixelBuffer const& rhs) {
+                    return lhs.size < rhs.size;
+                });
+        if (smallest->size >= buffer.size) {
+            glDeleteBuffers(1, &buffer.id);
+            return;
+        }
+        glDeleteBuffers(1, &smallest->id);
+        *smallest = buffer;
+        return;
+    }
+    v.push_back(buffer);
+}
+#endif
+
+void OpenGLDriver::deferDelete(
+        DeferredDelete::Type type, GLuint id, GLenum target) noexcept {
+    // The name can't be returned by glGen*() until it's deleted, so keeping it around is safe.
+    // Textures are unbound by the caller, and a buffer stays consistent with the state cache
+    // until it is actually deleted.
+    DeferredDelete const item{ id, target, type };
+    if (mDriverConfig.deferredDestructionBudgetUs) {
+        mDeferredDeletes.push_back(item);
+    } else {
+        executeDeferredDelete(item);
+    }
+}
+
+void OpenGLDriver::executeDeferredDelete(DeferredDelete const& item) noexcept {
+    switch (item.type) {
+        case DeferredDelete::Type::TEXTURE:
+            glDeleteTextures(1, &item.id);
+            break;
+        case DeferredDelete::Type::RENDERBUFFER:
+            glDeleteRenderbuffers(1, &item.id);
+            break;
+        case DeferredDelete::Type::BUFFER:
+            mContext.deleteBuffers(1, &item.id, item.target);
+            break;
+    }
+}
+
+void OpenGLDriver::executeDeferredDeletes(bool all) noexcept {
+    auto& v = mDeferredDeletes;
+    if (UTILS_LIKELY(v.empty())) {
+        return;
+    }
+
+    SYSTRACE_CALL();
+
+    using clock = std::chrono::steady_clock;
+    auto const deadline = clock::now() +
+            std::chrono::microseconds(mDriverConfig.deferredDestructionBudgetUs);
+
+    // Always delete at least one batch so that we make progress, and don't read the clock
+    // after every object. The order doesn't matter, so we pop from the back.
+    constexpr size_t BATCH_SIZE = 8;
+    do {
+        size_t const count = std::min(v.size(), BATCH_SIZE);
+        for (size_t i = 0; i < count; i++) {
+            executeDeferredDelete(v.back());
+            v.pop_back();
+        }
+    } while (!v.empty() && (all || clock::now() < deadline));
+}
+
 void OpenGLDriver::runEveryNowAndThen(std::function<bool()> fn) noexcept {
     mEveryNowAndThenOps.push_back(std::move(fn));
 }
@@ -3499,6 +3684,7 @@ void OpenGLDriver::tick(int) {
     executeGpuCommandsCompleteOps();
 #endif
     executeEveryNowAndThenOps();
+    executeDeferredDeletes(false);
     getShaderCompilerService().tick();
 }
 
@@ -3975,6 +4161,53 @@ void OpenGLDriver::draw2GLES2(uint32_t indexOffset, uint32_t indexCount, uint32_
             reinterpret_cast<const void*>(indexOffset * rp->gl.indicesSize));
 
 
+#if FILAMENT_ENABLE_MATDBG
+    CHECK_GL_ERROR_NON_FATAL(utils::slog.e)
+#else
+    CHECK_GL_ERROR(utils::slog.e)
+#endif
+}
+
+void OpenGLDriver::draw2Indirect(Handle<HwBufferObject> ibh, uint32_t byteOffset,
+        uint32_t drawCount, uint32_t byteStride) {
+    DEBUG_MARKER()
+    GLRenderPrimitive const* const rp = mBoundRenderPrimitive;
+    if (UTILS_UNLIKELY(!rp || !mValidProgram)) {
+        return;
+    }
+
+#if defined(BACKEND_OPENGL_LEVEL_GLES31)
+
+#if defined(__ANDROID__)
+    // on Android, GLES3.1 and above entry-points are defined in glext
+    // (this is temporary, until we phase-out API < 21)
+    using glext::glDrawElementsIndirect;
+#endif
+
+    assert_invariant(byteStride >= sizeof(DrawIndexedIndirectCommand));
+
+    GLBufferObject const* const bo = handle_cast<const GLBufferObject*>(ibh);
+    mContext.bindBuffer(GL_DRAW_INDIRECT_BUFFER, bo->gl.id);
+
+#if defined(BACKEND_OPENGL_VERSION_GL)
+    // GL 4.3 can submit all the draws at once
+    if (mContext.isAtLeastGL<4, 3>()) {
+        glMultiDrawElementsIndirect(GLenum(rp->type), rp->gl.getIndicesType(),
+                reinterpret_cast<const void*>(uintptr_t(byteOffset)),
+                GLsizei(drawCount), GLsizei(byteStride));
+        CHECK_GL_ERROR(utils::slog.e)
+        return;
+    }
+#endif
+
+    // GLES doesn't have glMultiDrawElementsIndirect, so we issue each draw separately. This is
+    // still much cheaper than a regular draw, because the arguments never leave the GPU.
+    for (uint32_t i = 0; i < drawCount; i++) {
+        glDrawElementsIndirect(GLenum(rp->type), rp->gl.getIndicesType(),
+                reinterpret_cast<const void*>(uintptr_t(byteOffset + i * byteStride)));
+    }
+#endif // BACKEND_OPENGL_LEVEL_GLES31
+
 #if FILAMENT_ENABLE_MATDBG
     CHECK_GL_ERROR_NON_FATAL(utils::slog.e)
 #else
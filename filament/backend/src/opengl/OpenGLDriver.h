@@ -359,6 +359,9 @@ private:
     void detachStream(GLTexture* t) noexcept;
     void replaceStream(GLTexture* t, GLStream* stream) noexcept;
 
+    // returns an acquired image to its owner once the GPU is done with it
+    void releaseAcquiredImage(AcquiredImage const& image) noexcept;
+
     void updateTextureLodRange(GLTexture* texture, int8_t targetLevel) noexcept;
 
 #ifndef FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2
@@ -369,8 +372,53 @@ private:
 
     void whenFrameComplete(const std::function<void()>& fn) noexcept;
     std::vector<std::function<void()>> mFrameCompleteOps;
+
+    // Pixel buffers are recycled once the GPU is done with them, so readbacks and uploads
+    // don't create a new buffer each time.
+    struct PixelBuffer {
+        GLuint id = 0;
+        GLsizeiptr size = 0;
+    };
+    static constexpr size_t MAX_PIXEL_BUFFER_COUNT = 4;
+    // returns a buffer of at least `size` bytes from the pool, bound to `target`
+    PixelBuffer acquirePixelBuffer(std::vector<PixelBuffer>& pool,
+            GLenum target, GLenum usage, GLsizeiptr size) noexcept;
+    void releasePixelBuffer(std::vector<PixelBuffer>& pool, PixelBuffer buffer) noexcept;
+
+    // pixel pack buffers used by readPixels() and readBufferSubData()
+    PixelBuffer acquireReadbackBuffer(GLsizeiptr size) noexcept {
+        return acquirePixelBuffer(mReadbackBuffers, GL_PIXEL_PACK_BUFFER, GL_STREAM_READ, size);
+    }
+    void releaseReadbackBuffer(PixelBuffer buffer) noexcept {
+        releasePixelBuffer(mReadbackBuffers, buffer);
+    }
+    std::vector<PixelBuffer> mReadbackBuffers;
+
+    // pixel unpack buffers used by setTextureData() for uploads of at least
+    // MIN_UPLOAD_BUFFER_SIZE bytes
+    static constexpr size_t MIN_UPLOAD_BUFFER_SIZE = 64 * 1024;
+    PixelBuffer acquireUploadBuffer(GLsizeiptr size) noexcept {
+        return acquirePixelBuffer(mUploadBuffers, GL_PIXEL_UNPACK_BUFFER, GL_STREAM_DRAW, size);
+    }
+    void releaseUploadBuffer(PixelBuffer buffer) noexcept {
+        releasePixelBuffer(mUploadBuffers, buffer);
+    }
+    std::vector<PixelBuffer> mUploadBuffers;
 #endif
 
+    // GL objects of destroyed textures and buffers, their deletion (which is what frees the
+    // memory) is spread over several frames, see DriverConfig::deferredDestructionBudgetUs.
+    struct DeferredDelete {
+        enum class Type : uint8_t { TEXTURE, RENDERBUFFER, BUFFER };
+        GLuint id;
+        GLenum target;  // only used by BUFFER
+        Type type;
+    };
+    void deferDelete(DeferredDelete::Type type, GLuint id, GLenum target = 0) noexcept;
+    void executeDeferredDelete(DeferredDelete const& item) noexcept;
+    void executeDeferredDeletes(bool all) noexcept;
+    std::vector<DeferredDelete> mDeferredDeletes;
+
     // tasks regularly executed on the main thread at until they return true
     void runEveryNowAndThen(std::function<bool()> fn) noexcept;
     void executeEveryNowAndThenOps() noexcept;
@@ -34,6 +34,7 @@
 #include <utils/Panic.h>
 #include <utils/Systrace.h>
 
+#include <algorithm>
 #include <array>
 #include <cctype>
 #include <chrono>
@@ -198,7 +199,7 @@ void ShaderCompilerService::init() noexcept {
         //   How many threads should we use?
         // - on macOS (M1 MacBook Pro/Ventura) there is global lock around all GL APIs when using
         //   a shared context, so parallel shader compilation yields no benefit.
-        // - on windows/linux we could use more threads, tbd.
+        // - desktop drivers on windows/linux compile and link concurrently on shared contexts.
 
         // By default, we use one thread at the same priority as the gl thread. This is the
         // safest choice that avoids priority inversions.
@@ -219,9 +220,21 @@ void ShaderCompilerService::init() noexcept {
             // Angle shared contexts are not expensive once we have two.
             poolSize = (std::thread::hardware_concurrency() + 1) / 2;
             priority = JobSystem::Priority::BACKGROUND;
+        } else if (mDriver.getContext().isAtLeastGL<4, 1>() && !strstr(renderer, "Apple")) {
+            // Same for desktop drivers, we leave half the cores for the application and the
+            // jobs queued by the main thread.
+            poolSize = (std::thread::hardware_concurrency() + 1) / 2;
+            priority = JobSystem::Priority::BACKGROUND;
+        }
+
+        // the user always has the last word
+        uint32_t const requestedPoolSize = mDriver.getDriverConfig().shaderCompilerThreadCount;
+        if (requestedPoolSize) {
+            poolSize = requestedPoolSize;
+            priority = poolSize > 1 ? JobSystem::Priority::BACKGROUND : JobSystem::Priority::DISPLAY;
         }
 
-        mShaderCompilerThreadCount = poolSize;
+        mShaderCompilerThreadCount = std::max(poolSize, 1u);
         mCompilerThreadPool.init(mShaderCompilerThreadCount,
                 [&platform = mDriver.mPlatform, priority]() {
                     // give the thread a name
@@ -260,18 +273,25 @@ ShaderCompilerService::program_token_t ShaderCompilerService::createProgram(
         token->attributes = std::move(program.getAttributes());
     }
 
-    token->gl.program = mBlobCache.retrieve(&token->key, mDriver.mPlatform, program);
-    if (token->gl.program) {
-        return token;
-    }
-
-    token->handle = mCallbackManager.get();
-
     CompilerPriorityQueue const priorityQueue = program.getPriorityQueue();
     if (mMode == Mode::THREAD_POOL) {
-        // queue a compile job
+        token->handle = mCallbackManager.get();
+
+        // queue a job, which starts with the cache lookup, so that warming-up many programs
+        // (i.e. Material::compile()) doesn't retrieve their binaries one by one on this thread.
         mCompilerThreadPool.queue(priorityQueue, token,
                 [this, &gl, program = std::move(program), token]() mutable {
+                    // try the cache first
+                    GLuint const cachedProgram = mBlobCache.retrieve(
+                            &token->key, mDriver.mPlatform, program);
+                    if (cachedProgram) {
+                        OpenGLProgramToken::ProgramData programData;
+                        programData.program = cachedProgram;
+                        token->set(programData);
+                        mCallbackManager.put(token->handle);
+                        return;
+                    }
+
                     // compile the shaders
                     std::array<GLuint, Program::SHADER_TYPE_COUNT> shaders{};
                     compileShaders(gl,
@@ -308,6 +328,13 @@ ShaderCompilerService::program_token_t ShaderCompilerService::createProgram(
                 });
 
     } else {
+        token->gl.program = mBlobCache.retrieve(&token->key, mDriver.mPlatform, program);
+        if (token->gl.program) {
+            return token;
+        }
+
+        token->handle = mCallbackManager.get();
+
         // this cannot fail because we check compilation status after linking the program
         // shaders[] is filled with id of shader stages present.
         compileShaders(gl,
@@ -156,6 +156,7 @@ extern PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC glFramebufferTextureMultiviewOVR;
 #endif
 #if defined(__ANDROID__) && !defined(FILAMENT_SILENCE_NOT_SUPPORTED_BY_ES2)
 extern PFNGLDISPATCHCOMPUTEPROC glDispatchCompute;
+extern PFNGLDRAWELEMENTSINDIRECTPROC glDrawElementsIndirect;
 #endif
 #endif // __EMSCRIPTEN__
 } // namespace glext
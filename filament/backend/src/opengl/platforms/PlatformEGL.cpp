@@ -35,10 +35,12 @@
 #include <utils/debug.h>
 #include <utils/Invocable.h>
 #include <utils/Log.h>
+#include <utils/Mutex.h>
 #include <utils/ostream.h>
 
 #include <algorithm>
 #include <new>
+#include <mutex>
 #include <initializer_list>
 #include <utility>
 
@@ -346,6 +348,7 @@ void PlatformEGL::createContext(bool shared) {
 
     eglMakeCurrent(mEGLDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
 
+    std::lock_guard<utils::Mutex> const lock(mAdditionalContextsLock);
     mAdditionalContexts.push_back(context);
 }
 
@@ -356,11 +359,14 @@ void PlatformEGL::releaseContext() noexcept {
         eglDestroyContext(mEGLDisplay, context);
     }
 
-    mAdditionalContexts.erase(
-            std::remove_if(mAdditionalContexts.begin(), mAdditionalContexts.end(),
-                    [context](EGLContext c) {
-                        return c == context;
-                    }), mAdditionalContexts.end());
+    {
+        std::lock_guard<utils::Mutex> const lock(mAdditionalContextsLock);
+        mAdditionalContexts.erase(
+                std::remove_if(mAdditionalContexts.begin(), mAdditionalContexts.end(),
+                        [context](EGLContext c) {
+                            return c == context;
+                        }), mAdditionalContexts.end());
+    }
 
     eglReleaseThread();
 }
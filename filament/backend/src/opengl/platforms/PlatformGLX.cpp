@@ -16,13 +16,19 @@
 
 #include <backend/platforms/PlatformGLX.h>
 
+#include <utils/compiler.h>
+#include <utils/debug.h>
 #include <utils/Log.h>
+#include <utils/Mutex.h>
 #include <utils/Panic.h>
 
 #include <X11/Xlib.h>
 #include <GL/glx.h>
 #include <GL/glxext.h>
 
+#include <algorithm>
+#include <mutex>
+
 #include <dlfcn.h>
 
 #define LIBRARY_GLX "libGL.so.1"
@@ -34,6 +40,7 @@ typedef Display* (* X11_CLOSE_DISPLAY)(Display*);
 
 // Function pointer types for GLX functions
 typedef void (* GLX_DESTROY_CONTEXT)(Display*, GLXContext);
+typedef GLXContext (* GLX_GET_CURRENT_CONTEXT)();
 typedef void (* GLX_SWAP_BUFFERS)(Display* dpy, GLXDrawable drawable);
 // Stores GLX function pointers and a handle to the system's GLX library
 struct GLXFunctions {
@@ -68,6 +75,7 @@ struct GLXFunctions {
     PFNGLXGETFBCONFIGATTRIBPROC getFbConfigAttrib;
 
     GLX_DESTROY_CONTEXT destroyContext;
+    GLX_GET_CURRENT_CONTEXT getCurrentContext;
     GLX_SWAP_BUFFERS swapBuffers;
     void* library;
 } g_glx;
@@ -103,6 +111,8 @@ static bool loadLibraries() {
             getProcAddress((const GLubyte*)"glXMakeContextCurrent");
     g_glx.destroyContext = (GLX_DESTROY_CONTEXT)
             getProcAddress((const GLubyte*)"glXDestroyContext");
+    g_glx.getCurrentContext = (GLX_GET_CURRENT_CONTEXT)
+            getProcAddress((const GLubyte*)"glXGetCurrentContext");
     g_glx.swapBuffers = (GLX_SWAP_BUFFERS)
             getProcAddress((const GLubyte*)"glXSwapBuffers");
 
@@ -128,6 +138,18 @@ namespace filament::backend {
 
 using namespace backend;
 
+static int const sContextAttribs[] = {
+        GLX_CONTEXT_MAJOR_VERSION_ARB, 4,
+        GLX_CONTEXT_MINOR_VERSION_ARB, 1,
+        GL_NONE
+};
+
+static int const sDummyPbufferAttribs[] = {
+        GLX_PBUFFER_WIDTH, 1,
+        GLX_PBUFFER_HEIGHT, 1,
+        GL_NONE
+};
+
 Driver* PlatformGLX::createDriver(void* const sharedGLContext,
         const DriverConfig& driverConfig) noexcept {
     loadLibraries();
@@ -207,22 +229,10 @@ Driver* PlatformGLX::createDriver(void* const sharedGLContext,
         return nullptr;
     }
 
-    int contextAttribs[] = {
-            GLX_CONTEXT_MAJOR_VERSION_ARB, 4,
-            GLX_CONTEXT_MINOR_VERSION_ARB, 1,
-            GL_NONE
-    };
-
     mGLXContext = g_glx.createContext(mGLXDisplay, mGLXConfig[0],
-            (GLXContext)sharedGLContext, True, contextAttribs);
+            (GLXContext)sharedGLContext, True, sContextAttribs);
 
-    int pbufferAttribs[] = {
-            GLX_PBUFFER_WIDTH, 1,
-            GLX_PBUFFER_HEIGHT, 1,
-            GL_NONE
-    };
-
-    mDummySurface = g_glx.createPbuffer(mGLXDisplay, mGLXConfig[0], pbufferAttribs);
+    mDummySurface = g_glx.createPbuffer(mGLXDisplay, mGLXConfig[0], sDummyPbufferAttribs);
     g_glx.setCurrentContext(mGLXDisplay, mDummySurface, mDummySurface, mGLXContext);
 
     int result = bluegl::bind();
@@ -231,8 +241,51 @@ Driver* PlatformGLX::createDriver(void* const sharedGLContext,
     return OpenGLPlatform::createDefaultDriver(this, sharedGLContext, driverConfig);
 }
 
+bool PlatformGLX::isExtraContextSupported() const noexcept {
+    return mGLXContext != nullptr && g_glx.getCurrentContext != nullptr;
+}
+
+void PlatformGLX::createContext(bool shared) {
+    // The compiler threads call this concurrently. Besides protecting mAdditionalContexts, the
+    // lock serializes these calls on our Display connection, which is private to this platform.
+    std::lock_guard<utils::Mutex> const lock(mAdditionalContextsLock);
+
+    GLXContext const context = g_glx.createContext(mGLXDisplay, mGLXConfig[0],
+            shared ? mGLXContext : nullptr, True, sContextAttribs);
+    if (UTILS_UNLIKELY(!context)) {
+        utils::slog.e << "glXCreateContextAttribsARB() failed" << utils::io::endl;
+    }
+    assert_invariant(context);
+
+    GLXPbuffer const surface = g_glx.createPbuffer(mGLXDisplay, mGLXConfig[0],
+            sDummyPbufferAttribs);
+    g_glx.setCurrentContext(mGLXDisplay, surface, surface, context);
+
+    mAdditionalContexts.emplace_back(context, surface);
+}
+
+void PlatformGLX::releaseContext() noexcept {
+    std::lock_guard<utils::Mutex> const lock(mAdditionalContextsLock);
+
+    GLXContext const context = g_glx.getCurrentContext();
+    g_glx.setCurrentContext(mGLXDisplay, None, None, nullptr);
+
+    auto const pos = std::find_if(mAdditionalContexts.begin(), mAdditionalContexts.end(),
+            [context](auto const& item) { return item.first == context; });
+    if (pos != mAdditionalContexts.end()) {
+        g_glx.destroyPbuffer(mGLXDisplay, pos->second);
+        g_glx.destroyContext(mGLXDisplay, pos->first);
+        mAdditionalContexts.erase(pos);
+    }
+}
+
 void PlatformGLX::terminate() noexcept {
     g_glx.setCurrentContext(mGLXDisplay, None, None, nullptr);
+    for (auto const& [context, surface] : mAdditionalContexts) {
+        g_glx.destroyPbuffer(mGLXDisplay, surface);
+        g_glx.destroyContext(mGLXDisplay, context);
+    }
+    mAdditionalContexts.clear();
     g_glx.destroyPbuffer(mGLXDisplay, mDummySurface);
     g_glx.destroyContext(mGLXDisplay, mGLXContext);
     g_x11.closeDisplay(mGLXDisplay);
@@ -32,9 +32,15 @@
 #include "GL/glext.h"
 #include "GL/wglext.h"
 
+#include <utils/compiler.h>
+#include <utils/debug.h>
 #include <utils/Log.h>
+#include <utils/Mutex.h>
 #include <utils/Panic.h>
 
+#include <algorithm>
+#include <mutex>
+
 namespace {
 
 void reportLastWindowsError() {
@@ -168,15 +174,38 @@ error:
 }
 
 bool PlatformWGL::isExtraContextSupported() const noexcept {
-    return false;
+    // wglCreateContextAttribsARB is always available since we require it for the main context
+    return mContext != NULL;
 }
 
 void PlatformWGL::createContext(bool shared) {
+    // all contexts render to the dummy window's DC, which has the same pixel format
     HGLRC context = wglCreateContextAttribs(mWhdc, shared ? mContext : nullptr, mAttribs.data());
+    if (UTILS_UNLIKELY(!context)) {
+        utils::slog.e << "wglCreateContextAttribs() failed, whdc=" << mWhdc << utils::io::endl;
+        reportLastWindowsError();
+    }
+    assert_invariant(context);
+
     wglMakeCurrent(mWhdc, context);
+
+    std::lock_guard<utils::Mutex> const lock(mAdditionalContextsLock);
     mAdditionalContexts.push_back(context);
 }
 
+void PlatformWGL::releaseContext() noexcept {
+    HGLRC context = wglGetCurrentContext();
+    wglMakeCurrent(NULL, NULL);
+    if (context) {
+        wglDeleteContext(context);
+    }
+
+    std::lock_guard<utils::Mutex> const lock(mAdditionalContextsLock);
+    mAdditionalContexts.erase(
+            std::remove(mAdditionalContexts.begin(), mAdditionalContexts.end(), context),
+            mAdditionalContexts.end());
+}
+
 void PlatformWGL::terminate() noexcept {
     wglMakeCurrent(NULL, NULL);
     if (mContext) {
@@ -184,8 +213,9 @@ void PlatformWGL::terminate() noexcept {
         mContext = NULL;
     }
     for (auto& context : mAdditionalContexts) {
-        wglDeleteContext(mContext);
+        wglDeleteContext(context);
     }
+    mAdditionalContexts.clear();
     if (mHWnd && mWhdc) {
         ReleaseDC(mHWnd, mWhdc);
         DestroyWindow(mHWnd);
@@ -471,7 +471,8 @@ io::ostream& operator<<(io::ostream& out, RenderPassParams const& params) {
     << ", height=" << params.viewport.height
     << ", clearColor=" << params.clearColor
     << ", clearDepth=" << params.clearDepth
-    << ", clearStencil=" << params.clearStencil << "}";
+    << ", clearStencil=" << params.clearStencil
+    << ", shadingRate=" << uint32_t(params.shadingRate) << "}";
     return out;
 }
 
@@ -49,8 +49,11 @@ inline void blitFast(const VkCommandBuffer cmdbuffer, VkImageAspectFlags aspect,
     VulkanLayout oldSrcLayout = src.getLayout();
     VulkanLayout oldDstLayout = dst.getLayout();
 
-    src.texture->transitionLayout(cmdbuffer, srcRange, VulkanLayout::TRANSFER_SRC);
-    dst.texture->transitionLayout(cmdbuffer, dstRange, VulkanLayout::TRANSFER_DST);
+    {
+        imgutil::BarrierBatch barriers(cmdbuffer);
+        src.texture->transitionLayout(barriers, srcRange, VulkanLayout::TRANSFER_SRC);
+        dst.texture->transitionLayout(barriers, dstRange, VulkanLayout::TRANSFER_DST);
+    }
 
     const VkImageBlit blitRegions[1] = {{
             .srcSubresource = { aspect, src.level, src.layer, 1 },
@@ -69,8 +72,9 @@ inline void blitFast(const VkCommandBuffer cmdbuffer, VkImageAspectFlags aspect,
     if (oldDstLayout == VulkanLayout::UNDEFINED) {
         oldDstLayout = imgutil::getDefaultLayout(dst.texture->usage);
     }
-    src.texture->transitionLayout(cmdbuffer, srcRange, oldSrcLayout);
-    dst.texture->transitionLayout(cmdbuffer, dstRange, oldDstLayout);
+    imgutil::BarrierBatch barriers(cmdbuffer);
+    src.texture->transitionLayout(barriers, srcRange, oldSrcLayout);
+    dst.texture->transitionLayout(barriers, dstRange, oldDstLayout);
 }
 
 inline void resolveFast(const VkCommandBuffer cmdbuffer, VkImageAspectFlags aspect,
@@ -88,8 +92,11 @@ inline void resolveFast(const VkCommandBuffer cmdbuffer, VkImageAspectFlags aspe
     VulkanLayout oldSrcLayout = src.getLayout();
     VulkanLayout oldDstLayout = dst.getLayout();
 
-    src.texture->transitionLayout(cmdbuffer, srcRange, VulkanLayout::TRANSFER_SRC);
-    dst.texture->transitionLayout(cmdbuffer, dstRange, VulkanLayout::TRANSFER_DST);
+    {
+        imgutil::BarrierBatch barriers(cmdbuffer);
+        src.texture->transitionLayout(barriers, srcRange, VulkanLayout::TRANSFER_SRC);
+        dst.texture->transitionLayout(barriers, dstRange, VulkanLayout::TRANSFER_DST);
+    }
 
     assert_invariant(
             aspect != VK_IMAGE_ASPECT_DEPTH_BIT && "Resolve with depth is not yet supported.");
@@ -111,8 +118,9 @@ inline void resolveFast(const VkCommandBuffer cmdbuffer, VkImageAspectFlags aspe
     if (oldDstLayout == VulkanLayout::UNDEFINED) {
         oldDstLayout = imgutil::getDefaultLayout(dst.texture->usage);
     }
-    src.texture->transitionLayout(cmdbuffer, srcRange, oldSrcLayout);
-    dst.texture->transitionLayout(cmdbuffer, dstRange, oldDstLayout);
+    imgutil::BarrierBatch barriers(cmdbuffer);
+    src.texture->transitionLayout(barriers, srcRange, oldSrcLayout);
+    dst.texture->transitionLayout(barriers, dstRange, oldDstLayout);
 }
 
 struct BlitterUniforms {
@@ -181,6 +189,66 @@ void VulkanBlitter::blit(VkFilter filter,
     blitFast(cmdbuffer, aspect, filter, src, dst, srcRectPair, dstRectPair);
 }
 
+void VulkanBlitter::generateMipmaps(VulkanTexture* texture, uint8_t levelCount,
+        uint32_t layerCount) {
+    assert_invariant(levelCount > 1);
+
+    VkImageAspectFlags const aspect = texture->getImageAspect();
+    VulkanCommandBuffer& commands = mCommands->get();
+    VkCommandBuffer const cmdbuffer = commands.buffer();
+    commands.acquire(texture);
+
+    // remember the layouts to restore, all the layers of a level are expected to share theirs
+    VulkanLayout oldLayouts[16]; // HwTexture::levels is 4 bits
+    assert_invariant(levelCount <= 16);
+    for (uint8_t level = 0; level < levelCount; level++) {
+        VulkanLayout layout = texture->getLayout(0, level);
+        if (layout == VulkanLayout::UNDEFINED) {
+            layout = imgutil::getDefaultLayout(texture->usage);
+        }
+        oldLayouts[level] = layout;
+    }
+
+    // all the destination levels are transitioned at once, since they're entirely overwritten
+    texture->transitionLayout(cmdbuffer, { aspect, 0, 1, 0, layerCount },
+            VulkanLayout::TRANSFER_SRC);
+    texture->transitionLayout(cmdbuffer, { aspect, 1, uint32_t(levelCount - 1), 0, layerCount },
+            VulkanLayout::TRANSFER_DST);
+
+    int32_t srcw = int32_t(texture->width);
+    int32_t srch = int32_t(texture->height);
+    for (uint8_t level = 1; level < levelCount; level++) {
+        int32_t const dstw = std::max(srcw >> 1, 1);
+        int32_t const dsth = std::max(srch >> 1, 1);
+        const VkImageBlit blitRegions[1] = {{
+                .srcSubresource = { aspect, uint32_t(level - 1), 0, layerCount },
+                .srcOffsets = {{ 0, 0, 0 }, { srcw, srch, 1 }},
+                .dstSubresource = { aspect, level, 0, layerCount },
+                .dstOffsets = {{ 0, 0, 0 }, { dstw, dsth, 1 }},
+        }};
+        vkCmdBlitImage(cmdbuffer,
+                texture->getVkImage(), imgutil::getVkLayout(VulkanLayout::TRANSFER_SRC),
+                texture->getVkImage(), imgutil::getVkLayout(VulkanLayout::TRANSFER_DST),
+                1, blitRegions, VK_FILTER_LINEAR);
+
+        // this is also the barrier between writing this level and reading it for the next one
+        texture->transitionLayout(cmdbuffer, { aspect, level, 1, 0, layerCount },
+                VulkanLayout::TRANSFER_SRC);
+        srcw = dstw;
+        srch = dsth;
+    }
+
+    // restore the layouts, using one transition for each run of levels that share their layout
+    uint8_t first = 0;
+    for (uint8_t level = 1; level <= levelCount; level++) {
+        if (level == levelCount || oldLayouts[level] != oldLayouts[first]) {
+            texture->transitionLayout(cmdbuffer,
+                    { aspect, first, uint32_t(level - first), 0, layerCount }, oldLayouts[first]);
+            first = level;
+        }
+    }
+}
+
 void VulkanBlitter::terminate() noexcept {
 }
 
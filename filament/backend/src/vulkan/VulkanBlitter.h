@@ -30,6 +30,7 @@ class VulkanPipelineCache;
 class VulkanSamplerCache;
 
 struct VulkanProgram;
+struct VulkanTexture;
 
 class VulkanBlitter {
 public:
@@ -41,6 +42,10 @@ public:
 
     void resolve(VulkanAttachment dst, VulkanAttachment src);
 
+    // Generates levels [1, levelCount) of all the layers of a texture from level 0, with a
+    // single blit and a single layout transition per level.
+    void generateMipmaps(VulkanTexture* texture, uint8_t levelCount, uint32_t layerCount);
+
     void terminate() noexcept;
 
 private:
@@ -19,10 +19,29 @@
 
 #include <utils/Panic.h>
 
+#include <string.h>
+
 using namespace bluevk;
 
 namespace filament::backend {
 
+namespace {
+
+// On unified memory architectures all the memory is device-local, so buffers can be placed in
+// memory that is also host-visible at no cost for the GPU.
+bool isUnifiedMemoryArchitecture(VmaAllocator allocator) {
+    VkPhysicalDeviceMemoryProperties const* properties = nullptr;
+    vmaGetMemoryProperties(allocator, &properties);
+    for (uint32_t i = 0; i < properties->memoryHeapCount; i++) {
+        if (!(properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
 VulkanBuffer::VulkanBuffer(VmaAllocator allocator, VulkanStagePool& stagePool,
         VkBufferUsageFlags usage, uint32_t numBytes)
     : mAllocator(allocator),
@@ -30,9 +49,11 @@ VulkanBuffer::VulkanBuffer(VmaAllocator allocator, VulkanStagePool& stagePool,
       mUsage(usage),
 	  mUpdatedOffset(0),
       mUpdatedBytes(0) {
-    // for now make sure that only 1 bit is set in usage
+    // for now make sure that only 1 bit is set in usage, ignoring the indirect bit
     // (because loadFromCpu() assumes that somewhat)
-    assert_invariant(usage && !(usage & (usage - 1)));
+    UTILS_UNUSED_IN_RELEASE VkBufferUsageFlags const u =
+            usage & ~VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    assert_invariant(u && !(u & (u - 1)));
 
     // Create the VkBuffer.
     VkBufferCreateInfo bufferInfo {
@@ -42,7 +63,20 @@ VulkanBuffer::VulkanBuffer(VmaAllocator allocator, VulkanStagePool& stagePool,
     };
 
     VmaAllocationCreateInfo allocInfo { .usage = VMA_MEMORY_USAGE_GPU_ONLY };
-    vmaCreateBuffer(mAllocator, &bufferInfo, &allocInfo, &mGpuBuffer, &mGpuMemory, nullptr);
+    if (isUnifiedMemoryArchitecture(mAllocator)) {
+        // MAPPED_BIT is ignored if we don't end up with host-visible memory
+        allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        allocInfo.preferredFlags =
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    }
+    VmaAllocationInfo info{};
+    vmaCreateBuffer(mAllocator, &bufferInfo, &allocInfo, &mGpuBuffer, &mGpuMemory, &info);
+
+    VkMemoryPropertyFlags properties = 0;
+    vmaGetAllocationMemoryProperties(mAllocator, mGpuMemory, &properties);
+    if ((properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) && info.pMappedData) {
+        mMappedData = info.pMappedData;
+    }
 }
 
 VulkanBuffer::~VulkanBuffer() {
@@ -51,12 +85,20 @@ VulkanBuffer::~VulkanBuffer() {
 
 void VulkanBuffer::loadFromCpu(VkCommandBuffer cmdbuf, const void* cpuData, uint32_t byteOffset,
         uint32_t numBytes) {
-    VulkanStage const* stage = mStagePool.acquireStage(numBytes);
-    void* mapped;
-    vmaMapMemory(mAllocator, stage->memory, &mapped);
-    memcpy(mapped, cpuData, numBytes);
-    vmaUnmapMemory(mAllocator, stage->memory);
-    vmaFlushAllocation(mAllocator, stage->memory, byteOffset, numBytes);
+    if (mMappedData && !mLoaded) {
+        // The GPU has never seen the content of this buffer, so the first upload (typically the
+        // whole mesh) can be written in place, which skips the stage and the copy command.
+        // Coherent host writes are made visible to the device when the command buffer is
+        // submitted.
+        memcpy(static_cast<char*>(mMappedData) + byteOffset, cpuData, numBytes);
+        mLoaded = true;
+        mUpdatedOffset = byteOffset;
+        mUpdatedBytes = numBytes;
+        return;
+    }
+    mLoaded = true;
+
+    VulkanStageArea const stage = mStagePool.upload(cpuData, numBytes);
 
     // If there was a previous update, then we need to make sure the following write is properly
     // synced with the previous read.
@@ -89,15 +131,70 @@ void VulkanBuffer::loadFromCpu(VkCommandBuffer cmdbuf, const void* cpuData, uint
     }
 
     VkBufferCopy region {
-            .srcOffset = 0,
+            .srcOffset = stage.offset,
             .dstOffset = byteOffset,
             .size = numBytes,
     };
-    vkCmdCopyBuffer(cmdbuf, stage->buffer, mGpuBuffer, 1, &region);
+    vkCmdCopyBuffer(cmdbuf, stage.buffer, mGpuBuffer, 1, &region);
 
 	mUpdatedOffset = byteOffset;
     mUpdatedBytes = numBytes;
 
+    auto const [dstAccessMask, dstStageMask] = getReadMasks();
+
+    VkBufferMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = dstAccessMask,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = mGpuBuffer,
+        .size = VK_WHOLE_SIZE,
+    };
+
+    vkCmdPipelineBarrier(cmdbuf, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask, 0, 0, nullptr, 1,
+            &barrier, 0, nullptr);
+}
+
+void VulkanBuffer::loadFromCpu(VkCommandBuffer cmdbuf, VkCommandBuffer transferCmdbuf,
+        uint32_t transferQueueFamilyIndex, uint32_t queueFamilyIndex, const void* cpuData,
+        uint32_t byteOffset, uint32_t numBytes) {
+    assert_invariant(canLoadOnTransferQueue());
+    mLoaded = true;
+
+    VulkanStageArea const stage = mStagePool.upload(cpuData, numBytes);
+    VkBufferCopy region {
+            .srcOffset = stage.offset,
+            .dstOffset = byteOffset,
+            .size = numBytes,
+    };
+    vkCmdCopyBuffer(transferCmdbuf, stage.buffer, mGpuBuffer, 1, &region);
+
+    mUpdatedOffset = byteOffset;
+    mUpdatedBytes = numBytes;
+
+    // The whole buffer is released by the transfer queue and acquired by the graphics queue,
+    // which owns it from now on. The access masks of the other queue are ignored.
+    auto const [dstAccessMask, dstStageMask] = getReadMasks();
+    VkBufferMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = 0,
+        .srcQueueFamilyIndex = transferQueueFamilyIndex,
+        .dstQueueFamilyIndex = queueFamilyIndex,
+        .buffer = mGpuBuffer,
+        .size = VK_WHOLE_SIZE,
+    };
+    vkCmdPipelineBarrier(transferCmdbuf, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = dstAccessMask;
+    vkCmdPipelineBarrier(cmdbuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStageMask, 0, 0, nullptr,
+            1, &barrier, 0, nullptr);
+}
+
+std::pair<VkAccessFlags, VkPipelineStageFlags> VulkanBuffer::getReadMasks() const noexcept {
     // Firstly, ensure that the copy finishes before the next draw call.
     // Secondly, in case the user decides to upload another chunk (without ever using the first one)
     // we need to ensure that this upload completes first (hence
@@ -119,18 +216,11 @@ void VulkanBuffer::loadFromCpu(VkCommandBuffer cmdbuf, const void* cpuData, uint
         // TODO: implement me
     }
 
-    VkBufferMemoryBarrier barrier{
-        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
-        .dstAccessMask = dstAccessMask,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .buffer = mGpuBuffer,
-        .size = VK_WHOLE_SIZE,
-    };
-
-    vkCmdPipelineBarrier(cmdbuf, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask, 0, 0, nullptr, 1,
-            &barrier, 0, nullptr);
+    if (mUsage & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) {
+        dstAccessMask |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        dstStageMask |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    }
+    return { dstAccessMask, dstStageMask };
 }
 
 } // namespace filament::backend
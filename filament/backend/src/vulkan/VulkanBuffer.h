@@ -21,6 +21,8 @@
 #include "VulkanStagePool.h"
 #include "VulkanMemory.h"
 
+#include <utility>
+
 namespace filament::backend {
 
 // Encapsulates a Vulkan buffer, its attached DeviceMemory and a staging area.
@@ -31,11 +33,28 @@ public:
     ~VulkanBuffer();
     void loadFromCpu(VkCommandBuffer cmdbuf, const void* cpuData, uint32_t byteOffset,
             uint32_t numBytes);
+
+    // Records the copy in transferCmdbuf, which must be submitted to transferQueueFamilyIndex,
+    // and the acquisition of the buffer by queueFamilyIndex in cmdbuf. This is only possible
+    // before the buffer is first written, see canLoadOnTransferQueue().
+    void loadFromCpu(VkCommandBuffer cmdbuf, VkCommandBuffer transferCmdbuf,
+            uint32_t transferQueueFamilyIndex, uint32_t queueFamilyIndex, const void* cpuData,
+            uint32_t byteOffset, uint32_t numBytes);
+
+    // True if the buffer has never been written by the device, so that it doesn't need to be
+    // released by the graphics queue, and if it can't be written in place.
+    bool canLoadOnTransferQueue() const noexcept {
+        return !mLoaded && !mMappedData && !(mUsage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    }
+
     VkBuffer getGpuBuffer() const {
         return mGpuBuffer;
     }
 
 private:
+    // The accesses and stages that must wait for an upload to this buffer.
+    std::pair<VkAccessFlags, VkPipelineStageFlags> getReadMasks() const noexcept;
+
     VmaAllocator mAllocator;
     VulkanStagePool& mStagePool;
 
@@ -44,6 +63,9 @@ private:
     VkBufferUsageFlags mUsage = {};
 	uint32_t mUpdatedOffset = 0;
     uint32_t mUpdatedBytes = 0;
+    // persistent mapping of mGpuMemory when it is host-visible and coherent
+    void* mMappedData = nullptr;
+    bool mLoaded = false;
 };
 
 } // namespace filament::backend
@@ -0,0 +1,439 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VulkanCommandRecorder.h"
+
+#include <utils/JobSystem.h>
+#include <utils/debug.h>
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+#include <string.h>
+
+using namespace bluevk;
+
+namespace filament::backend {
+
+namespace {
+
+// Maximum number of descriptor sets tracked when splitting the commands.
+constexpr uint32_t MAX_DESCRIPTOR_SETS = 8;
+
+constexpr uint32_t NONE = UINT32_MAX;
+
+struct BindPipelineArgs {
+    VkPipeline pipeline;
+};
+
+struct BindDescriptorSetsArgs {
+    VkPipelineLayout layout;
+    uint32_t firstSet;
+    uint32_t setCount;
+    uint32_t dynamicOffsetCount;
+    // followed by setCount VkDescriptorSet, then dynamicOffsetCount uint32_t
+};
+
+struct PushConstantsArgs {
+    VkPipelineLayout layout;
+    VkShaderStageFlags stages;
+    uint32_t offset;
+    uint32_t size;
+    // followed by size bytes
+};
+
+struct BindVertexBuffersArgs {
+    uint32_t bufferCount;
+    // followed by bufferCount VkBuffer, then bufferCount VkDeviceSize
+};
+
+struct BindIndexBufferArgs {
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkIndexType indexType;
+};
+
+struct DrawIndexedArgs {
+    uint32_t indexCount;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t firstInstance;
+};
+
+struct DrawIndexedIndirectArgs {
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    uint32_t drawCount;
+    uint32_t stride;
+};
+
+constexpr size_t words(size_t size) noexcept {
+    return (size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+}
+
+template<typename T>
+T read(uint64_t const* data) noexcept {
+    T args;
+    memcpy(&args, data, sizeof(T));
+    return args;
+}
+
+} // anonymous namespace
+
+VulkanCommandRecorder::VulkanCommandRecorder() noexcept = default;
+
+VulkanCommandRecorder::~VulkanCommandRecorder() noexcept = default;
+
+void VulkanCommandRecorder::push(Op op, size_t count, void const* const* data,
+        size_t const* sizes) {
+    mCommands.push_back({ op, uint32_t(mData.size()) });
+    for (size_t i = 0; i < count; i++) {
+        size_t const offset = mData.size();
+        mData.resize(offset + words(sizes[i]));
+        memcpy(mData.data() + offset, data[i], sizes[i]);
+    }
+}
+
+void VulkanCommandRecorder::bindPipeline(VkPipeline pipeline) {
+    push(Op::BIND_PIPELINE, BindPipelineArgs{ pipeline });
+}
+
+void VulkanCommandRecorder::bindDescriptorSets(VkPipelineLayout layout, uint32_t firstSet,
+        uint32_t setCount, VkDescriptorSet const* sets, uint32_t dynamicOffsetCount,
+        uint32_t const* dynamicOffsets) {
+    assert_invariant(firstSet + setCount <= MAX_DESCRIPTOR_SETS);
+    BindDescriptorSetsArgs const args{ layout, firstSet, setCount, dynamicOffsetCount };
+    void const* data[] = { &args, sets, dynamicOffsets };
+    size_t const sizes[] = { sizeof(args), setCount * sizeof(VkDescriptorSet),
+            dynamicOffsetCount * sizeof(uint32_t) };
+    push(Op::BIND_DESCRIPTOR_SETS, dynamicOffsetCount ? 3 : 2, data, sizes);
+}
+
+void VulkanCommandRecorder::pushConstants(VkPipelineLayout layout, VkShaderStageFlags stages,
+        uint32_t offset, uint32_t size, void const* values) {
+    PushConstantsArgs const args{ layout, stages, offset, size };
+    void const* data[] = { &args, values };
+    size_t const sizes[] = { sizeof(args), size };
+    push(Op::PUSH_CONSTANTS, 2, data, sizes);
+}
+
+void VulkanCommandRecorder::setViewport(VkViewport const& viewport) {
+    push(Op::SET_VIEWPORT, viewport);
+}
+
+void VulkanCommandRecorder::setScissor(VkRect2D const& scissor) {
+    push(Op::SET_SCISSOR, scissor);
+}
+
+void VulkanCommandRecorder::setFragmentShadingRate(VkExtent2D const& fragmentSize) {
+    push(Op::SET_FRAGMENT_SHADING_RATE, fragmentSize);
+}
+
+void VulkanCommandRecorder::bindVertexBuffers(uint32_t bufferCount, VkBuffer const* buffers,
+        VkDeviceSize const* offsets) {
+    BindVertexBuffersArgs const args{ bufferCount };
+    void const* data[] = { &args, buffers, offsets };
+    size_t const sizes[] = {
+            sizeof(args), bufferCount * sizeof(VkBuffer), bufferCount * sizeof(VkDeviceSize) };
+    push(Op::BIND_VERTEX_BUFFERS, 3, data, sizes);
+}
+
+void VulkanCommandRecorder::bindIndexBuffer(VkBuffer buffer, VkDeviceSize offset,
+        VkIndexType indexType) {
+    push(Op::BIND_INDEX_BUFFER, BindIndexBufferArgs{ buffer, offset, indexType });
+}
+
+void VulkanCommandRecorder::drawIndexed(uint32_t indexCount, uint32_t instanceCount,
+        uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
+    push(Op::DRAW_INDEXED,
+            DrawIndexedArgs{ indexCount, instanceCount, firstIndex, vertexOffset, firstInstance });
+    mDrawCount++;
+}
+
+void VulkanCommandRecorder::drawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset,
+        uint32_t drawCount, uint32_t stride) {
+    push(Op::DRAW_INDEXED_INDIRECT, DrawIndexedIndirectArgs{ buffer, offset, drawCount, stride });
+    mDrawCount++;
+}
+
+void VulkanCommandRecorder::split(uint32_t count) {
+    mRanges.clear();
+    mPrologues.clear();
+    if (mCommands.empty()) {
+        return;
+    }
+
+    count = std::max(1u, uint32_t(std::min(size_t(count), mDrawCount)));
+    size_t const drawsPerRange = (mDrawCount + count - 1) / count;
+
+    // Index of the most recent command that set each piece of state. Push constants are tracked
+    // per stage and offset.
+    enum : uint32_t {
+        PIPELINE, VIEWPORT, SCISSOR, SHADING_RATE, VERTEX_BUFFERS, INDEX_BUFFER, DESCRIPTOR_SETS,
+        STATE_COUNT = DESCRIPTOR_SETS + MAX_DESCRIPTOR_SETS
+    };
+    uint32_t state[STATE_COUNT];
+    std::fill(std::begin(state), std::end(state), NONE);
+    std::vector<std::pair<uint64_t, uint32_t>> pushConstants;
+
+    auto beginRange = [&](uint32_t begin) {
+        uint32_t const prologueBegin = uint32_t(mPrologues.size());
+        for (uint32_t const index: state) {
+            if (index != NONE) {
+                mPrologues.push_back(index);
+            }
+        }
+        for (auto const& [key, index]: pushConstants) {
+            mPrologues.push_back(index);
+        }
+        // The state is restored in its original order, so that a command that set several
+        // descriptor sets doesn't override a more recent one.
+        std::sort(mPrologues.begin() + prologueBegin, mPrologues.end());
+        mPrologues.erase(std::unique(mPrologues.begin() + prologueBegin, mPrologues.end()),
+                mPrologues.end());
+        mRanges.push_back({ prologueBegin, uint32_t(mPrologues.size()), begin, begin });
+    };
+
+    beginRange(0);
+    size_t draws = 0;
+    size_t totalDraws = 0;
+    for (uint32_t i = 0, n = uint32_t(mCommands.size()); i < n; i++) {
+        Command const& command = mCommands[i];
+        uint64_t const* const data = mData.data() + command.offset;
+        switch (command.op) {
+            case Op::BIND_PIPELINE:
+                state[PIPELINE] = i;
+                break;
+            case Op::BIND_DESCRIPTOR_SETS: {
+                auto const args = read<BindDescriptorSetsArgs>(data);
+                for (uint32_t s = 0; s < args.setCount; s++) {
+                    state[DESCRIPTOR_SETS + args.firstSet + s] = i;
+                }
+                break;
+            }
+            case Op::PUSH_CONSTANTS: {
+                auto const args = read<PushConstantsArgs>(data);
+                uint64_t const key = uint64_t(args.stages) << 32 | args.offset;
+                auto pos = std::find_if(pushConstants.begin(), pushConstants.end(),
+                        [key](auto const& entry) { return entry.first == key; });
+                if (pos != pushConstants.end()) {
+                    pos->second = i;
+                } else {
+                    pushConstants.emplace_back(key, i);
+                }
+                break;
+            }
+            case Op::SET_VIEWPORT:
+                state[VIEWPORT] = i;
+                break;
+            case Op::SET_SCISSOR:
+                state[SCISSOR] = i;
+                break;
+            case Op::SET_FRAGMENT_SHADING_RATE:
+                state[SHADING_RATE] = i;
+                break;
+            case Op::BIND_VERTEX_BUFFERS:
+                state[VERTEX_BUFFERS] = i;
+                break;
+            case Op::BIND_INDEX_BUFFER:
+                state[INDEX_BUFFER] = i;
+                break;
+            case Op::DRAW_INDEXED:
+            case Op::DRAW_INDEXED_INDIRECT:
+                totalDraws++;
+                if (++draws == drawsPerRange && totalDraws < mDrawCount) {
+                    mRanges.back().end = i + 1;
+                    beginRange(i + 1);
+                    draws = 0;
+                }
+                break;
+        }
+    }
+    mRanges.back().end = uint32_t(mCommands.size());
+}
+
+void VulkanCommandRecorder::replay(VkCommandBuffer cmdbuffer, size_t range) const noexcept {
+    assert_invariant(range < mRanges.size());
+    Range const& r = mRanges[range];
+    for (uint32_t i = r.prologueBegin; i < r.prologueEnd; i++) {
+        execute(cmdbuffer, mCommands[mPrologues[i]]);
+    }
+    for (uint32_t i = r.begin; i < r.end; i++) {
+        execute(cmdbuffer, mCommands[i]);
+    }
+}
+
+void VulkanCommandRecorder::replay(VkCommandBuffer cmdbuffer) const noexcept {
+    for (Command const& command: mCommands) {
+        execute(cmdbuffer, command);
+    }
+}
+
+void VulkanCommandRecorder::clear() noexcept {
+    mCommands.clear();
+    mData.clear();
+    mRanges.clear();
+    mPrologues.clear();
+    mDrawCount = 0;
+}
+
+void VulkanCommandRecorder::execute(VkCommandBuffer cmdbuffer,
+        Command const& command) const noexcept {
+    uint64_t const* const data = mData.data() + command.offset;
+    switch (command.op) {
+        case Op::BIND_PIPELINE: {
+            auto const args = read<BindPipelineArgs>(data);
+            vkCmdBindPipeline(cmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, args.pipeline);
+            break;
+        }
+        case Op::BIND_DESCRIPTOR_SETS: {
+            auto const args = read<BindDescriptorSetsArgs>(data);
+            auto const* sets = reinterpret_cast<VkDescriptorSet const*>(
+                    data + words(sizeof(args)));
+            auto const* dynamicOffsets = reinterpret_cast<uint32_t const*>(
+                    data + words(sizeof(args)) + words(args.setCount * sizeof(VkDescriptorSet)));
+            vkCmdBindDescriptorSets(cmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, args.layout,
+                    args.firstSet, args.setCount, sets, args.dynamicOffsetCount,
+                    args.dynamicOffsetCount ? dynamicOffsets : nullptr);
+            break;
+        }
+        case Op::PUSH_CONSTANTS: {
+            auto const args = read<PushConstantsArgs>(data);
+            vkCmdPushConstants(cmdbuffer, args.layout, args.stages, args.offset, args.size,
+                    data + words(sizeof(args)));
+            break;
+        }
+        case Op::SET_VIEWPORT: {
+            auto const viewport = read<VkViewport>(data);
+            vkCmdSetViewport(cmdbuffer, 0, 1, &viewport);
+            break;
+        }
+        case Op::SET_SCISSOR: {
+            auto const scissor = read<VkRect2D>(data);
+            vkCmdSetScissor(cmdbuffer, 0, 1, &scissor);
+            break;
+        }
+        case Op::SET_FRAGMENT_SHADING_RATE: {
+            auto const fragmentSize = read<VkExtent2D>(data);
+            VkFragmentShadingRateCombinerOpKHR const combinerOps[2] = {
+                    VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR,
+                    VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR };
+            vkCmdSetFragmentShadingRateKHR(cmdbuffer, &fragmentSize, combinerOps);
+            break;
+        }
+        case Op::BIND_VERTEX_BUFFERS: {
+            auto const args = read<BindVertexBuffersArgs>(data);
+            uint64_t const* const buffers = data + words(sizeof(args));
+            uint64_t const* const offsets = buffers + words(args.bufferCount * sizeof(VkBuffer));
+            vkCmdBindVertexBuffers(cmdbuffer, 0, args.bufferCount,
+                    reinterpret_cast<VkBuffer const*>(buffers),
+                    reinterpret_cast<VkDeviceSize const*>(offsets));
+            break;
+        }
+        case Op::BIND_INDEX_BUFFER: {
+            auto const args = read<BindIndexBufferArgs>(data);
+            vkCmdBindIndexBuffer(cmdbuffer, args.buffer, args.offset, args.indexType);
+            break;
+        }
+        case Op::DRAW_INDEXED: {
+            auto const args = read<DrawIndexedArgs>(data);
+            vkCmdDrawIndexed(cmdbuffer, args.indexCount, args.instanceCount, args.firstIndex,
+                    args.vertexOffset, args.firstInstance);
+            break;
+        }
+        case Op::DRAW_INDEXED_INDIRECT: {
+            auto const args = read<DrawIndexedIndirectArgs>(data);
+            vkCmdDrawIndexedIndirect(cmdbuffer, args.buffer, args.offset, args.drawCount,
+                    args.stride);
+            break;
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+VulkanRecordingThreads::VulkanRecordingThreads(uint32_t threadCount) {
+    mThreads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        mThreads.emplace_back([this]() {
+            utils::JobSystem::setThreadName("VulkanRecordingThread");
+            utils::JobSystem::setThreadPriority(utils::JobSystem::Priority::URGENT_DISPLAY);
+            loop();
+        });
+    }
+}
+
+VulkanRecordingThreads::~VulkanRecordingThreads() noexcept {
+    std::unique_lock<utils::Mutex> lock(mLock);
+    mExitRequested = true;
+    mCondition.notify_all();
+    lock.unlock();
+    for (auto& thread: mThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void VulkanRecordingThreads::loop() {
+    std::unique_lock<utils::Mutex> lock(mLock);
+    while (true) {
+        mCondition.wait(lock, [this]() { return mExitRequested || mNext < mCount; });
+        if (mExitRequested) {
+            return;
+        }
+        uint32_t const index = mNext++;
+        Job const& job = *mJob;
+        lock.unlock();
+        job(index);
+        lock.lock();
+        if (++mDone == mCount) {
+            mDoneCondition.notify_all();
+        }
+    }
+}
+
+void VulkanRecordingThreads::run(uint32_t count, Job const& job) {
+    if (count == 0) {
+        return;
+    }
+    std::unique_lock<utils::Mutex> lock(mLock);
+    assert_invariant(!mJob);
+    mJob = &job;
+    mCount = count;
+    mNext = 0;
+    mDone = 0;
+    mCondition.notify_all();
+
+    // the calling thread takes its share of the work
+    while (mNext < mCount) {
+        uint32_t const index = mNext++;
+        lock.unlock();
+        job(index);
+        lock.lock();
+        mDone++;
+    }
+
+    mDoneCondition.wait(lock, [this]() { return mDone == mCount; });
+    mJob = nullptr;
+    mCount = 0;
+    mNext = 0;
+}
+
+} // namespace filament::backend
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_BACKEND_VULKANCOMMANDRECORDER_H
+#define TNT_FILAMENT_BACKEND_VULKANCOMMANDRECORDER_H
+
+#include <bluevk/BlueVK.h>
+
+#include <utils/Condition.h>
+#include <utils/Mutex.h>
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament::backend {
+
+// Records the commands issued inside a render pass so that they can be replayed later, either
+// directly into the primary command buffer, or split into several ranges, each of which can be
+// replayed into its own secondary command buffer on a different thread.
+//
+// Only the commands that the driver issues between vkCmdBeginRenderPass and vkCmdEndRenderPass
+// are supported. All the handles must stay valid until the commands are replayed, which is
+// guaranteed by the resources acquired by the command buffer at record time.
+//
+// Secondary command buffers don't inherit any state, so when the commands are split, each range
+// starts by replaying the most recent command for each piece of state (pipeline, descriptor
+// sets, push constants, dynamic state, vertex and index buffers) that preceded it.
+class VulkanCommandRecorder {
+public:
+    VulkanCommandRecorder() noexcept;
+    ~VulkanCommandRecorder() noexcept;
+
+    VulkanCommandRecorder(VulkanCommandRecorder const&) = delete;
+    VulkanCommandRecorder& operator=(VulkanCommandRecorder const&) = delete;
+
+    void bindPipeline(VkPipeline pipeline);
+
+    void bindDescriptorSets(VkPipelineLayout layout, uint32_t firstSet, uint32_t setCount,
+            VkDescriptorSet const* sets, uint32_t dynamicOffsetCount,
+            uint32_t const* dynamicOffsets);
+
+    void pushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset,
+            uint32_t size, void const* values);
+
+    void setViewport(VkViewport const& viewport);
+
+    void setScissor(VkRect2D const& scissor);
+
+    void setFragmentShadingRate(VkExtent2D const& fragmentSize);
+
+    void bindVertexBuffers(uint32_t bufferCount, VkBuffer const* buffers,
+            VkDeviceSize const* offsets);
+
+    void bindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType);
+
+    void drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex,
+            int32_t vertexOffset, uint32_t firstInstance);
+
+    void drawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount,
+            uint32_t stride);
+
+    size_t getDrawCount() const noexcept { return mDrawCount; }
+
+    // Splits the recorded commands in `count` ranges with roughly the same number of draws.
+    void split(uint32_t count);
+
+    size_t getRangeCount() const noexcept { return mRanges.size(); }
+
+    // Replays a range created by split(), this can be called concurrently for different ranges.
+    void replay(VkCommandBuffer cmdbuffer, size_t range) const noexcept;
+
+    // Replays all the recorded commands.
+    void replay(VkCommandBuffer cmdbuffer) const noexcept;
+
+    // Forgets all the recorded commands, but keeps the memory around.
+    void clear() noexcept;
+
+private:
+    enum class Op : uint8_t {
+        BIND_PIPELINE,
+        BIND_DESCRIPTOR_SETS,
+        PUSH_CONSTANTS,
+        SET_VIEWPORT,
+        SET_SCISSOR,
+        SET_FRAGMENT_SHADING_RATE,
+        BIND_VERTEX_BUFFERS,
+        BIND_INDEX_BUFFER,
+        DRAW_INDEXED,
+        DRAW_INDEXED_INDIRECT,
+    };
+
+    struct Command {
+        Op op;
+        uint32_t offset;    // offset of the arguments in mData, in words
+    };
+
+    struct Range {
+        uint32_t prologueBegin; // range of mPrologues with the commands restoring the state
+        uint32_t prologueEnd;
+        uint32_t begin;         // range of mCommands
+        uint32_t end;
+    };
+
+    // Appends the arguments of a command, the storage is kept 8-bytes aligned.
+    void push(Op op, size_t count, void const* const* data, size_t const* sizes);
+
+    template<typename T>
+    void push(Op op, T const& args) {
+        void const* data[] = { &args };
+        size_t const sizes[] = { sizeof(T) };
+        push(op, 1, data, sizes);
+    }
+
+    void execute(VkCommandBuffer cmdbuffer, Command const& command) const noexcept;
+
+    std::vector<Command> mCommands;
+    std::vector<uint64_t> mData;
+    std::vector<Range> mRanges;
+    std::vector<uint32_t> mPrologues;
+    size_t mDrawCount = 0;
+};
+
+// A small pool of threads dedicated to recording secondary command buffers. Vulkan command
+// pools must be externally synchronized, so callers typically use one pool per job index.
+class VulkanRecordingThreads {
+public:
+    using Job = std::function<void(uint32_t index)>;
+
+    // Creates `threadCount` worker threads, the calling thread participates in run().
+    explicit VulkanRecordingThreads(uint32_t threadCount);
+    ~VulkanRecordingThreads() noexcept;
+
+    VulkanRecordingThreads(VulkanRecordingThreads const&) = delete;
+    VulkanRecordingThreads& operator=(VulkanRecordingThreads const&) = delete;
+
+    // Number of threads that can run jobs concurrently, including the calling thread.
+    uint32_t getConcurrency() const noexcept { return uint32_t(mThreads.size() + 1); }
+
+    // Calls job(i) for each i in [0, count), and returns when all the calls have returned.
+    void run(uint32_t count, Job const& job);
+
+private:
+    void loop();
+
+    std::vector<std::thread> mThreads;
+    utils::Mutex mLock;
+    utils::Condition mCondition;
+    utils::Condition mDoneCondition;
+    Job const* mJob = nullptr;
+    uint32_t mCount = 0;
+    uint32_t mNext = 0;
+    uint32_t mDone = 0;
+    bool mExitRequested = false;
+};
+
+} // namespace filament::backend
+
+#endif // TNT_FILAMENT_BACKEND_VULKANCOMMANDRECORDER_H
@@ -21,6 +21,7 @@
 
 #include "VulkanCommands.h"
 
+#include "VulkanCommandRecorder.h"
 #include "VulkanConstants.h"
 #include "VulkanContext.h"
 
@@ -62,6 +63,99 @@ VulkanCommandBuffer::VulkanCommandBuffer(VulkanResourceAllocator* allocator, VkD
     vkAllocateCommandBuffers(device, &allocateInfo, &mBuffer);
 }
 
+void VulkanCommandBuffer::cmdBindPipeline(VkPipeline pipeline) {
+    if (mRecorder) {
+        mRecorder->bindPipeline(pipeline);
+    } else {
+        vkCmdBindPipeline(mBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    }
+}
+
+void VulkanCommandBuffer::cmdBindDescriptorSets(VkPipelineLayout layout, uint32_t firstSet,
+        uint32_t setCount, VkDescriptorSet const* sets, uint32_t dynamicOffsetCount,
+        uint32_t const* dynamicOffsets) {
+    if (mRecorder) {
+        mRecorder->bindDescriptorSets(layout, firstSet, setCount, sets, dynamicOffsetCount,
+                dynamicOffsets);
+    } else {
+        vkCmdBindDescriptorSets(mBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
+                firstSet, setCount, sets, dynamicOffsetCount, dynamicOffsets);
+    }
+}
+
+void VulkanCommandBuffer::cmdPushConstants(VkPipelineLayout layout, VkShaderStageFlags stages,
+        uint32_t offset, uint32_t size, void const* values) {
+    if (mRecorder) {
+        mRecorder->pushConstants(layout, stages, offset, size, values);
+    } else {
+        vkCmdPushConstants(mBuffer, layout, stages, offset, size, values);
+    }
+}
+
+void VulkanCommandBuffer::cmdSetViewport(VkViewport const& viewport) {
+    if (mRecorder) {
+        mRecorder->setViewport(viewport);
+    } else {
+        vkCmdSetViewport(mBuffer, 0, 1, &viewport);
+    }
+}
+
+void VulkanCommandBuffer::cmdSetScissor(VkRect2D const& scissor) {
+    if (mRecorder) {
+        mRecorder->setScissor(scissor);
+    } else {
+        vkCmdSetScissor(mBuffer, 0, 1, &scissor);
+    }
+}
+
+void VulkanCommandBuffer::cmdSetFragmentShadingRate(VkExtent2D const& fragmentSize) {
+    if (mRecorder) {
+        mRecorder->setFragmentShadingRate(fragmentSize);
+    } else {
+        VkFragmentShadingRateCombinerOpKHR const combinerOps[2] = {
+                VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR,
+                VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR };
+        vkCmdSetFragmentShadingRateKHR(mBuffer, &fragmentSize, combinerOps);
+    }
+}
+
+void VulkanCommandBuffer::cmdBindVertexBuffers(uint32_t bufferCount, VkBuffer const* buffers,
+        VkDeviceSize const* offsets) {
+    if (mRecorder) {
+        mRecorder->bindVertexBuffers(bufferCount, buffers, offsets);
+    } else {
+        vkCmdBindVertexBuffers(mBuffer, 0, bufferCount, buffers, offsets);
+    }
+}
+
+void VulkanCommandBuffer::cmdBindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType) {
+    if (mRecorder) {
+        mRecorder->bindIndexBuffer(buffer, offset, indexType);
+    } else {
+        vkCmdBindIndexBuffer(mBuffer, buffer, offset, indexType);
+    }
+}
+
+void VulkanCommandBuffer::cmdDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex,
+        int32_t vertexOffset, uint32_t firstInstance) {
+    if (mRecorder) {
+        mRecorder->drawIndexed(indexCount, instanceCount, firstIndex, vertexOffset,
+                firstInstance);
+    } else {
+        vkCmdDrawIndexed(mBuffer, indexCount, instanceCount, firstIndex,
+                vertexOffset, firstInstance);
+    }
+}
+
+void VulkanCommandBuffer::cmdDrawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount,
+        uint32_t stride) {
+    if (mRecorder) {
+        mRecorder->drawIndexedIndirect(buffer, offset, drawCount, stride);
+    } else {
+        vkCmdDrawIndexedIndirect(mBuffer, buffer, offset, drawCount, stride);
+    }
+}
+
 CommandBufferObserver::~CommandBufferObserver() {}
 
 static VkCommandPool createPool(VkDevice device, uint32_t queueFamilyIndex) {
@@ -136,21 +230,39 @@ VulkanCommands::VulkanCommands(VkDevice device, VkQueue queue, uint32_t queueFam
       mQueue(queue),
       mPool(createPool(mDevice, queueFamilyIndex)),
       mContext(context),
+      mQueueFamilyIndex(queueFamilyIndex),
       mStorage(CAPACITY) {
     VkSemaphoreCreateInfo sci{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
     for (auto& semaphore: mSubmissionSignals) {
         vkCreateSemaphore(mDevice, &sci, nullptr, &semaphore);
     }
 
-    VkFenceCreateInfo fenceCreateInfo{.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
-    for (auto& fence: mFences) {
-        vkCreateFence(device, &fenceCreateInfo, VKALLOC, &fence);
+    if (mContext->isTimelineSemaphoreSupported()) {
+        VkSemaphoreTypeCreateInfoKHR const typeInfo{
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+                .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+                .initialValue = 0,
+        };
+        VkSemaphoreCreateInfo const timelineInfo{
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+                .pNext = &typeInfo,
+        };
+        vkCreateSemaphore(mDevice, &timelineInfo, VKALLOC, &mTimeline);
+    } else {
+        VkFenceCreateInfo fenceCreateInfo{.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+        for (auto& fence: mFences) {
+            vkCreateFence(device, &fenceCreateInfo, VKALLOC, &fence);
+        }
     }
 
     for (size_t i = 0; i < CAPACITY; ++i) {
         mStorage[i] = std::make_unique<VulkanCommandBuffer>(allocator, mDevice, mPool);
     }
 
+    for (auto& pool: mSecondaryPools) {
+        pool = createPool(mDevice, queueFamilyIndex);
+    }
+
 #if !FVK_ENABLED(FVK_DEBUG_GROUP_MARKERS)
     (void) mContext;
 #endif
@@ -160,12 +272,17 @@ void VulkanCommands::terminate() {
     wait();
     gc();
     vkDestroyCommandPool(mDevice, mPool, VKALLOC);
+    for (VkCommandPool pool: mSecondaryPools) {
+        // this also frees all the secondary command buffers
+        vkDestroyCommandPool(mDevice, pool, VKALLOC);
+    }
     for (VkSemaphore sema: mSubmissionSignals) {
         vkDestroySemaphore(mDevice, sema, VKALLOC);
     }
     for (VkFence fence: mFences) {
         vkDestroyFence(mDevice, fence, VKALLOC);
     }
+    vkDestroySemaphore(mDevice, mTimeline, VKALLOC);
 }
 
 VulkanCommandBuffer& VulkanCommands::get() {
@@ -202,7 +319,8 @@ VulkanCommandBuffer& VulkanCommands::get() {
 
     // Note that the fence wrapper uses shared_ptr because a DriverAPI fence can also have ownership
     // over it.  The destruction of the low-level fence occurs either in VulkanCommands::gc(), or in
-    // VulkanDriver::destroyFence(), both of which are safe spots.
+    // VulkanDriver::destroyFence(), both of which are safe spots. With a timeline semaphore, there
+    // is no low-level fence and only the status of the wrapper is used.
     currentbuf->fence = std::make_shared<VulkanCmdFence>(mFences[mCurrentCommandBufferIndex]);
 
     // Begin writing into the command buffer.
@@ -252,6 +370,13 @@ bool VulkanCommands::flush() {
     VulkanCommandBuffer const* currentbuf = mStorage[index].get();
     VkSemaphore const renderingFinished = mSubmissionSignals[index];
 
+    // Uploads recorded on the transfer queue must be visible to this command buffer, which also
+    // holds the barriers that acquire their resources.
+    VkSemaphore transferFinished = VK_NULL_HANDLE;
+    if (mTransfer && mTransfer->flush()) {
+        transferFinished = mTransfer->acquireFinishedSignal();
+    }
+
     vkEndCommandBuffer(currentbuf->buffer());
 
     // If the injected semaphore is an "image available" semaphore that has not yet been signaled,
@@ -260,12 +385,14 @@ bool VulkanCommands::flush() {
     // here and use VK_PIPELINE_STAGE_ALL_COMMANDS_BIT. This is a more aggressive stall, but it is
     // the only safe option because the previously submitted command buffer might have set up some
     // state that the new command buffer depends on.
-    VkPipelineStageFlags waitDestStageMasks[2] = {
+    VkPipelineStageFlags waitDestStageMasks[3] = {
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
     };
 
-    VkSemaphore signals[2] = {
+    VkSemaphore signals[3] = {
+            VK_NULL_HANDLE,
             VK_NULL_HANDLE,
             VK_NULL_HANDLE,
     };
@@ -276,6 +403,9 @@ bool VulkanCommands::flush() {
     if (mInjectedSignal) {
         signals[waitSemaphoreCount++] = mInjectedSignal;
     }
+    if (transferFinished) {
+        signals[waitSemaphoreCount++] = transferFinished;
+    }
     VkCommandBuffer const cmdbuffer = currentbuf->buffer();
     VkSubmitInfo submitInfo{
             .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
@@ -288,11 +418,29 @@ bool VulkanCommands::flush() {
             .pSignalSemaphores = &renderingFinished,
     };
 
+    // With a timeline semaphore, the submission also signals the next value of the timeline. The
+    // value given for the binary semaphore is ignored.
+    VkSemaphore const timelineSignals[2] = { renderingFinished, mTimeline };
+    uint64_t const timelineValues[2] = { 0, mSubmittedValue + 1 };
+    VkTimelineSemaphoreSubmitInfoKHR const timelineInfo{
+            .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+            .signalSemaphoreValueCount = 2u,
+            .pSignalSemaphoreValues = timelineValues,
+    };
+    if (mTimeline) {
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.signalSemaphoreCount = 2u;
+        submitInfo.pSignalSemaphores = timelineSignals;
+        mSubmittedValue++;
+        mSubmissionValues[index] = mSubmittedValue;
+    }
+
 #if FVK_ENABLED(FVK_DEBUG_COMMAND_BUFFER)
     FVK_LOGI << "Submitting cmdbuffer=" << cmdbuffer
            << " wait=(" << signals[0] << ", " << signals[1] << ") "
            << " signal=" << renderingFinished
            << " fence=" << currentbuf->fence->fence
+           << " value=" << (mTimeline ? mSubmittedValue : 0)
            << utils::io::endl;
 #endif
 
@@ -334,6 +482,28 @@ void VulkanCommands::injectDependency(VkSemaphore next) {
 }
 
 void VulkanCommands::wait() {
+    if (mTransfer) {
+        mTransfer->wait();
+    }
+    if (mTimeline) {
+        bool inFlight = false;
+        for (size_t i = 0; i < CAPACITY && !inFlight; i++) {
+            inFlight = isInFlight(i);
+        }
+        if (inFlight) {
+            // Every submitted command buffer is done once the last submission is.
+            VkSemaphoreWaitInfoKHR const waitInfo{
+                    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+                    .semaphoreCount = 1,
+                    .pSemaphores = &mTimeline,
+                    .pValues = &mSubmittedValue,
+            };
+            vkWaitSemaphoresKHR(mDevice, &waitInfo, UINT64_MAX);
+            updateFences();
+        }
+        return;
+    }
+
     VkFence fences[CAPACITY];
     size_t count = 0;
     for (size_t i = 0; i < CAPACITY; i++) {
@@ -353,21 +523,40 @@ void VulkanCommands::gc() {
     FVK_SYSTRACE_CONTEXT();
     FVK_SYSTRACE_START("commands::gc");
 
+    if (mTransfer) {
+        mTransfer->gc();
+    }
+
     VkFence fences[CAPACITY];
     size_t count = 0;
 
+    // With a timeline semaphore, one query tells which command buffers are done.
+    uint64_t completedValue = 0;
+    if (mTimeline) {
+        vkGetSemaphoreCounterValueKHR(mDevice, mTimeline, &completedValue);
+    }
+
     for (size_t i = 0; i < CAPACITY; i++) {
         auto wrapper = mStorage[i].get();
-        if (wrapper->buffer() == VK_NULL_HANDLE) {
-            continue;
-        }
-        VkResult const result = vkGetFenceStatus(mDevice, wrapper->fence->fence);
-        if (result != VK_SUCCESS) {
-            continue;
+        if (mTimeline) {
+            if (!isInFlight(i) || mSubmissionValues[i] > completedValue) {
+                continue;
+            }
+        } else {
+            if (wrapper->buffer() == VK_NULL_HANDLE) {
+                continue;
+            }
+            VkResult const result = vkGetFenceStatus(mDevice, wrapper->fence->fence);
+            if (result != VK_SUCCESS) {
+                continue;
+            }
+            fences[count++] = wrapper->fence->fence;
         }
-        fences[count++] = wrapper->fence->fence;
         wrapper->fence->status.store(VK_SUCCESS);
         wrapper->reset();
+        for (auto& secondaries: mSecondaries[i]) {
+            secondaries.used = 0;
+        }
         mAvailableBufferCount++;
     }
 
@@ -377,7 +566,42 @@ void VulkanCommands::gc() {
     FVK_SYSTRACE_END();
 }
 
+VkCommandBuffer VulkanCommands::getSecondary(uint8_t slot) {
+    assert_invariant(mCurrentCommandBufferIndex >= 0);
+    assert_invariant(slot < SECONDARY_SLOTS);
+    SecondaryBuffers& secondaries = mSecondaries[mCurrentCommandBufferIndex][slot];
+    if (secondaries.used == secondaries.buffers.size()) {
+        const VkCommandBufferAllocateInfo allocateInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool = mSecondaryPools[slot],
+                .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                .commandBufferCount = 1,
+        };
+        // Like the primary command buffers, these are implicitly reset by vkBeginCommandBuffer.
+        VkCommandBuffer buffer;
+        vkAllocateCommandBuffers(mDevice, &allocateInfo, &buffer);
+        secondaries.buffers.push_back(buffer);
+    }
+    return secondaries.buffers[secondaries.used++];
+}
+
 void VulkanCommands::updateFences() {
+    if (mTransfer) {
+        mTransfer->updateFences();
+    }
+    if (mTimeline) {
+        uint64_t completedValue = 0;
+        VkResult const result = vkGetSemaphoreCounterValueKHR(mDevice, mTimeline, &completedValue);
+        for (size_t i = 0; i < CAPACITY; i++) {
+            if (isInFlight(i)) {
+                VkResult const status = result != VK_SUCCESS ? result
+                        : mSubmissionValues[i] <= completedValue ? VK_SUCCESS : VK_NOT_READY;
+                mStorage[i]->fence->status.store(status, std::memory_order_relaxed);
+            }
+        }
+        return;
+    }
+
     for (size_t i = 0; i < CAPACITY; i++) {
         auto wrapper = mStorage[i].get();
         if (wrapper->buffer() != VK_NULL_HANDLE) {
@@ -34,9 +34,11 @@
 #include <list>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace filament::backend {
 
+class VulkanCommandRecorder;
 struct VulkanContext;
 
 #if FVK_ENABLED(FVK_DEBUG_GROUP_MARKERS)
@@ -90,6 +92,7 @@ struct VulkanCommandBuffer {
         fence.reset();
         mResourceManager.clear();
         mPipeline = VK_NULL_HANDLE;
+        mRecorder = nullptr;
     }
 
     inline void setPipeline(VkPipeline pipeline) {
@@ -107,12 +110,40 @@ struct VulkanCommandBuffer {
         return VK_NULL_HANDLE;
     }
 
+    // While a recorder is set, the cmd* methods below append to it instead of writing into the
+    // command buffer. This is used to defer the recording of a render pass.
+    inline void setRecorder(VulkanCommandRecorder* recorder) {
+        mRecorder = recorder;
+    }
+
+    inline VulkanCommandRecorder* recorder() const {
+        return mRecorder;
+    }
+
+    void cmdBindPipeline(VkPipeline pipeline);
+    void cmdBindDescriptorSets(VkPipelineLayout layout, uint32_t firstSet, uint32_t setCount,
+            VkDescriptorSet const* sets, uint32_t dynamicOffsetCount = 0,
+            uint32_t const* dynamicOffsets = nullptr);
+    void cmdPushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset,
+            uint32_t size, void const* values);
+    void cmdSetViewport(VkViewport const& viewport);
+    void cmdSetScissor(VkRect2D const& scissor);
+    void cmdSetFragmentShadingRate(VkExtent2D const& fragmentSize);
+    void cmdBindVertexBuffers(uint32_t bufferCount, VkBuffer const* buffers,
+            VkDeviceSize const* offsets);
+    void cmdBindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType);
+    void cmdDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex,
+            int32_t vertexOffset, uint32_t firstInstance);
+    void cmdDrawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount,
+            uint32_t stride);
+
     std::shared_ptr<VulkanCmdFence> fence;
 
 private:
     VulkanAcquireOnlyResourceManager mResourceManager;
     VkCommandBuffer mBuffer;
     VkPipeline mPipeline;
+    VulkanCommandRecorder* mRecorder = nullptr;
 };
 
 // Allows classes to be notified after a new command buffer has been activated.
@@ -143,11 +174,23 @@ public:
 // - Allows 1 user to listen to the most recent flush event using a "finished" VkSemaphore.
 //    - This is used to trigger presentation of the swap chain image.
 //
+// - Tracks the completion of submitted command buffers.
+//    - When VK_KHR_timeline_semaphore is available, each submission signals a monotonically
+//      increasing value on a single timeline semaphore, and a command buffer is done as soon as
+//      the semaphore's counter has reached its value. Otherwise each submission has a VkFence.
+//
 // - Allows off-thread queries of command buffer status.
 //    - Exposes an "updateFences" method that transfers current fence status into atomics.
 //    - Users can examine these atomic variables (see VulkanCmdFence) to determine status.
 //    - We do this because vkGetFenceStatus must be called from the rendering thread.
 //
+// - Hands out secondary command buffers whose lifetime is tied to the current command buffer.
+//    - Used to record the draw calls of a render pass on several threads.
+//
+// - Optionally owns the command buffers of a transfer queue, used for uploads.
+//    - The transfer commands are submitted right before the current command buffer, which waits
+//      for them. They're also collected and waited for along with the graphics commands.
+//
 class VulkanCommands {
 public:
     VulkanCommands(VkDevice device, VkQueue queue, uint32_t queueFamilyIndex,
@@ -180,6 +223,20 @@ public:
     // Updates the atomic "status" variable in every extant fence.
     void updateFences();
 
+    // Returns a secondary command buffer that can be executed by the current command buffer, and
+    // that stays valid until the current command buffer has finished executing. Each slot has its
+    // own command pool, so buffers from different slots can be recorded concurrently.
+    VkCommandBuffer getSecondary(uint8_t slot);
+
+    // Returns the commands that record uploads on the transfer queue, or null if uploads must be
+    // recorded in the current command buffer. Resources written by the transfer queue must be
+    // released to getQueueFamilyIndex() and acquired in the current command buffer.
+    VulkanCommands* getTransferCommands() const noexcept { return mTransfer; }
+
+    void setTransferCommands(VulkanCommands* transfer) noexcept { mTransfer = transfer; }
+
+    uint32_t getQueueFamilyIndex() const noexcept { return mQueueFamilyIndex; }
+
     // Sets an observer who is notified every time a new command buffer has been made "current".
     // The observer's event handler can only be called during get().
     void setObserver(CommandBufferObserver* observer) { mObserver = observer; }
@@ -200,6 +257,8 @@ private:
     VkQueue const mQueue;
     VkCommandPool const mPool;
     VulkanContext const* mContext;
+    uint32_t const mQueueFamilyIndex;
+    VulkanCommands* mTransfer = nullptr;
 
     // int8 only goes up to 127, therefore capacity must be less than that.
     static_assert(CAPACITY < 128);
@@ -209,13 +268,34 @@ private:
     utils::FixedCapacityVector<std::unique_ptr<VulkanCommandBuffer>> mStorage;
     VkFence mFences[CAPACITY] = {};
     VkSemaphore mSubmissionSignals[CAPACITY] = {};
+
+    // Only used when timeline semaphores are supported, in which case mFences is left empty.
+    // mSubmissionValues[i] is the value signaled by the last submission of command buffer i.
+    VkSemaphore mTimeline = VK_NULL_HANDLE;
+    uint64_t mSubmittedValue = 0;
+    uint64_t mSubmissionValues[CAPACITY] = {};
     uint8_t mAvailableBufferCount = CAPACITY;
     CommandBufferObserver* mObserver = nullptr;
 
+    // Secondary command buffers are recycled when the command buffer that executed them is.
+    static constexpr int SECONDARY_SLOTS = FVK_MAX_RECORDING_THREADS;
+    struct SecondaryBuffers {
+        std::vector<VkCommandBuffer> buffers;
+        size_t used = 0;
+    };
+    VkCommandPool mSecondaryPools[SECONDARY_SLOTS] = {};
+    SecondaryBuffers mSecondaries[CAPACITY][SECONDARY_SLOTS];
+
 #if FVK_ENABLED(FVK_DEBUG_GROUP_MARKERS)
     std::unique_ptr<VulkanGroupMarkers> mGroupMarkers;
     std::unique_ptr<VulkanGroupMarkers> mCarriedOverMarkers;
 #endif
+
+    // Returns true if command buffer `index` has been submitted and hasn't been reclaimed yet.
+    bool isInFlight(size_t index) const noexcept {
+        return mStorage[index]->buffer() != VK_NULL_HANDLE
+                && mCurrentCommandBufferIndex != static_cast<int8_t>(index);
+    }
 };
 
 } // namespace filament::backend
@@ -179,4 +179,38 @@ constexpr static const int FVK_MAX_PIPELINE_AGE = 10;
 // destroying any unused pipeline object.
 static_assert(FVK_MAX_PIPELINE_AGE >= FVK_MAX_COMMAND_BUFFERS);
 
+// Number of command buffer submissions without any new VkPipeline after which the VkPipelineCache
+// is written to the platform's blob cache (if any pipeline was created since it was last written).
+constexpr static const int FVK_PIPELINE_CACHE_SAVE_DELAY = 60;
+
+// Number of command buffer submissions during which the draw calls using a pipeline can be skipped
+// while it's being created in the background, after which the driver thread waits for it.
+//
+// This must be smaller than the number of submissions after which an unused VkRenderPass is
+// destroyed by VulkanFboCache, since the pipeline is created against it.
+constexpr static const int FVK_MAX_PIPELINE_COMPILE_DELAY = 4;
+static_assert(FVK_MAX_PIPELINE_COMPILE_DELAY + 1 < FVK_MAX_COMMAND_BUFFERS);
+
+// Maximum number of threads used to create pipelines when asynchronous pipeline creation is
+// enabled.
+constexpr static const int FVK_MAX_PIPELINE_COMPILER_THREADS = 2;
+
+// Maximum number of threads, including the driver thread, used to record the draw commands of a
+// render pass into secondary command buffers. Setting this to 1 disables parallel recording.
+constexpr static const int FVK_MAX_RECORDING_THREADS = 4;
+
+// Render passes with fewer draw calls than this per recording thread are recorded inline, since
+// the cost of the extra command buffers and of re-binding the state outweighs the gains.
+constexpr static const int FVK_MIN_DRAWS_PER_SECONDARY_BUFFER = 128;
+
+// Attachments at least this large (e.g. a 1080p RGBA8 target) are not sub-allocated from VMA's
+// memory blocks but get a dedicated allocation.
+constexpr static const uint32_t FVK_MIN_DEDICATED_ATTACHMENT_SIZE = 4u * 1024u * 1024u;
+
+// Uniform buffer bindings below this index use dynamic offsets, so that binding another range of
+// the same buffer, which Filament does for the per-renderable data at every draw, only rebinds
+// the descriptor set instead of writing a new one. Vulkan guarantees at least 8 dynamic uniform
+// buffers per pipeline layout.
+constexpr static const uint8_t FVK_DYNAMIC_UBO_BINDING_COUNT = 4;
+
 #endif
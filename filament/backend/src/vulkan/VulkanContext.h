@@ -21,6 +21,8 @@
 #include "VulkanImageUtility.h"
 #include "VulkanUtility.h"
 
+#include <backend/TargetBufferInfo.h>
+
 #include <utils/bitset.h>
 #include <utils/FixedCapacityVector.h>
 #include <utils/Mutex.h>
@@ -78,15 +80,27 @@ public:
 private:
     VkDevice mDevice;
     VkQueryPool mPool;
-    utils::bitset32 mUsed;
+    // Enough for the frame and pass timer queries of a few Renderers, see FrameInfoManager.
+    utils::bitset256 mUsed;
     utils::Mutex mMutex;
 };
 
 struct VulkanRenderPass {
     VulkanRenderTarget* renderTarget;
-    VkRenderPass renderPass;
+    VkRenderPass renderPass;    // VK_NULL_HANDLE with dynamic rendering
     RenderPassParams params;
     int currentSubpass;
+    bool dynamicRendering;
+};
+
+// The attachment formats of a render pass that uses VK_KHR_dynamic_rendering, which pipelines are
+// created with instead of a VkRenderPass. Color formats are packed in the same order as the color
+// attachments of the VkRenderPass that would otherwise be used.
+struct VulkanRenderingFormats {
+    uint32_t colorAttachmentCount;
+    VkFormat colorFormats[MRT::MAX_SUPPORTED_RENDER_TARGET_COUNT];
+    VkFormat depthFormat;
+    uint32_t viewMask;
 };
 
 // This is a collection of immutable data about the vulkan context. This actual handles to the
@@ -117,6 +131,10 @@ public:
         return mPhysicalDeviceProperties.limits;
     }
 
+    inline VkPhysicalDeviceProperties const& getPhysicalDeviceProperties() const noexcept {
+        return mPhysicalDeviceProperties;
+    }
+
     inline uint32_t getPhysicalDeviceVendorId() const noexcept {
         return mPhysicalDeviceProperties.vendorID;
     }
@@ -145,6 +163,26 @@ public:
         return mPhysicalDeviceFeatures.shaderClipDistance == VK_TRUE;
     }
 
+    inline bool isMultiDrawIndirectSupported() const noexcept {
+        return mPhysicalDeviceFeatures.multiDrawIndirect == VK_TRUE;
+    }
+
+    // Whether the shading rate can be set with vkCmdSetFragmentShadingRateKHR.
+    inline bool isFragmentShadingRateSupported() const noexcept {
+        return mFragmentShadingRateSupported;
+    }
+
+    // Whether submissions can be tracked with a VK_KHR_timeline_semaphore instead of fences.
+    inline bool isTimelineSemaphoreSupported() const noexcept {
+        return mTimelineSemaphoreSupported;
+    }
+
+    // Whether render passes without subpasses use vkCmdBeginRenderingKHR instead of VkRenderPass
+    // and VkFramebuffer objects. This is opt-in, see VulkanPlatform::Customization.
+    inline bool isDynamicRenderingEnabled() const noexcept {
+        return mDynamicRenderingEnabled;
+    }
+
 private:
     VkPhysicalDeviceMemoryProperties mMemoryProperties = {};
     VkPhysicalDeviceProperties mPhysicalDeviceProperties = {};
@@ -152,6 +190,9 @@ private:
     bool mDebugMarkersSupported = false;
     bool mDebugUtilsSupported = false;
     bool mMultiviewEnabled = false;
+    bool mFragmentShadingRateSupported = false;
+    bool mTimelineSemaphoreSupported = false;
+    bool mDynamicRenderingEnabled = false;
 
     VkFormatList mDepthStencilFormats;
     VkFormatList mBlittableDepthStencilFormats;
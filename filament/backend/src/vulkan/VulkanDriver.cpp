@@ -31,6 +31,10 @@
 #include <utils/FixedCapacityVector.h>
 #include <utils/Panic.h>
 
+#include <algorithm>
+#include <iterator>
+#include <thread>
+
 #ifndef NDEBUG
 #include <set>  // For VulkanDriver::debugCommandBegin
 #endif
@@ -75,14 +79,21 @@ VmaAllocator createAllocator(VkInstance instance, VkPhysicalDevice physicalDevic
         .vkDestroyImage = vkDestroyImage,
         .vkCmdCopyBuffer = vkCmdCopyBuffer,
         .vkGetBufferMemoryRequirements2KHR = vkGetBufferMemoryRequirements2KHR,
-        .vkGetImageMemoryRequirements2KHR = vkGetImageMemoryRequirements2KHR
+        .vkGetImageMemoryRequirements2KHR = vkGetImageMemoryRequirements2KHR,
+        .vkBindBufferMemory2KHR = vkBindBufferMemory2,
+        .vkBindImageMemory2KHR = vkBindImageMemory2,
+        .vkGetPhysicalDeviceMemoryProperties2KHR = vkGetPhysicalDeviceMemoryProperties2,
 #endif
     };
+    // Telling VMA which version of Vulkan is used lets it honor the driver's preference for
+    // dedicated allocations (VK_KHR_dedicated_allocation is core in 1.1).
     VmaAllocatorCreateInfo const allocatorInfo {
         .physicalDevice = physicalDevice,
         .device = device,
         .pVulkanFunctions = &funcs,
         .instance = instance,
+        .vulkanApiVersion = VK_MAKE_API_VERSION(0, FVK_REQUIRED_VERSION_MAJOR,
+                FVK_REQUIRED_VERSION_MINOR, 0),
     };
     vmaCreateAllocator(&allocatorInfo, &allocator);
     return allocator;
@@ -110,6 +121,23 @@ VulkanBufferObject* createEmptyBufferObject(VmaAllocator allocator, VulkanStageP
     return obj;
 }
 
+// Uploads to a buffer that has never been written are recorded on the transfer queue, if any.
+void loadFromCpu(VulkanCommands& commands, VulkanResource* resource, VulkanBuffer& buffer,
+        void const* data, uint32_t byteOffset, uint32_t numBytes) {
+    VulkanCommandBuffer& commandBuffer = commands.get();
+    commandBuffer.acquire(resource);
+    VulkanCommands* const transfer = commands.getTransferCommands();
+    if (transfer && buffer.canLoadOnTransferQueue()) {
+        VulkanCommandBuffer& transferBuffer = transfer->get();
+        transferBuffer.acquire(resource);
+        buffer.loadFromCpu(commandBuffer.buffer(), transferBuffer.buffer(),
+                transfer->getQueueFamilyIndex(), commands.getQueueFamilyIndex(), data, byteOffset,
+                numBytes);
+        return;
+    }
+    buffer.loadFromCpu(commandBuffer.buffer(), data, byteOffset, numBytes);
+}
+
 #if FVK_ENABLED(FVK_DEBUG_VALIDATION)
 VKAPI_ATTR VkBool32 VKAPI_CALL debugReportCallback(VkDebugReportFlagsEXT flags,
         VkDebugReportObjectTypeEXT objectType, uint64_t object, size_t location,
@@ -255,6 +283,23 @@ VulkanDriver::VulkanDriver(VulkanPlatform* platform, VulkanContext const& contex
 
     mTimestamps = std::make_unique<VulkanTimestamps>(mPlatform->getDevice());
 
+    if (mPlatform->getTransferQueue() != VK_NULL_HANDLE) {
+        mTransferCommands = std::make_unique<VulkanCommands>(mPlatform->getDevice(),
+                mPlatform->getTransferQueue(), mPlatform->getTransferQueueFamilyIndex(), &mContext,
+                &mResourceAllocator);
+        mCommands.setTransferCommands(mTransferCommands.get());
+    }
+
+    // Creating pipelines in the background is opt-in, because the draw calls are skipped until
+    // their pipeline is ready.
+    uint32_t const pipelineCompilerThreadCount =
+            (driverConfig.vulkanAsyncPipelineCreation && !driverConfig.disableParallelShaderCompile)
+                    ? std::clamp(std::thread::hardware_concurrency() / 4u, 1u,
+                              uint32_t(FVK_MAX_PIPELINE_COMPILER_THREADS))
+                    : 0u;
+    mPipelineCache.initialize(mPlatform, mContext.getPhysicalDeviceProperties(),
+            pipelineCompilerThreadCount, mContext.isFragmentShadingRateSupported());
+
     mEmptyTexture = createEmptyTexture(mPlatform->getDevice(), mPlatform->getPhysicalDevice(),
             mContext, mAllocator, &mCommands, mStagePool);
     mEmptyBufferObject = createEmptyBufferObject(mAllocator, mStagePool, &mCommands);
@@ -262,6 +307,17 @@ VulkanDriver::VulkanDriver(VulkanPlatform* platform, VulkanContext const& contex
     mDescriptorSetManager.setPlaceHolders(mSamplerCache.getSampler({}), mEmptyTexture,
             mEmptyBufferObject);
 
+    // Render passes are recorded in parallel only when there are enough cores to spare. Group
+    // markers are written directly into the primary command buffer, which isn't allowed within
+    // a render pass that executes secondary command buffers.
+#if !FVK_ENABLED(FVK_DEBUG_GROUP_MARKERS)
+    uint32_t const recordingThreadCount = std::min(uint32_t(FVK_MAX_RECORDING_THREADS),
+            std::thread::hardware_concurrency() / 2u);
+    if (recordingThreadCount > 1) {
+        mRecordingThreads = std::make_unique<VulkanRecordingThreads>(recordingThreadCount - 1);
+    }
+#endif
+
     mGetPipelineFunction = [this](VulkanDescriptorSetLayoutList const& layouts, VulkanProgram* program) {
         return mPipelineLayoutCache.getLayout(layouts, program);
     };
@@ -329,12 +385,21 @@ void VulkanDriver::terminate() {
     // to those commands are no longer referenced.
     finish(0);
 
+    mRecordingThreads.reset();
+
     delete mEmptyBufferObject;
     delete mEmptyTexture;
 
     // Command buffers should come first since it might have commands depending on resources that
     // are about to be destroyed.
     mCommands.terminate();
+    if (mTransferCommands) {
+        mTransferCommands->terminate();
+    }
+
+    // The pipeline cache stops its compiler threads, which can be using the shader modules of
+    // the programs released below.
+    mPipelineCache.terminate();
 
     mResourceManager.clear();
     mTimestamps.reset();
@@ -346,7 +411,6 @@ void VulkanDriver::terminate() {
     mStagePool.gc();
 
     mStagePool.terminate();
-    mPipelineCache.terminate();
     mFramebufferCache.reset();
     mSamplerCache.terminate();
     mDescriptorSetManager.terminate();
@@ -419,6 +483,34 @@ void VulkanDriver::endFrame(uint32_t frameId) {
     FVK_SYSTRACE_START("endframe");
     mCommands.flush();
     collectGarbage();
+    UTILS_UNUSED imgutil::BarrierStats const barrierStats =
+            imgutil::getAndResetBarrierStats();
+#if FVK_ENABLED(FVK_DEBUG_SYSTRACE)
+    SYSTRACE_VALUE32("vk.pipelineBarriers", barrierStats.callCount);
+    SYSTRACE_VALUE32("vk.imageBarriers", barrierStats.barrierCount);
+#endif
+    UTILS_UNUSED VulkanFboCache::Stats const fboStats = mFramebufferCache.getAndResetStats();
+#if FVK_ENABLED(FVK_DEBUG_SYSTRACE)
+    SYSTRACE_VALUE32("vk.renderPassCacheHits", fboStats.renderPassHits);
+    SYSTRACE_VALUE32("vk.renderPassCacheMisses", fboStats.renderPassMisses);
+    SYSTRACE_VALUE32("vk.framebufferCacheHits", fboStats.framebufferHits);
+    SYSTRACE_VALUE32("vk.framebufferCacheMisses", fboStats.framebufferMisses);
+    SYSTRACE_VALUE32("vk.renderPassCacheEvictions", fboStats.renderPassEvictions);
+    SYSTRACE_VALUE32("vk.framebufferCacheEvictions", fboStats.framebufferEvictions);
+#endif
+    UTILS_UNUSED auto const samplerStats = mSamplerCache.getAndResetStats();
+#if FVK_ENABLED(FVK_DEBUG_SYSTRACE)
+    SYSTRACE_VALUE32("vk.samplerCacheHits", samplerStats.hits);
+    SYSTRACE_VALUE32("vk.samplerCacheMisses", samplerStats.misses);
+#endif
+    UTILS_UNUSED VulkanPipelineCache::Stats const pipelineStats =
+            mPipelineCache.getAndResetStats();
+#if FVK_ENABLED(FVK_DEBUG_SYSTRACE)
+    SYSTRACE_VALUE32("vk.pipelineCacheHits", pipelineStats.hits);
+    SYSTRACE_VALUE32("vk.pipelineCacheMisses", pipelineStats.misses);
+    SYSTRACE_VALUE32("vk.pipelineCount", pipelineStats.pipelineCount);
+    SYSTRACE_VALUE32("vk.pipelineCreationTimeUs", pipelineStats.creationTimeUs);
+#endif
     FVK_SYSTRACE_END();
 }
 
@@ -572,6 +664,7 @@ void VulkanDriver::destroyProgram(Handle<HwProgram> ph) {
     }
     auto vkprogram = mResourceAllocator.handle_cast<VulkanProgram*>(ph);
     mDescriptorSetManager.clearProgram(vkprogram);
+    mPipelineCache.discardPendingPipelines(vkprogram);
     mResourceManager.release(vkprogram);
 }
 
@@ -948,6 +1041,27 @@ bool VulkanDriver::isDepthClampSupported() {
     return mContext.isDepthClampSupported();
 }
 
+bool VulkanDriver::isDrawIndirectSupported() {
+    return true;
+}
+
+bool VulkanDriver::isVariableRateShadingSupported() {
+    return mContext.isFragmentShadingRateSupported();
+}
+
+size_t VulkanDriver::getAllocatedMemorySize() {
+    // VMA synchronizes its allocator internally, so this is safe to call from any thread
+    VkPhysicalDeviceMemoryProperties const* memoryProperties = nullptr;
+    vmaGetMemoryProperties(mAllocator, &memoryProperties);
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(mAllocator, budgets);
+    VkDeviceSize size = 0;
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++) {
+        size += budgets[i].statistics.blockBytes;
+    }
+    return size_t(size);
+}
+
 bool VulkanDriver::isWorkaroundNeeded(Workaround workaround) {
     switch (workaround) {
         case Workaround::SPLIT_EASU: {
@@ -1039,21 +1153,16 @@ void VulkanDriver::setVertexBufferObject(Handle<HwVertexBuffer> vbh, uint32_t in
 
 void VulkanDriver::updateIndexBuffer(Handle<HwIndexBuffer> ibh, BufferDescriptor&& p,
         uint32_t byteOffset) {
-    VulkanCommandBuffer& commands = mCommands.get();
     auto ib = mResourceAllocator.handle_cast<VulkanIndexBuffer*>(ibh);
-    commands.acquire(ib);
-    ib->buffer.loadFromCpu(commands.buffer(), p.buffer, byteOffset, p.size);
+    loadFromCpu(mCommands, ib, ib->buffer, p.buffer, byteOffset, p.size);
 
     scheduleDestroy(std::move(p));
 }
 
 void VulkanDriver::updateBufferObject(Handle<HwBufferObject> boh, BufferDescriptor&& bd,
         uint32_t byteOffset) {
-    VulkanCommandBuffer& commands = mCommands.get();
-
     auto bo = mResourceAllocator.handle_cast<VulkanBufferObject*>(boh);
-    commands.acquire(bo);
-    bo->buffer.loadFromCpu(commands.buffer(), bd.buffer, byteOffset, bd.size);
+    loadFromCpu(mCommands, bo, bo->buffer, bd.buffer, byteOffset, bd.size);
 
     scheduleDestroy(std::move(bd));
 }
@@ -1141,32 +1250,16 @@ void VulkanDriver::generateMipmaps(Handle<HwTexture> th) {
         layerCount *= 6;
     }
 
-    // FIXME: the loop below can perform many layout transitions and back. We should be
-    //        able to optimize that.
-
-    uint8_t level = 0;
-    int32_t srcw = int32_t(t->width);
-    int32_t srch = int32_t(t->height);
-    do {
-        int32_t const dstw = std::max(srcw >> 1, 1);
-        int32_t const dsth = std::max(srch >> 1, 1);
-        const VkOffset3D srcOffsets[2] = {{ 0, 0, 0 }, { srcw, srch, 1 }};
-        const VkOffset3D dstOffsets[2] = {{ 0, 0, 0 }, { dstw, dsth, 1 }};
-
-        // TODO: there should be a way to do this using layerCount in vkBlitImage
-        // TODO: vkBlitImage should be able to handle 3D textures too
-        for (int32_t layer = 0; layer < layerCount; layer++) {
-            mBlitter.blit(VK_FILTER_LINEAR,
-                    { .texture = t, .level = uint8_t(level + 1), .layer = (uint16_t)layer },
-                    dstOffsets,
-                    { .texture = t, .level = uint8_t(level    ), .layer = (uint16_t)layer },
-                    srcOffsets);
-        }
-
-        level++;
-        srcw = dstw;
-        srch = dsth;
-    } while ((srcw > 1 || srch > 1) && level < t->levels);
+    // generate levels until both dimensions are 1, or we run out of levels
+    uint8_t levelCount = 1;
+    uint32_t size = std::max(t->width, t->height);
+    while (size > 1 && levelCount < t->levels) {
+        size >>= 1;
+        levelCount++;
+    }
+    if (levelCount > 1) {
+        mBlitter.generateMipmaps(t, levelCount, uint32_t(layerCount));
+    }
     t->setPrimaryRange(0, t->levels - 1);
 }
 
@@ -1179,10 +1272,21 @@ void VulkanDriver::updateSamplerGroup(Handle<HwSamplerGroup> sbh,
     //        It's preferable to do as much work as possible here.
     //        Here, we emulate the older backend API by re-creating a SamplerGroup from the
     //        passed data.
-    SamplerGroup samplerGroup(data.size / sizeof(SamplerDescriptor));
+    size_t const count = data.size / sizeof(SamplerDescriptor);
+    SamplerGroup samplerGroup(count);
     memcpy(samplerGroup.data(), data.buffer, data.size);
     *sb->sb = std::move(samplerGroup);
 
+    // Some drivers are slow to create samplers, so they're created now rather than on first use.
+    if (sb->samplers.size() != count) {
+        sb->samplers = utils::FixedCapacityVector<VkSampler>(count);
+    }
+    auto const* descriptors = static_cast<SamplerDescriptor const*>(data.buffer);
+    for (size_t i = 0; i < count; i++) {
+        sb->samplers[i] = descriptors[i].t ? mSamplerCache.getSampler(descriptors[i].s)
+                                           : VK_NULL_HANDLE;
+    }
+
     scheduleDestroy(std::move(data));
 }
 
@@ -1229,6 +1333,9 @@ void VulkanDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassP
     VulkanCommandBuffer& commands = mCommands.get();
     VkCommandBuffer const cmdbuffer = commands.buffer();
 
+    // all the attachment transitions below are issued with a single barrier
+    imgutil::BarrierBatch barriers(cmdbuffer);
+
     UTILS_NOUNROLL
     for (uint8_t samplerGroupIdx = 0; samplerGroupIdx < Program::SAMPLER_BINDING_COUNT;
             samplerGroupIdx++) {
@@ -1251,7 +1358,7 @@ void VulkanDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassP
                 commands.acquire(texture);
 
                 // Transition the primary view, which is the sampler's view into the right layout.
-                texture->transitionLayout(cmdbuffer, texture->getPrimaryViewRange(),
+                texture->transitionLayout(barriers, texture->getPrimaryViewRange(),
                         VulkanLayout::DEPTH_SAMPLER);
                 break;
             }
@@ -1260,6 +1367,9 @@ void VulkanDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassP
 
     VulkanLayout currentDepthLayout = depth.getLayout();
 
+    // Render passes with subpasses still need a VkRenderPass, dynamic rendering can't express them.
+    bool const useDynamicRendering = mContext.isDynamicRenderingEnabled() && !params.subpassMask;
+
     TargetBufferFlags clearVal = params.flags.clear;
     TargetBufferFlags discardEndVal = params.flags.discardEnd;
     if (depth.texture) {
@@ -1271,7 +1381,13 @@ void VulkanDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassP
         // transition it to an attachment. This is necessary to also set up a barrier between the
         // previous read and the potentially coming write.
         if (currentDepthLayout == VulkanLayout::DEPTH_SAMPLER) {
-            depth.texture->transitionLayout(cmdbuffer, depth.getSubresourceRange(),
+            depth.texture->transitionLayout(barriers, depth.getSubresourceRange(),
+                    VulkanLayout::DEPTH_ATTACHMENT);
+            currentDepthLayout = VulkanLayout::DEPTH_ATTACHMENT;
+        }
+        // Without a VkRenderPass, there is no initial layout transition to rely on.
+        if (useDynamicRendering && currentDepthLayout != VulkanLayout::DEPTH_ATTACHMENT) {
+            depth.texture->transitionLayout(barriers, depth.getSubresourceRange(),
                     VulkanLayout::DEPTH_ATTACHMENT);
             currentDepthLayout = VulkanLayout::DEPTH_ATTACHMENT;
         }
@@ -1302,13 +1418,28 @@ void VulkanDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassP
             }
             if (info.texture->getPrimaryImageLayout() != VulkanLayout::COLOR_ATTACHMENT) {
                 ((VulkanTexture*) info.texture)
-                        ->transitionLayout(cmdbuffer, info.getSubresourceRange(),
+                        ->transitionLayout(barriers, info.getSubresourceRange(),
                                 VulkanLayout::COLOR_ATTACHMENT);
             }
         } else {
             rpkey.colorFormat[i] = VK_FORMAT_UNDEFINED;
         }
     }
+    barriers.flush();
+
+    if (useDynamicRendering) {
+        beginRendering(commands, rt, rpkey, depth, params);
+        setRenderPassViewport(commands, rt, params);
+        mCurrentRenderPass = {
+            .renderTarget = rt,
+            .renderPass = VK_NULL_HANDLE,
+            .params = params,
+            .currentSubpass = 0,
+            .dynamicRendering = true,
+        };
+        FVK_SYSTRACE_END();
+        return;
+    }
 
     VkRenderPass renderPass = mFramebufferCache.getRenderPass(rpkey);
     mPipelineCache.bindRenderPass(renderPass, 0);
@@ -1427,8 +1558,143 @@ void VulkanDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassP
         renderPassInfo.pClearValues = &clearValues[0];
     }
 
-    vkCmdBeginRenderPass(cmdbuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    // When recording threads are available, the commands of the render pass are recorded and
+    // only written into command buffers in endRenderPass(), at which point we know how many draw
+    // calls there are and whether they're worth splitting across secondary command buffers.
+    // Secondary command buffers can't span subpasses, which we don't support here.
+    if (mRecordingThreads && !params.subpassMask) {
+        mDeferredRenderPass.beginInfo = renderPassInfo;
+        std::copy(std::begin(clearValues), std::end(clearValues),
+                std::begin(mDeferredRenderPass.clearValues));
+        if (renderPassInfo.pClearValues) {
+            mDeferredRenderPass.beginInfo.pClearValues = mDeferredRenderPass.clearValues;
+        }
+        commands.setRecorder(&mRenderPassRecorder);
+    } else {
+        vkCmdBeginRenderPass(cmdbuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    }
+
+    setRenderPassViewport(commands, rt, params);
+
+    mCurrentRenderPass = {
+        .renderTarget = rt,
+        .renderPass = renderPassInfo.renderPass,
+        .params = params,
+        .currentSubpass = 0,
+        .dynamicRendering = false,
+    };
+    FVK_SYSTRACE_END();
+}
+
+void VulkanDriver::beginRendering(VulkanCommandBuffer& commands, VulkanRenderTarget* rt,
+        VulkanFboCache::RenderPassKey const& rpkey, VulkanAttachment depth,
+        RenderPassParams const& params) {
+    mPipelineCache.bindRenderingFormats(mFramebufferCache.getRenderingFormats(rpkey));
+
+    // The attachments are packed in the same order as the VkRenderPass would have them, so that
+    // the fragment outputs are mapped the same way.
+    auto& renderPassAttachments = mRenderPassFboInfo.attachments;
+    auto& rendering = mDeferredRenderPass;
+    uint32_t colorAttachmentCount = 0;
+    for (int i = 0; i < MRT::MAX_SUPPORTED_RENDER_TARGET_COUNT; i++) {
+        VulkanAttachment& colorAttachment = rt->getColor(i);
+        if (!colorAttachment.texture) {
+            continue;
+        }
+        TargetBufferFlags const flag = TargetBufferFlags(int(TargetBufferFlags::COLOR0) << i);
+        bool const clear = any(rpkey.clear & flag);
+        bool const discard = any(rpkey.discardStart & flag);
+        bool const needsResolve = rpkey.needsResolveMask & (1 << i);
+
+        VkRenderingAttachmentInfoKHR& info = rendering.colorAttachments[colorAttachmentCount++];
+        info = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
+            .imageLayout = imgutil::getVkLayout(VulkanLayout::COLOR_ATTACHMENT),
+            .resolveMode = VK_RESOLVE_MODE_NONE_KHR,
+            .loadOp = clear ? VK_ATTACHMENT_LOAD_OP_CLEAR
+                            : (discard ? VK_ATTACHMENT_LOAD_OP_DONT_CARE
+                                       : VK_ATTACHMENT_LOAD_OP_LOAD),
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .clearValue = { .color = { .float32 = {
+                    params.clearColor.r, params.clearColor.g,
+                    params.clearColor.b, params.clearColor.a } } },
+        };
+        if (rpkey.samples == 1) {
+            renderPassAttachments.insert(colorAttachment);
+            info.imageView = colorAttachment.getImageView();
+        } else {
+            VulkanAttachment& msaaColorAttachment = rt->getMsaaColor(i);
+            renderPassAttachments.insert(msaaColorAttachment);
+            info.imageView = msaaColorAttachment.getImageView();
+            if (needsResolve) {
+                mRenderPassFboInfo.hasColorResolve = true;
+                renderPassAttachments.insert(colorAttachment);
+                // A VkRenderPass resolves integer formats with sample 0, which must be explicit.
+                TextureFormat const format = colorAttachment.texture->format;
+                info.resolveMode = isUnsignedIntFormat(format) || isSignedIntFormat(format)
+                        ? VK_RESOLVE_MODE_SAMPLE_ZERO_BIT_KHR : VK_RESOLVE_MODE_AVERAGE_BIT_KHR;
+                info.resolveImageView = colorAttachment.getImageView();
+                info.resolveImageLayout =
+                        imgutil::getVkLayout(VulkanLayout::COLOR_ATTACHMENT_RESOLVE);
+            }
+        }
+        assert_invariant(info.imageView);
+    }
+
+    if (depth.texture) {
+        renderPassAttachments.insert(depth);
+        bool const clear = any(rpkey.clear & TargetBufferFlags::DEPTH);
+        bool const discardStart = any(rpkey.discardStart & TargetBufferFlags::DEPTH);
+        bool const discardEnd = any(rpkey.discardEnd & TargetBufferFlags::DEPTH);
+
+        // As with a VkRenderPass, multisampled depth is never resolved.
+        assert_invariant(!(rt->getSamples() > 1 &&
+                rt->getDepth().texture->samples == 1 &&
+                !discardEnd));
+
+        rendering.depthAttachment = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
+            .imageView = depth.getImageView(),
+            .imageLayout = imgutil::getVkLayout(VulkanLayout::DEPTH_ATTACHMENT),
+            .resolveMode = VK_RESOLVE_MODE_NONE_KHR,
+            .loadOp = clear ? VK_ATTACHMENT_LOAD_OP_CLEAR
+                            : (discardStart ? VK_ATTACHMENT_LOAD_OP_DONT_CARE
+                                            : VK_ATTACHMENT_LOAD_OP_LOAD),
+            .storeOp = discardEnd ? VK_ATTACHMENT_STORE_OP_DONT_CARE
+                                  : VK_ATTACHMENT_STORE_OP_STORE,
+            .clearValue = { .depthStencil = { (float) params.clearDepth, 0 } },
+        };
+        assert_invariant(rendering.depthAttachment.imageView);
+    }
+
+    // The current command buffer now has references to the render target and its attachments.
+    commands.acquire(rt);
+    for (auto const& attachment: renderPassAttachments) {
+        commands.acquire(attachment.texture);
+    }
+
+    rendering.renderingInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
+        .renderArea = { .offset = {}, .extent = rt->getExtent() },
+        .layerCount = 1,
+        .viewMask = rpkey.viewCount > 1 ? (1u << rpkey.viewCount) - 1u : 0u,
+        .colorAttachmentCount = colorAttachmentCount,
+        .pColorAttachments = colorAttachmentCount ? rendering.colorAttachments : nullptr,
+        .pDepthAttachment = depth.texture ? &rendering.depthAttachment : nullptr,
+    };
+    rendering.samples = rpkey.samples;
+    rt->transformClientRectToPlatform(&rendering.renderingInfo.renderArea);
 
+    // See the comment about deferred recording in beginRenderPass().
+    if (mRecordingThreads) {
+        commands.setRecorder(&mRenderPassRecorder);
+    } else {
+        vkCmdBeginRenderingKHR(commands.buffer(), &rendering.renderingInfo);
+    }
+}
+
+void VulkanDriver::setRenderPassViewport(VulkanCommandBuffer& commands, VulkanRenderTarget* rt,
+        RenderPassParams const& params) {
     VkViewport viewport = {
         .x = (float) params.viewport.left,
         .y = (float) params.viewport.bottom,
@@ -1439,15 +1705,13 @@ void VulkanDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassP
     };
 
     rt->transformClientRectToPlatform(&viewport);
-    vkCmdSetViewport(cmdbuffer, 0, 1, &viewport);
+    commands.cmdSetViewport(viewport);
 
-    mCurrentRenderPass = {
-        .renderTarget = rt,
-        .renderPass = renderPassInfo.renderPass,
-        .params = params,
-        .currentSubpass = 0,
-    };
-    FVK_SYSTRACE_END();
+    // The shading rate is a dynamic state of all pipelines when it's supported, so it must be set
+    // in every render pass.
+    if (mContext.isFragmentShadingRateSupported()) {
+        commands.cmdSetFragmentShadingRate(getFragmentSize(params.shadingRate));
+    }
 }
 
 void VulkanDriver::endRenderPass(int) {
@@ -1456,7 +1720,15 @@ void VulkanDriver::endRenderPass(int) {
 
     VulkanCommandBuffer& commands = mCommands.get();
     VkCommandBuffer cmdbuffer = commands.buffer();
-    vkCmdEndRenderPass(cmdbuffer);
+    if (commands.recorder()) {
+        commands.setRecorder(nullptr);
+        executeDeferredRenderPass(cmdbuffer);
+    }
+    if (mCurrentRenderPass.dynamicRendering) {
+        vkCmdEndRenderingKHR(cmdbuffer);
+    } else {
+        vkCmdEndRenderPass(cmdbuffer);
+    }
 
     VulkanRenderTarget* rt = mCurrentRenderPass.renderTarget;
     assert_invariant(rt);
@@ -1515,6 +1787,83 @@ void VulkanDriver::endRenderPass(int) {
     mDescriptorSetManager.clearState();
     mCurrentRenderPass.renderTarget = nullptr;
     mCurrentRenderPass.renderPass = VK_NULL_HANDLE;
+    mCurrentRenderPass.dynamicRendering = false;
+    FVK_SYSTRACE_END();
+}
+
+void VulkanDriver::executeDeferredRenderPass(VkCommandBuffer cmdbuffer) {
+    FVK_SYSTRACE_CONTEXT();
+    FVK_SYSTRACE_START("executeDeferredRenderPass");
+
+    VulkanCommandRecorder& recorder = mRenderPassRecorder;
+    VkRenderPassBeginInfo const& beginInfo = mDeferredRenderPass.beginInfo;
+    VkRenderingInfoKHR& renderingInfo = mDeferredRenderPass.renderingInfo;
+    bool const dynamicRendering = mCurrentRenderPass.dynamicRendering;
+    uint32_t const count = std::min(mRecordingThreads->getConcurrency(),
+            uint32_t(recorder.getDrawCount() / FVK_MIN_DRAWS_PER_SECONDARY_BUFFER));
+
+    if (count <= 1) {
+        if (dynamicRendering) {
+            renderingInfo.flags = 0;
+            vkCmdBeginRenderingKHR(cmdbuffer, &renderingInfo);
+        } else {
+            vkCmdBeginRenderPass(cmdbuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        }
+        recorder.replay(cmdbuffer);
+    } else {
+        recorder.split(count);
+        uint32_t const rangeCount = uint32_t(recorder.getRangeCount());
+        VkCommandBuffer secondaries[FVK_MAX_RECORDING_THREADS];
+        for (uint32_t i = 0; i < rangeCount; i++) {
+            secondaries[i] = mCommands.getSecondary(uint8_t(i));
+        }
+
+        // With dynamic rendering, the secondary command buffers inherit the attachment formats
+        // instead of the render pass.
+        VulkanRenderingFormats const* formats = mPipelineCache.getBoundRenderingFormats();
+        VkCommandBufferInheritanceRenderingInfoKHR renderingInheritanceInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR,
+            .rasterizationSamples = (VkSampleCountFlagBits) mDeferredRenderPass.samples,
+        };
+        if (dynamicRendering) {
+            renderingInheritanceInfo.viewMask = formats->viewMask;
+            renderingInheritanceInfo.colorAttachmentCount = formats->colorAttachmentCount;
+            renderingInheritanceInfo.pColorAttachmentFormats = formats->colorFormats;
+            renderingInheritanceInfo.depthAttachmentFormat = formats->depthFormat;
+        }
+        VkCommandBufferInheritanceInfo const inheritanceInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .pNext = dynamicRendering ? &renderingInheritanceInfo : nullptr,
+            .renderPass = dynamicRendering ? VK_NULL_HANDLE : beginInfo.renderPass,
+            .subpass = 0,
+            .framebuffer = dynamicRendering ? VK_NULL_HANDLE : beginInfo.framebuffer,
+        };
+
+        // Each range uses the secondary command buffer (and pool) of the same index, so no two
+        // threads ever touch the same pool.
+        mRecordingThreads->run(rangeCount, [&](uint32_t index) {
+            VkCommandBufferBeginInfo const binfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                         VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+                .pInheritanceInfo = &inheritanceInfo,
+            };
+            vkBeginCommandBuffer(secondaries[index], &binfo);
+            recorder.replay(secondaries[index], index);
+            vkEndCommandBuffer(secondaries[index]);
+        });
+
+        if (dynamicRendering) {
+            renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR;
+            vkCmdBeginRenderingKHR(cmdbuffer, &renderingInfo);
+        } else {
+            vkCmdBeginRenderPass(cmdbuffer, &beginInfo,
+                    VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        }
+        vkCmdExecuteCommands(cmdbuffer, rangeCount, secondaries);
+    }
+
+    recorder.clear();
     FVK_SYSTRACE_END();
 }
 
@@ -1660,7 +2009,7 @@ void VulkanDriver::resolve(
     FVK_SYSTRACE_CONTEXT();
     FVK_SYSTRACE_START("resolve");
 
-    FILAMENT_CHECK_PRECONDITION(mCurrentRenderPass.renderPass == VK_NULL_HANDLE)
+    FILAMENT_CHECK_PRECONDITION(mCurrentRenderPass.renderTarget == nullptr)
             << "resolve() cannot be invoked inside a render pass.";
 
     auto* const srcTexture = mResourceAllocator.handle_cast<VulkanTexture*>(src);
@@ -1705,7 +2054,7 @@ void VulkanDriver::blit(
     FVK_SYSTRACE_CONTEXT();
     FVK_SYSTRACE_START("blit");
 
-    FILAMENT_CHECK_PRECONDITION(mCurrentRenderPass.renderPass == VK_NULL_HANDLE)
+    FILAMENT_CHECK_PRECONDITION(mCurrentRenderPass.renderTarget == nullptr)
             << "blit() cannot be invoked inside a render pass.";
 
     auto* const srcTexture = mResourceAllocator.handle_cast<VulkanTexture*>(src);
@@ -1750,7 +2099,7 @@ void VulkanDriver::blitDEPRECATED(TargetBufferFlags buffers,
 
     // Note: blitDEPRECATED is only used for Renderer::copyFrame()
 
-    FILAMENT_CHECK_PRECONDITION(mCurrentRenderPass.renderPass == VK_NULL_HANDLE)
+    FILAMENT_CHECK_PRECONDITION(mCurrentRenderPass.renderTarget == nullptr)
             << "blitDEPRECATED() cannot be invoked inside a render pass.";
 
     FILAMENT_CHECK_PRECONDITION(buffers == TargetBufferFlags::COLOR0)
@@ -1884,7 +2233,7 @@ void VulkanDriver::bindPipeline(PipelineState const& pipelineState) {
             texture = mEmptyTexture;
         }
 
-        VkSampler const vksampler = mSamplerCache.getSampler(boundSampler->s);
+        VkSampler const vksampler = vksb->samplers[samplerInd];
 #if FVK_ENABLED_DEBUG_SAMPLER_NAME
         VulkanDriver::DebugUtils::setName(VK_OBJECT_TYPE_SAMPLER,
                 reinterpret_cast<uint64_t>(vksampler), bindingToName[binding].c_str());
@@ -1893,14 +2242,15 @@ void VulkanDriver::bindPipeline(PipelineState const& pipelineState) {
     }
 
     auto const pipelineLayout = mDescriptorSetManager.bind(commands, program, mGetPipelineFunction);
+    mPipelineCache.bindLayout(pipelineLayout);
+    bool const ready = mPipelineCache.bindPipeline(commands);
+
     mBoundPipeline = {
         .program = program,
         .pipelineLayout = pipelineLayout,
+        .ready = ready,
     };
 
-    mPipelineCache.bindLayout(pipelineLayout);
-    mPipelineCache.bindPipeline(commands);
-
     // Since we don't statically define scissor as part of the pipeline, we need to call scissor at
     // least once. Context: VUID-vkCmdDrawIndexed-None-07832.
     auto const& extent = rt->getExtent();
@@ -1914,7 +2264,6 @@ void VulkanDriver::bindRenderPrimitive(Handle<HwRenderPrimitive> rph) {
     FVK_SYSTRACE_START("bindRenderPrimitive");
 
     VulkanCommandBuffer* commands = &mCommands.get();
-    VkCommandBuffer cmdbuffer = commands->buffer();
     const VulkanRenderPrimitive& prim = *mResourceAllocator.handle_cast<VulkanRenderPrimitive*>(rph);
     commands->acquire(prim.indexBuffer);
     commands->acquire(prim.vertexBuffer);
@@ -1931,8 +2280,8 @@ void VulkanDriver::bindRenderPrimitive(Handle<HwRenderPrimitive> rph) {
     // Next bind the vertex buffers and index buffer. One potential performance improvement is to
     // avoid rebinding these if they are already bound, but since we do not (yet) support subranges
     // it would be rare for a client to make consecutive draw calls with the same render primitive.
-    vkCmdBindVertexBuffers(cmdbuffer, 0, bufferCount, buffers, offsets);
-    vkCmdBindIndexBuffer(cmdbuffer, prim.indexBuffer->buffer.getGpuBuffer(), 0,
+    commands->cmdBindVertexBuffers(bufferCount, buffers, offsets);
+    commands->cmdBindIndexBuffer(prim.indexBuffer->buffer.getGpuBuffer(), 0,
             prim.indexBuffer->indexType);
 
     FVK_SYSTRACE_END();
@@ -1942,8 +2291,13 @@ void VulkanDriver::draw2(uint32_t indexOffset, uint32_t indexCount, uint32_t ins
     FVK_SYSTRACE_CONTEXT();
     FVK_SYSTRACE_START("draw2");
 
+    // The pipeline is still being created, skip the draw call rather than waiting for it.
+    if (UTILS_UNLIKELY(!mBoundPipeline.ready)) {
+        FVK_SYSTRACE_END();
+        return;
+    }
+
     VulkanCommandBuffer& commands = mCommands.get();
-    VkCommandBuffer cmdbuffer = commands.buffer();
 
     // Bind "dynamic" UBOs if they need to change.
     mDescriptorSetManager.dynamicBind(&commands, {});
@@ -1953,7 +2307,39 @@ void VulkanDriver::draw2(uint32_t indexOffset, uint32_t indexCount, uint32_t ins
     const int32_t vertexOffset = 0;
     const uint32_t firstInstId = 0;
 
-    vkCmdDrawIndexed(cmdbuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstId);
+    commands.cmdDrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstId);
+
+    FVK_SYSTRACE_END();
+}
+
+void VulkanDriver::draw2Indirect(Handle<HwBufferObject> ibh, uint32_t byteOffset,
+        uint32_t drawCount, uint32_t byteStride) {
+    FVK_SYSTRACE_CONTEXT();
+    FVK_SYSTRACE_START("draw2Indirect");
+
+    assert_invariant(byteStride >= sizeof(DrawIndexedIndirectCommand));
+
+    if (UTILS_UNLIKELY(!mBoundPipeline.ready)) {
+        FVK_SYSTRACE_END();
+        return;
+    }
+
+    VulkanCommandBuffer& commands = mCommands.get();
+
+    // Bind "dynamic" UBOs if they need to change.
+    mDescriptorSetManager.dynamicBind(&commands, {});
+
+    auto* bo = mResourceAllocator.handle_cast<VulkanBufferObject*>(ibh);
+    commands.acquire(bo);
+    VkBuffer const buffer = bo->buffer.getGpuBuffer();
+
+    if (mContext.isMultiDrawIndirectSupported()) {
+        commands.cmdDrawIndexedIndirect(buffer, byteOffset, drawCount, byteStride);
+    } else {
+        for (uint32_t i = 0; i < drawCount; i++) {
+            commands.cmdDrawIndexedIndirect(buffer, byteOffset + i * byteStride, 1, byteStride);
+        }
+    }
 
     FVK_SYSTRACE_END();
 }
@@ -1974,7 +2360,6 @@ void VulkanDriver::dispatchCompute(Handle<HwProgram> program, math::uint3 workGr
 
 void VulkanDriver::scissor(Viewport scissorBox) {
     VulkanCommandBuffer& commands = mCommands.get();
-    VkCommandBuffer cmdbuffer = commands.buffer();
 
     // Set scissoring.
     // clamp left-bottom to 0,0 and avoid overflows
@@ -1996,7 +2381,7 @@ void VulkanDriver::scissor(Viewport scissorBox) {
 
     const VulkanRenderTarget* rt = mCurrentRenderPass.renderTarget;
     rt->transformClientRectToPlatform(&scissor);
-    vkCmdSetScissor(cmdbuffer, 0, 1, &scissor);
+    commands.cmdSetScissor(scissor);
 }
 
 void VulkanDriver::beginTimerQuery(Handle<HwTimerQuery> tqh) {
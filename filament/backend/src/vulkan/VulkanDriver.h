@@ -18,6 +18,7 @@
 #define TNT_FILAMENT_BACKEND_VULKANDRIVER_H
 
 #include "VulkanBlitter.h"
+#include "VulkanCommandRecorder.h"
 #include "VulkanConstants.h"
 #include "VulkanContext.h"
 #include "VulkanFboCache.h"
@@ -38,6 +39,8 @@
 #include <utils/Allocator.h>
 #include <utils/compiler.h>
 
+#include <memory>
+
 namespace filament::backend {
 
 class VulkanPlatform;
@@ -127,6 +130,18 @@ private:
 private:
     void collectGarbage();
 
+    // Writes the commands recorded since beginRenderPass() into the command buffer.
+    void executeDeferredRenderPass(VkCommandBuffer cmdbuffer);
+
+    // Begins a render pass with vkCmdBeginRenderingKHR, without VkRenderPass and VkFramebuffer.
+    void beginRendering(VulkanCommandBuffer& commands, VulkanRenderTarget* rt,
+            VulkanFboCache::RenderPassKey const& rpkey, VulkanAttachment depth,
+            RenderPassParams const& params);
+
+    // Sets the dynamic state that all render passes start with.
+    void setRenderPassViewport(VulkanCommandBuffer& commands, VulkanRenderTarget* rt,
+            RenderPassParams const& params);
+
     VulkanPlatform* mPlatform = nullptr;
     std::unique_ptr<VulkanTimestamps> mTimestamps;
 
@@ -149,6 +164,8 @@ private:
     VulkanThreadSafeResourceManager mThreadSafeResourceManager;
 
     VulkanCommands mCommands;
+    // Records uploads on the platform's transfer queue, if it has one.
+    std::unique_ptr<VulkanCommands> mTransferCommands;
     VulkanPipelineLayoutCache mPipelineLayoutCache;
     VulkanPipelineCache mPipelineCache;
     VulkanStagePool mStagePool;
@@ -165,10 +182,27 @@ private:
     struct BoundPipeline {
         VulkanProgram* program;
         VkPipelineLayout pipelineLayout;
+        bool ready;     // false while the pipeline is created in the background
     };
     BoundPipeline mBoundPipeline = {};
     RenderPassFboBundle mRenderPassFboInfo;
 
+    // When not null, the commands of render passes are recorded by mRenderPassRecorder and may be
+    // split across secondary command buffers recorded by these threads.
+    std::unique_ptr<VulkanRecordingThreads> mRecordingThreads;
+    VulkanCommandRecorder mRenderPassRecorder;
+    struct {
+        VkRenderPassBeginInfo beginInfo;
+        VkClearValue clearValues[MAX_RENDERTARGET_ATTACHMENT_TEXTURES];
+
+        // With dynamic rendering, these describe the current render pass even when it's not
+        // deferred.
+        VkRenderingInfoKHR renderingInfo;
+        VkRenderingAttachmentInfoKHR colorAttachments[MRT::MAX_SUPPORTED_RENDER_TARGET_COUNT];
+        VkRenderingAttachmentInfoKHR depthAttachment;
+        uint8_t samples;
+    } mDeferredRenderPass = {};
+
     bool const mIsSRGBSwapChainSupported;
     backend::StereoscopicType const mStereoscopicType;
 };
@@ -18,6 +18,8 @@
 
 #include <utils/Panic.h>
 
+#include <string.h>
+
 #include "VulkanConstants.h"
 #include "VulkanUtility.h"
 
@@ -61,6 +63,11 @@ bool VulkanFboCache::FboKeyEqualFn::operator()(const FboKey& k1, const FboKey& k
     return true;
 }
 
+bool VulkanFboCache::RenderingFormatsEqualFn::operator()(const VulkanRenderingFormats& k1,
+        const VulkanRenderingFormats& k2) const {
+    return 0 == memcmp((const void*) &k1, (const void*) &k2, sizeof(k1));
+}
+
 VulkanFboCache::VulkanFboCache(VkDevice device)
     : mDevice(device) {}
 
@@ -70,10 +77,8 @@ VulkanFboCache::~VulkanFboCache() {
 }
 
 VkFramebuffer VulkanFboCache::getFramebuffer(FboKey config) noexcept {
-    auto iter = mFramebufferCache.find(config);
-    if (UTILS_LIKELY(iter != mFramebufferCache.end() && iter->second.handle != VK_NULL_HANDLE)) {
-        iter.value().timestamp = mCurrentTime;
-        return iter->second.handle;
+    if (VkFramebuffer const* framebuffer = mFramebufferCache.find(config)) {
+        return *framebuffer;
     }
 
     // The attachment list contains: Color Attachments, Resolve Attachments, and Depth Attachment.
@@ -117,15 +122,13 @@ VkFramebuffer VulkanFboCache::getFramebuffer(FboKey config) noexcept {
     VkFramebuffer framebuffer;
     VkResult error = vkCreateFramebuffer(mDevice, &info, VKALLOC, &framebuffer);
     FILAMENT_CHECK_POSTCONDITION(!error) << "Unable to create framebuffer.";
-    mFramebufferCache[config] = {framebuffer, mCurrentTime};
+    mFramebufferCache.insert(config, framebuffer);
     return framebuffer;
 }
 
 VkRenderPass VulkanFboCache::getRenderPass(RenderPassKey config) noexcept {
-    auto iter = mRenderPassCache.find(config);
-    if (UTILS_LIKELY(iter != mRenderPassCache.end() && iter->second.handle != VK_NULL_HANDLE)) {
-        iter.value().timestamp = mCurrentTime;
-        return iter->second.handle;
+    if (VkRenderPass const* renderPass = mRenderPassCache.find(config)) {
+        return *renderPass;
     }
     const bool hasSubpasses = config.subpassMask != 0;
 
@@ -327,7 +330,7 @@ VkRenderPass VulkanFboCache::getRenderPass(RenderPassKey config) noexcept {
     VkRenderPass renderPass;
     VkResult error = vkCreateRenderPass(mDevice, &renderPassInfo, VKALLOC, &renderPass);
     FILAMENT_CHECK_POSTCONDITION(!error) << "Unable to create render pass.";
-    mRenderPassCache[config] = {renderPass, mCurrentTime};
+    mRenderPassCache.insert(config, renderPass);
 
     #if FVK_ENABLED(FVK_DEBUG_FBO_CACHE)
     FVK_LOGD << "Created render pass " << renderPass << " with "
@@ -340,45 +343,78 @@ VkRenderPass VulkanFboCache::getRenderPass(RenderPassKey config) noexcept {
     return renderPass;
 }
 
-void VulkanFboCache::reset() noexcept {
-    for (auto pair : mFramebufferCache) {
-        mRenderPassRefCount[pair.first.renderPass]--;
-        vkDestroyFramebuffer(mDevice, pair.second.handle, VKALLOC);
+VulkanRenderingFormats const* VulkanFboCache::getRenderingFormats(
+        RenderPassKey const& config) noexcept {
+    // Subpasses can't be expressed with dynamic rendering.
+    assert_invariant(!config.subpassMask);
+
+    // The color formats are packed like the color attachments of getRenderPass().
+    VulkanRenderingFormats formats = {
+        .depthFormat = config.depthFormat,
+        .viewMask = config.viewCount > 1 ? (1u << config.viewCount) - 1u : 0u,
+    };
+    for (int i = 0; i < MRT::MAX_SUPPORTED_RENDER_TARGET_COUNT; i++) {
+        if (config.colorFormat[i] != VK_FORMAT_UNDEFINED) {
+            formats.colorFormats[formats.colorAttachmentCount++] = config.colorFormat[i];
+        }
     }
-    mFramebufferCache.clear();
-    for (auto pair : mRenderPassCache) {
-        vkDestroyRenderPass(mDevice, pair.second.handle, VKALLOC);
+
+    auto iter = mRenderingFormats.find(formats);
+    if (UTILS_LIKELY(iter != mRenderingFormats.end())) {
+        return iter->second.get();
     }
+    return mRenderingFormats.emplace(formats,
+            std::make_unique<VulkanRenderingFormats>(formats)).first->second.get();
+}
+
+VulkanFboCache::Stats VulkanFboCache::getAndResetStats() noexcept {
+    auto const framebufferStats = mFramebufferCache.getAndResetStats();
+    auto const renderPassStats = mRenderPassCache.getAndResetStats();
+    return {
+            .renderPassHits = renderPassStats.hits,
+            .renderPassMisses = renderPassStats.misses,
+            .framebufferHits = framebufferStats.hits,
+            .framebufferMisses = framebufferStats.misses,
+            .renderPassEvictions = renderPassStats.evictions,
+            .framebufferEvictions = framebufferStats.evictions,
+    };
+}
+
+void VulkanFboCache::reset() noexcept {
+    mFramebufferCache.forEach([this](FboKey const& key, VkFramebuffer framebuffer) {
+        mRenderPassRefCount[key.renderPass]--;
+        vkDestroyFramebuffer(mDevice, framebuffer, VKALLOC);
+    });
+    mFramebufferCache.clear();
+    mRenderPassCache.forEach([this](RenderPassKey const&, VkRenderPass renderPass) {
+        vkDestroyRenderPass(mDevice, renderPass, VKALLOC);
+    });
     mRenderPassCache.clear();
 }
 
-// Frees up old framebuffers and render passes, then nulls out their key.  Doesn't bother removing
-// the actual map entry since it is fairly small.
+// Frees up old framebuffers, and the old render passes that they no longer reference.
 void VulkanFboCache::gc() noexcept {
     FVK_SYSTRACE_CONTEXT();
     FVK_SYSTRACE_START("fbocache::gc");
 
-    // If this is one of the first few frames, return early to avoid wrapping unsigned integers.
-    if (++mCurrentTime <= TIME_BEFORE_EVICTION) {
-        return;
-    }
-    const uint32_t evictTime = mCurrentTime - TIME_BEFORE_EVICTION;
-
-    for (auto iter = mFramebufferCache.begin(); iter != mFramebufferCache.end(); ++iter) {
-        const FboVal fbo = iter->second;
-        if (fbo.timestamp < evictTime && fbo.handle) {
-            mRenderPassRefCount[iter->first.renderPass]--;
-            vkDestroyFramebuffer(mDevice, fbo.handle, VKALLOC);
-            iter.value().handle = VK_NULL_HANDLE;
-        }
-    }
-    for (auto iter = mRenderPassCache.begin(); iter != mRenderPassCache.end(); ++iter) {
-        const VkRenderPass handle = iter->second.handle;
-        if (iter->second.timestamp < evictTime && handle && mRenderPassRefCount[handle] == 0) {
-            vkDestroyRenderPass(mDevice, handle, VKALLOC);
-            iter.value().handle = VK_NULL_HANDLE;
-        }
-    }
+    mFramebufferCache.nextGeneration();
+    mRenderPassCache.nextGeneration();
+
+    mFramebufferCache.evict(TIME_BEFORE_EVICTION,
+            [this](FboKey const& key, VkFramebuffer framebuffer) {
+                mRenderPassRefCount[key.renderPass]--;
+                vkDestroyFramebuffer(mDevice, framebuffer, VKALLOC);
+                return true;
+            });
+    mRenderPassCache.evict(TIME_BEFORE_EVICTION,
+            [this](RenderPassKey const&, VkRenderPass renderPass) {
+                if (mRenderPassRefCount[renderPass] != 0) {
+                    return false;
+                }
+                mRenderPassRefCount.erase(renderPass);
+                vkDestroyRenderPass(mDevice, renderPass, VKALLOC);
+                return true;
+            });
     FVK_SYSTRACE_END();
 }
 
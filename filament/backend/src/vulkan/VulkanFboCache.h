@@ -19,12 +19,15 @@
 
 #include "VulkanContext.h"
 
+#include <utils/GenerationalCache.h>
 #include <utils/Hash.h>
 
 #include <backend/TargetBufferInfo.h>
 
 #include <tsl/robin_map.h>
 
+#include <memory>
+
 namespace filament::backend {
 
 // Simple manager for VkFramebuffer and VkRenderPass objects.
@@ -66,10 +69,6 @@ public:
         uint8_t subpassMask; // 1 byte
         uint8_t viewCount; // 1 byte
     };
-    struct RenderPassVal {
-        VkRenderPass handle;
-        uint32_t timestamp;
-    };
     static_assert(0 == MRT::MAX_SUPPORTED_RENDER_TARGET_COUNT % 8);
     static_assert(sizeof(RenderPassKey::initialColorLayoutMask) == MRT::MAX_SUPPORTED_RENDER_TARGET_COUNT / 8);
     static_assert(sizeof(TargetBufferFlags) == 4, "TargetBufferFlags has unexpected size.");
@@ -93,10 +92,6 @@ public:
         VkImageView resolve[MRT::MAX_SUPPORTED_RENDER_TARGET_COUNT]; // 64 bytes
         VkImageView depth; // 8 bytes
     };
-    struct FboVal {
-        VkFramebuffer handle;
-        uint32_t timestamp;
-    };
     static_assert(sizeof(VkRenderPass) == 8, "VkRenderPass has unexpected size.");
     static_assert(sizeof(VkImageView) == 8, "VkImageView has unexpected size.");
     static_assert(sizeof(FboKey) == 152, "FboKey has unexpected size.");
@@ -105,6 +100,23 @@ public:
         bool operator()(const FboKey& k1, const FboKey& k2) const;
     };
 
+    using RenderingFormatsHashFn = utils::hash::MurmurHashFn<VulkanRenderingFormats>;
+    struct RenderingFormatsEqualFn {
+        bool operator()(const VulkanRenderingFormats& k1, const VulkanRenderingFormats& k2) const;
+    };
+    static_assert(sizeof(VulkanRenderingFormats) == 44,
+            "VulkanRenderingFormats has unexpected size.");
+
+    // Number of lookups that found or created an object since the last call to getAndResetStats().
+    struct Stats {
+        uint32_t renderPassHits;
+        uint32_t renderPassMisses;
+        uint32_t framebufferHits;
+        uint32_t framebufferMisses;
+        uint32_t renderPassEvictions;
+        uint32_t framebufferEvictions;
+    };
+
     explicit VulkanFboCache(VkDevice device);
     ~VulkanFboCache();
 
@@ -114,6 +126,13 @@ public:
     // Retrieves or creates a VkRenderPass handle.
     VkRenderPass getRenderPass(RenderPassKey config) noexcept;
 
+    // Retrieves the attachment formats that pipelines use with dynamic rendering, in place of the
+    // render pass that would be created for `config`. They are never evicted, so the returned
+    // pointer stays valid (and unique for these formats) until the cache is destroyed.
+    VulkanRenderingFormats const* getRenderingFormats(RenderPassKey const& config) noexcept;
+
+    Stats getAndResetStats() noexcept;
+
     // Evicts old unused Vulkan objects. Call this once per frame.
     void gc() noexcept;
 
@@ -122,10 +141,13 @@ public:
 
 private:
     VkDevice mDevice;
-    tsl::robin_map<FboKey, FboVal, FboKeyHashFn, FboKeyEqualFn> mFramebufferCache;
-    tsl::robin_map<RenderPassKey, RenderPassVal, RenderPassHash, RenderPassEq> mRenderPassCache;
+    utils::GenerationalCache<FboKey, VkFramebuffer, FboKeyHashFn, FboKeyEqualFn>
+            mFramebufferCache;
+    utils::GenerationalCache<RenderPassKey, VkRenderPass, RenderPassHash, RenderPassEq>
+            mRenderPassCache;
     tsl::robin_map<VkRenderPass, uint32_t> mRenderPassRefCount;
-    uint32_t mCurrentTime = 0;
+    tsl::robin_map<VulkanRenderingFormats, std::unique_ptr<VulkanRenderingFormats>,
+            RenderingFormatsHashFn, RenderingFormatsEqualFn> mRenderingFormats;
 };
 
 } // namespace filament::backend
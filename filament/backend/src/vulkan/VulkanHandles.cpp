@@ -95,6 +95,9 @@ void addDescriptors(Bitmask mask,
         }
         if constexpr (std::is_same_v<Bitmask, UniformBufferBitmask>) {
             binding.type = DescriptorType::UNIFORM_BUFFER;
+            if (i < FVK_DYNAMIC_UBO_BINDING_COUNT) {
+                binding.flags = DescriptorFlags::DYNAMIC_OFFSET;
+            }
         } else if constexpr (std::is_same_v<Bitmask, SamplerBitmask>) {
             binding.type = DescriptorType::SAMPLER;
         } else if constexpr (std::is_same_v<Bitmask, InputAttachmentBitmask>) {
@@ -179,7 +182,7 @@ void PushConstantDescription::write(VulkanCommands* commands, VkPipelineLayout l
         int const ival = std::get<int>(value);
         binaryValue = *reinterpret_cast<uint32_t const*>(&ival);
     }
-    vkCmdPushConstants(cmdbuf->buffer(), layout, getVkStage(stage), index * ENTRY_SIZE, ENTRY_SIZE,
+    cmdbuf->cmdPushConstants(layout, getVkStage(stage), index * ENTRY_SIZE, ENTRY_SIZE,
             &binaryValue);
 }
 
@@ -428,9 +428,14 @@ struct VulkanBufferObject : public HwBufferObject, VulkanResource {
 struct VulkanSamplerGroup : public HwSamplerGroup, VulkanResource {
     // NOTE: we have to use out-of-line allocation here because the size of a Handle<> is limited
     std::unique_ptr<SamplerGroup> sb;// FIXME: this shouldn't depend on filament::SamplerGroup
+    // The VkSampler of each descriptor of sb, or VK_NULL_HANDLE if it has no texture. They're
+    // looked up when the group is updated (typically when a material instance is committed),
+    // so that they're not created or looked up while recording draw calls.
+    utils::FixedCapacityVector<VkSampler> samplers;
     explicit VulkanSamplerGroup(size_t size) noexcept
         : VulkanResource(VulkanResourceType::SAMPLER_GROUP),
-          sb(new SamplerGroup(size)) {}
+          sb(new SamplerGroup(size)),
+          samplers(size) {}
 };
 
 struct VulkanRenderPrimitive : public HwRenderPrimitive, VulkanResource {
@@ -484,7 +489,7 @@ private:
     utils::Mutex mFenceMutex;
 };
 
-inline constexpr VkBufferUsageFlagBits getBufferObjectUsage(
+inline constexpr VkBufferUsageFlags getBufferObjectUsage(
         BufferObjectBinding bindingType) noexcept {
     switch(bindingType) {
         case BufferObjectBinding::VERTEX:
@@ -492,7 +497,8 @@ inline constexpr VkBufferUsageFlagBits getBufferObjectUsage(
         case BufferObjectBinding::UNIFORM:
             return VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
         case BufferObjectBinding::SHADER_STORAGE:
-            return VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+            // storage buffers can also hold the arguments of indirect draws
+            return VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
         // when adding more buffer-types here, make sure to update VulkanBuffer::loadFromCpu()
         // if necessary.
     }
@@ -18,6 +18,7 @@
 
 #include "VulkanTexture.h"
 
+#include <utils/compiler.h>
 #include <utils/Panic.h>
 #include <utils/algorithm.h>
 #include <utils/debug.h>
@@ -30,6 +31,9 @@ namespace filament::backend::imgutil {
 
 namespace {
 
+// barriers are only ever recorded on the driver thread
+BarrierStats sBarrierStats{};
+
 inline std::tuple<VkAccessFlags, VkAccessFlags, VkPipelineStageFlags, VkPipelineStageFlags,
         VkImageLayout, VkImageLayout>
 getVkTransition(const VulkanLayoutTransition& transition) {
@@ -133,14 +137,53 @@ getVkTransition(const VulkanLayoutTransition& transition) {
 
 void transitionLayout(VkCommandBuffer cmdbuffer,
         VulkanLayoutTransition transition) {
+    BarrierBatch batch(cmdbuffer);
+    batch.transitionLayout(transition);
+}
+
+void transferOwnership(VkCommandBuffer release, VkCommandBuffer acquire,
+        VulkanLayoutTransition const& transition, uint32_t srcQueueFamilyIndex,
+        uint32_t dstQueueFamilyIndex) {
+    auto [srcAccessMask, dstAccessMask, srcStage, dstStage, oldLayout, newLayout]
+            = getVkTransition(transition);
+
+    // The access masks of the other queue are ignored, only the layouts must match.
+    VkImageMemoryBarrier barrier{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = srcAccessMask,
+            .dstAccessMask = 0,
+            .oldLayout = oldLayout,
+            .newLayout = newLayout,
+            .srcQueueFamilyIndex = srcQueueFamilyIndex,
+            .dstQueueFamilyIndex = dstQueueFamilyIndex,
+            .image = transition.image,
+            .subresourceRange = transition.subresources,
+    };
+    vkCmdPipelineBarrier(release, srcStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+            0, nullptr, 1, &barrier);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = dstAccessMask;
+    vkCmdPipelineBarrier(acquire, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStage, 0, 0, nullptr,
+            0, nullptr, 1, &barrier);
+
+    sBarrierStats.callCount += 2;
+    sBarrierStats.barrierCount += 2;
+}
+
+void BarrierBatch::transitionLayout(VulkanLayoutTransition const& transition) noexcept {
     if (transition.oldLayout == transition.newLayout) {
         return;
     }
     auto [srcAccessMask, dstAccessMask, srcStage, dstStage, oldLayout, newLayout]
             = getVkTransition(transition);
 
+    if (UTILS_UNLIKELY(mCount == CAPACITY)) {
+        flush();
+    }
+
     assert_invariant(transition.image != VK_NULL_HANDLE && "No image for transition");
-    VkImageMemoryBarrier barrier = {
+    mBarriers[mCount++] = {
             .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
             .srcAccessMask = srcAccessMask,
             .dstAccessMask = dstAccessMask,
@@ -151,7 +194,26 @@ void transitionLayout(VkCommandBuffer cmdbuffer,
             .image = transition.image,
             .subresourceRange = transition.subresources,
     };
-    vkCmdPipelineBarrier(cmdbuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    mSrcStage |= srcStage;
+    mDstStage |= dstStage;
+}
+
+void BarrierBatch::flush() noexcept {
+    if (mCount) {
+        vkCmdPipelineBarrier(mCmdBuffer, mSrcStage, mDstStage, 0, 0, nullptr, 0, nullptr,
+                mCount, mBarriers);
+        sBarrierStats.callCount++;
+        sBarrierStats.barrierCount += mCount;
+        mSrcStage = 0;
+        mDstStage = 0;
+        mCount = 0;
+    }
+}
+
+BarrierStats getAndResetBarrierStats() noexcept {
+    BarrierStats const stats = sBarrierStats;
+    sBarrierStats = {};
+    return stats;
 }
 
 }// namespace filament::backend
@@ -137,6 +137,46 @@ constexpr inline VkImageLayout getVkLayout(VulkanLayout layout) {
 
 void transitionLayout(VkCommandBuffer cmdbuffer, VulkanLayoutTransition transition);
 
+// Moves an image from one queue family to another while transitioning its layout. The release
+// half of the barrier is recorded in `release`, which must be submitted to srcQueueFamilyIndex,
+// and the acquire half in `acquire`, which must be submitted to dstQueueFamilyIndex and wait for
+// the release.
+void transferOwnership(VkCommandBuffer release, VkCommandBuffer acquire,
+        VulkanLayoutTransition const& transition, uint32_t srcQueueFamilyIndex,
+        uint32_t dstQueueFamilyIndex);
+
+// Accumulates layout transitions so that they're issued with a single vkCmdPipelineBarrier when
+// the batch is flushed or destroyed. The pipeline stages of all the transitions are merged, which
+// is slightly more conservative than one barrier per transition, but much cheaper.
+class BarrierBatch {
+public:
+    explicit BarrierBatch(VkCommandBuffer cmdbuffer) noexcept : mCmdBuffer(cmdbuffer) {}
+    ~BarrierBatch() noexcept { flush(); }
+
+    BarrierBatch(BarrierBatch const&) = delete;
+    BarrierBatch& operator=(BarrierBatch const&) = delete;
+
+    void transitionLayout(VulkanLayoutTransition const& transition) noexcept;
+
+    // issues the accumulated transitions, if any
+    void flush() noexcept;
+
+private:
+    static constexpr size_t CAPACITY = 16;
+    VkCommandBuffer const mCmdBuffer;
+    VkPipelineStageFlags mSrcStage = 0;
+    VkPipelineStageFlags mDstStage = 0;
+    uint32_t mCount = 0;
+    VkImageMemoryBarrier mBarriers[CAPACITY];
+};
+
+// Number of vkCmdPipelineBarrier calls and of image barriers issued since the last call.
+struct BarrierStats {
+    uint32_t callCount;
+    uint32_t barrierCount;
+};
+BarrierStats getAndResetBarrierStats() noexcept;
+
 } // namespace imgutil
 
 } // namespace filament::backend
@@ -18,10 +18,21 @@
 #include "VulkanMemory.h"
 #include "caching/VulkanDescriptorSetManager.h"
 
+#include <backend/Platform.h>
+
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 #include <utils/Panic.h>
+#include <utils/Systrace.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <string.h>
 
 #include "VulkanConstants.h"
+#include "VulkanContext.h"
 #include "VulkanHandles.h"
 #include "VulkanTexture.h"
 #include "VulkanUtility.h"
@@ -45,6 +56,108 @@ VulkanPipelineCache::~VulkanPipelineCache() {
     // be explicit about teardown order of various components.
 }
 
+void VulkanPipelineCache::initialize(Platform* platform,
+        VkPhysicalDeviceProperties const& properties, uint32_t compilerThreadCount,
+        bool dynamicShadingRate) noexcept {
+    SYSTRACE_CALL();
+    assert_invariant(mVkPipelineCache == VK_NULL_HANDLE);
+
+    mPlatform = platform;
+    mDynamicShadingRate = dynamicShadingRate;
+    memcpy(mBlobKey.tag, "FVK_PIPELINE", sizeof(mBlobKey.tag));
+    mBlobKey.vendorID = properties.vendorID;
+    mBlobKey.deviceID = properties.deviceID;
+    mBlobKey.driverVersion = properties.driverVersion;
+    memcpy(mBlobKey.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+    std::vector<uint8_t> data;
+    if (mPlatform && mPlatform->hasRetrieveBlobFunc()) {
+        // query the size first, retrieveBlob() doesn't write anything if the buffer is too small
+        VkPipelineCacheHeaderVersionOne header;
+        size_t const size = mPlatform->retrieveBlob(&mBlobKey, sizeof(mBlobKey),
+                &header, sizeof(header));
+        if (size >= sizeof(header)) {
+            data.resize(size);
+            mPlatform->retrieveBlob(&mBlobKey, sizeof(mBlobKey), data.data(), size);
+            memcpy(&header, data.data(), sizeof(header));
+            // Some drivers don't validate the data they are given, so we make sure it was
+            // created by the same device and driver.
+            if (header.headerSize < sizeof(header) ||
+                    header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+                    header.vendorID != properties.vendorID ||
+                    header.deviceID != properties.deviceID ||
+                    memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID,
+                            VK_UUID_SIZE) != 0) {
+                FVK_LOGW << "Ignoring incompatible pipeline cache data" << utils::io::endl;
+                data.clear();
+            }
+        }
+    }
+
+    VkPipelineCacheCreateInfo const createInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = data.size(),
+        .pInitialData = data.empty() ? nullptr : data.data(),
+    };
+    VkResult result = vkCreatePipelineCache(mDevice, &createInfo, VKALLOC, &mVkPipelineCache);
+    if (result != VK_SUCCESS && !data.empty()) {
+        // the data could be corrupted, try again without it
+        VkPipelineCacheCreateInfo const emptyCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        };
+        result = vkCreatePipelineCache(mDevice, &emptyCreateInfo, VKALLOC, &mVkPipelineCache);
+    }
+    if (result != VK_SUCCESS) {
+        // pipelines can still be created without a cache
+        FVK_LOGE << "vkCreatePipelineCache error " << result << utils::io::endl;
+        mVkPipelineCache = VK_NULL_HANDLE;
+    }
+
+#if FVK_ENABLED(FVK_DEBUG_PIPELINE_CACHE)
+    FVK_LOGD << "Pipeline cache created with " << data.size() << " bytes" << utils::io::endl;
+#endif
+
+    if (compilerThreadCount) {
+        mCompilerThreadPool.init(compilerThreadCount,
+                []() {
+                    utils::JobSystem::setThreadName("VulkanPipelineCompiler");
+                    // pipelines are usually needed in the next few frames, but they're never as
+                    // urgent as the driver thread
+                    utils::JobSystem::setThreadPriority(utils::JobSystem::Priority::BACKGROUND);
+                },
+                []() {});
+        mCompilerThreadsEnabled = true;
+    }
+}
+
+void VulkanPipelineCache::savePipelineCache() noexcept {
+    if (!mPipelineCacheDirty || mVkPipelineCache == VK_NULL_HANDLE ||
+            !mPlatform || !mPlatform->hasInsertBlobFunc()) {
+        return;
+    }
+    SYSTRACE_CALL();
+    mPipelineCacheDirty = false;
+
+    size_t size = 0;
+    VkResult result = vkGetPipelineCacheData(mDevice, mVkPipelineCache, &size, nullptr);
+    if (result != VK_SUCCESS || size == 0) {
+        return;
+    }
+    std::unique_ptr<uint8_t[]> data(new(std::nothrow) uint8_t[size]);
+    if (UTILS_UNLIKELY(!data)) {
+        return;
+    }
+    // VK_INCOMPLETE means the cache grew in between the two calls, what we have is still valid
+    result = vkGetPipelineCacheData(mDevice, mVkPipelineCache, &size, data.get());
+    if (result == VK_SUCCESS || result == VK_INCOMPLETE) {
+        mPlatform->insertBlob(&mBlobKey, sizeof(mBlobKey), data.get(), size);
+    }
+
+#if FVK_ENABLED(FVK_DEBUG_PIPELINE_CACHE)
+    FVK_LOGD << "Pipeline cache saved with " << size << " bytes" << utils::io::endl;
+#endif
+}
+
 void VulkanPipelineCache::bindLayout(VkPipelineLayout layout) noexcept {
     mPipelineRequirements.layout = layout;
 }
@@ -55,33 +168,142 @@ VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::getOrCreatePipelin
             pipelineIter != mPipelines.end()) {
         auto& pipeline = pipelineIter.value();
         pipeline.lastUsed = mCurrentTime;
+        mStats.hits++;
         return &pipeline;
     }
-    auto ret = createPipeline();
-    ret->lastUsed = mCurrentTime;
+    mStats.misses++;
+    auto ret = mCompilerThreadsEnabled ? getOrQueuePipeline() : createPipeline();
+    if (ret) {
+        ret->lastUsed = mCurrentTime;
+    }
     return ret;
 }
 
-void VulkanPipelineCache::bindPipeline(VulkanCommandBuffer* commands) {
-    VkCommandBuffer const cmdbuffer = commands->buffer();
+VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::getOrQueuePipeline() noexcept {
+    if (PendingPipelineMap::iterator iter = mPendingPipelines.find(mPipelineRequirements);
+            iter != mPendingPipelines.end()) {
+        std::shared_ptr<PipelineCompilation> const compilation = iter->second;
+        if (!compilation->done.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        mPendingPipelines.erase(iter);
+        return addPipeline(*compilation);
+    }
+
+    FVK_SYSTRACE_CONTEXT();
+    FVK_SYSTRACE_START("queuePipeline");
+
+    auto compilation = std::make_shared<PipelineCompilation>();
+    compilation->key = mPipelineRequirements;
+    compilation->requested = mCurrentTime;
+    mPendingPipelines.emplace(mPipelineRequirements, compilation);
+
+    mCompilerThreadPool.queue(CompilerPriorityQueue::HIGH, compilation,
+            [this, compilation]() {
+                SYSTRACE_NAME("createPipeline");
+                VkPipeline const handle = createPipeline(compilation->key);
+                std::unique_lock const lock(mCompilationLock);
+                compilation->handle = handle;
+                compilation->done.store(true, std::memory_order_release);
+                mCompilationCondition.notify_all();
+            });
+
+    FVK_SYSTRACE_END();
+    return nullptr;
+}
+
+void VulkanPipelineCache::wait(PipelineCompilation const& compilation) noexcept {
+    FVK_SYSTRACE_CONTEXT();
+    FVK_SYSTRACE_START("waitPipeline");
+    std::unique_lock lock(mCompilationLock);
+    mCompilationCondition.wait(lock, [&compilation]() {
+        return compilation.done.load(std::memory_order_relaxed);
+    });
+    FVK_SYSTRACE_END();
+}
+
+VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::addPipeline(
+        PipelineCompilation const& compilation) noexcept {
+    assert_invariant(compilation.done);
+    if (compilation.handle == VK_NULL_HANDLE) {
+        return nullptr;
+    }
+    mPipelineCacheDirty = true;
+    mLastPipelineCreationTime = mCurrentTime;
+    return &mPipelines.emplace(compilation.key,
+            PipelineCacheEntry{ compilation.handle, compilation.requested }).first.value();
+}
+
+void VulkanPipelineCache::discardPendingPipelines(VulkanProgram const* program) noexcept {
+    VkShaderModule const vertex = program->getVertexShader();
+    VkShaderModule const fragment = program->getFragmentShader();
+
+    // NOTE: Due to robin_map restrictions, we cannot use auto or range-based loops.
+    using PendingIterator = decltype(mPendingPipelines)::const_iterator;
+    for (PendingIterator iter = mPendingPipelines.begin(); iter != mPendingPipelines.end();) {
+        PipelineCompilation const& compilation = *iter->second;
+        if (compilation.key.shaders[0] != vertex || compilation.key.shaders[1] != fragment) {
+            ++iter;
+            continue;
+        }
+        // If the job was already picked up by a compiler thread, we need to wait for it. The
+        // pipeline was never bound, so it can be destroyed right away.
+        if (!mCompilerThreadPool.dequeue(iter->second)) {
+            wait(compilation);
+            if (compilation.handle != VK_NULL_HANDLE) {
+                vkDestroyPipeline(mDevice, compilation.handle, VKALLOC);
+            }
+        }
+        iter = mPendingPipelines.erase(iter);
+    }
+}
+
+bool VulkanPipelineCache::bindPipeline(VulkanCommandBuffer* commands) {
+    // Consecutive draws very often use the same state, comparing the key is much cheaper than
+    // hashing it. The entry's timestamp is already current since gc() resets mBoundHandle.
+    if (mBoundHandle != VK_NULL_HANDLE && mBoundHandle == commands->pipeline() &&
+            PipelineEqual()(mPipelineRequirements, mBoundPipeline)) {
+        mStats.hits++;
+        return true;
+    }
 
     PipelineCacheEntry* cacheEntry = getOrCreatePipeline();
+
+    // The pipeline is being created asynchronously, or an error occurred. Either way, allow higher
+    // levels to handle it gracefully.
+    if (UTILS_UNLIKELY(!cacheEntry)) {
+        return false;
+    }
+
+    mBoundPipeline = mPipelineRequirements;
+    mBoundHandle = cacheEntry->handle;
+
     // Check if the required pipeline is already bound.
     if (cacheEntry->handle == commands->pipeline()) {
-        return;
+        return true;
     }
 
-    // If an error occurred, allow higher levels to handle it gracefully.
-    assert_invariant(cacheEntry != nullptr && "Failed to create/find pipeline");
-
-    mBoundPipeline = mPipelineRequirements;
-    vkCmdBindPipeline(cmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, cacheEntry->handle);
+    commands->cmdBindPipeline(cacheEntry->handle);
     commands->setPipeline(cacheEntry->handle);
+    return true;
 }
 
 VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::createPipeline() noexcept {
-    assert_invariant(mPipelineRequirements.shaders[0] && "Vertex shader is not bound.");
-    assert_invariant(mPipelineRequirements.layout && "No pipeline layout specified");
+    VkPipeline const handle = createPipeline(mPipelineRequirements);
+    if (handle == VK_NULL_HANDLE) {
+        return nullptr;
+    }
+
+    mPipelineCacheDirty = true;
+    mLastPipelineCreationTime = mCurrentTime;
+
+    return &mPipelines.emplace(mPipelineRequirements,
+            PipelineCacheEntry{ handle, mCurrentTime }).first.value();
+}
+
+VkPipeline VulkanPipelineCache::createPipeline(PipelineKey const& key) const noexcept {
+    assert_invariant(key.shaders[0] && "Vertex shader is not bound.");
+    assert_invariant(key.layout && "No pipeline layout specified");
 
     VkPipelineShaderStageCreateInfo shaderStages[SHADER_MODULE_COUNT];
     shaderStages[0] = VkPipelineShaderStageCreateInfo{};
@@ -102,8 +324,8 @@ VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::createPipeline() n
     colorBlendState.pAttachments = colorBlendAttachments;
 
     // If we reach this point, we need to create and stash a brand new pipeline object.
-    shaderStages[0].module = mPipelineRequirements.shaders[0];
-    shaderStages[1].module = mPipelineRequirements.shaders[1];
+    shaderStages[0].module = key.shaders[0];
+    shaderStages[1].module = key.shaders[1];
 
     // Expand our size-optimized structs into the proper Vk structs.
     uint32_t numVertexAttribs = 0;
@@ -111,12 +333,12 @@ VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::createPipeline() n
     VkVertexInputAttributeDescription vertexAttributes[VERTEX_ATTRIBUTE_COUNT];
     VkVertexInputBindingDescription vertexBuffers[VERTEX_ATTRIBUTE_COUNT];
     for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_COUNT; i++) {
-        if (mPipelineRequirements.vertexAttributes[i].format > 0) {
-            vertexAttributes[numVertexAttribs] = mPipelineRequirements.vertexAttributes[i];
+        if (key.vertexAttributes[i].format > 0) {
+            vertexAttributes[numVertexAttribs] = key.vertexAttributes[i];
             numVertexAttribs++;
         }
-        if (mPipelineRequirements.vertexBuffers[i].stride > 0) {
-            vertexBuffers[numVertexBuffers] = mPipelineRequirements.vertexBuffers[i];
+        if (key.vertexBuffers[i].stride > 0) {
+            vertexBuffers[numVertexBuffers] = key.vertexBuffers[i];
             numVertexBuffers++;
         }
     }
@@ -130,7 +352,7 @@ VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::createPipeline() n
 
     VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = {};
     inputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssemblyState.topology = (VkPrimitiveTopology) mPipelineRequirements.topology;
+    inputAssemblyState.topology = (VkPrimitiveTopology) key.topology;
 
     VkPipelineViewportStateCreateInfo viewportState = {};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -140,19 +362,36 @@ VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::createPipeline() n
     VkDynamicState dynamicStateEnables[] = {
         VK_DYNAMIC_STATE_VIEWPORT,
         VK_DYNAMIC_STATE_SCISSOR,
+        VK_DYNAMIC_STATE_FRAGMENT_SHADING_RATE_KHR,
     };
     VkPipelineDynamicStateCreateInfo dynamicState = {};
     dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
     dynamicState.pDynamicStates = dynamicStateEnables;
-    dynamicState.dynamicStateCount = 2;
+    dynamicState.dynamicStateCount = mDynamicShadingRate ? 3 : 2;
 
     const bool hasFragmentShader = shaderStages[1].module != VK_NULL_HANDLE;
 
     VkGraphicsPipelineCreateInfo pipelineCreateInfo = {};
     pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineCreateInfo.layout = mPipelineRequirements.layout;
-    pipelineCreateInfo.renderPass = mPipelineRequirements.renderPass;
-    pipelineCreateInfo.subpass = mPipelineRequirements.subpassIndex;
+    pipelineCreateInfo.layout = key.layout;
+    pipelineCreateInfo.renderPass = key.renderPass;
+    pipelineCreateInfo.subpass = key.subpassIndex;
+
+    VkPipelineRenderingCreateInfoKHR renderingCreateInfo = {};
+    if (key.dynamicRendering) {
+        VulkanRenderingFormats const& formats = *key.renderingFormats;
+        renderingCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR,
+            .viewMask = formats.viewMask,
+            .colorAttachmentCount = formats.colorAttachmentCount,
+            .pColorAttachmentFormats = formats.colorFormats,
+            .depthAttachmentFormat = formats.depthFormat,
+            .stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+        };
+        pipelineCreateInfo.pNext = &renderingCreateInfo;
+        pipelineCreateInfo.renderPass = VK_NULL_HANDLE;
+        pipelineCreateInfo.subpass = 0;
+    }
     pipelineCreateInfo.stageCount = hasFragmentShader ? SHADER_MODULE_COUNT : 1;
     pipelineCreateInfo.pStages = shaderStages;
     pipelineCreateInfo.pVertexInputState = &vertexInputState;
@@ -179,7 +418,7 @@ VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::createPipeline() n
     };
     pipelineCreateInfo.pDepthStencilState = &vkDs;
 
-    const auto& raster = mPipelineRequirements.rasterState;
+    const auto& raster = key.rasterState;
 
     vkRaster.polygonMode = VK_POLYGON_MODE_FILL;
     vkRaster.cullMode = raster.cullMode;
@@ -210,16 +449,16 @@ VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::createPipeline() n
     pipelineCreateInfo.pDynamicState = &dynamicState;
 
     // Filament assumes consistent blend state across all color attachments.
-    colorBlendState.attachmentCount = mPipelineRequirements.rasterState.colorTargetCount;
+    colorBlendState.attachmentCount = key.rasterState.colorTargetCount;
     for (auto& target : colorBlendAttachments) {
-        target.blendEnable = mPipelineRequirements.rasterState.blendEnable;
-        target.srcColorBlendFactor = mPipelineRequirements.rasterState.srcColorBlendFactor;
-        target.dstColorBlendFactor = mPipelineRequirements.rasterState.dstColorBlendFactor;
-        target.colorBlendOp = (VkBlendOp) mPipelineRequirements.rasterState.colorBlendOp;
-        target.srcAlphaBlendFactor = mPipelineRequirements.rasterState.srcAlphaBlendFactor;
-        target.dstAlphaBlendFactor = mPipelineRequirements.rasterState.dstAlphaBlendFactor;
-        target.alphaBlendOp = (VkBlendOp) mPipelineRequirements.rasterState.alphaBlendOp;
-        target.colorWriteMask = mPipelineRequirements.rasterState.colorWriteMask;
+        target.blendEnable = key.rasterState.blendEnable;
+        target.srcColorBlendFactor = key.rasterState.srcColorBlendFactor;
+        target.dstColorBlendFactor = key.rasterState.dstColorBlendFactor;
+        target.colorBlendOp = (VkBlendOp) key.rasterState.colorBlendOp;
+        target.srcAlphaBlendFactor = key.rasterState.srcAlphaBlendFactor;
+        target.dstAlphaBlendFactor = key.rasterState.dstAlphaBlendFactor;
+        target.alphaBlendOp = (VkBlendOp) key.rasterState.alphaBlendOp;
+        target.colorWriteMask = key.rasterState.colorWriteMask;
     }
 
     // There are no color attachments if there is no bound fragment shader.  (e.g. shadow map gen)
@@ -228,22 +467,24 @@ VulkanPipelineCache::PipelineCacheEntry* VulkanPipelineCache::createPipeline() n
         colorBlendState.attachmentCount = 0;
     }
 
-    PipelineCacheEntry cacheEntry = {};
+    VkPipeline pipeline = VK_NULL_HANDLE;
 
     #if FVK_ENABLED(FVK_DEBUG_SHADER_MODULE)
         FVK_LOGD << "vkCreateGraphicsPipelines with shaders = ("
                  << shaderStages[0].module << ", " << shaderStages[1].module << ")"
                  << utils::io::endl;
     #endif
-    VkResult error = vkCreateGraphicsPipelines(mDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo,
-            VKALLOC, &cacheEntry.handle);
+    auto const startTime = std::chrono::steady_clock::now();
+    VkResult error = vkCreateGraphicsPipelines(mDevice, mVkPipelineCache, 1, &pipelineCreateInfo,
+            VKALLOC, &pipeline);
+    mCreationTimeNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - startTime).count(), std::memory_order_relaxed);
     assert_invariant(error == VK_SUCCESS);
     if (error != VK_SUCCESS) {
         FVK_LOGE << "vkCreateGraphicsPipelines error " << error << utils::io::endl;
-        return nullptr;
+        return VK_NULL_HANDLE;
     }
-
-    return &mPipelines.emplace(mPipelineRequirements, cacheEntry).first.value();
+    return pipeline;
 }
 
 void VulkanPipelineCache::bindProgram(VulkanProgram* program) noexcept {
@@ -266,6 +507,15 @@ void VulkanPipelineCache::bindRasterState(const RasterState& rasterState) noexce
 void VulkanPipelineCache::bindRenderPass(VkRenderPass renderPass, int subpassIndex) noexcept {
     mPipelineRequirements.renderPass = renderPass;
     mPipelineRequirements.subpassIndex = subpassIndex;
+    mPipelineRequirements.dynamicRendering = false;
+}
+
+void VulkanPipelineCache::bindRenderingFormats(VulkanRenderingFormats const* formats) noexcept {
+    // Clear the whole union first, since the key is hashed and compared bytewise.
+    mPipelineRequirements.renderPass = VK_NULL_HANDLE;
+    mPipelineRequirements.renderingFormats = formats;
+    mPipelineRequirements.subpassIndex = 0;
+    mPipelineRequirements.dynamicRendering = true;
 }
 
 void VulkanPipelineCache::bindPrimitiveTopology(VkPrimitiveTopology topology) noexcept {
@@ -287,11 +537,30 @@ void VulkanPipelineCache::bindVertexArray(VkVertexInputAttributeDescription cons
 }
 
 void VulkanPipelineCache::terminate() noexcept {
+    // Queued jobs are dropped, and the ones in flight are finished before the threads exit.
+    if (mCompilerThreadsEnabled) {
+        mCompilerThreadPool.terminate();
+        mCompilerThreadsEnabled = false;
+    }
+    for (auto& iter : mPendingPipelines) {
+        if (iter.second->done && iter.second->handle != VK_NULL_HANDLE) {
+            vkDestroyPipeline(mDevice, iter.second->handle, VKALLOC);
+        }
+    }
+    mPendingPipelines.clear();
+
     for (auto& iter : mPipelines) {
         vkDestroyPipeline(mDevice, iter.second.handle, VKALLOC);
     }
     mPipelines.clear();
     mBoundPipeline = {};
+    mBoundHandle = VK_NULL_HANDLE;
+
+    savePipelineCache();
+    if (mVkPipelineCache != VK_NULL_HANDLE) {
+        vkDestroyPipelineCache(mDevice, mVkPipelineCache, VKALLOC);
+        mVkPipelineCache = VK_NULL_HANDLE;
+    }
 }
 
 void VulkanPipelineCache::gc() noexcept {
@@ -304,6 +573,32 @@ void VulkanPipelineCache::gc() noexcept {
     // The Vulkan spec says: "When a command buffer begins recording, all state in that command
     // buffer is undefined." Therefore, we need to clear all bindings at this time.
     mBoundPipeline = {};
+    mBoundHandle = VK_NULL_HANDLE;
+
+    // Collect the pipelines created since the last gc, even if they haven't been requested again
+    // they'll age out like the others. Compilations that have been running for too long are
+    // waited for, so that draw calls are not skipped indefinitely and so that the render pass
+    // they use is still alive.
+    using PendingIterator = decltype(mPendingPipelines)::const_iterator;
+    for (PendingIterator iter = mPendingPipelines.begin(); iter != mPendingPipelines.end();) {
+        PipelineCompilation const& compilation = *iter->second;
+        if (!compilation.done.load(std::memory_order_acquire)) {
+            if (compilation.requested + FVK_MAX_PIPELINE_COMPILE_DELAY >= mCurrentTime) {
+                ++iter;
+                continue;
+            }
+            wait(compilation);
+        }
+        addPipeline(compilation);
+        iter = mPendingPipelines.erase(iter);
+    }
+
+    // Pipelines tend to be created in bursts (e.g. when a new scene is loaded), so we wait for
+    // things to settle down before writing the cache, which can be several megabytes.
+    if (mPipelineCacheDirty &&
+            mLastPipelineCreationTime + FVK_PIPELINE_CACHE_SAVE_DELAY < mCurrentTime) {
+        savePipelineCache();
+    }
 
     // NOTE: Due to robin_map restrictions, we cannot use auto or range-based loops.
 
@@ -321,6 +616,14 @@ void VulkanPipelineCache::gc() noexcept {
    }
 }
 
+VulkanPipelineCache::Stats VulkanPipelineCache::getAndResetStats() noexcept {
+    Stats stats = mStats;
+    stats.pipelineCount = uint32_t(mPipelines.size());
+    stats.creationTimeUs = uint32_t(mCreationTimeNs.exchange(0, std::memory_order_relaxed) / 1000);
+    mStats = {};
+    return stats;
+}
+
 bool VulkanPipelineCache::PipelineEqual::operator()(const PipelineKey& k1,
         const PipelineKey& k2) const {
     return 0 == memcmp((const void*) &k1, (const void*) &k2, sizeof(k1));
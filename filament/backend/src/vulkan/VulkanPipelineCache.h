@@ -17,6 +17,7 @@
 #ifndef TNT_FILAMENT_BACKEND_VULKANPIPELINECACHE_H
 #define TNT_FILAMENT_BACKEND_VULKANPIPELINECACHE_H
 
+#include "CompilerThreadPool.h"
 #include "VulkanCommands.h"
 #include "VulkanMemory.h"
 #include "VulkanResources.h"
@@ -31,9 +32,13 @@
 
 #include <utils/bitset.h>
 #include <utils/compiler.h>
+#include <utils/Condition.h>
 #include <utils/Hash.h>
+#include <utils/Mutex.h>
 
+#include <atomic>
 #include <list>
+#include <memory>
 #include <tsl/robin_map.h>
 #include <type_traits>
 #include <vector>
@@ -41,8 +46,10 @@
 
 namespace filament::backend {
 
+class Platform;
 struct VulkanProgram;
 struct VulkanBufferObject;
+struct VulkanRenderingFormats;
 struct VulkanTexture;
 class VulkanResourceAllocator;
 
@@ -118,18 +125,50 @@ public:
 
     void bindLayout(VkPipelineLayout layout) noexcept;
 
-    // Creates a new pipeline if necessary and binds it using vkCmdBindPipeline.
-    void bindPipeline(VulkanCommandBuffer* commands);
+    // Creates a new pipeline if necessary and binds it using vkCmdBindPipeline. Returns false if
+    // the pipeline is not ready yet, in which case the draw calls using it should be skipped.
+    bool bindPipeline(VulkanCommandBuffer* commands);
 
     // Each of the following methods are fast and do not make Vulkan calls.
     void bindProgram(VulkanProgram* program) noexcept;
     void bindRasterState(const RasterState& rasterState) noexcept;
     void bindRenderPass(VkRenderPass renderPass, int subpassIndex) noexcept;
+
+    // Pipelines bound after this are created for dynamic rendering with the given formats, which
+    // must outlive the pipeline cache (see VulkanFboCache::getRenderingFormats).
+    void bindRenderingFormats(VulkanRenderingFormats const* formats) noexcept;
+
+    // Returns the formats bound with bindRenderingFormats(), or null if a render pass is bound.
+    VulkanRenderingFormats const* getBoundRenderingFormats() const noexcept {
+        return mPipelineRequirements.dynamicRendering ? mPipelineRequirements.renderingFormats
+                                                      : nullptr;
+    }
     void bindPrimitiveTopology(VkPrimitiveTopology topology) noexcept;
 
     void bindVertexArray(VkVertexInputAttributeDescription const* attribDesc,
             VkVertexInputBindingDescription const* bufferDesc, uint8_t count);
 
+    // Creates the VkPipelineCache used for all pipelines, seeded with the data previously saved
+    // through the platform's blob cache, if any. The cache data is keyed by the device and the
+    // driver version, and is written back to the blob cache when new pipelines are created.
+    //
+    // When compilerThreadCount is not zero, pipelines are created by that many background threads
+    // the first time they're needed, and bindPipeline() fails until they are ready. A pipeline
+    // that takes longer than FVK_MAX_PIPELINE_COMPILE_DELAY submissions is waited for by gc().
+    //
+    // When dynamicShadingRate is true, the fragment shading rate of all pipelines is a dynamic
+    // state, which must be set with vkCmdSetFragmentShadingRateKHR in each render pass.
+    void initialize(Platform* platform, VkPhysicalDeviceProperties const& properties,
+            uint32_t compilerThreadCount, bool dynamicShadingRate) noexcept;
+
+    // Drops the pipelines being created for the given program, waiting for those that are
+    // in flight. This must be called before the program's shader modules can be destroyed.
+    void discardPendingPipelines(VulkanProgram const* program) noexcept;
+
+    // Writes the VkPipelineCache data to the platform's blob cache if pipelines were created
+    // since it was last written.
+    void savePipelineCache() noexcept;
+
     // Destroys all managed Vulkan objects. This should be called before changing the VkDevice.
     void terminate() noexcept;
 
@@ -150,6 +189,17 @@ public:
 
     void gc() noexcept;
 
+    // Pipeline lookups since the last call to getAndResetStats(). A bind of the same state as the
+    // previous one is counted as a hit without hashing the key.
+    struct Stats {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t pipelineCount;     // number of pipelines in the cache
+        uint32_t creationTimeUs;    // time spent in vkCreateGraphicsPipelines, on all threads
+    };
+
+    Stats getAndResetStats() noexcept;
+
 private:
     // PIPELINE CACHE KEY
     // ------------------
@@ -196,13 +246,16 @@ private:
     // VkPipeline object. The size:offset comments below are expressed in bytes.
     struct PipelineKey {                                                          // size : offset
         VkShaderModule shaders[SHADER_MODULE_COUNT];                              //  16  : 0
-        VkRenderPass renderPass;                                                  //  8   : 16
+        union {                                                                   //  8   : 16
+            VkRenderPass renderPass;
+            VulkanRenderingFormats const* renderingFormats; // when dynamicRendering is set
+        };
         uint16_t topology;                                                        //  2   : 24
         uint16_t subpassIndex;                                                    //  2   : 26
         VertexInputAttributeDescription vertexAttributes[VERTEX_ATTRIBUTE_COUNT]; //  128 : 28
         VertexInputBindingDescription vertexBuffers[VERTEX_ATTRIBUTE_COUNT];      //  128 : 156
         RasterState rasterState;                                                  //  16  : 284
-        uint32_t padding;                                                         //  4   : 300
+        uint32_t dynamicRendering;                                                //  4   : 300
         VkPipelineLayout layout;                                                  //  8   : 304
     };
 
@@ -242,12 +295,47 @@ private:
     using PipelineMap = tsl::robin_map<PipelineKey, PipelineCacheEntry,
             PipelineHashFn, PipelineEqual>;
 
+    // A pipeline being created by one of the compiler threads. The token is used to cancel the
+    // job while it's still queued.
+    struct PipelineCompilation : public ProgramToken {
+        PipelineKey key;
+        Timestamp requested;
+        VkPipeline handle = VK_NULL_HANDLE; // only valid once done is true
+        std::atomic_bool done{ false };
+    };
+
+    using PendingPipelineMap = tsl::robin_map<PipelineKey, std::shared_ptr<PipelineCompilation>,
+            PipelineHashFn, PipelineEqual>;
+
 private:
 
     PipelineCacheEntry* getOrCreatePipeline() noexcept;
 
+    // Returns the pipeline if it was created by a compiler thread, queues its creation otherwise.
+    PipelineCacheEntry* getOrQueuePipeline() noexcept;
+
+    // Blocks until the given compilation has finished.
+    void wait(PipelineCompilation const& compilation) noexcept;
+
+    // Moves a finished compilation to mPipelines, returns nullptr if its creation failed.
+    PipelineCacheEntry* addPipeline(PipelineCompilation const& compilation) noexcept;
+
     PipelineMap mPipelines;
 
+    // Only accessed by the driver thread, the compiler threads only touch the compilations.
+    PendingPipelineMap mPendingPipelines;
+
+    CompilerThreadPool mCompilerThreadPool;
+    bool mCompilerThreadsEnabled = false;
+    utils::Mutex mCompilationLock;
+    utils::Condition mCompilationCondition;
+
+    // This can be called from any thread. Vulkan allows concurrent vkCreateGraphicsPipelines calls
+    // on the same device and VkPipelineCache: the implementation synchronizes the cache
+    // internally, only the destination cache of vkMergePipelineCaches needs external
+    // synchronization.
+    VkPipeline createPipeline(PipelineKey const& key) const noexcept;
+
     // These helpers all return unstable pointers that should not be stored.
     PipelineCacheEntry* createPipeline() noexcept;
     PipelineLayoutCacheEntry* getOrCreatePipelineLayout() noexcept;
@@ -256,11 +344,38 @@ private:
     VkDevice mDevice = VK_NULL_HANDLE;
     VmaAllocator mAllocator = VK_NULL_HANDLE;
 
+    bool mDynamicShadingRate = false;
+
+    // Persistent cache shared by all the pipelines, and the state needed to save it.
+    struct BlobKey {
+        char tag[12];
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+    };
+    static_assert(sizeof(BlobKey) == 40, "BlobKey must not have implicit padding.");
+
+    VkPipelineCache mVkPipelineCache = VK_NULL_HANDLE;
+    Platform* mPlatform = nullptr;
+    BlobKey mBlobKey = {};
+    bool mPipelineCacheDirty = false;
+    Timestamp mLastPipelineCreationTime = 0;
+
     // Current requirements for the pipeline layout, pipeline, and descriptor sets.
     PipelineKey mPipelineRequirements = {};
 
     // Current bindings for the pipeline and descriptor sets.
     PipelineKey mBoundPipeline = {};
+
+    // The pipeline created for mBoundPipeline, used to skip the lookup when the same state is
+    // bound again in the same command buffer.
+    VkPipeline mBoundHandle = VK_NULL_HANDLE;
+
+    Stats mStats = {};
+
+    // Updated by the compiler threads.
+    mutable std::atomic<uint64_t> mCreationTimeNs{ 0 };
 };
 
 } // namespace filament::backend
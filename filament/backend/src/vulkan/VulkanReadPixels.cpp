@@ -24,6 +24,8 @@
 
 #include <utils/Log.h>
 
+#include <algorithm>
+
 using namespace bluevk;
 
 namespace filament::backend {
@@ -107,11 +109,18 @@ void VulkanReadPixels::terminate() noexcept {
     if (mCommandPool == VK_NULL_HANDLE) {
         return;
     }
-    vkDestroyCommandPool(mDevice, mCommandPool, VKALLOC);
-    mDevice = VK_NULL_HANDLE;
 
+    // Shutting down the handler returns the staging images of pending requests to the pool.
     mTaskHandler->shutdown();
     mTaskHandler.reset();
+
+    for (StagingImage const& staging: mPool) {
+        destroyStagingImage(staging);
+    }
+    mPool.clear();
+
+    vkDestroyCommandPool(mDevice, mCommandPool, VKALLOC);
+    mDevice = VK_NULL_HANDLE;
 }
 
 VulkanReadPixels::VulkanReadPixels(VkDevice device)
@@ -141,76 +150,22 @@ void VulkanReadPixels::run(VulkanRenderTarget* srcTarget, uint32_t const x, uint
         mTaskHandler = std::make_unique<TaskHandler>();
     }
 
-    VkCommandPool& cmdpool = mCommandPool;
-
     VulkanTexture* srcTexture = srcTarget->getColor(0).texture;
     assert_invariant(srcTexture);
     VkFormat const srcFormat = srcTexture->getVkFormat();
     bool const swizzle
             = srcFormat == VK_FORMAT_B8G8R8A8_UNORM || srcFormat == VK_FORMAT_B8G8R8A8_SRGB;
 
-    // Create a host visible, linearly tiled image as a staging area.
-    VkImageCreateInfo const imageInfo{
-            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-            .imageType = VK_IMAGE_TYPE_2D,
-            .format = srcFormat,
-            .extent = {width, height, 1},
-            .mipLevels = 1,
-            .arrayLayers = 1,
-            .samples = VK_SAMPLE_COUNT_1_BIT,
-            .tiling = VK_IMAGE_TILING_LINEAR,
-            .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-    };
-
-    VkImage stagingImage;
-    vkCreateImage(device, &imageInfo, VKALLOC, &stagingImage);
+    StagingImage const staging = acquireStagingImage(srcFormat, width, height, selectMemoryFunc);
+    VkImage const stagingImage = staging.image;
+    VkCommandBuffer const cmdbuffer = staging.cmdbuffer;
 
 #if FVK_ENABLED(FVK_DEBUG_READ_PIXELS)
-    FVK_LOGD << "readPixels created image=" << stagingImage
+    FVK_LOGD << "readPixels using image=" << stagingImage
              << " to copy from image=" << srcTexture->getVkImage()
              << " src-layout=" << srcTexture->getLayout(0, 0) << utils::io::endl;
 #endif
 
-    VkMemoryRequirements memReqs;
-    VkDeviceMemory stagingMemory;
-    vkGetImageMemoryRequirements(device, stagingImage, &memReqs);
-
-    uint32_t memoryTypeIndex = selectMemoryFunc(memReqs.memoryTypeBits,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-                    | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
-
-    // If VK_MEMORY_PROPERTY_HOST_CACHED_BIT is not supported, we try only
-    // HOST_VISIBLE+HOST_COHERENT.  HOST_CACHED helps a lot with readpixels performance.
-    if (memoryTypeIndex >= VK_MAX_MEMORY_TYPES) {
-        memoryTypeIndex = selectMemoryFunc(memReqs.memoryTypeBits,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        FVK_LOGW
-                << "readPixels is slow because VK_MEMORY_PROPERTY_HOST_CACHED_BIT is not available"
-                << utils::io::endl;
-    }
-
-    FILAMENT_CHECK_POSTCONDITION(memoryTypeIndex < VK_MAX_MEMORY_TYPES)
-            << "VulkanReadPixels: unable to find a memory type that meets requirements.";
-
-    VkMemoryAllocateInfo const allocInfo = {
-            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-            .allocationSize = memReqs.size,
-            .memoryTypeIndex = memoryTypeIndex,
-    };
-
-    vkAllocateMemory(device, &allocInfo, VKALLOC, &stagingMemory);
-    vkBindImageMemory(device, stagingImage, stagingMemory, 0);
-
-    VkCommandBuffer cmdbuffer;
-    VkCommandBufferAllocateInfo const allocateInfo{
-            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-            .commandPool = cmdpool,
-            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-            .commandBufferCount = 1,
-    };
-    vkAllocateCommandBuffers(device, &allocateInfo, &cmdbuffer);
-
     VkCommandBufferBeginInfo const binfo{
             .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
             .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
@@ -274,11 +229,6 @@ void VulkanReadPixels::run(VulkanRenderTarget* srcTarget, uint32_t const x, uint
 
     VkQueue queue;
     vkGetDeviceQueue(device, graphicsQueueFamilyIndex, 0, &queue);
-    VkFence readCompleteFence;
-    VkFenceCreateInfo const fenceCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-    };
-    vkCreateFence(device, &fenceCreateInfo, VKALLOC, &readCompleteFence);
     VkSubmitInfo const submitInfo{
             .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
             .waitSemaphoreCount = 0,
@@ -289,50 +239,154 @@ void VulkanReadPixels::run(VulkanRenderTarget* srcTarget, uint32_t const x, uint
             .signalSemaphoreCount = 0,
             .pSignalSemaphores = VK_NULL_HANDLE,
     };
-    vkQueueSubmit(queue, 1, &submitInfo, readCompleteFence);
+    vkQueueSubmit(queue, 1, &submitInfo, staging.fence);
 
     auto* const pUserBuffer = new PixelBufferDescriptor(std::move(pbd));
-    auto cleanPbdFunc = [pUserBuffer, readCompleteFunc]() {
+    auto cleanPbdFunc = [this, staging, pUserBuffer, readCompleteFunc]() {
+        releaseStagingImage(staging);
         PixelBufferDescriptor& p = *pUserBuffer;
         readCompleteFunc(std::move(p));
         delete pUserBuffer;
     };
-    auto waitFenceFunc = [device, width, height, swizzle, srcFormat, stagingImage, stagingMemory,
-                                 cmdpool, cmdbuffer, pUserBuffer,
-                                 fence = readCompleteFence]() mutable {
-        VkResult status = vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+    auto waitFenceFunc = [device, width, height, swizzle, srcFormat, staging,
+                                 pUserBuffer]() mutable {
+        VkResult status = vkWaitForFences(device, 1, &staging.fence, VK_TRUE, UINT64_MAX);
         // Fence hasn't been reached. Try waiting again.
         if (status != VK_SUCCESS) {
             FVK_LOGE << "Failed to wait for readPixels fence" << utils::io::endl;
             return;
         }
 
+        // The staging memory stays mapped, so the pixels are reshaped straight from it into the
+        // client's buffer.
         PixelBufferDescriptor& p = *pUserBuffer;
-        VkImageSubresource subResource{.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT};
-        VkSubresourceLayout subResourceLayout;
-        vkGetImageSubresourceLayout(device, stagingImage, &subResource, &subResourceLayout);
-
-        // Map image memory so that we can start copying from it.
-        uint8_t const* srcPixels;
-        vkMapMemory(device, stagingMemory, 0, VK_WHOLE_SIZE, 0, (void**) &srcPixels);
-        srcPixels += subResourceLayout.offset;
-
         if (!DataReshaper::reshapeImage(&p, getComponentType(srcFormat),
-                    getComponentCount(srcFormat), srcPixels,
-                    static_cast<int>(subResourceLayout.rowPitch), static_cast<int>(width),
+                    getComponentCount(srcFormat), staging.pixels,
+                    static_cast<int>(staging.rowPitch), static_cast<int>(width),
                     static_cast<int>(height), swizzle)) {
             FVK_LOGE << "Unsupported PixelDataFormat or PixelDataType" << utils::io::endl;
         }
-
-        vkUnmapMemory(device, stagingMemory);
-        vkDestroyImage(device, stagingImage, VKALLOC);
-        vkFreeMemory(device, stagingMemory, VKALLOC);
-        vkDestroyFence(device, fence, VKALLOC);
-        vkFreeCommandBuffers(device, cmdpool, 1, &cmdbuffer);
     };
     mTaskHandler->post(std::move(waitFenceFunc), std::move(cleanPbdFunc));
 }
 
+VulkanReadPixels::StagingImage VulkanReadPixels::acquireStagingImage(VkFormat const format,
+        uint32_t const width, uint32_t const height,
+        SelecteMemoryFunction const& selectMemoryFunc) {
+    {
+        std::unique_lock<std::mutex> lock(mPoolMutex);
+        auto const iter = std::find_if(mPool.begin(), mPool.end(),
+                [format, width, height](StagingImage const& staging) {
+                    return staging.format == format && staging.width == width &&
+                           staging.height == height;
+                });
+        if (iter != mPool.end()) {
+            StagingImage const staging = *iter;
+            mPool.erase(iter);
+            return staging;
+        }
+    }
+
+    VkDevice const device = mDevice;
+    StagingImage staging{
+            .format = format,
+            .width = width,
+            .height = height,
+    };
+
+    // Create a host visible, linearly tiled image as a staging area.
+    VkImageCreateInfo const imageInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = format,
+            .extent = {width, height, 1},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_LINEAR,
+            .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    vkCreateImage(device, &imageInfo, VKALLOC, &staging.image);
+
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(device, staging.image, &memReqs);
+
+    uint32_t memoryTypeIndex = selectMemoryFunc(memReqs.memoryTypeBits,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+                    | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+
+    // If VK_MEMORY_PROPERTY_HOST_CACHED_BIT is not supported, we try only
+    // HOST_VISIBLE+HOST_COHERENT.  HOST_CACHED helps a lot with readpixels performance.
+    if (memoryTypeIndex >= VK_MAX_MEMORY_TYPES) {
+        memoryTypeIndex = selectMemoryFunc(memReqs.memoryTypeBits,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        FVK_LOGW
+                << "readPixels is slow because VK_MEMORY_PROPERTY_HOST_CACHED_BIT is not available"
+                << utils::io::endl;
+    }
+
+    FILAMENT_CHECK_POSTCONDITION(memoryTypeIndex < VK_MAX_MEMORY_TYPES)
+            << "VulkanReadPixels: unable to find a memory type that meets requirements.";
+
+    VkMemoryAllocateInfo const allocInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .allocationSize = memReqs.size,
+            .memoryTypeIndex = memoryTypeIndex,
+    };
+    vkAllocateMemory(device, &allocInfo, VKALLOC, &staging.memory);
+    vkBindImageMemory(device, staging.image, staging.memory, 0);
+
+    VkImageSubresource const subResource{.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT};
+    VkSubresourceLayout subResourceLayout;
+    vkGetImageSubresourceLayout(device, staging.image, &subResource, &subResourceLayout);
+
+    // The memory stays mapped for the lifetime of the staging image.
+    uint8_t* pixels;
+    vkMapMemory(device, staging.memory, 0, VK_WHOLE_SIZE, 0, (void**) &pixels);
+    staging.pixels = pixels + subResourceLayout.offset;
+    staging.rowPitch = subResourceLayout.rowPitch;
+
+    VkCommandBufferAllocateInfo const allocateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = mCommandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+    };
+    vkAllocateCommandBuffers(device, &allocateInfo, &staging.cmdbuffer);
+
+    VkFenceCreateInfo const fenceCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+    vkCreateFence(device, &fenceCreateInfo, VKALLOC, &staging.fence);
+
+#if FVK_ENABLED(FVK_DEBUG_READ_PIXELS)
+    FVK_LOGD << "readPixels created image=" << staging.image << utils::io::endl;
+#endif
+
+    return staging;
+}
+
+void VulkanReadPixels::releaseStagingImage(StagingImage const& staging) {
+    vkResetFences(mDevice, 1, &staging.fence);
+
+    std::unique_lock<std::mutex> lock(mPoolMutex);
+    if (mPool.size() >= MAX_POOL_SIZE) {
+        // Evict the least recently used image.
+        destroyStagingImage(mPool.front());
+        mPool.erase(mPool.begin());
+    }
+    mPool.push_back(staging);
+}
+
+void VulkanReadPixels::destroyStagingImage(StagingImage const& staging) {
+    vkUnmapMemory(mDevice, staging.memory);
+    vkDestroyImage(mDevice, staging.image, VKALLOC);
+    vkFreeMemory(mDevice, staging.memory, VKALLOC);
+    vkDestroyFence(mDevice, staging.fence, VKALLOC);
+    vkFreeCommandBuffers(mDevice, mCommandPool, 1, &staging.cmdbuffer);
+}
+
 void VulkanReadPixels::runUntilComplete() noexcept {
     if (!mTaskHandler) {
         return;
@@ -27,6 +27,7 @@
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 namespace filament::backend {
 
@@ -81,9 +82,38 @@ public:
     void runUntilComplete() noexcept;
 
 private:
+    // A host visible, persistently mapped image that the render target is copied into, along
+    // with the command buffer and fence used for the copy. These are recycled across calls
+    // instead of being created for each readPixels.
+    struct StagingImage {
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        uint8_t const* pixels = nullptr;
+        VkDeviceSize rowPitch = 0;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        VkCommandBuffer cmdbuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+    };
+
+    // Number of idle staging images kept around for reuse.
+    static constexpr size_t MAX_POOL_SIZE = 4;
+
+    StagingImage acquireStagingImage(VkFormat format, uint32_t width, uint32_t height,
+            SelecteMemoryFunction const& selectMemoryFunc);
+
+    // Can be called from the task handler thread.
+    void releaseStagingImage(StagingImage const& staging);
+
+    void destroyStagingImage(StagingImage const& staging);
+
     VkDevice mDevice = VK_NULL_HANDLE;
     VkCommandPool mCommandPool = VK_NULL_HANDLE;
     std::unique_ptr<TaskHandler> mTaskHandler;
+
+    std::mutex mPoolMutex;
+    std::vector<StagingImage> mPool;
 };
 
 }// namespace filament::backend
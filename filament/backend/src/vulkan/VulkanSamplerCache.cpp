@@ -99,9 +99,8 @@ VulkanSamplerCache::VulkanSamplerCache(VkDevice device)
     : mDevice(device) {}
 
 VkSampler VulkanSamplerCache::getSampler(SamplerParams params) noexcept {
-    auto iter = mCache.find(params);
-    if (UTILS_LIKELY(iter != mCache.end())) {
-        return iter->second;
+    if (VkSampler const* sampler = mCache.find(params)) {
+        return *sampler;
     }
     VkSamplerCreateInfo samplerInfo {
         .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
@@ -123,14 +122,14 @@ VkSampler VulkanSamplerCache::getSampler(SamplerParams params) noexcept {
     VkSampler sampler;
     VkResult error = vkCreateSampler(mDevice, &samplerInfo, VKALLOC, &sampler);
     FILAMENT_CHECK_POSTCONDITION(!error) << "Unable to create sampler.";
-    mCache.insert({params, sampler});
+    mCache.insert(params, sampler);
     return sampler;
 }
 
 void VulkanSamplerCache::terminate() noexcept {
-    for (auto pair : mCache) {
-        vkDestroySampler(mDevice, pair.second, VKALLOC);
-    }
+    mCache.forEach([this](SamplerParams const&, VkSampler sampler) {
+        vkDestroySampler(mDevice, sampler, VKALLOC);
+    });
     mCache.clear();
 }
 
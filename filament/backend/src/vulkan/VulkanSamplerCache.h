@@ -20,7 +20,7 @@
 #include "VulkanContext.h"
 #include "VulkanUtility.h"
 
-#include <tsl/robin_map.h>
+#include <utils/GenerationalCache.h>
 
 namespace filament::backend {
 
@@ -30,9 +30,14 @@ public:
     explicit VulkanSamplerCache(VkDevice device);
     VkSampler getSampler(SamplerParams params) noexcept;
     void terminate() noexcept;
+
+    // Lookups since the last call. Samplers are never evicted, descriptor sets can keep using them.
+    auto getAndResetStats() noexcept { return mCache.getAndResetStats(); }
+
 private:
     VkDevice mDevice;
-    tsl::robin_map<SamplerParams, VkSampler, SamplerParams::Hasher, SamplerParams::EqualTo> mCache;
+    utils::GenerationalCache<SamplerParams, VkSampler,
+            SamplerParams::Hasher, SamplerParams::EqualTo> mCache;
 };
 
 } // namespace filament::backend
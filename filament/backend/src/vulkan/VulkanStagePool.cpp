@@ -23,8 +23,18 @@
 
 #include <utils/Panic.h>
 
+#include <string.h>
+
 static constexpr uint32_t TIME_BEFORE_EVICTION = FVK_MAX_COMMAND_BUFFERS;
 
+// Size of the blocks of the staging arena, uploads larger than ARENA_MAX_UPLOAD_SIZE use a stage
+// from the pool instead, so that a few of them don't use up a whole block.
+static constexpr uint32_t ARENA_BLOCK_SIZE = 1024 * 1024;
+static constexpr uint32_t ARENA_MAX_UPLOAD_SIZE = ARENA_BLOCK_SIZE / 16;
+
+// vkCmdCopyBuffer doesn't require any alignment, but keep the copies nicely aligned.
+static constexpr uint32_t ARENA_ALIGNMENT = 16;
+
 namespace filament::backend {
 
 VulkanStagePool::VulkanStagePool(VmaAllocator allocator, VulkanCommands* commands)
@@ -32,14 +42,18 @@ VulkanStagePool::VulkanStagePool(VmaAllocator allocator, VulkanCommands* command
       mCommands(commands) {}
 
 VulkanStage const* VulkanStagePool::acquireStage(uint32_t numBytes) {
+    mStatistics.bytesUploaded += numBytes;
+
     // First check if a stage exists whose capacity is greater than or equal to the requested size.
     auto iter = mFreeStages.lower_bound(numBytes);
     if (iter != mFreeStages.end()) {
         auto stage = iter->second;
         mFreeStages.erase(iter);
         mUsedStages.insert(stage);
+        mStatistics.stageHits++;
         return stage;
     }
+    mStatistics.stageMisses++;
     // We were not able to find a sufficiently large stage, so create a new one.
     VulkanStage* stage = new VulkanStage({
         .memory = VK_NULL_HANDLE,
@@ -68,6 +82,69 @@ VulkanStage const* VulkanStagePool::acquireStage(uint32_t numBytes) {
     return stage;
 }
 
+VulkanStageArea VulkanStagePool::upload(void const* data, uint32_t numBytes) {
+    if (numBytes > ARENA_MAX_UPLOAD_SIZE) {
+        VulkanStage const* stage = acquireStage(numBytes);
+        void* mapped;
+        vmaMapMemory(mAllocator, stage->memory, &mapped);
+        memcpy(mapped, data, numBytes);
+        vmaUnmapMemory(mAllocator, stage->memory);
+        vmaFlushAllocation(mAllocator, stage->memory, 0, numBytes);
+        return { stage->buffer, 0 };
+    }
+
+    uint32_t offset = (mArenaHead + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    if (UTILS_UNLIKELY(!mArenaBlock || offset + numBytes > ARENA_BLOCK_SIZE)) {
+        if (mArenaBlock) {
+            mArenaBlock->lastAccessed = mCurrentFrame;
+            mFullArenaBlocks.push_back(mArenaBlock);
+        }
+        mArenaBlock = acquireArenaBlock();
+        offset = 0;
+    }
+
+    memcpy(static_cast<char*>(mArenaBlock->mapped) + offset, data, numBytes);
+    vmaFlushAllocation(mAllocator, mArenaBlock->memory, offset, numBytes);
+    mArenaHead = offset + numBytes;
+
+    // a block currently in use can't be reclaimed until the frame after it's full
+    mArenaBlock->lastAccessed = mCurrentFrame;
+
+    mStatistics.arenaAllocations++;
+    mStatistics.bytesUploaded += numBytes;
+    return { mArenaBlock->buffer, offset };
+}
+
+VulkanStagePool::ArenaBlock* VulkanStagePool::acquireArenaBlock() {
+    if (!mFreeArenaBlocks.empty()) {
+        ArenaBlock* const block = mFreeArenaBlocks.back();
+        mFreeArenaBlocks.pop_back();
+        return block;
+    }
+
+    ArenaBlock* const block = new ArenaBlock{};
+    VkBufferCreateInfo const bufferInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = ARENA_BLOCK_SIZE,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    };
+    VmaAllocationCreateInfo const allocInfo{
+        .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_CPU_ONLY,
+    };
+    VmaAllocationInfo info{};
+    UTILS_UNUSED_IN_RELEASE VkResult result = vmaCreateBuffer(mAllocator, &bufferInfo,
+            &allocInfo, &block->buffer, &block->memory, &info);
+    assert_invariant(result == VK_SUCCESS);
+    block->mapped = info.pMappedData;
+    return block;
+}
+
+void VulkanStagePool::destroyArenaBlock(ArenaBlock* block) noexcept {
+    vmaDestroyBuffer(mAllocator, block->buffer, block->memory);
+    delete block;
+}
+
 VulkanStageImage const* VulkanStagePool::acquireImage(PixelDataFormat format, PixelDataType type,
         uint32_t width, uint32_t height) {
     const VkFormat vkformat = getVkFormat(format, type);
@@ -162,6 +239,28 @@ void VulkanStagePool::gc() noexcept {
         }
     }
 
+    // Destroy arena blocks that have not been used for several frames, and reclaim the full ones
+    // that are no longer being used by any command buffer.
+    decltype(mFreeArenaBlocks) freeArenaBlocks;
+    freeArenaBlocks.swap(mFreeArenaBlocks);
+    for (auto block : freeArenaBlocks) {
+        if (block->lastAccessed < evictionTime) {
+            destroyArenaBlock(block);
+        } else {
+            mFreeArenaBlocks.push_back(block);
+        }
+    }
+    decltype(mFullArenaBlocks) fullArenaBlocks;
+    fullArenaBlocks.swap(mFullArenaBlocks);
+    for (auto block : fullArenaBlocks) {
+        if (block->lastAccessed < evictionTime) {
+            block->lastAccessed = mCurrentFrame;
+            mFreeArenaBlocks.push_back(block);
+        } else {
+            mFullArenaBlocks.push_back(block);
+        }
+    }
+
     // Destroy images that have not been used for several frames.
     decltype(mFreeImages) freeImages;
     freeImages.swap(mFreeImages);
@@ -189,6 +288,26 @@ void VulkanStagePool::gc() noexcept {
 }
 
 void VulkanStagePool::terminate() noexcept {
+#if FVK_ENABLED(FVK_DEBUG_ALLOCATION)
+    FVK_LOGD << "Stage pool: " << mStatistics.stageHits << " hits, "
+             << mStatistics.stageMisses << " misses, "
+             << mStatistics.arenaAllocations << " arena allocations, "
+             << mStatistics.bytesUploaded << " bytes uploaded" << utils::io::endl;
+#endif
+
+    if (mArenaBlock) {
+        destroyArenaBlock(mArenaBlock);
+        mArenaBlock = nullptr;
+    }
+    for (auto block : mFullArenaBlocks) {
+        destroyArenaBlock(block);
+    }
+    mFullArenaBlocks.clear();
+    for (auto block : mFreeArenaBlocks) {
+        destroyArenaBlock(block);
+    }
+    mFreeArenaBlocks.clear();
+
     for (auto stage : mUsedStages) {
         vmaDestroyBuffer(mAllocator, stage->buffer, stage->memory);
         delete stage;
@@ -23,6 +23,7 @@
 
 #include <map>
 #include <unordered_set>
+#include <vector>
 
 namespace filament::backend {
 
@@ -34,6 +35,12 @@ struct VulkanStage {
     mutable uint64_t lastAccessed;
 };
 
+// A range of a staging buffer, which can be used as the source of a transfer.
+struct VulkanStageArea {
+    VkBuffer buffer;
+    VkDeviceSize offset;
+};
+
 struct VulkanStageImage {
     VkFormat format;
     uint32_t width;
@@ -53,6 +60,11 @@ public:
     // The stage is automatically released back to the pool after TIME_BEFORE_EVICTION frames.
     VulkanStage const* acquireStage(uint32_t numBytes);
 
+    // Copies the given data into a staging area that can be used by the current command buffer.
+    // Small uploads are bump-allocated from persistently mapped blocks, which avoids a lookup and
+    // a map / unmap for each of them, larger ones use a stage from acquireStage().
+    VulkanStageArea upload(void const* data, uint32_t numBytes);
+
     // Images have VK_IMAGE_LAYOUT_GENERAL and must not be transitioned to any other layout
     VulkanStageImage const* acquireImage(PixelDataFormat format, PixelDataType type,
             uint32_t width, uint32_t height);
@@ -64,7 +76,26 @@ public:
     // This should be called while the context's VkDevice is still alive.
     void terminate() noexcept;
 
+    struct Statistics {
+        uint64_t stageHits = 0;         // stages reused from the pool
+        uint64_t stageMisses = 0;       // stages that had to be created
+        uint64_t arenaAllocations = 0;  // uploads bump-allocated from the arena
+        uint64_t bytesUploaded = 0;     // bytes staged through either path
+    };
+
+    Statistics const& getStatistics() const noexcept { return mStatistics; }
+
 private:
+    struct ArenaBlock {
+        VmaAllocation memory;
+        VkBuffer buffer;
+        void* mapped;
+        uint64_t lastAccessed;
+    };
+
+    ArenaBlock* acquireArenaBlock();
+    void destroyArenaBlock(ArenaBlock* block) noexcept;
+
     VmaAllocator mAllocator;
     VulkanCommands* mCommands;
 
@@ -77,6 +108,15 @@ private:
     std::unordered_set<VulkanStageImage const*> mFreeImages;
     std::unordered_set<VulkanStageImage const*> mUsedImages;
 
+    // The arena block being bump-allocated from, full blocks wait for the command buffers that
+    // use them to complete before they are reused.
+    ArenaBlock* mArenaBlock = nullptr;
+    uint32_t mArenaHead = 0;
+    std::vector<ArenaBlock*> mFullArenaBlocks;
+    std::vector<ArenaBlock*> mFreeArenaBlocks;
+
+    Statistics mStatistics;
+
     // Store the current "time" (really just a frame count) and LRU eviction parameters.
     uint64_t mCurrentFrame = 0;
 };
@@ -158,6 +158,14 @@ VulkanTexture::VulkanTexture(VkDevice device, VkPhysicalDevice physicalDevice,
     this->samples = samples;
     imageInfo.samples = (VkSampleCountFlagBits) samples;
 
+    // An attachment whose content doesn't outlive a render pass can be lazily allocated, which on
+    // tiled GPUs means it never gets memory backing. This is only allowed for attachments.
+    constexpr VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    if (any(usage & TextureUsage::MEMORYLESS) && !(imageInfo.usage & ~attachmentUsage)) {
+        imageInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+    }
+
     VkResult error = vkCreateImage(mDevice, &imageInfo, VKALLOC, &mTextureImage);
     if (error || FVK_ENABLED(FVK_DEBUG_TEXTURE)) {
         FVK_LOGD << "vkCreateImage: "
@@ -176,24 +184,34 @@ VulkanTexture::VulkanTexture(VkDevice device, VkPhysicalDevice physicalDevice,
     }
     FILAMENT_CHECK_POSTCONDITION(!error) << "Unable to create image.";
 
-    // Allocate memory for the VkImage and bind it.
+    // Allocate memory for the VkImage and bind it. Textures are sub-allocated from VMA's blocks,
+    // which keeps the number of VkDeviceMemory objects low and the memory visible to VMA's
+    // statistics. Large attachments get their own allocation instead, so that render targets,
+    // which are reallocated whenever the resolution changes, don't fragment the blocks that hold
+    // long-lived textures.
     VkMemoryRequirements memReqs = {};
     vkGetImageMemoryRequirements(mDevice, mTextureImage, &memReqs);
 
-    uint32_t memoryTypeIndex
-            = context.selectMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-    FILAMENT_CHECK_POSTCONDITION(memoryTypeIndex < VK_MAX_MEMORY_TYPES)
-            << "VulkanTexture: unable to find a memory type that meets requirements.";
+    VmaAllocationCreateInfo allocInfo = { .usage = VMA_MEMORY_USAGE_GPU_ONLY };
+    if ((imageInfo.usage & attachmentUsage) && memReqs.size >= FVK_MIN_DEDICATED_ATTACHMENT_SIZE) {
+        allocInfo.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+    }
 
-    VkMemoryAllocateInfo allocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = memReqs.size,
-        .memoryTypeIndex = memoryTypeIndex,
-    };
-    error = vkAllocateMemory(mDevice, &allocInfo, nullptr, &mTextureImageMemory);
+    error = VK_ERROR_FEATURE_NOT_PRESENT;
+    if (imageInfo.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) {
+        // desktop GPUs usually don't have lazily allocated memory
+        VmaAllocationCreateInfo const lazyAllocInfo = {
+            .usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED,
+        };
+        error = vmaAllocateMemoryForImage(mAllocator, mTextureImage, &lazyAllocInfo,
+                &mTextureImageMemory, nullptr);
+    }
+    if (error) {
+        error = vmaAllocateMemoryForImage(mAllocator, mTextureImage, &allocInfo,
+                &mTextureImageMemory, nullptr);
+    }
     FILAMENT_CHECK_POSTCONDITION(!error) << "Unable to allocate image memory.";
-    error = vkBindImageMemory(mDevice, mTextureImage, mTextureImageMemory, 0);
+    error = vmaBindImageMemory(mAllocator, mTextureImageMemory, mTextureImage);
     FILAMENT_CHECK_POSTCONDITION(!error) << "Unable to bind image.";
 
     uint32_t layerCount = 0;
@@ -239,7 +257,7 @@ VulkanTexture::VulkanTexture(VkDevice device, VkPhysicalDevice physicalDevice,
 VulkanTexture::~VulkanTexture() {
     if (mTextureImageMemory != VK_NULL_HANDLE) {
         vkDestroyImage(mDevice, mTextureImage, VKALLOC);
-        vkFreeMemory(mDevice, mTextureImageMemory, VKALLOC);
+        vmaFreeMemory(mAllocator, mTextureImageMemory);
     }
     for (auto entry : mCachedImageViews) {
         vkDestroyImageView(mDevice, entry.second, VKALLOC);
@@ -329,6 +347,33 @@ void VulkanTexture::updateImage(const PixelBufferDescriptor& data, uint32_t widt
         nextLayout = imgutil::getDefaultLayout(this->usage);
     }
 
+    // Subresources that have never been written don't need to be released by the graphics queue
+    // before they're written by the transfer queue, so they can be uploaded there, which is the
+    // common case for streamed textures.
+    VulkanCommands* const transfer = mCommands->getTransferCommands();
+    if (transfer && isUndefined(transitionRange)) {
+        VulkanCommandBuffer& transferCommands = transfer->get();
+        VkCommandBuffer const transferCmdbuf = transferCommands.buffer();
+        transferCommands.acquire(this);
+
+        imgutil::transitionLayout(transferCmdbuf, {
+                .image = mTextureImage,
+                .oldLayout = VulkanLayout::UNDEFINED,
+                .newLayout = newLayout,
+                .subresources = transitionRange,
+        });
+        vkCmdCopyBufferToImage(transferCmdbuf, stage->buffer, mTextureImage, newVkLayout, 1,
+                &copyRegion);
+        imgutil::transferOwnership(transferCmdbuf, cmdbuf, {
+                .image = mTextureImage,
+                .oldLayout = newLayout,
+                .newLayout = nextLayout,
+                .subresources = transitionRange,
+        }, transfer->getQueueFamilyIndex(), mCommands->getQueueFamilyIndex());
+        setLayout(transitionRange, nextLayout);
+        return;
+    }
+
     transitionLayout(cmdbuf, transitionRange, newLayout);
 
     vkCmdCopyBufferToImage(cmdbuf, stage->buffer, mTextureImage, newVkLayout, 1, &copyRegion);
@@ -427,6 +472,12 @@ VkImageAspectFlags VulkanTexture::getImageAspect() const {
 
 void VulkanTexture::transitionLayout(VkCommandBuffer cmdbuf, const VkImageSubresourceRange& range,
         VulkanLayout newLayout) {
+    imgutil::BarrierBatch batch(cmdbuf);
+    transitionLayout(batch, range, newLayout);
+}
+
+void VulkanTexture::transitionLayout(imgutil::BarrierBatch& batch,
+        const VkImageSubresourceRange& range, VulkanLayout newLayout) {
 
     VulkanLayout const oldLayout = getLayout(range.baseArrayLayer, range.baseMipLevel);
 
@@ -466,7 +517,7 @@ void VulkanTexture::transitionLayout(VkCommandBuffer cmdbuf, const VkImageSubres
         for (uint32_t i = firstLayer; i < lastLayer; ++i) {
             for (uint32_t j = firstLevel; j < lastLevel; ++j) {
                 VulkanLayout const layout = getLayout(i, j);
-                imgutil::transitionLayout(cmdbuf, {
+                batch.transitionLayout({
                         .image = mTextureImage,
                         .oldLayout = layout,
                         .newLayout = newLayout,
@@ -481,7 +532,7 @@ void VulkanTexture::transitionLayout(VkCommandBuffer cmdbuf, const VkImageSubres
             }
         }
     } else {
-        imgutil::transitionLayout(cmdbuf, {
+        batch.transitionLayout({
             .image = mTextureImage,
             .oldLayout = oldLayout,
             .newLayout = newLayout,
@@ -516,6 +567,18 @@ void VulkanTexture::setLayout(const VkImageSubresourceRange& range, VulkanLayout
     }
 }
 
+bool VulkanTexture::isUndefined(VkImageSubresourceRange const& range) const {
+    for (uint32_t layer = 0; layer < range.layerCount; ++layer) {
+        for (uint32_t level = 0; level < range.levelCount; ++level) {
+            if (getLayout(range.baseArrayLayer + layer, range.baseMipLevel + level) !=
+                    VulkanLayout::UNDEFINED) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 VulkanLayout VulkanTexture::getLayout(uint32_t layer, uint32_t level) const {
     assert_invariant(level <= 0xffff && layer <= 0xffff);
     const uint32_t key = (layer << 16) | level;
@@ -88,6 +88,9 @@ struct VulkanTexture : public HwTexture, VulkanResource {
 
     VulkanLayout getLayout(uint32_t layer, uint32_t level) const;
 
+    // Returns true if none of the subresources in the range has been written yet.
+    bool isUndefined(VkImageSubresourceRange const& range) const;
+
     void setSidecar(VulkanTexture* sidecar) {
         mSidecarMSAA.reset(sidecar);
     }
@@ -99,6 +102,11 @@ struct VulkanTexture : public HwTexture, VulkanResource {
     void transitionLayout(VkCommandBuffer commands, const VkImageSubresourceRange& range,
             VulkanLayout newLayout);
 
+    // Same as above, but the barriers are added to the given batch, which must be flushed before
+    // the texture is used. The tracked layout is updated immediately.
+    void transitionLayout(imgutil::BarrierBatch& batch, const VkImageSubresourceRange& range,
+            VulkanLayout newLayout);
+
     // Returns the preferred data plane of interest for all image views.
     // For now this always returns either DEPTH or COLOR.
     VkImageAspectFlags getImageAspect() const;
@@ -148,7 +156,7 @@ private:
     const VkImageViewType mViewType;
     const VkComponentMapping mSwizzle;
     VkImage mTextureImage = VK_NULL_HANDLE;
-    VkDeviceMemory mTextureImageMemory = VK_NULL_HANDLE;
+    VmaAllocation mTextureImageMemory = VK_NULL_HANDLE;    // null if the image isn't owned
 
     // Track the image layout of each subresource using a sparse range map.
     utils::RangeMap<uint32_t, VulkanLayout> mSubresourceLayouts;
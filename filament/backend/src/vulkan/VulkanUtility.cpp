@@ -378,6 +378,18 @@ VkFrontFace getFrontFace(bool inverseFrontFaces) {
             VkFrontFace::VK_FRONT_FACE_CLOCKWISE : VkFrontFace::VK_FRONT_FACE_COUNTER_CLOCKWISE;
 }
 
+VkExtent2D getFragmentSize(ShadingRate shadingRate) {
+    // these are the rates that all implementations of pipelineFragmentShadingRate support
+    switch (shadingRate) {
+        case ShadingRate::RATE_1x1: return { 1, 1 };
+        case ShadingRate::RATE_1x2: return { 1, 2 };
+        case ShadingRate::RATE_2x1: return { 2, 1 };
+        case ShadingRate::RATE_2x2: return { 2, 2 };
+    }
+    assert_invariant(false && "Unknown shading rate.");
+    return { 1, 1 };
+}
+
 PixelDataType getComponentType(VkFormat format) {
     switch (format) {
         case VK_FORMAT_R8_UNORM:
@@ -26,8 +26,10 @@
 
 #include <math.h>
 
+#include <algorithm>
 #include <memory>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 namespace filament::backend {
@@ -389,7 +391,7 @@ struct UBOKey {
 
     static inline UBOKey key(UBOMap const& uboMap, VulkanDescriptorSetLayout* layout) {
         UBOKey ret{
-                .count = (uint8_t) layout->count.ubo,
+                .count = (uint8_t) (layout->count.ubo + layout->count.dynamicUbo),
         };
         uint8_t count = 0;
         for (uint8_t binding: layout->bindings.ubo) {
@@ -402,6 +404,17 @@ struct UBOKey {
             }// else we keep them as VK_NULL_HANDLE and 0s.
             count++;
         }
+        // The offsets of dynamic bindings are given when the set is bound, so the same set can be
+        // used for all the ranges of a buffer.
+        for (uint8_t binding: layout->bindings.dynamicUbo) {
+            auto const& [info, obj] = uboMap[binding];
+            ret.bindings[count] = binding;
+            if (obj) {
+                ret.buffers[count] = info.buffer;
+                ret.sizes[count] = info.range;
+            }
+            count++;
+        }
         return ret;
     }
 
@@ -494,31 +507,42 @@ public:
             return;
         }
 
-        auto const& popped = mLRU.pop((size_t) (size * LRU_REDUCTION_FACTOR), nFramesAgo);
-        for (auto p: popped) {
-            mCache.erase(p);
-            mResources.release(p);
+        // The recency of a set is only recorded on lookup, so the least recently used sets are
+        // found here, once per frame, rather than keeping an ordered structure up to date on
+        // every bind.
+        mEvictions.clear();
+        mCache.forEach([this, nFramesAgo](SetPtr set, uint64_t lastUsed) {
+            if (lastUsed <= nFramesAgo) {
+                mEvictions.push_back({ lastUsed, set });
+            }
+        });
+
+        size_t const popCount = std::min(mEvictions.size(), size_t(size * LRU_REDUCTION_FACTOR));
+        if (popCount < mEvictions.size()) {
+            std::nth_element(mEvictions.begin(), mEvictions.begin() + popCount, mEvictions.end());
+        }
+        for (size_t i = 0; i < popCount; i++) {
+            SetPtr const set = mEvictions[i].second;
+            mCache.erase(set);
+            mResources.release(set);
         }
     }
 
     inline SetPtr get(Key const& key) {
-        if (auto itr = mCache.find(key); itr != mCache.end()) {
-            auto const& ret = itr->second;
-            mLRU.update(ret, (mFrame << 32) | mId++);
-            return ret;
+        if (auto* entry = mCache.find(key); entry) {
+            entry->lastUsed = (mFrame << 32) | mId++;
+            return entry->set;
         }
         return nullptr;
     }
 
     void put(Key const& key, SetPtr set) {
-        mLRU.update(set, (mFrame << 32) | mId++);
-        mCache.put(key, set);
+        mCache.put(key, set, (mFrame << 32) | mId++);
         mResources.acquire(set);
     }
 
     void erase(SetPtr set) {
         mCache.erase(set);
-        mLRU.erase(set);
         mResources.release(set);
     }
 
@@ -528,14 +552,19 @@ public:
 
 private:
     struct BiMap {
+        struct Entry {
+            SetPtr set;
+            uint64_t lastUsed;
+        };
+
         using ForwardMap
-                = std::unordered_map<Key, SetPtr, typename Key::HashFn, typename Key::Equal>;
+                = std::unordered_map<Key, Entry, typename Key::HashFn, typename Key::Equal>;
 
-        typename ForwardMap::const_iterator find(Key const& key) const {
-            return forward.find(key);
-        }
-        typename ForwardMap::const_iterator end() const {
-            return forward.end();
+        Entry* find(Key const& key) {
+            if (auto itr = forward.find(key); itr != forward.end()) {
+                return &itr->second;
+            }
+            return nullptr;
         }
 
         inline size_t size() const {
@@ -544,27 +573,28 @@ private:
 
         void erase(Key const& key) {
             if (auto itr = forward.find(key); itr != forward.end()) {
-                auto const& ptr = itr->second;
-                forward.erase(key);
-                backward.erase(ptr);
+                backward.erase(itr->second.set);
+                forward.erase(itr);
             }
         }
 
         void erase(SetPtr ptr) {
             if (auto itr = backward.find(ptr); itr != backward.end()) {
-                auto const& key = itr->second;
-                forward.erase(key);
-                backward.erase(ptr);
+                forward.erase(itr->second);
+                backward.erase(itr);
             }
         }
 
-        void put(Key const& key, SetPtr ptr) {
-            forward[key] = ptr;
+        void put(Key const& key, SetPtr ptr, uint64_t lastUsed) {
+            forward[key] = { ptr, lastUsed };
             backward[ptr] = key;
         }
 
-        SetPtr const& get(Key const& key) {
-            return forward[key];
+        template<typename F>
+        void forEach(F&& f) const {
+            for (auto const& [key, entry]: forward) {
+                f(entry.set, entry.lastUsed);
+            }
         }
 
     private:
@@ -572,64 +602,14 @@ private:
         std::unordered_map<SetPtr, Key> backward;
     };
 
-    struct PriorityQueue {
-        void update(SetPtr const& ptr, uint64_t priority) {
-            if (auto itr = backward.find(ptr); itr != backward.end()) {
-                auto const& priority = itr->second;
-                forward.erase(priority);
-                forward[priority] = ptr;
-                backward[ptr] = priority;
-            } else {
-                backward[ptr] = priority;
-                forward[priority] = ptr;
-            }
-        }
-
-        void erase(SetPtr ptr) {
-            if (auto itr = backward.find(ptr); itr != backward.end()) {
-                auto const& priority = itr->second;
-                forward.erase(priority);
-                backward.erase(ptr);
-            }
-        }
-
-        void erase(uint64_t priority) {
-            if (auto itr = forward.find(priority); itr != forward.end()) {
-                auto const& ptr = itr->second;
-                backward.erase(ptr);
-                forward.erase(itr);
-            }
-        }
-
-        // Pop the lowest `popCount` elements that are equal or less than `priority`
-        utils::FixedCapacityVector<SetPtr> pop(size_t popCount, uint64_t priority) {
-            utils::FixedCapacityVector<SetPtr> evictions
-                    = utils::FixedCapacityVector<SetPtr>::with_capacity(popCount);
-            for (auto itr = forward.begin(); itr != forward.end() && popCount > 0;
-                    itr++, popCount--) {
-                auto const& [ipriority, ival] = *itr;
-                if (ipriority > priority) {
-                    break;
-                }
-                evictions.push_back(ival);
-            }
-            for (auto p: evictions) {
-                erase(p);
-            }
-            return evictions;
-        }
-
-    private:
-        std::map<uint64_t, SetPtr> forward;
-        std::unordered_map<SetPtr, uint64_t> backward;
-    };
-
     uint64_t mFrame;
     uint64_t mId;
 
     BiMap mCache;
-    PriorityQueue mLRU;
     VulkanResourceManager mResources;
+
+    // scratch storage for gc(), kept around to avoid an allocation each frame
+    std::vector<std::pair<uint64_t, SetPtr>> mEvictions;
 };
 
 // TODO: Obsolete after [GDSR].
@@ -713,6 +693,28 @@ private:
                 VulkanDescriptorSetLayout::UNIQUE_DESCRIPTOR_SET_COUNT);
     }
 
+    // The offsets of the dynamic bindings of the UBO set, in binding order. The offsets of unused
+    // bindings are left at 0.
+    struct DynamicOffsets {
+        uint32_t count = 0;
+        uint32_t offsets[MAX_UBO_BINDING] = {};
+
+        bool operator==(DynamicOffsets const& rhs) const noexcept {
+            return count == rhs.count &&
+                   std::equal(offsets, offsets + count, rhs.offsets);
+        }
+        bool operator!=(DynamicOffsets const& rhs) const noexcept { return !(*this == rhs); }
+    };
+
+    DynamicOffsets getDynamicOffsets(VulkanDescriptorSetLayout const* layout) const noexcept {
+        DynamicOffsets ret;
+        for (uint8_t binding: layout->bindings.dynamicUbo) {
+            auto const& [info, ubo] = mUboMap[binding];
+            ret.offsets[ret.count++] = ubo ? uint32_t(info.offset) : 0u;
+        }
+        return ret;
+    }
+
     struct BoundState {
         BoundState()
             : cmdbuf(VK_NULL_HANDLE),
@@ -720,7 +722,8 @@ private:
               vkSets(initDescSetHandles()) {}
 
         inline bool operator==(BoundState const& b) const {
-            if (cmdbuf != b.cmdbuf || pipelineLayout != b.pipelineLayout) {
+            if (cmdbuf != b.cmdbuf || pipelineLayout != b.pipelineLayout ||
+                    dynamicOffsets != b.dynamicOffsets) {
                 return false;
             }
             for (size_t i = 0; i < vkSets.size(); ++i) {
@@ -743,6 +746,7 @@ private:
         VkPipelineLayout pipelineLayout;
         DescriptorSetVkHandles vkSets;
         VulkanDescriptorSetLayoutList layouts;
+        DynamicOffsets dynamicOffsets;
     };
 
     static constexpr uint8_t UBO_SET_ID = 0;
@@ -778,7 +782,9 @@ public:
         VulkanDescriptorSetLayoutList outLayouts = layouts;
         DescriptorSetVkHandles vkDescSets = initDescSetHandles();
         VkWriteDescriptorSet descriptorWrites[MAX_BINDINGS];
+        VkDescriptorBufferInfo dynamicInfos[MAX_UBO_BINDING];
         uint32_t nwrites = 0;
+        DynamicOffsets dynamicOffsets;
 
         // Use placeholders when necessary
         for (uint8_t i = 0; i < VulkanDescriptorSetLayout::UNIQUE_DESCRIPTOR_SET_COUNT; ++i) {
@@ -791,7 +797,7 @@ public:
             } else {
                 outLayouts[i] = layouts[i];
                 auto p = mAllocator->handle_cast<VulkanDescriptorSetLayout*>(layouts[i]);
-                if (!((i == UBO_SET_ID && p->bitmask.ubo)
+                if (!((i == UBO_SET_ID && (p->bitmask.ubo || p->bitmask.dynamicUbo))
                         || (i == SAMPLER_SET_ID && p->bitmask.sampler)
                         || (i == INPUT_ATTACHMENT_SET_ID && p->bitmask.inputAttachment
                                 && mInputAttachment.first.texture))) {
@@ -813,6 +819,10 @@ public:
             commands->acquire(set);
             vkDescSets.push_back(vkSet);
 
+            if (i == UBO_SET_ID) {
+                dynamicOffsets = getDynamicOffsets(layout);
+            }
+
             // Note that we still need to bind the set, but 'cached' means that we found a set with
             // the exact same content already written, and we would just bind that one instead.
             // We also don't need to write to the placeholder set.
@@ -822,21 +832,7 @@ public:
 
             switch (i) {
                 case UBO_SET_ID: {
-                    for (uint8_t binding: layout->bindings.ubo) {
-                        auto const& [info, ubo] = mUboMap[binding];
-                        descriptorWrites[nwrites++] = {
-                                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                                .pNext = nullptr,
-                                .dstSet = vkSet,
-                                .dstBinding = binding,
-                                .descriptorCount = 1,
-                                .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                                .pBufferInfo = ubo ? &info : &mPlaceHolderBufferInfo,
-                        };
-                        if (ubo) {
-                            set->resources.acquire(ubo);
-                        }
-                    }
+                    writeUbos(set, layout, descriptorWrites, nwrites, dynamicInfos);
                     break;
                 }
                 case SAMPLER_SET_ID: {
@@ -887,10 +883,35 @@ public:
         state.pipelineLayout = pipelineLayout;
         state.vkSets = vkDescSets;
         state.layouts = layouts;
+        state.dynamicOffsets = dynamicOffsets;
 
         if (state != mBoundState) {
-            vkCmdBindDescriptorSets(cmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0,
-                    vkDescSets.size(), vkDescSets.data(), 0, nullptr);
+            uint32_t first = 0;
+            uint32_t last = vkDescSets.size();
+            if (mBoundState.cmdbuf == cmdbuffer && mBoundState.pipelineLayout == pipelineLayout &&
+                    mBoundState.vkSets.size() == vkDescSets.size()) {
+                // Sets stay bound as long as the pipeline layout doesn't change, so only the
+                // range of sets that changed needs to be bound, typically just the samplers when
+                // switching from a material instance to another. The UBO set is also rebound
+                // when only its dynamic offsets changed.
+                auto const unchanged = [&](uint32_t i) {
+                    return vkDescSets[i] == mBoundState.vkSets[i] &&
+                           (i != UBO_SET_ID || dynamicOffsets == mBoundState.dynamicOffsets);
+                };
+                while (first < last && unchanged(first)) {
+                    first++;
+                }
+                while (last > first && unchanged(last - 1)) {
+                    last--;
+                }
+            }
+            if (first < last) {
+                // Only the UBO set has dynamic bindings.
+                bool const hasOffsets = first == UBO_SET_ID && dynamicOffsets.count;
+                commands->cmdBindDescriptorSets(pipelineLayout, first, last - first,
+                        vkDescSets.data() + first, hasOffsets ? dynamicOffsets.count : 0,
+                        hasOffsets ? dynamicOffsets.offsets : nullptr);
+            }
             mBoundState = state;
         }
 
@@ -905,6 +926,7 @@ public:
         }
         mInputAttachment = {};
         mHaveDynamicUbos = false;
+        mUboSetChanged = false;
 
         FVK_SYSTRACE_END();
         return pipelineLayout;
@@ -922,42 +944,36 @@ public:
 
         auto layout = mAllocator->handle_cast<VulkanDescriptorSetLayout*>(
                 mBoundState.layouts[UBO_SET_ID]);
-
-        // Note that this is costly, instead just use dynamic UBOs with dynamic offsets.
-        auto const& [set, cached] = getSet(UBO_SET_ID, layout);
-        VkDescriptorSet const vkSet = set->vkSet;
-
-        if (!cached) {
-            VkWriteDescriptorSet descriptorWrites[MAX_UBO_BINDING];
-            uint8_t nwrites = 0;
-
-            for (uint8_t binding: layout->bindings.ubo) {
-                auto const& [info, ubo] = mUboMap[binding];
-                descriptorWrites[nwrites++] = {
-                        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                        .pNext = nullptr,
-                        .dstSet = vkSet,
-                        .dstBinding = binding,
-                        .descriptorCount = 1,
-                        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                        .pBufferInfo = ubo ? &info : &mPlaceHolderBufferInfo,
-                };
-                if (ubo) {
-                    set->resources.acquire(ubo);
+        DynamicOffsets const dynamicOffsets = getDynamicOffsets(layout);
+
+        // When only the offsets of dynamic bindings changed, which is the case for the
+        // per-renderable data, the bound set is still valid and doesn't need to be looked up.
+        VkDescriptorSet vkSet = mBoundState.vkSets[UBO_SET_ID];
+        if (mUboSetChanged) {
+            auto const& [set, cached] = getSet(UBO_SET_ID, layout);
+            vkSet = set->vkSet;
+
+            if (!cached) {
+                VkWriteDescriptorSet descriptorWrites[MAX_UBO_BINDING];
+                VkDescriptorBufferInfo dynamicInfos[MAX_UBO_BINDING];
+                uint32_t nwrites = 0;
+                writeUbos(set, layout, descriptorWrites, nwrites, dynamicInfos);
+                if (nwrites > 0) {
+                    vkUpdateDescriptorSets(mDevice, nwrites, descriptorWrites, 0, nullptr);
                 }
             }
-            if (nwrites > 0) {
-                vkUpdateDescriptorSets(mDevice, nwrites, descriptorWrites, 0, nullptr);
-            }
+            commands->acquire(set);
         }
-        commands->acquire(set);
 
-        if (mBoundState.vkSets[UBO_SET_ID] != vkSet) {
-            vkCmdBindDescriptorSets(mBoundState.cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    mBoundState.pipelineLayout, 0, 1, &vkSet, 0, nullptr);
+        if (mBoundState.vkSets[UBO_SET_ID] != vkSet ||
+                mBoundState.dynamicOffsets != dynamicOffsets) {
+            commands->cmdBindDescriptorSets(mBoundState.pipelineLayout, 0, 1, &vkSet,
+                    dynamicOffsets.count, dynamicOffsets.count ? dynamicOffsets.offsets : nullptr);
             mBoundState.vkSets[UBO_SET_ID] = vkSet;
+            mBoundState.dynamicOffsets = dynamicOffsets;
         }
         mHaveDynamicUbos = false;
+        mUboSetChanged = false;
         FVK_SYSTRACE_END();
     }
 
@@ -983,6 +999,11 @@ public:
                 .offset = offset,
                 .range = size,
         };
+        auto const& [current, currentObject] = mUboMap[binding];
+        if (binding >= FVK_DYNAMIC_UBO_BINDING_COUNT || currentObject != bufferObject ||
+                current.range != size) {
+            mUboSetChanged = true;
+        }
         mUboMap[binding] = {info, bufferObject};
         mResources.acquire(bufferObject);
 
@@ -1028,6 +1049,7 @@ public:
             mResources.release(ubo);
         }
         mUboMap[binding] = {{}, nullptr};
+        mUboSetChanged = true;
     }
 
     void setPlaceHolders(VkSampler sampler, VulkanTexture* texture,
@@ -1046,6 +1068,7 @@ public:
 
     void clearState() noexcept {
         mHaveDynamicUbos = false;
+        mUboSetChanged = false;
         if (mInputAttachment.first.texture) {
             mResources.release(mInputAttachment.first.texture);
         }
@@ -1058,6 +1081,47 @@ public:
     }
 
 private:
+    // Appends the writes of the UBO set, the infos of the dynamic bindings are stored in
+    // dynamicInfos since their offsets are given at bind time instead.
+    void writeUbos(VulkanDescriptorSet* set, VulkanDescriptorSetLayout const* layout,
+            VkWriteDescriptorSet* descriptorWrites, uint32_t& nwrites,
+            VkDescriptorBufferInfo* dynamicInfos) {
+        for (uint8_t binding: layout->bindings.ubo) {
+            auto const& [info, ubo] = mUboMap[binding];
+            descriptorWrites[nwrites++] = {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .pNext = nullptr,
+                    .dstSet = set->vkSet,
+                    .dstBinding = binding,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                    .pBufferInfo = ubo ? &info : &mPlaceHolderBufferInfo,
+            };
+            if (ubo) {
+                set->resources.acquire(ubo);
+            }
+        }
+        uint32_t ndynamic = 0;
+        for (uint8_t binding: layout->bindings.dynamicUbo) {
+            auto const& [info, ubo] = mUboMap[binding];
+            VkDescriptorBufferInfo& dynamicInfo = dynamicInfos[ndynamic++];
+            dynamicInfo = ubo ? info : mPlaceHolderBufferInfo;
+            dynamicInfo.offset = 0;
+            descriptorWrites[nwrites++] = {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .pNext = nullptr,
+                    .dstSet = set->vkSet,
+                    .dstBinding = binding,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+                    .pBufferInfo = &dynamicInfo,
+            };
+            if (ubo) {
+                set->resources.acquire(ubo);
+            }
+        }
+    }
+
     inline std::pair<VulkanDescriptorSet*, bool> getSet(uint8_t const setIndex,
             VulkanDescriptorSetLayout* layout) {
         switch (setIndex) {
@@ -1125,6 +1189,9 @@ private:
     LayoutCache mLayoutCache;
     DescriptorSetCache mDescriptorSetCache;
     bool mHaveDynamicUbos;
+    // Whether a UBO binding changed other than the offset of a dynamic binding since the set
+    // was last bound.
+    bool mUboSetChanged = false;
     UBOMap mUboMap;
     SamplerMap mSamplerMap;
     std::pair<VulkanAttachment, VkDescriptorImageInfo> mInputAttachment;
@@ -52,9 +52,17 @@ VkPipelineLayout VulkanPipelineLayoutCache::getLayout(
         }
     }
 
+    // Programs sharing the same layout are usually drawn back to back, skip the hash for those.
+    if (mLastEntry && PipelineLayoutKeyEqual()(key, mLastKey)) {
+        mLastEntry->lastUsed = mTimestamp++;
+        return mLastEntry->handle;
+    }
+
     if (auto iter = mPipelineLayouts.find(key); iter != mPipelineLayouts.end()) {
         PipelineLayoutCacheEntry& entry = iter->second;
         entry.lastUsed = mTimestamp++;
+        mLastKey = key;
+        mLastEntry = &entry;
         return entry.handle;
     }
 
@@ -70,10 +78,13 @@ VkPipelineLayout VulkanPipelineLayoutCache::getLayout(
     VkPipelineLayout layout;
     vkCreatePipelineLayout(mDevice, &info, VKALLOC, &layout);
 
-    mPipelineLayouts[key] = {
+    PipelineLayoutCacheEntry& entry = mPipelineLayouts[key];
+    entry = {
         .handle = layout,
         .lastUsed = mTimestamp++,
     };
+    mLastKey = key;
+    mLastEntry = &entry;
     return layout;
 }
 
@@ -81,6 +92,8 @@ void VulkanPipelineLayoutCache::terminate() noexcept {
     for (auto const& [key, entry]: mPipelineLayouts) {
         vkDestroyPipelineLayout(mDevice, entry.handle, VKALLOC);
     }
+    mPipelineLayouts.clear();
+    mLastEntry = nullptr;
 }
 
 }// namespace filament::backend
@@ -80,6 +80,10 @@ private:
     VulkanResourceAllocator* mAllocator;
     Timestamp mTimestamp;
     PipelineLayoutMap mPipelineLayouts;
+
+    // The most recently returned layout, entries of an unordered_map are never moved.
+    PipelineLayoutKey mLastKey = {};
+    PipelineLayoutCacheEntry* mLastEntry = nullptr;
 };
 
 } // filament::backend
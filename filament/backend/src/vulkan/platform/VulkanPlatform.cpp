@@ -199,6 +199,11 @@ ExtensionSet getDeviceExtensions(VkPhysicalDevice device) {
             VK_KHR_MAINTENANCE2_EXTENSION_NAME,
             VK_KHR_MAINTENANCE3_EXTENSION_NAME,
             VK_KHR_MULTIVIEW_EXTENSION_NAME,
+            VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+            VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME,
+            VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME,
+            VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+            VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
     };
     ExtensionSet exts;
     // Identify supported physical device extensions
@@ -301,9 +306,9 @@ VkInstance createInstance(ExtensionSet const& requiredExts) {
 
 VkDevice createLogicalDevice(VkPhysicalDevice physicalDevice,
         VkPhysicalDeviceFeatures const& features, uint32_t graphicsQueueFamilyIndex,
-        ExtensionSet const& deviceExtensions) {
+        uint32_t transferQueueFamilyIndex, ExtensionSet const& deviceExtensions) {
     VkDevice device;
-    VkDeviceQueueCreateInfo deviceQueueCreateInfo[1] = {};
+    VkDeviceQueueCreateInfo deviceQueueCreateInfo[2] = {};
     const float queuePriority[] = {1.0f};
     VkDeviceCreateInfo deviceCreateInfo = {};
     FixedCapacityVector<const char*> requestExtensions;
@@ -320,11 +325,18 @@ VkDevice createLogicalDevice(VkPhysicalDevice physicalDevice,
     deviceQueueCreateInfo->pQueuePriorities = &queuePriority[0];
     deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     deviceCreateInfo.queueCreateInfoCount = 1;
+    if (transferQueueFamilyIndex != INVALID_VK_INDEX) {
+        deviceQueueCreateInfo[1] = deviceQueueCreateInfo[0];
+        deviceQueueCreateInfo[1].queueFamilyIndex = transferQueueFamilyIndex;
+        deviceCreateInfo.queueCreateInfoCount = 2;
+    }
     deviceCreateInfo.pQueueCreateInfos = deviceQueueCreateInfo;
 
     // We could simply enable all supported features, but since that may have performance
     // consequences let's just enable the features we need.
     VkPhysicalDeviceFeatures enabledFeatures{
+            .multiDrawIndirect = features.multiDrawIndirect,
+            .drawIndirectFirstInstance = features.drawIndirectFirstInstance,
             .depthClamp = features.depthClamp,
             .samplerAnisotropy = features.samplerAnisotropy,
             .textureCompressionETC2 = features.textureCompressionETC2,
@@ -360,6 +372,39 @@ VkDevice createLogicalDevice(VkPhysicalDevice physicalDevice,
         pNext = &multiview;
     }
 
+    // Only the pipeline (i.e. per draw) shading rate is used.
+    VkPhysicalDeviceFragmentShadingRateFeaturesKHR fragmentShadingRate = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR,
+            .pNext = nullptr,
+            .pipelineFragmentShadingRate = VK_TRUE,
+            .primitiveFragmentShadingRate = VK_FALSE,
+            .attachmentFragmentShadingRate = VK_FALSE,
+    };
+    if (setContains(deviceExtensions, VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME)) {
+        fragmentShadingRate.pNext = pNext;
+        pNext = &fragmentShadingRate;
+    }
+
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphore = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+            .pNext = nullptr,
+            .timelineSemaphore = VK_TRUE,
+    };
+    if (setContains(deviceExtensions, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+        timelineSemaphore.pNext = pNext;
+        pNext = &timelineSemaphore;
+    }
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRendering = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
+            .pNext = nullptr,
+            .dynamicRendering = VK_TRUE,
+    };
+    if (setContains(deviceExtensions, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)) {
+        dynamicRendering.pNext = pNext;
+        pNext = &dynamicRendering;
+    }
+
     deviceCreateInfo.pNext = pNext;
 
     VkResult result = vkCreateDevice(physicalDevice, &deviceCreateInfo, VKALLOC, &device);
@@ -383,6 +428,64 @@ std::tuple<ExtensionSet, ExtensionSet> pruneExtensions(VkPhysicalDevice device,
     }
 #endif
 
+    // The extension can be exposed without the pipeline shading rate, which is the part we use,
+    // and it requires VK_KHR_create_renderpass2, which is otherwise only needed for dynamic
+    // rendering.
+    if (setContains(newDeviceExts, VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME)) {
+        VkPhysicalDeviceFragmentShadingRateFeaturesKHR fragmentShadingRate = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR,
+        };
+        VkPhysicalDeviceFeatures2 features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &fragmentShadingRate,
+        };
+        vkGetPhysicalDeviceFeatures2(device, &features);
+        if (!fragmentShadingRate.pipelineFragmentShadingRate ||
+                !setContains(newDeviceExts, VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME)) {
+            newDeviceExts.erase(VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME);
+        }
+    }
+
+    // VK_KHR_dynamic_rendering depends on VK_KHR_depth_stencil_resolve, which itself depends on
+    // VK_KHR_create_renderpass2.
+    if (setContains(newDeviceExts, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)) {
+        VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRendering = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
+        };
+        VkPhysicalDeviceFeatures2 features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &dynamicRendering,
+        };
+        vkGetPhysicalDeviceFeatures2(device, &features);
+        if (!dynamicRendering.dynamicRendering ||
+                !setContains(newDeviceExts, VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME) ||
+                !setContains(newDeviceExts, VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME)) {
+            newDeviceExts.erase(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+        }
+    }
+    if (!setContains(newDeviceExts, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)) {
+        newDeviceExts.erase(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+    }
+
+    if (!setContains(newDeviceExts, VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME) &&
+            !setContains(newDeviceExts, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)) {
+        newDeviceExts.erase(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+    }
+
+    if (setContains(newDeviceExts, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphore = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+        };
+        VkPhysicalDeviceFeatures2 features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &timelineSemaphore,
+        };
+        vkGetPhysicalDeviceFeatures2(device, &features);
+        if (!timelineSemaphore.timelineSemaphore) {
+            newDeviceExts.erase(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        }
+    }
+
 #if FVK_ENABLED(FVK_DEBUG_VALIDATION)
     // debugMarker must also request debugReport the instance extension. So check if that's present.
     if (setContains(newInstExts, VK_EXT_DEBUG_MARKER_EXTENSION_NAME) &&
@@ -420,6 +523,22 @@ uint32_t identifyGraphicsQueueFamilyIndex(VkPhysicalDevice physicalDevice) {
     return graphicsQueueFamilyIndex;
 }
 
+// Returns a family that only supports transfers, which usually maps to the DMA engines of
+// discrete GPUs. A family that also supports graphics or compute is of no use for uploads, since
+// its queues would compete with the graphics queue for the same hardware.
+uint32_t identifyTransferQueueFamilyIndex(VkPhysicalDevice physicalDevice) {
+    const FixedCapacityVector<VkQueueFamilyProperties> queueFamiliesProperties
+            = getPhysicalDeviceQueueFamilyPropertiesHelper(physicalDevice);
+    for (uint32_t j = 0; j < queueFamiliesProperties.size(); ++j) {
+        VkQueueFamilyProperties props = queueFamiliesProperties[j];
+        if (props.queueCount != 0 && (props.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+                !(props.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+            return j;
+        }
+    }
+    return INVALID_VK_INDEX;
+}
+
 // Provide a preference ordering of device types.
 // Enum based on:
 // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPhysicalDeviceType.html
@@ -584,6 +703,8 @@ struct VulkanPlatformPrivate {
     uint32_t mGraphicsQueueFamilyIndex = INVALID_VK_INDEX;
     uint32_t mGraphicsQueueIndex = INVALID_VK_INDEX;
     VkQueue mGraphicsQueue = VK_NULL_HANDLE;
+    uint32_t mTransferQueueFamilyIndex = INVALID_VK_INDEX;
+    VkQueue mTransferQueue = VK_NULL_HANDLE;
     VulkanContext mContext = {};
 
     // We use a map to both map a handle (i.e. SwapChainPtr) to the concrete type and also to
@@ -715,6 +836,9 @@ Driver* VulkanPlatform::createDriver(void* sharedContext,
     // If using a shared context, we do not assume any extensions.
     if (!mImpl->mSharedContext) {
         deviceExts = getDeviceExtensions(mImpl->mPhysicalDevice);
+        if (!getCustomization().useDynamicRendering) {
+            deviceExts.erase(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+        }
         auto [prunedInstExts, prunedDeviceExts]
                 = pruneExtensions(mImpl->mPhysicalDevice, instExts, deviceExts);
         instExts = prunedInstExts;
@@ -723,11 +847,17 @@ Driver* VulkanPlatform::createDriver(void* sharedContext,
         if (driverConfig.stereoscopicType != StereoscopicType::MULTIVIEW) {
             deviceExts.erase(VK_KHR_MULTIVIEW_EXTENSION_NAME);
         }
+
+        if (getCustomization().useTransferQueue) {
+            mImpl->mTransferQueueFamilyIndex =
+                    identifyTransferQueueFamilyIndex(mImpl->mPhysicalDevice);
+        }
     }
 
     mImpl->mDevice
             = mImpl->mDevice == VK_NULL_HANDLE ? createLogicalDevice(mImpl->mPhysicalDevice,
-                      context.mPhysicalDeviceFeatures, mImpl->mGraphicsQueueFamilyIndex, deviceExts)
+                      context.mPhysicalDeviceFeatures, mImpl->mGraphicsQueueFamilyIndex,
+                      mImpl->mTransferQueueFamilyIndex, deviceExts)
                                                : mImpl->mDevice;
     assert_invariant(mImpl->mDevice != VK_NULL_HANDLE);
 
@@ -735,10 +865,22 @@ Driver* VulkanPlatform::createDriver(void* sharedContext,
             &mImpl->mGraphicsQueue);
     assert_invariant(mImpl->mGraphicsQueue != VK_NULL_HANDLE);
 
+    if (mImpl->mTransferQueueFamilyIndex != INVALID_VK_INDEX) {
+        vkGetDeviceQueue(mImpl->mDevice, mImpl->mTransferQueueFamilyIndex, 0,
+                &mImpl->mTransferQueue);
+        assert_invariant(mImpl->mTransferQueue != VK_NULL_HANDLE);
+    }
+
     // Store the extension support in the context
     context.mDebugUtilsSupported = setContains(instExts, VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     context.mDebugMarkersSupported = setContains(deviceExts, VK_EXT_DEBUG_MARKER_EXTENSION_NAME);
     context.mMultiviewEnabled = setContains(deviceExts, VK_KHR_MULTIVIEW_EXTENSION_NAME);
+    context.mFragmentShadingRateSupported =
+            setContains(deviceExts, VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME);
+    context.mTimelineSemaphoreSupported =
+            setContains(deviceExts, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    context.mDynamicRenderingEnabled =
+            setContains(deviceExts, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
 
 #ifdef NDEBUG
     // If we are in release build, we should not have turned on debug extensions
@@ -848,6 +990,14 @@ VkQueue VulkanPlatform::getGraphicsQueue() const noexcept {
     return mImpl->mGraphicsQueue;
 }
 
+uint32_t VulkanPlatform::getTransferQueueFamilyIndex() const noexcept {
+    return mImpl->mTransferQueueFamilyIndex;
+}
+
+VkQueue VulkanPlatform::getTransferQueue() const noexcept {
+    return mImpl->mTransferQueue;
+}
+
 #undef SWAPCHAIN_RET_FUNC
 
 }// namespace filament::backend
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BackendTest.h"
+
+#include "ShaderGenerator.h"
+#include "TrianglePrimitive.h"
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Shaders
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string vertex (R"(#version 450 core
+
+layout(location = 0) in vec4 mesh_position;
+
+void main() {
+    gl_Position = vec4(mesh_position.xy, 0.0, 1.0);
+#if defined(TARGET_VULKAN_ENVIRONMENT)
+    // In Vulkan, clip space is Y-down. In OpenGL and Metal, clip space is Y-up.
+    gl_Position.y = -gl_Position.y;
+#endif
+}
+)");
+
+std::string fragment (R"(#version 450 core
+
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    fragColor = vec4(1.0);
+}
+
+)");
+
+// Size of the viewport, which is also the area read back.
+constexpr size_t kSize = 512;
+
+// Returns the RGBA8 pixel at (x, y), with the origin at the bottom-left.
+uint8_t const* getPixel(void const* buffer, size_t x, size_t y) {
+    return static_cast<uint8_t const*>(buffer) + (y * kSize + x) * 4;
+}
+
+}
+
+namespace test {
+
+using namespace filament;
+using namespace filament::backend;
+
+/**
+ * This test case renders a triangle using arguments sourced from a buffer object. The second
+ * draw has an instance count of 0 and must be skipped.
+ */
+TEST_F(BackendTest, DrawIndirect) {
+    auto& api = getDriverApi();
+
+    if (!api.isDrawIndirectSupported()) {
+        GTEST_SKIP() << "indirect draws are not supported on this backend";
+    }
+
+    // The test is executed within this block scope to force destructors to run before
+    // executeCommands().
+    {
+        // Create a platform-specific SwapChain and make it current.
+        auto swapChain = createSwapChain();
+        api.makeCurrent(swapChain, swapChain);
+
+        // Create a program.
+        ShaderGenerator shaderGen(vertex, fragment, sBackend, sIsMobilePlatform);
+        Program p = shaderGen.getProgram(api);
+        auto program = api.createProgram(std::move(p));
+
+        auto defaultRenderTarget = api.createDefaultRenderTarget(0);
+
+        TrianglePrimitive triangle(api);
+
+        // Indirect arguments must live in a storage buffer, so they can be written by compute.
+        static constexpr DrawIndexedIndirectCommand commands[2] = {
+                { .indexCount = 3, .instanceCount = 1, .firstIndex = 0, .baseVertex = 0, .baseInstance = 0 },
+                { .indexCount = 3, .instanceCount = 0, .firstIndex = 0, .baseVertex = 0, .baseInstance = 0 },
+        };
+        auto indirect = api.createBufferObject(sizeof(commands),
+                BufferObjectBinding::SHADER_STORAGE, BufferUsage::STATIC);
+        api.updateBufferObject(indirect, { commands, sizeof(commands) }, 0);
+
+        RenderPassParams params = {};
+        params.viewport = { 0, 0, kSize, kSize };
+        params.flags.clear = TargetBufferFlags::COLOR;
+        params.clearColor = {0.f, 1.f, 0.f, 1.f};
+        params.flags.discardStart = TargetBufferFlags::ALL;
+        params.flags.discardEnd = TargetBufferFlags::NONE;
+
+        PipelineState state;
+        state.program = program;
+        state.vertexBufferInfo = triangle.getVertexBufferInfo();
+        state.primitiveType = PrimitiveType::TRIANGLES;
+        state.rasterState.colorWrite = true;
+        state.rasterState.depthWrite = false;
+        state.rasterState.depthFunc = RasterState::DepthFunc::A;
+        state.rasterState.culling = CullingMode::NONE;
+
+        api.startCapture(0);
+
+        api.makeCurrent(swapChain, swapChain);
+        api.beginFrame(0, 0, 0);
+
+        api.beginRenderPass(defaultRenderTarget, params);
+        api.bindPipeline(state);
+        api.bindRenderPrimitive(triangle.getRenderPrimitive());
+        api.draw2Indirect(indirect, 0, 2, sizeof(DrawIndexedIndirectCommand));
+        api.endRenderPass();
+
+        // The triangle covers the lower-left half of the viewport, the upper-right half must
+        // still have the clear color.
+        size_t const size = kSize * kSize * 4;
+        PixelBufferDescriptor pbd(calloc(1, size), size, PixelDataFormat::RGBA,
+                PixelDataType::UBYTE, [](void* buffer, size_t, void*) {
+                    uint8_t const* inside = getPixel(buffer, kSize / 4, kSize / 4);
+                    EXPECT_EQ(inside[0], 0xFF);
+                    EXPECT_EQ(inside[1], 0xFF);
+                    EXPECT_EQ(inside[2], 0xFF);
+                    uint8_t const* outside = getPixel(buffer, 3 * kSize / 4, 3 * kSize / 4);
+                    EXPECT_EQ(outside[0], 0x00);
+                    EXPECT_EQ(outside[1], 0xFF);
+                    EXPECT_EQ(outside[2], 0x00);
+                    free(buffer);
+                });
+        api.readPixels(defaultRenderTarget, 0, 0, kSize, kSize, std::move(pbd));
+
+        api.flush();
+        api.commit(swapChain);
+        api.endFrame(0);
+
+        api.stopCapture(0);
+
+        api.destroyBufferObject(indirect);
+        api.destroyProgram(program);
+        api.destroySwapChain(swapChain);
+        api.destroyRenderTarget(defaultRenderTarget);
+    }
+
+    executeCommands();
+}
+
+} // namespace test
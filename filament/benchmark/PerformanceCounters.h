@@ -21,8 +21,22 @@
 
 #include <utils/Profiler.h>
 
-#include <cmath>
+#include <stdint.h>
 
+/*
+ * Records the hardware performance counters of the calling thread for the lifetime of this
+ * object (or until stop() is called) and reports them as benchmark counters:
+ *   C   cpu cycles
+ *   I   instructions
+ *   CM  cache misses
+ *   BPU branch misses
+ *   CPI cycles per instruction
+ *
+ * Counters are per item when the benchmark sets the number of items processed, per iteration
+ * otherwise. They are only available on Linux and Android, and only the ones supported by the
+ * current cpu/kernel are reported. Like the other user counters, they are part of the
+ * benchmark's output in all formats, including --benchmark_format=json.
+ */
 class PerformanceCounters {
     benchmark::State& state;
     utils::Profiler profiler;
@@ -31,7 +45,9 @@ class PerformanceCounters {
 public:
     explicit PerformanceCounters(benchmark::State& state)
             : state(state) {
-        profiler.resetEvents(utils::Profiler::EV_CPU_CYCLES | utils::Profiler::EV_BPU_MISSES);
+        profiler.resetEvents(utils::Profiler::EV_CPU_CYCLES |
+                             utils::Profiler::EV_L1D_MISSES |
+                             utils::Profiler::EV_BPU_MISSES);
         profiler.start();
     }
 
@@ -42,14 +58,25 @@ public:
     ~PerformanceCounters() {
         profiler.stop();
         counters = profiler.readCounters();
-        if (profiler.isValid()) {
-            auto avgItem = double(state.iterations()) / state.items_processed();
-            state.counters.insert({
-                    { "C",   { avgItem * (double)counters.getCpuCycles(),    benchmark::Counter::kAvgIterations }},
-                    { "I",   { avgItem * (double)counters.getInstructions(), benchmark::Counter::kAvgIterations }},
-                    { "BPU", { std::floor(0.5 + avgItem * (double)counters.getBranchMisses() / state.iterations()), benchmark::Counter::kDefaults }},
-                    { "CPI", {           (double)counters.getCPI(),          benchmark::Counter::kAvgThreads }},
-            });
+        if (!profiler.isValid()) {
+            return;
+        }
+        using utils::Profiler;
+        using benchmark::Counter;
+        uint32_t const events = profiler.getEnabledEvents();
+        double const avgItem = state.items_processed() ?
+                double(state.iterations()) / double(state.items_processed()) : 1.0;
+        auto& c = state.counters;
+        c["I"] = { avgItem * (double)counters.getInstructions(), Counter::kAvgIterations };
+        if (events & Profiler::EV_CPU_CYCLES) {
+            c["C"]   = { avgItem * (double)counters.getCpuCycles(), Counter::kAvgIterations };
+            c["CPI"] = { (double)counters.getCPI(), Counter::kAvgThreads };
+        }
+        if (events & Profiler::EV_L1D_MISSES) {
+            c["CM"]  = { avgItem * (double)counters.getL1DMisses(), Counter::kAvgIterations };
+        }
+        if (events & Profiler::EV_BPU_MISSES) {
+            c["BPU"] = { avgItem * (double)counters.getBranchMisses(), Counter::kAvgIterations };
         }
     }
 };
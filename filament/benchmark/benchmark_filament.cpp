@@ -21,10 +21,20 @@
 
 #include <filament/Box.h>
 #include <filament/Frustum.h>
+#include <filament/LightManager.h>
+#include <filament/Viewport.h>
+#include "Allocators.h"
 #include "Culler.h"
+#include "Froxelizer.h"
+#include "components/TransformManager.h"
+#include "details/Engine.h"
+#include "details/Scene.h"
 
 #include <utils/Allocator.h>
+#include <utils/EntityManager.h>
+#include <utils/JobSystem.h>
 
+#include <memory>
 #include <vector>
 #include <random>
 
@@ -103,3 +113,164 @@ BENCHMARK_F(FilamentCullingFixture, sphereCulling)(benchmark::State& state) {
         state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
     }
 }
+
+// Same as above, for each culling kernel. The kernel is given by its Culler::Kernel value:
+// 0: GENERIC, 1: SSE2, 2: AVX2, 3: NEON
+
+BENCHMARK_DEFINE_F(FilamentCullingFixture, boxCullingKernel)(benchmark::State& state) {
+    auto const kernel = Culler::Kernel(state.range(0));
+    if (!Culler::isKernelSupported(kernel)) {
+        state.SkipWithError("kernel not supported on this CPU");
+        return;
+    }
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            Culler::Test::intersects(kernel,
+                    visibles, frustum, boxesCenter.data(), boxesExtent.data(), BATCH_SIZE);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+    }
+}
+
+BENCHMARK_DEFINE_F(FilamentCullingFixture, sphereCullingKernel)(benchmark::State& state) {
+    auto const kernel = Culler::Kernel(state.range(0));
+    if (!Culler::isKernelSupported(kernel)) {
+        state.SkipWithError("kernel not supported on this CPU");
+        return;
+    }
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            Culler::Test::intersects(kernel, visibles, frustum, spheres.data(), BATCH_SIZE);
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+    }
+}
+
+BENCHMARK_REGISTER_F(FilamentCullingFixture, boxCullingKernel)
+        ->ArgName("kernel")->DenseRange(0, int(Culler::Kernel::NEON));
+
+BENCHMARK_REGISTER_F(FilamentCullingFixture, sphereCullingKernel)
+        ->ArgName("kernel")->DenseRange(0, int(Culler::Kernel::NEON));
+
+// Computes the world transforms of a crowd of characters, i.e. many shallow hierarchies, with the
+// given number of JobSystem threads. 0 means without a JobSystem.
+
+static void transformHierarchy(benchmark::State& state) {
+    constexpr size_t CHARACTER_COUNT = 500;
+    constexpr size_t BONE_COUNT = 64;
+
+    std::unique_ptr<JobSystem> js;
+    if (state.range(0)) {
+        js = std::make_unique<JobSystem>(state.range(0));
+        js->adopt();
+    }
+
+    FTransformManager tcm;
+    tcm.setJobSystem(js.get());
+
+    // each skeleton is a binary tree of bones
+    EntityManager& em = EntityManager::get();
+    std::vector<Entity> entities(CHARACTER_COUNT * BONE_COUNT);
+    em.create(entities.size(), entities.data());
+    for (size_t c = 0; c < CHARACTER_COUNT; c++) {
+        Entity const* const bones = entities.data() + c * BONE_COUNT;
+        tcm.create(bones[0]);
+        for (size_t b = 1; b < BONE_COUNT; b++) {
+            tcm.create(bones[b], tcm.getInstance(bones[(b - 1) / 2]),
+                    mat4f::translation(float3{ 0, 1, 0 }));
+        }
+    }
+
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            tcm.openLocalTransformTransaction();
+            tcm.commitLocalTransformTransaction();
+        }
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * entities.size()));
+    }
+
+    for (Entity const e: entities) {
+        tcm.destroy(e);
+    }
+    em.destroy(entities.size(), entities.data());
+    if (js) {
+        js->emancipate();
+    }
+}
+
+BENCHMARK(transformHierarchy)->ArgName("threads")->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)
+        ->UseRealTime();
+
+// Froxelizes the given number of point and spot lights (3 spot lights for 1 point light) spread
+// across the view frustum of a 1080p view, with the light data in view space.
+
+static void froxelizeLights(benchmark::State& state) {
+    size_t const lightCount = size_t(state.range(0));
+
+    FEngine* engine = downcast(Engine::create(Engine::Backend::NOOP));
+    {
+        LinearAllocatorArena arena("benchmark: froxelizer", 4 * 1024 * 1024);
+        RootArenaScope scope(arena);
+
+        Viewport const viewport(0, 0, 1920, 1080);
+        mat4f const projection = mat4f::perspective(60.0f, 1920.0f / 1080.0f, 0.1f, 100.0f);
+
+        Froxelizer froxelizer(*engine);
+        froxelizer.setOptions(5.0f, 100.0f);
+        froxelizer.prepare(engine->getDriverApi(), scope, viewport, projection, 0.1f, 100.0f);
+
+        std::default_random_engine gen; // NOLINT
+        std::uniform_real_distribution<float> rand(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> distance(1.0f, 60.0f);
+        std::uniform_real_distribution<float> radius(1.0f, 10.0f);
+        std::uniform_real_distribution<float> angle(0.2f, 0.8f);
+
+        EntityManager& em = EntityManager::get();
+        std::vector<Entity> entities(lightCount);
+        em.create(entities.size(), entities.data());
+
+        FScene::LightSoa lights;
+        lights.push_back({}, {}, {}, {}, {}, {}, {}, {});   // the directional light is skipped
+        for (size_t i = 0; i < lightCount; i++) {
+            bool const spot = i % 4 != 0;
+            float const r = radius(gen);
+            float3 const direction = normalize(float3{ rand(gen), rand(gen), rand(gen) });
+            LightManager::Builder(spot ? LightManager::Type::SPOT : LightManager::Type::POINT)
+                    .falloff(r)
+                    .direction(direction)
+                    .spotLightCone(0.1f, angle(gen))
+                    .build(*engine, entities[i]);
+            float const z = distance(gen);
+            float4 const sphere{ rand(gen) * z, rand(gen) * z * 0.56f, -z, r };
+            lights.push_back(sphere, direction, {}, {},
+                    engine->getLightManager().getInstance(entities[i]), 1, {}, {});
+        }
+
+        {
+            PerformanceCounters pc(state);
+            for (auto _ : state) {
+                froxelizer.froxelizeLights(*engine, {}, lights);
+            }
+            pc.stop();
+            state.SetItemsProcessed(int64_t(state.iterations() * lightCount));
+        }
+
+        froxelizer.terminate(engine->getDriverApi());
+        for (Entity const e: entities) {
+            engine->getLightManager().destroy(e);
+        }
+        em.destroy(entities.size(), entities.data());
+    }
+    Engine::destroy((Engine**)&engine);
+}
+
+// The froxelizer is limited to CONFIG_MAX_LIGHT_COUNT point and spot lights.
+BENCHMARK(froxelizeLights)->ArgName("lights")->Arg(64)->Arg(128)->Arg(CONFIG_MAX_LIGHT_COUNT);
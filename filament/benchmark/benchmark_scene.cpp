@@ -0,0 +1,440 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include <filament/Box.h>
+#include <filament/Frustum.h>
+#include <filament/IndexBuffer.h>
+#include <filament/Material.h>
+#include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
+#include <filament/Renderer.h>
+#include <filament/SwapChain.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
+#include <filament/Viewport.h>
+
+#include "Allocators.h"
+#include "RenderPass.h"
+#include "ResourceAllocator.h"
+#include "ShadowMap.h"
+#include "components/TransformManager.h"
+#include "details/Camera.h"
+#include "details/Engine.h"
+#include "details/IndexBuffer.h"
+#include "details/Material.h"
+#include "details/MaterialInstance.h"
+#include "details/Renderer.h"
+#include "details/Scene.h"
+#include "details/SwapChain.h"
+#include "details/VertexBuffer.h"
+#include "details/View.h"
+#include "fg/FrameGraph.h"
+#include "fg/FrameGraphResources.h"
+
+#include <utils/EntityManager.h>
+#include <utils/Range.h>
+
+#include <memory>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include <stdlib.h>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+// These benchmarks measure the CPU cost of the per-frame work on synthetic scenes. They use the
+// NOOP backend by default so that the driver doesn't interfere; set FILAMENT_BENCHMARK_BACKEND
+// to "opengl", "vulkan" or "metal" to run them against a real backend instead. The NOOP backend
+// also counts the work submitted to it, which frameRender reports.
+
+static Engine::Backend getBenchmarkBackend() {
+    char const* const name = getenv("FILAMENT_BENCHMARK_BACKEND");
+    if (name) {
+        std::string_view const backend(name);
+        if (backend == "opengl") return Engine::Backend::OPENGL;
+        if (backend == "vulkan") return Engine::Backend::VULKAN;
+        if (backend == "metal") return Engine::Backend::METAL;
+    }
+    return Engine::Backend::NOOP;
+}
+
+// A scene made of state.range(0) boxes spread around the camera, which share a handful of
+// material instances. About a sixth of them are in the camera frustum.
+class FilamentSceneFixture : public benchmark::Fixture {
+protected:
+    static constexpr size_t MATERIAL_INSTANCE_COUNT = 16;
+    static constexpr size_t ARENA_SIZE = 64 * 1024 * 1024;
+
+    FEngine* engine = nullptr;
+    FScene* scene = nullptr;
+    FCamera* camera = nullptr;
+    Entity cameraEntity;
+    VertexBuffer* vertexBuffer = nullptr;
+    IndexBuffer* indexBuffer = nullptr;
+    std::vector<MaterialInstance*> materialInstances;
+    std::vector<Entity> entities;
+    std::unique_ptr<LinearAllocatorArena> arena;
+
+public:
+    void SetUp(benchmark::State& state) override {
+        size_t const renderableCount = size_t(state.range(0));
+
+        Engine::Config config;
+        config.noopDriverStatistics = true;
+        engine = downcast(Engine::Builder()
+                .backend(getBenchmarkBackend())
+                .config(&config)
+                .build());
+        if (!engine) {
+            state.SkipWithError("unable to create the engine");
+            return;
+        }
+        arena = std::make_unique<LinearAllocatorArena>("benchmark: scene", ARENA_SIZE);
+
+        vertexBuffer = VertexBuffer::Builder()
+                .vertexCount(3)
+                .bufferCount(1)
+                .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::FLOAT3)
+                .build(*engine);
+        indexBuffer = IndexBuffer::Builder()
+                .indexCount(3)
+                .bufferType(IndexBuffer::IndexType::USHORT)
+                .build(*engine);
+
+        FMaterial const* const material = engine->getDefaultMaterial();
+        for (size_t i = 0; i < MATERIAL_INSTANCE_COUNT; i++) {
+            materialInstances.push_back(material->createInstance(nullptr));
+        }
+
+        std::default_random_engine gen; // NOLINT
+        std::uniform_real_distribution<float> rand(-100.0f, 100.0f);
+
+        FTransformManager& tcm = engine->getTransformManager();
+        EntityManager& em = EntityManager::get();
+        entities.resize(renderableCount);
+        em.create(entities.size(), entities.data());
+        for (size_t i = 0; i < renderableCount; i++) {
+            Entity const e = entities[i];
+            RenderableManager::Builder(1)
+                    .boundingBox({{ -0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, 0.5f }})
+                    .material(0, materialInstances[i % MATERIAL_INSTANCE_COUNT])
+                    .geometry(0, RenderableManager::PrimitiveType::TRIANGLES,
+                            vertexBuffer, indexBuffer)
+                    .castShadows(true)
+                    .receiveShadows(true)
+                    .build(*engine, e);
+            tcm.create(e, {}, mat4f::translation(float3{ rand(gen), rand(gen), rand(gen) }));
+        }
+
+        Scene* const s = engine->createScene();
+        s->addEntities(entities.data(), entities.size());
+        scene = downcast(s);
+
+        cameraEntity = em.create();
+        Camera* const c = engine->createCamera(cameraEntity);
+        c->setProjection(60.0, 16.0 / 9.0, 0.1, 200.0, Camera::Fov::VERTICAL);
+        c->lookAt({ 0, 0, 0 }, { 0, 0, -1 }, { 0, 1, 0 });
+        camera = downcast(c);
+    }
+
+    void TearDown(benchmark::State& state) override {
+        if (!engine) {
+            return;
+        }
+        FRenderableManager& rcm = engine->getRenderableManager();
+        FTransformManager& tcm = engine->getTransformManager();
+        for (Entity const e: entities) {
+            rcm.destroy(e);
+            tcm.destroy(e);
+        }
+        EntityManager::get().destroy(entities.size(), entities.data());
+        entities.clear();
+        for (MaterialInstance const* mi: materialInstances) {
+            engine->destroy(downcast(mi));
+        }
+        materialInstances.clear();
+        engine->destroy(scene);
+        engine->destroy(downcast(vertexBuffer));
+        engine->destroy(downcast(indexBuffer));
+        engine->destroyCameraComponent(cameraEntity);
+        EntityManager::get().destroy(cameraEntity);
+        arena.reset();
+        Engine::destroy((Engine**)&engine);
+    }
+
+    // Gathers the renderables and culls them against the camera, like FView::prepare() does.
+    // Returns the range of renderables to generate commands for.
+    utils::Range<uint32_t> prepare(RootArenaScope& scope) {
+        CameraInfo const cameraInfo(*camera);
+        scene->prepare(engine->getJobSystem(), scope, cameraInfo.worldTransform, false);
+        FScene::RenderableSoa& renderableData = scene->getRenderableData();
+        std::uninitialized_fill(renderableData.begin<FScene::VISIBLE_MASK>(),
+                renderableData.end<FScene::VISIBLE_MASK>(), 0);
+        FView::cullRenderables(engine->getJobSystem(), *scene, camera->getCullingFrustum(),
+                VISIBLE_RENDERABLE_BIT);
+        return { 0, uint32_t(entities.size()) };
+    }
+};
+
+BENCHMARK_DEFINE_F(FilamentSceneFixture, scenePrepare)(benchmark::State& state) {
+    CameraInfo const cameraInfo(*camera);
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            RootArenaScope scope(*arena);
+            scene->prepare(engine->getJobSystem(), scope, cameraInfo.worldTransform, false);
+        }
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * entities.size()));
+    }
+}
+
+BENCHMARK_DEFINE_F(FilamentSceneFixture, renderableCulling)(benchmark::State& state) {
+    RootArenaScope scope(*arena);
+    prepare(scope);
+    Frustum const frustum = camera->getCullingFrustum();
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            FView::cullRenderables(engine->getJobSystem(), *scene, frustum,
+                    VISIBLE_RENDERABLE_BIT);
+        }
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * entities.size()));
+    }
+}
+
+// Generates and sorts the commands of a color pass, which is what RenderPassBuilder::build()
+// does for each pass.
+BENCHMARK_DEFINE_F(FilamentSceneFixture, renderPassBuild)(benchmark::State& state) {
+    RootArenaScope scope(*arena);
+    utils::Range<uint32_t> const visibleRenderables = prepare(scope);
+    CameraInfo const cameraInfo(*camera);
+
+    size_t const commandsSize = engine->getPerFrameCommandsSize();
+    void* const commandsBegin = scope.allocate(commandsSize, CACHELINE_SIZE);
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            RenderPass::Arena commandArena("benchmark: commands",
+                    { commandsBegin, pointermath::add(commandsBegin, commandsSize) });
+            RenderPass const pass = RenderPassBuilder(commandArena)
+                    .commandTypeFlags(RenderPass::CommandTypeFlags::COLOR)
+                    .geometry(scene->getRenderableData(), visibleRenderables, {})
+                    .camera(cameraInfo)
+                    .build(*engine);
+            benchmark::DoNotOptimize(pass.begin());
+        }
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * entities.size()));
+    }
+}
+
+// Computes the shadow casters and receivers volumes of a directional light and culls the
+// shadow casters against the light frustum, the CPU side of ShadowMapManager::update().
+BENCHMARK_DEFINE_F(FilamentSceneFixture, shadowCasterCulling)(benchmark::State& state) {
+    RootArenaScope scope(*arena);
+    prepare(scope);
+    mat4f const Mv = ShadowMap::getDirectionalLightViewMatrix(
+            normalize(float3{ 0.5f, -1.0f, -0.5f }), { 0, 1, 0 });
+    Frustum const frustum{ mat4f::ortho(-100, 100, -100, 100, -200, 200) * Mv };
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            ShadowMap::SceneInfo sceneInfo(*scene, 0xff);
+            ShadowMap::updateSceneInfoDirectional(Mv, *scene, sceneInfo);
+            FView::cullRenderables(engine->getJobSystem(), *scene, frustum,
+                    VISIBLE_DIR_SHADOW_RENDERABLE_BIT);
+            benchmark::DoNotOptimize(sceneInfo);
+        }
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * entities.size()));
+    }
+}
+
+// Makes the uniforms of state.range(0) material instances dirty and commits them, as
+// FEngine::prepare() does each frame.
+BENCHMARK_DEFINE_F(FilamentSceneFixture, materialInstanceCommit)(benchmark::State& state) {
+    FMaterial const* const material = engine->getDefaultMaterial();
+    std::vector<FMaterialInstance*> instances(entities.size());
+    for (auto& mi: instances) {
+        mi = material->createInstance(nullptr);
+    }
+    if (instances.front()->getUniformBuffer().getSize() == 0) {
+        state.SkipWithError("the default material has no uniforms");
+    } else {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            for (FMaterialInstance const* mi: instances) {
+                // this is what setting any parameter does
+                const_cast<UniformBuffer&>(mi->getUniformBuffer()).invalidate();
+            }
+            engine->prepare();
+            // don't let the commands accumulate in the command buffer
+            state.PauseTiming();
+            engine->flush();
+            state.ResumeTiming();
+        }
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * instances.size()));
+    }
+    for (FMaterialInstance* mi: instances) {
+        engine->destroy(mi);
+    }
+}
+
+// Renders whole frames of the scene, headless. With the NOOP backend this measures the CPU cost
+// of a frame without a GPU, and the counters report the work submitted to the backend per frame,
+// which tracks regressions such as redundant state changes in CI.
+BENCHMARK_DEFINE_F(FilamentSceneFixture, frameRender)(benchmark::State& state) {
+    Renderer* const renderer = engine->createRenderer();
+    SwapChain* const swapChain = engine->createSwapChain(1920, 1080, 0);
+    View* const view = engine->createView();
+    view->setViewport({ 0, 0, 1920, 1080 });
+    view->setScene(scene);
+    view->setCamera(camera);
+
+    engine->flushAndWait();
+    Engine::DriverStats const before = engine->getDriverStats();
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            if (renderer->beginFrame(swapChain)) {
+                renderer->render(view);
+                renderer->endFrame();
+            }
+        }
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * entities.size()));
+    }
+    engine->flushAndWait();
+    Engine::DriverStats const after = engine->getDriverStats();
+
+    // all zero unless the NOOP backend counted them
+    uint64_t const frames = after.frameCount - before.frameCount;
+    if (frames) {
+        auto const perFrame = [frames](uint64_t a, uint64_t b) { return double(a - b) / frames; };
+        state.counters["draws"] = perFrame(after.drawCount, before.drawCount);
+        state.counters["passes"] = perFrame(after.renderPassCount, before.renderPassCount);
+        state.counters["pipelines"] =
+                perFrame(after.pipelineBindCount, before.pipelineBindCount);
+        state.counters["redundantPipelines"] = perFrame(
+                after.redundantPipelineBindCount, before.redundantPipelineBindCount);
+        state.counters["primitives"] =
+                perFrame(after.primitiveBindCount, before.primitiveBindCount);
+        state.counters["redundantPrimitives"] = perFrame(
+                after.redundantPrimitiveBindCount, before.redundantPrimitiveBindCount);
+        state.counters["uploadBytes"] =
+                perFrame(after.bufferUploadSize + after.textureUploadSize,
+                        before.bufferUploadSize + before.textureUploadSize);
+    }
+
+    engine->destroy(downcast(view));
+    engine->destroy(downcast(swapChain));
+    engine->destroy(downcast(renderer));
+}
+
+BENCHMARK_REGISTER_F(FilamentSceneFixture, scenePrepare)
+        ->ArgName("renderables")->Arg(1000)->Arg(10000)->Arg(100000);
+
+BENCHMARK_REGISTER_F(FilamentSceneFixture, renderableCulling)
+        ->ArgName("renderables")->Arg(1000)->Arg(10000)->Arg(100000);
+
+BENCHMARK_REGISTER_F(FilamentSceneFixture, renderPassBuild)
+        ->ArgName("renderables")->Arg(1000)->Arg(10000)->Arg(100000);
+
+BENCHMARK_REGISTER_F(FilamentSceneFixture, shadowCasterCulling)
+        ->ArgName("renderables")->Arg(1000)->Arg(10000)->Arg(100000);
+
+BENCHMARK_REGISTER_F(FilamentSceneFixture, materialInstanceCommit)
+        ->ArgName("renderables")->Arg(1000)->Arg(10000);
+
+BENCHMARK_REGISTER_F(FilamentSceneFixture, frameRender)
+        ->ArgName("renderables")->Arg(1000)->Arg(10000);
+
+// Builds and compiles the FrameGraph of a frame made of state.range(0) passes. Each pass renders
+// into a new target, sampling the output of the previous pass and, every few passes, of an
+// earlier one. Passes 4, 8, 12... don't contribute to the final image and are culled.
+
+class NullResourceAllocator : public ResourceAllocatorInterface {
+    struct NullDisposer : public ResourceAllocatorDisposerInterface {
+        void destroy(backend::TextureHandle) noexcept override {}
+    } mDisposer;
+public:
+    backend::RenderTargetHandle createRenderTarget(const char*, backend::TargetBufferFlags,
+            uint32_t, uint32_t, uint8_t, uint8_t, backend::MRT, backend::TargetBufferInfo,
+            backend::TargetBufferInfo) noexcept override {
+        return {};
+    }
+    void destroyRenderTarget(backend::RenderTargetHandle) noexcept override {}
+    backend::TextureHandle createTexture(const char*, backend::SamplerType, uint8_t,
+            backend::TextureFormat, uint8_t, uint32_t, uint32_t, uint32_t,
+            std::array<backend::TextureSwizzle, 4>, backend::TextureUsage) noexcept override {
+        return {};
+    }
+    void destroyTexture(backend::TextureHandle) noexcept override {}
+    ResourceAllocatorDisposerInterface& getDisposer() noexcept override { return mDisposer; }
+};
+
+static void frameGraphCompile(benchmark::State& state) {
+    size_t const passCount = size_t(state.range(0));
+
+    struct PassData {
+        FrameGraphId<FrameGraphTexture> input;
+        FrameGraphId<FrameGraphTexture> history;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    NullResourceAllocator resourceAllocator;
+    LinearAllocatorArena arena("benchmark: framegraph", 4 * 1024 * 1024);
+    std::vector<FrameGraphId<FrameGraphTexture>> outputs(passCount);
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            FrameGraph fg(resourceAllocator, arena);
+            for (size_t i = 0; i < passCount; i++) {
+                auto& pass = fg.addPass<PassData>("pass",
+                        [&](FrameGraph::Builder& builder, auto& data) {
+                            size_t const source = i - (i > 1 && i % 4 == 1 ? 2 : 1);
+                            if (i > 0) {
+                                data.input = builder.sample(outputs[source]);
+                            }
+                            if (i >= 8 && i % 8 == 0) {
+                                data.history = builder.sample(outputs[i - 7]);
+                            }
+                            data.output = builder.createTexture("output",
+                                    { .width = 1920, .height = 1080 });
+                            data.output = builder.declareRenderPass(data.output);
+                        },
+                        [](FrameGraphResources const&, auto const&, backend::DriverApi&) {});
+                outputs[i] = pass->output;
+            }
+            fg.present(outputs.back());
+            fg.compile();
+        }
+        pc.stop();
+        state.SetItemsProcessed(int64_t(state.iterations() * passCount));
+    }
+}
+
+BENCHMARK(frameGraphCompile)->ArgName("passes")->Arg(16)->Arg(64)->Arg(256);
@@ -53,6 +53,7 @@ class UTILS_PUBLIC BufferObject : public FilamentAPI {
 public:
     using BufferDescriptor = backend::BufferDescriptor;
     using BindingType = backend::BufferObjectBinding;
+    using BufferUsage = backend::BufferUsage;
 
     class Builder : public BuilderBase<BuilderDetails>, public BuilderNameMixin<Builder> {
         friend struct BuilderDetails;
@@ -78,6 +79,14 @@ public:
          */
         Builder& bindingType(BindingType bindingType) noexcept;
 
+        /**
+         * How the content of this buffer object is going to be updated. (defaults to STATIC)
+         * Buffers updated every frame, e.g. with setBufferUnsynchronized(), should use DYNAMIC.
+         * @param usage The usage hint for this buffer.
+         * @return A reference to this Builder for chaining calls.
+         */
+        Builder& usage(BufferUsage usage) noexcept;
+
         /**
          * Associate an optional name with this BufferObject for debugging purposes.
          *
@@ -121,6 +130,26 @@ public:
      */
     void setBuffer(Engine& engine, BufferDescriptor&& buffer, uint32_t byteOffset = 0);
 
+    /**
+     * Asynchronously copy-initializes a region of this BufferObject from the data provided,
+     * without synchronizing with the GPU.
+     *
+     * Unlike setBuffer(), this never waits for the GPU to be done with the BufferObject, which
+     * makes it suitable for data streamed every frame (e.g. procedural or particle geometry).
+     * In exchange, the caller must guarantee that the region written isn't used by a frame
+     * that is still in flight. Typically, the BufferObject is split in a ring of regions, one
+     * per frame, with at least as many regions as the number of frames the GPU can lag behind
+     * (3 is generally enough), and each frame renders from the region it just wrote.
+     *
+     * @param engine Reference to the filament::Engine associated with this BufferObject.
+     * @param buffer A BufferDescriptor representing the data used to initialize the BufferObject.
+     * @param byteOffset Offset in bytes into the BufferObject
+     *
+     * @see Builder::usage
+     */
+    void setBufferUnsynchronized(Engine& engine, BufferDescriptor&& buffer,
+            uint32_t byteOffset = 0);
+
     /**
      * Returns the size of this BufferObject in elements.
      * @return The maximum capacity of the BufferObject.
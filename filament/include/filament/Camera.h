@@ -309,6 +309,30 @@ public:
     void setCustomEyeProjection(math::mat4 const* UTILS_NONNULL projection, size_t count,
             math::mat4 const& projectionForCulling, double near, double far);
 
+    /** Sets a custom projection matrix for each eye, and computes the culling frustum.
+     *
+     * This is the same as setCustomEyeProjection(projection, count, projectionForCulling, near, far)
+     * except that the culling frustum is computed by the Camera, so that it encompasses the
+     * frustums of all the eyes. The culling frustum is updated when setEyeModelMatrix() is called.
+     * This allows all the eyes to be culled together, once per frame.
+     *
+     * The culling frustum has its apex at, or slightly behind, the camera's (head) position. For
+     * this to work, the far plane of each eye must be in front of the head. If that's not the
+     * case, the culling frustum falls back to the first eye's projection.
+     *
+     * @param projection an array of projection matrices, only the first config.stereoscopicEyeCount
+     *                   are read
+     * @param count size of the projection matrix array to set, must be
+     *              >= config.stereoscopicEyeCount
+     * @param near distance in world units from the camera to the culling near plane. \p near > 0.
+     * @param far distance in world units from the camera to the culling far plane. \p far > \p
+     * near.
+     * @see setEyeModelMatrix
+     * @see Engine::Config::stereoscopicEyeCount
+     */
+    void setCustomEyeProjection(math::mat4 const* UTILS_NONNULL projection, size_t count,
+            double near, double far);
+
     /** Sets an additional matrix that scales the projection matrix.
      *
      * This is useful to adjust the aspect ratio of the camera independent from its projection.
@@ -32,6 +32,9 @@ namespace utils {
 class Entity;
 class EntityManager;
 class JobSystem;
+namespace io {
+class ostream;
+} // namespace io
 } // namespace utils
 
 namespace filament {
@@ -288,6 +291,17 @@ public:
          */
         uint32_t jobSystemThreadCount = 0;
 
+        /**
+         * Keep the JobSystem threads on the performance cores of CPUs which have cores of
+         * different capacities (e.g. ARM big.LITTLE), so that frame jobs don't land on
+         * efficiency cores. When jobSystemThreadCount is 0, the number of threads is also derived
+         * from the number of performance cores.
+         *
+         * This has no effect on CPUs where all cores are identical, or where the topology can't
+         * be determined. Currently only supported on Linux and Android.
+         */
+        bool jobSystemPreferPerformanceCores = false;
+
         /*
          * Number of most-recently destroyed textures to track for use-after-free.
          *
@@ -322,6 +336,24 @@ public:
          */
         bool disableParallelShaderCompile = false;
 
+        /**
+         * Number of threads used to compile and link programs in parallel, each of them uses
+         * its own shared context. 0 lets the backend choose based on the GPU, this is usually
+         * the best choice because some drivers serialize compilations anyway.
+         * Currently only honored by the GL backend, and ignored if disableParallelShaderCompile
+         * is set.
+         */
+        uint32_t shaderCompilerThreadCount = 0;
+
+        /**
+         * Time budget, in microseconds, the backend may spend each frame releasing the GPU
+         * memory of destroyed textures and buffers. When many resources are destroyed at once,
+         * e.g. a large glTF asset, the cost is then spread over several frames instead of
+         * stalling one. 0 releases the memory as soon as the resources are destroyed.
+         * Currently only honored by the GL backend.
+         */
+        uint32_t deferredDestructionBudgetUs = 0;
+
         /*
          * The type of technique for stereoscopic rendering.
          *
@@ -390,6 +422,59 @@ public:
          * it's a GLES2 context. Ignored on other backends.
          */
         bool forceGLES2Context = false;
+
+        /*
+         * When the Vulkan backend is used, setting this value to true creates the pipelines on
+         * background threads the first time they're needed, instead of stalling the frame. The
+         * draw calls using a pipeline are skipped while it's being created, so objects may not
+         * appear for a few frames. Ignored on other backends, or if disableParallelShaderCompile
+         * is set.
+         */
+        bool vulkanAsyncPipelineCreation = false;
+
+        /*
+         * Setting this value to true lets the draw commands of large render passes be recorded
+         * on the JobSystem's threads, each in its own buffer of minCommandBufferSizeMB, instead
+         * of only on the thread that calls Renderer::render(). This is ignored if the
+         * JobSystem has no threads.
+         */
+        bool parallelCommandRecording = false;
+
+        /*
+         * Setting this value to true backs the per render pass arena and the command buffer
+         * with huge pages when the system allows it, which reduces the TLB misses when
+         * writing commands. On Linux and Android, explicitly reserved huge pages are tried
+         * first, then transparent huge pages. On Windows, this requires the process to hold the
+         * SeLockMemoryPrivilege. Filament falls back to regular pages otherwise, and this is
+         * ignored on other platforms.
+         *
+         * Because huge pages are at least 2 MiB, this can increase the memory footprint when
+         * perRenderPassArenaSizeMB isn't a multiple of the huge page size.
+         */
+        bool useHugePages = false;
+
+        /*
+         * When set, the backend commands are written into this file from the creation of the
+         * Engine until commandCaptureFrameCount frames have been rendered, so that the last
+         * of these frames can be replayed without the application by the frame-replay tool.
+         * This slows down the thread calling Renderer::render() noticeably and disables
+         * parallelCommandRecording. The string must stay valid until Engine::create(), or
+         * Engine::getEngine() when created asynchronously, returns.
+         */
+        const char* UTILS_NULLABLE commandCaptureFile = nullptr;
+
+        /*
+         * Number of frames captured into commandCaptureFile.
+         */
+        uint32_t commandCaptureFrameCount = 1;
+
+        /*
+         * Makes the NOOP backend count the render passes, draw calls, pipeline and primitive
+         * bindings, and the data uploaded to buffers and textures, see getDriverStats(). This
+         * measures the work Filament submits without a GPU, e.g. in CPU-only benchmarks.
+         * Ignored by the other backends.
+         */
+        bool noopDriverStatistics = false;
     };
 
 
@@ -664,6 +749,15 @@ public:
      */
     bool isStereoSupported(StereoscopicType stereoscopicType) const noexcept;
 
+    /**
+     * Queries the device and platform for support of variable rate shading, i.e. whether
+     * View::setShadingRate() has an effect.
+     *
+     * @return true if variable rate shading is supported, false otherwise
+     * @see View::setShadingRate
+     */
+    bool isVariableRateShadingSupported() const noexcept;
+
     /**
      * Retrieves the configuration settings of this Engine.
      *
@@ -723,6 +817,10 @@ public:
      * that the scene doesn't contain any identical primitives, automatic instancing can have some
      * overhead and it is then best to disable it.
      *
+     * When enabled, opaque primitives that can be instanced are sorted by their draw state
+     * instead of front-to-back, so that identical primitives are always grouped together. The
+     * number of draw calls saved is reported by Renderer::FrameInfo::instancingDrawCallsSaved.
+     *
      * Disabled by default.
      *
      * @param enable true to enable, false to disable automatic instancing.
@@ -738,6 +836,40 @@ public:
      */
     bool isAutomaticInstancingEnabled() const noexcept;
 
+    /**
+     * Starts or stops recording the systrace markers of all the threads in memory, including
+     * the JobSystem's and the driver's, so they can be written with writeTraceRecording().
+     * Starting a recording discards the previous one. This is process-wide, and has no effect
+     * on Android where the markers go to atrace, or on Apple platforms when
+     * FILAMENT_APPLE_SYSTRACE is set.
+     *
+     * Disabled by default.
+     *
+     * @param enable true to start recording, false to stop.
+     *
+     * @see writeTraceRecording
+     */
+    void setTraceRecordingEnabled(bool enable) noexcept;
+
+    /**
+     * @return true if the systrace markers are being recorded, false otherwise.
+     * @see setTraceRecordingEnabled
+     */
+    bool isTraceRecordingEnabled() const noexcept;
+
+    /**
+     * Writes the recorded systrace markers into a JSON trace file, which can be opened with
+     * ui.perfetto.dev or chrome://tracing. Only the most recent events of each thread are kept,
+     * and the events recorded while writing may be missing, so the recording is best stopped
+     * first.
+     *
+     * @param path path of the file to write.
+     * @return false if the file couldn't be written or if recording isn't supported.
+     *
+     * @see setTraceRecordingEnabled
+     */
+    bool writeTraceRecording(const char* UTILS_NONNULL path) const noexcept;
+
     /**
      * Creates a SwapChain from the given Operating System's native window handle.
      *
@@ -964,6 +1096,148 @@ public:
      */
     void setPaused(bool paused);
 
+    /**
+     * Statistics about the commands sent to the rendering thread, collected once per frame by
+     * Renderer::endFrame().
+     *
+     * @see getCommandStreamStats
+     */
+    struct CommandStreamStats {
+        //! Statistics of one type of command
+        struct CommandStats {
+            const char* UTILS_NULLABLE name;    //!< name of the command
+            uint32_t count;                     //!< number of commands executed
+            uint32_t size;                      //!< space used by these commands in bytes
+            uint64_t duration;                  //!< time spent executing them in nanoseconds
+        };
+
+        //! Maximum number of command types reported, only the most expensive ones are kept
+        static constexpr size_t MAX_COMMAND_TYPES = 16;
+
+        //! Bytes of commands flushed by the main thread
+        size_t size = 0;
+        //! Number of times the main thread flushed the command stream
+        uint32_t flushCount = 0;
+        //! Number of flushes which blocked because the command buffer was full
+        uint32_t waitCount = 0;
+        //! Time the main thread spent waiting for the rendering thread, in nanoseconds
+        uint64_t waitDuration = 0;
+
+        // the fields below are only set when profiling is enabled
+
+        //! Number of commands executed by the rendering thread
+        uint32_t commandCount = 0;
+        //! Time the rendering thread spent executing commands, in nanoseconds
+        uint64_t duration = 0;
+        //! Number of valid entries in commands
+        size_t commandTypeCount = 0;
+        //! Per command type statistics, sorted by decreasing duration
+        CommandStats commands[MAX_COMMAND_TYPES] = {};
+    };
+
+    /**
+     * Enables recording the count, size and execution time of each type of command on the
+     * rendering thread. This slows down the rendering thread noticeably and is meant for
+     * debugging; the "d.stream.profiling" debug property controls it as well.
+     *
+     * @see getCommandStreamStats
+     */
+    void setCommandStreamProfilingEnabled(bool enabled) noexcept;
+
+    /**
+     * @return Whether command stream profiling is enabled.
+     */
+    bool isCommandStreamProfilingEnabled() const noexcept;
+
+    /**
+     * Returns the command stream statistics of the last frame. The rendering thread usually
+     * lags behind, so the execution statistics relate to the commands executed during that
+     * frame, not necessarily to the ones it recorded.
+     *
+     * The same data is available from the "d.stream.stats" debug data source.
+     */
+    CommandStreamStats getCommandStreamStats() const noexcept;
+
+    /**
+     * Memory used by the Engine, in bytes.
+     *
+     * Texture and buffer sizes are estimated from their dimensions and formats, the actual
+     * amount of memory used by the GPU driver (alignment, compression, padding) may differ.
+     *
+     * @see getMemoryStats
+     */
+    struct MemoryStats {
+        //! Textures created with Texture::Builder, imported textures excluded
+        size_t textures = 0;
+        //! Vertex, index and buffer objects
+        size_t buffers = 0;
+        //! Sum of the peak transient texture memory of all Views during their last frame
+        size_t transientTextures = 0;
+        //! Transient textures kept by the Renderers' caches for reuse
+        size_t textureCache = 0;
+        //! Largest size the Renderers' texture caches reached
+        size_t textureCacheHighWatermark = 0;
+        //! Size of the command buffer
+        size_t commandBuffer = 0;
+        //! Largest amount of the command buffer used at once
+        size_t commandBufferHighWatermark = 0;
+        //! Size of the per render pass arena
+        size_t perRenderPassArena = 0;
+        //! Largest amount of the per render pass arena used by the draw commands of a View
+        size_t renderPassCommandsHighWatermark = 0;
+        //! Largest amount of its arena used by a FrameGraph
+        size_t frameGraphArenaHighWatermark = 0;
+        //! GPU memory allocated by the backend, 0 when the backend can't report it (OpenGL)
+        size_t device = 0;
+    };
+
+    /**
+     * Returns the current memory usage of the Engine, for instance to define memory budgets
+     * per device class.
+     *
+     * The transient textures and high watermarks are updated when a View is rendered.
+     */
+    MemoryStats getMemoryStats() const noexcept;
+
+    /**
+     * Work executed by the backend since the Engine was created. Only the NOOP backend collects
+     * it, when Config::noopDriverStatistics is set, all the fields are 0 otherwise. The number
+     * of commands of each type is given by getCommandStreamStats().
+     *
+     * @see getDriverStats
+     */
+    struct DriverStats {
+        //! Frames ended by the Renderers
+        uint64_t frameCount = 0;
+        //! Render passes begun
+        uint64_t renderPassCount = 0;
+        //! Draw calls, each draw of an indirect draw call counts
+        uint64_t drawCount = 0;
+        //! Pipeline bindings
+        uint64_t pipelineBindCount = 0;
+        //! Pipeline bindings identical to the previous one in the same render pass
+        uint64_t redundantPipelineBindCount = 0;
+        //! Render primitive bindings
+        uint64_t primitiveBindCount = 0;
+        //! Render primitive bindings identical to the previous one in the same render pass
+        uint64_t redundantPrimitiveBindCount = 0;
+        //! Updates of index buffers and buffer objects
+        uint64_t bufferUploadCount = 0;
+        //! Bytes uploaded to index buffers and buffer objects
+        uint64_t bufferUploadSize = 0;
+        //! Updates of texture images
+        uint64_t textureUploadCount = 0;
+        //! Bytes uploaded to textures
+        uint64_t textureUploadSize = 0;
+    };
+
+    /**
+     * Returns the work executed by the backend so far. The counts are updated by the backend at
+     * the end of each frame and when the command stream is flushed, call flushAndWait() first to
+     * include all the commands issued. Take the difference of two calls to measure a frame.
+     */
+    DriverStats getDriverStats() const noexcept;
+
     /**
      * Drains the user callback message queue and immediately execute all pending callbacks.
      *
@@ -1082,6 +1356,19 @@ public:
 
     DebugRegistry& getDebugRegistry() noexcept;
 
+    /**
+     * Writes which shader variants of each material were loaded so far. matedit's
+     * strip-variants command uses this profile to remove the other variants from a material
+     * package, which makes it smaller and faster to load.
+     *
+     * Some variants are only needed in some situations, e.g. with shadows, fog, stereo
+     * rendering or picking, the profile must therefore be recorded while the application
+     * exercises all of them. Variants loaded by Material::compile() are recorded too.
+     *
+     * @param out Stream the profile is written to, in a text format.
+     */
+    void writeVariantUsageProfile(utils::io::ostream& out) const noexcept;
+
 protected:
     //! \privatesection
     Engine() noexcept = default;
@@ -285,6 +285,25 @@ public:
      */
     const math::mat3f& getRotation() const noexcept;
 
+    /**
+     * Updates the irradiance spherical harmonics, without having to rebuild the IndirectLight.
+     * This is useful for dynamic environments, such as a time-of-day sky.
+     *
+     * The coefficients are blended with the current ones, so that calling this every frame with
+     * a small blend factor spreads the change over several frames instead of popping.
+     * This has no effect if the IndirectLight was built with an irradiance cubemap.
+     *
+     * @param bands     Number of spherical harmonics bands. Must be 1, 2 or 3.
+     * @param sh        Array containing the spherical harmonics coefficients, pre-scaled
+     *                  as described in Builder::irradiance().
+     * @param blend     Weight of the new coefficients, between 0 and 1. 1 (default) replaces
+     *                  the current coefficients.
+     *
+     * @see Builder::irradiance()
+     */
+    void setIrradiance(uint8_t bands, math::float3 const* UTILS_NONNULL sh,
+            float blend = 1.0f) noexcept;
+
     /**
      * Returns the associated reflection map, or null if it does not exist.
      */
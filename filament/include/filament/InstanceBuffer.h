@@ -17,6 +17,7 @@
 #ifndef TNT_FILAMENT_INSTANCEBUFFER_H
 #define TNT_FILAMENT_INSTANCEBUFFER_H
 
+#include <filament/Box.h>
 #include <filament/FilamentAPI.h>
 #include <filament/Engine.h>
 
@@ -70,6 +71,19 @@ public:
          */
         Builder& localTransforms(math::mat4f const* UTILS_NULLABLE localTransforms) noexcept;
 
+        /**
+         * Provide the bounding box of a single instance, in the space of the renderable's
+         * geometry, i.e. before the instance's local transform is applied. This is typically the
+         * bounding box of the mesh.
+         *
+         * When this is set, instances outside of the view frustum are not drawn, otherwise all
+         * the instances are drawn whenever the renderable is visible. Instances of renderables that
+         * cast shadows are only culled in views that don't render shadows.
+         *
+         * @param instanceBoundingBox the bounding box of one instance
+         */
+        Builder& instanceBoundingBox(Box const& instanceBoundingBox) noexcept;
+
         /**
          * Associate an optional name with this InstanceBuffer for debugging purposes.
          *
@@ -126,6 +126,27 @@ public:
     void setPositionsAt(Engine& engine, size_t targetIndex,
             math::float4 const* UTILS_NONNULL positions, size_t count, size_t offset = 0);
 
+    /**
+     * Updates positions for the given morph target from a sparse list of deltas, which is
+     * typical of blend shapes that only move a small part of a mesh.
+     *
+     * The "vertexCount" positions starting at "offset" are replaced: the vertices listed in
+     * "indices" get the corresponding position, and all the others get a zero delta. This
+     * uses 1.0 for the 4th component.
+     *
+     * @param engine Reference to the filament::Engine associated with this MorphTargetBuffer.
+     * @param targetIndex the index of morph target to be updated.
+     * @param indices pointer to at least "count" vertex indices, relative to "offset"
+     * @param positions pointer to at least "count" positions
+     * @param count number of entries in indices and positions
+     * @param offset offset into the target buffer, expressed as a number of float4 vectors
+     * @param vertexCount number of vertices replaced, 0 means up to the end of the buffer
+     * @see setTangentsAt
+     */
+    void setPositionsAt(Engine& engine, size_t targetIndex,
+            uint32_t const* UTILS_NONNULL indices, math::float3 const* UTILS_NONNULL positions,
+            size_t count, size_t offset = 0, size_t vertexCount = 0);
+
     /**
      * Updates tangents for the given morph target.
      *
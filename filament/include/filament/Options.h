@@ -140,6 +140,7 @@ struct BloomOptions {
     bool threshold = true;                  //!< whether to threshold the source
     bool enabled = false;                   //!< enable or disable bloom
     float highlight = 1000.0f;              //!< limit highlights to this value before bloom [10, +inf]
+    bool quarterResolution = false;         //!< downsample 4x per pass, faster but more aliasing
 
     /**
      * Bloom quality level.
@@ -350,6 +351,26 @@ struct VignetteOptions {
     bool enabled = false;                       //!< enables or disables the vignette effect
 };
 
+/**
+ * Options for automatic exposure, which scales the HDR color buffer before color grading so that
+ * the average luminance of the scene maps to middle gray. The average is computed on the GPU
+ * from a histogram of the color buffer and adapts smoothly over time.
+ *
+ * Automatic exposure is applied on top of the camera's exposure.
+ *
+ * @see setAutoExposureOptions()
+ */
+struct AutoExposureOptions {
+    float minLogLuminance = -8.0f;  //!< lowest log2 luminance tracked by the histogram
+    float maxLogLuminance = 8.0f;   //!< highest log2 luminance tracked by the histogram
+    float lowPercentile = 0.5f;     //!< darker pixels are ignored when averaging, between 0 and 1
+    float highPercentile = 0.95f;   //!< brighter pixels are ignored when averaging, between 0 and 1
+    float speedUp = 3.0f;           //!< adaptation speed when the scene gets brighter, in 1/s
+    float speedDown = 1.0f;         //!< adaptation speed when the scene gets darker, in 1/s
+    float compensation = 0.0f;      //!< exposure compensation, in EV
+    bool enabled = false;           //!< enables or disables automatic exposure
+};
+
 /**
  * Structure used to set the precision of the color buffer and related quality settings.
  *
@@ -376,7 +397,7 @@ struct AmbientOcclusionOptions {
     float radius = 0.3f;    //!< Ambient Occlusion radius in meters, between 0 and ~10.
     float power = 1.0f;     //!< Controls ambient occlusion's contrast. Must be positive.
     float bias = 0.0005f;   //!< Self-occlusion bias in meters. Use to avoid self-occlusion. Between 0 and a few mm.
-    float resolution = 0.5f;//!< How each dimension of the AO buffer is scaled. Must be either 0.5 or 1.0.
+    float resolution = 0.5f;//!< How each dimension of the AO buffer is scaled. Must be either 0.25, 0.5 or 1.0.
     float intensity = 1.0f; //!< Strength of the Ambient Occlusion effect.
     float bilateralThreshold = 0.05f; //!< depth distance that constitute an edge for filtering
     QualityLevel quality = QualityLevel::LOW; //!< affects # of samples used for AO.
@@ -486,6 +507,7 @@ struct ScreenSpaceReflectionsOptions {
     float bias = 0.01f;         //!< bias, in world units, to prevent self-intersections
     float maxDistance = 3.0f;   //!< maximum distance, in world units, to raycast
     float stride = 2.0f;        //!< stride, in texels, for samples along the ray.
+    float resolution = 1.0f;    //!< how each dimension of the reflections buffer is scaled, either 0.5 or 1.0.
     bool enabled = false;
 };
 
@@ -156,6 +156,12 @@ public:
          */
         static constexpr uint8_t DEFAULT_CHANNEL = 2u;
 
+        /**
+         * Maximum number of levels of detail of a Renderable
+         * @see Builder::levelOfDetail()
+         */
+        static constexpr uint8_t LEVEL_OF_DETAIL_COUNT_MAX = 4u;
+
         /**
          * Type of geometry for a Renderable
          */
@@ -372,6 +378,60 @@ public:
          */
         Builder& fog(bool enabled = true) noexcept;
 
+        /**
+         * Declares that the POSITION attribute of all the primitives of this renderable is
+         * quantized, typically to a normalized SHORT4 or USHORT4. The position in model space is
+         * `offset + scale * position`.
+         *
+         * The dequantization is folded into the model matrix of the renderable, so it doesn't
+         * cost anything in the vertex shader. The bounding box of the renderable and the
+         * transforms of its instances are still given in model space.
+         *
+         * Quantized positions can't be used with skinning or morphing.
+         *
+         * @param scale  scale from the quantized positions to model space
+         * @param offset position in model space of the quantized position 0
+         * @return A reference to this Builder for chaining calls.
+         *
+         * @see VertexBuffer::Builder::normalized
+         */
+        Builder& positionDequantization(math::float3 scale, math::float3 offset) noexcept;
+
+        /**
+         * Groups the primitives of this renderable into levels of detail (LOD), only one of
+         * which is drawn at a time. Levels are made of consecutive primitives: level 0 (the most
+         * detailed) uses the first \p primitiveCount primitives, level 1 the following ones, and
+         * so on. All levels share the renderable's bounding box.
+         *
+         * Each View selects a level from the size of the renderable's bounding sphere projected
+         * on screen, as a fraction of the viewport height: level i > 0 is used when that size is
+         * below the level's \p screenSize. The same level is used for all the passes of a View,
+         * including shadow maps. geometry::MeshSimplifier can be used to generate the levels.
+         *
+         * When no level is specified, all primitives belong to level 0. Primitive indices used
+         * elsewhere in this API (e.g. geometry() or setMaterialInstanceAt()) are not affected,
+         * they always span all levels.
+         *
+         * @param level         index of the level, less than LEVEL_OF_DETAIL_COUNT_MAX.
+         * @param primitiveCount number of primitives of this level. The primitive counts of all
+         *                      levels must add up to the count passed to the Builder constructor.
+         * @param screenSize    projected size below which this level is used, must decrease
+         *                      with the level. Ignored for level 0.
+         * @return A reference to this Builder for chaining calls.
+         */
+        Builder& levelOfDetail(uint8_t level, size_t primitiveCount, float screenSize) noexcept;
+
+        /**
+         * Prevents a renderable whose projected size hovers around a level's screenSize from
+         * switching level every frame: a coarser level is only selected below
+         * screenSize * (1 - hysteresis), and a finer one above screenSize * (1 + hysteresis).
+         *
+         * @param hysteresis fraction of the screenSize of the levels, between 0 and 1.
+         *                   0.1 by default.
+         * @return A reference to this Builder for chaining calls.
+         */
+        Builder& levelOfDetailHysteresis(float hysteresis) noexcept;
+
         /**
          * Enables GPU vertex skinning for up to 255 bones, 0 by default.
          *
@@ -593,6 +653,24 @@ public:
          */
         Result build(Engine& engine, utils::Entity entity);
 
+        /**
+         * Adds an identical Renderable component to each of the given entities. This is
+         * equivalent to calling build() on each entity, but the builder is validated only once
+         * and the component storage is only grown once. This is typically used to instantiate
+         * many copies of the same geometry and material, whose transforms are then set with
+         * TransformManager.
+         *
+         * @param engine Reference to the filament::Engine to associate the Renderables with.
+         * @param entities Array of \p count entities to add the Renderable component to.
+         * @param count Number of entities in \p entities.
+         * @return Success if the components were created successfully, Error otherwise.
+         *
+         * @see build(Engine&, utils::Entity)
+         * @see TransformManager::create(utils::Entity const*, size_t, Instance,
+         *      const math::mat4f*)
+         */
+        Result build(Engine& engine, utils::Entity const* UTILS_NONNULL entities, size_t count);
+
     private:
         friend class FEngine;
         friend class FRenderPrimitive;
@@ -794,10 +872,18 @@ public:
     uint8_t getLayerMask(Instance instance) const noexcept;
 
     /**
-     * Gets the immutable number of primitives in the given renderable.
+     * Gets the immutable number of primitives in the given renderable, this includes the
+     * primitives of all its levels of detail.
      */
     size_t getPrimitiveCount(Instance instance) const noexcept;
 
+    /**
+     * Gets the immutable number of levels of detail of the given renderable, at least 1.
+     *
+     * \see Builder::levelOfDetail()
+     */
+    size_t getLevelOfDetailCount(Instance instance) const noexcept;
+
     /**
      * Changes the material instance binding for the given primitive.
      *
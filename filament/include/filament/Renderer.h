@@ -97,6 +97,29 @@ public:
         time_point_ns endFrame;             //!< Renderer::endFrame() time since epoch [ns]
         time_point_ns backendBeginFrame;    //!< Backend thread time of frame start since epoch [ns]
         time_point_ns backendEndFrame;      //!< Backend thread time of frame end since epoch [ns]
+
+        //! maximum number of passes timed in a frame, the following passes are not timed
+        static constexpr size_t MAX_PASS_TIMINGS = 32;
+
+        /**
+         * GPU duration of a FrameGraph pass (e.g. shadow maps, SSAO, color pass or a
+         * post-process stage).
+         * @see setPassTimingEnabled()
+         */
+        struct PassTiming {
+            const char* name;               //!< name of the pass, a static string
+            duration_ns gpuTime;            //!< pass duration on the GPU in nanosecond [ns]
+        };
+
+        //! number of valid entries in passTimings, 0 unless setPassTimingEnabled(true)
+        uint32_t passTimingCount = 0;
+
+        //! per-pass GPU durations, in execution order, for all the views of the frame
+        PassTiming passTimings[MAX_PASS_TIMINGS] = {};
+
+        //! number of draw calls saved by automatic instancing during this frame
+        //! @see Engine::setAutomaticInstancingEnabled()
+        uint32_t instancingDrawCallsSaved = 0;
     };
 
     /**
@@ -114,6 +137,19 @@ public:
      */
     size_t getMaxFrameHistorySize() const noexcept;
 
+    /**
+     * Enables or disables timing each FrameGraph pass on the GPU. When enabled, the
+     * FrameInfo::passTimings of the frames returned by getFrameInfoHistory() are populated.
+     * This is disabled by default, as it costs two timestamps per pass.
+     *
+     * On the OpenGL backend, timer queries can't be nested. While pass timing is enabled the
+     * frame is not timed as a whole, and FrameInfo::frameTime is the sum of the pass durations.
+     *
+     * @param enabled true to time each pass
+     * @see getFrameInfoHistory()
+     */
+    void setPassTimingEnabled(bool enabled) noexcept;
+
     /**
      * Use FrameRateOptions to set the desired frame rate and control how quickly the system
      * reacts to GPU load changes.
@@ -132,6 +168,16 @@ public:
      *            needed to reach 64% of the target scale factor.
      *            Higher values make the dynamic resolution react faster.
      *
+     * The parameters below let the system anticipate thermal throttling, they rely on the thermal
+     * headroom forecast reported by the OS (currently Android 11 and later, ignored elsewhere).
+     * A headroom of 1.0 means the device is about to be throttled.
+     *
+     * thermalHeadroomThreshold: forecast thermal headroom above which the GPU load is reduced,
+     *                           by shrinking the frame time target by up to 50% as the forecast
+     *                           approaches 1.0. 0 disables thermal adaptation.
+     * thermalInterval: frame interval used instead of interval once the forecast reaches 1.0,
+     *                  0 keeps interval.
+     *
      * @see View::DynamicResolutionOptions
      * @see Renderer::DisplayInfo
      *
@@ -141,6 +187,8 @@ public:
         float scaleRate = 1.0f / 8.0f;     //!< rate at which the system reacts to load changes
         uint8_t history = 15;              //!< history size
         uint8_t interval = 1;              //!< desired frame interval in unit of 1.0 / DisplayInfo::refreshRate
+        float thermalHeadroomThreshold = 0.0f; //!< thermal headroom above which the load is reduced
+        uint8_t thermalInterval = 0;       //!< frame interval used when throttling is imminent
     };
 
     /**
@@ -186,6 +234,29 @@ public:
         bool discard = true;
     };
 
+    /**
+     * Use IdleFrameOptions to skip rendering frames whose content didn't change.
+     */
+    struct IdleFrameOptions {
+        /**
+         * When enabled, beginFrame() returns false if nothing that affects the Views rendered
+         * in the previous frames has changed, in which case the SwapChain keeps presenting the
+         * last rendered frame. Changes are tracked through the component managers, Scenes,
+         * Views, Cameras, MaterialInstances and buffer or texture uploads.
+         *
+         * Materials that animate on their own (e.g. using getUserTime()) aren't detected, and
+         * frames are never skipped while Streams are in use.
+         */
+        bool enabled = false;
+
+        /**
+         * Number of frames that are still rendered after the last change, so that temporal
+         * effects (TAA, auto-exposure, dynamic resolution, shadow map updates spread over
+         * several frames) can converge before frames are skipped.
+         */
+        uint8_t settleFrameCount = 30;
+    };
+
     /**
      * Information about the display this Renderer is associated to. This information is needed
      * to accurately compute dynamic-resolution scaling and for frame-pacing.
@@ -209,6 +280,18 @@ public:
      */
     ClearOptions const& getClearOptions() const noexcept;
 
+    /**
+     * Set IdleFrameOptions which control whether beginFrame() skips frames with unchanged
+     * content.
+     */
+    void setIdleFrameOptions(IdleFrameOptions const& options) noexcept;
+
+    /**
+     * Returns the IdleFrameOptions currently set.
+     * @return A reference to an IdleFrameOptions structure.
+     */
+    IdleFrameOptions const& getIdleFrameOptions() const noexcept;
+
     /**
      * Get the Engine that created this Renderer.
      *
@@ -571,6 +654,32 @@ public:
      */
     void renderStandaloneView(View const* UTILS_NONNULL view);
 
+    /**
+     * Render several standalone Views into their associated RenderTarget, in a single frame
+     *
+     * This is equivalent to calling renderStandaloneView() for each View, but the per-frame work
+     * (engine preparation, beginFrame / endFrame on the backend) is done only once for all of
+     * them, which significantly reduces the overhead of rendering many small images, e.g. for
+     * thumbnails generated offline.
+     *
+     * Views that render into the same RenderTarget are composited on top of each other, as
+     * with render(); the clear options are only applied to each RenderTarget once.
+     *
+     * The results can be read back with readPixels(RenderTarget*, ...) right after this call,
+     * the readbacks don't wait for the GPU and their callbacks are invoked once the data is
+     * available.
+     *
+     * @param views An array of `count` Views to render. Each View must have a RenderTarget
+     *              associated to it.
+     * @param count Number of Views in the array.
+     *
+     * @attention
+     * renderStandaloneViews() must be called outside of beginFrame() / endFrame().
+     *
+     * @see renderStandaloneView()
+     */
+    void renderStandaloneViews(View const* UTILS_NONNULL const* UTILS_NONNULL views, size_t count);
+
 
     /**
      * Returns the time in second of the last call to beginFrame(). This value is constant for all
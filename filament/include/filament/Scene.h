@@ -177,6 +177,28 @@ public:
      */
     void forEach(utils::Invocable<void(utils::Entity entity)>&& functor) const noexcept;
 
+    /**
+     * Enables or disables the culling hierarchy of this Scene.
+     *
+     * When enabled, the Scene maintains a bounding volume hierarchy of its renderables, which is
+     * updated incrementally from frame to frame. Frustum culling of the camera and of the
+     * directional shadow cascades then rejects entire groups of renderables at once, instead of
+     * testing each of them. This is beneficial for large scenes where most renderables don't
+     * move; in scenes where most renderables move every frame, maintaining the hierarchy can
+     * cost more than it saves.
+     *
+     * The culling hierarchy is disabled by default.
+     *
+     * @param enabled true to enable the culling hierarchy, false to disable it.
+     */
+    void setCullingHierarchyEnabled(bool enabled) noexcept;
+
+    /**
+     * @return Whether the culling hierarchy is enabled.
+     * @see setCullingHierarchyEnabled
+     */
+    bool isCullingHierarchyEnabled() const noexcept;
+
 protected:
     // prevent heap allocation
     ~Scene() = default;
@@ -182,6 +182,13 @@ public:
      * also where the callback is invoked. This method can only be used for streams that were
      * constructed without calling the `stream` method on the builder.
      *
+     * The image is sampled directly, without any copy or color conversion pass. The callback is
+     * only invoked once the GPU has finished executing the commands that sample the image, or
+     * when the stream is destroyed. At that point the image can be written to again, which
+     * allows the producer (e.g. a video decoder) to recycle its images from a small pool.
+     * Typically, the pool needs one image more than the number of frames in flight, plus the
+     * image being produced.
+     *
      * @see Stream for more information about NATIVE and ACQUIRED configurations.
      *
      * @param image      Pointer to AHardwareBuffer, casted to void* since this is a public header.
@@ -21,10 +21,12 @@
 
 #include <filament/FilamentAPI.h>
 
+#include <backend/CallbackHandler.h>
 #include <backend/DriverEnums.h>
 #include <backend/PixelBufferDescriptor.h>
 
 #include <utils/compiler.h>
+#include <utils/Invocable.h>
 
 #include <utility>
 
@@ -481,6 +483,24 @@ public:
      */
     void generateMipmaps(Engine& engine) const noexcept;
 
+    /**
+     * Restricts the mipmap levels that are sampled to the range [minLevel, maxLevel].
+     *
+     * This allows a texture to be streamed in progressively: the smallest levels are uploaded
+     * first with setImage() and the range is widened as larger levels become available, so the
+     * texture never samples a level that hasn't been uploaded yet. All levels are sampled by
+     * default.
+     *
+     * @param engine        Engine this texture is associated to.
+     * @param minLevel      Largest resolution level that can be sampled.
+     * @param maxLevel      Smallest resolution level that can be sampled.
+     *
+     * @attention \p engine must be the instance passed to Builder::build()
+     * @attention \p minLevel must be less or equal to \p maxLevel, which must be less than
+     *            getLevels().
+     */
+    void setMinMaxLevels(Engine& engine, size_t minLevel, size_t maxLevel);
+
     /**
      * Creates a reflection map from an environment map.
      *
@@ -519,6 +539,41 @@ public:
             PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
             PrefilterOptions const* UTILS_NULLABLE options = nullptr);
 
+    /**
+     * Asynchronous version of generatePrefilterMipmap().
+     *
+     * The environment is processed by a job in the background and the calling thread returns
+     * immediately. The mipmap levels are uploaded by the engine's thread during
+     * Renderer::beginFrame() once they're all ready, and then the callback is called. Until then
+     * the content of the texture is undefined.
+     *
+     * \p buffer is kept until the processing is done, its callback is called from the engine's
+     * thread. Only one prefiltering can be pending on a texture at a time. Destroying the texture
+     * waits for the pending prefiltering to finish.
+     *
+     * IBLPrefilterContext provides a GPU based alternative, which can be spread over several
+     * frames.
+     *
+     * @param engine        Reference to the filament::Engine to associate this IndirectLight with.
+     * @param buffer        Client-side buffer containing the images to set.
+     * @param faceOffsets   Offsets in bytes into \p buffer for all six images. The offsets
+     *                      are specified in the following order: +x, -x, +y, -y, +z, -z
+     * @param options       Optional parameter to controlling user-specified quality and options.
+     * @param handler       Handler to dispatch the callback or nullptr to call it directly from
+     *                      the engine's thread.
+     * @param callback      Called once all levels have been uploaded.
+     *
+     * @exception utils::PreConditionPanic if the source data constraints are not respected, or if
+     *            a prefiltering is already pending on this texture.
+     *
+     * @see generatePrefilterMipmap()
+     */
+    void generatePrefilterMipmapAsync(Engine& engine,
+            PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
+            PrefilterOptions const* UTILS_NULLABLE options,
+            backend::CallbackHandler* UTILS_NULLABLE handler,
+            utils::Invocable<void(Texture* UTILS_NONNULL)>&& callback);
+
 
     /** @deprecated */
     struct FaceOffsets {
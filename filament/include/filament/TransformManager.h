@@ -182,6 +182,22 @@ public:
     void create(utils::Entity entity, Instance parent, const math::mat4& localTransform); //!< \overload
     void create(utils::Entity entity, Instance parent = {}); //!< \overload
 
+    /**
+     * Creates transform components for several entities at once, all with the same parent.
+     * This is equivalent to calling create() for each entity, but the component storage
+     * is only grown once.
+     *
+     * @param entities          Array of \p count Entities to associate a transform component to.
+     * @param count             Number of entities in \p entities.
+     * @param parent            The Instance of the parent transform, or Instance{} if no parent.
+     * @param localTransforms   Array of \p count transforms, relative to the parent, or nullptr
+     *                          to use the identity for all of them.
+     *
+     * @see create(utils::Entity, Instance, const math::mat4f&)
+     */
+    void create(utils::Entity const* UTILS_NONNULL entities, size_t count, Instance parent = {},
+            const math::mat4f* UTILS_NULLABLE localTransforms = nullptr);
+
     /**
      * Destroys this component from the given entity, children are orphaned.
      * @param e An entity.
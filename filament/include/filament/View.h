@@ -22,9 +22,12 @@
 #include <filament/FilamentAPI.h>
 #include <filament/Options.h>
 
+#include <backend/DriverEnums.h>
+
 #include <utils/compiler.h>
 #include <utils/Entity.h>
 #include <utils/FixedCapacityVector.h>
+#include <utils/Invocable.h>
 
 #include <math/mathfwd.h>
 
@@ -81,6 +84,7 @@ public:
     using FogOptions = filament::FogOptions;
     using DepthOfFieldOptions = filament::DepthOfFieldOptions;
     using VignetteOptions = filament::VignetteOptions;
+    using AutoExposureOptions = filament::AutoExposureOptions;
     using RenderQuality = filament::RenderQuality;
     using AmbientOcclusionOptions = filament::AmbientOcclusionOptions;
     using TemporalAntiAliasingOptions = filament::TemporalAntiAliasingOptions;
@@ -90,6 +94,7 @@ public:
     using ScreenSpaceReflectionsOptions = filament::ScreenSpaceReflectionsOptions;
     using GuardBandOptions = filament::GuardBandOptions;
     using StereoscopicOptions = filament::StereoscopicOptions;
+    using ShadingRate = backend::ShadingRate;
 
     /**
      * Sets the View's name. Only useful for debugging.
@@ -212,6 +217,34 @@ public:
         return const_cast<View*>(this)->getCamera();
     }
 
+    /**
+     * Callback used to late-latch the camera's model matrix. It receives the model matrix the
+     * frame was prepared with and returns the model matrix to render with.
+     */
+    using CameraLateLatchCallback = utils::Invocable<math::mat4(math::mat4 const& model)>;
+
+    /**
+     * Enables late-latching of the camera's model matrix.
+     *
+     * Normally, the camera's transform is read when Renderer::render() is called, which can be
+     * up to a frame before the GPU commands are submitted. With late-latching, the callback is
+     * called on the backend thread, right before this view's uniforms are uploaded, and the
+     * model matrix it returns is used for rendering instead. This is useful to reduce
+     * the motion-to-photon latency of head-tracked displays, the callback would typically
+     * return the latest head pose, predicted for the time set with
+     * Renderer::setPresentationTime().
+     *
+     * The callback is called once per frame and must return quickly. Culling and shadows still
+     * use the model matrix the frame was prepared with, so the camera shouldn't move by more
+     * than a few degrees.
+     *
+     * @param callback  Callback called on the backend thread, or an empty Invocable to disable
+     *                  late-latching.
+     *
+     * @see setCamera(), Renderer::setPresentationTime()
+     */
+    void setCameraLateLatchCallback(CameraLateLatchCallback&& callback) noexcept;
+
     /**
      * Sets the blending mode used to draw the view into the SwapChain.
      *
@@ -281,6 +314,64 @@ public:
      */
     bool isShadowingEnabled() const noexcept;
 
+    /**
+     * Enables or disables shadow map caching. Disabled by default.
+     *
+     * When enabled, the shadow maps are kept from one frame to the next, and a shadow map is only
+     * rendered again when its light, its shadow casters or the part of the camera
+     * frustum it covers changed. This saves most of the cost of shadow mapping when the
+     * lights and the shadow casters are static.
+     *
+     * Shadow casters that are skinned, morphed or that use an InstanceBuffer are always
+     * considered as changed. Changes that don't affect the transform of a shadow caster (e.g.
+     * a material parameter or a time-based vertex animation) are not detected.
+     *
+     * @param enabled true enables shadow map caching, false disables it.
+     */
+    void setShadowMapCachingEnabled(bool enabled) noexcept;
+
+    /**
+     * @return whether shadow map caching is enabled
+     */
+    bool isShadowMapCachingEnabled() const noexcept;
+
+    /**
+     * Sets the maximum number of spot and point light shadow maps rendered per frame, each face
+     * of a point light counting as one shadow map. 0 means no limit, which is the default.
+     *
+     * When more shadow maps are out-of-date, the ones whose light covers more of the screen and
+     * the ones that weren't rendered for longer are rendered first, and the others are sampled
+     * as they were last rendered. Shadow maps that were never rendered are always rendered.
+     *
+     * This can be combined with shadow map caching, in which case only the shadow maps that
+     * changed count towards the budget.
+     *
+     * @param count maximum number of spot and point light shadow maps to render per frame.
+     *
+     * @see setShadowMapCachingEnabled()
+     */
+    void setShadowMapUpdateBudget(uint8_t count) noexcept;
+
+    /**
+     * @return the maximum number of spot and point light shadow maps rendered per frame
+     */
+    uint8_t getShadowMapUpdateBudget() const noexcept;
+
+    /**
+     * Sets how often the cascades of the directional light, except the first one, are rendered.
+     * Each of these cascades is rendered every `frames` frames, on different frames for different
+     * cascades, and is sampled as it was last rendered on other frames. The default of 1 renders
+     * all the cascades every frame.
+     *
+     * @param frames number of frames between two updates of a far cascade, at least 1.
+     */
+    void setFarCascadeUpdateInterval(uint8_t frames) noexcept;
+
+    /**
+     * @return the number of frames between two updates of a far cascade
+     */
+    uint8_t getFarCascadeUpdateInterval() const noexcept;
+
     /**
      * Enables or disables screen space refraction. Enabled by default.
      *
@@ -293,6 +384,119 @@ public:
      */
     bool isScreenSpaceRefractionEnabled() const noexcept;
 
+    /**
+     * Enables or disables occlusion culling. Disabled by default.
+     *
+     * When enabled, renderables that pass frustum culling are also tested against a
+     * low resolution depth buffer of a previous frame, and are not rendered in the color pass
+     * if they're entirely hidden. The depth buffer is produced by the structure (depth) pass,
+     * which is forced on when occlusion culling is enabled, and is read back asynchronously, so
+     * occlusion culling only starts working a few frames after being enabled.
+     *
+     * Because that depth buffer is a few frames old, a renderable moving from behind an
+     * occluder can appear with a few frames of delay. Occlusion culling is therefore best suited
+     * for scenes with a lot of static occluders, e.g. dense interiors.
+     *
+     * Occlusion culling is never used with a debug camera, or at feature level 0.
+     *
+     * @param enabled true enables occlusion culling, false disables it.
+     *
+     * @see getOcclusionCulledRenderableCount
+     */
+    void setOcclusionCullingEnabled(bool enabled) noexcept;
+
+    /**
+     * @return whether occlusion culling is enabled
+     */
+    bool isOcclusionCullingEnabled() const noexcept;
+
+    /**
+     * Enables or disables fitting the directional shadow cascades to the visible geometry.
+     * Disabled by default.
+     *
+     * When enabled, the cascades of the directional light end at the farthest geometry visible
+     * in a low resolution depth buffer of a previous frame, instead of at the camera's far
+     * plane (or LightManager::ShadowOptions::shadowFar), and the cascade splits start near the
+     * nearest visible geometry instead of at the camera's near plane. This gives a higher
+     * shadow resolution when a large part of the view frustum is empty, e.g. outdoors with a
+     * distant far plane, or when the camera's near plane is much closer than the scene.
+     * The depth buffer is the same as the one used by occlusion culling, and is read back
+     * asynchronously, so fitting only starts a few frames after being enabled.
+     *
+     * Because that depth buffer is a few frames old, geometry becoming visible farther away, or
+     * much closer, than what was visible before can be unshadowed for a few frames.
+     *
+     * Shadow fitting is never used with a debug camera, or at feature level 0.
+     *
+     * @param enabled true enables fitting the shadow cascades, false disables it.
+     *
+     * @see setOcclusionCullingEnabled
+     */
+    void setShadowDepthFittingEnabled(bool enabled) noexcept;
+
+    /**
+     * @return whether fitting the directional shadow cascades to the visible geometry is enabled
+     */
+    bool isShadowDepthFittingEnabled() const noexcept;
+
+    /**
+     * Returns the number of renderables rejected by occlusion culling during the last frame
+     * rendered with this View. Renderables rejected by frustum culling are not counted.
+     *
+     * @return number of renderables rejected by occlusion culling.
+     */
+    size_t getOcclusionCulledRenderableCount() const noexcept;
+
+    /**
+     * Returns an estimate of the memory needed by the transient render targets and textures
+     * (e.g. for post-processing effects) of the last frame rendered with this View, if the
+     * memory of the textures whose lifetimes don't overlap was shared.
+     *
+     * The memory actually used can be higher than this, because transient textures are only
+     * reused when they have the same format, dimensions and usage.
+     *
+     * @return peak size of the transient textures alive at the same time, in bytes.
+     *
+     * @see getTotalTransientMemorySize
+     */
+    size_t getPeakTransientMemorySize() const noexcept;
+
+    /**
+     * Returns an estimate of the memory needed by the transient render targets and textures of
+     * the last frame rendered with this View, if no memory was shared between them.
+     *
+     * @return size of all the transient textures, in bytes.
+     *
+     * @see getPeakTransientMemorySize
+     */
+    size_t getTotalTransientMemorySize() const noexcept;
+
+    /**
+     * Enables or disables order-independent transparency. Disabled by default.
+     *
+     * By default, blended renderables are sorted back-to-front by the distance of their center
+     * to the camera, which gives wrong results for intersecting or overlapping geometry.
+     * With order-independent transparency, they are rendered in any order into separate
+     * accumulation and revealage buffers, which are then composited over the color buffer
+     * (weighted blended order-independent transparency with uniform weights). This also lets
+     * blended renderables be sorted by material, like opaque ones.
+     *
+     * The result is an approximation: the colors of overlapping surfaces are averaged by their
+     * opacity rather than layered, which looks right for thin and moderately opaque surfaces
+     * but loses the ordering cue for very opaque ones. TransparencyMode, blend order and the
+     * material's blending mode (other than its alpha) are ignored.
+     *
+     * Order-independent transparency is not used with MSAA, multiview, or at feature level 0.
+     *
+     * @param enabled true enables order-independent transparency, false disables it.
+     */
+    void setOrderIndependentTransparencyEnabled(bool enabled) noexcept;
+
+    /**
+     * @return whether order-independent transparency is enabled
+     */
+    bool isOrderIndependentTransparencyEnabled() const noexcept;
+
     /**
      * Sets how many samples are to be used for MSAA in the post-process stage.
      * Default is 1 and disables MSAA.
@@ -491,6 +695,20 @@ public:
      */
     VignetteOptions getVignetteOptions() const noexcept;
 
+    /**
+     * Enables or disables automatic exposure in the post-processing stage. Disabled by default.
+     *
+     * @param options options
+     */
+    void setAutoExposureOptions(AutoExposureOptions options) noexcept;
+
+    /**
+     * Queries the automatic exposure options.
+     *
+     * @return the current automatic exposure options for this view.
+     */
+    AutoExposureOptions getAutoExposureOptions() const noexcept;
+
     /**
      * Enables or disables dithering in the post-processing stage. Enabled by default.
      *
@@ -668,6 +886,28 @@ public:
      */
     bool isFrontFaceWindingInverted() const noexcept;
 
+    /**
+     * Sets the rate at which the fragment shaders of the color pass are invoked. Default is
+     * ShadingRate::RATE_1x1, i.e. once per pixel.
+     *
+     * Coarser rates shade each 1x2, 2x1 or 2x2 pixels area with a single invocation, which lowers
+     * the cost of fill-rate bound views, at the expense of details in the shading (the geometry,
+     * depth and MSAA coverage are unaffected). Unlike dynamic resolution, this doesn't
+     * affect post-processing nor the size of the render targets.
+     *
+     * This is ignored when variable rate shading is not supported, see
+     * Engine::isVariableRateShadingSupported(). It's currently only supported by the Vulkan
+     * backend, with VK_KHR_fragment_shading_rate.
+     *
+     * @param rate the shading rate of the color pass
+     */
+    void setShadingRate(ShadingRate rate) noexcept;
+
+    /**
+     * @return the shading rate of the color pass, as set by setShadingRate()
+     */
+    ShadingRate getShadingRate() const noexcept;
+
     /**
      * Enables use of the stencil buffer.
      *
@@ -855,6 +1095,60 @@ public:
             backend::CallbackHandler* UTILS_NULLABLE handler,
             PickingQueryResultCallback UTILS_NONNULL callback) noexcept;
 
+    /** callback type used for batched picking queries, `results` holds `count` entries. */
+    using MultiPickingQueryResultCallback = void(*)(
+            PickingQueryResult const* UTILS_NULLABLE results, size_t count,
+            PickingQuery* UTILS_NONNULL pq);
+
+    /**
+     * Creates a batched picking query for several viewport coordinates, e.g. hover samples
+     * around the cursor. All the coordinates are resolved with a single readback of their
+     * bounding rectangle, which is much cheaper than one pick() per coordinate as long as the
+     * coordinates are close to each other.
+     *
+     * @param coords    Coordinates to query, origin at the bottom-left of the viewport. They are
+     *                  copied, the array doesn't need to outlive this call.
+     * @param count     Number of coordinates in `coords`.
+     * @param handler   Handler to dispatch the callback or nullptr for the default handler.
+     * @param callback  User callback, called with one result per coordinate, in the same order.
+     * @return          A reference to a PickingQuery structure, for user data.
+     * @see pick()
+     */
+    PickingQuery& pick(math::uint2 const* UTILS_NONNULL coords, size_t count,
+            backend::CallbackHandler* UTILS_NULLABLE handler,
+            MultiPickingQueryResultCallback UTILS_NONNULL callback) noexcept;
+
+    /**
+     * Creates a rectangle selection query, resolved with a single readback of the rectangle.
+     *
+     * @param x         Left of the rectangle in the viewport.
+     * @param y         Bottom of the rectangle in the viewport.
+     * @param width     Width of the rectangle, must be at least 1.
+     * @param height    Height of the rectangle, must be at least 1.
+     * @param handler   Handler to dispatch the callback or nullptr for the default handler.
+     * @param callback  User callback, called with one result per renderable visible in the
+     *                  rectangle, for the pixel of that renderable nearest to the camera.
+     * @return          A reference to a PickingQuery structure, for user data.
+     * @see pick()
+     */
+    PickingQuery& pickRect(uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+            backend::CallbackHandler* UTILS_NULLABLE handler,
+            MultiPickingQueryResultCallback UTILS_NONNULL callback) noexcept;
+
+    /**
+     * Picks the renderable whose world-space bounding box is hit first by the camera ray through
+     * the given viewport coordinates. This runs immediately on the CPU and needs no GPU
+     * round-trip, but only tests bounding boxes, so it is less precise than pick(): e.g. the
+     * empty corners of a bounding box are hit too.
+     *
+     * Only the renderables of the View's Scene that are in the View's visible layers are tested.
+     *
+     * @param x         Horizontal coordinate in the viewport with origin on the left.
+     * @param y         Vertical coordinate in the viewport with origin at the bottom.
+     * @return          The result, `renderable` is null if no bounding box was hit.
+     */
+    PickingQueryResult pickBoundingBoxes(uint32_t x, uint32_t y) const noexcept;
+
     /**
      * Set the value of material global variables. There are up-to four such variable each of
      * type float4. These variables can be read in a user Material with
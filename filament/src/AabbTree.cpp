@@ -0,0 +1,372 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AabbTree.h"
+
+#include <utils/compiler.h>
+#include <utils/debug.h>
+
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace filament::math;
+
+namespace filament {
+
+// Leaves are enlarged by this amount (in world units) plus a fraction of their size
+static constexpr float FAT_MARGIN = 0.1f;
+static constexpr float FAT_MARGIN_RATIO = 0.1f;
+
+static inline Aabb merge(Aabb const& a, Aabb const& b) noexcept {
+    return { min(a.min, b.min), max(a.max, b.max) };
+}
+
+static inline float area(Aabb const& box) noexcept {
+    float3 const d = box.max - box.min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+static inline bool contains(Aabb const& outer, Aabb const& inner) noexcept {
+    return all(lessThanEqual(outer.min, inner.min)) && all(greaterThanEqual(outer.max, inner.max));
+}
+
+static inline Aabb fatten(Aabb const& box) noexcept {
+    float3 const margin = FAT_MARGIN + FAT_MARGIN_RATIO * (box.max - box.min);
+    return { box.min - margin, box.max + margin };
+}
+
+AabbTree::AabbTree() noexcept = default;
+
+AabbTree::~AabbTree() noexcept = default;
+
+AabbTree::NodeId AabbTree::allocateNode() noexcept {
+    NodeId index;
+    if (mFreeList != NONE) {
+        index = mFreeList;
+        mFreeList = mNodes[index].parent;
+        mNodes[index] = {};
+    } else {
+        index = NodeId(mNodes.size());
+        mNodes.emplace_back();
+    }
+    mNodes[index].height = 0;
+    return index;
+}
+
+void AabbTree::freeNode(NodeId node) noexcept {
+    mNodes[node].parent = mFreeList;
+    mNodes[node].height = -1;
+    mFreeList = node;
+}
+
+AabbTree::NodeId AabbTree::insert(Aabb const& box, uint32_t userData) noexcept {
+    NodeId const leaf = allocateNode();
+    mNodes[leaf].box = fatten(box);
+    mNodes[leaf].userData = userData;
+    insertLeaf(leaf);
+    mLeafCount++;
+    return leaf;
+}
+
+void AabbTree::remove(NodeId leaf) noexcept {
+    assert_invariant(mNodes[leaf].isLeaf());
+    removeLeaf(leaf);
+    freeNode(leaf);
+    mLeafCount--;
+}
+
+bool AabbTree::update(NodeId leaf, Aabb const& box) noexcept {
+    assert_invariant(mNodes[leaf].isLeaf());
+    Aabb const& fat = mNodes[leaf].box;
+    // We keep the current fat box, unless it doesn't contain the new box, or it's become much
+    // larger than needed (e.g. the object shrunk).
+    if (contains(fat, box) && area(fat) <= 4.0f * area(fatten(box))) {
+        return false;
+    }
+    removeLeaf(leaf);
+    mNodes[leaf].box = fatten(box);
+    insertLeaf(leaf);
+    return true;
+}
+
+void AabbTree::insertLeaf(NodeId leaf) noexcept {
+    if (mRoot == NONE) {
+        mRoot = leaf;
+        mNodes[leaf].parent = NONE;
+        return;
+    }
+
+    // find the best sibling using the surface area heuristic
+    Aabb const leafBox = mNodes[leaf].box;
+    NodeId index = mRoot;
+    while (!mNodes[index].isLeaf()) {
+        Node const& node = mNodes[index];
+        float const nodeArea = area(node.box);
+        float const combinedArea = area(merge(node.box, leafBox));
+
+        // cost of creating a new parent for this node and the new leaf
+        float const cost = 2.0f * combinedArea;
+
+        // minimum cost of pushing the leaf further down the tree
+        float const inheritanceCost = 2.0f * (combinedArea - nodeArea);
+
+        auto descendCost = [&](NodeId child) {
+            Node const& c = mNodes[child];
+            float const merged = area(merge(leafBox, c.box));
+            return (c.isLeaf() ? merged : merged - area(c.box)) + inheritanceCost;
+        };
+
+        float const cost1 = descendCost(node.child1);
+        float const cost2 = descendCost(node.child2);
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    // create a new parent for the sibling and the leaf
+    NodeId const sibling = index;
+    NodeId const oldParent = mNodes[sibling].parent;
+    NodeId const newParent = allocateNode();
+    mNodes[newParent].parent = oldParent;
+    mNodes[newParent].box = merge(leafBox, mNodes[sibling].box);
+    mNodes[newParent].height = mNodes[sibling].height + 1;
+    mNodes[newParent].child1 = sibling;
+    mNodes[newParent].child2 = leaf;
+    mNodes[sibling].parent = newParent;
+    mNodes[leaf].parent = newParent;
+
+    if (oldParent != NONE) {
+        if (mNodes[oldParent].child1 == sibling) {
+            mNodes[oldParent].child1 = newParent;
+        } else {
+            mNodes[oldParent].child2 = newParent;
+        }
+    } else {
+        mRoot = newParent;
+    }
+
+    refit(mNodes[leaf].parent);
+}
+
+void AabbTree::removeLeaf(NodeId leaf) noexcept {
+    if (leaf == mRoot) {
+        mRoot = NONE;
+        return;
+    }
+
+    NodeId const parent = mNodes[leaf].parent;
+    NodeId const grandParent = mNodes[parent].parent;
+    NodeId const sibling = mNodes[parent].child1 == leaf ?
+            mNodes[parent].child2 : mNodes[parent].child1;
+
+    if (grandParent != NONE) {
+        // replace the parent with the sibling
+        if (mNodes[grandParent].child1 == parent) {
+            mNodes[grandParent].child1 = sibling;
+        } else {
+            mNodes[grandParent].child2 = sibling;
+        }
+        mNodes[sibling].parent = grandParent;
+        freeNode(parent);
+        refit(grandParent);
+    } else {
+        mRoot = sibling;
+        mNodes[sibling].parent = NONE;
+        freeNode(parent);
+    }
+}
+
+void AabbTree::refit(NodeId index) noexcept {
+    // walk back up the tree, rebalancing and fixing the boxes and heights
+    while (index != NONE) {
+        index = balance(index);
+        Node& node = mNodes[index];
+        Node const& child1 = mNodes[node.child1];
+        Node const& child2 = mNodes[node.child2];
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.box = merge(child1.box, child2.box);
+        index = node.parent;
+    }
+}
+
+/*
+ * Performs a left or right rotation if node A is imbalanced, returns the new root of the
+ * subtree.
+ *
+ *           A
+ *         /   \
+ *        B     C
+ *       / \   / \
+ *      D   E F   G
+ */
+AabbTree::NodeId AabbTree::balance(NodeId iA) noexcept {
+    Node& A = mNodes[iA];
+    if (A.isLeaf() || A.height < 2) {
+        return iA;
+    }
+
+    NodeId const iB = A.child1;
+    NodeId const iC = A.child2;
+    Node& B = mNodes[iB];
+    Node& C = mNodes[iC];
+
+    int32_t const imbalance = C.height - B.height;
+
+    // rotate C up
+    if (imbalance > 1) {
+        NodeId const iF = C.child1;
+        NodeId const iG = C.child2;
+        Node& F = mNodes[iF];
+        Node& G = mNodes[iG];
+
+        // swap A and C
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        // A's old parent now points to C
+        if (C.parent != NONE) {
+            if (mNodes[C.parent].child1 == iA) {
+                mNodes[C.parent].child1 = iC;
+            } else {
+                mNodes[C.parent].child2 = iC;
+            }
+        } else {
+            mRoot = iC;
+        }
+
+        if (F.height > G.height) {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.box = merge(B.box, G.box);
+            C.box = merge(A.box, F.box);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        } else {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.box = merge(B.box, F.box);
+            C.box = merge(A.box, G.box);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return iC;
+    }
+
+    // rotate B up
+    if (imbalance < -1) {
+        NodeId const iD = B.child1;
+        NodeId const iE = B.child2;
+        Node& D = mNodes[iD];
+        Node& E = mNodes[iE];
+
+        // swap A and B
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        // A's old parent now points to B
+        if (B.parent != NONE) {
+            if (mNodes[B.parent].child1 == iA) {
+                mNodes[B.parent].child1 = iB;
+            } else {
+                mNodes[B.parent].child2 = iB;
+            }
+        } else {
+            mRoot = iB;
+        }
+
+        if (D.height > E.height) {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.box = merge(C.box, E.box);
+            B.box = merge(A.box, D.box);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        } else {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.box = merge(C.box, D.box);
+            B.box = merge(A.box, E.box);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+AabbTree::Classification AabbTree::classify(float4 const* UTILS_RESTRICT planes,
+        Aabb const& box) noexcept {
+    float3 const center = box.center();
+    float3 const extent = box.extent();
+    bool intersects = false;
+    for (size_t j = 0; j < 6; j++) {
+        float const d = dot(planes[j].xyz, center) + planes[j].w;
+        float const r = dot(abs(planes[j].xyz), extent);
+        if (d - r > 0.0f) {
+            return Classification::OUTSIDE;
+        }
+        intersects |= d + r > 0.0f;
+    }
+    return intersects ? Classification::INTERSECTS : Classification::INSIDE;
+}
+
+bool AabbTree::validate() const noexcept {
+    if (mRoot == NONE) {
+        return mLeafCount == 0;
+    }
+    if (mNodes[mRoot].parent != NONE) {
+        return false;
+    }
+    return validate(mRoot) >= 0;
+}
+
+// returns the number of leaves under index, or -1 if the subtree is invalid
+int32_t AabbTree::validate(NodeId index) const noexcept {
+    Node const& node = mNodes[index];
+    if (node.isLeaf()) {
+        return node.height == 0 ? 1 : -1;
+    }
+    Node const& child1 = mNodes[node.child1];
+    Node const& child2 = mNodes[node.child2];
+    if (child1.parent != index || child2.parent != index ||
+            node.height != 1 + std::max(child1.height, child2.height) ||
+            !contains(node.box, child1.box) || !contains(node.box, child2.box)) {
+        return -1;
+    }
+    int32_t const count1 = validate(node.child1);
+    int32_t const count2 = validate(node.child2);
+    if (count1 < 0 || count2 < 0) {
+        return -1;
+    }
+    int32_t const count = count1 + count2;
+    return index == mRoot && size_t(count) != mLeafCount ? -1 : count;
+}
+
+} // namespace filament
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_AABBTREE_H
+#define TNT_FILAMENT_AABBTREE_H
+
+#include <filament/Box.h>
+
+#include <utils/compiler.h>
+#include <utils/debug.h>
+
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * A dynamic bounding volume hierarchy of axis aligned boxes.
+ *
+ * Leaves store a "fat" box, i.e. slightly larger than the box they were given, so that objects
+ * moving by small amounts don't need to be reinserted. Insertion uses a surface area heuristic
+ * and the tree is kept balanced with AVL-like rotations, so updates are O(log(n)).
+ *
+ * Every leaf carries a 32-bit user value.
+ */
+class AabbTree {
+public:
+    using NodeId = int32_t;
+    static constexpr NodeId NONE = -1;
+
+    enum class Classification : uint8_t {
+        OUTSIDE,
+        INTERSECTS,
+        INSIDE
+    };
+
+    AabbTree() noexcept;
+    ~AabbTree() noexcept;
+
+    AabbTree(AabbTree const&) = delete;
+    AabbTree& operator=(AabbTree const&) = delete;
+
+    // inserts a new leaf, returns its id
+    NodeId insert(Aabb const& box, uint32_t userData) noexcept;
+
+    // removes a leaf
+    void remove(NodeId leaf) noexcept;
+
+    // updates the box of a leaf, returns true if the leaf had to be reinserted
+    bool update(NodeId leaf, Aabb const& box) noexcept;
+
+    void setUserData(NodeId leaf, uint32_t userData) noexcept {
+        assert_invariant(mNodes[leaf].isLeaf());
+        mNodes[leaf].userData = userData;
+    }
+
+    uint32_t getUserData(NodeId leaf) const noexcept {
+        assert_invariant(mNodes[leaf].isLeaf());
+        return mNodes[leaf].userData;
+    }
+
+    // the fat box of a leaf
+    Aabb const& getFatBox(NodeId leaf) const noexcept {
+        return mNodes[leaf].box;
+    }
+
+    size_t getLeafCount() const noexcept { return mLeafCount; }
+
+    // height of the tree, a single leaf has a height of 0
+    int32_t getHeight() const noexcept {
+        return mRoot == NONE ? 0 : mNodes[mRoot].height;
+    }
+
+    // checks the structural invariants of the tree, for debugging and testing
+    bool validate() const noexcept;
+
+    // classifies a box against 6 planes, the inside of the planes is their negative side
+    static Classification classify(math::float4 const* UTILS_RESTRICT planes,
+            Aabb const& box) noexcept;
+
+    /*
+     * Calls visitor(uint32_t userData, bool inside) for each leaf whose fat box is not entirely
+     * outside of the 6 given planes. `inside` is true when the leaf is entirely inside all the
+     * planes. Subtrees entirely outside, or entirely inside, are not tested further.
+     */
+    template<typename Visitor>
+    void query(math::float4 const* UTILS_RESTRICT planes, Visitor&& visitor) const {
+        if (mRoot == NONE) {
+            return;
+        }
+        // the balanced tree height is O(log(n)), each level pushes at most one extra node
+        std::vector<NodeId> stack;
+        stack.reserve(size_t(getHeight()) + 2u);
+        stack.push_back(mRoot);
+        while (!stack.empty()) {
+            NodeId const index = stack.back();
+            stack.pop_back();
+            Node const& node = mNodes[index];
+            switch (classify(planes, node.box)) {
+                case Classification::OUTSIDE:
+                    break;
+                case Classification::INSIDE:
+                    visitAll(index, visitor);
+                    break;
+                case Classification::INTERSECTS:
+                    if (node.isLeaf()) {
+                        visitor(node.userData, false);
+                    } else {
+                        stack.push_back(node.child1);
+                        stack.push_back(node.child2);
+                    }
+                    break;
+            }
+        }
+    }
+
+private:
+    struct Node {
+        Aabb box;                   // fat box for leaves, union of the children otherwise
+        NodeId parent = NONE;       // next free node when in the free list
+        NodeId child1 = NONE;
+        NodeId child2 = NONE;
+        int32_t height = -1;        // 0 for leaves, -1 for free nodes
+        uint32_t userData = 0;
+        bool isLeaf() const noexcept { return child1 == NONE; }
+    };
+
+    template<typename Visitor>
+    void visitAll(NodeId root, Visitor& visitor) const {
+        std::vector<NodeId> stack;
+        stack.reserve(size_t(mNodes[root].height) + 2u);
+        stack.push_back(root);
+        while (!stack.empty()) {
+            Node const& node = mNodes[stack.back()];
+            stack.pop_back();
+            if (node.isLeaf()) {
+                visitor(node.userData, true);
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    NodeId allocateNode() noexcept;
+    void freeNode(NodeId node) noexcept;
+    void insertLeaf(NodeId leaf) noexcept;
+    void removeLeaf(NodeId leaf) noexcept;
+    void refit(NodeId index) noexcept;
+    NodeId balance(NodeId index) noexcept;
+    int32_t validate(NodeId index) const noexcept;
+
+    std::vector<Node> mNodes;
+    NodeId mRoot = NONE;
+    NodeId mFreeList = NONE;
+    size_t mLeafCount = 0;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_AABBTREE_H
@@ -36,7 +36,8 @@ using HeapAllocatorArena = utils::Arena<
 using LinearAllocatorArena = utils::Arena<
         utils::LinearAllocator,
         utils::LockingPolicy::NoLock,
-        utils::TrackingPolicy::DebugAndHighWatermark>;
+        utils::TrackingPolicy::DebugAndHighWatermark,
+        utils::AreaPolicy::HugePageArea>;
 
 #else
 
@@ -50,7 +51,9 @@ using HeapAllocatorArena = utils::Arena<
 
 using LinearAllocatorArena = utils::Arena<
         utils::LinearAllocator,
-        utils::LockingPolicy::NoLock>;
+        utils::LockingPolicy::NoLock,
+        utils::TrackingPolicy::Untracked,
+        utils::AreaPolicy::HugePageArea>;
 
 #endif
 
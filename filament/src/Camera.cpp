@@ -55,6 +55,11 @@ void Camera::setCustomEyeProjection(math::mat4 const* projection, size_t count,
     downcast(this)->setCustomEyeProjection(projection, count, projectionForCulling, near, far);
 }
 
+void Camera::setCustomEyeProjection(math::mat4 const* projection, size_t count,
+        double near, double far) {
+    downcast(this)->setCustomEyeProjection(projection, count, near, far);
+}
+
 void Camera::setProjection(Camera::Projection projection, double left, double right, double bottom,
         double top, double near, double far) {
     downcast(this)->setProjection(projection, left, right, bottom, top, near, far);
@@ -18,8 +18,30 @@
 
 #include <filament/Box.h>
 
+#include <utils/compiler.h>
+#include <utils/debug.h>
+
 #include <math/fast.h>
 
+#include <algorithm>
+#include <cmath>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define FILAMENT_CULLER_SSE2 1
+#   include <emmintrin.h>
+#   if (defined(__clang__) || defined(__GNUC__)) && !defined(_MSC_VER)
+        // we need the target attribute and __builtin_cpu_supports()
+#       define FILAMENT_CULLER_AVX2 1
+#       include <immintrin.h>
+#   endif
+#elif defined(__ARM_NEON)
+#   define FILAMENT_CULLER_NEON 1
+#   include <arm_neon.h>
+#endif
+
 using namespace filament::math;
 
 // use 8 if Culler::result_type is 8-bits, on ARMv8 it allows the compiler to write eight
@@ -31,15 +53,26 @@ namespace filament {
 static_assert(Culler::MODULO % FILAMENT_CULLER_VECTORIZE_HINT == 0,
         "MODULO m=must be a multiple of FILAMENT_CULLER_VECTORIZE_HINT");
 
-void Culler::intersects(
+namespace {
+
+using result_type = Culler::result_type;
+
+using SphereKernel = void(*)(result_type* results, float4 const* planes,
+        float4 const* b, size_t count) noexcept;
+
+using BoxKernel = void(*)(result_type* results, float4 const* planes,
+        float3 const* center, float3 const* extent, size_t count, size_t bit) noexcept;
+
+// ------------------------------------------------------------------------------------------------
+// Generic kernels, these rely on the compiler's auto-vectorization
+// ------------------------------------------------------------------------------------------------
+
+void intersectsGeneric(
         result_type* UTILS_RESTRICT results,
-        Frustum const& UTILS_RESTRICT frustum,
+        float4 const* UTILS_RESTRICT planes,
         float4 const* UTILS_RESTRICT b,
         size_t count) noexcept {
 
-    float4 const * const UTILS_RESTRICT planes = frustum.mPlanes;
-
-    count = round(count);
     #pragma clang loop vectorize_width(FILAMENT_CULLER_VECTORIZE_HINT)
     for (size_t i = 0; i < count; i++) {
         int visible = ~0;
@@ -59,16 +92,13 @@ void Culler::intersects(
     }
 }
 
-void Culler::intersects(
+void intersectsGeneric(
         result_type* UTILS_RESTRICT results,
-        Frustum const& UTILS_RESTRICT frustum,
+        float4 const* UTILS_RESTRICT planes,
         float3 const* UTILS_RESTRICT center,
         float3 const* UTILS_RESTRICT extent,
         size_t count, size_t bit) noexcept {
 
-    float4 const * UTILS_RESTRICT const planes = frustum.mPlanes;
-
-    count = round(count);
     #pragma clang loop vectorize_width(FILAMENT_CULLER_VECTORIZE_HINT)
     for (size_t i = 0; i < count; i++) {
         int visible = ~0;
@@ -93,6 +123,389 @@ void Culler::intersects(
     }
 }
 
+// The SIMD kernels below produce a bitmask where bit k is the visibility of the k-th primitive
+// of the batch, i.e. the AND of the sign bits of the 6 plane distances.
+
+UTILS_ALWAYS_INLINE
+inline void storeSphereResults(result_type* UTILS_RESTRICT results,
+        uint32_t mask, size_t n) noexcept {
+    for (size_t k = 0; k < n; k++) {
+        results[k] = result_type((mask >> k) & 1u);
+    }
+}
+
+UTILS_ALWAYS_INLINE
+inline void storeBoxResults(result_type* UTILS_RESTRICT results,
+        uint32_t mask, size_t n, size_t bit) noexcept {
+    result_type const clear = ~result_type(1u << bit);
+    for (size_t k = 0; k < n; k++) {
+        results[k] = result_type((results[k] & clear) | (((mask >> k) & 1u) << bit));
+    }
+}
+
+#if defined(FILAMENT_CULLER_SSE2)
+
+// ------------------------------------------------------------------------------------------------
+// SSE2 kernels (x86-64 baseline)
+// ------------------------------------------------------------------------------------------------
+
+// loads 4 float3 and transposes them into x, y and z vectors
+UTILS_ALWAYS_INLINE
+inline void load4x3(float3 const* UTILS_RESTRICT p, __m128& x, __m128& y, __m128& z) noexcept {
+    float const* const f = reinterpret_cast<float const*>(p);
+    __m128 const a = _mm_loadu_ps(f + 0);   // x0 y0 z0 x1
+    __m128 const b = _mm_loadu_ps(f + 4);   // y1 z1 x2 y2
+    __m128 const c = _mm_loadu_ps(f + 8);   // z2 x3 y3 z3
+    __m128 const bc = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));    // x2 x2 x3 x3
+    __m128 const ab = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));    // y0 y0 y1 y1
+    __m128 const bc2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));   // y2 y2 y3 y3
+    __m128 const ab2 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));   // z0 z0 z1 z1
+    __m128 const cc = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));    // z2 z2 z3 z3
+    x = _mm_shuffle_ps(a, bc, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(ab, bc2, _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(ab2, cc, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+// loads 4 float4 and transposes them into x, y, z and w vectors
+UTILS_ALWAYS_INLINE
+inline void load4x4(float4 const* UTILS_RESTRICT p,
+        __m128& x, __m128& y, __m128& z, __m128& w) noexcept {
+    float const* const f = reinterpret_cast<float const*>(p);
+    x = _mm_loadu_ps(f + 0);
+    y = _mm_loadu_ps(f + 4);
+    z = _mm_loadu_ps(f + 8);
+    w = _mm_loadu_ps(f + 12);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+}
+
+UTILS_ALWAYS_INLINE
+inline __m128 abs(__m128 v) noexcept {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+void intersectsSSE2(
+        result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT planes,
+        float4 const* UTILS_RESTRICT b,
+        size_t count) noexcept {
+    for (size_t i = 0; i < count; i += 4) {
+        __m128 x, y, z, r;
+        load4x4(b + i, x, y, z, r);
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t j = 0; j < 6; j++) {
+            __m128 dot = _mm_mul_ps(_mm_set1_ps(planes[j].x), x);
+            dot = _mm_add_ps(dot, _mm_mul_ps(_mm_set1_ps(planes[j].y), y));
+            dot = _mm_add_ps(dot, _mm_mul_ps(_mm_set1_ps(planes[j].z), z));
+            dot = _mm_add_ps(dot, _mm_sub_ps(_mm_set1_ps(planes[j].w), r));
+            visible = _mm_and_ps(visible, dot);
+        }
+        storeSphereResults(results + i, uint32_t(_mm_movemask_ps(visible)), 4);
+    }
+}
+
+void intersectsSSE2(
+        result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT planes,
+        float3 const* UTILS_RESTRICT center,
+        float3 const* UTILS_RESTRICT extent,
+        size_t count, size_t bit) noexcept {
+    for (size_t i = 0; i < count; i += 4) {
+        __m128 cx, cy, cz, ex, ey, ez;
+        load4x3(center + i, cx, cy, cz);
+        load4x3(extent + i, ex, ey, ez);
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t j = 0; j < 6; j++) {
+            __m128 const px = _mm_set1_ps(planes[j].x);
+            __m128 const py = _mm_set1_ps(planes[j].y);
+            __m128 const pz = _mm_set1_ps(planes[j].z);
+            __m128 dot = _mm_set1_ps(planes[j].w);
+            dot = _mm_add_ps(dot, _mm_sub_ps(_mm_mul_ps(px, cx), _mm_mul_ps(abs(px), ex)));
+            dot = _mm_add_ps(dot, _mm_sub_ps(_mm_mul_ps(py, cy), _mm_mul_ps(abs(py), ey)));
+            dot = _mm_add_ps(dot, _mm_sub_ps(_mm_mul_ps(pz, cz), _mm_mul_ps(abs(pz), ez)));
+            visible = _mm_and_ps(visible, dot);
+        }
+        storeBoxResults(results + i, uint32_t(_mm_movemask_ps(visible)), 4, bit);
+    }
+}
+
+#endif // FILAMENT_CULLER_SSE2
+
+#if defined(FILAMENT_CULLER_AVX2)
+
+// ------------------------------------------------------------------------------------------------
+// AVX2 kernels, selected at runtime
+// ------------------------------------------------------------------------------------------------
+
+#define FILAMENT_CULLER_TARGET_AVX2 __attribute__((target("avx2")))
+
+FILAMENT_CULLER_TARGET_AVX2 UTILS_ALWAYS_INLINE
+inline __m256 combine(__m128 lo, __m128 hi) noexcept {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+FILAMENT_CULLER_TARGET_AVX2 UTILS_ALWAYS_INLINE
+inline __m256 abs(__m256 v) noexcept {
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+FILAMENT_CULLER_TARGET_AVX2
+void intersectsAVX2(
+        result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT planes,
+        float4 const* UTILS_RESTRICT b,
+        size_t count) noexcept {
+    for (size_t i = 0; i < count; i += 8) {
+        __m128 x0, y0, z0, r0, x1, y1, z1, r1;
+        load4x4(b + i,     x0, y0, z0, r0);
+        load4x4(b + i + 4, x1, y1, z1, r1);
+        __m256 const x = combine(x0, x1);
+        __m256 const y = combine(y0, y1);
+        __m256 const z = combine(z0, z1);
+        __m256 const r = combine(r0, r1);
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t j = 0; j < 6; j++) {
+            __m256 dot = _mm256_mul_ps(_mm256_set1_ps(planes[j].x), x);
+            dot = _mm256_add_ps(dot, _mm256_mul_ps(_mm256_set1_ps(planes[j].y), y));
+            dot = _mm256_add_ps(dot, _mm256_mul_ps(_mm256_set1_ps(planes[j].z), z));
+            dot = _mm256_add_ps(dot, _mm256_sub_ps(_mm256_set1_ps(planes[j].w), r));
+            visible = _mm256_and_ps(visible, dot);
+        }
+        storeSphereResults(results + i, uint32_t(_mm256_movemask_ps(visible)), 8);
+    }
+}
+
+FILAMENT_CULLER_TARGET_AVX2
+void intersectsAVX2(
+        result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT planes,
+        float3 const* UTILS_RESTRICT center,
+        float3 const* UTILS_RESTRICT extent,
+        size_t count, size_t bit) noexcept {
+    for (size_t i = 0; i < count; i += 8) {
+        __m128 cx0, cy0, cz0, ex0, ey0, ez0;
+        __m128 cx1, cy1, cz1, ex1, ey1, ez1;
+        load4x3(center + i,     cx0, cy0, cz0);
+        load4x3(center + i + 4, cx1, cy1, cz1);
+        load4x3(extent + i,     ex0, ey0, ez0);
+        load4x3(extent + i + 4, ex1, ey1, ez1);
+        __m256 const cx = combine(cx0, cx1);
+        __m256 const cy = combine(cy0, cy1);
+        __m256 const cz = combine(cz0, cz1);
+        __m256 const ex = combine(ex0, ex1);
+        __m256 const ey = combine(ey0, ey1);
+        __m256 const ez = combine(ez0, ez1);
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t j = 0; j < 6; j++) {
+            __m256 const px = _mm256_set1_ps(planes[j].x);
+            __m256 const py = _mm256_set1_ps(planes[j].y);
+            __m256 const pz = _mm256_set1_ps(planes[j].z);
+            __m256 dot = _mm256_set1_ps(planes[j].w);
+            dot = _mm256_add_ps(dot,
+                    _mm256_sub_ps(_mm256_mul_ps(px, cx), _mm256_mul_ps(abs(px), ex)));
+            dot = _mm256_add_ps(dot,
+                    _mm256_sub_ps(_mm256_mul_ps(py, cy), _mm256_mul_ps(abs(py), ey)));
+            dot = _mm256_add_ps(dot,
+                    _mm256_sub_ps(_mm256_mul_ps(pz, cz), _mm256_mul_ps(abs(pz), ez)));
+            visible = _mm256_and_ps(visible, dot);
+        }
+        storeBoxResults(results + i, uint32_t(_mm256_movemask_ps(visible)), 8, bit);
+    }
+}
+
+#undef FILAMENT_CULLER_TARGET_AVX2
+
+#endif // FILAMENT_CULLER_AVX2
+
+#if defined(FILAMENT_CULLER_NEON)
+
+// ------------------------------------------------------------------------------------------------
+// NEON kernels
+// ------------------------------------------------------------------------------------------------
+
+// returns a 4-bits mask of the sign bits of v
+UTILS_ALWAYS_INLINE
+inline uint32_t movemask(uint32x4_t v) noexcept {
+    static constexpr int32_t shifts[4] = { 0, 1, 2, 3 };
+    uint32x4_t const bits = vshlq_u32(vshrq_n_u32(v, 31), vld1q_s32(shifts));
+#if defined(__aarch64__)
+    return vaddvq_u32(bits);
+#else
+    uint32x2_t const sum = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return vget_lane_u32(vpadd_u32(sum, sum), 0);
+#endif
+}
+
+void intersectsNEON(
+        result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT planes,
+        float4 const* UTILS_RESTRICT b,
+        size_t count) noexcept {
+    for (size_t i = 0; i < count; i += 4) {
+        float32x4x4_t const s = vld4q_f32(reinterpret_cast<float const*>(b + i));
+        uint32x4_t visible = vdupq_n_u32(~0u);
+        for (size_t j = 0; j < 6; j++) {
+            float32x4_t dot = vsubq_f32(vdupq_n_f32(planes[j].w), s.val[3]);
+            dot = vmlaq_n_f32(dot, s.val[0], planes[j].x);
+            dot = vmlaq_n_f32(dot, s.val[1], planes[j].y);
+            dot = vmlaq_n_f32(dot, s.val[2], planes[j].z);
+            visible = vandq_u32(visible, vreinterpretq_u32_f32(dot));
+        }
+        storeSphereResults(results + i, movemask(visible), 4);
+    }
+}
+
+void intersectsNEON(
+        result_type* UTILS_RESTRICT results,
+        float4 const* UTILS_RESTRICT planes,
+        float3 const* UTILS_RESTRICT center,
+        float3 const* UTILS_RESTRICT extent,
+        size_t count, size_t bit) noexcept {
+    for (size_t i = 0; i < count; i += 4) {
+        float32x4x3_t const c = vld3q_f32(reinterpret_cast<float const*>(center + i));
+        float32x4x3_t const e = vld3q_f32(reinterpret_cast<float const*>(extent + i));
+        uint32x4_t visible = vdupq_n_u32(~0u);
+        for (size_t j = 0; j < 6; j++) {
+            float32x4_t dot = vdupq_n_f32(planes[j].w);
+            dot = vmlaq_n_f32(dot, c.val[0], planes[j].x);
+            dot = vmlsq_n_f32(dot, e.val[0], std::abs(planes[j].x));
+            dot = vmlaq_n_f32(dot, c.val[1], planes[j].y);
+            dot = vmlsq_n_f32(dot, e.val[1], std::abs(planes[j].y));
+            dot = vmlaq_n_f32(dot, c.val[2], planes[j].z);
+            dot = vmlsq_n_f32(dot, e.val[2], std::abs(planes[j].z));
+            visible = vandq_u32(visible, vreinterpretq_u32_f32(dot));
+        }
+        storeBoxResults(results + i, movemask(visible), 4, bit);
+    }
+}
+
+#endif // FILAMENT_CULLER_NEON
+
+// ------------------------------------------------------------------------------------------------
+
+struct Kernels {
+    SphereKernel spheres;
+    BoxKernel boxes;
+};
+
+Kernels getKernels(Culler::Kernel kernel) noexcept {
+    switch (kernel) {
+#if defined(FILAMENT_CULLER_SSE2)
+        case Culler::Kernel::SSE2:
+            return { intersectsSSE2, intersectsSSE2 };
+#endif
+#if defined(FILAMENT_CULLER_AVX2)
+        case Culler::Kernel::AVX2:
+            return { intersectsAVX2, intersectsAVX2 };
+#endif
+#if defined(FILAMENT_CULLER_NEON)
+        case Culler::Kernel::NEON:
+            return { intersectsNEON, intersectsNEON };
+#endif
+        default:
+            return { intersectsGeneric, intersectsGeneric };
+    }
+}
+
+Kernels const& getBestKernels() noexcept {
+    static Kernels const kernels = getKernels(Culler::getKernel());
+    return kernels;
+}
+
+} // anonymous namespace
+
+Culler::Kernel Culler::getKernel() noexcept {
+    if (isKernelSupported(Kernel::AVX2)) {
+        return Kernel::AVX2;
+    }
+    if (isKernelSupported(Kernel::SSE2)) {
+        return Kernel::SSE2;
+    }
+    if (isKernelSupported(Kernel::NEON)) {
+        return Kernel::NEON;
+    }
+    return Kernel::GENERIC;
+}
+
+bool Culler::isKernelSupported(Kernel kernel) noexcept {
+    switch (kernel) {
+        case Kernel::GENERIC:
+            return true;
+        case Kernel::SSE2:
+#if defined(FILAMENT_CULLER_SSE2)
+            return true;
+#else
+            return false;
+#endif
+        case Kernel::AVX2:
+#if defined(FILAMENT_CULLER_AVX2)
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+        case Kernel::NEON:
+#if defined(FILAMENT_CULLER_NEON)
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+void Culler::intersects(
+        result_type* UTILS_RESTRICT results,
+        Frustum const& UTILS_RESTRICT frustum,
+        float4 const* UTILS_RESTRICT b,
+        size_t count) noexcept {
+    getBestKernels().spheres(results, frustum.mPlanes, b, round(count));
+}
+
+void Culler::intersects(
+        result_type* UTILS_RESTRICT results,
+        Frustum const& UTILS_RESTRICT frustum,
+        float3 const* UTILS_RESTRICT center,
+        float3 const* UTILS_RESTRICT extent,
+        size_t count, size_t bit) noexcept {
+    getBestKernels().boxes(results, frustum.mPlanes, center, extent, round(count), bit);
+}
+
+void Culler::intersects(
+        uint64_t* UTILS_RESTRICT masks,
+        float4 const* UTILS_RESTRICT planes, size_t frustumCount,
+        float3 const* UTILS_RESTRICT center,
+        float3 const* UTILS_RESTRICT extent,
+        size_t count) noexcept {
+    assert_invariant(frustumCount <= 64);
+
+    // The boxes are processed in batches small enough to stay in the L1 cache while they are
+    // tested against every frustum, so the AABB arrays are only read once from memory.
+    constexpr size_t BATCH_SIZE = 64;
+    for (size_t first = 0; first < count; first += BATCH_SIZE) {
+        size_t const n = std::min(BATCH_SIZE, count - first);
+        float3 const* const UTILS_RESTRICT c = center + first;
+        float3 const* const UTILS_RESTRICT e = extent + first;
+        uint64_t* const UTILS_RESTRICT m = masks + first;
+        std::fill_n(m, n, 0);
+        for (size_t k = 0; k < frustumCount; k++) {
+            float4 const* const UTILS_RESTRICT p = planes + k * 6;
+            #pragma clang loop vectorize_width(FILAMENT_CULLER_VECTORIZE_HINT)
+            for (size_t i = 0; i < n; i++) {
+                int visible = ~0;
+                #pragma clang loop unroll(full)
+                for (size_t j = 0; j < 6; j++) {
+                    const float dot =
+                            p[j].x * c[i].x - std::abs(p[j].x) * e[i].x +
+                            p[j].y * c[i].y - std::abs(p[j].y) * e[i].y +
+                            p[j].z * c[i].z - std::abs(p[j].z) * e[i].z +
+                            p[j].w;
+                    visible &= fast::signbit(dot);
+                }
+                m[i] |= uint64_t(visible & 1) << k;
+            }
+        }
+    }
+}
+
 /*
  * returns whether a box intersects with the frustum
  */
@@ -138,4 +551,22 @@ void Culler::Test::intersects(
     Culler::intersects(results, frustum, b, count);
 }
 
+void Culler::Test::intersects(Kernel kernel,
+        result_type* UTILS_RESTRICT results,
+        Frustum const& UTILS_RESTRICT frustum,
+        float3 const* UTILS_RESTRICT c,
+        float3 const* UTILS_RESTRICT e,
+        size_t count) noexcept {
+    assert_invariant(isKernelSupported(kernel));
+    getKernels(kernel).boxes(results, frustum.mPlanes, c, e, round(count), 0);
+}
+
+void Culler::Test::intersects(Kernel kernel,
+        result_type* UTILS_RESTRICT results,
+        Frustum const& UTILS_RESTRICT frustum,
+        float4 const* UTILS_RESTRICT b, size_t count) noexcept {
+    assert_invariant(isKernelSupported(kernel));
+    getKernels(kernel).spheres(results, frustum.mPlanes, b, round(count));
+}
+
 } // namespace filament
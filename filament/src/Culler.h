@@ -44,6 +44,23 @@ public:
 
     using result_type = uint8_t;
 
+    /*
+     * The culling kernels. The best kernel supported by the CPU is selected at runtime, other
+     * kernels can only be used for testing.
+     */
+    enum class Kernel : uint8_t {
+        GENERIC,    // portable C++, relies on auto-vectorization
+        SSE2,       // x86-64 baseline, 4 primitives at a time
+        AVX2,       // x86-64 with AVX2 (detected at runtime), 8 primitives at a time
+        NEON,       // ARM, 4 primitives at a time
+    };
+
+    // returns the kernel used by intersects()
+    static Kernel getKernel() noexcept;
+
+    // returns whether the given kernel can run on this CPU
+    static bool isKernelSupported(Kernel kernel) noexcept;
+
     /*
      * returns whether each AABB in an array intersects with the frustum
      */
@@ -53,6 +70,18 @@ public:
             math::float3 const* extent,
             size_t count, size_t bit) noexcept;
 
+    /*
+     * Tests each AABB in an array against several frustums in a single pass. 'planes' holds
+     * 6 planes per frustum, in the order of Frustum::getNormalizedPlanes(). Bit k of masks[i] is
+     * set if the i-th AABB intersects the k-th frustum. At most 64 frustums are supported, and
+     * 'count' doesn't need to be a multiple of MODULO.
+     */
+    static void intersects(uint64_t* masks,
+            math::float4 const* planes, size_t frustumCount,
+            math::float3 const* center,
+            math::float3 const* extent,
+            size_t count) noexcept;
+
     /*
      * returns whether each sphere in an array intersects with the frustum
      */
@@ -88,6 +117,18 @@ public:
                 Frustum const& frustum,
                 math::float4 const* b,
                 size_t count) noexcept;
+
+        // same as above, but using the given kernel, which must be supported
+        static void intersects(Kernel kernel, result_type* results,
+                Frustum const& frustum,
+                math::float3 const* c,
+                math::float3 const* e,
+                size_t count) noexcept;
+
+        static void intersects(Kernel kernel, result_type* results,
+                Frustum const& frustum,
+                math::float4 const* b,
+                size_t count) noexcept;
     };
 };
 
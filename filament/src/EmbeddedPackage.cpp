@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "EmbeddedPackage.h"
+
+#include <utils/Panic.h>
+#include <utils/Systrace.h>
+
+#if FILAMENT_COMPRESS_MATERIALS
+#include <zstd.h>
+#endif
+
+#include <stdlib.h>
+
+namespace filament {
+
+EmbeddedPackage::EmbeddedPackage(void const* data, size_t size)
+        : mData(data), mSize(size) {
+#if FILAMENT_COMPRESS_MATERIALS
+    SYSTRACE_CALL();
+    unsigned long long const decompressedSize = ZSTD_getFrameContentSize(data, size);
+    FILAMENT_CHECK_POSTCONDITION(decompressedSize != ZSTD_CONTENTSIZE_UNKNOWN &&
+            decompressedSize != ZSTD_CONTENTSIZE_ERROR) << "invalid embedded material package";
+    mBuffer = malloc(decompressedSize);
+    size_t const result = ZSTD_decompress(mBuffer, decompressedSize, data, size);
+    FILAMENT_CHECK_POSTCONDITION(!ZSTD_isError(result) && result == decompressedSize)
+            << "unable to decompress embedded material package";
+    mData = mBuffer;
+    mSize = decompressedSize;
+#endif
+}
+
+EmbeddedPackage::~EmbeddedPackage() noexcept {
+    free(mBuffer);
+}
+
+} // namespace filament
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_EMBEDDEDPACKAGE_H
+#define TNT_FILAMENT_EMBEDDEDPACKAGE_H
+
+#include <stddef.h>
+
+namespace filament {
+
+/*
+ * Gives access to one of the material packages embedded in the engine by resgen.
+ *
+ * When FILAMENT_COMPRESS_MATERIALS is enabled, each package is a separate zstd frame, which is
+ * decompressed into a temporary buffer that lives as long as this object. Material::Builder
+ * copies the package, so an EmbeddedPackage only needs to outlive the call to build(). This way,
+ * only the materials that are actually used are ever decompressed, e.g. most post-process
+ * materials never are.
+ *
+ * Otherwise, this simply refers to the embedded data.
+ */
+class EmbeddedPackage {
+public:
+    // Panics if a compressed package can't be decompressed.
+    EmbeddedPackage(void const* data, size_t size);
+    ~EmbeddedPackage() noexcept;
+
+    EmbeddedPackage(EmbeddedPackage const&) = delete;
+    EmbeddedPackage& operator=(EmbeddedPackage const&) = delete;
+
+    void const* data() const noexcept { return mData; }
+    size_t size() const noexcept { return mSize; }
+
+private:
+    void const* mData;
+    size_t mSize;
+    void* mBuffer = nullptr;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_EMBEDDEDPACKAGE_H
@@ -40,6 +40,7 @@
 
 #include <utils/compiler.h>
 #include <utils/Panic.h>
+#include <utils/TraceRecorder.h>
 
 #include <chrono>
 
@@ -390,10 +391,34 @@ void Engine::setPaused(bool paused) {
     downcast(this)->setPaused(paused);
 }
 
+void Engine::setCommandStreamProfilingEnabled(bool enabled) noexcept {
+    downcast(this)->setCommandStreamProfilingEnabled(enabled);
+}
+
+bool Engine::isCommandStreamProfilingEnabled() const noexcept {
+    return downcast(this)->isCommandStreamProfilingEnabled();
+}
+
+Engine::CommandStreamStats Engine::getCommandStreamStats() const noexcept {
+    return downcast(this)->getCommandStreamStats();
+}
+
+Engine::MemoryStats Engine::getMemoryStats() const noexcept {
+    return downcast(this)->getMemoryStats();
+}
+
+Engine::DriverStats Engine::getDriverStats() const noexcept {
+    return downcast(this)->getDriverStats();
+}
+
 DebugRegistry& Engine::getDebugRegistry() noexcept {
     return downcast(this)->getDebugRegistry();
 }
 
+void Engine::writeVariantUsageProfile(utils::io::ostream& out) const noexcept {
+    downcast(this)->writeVariantUsageProfile(out);
+}
+
 void Engine::pumpMessageQueues() {
     downcast(this)->pumpMessageQueues();
 }
@@ -410,6 +435,22 @@ bool Engine::isAutomaticInstancingEnabled() const noexcept {
     return downcast(this)->isAutomaticInstancingEnabled();
 }
 
+void Engine::setTraceRecordingEnabled(bool enable) noexcept {
+    if (enable) {
+        TraceRecorder::start();
+    } else {
+        TraceRecorder::stop();
+    }
+}
+
+bool Engine::isTraceRecordingEnabled() const noexcept {
+    return TraceRecorder::isRecording();
+}
+
+bool Engine::writeTraceRecording(const char* path) const noexcept {
+    return TraceRecorder::write(path);
+}
+
 FeatureLevel Engine::getSupportedFeatureLevel() const noexcept {
     return downcast(this)->getSupportedFeatureLevel();
 }
@@ -434,6 +475,10 @@ bool Engine::isStereoSupported(StereoscopicType) const noexcept {
     return downcast(this)->isStereoSupported();
 }
 
+bool Engine::isVariableRateShadingSupported() const noexcept {
+    return downcast(this)->isVariableRateShadingSupported();
+}
+
 size_t Engine::getMaxStereoscopicEyes() noexcept {
     return FEngine::getMaxStereoscopicEyes();
 }
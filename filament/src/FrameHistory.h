@@ -43,6 +43,11 @@ struct FrameHistoryEntry {
         FrameGraphTexture::Descriptor desc;
         math::mat4 projection;
     } ssr;
+    struct {
+        FrameGraphTexture color;    // 1x1 adapted log2 luminance
+        FrameGraphTexture::Descriptor desc;
+        double time = 0.0;          // engine time of the frame, in seconds
+    } autoExposure;
 };
 
 /*
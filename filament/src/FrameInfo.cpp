@@ -41,7 +41,8 @@ namespace filament {
 using namespace utils;
 using namespace backend;
 
-FrameInfoManager::FrameInfoManager(DriverApi& driver) noexcept {
+FrameInfoManager::FrameInfoManager(DriverApi& driver, bool canNestTimerQueries) noexcept
+        : mCanNestTimerQueries(canNestTimerQueries) {
     for (auto& query : mQueries) {
         query.handle = driver.createTimerQuery();
     }
@@ -52,6 +53,11 @@ FrameInfoManager::~FrameInfoManager() noexcept = default;
 void FrameInfoManager::terminate(DriverApi& driver) noexcept {
     for (auto& query : mQueries) {
         driver.destroyTimerQuery(query.handle);
+        for (auto& pass : query.passes) {
+            if (pass) {
+                driver.destroyTimerQuery(pass);
+            }
+        }
     }
 }
 
@@ -70,9 +76,16 @@ void FrameInfoManager::beginFrame(DriverApi& driver, Config const& config, uint3
 
     // references are not invalidated by CircularQueue<>, so we can associate a reference to
     // the slot we created to the timer query used to find the frame time.
-    mQueries[mIndex].pInfo = std::addressof(front);
-    // issue the timer query
-    driver.beginTimerQuery(mQueries[mIndex].handle);
+    Query& query = mQueries[mIndex];
+    query.pInfo = std::addressof(front);
+
+    mPassTimingEnabled = config.passTimings;
+
+    // issue the timer query, unless it can't be active at the same time as the passes'
+    query.timesFrame = mCanNestTimerQueries || !mPassTimingEnabled;
+    if (query.timesFrame) {
+        driver.beginTimerQuery(query.handle);
+    }
     // issue the custom backend command to get the backend time
     driver.queueCommand([&front](){
         front.backendBeginFrame = std::chrono::steady_clock::now();
@@ -81,7 +94,7 @@ void FrameInfoManager::beginFrame(DriverApi& driver, Config const& config, uint3
     // now is a good time to check the oldest active query
     while (mLast != mIndex) {
         uint64_t elapsed = 0;
-        TimerQueryResult const result = driver.getTimerQueryValue(mQueries[mLast].handle, &elapsed);
+        TimerQueryResult const result = getFrameTime(driver, mQueries[mLast], &elapsed);
         switch (result) {
             case TimerQueryResult::NOT_READY:
                 // nothing to do
@@ -122,10 +135,15 @@ void FrameInfoManager::beginFrame(DriverApi& driver, Config const& config, uint3
     }
 }
 
-void FrameInfoManager::endFrame(DriverApi& driver) noexcept {
+void FrameInfoManager::endFrame(DriverApi& driver, uint32_t instancingDrawCallsSaved) noexcept {
     auto& front = mFrameTimeHistory.front();
+    front.instancingDrawCallsSaved = instancingDrawCallsSaved;
+    assert_invariant(!mPassActive);
+    mPassTimingEnabled = false;
     // close the timer query
-    driver.endTimerQuery(mQueries[mIndex].handle);
+    if (mQueries[mIndex].timesFrame) {
+        driver.endTimerQuery(mQueries[mIndex].handle);
+    }
     // queue custom backend command to query the current time
     driver.queueCommand([&front](){
         // backend frame end-time
@@ -138,6 +156,68 @@ void FrameInfoManager::endFrame(DriverApi& driver) noexcept {
     mIndex = (mIndex + 1) % POOL_COUNT;
 }
 
+void FrameInfoManager::beginPass(DriverApi& driver, const char* name) noexcept {
+    assert_invariant(!mPassActive);
+    if (!mPassTimingEnabled) {
+        return;
+    }
+    auto& front = mFrameTimeHistory.front();
+    if (front.passCount < front.passNames.size()) {
+        front.passNames[front.passCount] = name;
+        // Pass queries are only created when a frame has that many passes, backends can have
+        // a limited number of timer queries.
+        Handle<HwTimerQuery>& pass = mQueries[mIndex].passes[front.passCount];
+        if (!pass) {
+            pass = driver.createTimerQuery();
+        }
+        driver.beginTimerQuery(pass);
+        mPassActive = true;
+    }
+}
+
+void FrameInfoManager::endPass(DriverApi& driver) noexcept {
+    if (mPassActive) {
+        auto& front = mFrameTimeHistory.front();
+        driver.endTimerQuery(mQueries[mIndex].passes[front.passCount]);
+        front.passCount++;
+        mPassActive = false;
+    }
+}
+
+TimerQueryResult FrameInfoManager::getFrameTime(DriverApi& driver,
+        Query const& query, uint64_t* elapsed) noexcept {
+    FrameInfoImpl& info = *query.pInfo;
+    if (query.timesFrame) {
+        TimerQueryResult const result = driver.getTimerQueryValue(query.handle, elapsed);
+        if (result == TimerQueryResult::AVAILABLE) {
+            // the passes ended before the frame did, their results must be available too
+            for (size_t i = 0; i < info.passCount; i++) {
+                uint64_t passElapsed = 0;
+                driver.getTimerQueryValue(query.passes[i], &passElapsed);
+                info.passTimes[i] = std::chrono::duration<uint64_t, std::nano>(passElapsed);
+            }
+        }
+        return result;
+    }
+
+    // the frame wasn't timed as a whole, use the sum of its passes
+    if (!info.passCount) {
+        return TimerQueryResult::ERROR;
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < info.passCount; i++) {
+        uint64_t passElapsed = 0;
+        TimerQueryResult const result = driver.getTimerQueryValue(query.passes[i], &passElapsed);
+        if (result != TimerQueryResult::AVAILABLE) {
+            return result;
+        }
+        info.passTimes[i] = std::chrono::duration<uint64_t, std::nano>(passElapsed);
+        total += passElapsed;
+    }
+    *elapsed = total;
+    return TimerQueryResult::AVAILABLE;
+}
+
 void FrameInfoManager::denoiseFrameTime(FrameHistoryQueue& history, Config const& config) noexcept {
     assert_invariant(!history.empty());
 
@@ -198,6 +278,14 @@ utils::FixedCapacityVector<Renderer::FrameInfo> FrameInfoManager::getFrameInfoHi
                 duration_cast<nanoseconds>(entry.backendBeginFrame.time_since_epoch()).count(),
                 duration_cast<nanoseconds>(entry.backendEndFrame.time_since_epoch()).count()
         });
+        Renderer::FrameInfo& info = result.back();
+        info.passTimingCount = entry.passCount;
+        info.instancingDrawCallsSaved = entry.instancingDrawCallsSaved;
+        for (size_t j = 0; j < entry.passCount; j++) {
+            info.passTimings[j] = {
+                    entry.passNames[j],
+                    duration_cast<nanoseconds>(entry.passTimes[j]).count() };
+        }
     }
     return result;
 }
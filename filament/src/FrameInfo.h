@@ -57,6 +57,10 @@ struct FrameInfoImpl : public details::FrameInfo {
     time_point backendBeginFrame;    // backend thread beginFrame time (makeCurrent time)
     time_point backendEndFrame;      // backend thread endFrame time (present time)
     std::atomic_bool ready{};        // true once backend thread has populated its data
+    uint32_t passCount = 0;          // number of passes timed during this frame
+    uint32_t instancingDrawCallsSaved = 0; // draw calls saved by automatic instancing
+    std::array<const char*, Renderer::FrameInfo::MAX_PASS_TIMINGS> passNames;
+    std::array<duration, Renderer::FrameInfo::MAX_PASS_TIMINGS> passTimes;
     explicit FrameInfoImpl(uint32_t frameId) noexcept
         : frameId(frameId) {
     }
@@ -150,9 +154,13 @@ public:
 
     struct Config {
         uint32_t historySize;
+        bool passTimings;           // time each pass between beginPass() and endPass()
     };
 
-    explicit FrameInfoManager(backend::DriverApi& driver) noexcept;
+    // canNestTimerQueries is false if the frame timer query can't be active at the same time
+    // as the pass timer queries, in which case the frame time is the sum of the passes' when
+    // pass timing is enabled.
+    FrameInfoManager(backend::DriverApi& driver, bool canNestTimerQueries) noexcept;
 
     ~FrameInfoManager() noexcept;
     void terminate(backend::DriverApi& driver) noexcept;
@@ -161,7 +169,11 @@ public:
     void beginFrame(backend::DriverApi& driver, Config const& config, uint32_t frameId) noexcept;
 
     // call this immediately before "swap buffers"
-    void endFrame(backend::DriverApi& driver) noexcept;
+    void endFrame(backend::DriverApi& driver, uint32_t instancingDrawCallsSaved) noexcept;
+
+    // call these around each pass of the frame, they're no-ops unless Config::passTimings is set
+    void beginPass(backend::DriverApi& driver, const char* name) noexcept;
+    void endPass(backend::DriverApi& driver) noexcept;
 
     details::FrameInfo getLastFrameInfo() const noexcept {
         // if pFront is not set yet, return FrameInfo(). But the `valid` field will be false in this case.
@@ -176,12 +188,21 @@ private:
     struct Query {
         backend::Handle<backend::HwTimerQuery> handle{};
         FrameInfoImpl* pInfo = nullptr;
+        // created the first time a frame has as many passes
+        std::array<backend::Handle<backend::HwTimerQuery>,
+                Renderer::FrameInfo::MAX_PASS_TIMINGS> passes{};
+        bool timesFrame = true;         // false if the frame time is the sum of the passes'
     };
+    static backend::TimerQueryResult getFrameTime(backend::DriverApi& driver,
+            Query const& query, uint64_t* elapsed) noexcept;
     std::array<Query, POOL_COUNT> mQueries;
     uint32_t mIndex = 0;                // index of current query
     uint32_t mLast = 0;                 // index of oldest query still active
     FrameInfoImpl* pFront = nullptr;    // the most recent slot with a valid frame time
     FrameHistoryQueue mFrameTimeHistory;
+    bool const mCanNestTimerQueries;
+    bool mPassTimingEnabled = false;    // pass timing is enabled for the current frame
+    bool mPassActive = false;           // a pass timer query is active
 };
 
 
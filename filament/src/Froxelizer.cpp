@@ -37,6 +37,15 @@
 #include <algorithm>
 
 #include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define FILAMENT_FROXELIZER_SSE2 1
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#   define FILAMENT_FROXELIZER_NEON 1
+#   include <arm_neon.h>
+#endif
 
 using namespace filament::math;
 using namespace utils;
@@ -78,6 +87,20 @@ static_assert(RECORD_BUFFER_ENTRY_COUNT <= 65536,
 static_assert(RECORD_BUFFER_ENTRY_COUNT <= CONFIG_MINSPEC_UBO_SIZE,
         "RecordBuffer cannot be larger than the UBO minspec (16KiB)");
 
+// The record table maps the light lists already in the record buffer to the first froxel using
+// them. It's kept at most half full so that lookups stay short.
+static constexpr size_t RECORD_TABLE_SIZE = FROXEL_BUFFER_MAX_ENTRY_COUNT * 2;
+static constexpr uint16_t RECORD_TABLE_EMPTY = 0xFFFF;
+
+static_assert((RECORD_TABLE_SIZE & (RECORD_TABLE_SIZE - 1)) == 0,
+        "The record table size must be a power of two");
+
+static_assert(FROXEL_BUFFER_MAX_ENTRY_COUNT < RECORD_TABLE_EMPTY,
+        "Froxel indices must fit in the record table");
+
+// Maximum number of vertical planes, there can't be more froxels horizontally than per slice.
+static constexpr size_t MAX_PLANE_COUNT_X = FROXEL_BUFFER_MAX_ENTRY_COUNT / FROXEL_SLICE_COUNT + 1;
+
 struct Froxelizer::FroxelThreadData :
         public std::array<LightGroupType, FROXEL_BUFFER_MAX_ENTRY_COUNT> {
 };
@@ -204,6 +227,11 @@ bool Froxelizer::prepare(
             rootArenaScope.allocate<LightRecord>(getFroxelBufferEntryCount(), CACHELINE_SIZE),
             getFroxelBufferEntryCount() };
 
+    // record table (~32 KiB)
+    mRecordTable = {
+            rootArenaScope.allocate<uint16_t>(RECORD_TABLE_SIZE, CACHELINE_SIZE),
+            RECORD_TABLE_SIZE };
+
     // froxel thread data (~256 KiB)
     mFroxelShardedData = {
             rootArenaScope.allocate<FroxelThreadData>(GROUP_COUNT, CACHELINE_SIZE),
@@ -213,6 +241,7 @@ bool Froxelizer::prepare(
     assert_invariant(mFroxelBufferUser.begin());
     assert_invariant(mRecordBufferUser.begin());
     assert_invariant(mLightRecords.begin());
+    assert_invariant(mRecordTable.begin());
     assert_invariant(mFroxelShardedData.begin());
 
     // initialize buffers that need to be
@@ -617,6 +646,14 @@ void Froxelizer::froxelizeLoop(FEngine& engine,
     }
 }
 
+size_t Froxelizer::hashLightRecord(LightRecord const& record) noexcept {
+    uint64_t h = 0;
+    for (size_t i = 0; i < LightRecord::bitset::WORLD_COUNT; i++) {
+        h = (h ^ record.lights.getBitsAt(i)) * 0x9E3779B97F4A7C15ull;
+    }
+    return size_t(h ^ (h >> 32u));
+}
+
 void Froxelizer::froxelizeAssignRecordsCompress() noexcept {
 
     SYSTRACE_CALL();
@@ -668,8 +705,23 @@ void Froxelizer::froxelizeAssignRecordsCompress() noexcept {
         point += (point - froxelRecords < 255) ? 1 : 0;
     });
 
+    // Light lists already written to the record buffer, so that identical lists can be shared
+    // by froxels that are not adjacent. This matters with many lights, when the record buffer
+    // would otherwise run out of space.
+    uint16_t* const UTILS_RESTRICT recordTable = mRecordTable.data();
+    std::fill_n(recordTable, RECORD_TABLE_SIZE, RECORD_TABLE_EMPTY);
+    auto findRecord = [recordTable, records](LightRecord const& record) -> uint16_t& {
+        size_t k = hashLightRecord(record) & (RECORD_TABLE_SIZE - 1);
+        while (recordTable[k] != RECORD_TABLE_EMPTY &&
+               records[recordTable[k]].lights != record.lights) {
+            k = (k + 1) & (RECORD_TABLE_SIZE - 1);
+        }
+        return recordTable[k];
+    };
+
     // how many froxel record entries were reused (for debugging)
     UTILS_UNUSED size_t reused = 0;
+    UTILS_UNUSED bool outOfSpace = false;
 
     for (size_t i = 0, c = mFroxelCount; i < c;) {
         LightRecord b = records[i];
@@ -678,47 +730,53 @@ void Froxelizer::froxelizeAssignRecordsCompress() noexcept {
             continue;
         }
 
-        // We have a limitation of 255 spot + 255 point lights per froxel.
-        // note: initializer list for union cannot have more than one element
-        FroxelEntry entry{ offset, uint8_t(std::min(size_t(255), b.lights.count())) };
-        const size_t lightCount = entry.count();
+        FroxelEntry entry{ 0u, 0u };
+        uint16_t& tableEntry = findRecord(b);
+        if (tableEntry != RECORD_TABLE_EMPTY) {
+            // this list of lights is already in the record buffer
+            entry.u32 = froxels[tableEntry].u32;
+        } else {
+            // We have a limitation of 255 spot + 255 point lights per froxel.
+            // note: initializer list for union cannot have more than one element
+            entry = FroxelEntry{ offset, uint8_t(std::min(size_t(255), b.lights.count())) };
+            const size_t lightCount = entry.count();
 
-        if (UTILS_UNLIKELY(offset + lightCount >= RECORD_BUFFER_ENTRY_COUNT)) {
+            if (UTILS_UNLIKELY(offset + lightCount >= RECORD_BUFFER_ENTRY_COUNT)) {
 #ifndef NDEBUG
-            slog.d << "out of space: " << i << ", at " << offset << io::endl;
-#endif
-            // note: instead of dropping froxels we could look for similar records we've already
-            // filed up.
-            do {
-                froxels[i] = { 0u, allLightsCount };
-                if (records[i].lights.none()) {
-                    froxels[i].u32 = 0;
+                if (!outOfSpace) {
+                    slog.d << "out of space: " << i << ", at " << offset << io::endl;
                 }
-            } while(++i < c);
-            goto out_of_memory;
+#endif
+                outOfSpace = true;
+                // fallback to the list of all lights, lists that are already in the record
+                // buffer can still be used by the remaining froxels.
+                entry = FroxelEntry{ 0u, allLightsCount };
+            } else {
+                // iterate the bitfield
+                auto * const beginPoint = froxelRecords + offset;
+                b.lights.forEachSetBit([point = beginPoint, beginPoint](size_t l) mutable {
+                    // make sure to keep this code branch-less
+                    const size_t word = l / LIGHT_PER_GROUP;
+                    const size_t bit  = l % LIGHT_PER_GROUP;
+                    l = (bit * GROUP_COUNT) | (word % GROUP_COUNT);
+                    *point = (RecordBufferType)l;
+                    // we need to "cancel" the write operation if we have more than 255 spot or
+                    // point lights (this is a limitation of the data type used to store the light
+                    // counts per froxel)
+                    point += (point - beginPoint < 255) ? 1 : 0;
+                });
+
+                offset += lightCount;
+                tableEntry = uint16_t(i);
+            }
         }
 
-        // iterate the bitfield
-        auto * const beginPoint = froxelRecords + offset;
-        b.lights.forEachSetBit([point = beginPoint, beginPoint](size_t l) mutable {
-            // make sure to keep this code branch-less
-            const size_t word = l / LIGHT_PER_GROUP;
-            const size_t bit  = l % LIGHT_PER_GROUP;
-            l = (bit * GROUP_COUNT) | (word % GROUP_COUNT);
-            *point = (RecordBufferType)l;
-            // we need to "cancel" the write operation if we have more than 255 spot or point lights
-            // (this is a limitation of the data type used to store the light counts per froxel)
-            point += (point - beginPoint < 255) ? 1 : 0;
-        });
-
-        offset += lightCount;
-
 #ifndef NDEBUG
-        if (lightCount) { reused--; }
+        reused--;
 #endif
         do {
 #ifndef NDEBUG
-            if (lightCount) { reused++; }
+            reused++;
 #endif
             froxels[i++].u32 = entry.u32;
             if (i >= c) break;
@@ -732,9 +790,126 @@ void Froxelizer::froxelizeAssignRecordsCompress() noexcept {
             }
         } while(records[i].lights == b.lights);
     }
-out_of_memory:
+
     // FIXME: on big-endian systems we need to change the endianness of the record buffer
-    ;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Light vs. froxel intersection kernels, these process 4 planes or froxels per iteration, the
+// remaining ones are processed by the scalar code.
+// ------------------------------------------------------------------------------------------------
+
+#if defined(FILAMENT_FROXELIZER_SSE2)
+
+// sphere radius must be squared, returns one bit per plane
+static inline uint32_t spherePlanesIntersection4(
+        float4 const* UTILS_RESTRICT planes, float4 const& s) noexcept {
+    __m128 px = _mm_loadu_ps(&planes[0].x);
+    __m128 py = _mm_loadu_ps(&planes[1].x);
+    __m128 pz = _mm_loadu_ps(&planes[2].x);
+    __m128 pw = _mm_loadu_ps(&planes[3].x);
+    _MM_TRANSPOSE4_PS(px, py, pz, pw);
+    __m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(px, _mm_set1_ps(s.x)),
+            _mm_mul_ps(py, _mm_set1_ps(s.y))),
+            _mm_mul_ps(pz, _mm_set1_ps(s.z))), pw);
+    return uint32_t(_mm_movemask_ps(_mm_cmplt_ps(_mm_mul_ps(d, d), _mm_set1_ps(s.w))));
+}
+
+// returns one bit per sphere, see sphereConeIntersectionFast()
+static inline uint32_t sphereConeIntersectionFast4(float4 const* UTILS_RESTRICT spheres,
+        float3 const& conePosition, float3 const& coneAxis,
+        float coneSinInverse, float coneCosSquared) noexcept {
+    __m128 sx = _mm_loadu_ps(&spheres[0].x);
+    __m128 sy = _mm_loadu_ps(&spheres[1].x);
+    __m128 sz = _mm_loadu_ps(&spheres[2].x);
+    __m128 sw = _mm_loadu_ps(&spheres[3].x);
+    _MM_TRANSPOSE4_PS(sx, sy, sz, sw);
+    __m128 const ax = _mm_set1_ps(coneAxis.x);
+    __m128 const ay = _mm_set1_ps(coneAxis.y);
+    __m128 const az = _mm_set1_ps(coneAxis.z);
+    __m128 const k = _mm_mul_ps(sw, _mm_set1_ps(coneSinInverse));
+    // d = sphere.xyz - (conePosition - k * coneAxis)
+    __m128 const dx = _mm_add_ps(_mm_sub_ps(sx, _mm_set1_ps(conePosition.x)), _mm_mul_ps(k, ax));
+    __m128 const dy = _mm_add_ps(_mm_sub_ps(sy, _mm_set1_ps(conePosition.y)), _mm_mul_ps(k, ay));
+    __m128 const dz = _mm_add_ps(_mm_sub_ps(sz, _mm_set1_ps(conePosition.z)), _mm_mul_ps(k, az));
+    __m128 const e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, dx), _mm_mul_ps(ay, dy)),
+            _mm_mul_ps(az, dz));
+    __m128 const dd = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+            _mm_mul_ps(dz, dz));
+    __m128 const hit = _mm_and_ps(
+            _mm_cmpge_ps(_mm_mul_ps(e, e), _mm_mul_ps(dd, _mm_set1_ps(coneCosSquared))),
+            _mm_cmpgt_ps(e, _mm_setzero_ps()));
+    return uint32_t(_mm_movemask_ps(hit));
+}
+
+#elif defined(FILAMENT_FROXELIZER_NEON)
+
+static inline uint32_t movemask(uint32x4_t m) noexcept {
+    static constexpr uint32_t const weights[4] = { 1, 2, 4, 8 };
+    uint32x4_t const bits = vandq_u32(m, vld1q_u32(weights));
+#if defined(__aarch64__)
+    return vaddvq_u32(bits);
+#else
+    uint32x2_t const sum = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return vget_lane_u32(vpadd_u32(sum, sum), 0);
+#endif
+}
+
+// sphere radius must be squared, returns one bit per plane
+static inline uint32_t spherePlanesIntersection4(
+        float4 const* UTILS_RESTRICT planes, float4 const& s) noexcept {
+    float32x4x4_t const p = vld4q_f32(&planes[0].x);
+    float32x4_t d = vmlaq_n_f32(p.val[3], p.val[0], s.x);
+    d = vmlaq_n_f32(d, p.val[1], s.y);
+    d = vmlaq_n_f32(d, p.val[2], s.z);
+    return movemask(vcltq_f32(vmulq_f32(d, d), vdupq_n_f32(s.w)));
+}
+
+// returns one bit per sphere, see sphereConeIntersectionFast()
+static inline uint32_t sphereConeIntersectionFast4(float4 const* UTILS_RESTRICT spheres,
+        float3 const& conePosition, float3 const& coneAxis,
+        float coneSinInverse, float coneCosSquared) noexcept {
+    float32x4x4_t const sp = vld4q_f32(&spheres[0].x);
+    float32x4_t const k = vmulq_n_f32(sp.val[3], coneSinInverse);
+    // d = sphere.xyz - (conePosition - k * coneAxis)
+    float32x4_t const dx = vmlaq_n_f32(
+            vsubq_f32(sp.val[0], vdupq_n_f32(conePosition.x)), k, coneAxis.x);
+    float32x4_t const dy = vmlaq_n_f32(
+            vsubq_f32(sp.val[1], vdupq_n_f32(conePosition.y)), k, coneAxis.y);
+    float32x4_t const dz = vmlaq_n_f32(
+            vsubq_f32(sp.val[2], vdupq_n_f32(conePosition.z)), k, coneAxis.z);
+    float32x4_t const e = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(dx, coneAxis.x),
+            dy, coneAxis.y), dz, coneAxis.z);
+    float32x4_t const dd = vmlaq_f32(vmlaq_f32(vmulq_f32(dx, dx), dy, dy), dz, dz);
+    uint32x4_t const hit = vandq_u32(
+            vcgeq_f32(vmulq_f32(e, e), vmulq_n_f32(dd, coneCosSquared)),
+            vcgtq_f32(e, vdupq_n_f32(0.0f)));
+    return movemask(hit);
+}
+
+#endif
+
+#if defined(FILAMENT_FROXELIZER_SSE2) || defined(FILAMENT_FROXELIZER_NEON)
+#   define FILAMENT_FROXELIZER_SIMD 1
+static constexpr size_t FROXELIZER_SIMD_WIDTH = 4;
+#endif
+
+// Sets bit i of `hits` if the sphere s intersects plane i, for i in [0, count).
+// Sphere radius must be squared.
+static void spherePlanesIntersection(uint64_t* UTILS_RESTRICT hits,
+        float4 const* UTILS_RESTRICT planes, size_t count, float4 const& s) noexcept {
+    std::fill_n(hits, (count + 63) / 64, 0);
+    size_t i = 0;
+#if defined(FILAMENT_FROXELIZER_SIMD)
+    // 4 is a divisor of 64, so each group of 4 bits lands in a single word
+    for (; i + FROXELIZER_SIMD_WIDTH <= count; i += FROXELIZER_SIMD_WIDTH) {
+        hits[i / 64] |= uint64_t(spherePlanesIntersection4(planes + i, s)) << (i % 64);
+    }
+#endif
+    for (; i < count; i++) {
+        hits[i / 64] |= uint64_t(spherePlaneIntersection(s, planes[i]).w > 0) << (i % 64);
+    }
 }
 
 static inline float2 project(mat4f const& p, float3 const& v) noexcept {
@@ -809,6 +984,8 @@ void Froxelizer::froxelizePointAndSpotLight(
 #endif
 
     const size_t zcenter = findSliceZ(s.z);
+    assert_invariant(mFroxelCountX + 1 <= MAX_PLANE_COUNT_X);
+    uint64_t planeHits[(MAX_PLANE_COUNT_X + 63) / 64];
     float4 const * const UTILS_RESTRICT planesX = mPlanesX;
     float4 const * const UTILS_RESTRICT planesY = mPlanesY;
     float const * const UTILS_RESTRICT planesZ = mDistancesZ;
@@ -843,21 +1020,22 @@ void Froxelizer::froxelizePointAndSpotLight(
                     size_t bx = std::numeric_limits<size_t>::max(); // horizontal begin index
                     size_t ex = 0; // horizontal end index
 
-                    // find the "begin" index (left side)
+                    // test all the vertical planes of this range at once, bit i is plane x0 + i
+                    spherePlanesIntersection(planeHits, planesX + x0, x1 - x0 + 2, cy);
+                    auto const planeHit = [&planeHits, x0](size_t ix) -> bool {
+                        size_t const i = ix - x0;
+                        return (planeHits[i / 64] >> (i % 64)) & 1u;
+                    };
+
+                    // find the "begin" and "end" indices
                     for (size_t ix = x0; ix < x1 + 1; ++ix) {
                         // The froxel that contains the center of the sphere is special,
                         // we don't even need to do the intersection check, it's always true.
-                        if (UTILS_LIKELY(ix != xcenter)) {
-                            float4 const& plane = ix < xcenter ? planesX[ix + 1] : planesX[ix];
-                            if (spherePlaneIntersection(cy, plane).w > 0) {
-                                // The reduced sphere from the previous stage intersects this
-                                // vertical plane, we record the min/max froxel indices
-                                bx = std::min(bx, ix);
-                                ex = std::max(ex, ix);
-                            }
-                        } else {
-                            // this is the froxel containing the center of the sphere, it is
-                            // definitely participating
+                        bool const hit = (ix == xcenter) ||
+                                (ix < xcenter ? planeHit(ix + 1) : planeHit(ix));
+                        if (hit) {
+                            // The reduced sphere from the previous stage intersects this
+                            // vertical plane, we record the min/max froxel indices
                             bx = std::min(bx, ix);
                             ex = std::max(ex, ix);
                         }
@@ -874,7 +1052,16 @@ void Froxelizer::froxelizePointAndSpotLight(
                     size_t fi = getFroxelIndex(bx, iy, iz);
                     if (light.invSin != std::numeric_limits<float>::infinity()) {
                         // This is a spotlight (common case)
-                        // this loops gets vectorized (on arm64) w/ clang
+#if defined(FILAMENT_FROXELIZER_SIMD)
+                        for (; bx + FROXELIZER_SIMD_WIDTH <= ex; bx += FROXELIZER_SIMD_WIDTH) {
+                            uint32_t const intersect = sphereConeIntersectionFast4(
+                                    boundingSpheres + fi,
+                                    light.position, light.axis, light.invSin, light.cosSqr);
+                            for (size_t k = 0; k < FROXELIZER_SIMD_WIDTH; k++) {
+                                froxelThread[fi++] |= LightGroupType((intersect >> k) & 1u) << bit;
+                            }
+                        }
+#endif
                         while (bx++ != ex) {
                             // see if this froxel intersects the cone
                             bool const intersect = sphereConeIntersectionFast(boundingSpheres[fi],
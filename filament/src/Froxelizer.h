@@ -200,6 +200,8 @@ private:
 
     void froxelizeAssignRecordsCompress() noexcept;
 
+    static size_t hashLightRecord(LightRecord const& record) noexcept;
+
     void froxelizePointAndSpotLight(FroxelThreadData& froxelThread, size_t bit,
             math::mat4f const& projection, const LightParams& light) const noexcept;
 
@@ -247,6 +249,7 @@ private:
     utils::Slice<FroxelThreadData> mFroxelShardedData;  // 256 KiB w/  256 lights and 8192 froxels
     utils::Slice<FroxelEntry> mFroxelBufferUser;        //  32 KiB w/ 8192 froxels
     utils::Slice<LightRecord> mLightRecords;            // 256 KiB w/  256 lights
+    utils::Slice<uint16_t> mRecordTable;                //  32 KiB w/ 8192 froxels
 
     // allocations in the command stream
     utils::Slice<RecordBufferType> mRecordBufferUser;   //  16 KiB
@@ -38,6 +38,10 @@ const mat3f& IndirectLight::getRotation() const noexcept {
     return downcast(this)->getRotation();
 }
 
+void IndirectLight::setIrradiance(uint8_t bands, float3 const* sh, float blend) noexcept {
+    downcast(this)->setIrradiance(bands, sh, blend);
+}
+
 Texture const* IndirectLight::getReflectionsTexture() const noexcept {
     return downcast(this)->getReflectionsTexture();
 }
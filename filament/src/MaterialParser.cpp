@@ -120,9 +120,19 @@ MaterialParser::ParseResult MaterialParser::parse() noexcept {
     }
 
     const auto [chosenLanguage, matTag, dictTag] = result.value();
-    if (UTILS_UNLIKELY(!DictionaryReader::unflatten(cc, dictTag, mImpl.mBlobDictionary))) {
-        return ParseResult::ERROR_OTHER;
+    if (dictTag == ChunkType::DictionaryText) {
+        if (UTILS_UNLIKELY(!DictionaryReader::unflatten(cc, dictTag, mImpl.mBlobDictionary))) {
+            return ParseResult::ERROR_OTHER;
+        }
+    } else {
+        // binary blobs are large and a material typically only uses a fraction of its variants,
+        // so they're decoded in getShader()
+        if (UTILS_UNLIKELY(!DictionaryReader::unflattenDeferred(cc, dictTag,
+                mImpl.mBlobDictionary, mImpl.mBlobs))) {
+            return ParseResult::ERROR_OTHER;
+        }
     }
+    mImpl.mDictionaryTag = dictTag;
     if (UTILS_UNLIKELY(!mImpl.mMaterialChunk.initialize(matTag))) {
         return ParseResult::ERROR_OTHER;
     }
@@ -294,6 +304,11 @@ bool MaterialParser::getMaterialVariantFilterMask(UserVariantFilterMask* value)
             reinterpret_cast<UserVariantFilterMask*>(value));
 }
 
+bool MaterialParser::getMaterialSpecializedVariants(UserVariantFilterMask* value) const noexcept {
+    return mImpl.getFromSimpleChunk(ChunkType::MaterialSpecializedVariants,
+            reinterpret_cast<UserVariantFilterMask*>(value));
+}
+
 bool MaterialParser::getMaterialDomain(MaterialDomain* value) const noexcept {
     static_assert(sizeof(MaterialDomain) == sizeof(uint8_t),
             "MaterialDomain expected size is wrong");
@@ -390,6 +405,17 @@ bool MaterialParser::getReflectionMode(ReflectionMode* value) const noexcept {
 
 bool MaterialParser::getShader(ShaderContent& shader,
         ShaderModel shaderModel, Variant variant, ShaderStage stage) noexcept {
+    uint32_t index;
+    if (!mImpl.mBlobs.empty() &&
+            mImpl.mMaterialChunk.getBlobIndex(shaderModel, variant, stage, &index)) {
+        ShaderContent& content = mImpl.mBlobDictionary[index];
+        if (content.empty()) {
+            if (UTILS_UNLIKELY(!DictionaryReader::decode(mImpl.mDictionaryTag,
+                    mImpl.mBlobs[index], content))) {
+                return false;
+            }
+        }
+    }
     return mImpl.mMaterialChunk.getShader(shader,
             mImpl.mBlobDictionary, shaderModel, variant, stage);
 }
@@ -18,6 +18,7 @@
 #define TNT_FILAMENT_MATERIALPARSER_H
 
 #include <filaflat/ChunkContainer.h>
+#include <filaflat/DictionaryReader.h>
 #include <filaflat/MaterialChunk.h>
 
 #include <filament/MaterialEnums.h>
@@ -106,6 +107,7 @@ public:
     bool getVertexDomain(VertexDomain* value) const noexcept;
     bool getMaterialDomain(MaterialDomain* domain) const noexcept;
     bool getMaterialVariantFilterMask(UserVariantFilterMask* userVariantFilterMask) const noexcept;
+    bool getMaterialSpecializedVariants(UserVariantFilterMask* specializedVariants) const noexcept;
 
     bool getShading(Shading*) const noexcept;
     bool getBlendingMode(BlendingMode*) const noexcept;
@@ -173,6 +175,11 @@ private:
         // Keep MaterialChunk alive between calls to getShader to avoid reload the shader index.
         filaflat::MaterialChunk mMaterialChunk;
         filaflat::BlobDictionary mBlobDictionary;
+
+        // For binary materials, the dictionary entries are only decoded when first requested,
+        // mBlobs points to the encoded blobs in mManagedBuffer.
+        filaflat::DictionaryReader::BlobList mBlobs;
+        filamat::ChunkType mDictionaryTag = filamat::ChunkType::Unknown;
     };
 
     filaflat::ChunkContainer& getChunkContainer() noexcept;
@@ -30,6 +30,13 @@ void MorphTargetBuffer::setPositionsAt(Engine& engine, size_t targetIndex,
     downcast(this)->setPositionsAt(downcast(engine), targetIndex, positions, count, offset);
 }
 
+void MorphTargetBuffer::setPositionsAt(Engine& engine, size_t targetIndex,
+        uint32_t const* indices, math::float3 const* positions, size_t count,
+        size_t offset, size_t vertexCount) {
+    downcast(this)->setPositionsAt(downcast(engine), targetIndex, indices, positions, count,
+            offset, vertexCount);
+}
+
 void MorphTargetBuffer::setTangentsAt(Engine& engine, size_t targetIndex,
         math::short4 const* tangents, size_t count, size_t offset) {
     downcast(this)->setTangentsAt(downcast(engine), targetIndex, tangents, count, offset);
@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OcclusionCuller.h"
+
+#include <backend/DriverEnums.h>
+#include <backend/PixelBufferDescriptor.h>
+
+#include "private/backend/DriverApi.h"
+
+#include <utils/compiler.h>
+#include <utils/debug.h>
+
+#include <math/mat4.h>
+#include <math/vec2.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace filament::math;
+
+namespace filament {
+
+using namespace backend;
+
+struct OcclusionCuller::Readback {
+    OcclusionCuller* owner;
+    mat4 clipFromWorld;
+    uint32_t width;
+    uint32_t height;
+    std::vector<float2> depth;
+};
+
+OcclusionCuller::OcclusionCuller() noexcept = default;
+
+OcclusionCuller::~OcclusionCuller() noexcept {
+    assert_invariant(!mPendingReadback);
+}
+
+void OcclusionCuller::terminate() noexcept {
+    if (mPendingReadback) {
+        // the readback callback owns the Readback, we just make sure it won't call us back
+        mPendingReadback->owner = nullptr;
+        mPendingReadback = nullptr;
+    }
+}
+
+void OcclusionCuller::reset() noexcept {
+    terminate();
+    mLevels.clear();
+    mDepth.clear();
+    mNearestDepth.clear();
+}
+
+void OcclusionCuller::readback(DriverApi& driver, Handle<HwRenderTarget> rt,
+        uint32_t width, uint32_t height, mat4 const& clipFromWorld) noexcept {
+    if (mPendingReadback) {
+        // we only ever have a single readback in flight
+        return;
+    }
+
+    Readback* const r = new Readback{ this, clipFromWorld, width, height,
+            std::vector<float2>(size_t(width) * height) };
+    mPendingReadback = r;
+
+    driver.readPixels(rt, 0, 0, width, height, {
+            r->depth.data(), r->depth.size() * sizeof(float2),
+            PixelDataFormat::RG, PixelDataType::FLOAT,
+            [](void*, size_t, void* user) {
+                Readback* const r = static_cast<Readback*>(user);
+                if (r->owner) {
+                    r->owner->mPendingReadback = nullptr;
+                    r->owner->setDepthBuffer(r->depth.data(), r->width, r->height,
+                            r->clipFromWorld);
+                }
+                delete r;
+            }, r
+    });
+}
+
+void OcclusionCuller::setDepthBuffer(float const* depth, uint32_t width, uint32_t height,
+        mat4 const& clipFromWorld) noexcept {
+    std::vector<float2> depthRange(size_t(width) * height);
+    std::transform(depth, depth + depthRange.size(), depthRange.begin(),
+            [](float d) { return float2{ d }; });
+    setDepthBuffer(depthRange.data(), width, height, clipFromWorld);
+}
+
+void OcclusionCuller::setDepthBuffer(float2 const* depthRange, uint32_t width, uint32_t height,
+        mat4 const& clipFromWorld) noexcept {
+    mLevels.clear();
+    mDepth.clear();
+    mNearestDepth.clear();
+    if (!width || !height) {
+        return;
+    }
+
+    mClipFromWorld = clipFromWorld;
+
+    // compute the layout of the mip chain, each level is a floor-halving of the previous one
+    uint32_t offset = 0;
+    for (uint32_t w = width, h = height;; w = std::max(1u, w / 2u), h = std::max(1u, h / 2u)) {
+        mLevels.push_back({ offset, w, h });
+        offset += w * h;
+        if (w == 1 && h == 1) {
+            break;
+        }
+    }
+
+    mDepth.resize(offset);
+    mNearestDepth.resize(size_t(width) * height);
+    for (size_t i = 0, c = mNearestDepth.size(); i < c; i++) {
+        mDepth[i] = depthRange[i].x;
+        mNearestDepth[i] = depthRange[i].y;
+    }
+
+    // Filament uses reversed-Z, so the farthest depth is the smallest value. When the source
+    // dimension is odd, the last texel of the destination also covers the extra row or column.
+    for (size_t l = 1; l < mLevels.size(); l++) {
+        Level const& src = mLevels[l - 1];
+        Level const& dst = mLevels[l];
+        float const* UTILS_RESTRICT const in = mDepth.data() + src.offset;
+        float* UTILS_RESTRICT const out = mDepth.data() + dst.offset;
+        for (uint32_t y = 0; y < dst.height; y++) {
+            uint32_t const y0 = std::min(2u * y, src.height - 1u);
+            uint32_t const y1 = y == dst.height - 1u ? src.height - 1u : 2u * y + 1u;
+            for (uint32_t x = 0; x < dst.width; x++) {
+                uint32_t const x0 = std::min(2u * x, src.width - 1u);
+                uint32_t const x1 = x == dst.width - 1u ? src.width - 1u : 2u * x + 1u;
+                float d = std::numeric_limits<float>::max();
+                for (uint32_t j = y0; j <= y1; j++) {
+                    for (uint32_t i = x0; i <= x1; i++) {
+                        d = std::min(d, in[j * src.width + i]);
+                    }
+                }
+                out[y * dst.width + x] = d;
+            }
+        }
+    }
+}
+
+float OcclusionCuller::getFarthestDepth(float x0, float y0, float x1, float y1) const noexcept {
+    Level const& base = mLevels[0];
+    int32_t const ix0 = std::clamp(int32_t(std::floor(x0)), 0, int32_t(base.width  - 1));
+    int32_t const iy0 = std::clamp(int32_t(std::floor(y0)), 0, int32_t(base.height - 1));
+    int32_t const ix1 = std::clamp(int32_t(std::floor(x1)), 0, int32_t(base.width  - 1));
+    int32_t const iy1 = std::clamp(int32_t(std::floor(y1)), 0, int32_t(base.height - 1));
+
+    // pick the level where the rectangle covers at most 2x2 texels
+    uint32_t const span = uint32_t(std::max(ix1 - ix0, iy1 - iy0));
+    size_t level = 0;
+    while (level < mLevels.size() - 1 && (1u << level) < span) {
+        level++;
+    }
+
+    Level const& l = mLevels[level];
+    uint32_t const lx0 = std::min(uint32_t(ix0) >> level, l.width  - 1u);
+    uint32_t const ly0 = std::min(uint32_t(iy0) >> level, l.height - 1u);
+    uint32_t const lx1 = std::min(uint32_t(ix1) >> level, l.width  - 1u);
+    uint32_t const ly1 = std::min(uint32_t(iy1) >> level, l.height - 1u);
+
+    float const* const UTILS_RESTRICT depth = mDepth.data() + l.offset;
+    float d = std::numeric_limits<float>::max();
+    for (uint32_t y = ly0; y <= ly1; y++) {
+        for (uint32_t x = lx0; x <= lx1; x++) {
+            d = std::min(d, depth[y * l.width + x]);
+        }
+    }
+    return d;
+}
+
+size_t OcclusionCuller::cull(Culler::result_type* results,
+        float3 const* center, float3 const* extent,
+        size_t count, size_t bit, mat4 const& worldTransform) const noexcept {
+    if (UTILS_UNLIKELY(mLevels.empty())) {
+        return 0;
+    }
+
+    // the AABBs have the current world transform applied, the depth buffer was rendered with
+    // the world transform of an older frame.
+    mat4f const clipFromScene{ mClipFromWorld * inverse(worldTransform) };
+
+    Level const& base = mLevels[0];
+    float2 const scale{ 0.5f * float(base.width), 0.5f * float(base.height) };
+    Culler::result_type const mask = Culler::result_type(1u << bit);
+
+    size_t culled = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!(results[i] & mask)) {
+            continue;
+        }
+
+        // the transform is linear, so the 8 corners can be computed from the projected center
+        // and the projected half-extent axes
+        float4 const c = clipFromScene * float4{ center[i], 1.0f };
+        float4 const ex = clipFromScene[0] * extent[i].x;
+        float4 const ey = clipFromScene[1] * extent[i].y;
+        float4 const ez = clipFromScene[2] * extent[i].z;
+
+        float2 lo{ std::numeric_limits<float>::max() };
+        float2 hi{ std::numeric_limits<float>::lowest() };
+        float nearest = 0.0f;
+        bool crossesCameraPlane = false;
+        for (size_t k = 0; k < 8; k++) {
+            float4 const p = c + ((k & 1u) ? ex : -ex) + ((k & 2u) ? ey : -ey)
+                               + ((k & 4u) ? ez : -ez);
+            if (p.w <= std::numeric_limits<float>::epsilon()) {
+                crossesCameraPlane = true;
+                break;
+            }
+            float3 const ndc = p.xyz / p.w;
+            lo = min(lo, ndc.xy);
+            hi = max(hi, ndc.xy);
+            nearest = std::max(nearest, ndc.z);
+        }
+
+        // Boxes crossing the camera or near planes are always visible, and so are boxes that
+        // are not entirely within the depth buffer, since we know nothing of what's outside.
+        if (crossesCameraPlane || nearest >= 1.0f ||
+                lo.x < -1.0f || lo.y < -1.0f || hi.x > 1.0f || hi.y > 1.0f) {
+            continue;
+        }
+
+        // texel (0,0) of the depth buffer is at the bottom-left, like NDC
+        float2 const t0 = (lo + 1.0f) * scale;
+        float2 const t1 = (hi + 1.0f) * scale;
+        if (nearest < getFarthestDepth(t0.x, t0.y, t1.x, t1.y)) {
+            results[i] &= ~mask;
+            culled++;
+        }
+    }
+    return culled;
+}
+
+float2 OcclusionCuller::getVisibleDistanceRange(mat4 const& viewFromWorld) const noexcept {
+    if (UTILS_UNLIKELY(mLevels.empty())) {
+        return {};
+    }
+
+    // unproject the center of each texel with the transform the depth buffer was rendered
+    // with, and reproject it in the current view.
+    mat4f const viewFromClip{ viewFromWorld * inverse(mClipFromWorld) };
+
+    Level const& base = mLevels[0];
+    float const* const UTILS_RESTRICT depth = mDepth.data() + base.offset;
+    float const* const UTILS_RESTRICT nearestDepth = mNearestDepth.data();
+    float2 const scale{ 2.0f / float(base.width), 2.0f / float(base.height) };
+    float nearest = std::numeric_limits<float>::max();
+    float farthest = 0.0f;
+    for (uint32_t y = 0; y < base.height; y++) {
+        for (uint32_t x = 0; x < base.width; x++) {
+            float2 const ndc = (float2{ x, y } + 0.5f) * scale - 1.0f;
+            // reversed-Z, the depth buffer is cleared to 0
+            float const n = nearestDepth[y * base.width + x];
+            if (n <= 0.0f) {
+                continue;
+            }
+            float4 const pn = viewFromClip * float4{ ndc, n, 1.0f };
+            nearest = std::min(nearest, -pn.z / pn.w);
+
+            float const d = depth[y * base.width + x];
+            if (d <= 0.0f) {
+                continue;
+            }
+            float4 const p = viewFromClip * float4{ ndc, d, 1.0f };
+            farthest = std::max(farthest, -p.z / p.w);
+        }
+    }
+    if (nearest == std::numeric_limits<float>::max()) {
+        return {};
+    }
+    return { std::max(0.0f, nearest), farthest };
+}
+
+} // namespace filament
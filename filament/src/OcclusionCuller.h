@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_OCCLUSIONCULLER_H
+#define TNT_FILAMENT_OCCLUSIONCULLER_H
+
+#include "Culler.h"
+
+#include <backend/DriverApiForward.h>
+#include <backend/Handle.h>
+
+#include <math/mat4.h>
+#include <math/vec2.h>
+#include <math/vec3.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * CPU side of the hierarchical-Z occlusion culling.
+ *
+ * A small depth buffer, where each texel holds the farthest depth of its footprint in the
+ * structure pass, is read back asynchronously from the GPU. Since the readback has a few frames
+ * of latency, the depth buffer is stored along with the clip-from-world transform it was
+ * rendered with, and renderables' AABBs are reprojected with that transform when tested.
+ *
+ * The test is conservative with respect to the depth buffer, however, because the depth buffer
+ * is old, objects that move from behind an occluder can be missing for the duration of the
+ * readback latency.
+ */
+class OcclusionCuller {
+public:
+    // maximum width of the depth buffer read back from the GPU
+    static constexpr uint32_t MAX_DEPTH_BUFFER_WIDTH = 128u;
+
+    OcclusionCuller() noexcept;
+    ~OcclusionCuller() noexcept;
+
+    OcclusionCuller(OcclusionCuller const&) = delete;
+    OcclusionCuller& operator=(OcclusionCuller const&) = delete;
+
+    // detaches a readback in flight, must be called before destruction
+    void terminate() noexcept;
+
+    // forgets the current depth buffer; nothing is culled until the next readback completes
+    void reset() noexcept;
+
+    bool hasDepthBuffer() const noexcept { return !mLevels.empty(); }
+
+    /*
+     * Issues an asynchronous readback of a RG32F render target of the given size, holding the
+     * (farthest, nearest) depth of each texel's footprint. No-op if a readback is already in
+     * flight.
+     */
+    void readback(backend::DriverApi& driver, backend::Handle<backend::HwRenderTarget> rt,
+            uint32_t width, uint32_t height, math::mat4 const& clipFromWorld) noexcept;
+
+    // Replaces the depth buffer (reversed-Z) and builds its mip chain.
+    void setDepthBuffer(float const* depth, uint32_t width, uint32_t height,
+            math::mat4 const& clipFromWorld) noexcept;
+
+    // Same as above, with the (farthest, nearest) depth of each texel.
+    void setDepthBuffer(math::float2 const* depthRange, uint32_t width, uint32_t height,
+            math::mat4 const& clipFromWorld) noexcept;
+
+    /*
+     * Clears `bit` in `results` for each AABB which is entirely behind the depth buffer.
+     * `worldTransform` is the transform that was applied to the AABBs. Entries whose bit is
+     * already cleared are skipped. Returns the number of AABBs rejected.
+     */
+    size_t cull(Culler::result_type* results,
+            math::float3 const* center,
+            math::float3 const* extent,
+            size_t count, size_t bit,
+            math::mat4 const& worldTransform) const noexcept;
+
+    /*
+     * Returns the distances along the view direction of `viewFromWorld` to the nearest and
+     * farthest geometry in the depth buffer, each is 0 if there is no depth buffer or it's empty.
+     * Texels where nothing was rendered are ignored. For the farthest distance, this includes
+     * the texels only partially covered by geometry, since they hold the farthest depth of
+     * their footprint.
+     */
+    math::float2 getVisibleDistanceRange(math::mat4 const& viewFromWorld) const noexcept;
+
+private:
+    struct Readback;
+    struct Level {
+        uint32_t offset;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    float getFarthestDepth(float x0, float y0, float x1, float y1) const noexcept;
+
+    Readback* mPendingReadback = nullptr;
+    math::mat4 mClipFromWorld;
+    std::vector<Level> mLevels;
+    std::vector<float> mDepth;
+    // nearest depth of each texel of the first level
+    std::vector<float> mNearestDepth;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_OCCLUSIONCULLER_H
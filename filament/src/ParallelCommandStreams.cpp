@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ParallelCommandStreams.h"
+
+namespace filament {
+
+using namespace backend;
+
+ParallelCommandStreams::ParallelCommandStreams(Driver& driver, size_t count, size_t size)
+        : mSize(size) {
+    mStreams.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        mStreams.push_back(std::make_unique<Stream>(driver, size));
+    }
+}
+
+ParallelCommandStreams::~ParallelCommandStreams() noexcept = default;
+
+} // namespace filament
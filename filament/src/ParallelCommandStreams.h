@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_PARALLELCOMMANDSTREAMS_H
+#define TNT_FILAMENT_PARALLELCOMMANDSTREAMS_H
+
+#include "private/backend/CircularBuffer.h"
+#include "private/backend/CommandStream.h"
+
+#include <memory>
+#include <vector>
+
+#include <stddef.h>
+
+namespace filament {
+
+/*
+ * A set of CommandStreams that JobSystem threads can record into concurrently, each writing to
+ * its own CircularBuffer. The recorded commands are then moved, in order, at the end of the
+ * engine's CommandStream by the thread that owns it.
+ *
+ * Only commands that don't use CommandStream::allocate() can be recorded this way, since they
+ * are relocated.
+ */
+class ParallelCommandStreams {
+public:
+    // beyond this, the main thread spends more time moving the commands than recording them
+    static constexpr size_t MAX_COUNT = 8;
+
+    // creates `count` streams which can each hold `size` bytes of commands
+    ParallelCommandStreams(backend::Driver& driver, size_t count, size_t size);
+    ~ParallelCommandStreams() noexcept;
+
+    ParallelCommandStreams(ParallelCommandStreams const& rhs) = delete;
+    ParallelCommandStreams& operator=(ParallelCommandStreams const& rhs) = delete;
+
+    size_t getCount() const noexcept { return mStreams.size(); }
+
+    size_t getSize() const noexcept { return mSize; }
+
+    // Returns stream `index` and binds it to the calling thread, a stream can only be used by
+    // one thread at a time.
+    backend::CommandStream& acquire(size_t index) noexcept {
+        Stream& stream = *mStreams[index];
+        stream.commands.debugThreading();
+        return stream.commands;
+    }
+
+    // Moves the commands recorded in stream `index` at the end of `commands`.
+    void append(backend::CommandStream& commands, size_t index) noexcept {
+        commands.append(mStreams[index]->buffer);
+    }
+
+private:
+    struct Stream {
+        Stream(backend::Driver& driver, size_t size) : buffer(size), commands(driver, buffer) {}
+        backend::CircularBuffer buffer;
+        backend::CommandStream commands;
+    };
+
+    std::vector<std::unique_ptr<Stream>> mStreams;
+    size_t const mSize;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_PARALLELCOMMANDSTREAMS_H
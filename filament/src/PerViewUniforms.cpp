@@ -34,11 +34,35 @@
 
 #include <math/mat4.h>
 
+#include <memory>
+#include <utility>
+
 namespace filament {
 
 using namespace backend;
 using namespace math;
 
+struct PerViewUniforms::CameraLateLatch {
+    std::shared_ptr<CameraLateLatchCallback> callback;
+    CameraInfo camera;
+    uint8_t eyeCount;
+    bool latched = false;
+
+    // this is only ever called on the backend thread
+    void apply(PerViewUib& s) {
+        if (!latched) {
+            latched = true;
+            // the callback works with the camera's model matrix as set by the user, i.e.
+            // without the world origin transform
+            mat4 const model = (*callback)(inverse(camera.worldTransform) * mat4{ camera.model });
+            mat4 const worldFromView = camera.worldTransform * model;
+            camera.model = mat4f{ worldFromView };
+            camera.view = mat4f{ inverse(worldFromView) };
+        }
+        prepareCamera(s, camera, eyeCount);
+    }
+};
+
 PerViewUniforms::PerViewUniforms(FEngine& engine) noexcept
         : mSamplers(PerViewSib::SAMPLER_COUNT) {
     DriverApi& driver = engine.getDriverApi();
@@ -62,6 +86,26 @@ void PerViewUniforms::terminate(DriverApi& driver) {
 }
 
 void PerViewUniforms::prepareCamera(FEngine& engine, const CameraInfo& camera) noexcept {
+    auto& s = mUniforms.edit();
+    prepareCamera(s, camera, engine.getConfig().stereoscopicEyeCount);
+
+    // with a clip-space of [-w, w] ==> z' = -z
+    // with a clip-space of [0,  w] ==> z' = (w - z)/2
+    s.clipControl = engine.getDriverApi().getClipSpaceParams();
+
+    mCameraLateLatch.reset();
+}
+
+void PerViewUniforms::prepareCameraLateLatch(FEngine& engine, const CameraInfo& camera,
+        std::shared_ptr<CameraLateLatchCallback> callback) noexcept {
+    mCameraLateLatch = std::make_shared<CameraLateLatch>(CameraLateLatch{
+            .callback = std::move(callback),
+            .camera = camera,
+            .eyeCount = engine.getConfig().stereoscopicEyeCount });
+}
+
+void PerViewUniforms::prepareCamera(PerViewUib& s, const CameraInfo& camera,
+        uint8_t eyeCount) noexcept {
     mat4f const& viewFromWorld = camera.view;
     mat4f const& worldFromView = camera.model;
     mat4f const& clipFromView  = camera.projection;
@@ -69,7 +113,6 @@ void PerViewUniforms::prepareCamera(FEngine& engine, const CameraInfo& camera) n
     const mat4f viewFromClip{ inverse((mat4)camera.projection) };
     const mat4f worldFromClip{ highPrecisionMultiply(worldFromView, viewFromClip) };
 
-    auto& s = mUniforms.edit();
     s.viewFromWorldMatrix = viewFromWorld;    // view
     s.worldFromViewMatrix = worldFromView;    // model
     s.clipFromViewMatrix  = clipFromView;     // projection
@@ -82,18 +125,13 @@ void PerViewUniforms::prepareCamera(FEngine& engine, const CameraInfo& camera) n
     s.nearOverFarMinusNear = camera.zn / (camera.zf - camera.zn);
 
     mat4f const& headFromWorld = camera.view;
-    Engine::Config const& config = engine.getConfig();
-    for (int i = 0; i < config.stereoscopicEyeCount; i++) {
+    for (int i = 0; i < eyeCount; i++) {
         mat4f const& eyeFromHead = camera.eyeFromView[i];   // identity for monoscopic rendering
         mat4f const& clipFromEye = camera.eyeProjection[i];
         // clipFromEye * eyeFromHead * headFromWorld
         s.clipFromWorldMatrix[i] = highPrecisionMultiply(
                 clipFromEye, highPrecisionMultiply(eyeFromHead, headFromWorld));
     }
-
-    // with a clip-space of [-w, w] ==> z' = -z
-    // with a clip-space of [0,  w] ==> z' = (w - z)/2
-    s.clipControl = engine.getDriverApi().getClipSpaceParams();
 }
 
 void PerViewUniforms::prepareLodBias(float bias, float2 derivativesScale) noexcept {
@@ -445,7 +483,16 @@ void PerViewUniforms::prepareShadowPCFDebug(Handle<HwTexture> texture,
 
 void PerViewUniforms::commit(backend::DriverApi& driver) noexcept {
     if (mUniforms.isDirty()) {
-        driver.updateBufferObject(mUniformBufferHandle, mUniforms.toBufferDescriptor(driver), 0);
+        BufferDescriptor bd = mUniforms.toBufferDescriptor(driver);
+        if (UTILS_UNLIKELY(mCameraLateLatch)) {
+            // This patches the copy of the uniforms held in the command stream, the command
+            // below reads it when it's executed.
+            driver.queueCommand([latch = mCameraLateLatch,
+                    s = static_cast<PerViewUib*>(bd.buffer)]() {
+                latch->apply(*s);
+            });
+        }
+        driver.updateBufferObject(mUniformBufferHandle, std::move(bd), 0);
     }
     if (mSamplers.isDirty()) {
         driver.updateSamplerGroup(mSamplerGroupHandle, mSamplers.toBufferDescriptor(driver));
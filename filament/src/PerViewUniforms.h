@@ -27,7 +27,11 @@
 #include <backend/Handle.h>
 
 #include <utils/EntityInstance.h>
+#include <utils/Invocable.h>
 
+#include <math/mathfwd.h>
+
+#include <memory>
 #include <random>
 
 namespace filament {
@@ -64,11 +68,21 @@ class PerViewUniforms {
     static constexpr uint32_t const SHADOW_SAMPLING_RUNTIME_PCSS  = 3u;
 
 public:
+    // same as View::CameraLateLatchCallback
+    using CameraLateLatchCallback = utils::Invocable<math::mat4(math::mat4 const&)>;
+
     explicit PerViewUniforms(FEngine& engine) noexcept;
 
     void terminate(backend::DriverApi& driver);
 
     void prepareCamera(FEngine& engine, const CameraInfo& camera) noexcept;
+
+    // Late-latches the camera set by the last prepareCamera(): the camera uniforms are
+    // recomputed on the backend thread, right before the first commit() is executed, with the
+    // model matrix returned by the callback. Subsequent commit() reuse the same model matrix,
+    // until the next prepareCamera().
+    void prepareCameraLateLatch(FEngine& engine, const CameraInfo& camera,
+            std::shared_ptr<CameraLateLatchCallback> callback) noexcept;
     void prepareLodBias(float bias, math::float2 derivativesScale) noexcept;
 
     /*
@@ -141,10 +155,14 @@ public:
     void unbindSamplers() noexcept;
 
 private:
+    struct CameraLateLatch;
     TypedUniformBuffer<PerViewUib> mUniforms;
     backend::SamplerGroup mSamplers;
     backend::Handle<backend::HwBufferObject> mUniformBufferHandle;
     backend::Handle<backend::HwSamplerGroup> mSamplerGroupHandle;
+    std::shared_ptr<CameraLateLatch> mCameraLateLatch;
+    static void prepareCamera(PerViewUib& s, const CameraInfo& camera,
+            uint8_t eyeCount) noexcept;
     static void prepareShadowSampling(PerViewUib& uniforms,
             ShadowMappingUniforms const& shadowMappingUniforms) noexcept;
 };
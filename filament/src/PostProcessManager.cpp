@@ -31,6 +31,7 @@
 #include "fg/FrameGraphResources.h"
 #include "fg/FrameGraphTexture.h"
 
+#include "EmbeddedPackage.h"
 #include "fsr.h"
 #include "FrameHistory.h"
 #include "PerViewUniforms.h"
@@ -77,6 +78,7 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <limits>
 #include <string_view>
@@ -93,6 +95,11 @@ using namespace math;
 using namespace backend;
 
 static constexpr uint8_t kMaxBloomLevels = 12u;
+
+// size of the log-luminance buffer the auto-exposure histogram is built from
+static constexpr uint32_t AUTO_EXPOSURE_LUMINANCE_SIZE = 64u;
+// must match binCount in autoExposureHistogram.mat
+static constexpr uint32_t AUTO_EXPOSURE_BIN_COUNT = 64u;
 static_assert(kMaxBloomLevels >= 3, "We require at least 3 bloom levels");
 
 constexpr static float halton(unsigned int i, unsigned int b) noexcept {
@@ -166,8 +173,9 @@ void PostProcessManager::PostProcessMaterial::loadMaterial(FEngine& engine) cons
     // TODO: After all materials using this class have been converted to the post-process material
     //       domain, load both OPAQUE and TRANSPARENT variants here.
     mHasMaterial = true;
+    EmbeddedPackage const package(mData, mSize);
     auto builder = Material::Builder();
-    builder.package(mData, mSize);
+    builder.package(package.data(), package.size());
     for (auto const& constant: mConstants) {
         std::visit([&](auto&& arg) {
             builder.constant(constant.name.data(), constant.name.size(), arg);
@@ -262,6 +270,10 @@ static const PostProcessManager::MaterialInfo sMaterialListFeatureLevel0[] = {
 };
 
 static const PostProcessManager::MaterialInfo sMaterialList[] = {
+        { "autoExposureAdaptation",     MATERIAL(AUTOEXPOSUREADAPTATION) },
+        { "autoExposureApply",          MATERIAL(AUTOEXPOSUREAPPLY) },
+        { "autoExposureHistogram",      MATERIAL(AUTOEXPOSUREHISTOGRAM) },
+        { "autoExposureLuminance",      MATERIAL(AUTOEXPOSURELUMINANCE) },
         { "bilateralBlur",              MATERIAL(BILATERALBLUR) },
         { "bilateralBlurBentNormals",   MATERIAL(BILATERALBLURBENTNORMALS) },
         { "blitArray",                  MATERIAL(BLITARRAY) },
@@ -281,10 +293,13 @@ static const PostProcessManager::MaterialInfo sMaterialList[] = {
         { "dofMedian",                  MATERIAL(DOFMEDIAN) },
         { "dofMipmap",                  MATERIAL(DOFMIPMAP) },
         { "dofTiles",                   MATERIAL(DOFTILES) },
+        { "dofTilesMask",               MATERIAL(DOFTILESMASK) },
         { "dofTilesSwizzle",            MATERIAL(DOFTILESSWIZZLE) },
         { "flare",                      MATERIAL(FLARE) },
         { "fxaa",                       MATERIAL(FXAA) },
+        { "hizDownsample",              MATERIAL(HIZDOWNSAMPLE) },
         { "mipmapDepth",                MATERIAL(MIPMAPDEPTH) },
+        { "oitComposite",               MATERIAL(OITCOMPOSITE) },
         { "sao",                        MATERIAL(SAO) },
         { "saoBentNormals",             MATERIAL(SAOBENTNORMALS) },
         { "separableGaussianBlur1",     MATERIAL(SEPARABLEGAUSSIANBLUR),
@@ -528,6 +543,128 @@ PostProcessManager::StructurePassOutput PostProcessManager::structure(FrameGraph
 
 // ------------------------------------------------------------------------------------------------
 
+FrameGraphId<FrameGraphTexture> PostProcessManager::occlusionDepthPyramid(FrameGraph& fg,
+        FrameGraphId<FrameGraphTexture> structure, uint32_t maxWidth) noexcept {
+
+    // The pyramid starts at half the resolution of the structure buffer and each texel holds the
+    // farthest depth of its footprint, which is what conservative occlusion tests need, and the
+    // nearest, which bounds the visible depth range for fitting shadow cascades. This is
+    // different from the structure buffer's own mipmaps, which are tuned for SSAO.
+    auto const& desc = fg.getDescriptor(structure);
+    uint32_t const width  = std::max(1u, desc.width  / 2u);
+    uint32_t const height = std::max(1u, desc.height / 2u);
+
+    // stop as soon as the level is narrower than maxWidth
+    size_t const maxLevelCount = FTexture::maxLevelCount(width, height);
+    size_t levelCount = 1;
+    while (levelCount < maxLevelCount && (width >> (levelCount - 1)) > maxWidth) {
+        levelCount++;
+    }
+
+    struct HiZReduceData {
+        FrameGraphId<FrameGraphTexture> in;
+        FrameGraphId<FrameGraphTexture> out;
+    };
+
+    auto& reducePass = fg.addPass<HiZReduceData>("Hi-Z Reduce",
+            [&](FrameGraph::Builder& builder, auto& data) {
+                data.in = builder.sample(structure);
+                data.out = builder.createTexture("Hi-Z Buffer", {
+                        .width = width, .height = height,
+                        .levels = uint8_t(levelCount),
+                        .format = TextureFormat::RG32F });
+                data.out = builder.write(data.out, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                builder.declareRenderPass("Hi-Z Reduce Target", {
+                        .attachments = { .color = { data.out }}
+                });
+            },
+            [=](FrameGraphResources const& resources, auto const& data, DriverApi& driver) {
+                auto in = resources.getTexture(data.in);
+                auto out = resources.getRenderPassInfo();
+                auto& material = getPostProcessMaterial("hizDownsample");
+                FMaterialInstance* const mi = material.getMaterialInstance(mEngine);
+                mi->setParameter("depth", in, { .filterMin = SamplerMinFilter::NEAREST_MIPMAP_NEAREST });
+                mi->setParameter("fromDepthBuffer", int32_t(1));
+                commitAndRender(out, material, driver);
+            });
+
+    auto hiz = reducePass->out;
+
+    struct HiZMipmapData {
+        FrameGraphId<FrameGraphTexture> hiz;
+    };
+
+    fg.addPass<HiZMipmapData>("Hi-Z Mipmap",
+            [&](FrameGraph::Builder& builder, auto& data) {
+                data.hiz = builder.sample(hiz);
+                for (size_t i = 1; i < levelCount; i++) {
+                    auto out = builder.createSubresource(data.hiz, "Hi-Z mip", {
+                            .level = uint8_t(i)
+                    });
+                    out = builder.write(out, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                    builder.declareRenderPass("Hi-Z mip target", {
+                            .attachments = { .color = { out }}
+                    });
+                }
+            },
+            [=](FrameGraphResources const& resources, auto const& data, DriverApi& driver) {
+                auto in = resources.getTexture(data.hiz);
+                auto& material = getPostProcessMaterial("hizDownsample");
+                FMaterialInstance* const mi = material.getMaterialInstance(mEngine);
+                mi->setParameter("depth", in, { .filterMin = SamplerMinFilter::NEAREST_MIPMAP_NEAREST });
+                mi->setParameter("fromDepthBuffer", int32_t(0));
+                // The first mip already exists, so we process n-1 lods
+                for (size_t level = 0; level < levelCount - 1; level++) {
+                    auto out = resources.getRenderPassInfo(level);
+                    driver.setMinMaxLevels(in, level, level);
+                    commitAndRender(out, material, driver);
+                }
+                driver.setMinMaxLevels(in, 0, levelCount - 1);
+            });
+
+    return hiz;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FrameGraphId<FrameGraphTexture> PostProcessManager::orderIndependentTransparencyComposite(
+        FrameGraph& fg, FrameGraphId<FrameGraphTexture> color,
+        FrameGraphId<FrameGraphTexture> accumulation,
+        FrameGraphId<FrameGraphTexture> revealage) noexcept {
+
+    struct OitCompositeData {
+        FrameGraphId<FrameGraphTexture> color;
+        FrameGraphId<FrameGraphTexture> accumulation;
+        FrameGraphId<FrameGraphTexture> revealage;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    auto& compositePass = fg.addPass<OitCompositeData>("OIT Composite",
+            [&](FrameGraph::Builder& builder, auto& data) {
+                auto const& desc = builder.getDescriptor(color);
+                data.color = builder.sample(color);
+                data.accumulation = builder.sample(accumulation);
+                data.revealage = builder.sample(revealage);
+                data.output = builder.createTexture("OIT Composite Output", {
+                        .width = desc.width, .height = desc.height,
+                        .format = desc.format });
+                data.output = builder.declareRenderPass(data.output);
+            },
+            [=](FrameGraphResources const& resources, auto const& data, DriverApi& driver) {
+                auto out = resources.getRenderPassInfo();
+                auto& material = getPostProcessMaterial("oitComposite");
+                FMaterialInstance* const mi = material.getMaterialInstance(mEngine);
+                mi->setParameter("color", resources.getTexture(data.color), {});
+                mi->setParameter("accumulation", resources.getTexture(data.accumulation), {});
+                mi->setParameter("revealage", resources.getTexture(data.revealage), {});
+                commitAndRender(out, material, driver);
+            });
+
+    return compositePass->output;
+}
+
+// ------------------------------------------------------------------------------------------------
+
 FrameGraphId<FrameGraphTexture> PostProcessManager::ssr(FrameGraph& fg,
         RenderPassBuilder const& passBuilder,
         FrameHistory const& frameHistory,
@@ -1395,6 +1532,166 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::generateMipmapSSR(
             true, config.kernelSize, config.sigma0);
 }
 
+FrameGraphId<FrameGraphTexture> PostProcessManager::autoExposure(FrameGraph& fg,
+        FrameGraphId<FrameGraphTexture> input, filament::Viewport const& vp,
+        FrameHistory& frameHistory, AutoExposureOptions const& options) noexcept {
+
+    // The whole chain stays on the GPU: the color buffer is reduced to a small log-luminance
+    // buffer, that buffer to a histogram, and the histogram to a 1x1 adapted luminance which is
+    // kept in the frame history and read back by the pass that applies the exposure.
+    auto const& inputDesc = fg.getDescriptor(input);
+
+    auto const& previous = frameHistory.getPrevious().autoExposure;
+    auto& current = frameHistory.getCurrent().autoExposure;
+    current.time = std::chrono::duration<double>(mEngine.getEngineTime()).count();
+
+    FrameGraphId<FrameGraphTexture> history;
+    float deltaTime = 0.0f;
+    if (previous.color.handle) {
+        history = fg.import("Auto Exposure history", previous.desc,
+                FrameGraphTexture::Usage::SAMPLEABLE, previous.color);
+        // large gaps (e.g. the view wasn't rendered for a while) are treated like a cut
+        deltaTime = std::clamp(float(current.time - previous.time), 0.0f, 1.0f);
+    }
+
+    struct LuminanceData {
+        FrameGraphId<FrameGraphTexture> input;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    auto& luminancePass = fg.addPass<LuminanceData>("Auto Exposure Luminance",
+            [&](FrameGraph::Builder& builder, auto& data) {
+                data.input = builder.sample(input);
+                data.output = builder.createTexture("Auto Exposure Luminance", {
+                        .width = AUTO_EXPOSURE_LUMINANCE_SIZE,
+                        .height = AUTO_EXPOSURE_LUMINANCE_SIZE,
+                        .format = TextureFormat::R16F });
+                data.output = builder.declareRenderPass(data.output);
+            },
+            [=](FrameGraphResources const& resources, auto const& data, DriverApi& driver) {
+                auto color = resources.getTexture(data.input);
+                auto out = resources.getRenderPassInfo();
+                float const w = float(inputDesc.width);
+                float const h = float(inputDesc.height);
+                float const size = float(AUTO_EXPOSURE_LUMINANCE_SIZE);
+                auto& material = getPostProcessMaterial("autoExposureLuminance");
+                FMaterialInstance* const mi = material.getMaterialInstance(mEngine);
+                mi->setParameter("color", color, {
+                        .filterMag = SamplerMagFilter::LINEAR,
+                        .filterMin = SamplerMinFilter::LINEAR });
+                mi->setParameter("viewport", float4{
+                        float(vp.left) / w, float(vp.bottom) / h,
+                        float(vp.width) / w, float(vp.height) / h });
+                mi->setParameter("resolution", float4{ size, size, 1.0f / size, 1.0f / size });
+                mi->setParameter("logLuminanceRange", float2{ options.minLogLuminance,
+                        1.0f / (options.maxLogLuminance - options.minLogLuminance) });
+                commitAndRender(out, material, driver);
+            });
+
+    struct HistogramData {
+        FrameGraphId<FrameGraphTexture> luminance;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    auto& histogramPass = fg.addPass<HistogramData>("Auto Exposure Histogram",
+            [&](FrameGraph::Builder& builder, auto& data) {
+                data.luminance = builder.sample(luminancePass->output);
+                data.output = builder.createTexture("Auto Exposure Histogram", {
+                        .width = AUTO_EXPOSURE_BIN_COUNT, .height = 1,
+                        .format = TextureFormat::R16F });
+                data.output = builder.declareRenderPass(data.output);
+            },
+            [=](FrameGraphResources const& resources, auto const& data, DriverApi& driver) {
+                auto luminance = resources.getTexture(data.luminance);
+                auto out = resources.getRenderPassInfo();
+                auto& material = getPostProcessMaterial("autoExposureHistogram");
+                FMaterialInstance* const mi = material.getMaterialInstance(mEngine);
+                mi->setParameter("luminance", luminance, {});
+                commitAndRender(out, material, driver);
+            });
+
+    struct AdaptationData {
+        FrameGraphId<FrameGraphTexture> histogram;
+        FrameGraphId<FrameGraphTexture> history;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    auto& adaptationPass = fg.addPass<AdaptationData>("Auto Exposure Adaptation",
+            [&](FrameGraph::Builder& builder, auto& data) {
+                data.histogram = builder.sample(histogramPass->output);
+                if (history) {
+                    data.history = builder.sample(history);
+                }
+                // R32F because the result is accumulated over many frames
+                data.output = builder.createTexture("Auto Exposure Adapted Luminance", {
+                        .width = 1, .height = 1,
+                        .format = TextureFormat::R32F });
+                data.output = builder.declareRenderPass(data.output);
+            },
+            [=](FrameGraphResources const& resources, auto const& data, DriverApi& driver) {
+                auto histogram = resources.getTexture(data.histogram);
+                auto out = resources.getRenderPassInfo();
+                auto& material = getPostProcessMaterial("autoExposureAdaptation");
+                FMaterialInstance* const mi = material.getMaterialInstance(mEngine);
+                mi->setParameter("histogram", histogram, {});
+                mi->setParameter("history",
+                        data.history ? resources.getTexture(data.history) : getZeroTexture(), {});
+                mi->setParameter("range", float4{
+                        options.minLogLuminance,
+                        options.maxLogLuminance - options.minLogLuminance,
+                        options.lowPercentile, options.highPercentile });
+                mi->setParameter("adaptation", float4{
+                        options.speedUp, options.speedDown, deltaTime,
+                        data.history ? 1.0f : 0.0f });
+                commitAndRender(out, material, driver);
+            });
+
+    auto const adapted = adaptationPass->output;
+
+    struct ExportAutoExposureHistoryData {
+        FrameGraphId<FrameGraphTexture> adapted;
+    };
+    fg.addPass<ExportAutoExposureHistoryData>("Export Auto Exposure history",
+            [&](FrameGraph::Builder& builder, auto& data) {
+                // We need to use sideEffect here to ensure this pass won't be culled.
+                // The "output" of this pass is going to be used during the next frame as
+                // an "import".
+                builder.sideEffect();
+                data.adapted = builder.sample(adapted);
+            }, [&current](FrameGraphResources const& resources, auto const& data, auto&) {
+                resources.detach(data.adapted, &current.color, &current.desc);
+            });
+
+    struct ApplyData {
+        FrameGraphId<FrameGraphTexture> input;
+        FrameGraphId<FrameGraphTexture> adapted;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    auto& applyPass = fg.addPass<ApplyData>("Auto Exposure",
+            [&](FrameGraph::Builder& builder, auto& data) {
+                data.input = builder.sample(input);
+                data.adapted = builder.sample(adapted);
+                data.output = builder.createTexture("Auto Exposure Output", {
+                        .width = inputDesc.width, .height = inputDesc.height,
+                        .format = inputDesc.format });
+                data.output = builder.declareRenderPass(data.output);
+            },
+            [=](FrameGraphResources const& resources, auto const& data, DriverApi& driver) {
+                auto color = resources.getTexture(data.input);
+                auto luminance = resources.getTexture(data.adapted);
+                auto out = resources.getRenderPassInfo();
+                auto& material = getPostProcessMaterial("autoExposureApply");
+                FMaterialInstance* const mi = material.getMaterialInstance(mEngine);
+                mi->setParameter("color", color, {});
+                mi->setParameter("luminance", luminance, {});
+                mi->setParameter("compensation", options.compensation);
+                commitAndRender(out, material, driver);
+            });
+
+    return applyPass->output;
+}
+
 FrameGraphId<FrameGraphTexture> PostProcessManager::dof(FrameGraph& fg,
         FrameGraphId<FrameGraphTexture> input,
         FrameGraphId<FrameGraphTexture> depth,
@@ -1734,6 +2031,62 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::dof(FrameGraph& fg,
     auto dilated = dilate(inTilesCocMinMax);
     dilated = dilate(dilated);
 
+    /*
+     * Tiles mask
+     *      - Marks the in-focus tiles in the stencil buffer, so that the gather and median passes
+     *        don't run at all for them. In typical shots, most of the frame is in focus.
+     */
+
+    struct PostProcessDofTilesMask {
+        FrameGraphId<FrameGraphTexture> tilesCocMinMax;
+        FrameGraphId<FrameGraphTexture> mask;
+    };
+
+    auto& ppDoFTilesMask = fg.addPass<PostProcessDofTilesMask>("DoF Tiles Mask",
+            [&](FrameGraph::Builder& builder, auto& data) {
+                bool const isES2 = mEngine.getDriverApi().getFeatureLevel() ==
+                        FeatureLevel::FEATURE_LEVEL_0;
+                data.tilesCocMinMax = builder.sample(dilated);
+                data.mask = builder.createTexture("dof tiles mask", {
+                        .width = width, .height = height,
+                        .format = isES2 ?
+                                TextureFormat::DEPTH24_STENCIL8 : TextureFormat::DEPTH32F_STENCIL8
+                });
+                data.mask = builder.write(data.mask, FrameGraphTexture::Usage::DEPTH_ATTACHMENT);
+                builder.declareRenderPass("DoF Tiles Mask Target", {
+                        .attachments = { .depth = data.mask, .stencil = data.mask },
+                        .clearFlags = TargetBufferFlags::DEPTH_AND_STENCIL
+                });
+            },
+            [=](FrameGraphResources const& resources, auto const& data, DriverApi& driver) {
+                auto const& out = resources.getRenderPassInfo();
+                auto tilesCocMinMax = resources.getTexture(data.tilesCocMinMax);
+                auto const& material = getPostProcessMaterial("dofTilesMask");
+                FMaterialInstance* const mi = material.getMaterialInstance(mEngine);
+                mi->setParameter("tiles", tilesCocMinMax,
+                        { .filterMin = SamplerMinFilter::NEAREST });
+                mi->setParameter("tileSize", int32_t(tileSize / dofResolution));
+                mi->commit(driver);
+                mi->use(driver);
+
+                auto pipeline = material.getPipelineState(mEngine);
+                pipeline.first.stencilState.stencilWrite = true;
+                pipeline.first.stencilState.front.stencilOpDepthStencilPass =
+                        StencilOperation::REPLACE;
+                pipeline.first.stencilState.front.ref = 1;
+                pipeline.first.stencilState.back = pipeline.first.stencilState.front;
+                render(out, pipeline, driver);
+            });
+
+    // The gather and median passes use the stencil test to skip the in-focus tiles, so their
+    // outputs are cleared, like the shaders would have done for these tiles.
+    auto skipInFocusTiles = [](PipelineState pipeline) -> PipelineState {
+        pipeline.stencilState.front.stencilFunc = StencilState::StencilFunction::NE;
+        pipeline.stencilState.front.ref = 1;
+        pipeline.stencilState.back = pipeline.stencilState.front;
+        return pipeline;
+    };
+
     /*
      * DoF blur pass
      */
@@ -1742,6 +2095,7 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::dof(FrameGraph& fg,
         FrameGraphId<FrameGraphTexture> color;
         FrameGraphId<FrameGraphTexture> coc;
         FrameGraphId<FrameGraphTexture> tilesCocMinMax;
+        FrameGraphId<FrameGraphTexture> mask;
         FrameGraphId<FrameGraphTexture> outColor;
         FrameGraphId<FrameGraphTexture> outAlpha;
     };
@@ -1765,8 +2119,12 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::dof(FrameGraph& fg,
                 });
                 data.outColor  = builder.write(data.outColor, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
                 data.outAlpha  = builder.write(data.outAlpha, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                data.mask = builder.read(ppDoFTilesMask->mask,
+                        FrameGraphTexture::Usage::DEPTH_ATTACHMENT);
                 builder.declareRenderPass("DoF Target", {
-                        .attachments = { .color = { data.outColor, data.outAlpha }}
+                        .attachments = { .color = { data.outColor, data.outAlpha },
+                                .depth = data.mask, .stencil = data.mask },
+                        .clearFlags = TargetBufferFlags::COLOR0 | TargetBufferFlags::COLOR1
                 });
             },
             [=](FrameGraphResources const& resources, auto const& data, DriverApi& driver) {
@@ -1801,7 +2159,12 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::dof(FrameGraph& fg,
                     0.0 // unused for now
                 });
                 mi->setParameter("bokehAngle",  bokehAngle);
-                commitAndRender(out, material, driver);
+                mi->commit(driver);
+                mi->use(driver);
+
+                auto pipeline = material.getPipelineState(mEngine);
+                pipeline.first = skipInFocusTiles(pipeline.first);
+                render(out, pipeline, driver);
             });
 
     /*
@@ -1812,6 +2175,7 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::dof(FrameGraph& fg,
         FrameGraphId<FrameGraphTexture> inColor;
         FrameGraphId<FrameGraphTexture> inAlpha;
         FrameGraphId<FrameGraphTexture> tilesCocMinMax;
+        FrameGraphId<FrameGraphTexture> mask;
         FrameGraphId<FrameGraphTexture> outColor;
         FrameGraphId<FrameGraphTexture> outAlpha;
     };
@@ -1827,8 +2191,12 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::dof(FrameGraph& fg,
                 data.outAlpha = builder.createTexture("dof alpha output", fg.getDescriptor(data.inAlpha));
                 data.outColor = builder.write(data.outColor, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
                 data.outAlpha = builder.write(data.outAlpha, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                data.mask = builder.read(ppDoFTilesMask->mask,
+                        FrameGraphTexture::Usage::DEPTH_ATTACHMENT);
                 builder.declareRenderPass("DoF Target", {
-                        .attachments = { .color = { data.outColor, data.outAlpha }}
+                        .attachments = { .color = { data.outColor, data.outAlpha },
+                                .depth = data.mask, .stencil = data.mask },
+                        .clearFlags = TargetBufferFlags::COLOR0 | TargetBufferFlags::COLOR1
                 });
             },
             [=](FrameGraphResources const& resources, auto const& data, DriverApi& driver) {
@@ -1843,7 +2211,12 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::dof(FrameGraph& fg,
                 mi->setParameter("dof",   inColor,        { .filterMin = SamplerMinFilter::NEAREST_MIPMAP_NEAREST });
                 mi->setParameter("alpha", inAlpha,        { .filterMin = SamplerMinFilter::NEAREST_MIPMAP_NEAREST });
                 mi->setParameter("tiles", tilesCocMinMax, { .filterMin = SamplerMinFilter::NEAREST });
-                commitAndRender(out, material, driver);
+                mi->commit(driver);
+                mi->use(driver);
+
+                auto pipeline = material.getPipelineState(mEngine);
+                pipeline.first = skipInFocusTiles(pipeline.first);
+                render(out, pipeline, driver);
             });
 
 
@@ -1982,9 +2355,15 @@ PostProcessManager::BloomPassOutput PostProcessManager::bloom(FrameGraph& fg,
     while (2 * bloomWidth < float(desc.width) || 2 * bloomHeight < float(desc.height)) {
         if (inoutBloomOptions.quality == QualityLevel::LOW ||
             inoutBloomOptions.quality == QualityLevel::MEDIUM) {
+            // In quarter resolution mode, we skip every other intermediate buffer when there is
+            // room for it, which roughly halves the bandwidth of this chain. The 2x filter
+            // undersamples the source in that case, which causes some aliasing.
+            const uint32_t factor = (inoutBloomOptions.quarterResolution &&
+                    4 * bloomWidth <= float(desc.width) &&
+                    4 * bloomHeight <= float(desc.height)) ? 4u : 2u;
             input = downscalePass(fg, input, {
-                            .width  = (desc.width  = std::max(1u, desc.width  / 2)),
-                            .height = (desc.height = std::max(1u, desc.height / 2)),
+                            .width  = (desc.width  = std::max(1u, desc.width  / factor)),
+                            .height = (desc.height = std::max(1u, desc.height / factor)),
                             .format = outFormat
                     },
                     threshold, inoutBloomOptions.highlight, fireflies);
@@ -3248,62 +3627,74 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::resolveDepth(FrameGraph& fg,
 }
 
 FrameGraphId<FrameGraphTexture> PostProcessManager::vsmMipmapPass(FrameGraph& fg,
-        FrameGraphId<FrameGraphTexture> input, uint8_t layer, size_t level,
-        math::float4 clearColor, bool finalize) noexcept {
+        FrameGraphId<FrameGraphTexture> input,
+        utils::FixedCapacityVector<uint8_t> const& layers, size_t levelCount,
+        math::float4 clearColor) noexcept {
 
     struct VsmMipData {
         FrameGraphId<FrameGraphTexture> in;
     };
 
+    // All the layers are processed by the same pass, so that the material and its pipeline are
+    // only set up once, and the FrameGraph has a single pass to schedule instead of one per
+    // layer and level.
     auto& depthMipmapPass = fg.addPass<VsmMipData>("VSM Generate Mipmap Pass",
             [&](FrameGraph::Builder& builder, auto& data) {
                 const char* name = builder.getName(input);
                 data.in = builder.sample(input);
 
-                auto out = builder.createSubresource(data.in, "Mip level", {
-                        .level = uint8_t(level + 1), .layer = layer });
-
-                out = builder.write(out, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
-                builder.declareRenderPass(name, {
-                    .attachments = { .color = { out }},
-                    .clearColor = clearColor,
-                    .clearFlags = TargetBufferFlags::COLOR
-                });
+                // render targets are declared in the order they're used below
+                for (uint8_t const layer : layers) {
+                    for (size_t level = 0; level < levelCount - 1; level++) {
+                        auto out = builder.createSubresource(data.in, "Mip level", {
+                                .level = uint8_t(level + 1), .layer = layer });
+
+                        out = builder.write(out, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                        builder.declareRenderPass(name, {
+                            .attachments = { .color = { out }},
+                            .clearColor = clearColor,
+                            .clearFlags = TargetBufferFlags::COLOR
+                        });
+                    }
+                }
             },
             [=](FrameGraphResources const& resources,
                     auto const& data, DriverApi& driver) {
 
                 auto in = resources.getTexture(data.in);
-                auto out = resources.getRenderPassInfo();
 
                 auto const& inDesc = resources.getDescriptor(data.in);
                 auto width = inDesc.width;
                 assert_invariant(width == inDesc.height);
-                int const dim = width >> (level + 1);
-
-                driver.setMinMaxLevels(in, level, level);
 
                 auto& material = getPostProcessMaterial("vsmMipmap");
 
                 // When generating shadow map mip levels, we want to preserve the 1 texel border.
                 // (note clearing never respects the scissor in Filament)
                 auto const [pipeline, _] = material.getPipelineState(mEngine);
-                backend::Viewport const scissor = { 1u, 1u, dim - 2u, dim - 2u };
 
                 FMaterialInstance* const mi = material.getMaterialInstance(mEngine);
                 mi->setParameter("color", in, {
                         .filterMag = SamplerMagFilter::LINEAR,
                         .filterMin = SamplerMinFilter::LINEAR_MIPMAP_NEAREST
                 });
-                mi->setParameter("layer", uint32_t(layer));
-                mi->setParameter("uvscale", 1.0f / float(dim));
-                mi->commit(driver);
-                mi->use(driver);
-                render(out, pipeline, scissor, driver);
 
-                if (finalize) {
-                   driver.setMinMaxLevels(in, 0, level);
+                for (size_t level = 0; level < levelCount - 1; level++) {
+                    int const dim = width >> (level + 1);
+                    backend::Viewport const scissor = { 1u, 1u, dim - 2u, dim - 2u };
+
+                    // the source level is the same for all layers
+                    driver.setMinMaxLevels(in, level, level);
+                    for (size_t i = 0, c = layers.size(); i < c; i++) {
+                        auto out = resources.getRenderPassInfo(i * (levelCount - 1) + level);
+                        mi->setParameter("layer", uint32_t(layers[i]));
+                        mi->setParameter("uvscale", 1.0f / float(dim));
+                        mi->commit(driver);
+                        mi->use(driver);
+                        render(out, pipeline, scissor, driver);
+                    }
                 }
+                driver.setMinMaxLevels(in, 0, levelCount - 1);
             });
 
     return depthMipmapPass->in;
@@ -103,6 +103,19 @@ public:
             RenderPassBuilder const& passBuilder, uint8_t structureRenderFlags,
             uint32_t width, uint32_t height, StructurePassConfig const& config) noexcept;
 
+    // Hi-Z pyramid of the structure buffer, used for occlusion culling and shadow fitting, each
+    // texel holds the (farthest, nearest) depth of its footprint. The last level is at most
+    // maxWidth wide.
+    FrameGraphId<FrameGraphTexture> occlusionDepthPyramid(FrameGraph& fg,
+            FrameGraphId<FrameGraphTexture> structure, uint32_t maxWidth) noexcept;
+
+    // Composites the accumulation and revealage buffers of order-independent transparency over
+    // the color buffer
+    FrameGraphId<FrameGraphTexture> orderIndependentTransparencyComposite(FrameGraph& fg,
+            FrameGraphId<FrameGraphTexture> color,
+            FrameGraphId<FrameGraphTexture> accumulation,
+            FrameGraphId<FrameGraphTexture> revealage) noexcept;
+
     // reflections pass
     FrameGraphId<FrameGraphTexture> ssr(FrameGraph& fg,
             RenderPassBuilder const& passBuilder,
@@ -158,6 +171,11 @@ public:
             FrameGraphId<FrameGraphTexture> output,
             bool needInputDuplication, ScreenSpaceRefConfig const& config) noexcept;
 
+    // Automatic exposure, computed and applied entirely on the GPU
+    FrameGraphId<FrameGraphTexture> autoExposure(FrameGraph& fg,
+            FrameGraphId<FrameGraphTexture> input, filament::Viewport const& vp,
+            FrameHistory& frameHistory, AutoExposureOptions const& options) noexcept;
+
     // Depth-of-field
     FrameGraphId<FrameGraphTexture> dof(FrameGraph& fg,
             FrameGraphId<FrameGraphTexture> input,
@@ -273,10 +291,11 @@ public:
             const char* outputBufferName, FrameGraphId<FrameGraphTexture> input,
             FrameGraphTexture::Descriptor outDesc) noexcept;
 
-    // VSM shadow mipmap pass
+    // VSM shadow mipmap pass, generates all the levels of all the given layers in a single pass
     FrameGraphId<FrameGraphTexture> vsmMipmapPass(FrameGraph& fg,
-            FrameGraphId<FrameGraphTexture> input, uint8_t layer, size_t level,
-            math::float4 clearColor, bool finalize) noexcept;
+            FrameGraphId<FrameGraphTexture> input,
+            utils::FixedCapacityVector<uint8_t> const& layers, size_t levelCount,
+            math::float4 clearColor) noexcept;
 
     FrameGraphId<FrameGraphTexture> gaussianBlurPass(FrameGraph& fg,
             FrameGraphId<FrameGraphTexture> input,
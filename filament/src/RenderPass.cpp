@@ -16,6 +16,7 @@
 
 #include "RenderPass.h"
 
+#include "ParallelCommandStreams.h"
 #include "RenderPrimitive.h"
 #include "ShadowMap.h"
 #include "SharedHandle.h"
@@ -135,7 +136,7 @@ RenderPass::RenderPass(FEngine& engine, RenderPassBuilder const& builder) noexce
             builder.mUboHandle,
             builder.mVisibleRenderables,
             builder.mCommandTypeFlags,
-            builder.mFlags,
+            builder.mFlags | (engine.isAutomaticInstancingEnabled() ? HAS_AUTOMATIC_INSTANCING : 0),
             builder.mVisibilityMask,
             builder.mVariant,
             builder.mCameraPosition,
@@ -149,8 +150,10 @@ RenderPass::RenderPass(FEngine& engine, RenderPassBuilder const& builder) noexce
     }
 
     // sort commands once we're done adding commands
-    commandEnd = resize(builder.mArena,
-            RenderPass::sortCommands(commandBegin, commandEnd));
+    JobSystem& js = engine.getJobSystem();
+    commandEnd = resize(builder.mArena, builder.mSortCache ?
+            RenderPass::sortCommands(js, *builder.mSortCache, commandBegin, commandEnd) :
+            RenderPass::sortCommands(js, builder.mArena, commandBegin, commandEnd));
 
     if (engine.isAutomaticInstancingEnabled()) {
         int32_t stereoscopicEyeCount = 1;
@@ -262,11 +265,30 @@ void RenderPass::appendCustomCommand(Command* commands,
     commands->key = cmd;
 }
 
-RenderPass::Command* RenderPass::sortCommands(
+RenderPass::Command* RenderPass::sortCommands(JobSystem& js, Arena& arena,
         Command* const begin, Command* const end) noexcept {
     SYSTRACE_NAME("sort commands");
 
-    std::sort(begin, end);
+    // We only sort keys, the commands are permuted once at the end. This alone is
+    // significantly cheaper than sorting the 64 bytes commands directly.
+    // The scratch memory is placed after the commands, it's released by resize().
+
+    using Entry = CommandSortCache::Entry;
+    uint32_t const count = uint32_t(end - begin);
+    Entry* const entries = arena.alloc<Entry>(count);
+    Entry* const scratch = arena.alloc<Entry>(count);
+    uint32_t* const order = arena.alloc<uint32_t>(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        entries[i] = { begin[i].key, i };
+    }
+
+    Entry const* const sorted = sortEntries(js, entries, scratch, count);
+    for (uint32_t i = 0; i < count; i++) {
+        order[i] = sorted[i].index;
+    }
+
+    permuteCommands(begin, order, count);
 
     // find the last command
     Command* const last = std::partition_point(begin, end,
@@ -277,6 +299,181 @@ RenderPass::Command* RenderPass::sortCommands(
     return last;
 }
 
+RenderPass::Command* RenderPass::sortCommands(JobSystem& js, CommandSortCache& cache,
+        Command* const begin, Command* const end) noexcept {
+    SYSTRACE_NAME("sort commands (cached)");
+
+    // We only sort keys, the commands are permuted once at the end. This alone is
+    // significantly cheaper than sorting the 64 bytes commands directly.
+
+    uint32_t const count = uint32_t(end - begin);
+    auto& entries = cache.mEntries;
+    auto& merged = cache.mMerged;
+    auto& order = cache.mOrder;
+    entries.resize(count);
+
+    if (order.size() == count) {
+        // replay last frame's order, most commands should already be in place
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t const index = order[i];
+            entries[i] = { begin[index].key, index };
+        }
+
+        // Split the commands in an already sorted sequence and the "dirty" commands that are
+        // now out of place. A command is dirty if it's smaller than the last one we kept, or
+        // larger than its successor (that's the case of a single command which key increased,
+        // we don't want it to make all the following commands dirty).
+        auto& dirty = cache.mDirty;
+        dirty.clear();
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            CommandSortCache::Entry const e = entries[i];
+            bool const isDirty = (kept && e.key < entries[kept - 1].key) ||
+                    (i + 1 < count && e.key > entries[i + 1].key);
+            if (UTILS_UNLIKELY(isDirty)) {
+                dirty.push_back(e);
+            } else {
+                entries[kept++] = e;
+            }
+        }
+
+        if (UTILS_LIKELY(dirty.empty())) {
+            std::swap(merged, entries);
+        } else {
+            std::sort(dirty.begin(), dirty.end());
+            merged.resize(count);
+            std::merge(entries.begin(), entries.begin() + kept, dirty.begin(), dirty.end(),
+                    merged.begin());
+        }
+    } else {
+        // the pass changed too much, start from scratch
+        for (uint32_t i = 0; i < count; i++) {
+            entries[i] = { begin[i].key, i };
+        }
+        merged.resize(count);
+        if (sortEntries(js, entries.data(), merged.data(), count) == entries.data()) {
+            std::swap(merged, entries);
+        }
+    }
+
+    // remember this order for next time
+    order.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        order[i] = merged[i].index;
+    }
+
+    auto& permutation = cache.mPermutation;
+    permutation = order;
+    permuteCommands(begin, permutation.data(), count);
+
+    // find the last command
+    Command* const last = std::partition_point(begin, end,
+            [](Command const& c) {
+                return c.key != uint64_t(Pass::SENTINEL);
+            });
+
+    return last;
+}
+
+RenderPass::CommandSortCache::Entry* RenderPass::sortEntries(JobSystem& js,
+        CommandSortCache::Entry* entries, CommandSortCache::Entry* scratch,
+        uint32_t const count) noexcept {
+    using Entry = CommandSortCache::Entry;
+
+    if (count < RADIX_SORT_MIN_COUNT) {
+        std::sort(entries, entries + count);
+        return entries;
+    }
+
+    // LSD radix sort, one byte at a time. Bytes that are identical in all keys are skipped,
+    // that's typically the case of several key fields (e.g. the pass or the channel).
+    uint64_t varying = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        varying |= entries[i].key ^ entries[0].key;
+    }
+
+    // Each job counts then scatters its own contiguous range of entries, the prefix sum
+    // computed in between gives each (digit, job) pair its destination, which keeps the sort
+    // stable.
+    uint32_t const jobCount = std::min(RADIX_SORT_MAX_JOB_COUNT,
+            std::max(1u, count / RADIX_SORT_MIN_COUNT_PER_JOB));
+    uint32_t const countPerJob = (count + jobCount - 1) / jobCount;
+    uint32_t histograms[RADIX_SORT_MAX_JOB_COUNT][256];
+
+    auto forEachJob = [&js, jobCount](auto const& work) {
+        if (jobCount == 1) {
+            work(0u);
+            return;
+        }
+        auto* parent = js.createJob();
+        for (uint32_t j = 0; j < jobCount; j++) {
+            js.run(jobs::createJob(js, parent, [&work, j]() { work(j); }));
+        }
+        js.runAndWait(parent);
+    };
+
+    Entry* src = entries;
+    Entry* dst = scratch;
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        if (((varying >> shift) & 0xFF) == 0) {
+            continue;
+        }
+
+        forEachJob([&](uint32_t const j) {
+            uint32_t* const histogram = histograms[j];
+            std::fill_n(histogram, 256, 0);
+            uint32_t const first = std::min(j * countPerJob, count);
+            uint32_t const last = std::min(first + countPerJob, count);
+            for (uint32_t i = first; i < last; i++) {
+                histogram[(src[i].key >> shift) & 0xFF]++;
+            }
+        });
+
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit < 256; digit++) {
+            for (uint32_t j = 0; j < jobCount; j++) {
+                uint32_t const c = histograms[j][digit];
+                histograms[j][digit] = offset;
+                offset += c;
+            }
+        }
+
+        forEachJob([&](uint32_t const j) {
+            uint32_t* const offsets = histograms[j];
+            uint32_t const first = std::min(j * countPerJob, count);
+            uint32_t const last = std::min(first + countPerJob, count);
+            for (uint32_t i = first; i < last; i++) {
+                dst[offsets[(src[i].key >> shift) & 0xFF]++] = src[i];
+            }
+        });
+
+        std::swap(src, dst);
+    }
+    return src;
+}
+
+void RenderPass::permuteCommands(Command* const commands, uint32_t* const order,
+        uint32_t const count) noexcept {
+    // permute the commands in place by following the cycles of the permutation
+    for (uint32_t i = 0; i < count; i++) {
+        if (order[i] == i) {
+            continue;
+        }
+        Command const tmp = commands[i];
+        uint32_t j = i;
+        while (true) {
+            uint32_t const next = order[j];
+            order[j] = j;
+            if (next == i) {
+                commands[j] = tmp;
+                break;
+            }
+            commands[j] = commands[next];
+            j = next;
+        }
+    }
+}
+
 void RenderPass::execute(RenderPass const& pass,
         FEngine& engine, const char* name,
         backend::Handle<backend::HwRenderTarget> renderTarget,
@@ -295,12 +492,10 @@ RenderPass::Command* RenderPass::instanceify(FEngine& engine,
     // instanceify works by scanning the **sorted** command stream, looking for repeat draw
     // commands. When one is found, it is replaced by an instanced command.
     // A "repeat" draw is one that ends-up using the same draw parameters and state.
-    // Currently, this relies somewhat on luck that "repeat draws" are found consecutively,
-    // we could improve this by including some or all of these "repeat" parameters in the
-    // sorting key (e.g. raster state, primitive handle, etc...), the key could even use a small
-    // hash of those parameters.
+    // "Repeat draws" are found consecutively because, with automatic instancing, the sorting
+    // key includes a hash of these parameters (see makeInstancingKey()).
 
-    UTILS_UNUSED uint32_t drawCallsSavedCount = 0;
+    uint32_t drawCallsSavedCount = 0;
 
     Command* firstSentinel = nullptr;
     PerRenderableData const* uboData = nullptr;
@@ -386,8 +581,7 @@ RenderPass::Command* RenderPass::instanceify(FEngine& engine,
     }
 
     if (UTILS_UNLIKELY(firstSentinel)) {
-        //slog.d << "auto-instancing, saving " << drawCallsSavedCount << " draw calls, out of "
-        //       << count << io::endl;
+        engine.addInstancingDrawCallsSaved(drawCallsSavedCount);
 
         // we have instanced primitives
         DriverApi& driver = engine.getDriverApi();
@@ -551,6 +745,17 @@ RenderPass::Command* RenderPass::generateCommandsImpl(RenderPass::CommandTypeFla
     bool const filterTranslucentObjects =
             bool(extraFlags & CommandTypeFlags::FILTER_TRANSLUCENT_OBJECTS);
 
+    bool const filterBlendedObjects =
+            bool(extraFlags & CommandTypeFlags::FILTER_BLENDED_OBJECTS);
+
+    bool const isOitRevealagePass =
+            bool(extraFlags & CommandTypeFlags::OIT_REVEALAGE);
+
+    bool const isOitPass = isOitRevealagePass ||
+            bool(extraFlags & CommandTypeFlags::OIT_ACCUMULATION);
+
+    bool const hasOrderIndependentTransparency = filterBlendedObjects || isOitPass;
+
     bool const hasShadowing =
             renderFlags & HAS_SHADOWING;
 
@@ -563,6 +768,9 @@ RenderPass::Command* RenderPass::generateCommandsImpl(RenderPass::CommandTypeFla
     bool const hasDepthClamp =
             renderFlags & HAS_DEPTH_CLAMP;
 
+    bool const hasAutomaticInstancing =
+            renderFlags & HAS_AUTOMATIC_INSTANCING;
+
     float const cameraPositionDotCameraForward = dot(cameraPosition, cameraForward);
 
     auto const* const UTILS_RESTRICT soaWorldAABBCenter = soa.data<FScene::WORLD_AABB_CENTER>();
@@ -696,11 +904,32 @@ RenderPass::Command* RenderPass::generateCommandsImpl(RenderPass::CommandTypeFla
                     morphing.morphTargetBuffer->getHwHandle() : SamplerGroupHandle{};
             cmd.info.morphingOffset = primitive.getMorphingBufferOffset();
 
+            bool cancelCommand = false;
+
             if constexpr (isColorPass) {
                 RenderPass::setupColorCommand(cmd, renderableVariant, mi,
                         inverseFrontFaces, hasDepthClamp);
                 const bool blendPass = Pass(cmd.key & PASS_MASK) == Pass::BLENDED;
-                if (blendPass) {
+                if (UTILS_UNLIKELY(blendPass && hasOrderIndependentTransparency)) {
+                    // The accumulation and revealage are order independent, so we sort by
+                    // material instead of distance and ignore the two-pass transparency modes.
+                    cmd.key &= ~(BLEND_DISTANCE_MASK | BLEND_ORDER_MASK);
+                    cmd.key |= makeField(mi->getSortingKey() & MATERIAL_MASK,
+                            BLEND_DISTANCE_MASK, BLEND_DISTANCE_SHIFT);
+
+                    RasterState& rs = cmd.info.rasterState;
+                    rs.depthWrite = false;
+                    rs.blendEquationRGB = BlendEquation::ADD;
+                    rs.blendEquationAlpha = BlendEquation::ADD;
+                    rs.blendFunctionSrcRGB = isOitRevealagePass ?
+                            BlendFunction::ZERO : BlendFunction::ONE;
+                    rs.blendFunctionSrcAlpha = rs.blendFunctionSrcRGB;
+                    rs.blendFunctionDstRGB = isOitRevealagePass ?
+                            BlendFunction::ONE_MINUS_SRC_ALPHA : BlendFunction::ONE;
+                    rs.blendFunctionDstAlpha = rs.blendFunctionDstRGB;
+
+                    cancelCommand = filterBlendedObjects;
+                } else if (blendPass) {
                     // TODO: at least for transparent objects, AABB should be per primitive
                     //       but that would break the "local" blend-order, which relies on
                     //       all primitives having the same Z
@@ -773,6 +1002,9 @@ RenderPass::Command* RenderPass::generateCommandsImpl(RenderPass::CommandTypeFla
                     // bucketizes the depth by its log2 and in 4 linear chunks in each bucket.
                     cmd.key &= ~Z_BUCKET_MASK;
                     cmd.key |= makeField(distanceBits >> 22u, Z_BUCKET_MASK, Z_BUCKET_SHIFT);
+
+                    // the order-independent transparency passes only render blended objects
+                    cancelCommand = isOitPass;
                 }
             } else if constexpr (isDepthPass) {
                 const RasterState rs = ma->getRasterState();
@@ -793,8 +1025,26 @@ RenderPass::Command* RenderPass::generateCommandsImpl(RenderPass::CommandTypeFla
             }
 
             *curr = cmd;
+
+            // With automatic instancing, draws that can be instanced together are sorted next
+            // to each other within their material, rather than by depth.
+            if (UTILS_UNLIKELY(hasAutomaticInstancing)) {
+                bool const canBeInstanced = !cmd.info.hasSkinning && !cmd.info.hasMorphing &&
+                        Pass(curr->key & PASS_MASK) != Pass::BLENDED;
+                CommandKey const instancingKey =
+                        makeField((curr->key & MATERIAL_MASK) >> MATERIAL_SHIFT,
+                                INSTANCING_MATERIAL_MASK, INSTANCING_MATERIAL_SHIFT) |
+                        makeInstancingKey(curr->info);
+                curr->key &= ~select(canBeInstanced,
+                        INSTANCING_MATERIAL_MASK | INSTANCING_KEY_MASK);
+                curr->key |= select(canBeInstanced, instancingKey);
+            }
+
             // cancel command if both front and back faces are culled
             curr->key |= select(mi->getCullingMode() == CullingMode::FRONT_AND_BACK);
+
+            // cancel command if it's rendered by another pass
+            curr->key |= select(cancelCommand);
             ++curr;
         }
     }
@@ -859,6 +1109,61 @@ backend::Viewport RenderPass::Executor::applyScissorViewport(
     return { l, b, uint32_t(r - l), uint32_t(t - b) };
 }
 
+// Maximum space occupied in the CircularBuffer by a single `Command`. This must be
+// reevaluated when the inner loop below adds DriverApi commands or when we change the
+// CommandStream protocol. Currently, the maximum is 320 bytes.
+// The batch size is calculated by adding the size of all commands that can possibly be
+// emitted per draw call:
+static constexpr size_t maxCommandSizeInBytes =
+        sizeof(CustomCommand) +
+        sizeof(COMMAND_TYPE(scissor)) +
+        sizeof(COMMAND_TYPE(bindBufferRange)) +
+        sizeof(COMMAND_TYPE(bindSamplers)) +
+        sizeof(COMMAND_TYPE(bindBufferRange)) +
+        sizeof(COMMAND_TYPE(bindBufferRange)) +
+        sizeof(COMMAND_TYPE(bindSamplers)) +
+        sizeof(COMMAND_TYPE(bindSamplers)) +
+        sizeof(COMMAND_TYPE(bindUniformBuffer)) +
+        sizeof(COMMAND_TYPE(bindSamplers)) +
+        sizeof(COMMAND_TYPE(bindSamplers)) +
+        sizeof(COMMAND_TYPE(bindPipeline)) +
+        sizeof(COMMAND_TYPE(setPushConstant)) +
+        sizeof(COMMAND_TYPE(bindRenderPrimitive)) +
+        sizeof(COMMAND_TYPE(draw2));
+
+// Render passes are only recorded in parallel when each job gets at least this many commands,
+// because each job starts by binding all the state again.
+static constexpr size_t MIN_COMMANDS_PER_RECORDING_JOB = 512;
+
+#if FILAMENT_ENABLE_MATDBG
+// Counts the draws and triangles of the given commands, for the debug server. This is a separate
+// loop so that the recording loop below isn't slowed down when nobody is watching.
+UTILS_NOINLINE
+static void collectFrameStats(matdbg::FrameStats& stats,
+        RenderPass::Command const* first, RenderPass::Command const* last) noexcept {
+    for (; first != last; ++first) {
+        RenderPass::PrimitiveInfo const& info = first->info;
+        if ((first->key & RenderPass::CUSTOM_MASK) != uint64_t(RenderPass::CustomCommand::PASS) ||
+                !info.rph) {
+            continue;
+        }
+        uint64_t triangleCount = 0;
+        if (info.type == PrimitiveType::TRIANGLES) {
+            triangleCount = info.indexCount / 3;
+        } else if (info.type == PrimitiveType::TRIANGLE_STRIP && info.indexCount > 2) {
+            triangleCount = info.indexCount - 2;
+        }
+        triangleCount *= info.instanceCount;
+
+        auto& material = stats.materials[info.mi->getMaterial()->getDebuggerId()];
+        material.drawCount++;
+        material.triangleCount += triangleCount;
+        stats.drawCount++;
+        stats.triangleCount += triangleCount;
+    }
+}
+#endif
+
 UTILS_NOINLINE // no need to be inlined
 void RenderPass::Executor::execute(FEngine& engine,
         const Command* first, const Command* last) const noexcept {
@@ -873,55 +1178,34 @@ void RenderPass::Executor::execute(FEngine& engine,
     if (first != last) {
         SYSTRACE_VALUE32("commandCount", last - first);
 
-        bool const scissorOverride = mScissorOverride;
-        if (UTILS_UNLIKELY(scissorOverride)) {
+#if FILAMENT_ENABLE_MATDBG
+        if (UTILS_UNLIKELY(engine.debug.frameStats)) {
+            collectFrameStats(*engine.debug.frameStats, first, last);
+        }
+#endif
+
+        if (UTILS_UNLIKELY(mScissorOverride)) {
             // initialize with scissor overide
             driver.scissor(mScissor);
         }
 
-        bool const polygonOffsetOverride = mPolygonOffsetOverride;
-        PipelineState pipeline{
-                // initialize with polygon offset override
-                .polygonOffset = mPolygonOffset,
-        };
-
-        PipelineState currentPipeline{};
-        Handle<HwRenderPrimitive> currentPrimitiveHandle{};
-        bool rebindPipeline = true;
-
-        FMaterialInstance const* UTILS_RESTRICT mi = nullptr;
-        FMaterial const* UTILS_RESTRICT ma = nullptr;
-        auto const* UTILS_RESTRICT pCustomCommands = mCustomCommands.data();
-
-        // Maximum space occupied in the CircularBuffer by a single `Command`. This must be
-        // reevaluated when the inner loop below adds DriverApi commands or when we change the
-        // CommandStream protocol. Currently, the maximum is 320 bytes.
-        // The batch size is calculated by adding the size of all commands that can possibly be
-        // emitted per draw call:
-        constexpr size_t const maxCommandSizeInBytes =
-                sizeof(CustomCommand) +
-                sizeof(COMMAND_TYPE(scissor)) +
-                sizeof(COMMAND_TYPE(bindUniformBuffer)) +
-                sizeof(COMMAND_TYPE(bindSamplers)) +
-                sizeof(COMMAND_TYPE(bindBufferRange)) +
-                sizeof(COMMAND_TYPE(bindBufferRange)) +
-                sizeof(COMMAND_TYPE(bindSamplers)) +
-                sizeof(COMMAND_TYPE(bindSamplers)) +
-                sizeof(COMMAND_TYPE(bindUniformBuffer)) +
-                sizeof(COMMAND_TYPE(bindSamplers)) +
-                sizeof(COMMAND_TYPE(bindSamplers)) +
-                sizeof(COMMAND_TYPE(bindPipeline)) +
-                sizeof(COMMAND_TYPE(setPushConstant)) +
-                sizeof(COMMAND_TYPE(bindRenderPrimitive)) +
-                sizeof(COMMAND_TYPE(draw2));
-
-
         // Number of Commands that can be issued and guaranteed to fit in the current
         // CircularBuffer allocation. In practice, we'll have tons of headroom especially if
         // skinning and morphing aren't used. With a 2 MiB buffer (the default) a batch is
         // 6553 commands (i.e. draw calls).
         size_t const batchCommandCount = capacity / maxCommandSizeInBytes;
+
+        // Custom commands use the engine's DriverApi, so they can only be recorded here.
+        ParallelCommandStreams* const streams = mCustomCommands.empty() ?
+                engine.getParallelCommandStreams() : nullptr;
+
         while(first != last) {
+            size_t const remaining = last - first;
+            if (streams && remaining >= 2 * MIN_COMMANDS_PER_RECORDING_JOB) {
+                first = recordInParallel(engine, *streams, first, last);
+                continue;
+            }
+
             Command const* const batchLast = std::min(first + batchCommandCount, last);
 
             // actual number of commands we need to write (can be smaller than batchCommandCount)
@@ -934,150 +1218,256 @@ void RenderPass::Executor::execute(FEngine& engine,
                 engine.flush(); // TODO: we should use a "fast" flush if possible
             }
 
-            first--;
-            while (++first != batchLast) {
-                assert_invariant(first->key != uint64_t(Pass::SENTINEL));
+            record(driver, first, batchLast);
+            first = batchLast;
+        }
+
+        // If the remaining space is less than half the capacity, we flush right away to
+        // allow some headroom for commands that might come later.
+        if (UTILS_UNLIKELY(circularBuffer.getUsed() > capacity / 2)) {
+            engine.flush();
+        }
+    }
+}
 
-                /*
-                 * Be careful when changing code below, this is the hot inner-loop
-                 */
+RenderPass::Command const* RenderPass::Executor::recordInParallel(FEngine& engine,
+        ParallelCommandStreams& streams, Command const* first, Command const* last) const noexcept {
+    SYSTRACE_CALL();
 
-                if (UTILS_UNLIKELY((first->key & CUSTOM_MASK) != uint64_t(CustomCommand::PASS))) {
-                    mi = nullptr; // custom command could change the currently bound MaterialInstance
-                    uint32_t const index = (first->key & CUSTOM_INDEX_MASK) >> CUSTOM_INDEX_SHIFT;
-                    assert_invariant(index < mCustomCommands.size());
-                    pCustomCommands[index]();
-                    continue;
-                }
+    DriverApi& driver = engine.getDriverApi();
+    size_t const capacity = engine.getMinCommandBufferSize();
+    CircularBuffer const& circularBuffer = driver.getCircularBuffer();
 
-                // primitiveHandle may be invalid if no geometry was set on the renderable.
-                if (UTILS_UNLIKELY(!first->info.rph)) {
-                    continue;
-                }
+    // each job must fit in its stream
+    size_t const remaining = last - first;
+    size_t const jobCount = std::min(streams.getCount(),
+            remaining / MIN_COMMANDS_PER_RECORDING_JOB);
+    size_t const jobCommandCount = std::min((remaining + jobCount - 1) / jobCount,
+            streams.getSize() / maxCommandSizeInBytes);
 
-                // per-renderable uniform
-                PrimitiveInfo const info = first->info;
-                pipeline.rasterState = info.rasterState;
-                pipeline.vertexBufferInfo = info.vbih;
-                pipeline.primitiveType = info.type;
-                assert_invariant(pipeline.vertexBufferInfo);
-
-                if (UTILS_UNLIKELY(mi != info.mi)) {
-                    // this is always taken the first time
-                    mi = info.mi;
-                    assert_invariant(mi);
-
-                    ma = mi->getMaterial();
-
-                   if (UTILS_LIKELY(!scissorOverride)) {
-                       backend::Viewport scissor = mi->getScissor();
-                       if (UTILS_UNLIKELY(mi->hasScissor())) {
-                           scissor = applyScissorViewport(mScissorViewport, scissor);
-                       }
-                       driver.scissor(scissor);
-                   }
-
-                   if (UTILS_LIKELY(!polygonOffsetOverride)) {
-                       pipeline.polygonOffset = mi->getPolygonOffset();
-                   }
-                    pipeline.stencilState = mi->getStencilState();
-                    mi->use(driver);
-
-                    // FIXME: MaterialInstance changed (not necessarily the program though),
-                    //  however, texture bindings may have changed and currently we need to
-                    //  rebind the pipeline when that happens.
-                    rebindPipeline = true;
-                }
+    JobSystem& js = engine.getJobSystem();
+    auto* parent = js.createJob();
+    for (size_t i = 0; i < jobCount; i++) {
+        Command const* const jobFirst = first + std::min(i * jobCommandCount, remaining);
+        Command const* const jobLast = first + std::min((i + 1) * jobCommandCount, remaining);
+        js.run(jobs::createJob(js, parent, [this, &streams, i, jobFirst, jobLast]() {
+            record(streams.acquire(i), jobFirst, jobLast);
+        }));
+    }
+    js.runAndWait(parent);
 
-                assert_invariant(ma);
-                pipeline.program = ma->getProgram(info.materialVariant);
+    // move the commands in order, each stream holds at most what fits in the CircularBuffer
+    for (size_t i = 0; i < jobCount; i++) {
+        if (UTILS_UNLIKELY(circularBuffer.getUsed() >
+                capacity - jobCommandCount * maxCommandSizeInBytes)) {
+            engine.flush();
+        }
+        streams.append(driver, i);
+    }
 
-                // Bind per-renderable uniform block. There is no need to attempt to skip this command
-                // because the backends already do this.
-                size_t const offset = info.hasHybridInstancing ?
-                                      0 : info.index * sizeof(PerRenderableData);
+    return first + std::min(jobCount * jobCommandCount, remaining);
+}
 
-                assert_invariant(info.boh);
+// Records the commands in [first, last). Apart from the scissor override, no state is inherited
+// from the commands recorded before, so that ranges can be recorded independently.
+void RenderPass::Executor::record(DriverApi& driver,
+        Command const* first, Command const* last) const noexcept {
+
+    bool const scissorOverride = mScissorOverride;
+    bool const polygonOffsetOverride = mPolygonOffsetOverride;
+    PipelineState pipeline{
+            // initialize with polygon offset override
+            .polygonOffset = mPolygonOffset,
+    };
+
+    PipelineState currentPipeline{};
+    Handle<HwRenderPrimitive> currentPrimitiveHandle{};
+    Handle<HwBufferObject> currentUboHandle{};
+    size_t currentUboOffset = 0;
+    bool rebindPipeline = true;
+
+    // The draw is deferred until the next command, so that consecutive draws of adjacent index
+    // ranges that don't change any state can be submitted as a single draw2().
+    uint32_t drawIndexOffset = 0;
+    uint32_t drawIndexCount = 0;
+    uint32_t drawInstanceCount = 0;
+    auto flushDraw = [&driver, &drawIndexOffset, &drawIndexCount, &drawInstanceCount]() {
+        if (drawIndexCount) {
+            driver.draw2(drawIndexOffset, drawIndexCount, drawInstanceCount);
+            drawIndexCount = 0;
+        }
+    };
 
-                driver.bindBufferRange(BufferObjectBinding::UNIFORM,
-                        +UniformBindingPoints::PER_RENDERABLE,
-                        info.boh, offset, sizeof(PerRenderableUib));
+    FMaterialInstance const* UTILS_RESTRICT mi = nullptr;
+    FMaterial const* UTILS_RESTRICT ma = nullptr;
+    auto const* UTILS_RESTRICT pCustomCommands = mCustomCommands.data();
 
-                if (UTILS_UNLIKELY(info.hasSkinning)) {
+    first--;
+    while (++first != last) {
+        assert_invariant(first->key != uint64_t(Pass::SENTINEL));
 
-                    FScene::RenderableSoa const& soa = *mRenderableSoa;
+        /*
+         * Be careful when changing code below, this is the hot inner-loop
+         */
 
-                    const FRenderableManager::SkinningBindingInfo& skinning =
-                            soa.elementAt<FScene::SKINNING_BUFFER>(info.index);
+        if (UTILS_UNLIKELY((first->key & CUSTOM_MASK) != uint64_t(CustomCommand::PASS))) {
+            flushDraw();
+            mi = nullptr; // custom command could change the currently bound MaterialInstance
+            currentUboHandle = {}; // or any other binding
+            uint32_t const index = (first->key & CUSTOM_INDEX_MASK) >> CUSTOM_INDEX_SHIFT;
+            assert_invariant(index < mCustomCommands.size());
+            pCustomCommands[index]();
+            continue;
+        }
 
-                    // note: we can't bind less than sizeof(PerRenderableBoneUib) due to glsl limitations
-                    driver.bindBufferRange(BufferObjectBinding::UNIFORM,
-                            +UniformBindingPoints::PER_RENDERABLE_BONES,
-                            skinning.handle,
-                            skinning.offset * sizeof(PerRenderableBoneUib::BoneData),
-                            sizeof(PerRenderableBoneUib));
-                    // note: always bind the skinningTexture because the shader needs it.
-                    driver.bindSamplers(+SamplerBindingPoints::PER_RENDERABLE_SKINNING,
-                            skinning.handleSampler);
-                    // note: even if only skinning is enabled, binding morphTargetBuffer is needed.
-                    driver.bindSamplers(+SamplerBindingPoints::PER_RENDERABLE_MORPHING,
-                            info.morphTargetBuffer);
+        // primitiveHandle may be invalid if no geometry was set on the renderable.
+        if (UTILS_UNLIKELY(!first->info.rph)) {
+            continue;
+        }
 
-                    // FIXME: Currently we need to rebind the PipelineState when texture or
-                    //  UBO binding change.
-                    rebindPipeline = true;
-                }
+        // per-renderable uniform
+        PrimitiveInfo const info = first->info;
+        size_t const offset = info.hasHybridInstancing ?
+                              0 : info.index * sizeof(PerRenderableData);
+
+        // Extend the pending draw if this command would only issue a draw2() that continues it.
+        // This is never the case for strips, whose index ranges can't be concatenated.
+        if (drawIndexCount &&
+                info.indexOffset == drawIndexOffset + drawIndexCount &&
+                info.instanceCount == drawInstanceCount &&
+                info.rph == currentPrimitiveHandle &&
+                info.mi == mi &&
+                info.boh == currentUboHandle && offset == currentUboOffset &&
+                !info.hasSkinning && !info.hasMorphing &&
+                info.rasterState == currentPipeline.rasterState &&
+                ma->getProgram(info.materialVariant) == currentPipeline.program &&
+                info.type != PrimitiveType::TRIANGLE_STRIP &&
+                info.type != PrimitiveType::LINE_STRIP) {
+            drawIndexCount += info.indexCount;
+            continue;
+        }
 
-                if (UTILS_UNLIKELY(info.hasMorphing)) {
+        flushDraw();
+
+        pipeline.rasterState = info.rasterState;
+        pipeline.vertexBufferInfo = info.vbih;
+        pipeline.primitiveType = info.type;
+        assert_invariant(pipeline.vertexBufferInfo);
+
+        if (UTILS_UNLIKELY(mi != info.mi)) {
+            // this is always taken the first time
+            mi = info.mi;
+            assert_invariant(mi);
+
+            ma = mi->getMaterial();
+
+           if (UTILS_LIKELY(!scissorOverride)) {
+               backend::Viewport scissor = mi->getScissor();
+               if (UTILS_UNLIKELY(mi->hasScissor())) {
+                   scissor = applyScissorViewport(mScissorViewport, scissor);
+               }
+               driver.scissor(scissor);
+           }
+
+           if (UTILS_LIKELY(!polygonOffsetOverride)) {
+               pipeline.polygonOffset = mi->getPolygonOffset();
+           }
+            pipeline.stencilState = mi->getStencilState();
+            mi->use(driver);
+
+            // FIXME: MaterialInstance changed (not necessarily the program though),
+            //  however, texture bindings may have changed and currently we need to
+            //  rebind the pipeline when that happens.
+            rebindPipeline = true;
+        }
 
-                    FScene::RenderableSoa const& soa = *mRenderableSoa;
+        assert_invariant(ma);
+        pipeline.program = ma->getProgram(info.materialVariant);
 
-                    const FRenderableManager::SkinningBindingInfo& skinning =
-                            soa.elementAt<FScene::SKINNING_BUFFER>(info.index);
+        // Bind per-renderable uniform block. The backends skip redundant bindings too, but
+        // skipping them here saves the command altogether, e.g. with hybrid instancing or for
+        // the primitives of the same renderable.
+        assert_invariant(info.boh);
 
-                    const FRenderableManager::MorphingBindingInfo& morphing =
-                            soa.elementAt<FScene::MORPHING_BUFFER>(info.index);
+        if (info.boh != currentUboHandle || offset != currentUboOffset) {
+            currentUboHandle = info.boh;
+            currentUboOffset = offset;
+            driver.bindBufferRange(BufferObjectBinding::UNIFORM,
+                    +UniformBindingPoints::PER_RENDERABLE,
+                    info.boh, offset, sizeof(PerRenderableUib));
+        }
 
-                    // Instead of using a UBO per primitive, we could also have a single UBO for all
-                    // primitives and use bindUniformBufferRange which might be more efficient.
-                    driver.bindUniformBuffer(+UniformBindingPoints::PER_RENDERABLE_MORPHING,
-                            morphing.handle);
-                    driver.bindSamplers(+SamplerBindingPoints::PER_RENDERABLE_MORPHING,
-                            info.morphTargetBuffer);
-                    // note: even if only morphing is enabled, binding skinningTexture is needed.
-                    driver.bindSamplers(+SamplerBindingPoints::PER_RENDERABLE_SKINNING,
-                            skinning.handleSampler);
+        if (UTILS_UNLIKELY(info.hasSkinning)) {
+
+            FScene::RenderableSoa const& soa = *mRenderableSoa;
+
+            const FRenderableManager::SkinningBindingInfo& skinning =
+                    soa.elementAt<FScene::SKINNING_BUFFER>(info.index);
+
+            // note: we can't bind less than sizeof(PerRenderableBoneUib) due to glsl limitations
+            driver.bindBufferRange(BufferObjectBinding::UNIFORM,
+                    +UniformBindingPoints::PER_RENDERABLE_BONES,
+                    skinning.handle,
+                    skinning.offset * sizeof(PerRenderableBoneUib::BoneData),
+                    sizeof(PerRenderableBoneUib));
+            // note: always bind the skinningTexture because the shader needs it.
+            driver.bindSamplers(+SamplerBindingPoints::PER_RENDERABLE_SKINNING,
+                    skinning.handleSampler);
+            // note: even if only skinning is enabled, binding morphTargetBuffer is needed.
+            driver.bindSamplers(+SamplerBindingPoints::PER_RENDERABLE_MORPHING,
+                    info.morphTargetBuffer);
+
+            // FIXME: Currently we need to rebind the PipelineState when texture or
+            //  UBO binding change.
+            rebindPipeline = true;
+        }
 
-                    // FIXME: Currently we need to rebind the PipelineState when texture or
-                    //  UBO binding change.
-                    rebindPipeline = true;
-                }
+        if (UTILS_UNLIKELY(info.hasMorphing)) {
 
-                if (rebindPipeline ||
-                        (memcmp(&pipeline,  &currentPipeline, sizeof(PipelineState)) != 0)) {
-                    rebindPipeline = false;
-                    currentPipeline = pipeline;
-                    driver.bindPipeline(pipeline);
+            FScene::RenderableSoa const& soa = *mRenderableSoa;
 
-                    driver.setPushConstant(ShaderStage::VERTEX,
-                            +PushConstantIds::MORPHING_BUFFER_OFFSET, int32_t(info.morphingOffset));
-                }
+            const FRenderableManager::SkinningBindingInfo& skinning =
+                    soa.elementAt<FScene::SKINNING_BUFFER>(info.index);
 
-                if (info.rph != currentPrimitiveHandle) {
-                    currentPrimitiveHandle = info.rph;
-                    driver.bindRenderPrimitive(info.rph);
-                }
+            const FRenderableManager::MorphingBindingInfo& morphing =
+                    soa.elementAt<FScene::MORPHING_BUFFER>(info.index);
 
-                driver.draw2(info.indexOffset, info.indexCount, info.instanceCount);
-            }
+            // Instead of using a UBO per primitive, we could also have a single UBO for all
+            // primitives and use bindUniformBufferRange which might be more efficient.
+            driver.bindUniformBuffer(+UniformBindingPoints::PER_RENDERABLE_MORPHING,
+                    morphing.handle);
+            driver.bindSamplers(+SamplerBindingPoints::PER_RENDERABLE_MORPHING,
+                    info.morphTargetBuffer);
+            // note: even if only morphing is enabled, binding skinningTexture is needed.
+            driver.bindSamplers(+SamplerBindingPoints::PER_RENDERABLE_SKINNING,
+                    skinning.handleSampler);
+
+            // FIXME: Currently we need to rebind the PipelineState when texture or
+            //  UBO binding change.
+            rebindPipeline = true;
         }
 
-        // If the remaining space is less than half the capacity, we flush right away to
-        // allow some headroom for commands that might come later.
-        if (UTILS_UNLIKELY(circularBuffer.getUsed() > capacity / 2)) {
-            engine.flush();
+        if (rebindPipeline ||
+                (memcmp(&pipeline,  &currentPipeline, sizeof(PipelineState)) != 0)) {
+            rebindPipeline = false;
+            currentPipeline = pipeline;
+            driver.bindPipeline(pipeline);
+
+            driver.setPushConstant(ShaderStage::VERTEX,
+                    +PushConstantIds::MORPHING_BUFFER_OFFSET, int32_t(info.morphingOffset));
         }
+
+        if (info.rph != currentPrimitiveHandle) {
+            currentPrimitiveHandle = info.rph;
+            driver.bindRenderPrimitive(info.rph);
+        }
+
+        drawIndexOffset = info.indexOffset;
+        drawIndexCount = info.indexCount;
+        drawInstanceCount = info.instanceCount;
     }
+
+    flushDraw();
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -32,6 +32,7 @@
 
 #include <utils/Allocator.h>
 #include <utils/BitmaskEnum.h>
+#include <utils/Hash.h>
 #include <utils/Range.h>
 #include <utils/Slice.h>
 #include <utils/architecture.h>
@@ -56,6 +57,7 @@ class CommandBufferQueue;
 }
 
 class FMaterialInstance;
+class ParallelCommandStreams;
 class FRenderPrimitive;
 class RenderPassBuilder;
 
@@ -73,8 +75,18 @@ public:
      *   0     = reserved, must be zero
      *
      *
-     * TODO: we need to add a "primitive id" in the low-bits of material-id, so that
-     *       auto-instancing can work better
+     * With automatic instancing, the commands that can be instanced (i.e. not blended, skinned
+     * or morphed) drop their Z-bucket: the material-id moves up into the Z-bucket and the
+     * reserved bits that follow it, above an 18-bits hash of the state that must match for
+     * draws to be instanced together (see makeInstancingKey()). Draws are still sorted by
+     * material first, and identical draws end up next to each other within each material.
+     *
+     *   instanceable DEPTH and COLOR commands, with automatic instancing
+     *   |  | 2| 2| 2| 2|1| 3 |               32               |        18        |
+     *   +--+--+--+--+--+-+---+--------------------------------+------------------+
+     *   |CC|00|PP|01|00|a|ppp|          material-id           |  instancing key  |
+     *   +--+--+--+--+--+-+---+--------------------------------+------------------+
+     *   | correctness        |      optimizations (truncation allowed)           |
      *
      *   DEPTH command (b00)
      *   |  |  | 2| 2| 2|1| 3 | 2|  6   |   10     |               32               |
@@ -100,6 +112,9 @@ public:
      *   +--+--+--+--+--+-+---+--+--------------------------------+---------------+-+
      *   | correctness                                                              |
      *
+     * In the order-independent transparency passes, the distance is replaced by the
+     * material-id and the blend order and two-pass bits are unused.
+     *
      *
      *   pre-CUSTOM command
      *   | 2| 2| 2| 2| 2|         22           |               32               |
@@ -149,6 +164,12 @@ public:
     static constexpr uint64_t Z_BUCKET_MASK                 = 0x3FF00000000llu;
     static constexpr unsigned Z_BUCKET_SHIFT                = 32;
 
+    static constexpr uint64_t INSTANCING_MATERIAL_MASK      = 0x0003FFFFFFFC0000llu;
+    static constexpr unsigned INSTANCING_MATERIAL_SHIFT     = 18;
+
+    static constexpr uint64_t INSTANCING_KEY_MASK           = 0x000000000003FFFFllu;
+    static constexpr unsigned INSTANCING_KEY_SHIFT          = 0;
+
     static constexpr uint64_t PRIORITY_MASK                 = 0x001C000000000000llu;
     static constexpr unsigned PRIORITY_SHIFT                = 50;
 
@@ -199,6 +220,14 @@ public:
         // alpha-blended objects are not rendered in the depth buffer
         FILTER_TRANSLUCENT_OBJECTS = 0x10,
 
+        // Weighted blended order-independent transparency: the color pass skips blended
+        // objects, which are then rendered in any order by the accumulation pass (sum of the
+        // premultiplied colors and of the alphas) and the revealage pass (product of 1-alpha).
+        // Both of these only render blended objects, without writing depth.
+        FILTER_BLENDED_OBJECTS = 0x20,
+        OIT_ACCUMULATION = 0x40,
+        OIT_REVEALAGE = 0x80,
+
         // generate commands for shadow map
         SHADOW = DEPTH | DEPTH_CONTAINS_SHADOW_CASTERS,
         // generate commands for SSAO
@@ -266,6 +295,20 @@ public:
     };
     static_assert(sizeof(PrimitiveInfo) == 56);
 
+    // A hash of the state instanceify() compares, placed in the INSTANCING_KEY_MASK bits.
+    // Collisions only cost draws that could have been instanced.
+    static CommandKey makeInstancingKey(PrimitiveInfo const& info) noexcept {
+        uint64_t const mi = uintptr_t(info.mi);
+        uint32_t const words[] = {
+                uint32_t(mi), uint32_t(mi >> 32u),
+                info.rph.getId(), info.vbih.getId(),
+                info.indexOffset, info.indexCount,
+                info.rasterState.u };
+        uint32_t const hash = utils::hash::murmur3(words, sizeof(words) / sizeof(uint32_t), 0);
+        return makeField(hash & (INSTANCING_KEY_MASK >> INSTANCING_KEY_SHIFT),
+                INSTANCING_KEY_MASK, INSTANCING_KEY_SHIFT);
+    }
+
     struct alignas(8) Command {     // 64 bytes
         CommandKey key = 0;         //  8 bytes
         PrimitiveInfo info;    // 56 bytes
@@ -280,11 +323,41 @@ public:
     static_assert(std::is_trivially_destructible_v<Command>,
             "Command isn't trivially destructible");
 
+    /*
+     * CommandSortCache retains the sorted order of a pass's commands from one frame to the next.
+     * Most commands keep the same key across frames, so instead of sorting everything again,
+     * sortCommands() replays the previous order, sorts only the commands that are now out of
+     * place and merges them back in. This costs O(n + d.log(d)) instead of O(n.log(n)), where
+     * d is the number of commands that changed.
+     * The cache is only a hint, a stale cache never affects the result.
+     */
+    class CommandSortCache {
+    public:
+        // forget the previous order, e.g. when the scene changes completely
+        void clear() noexcept { mOrder.clear(); }
+
+    private:
+        friend class RenderPass;
+        struct Entry {
+            CommandKey key;
+            uint32_t index;
+            bool operator < (Entry const& rhs) const noexcept { return key < rhs.key; }
+        };
+        // previous frame's sorted order, i.e. the index of each command before sorting
+        std::vector<uint32_t> mOrder;
+        // scratch storage, kept around so we don't reallocate every frame
+        std::vector<Entry> mEntries;
+        std::vector<Entry> mDirty;
+        std::vector<Entry> mMerged;
+        std::vector<uint32_t> mPermutation;
+    };
+
     using RenderFlags = uint8_t;
     static constexpr RenderFlags HAS_SHADOWING             = 0x01;
     static constexpr RenderFlags HAS_INVERSE_FRONT_FACES   = 0x02;
     static constexpr RenderFlags IS_INSTANCED_STEREOSCOPIC = 0x04;
     static constexpr RenderFlags HAS_DEPTH_CLAMP           = 0x08;
+    static constexpr RenderFlags HAS_AUTOMATIC_INSTANCING  = 0x10;
 
     // Arena used for commands
     using Arena = utils::Arena<
@@ -350,6 +423,12 @@ public:
 
         void execute(FEngine& engine, const Command* first, const Command* last) const noexcept;
 
+        Command const* recordInParallel(FEngine& engine, ParallelCommandStreams& streams,
+                Command const* first, Command const* last) const noexcept;
+
+        void record(backend::DriverApi& driver,
+                Command const* first, Command const* last) const noexcept;
+
         static backend::Viewport applyScissorViewport(
                 backend::Viewport const& scissorViewport,
                 backend::Viewport const& scissor) noexcept;
@@ -411,10 +490,30 @@ private:
 
     static Command* resize(Arena& arena, Command* const last) noexcept;
 
-    // sorts commands then trims sentinels
-    static Command* sortCommands(
+    // sorts commands then trims sentinels, scratch memory is allocated from `arena`
+    static Command* sortCommands(utils::JobSystem& js, Arena& arena,
+            Command* begin, Command* end) noexcept;
+
+    // same as above but uses (and updates) the previous frame's order as a starting point
+    static Command* sortCommands(utils::JobSystem& js, CommandSortCache& cache,
             Command* begin, Command* end) noexcept;
 
+    // Sorts `count` entries by key, using `scratch` as temporary storage. Large arrays use a
+    // parallel LSD radix sort. Returns either `entries` or `scratch`, whichever holds the result.
+    static CommandSortCache::Entry* sortEntries(utils::JobSystem& js,
+            CommandSortCache::Entry* entries, CommandSortCache::Entry* scratch,
+            uint32_t count) noexcept;
+
+    // Moves each command to its sorted position: command `order[i]` ends up at index `i`.
+    // `order` is destroyed in the process.
+    static void permuteCommands(Command* commands, uint32_t* order, uint32_t count) noexcept;
+
+    // Below this many commands the radix sort isn't worth it.
+    static constexpr uint32_t RADIX_SORT_MIN_COUNT = 2048;
+    // Minimum number of commands per radix sort job.
+    static constexpr uint32_t RADIX_SORT_MIN_COUNT_PER_JOB = 4096;
+    static constexpr uint32_t RADIX_SORT_MAX_JOB_COUNT = 16;
+
     // instanceify commands then trims sentinels
     RenderPass::Command* instanceify(FEngine& engine,
             Command* begin, Command* end,
@@ -476,6 +575,7 @@ class RenderPassBuilder {
     RenderPass::RenderFlags mFlags{};
     Variant mVariant{};
     FScene::VisibleMaskType mVisibilityMask = std::numeric_limits<FScene::VisibleMaskType>::max();
+    RenderPass::CommandSortCache* mSortCache = nullptr;
 
     using CustomCommandRecord = std::tuple<
             uint8_t,
@@ -549,6 +649,14 @@ public:
         return *this;
     }
 
+    // Speeds up sorting by reusing the order of a previous pass built with the same cache.
+    // The cache must outlive the RenderPass and should only be shared by passes that produce
+    // similar commands from one frame to the next (e.g. a View's color pass).
+    RenderPassBuilder& sortCache(RenderPass::CommandSortCache* cache) noexcept {
+        mSortCache = cache;
+        return *this;
+    }
+
     RenderPassBuilder& customCommand(FEngine& engine,
             uint8_t channel,
             RenderPass::Pass pass,
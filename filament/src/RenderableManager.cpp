@@ -105,36 +105,45 @@ uint8_t RenderableManager::getLayerMask(Instance instance) const noexcept {
 }
 
 size_t RenderableManager::getPrimitiveCount(Instance instance) const noexcept {
-    return downcast(this)->getPrimitiveCount(instance, 0);
+    return downcast(this)->getPrimitiveCount(instance, FRenderableManager::ALL_LEVELS);
+}
+
+size_t RenderableManager::getLevelOfDetailCount(Instance instance) const noexcept {
+    return downcast(this)->getLevelCount(instance);
 }
 
 void RenderableManager::setMaterialInstanceAt(Instance instance,
         size_t primitiveIndex, MaterialInstance const* materialInstance) {
-    downcast(this)->setMaterialInstanceAt(instance, 0, primitiveIndex, downcast(materialInstance));
+    downcast(this)->setMaterialInstanceAt(instance, FRenderableManager::ALL_LEVELS,
+            primitiveIndex, downcast(materialInstance));
 }
 
 MaterialInstance* RenderableManager::getMaterialInstanceAt(
         Instance instance, size_t primitiveIndex) const noexcept {
-    return downcast(this)->getMaterialInstanceAt(instance, 0, primitiveIndex);
+    return downcast(this)->getMaterialInstanceAt(instance, FRenderableManager::ALL_LEVELS,
+            primitiveIndex);
 }
 
 void RenderableManager::setBlendOrderAt(Instance instance, size_t primitiveIndex, uint16_t order) noexcept {
-    downcast(this)->setBlendOrderAt(instance, 0, primitiveIndex, order);
+    downcast(this)->setBlendOrderAt(instance, FRenderableManager::ALL_LEVELS,
+            primitiveIndex, order);
 }
 
 void RenderableManager::setGlobalBlendOrderEnabledAt(RenderableManager::Instance instance,
         size_t primitiveIndex, bool enabled) noexcept {
-    downcast(this)->setGlobalBlendOrderEnabledAt(instance, 0, primitiveIndex, enabled);
+    downcast(this)->setGlobalBlendOrderEnabledAt(instance, FRenderableManager::ALL_LEVELS,
+            primitiveIndex, enabled);
 }
 
 AttributeBitset RenderableManager::getEnabledAttributesAt(Instance instance, size_t primitiveIndex) const noexcept {
-    return downcast(this)->getEnabledAttributesAt(instance, 0, primitiveIndex);
+    return downcast(this)->getEnabledAttributesAt(instance, FRenderableManager::ALL_LEVELS,
+            primitiveIndex);
 }
 
 void RenderableManager::setGeometryAt(Instance instance, size_t primitiveIndex,
         PrimitiveType type, VertexBuffer* vertices, IndexBuffer* indices,
         size_t offset, size_t count) noexcept {
-    downcast(this)->setGeometryAt(instance, 0, primitiveIndex,
+    downcast(this)->setGeometryAt(instance, FRenderableManager::ALL_LEVELS, primitiveIndex,
             type, downcast(vertices), downcast(indices), offset, count);
 }
 
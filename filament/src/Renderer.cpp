@@ -99,10 +99,27 @@ Renderer::ClearOptions const& Renderer::getClearOptions() const noexcept {
     return downcast(this)->getClearOptions();
 }
 
+void Renderer::setIdleFrameOptions(IdleFrameOptions const& options) noexcept {
+    downcast(this)->setIdleFrameOptions(options);
+}
+
+Renderer::IdleFrameOptions const& Renderer::getIdleFrameOptions() const noexcept {
+    return downcast(this)->getIdleFrameOptions();
+}
+
 void Renderer::renderStandaloneView(View const* view) {
     downcast(this)->renderStandaloneView(downcast(view));
 }
 
+void Renderer::renderStandaloneViews(View const* const* views, size_t count) {
+    // FView derives from View, but an array of View* can't be reinterpreted as an array of FView*
+    auto fviews = utils::FixedCapacityVector<FView const*>::with_capacity(count);
+    for (size_t i = 0; i < count; i++) {
+        fviews.push_back(downcast(views[i]));
+    }
+    downcast(this)->renderStandaloneViews(fviews.data(), count);
+}
+
 void Renderer::setVsyncTime(uint64_t steadyClockTimeNano) noexcept {
     downcast(this)->setVsyncTime(steadyClockTimeNano);
 }
@@ -115,4 +132,8 @@ size_t Renderer::getMaxFrameHistorySize() const noexcept {
     return downcast(this)->getMaxFrameHistorySize();
 }
 
+void Renderer::setPassTimingEnabled(bool enabled) noexcept {
+    downcast(this)->setPassTimingEnabled(enabled);
+}
+
 } // namespace filament
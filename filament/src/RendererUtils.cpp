@@ -250,6 +250,8 @@ RendererUtils::ColorPassOutput RendererUtils::colorPass(
                     out.params.subpassMask = 1;
                 }
 
+                out.params.shadingRate = view.getShadingRate();
+
                 driver.beginRenderPass(out.target, out.params);
                 passExecutor.execute(engine, resources.getPassName());
                 driver.endRenderPass();
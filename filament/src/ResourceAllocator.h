@@ -115,6 +115,10 @@ public:
 
     void gc(bool skippedFrame = false) noexcept;
 
+    // size of the textures currently in the cache, and the largest size it reached
+    size_t getCacheSize() const noexcept { return mCacheSize; }
+    size_t getCacheSizeHighWatermark() const noexcept { return mCacheSizeHiWaterMark; }
+
 private:
     size_t const mCacheMaxAge;
 
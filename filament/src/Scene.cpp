@@ -75,4 +75,12 @@ void Scene::forEach(Invocable<void(utils::Entity)>&& functor) const noexcept {
     downcast(this)->forEach(std::move(functor));
 }
 
+void Scene::setCullingHierarchyEnabled(bool enabled) noexcept {
+    downcast(this)->setCullingHierarchyEnabled(enabled);
+}
+
+bool Scene::isCullingHierarchyEnabled() const noexcept {
+    return downcast(this)->isCullingHierarchyEnabled();
+}
+
 } // namespace filament
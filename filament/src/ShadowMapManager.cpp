@@ -43,6 +43,7 @@
 #include <utils/debug.h>
 #include <utils/FixedCapacityVector.h>
 #include <utils/BitmaskEnum.h>
+#include <utils/Hash.h>
 #include <utils/Range.h>
 #include <utils/Slice.h>
 
@@ -75,6 +76,8 @@ ShadowMapManager::ShadowMapManager(FEngine& engine)
             &engine.debug.shadowmap.disable_light_frustum_align);
     debugRegistry.registerProperty("d.shadowmap.depth_clamp",
             &engine.debug.shadowmap.depth_clamp);
+    debugRegistry.registerProperty("d.shadowmap.cull_casters_by_receivers",
+            &engine.debug.shadowmap.cull_casters_by_receivers);
 }
 
 ShadowMapManager::~ShadowMapManager() {
@@ -105,6 +108,7 @@ void ShadowMapManager::terminate(FEngine& engine) {
     if (UTILS_UNLIKELY(mInitialized)) {
         DriverApi& driver = engine.getDriverApi();
         driver.destroyBufferObject(mShadowUbh);
+        destroyCachedAtlas(engine);
         UTILS_NOUNROLL
         for (auto& entry: mShadowMapCache) {
             std::launder(reinterpret_cast<ShadowMap*>(&entry))->terminate(engine);
@@ -246,16 +250,34 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
 
     VsmShadowOptions const& vsmShadowOptions = view.getVsmShadowOptions();
 
+    // With shadow map caching or time-slicing, the atlas outlives the FrameGraph and the shadow
+    // maps that are not rendered this frame are sampled from the layer they were last rendered to.
+    bool const cacheShadowMaps = view.isShadowMapCachingEnabled();
+    uint32_t const spotUpdateBudget = view.getShadowMapUpdateBudget();
+    uint32_t const cascadeUpdateInterval = view.getFarCascadeUpdateInterval();
+    bool const useCachedAtlas = cacheShadowMaps || spotUpdateBudget || cascadeUpdateInterval > 1;
+    FrameGraphId<FrameGraphTexture> cachedShadows;
+    if (useCachedAtlas) {
+        updateCachedAtlas(engine, view);
+        cachedShadows = fg.import("Shadowmap", mCachedAtlas.desc, mCachedAtlas.usage,
+                FrameGraphTexture{ .handle = mCachedAtlas.texture });
+    } else {
+        destroyCachedAtlas(engine);
+    }
+    mFrameCount++;
+
     auto& prepareShadowPass = fg.addPass<PrepareShadowPassData>("Prepare Shadow Pass",
             [&](FrameGraph::Builder& builder, auto& data) {
                 data.passList.reserve(CONFIG_MAX_SHADOWMAPS);
-                data.shadows = builder.createTexture("Shadowmap", {
-                        .width = textureRequirements.size, .height = textureRequirements.size,
-                        .depth = textureRequirements.layers,
-                        .levels = textureRequirements.levels,
-                        .type = SamplerType::SAMPLER_2D_ARRAY,
-                        .format = textureRequirements.format
-                });
+                data.shadows = useCachedAtlas ? cachedShadows :
+                        builder.createTexture("Shadowmap", {
+                                .width = textureRequirements.size,
+                                .height = textureRequirements.size,
+                                .depth = textureRequirements.layers,
+                                .levels = textureRequirements.levels,
+                                .type = SamplerType::SAMPLER_2D_ARRAY,
+                                .format = textureRequirements.format
+                        });
 
                 // these loops create a list of the shadow maps that might need to be rendered
                 auto& passList = data.passList;
@@ -265,16 +287,44 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                 if (!directionalShadowCastersRange.empty()) {
                     for (auto& shadowMap : getCascadedShadowMap()) {
                         // for the directional light, we already know if it has visible shadows.
-                        if (shadowMap.hasVisibleShadows()) {
-                            passList.push_back({
-                                    {}, &shadowMap, directionalShadowCastersRange,
-                                    VISIBLE_DIR_SHADOW_RENDERABLE });
+                        if (!shadowMap.hasVisibleShadows()) {
+                            continue;
                         }
+                        if (useCachedAtlas) {
+                            LayerUpdate const update = getLayerUpdate(engine, view, shadowMap,
+                                    scene->getRenderableData(), scene->getLightData(),
+                                    directionalShadowCastersRange,
+                                    VISIBLE_DIR_SHADOW_RENDERABLE, cacheShadowMaps);
+                            // all cascades but the first are rendered every
+                            // cascadeUpdateInterval frames, each on a different frame.
+                            size_t const cascade = shadowMap.getShadowIndex();
+                            bool const deferred = update.state == LayerState::OUT_OF_DATE &&
+                                    cascade > 0 &&
+                                    (mFrameCount + cascade) % cascadeUpdateInterval != 0;
+                            if (update.state == LayerState::UP_TO_DATE || deferred) {
+                                setLayerKept(shadowMap, update.state);
+                                continue;
+                            }
+                            setLayerRendered(shadowMap, update);
+                        }
+                        passList.push_back({
+                                {}, &shadowMap, directionalShadowCastersRange,
+                                VISIBLE_DIR_SHADOW_RENDERABLE });
                     }
                 }
 
                 // Point lights and Spotlight shadow maps
+                struct Candidate {
+                    ShadowMap* shadowMap;
+                    LayerUpdate update;
+                    float priority;
+                };
+                std::array<Candidate, CONFIG_MAX_SHADOWMAPS> candidates;
+                size_t candidateCount = 0;
+                size_t updateCount = 0;
+
                 auto const spotShadowCastersRange = view.getVisibleSpotShadowCasters();
+                mPointShadowFaces.lightIndex = PointShadowFaces::INVALID;
                 if (!spotShadowCastersRange.empty()) {
                     for (auto& shadowMap : getSpotShadowMaps()) {
                         assert_invariant(!shadowMap.isDirectionalShadow());
@@ -293,11 +343,69 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                                 break;
                         }
 
-                        if (shadowMap.hasVisibleShadows()) {
-                            passList.push_back({
-                                    {}, &shadowMap, spotShadowCastersRange,
-                                    VISIBLE_DYN_SHADOW_RENDERABLE });
+                        if (!shadowMap.hasVisibleShadows()) {
+                            continue;
                         }
+
+                        if (useCachedAtlas) {
+                            if (cacheShadowMaps) {
+                                // The casters of this shadow map are needed to tell if it
+                                // changed. Culling is done again below before rendering,
+                                // because the result is shared by all spot and point shadow maps.
+                                if (shadowMap.getShadowType() == ShadowType::SPOT) {
+                                    cullSpotShadowMap(shadowMap, engine, view,
+                                            scene->getRenderableData(), spotShadowCastersRange,
+                                            scene->getLightData());
+                                } else {
+                                    cullPointShadowMap(shadowMap, view,
+                                            scene->getRenderableData(), spotShadowCastersRange,
+                                            scene->getLightData());
+                                }
+                            }
+                            LayerUpdate const update = getLayerUpdate(engine, view, shadowMap,
+                                    scene->getRenderableData(), scene->getLightData(),
+                                    spotShadowCastersRange,
+                                    VISIBLE_DYN_SHADOW_RENDERABLE, cacheShadowMaps);
+                            if (update.state == LayerState::UP_TO_DATE) {
+                                setLayerKept(shadowMap, update.state);
+                                continue;
+                            }
+                            if (update.state == LayerState::OUT_OF_DATE && spotUpdateBudget) {
+                                // out-of-date shadow maps compete for the budget below
+                                candidates[candidateCount++] = { &shadowMap, update,
+                                        getShadowMapPriority(shadowMap, mainCameraInfo,
+                                                scene->getLightData()) };
+                                continue;
+                            }
+                            setLayerRendered(shadowMap, update);
+                        }
+
+                        updateCount++;
+                        passList.push_back({
+                                {}, &shadowMap, spotShadowCastersRange,
+                                VISIBLE_DYN_SHADOW_RENDERABLE });
+                    }
+                }
+
+                // Missing shadow maps are always rendered, out-of-date ones are rendered by
+                // order of priority with what's left of the budget, the others keep their content.
+                if (candidateCount) {
+                    std::sort(candidates.begin(), candidates.begin() + candidateCount,
+                            [](Candidate const& lhs, Candidate const& rhs) {
+                                return lhs.priority > rhs.priority;
+                            });
+                    size_t const remaining = spotUpdateBudget > updateCount ?
+                            spotUpdateBudget - updateCount : 0;
+                    for (size_t i = 0; i < candidateCount; i++) {
+                        Candidate const& candidate = candidates[i];
+                        if (i >= remaining) {
+                            setLayerKept(*candidate.shadowMap, candidate.update.state);
+                            continue;
+                        }
+                        setLayerRendered(*candidate.shadowMap, candidate.update);
+                        passList.push_back({
+                                {}, candidate.shadowMap, spotShadowCastersRange,
+                                VISIBLE_DYN_SHADOW_RENDERABLE });
                     }
                 }
 
@@ -313,12 +421,41 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
 
 
                 // Note: we could almost parallel_for the loop below, the problem currently is
-                // that updatePrimitivesLod() updates temporary global state.
-                // prepareSpotShadowMap() also update the visibility of renderable. These two
-                // pieces of state are needed only until shadowMap.render() returns.
+                // that prepareSpotShadowMap() updates the visibility of renderables, which is
+                // needed only until shadowMap.render() returns.
                 // Conceptually, we could store this out-of-band.
 
+                // Cull the casters of all the spot shadow maps at once, and separately the casters
+                // of all the cascades, so that each range of casters is swept only once.
+                auto& renderableData = scene->getRenderableData();
+                std::array<float4, CONFIG_MAX_SHADOWMAPS * 6> spotPlanes;
+                size_t spotCount = 0;
+                utils::Range<uint32_t> spotRange{};
+                utils::Range<uint32_t> directionalRange{};
+                for (auto const& entry : data.passList) {
+                    ShadowMap const& shadowMap = *entry.shadowMap;
+                    if (shadowMap.getShadowType() == ShadowType::SPOT) {
+                        Frustum const frustum = getSpotShadowCullingFrustum(shadowMap, engine,
+                                scene->getLightData());
+                        std::copy_n(frustum.getNormalizedPlanes(), 6,
+                                spotPlanes.data() + spotCount * 6);
+                        spotRange = entry.range;
+                        spotCount++;
+                    } else if (shadowMap.getShadowType() == ShadowType::DIRECTIONAL) {
+                        directionalRange = entry.range;
+                    }
+                }
+                if (spotCount) {
+                    cullShadowCasters(mSpotCasterMasks, renderableData, spotRange,
+                            spotPlanes.data(), spotCount);
+                }
+                if (!directionalRange.empty()) {
+                    cullCascadeShadowMaps(engine, view, renderableData, directionalRange);
+                }
+
                 // Generate a RenderPass for each shadow map
+                mPointShadowFaces.lightIndex = PointShadowFaces::INVALID;
+                size_t spotIndex = 0;
                 for (auto const& entry : data.passList) {
                     ShadowMap const& shadowMap = *entry.shadowMap;
                     assert_invariant(shadowMap.hasVisibleShadows());
@@ -336,15 +473,14 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
 
                     switch (shadowMap.getShadowType()) {
                         case ShadowType::DIRECTIONAL:
-                            // we should never be here
+                            updateCascadeCasters(shadowMap.getShadowIndex(),
+                                    renderableData, entry.range);
                             break;
                         case ShadowType::SPOT:
-                            ShadowMapManager::cullSpotShadowMap(shadowMap, engine, view,
-                                    scene->getRenderableData(), entry.range,
-                                    scene->getLightData());
+                            updateSpotCasters(spotIndex++, view, renderableData, entry.range);
                             break;
                         case ShadowType::POINT:
-                            ShadowMapManager::cullPointShadowMap(shadowMap, view,
+                            cullPointShadowMap(shadowMap, view,
                                     scene->getRenderableData(), entry.range,
                                     scene->getLightData());
                             break;
@@ -361,9 +497,8 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                             vsmShadowOptions.highPrecision);
                     shadowMap.commit(transaction, driver);
 
-                    // updatePrimitivesLod must be run before RenderPass::appendCommands.
-                    view.updatePrimitivesLod(engine,
-                            cameraInfo, scene->getRenderableData(), entry.range);
+                    // the levels of detail were selected by FView::prepare() from the main
+                    // camera, so shadows are cast by the primitives that are drawn.
 
                     // generate and sort the commands for rendering the shadow map
 
@@ -533,23 +668,176 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                         shadowPass->output,
                         false, kernelWidth, sigma);
             }
+        }
+    }
 
-            // If the shadow texture has more than one level, mipmapping was requested, either directly
-            // or indirectly via anisotropic filtering.
-            // So generate the mipmaps for each layer
-            if (textureRequirements.levels > 1) {
-                for (size_t level = 0; level < textureRequirements.levels - 1; level++) {
-                    const bool finalize = level == textureRequirements.levels - 2;
-                    ppm.vsmMipmapPass(fg, prepareShadowPass->shadows, layer, level,
-                            vsmClearColor, finalize);
-                }
-            }
+    // If the shadow texture has more than one level, mipmapping was requested, either directly
+    // or indirectly via anisotropic filtering.
+    // So generate the mipmaps for all the layers we rendered, in a single pass.
+    if (view.hasVSM() && textureRequirements.levels > 1 && !passList.empty()) {
+        auto layers = utils::FixedCapacityVector<uint8_t>::with_capacity(passList.size());
+        for (auto const& entry: passList) {
+            layers.push_back(entry.shadowMap->getLayer());
         }
+        engine.getPostProcessManager().vsmMipmapPass(fg, prepareShadowPass->shadows,
+                layers, textureRequirements.levels, vsmClearColor);
     }
 
     return prepareShadowPass->shadows;
 }
 
+size_t ShadowMapManager::computeShadowMapKey(FEngine const& engine, FView const& view,
+        ShadowMap const& shadowMap, FScene::RenderableSoa const& renderableData,
+        utils::Range<uint32_t> range, FScene::VisibleMaskType visibilityMask,
+        bool* outCacheable) noexcept {
+
+    auto hashWords = [](size_t& seed, auto const& v) {
+        static_assert(sizeof(v) % 4 == 0);
+        utils::hash::combine(seed, utils::hash::murmur3(
+                reinterpret_cast<uint32_t const*>(&v), sizeof(v) / 4, 0));
+    };
+
+    // what the shadow map is rendered with
+    FCamera const& camera = shadowMap.getCamera();
+    auto const* options = shadowMap.getShadowOptions();
+    size_t key = size_t(shadowMap.getShadowType());
+    hashWords(key, camera.getProjectionMatrix());
+    hashWords(key, camera.getModelMatrix());
+    hashWords(key, shadowMap.getViewport());
+    hashWords(key, shadowMap.getScissor());
+    hashWords(key, float4{
+            options->polygonOffsetConstant, options->polygonOffsetSlope,
+            options->vsm.blurWidth, float(view.getVsmShadowOptions().msaaSamples) });
+    utils::hash::combine(key, engine.debug.shadowmap.depth_clamp);
+
+    // and what is rendered into it
+    bool cacheable = true;
+    auto const* const instances = renderableData.data<FScene::RENDERABLE_INSTANCE>();
+    auto const* const worldTransforms = renderableData.data<FScene::WORLD_TRANSFORM>();
+    auto const* const visibility = renderableData.data<FScene::VISIBILITY_STATE>();
+    auto const* const instancesInfo = renderableData.data<FScene::INSTANCES>();
+    auto const* const primitives = renderableData.data<FScene::PRIMITIVES>();
+    auto const* const visibleMask = renderableData.data<FScene::VISIBLE_MASK>();
+    for (uint32_t i = range.first; i < range.last; i++) {
+        if (!(visibleMask[i] & visibilityMask)) {
+            continue;
+        }
+        // the vertices of skinned, morphed or instanced renderables can move on their own
+        FRenderableManager::Visibility const v = visibility[i];
+        cacheable = cacheable && !v.skinning && !v.morphing && !instancesInfo[i].buffer;
+        utils::hash::combine(key, instances[i].asValue());
+        utils::hash::combine(key, instancesInfo[i].count);
+        utils::hash::combine(key, primitives[i].begin());
+        utils::hash::combine(key, primitives[i].end());
+        hashWords(key, worldTransforms[i]);
+    }
+
+    *outCacheable = cacheable;
+    return key;
+}
+
+void ShadowMapManager::updateCachedAtlas(FEngine& engine, FView const& view) noexcept {
+    TextureAtlasRequirements const& requirements = mTextureAtlasRequirements;
+    FrameGraphTexture::Descriptor const desc{
+            .width = requirements.size, .height = requirements.size,
+            .depth = requirements.layers,
+            .levels = requirements.levels,
+            .type = SamplerType::SAMPLER_2D_ARRAY,
+            .format = requirements.format
+    };
+
+    CachedAtlas& atlas = mCachedAtlas;
+    if (atlas.texture &&
+            atlas.desc.width == desc.width && atlas.desc.depth == desc.depth &&
+            atlas.desc.levels == desc.levels && atlas.desc.format == desc.format) {
+        return;
+    }
+
+    // the layout of the atlas changed, all its layers need to be rendered again
+    destroyCachedAtlas(engine);
+    TextureUsage const usage = TextureUsage::SAMPLEABLE |
+            (view.hasVSM() ? TextureUsage::COLOR_ATTACHMENT : TextureUsage::DEPTH_ATTACHMENT);
+    atlas.texture = engine.getDriverApi().createTexture(desc.type, desc.levels, desc.format, 1,
+            desc.width, desc.height, desc.depth, usage);
+    atlas.desc = desc;
+    atlas.usage = usage;
+}
+
+void ShadowMapManager::destroyCachedAtlas(FEngine& engine) noexcept {
+    if (mCachedAtlas.texture) {
+        engine.getDriverApi().destroyTexture(mCachedAtlas.texture);
+        mCachedAtlas.texture.clear();
+    }
+    for (CachedLayer& layer : mCachedAtlas.layers) {
+        layer.valid = false;
+    }
+}
+
+ShadowMapManager::LayerUpdate ShadowMapManager::getLayerUpdate(FEngine const& engine,
+        FView const& view, ShadowMap const& shadowMap,
+        FScene::RenderableSoa const& renderableData, FScene::LightSoa const& lightData,
+        utils::Range<uint32_t> range, FScene::VisibleMaskType visibilityMask,
+        bool cacheShadowMaps) const noexcept {
+
+    // the layers are assigned in order every frame, so we need to check which light last
+    // rendered into it. Point lights have one shadow map per face, the directional light one
+    // per cascade.
+    size_t const lightIndex = shadowMap.getLightIndex();
+    size_t owner = lightData.elementAt<FScene::LIGHT_INSTANCE>(lightIndex).asValue();
+    utils::hash::combine(owner, uint8_t(shadowMap.getShadowType()));
+    utils::hash::combine(owner, shadowMap.isDirectionalShadow() ?
+            uint8_t(shadowMap.getShadowIndex()) : shadowMap.getFace());
+
+    LayerUpdate update{ LayerState::MISSING, 0, owner, false };
+    if (cacheShadowMaps) {
+        update.key = computeShadowMapKey(engine, view, shadowMap,
+                renderableData, range, visibilityMask, &update.cacheable);
+    }
+
+    CachedLayer const& layer = mCachedAtlas.layers[shadowMap.getLayer()];
+    if (layer.valid && layer.owner == owner) {
+        update.state = (update.cacheable && layer.cacheable && layer.key == update.key) ?
+                LayerState::UP_TO_DATE : LayerState::OUT_OF_DATE;
+    }
+    return update;
+}
+
+void ShadowMapManager::setLayerRendered(ShadowMap const& shadowMap,
+        LayerUpdate const& update) noexcept {
+    mCachedAtlas.layers[shadowMap.getLayer()] = {
+            .key = update.key,
+            .owner = update.owner,
+            .frame = mFrameCount,
+            .valid = true,
+            .cacheable = update.cacheable,
+            .shadowData = mShadowUb.edit().shadows[shadowMap.getShadowIndex()] };
+}
+
+void ShadowMapManager::setLayerKept(ShadowMap const& shadowMap, LayerState state) noexcept {
+    assert_invariant(state != LayerState::MISSING);
+    CachedLayer& layer = mCachedAtlas.layers[shadowMap.getLayer()];
+    if (state == LayerState::UP_TO_DATE) {
+        layer.frame = mFrameCount;
+    } else {
+        // the layer was rendered with another camera, it must be sampled with it
+        mShadowUb.edit().shadows[shadowMap.getShadowIndex()] = layer.shadowData;
+    }
+}
+
+float ShadowMapManager::getShadowMapPriority(ShadowMap const& shadowMap,
+        CameraInfo const& mainCameraInfo, FScene::LightSoa const& lightData) const noexcept {
+    // The fraction of the screen covered by the light's sphere of influence is roughly
+    // proportional to (radius / distance)^2, which is enough to order the lights.
+    float4 const positionRadius =
+            lightData.elementAt<FScene::POSITION_RADIUS>(shadowMap.getLightIndex());
+    float3 const v = (mainCameraInfo.view * float4{ positionRadius.xyz, 1.0f }).xyz;
+    float const r2 = positionRadius.w * positionRadius.w;
+    float const d2 = dot(v, v);
+    float const coverage = d2 > r2 ? r2 / d2 : 1.0f;
+    uint32_t const staleness = mFrameCount - mCachedAtlas.layers[shadowMap.getLayer()].frame;
+    return coverage * float(staleness);
+}
+
 ShadowMapManager::ShadowTechnique ShadowMapManager::updateCascadeShadowMaps(FEngine& engine,
         FView& view, CameraInfo cameraInfo, FScene::RenderableSoa& renderableData,
         FScene::LightSoa const& lightData, ShadowMap::SceneInfo sceneInfo) noexcept {
@@ -567,6 +855,21 @@ ShadowMapManager::ShadowTechnique ShadowMapManager::updateCascadeShadowMaps(FEng
         updateNearFarPlanes(&cameraInfo.cullingProjection, cameraInfo.zn, cameraInfo.zf);
     }
 
+    // Fit the cascades to the visible geometry, so that no texel is spent on the part of the
+    // frustum that's empty. The depth buffer is old and has a low resolution, so we leave some
+    // room for geometry that wasn't visible when it was rendered.
+    float2 const visibleDistanceRange = view.getVisibleDistanceRange(cameraInfo);
+    float const farthestVisibleDistance = visibleDistanceRange[1];
+    if (UTILS_UNLIKELY(farthestVisibleDistance > 0.0f)) {
+        constexpr float FARTHEST_VISIBLE_DISTANCE_MARGIN = 1.25f;
+        float const zf = std::max(2.0f * cameraInfo.zn,
+                farthestVisibleDistance * FARTHEST_VISIBLE_DISTANCE_MARGIN);
+        if (zf < cameraInfo.zf) {
+            cameraInfo.zf = zf;
+            updateNearFarPlanes(&cameraInfo.cullingProjection, cameraInfo.zn, cameraInfo.zf);
+        }
+    }
+
     const ShadowMap::ShadowMapInfo shadowMapInfo{
             .atlasDimension      = mTextureAtlasRequirements.size,
             .textureDimension    = uint16_t(options.mapSize),
@@ -603,7 +906,7 @@ ShadowMapManager::ShadowTechnique ShadowMapManager::updateCascadeShadowMaps(FEng
 
         if (hasVisibleShadows) {
             Frustum const& frustum = shadowMap.getCamera().getCullingFrustum();
-            FView::cullRenderables(engine.getJobSystem(), renderableData, frustum,
+            FView::cullRenderables(engine.getJobSystem(), *scene, frustum,
                     VISIBLE_DIR_SHADOW_RENDERABLE_BIT);
         }
     }
@@ -623,8 +926,19 @@ ShadowMapManager::ShadowTechnique ShadowMapManager::updateCascadeShadowMaps(FEng
             splitPercentages[i] = options.cascadeSplitPositions[i - 1];
         }
 
+        // The splits start at the nearest visible geometry rather than at the near plane, this
+        // matters most for the first cascades, which would otherwise cover mostly empty space.
+        // The culling above still uses the whole frustum, so that no caster is missed.
+        float splitNear = cameraInfo.zn;
+        float const nearestVisibleDistance = visibleDistanceRange[0];
+        if (UTILS_UNLIKELY(nearestVisibleDistance > 0.0f)) {
+            constexpr float NEAREST_VISIBLE_DISTANCE_MARGIN = 0.75f;
+            splitNear = std::clamp(nearestVisibleDistance * NEAREST_VISIBLE_DISTANCE_MARGIN,
+                    cameraInfo.zn, 0.5f * cameraInfo.zf);
+        }
+
         const CascadeSplits splits({
-                .near = -cameraInfo.zn,
+                .near = -splitNear,
                 .far = -cameraInfo.zf,
                 .cascadeCount = cascadeCount,
                 .splitPositions = splitPercentages
@@ -781,9 +1095,8 @@ void ShadowMapManager::prepareSpotShadowMap(ShadowMap& shadowMap, FEngine& engin
     }
 }
 
-void ShadowMapManager::cullSpotShadowMap(ShadowMap const& shadowMap, FEngine& engine, FView& view,
-        FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
-        FScene::LightSoa& lightData) noexcept {
+Frustum ShadowMapManager::getSpotShadowCullingFrustum(ShadowMap const& shadowMap,
+        FEngine& engine, FScene::LightSoa const& lightData) noexcept {
     auto& lcm = engine.getLightManager();
 
     const size_t lightIndex = shadowMap.getLightIndex();
@@ -801,7 +1114,13 @@ void ShadowMapManager::cullSpotShadowMap(ShadowMap const& shadowMap, FEngine& en
     const mat4f Mv = ShadowMap::getDirectionalLightViewMatrix(direction, { 0, 1, 0 }, position);
     const mat4f Mp = mat4f::perspective(outerConeAngle * f::RAD_TO_DEG * 2.0f, 1.0f, 0.01f, radius);
     const mat4f MpMv = math::highPrecisionMultiply(Mp, Mv);
-    const Frustum frustum(MpMv);
+    return Frustum(MpMv);
+}
+
+void ShadowMapManager::cullSpotShadowMap(ShadowMap const& shadowMap, FEngine& engine, FView& view,
+        FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
+        FScene::LightSoa& lightData) noexcept {
+    const Frustum frustum = getSpotShadowCullingFrustum(shadowMap, engine, lightData);
 
     // Cull shadow casters
     float3 const* worldAABBCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
@@ -826,6 +1145,186 @@ void ShadowMapManager::cullSpotShadowMap(ShadowMap const& shadowMap, FEngine& en
             range.size());
 }
 
+void ShadowMapManager::cullShadowCasters(std::vector<uint64_t>& masks,
+        FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+        float4 const* planes, size_t frustumCount) noexcept {
+    float3 const* worldAABBCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
+    float3 const* worldAABBExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
+    masks.resize(range.size());
+    Culler::intersects(masks.data(), planes, frustumCount,
+            worldAABBCenter + range.first,
+            worldAABBExtent + range.first,
+            range.size());
+}
+
+void ShadowMapManager::cullCascadeShadowMaps(FEngine const& engine, FView const& view,
+        FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range) noexcept {
+    // The near plane of a cascade is fitted to the casters, which are clamped to it when depth
+    // clamp is used, and its far plane only matters for receivers.
+    auto const cascades = getCascadedShadowMap();
+    std::array<float4, CONFIG_MAX_SHADOW_CASCADES * 6> planes;
+    for (size_t k = 0; k < cascades.size(); k++) {
+        Frustum const frustum = cascades[k].getCamera().getCullingFrustum();
+        float4* const p = planes.data() + k * 6;
+        std::copy_n(frustum.getNormalizedPlanes(), 6, p);
+        p[4] = p[5] = float4{ 0, 0, 0, -1 }; // always inside
+    }
+    cullShadowCasters(mCascadeCasterMasks, renderableData, range, planes.data(), cascades.size());
+
+    if (engine.debug.shadowmap.cull_casters_by_receivers) {
+        cullCascadeCastersByReceivers(view, renderableData, range, planes.data(), cascades.size());
+    }
+
+    // Fold in the visibility computed by FView::prepareVisibleRenderables(), which also accounts
+    // for layers and casters that are never culled.
+    FScene::VisibleMaskType const* visibleArray = renderableData.data<FScene::VISIBLE_MASK>();
+    auto const* visibility = renderableData.data<FScene::VISIBILITY_STATE>();
+    uint64_t* const masks = mCascadeCasterMasks.data();
+    for (size_t i = 0, c = range.size(); i < c; i++) {
+        bool const caster = visibleArray[range.first + i] & VISIBLE_DIR_SHADOW_RENDERABLE;
+        bool const culling = visibility[range.first + i].culling;
+        masks[i] = caster ? (culling ? masks[i] : ~uint64_t(0)) : 0;
+    }
+}
+
+void ShadowMapManager::cullCascadeCastersByReceivers(FView const& view,
+        FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+        float4 const* planes, size_t cascadeCount) noexcept {
+    // Each cascade gets a coarse grid over the light-space footprint of its receivers, where each
+    // cell holds the depth of the receiver farthest from the light. A caster is kept only if it
+    // overlaps a cell and is closer to the light than the farthest receiver of that cell.
+    // Light-space is looking down -z, so closer to the light means a larger z.
+    constexpr size_t GRID_SIZE = 32;
+
+    utils::Range<uint32_t> const receivers = view.getVisibleRenderables();
+    cullShadowCasters(mCascadeReceiverMasks, renderableData, receivers, planes, cascadeCount);
+
+    float3 const* worldAABBCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
+    float3 const* worldAABBExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
+    auto const* visibility = renderableData.data<FScene::VISIBILITY_STATE>();
+    uint64_t const* const receiverMasks = mCascadeReceiverMasks.data();
+    uint64_t* const casterMasks = mCascadeCasterMasks.data();
+
+    auto const cascades = getCascadedShadowMap();
+    std::array<float, GRID_SIZE * GRID_SIZE> farthest; // NOLINT(*-member-init)
+    for (size_t k = 0; k < cascadeCount; k++) {
+        mat4f const Mv{ cascades[k].getCamera().getViewMatrix() };
+        mat3f const M = Mv.upperLeft();
+        mat3f const absM{ abs(M[0]), abs(M[1]), abs(M[2]) };
+        auto const lightSpaceBounds = [&](size_t i) -> Aabb {
+            float3 const c = M * worldAABBCenter[i] + Mv[3].xyz;
+            float3 const e = absM * worldAABBExtent[i];
+            return { c - e, c + e };
+        };
+
+        uint64_t const bit = uint64_t(1) << k;
+
+        // note: the bounds can be flat, e.g. a ground plane seen from a light straight above
+        Aabb bounds;
+        bool hasReceivers = false;
+        for (size_t i = 0, c = receivers.size(); i < c; i++) {
+            size_t const j = receivers.first + i;
+            if ((receiverMasks[i] & bit) && visibility[j].receiveShadows) {
+                Aabb const r = lightSpaceBounds(j);
+                bounds.min = min(bounds.min, r.min);
+                bounds.max = max(bounds.max, r.max);
+                hasReceivers = true;
+            }
+        }
+
+        if (!hasReceivers) {
+            // nothing receives shadows from this cascade
+            for (size_t i = 0, c = range.size(); i < c; i++) {
+                if (visibility[range.first + i].culling) {
+                    casterMasks[i] &= ~bit;
+                }
+            }
+            continue;
+        }
+
+        float2 const origin = bounds.min.xy;
+        float2 const scale = float(GRID_SIZE) / max(bounds.max.xy - origin, float2{ 1e-6f });
+        auto const cells = [&](Aabb const& box) -> int4 {
+            float2 const lo = clamp((box.min.xy - origin) * scale, 0.0f, float(GRID_SIZE - 1));
+            float2 const hi = clamp((box.max.xy - origin) * scale, 0.0f, float(GRID_SIZE - 1));
+            return { int2(lo), int2(hi) };
+        };
+
+        farthest.fill(std::numeric_limits<float>::max());
+        for (size_t i = 0, c = receivers.size(); i < c; i++) {
+            size_t const j = receivers.first + i;
+            if ((receiverMasks[i] & bit) && visibility[j].receiveShadows) {
+                Aabb const r = lightSpaceBounds(j);
+                int4 const cell = cells(r);
+                for (int y = cell.y; y <= cell.w; y++) {
+                    for (int x = cell.x; x <= cell.z; x++) {
+                        float& f = farthest[y * GRID_SIZE + x];
+                        f = std::min(f, r.min.z);
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0, c = range.size(); i < c; i++) {
+            size_t const j = range.first + i;
+            // the bounds of casters that are never culled can't be trusted
+            if (!(casterMasks[i] & bit) || !visibility[j].culling) {
+                continue;
+            }
+            Aabb const r = lightSpaceBounds(j);
+            bool shadowsReceiver = false;
+            if (all(lessThanEqual(r.min.xy, bounds.max.xy)) &&
+                    all(greaterThanEqual(r.max.xy, bounds.min.xy))) {
+                int4 const cell = cells(r);
+                for (int y = cell.y; y <= cell.w && !shadowsReceiver; y++) {
+                    for (int x = cell.x; x <= cell.z && !shadowsReceiver; x++) {
+                        shadowsReceiver = farthest[y * GRID_SIZE + x] < r.max.z;
+                    }
+                }
+            }
+            if (!shadowsReceiver) {
+                casterMasks[i] &= ~bit;
+            }
+        }
+    }
+}
+
+void ShadowMapManager::updateSpotCasters(size_t bit, FView const& view,
+        FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range) const noexcept {
+    uint64_t const* const masks = mSpotCasterMasks.data();
+    FScene::VisibleMaskType* visibleArray = renderableData.data<FScene::VISIBLE_MASK>();
+    constexpr FScene::VisibleMaskType dyn = 1u << VISIBLE_DYN_SHADOW_RENDERABLE_BIT;
+    for (size_t i = 0, c = range.size(); i < c; i++) {
+        auto mask = visibleArray[range.first + i];
+        mask &= ~dyn;
+        mask |= ((masks[i] >> bit) & 1u) << VISIBLE_DYN_SHADOW_RENDERABLE_BIT;
+        visibleArray[range.first + i] = mask;
+    }
+
+    // update their visibility mask
+    uint8_t const* layers = renderableData.data<FScene::LAYERS>();
+    auto const* visibility = renderableData.data<FScene::VISIBILITY_STATE>();
+    updateSpotVisibilityMasks(
+            view.getVisibleLayers(),
+            layers + range.first,
+            visibility + range.first,
+            visibleArray + range.first,
+            range.size());
+}
+
+void ShadowMapManager::updateCascadeCasters(size_t cascade,
+        FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range) const noexcept {
+    uint64_t const* const masks = mCascadeCasterMasks.data();
+    FScene::VisibleMaskType* visibleArray = renderableData.data<FScene::VISIBLE_MASK>();
+    constexpr FScene::VisibleMaskType dir = VISIBLE_DIR_SHADOW_RENDERABLE;
+    for (size_t i = 0, c = range.size(); i < c; i++) {
+        auto mask = visibleArray[range.first + i];
+        mask &= ~dir;
+        mask |= ((masks[i] >> cascade) & 1u) << VISIBLE_DIR_SHADOW_RENDERABLE_BIT;
+        visibleArray[range.first + i] = mask;
+    }
+}
+
 void ShadowMapManager::preparePointShadowMap(ShadowMap& shadowMap,
         FEngine& engine, FView& view, CameraInfo const& mainCameraInfo,
         FScene::LightSoa& lightData) noexcept {
@@ -878,28 +1377,23 @@ void ShadowMapManager::cullPointShadowMap(ShadowMap const& shadowMap, FView& vie
     const uint8_t face = shadowMap.getFace();
     const size_t lightIndex = shadowMap.getLightIndex();
 
-    // compute the frustum for this light
-    // for spotlights, we cull shadow casters first because we already know the frustum,
-    // this will help us find better near/far plane later
-    const auto position = lightData.elementAt<FScene::POSITION_RADIUS>(lightIndex).xyz;
-    const auto radius = lightData.elementAt<FScene::POSITION_RADIUS>(lightIndex).w;
-
-    // compute shadow map frustum for culling
-    const mat4f Mv = ShadowMap::getPointLightViewMatrix(TextureCubemapFace(face), position);
-    const mat4f Mp = mat4f::perspective(90.0f, 1.0f, 0.01f, radius);
-    const Frustum frustum{ math::highPrecisionMultiply(Mp, Mv) };
+    // the six faces of a light are culled together the first time one of them is needed
+    PointShadowFaces const& faces = mPointShadowFaces;
+    if (faces.lightIndex != lightIndex ||
+            faces.range.first != range.first || faces.range.last != range.last) {
+        cullPointShadowMapFaces(lightIndex, renderableData, range, lightData);
+    }
 
     // Cull shadow casters
-    float3 const* worldAABBCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
-    float3 const* worldAABBExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
+    uint8_t const* const masks = faces.masks.data();
     FScene::VisibleMaskType* visibleArray = renderableData.data<FScene::VISIBLE_MASK>();
-    Culler::intersects(
-            visibleArray + range.first,
-            frustum,
-            worldAABBCenter + range.first,
-            worldAABBExtent + range.first,
-            range.size(),
-            VISIBLE_DYN_SHADOW_RENDERABLE_BIT);
+    constexpr FScene::VisibleMaskType bit = 1u << VISIBLE_DYN_SHADOW_RENDERABLE_BIT;
+    for (size_t i = 0, c = range.size(); i < c; i++) {
+        auto mask = visibleArray[range.first + i];
+        mask &= ~bit;
+        mask |= ((masks[i] >> face) & 1u) << VISIBLE_DYN_SHADOW_RENDERABLE_BIT;
+        visibleArray[range.first + i] = mask;
+    }
 
     // update their visibility mask
     uint8_t const* layers = renderableData.data<FScene::LAYERS>();
@@ -912,6 +1406,46 @@ void ShadowMapManager::cullPointShadowMap(ShadowMap const& shadowMap, FView& vie
             range.size());
 }
 
+void ShadowMapManager::cullPointShadowMapFaces(size_t lightIndex,
+        FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+        FScene::LightSoa const& lightData) noexcept {
+
+    const auto position = lightData.elementAt<FScene::POSITION_RADIUS>(lightIndex).xyz;
+    const auto radius = lightData.elementAt<FScene::POSITION_RADIUS>(lightIndex).w;
+
+    PointShadowFaces& faces = mPointShadowFaces;
+    faces.lightIndex = lightIndex;
+    faces.range = range;
+    faces.masks.resize(range.size());
+
+    // The frustum of the face along +x is the set of points (relative to the light) such that
+    // |y| <= x, |z| <= x and x <= radius. A box intersects it iff the smallest x allowed within
+    // the box, max(min.x, d.y, d.z) -- where d is the distance of the box to the light along each
+    // axis -- is not larger than the largest one, min(max.x, radius). The other faces are
+    // symmetrical. This is exact, so it culls at least as well as testing the six frustums.
+    float3 const* worldAABBCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
+    float3 const* worldAABBExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
+    for (size_t i = 0, c = range.size(); i < c; i++) {
+        float3 const center = worldAABBCenter[range.first + i] - position;
+        float3 const extent = worldAABBExtent[range.first + i];
+        float3 const lo = center - extent;
+        float3 const hi = center + extent;
+        float3 const d = max(float3{ 0.0f }, max(lo, -hi));
+        uint8_t mask = 0;
+        #pragma clang loop unroll(full)
+        for (size_t axis = 0; axis < 3; axis++) {
+            float const u = d[(axis + 1) % 3];
+            float const v = d[(axis + 2) % 3];
+            float const m = std::max(u, v);
+            bool const positive = std::max(lo[axis], m) <= std::min(hi[axis], radius);
+            bool const negative = std::max(-hi[axis], m) <= std::min(-lo[axis], radius);
+            mask |= uint8_t(positive) << (axis * 2);
+            mask |= uint8_t(negative) << (axis * 2 + 1);
+        }
+        faces.masks[i] = mask;
+    }
+}
+
 ShadowMapManager::ShadowTechnique ShadowMapManager::updateSpotShadowMaps(FEngine& engine,
         FScene::LightSoa const& lightData) noexcept {
 
@@ -49,6 +49,7 @@
 #include <math/vec4.h>
 
 #include <array>
+#include <limits>
 #include <memory>
 #include <new>
 #include <type_traits>
@@ -169,20 +170,99 @@ private:
             FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
             FScene::LightSoa& lightData) noexcept;
 
+    // Returns the frustum of a spotlight, used to cull its shadow casters.
+    static Frustum getSpotShadowCullingFrustum(ShadowMap const& map,
+            FEngine& engine, FScene::LightSoa const& lightData) noexcept;
+
+    // Tests the shadow casters in `range` against several frustums in a single sweep, bit k of
+    // masks[i] is set if the i-th caster of the range intersects the k-th frustum.
+    static void cullShadowCasters(std::vector<uint64_t>& masks,
+            FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+            math::float4 const* planes, size_t frustumCount) noexcept;
+
+    // Culls the casters of all the cascades, leaving the result in mCascadeCasterMasks. Only the
+    // side planes of the cascades are used, so that casters in front of the near plane are kept.
+    void cullCascadeShadowMaps(FEngine const& engine, FView const& view,
+            FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range) noexcept;
+
+    // Removes from mCascadeCasterMasks the casters that can't shadow any of the visible receivers
+    // of a cascade, i.e. whose extrusion along the light direction misses all of them.
+    void cullCascadeCastersByReceivers(FView const& view,
+            FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+            math::float4 const* planes, size_t cascadeCount) noexcept;
+
+    // Sets the visibility of the shadow casters in `range` from bit `bit` of the masks computed
+    // for all the spot or all the cascade shadow maps at once.
+    void updateSpotCasters(size_t bit, FView const& view,
+            FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range) const noexcept;
+    void updateCascadeCasters(size_t cascade,
+            FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range) const noexcept;
+
     void preparePointShadowMap(ShadowMap& map,
             FEngine& engine, FView& view, CameraInfo const& mainCameraInfo,
             FScene::LightSoa& lightData) noexcept;
 
-    static void cullPointShadowMap(ShadowMap const& shadowMap, FView& view,
+    void cullPointShadowMap(ShadowMap const& shadowMap, FView& view,
             FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
             FScene::LightSoa& lightData) noexcept;
 
+    // Computes, in a single sweep over the shadow casters, which of the six faces of a point
+    // light each caster intersects. The result is used by cullPointShadowMap() for all faces.
+    void cullPointShadowMapFaces(size_t lightIndex,
+            FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range,
+            FScene::LightSoa const& lightData) noexcept;
+
     static void updateSpotVisibilityMasks(
             uint8_t visibleLayers,
             uint8_t const* UTILS_RESTRICT layers,
             FRenderableManager::Visibility const* UTILS_RESTRICT visibility,
             Culler::result_type* UTILS_RESTRICT visibleMask, size_t count);
 
+    // Returns a key identifying the content of a shadow map: its camera and options, and the
+    // state of the shadow casters selected by `visibilityMask` in `range`. The key can't be
+    // trusted across frames if one of these casters can change without its transform changing,
+    // in which case outCacheable is set to false.
+    static size_t computeShadowMapKey(FEngine const& engine, FView const& view,
+            ShadowMap const& shadowMap, FScene::RenderableSoa const& renderableData,
+            utils::Range<uint32_t> range, FScene::VisibleMaskType visibilityMask,
+            bool* outCacheable) noexcept;
+
+    void updateCachedAtlas(FEngine& engine, FView const& view) noexcept;
+
+    void destroyCachedAtlas(FEngine& engine) noexcept;
+
+    // How the layer of the cached atlas assigned to a shadow map relates to it this frame
+    enum class LayerState : uint8_t {
+        MISSING,        // the layer doesn't hold this shadow map, it must be rendered
+        OUT_OF_DATE,    // the layer holds a previous version of this shadow map
+        UP_TO_DATE,     // the layer holds this shadow map as it would be rendered now
+    };
+
+    struct LayerUpdate {
+        LayerState state;
+        size_t key;         // see computeShadowMapKey()
+        size_t owner;       // identifies the light and the face or cascade
+        bool cacheable;
+    };
+
+    LayerUpdate getLayerUpdate(FEngine const& engine, FView const& view,
+            ShadowMap const& shadowMap, FScene::RenderableSoa const& renderableData,
+            FScene::LightSoa const& lightData, utils::Range<uint32_t> range,
+            FScene::VisibleMaskType visibilityMask, bool cacheShadowMaps) const noexcept;
+
+    // Records that the shadow map is rendered into its layer this frame. Must be called after
+    // its shadow parameters are set in the UBO.
+    void setLayerRendered(ShadowMap const& shadowMap, LayerUpdate const& update) noexcept;
+
+    // Records that the shadow map is not rendered this frame and samples the content of its
+    // layer instead, along with the shadow parameters it was rendered with if it's out-of-date.
+    void setLayerKept(ShadowMap const& shadowMap, LayerState state) noexcept;
+
+    // Relative priority for rendering an out-of-date spot or point shadow map, based on how much
+    // of the screen its light covers and on how long ago the shadow map was rendered.
+    float getShadowMapPriority(ShadowMap const& shadowMap, CameraInfo const& mainCameraInfo,
+            FScene::LightSoa const& lightData) const noexcept;
+
     class CascadeSplits {
     public:
         constexpr static size_t SPLIT_COUNT = CONFIG_MAX_SHADOW_CASCADES + 1;
@@ -222,8 +302,43 @@ private:
 
     ShadowMappingUniforms mShadowMappingUniforms = {};
 
+    // Shadow map atlas used when shadow maps are cached or time-sliced. Unlike the atlas
+    // allocated by the FrameGraph, it is imported every frame, so that its layers keep their
+    // content.
+    struct CachedLayer {
+        size_t key = 0;             // content of the layer, see computeShadowMapKey()
+        size_t owner = 0;           // shadow map the layer was rendered for
+        uint32_t frame = 0;         // last frame the content of the layer was current
+        bool valid = false;         // whether the layer was rendered since the atlas was created
+        bool cacheable = false;     // whether `key` can be trusted
+        ShadowUib::ShadowData shadowData{};     // the parameters the layer was rendered with
+    };
+    struct CachedAtlas {
+        backend::Handle<backend::HwTexture> texture;
+        FrameGraphTexture::Descriptor desc;
+        backend::TextureUsage usage = backend::TextureUsage::NONE;
+        std::array<CachedLayer, CONFIG_MAX_SHADOW_LAYERS> layers;
+    } mCachedAtlas;
+    uint32_t mFrameCount = 0;
+
     ShadowMap::SceneInfo mSceneInfo;
 
+    // Per face visibility of the shadow casters of the last point light culled, bit `face` is
+    // set if the caster intersects that face's frustum. It's invalidated before each culling
+    // sweep, i.e. at least once per frame.
+    struct PointShadowFaces {
+        static constexpr size_t INVALID = std::numeric_limits<size_t>::max();
+        size_t lightIndex = INVALID;
+        utils::Range<uint32_t> range{};
+        std::vector<uint8_t> masks;
+    } mPointShadowFaces;
+
+    // Visibility of the shadow casters from each spot shadow map and each cascade rendered this
+    // frame, computed in a single sweep per kind of light before the shadow passes are built.
+    std::vector<uint64_t> mSpotCasterMasks;
+    std::vector<uint64_t> mCascadeCasterMasks;
+    std::vector<uint64_t> mCascadeReceiverMasks;
+
     // Inline storage for all our ShadowMap objects, we can't easily use a std::array<> directly.
     // Because ShadowMap doesn't have a default ctor, and we avoid out-of-line allocations.
     // Each ShadowMap is currently 40 bytes (total of 2.5KB for 64 shadow maps)
@@ -74,6 +74,10 @@ void Texture::generateMipmaps(Engine& engine) const noexcept {
     downcast(this)->generateMipmaps(downcast(engine));
 }
 
+void Texture::setMinMaxLevels(Engine& engine, size_t minLevel, size_t maxLevel) {
+    downcast(this)->setMinMaxLevels(downcast(engine), minLevel, maxLevel);
+}
+
 bool Texture::isTextureFormatSupported(Engine& engine, InternalFormat format) noexcept {
     return FTexture::isTextureFormatSupported(downcast(engine), format);
 }
@@ -96,4 +100,11 @@ void Texture::generatePrefilterMipmap(Engine& engine, Texture::PixelBufferDescri
     downcast(this)->generatePrefilterMipmap(downcast(engine), std::move(buffer), faceOffsets, options);
 }
 
+void Texture::generatePrefilterMipmapAsync(Engine& engine, Texture::PixelBufferDescriptor&& buffer,
+        const Texture::FaceOffsets& faceOffsets, PrefilterOptions const* options,
+        backend::CallbackHandler* handler, utils::Invocable<void(Texture*)>&& callback) {
+    downcast(this)->generatePrefilterMipmapAsync(downcast(engine), std::move(buffer), faceOffsets,
+            options, handler, std::move(callback));
+}
+
 } // namespace filament
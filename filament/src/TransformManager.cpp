@@ -58,6 +58,11 @@ void TransformManager::create(Entity entity, Instance parent) {
     downcast(this)->create(entity, parent, mat4f{});
 }
 
+void TransformManager::create(Entity const* entities, size_t count, Instance parent,
+        const mat4f* localTransforms) {
+    downcast(this)->create(entities, count, parent, localTransforms);
+}
+
 void TransformManager::destroy(Entity e) noexcept {
     downcast(this)->destroy(e);
 }
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "UniformHeap.h"
+
+#include <backend/DriverEnums.h>
+#include <backend/BufferDescriptor.h>
+
+#include "private/backend/DriverApi.h"
+
+#include <utils/debug.h>
+
+#include <algorithm>
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace filament {
+
+using namespace backend;
+
+UniformHeap::~UniformHeap() noexcept {
+    assert_invariant(mPages.empty());
+}
+
+void UniformHeap::init(size_t size, bool enabled) noexcept {
+    assert_invariant(mPages.empty());
+    mSize = size;
+    mSlotSize = align(size);
+    mSlotsPerPage = uint32_t(std::max(size_t(1), PAGE_SIZE / std::max(size_t(1), mSlotSize)));
+    mEnabled = enabled && size;
+}
+
+void UniformHeap::terminate(DriverApi& driver) {
+    for (Page& page : mPages) {
+        driver.destroyBufferObject(page.boh);
+        ::free(page.shadow);
+    }
+    mPages.clear();
+    mFreeSlots.clear();
+}
+
+UniformHeap::Slot UniformHeap::allocate(DriverApi& driver) {
+    if (UTILS_UNLIKELY(!mEnabled)) {
+        return {};
+    }
+
+    if (mFreeSlots.empty()) {
+        size_t const size = mSlotSize * mSlotsPerPage;
+        Page page;
+        page.boh = driver.createBufferObject(size,
+                BufferObjectBinding::UNIFORM, BufferUsage::DYNAMIC);
+        driver.setDebugTag(page.boh.getId(), "UniformHeap");
+        page.shadow = static_cast<char*>(calloc(1, size));
+        mPages.push_back(page);
+
+        // hand out the slots of the new page in order
+        uint32_t const first = uint32_t(mPages.size() - 1) * mSlotsPerPage;
+        for (uint32_t i = mSlotsPerPage; i > 0; i--) {
+            mFreeSlots.push_back(first + i - 1);
+        }
+    }
+
+    uint32_t const index = mFreeSlots.back();
+    mFreeSlots.pop_back();
+    return { mPages[index / mSlotsPerPage].boh,
+             uint32_t((index % mSlotsPerPage) * mSlotSize), index };
+}
+
+void UniformHeap::free(Slot const& slot) noexcept {
+    if (slot.boh) {
+        mFreeSlots.push_back(slot.index);
+    }
+}
+
+void UniformHeap::write(DriverApi& driver, Slot const& slot, void const* data) {
+    assert_invariant(slot.boh);
+    Page& page = mPages[slot.index / mSlotsPerPage];
+    uint32_t const i = slot.index % mSlotsPerPage;
+    memcpy(page.shadow + slot.offset, data, mSize);
+    if (mBatching) {
+        if (page.dirtyBegin >= page.dirtyEnd) {
+            page.dirtyBegin = i;
+            page.dirtyEnd = i + 1;
+        } else {
+            page.dirtyBegin = std::min(page.dirtyBegin, i);
+            page.dirtyEnd = std::max(page.dirtyEnd, i + 1);
+        }
+    } else {
+        upload(driver, page, i, i + 1);
+    }
+}
+
+void UniformHeap::flush(DriverApi& driver) {
+    for (Page& page : mPages) {
+        if (page.dirtyBegin < page.dirtyEnd) {
+            upload(driver, page, page.dirtyBegin, page.dirtyEnd);
+        }
+        page.dirtyBegin = page.dirtyEnd = 0;
+    }
+    mBatching = false;
+}
+
+void UniformHeap::upload(DriverApi& driver, Page const& page, uint32_t first, uint32_t last) {
+    // the padding of the last slot doesn't need to be uploaded
+    size_t const offset = first * mSlotSize;
+    size_t const size = (last - first - 1) * mSlotSize + mSize;
+    void* const p = driver.allocate(size);
+    memcpy(p, page.shadow + offset, size);
+    driver.updateBufferObject(page.boh, { p, size }, uint32_t(offset));
+}
+
+} // namespace filament
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_UNIFORMHEAP_H
+#define TNT_FILAMENT_UNIFORMHEAP_H
+
+#include <backend/DriverApiForward.h>
+#include <backend/Handle.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * UniformHeap holds the uniforms of all the instances of a material. Each instance gets a slot in
+ * one of the heap's pages, a uniform buffer object that is bound with bindBufferRange(), so that
+ * consecutive draws with instances of the same material usually share a buffer.
+ *
+ * A slot is only written when the instance's uniforms change. Between beginBatch() and flush(),
+ * writes are kept in a copy of each page and uploaded with one update per page, covering the
+ * range of slots that changed, afterwards each write is uploaded immediately since it may be used
+ * by the next draw.
+ */
+class UniformHeap {
+public:
+    // offset alignment of the slots, this is the largest value allowed by Vulkan and GL
+    static constexpr uint32_t ALIGNMENT = 256;
+
+    // size of the pages, unless a single slot is larger
+    static constexpr size_t PAGE_SIZE = 16 * 1024;
+
+    struct Slot {
+        backend::Handle<backend::HwBufferObject> boh;
+        uint32_t offset = 0;
+        uint32_t index = 0;
+    };
+
+    UniformHeap() noexcept = default;
+    UniformHeap(UniformHeap const& rhs) = delete;
+    UniformHeap& operator=(UniformHeap const& rhs) = delete;
+    ~UniformHeap() noexcept;
+
+    // `size` is the size of the material's uniform block. When the heap is disabled allocate()
+    // always fails, this is used when bindBufferRange() can't be used.
+    void init(size_t size, bool enabled) noexcept;
+
+    void terminate(backend::DriverApi& driver);
+
+    // Returns a slot for an instance, its buffer is null if the heap is disabled.
+    Slot allocate(backend::DriverApi& driver);
+
+    void free(Slot const& slot) noexcept;
+
+    // Copies the uniforms of an instance in its slot.
+    void write(backend::DriverApi& driver, Slot const& slot, void const* data);
+
+    void beginBatch() noexcept { mBatching = true; }
+
+    // Uploads the slots written since beginBatch().
+    void flush(backend::DriverApi& driver);
+
+    static constexpr size_t align(size_t size) noexcept {
+        return (size + ALIGNMENT - 1) & ~size_t(ALIGNMENT - 1);
+    }
+
+private:
+    struct Page {
+        backend::Handle<backend::HwBufferObject> boh;
+        char* shadow = nullptr;
+        // range of slots written since beginBatch(), empty when dirtyBegin >= dirtyEnd
+        uint32_t dirtyBegin = 0;
+        uint32_t dirtyEnd = 0;
+    };
+
+    void upload(backend::DriverApi& driver, Page const& page, uint32_t first, uint32_t last);
+
+    std::vector<Page> mPages;
+    std::vector<uint32_t> mFreeSlots;
+    size_t mSize = 0;
+    size_t mSlotSize = 0;
+    uint32_t mSlotsPerPage = 0;
+    bool mEnabled = false;
+    bool mBatching = false;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_UNIFORMHEAP_H
@@ -41,6 +41,10 @@ Camera& View::getCamera() noexcept {
     return downcast(this)->getCameraUser();
 }
 
+void View::setCameraLateLatchCallback(CameraLateLatchCallback&& callback) noexcept {
+    downcast(this)->setCameraLateLatchCallback(std::move(callback));
+}
+
 void View::setViewport(filament::Viewport const& viewport) noexcept {
     downcast(this)->setViewport(viewport);
 }
@@ -57,6 +61,42 @@ bool View::isFrustumCullingEnabled() const noexcept {
     return downcast(this)->isFrustumCullingEnabled();
 }
 
+void View::setOcclusionCullingEnabled(bool enabled) noexcept {
+    downcast(this)->setOcclusionCullingEnabled(enabled);
+}
+
+bool View::isOcclusionCullingEnabled() const noexcept {
+    return downcast(this)->isOcclusionCullingEnabled();
+}
+
+void View::setShadowDepthFittingEnabled(bool enabled) noexcept {
+    downcast(this)->setShadowDepthFittingEnabled(enabled);
+}
+
+bool View::isShadowDepthFittingEnabled() const noexcept {
+    return downcast(this)->isShadowDepthFittingEnabled();
+}
+
+size_t View::getOcclusionCulledRenderableCount() const noexcept {
+    return downcast(this)->getOcclusionCulledRenderableCount();
+}
+
+size_t View::getPeakTransientMemorySize() const noexcept {
+    return downcast(this)->getPeakTransientMemorySize();
+}
+
+size_t View::getTotalTransientMemorySize() const noexcept {
+    return downcast(this)->getTotalTransientMemorySize();
+}
+
+void View::setOrderIndependentTransparencyEnabled(bool enabled) noexcept {
+    downcast(this)->setOrderIndependentTransparencyEnabled(enabled);
+}
+
+bool View::isOrderIndependentTransparencyEnabled() const noexcept {
+    return downcast(this)->isOrderIndependentTransparencyEnabled();
+}
+
 void View::setDebugCamera(Camera* camera) noexcept {
     downcast(this)->setViewingCamera(downcast(camera));
 }
@@ -185,6 +225,14 @@ bool View::isFrontFaceWindingInverted() const noexcept {
     return downcast(this)->isFrontFaceWindingInverted();
 }
 
+void View::setShadingRate(ShadingRate rate) noexcept {
+    downcast(this)->setShadingRate(rate);
+}
+
+View::ShadingRate View::getShadingRate() const noexcept {
+    return downcast(this)->getShadingRate();
+}
+
 void View::setDynamicLightingOptions(float zLightNear, float zLightFar) noexcept {
     downcast(this)->setDynamicLightingOptions(zLightNear, zLightFar);
 }
@@ -261,6 +309,14 @@ View::VignetteOptions View::getVignetteOptions() const noexcept {
     return downcast(this)->getVignetteOptions();
 }
 
+void View::setAutoExposureOptions(AutoExposureOptions options) noexcept {
+    downcast(this)->setAutoExposureOptions(options);
+}
+
+View::AutoExposureOptions View::getAutoExposureOptions() const noexcept {
+    return downcast(this)->getAutoExposureOptions();
+}
+
 void View::setBlendMode(BlendMode blendMode) noexcept {
     downcast(this)->setBlendMode(blendMode);
 }
@@ -277,6 +333,30 @@ bool View::isShadowingEnabled() const noexcept {
     return downcast(this)->isShadowingEnabled();
 }
 
+void View::setShadowMapCachingEnabled(bool enabled) noexcept {
+    downcast(this)->setShadowMapCachingEnabled(enabled);
+}
+
+bool View::isShadowMapCachingEnabled() const noexcept {
+    return downcast(this)->isShadowMapCachingEnabled();
+}
+
+void View::setShadowMapUpdateBudget(uint8_t count) noexcept {
+    downcast(this)->setShadowMapUpdateBudget(count);
+}
+
+uint8_t View::getShadowMapUpdateBudget() const noexcept {
+    return downcast(this)->getShadowMapUpdateBudget();
+}
+
+void View::setFarCascadeUpdateInterval(uint8_t frames) noexcept {
+    downcast(this)->setFarCascadeUpdateInterval(frames);
+}
+
+uint8_t View::getFarCascadeUpdateInterval() const noexcept {
+    return downcast(this)->getFarCascadeUpdateInterval();
+}
+
 void View::setScreenSpaceRefractionEnabled(bool enabled) noexcept {
     downcast(this)->setScreenSpaceRefractionEnabled(enabled);
 }
@@ -306,6 +386,22 @@ View::PickingQuery& View::pick(uint32_t x, uint32_t y, backend::CallbackHandler*
     return downcast(this)->pick(x, y, handler, callback);
 }
 
+View::PickingQuery& View::pick(math::uint2 const* coords, size_t count,
+        backend::CallbackHandler* handler,
+        View::MultiPickingQueryResultCallback callback) noexcept {
+    return downcast(this)->pick(coords, count, handler, callback);
+}
+
+View::PickingQuery& View::pickRect(uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+        backend::CallbackHandler* handler,
+        View::MultiPickingQueryResultCallback callback) noexcept {
+    return downcast(this)->pickRect(x, y, width, height, handler, callback);
+}
+
+View::PickingQueryResult View::pickBoundingBoxes(uint32_t x, uint32_t y) const noexcept {
+    return downcast(this)->pickBoundingBoxes(x, y);
+}
+
 void View::setMaterialGlobal(uint32_t index, math::float4 const& value) {
     downcast(this)->setMaterialGlobal(index, value);
 }
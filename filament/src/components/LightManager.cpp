@@ -175,6 +175,7 @@ void FLightManager::create(const FLightManager::Builder& builder, utils::Entity
     }
     Instance const i = manager.addComponent(entity);
     assert_invariant(i);
+    mComponentsVersion++;
 
     if (i) {
         // This needs to happen before we call the set() methods below
@@ -210,7 +211,11 @@ void FLightManager::destroy(utils::Entity e) noexcept {
     Instance const i = getInstance(e);
     if (i) {
         auto& manager = mManager;
+        if (getShadowOptions(i).screenSpaceContactShadows) {
+            mContactShadowsLightCount--;
+        }
         manager.removeComponent(e);
+        mComponentsVersion++;
     }
 }
 
@@ -225,6 +230,7 @@ void FLightManager::terminate() noexcept {
             Instance const ci = manager.end() - 1;
             manager.removeComponent(manager.getEntity(ci));
         }
+        mContactShadowsLightCount = 0;
     }
 }
 void FLightManager::gc(utils::EntityManager& em) noexcept {
@@ -234,7 +240,13 @@ void FLightManager::gc(utils::EntityManager& em) noexcept {
 }
 
 void FLightManager::setShadowOptions(Instance i, ShadowOptions const& options) noexcept {
+    mChangeCount++;
+    if (UTILS_UNLIKELY(!i)) {
+        return;
+    }
     ShadowParams& params = mManager[i].shadowParams;
+    mContactShadowsLightCount += uint32_t(options.screenSpaceContactShadows) -
+            uint32_t(params.options.screenSpaceContactShadows);
     params.options = options;
     params.options.mapSize = clamp(options.mapSize, 8u, 2048u);
     params.options.shadowCascades = clamp<uint8_t>(options.shadowCascades, 1, CONFIG_MAX_SHADOW_CASCADES);
@@ -247,6 +259,7 @@ void FLightManager::setShadowOptions(Instance i, ShadowOptions const& options) n
 }
 
 void FLightManager::setLightChannel(Instance i, unsigned int channel, bool enable) noexcept {
+    mChangeCount++;
     if (i) {
         if (channel < 8) {
             auto& manager = mManager;
@@ -269,6 +282,7 @@ bool FLightManager::getLightChannel(Instance i, unsigned int channel) const noex
 }
 
 void FLightManager::setLocalPosition(Instance i, const float3& position) noexcept {
+    mChangeCount++;
     if (i) {
         auto& manager = mManager;
         manager[i].position = position;
@@ -276,6 +290,7 @@ void FLightManager::setLocalPosition(Instance i, const float3& position) noexcep
 }
 
 void FLightManager::setLocalDirection(Instance i, float3 direction) noexcept {
+    mChangeCount++;
     if (i) {
         auto& manager = mManager;
         manager[i].direction = direction;
@@ -283,6 +298,7 @@ void FLightManager::setLocalDirection(Instance i, float3 direction) noexcept {
 }
 
 void FLightManager::setColor(Instance i, const LinearColor& color) noexcept {
+    mChangeCount++;
     if (i) {
         auto& manager = mManager;
         manager[i].color = color;
@@ -290,6 +306,7 @@ void FLightManager::setColor(Instance i, const LinearColor& color) noexcept {
 }
 
 void FLightManager::setIntensity(Instance i, float intensity, IntensityUnit unit) noexcept {
+    mChangeCount++;
     auto& manager = mManager;
     if (i) {
         Type const type = getLightType(i).type;
@@ -345,6 +362,7 @@ void FLightManager::setIntensity(Instance i, float intensity, IntensityUnit unit
 }
 
 void FLightManager::setFalloff(Instance i, float falloff) noexcept {
+    mChangeCount++;
     auto& manager = mManager;
     if (i && !isDirectionalLight(i)) {
         float const sqFalloff = falloff * falloff;
@@ -355,6 +373,7 @@ void FLightManager::setFalloff(Instance i, float falloff) noexcept {
 }
 
 void FLightManager::setSpotLightCone(Instance i, float inner, float outer) noexcept {
+    mChangeCount++;
     auto& manager = mManager;
     if (i && isSpotLight(i)) {
         // clamp the inner/outer angles to [0.5 degrees, 90 degrees]
@@ -388,6 +407,7 @@ void FLightManager::setSpotLightCone(Instance i, float inner, float outer) noexc
 }
 
 void FLightManager::setSunAngularRadius(Instance i, float angularRadius) noexcept {
+    mChangeCount++;
     if (i && isSunLight(i)) {
         angularRadius = clamp(angularRadius, 0.25f, 20.0f);
         mManager[i].sunAngularRadius = angularRadius * f::DEG_TO_RAD;
@@ -395,18 +415,21 @@ void FLightManager::setSunAngularRadius(Instance i, float angularRadius) noexcep
 }
 
 void FLightManager::setSunHaloSize(Instance i, float haloSize) noexcept {
+    mChangeCount++;
     if (i && isSunLight(i)) {
         mManager[i].sunHaloSize = haloSize;
     }
 }
 
 void FLightManager::setSunHaloFalloff(Instance i, float haloFalloff) noexcept {
+    mChangeCount++;
     if (i && isSunLight(i)) {
         mManager[i].sunHaloFalloff = haloFalloff;
     }
 }
 
 void FLightManager::setShadowCaster(Instance i, bool shadowCaster) noexcept {
+    mChangeCount++;
     if (i) {
         LightType& lightType = mManager[i].lightType;
         lightType.shadowCaster = shadowCaster;
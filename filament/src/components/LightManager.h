@@ -66,6 +66,12 @@ public:
         return mManager.empty();
     }
 
+    // changes whenever components are created or destroyed, which can reassign instances
+    uint32_t getComponentsVersion() const noexcept { return mComponentsVersion; }
+
+    // changes whenever the parameters of a light are set
+    uint32_t getChangeCount() const noexcept { return mChangeCount; }
+
     utils::Entity getEntity(Instance i) const noexcept {
         return mManager.getEntity(i);
     }
@@ -240,6 +246,11 @@ public:
 
     void setShadowOptions(Instance i, ShadowOptions const& options) noexcept;
 
+    // number of lights with ShadowOptions::screenSpaceContactShadows set, across all scenes.
+    // This is kept up to date as lights change, so that scenes can skip looking at their
+    // lights when it's zero.
+    uint32_t getContactShadowsLightCount() const noexcept { return mContactShadowsLightCount; }
+
 private:
     friend class FScene;
 
@@ -309,6 +320,9 @@ private:
     };
 
     Sim mManager;
+    uint32_t mComponentsVersion = 0;
+    uint32_t mChangeCount = 0;
+    uint32_t mContactShadowsLightCount = 0;
     FEngine& mEngine;
 };
 
@@ -83,6 +83,7 @@ struct RenderableManager::BuilderDetails {
     bool mScreenSpaceContactShadows : 1;
     bool mSkinningBufferMode : 1;
     bool mFogEnabled : 1;
+    bool mDequantizePositions : 1;
     RenderableManager::Builder::GeometryType mGeometryType : 2;
     size_t mSkinningBoneCount = 0;
     size_t mMorphTargetCount = 0;
@@ -94,6 +95,11 @@ struct RenderableManager::BuilderDetails {
     uint32_t mSkinningBufferOffset = 0;
     utils::FixedCapacityVector<math::float2> mBoneIndicesAndWeights;
     size_t mBoneIndicesAndWeightsCount = 0;
+    size_t mLevelPrimitiveCounts[RenderableManager::Builder::LEVEL_OF_DETAIL_COUNT_MAX] = {};
+    float mLevelScreenSizes[RenderableManager::Builder::LEVEL_OF_DETAIL_COUNT_MAX] = {};
+    float mLevelHysteresis = 0.1f;
+    uint8_t mLevelCount = 0;
+    FRenderableManager::PositionDequantization mPositionDequantization = { 1.0f, 0.0f };
 
     // bone indices and weights defined for primitive index
     std::unordered_map<size_t, utils::FixedCapacityVector<
@@ -102,7 +108,7 @@ struct RenderableManager::BuilderDetails {
     explicit BuilderDetails(size_t count)
             : mEntries(count), mCulling(true), mCastShadows(false),
               mReceiveShadows(true), mScreenSpaceContactShadows(false),
-              mSkinningBufferMode(false), mFogEnabled(true),
+              mSkinningBufferMode(false), mFogEnabled(true), mDequantizePositions(false),
               mGeometryType(RenderableManager::Builder::GeometryType::DYNAMIC),
               mBonePairs() {
     }
@@ -269,6 +275,29 @@ RenderableManager::Builder& RenderableManager::Builder::fog(bool enabled) noexce
     return *this;
 }
 
+RenderableManager::Builder& RenderableManager::Builder::positionDequantization(
+        float3 scale, float3 offset) noexcept {
+    mImpl->mDequantizePositions = true;
+    mImpl->mPositionDequantization = { scale, offset };
+    return *this;
+}
+
+RenderableManager::Builder& RenderableManager::Builder::levelOfDetail(uint8_t level,
+        size_t primitiveCount, float screenSize) noexcept {
+    if (level < LEVEL_OF_DETAIL_COUNT_MAX) {
+        mImpl->mLevelPrimitiveCounts[level] = primitiveCount;
+        mImpl->mLevelScreenSizes[level] = screenSize;
+        mImpl->mLevelCount = std::max(mImpl->mLevelCount, uint8_t(level + 1));
+    }
+    return *this;
+}
+
+RenderableManager::Builder& RenderableManager::Builder::levelOfDetailHysteresis(
+        float hysteresis) noexcept {
+    mImpl->mLevelHysteresis = clamp(hysteresis, 0.0f, 1.0f);
+    return *this;
+}
+
 RenderableManager::Builder& RenderableManager::Builder::morphing(size_t targetCount) noexcept {
     mImpl->mMorphTargetCount = targetCount;
     return *this;
@@ -431,6 +460,18 @@ void RenderableManager::BuilderDetails::processBoneIndicesAndWights(Engine& engi
 }
 
 RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& engine, Entity entity) {
+    return build(engine, &entity, 1);
+}
+
+RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& engine,
+        Entity const* entities, size_t count) {
+    if (UTILS_UNLIKELY(count == 0)) {
+        return Success;
+    }
+
+    // all the renderables are identical, so we only need to validate the builder once, errors
+    // are reported on the first entity.
+    Entity const entity = entities[0];
     bool isEmpty = true;
 
     FILAMENT_CHECK_PRECONDITION(mImpl->mSkinningBoneCount <= CONFIG_MAX_BONE_COUNT)
@@ -450,6 +491,15 @@ RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& eng
                 << "Morphing can't be used with STATIC geometry";
     }
 
+    if (mImpl->mDequantizePositions) {
+        // skinning and morphing happen before the model matrix, i.e. on quantized positions
+        FILAMENT_CHECK_PRECONDITION(mImpl->mSkinningBoneCount == 0 && !mImpl->mSkinningBufferMode)
+                << "Quantized positions can't be used with skinning";
+
+        FILAMENT_CHECK_PRECONDITION(mImpl->mMorphTargetCount == 0)
+                << "Quantized positions can't be used with morphing";
+    }
+
     if (mImpl->mInstanceBuffer) {
         size_t const bufferInstanceCount = mImpl->mInstanceBuffer->mInstanceCount;
         FILAMENT_CHECK_PRECONDITION(mImpl->mInstanceCount <= bufferInstanceCount)
@@ -462,6 +512,21 @@ RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& eng
         mImpl->processBoneIndicesAndWights(engine, entity);
     }
 
+    if (mImpl->mLevelCount) {
+        size_t levelsPrimitiveCount = 0;
+        for (size_t i = 0; i < mImpl->mLevelCount; i++) {
+            FILAMENT_CHECK_PRECONDITION(i < 2 ||
+                    mImpl->mLevelScreenSizes[i] < mImpl->mLevelScreenSizes[i - 1])
+                    << "[entity=" << entity.getId() << "] the screen size of level " << i
+                    << " must be smaller than the one of level " << i - 1;
+            levelsPrimitiveCount += mImpl->mLevelPrimitiveCounts[i];
+        }
+        FILAMENT_CHECK_PRECONDITION(levelsPrimitiveCount == mImpl->mEntries.size())
+                << "[entity=" << entity.getId() << "] the levels of detail have "
+                << levelsPrimitiveCount << " primitives, but the renderable has "
+                << mImpl->mEntries.size();
+    }
+
     for (size_t i = 0, c = mImpl->mEntries.size(); i < c; i++) {
         auto& entry = mImpl->mEntries[i];
 
@@ -511,7 +576,7 @@ RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& eng
             << "] AABB can't be empty, unless culling is disabled and "
                "the object is not a shadow caster/receiver";
 
-    downcast(engine).createRenderable(*this, entity);
+    downcast(engine).createRenderables(*this, entities, count);
     return Success;
 }
 
@@ -539,6 +604,16 @@ FRenderableManager::~FRenderableManager() {
     assert_invariant(mManager.getComponentCount() == 0);
 }
 
+void FRenderableManager::create(
+        const RenderableManager::Builder& UTILS_RESTRICT builder,
+        Entity const* entities, size_t count) {
+    // grow the arrays and the instance map once, instead of up to log(count) times
+    mManager.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        create(builder, entities[i]);
+    }
+}
+
 void FRenderableManager::create(
         const RenderableManager::Builder& UTILS_RESTRICT builder, Entity entity) {
     FEngine& engine = mEngine;
@@ -550,6 +625,7 @@ void FRenderableManager::create(
     }
     Instance const ci = manager.addComponent(entity);
     assert_invariant(ci);
+    mComponentsVersion++;
 
     if (ci) {
         // create and initialize all needed RenderPrimitives
@@ -563,6 +639,16 @@ void FRenderableManager::create(
         }
         setPrimitives(ci, { rp, size_type(entryCount) });
 
+        LevelsOfDetail& lods = manager[ci].levelsOfDetail;
+        lods = {};
+        lods.count = std::max(builder->mLevelCount, uint8_t(1));
+        lods.offsets[1] = uint32_t(entryCount);
+        lods.hysteresis = builder->mLevelHysteresis;
+        for (size_t i = 0; i < builder->mLevelCount; i++) {
+            lods.offsets[i + 1] = uint32_t(lods.offsets[i] + builder->mLevelPrimitiveCounts[i]);
+            lods.screenSizes[i] = builder->mLevelScreenSizes[i];
+        }
+
         setAxisAlignedBoundingBox(ci, builder->mAABB);
         setLayerMask(ci, builder->mLayerMask);
         setPriority(ci, builder->mPriority);
@@ -576,6 +662,9 @@ void FRenderableManager::create(
         setFogEnabled(ci, builder->mFogEnabled);
         // do this after calling setAxisAlignedBoundingBox
         static_cast<Visibility&>(mManager[ci].visibility).geometryType = builder->mGeometryType;
+        static_cast<Visibility&>(mManager[ci].visibility).dequantizePositions =
+                builder->mDequantizePositions;
+        mManager[ci].positionDequantization = builder->mPositionDequantization;
         mManager[ci].channels = builder->mLightChannels;
 
         InstancesInfo& instances = manager[ci].instances;
@@ -640,7 +729,7 @@ void FRenderableManager::create(
                     } else {
                         // initialize the bones to identity
                         auto* out = driver.allocatePod<PerRenderableBoneUib::BoneData>(boneCount);
-                        std::uninitialized_fill_n(out, boneCount, FSkinningBuffer::makeBone({}));
+                        std::uninitialized_fill_n(out, boneCount, FSkinningBuffer::makeBone(mat4f{}));
                         driver.updateBufferObject(bones.handle, {
                                 out, boneCount * sizeof(PerRenderableBoneUib::BoneData) }, 0);
                     }
@@ -651,7 +740,7 @@ void FRenderableManager::create(
                     if (UTILS_UNLIKELY(driver.isWorkaroundNeeded(
                             Workaround::ADRENO_UNIFORM_ARRAY_CRASH))) {
                         auto *initBones = driver.allocatePod<PerRenderableBoneUib::BoneData>(1);
-                        std::uninitialized_fill_n(initBones, 1, FSkinningBuffer::makeBone({}));
+                        std::uninitialized_fill_n(initBones, 1, FSkinningBuffer::makeBone(mat4f{}));
                         driver.updateBufferObject(bones.handle, {
                                 initBones, sizeof(PerRenderableBoneUib::BoneData) }, 0);
                     }
@@ -688,7 +777,8 @@ void FRenderableManager::create(
                         sizeof(PerRenderableMorphingUib),
                         BufferObjectBinding::UNIFORM,
                         backend::BufferUsage::DYNAMIC),
-                .count = targetCount };
+                .count = uint32_t(targetCount),
+                .idle = false };
 
             Slice<FRenderPrimitive>& primitives = mManager[ci].primitives;
             mManager[ci].morphTargetBuffer = morphTargetBuffer;
@@ -717,6 +807,7 @@ void FRenderableManager::destroy(utils::Entity e) noexcept {
     if (ci) {
         destroyComponent(ci);
         mManager.removeComponent(e);
+        mComponentsVersion++;
     }
 }
 
@@ -786,8 +877,9 @@ void FRenderableManager::destroyComponentPrimitives(
 
 void FRenderableManager::setMaterialInstanceAt(Instance instance, uint8_t level,
         size_t primitiveIndex, FMaterialInstance const* mi) {
+    mChangeCount++;
     if (instance) {
-        Slice<FRenderPrimitive>& primitives = getRenderPrimitives(instance, level);
+        Slice<FRenderPrimitive> primitives = getRenderPrimitives(instance, level);
         if (primitiveIndex < primitives.size()) {
             assert_invariant(mi);
             FMaterial const* material = mi->getMaterial();
@@ -813,7 +905,7 @@ void FRenderableManager::setMaterialInstanceAt(Instance instance, uint8_t level,
 MaterialInstance* FRenderableManager::getMaterialInstanceAt(
         Instance instance, uint8_t level, size_t primitiveIndex) const noexcept {
     if (instance) {
-        const Slice<FRenderPrimitive>& primitives = getRenderPrimitives(instance, level);
+        Slice<FRenderPrimitive> const primitives = getRenderPrimitives(instance, level);
         if (primitiveIndex < primitives.size()) {
             // We store the material instance as const because we don't want to change it internally
             // but when the user queries it, we want to allow them to call setParameter()
@@ -825,8 +917,9 @@ MaterialInstance* FRenderableManager::getMaterialInstanceAt(
 
 void FRenderableManager::setBlendOrderAt(Instance instance, uint8_t level,
         size_t primitiveIndex, uint16_t order) noexcept {
+    mChangeCount++;
     if (instance) {
-        Slice<FRenderPrimitive>& primitives = getRenderPrimitives(instance, level);
+        Slice<FRenderPrimitive> primitives = getRenderPrimitives(instance, level);
         if (primitiveIndex < primitives.size()) {
             primitives[primitiveIndex].setBlendOrder(order);
         }
@@ -835,8 +928,9 @@ void FRenderableManager::setBlendOrderAt(Instance instance, uint8_t level,
 
 void FRenderableManager::setGlobalBlendOrderEnabledAt(Instance instance, uint8_t level,
         size_t primitiveIndex, bool enabled) noexcept {
+    mChangeCount++;
     if (instance) {
-        Slice<FRenderPrimitive>& primitives = getRenderPrimitives(instance, level);
+        Slice<FRenderPrimitive> primitives = getRenderPrimitives(instance, level);
         if (primitiveIndex < primitives.size()) {
             primitives[primitiveIndex].setGlobalBlendOrderEnabled(enabled);
         }
@@ -846,7 +940,7 @@ void FRenderableManager::setGlobalBlendOrderEnabledAt(Instance instance, uint8_t
 AttributeBitset FRenderableManager::getEnabledAttributesAt(
         Instance instance, uint8_t level, size_t primitiveIndex) const noexcept {
     if (instance) {
-        Slice<FRenderPrimitive> const& primitives = getRenderPrimitives(instance, level);
+        Slice<FRenderPrimitive> const primitives = getRenderPrimitives(instance, level);
         if (primitiveIndex < primitives.size()) {
             return primitives[primitiveIndex].getEnabledAttributes();
         }
@@ -857,8 +951,9 @@ AttributeBitset FRenderableManager::getEnabledAttributesAt(
 void FRenderableManager::setGeometryAt(Instance instance, uint8_t level, size_t primitiveIndex,
         PrimitiveType type, FVertexBuffer* vertices, FIndexBuffer* indices,
         size_t offset, size_t count) noexcept {
+    mChangeCount++;
     if (instance) {
-        Slice<FRenderPrimitive>& primitives = getRenderPrimitives(instance, level);
+        Slice<FRenderPrimitive> primitives = getRenderPrimitives(instance, level);
         if (primitiveIndex < primitives.size()) {
             primitives[primitiveIndex].set(mHwRenderPrimitiveFactory, mEngine.getDriverApi(),
                     type, vertices, indices, offset, count);
@@ -868,6 +963,7 @@ void FRenderableManager::setGeometryAt(Instance instance, uint8_t level, size_t
 
 void FRenderableManager::setBones(Instance ci,
         Bone const* UTILS_RESTRICT transforms, size_t boneCount, size_t offset) {
+    mChangeCount++;
     if (ci) {
         Bones const& bones = mManager[ci].bones;
 
@@ -884,6 +980,7 @@ void FRenderableManager::setBones(Instance ci,
 
 void FRenderableManager::setBones(Instance ci,
         mat4f const* UTILS_RESTRICT transforms, size_t boneCount, size_t offset) {
+    mChangeCount++;
     if (ci) {
         Bones const& bones = mManager[ci].bones;
 
@@ -926,6 +1023,7 @@ void FRenderableManager::setSkinningBuffer(FRenderableManager::Instance ci,
     bones.handle = skinningBuffer->getHwHandle();
     bones.count = uint16_t(count);
     bones.offset = uint16_t(offset);
+    updateVersion(ci);
 }
 
 static void updateMorphWeights(FEngine& engine, backend::Handle<backend::HwBufferObject> handle,
@@ -940,14 +1038,31 @@ static void updateMorphWeights(FEngine& engine, backend::Handle<backend::HwBuffe
 
 void FRenderableManager::setMorphWeights(Instance instance, float const* weights,
         size_t count, size_t offset) {
+    mChangeCount++;
     if (instance) {
         FILAMENT_CHECK_PRECONDITION(count + offset <= CONFIG_MAX_MORPH_TARGET_COUNT)
                 << "Only " << CONFIG_MAX_MORPH_TARGET_COUNT
                 << " morph targets are supported (count=" << count << ", offset=" << offset << ")";
 
-        MorphWeights const& morphWeights = mManager[instance].morphWeights;
+        MorphWeights& morphWeights = mManager[instance].morphWeights;
         if (morphWeights.handle) {
             updateMorphWeights(mEngine, morphWeights.handle, weights, count, offset);
+
+            // Keep track of whether all the weights are zero, e.g. blend shapes at rest. In that
+            // case the renderable doesn't need morphing, which is evaluated in every pass.
+            bool const allZero = std::all_of(weights, weights + count,
+                    [](float w) { return w == 0.0f; });
+            bool const idle = morphWeights.idle;
+            if (!allZero) {
+                morphWeights.idle = false;
+            } else if (offset == 0 && count >= morphWeights.count) {
+                morphWeights.idle = true;
+            }
+            // FScene evaluates whether the renderable needs morphing, only when its version
+            // changes
+            if (morphWeights.idle != idle) {
+                updateVersion(instance);
+            }
         }
     }
 }
@@ -955,6 +1070,7 @@ void FRenderableManager::setMorphWeights(Instance instance, float const* weights
 void FRenderableManager::setMorphTargetBufferOffsetAt(Instance instance, uint8_t level,
         size_t primitiveIndex,
         size_t offset) {
+    mChangeCount++;
     if (instance) {
         assert_invariant(mManager[instance].morphTargetBuffer);
         Slice<FRenderPrimitive>& primitives = mManager[instance].primitives;
@@ -985,6 +1101,7 @@ void FRenderableManager::setLightChannel(Instance ci, unsigned int channel, bool
             const uint8_t mask = 1u << channel;
             mManager[ci].channels &= ~mask;
             mManager[ci].channels |= enable ? mask : 0u;
+            updateVersion(ci);
         }
     }
 }
@@ -999,6 +1116,18 @@ bool FRenderableManager::getLightChannel(Instance ci, unsigned int channel) cons
     return false;
 }
 
+Slice<FRenderPrimitive> FRenderableManager::getRenderPrimitives(
+        Instance instance, uint8_t level) const noexcept {
+    Slice<FRenderPrimitive> const& primitives = mManager[instance].primitives;
+    if (level == ALL_LEVELS) {
+        return primitives;
+    }
+    LevelsOfDetail const& lods = mManager[instance].levelsOfDetail;
+    assert_invariant(level < lods.count);
+    return { primitives.begin() + lods.offsets[level],
+             primitives.begin() + lods.offsets[level + 1] };
+}
+
 size_t FRenderableManager::getPrimitiveCount(Instance instance, uint8_t level) const noexcept {
     return getRenderPrimitives(instance, level).size();
 }
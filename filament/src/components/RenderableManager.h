@@ -76,6 +76,7 @@ public:
         bool reversedWindingOrder       : 1;
         bool fog                        : 1;
         GeometryType geometryType       : 2;
+        bool dequantizePositions        : 1;
     };
 
     static_assert(sizeof(Visibility) == sizeof(uint16_t), "Visibility should be 16 bits");
@@ -108,6 +109,25 @@ public:
         return mManager.empty();
     }
 
+    /*
+     * Change tracking: each instance records the version at which the state that FScene
+     * caches (bounds, layers, visibility, channels and buffer bindings) last changed.
+     * advanceVersion() returns the current version and starts a new one, so that
+     * getVersion(i) > v iff that state has changed since the call that returned v.
+     * getComponentsVersion() changes whenever components are created or destroyed, which can
+     * reassign instances.
+     */
+    uint32_t advanceVersion() noexcept { return mVersion++; }
+
+    uint32_t getVersion(Instance instance) const noexcept { return mManager[instance].version; }
+
+    uint32_t getComponentsVersion() const noexcept { return mComponentsVersion; }
+
+    // Changes whenever any state of a renderable is set, including the state that doesn't
+    // affect its version, e.g. its material instances or morph weights (unless they become all
+    // zero, or stop being so).
+    uint32_t getChangeCount() const noexcept { return mChangeCount; }
+
     utils::Entity getEntity(Instance i) const noexcept {
         return mManager.getEntity(i);
     }
@@ -118,6 +138,9 @@ public:
 
     void create(const RenderableManager::Builder& builder, utils::Entity entity);
 
+    void create(const RenderableManager::Builder& builder,
+            utils::Entity const* entities, size_t count);
+
     void destroy(utils::Entity e) noexcept;
 
     inline void setAxisAlignedBoundingBox(Instance instance, const Box& aabb);
@@ -165,6 +188,23 @@ public:
     inline Box const& getAABB(Instance instance) const noexcept;
     inline Box const& getAxisAlignedBoundingBox(Instance instance) const noexcept { return getAABB(instance); }
     inline Visibility getVisibility(Instance instance) const noexcept;
+
+    // the POSITION attribute is quantized, its model-space position is offset + scale * position
+    struct PositionDequantization {
+        math::float3 scale;
+        math::float3 offset;
+    };
+
+    inline PositionDequantization const& getPositionDequantization(
+            Instance instance) const noexcept;
+
+    // returns model * translation(q.offset) * scale(q.scale)
+    static math::mat4f dequantize(math::mat4f const& model,
+            PositionDequantization const& q) noexcept {
+        return { model[0] * q.scale.x, model[1] * q.scale.y, model[2] * q.scale.z,
+                 model[0] * q.offset.x + model[1] * q.offset.y + model[2] * q.offset.z +
+                 model[3] };
+    }
     inline uint8_t getLayerMask(Instance instance) const noexcept;
     inline uint8_t getPriority(Instance instance) const noexcept;
     inline uint8_t getChannels(Instance instance) const noexcept;
@@ -185,6 +225,9 @@ public:
     };
     inline MorphingBindingInfo getMorphingBufferInfo(Instance instance) const noexcept;
 
+    // returns whether all the morph weights of this renderable are zero
+    inline bool areMorphWeightsIdle(Instance instance) const noexcept;
+
     struct InstancesInfo {
         union {
             FInstanceBuffer* buffer;
@@ -197,7 +240,28 @@ public:
     static_assert(sizeof(InstancesInfo) == 16);
     inline InstancesInfo getInstancesInfo(Instance instance) const noexcept;
 
-    inline size_t getLevelCount(Instance) const noexcept { return 1u; }
+    // passed as level to address the primitives of all the levels of detail at once
+    static constexpr uint8_t ALL_LEVELS = 0xff;
+
+    struct LevelsOfDetail {
+        // the primitives of level i are [offsets[i], offsets[i + 1])
+        uint32_t offsets[Builder::LEVEL_OF_DETAIL_COUNT_MAX + 1];
+        uint8_t count;
+        // level selected by the last call to selectLevelOfDetail()
+        uint8_t current;
+        // level i > 0 is used below screenSizes[i], screenSizes[0] is unused
+        float screenSizes[Builder::LEVEL_OF_DETAIL_COUNT_MAX];
+        float hysteresis;
+    };
+    static_assert(sizeof(LevelsOfDetail) == 44);
+
+    inline size_t getLevelCount(Instance instance) const noexcept;
+
+    // Picks the level of detail of the renderable from its projected size, expressed as a
+    // fraction of the viewport height. The level selected last is remembered, so that
+    // hysteresis can be applied.
+    inline uint8_t selectLevelOfDetail(Instance instance, float screenSize) noexcept;
+
     size_t getPrimitiveCount(Instance instance, uint8_t level) const noexcept;
     void setMaterialInstanceAt(Instance instance, uint8_t level,
             size_t primitiveIndex, FMaterialInstance const* materialInstance);
@@ -208,8 +272,8 @@ public:
     void setBlendOrderAt(Instance instance, uint8_t level, size_t primitiveIndex, uint16_t blendOrder) noexcept;
     void setGlobalBlendOrderEnabledAt(Instance instance, uint8_t level, size_t primitiveIndex, bool enabled) noexcept;
     AttributeBitset getEnabledAttributesAt(Instance instance, uint8_t level, size_t primitiveIndex) const noexcept;
-    inline utils::Slice<FRenderPrimitive> const& getRenderPrimitives(Instance instance, uint8_t level) const noexcept;
-    inline utils::Slice<FRenderPrimitive>& getRenderPrimitives(Instance instance, uint8_t level) noexcept;
+    utils::Slice<FRenderPrimitive> getRenderPrimitives(
+            Instance instance, uint8_t level) const noexcept;
 
 private:
     void destroyComponent(Instance ci) noexcept;
@@ -229,7 +293,9 @@ private:
 
     struct MorphWeights {
         backend::Handle<backend::HwBufferObject> handle;
-        uint32_t count = 0;
+        uint32_t count : 31;
+        // all the weights are known to be zero, the renderable can be drawn without morphing
+        uint32_t idle : 1;
     };
     static_assert(sizeof(MorphWeights) == 8);
 
@@ -242,7 +308,10 @@ private:
         VISIBILITY,             // user data
         PRIMITIVES,             // user data
         BONES,                  // filament data, UBO storing a pointer to the bones information
-        MORPHTARGET_BUFFER      // morphtarget buffer for the component
+        MORPHTARGET_BUFFER,     // morphtarget buffer for the component
+        LEVELS_OF_DETAIL,       // user data, and level selected last
+        POSITION_DEQUANTIZATION, // user data
+        VERSION                 // filament data, version of the last change
     };
 
     using Base = utils::SingleInstanceComponentManager<
@@ -254,7 +323,10 @@ private:
             Visibility,                      // VISIBILITY
             utils::Slice<FRenderPrimitive>,  // PRIMITIVES
             Bones,                           // BONES
-            FMorphTargetBuffer*              // MORPHTARGET_BUFFER
+            FMorphTargetBuffer*,             // MORPHTARGET_BUFFER
+            LevelsOfDetail,                  // LEVELS_OF_DETAIL
+            PositionDequantization,          // POSITION_DEQUANTIZATION
+            uint32_t                         // VERSION
     >;
 
     struct Sim : public Base {
@@ -278,6 +350,9 @@ private:
                 Field<PRIMITIVES>           primitives;
                 Field<BONES>                bones;
                 Field<MORPHTARGET_BUFFER>   morphTargetBuffer;
+                Field<LEVELS_OF_DETAIL>     levelsOfDetail;
+                Field<POSITION_DEQUANTIZATION> positionDequantization;
+                Field<VERSION>              version;
             };
         };
 
@@ -289,7 +364,15 @@ private:
         }
     };
 
+    void updateVersion(Instance instance) noexcept {
+        mManager[instance].version = mVersion;
+        mChangeCount++;
+    }
+
     Sim mManager;
+    uint32_t mVersion = 1;
+    uint32_t mComponentsVersion = 0;
+    uint32_t mChangeCount = 0;
     FEngine& mEngine;
     HwRenderPrimitiveFactory mHwRenderPrimitiveFactory;
 };
@@ -303,6 +386,7 @@ void FRenderableManager::setAxisAlignedBoundingBox(Instance instance, const Box&
                 GeometryType::DYNAMIC)
                 << "This renderable has staticBounds enabled; its AABB cannot change.";
         mManager[instance].aabb = aabb;
+        updateVersion(instance);
     }
 }
 
@@ -311,12 +395,14 @@ void FRenderableManager::setLayerMask(Instance instance,
     if (instance) {
         uint8_t& layers = mManager[instance].layers;
         layers = (layers & ~select) | (values & select);
+        updateVersion(instance);
     }
 }
 
 void FRenderableManager::setLayerMask(Instance instance, uint8_t layerMask) noexcept {
     if (instance) {
         mManager[instance].layers = layerMask;
+        updateVersion(instance);
     }
 }
 
@@ -324,6 +410,7 @@ void FRenderableManager::setPriority(Instance instance, uint8_t priority) noexce
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.priority = std::min(priority, uint8_t(0x7));
+        updateVersion(instance);
     }
 }
 
@@ -331,6 +418,7 @@ void FRenderableManager::setChannel(Instance instance, uint8_t channel) noexcept
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.channel = std::min(channel, uint8_t(0x3));
+        updateVersion(instance);
     }
 }
 
@@ -338,6 +426,7 @@ void FRenderableManager::setCastShadows(Instance instance, bool enable) noexcept
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.castShadows = enable;
+        updateVersion(instance);
     }
 }
 
@@ -345,6 +434,7 @@ void FRenderableManager::setReceiveShadows(Instance instance, bool enable) noexc
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.receiveShadows = enable;
+        updateVersion(instance);
     }
 }
 
@@ -352,6 +442,7 @@ void FRenderableManager::setScreenSpaceContactShadows(Instance instance, bool en
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.screenSpaceContactShadows = enable;
+        updateVersion(instance);
     }
 }
 
@@ -359,6 +450,7 @@ void FRenderableManager::setCulling(Instance instance, bool enable) noexcept {
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.culling = enable;
+        updateVersion(instance);
     }
 }
 
@@ -366,6 +458,7 @@ void FRenderableManager::setFogEnabled(Instance instance, bool enable) noexcept
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.fog = enable;
+        updateVersion(instance);
     }
 }
 
@@ -381,6 +474,7 @@ void FRenderableManager::setSkinning(Instance instance, bool enable) {
                 << "Skinning can't be used with STATIC geometry";
 
         visibility.skinning = enable;
+        updateVersion(instance);
     }
 }
 
@@ -392,6 +486,7 @@ void FRenderableManager::setMorphing(Instance instance, bool enable) {
                 << "Morphing can't be used with STATIC geometry";
 
         visibility.morphing = enable;
+        updateVersion(instance);
     }
 }
 
@@ -407,6 +502,11 @@ FRenderableManager::getVisibility(Instance instance) const noexcept {
     return mManager[instance].visibility;
 }
 
+FRenderableManager::PositionDequantization const&
+FRenderableManager::getPositionDequantization(Instance instance) const noexcept {
+    return mManager[instance].positionDequantization;
+}
+
 bool FRenderableManager::isShadowCaster(Instance instance) const noexcept {
     return getVisibility(instance).castShadows;
 }
@@ -446,6 +546,11 @@ inline uint32_t FRenderableManager::getBoneCount(Instance instance) const noexce
     return bones.count;
 }
 
+bool FRenderableManager::areMorphWeightsIdle(Instance instance) const noexcept {
+    MorphWeights const& morphWeights = mManager[instance].morphWeights;
+    return morphWeights.idle;
+}
+
 FRenderableManager::MorphingBindingInfo
 FRenderableManager::getMorphingBufferInfo(Instance instance) const noexcept {
     MorphWeights const& morphWeights = mManager[instance].morphWeights;
@@ -458,14 +563,25 @@ FRenderableManager::getInstancesInfo(Instance instance) const noexcept {
     return mManager[instance].instances;
 }
 
-utils::Slice<FRenderPrimitive> const& FRenderableManager::getRenderPrimitives(
-        Instance instance, UTILS_UNUSED uint8_t level) const noexcept {
-    return mManager[instance].primitives;
+size_t FRenderableManager::getLevelCount(Instance instance) const noexcept {
+    LevelsOfDetail const& lods = mManager[instance].levelsOfDetail;
+    return lods.count;
 }
 
-utils::Slice<FRenderPrimitive>& FRenderableManager::getRenderPrimitives(
-        Instance instance, UTILS_UNUSED uint8_t level) noexcept {
-    return mManager[instance].primitives;
+uint8_t FRenderableManager::selectLevelOfDetail(Instance instance, float screenSize) noexcept {
+    LevelsOfDetail& lods = mManager[instance].levelsOfDetail;
+    uint8_t level = lods.current;
+    // switch to a coarser level only once we're clearly below its threshold...
+    while (level + 1 < lods.count &&
+           screenSize < lods.screenSizes[level + 1] * (1.0f - lods.hysteresis)) {
+        level++;
+    }
+    // ...and back to a finer one only once we're clearly above the current level's threshold
+    while (level > 0 && screenSize >= lods.screenSizes[level] * (1.0f + lods.hysteresis)) {
+        level--;
+    }
+    lods.current = level;
+    return level;
 }
 
 } // namespace filament
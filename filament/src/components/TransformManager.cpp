@@ -19,8 +19,12 @@
 #include <math/mat4.h>
 
 #include <utils/debug.h>
+#include <utils/JobSystem.h>
+#include <utils/Systrace.h>
 #include <filament/TransformManager.h>
 
+#include <vector>
+
 
 using namespace utils;
 using namespace filament::math;
@@ -59,6 +63,7 @@ void FTransformManager::create(Entity entity, Instance parent, const mat4f& loca
     Instance const i = manager.addComponent(entity);
     assert_invariant(i);
     assert_invariant(i != parent);
+    mComponentsVersion++;
 
     if (i && i != parent) {
         manager[i].parent = 0;
@@ -70,6 +75,15 @@ void FTransformManager::create(Entity entity, Instance parent, const mat4f& loca
     }
 }
 
+void FTransformManager::create(Entity const* entities, size_t count, Instance parent,
+        const mat4f* localTransforms) {
+    // grow the arrays and the instance map once, instead of up to log(count) times
+    mManager.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        create(entities[i], parent, localTransforms ? localTransforms[i] : mat4f{});
+    }
+}
+
 void FTransformManager::create(Entity entity, Instance parent, const mat4& localTransform) {
     // this always adds at the end, so all existing instances stay valid
     auto& manager = mManager;
@@ -81,6 +95,7 @@ void FTransformManager::create(Entity entity, Instance parent, const mat4& local
     Instance const i = manager.addComponent(entity);
     assert_invariant(i);
     assert_invariant(i != parent);
+    mComponentsVersion++;
 
     if (i && i != parent) {
         manager[i].parent = 0;
@@ -159,6 +174,7 @@ void FTransformManager::destroy(Entity e) noexcept {
 
         // 2) remove the component
         Instance const moved = manager.removeComponent(e);
+        mComponentsVersion++;
 
         // 3) update the references to the entry now with Instance i
         if (moved != i) {
@@ -206,6 +222,8 @@ void FTransformManager::updateNodeTransform(Instance i) noexcept {
             manager[parent].world, manager[i].local,
             manager[parent].worldTranslationLo, manager[i].localTranslationLo,
             mAccurateTranslations);
+    manager[i].version = mVersion;
+    mChangeCount.fetch_add(1, std::memory_order_relaxed);
 
     // update our children's world transforms
     Instance const child = manager[i].firstChild;
@@ -226,26 +244,138 @@ void FTransformManager::commitLocalTransformTransaction() noexcept {
 }
 
 void FTransformManager::computeAllWorldTransforms() noexcept {
+    SYSTRACE_CALL();
+
+    // store the nodes level by level, so that each level only depends on the previous ones
+    sortByDepth();
+
+    // Below this many nodes, a level is not worth splitting across threads.
+    constexpr size_t PARALLEL_LEVEL_SIZE = 1024;
+
+    JobSystem* const js = mJobSystem;
+    auto const& levels = mLevels;
+    for (size_t l = 0, c = levels.size(); l < c; l++) {
+        uint32_t const first = levels[l];
+        uint32_t const last = l + 1 < c ? levels[l + 1] : uint32_t(mManager.end());
+        if (js && last - first >= PARALLEL_LEVEL_SIZE) {
+            // the nodes of a level are independent of each other
+            auto work = [this](uint32_t start, uint32_t count) {
+                computeLevelWorldTransforms(Instance(start), Instance(start + count));
+            };
+            JobSystem::Job* parent = js->createJob();
+            JobSystem::Job* job = jobs::parallel_for(*js, parent,
+                    first, last - first, std::cref(work), jobs::CountSplitter<256>());
+            js->run(job);
+            js->runAndWait(parent);
+        } else {
+            computeLevelWorldTransforms(first, last);
+        }
+    }
+}
+
+void FTransformManager::computeLevelWorldTransforms(Instance first, Instance last) noexcept {
     auto& manager = mManager;
+    const bool accurate = mAccurateTranslations;
+    uint32_t const version = mVersion;
+    bool changed = false;
+    for (Instance i = first; i != last; ++i) {
+        Instance const parent = manager[i].parent;
+        assert_invariant(parent < i);
+
+        // only the transforms that actually change get a new version
+        mat4f const world = manager[i].world;
+        float3 const worldTranslationLo = manager[i].worldTranslationLo;
+
+        FTransformManager::computeWorldTransform(
+                manager[i].world, manager[i].worldTranslationLo,
+                manager[parent].world, manager[i].local,
+                manager[parent].worldTranslationLo, manager[i].localTranslationLo,
+                accurate);
+
+        mat4f const& newWorld = manager.elementAt<WORLD>(i);
+        float3 const& newWorldTranslationLo = manager.elementAt<WORLD_LO>(i);
+        if (world[0] != newWorld[0] || world[1] != newWorld[1] ||
+            world[2] != newWorld[2] || world[3] != newWorld[3] ||
+            worldTranslationLo != newWorldTranslationLo) {
+            manager[i].version = version;
+            changed = true;
+        }
+    }
+    if (changed) {
+        mChangeCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Reorders the nodes by increasing depth in the hierarchy and records where each level starts.
+void FTransformManager::sortByDepth() noexcept {
+    auto& manager = mManager;
+    mLevels.clear();
+    if (manager.empty()) {
+        return;
+    }
 
     // swapNode() below needs some temporary storage which we provide here
-    const bool accurate = mAccurateTranslations;
     auto& soa = manager.getSoA();
     soa.ensureCapacity(soa.size() + 1);
 
+    // Ensure that children are always sorted after their parent, so we can compute the depths
+    // of all nodes in a single pass.
     for (Instance i = manager.begin(), e = manager.end(); i != e; ++i) {
-        // Ensure that children are always sorted after their parent.
         while (UTILS_UNLIKELY(Instance(manager[i].parent) > i)) {
             swapNode(i, manager[i].parent);
         }
+    }
+
+    // depths are indexed by instance, the 0 entry is unused
+    size_t const count = manager.end();
+    std::vector<uint32_t> depths(count);
+    std::vector<uint32_t> levelSizes;
+    bool sorted = true;
+    for (uint32_t i = manager.begin(), e = manager.end(); i != e; ++i) {
         Instance const parent = manager[i].parent;
-        assert_invariant(parent < i);
+        uint32_t const depth = parent ? depths[parent] + 1 : 0;
+        depths[i] = depth;
+        sorted = sorted && (i == manager.begin() || depths[i - 1] <= depth);
+        if (depth >= levelSizes.size()) {
+            levelSizes.push_back(0);
+        }
+        levelSizes[depth]++;
+    }
 
-        FTransformManager::computeWorldTransform(
-                manager[i].world, manager[i].worldTranslationLo,
-                manager[parent].world, manager[i].local,
-                manager[parent].worldTranslationLo, manager[i].localTranslationLo,
-                accurate);
+    uint32_t first = manager.begin();
+    for (uint32_t const size: levelSizes) {
+        mLevels.push_back(first);
+        first += size;
+    }
+
+    if (sorted) {
+        // this is the common case, the hierarchy hasn't changed since the last time
+        return;
+    }
+
+    // a stable counting sort of the nodes by depth gives each node its destination
+    std::vector<uint32_t> next(mLevels.begin(), mLevels.end());
+    std::vector<uint32_t> nodeAt(count);        // node currently at a given position
+    std::vector<uint32_t> positionOf(count);    // current position of a given node
+    std::vector<uint32_t> order(count);         // node that goes at a given position
+    for (uint32_t i = manager.begin(), e = manager.end(); i != e; ++i) {
+        order[next[depths[i]]++] = i;
+        nodeAt[i] = i;
+        positionOf[i] = i;
+    }
+
+    // apply the permutation with swaps, swapNode() keeps the hierarchy consistent
+    for (uint32_t i = manager.begin(), e = manager.end(); i != e; ++i) {
+        uint32_t const node = order[i];
+        uint32_t const position = positionOf[node];
+        if (position != i) {
+            swapNode(i, position);
+            uint32_t const displaced = nodeAt[i];
+            nodeAt[position] = displaced;
+            positionOf[displaced] = position;
+            nodeAt[i] = node;
+            positionOf[node] = i;
+        }
     }
 }
 
@@ -285,6 +415,7 @@ void FTransformManager::swapNode(Instance i, Instance j) noexcept {
     std::swap(manager.elementAt<LOCAL_LO>(i), manager.elementAt<LOCAL_LO>(j));
     std::swap(manager.elementAt<WORLD>(i),    manager.elementAt<WORLD>(j));
     std::swap(manager.elementAt<WORLD_LO>(i), manager.elementAt<WORLD_LO>(j));
+    std::swap(manager.elementAt<VERSION>(i),  manager.elementAt<VERSION>(j));
     manager.swap(i, j); // this swaps the data relative to SingleInstanceComponentManager
 
     // now swap the linked-list references, to do that correctly we must use a temporary
@@ -381,6 +512,7 @@ void FTransformManager::transformChildren(Sim& manager, Instance i) noexcept {
                 manager[parent].world, manager[i].local,
                 manager[parent].worldTranslationLo, manager[i].localTranslationLo,
                 accurate);
+        manager[i].version = mVersion;
 
         // assume we don't have a deep hierarchy
         Instance const child = manager[i].firstChild;
@@ -28,6 +28,13 @@
 
 #include <math/mat4.h>
 
+#include <atomic>
+#include <vector>
+
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace filament {
 
 class UTILS_PRIVATE FTransformManager : public TransformManager {
@@ -69,6 +76,28 @@ public:
         return mManager.getEntities();
     }
 
+    /*
+     * Change tracking: each instance records the version at which its world transform last
+     * changed. advanceVersion() returns the current version and starts a new one, so that
+     * getVersion(i) > v iff the world transform of i has changed since the call that returned v.
+     * getComponentsVersion() changes whenever components are created or destroyed, which can
+     * reassign instances.
+     */
+    uint32_t advanceVersion() noexcept { return mVersion++; }
+
+    uint32_t getVersion(Instance ci) const noexcept { return mManager[ci].version; }
+
+    uint32_t getComponentsVersion() const noexcept { return mComponentsVersion; }
+
+    // Changes whenever any world transform changes, regardless of advanceVersion().
+    uint32_t getChangeCount() const noexcept {
+        return mChangeCount.load(std::memory_order_relaxed);
+    }
+
+    // JobSystem used to compute the world transforms of large hierarchies in parallel,
+    // nullptr (the default) to always use the calling thread.
+    void setJobSystem(utils::JobSystem* js) noexcept { mJobSystem = js; }
+
     void setAccurateTranslationsEnabled(bool enable) noexcept;
 
     bool isAccurateTranslationsEnabled() const noexcept {
@@ -77,10 +106,15 @@ public:
 
     void create(utils::Entity entity);
 
+    void reserve(size_t count) { mManager.reserve(count); }
+
     void create(utils::Entity entity, Instance parent, const math::mat4f& localTransform);
 
     void create(utils::Entity entity, Instance parent, const math::mat4& localTransform);
 
+    void create(utils::Entity const* entities, size_t count, Instance parent,
+            const math::mat4f* localTransforms);
+
     void destroy(utils::Entity e) noexcept;
 
     void setParent(Instance i, Instance newParent) noexcept;
@@ -145,6 +179,8 @@ private:
     void transformChildren(Sim& manager, Instance firstChild) noexcept;
 
     void computeAllWorldTransforms() noexcept;
+    void sortByDepth() noexcept;
+    void computeLevelWorldTransforms(Instance first, Instance last) noexcept;
 
     static void computeWorldTransform(math::mat4f& outWorld, math::float3& inoutWorldTranslationLo,
             math::mat4f const& pt, math::mat4f const& local,
@@ -162,6 +198,7 @@ private:
         FIRST_CHILD,    // instance to our first child
         NEXT,           // instance to our next sibling
         PREV,           // instance to our previous sibling
+        VERSION,        // version at which the world transform last changed
     };
 
     using Base = utils::SingleInstanceComponentManager<
@@ -172,7 +209,8 @@ private:
             Instance,       // parent
             Instance,       // firstChild
             Instance,       // next
-            Instance        // prev
+            Instance,       // prev
+            uint32_t        // version
     >;
 
     struct Sim : public Base {
@@ -197,6 +235,7 @@ private:
                 Field<FIRST_CHILD>  firstChild;
                 Field<NEXT>         next;
                 Field<PREV>         prev;
+                Field<VERSION>      version;
             };
         };
 
@@ -209,6 +248,13 @@ private:
     };
 
     Sim mManager;
+    utils::JobSystem* mJobSystem = nullptr;
+    // first instance of each level of the hierarchy, valid after computeAllWorldTransforms()
+    std::vector<uint32_t> mLevels;
+    uint32_t mVersion = 1;
+    uint32_t mComponentsVersion = 0;
+    // updated from the jobs of computeAllWorldTransforms()
+    std::atomic<uint32_t> mChangeCount = 0;
     bool mLocalTransformTransactionOpen = false;
     bool mAccurateTranslations = false;
 };
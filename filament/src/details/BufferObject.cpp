@@ -21,12 +21,14 @@
 #include "FilamentAPI-impl.h"
 
 #include <utils/CString.h>
+#include <utils/Panic.h>
 
 namespace filament {
 
 struct BufferObject::BuilderDetails {
     BindingType mBindingType = BindingType::VERTEX;
     uint32_t mByteCount = 0;
+    BufferUsage mUsage = BufferUsage::STATIC;
 };
 
 using BuilderType = BufferObject;
@@ -47,6 +49,11 @@ BufferObject::Builder& BufferObject::Builder::bindingType(BindingType bindingTyp
     return *this;
 }
 
+BufferObject::Builder& BufferObject::Builder::usage(BufferUsage usage) noexcept {
+    mImpl->mUsage = usage;
+    return *this;
+}
+
 BufferObject* BufferObject::Builder::build(Engine& engine) {
     return downcast(engine).createBufferObject(*this);
 }
@@ -57,19 +64,32 @@ FBufferObject::FBufferObject(FEngine& engine, const BufferObject::Builder& build
         : mByteCount(builder->mByteCount), mBindingType(builder->mBindingType) {
     FEngine::DriverApi& driver = engine.getDriverApi();
     mHandle = driver.createBufferObject(builder->mByteCount, builder->mBindingType,
-            backend::BufferUsage::STATIC);
+            builder->mUsage);
     if (auto name = builder.getName(); !name.empty()) {
         driver.setDebugTag(mHandle.getId(), std::move(name));
     }
+    engine.trackBufferMemory(ptrdiff_t(mByteCount));
 }
 
 void FBufferObject::terminate(FEngine& engine) {
     FEngine::DriverApi& driver = engine.getDriverApi();
     driver.destroyBufferObject(mHandle);
+    engine.trackBufferMemory(-ptrdiff_t(mByteCount));
 }
 
 void FBufferObject::setBuffer(FEngine& engine, BufferDescriptor&& buffer, uint32_t byteOffset) {
+    engine.markContentChanged();
     engine.getDriverApi().updateBufferObject(mHandle, std::move(buffer), byteOffset);
 }
 
+void FBufferObject::setBufferUnsynchronized(FEngine& engine, BufferDescriptor&& buffer,
+        uint32_t byteOffset) {
+    engine.markContentChanged();
+    FILAMENT_CHECK_PRECONDITION(byteOffset + buffer.size <= mByteCount)
+            << "setBufferUnsynchronized() out of bounds: offset=" << byteOffset
+            << ", size=" << buffer.size << ", byteCount=" << mByteCount;
+    engine.getDriverApi().updateBufferObjectUnsynchronized(mHandle, std::move(buffer),
+            byteOffset);
+}
+
 } // namespace filament
@@ -26,9 +26,15 @@
 #include <utils/compiler.h>
 #include <utils/Panic.h>
 
+#include <math/mat4.h>
 #include <math/scalar.h>
-
 #include <math/vec2.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace filament::math;
 using namespace utils;
@@ -92,6 +98,14 @@ void UTILS_NOINLINE FCamera::setCustomProjection(mat4 const& p,
     mProjectionForCulling = c;
     mNear = near;
     mFar = far;
+    mHasStereoscopicCullingProjection = false;
+}
+
+void UTILS_NOINLINE FCamera::setCustomEyeProjection(math::mat4 const* projection, size_t count,
+        double near, double far) {
+    setCustomEyeProjection(projection, count, projection[0], near, far);
+    mHasStereoscopicCullingProjection = true;
+    updateStereoscopicCullingProjection();
 }
 
 void UTILS_NOINLINE FCamera::setCustomEyeProjection(math::mat4 const* projection, size_t count,
@@ -107,6 +121,80 @@ void UTILS_NOINLINE FCamera::setCustomEyeProjection(math::mat4 const* projection
     mProjectionForCulling = projectionForCulling;
     mNear = near;
     mFar = far;
+    mHasStereoscopicCullingProjection = false;
+}
+
+void FCamera::updateStereoscopicCullingProjection() noexcept {
+    // Compute a frustum, in head space, which contains the near and far corners of all the eyes'
+    // frustums. Because the frustum is convex, it contains all the eyes' frustums entirely and
+    // can be used to cull for all eyes at once.
+    const uint8_t eyeCount = mEngine.getConfig().stereoscopicEyeCount;
+    double3 corners[CONFIG_MAX_STEREOSCOPIC_EYES][8];
+    bool valid = std::isfinite(mFar);
+    for (uint8_t i = 0; i < eyeCount && valid; i++) {
+        const mat4 viewFromClip = inverse(mEyeProjection[i]);
+        const mat4 viewFromEye = inverse(mEyeFromView[i]);
+        for (size_t j = 0; j < 4; j++) {
+            const double2 ndc{ (j & 1u) ? 1.0 : -1.0, (j & 2u) ? 1.0 : -1.0 };
+            // a is on the eye's near plane, b further along the same frustum edge (this works
+            // for infinite projections as well).
+            const double4 a = viewFromClip * double4{ ndc, -1.0, 1.0 };
+            const double4 b = viewFromClip * double4{ ndc,  0.0, 1.0 };
+            const double3 pn = a.xyz / a.w;
+            const double3 d = b.xyz / b.w - pn;
+            valid = valid && d.z < 0.0;
+            // move along the edge up to the far plane
+            const double3 pf = pn + d * ((mFar + pn.z) / -d.z);
+            corners[i][j]     = (viewFromEye * double4{ pn, 1.0 }).xyz;
+            corners[i][j + 4] = (viewFromEye * double4{ pf, 1.0 }).xyz;
+        }
+    }
+
+    // the angular extent is given by the far corners, as seen from the head
+    double2 slope{ 0.0 };
+    for (uint8_t i = 0; i < eyeCount && valid; i++) {
+        for (size_t j = 4; j < 8; j++) {
+            valid = valid && corners[i][j].z < 0.0;
+            slope = max(slope, abs(corners[i][j].xy) / -corners[i][j].z);
+        }
+    }
+
+    valid = valid && slope.x > 0.0 && slope.y > 0.0;
+
+    // move the apex behind the head so that the near corners fit within that extent
+    double apex = 0.0;
+    for (uint8_t i = 0; i < eyeCount && valid; i++) {
+        for (size_t j = 0; j < 4; j++) {
+            const double2 z = abs(corners[i][j].xy) / slope + corners[i][j].z;
+            apex = std::max({ apex, z.x, z.y });
+        }
+    }
+
+    // and finally compute the frustum as seen from the apex
+    double2 lb{ std::numeric_limits<double>::infinity() };
+    double2 rt{ -std::numeric_limits<double>::infinity() };
+    double near = std::numeric_limits<double>::infinity();
+    double far = 0.0;
+    for (uint8_t i = 0; i < eyeCount && valid; i++) {
+        for (double3 const& p : corners[i]) {
+            const double z = apex - p.z;
+            valid = valid && z > 0.0;
+            lb = min(lb, p.xy / z);
+            rt = max(rt, p.xy / z);
+            near = std::min(near, z);
+            far = std::max(far, z);
+        }
+    }
+
+    if (UTILS_LIKELY(valid)) {
+        mProjectionForCulling =
+                mat4::frustum(lb.x * near, rt.x * near, lb.y * near, rt.y * near, near, far) *
+                mat4::translation(double3{ 0.0, 0.0, -apex });
+    } else {
+        // an eye looks beside or behind the head, we can't compute a frustum, fallback to
+        // the first eye.
+        mProjectionForCulling = mEyeProjection[0];
+    }
 }
 
 void UTILS_NOINLINE FCamera::setProjection(Camera::Projection projection,
@@ -215,6 +303,9 @@ void UTILS_NOINLINE FCamera::setEyeModelMatrix(uint8_t eyeId, math::mat4 const&
             << "eyeId must be < config.stereoscopicEyeCount (" << config.stereoscopicEyeCount
             << ")";
     mEyeFromView[eyeId] = inverse(model);
+    if (mHasStereoscopicCullingProjection) {
+        updateStereoscopicCullingProjection();
+    }
 }
 
 void FCamera::lookAt(double3 const& eye, double3 const& center, double3 const& up) noexcept {
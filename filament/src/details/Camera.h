@@ -66,6 +66,11 @@ public:
     void setCustomEyeProjection(math::mat4 const* projection, size_t count,
             math::mat4 const& projectionForCulling, double near, double far);
 
+    // Sets the projection of each eye, the culling projection encompassing all eyes is computed
+    // and kept up-to-date with the eye model matrices.
+    void setCustomEyeProjection(math::mat4 const* projection, size_t count,
+            double near, double far);
+
 
     void setScaling(math::double2 scaling) noexcept { mScalingCS = scaling; }
 
@@ -198,6 +203,8 @@ public:
             double aspect, double near, double far);
 
 private:
+    void updateStereoscopicCullingProjection() noexcept;
+
     FEngine& mEngine;
     utils::Entity mEntity;
 
@@ -211,6 +218,7 @@ private:
 
     double mNear{};
     double mFar{};
+    bool mHasStereoscopicCullingProjection = false;
     // exposure settings
     float mAperture = 16.0f;
     float mShutterSpeed = 1.0f / 125.0f;
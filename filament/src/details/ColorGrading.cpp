@@ -25,6 +25,7 @@
 
 #include <filament/ColorSpace.h>
 
+#include <math/half.h>
 #include <math/vec2.h>
 #include <math/vec3.h>
 #include <math/vec4.h>
@@ -33,6 +34,8 @@
 #include <utils/Mutex.h>
 #include <utils/Systrace.h>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdlib>
 #include <mutex>
@@ -627,6 +630,63 @@ static ColorTransform selectOETF(const ColorSpace& colorSpace) noexcept {
 // Color grading implementation
 //------------------------------------------------------------------------------
 
+struct FColorGrading::LutCache::Entry {
+    // parameters the LUT was built with, the tone mapper must not be dereferenced
+    Builder builder;
+    ToneMapperResponse toneMapperResponse;
+    TextureHandle handle;
+    uint32_t dimension;
+    uint32_t refCount;
+    uint64_t lastUse;
+};
+
+FColorGrading::LutCache::LutCache() noexcept = default;
+
+FColorGrading::LutCache::~LutCache() noexcept {
+    assert_invariant(mEntries.empty());
+}
+
+void FColorGrading::LutCache::terminate(DriverApi& driver) noexcept {
+    for (Entry const& entry : mEntries) {
+        driver.destroyTexture(entry.handle);
+    }
+    mEntries.clear();
+}
+
+void FColorGrading::LutCache::release(DriverApi& driver, TextureHandle handle) noexcept {
+    auto pos = std::find_if(mEntries.begin(), mEntries.end(),
+            [handle](Entry const& entry) { return entry.handle == handle; });
+    assert_invariant(pos != mEntries.end());
+    assert_invariant(pos->refCount > 0);
+    pos->refCount--;
+    pos->lastUse = mTime++;
+
+    // evict the least recently used LUTs that nobody uses anymore
+    while (std::count_if(mEntries.begin(), mEntries.end(),
+            [](Entry const& entry) { return entry.refCount == 0; }) > MAX_UNUSED_COUNT) {
+        auto lru = mEntries.end();
+        for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+            if (it->refCount == 0 && (lru == mEntries.end() || it->lastUse < lru->lastUse)) {
+                lru = it;
+            }
+        }
+        driver.destroyTexture(lru->handle);
+        mEntries.erase(lru);
+    }
+}
+
+FColorGrading::ToneMapperResponse FColorGrading::getToneMapperResponse(
+        ToneMapper const& toneMapper) noexcept {
+    // ToneMappers can't be compared, in particular a GenericToneMapper can be modified after
+    // it's been used, so we identify them by their output for a few inputs covering the LUT.
+    ToneMapperResponse response;
+    for (size_t i = 0; i < response.size(); i++) {
+        float const x = float(i) / float(response.size() - 1u);
+        response[i] = toneMapper(max(LogC_to_linear(float3{ x, 1.0f - x, x * x }), 0.0f));
+    }
+    return response;
+}
+
 struct Config {
     size_t lutDimension{};
     mat3f  adaptationTransform;
@@ -646,6 +706,23 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
 
     DriverApi& driver = engine.getDriverApi();
 
+    // if a LUT was built with the same parameters, there is no need to compute it
+    LutCache& cache = engine.getColorGradingLutCache();
+    ToneMapperResponse const toneMapperResponse = getToneMapperResponse(*builder->toneMapper);
+    auto const pos = std::find_if(cache.mEntries.begin(), cache.mEntries.end(),
+            [&](LutCache::Entry const& entry) {
+                return entry.toneMapperResponse == toneMapperResponse &&
+                        entry.builder->toneMapping == builder->toneMapping &&
+                        *entry.builder.operator->() == *builder.operator->();
+            });
+    if (pos != cache.mEntries.end()) {
+        pos->refCount++;
+        cache.mHitCount++;
+        mLutHandle = pos->handle;
+        mDimension = pos->dimension;
+        return;
+    }
+
     Config c;
     // This lock protects the data inside Config, which is written to by the Filament thread,
     // and read from multiple Job threads.
@@ -692,6 +769,9 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
                 config = c;
             }
             half4* UTILS_RESTRICT p = (half4*) data + b * config.lutDimension * config.lutDimension;
+            // each row is computed in float and converted to half in bulk
+            float4 row[64];
+            assert_invariant(config.lutDimension <= 64);
             for (size_t g = 0; g < config.lutDimension; g++) {
                 for (size_t r = 0; r < config.lutDimension; r++) {
                     float3 v = float3{r, g, b} * (1.0f / float(config.lutDimension - 1u));
@@ -780,8 +860,10 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
                     // Apply OETF
                     v = c.oetf(v);
 
-                    *p++ = half4{v, 0.0f};
+                    row[r] = float4{ v, 0.0f };
                 }
+                floatToHalf(&p[0].x, &row[0].x, config.lutDimension * 4);
+                p += config.lutDimension;
             }
 
             if (converted) {
@@ -838,13 +920,18 @@ FColorGrading::FColorGrading(FEngine& engine, const Builder& builder) {
                     [](void* buffer, size_t, void*) { free(buffer); }
             }
     );
+
+    Builder key = builder;
+    key.toneMapper(nullptr);
+    cache.mEntries.push_back({ std::move(key), toneMapperResponse, mLutHandle, mDimension, 1,
+            cache.mTime++ });
 }
 
 FColorGrading::~FColorGrading() noexcept = default;
 
 void FColorGrading::terminate(FEngine& engine) {
     DriverApi& driver = engine.getDriverApi();
-    driver.destroyTexture(mLutHandle);
+    engine.getColorGradingLutCache().release(driver, mLutHandle);
 }
 
 } //namespace filament
@@ -19,12 +19,20 @@
 
 #include "downcast.h"
 
+#include "private/backend/DriverApi.h"
+
 #include <backend/DriverEnums.h>
 #include <backend/Handle.h>
 
 #include <filament/ColorGrading.h>
 
-#include <math/mathfwd.h>
+#include <math/vec3.h>
+
+#include <array>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
 
 namespace filament {
 
@@ -32,6 +40,36 @@ class FEngine;
 
 class FColorGrading : public ColorGrading {
 public:
+    /*
+     * LUTs of the recently built ColorGradings. ColorGradings built with the same parameters
+     * share their LUT, and a few LUTs are kept after their last ColorGrading is destroyed, so
+     * that going back to previous parameters doesn't compute and upload the LUT again.
+     */
+    class LutCache {
+    public:
+        // number of LUTs kept when they're not used by any ColorGrading
+        static constexpr size_t MAX_UNUSED_COUNT = 4;
+
+        LutCache() noexcept;
+        ~LutCache() noexcept;
+        LutCache(LutCache const&) = delete;
+        LutCache& operator=(LutCache const&) = delete;
+
+        // destroys all the LUTs, they must not be used anymore
+        void terminate(backend::DriverApi& driver) noexcept;
+
+        // number of ColorGradings that didn't need to compute their LUT
+        size_t getHitCount() const noexcept { return mHitCount; }
+
+    private:
+        friend class FColorGrading;
+        struct Entry;
+        void release(backend::DriverApi& driver, backend::TextureHandle handle) noexcept;
+        std::vector<Entry> mEntries;
+        uint64_t mTime = 0;
+        size_t mHitCount = 0;
+    };
+
     FColorGrading(FEngine& engine, const Builder& builder);
     FColorGrading(const FColorGrading& rhs) = delete;
     FColorGrading& operator=(const FColorGrading& rhs) = delete;
@@ -46,6 +84,9 @@ public:
     uint32_t getDimension() const noexcept { return mDimension; }
 
 private:
+    using ToneMapperResponse = std::array<math::float3, 8>;
+    static ToneMapperResponse getToneMapperResponse(ToneMapper const& toneMapper) noexcept;
+
     backend::TextureHandle mLutHandle;
     uint32_t mDimension;
 };
@@ -16,6 +16,7 @@
 
 #include "details/Engine.h"
 
+#include "EmbeddedPackage.h"
 #include "MaterialParser.h"
 #include "ResourceAllocator.h"
 #include "RenderPrimitive.h"
@@ -42,6 +43,7 @@
 
 #include <backend/DriverEnums.h>
 
+#include <utils/algorithm.h>
 #include <utils/compiler.h>
 #include <utils/debug.h>
 #include <utils/Log.h>
@@ -86,6 +88,7 @@ Engine* FEngine::create(Engine::Builder const& builder) {
     // Normally we launch a thread and create the context and Driver from there (see FEngine::loop).
     // In the single-threaded case, we do so in the here and now.
     if (!UTILS_HAS_THREADING) {
+        clock::time_point const driverStart = clock::now();
         Platform* platform = builder->mPlatform;
         void* const sharedContext = builder->mSharedContext;
 
@@ -104,11 +107,16 @@ Engine* FEngine::create(Engine::Builder const& builder) {
                 .textureUseAfterFreePoolSize = instance->getConfig().textureUseAfterFreePoolSize,
                 .metalUploadBufferSizeBytes = instance->getConfig().metalUploadBufferSizeBytes,
                 .disableParallelShaderCompile = instance->getConfig().disableParallelShaderCompile,
+                .shaderCompilerThreadCount = instance->getConfig().shaderCompilerThreadCount,
+                .deferredDestructionBudgetUs = instance->getConfig().deferredDestructionBudgetUs,
                 .disableHandleUseAfterFreeCheck = instance->getConfig().disableHandleUseAfterFreeCheck,
                 .forceGLES2Context = instance->getConfig().forceGLES2Context,
                 .stereoscopicType =  instance->getConfig().stereoscopicType,
+                .vulkanAsyncPipelineCreation = instance->getConfig().vulkanAsyncPipelineCreation,
+                .noopStatistics = instance->getConfig().noopDriverStatistics,
         };
         instance->mDriver = platform->createDriver(sharedContext, driverConfig);
+        instance->mDriverCreationDuration = clock::now() - driverStart;
 
     } else {
         // start the driver thread
@@ -206,12 +214,17 @@ FEngine::FEngine(Engine::Builder const& builder) :
         mCommandBufferQueue(
                 builder->mConfig.minCommandBufferSizeMB * MiB,
                 builder->mConfig.commandBufferSizeMB * MiB,
-                builder->mPaused),
+                builder->mPaused,
+                builder->mConfig.useHugePages),
         mPerRenderPassArena(
                 "FEngine::mPerRenderPassAllocator",
-                builder->mConfig.perRenderPassArenaSizeMB * MiB),
+                AreaPolicy::HugePageArea(
+                        builder->mConfig.perRenderPassArenaSizeMB * MiB,
+                        builder->mConfig.useHugePages)),
         mHeapAllocator("FEngine::mHeapAllocator", AreaPolicy::NullArea{}),
-        mJobSystem(getJobSystemThreadPoolSize(builder->mConfig)),
+        mJobSystem(getJobSystemThreadPoolSize(builder->mConfig), 1,
+                builder->mConfig.jobSystemPreferPerformanceCores ?
+                JobSystem::ThreadPlacement::PERFORMANCE_CORES : JobSystem::ThreadPlacement::ANY),
         mEngineEpoch(std::chrono::steady_clock::now()),
         mDriverBarrier(1),
         mMainThreadId(ThreadUtils::getThreadId()),
@@ -221,6 +234,8 @@ FEngine::FEngine(Engine::Builder const& builder) :
     // (it may not be the case)
     mJobSystem.adopt();
 
+    mTransformManager.setJobSystem(&mJobSystem);
+
     slog.i << "FEngine (" << sizeof(void*) * 8 << " bits) created at " << this << " "
            << "(threading is " << (UTILS_HAS_THREADING ? "enabled)" : "disabled)") << io::endl;
 }
@@ -232,6 +247,12 @@ uint32_t FEngine::getJobSystemThreadPoolSize(Engine::Config const& config) noexc
 
     // 1 thread for the user, 1 thread for the backend
     int threadCount = (int)std::thread::hardware_concurrency() - 2;
+    if (config.jobSystemPreferPerformanceCores) {
+        if (uint64_t const mask = JobSystem::getPerformanceCoreMask()) {
+            // the user and backend threads are expected to run on the performance cores too
+            threadCount = (int)utils::popcount(mask) - 2;
+        }
+    }
     // make sure we have at least 1 thread though
     threadCount = std::max(1, threadCount);
     return threadCount;
@@ -244,6 +265,9 @@ uint32_t FEngine::getJobSystemThreadPoolSize(Engine::Config const& config) noexc
 
 void FEngine::init() {
     SYSTRACE_CALL();
+    SYSTRACE_CONTEXT();
+
+    clock::time_point const initStart = clock::now();
 
     // this must be first.
     assert_invariant( intptr_t(&mDriverApiStorage) % alignof(DriverApi) == 0 );
@@ -251,6 +275,14 @@ void FEngine::init() {
 
     DriverApi& driverApi = getDriverApi();
 
+    if (mConfig.commandCaptureFile) {
+        mCommandCapture = std::make_unique<CommandCapture>(
+                mConfig.commandCaptureFile, std::max(mConfig.commandCaptureFrameCount, 1u));
+        driverApi.setCapture(mCommandCapture.get());
+        // the file name isn't owned by the Engine
+        mConfig.commandCaptureFile = nullptr;
+    }
+
     mActiveFeatureLevel = std::min(mActiveFeatureLevel, driverApi.getFeatureLevel());
 
 #ifndef FILAMENT_ENABLE_FEATURE_LEVEL_0
@@ -263,6 +295,14 @@ void FEngine::init() {
 
     mResourceAllocatorDisposer = std::make_shared<ResourceAllocatorDisposer>(driverApi);
 
+    // the commands recorded in parallel wouldn't be captured
+    if (mConfig.parallelCommandRecording && mJobSystem.getThreadCount() && !mCommandCapture) {
+        // the calling thread participates, so this is one stream per thread
+        mParallelCommandStreams = std::make_unique<ParallelCommandStreams>(*mDriver,
+                std::min(mJobSystem.getThreadCount() + 1, ParallelCommandStreams::MAX_COUNT),
+                getMinCommandBufferSize());
+    }
+
     mFullScreenTriangleVb = downcast(VertexBuffer::Builder()
             .vertexCount(3)
             .bufferCount(1)
@@ -341,34 +381,43 @@ void FEngine::init() {
     driverApi.update3DImage(mDummyZeroTexture, 0, 0, 0, 0, 1, 1, 1,
             { zeroes, 4, Texture::Format::RGBA, Texture::Type::UBYTE });
 
+    SYSTRACE_NAME_BEGIN("createDefaultMaterial");
+    clock::time_point const defaultMaterialStart = clock::now();
+    clock::duration defaultMaterialDuration{};
+
 #ifdef FILAMENT_ENABLE_FEATURE_LEVEL_0
     if (UTILS_UNLIKELY(mActiveFeatureLevel == FeatureLevel::FEATURE_LEVEL_0)) {
-        FMaterial::DefaultMaterialBuilder defaultMaterialBuilder;
-        defaultMaterialBuilder.package(
+        EmbeddedPackage const package(
                 MATERIALS_DEFAULTMATERIAL_FL0_DATA, MATERIALS_DEFAULTMATERIAL_FL0_SIZE);
+        FMaterial::DefaultMaterialBuilder defaultMaterialBuilder;
+        defaultMaterialBuilder.package(package.data(), package.size());
         mDefaultMaterial = downcast(defaultMaterialBuilder.build(*const_cast<FEngine*>(this)));
+        defaultMaterialDuration = clock::now() - defaultMaterialStart;
+        SYSTRACE_NAME_END();
     } else
 #endif
     {
-        mDefaultColorGrading = downcast(ColorGrading::Builder().build(*this));
-
-        FMaterial::DefaultMaterialBuilder defaultMaterialBuilder;
+        void const* data = MATERIALS_DEFAULTMATERIAL_DATA;
+        size_t size = MATERIALS_DEFAULTMATERIAL_SIZE;
         switch (mConfig.stereoscopicType) {
             case StereoscopicType::NONE:
             case StereoscopicType::INSTANCED:
-                defaultMaterialBuilder.package(
-                    MATERIALS_DEFAULTMATERIAL_DATA, MATERIALS_DEFAULTMATERIAL_SIZE);
                 break;
             case StereoscopicType::MULTIVIEW:
 #ifdef FILAMENT_ENABLE_MULTIVIEW
-                defaultMaterialBuilder.package(
-                    MATERIALS_DEFAULTMATERIAL_MULTIVIEW_DATA, MATERIALS_DEFAULTMATERIAL_MULTIVIEW_SIZE);
+                data = MATERIALS_DEFAULTMATERIAL_MULTIVIEW_DATA;
+                size = MATERIALS_DEFAULTMATERIAL_MULTIVIEW_SIZE;
 #else
                 assert_invariant(false);
 #endif
                 break;
         }
+        EmbeddedPackage const package(data, size);
+        FMaterial::DefaultMaterialBuilder defaultMaterialBuilder;
+        defaultMaterialBuilder.package(package.data(), package.size());
         mDefaultMaterial = downcast(defaultMaterialBuilder.build(*const_cast<FEngine*>(this)));
+        defaultMaterialDuration = clock::now() - defaultMaterialStart;
+        SYSTRACE_NAME_END();
 
         float3 dummyPositions[1] = {};
         short4 dummyTangents[1] = {};
@@ -391,7 +440,9 @@ void FEngine::init() {
         mDFG.init(*this);
     }
 
+    clock::time_point const postProcessStart = clock::now();
     mPostProcessManager.init();
+    clock::duration const postProcessDuration = clock::now() - postProcessStart;
 
     mDebugRegistry.registerProperty("d.shadowmap.debug_directional_shadowmap",
             &debug.shadowmap.debug_directional_shadowmap, [this]() {
@@ -425,7 +476,18 @@ void FEngine::init() {
                 });
             });
 
+    mDebugRegistry.registerProperty("d.stream.profiling", &debug.stream.profiling, [this]() {
+        getDriverApi().setProfilingEnabled(debug.stream.profiling);
+    });
+    mDebugRegistry.registerDataSource("d.stream.stats", &mCommandStreamStats, 1);
+
     mInitialized = true;
+
+    using ms = std::chrono::duration<float, std::milli>;
+    slog.i << "FEngine startup: driver " << ms(mDriverCreationDuration).count() << " ms, init "
+           << ms(clock::now() - initStart).count() << " ms (default material "
+           << ms(defaultMaterialDuration).count() << " ms, post-process "
+           << ms(postProcessDuration).count() << " ms)" << io::endl;
 }
 
 FEngine::~FEngine() noexcept {
@@ -493,6 +555,7 @@ void FEngine::shutdown() {
     cleanupResourceList(std::move(mScenes));
     cleanupResourceList(std::move(mSkyboxes));
     cleanupResourceList(std::move(mColorGradings));
+    mColorGradingLutCache.terminate(driver);
 
     // this must be done after Skyboxes and before materials
     destroy(mSkyboxMaterial);
@@ -504,14 +567,17 @@ void FEngine::shutdown() {
     cleanupResourceList(std::move(mVertexBuffers));
     cleanupResourceList(std::move(mTextures));
     cleanupResourceList(std::move(mRenderTargets));
-    cleanupResourceList(std::move(mMaterials));
-    cleanupResourceList(std::move(mInstanceBuffers));
+    // material instances release their uniforms into their material's heap
     for (auto& item : mMaterialInstances) {
         cleanupResourceList(std::move(item.second));
     }
+    cleanupResourceList(std::move(mMaterials));
+    cleanupResourceList(std::move(mInstanceBuffers));
 
     cleanupResourceListLocked(mFenceListLock, std::move(mFences));
 
+    mParallelCommandStreams.reset();
+
     driver.destroyTexture(mDummyOneTexture);
     driver.destroyTexture(mDummyOneTextureArray);
     driver.destroyTexture(mDummyZeroTexture);
@@ -543,6 +609,8 @@ void FEngine::shutdown() {
     getDriver().purge();
 
     // and destroy the CommandStream
+    getDriverApi().setCapture(nullptr);
+    mCommandCapture.reset();
     std::destroy_at(std::launder(reinterpret_cast<DriverApi*>(&mDriverApiStorage)));
 
     /*
@@ -560,6 +628,14 @@ void FEngine::prepare() {
     // skipped if the UBO hasn't changed. Still we could have a lot of these.
     FEngine::DriverApi& driver = getDriverApi();
 
+    mFrameCount++;
+
+    // The uniforms of the material instances that changed are uploaded with one update per
+    // page of their material's UniformHeap.
+    mMaterials.forEach([](FMaterial* material) {
+        material->getUniformHeap().beginBatch();
+    });
+
     for (auto& materialInstanceList: mMaterialInstances) {
         materialInstanceList.second.forEach([&driver](FMaterialInstance* item) {
             item->commit(driver);
@@ -572,7 +648,32 @@ void FEngine::prepare() {
         material->checkProgramEdits();
 #endif
         material->getDefaultInstance()->commit(driver);
+        material->getUniformHeap().flush(driver);
     });
+
+    // Upload the mipmaps of the reflection maps whose prefiltering is done.
+    if (UTILS_UNLIKELY(!mPendingPrefilters.empty())) {
+        mPendingPrefilters.erase(std::remove_if(mPendingPrefilters.begin(),
+                mPendingPrefilters.end(), [this](FTexture* texture) {
+                    return texture->updatePrefilterMipmap(*this);
+                }), mPendingPrefilters.end());
+    }
+}
+
+bool FEngine::hasPendingContentChanges() const noexcept {
+    if (!mStreams.empty()) {
+        return true;
+    }
+    bool dirty = false;
+    for (auto const& materialInstanceList: mMaterialInstances) {
+        materialInstanceList.second.forEach([&dirty](FMaterialInstance const* item) {
+            dirty = dirty || item->isDirty();
+        });
+    }
+    mMaterials.forEach([&dirty](FMaterial const* material) {
+        dirty = dirty || material->getDefaultInstance()->isDirty();
+    });
+    return dirty;
 }
 
 void FEngine::gc() {
@@ -641,6 +742,7 @@ void FEngine::flushAndWait() {
 // -----------------------------------------------------------------------------------------------
 
 int FEngine::loop() {
+    clock::time_point const driverStart = clock::now();
     if (mPlatform == nullptr) {
         mPlatform = PlatformFactory::create(&mBackend);
         mOwnPlatform = true;
@@ -683,11 +785,16 @@ int FEngine::loop() {
             .textureUseAfterFreePoolSize = mConfig.textureUseAfterFreePoolSize,
             .metalUploadBufferSizeBytes = mConfig.metalUploadBufferSizeBytes,
             .disableParallelShaderCompile = mConfig.disableParallelShaderCompile,
+            .shaderCompilerThreadCount = mConfig.shaderCompilerThreadCount,
+            .deferredDestructionBudgetUs = mConfig.deferredDestructionBudgetUs,
             .disableHandleUseAfterFreeCheck = mConfig.disableHandleUseAfterFreeCheck,
             .forceGLES2Context = mConfig.forceGLES2Context,
             .stereoscopicType =  mConfig.stereoscopicType,
+            .vulkanAsyncPipelineCreation = mConfig.vulkanAsyncPipelineCreation,
+            .noopStatistics = mConfig.noopDriverStatistics,
     };
     mDriver = mPlatform->createDriver(mSharedGLContext, driverConfig);
+    mDriverCreationDuration = clock::now() - driverStart;
 
     mDriverBarrier.latch();
     if (UTILS_UNLIKELY(!mDriver)) {
@@ -721,6 +828,19 @@ const FMaterial* FEngine::getSkyboxMaterial() const noexcept {
     return material;
 }
 
+const FColorGrading* FEngine::getDefaultColorGrading() const noexcept {
+    FColorGrading* colorGrading = mDefaultColorGrading;
+    if (UTILS_UNLIKELY(colorGrading == nullptr)) {
+        // color grading is not supported at feature level 0
+        if (mActiveFeatureLevel > FeatureLevel::FEATURE_LEVEL_0) {
+            SYSTRACE_NAME("createDefaultColorGrading");
+            colorGrading = downcast(ColorGrading::Builder().build(*const_cast<FEngine*>(this)));
+            mDefaultColorGrading = colorGrading;
+        }
+    }
+    return colorGrading;
+}
+
 // -----------------------------------------------------------------------------------------------
 // Resource management
 // -----------------------------------------------------------------------------------------------
@@ -894,6 +1014,22 @@ void FEngine::createRenderable(const RenderableManager::Builder& builder, Entity
     }
 }
 
+void FEngine::createRenderables(const RenderableManager::Builder& builder,
+        Entity const* entities, size_t count) {
+    mRenderableManager.create(builder, entities, count);
+    auto& tcm = mTransformManager;
+    // if these entities don't have a transform component, add one. Typically, either all of
+    // them or none of them do.
+    if (!tcm.hasComponent(entities[0])) {
+        tcm.reserve(count);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!tcm.hasComponent(entities[i])) {
+            tcm.create(entities[i], 0, mat4f());
+        }
+    }
+}
+
 void FEngine::createLight(const LightManager::Builder& builder, Entity entity) {
     mLightManager.create(builder, entity);
 }
@@ -1214,6 +1350,13 @@ size_t FEngine::getSkyboxeCount() const noexcept { return mSkyboxes.size(); }
 size_t FEngine::getColorGradingCount() const noexcept { return mColorGradings.size(); }
 size_t FEngine::getRenderTargetCount() const noexcept { return mRenderTargets.size(); }
 
+void FEngine::writeVariantUsageProfile(io::ostream& out) const noexcept {
+    out << "# filament variant usage profile" << io::endl;
+    mMaterials.forEach([&out](FMaterial const* material) {
+        material->writeVariantUsageProfile(out);
+    });
+}
+
 void* FEngine::streamAlloc(size_t size, size_t alignment) noexcept {
     // we allow this only for small allocations
     if (size > 65536) {
@@ -1222,6 +1365,68 @@ void* FEngine::streamAlloc(size_t size, size_t alignment) noexcept {
     return getDriverApi().allocate(size, alignment);
 }
 
+void FEngine::updateCommandStreamStats() noexcept {
+    CommandBufferQueue::Stats const queueStats = mCommandBufferQueue.getStats();
+    CommandStreamStats stats;
+    stats.size = queueStats.flushedSize;
+    stats.flushCount = queueStats.flushCount;
+    stats.waitCount = queueStats.waitCount;
+    stats.waitDuration = queueStats.waitDuration;
+    if (UTILS_UNLIKELY(debug.stream.profiling)) {
+        auto const commands = getDriverApi().getProfilingStats();
+        for (auto const& command : commands) {
+            stats.commandCount += command.count;
+            stats.duration += command.duration;
+        }
+        stats.commandTypeCount = std::min(commands.size(), CommandStreamStats::MAX_COMMAND_TYPES);
+        for (size_t i = 0; i < stats.commandTypeCount; i++) {
+            auto const& command = commands[i];
+            stats.commands[i] = { command.name, command.count, command.bytes, command.duration };
+        }
+    }
+    mCommandStreamStats = stats;
+}
+
+FEngine::MemoryStats FEngine::getMemoryStats() const noexcept {
+    MemoryStats stats;
+    stats.textures = mTextureMemorySize;
+    stats.buffers = mBufferMemorySize;
+    mViews.forEach([&stats](FView const* view) {
+        stats.transientTextures += view->getPeakTransientMemorySize();
+    });
+    mRenderers.forEach([&stats](FRenderer const* renderer) {
+        ResourceAllocator const& allocator = renderer->getResourceAllocator();
+        stats.textureCache += allocator.getCacheSize();
+        stats.textureCacheHighWatermark += allocator.getCacheSizeHighWatermark();
+        stats.renderPassCommandsHighWatermark = std::max(
+                stats.renderPassCommandsHighWatermark, renderer->getCommandsHighWatermark());
+        stats.frameGraphArenaHighWatermark = std::max(
+                stats.frameGraphArenaHighWatermark, renderer->getFrameGraphHighWatermark());
+    });
+    stats.commandBuffer = getCommandBufferSize();
+    stats.commandBufferHighWatermark = mCommandBufferQueue.getHighWatermark();
+    stats.perRenderPassArena = getPerRenderPassArenaSize();
+    stats.device = getDriver().getAllocatedMemorySize();
+    return stats;
+}
+
+FEngine::DriverStats FEngine::getDriverStats() const noexcept {
+    Driver::Statistics const s = getDriver().getStatistics();
+    DriverStats stats;
+    stats.frameCount = s.frameCount;
+    stats.renderPassCount = s.renderPassCount;
+    stats.drawCount = s.drawCount;
+    stats.pipelineBindCount = s.pipelineBindCount;
+    stats.redundantPipelineBindCount = s.redundantPipelineBindCount;
+    stats.primitiveBindCount = s.primitiveBindCount;
+    stats.redundantPrimitiveBindCount = s.redundantPrimitiveBindCount;
+    stats.bufferUploadCount = s.bufferUploadCount;
+    stats.bufferUploadSize = s.bufferUploadSize;
+    stats.textureUploadCount = s.textureUploadCount;
+    stats.textureUploadSize = s.textureUploadSize;
+    return stats;
+}
+
 bool FEngine::execute() {
     // wait until we get command buffers to be executed (or thread exit requested)
     auto buffers = mCommandBufferQueue.waitForCommands();
@@ -24,6 +24,7 @@
 #include "PostProcessManager.h"
 #include "ResourceList.h"
 #include "HwVertexBufferInfoFactory.h"
+#include "ParallelCommandStreams.h"
 
 #include "components/CameraManager.h"
 #include "components/LightManager.h"
@@ -43,6 +44,7 @@
 #include "details/Skybox.h"
 
 #include "private/backend/CommandBufferQueue.h"
+#include "private/backend/CommandCapture.h"
 #include "private/backend/CommandStream.h"
 #include "private/backend/DriverApi.h"
 
@@ -65,6 +67,8 @@
 #include <utils/JobSystem.h>
 #include <utils/compiler.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <new>
@@ -72,12 +76,14 @@
 #include <thread>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #if FILAMENT_ENABLE_MATDBG
 #include <matdbg/DebugServer.h>
 #else
 namespace filament::matdbg {
 class DebugServer;
+struct FrameStats;
 using MaterialKey = uint32_t;
 } // namespace filament::matdbg
 #endif
@@ -154,7 +160,8 @@ public:
     const FMaterial* getSkyboxMaterial() const noexcept;
     const FIndirectLight* getDefaultIndirectLight() const noexcept { return mDefaultIbl; }
     const FTexture* getDummyCubemap() const noexcept { return mDefaultIblTexture; }
-    const FColorGrading* getDefaultColorGrading() const noexcept { return mDefaultColorGrading; }
+    // the default ColorGrading's LUT is only computed when a View first needs it
+    const FColorGrading* getDefaultColorGrading() const noexcept;
     FMorphTargetBuffer* getDummyMorphTargetBuffer() const { return mDummyMorphTargetBuffer; }
 
     backend::Handle<backend::HwRenderPrimitive> getFullScreenRenderPrimitive() const noexcept {
@@ -189,6 +196,10 @@ public:
         return getDriver().isStereoSupported();
     }
 
+    bool isVariableRateShadingSupported() const noexcept {
+        return getDriver().isVariableRateShadingSupported();
+    }
+
     static size_t getMaxStereoscopicEyes() noexcept {
         return CONFIG_MAX_STEREOSCOPIC_EYES;
     }
@@ -201,6 +212,11 @@ public:
         return mPostProcessManager;
     }
 
+    // this is null unless Config::parallelCommandRecording is set
+    ParallelCommandStreams* getParallelCommandStreams() noexcept {
+        return mParallelCommandStreams.get();
+    }
+
     FRenderableManager& getRenderableManager() noexcept {
         return mRenderableManager;
     }
@@ -293,6 +309,8 @@ public:
     FRenderTarget* createRenderTarget(const RenderTarget::Builder& builder) noexcept;
 
     void createRenderable(const RenderableManager::Builder& builder, utils::Entity entity);
+    void createRenderables(const RenderableManager::Builder& builder,
+            utils::Entity const* entities, size_t count);
     void createLight(const LightManager::Builder& builder, utils::Entity entity);
 
     FRenderer* createRenderer() noexcept;
@@ -363,6 +381,8 @@ public:
     size_t getVertexBufferCount() const noexcept;
     size_t getIndirectLightCount() const noexcept;
     size_t getMaterialCount() const noexcept;
+
+    void writeVariantUsageProfile(utils::io::ostream& out) const noexcept;
     size_t getTextureCount() const noexcept;
     size_t getSkyboxeCount() const noexcept;
     size_t getColorGradingCount() const noexcept;
@@ -373,6 +393,30 @@ public:
     bool isPaused() const noexcept;
     void setPaused(bool paused);
 
+    void setCommandStreamProfilingEnabled(bool enabled) noexcept {
+        debug.stream.profiling = enabled;
+        getDriverApi().setProfilingEnabled(enabled);
+    }
+
+    bool isCommandStreamProfilingEnabled() const noexcept {
+        return debug.stream.profiling;
+    }
+
+    CommandStreamStats getCommandStreamStats() const noexcept {
+        return mCommandStreamStats;
+    }
+
+    // collects the statistics of the frame that just ended, called by FRenderer::endFrame()
+    void updateCommandStreamStats() noexcept;
+
+    MemoryStats getMemoryStats() const noexcept;
+
+    DriverStats getDriverStats() const noexcept;
+
+    // keeps track of the estimated size of the textures and buffers created by the user
+    void trackTextureMemory(ptrdiff_t delta) noexcept { mTextureMemorySize += delta; }
+    void trackBufferMemory(ptrdiff_t delta)  noexcept { mBufferMemorySize += delta; }
+
     void flushAndWait();
 
     // flush the current buffer
@@ -400,6 +444,19 @@ public:
     void prepare();
     void gc();
 
+    // number of Renderer frames started so far, i.e. of calls to prepare()
+    uint64_t getFrameCount() const noexcept { return mFrameCount; }
+
+    // Changes whenever the content of a buffer or texture is set, or the entities of a scene
+    // change. Along with the change counts of the component managers, this lets the Renderer
+    // tell when a frame would be identical to the previous one.
+    uint64_t getContentVersion() const noexcept { return mContentVersion; }
+    void markContentChanged() noexcept { mContentVersion++; }
+
+    // Whether the content can change without any of the above, i.e. there are material
+    // parameters to commit, or streams that can get new images at any time.
+    bool hasPendingContentChanges() const noexcept;
+
     using ShaderContent = utils::FixedCapacityVector<uint8_t>;
 
     ShaderContent& getVertexShaderContent() const noexcept {
@@ -420,6 +477,20 @@ public:
         return mJobSystem;
     }
 
+    FColorGrading::LutCache& getColorGradingLutCache() noexcept {
+        return mColorGradingLutCache;
+    }
+
+    // textures with a pending Texture::generatePrefilterMipmapAsync(), polled by prepare()
+    void addPendingPrefilter(FTexture* texture) {
+        mPendingPrefilters.push_back(texture);
+    }
+
+    void removePendingPrefilter(FTexture* texture) {
+        mPendingPrefilters.erase(std::remove(mPendingPrefilters.begin(), mPendingPrefilters.end(),
+                texture), mPendingPrefilters.end());
+    }
+
     std::default_random_engine& getRandomEngine() {
         return mRandomEngine;
     }
@@ -441,6 +512,17 @@ public:
         return mAutomaticInstancingEnabled;
     }
 
+    // Accumulates the number of draw calls saved by automatic instancing, this can be called
+    // from any thread.
+    void addInstancingDrawCallsSaved(uint32_t count) noexcept {
+        mInstancingDrawCallsSaved.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // Returns the number of draw calls saved by automatic instancing since the last call.
+    uint32_t getAndResetInstancingDrawCallsSaved() noexcept {
+        return mInstancingDrawCallsSaved.exchange(0, std::memory_order_relaxed);
+    }
+
     HwVertexBufferInfoFactory& getVertexBufferInfoFactory() noexcept {
         return mHwVertexBufferInfoFactory;
     }
@@ -499,6 +581,7 @@ private:
     Platform* mPlatform = nullptr;
     bool mOwnPlatform = false;
     bool mAutomaticInstancingEnabled = false;
+    std::atomic<uint32_t> mInstancingDrawCallsSaved{};
     void* mSharedGLContext = nullptr;
     backend::Handle<backend::HwRenderPrimitive> mFullScreenTriangleRph;
     FVertexBuffer* mFullScreenTriangleVb = nullptr;
@@ -506,6 +589,8 @@ private:
     math::mat4f mUvFromClipMatrix;
 
     PostProcessManager mPostProcessManager;
+    std::unique_ptr<ParallelCommandStreams> mParallelCommandStreams;
+    std::unique_ptr<backend::CommandCapture> mCommandCapture;
 
     utils::EntityManager& mEntityManager;
     FRenderableManager mRenderableManager;
@@ -531,6 +616,10 @@ private:
     ResourceList<FTexture> mTextures{ "Texture" };
     ResourceList<FSkybox> mSkyboxes{ "Skybox" };
     ResourceList<FColorGrading> mColorGradings{ "ColorGrading" };
+    FColorGrading::LutCache mColorGradingLutCache;
+    std::vector<FTexture*> mPendingPrefilters;
+    uint64_t mFrameCount = 0;
+    uint64_t mContentVersion = 0;
     ResourceList<FRenderTarget> mRenderTargets{ "RenderTarget" };
 
     // the fence list is accessed from multiple threads
@@ -572,6 +661,8 @@ private:
     FMorphTargetBuffer* mDummyMorphTargetBuffer = nullptr;
 
     mutable utils::CountDownLatch mDriverBarrier;
+    // time spent creating the platform and the driver, logged at the end of init()
+    clock::duration mDriverCreationDuration{};
 
     mutable ShaderContent mVertexShaderContent;
     mutable ShaderContent mFragmentShaderContent;
@@ -586,6 +677,10 @@ private:
 
     bool mInitialized = false;
 
+    CommandStreamStats mCommandStreamStats;
+    size_t mTextureMemorySize = 0;
+    size_t mBufferMemorySize = 0;
+
     // Creation parameters
     Config mConfig;
 
@@ -601,6 +696,7 @@ public:
             bool visualize_cascades = false;
             bool disable_light_frustum_align = false;
             bool depth_clamp = true;
+            bool cull_casters_by_receivers = true;
             float dzn = -1.0f;
             float dzf =  1.0f;
             float display_shadow_texture_scale = 0.25f;
@@ -625,6 +721,9 @@ public:
             bool doFrameCapture = false;
             bool disable_buffer_padding = false;
             bool disable_subpasses = false;
+            // When set to true, the FrameGraph tile memory report of the next view rendered is
+            // logged, then this is reset to false.
+            bool print_tile_memory_report = false;
         } renderer;
         struct {
             bool debug_froxel_visualization = false;
@@ -632,7 +731,12 @@ public:
         struct {
             bool combine_multiview_images = false;
         } stereo;
+        struct {
+            bool profiling = false;
+        } stream;
         matdbg::DebugServer* server = nullptr;
+        // set by the Renderer during frames whose statistics are streamed by the debug server
+        matdbg::FrameStats* frameStats = nullptr;
     } debug;
 };
 
@@ -54,7 +54,9 @@ IndexBuffer* IndexBuffer::Builder::build(Engine& engine) {
 // ------------------------------------------------------------------------------------------------
 
 FIndexBuffer::FIndexBuffer(FEngine& engine, const IndexBuffer::Builder& builder)
-        : mIndexCount(builder->mIndexCount) {
+        : mIndexCount(builder->mIndexCount),
+          mByteCount(builder->mIndexCount *
+                  (builder->mIndexType == IndexType::USHORT ? sizeof(uint16_t) : sizeof(uint32_t))) {
     FEngine::DriverApi& driver = engine.getDriverApi();
     mHandle = driver.createIndexBuffer(
             (backend::ElementType)builder->mIndexType,
@@ -63,14 +65,17 @@ FIndexBuffer::FIndexBuffer(FEngine& engine, const IndexBuffer::Builder& builder)
     if (auto name = builder.getName(); !name.empty()) {
         driver.setDebugTag(mHandle.getId(), std::move(name));
     }
+    engine.trackBufferMemory(ptrdiff_t(mByteCount));
 }
 
 void FIndexBuffer::terminate(FEngine& engine) {
     FEngine::DriverApi& driver = engine.getDriverApi();
     driver.destroyIndexBuffer(mHandle);
+    engine.trackBufferMemory(-ptrdiff_t(mByteCount));
 }
 
 void FIndexBuffer::setBuffer(FEngine& engine, BufferDescriptor&& buffer, uint32_t byteOffset) {
+    engine.markContentChanged();
     engine.getDriverApi().updateIndexBuffer(mHandle, std::move(buffer), byteOffset);
 }
 
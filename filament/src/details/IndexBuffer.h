@@ -46,6 +46,7 @@ private:
     friend class IndexBuffer;
     backend::Handle<backend::HwIndexBuffer> mHandle;
     uint32_t mIndexCount;
+    uint32_t mByteCount;
 };
 
 FILAMENT_DOWNCAST(IndexBuffer)
@@ -192,6 +192,17 @@ FIndirectLight::FIndirectLight(FEngine& engine, const Builder& builder) noexcept
     }
 }
 
+void FIndirectLight::setIrradiance(uint8_t bands, float3 const* sh, float blend) noexcept {
+    // clamp to 3 bands for now
+    bands = std::min(bands, uint8_t(3));
+    blend = saturate(blend);
+    const size_t numCoefs = bands * bands;
+    for (size_t i = 0; i < mIrradianceCoefs.size(); i++) {
+        const float3 target = i < numCoefs ? sh[i] : float3{ 0.0f };
+        mIrradianceCoefs[i] = mix(mIrradianceCoefs[i], target, blend);
+    }
+}
+
 void FIndirectLight::terminate(FEngine& engine) {
     if (CONFIG_IBL_USE_IRRADIANCE_MAP) {
         FEngine::DriverApi& driver = engine.getDriverApi();
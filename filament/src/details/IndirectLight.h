@@ -49,6 +49,7 @@ public:
     void setIntensity(float intensity) noexcept { mIntensity = intensity; }
     void setRotation(math::mat3f const& rotation) noexcept { mRotation = rotation; }
     const math::mat3f& getRotation() const noexcept { return mRotation; }
+    void setIrradiance(uint8_t bands, math::float3 const* sh, float blend) noexcept;
     FTexture const* getReflectionsTexture() const noexcept { return mReflectionsTexture; }
     FTexture const* getIrradianceTexture() const noexcept { return mIrradianceTexture; }
     size_t getLevelCount() const noexcept { return mLevelCount; }
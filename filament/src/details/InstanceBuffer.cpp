@@ -19,11 +19,20 @@
 #include <details/Engine.h>
 #include <private/filament/UibStructs.h>
 
+#include "Culler.h"
 #include "FilamentAPI-impl.h"
 
 #include <math/mat3.h>
+#include <math/mat4.h>
 #include <math/vec3.h>
 
+#include <utils/debug.h>
+
+#include <algorithm>
+
+#include <stdlib.h>
+#include <string.h>
+
 namespace filament {
 
 using namespace backend;
@@ -31,6 +40,7 @@ using namespace backend;
 struct InstanceBuffer::BuilderDetails {
     size_t mInstanceCount = 0;
     math::mat4f const* mLocalTransforms = nullptr;
+    Box mInstanceBoundingBox;
 };
 
 using BuilderType = InstanceBuffer;
@@ -50,6 +60,12 @@ InstanceBuffer::Builder& InstanceBuffer::Builder::localTransforms(
     return *this;
 }
 
+InstanceBuffer::Builder& InstanceBuffer::Builder::instanceBoundingBox(
+        Box const& instanceBoundingBox) noexcept {
+    mImpl->mInstanceBoundingBox = instanceBoundingBox;
+    return *this;
+}
+
 InstanceBuffer* InstanceBuffer::Builder::build(Engine& engine) {
     FILAMENT_CHECK_PRECONDITION(mImpl->mInstanceCount >= 1) << "instanceCount must be >= 1.";
     FILAMENT_CHECK_PRECONDITION(mImpl->mInstanceCount <= engine.getMaxAutomaticInstances())
@@ -62,7 +78,8 @@ InstanceBuffer* InstanceBuffer::Builder::build(Engine& engine) {
 // ------------------------------------------------------------------------------------------------
 
 FInstanceBuffer::FInstanceBuffer(FEngine& engine, const Builder& builder)
-    : mName(builder.getName()) {
+    : mEngine(engine), mName(builder.getName()),
+      mInstanceBoundingBox(builder->mInstanceBoundingBox) {
     mInstanceCount = builder->mInstanceCount;
 
     mLocalTransforms.reserve(mInstanceCount);
@@ -81,30 +98,88 @@ void FInstanceBuffer::setLocalTransforms(
             << " instances, but trying to set " << count 
             << " transforms at offset " << offset << ".";
     memcpy(mLocalTransforms.data() + offset, localTransforms, sizeof(math::mat4f) * count);
+    mEngine.markContentChanged();
 }
 
-void FInstanceBuffer::prepare(FEngine& engine, math::mat4f rootTransform,
-        const PerRenderableData& ubo, Handle<HwBufferObject> handle) {
+uint32_t FInstanceBuffer::prepare(FEngine& engine, math::mat4f rootTransform,
+        math::mat4f const& dequantization, const PerRenderableData& ubo,
+        Handle<HwBufferObject> handle, Frustum const* frustum) {
     DriverApi& driver = engine.getDriverApi();
 
+    size_t const count = mInstanceCount;
+    assert_invariant(count <= CONFIG_MAX_INSTANCES);
+
+    // The culler works on batches of Culler::MODULO boxes, CONFIG_MAX_INSTANCES is a multiple.
+    Culler::result_type visible[CONFIG_MAX_INSTANCES];
+    if (frustum && !mInstanceBoundingBox.isEmpty()) {
+        math::float3 centers[CONFIG_MAX_INSTANCES];
+        math::float3 extents[CONFIG_MAX_INSTANCES];
+        for (size_t i = 0, c = Culler::round(count); i < c; i++) {
+            if (i < count) {
+                math::mat4f const model = rootTransform * mLocalTransforms[i];
+                Box const box = Box::transform(model.upperLeft(), model[3].xyz,
+                        mInstanceBoundingBox);
+                centers[i] = box.center;
+                extents[i] = box.halfExtent;
+            } else {
+                centers[i] = extents[i] = math::float3{};
+            }
+            visible[i] = 0;
+        }
+        Culler::intersects(visible, *frustum, centers, extents, count, 0);
+    } else {
+        std::fill_n(visible, count, Culler::result_type(1));
+    }
+
+    // The visible instances are packed at the start of the buffer, which is all the shader needs
+    // since it indexes it with the instance index.
     // TODO: allocate this staging buffer from a pool.
-    uint32_t stagingBufferSize = sizeof(PerRenderableUib);
+    uint32_t const stagingBufferSize = sizeof(PerRenderableUib);
     PerRenderableData* stagingBuffer = (PerRenderableData*)::malloc(stagingBufferSize);
-    // TODO: consider using JobSystem to parallelize this.
-    for (size_t i = 0, c = mInstanceCount; i < c; i++) {
-        stagingBuffer[i] = ubo;
-        math::mat4f model = rootTransform * mLocalTransforms[i];
-        stagingBuffer[i].worldFromModelMatrix = model;
-
-        math::mat3f m = math::mat3f::getTransformForNormals(model.upperLeft());
-        stagingBuffer[i].worldFromModelNormalMatrix = math::prescaleForNormals(m);
+    // the local transforms of the previous frame are not kept, we assume they didn't change.
+    // The dequantization must come after them, so it's taken out of the renderable's matrix.
+    math::mat4f const previousRootTransform =
+            ubo.previousWorldFromModelMatrix.toMat4f() * inverse(dequantization);
+    uint32_t visibleCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!(visible[i] & 1u)) {
+            continue;
+        }
+        PerRenderableData& data = stagingBuffer[visibleCount++];
+        data = ubo;
+        math::mat4f const model = rootTransform * mLocalTransforms[i];
+        data.worldFromModelMatrix = model * dequantization;
+        data.previousWorldFromModelMatrix =
+                previousRootTransform * mLocalTransforms[i] * dequantization;
+
+        math::mat3f const m = math::mat3f::getTransformForNormals(model.upperLeft());
+        data.worldFromModelNormalMatrix = math::prescaleForNormals(m);
+    }
+
+    if (UTILS_UNLIKELY(!visibleCount)) {
+        // Drawing an instance outside the frustum is cheaper than having every backend and pass
+        // skip empty draws, the GPU clips it anyway.
+        PerRenderableData& data = stagingBuffer[0];
+        data = ubo;
+        math::mat4f const model = rootTransform * mLocalTransforms[0];
+        data.worldFromModelMatrix = model * dequantization;
+        data.previousWorldFromModelMatrix =
+                previousRootTransform * mLocalTransforms[0] * dequantization;
+
+        math::mat3f const m = math::mat3f::getTransformForNormals(model.upperLeft());
+        data.worldFromModelNormalMatrix = math::prescaleForNormals(m);
+        visibleCount = 1;
     }
+
+    // only upload what is used
     driver.updateBufferObject(handle, {
-            stagingBuffer, stagingBufferSize,
+            stagingBuffer, visibleCount * sizeof(PerRenderableData),
             +[](void* buffer, size_t, void*) {
                 ::free(buffer);
             }
     }, 0);
+
+    return visibleCount;
 }
 
 void FInstanceBuffer::terminate(FEngine& engine) {
@@ -19,6 +19,7 @@
 
 #include "downcast.h"
 
+#include <filament/Box.h>
 #include <filament/InstanceBuffer.h>
 
 #include <backend/Handle.h>
@@ -28,9 +29,12 @@
 #include <utils/CString.h>
 #include <utils/FixedCapacityVector.h>
 
+#include <stdint.h>
+
 namespace filament {
 
 class FEngine;
+class Frustum;
 
 struct PerRenderableData;
 
@@ -44,16 +48,22 @@ public:
 
     void setLocalTransforms(math::mat4f const* localTransforms, size_t count, size_t offset);
 
-    void prepare(FEngine& engine, math::mat4f rootTransform, const PerRenderableData& ubo,
-            backend::Handle<backend::HwBufferObject> handle);
+    // Uploads the world transforms of the instances that intersect `frustum`, or of all of them
+    // if `frustum` is null, and returns how many were uploaded. `dequantization` maps the
+    // quantized positions of the renderable to model space, it's identity when they aren't.
+    uint32_t prepare(FEngine& engine, math::mat4f rootTransform,
+            math::mat4f const& dequantization, const PerRenderableData& ubo,
+            backend::Handle<backend::HwBufferObject> handle, Frustum const* frustum);
 
     utils::CString const& getName() const noexcept { return mName; }
 
 private:
     friend class RenderableManager;
 
+    FEngine& mEngine;
     utils::FixedCapacityVector<math::mat4f> mLocalTransforms;
     utils::CString mName;
+    Box mInstanceBoundingBox;
     size_t mInstanceCount;
 };
 
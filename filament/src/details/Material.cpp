@@ -285,6 +285,7 @@ FMaterial::FMaterial(FEngine& engine, const Material::Builder& builder,
     parser->getVertexDomain(&mVertexDomain);
     parser->getMaterialDomain(&mMaterialDomain);
     parser->getMaterialVariantFilterMask(&mVariantFilterMask);
+    parser->getMaterialSpecializedVariants(&mSpecializedVariants);
     parser->getRequiredAttributes(&mRequiredAttributes);
     parser->getRefractionMode(&mRefractionMode);
     parser->getRefractionType(&mRefractionType);
@@ -331,6 +332,11 @@ FMaterial::FMaterial(FEngine& engine, const Material::Builder& builder,
     processPushConstants(engine, parser);
     processDepthVariants(engine, parser);
 
+    // ES2 emulates uniform buffers, and tracks their changes per buffer object rather than per
+    // range, so we can't sub-allocate them.
+    mUniformHeap.init(mUniformInterfaceBlock.getSize(),
+            engine.getActiveFeatureLevel() > FeatureLevel::FEATURE_LEVEL_0);
+
     // we can only initialize the default instance once we're initialized ourselves
     new(&mDefaultInstanceStorage) FMaterialInstance(engine, this);
 
@@ -407,6 +413,8 @@ void FMaterial::terminate(FEngine& engine) {
     destroyPrograms(engine);
 
     getDefaultInstance()->terminate(engine);
+
+    mUniformHeap.terminate(engine.getDriverApi());
 }
 
 void FMaterial::compile(CompilerPriorityQueue priority,
@@ -475,7 +483,8 @@ bool FMaterial::hasVariant(Variant variant) const noexcept {
     switch (getMaterialDomain()) {
         case MaterialDomain::SURFACE:
             vertexVariant = Variant::filterVariantVertex(variant);
-            fragmentVariant = Variant::filterVariantFragment(variant);
+            fragmentVariant = Variant::filterUserVariant(
+                    Variant::filterVariantFragment(variant), mSpecializedVariants);
             break;
         case MaterialDomain::POST_PROCESS:
             vertexVariant = fragmentVariant = variant;
@@ -519,7 +528,8 @@ void FMaterial::getSurfaceProgramSlow(Variant variant,
     assert_invariant(!Variant::isReserved(variant));
 
     Variant const vertexVariant   = Variant::filterVariantVertex(variant);
-    Variant const fragmentVariant = Variant::filterVariantFragment(variant);
+    Variant const fragmentVariant = Variant::filterUserVariant(
+            Variant::filterVariantFragment(variant), mSpecializedVariants);
 
     Program pb{ getProgramWithVariants(variant, vertexVariant, fragmentVariant) };
     pb.priorityQueue(priorityQueue);
@@ -547,6 +557,9 @@ Program FMaterial::getProgramWithVariants(
      * Vertex shader
      */
 
+    mUsedVertexVariants.set(vertexVariant.key);
+    mUsedFragmentVariants.set(fragmentVariant.key);
+
     ShaderContent& vsBuilder = engine.getVertexShaderContent();
 
     UTILS_UNUSED_IN_RELEASE bool const vsOK = mMaterialParser->getShader(vsBuilder, sm,
@@ -606,7 +619,23 @@ Program FMaterial::getProgramWithVariants(
         program.attributes(mAttributeInfo);
     }
 
-    program.specializationConstants(mSpecializationConstants);
+    if (UTILS_UNLIKELY(mSpecializedVariants)) {
+        // the specialized variant bits are passed to the shared shaders
+        auto specializationConstants =
+                FixedCapacityVector<Program::SpecializationConstant>::with_capacity(
+                        mSpecializationConstants.size() + 1);
+        for (auto const& constant : mSpecializationConstants) {
+            specializationConstants.push_back(constant);
+        }
+        if (mSpecializedVariants & UserVariantFilterMask(UserVariantFilterBit::FOG)) {
+            specializationConstants.push_back({
+                    +ReservedSpecializationConstants::CONFIG_VARIANT_FOG,
+                    Variant::isFogVariant(variant) });
+        }
+        program.specializationConstants(std::move(specializationConstants));
+    } else {
+        program.specializationConstants(mSpecializationConstants);
+    }
 
     program.pushConstants(ShaderStage::VERTEX, mPushConstants[(uint8_t) ShaderStage::VERTEX]);
     program.pushConstants(ShaderStage::FRAGMENT, mPushConstants[(uint8_t) ShaderStage::FRAGMENT]);
@@ -616,11 +645,26 @@ Program FMaterial::getProgramWithVariants(
     return program;
 }
 
+void FMaterial::writeVariantUsageProfile(io::ostream& out) const noexcept {
+    out << "material " << mName.c_str_safe() << io::endl;
+    out << "vertex";
+    mUsedVertexVariants.forEachSetBit([&out](size_t key) { out << " " << unsigned(key); });
+    out << io::endl;
+    out << "fragment";
+    mUsedFragmentVariants.forEachSetBit([&out](size_t key) { out << " " << unsigned(key); });
+    out << io::endl;
+}
+
 void FMaterial::createAndCacheProgram(Program&& p, Variant variant) const noexcept {
     auto program = mEngine.getDriverApi().createProgram(std::move(p));
     mEngine.getDriverApi().setDebugTag(program.getId(), mName);
     assert_invariant(program);
     mCachedPrograms[variant.key] = program;
+#if FILAMENT_ENABLE_MATDBG
+    if (UTILS_UNLIKELY(mEngine.debug.frameStats)) {
+        mEngine.debug.frameStats->programCount++;
+    }
+#endif
 }
 
 size_t FMaterial::getParameters(ParameterInfo* parameters, size_t count) const noexcept {
@@ -21,6 +21,8 @@
 
 #include "details/MaterialInstance.h"
 
+#include "UniformHeap.h"
+
 #include <filament/Material.h>
 #include <filament/MaterialEnums.h>
 
@@ -37,12 +39,14 @@
 #include <backend/Handle.h>
 #include <backend/Program.h>
 
+#include <utils/bitset.h>
 #include <utils/compiler.h>
 #include <utils/CString.h>
 #include <utils/debug.h>
 #include <utils/FixedCapacityVector.h>
 #include <utils/Invocable.h>
 #include <utils/Mutex.h>
+#include <utils/ostream.h>
 
 #include <array>
 #include <atomic>
@@ -148,10 +152,18 @@ public:
     bool isVariantLit() const noexcept { return mIsVariantLit; }
 
     const utils::CString& getName() const noexcept { return mName; }
+
+    // Writes the variants of each stage that were loaded so far, see
+    // Engine::writeVariantUsageProfile().
+    void writeVariantUsageProfile(utils::io::ostream& out) const noexcept;
+
     backend::FeatureLevel getFeatureLevel() const noexcept { return mFeatureLevel; }
     backend::RasterState getRasterState() const noexcept  { return mRasterState; }
     uint32_t getId() const noexcept { return mMaterialId; }
 
+    // the uniforms of all our instances
+    UniformHeap& getUniformHeap() const noexcept { return mUniformHeap; }
+
     UserVariantFilterMask getSupportedVariants() const noexcept {
         return UserVariantFilterMask(UserVariantFilterBit::ALL) & ~mVariantFilterMask;
     }
@@ -206,6 +218,8 @@ public:
     bool setConstant(uint32_t id, T value) noexcept;
 
 #if FILAMENT_ENABLE_MATDBG
+    matdbg::MaterialKey getDebuggerId() const noexcept { return mDebuggerId; }
+
     void applyPendingEdits() noexcept;
 
     /**
@@ -262,6 +276,10 @@ private:
     // try to order by frequency of use
     mutable std::array<backend::Handle<backend::HwProgram>, VARIANT_COUNT> mCachedPrograms;
 
+    // the shaders that were loaded, recorded for writeVariantUsageProfile()
+    mutable utils::bitset256 mUsedVertexVariants;
+    mutable utils::bitset256 mUsedFragmentVariants;
+
     backend::RasterState mRasterState;
     TransparencyMode mTransparencyMode = TransparencyMode::DEFAULT;
     bool mIsVariantLit = false;
@@ -276,6 +294,11 @@ private:
     CullingMode mCullingMode = CullingMode::NONE;
     AttributeBitset mRequiredAttributes;
     UserVariantFilterMask mVariantFilterMask = 0;
+    // variants selected by a specialization constant, they share the shaders of the variants
+    // without them
+    UserVariantFilterMask mSpecializedVariants = 0;
+
+    mutable UniformHeap mUniformHeap;
     RefractionMode mRefractionMode = RefractionMode::NONE;
     RefractionType mRefractionType = RefractionType::SOLID;
     ReflectionMode mReflectionMode = ReflectionMode::DEFAULT;
@@ -49,9 +49,6 @@ FMaterialInstance::FMaterialInstance(FEngine& engine, FMaterial const* material)
 
     if (!material->getUniformInterfaceBlock().isEmpty()) {
         mUniforms = UniformBuffer(material->getUniformInterfaceBlock().getSize());
-        mUbHandle = driver.createBufferObject(mUniforms.getSize(),
-                BufferObjectBinding::UNIFORM, backend::BufferUsage::STATIC);
-        driver.setDebugTag(mUbHandle.getId(), material->getName());
     }
 
     if (!material->getSamplerInterfaceBlock().isEmpty()) {
@@ -115,9 +112,6 @@ FMaterialInstance::FMaterialInstance(FEngine& engine,
 
     if (!material->getUniformInterfaceBlock().isEmpty()) {
         mUniforms.setUniforms(other->getUniformBuffer());
-        mUbHandle = driver.createBufferObject(mUniforms.getSize(),
-                BufferObjectBinding::UNIFORM, backend::BufferUsage::DYNAMIC);
-        driver.setDebugTag(mUbHandle.getId(), material->getName());
     }
 
     if (!material->getSamplerInterfaceBlock().isEmpty()) {
@@ -156,6 +150,7 @@ FMaterialInstance::~FMaterialInstance() noexcept = default;
 
 void FMaterialInstance::terminate(FEngine& engine) {
     FEngine::DriverApi& driver = engine.getDriverApi();
+    mMaterial->getUniformHeap().free(mUniformSlot);
     driver.destroyBufferObject(mUbHandle);
     driver.destroySamplerGroup(mSbHandle);
 }
@@ -163,7 +158,22 @@ void FMaterialInstance::terminate(FEngine& engine) {
 void FMaterialInstance::commitSlow(DriverApi& driver) const {
     // update uniforms if needed
     if (mUniforms.isDirty()) {
-        driver.updateBufferObject(mUbHandle, mUniforms.toBufferDescriptor(driver), 0);
+        UniformHeap& heap = mMaterial->getUniformHeap();
+        if (!mUniformSlot.boh && !mUbHandle) {
+            mUniformSlot = heap.allocate(driver);
+        }
+        if (UTILS_LIKELY(mUniformSlot.boh)) {
+            heap.write(driver, mUniformSlot, mUniforms.getBuffer());
+            mUniforms.clean();
+        } else {
+            // the heap is disabled, use our own buffer object
+            if (!mUbHandle) {
+                mUbHandle = driver.createBufferObject(mUniforms.getSize(),
+                        BufferObjectBinding::UNIFORM, backend::BufferUsage::DYNAMIC);
+                driver.setDebugTag(mUbHandle.getId(), mMaterial->getName());
+            }
+            driver.updateBufferObject(mUbHandle, mUniforms.toBufferDescriptor(driver), 0);
+        }
     }
     if (mSamplers.isDirty()) {
         driver.updateSamplerGroup(mSbHandle, mSamplers.toBufferDescriptor(driver));
@@ -19,6 +19,7 @@
 
 #include "downcast.h"
 #include "UniformBuffer.h"
+#include "UniformHeap.h"
 #include "details/Engine.h"
 
 #include "private/backend/DriverApi.h"
@@ -49,13 +50,22 @@ public:
     void terminate(FEngine& engine);
 
     void commit(FEngine::DriverApi& driver) const {
-        if (UTILS_UNLIKELY(mUniforms.isDirty() || mSamplers.isDirty())) {
+        if (UTILS_UNLIKELY(isDirty())) {
             commitSlow(driver);
         }
     }
 
+    // whether some parameters were set since the last commit()
+    bool isDirty() const noexcept {
+        return mUniforms.isDirty() || mSamplers.isDirty();
+    }
+
     void use(FEngine::DriverApi& driver) const {
-        if (mUbHandle) {
+        if (mUniformSlot.boh) {
+            driver.bindBufferRange(backend::BufferObjectBinding::UNIFORM,
+                    +UniformBindingPoints::PER_MATERIAL_INSTANCE,
+                    mUniformSlot.boh, mUniformSlot.offset, mUniforms.getSize());
+        } else if (mUbHandle) {
             driver.bindUniformBuffer(+UniformBindingPoints::PER_MATERIAL_INSTANCE, mUbHandle);
         }
         if (mSbHandle) {
@@ -242,7 +252,10 @@ private:
     // keep these grouped, they're accessed together in the render-loop
     FMaterial const* mMaterial = nullptr;
 
-    backend::Handle<backend::HwBufferObject> mUbHandle;
+    // the uniforms live in the material's UniformHeap, unless it's disabled, in which case they
+    // use their own buffer object
+    mutable UniformHeap::Slot mUniformSlot;
+    mutable backend::Handle<backend::HwBufferObject> mUbHandle;
     backend::Handle<backend::HwSamplerGroup> mSbHandle;
     UniformBuffer mUniforms;
     backend::SamplerGroup mSamplers;
@@ -155,6 +155,7 @@ void FMorphTargetBuffer::terminate(FEngine& engine) {
 
 void FMorphTargetBuffer::setPositionsAt(FEngine& engine, size_t targetIndex,
         math::float3 const* positions, size_t count, size_t offset) {
+    engine.markContentChanged();
     FILAMENT_CHECK_PRECONDITION(offset + count <= mVertexCount)
             << "MorphTargetBuffer (size=" << (unsigned)mVertexCount
             << ") overflow (count=" << (unsigned)count << ", offset=" << (unsigned)offset << ")";
@@ -178,6 +179,7 @@ void FMorphTargetBuffer::setPositionsAt(FEngine& engine, size_t targetIndex,
 
 void FMorphTargetBuffer::setPositionsAt(FEngine& engine, size_t targetIndex,
         math::float4 const* positions, size_t count, size_t offset) {
+    engine.markContentChanged();
     FILAMENT_CHECK_PRECONDITION(offset + count <= mVertexCount)
             << "MorphTargetBuffer (size=" << (unsigned)mVertexCount
             << ") overflow (count=" << (unsigned)count << ", offset=" << (unsigned)offset << ")";
@@ -198,8 +200,47 @@ void FMorphTargetBuffer::setPositionsAt(FEngine& engine, size_t targetIndex,
             count, offset);
 }
 
+void FMorphTargetBuffer::setPositionsAt(FEngine& engine, size_t targetIndex,
+        uint32_t const* indices, math::float3 const* positions, size_t count,
+        size_t offset, size_t vertexCount) {
+    engine.markContentChanged();
+    FILAMENT_CHECK_PRECONDITION(offset <= mVertexCount)
+            << "MorphTargetBuffer (size=" << (unsigned)mVertexCount
+            << ") overflow (offset=" << (unsigned)offset << ")";
+
+    if (!vertexCount) {
+        vertexCount = mVertexCount - offset;
+    }
+
+    FILAMENT_CHECK_PRECONDITION(offset + vertexCount <= mVertexCount)
+            << "MorphTargetBuffer (size=" << (unsigned)mVertexCount
+            << ") overflow (vertexCount=" << (unsigned)vertexCount
+            << ", offset=" << (unsigned)offset << ")";
+
+    FILAMENT_CHECK_PRECONDITION(targetIndex < mCount)
+            << targetIndex << " target index must be < " << mCount;
+
+    auto size = getSize<VertexAttribute::POSITION>(vertexCount);
+
+    // the texture stores every vertex, so expand the deltas, untouched vertices don't move
+    auto* out = (float4*) malloc(size);
+    std::fill_n(out, vertexCount, float4{ 0.0f, 0.0f, 0.0f, 1.0f });
+    for (size_t i = 0; i < count; i++) {
+        FILAMENT_CHECK_PRECONDITION(indices[i] < vertexCount)
+                << "vertex index " << indices[i] << " must be < " << (unsigned)vertexCount;
+        out[indices[i]] = float4(positions[i], 1.0f);
+    }
+
+    FEngine::DriverApi& driver = engine.getDriverApi();
+    updateDataAt(driver, mPbHandle,
+            Texture::Format::RGBA, Texture::Type::FLOAT,
+            (char const*)out, sizeof(float4), targetIndex,
+            vertexCount, offset);
+}
+
 void FMorphTargetBuffer::setTangentsAt(FEngine& engine, size_t targetIndex,
         math::short4 const* tangents, size_t count, size_t offset) {
+    engine.markContentChanged();
     FILAMENT_CHECK_PRECONDITION(offset + count <= mVertexCount)
             << "MorphTargetBuffer (size=" << (unsigned)mVertexCount
             << ") overflow (count=" << (unsigned)count << ", offset=" << (unsigned)offset << ")";
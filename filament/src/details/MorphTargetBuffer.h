@@ -54,6 +54,10 @@ public:
     void setPositionsAt(FEngine& engine, size_t targetIndex,
             math::float4 const* positions, size_t count, size_t offset);
 
+    void setPositionsAt(FEngine& engine, size_t targetIndex,
+            uint32_t const* indices, math::float3 const* positions, size_t count,
+            size_t offset, size_t vertexCount);
+
     void setTangentsAt(FEngine& engine, size_t targetIndex,
             math::short4 const* tangents, size_t count, size_t offset);
 
@@ -24,6 +24,10 @@
 #include "RenderPass.h"
 #include "ResourceAllocator.h"
 
+#include "components/LightManager.h"
+#include "components/RenderableManager.h"
+#include "components/TransformManager.h"
+
 #include "details/Engine.h"
 #include "details/Fence.h"
 #include "details/Scene.h"
@@ -51,6 +55,7 @@
 #include <math/mat4.h>
 
 #include <utils/compiler.h>
+#include <utils/Hash.h>
 #include <utils/JobSystem.h>
 #include <utils/Log.h>
 #include <utils/ostream.h>
@@ -58,9 +63,12 @@
 #include <utils/Systrace.h>
 #include <utils/debug.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include <stddef.h>
@@ -84,7 +92,8 @@ FRenderer::FRenderer(FEngine& engine) :
         mEngine(engine),
         mFrameSkipper(),
         mRenderTargetHandle(engine.getDefaultRenderTarget()),
-        mFrameInfoManager(engine.getDriverApi()),
+        // OpenGL's GL_TIME_ELAPSED queries can't be nested
+        mFrameInfoManager(engine.getDriverApi(), engine.getBackend() != Backend::OPENGL),
         mHdrTranslucent(TextureFormat::RGBA16F),
         mHdrQualityMedium(TextureFormat::R11F_G11F_B10F),
         mHdrQualityHigh(TextureFormat::RGB16F),
@@ -93,7 +102,8 @@ FRenderer::FRenderer(FEngine& engine) :
         mResourceAllocator(std::make_unique<ResourceAllocator>(
                 engine.getSharedResourceAllocatorDisposer(),
                 engine.getConfig(),
-                engine.getDriverApi()))
+                engine.getDriverApi())),
+        mFrameGraphArena("FrameGraph Arena", FRAME_GRAPH_ARENA_SIZE)
 {
     FDebugRegistry& debugRegistry = engine.getDebugRegistry();
     debugRegistry.registerProperty("d.renderer.doFrameCapture",
@@ -102,6 +112,8 @@ FRenderer::FRenderer(FEngine& engine) :
             &engine.debug.renderer.disable_buffer_padding);
     debugRegistry.registerProperty("d.renderer.disable_subpasses",
             &engine.debug.renderer.disable_subpasses);
+    debugRegistry.registerProperty("d.renderer.print_tile_memory_report",
+            &engine.debug.renderer.print_tile_memory_report);
     debugRegistry.registerProperty("d.shadowmap.display_shadow_texture",
             &engine.debug.shadowmap.display_shadow_texture);
     debugRegistry.registerProperty("d.shadowmap.display_shadow_texture_scale",
@@ -161,6 +173,10 @@ FRenderer::~FRenderer() noexcept {
     << wm / 1024 << " KiB (" << wmpct << "%), "
     << wm / sizeof(Command) << " commands, " << sizeof(Command) << " bytes/command"
     << io::endl;
+    size_t const fgwm = mFrameGraphHighWatermark;
+    slog.d << "Renderer: FrameGraph High watermark "
+    << fgwm / 1024 << " KiB (" << fgwm / (FRAME_GRAPH_ARENA_SIZE / 100) << "%)"
+    << io::endl;
 #endif
 }
 
@@ -275,6 +291,74 @@ void FRenderer::skipFrame(uint64_t vsyncSteadyClockTimeNano) {
     js.waitAndRelease(job);
 }
 
+void FRenderer::updateThermalHeadroom(std::chrono::steady_clock::time_point now) noexcept {
+    // the headroom can't be queried more often than once per second
+    if (mFrameRateOptions.thermalHeadroomThreshold <= 0.0f ||
+            now - mThermalHeadroomTime < std::chrono::seconds(1)) {
+        return;
+    }
+    mThermalHeadroomTime = now;
+    // look far enough ahead to lower the load before the device throttles
+    constexpr int THERMAL_FORECAST_SECONDS = 10;
+    float const headroom = mThermalManager.getThermalHeadroom(THERMAL_FORECAST_SECONDS);
+    if (!std::isnan(headroom)) {
+        mThermalHeadroom = headroom;
+    }
+}
+
+Renderer::FrameRateOptions FRenderer::getThermalFrameRateOptions() const noexcept {
+    FrameRateOptions options = mFrameRateOptions;
+    float const threshold = options.thermalHeadroomThreshold;
+    if (threshold > 0.0f && mThermalHeadroom > threshold) {
+        // 0 at the threshold, 1 when throttling is imminent
+        float const load = std::min(1.0f,
+                (mThermalHeadroom - threshold) / std::max(1.0f - threshold, 0.01f));
+        // dynamic resolution then lowers the resolution to fit the reduced frame time target
+        options.headRoomRatio += (1.0f - options.headRoomRatio) * 0.5f * load;
+        if (mThermalHeadroom >= 1.0f && options.thermalInterval > options.interval) {
+            options.interval = options.thermalInterval;
+        }
+    }
+    return options;
+}
+
+FRenderer::IdleState FRenderer::getIdleState(FSwapChain const* swapChain) const noexcept {
+    FEngine const& engine = mEngine;
+    FRenderableManager const& rcm = engine.getRenderableManager();
+    FTransformManager const& tcm = engine.getTransformManager();
+    FLightManager const& lcm = engine.getLightManager();
+    size_t viewsKey = mRenderedViews.size();
+    for (FView const* view : mRenderedViews) {
+        utils::hash::combine(viewsKey, view);
+        utils::hash::combine(viewsKey, view->getContentKey());
+    }
+    return {
+            .contentVersion = engine.getContentVersion(),
+            .renderableChangeCount = rcm.getChangeCount(),
+            .renderableComponentsVersion = rcm.getComponentsVersion(),
+            .transformChangeCount = tcm.getChangeCount(),
+            .transformComponentsVersion = tcm.getComponentsVersion(),
+            .lightChangeCount = lcm.getChangeCount(),
+            .lightComponentsVersion = lcm.getComponentsVersion(),
+            .swapChain = swapChain,
+            .viewsKey = viewsKey
+    };
+}
+
+bool FRenderer::isIdleFrame(FSwapChain const* swapChain) const noexcept {
+    if (!mIdleFrameOptions.enabled ||
+            mUnchangedFrameCount < mIdleFrameOptions.settleFrameCount ||
+            mEngine.hasPendingContentChanges()) {
+        return false;
+    }
+    // a view destroyed since the last frame can't be hashed, and is a change anyway
+    auto const isValid = [&engine = mEngine](FView const* view) { return engine.isValid(view); };
+    if (!std::all_of(mRenderedViews.begin(), mRenderedViews.end(), isValid)) {
+        return false;
+    }
+    return getIdleState(swapChain) == mIdleState;
+}
+
 bool FRenderer::beginFrame(FSwapChain* swapChain, uint64_t vsyncSteadyClockTimeNano) {
     assert_invariant(swapChain);
 
@@ -306,6 +390,8 @@ bool FRenderer::beginFrame(FSwapChain* swapChain, uint64_t vsyncSteadyClockTimeN
     const steady_clock::time_point userVsync{ steady_clock::duration(vsyncSteadyClockTimeNano) };
     const time_point<steady_clock> appVsync(vsyncSteadyClockTimeNano ? userVsync : now);
 
+    updateThermalHeadroom(now);
+
     mFrameId++;
     mViewRenderedCount = 0;
 
@@ -361,15 +447,28 @@ bool FRenderer::beginFrame(FSwapChain* swapChain, uint64_t vsyncSteadyClockTimeN
         // This need to occur after the backend beginFrame() because some backends need to start
         // a command buffer before creating a fence.
 
+        mRenderedViews.clear();
+
         mFrameInfoManager.beginFrame(driver, {
-                .historySize = mFrameRateOptions.history
+                .historySize = mFrameRateOptions.history,
+                .passTimings = mPassTimingEnabled || mFrameStatsEnabled
         }, mFrameId);
 
+#if FILAMENT_ENABLE_MATDBG
+        if (UTILS_UNLIKELY(mFrameStatsEnabled)) {
+            mFrameStats.clear();
+            mFrameStats.frameId = mFrameId;
+            engine.debug.frameStats = &mFrameStats;
+        }
+#endif
+
         // ask the engine to do what it needs to (e.g. updates light buffer, materials...)
         engine.prepare();
     };
 
-    if (mFrameSkipper.beginFrame(driver)) {
+    // Frames identical to the last one are skipped, just like the frames the GPU can't keep up
+    // with, so that the SwapChain keeps presenting the last frame.
+    if (!isIdleFrame(swapChain) && mFrameSkipper.beginFrame(driver)) {
         // if beginFrame() returns true, we are expecting a call to endFrame(),
         // so do the beginFrame work right now, instead of requiring a call to render()
         beginFrameInternal();
@@ -407,12 +506,19 @@ void FRenderer::endFrame() {
         driver.debugThreading();
     }
 
+    if (mIdleFrameOptions.enabled) {
+        IdleState const state = getIdleState(mSwapChain);
+        mUnchangedFrameCount = state == mIdleState ?
+                std::min(mUnchangedFrameCount + 1u, uint32_t(UINT8_MAX)) : 0u;
+        mIdleState = state;
+    }
+
     if (mSwapChain) {
         mSwapChain->commit(driver);
         mSwapChain = nullptr;
     }
 
-    mFrameInfoManager.endFrame(driver);
+    mFrameInfoManager.endFrame(driver, engine.getAndResetInstancingDrawCallsSaved());
     mFrameSkipper.endFrame(driver);
 
     driver.endFrame(mFrameId);
@@ -437,10 +543,81 @@ void FRenderer::endFrame() {
 
     engine.flush();     // flush command stream
 
+    engine.updateCommandStreamStats();
+
     // make sure we're done with the gcs
     js.waitAndRelease(job);
+
+#if FILAMENT_ENABLE_MATDBG
+    if (UTILS_UNLIKELY(engine.debug.server)) {
+        publishFrameStats();
+    }
+#endif
 }
 
+#if FILAMENT_ENABLE_MATDBG
+
+void FRenderer::publishFrameStats() noexcept {
+    FEngine& engine = mEngine;
+    JobSystem& js = engine.getJobSystem();
+
+    if (engine.debug.frameStats == &mFrameStats) {
+        matdbg::FrameStats& stats = mFrameStats;
+
+        // GPU timings come from the most recent frame whose results are available
+        auto const history = mFrameInfoManager.getFrameInfoHistory(1);
+        if (!history.empty()) {
+            Renderer::FrameInfo const& info = history[0];
+            stats.gpuFrameId = info.frameId;
+            stats.gpuFrameTime = info.frameTime;
+            for (uint32_t i = 0; i < info.passTimingCount; i++) {
+                stats.passes.push_back({ info.passTimings[i].name, info.passTimings[i].gpuTime });
+            }
+        }
+
+        Engine::CommandStreamStats const streamStats = engine.getCommandStreamStats();
+        stats.commandBufferSize = streamStats.size;
+        stats.commandBufferWaitCount = streamStats.waitCount;
+        stats.commandBufferWaitTime = streamStats.waitDuration;
+
+        if (js.isTracingEnabled()) {
+            uint64_t busyTime = 0;
+            uint64_t idleTime = 0;
+            for (size_t i = 0, c = js.getTracedThreadCount(); i < c; i++) {
+                JobSystem::ThreadStatistics const threadStats = js.getThreadStatistics(i);
+                busyTime += threadStats.busyTime;
+                idleTime += threadStats.idleTime;
+            }
+            uint64_t const busy = busyTime - mJobSystemBusyTime;
+            uint64_t const total = busy + (idleTime - mJobSystemIdleTime);
+            if (total) {
+                stats.jobSystemUtilization = float(double(busy) / double(total));
+            }
+            mJobSystemBusyTime = busyTime;
+            mJobSystemIdleTime = idleTime;
+        }
+
+        engine.debug.server->setFrameStats(stats);
+        engine.debug.frameStats = nullptr;
+    }
+
+    // Takes effect at the next frame. The JobSystem tracing can only be toggled while no jobs are
+    // running, which is the case here since we just waited for the gc job. We only turn off the
+    // tracing we turned on.
+    mFrameStatsEnabled = engine.debug.server->isStreamingStats();
+    if (mFrameStatsEnabled && !js.isTracingEnabled()) {
+        js.setTracingEnabled(true);
+        mJobSystemTracingEnabled = true;
+        mJobSystemBusyTime = 0;
+        mJobSystemIdleTime = 0;
+    } else if (!mFrameStatsEnabled && mJobSystemTracingEnabled) {
+        js.setTracingEnabled(false);
+        mJobSystemTracingEnabled = false;
+    }
+}
+
+#endif // FILAMENT_ENABLE_MATDBG
+
 void FRenderer::readPixels(uint32_t xoffset, uint32_t yoffset, uint32_t width, uint32_t height,
         PixelBufferDescriptor&& buffer) {
 #ifndef NDEBUG
@@ -508,17 +685,24 @@ void FRenderer::copyFrame(FSwapChain* dstSwapChain, filament::Viewport const& ds
 }
 
 void FRenderer::renderStandaloneView(FView const* view) {
+    renderStandaloneViews(&view, 1);
+}
+
+void FRenderer::renderStandaloneViews(FView const* const* views, size_t count) {
     SYSTRACE_CALL();
 
     using namespace std::chrono;
 
-    FILAMENT_CHECK_PRECONDITION(view->getRenderTarget())
-            << "View \"" << view->getName() << "\" must have a RenderTarget associated";
+    for (size_t i = 0; i < count; i++) {
+        FILAMENT_CHECK_PRECONDITION(views[i]->getRenderTarget())
+                << "View \"" << views[i]->getName() << "\" must have a RenderTarget associated";
+    }
 
     FILAMENT_CHECK_PRECONDITION(!mSwapChain)
             << "renderStandaloneView() must be called outside of beginFrame() / endFrame()";
 
-    if (UTILS_LIKELY(view->getScene())) {
+    auto const hasScene = [](FView const* view) { return view->getScene() != nullptr; };
+    if (UTILS_LIKELY(std::any_of(views, views + count, hasScene))) {
         mPreviousRenderTargets.clear();
         mFrameId++;
 
@@ -533,7 +717,13 @@ void FRenderer::renderStandaloneView(FView const* view) {
                         1'000'000'000.0 / mDisplayInfo.refreshRate),
                 mFrameId);
 
-        renderInternal(view);
+        // all the views share the frame above, renderInternal() flushes after each of them so
+        // the GPU can start on a view while the next one is being prepared.
+        for (size_t i = 0; i < count; i++) {
+            if (hasScene(views[i])) {
+                renderInternal(views[i]);
+            }
+        }
 
         driver.endFrame(mFrameId);
     }
@@ -560,6 +750,9 @@ void FRenderer::render(FView const* view) {
         }
         renderInternal(view);
         mViewRenderedCount++;
+        if (mIdleFrameOptions.enabled) {
+            mRenderedViews.push_back(view);
+        }
     }
 }
 
@@ -597,7 +790,8 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
     bool hasColorGrading = hasPostProcess;
     bool hasDithering = view.getDithering() == Dithering::TEMPORAL;
     bool hasFXAA = view.getAntiAliasing() == AntiAliasing::FXAA;
-    float2 scale = view.updateScale(engine, mFrameInfoManager.getLastFrameInfo(), mFrameRateOptions, mDisplayInfo);
+    float2 scale = view.updateScale(engine, mFrameInfoManager.getLastFrameInfo(),
+            getThermalFrameRateOptions(), mDisplayInfo);
     auto msaaOptions = view.getMultiSampleAntiAliasingOptions();
     auto dsrOptions = view.getDynamicResolutionOptions();
     auto bloomOptions = view.getBloomOptions();
@@ -605,6 +799,7 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
     auto aoOptions = view.getAmbientOcclusionOptions();
     auto taaOptions = view.getTemporalAntiAliasingOptions();
     auto vignetteOptions = view.getVignetteOptions();
+    auto autoExposureOptions = view.getAutoExposureOptions();
     auto colorGrading = view.getColorGrading();
     auto ssReflectionsOptions = view.getScreenSpaceReflectionsOptions();
     auto guardBandOptions = view.getGuardBandOptions();
@@ -618,11 +813,18 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
     }
     const uint8_t msaaSampleCount = msaaOptions.enabled ? msaaOptions.sampleCount : 1u;
 
+    // the accumulation and revealage buffers are single-sampled and not layered
+    const bool hasOrderIndependentTransparency =
+            view.isOrderIndependentTransparencyEnabled() &&
+            msaaSampleCount <= 1 && !isRenderingMultiview &&
+            driver.getFeatureLevel() > FeatureLevel::FEATURE_LEVEL_0;
+
     if (!hasPostProcess) {
         // disable all effects that are part of post-processing
         dofOptions.enabled = false;
         bloomOptions.enabled = false;
         vignetteOptions.enabled = false;
+        autoExposureOptions.enabled = false;
         taaOptions.enabled = false;
         hasColorGrading = false;
         hasDithering = false;
@@ -656,7 +858,8 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
     const bool isSubpassPossible =
              msaaSampleCount <= 1 &&
              hasColorGrading &&
-             !bloomOptions.enabled && !dofOptions.enabled && !taaOptions.enabled;
+             !bloomOptions.enabled && !dofOptions.enabled && !taaOptions.enabled &&
+             !autoExposureOptions.enabled && !hasOrderIndependentTransparency;
 
     // asSubpass is disabled with TAA (although it's supported) because performance was degraded
     // on qualcomm hardware -- we might need a backend dependent toggle at some point
@@ -805,7 +1008,7 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
      * Frame graph
      */
 
-    FrameGraph fg(*mResourceAllocator,
+    FrameGraph fg(*mResourceAllocator, mFrameGraphArena,
             isProtectedContent ? FrameGraph::Mode::PROTECTED : FrameGraph::Mode::UNPROTECTED);
     auto& blackboard = fg.getBlackboard();
 
@@ -896,15 +1099,22 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
             .enabledStencilBuffer = view.isStencilBufferEnabled()
     };
 
+    // The structure pass is consumed by SSAO, SSR, contact shadows, picking and occlusion culling.
+    // SSAO works at the resolution of the structure buffer, so it dictates its scale when
+    // enabled. Otherwise, we use half-resolution (full-resolution with TAA upscaling, which
+    // already halves the viewport), unless SSR traces at a higher resolution.
+    float structureScale = aoOptions.resolution;
+    if (!aoOptions.enabled) {
+        structureScale = (taaOptions.enabled && taaOptions.upscaling) ? 1.0f : 0.5f;
+        if (ssReflectionsOptions.enabled) {
+            structureScale = std::max(structureScale, ssReflectionsOptions.resolution);
+        }
+    }
+
     /*
      * Depth + Color passes
      */
 
-    // updatePrimitivesLod must be run before appendCommands and once for each set
-    // of RenderPass::setCamera / RenderPass::setGeometry calls.
-    view.updatePrimitivesLod(engine, cameraInfo,
-            scene.getRenderableData(), view.getVisibleRenderables());
-
     passBuilder.camera(cameraInfo);
     passBuilder.geometry(scene.getRenderableData(),
             view.getVisibleRenderables(),
@@ -918,7 +1128,7 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
                 // The code here is a little fragile. In theory, we need to call prepareViewport()
                 // for each render pass, because the viewport parameters depend on the resolution.
                 // However, in practice, we only have two resolutions: the color pass resolution,
-                // and the structure pass which is governed by aoOptions.resolution (this could
+                // and the structure pass which is governed by structureScale (this could
                 // change in the future).
                 // So here we set the parameters for the structure pass and SSAO passes which
                 // are always done first. The SSR pass will also use these parameters which
@@ -933,14 +1143,14 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
                 // The reason why this bug is acceptable is that the viewport parameters are
                 // currently only used for generating noise, so it's not too bad.
 
-                // note: aoOptions.resolution is either 1.0 or 0.5, and the result is then
+                // note: structureScale is either 1.0, 0.5 or 0.25, and the result is then
                 // guaranteed to be an integer (because xvp is a multiple of 16).
                 view.prepareViewport(svp,
                         filament::Viewport{
-                             int32_t(float(xvp.left  ) * aoOptions.resolution),
-                             int32_t(float(xvp.bottom) * aoOptions.resolution),
-                            uint32_t(float(xvp.width ) * aoOptions.resolution),
-                            uint32_t(float(xvp.height) * aoOptions.resolution)});
+                             int32_t(float(xvp.left  ) * structureScale),
+                             int32_t(float(xvp.bottom) * structureScale),
+                            uint32_t(float(xvp.width ) * structureScale),
+                            uint32_t(float(xvp.height) * structureScale)});
 
                 view.commitUniforms(driver);
 
@@ -953,10 +1163,9 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
     // Currently it consists of a simple depth pass.
     // This is normally used by SSAO and contact-shadows
 
-    // TODO: the scaling should depends on all passes that need the structure pass
     const auto [structure, picking_] = ppm.structure(fg,
             passBuilder, renderFlags, svp.width, svp.height, {
-            .scale = aoOptions.resolution,
+            .scale = structureScale,
             .picking = view.hasPicking()
     });
     const auto picking = picking_;
@@ -978,7 +1187,38 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
                 [=, &view](FrameGraphResources const& resources,
                         auto const&, DriverApi& driver) mutable {
                     auto out = resources.getRenderPassInfo();
-                    view.executePickingQueries(driver, out.target, scale * aoOptions.resolution);
+                    view.executePickingQueries(driver, out.target, scale * structureScale,
+                            out.params.viewport.width, out.params.viewport.height);
+                });
+    }
+
+    if (UTILS_UNLIKELY(view.needsOcclusionDepth() &&
+            driver.getFeatureLevel() > FeatureLevel::FEATURE_LEVEL_0)) {
+        // Build a conservative depth pyramid from the structure pass and read its last level
+        // back; it's used to occlusion-cull renderables and fit the shadow cascades in later
+        // frames.
+        auto const hiz = ppm.occlusionDepthPyramid(fg, structure,
+                OcclusionCuller::MAX_DEPTH_BUFFER_WIDTH);
+
+        struct OcclusionReadbackPassData {
+            FrameGraphId<FrameGraphTexture> hiz;
+        };
+        fg.addPass<OcclusionReadbackPassData>("Occlusion Readback Pass",
+                [&](FrameGraph::Builder& builder, auto& data) {
+                    uint8_t const lastLevel = uint8_t(builder.getDescriptor(hiz).levels - 1u);
+                    data.hiz = builder.createSubresource(hiz, "Hi-Z last mip", {
+                            .level = lastLevel });
+                    data.hiz = builder.read(data.hiz, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                    builder.declareRenderPass("Occlusion Readback Target", {
+                            .attachments = { .color = { data.hiz }}
+                    });
+                    builder.sideEffect();
+                },
+                [=, &view](FrameGraphResources const& resources,
+                        auto const&, DriverApi& driver) mutable {
+                    auto out = resources.getRenderPassInfo();
+                    view.readbackOcclusionDepth(driver, out.target,
+                            out.params.viewport.width, out.params.viewport.height, cameraInfo);
                 });
     }
 
@@ -1016,7 +1256,8 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
                 view.getPerViewUniforms(),
                 structure,
                 ssReflectionsOptions,
-                { .width = svp.width, .height = svp.height });
+                { .width  = uint32_t(float(svp.width ) * ssReflectionsOptions.resolution),
+                  .height = uint32_t(float(svp.height) * ssReflectionsOptions.resolution) });
 
         if (UTILS_LIKELY(reflections)) {
             fg.addTrivialSideEffectPass("SSR Cleanup", [&view](DriverApi& driver) {
@@ -1065,7 +1306,11 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
                 });
     }
 
-    passBuilder.commandTypeFlags(RenderPass::CommandTypeFlags::COLOR);
+    // with order-independent transparency, blended objects are rendered by separate passes
+    using CommandTypeFlags = RenderPass::CommandTypeFlags;
+    passBuilder.commandTypeFlags(hasOrderIndependentTransparency ?
+            CommandTypeFlags::COLOR | CommandTypeFlags::FILTER_BLENDED_OBJECTS :
+            CommandTypeFlags::COLOR);
 
 
     // RenderPass::IS_INSTANCED_STEREOSCOPIC only applies to the color pass
@@ -1075,6 +1320,9 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
         passBuilder.renderFlags(renderFlags);
     }
 
+    // the color pass is mostly the same from frame to frame, reuse its previous order
+    passBuilder.sortCache(&view.getColorPassSortCache());
+
     RenderPass const pass{ passBuilder.build(engine) };
 
     FrameGraphTexture::Descriptor colorBufferDesc = {
@@ -1138,6 +1386,56 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
         }
     }
 
+    // these must outlive the FrameGraph execution
+    std::optional<RenderPass> oitAccumulationPass;
+    std::optional<RenderPass> oitRevealagePass;
+    if (hasOrderIndependentTransparency) {
+        // The blended objects skipped by the color pass are rendered, in any order, in the
+        // accumulation and revealage buffers, using the depth buffer of the color pass. Both
+        // are then composited over the color buffer.
+        RendererUtils::ColorPassInput const oitInput{
+                .depth = colorPassOutput.depth,
+                .shadows = blackboard.get<FrameGraphTexture>("shadows"),
+                .ssao = blackboard.get<FrameGraphTexture>("ssao"),
+                .ssr = ssrConfig.ssr,
+                .structure = structure
+        };
+        RendererUtils::ColorPassConfig oitConfig = config;
+        oitConfig.clearFlags = TargetBufferFlags::COLOR;
+
+        passBuilder.sortCache(nullptr);
+
+        passBuilder.commandTypeFlags(
+                CommandTypeFlags::COLOR | CommandTypeFlags::OIT_ACCUMULATION);
+        oitAccumulationPass.emplace(passBuilder.build(engine));
+
+        passBuilder.commandTypeFlags(
+                CommandTypeFlags::COLOR | CommandTypeFlags::OIT_REVEALAGE);
+        oitRevealagePass.emplace(passBuilder.build(engine));
+
+        if (!oitAccumulationPass->empty()) {
+            oitConfig.clearColor = {};
+            auto const accumulation = RendererUtils::colorPass(fg, "OIT Accumulation Pass",
+                    mEngine, view, oitInput, {
+                            .width = colorBufferDesc.width,
+                            .height = colorBufferDesc.height,
+                            .format = TextureFormat::RGBA16F },
+                    oitConfig, {}, oitAccumulationPass->getExecutor());
+
+            oitConfig.clearColor = { 1.0f };
+            auto const revealage = RendererUtils::colorPass(fg, "OIT Revealage Pass",
+                    mEngine, view, oitInput, {
+                            .width = colorBufferDesc.width,
+                            .height = colorBufferDesc.height,
+                            .format = TextureFormat::R16F },
+                    oitConfig, {}, oitRevealagePass->getExecutor());
+
+            colorPassOutput.linearColor = ppm.orderIndependentTransparencyComposite(fg,
+                    colorPassOutput.linearColor,
+                    accumulation.linearColor, revealage.linearColor);
+        }
+    }
+
     fg.addTrivialSideEffectPass("Finish Color Passes", [&view](DriverApi& driver) {
         // Unbind SSAO sampler, b/c the FrameGraph will delete the texture at the end of the pass.
         view.cleanupRenderPasses();
@@ -1229,6 +1527,11 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
 
     bool mightNeedFinalBlit = true;
     if (hasPostProcess) {
+        if (autoExposureOptions.enabled) {
+            // the exposure must be known before bloom and color grading
+            input = ppm.autoExposure(fg, input, xvp, view.getFrameHistory(), autoExposureOptions);
+        }
+
         if (dofOptions.enabled) {
             // The bokeh height is always correct regardless of the dynamic resolution scaling.
             // (because the CoC is calculated w.r.t. the height), so we only need to adjust
@@ -1349,16 +1652,40 @@ void FRenderer::renderJob(RootArenaScope& rootArenaScope, FView& view) {
 
     fg.present(fgViewRenderTarget);
 
-    fg.compile();
+    fg.compile(mFrameGraphCompileCache);
+
+    FrameGraph::TransientMemoryStats const& memoryStats = fg.getTransientMemoryStats();
+    view.setTransientMemorySize(memoryStats.peak, memoryStats.total);
 
     //fg.export_graphviz(slog.d, view.getName());
 
-    fg.execute(driver);
+    // print the tile memory report once, if requested
+    if (UTILS_UNLIKELY(engine.debug.renderer.print_tile_memory_report)) {
+        engine.debug.renderer.print_tile_memory_report = false;
+        fg.export_tileMemoryReport(slog.d);
+    }
+
+    // times each pass of the FrameGraph, if enabled
+    struct PassTimer final : public FrameGraph::PassListener {
+        FrameInfoManager& frameInfoManager;
+        explicit PassTimer(FrameInfoManager& frameInfoManager) noexcept
+                : frameInfoManager(frameInfoManager) {
+        }
+        void onBeginPass(DriverApi& driver, const char* name) noexcept override {
+            frameInfoManager.beginPass(driver, name);
+        }
+        void onEndPass(DriverApi& driver) noexcept override {
+            frameInfoManager.endPass(driver);
+        }
+    } passTimer(mFrameInfoManager);
+
+    fg.execute(driver, (mPassTimingEnabled || mFrameStatsEnabled) ? &passTimer : nullptr);
 
     // save the current history entry and destroy the oldest entry
     view.commitFrameHistory(engine);
 
     recordHighWatermark(commandArena.getListener().getHighWatermark());
+    recordFrameGraphHighWatermark(fg.getArenaUsage());
 }
 
 } // namespace filament
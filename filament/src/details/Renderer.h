@@ -27,6 +27,8 @@
 
 #include "details/SwapChain.h"
 
+#include "fg/FrameGraph.h"
+
 #include "backend/DriverApiForward.h"
 
 #include <filament/Renderer.h>
@@ -38,16 +40,22 @@
 #include <utils/compiler.h>
 #include <utils/Allocator.h>
 #include <utils/FixedCapacityVector.h>
+#include <utils/ThermalManager.h>
 
 #include <math/vec4.h>
 
 #include <tsl/robin_set.h>
 
+#if FILAMENT_ENABLE_MATDBG
+#include <matdbg/DebugServer.h>
+#endif
+
 #include <algorithm>
 #include <chrono>
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -86,6 +94,9 @@ public:
     // renders a single standalone view. The view must have a a custom rendertarget.
     void renderStandaloneView(FView const* view);
 
+    // renders several standalone views in a single frame.
+    void renderStandaloneViews(FView const* const* views, size_t count);
+
 
     void setPresentationTime(int64_t monotonic_clock_ns);
 
@@ -137,16 +148,30 @@ public:
         // headroom can't be larger than frame time, or less than 0
         frameRateOptions.headRoomRatio = std::min(frameRateOptions.headRoomRatio, 1.0f);
         frameRateOptions.headRoomRatio = std::max(frameRateOptions.headRoomRatio, 0.0f);
+
+        frameRateOptions.thermalHeadroomThreshold =
+                std::max(frameRateOptions.thermalHeadroomThreshold, 0.0f);
     }
 
     void setClearOptions(const ClearOptions& options) {
         mClearOptions = options;
+        // the clear options aren't part of the IdleState, they change what's on screen anyway
+        mUnchangedFrameCount = 0;
     }
 
     ClearOptions const& getClearOptions() const noexcept {
         return mClearOptions;
     }
 
+    void setIdleFrameOptions(IdleFrameOptions const& options) noexcept {
+        mIdleFrameOptions = options;
+        mUnchangedFrameCount = 0;
+    }
+
+    IdleFrameOptions const& getIdleFrameOptions() const noexcept {
+        return mIdleFrameOptions;
+    }
+
     utils::FixedCapacityVector<Renderer::FrameInfo> getFrameInfoHistory(size_t historySize) const noexcept {
         return mFrameInfoManager.getFrameInfoHistory(historySize);
     }
@@ -155,6 +180,10 @@ public:
         return MAX_FRAMETIME_HISTORY;
     }
 
+    void setPassTimingEnabled(bool enabled) noexcept {
+        mPassTimingEnabled = enabled;
+    }
+
 private:
     friend class Renderer;
     using Command = RenderPass::Command;
@@ -178,23 +207,80 @@ private:
     std::pair<backend::Handle<backend::HwRenderTarget>, backend::TargetBufferFlags>
             getRenderTarget(FView const& view) const noexcept;
 
+    static constexpr size_t FRAME_GRAPH_ARENA_SIZE = 262144;
+
     void recordHighWatermark(size_t watermark) noexcept {
         mCommandsHighWatermark = std::max(mCommandsHighWatermark, watermark);
     }
 
+    void recordFrameGraphHighWatermark(size_t watermark) noexcept {
+        mFrameGraphHighWatermark = std::max(mFrameGraphHighWatermark, watermark);
+    }
+
+public:
     size_t getCommandsHighWatermark() const noexcept {
         return mCommandsHighWatermark;
     }
 
+    size_t getFrameGraphHighWatermark() const noexcept {
+        return mFrameGraphHighWatermark;
+    }
+
+    ResourceAllocator const& getResourceAllocator() const noexcept {
+        return *mResourceAllocator;
+    }
+
+private:
+
     void renderInternal(FView const* view);
     void renderJob(RootArenaScope& rootArenaScope, FView& view);
 
+    // polls the thermal headroom forecast, at most once per second
+    void updateThermalHeadroom(std::chrono::steady_clock::time_point now) noexcept;
+    // mFrameRateOptions, adjusted to reduce the GPU load when throttling is forecast
+    FrameRateOptions getThermalFrameRateOptions() const noexcept;
+
+
+    // Everything the content of a frame depends on, see IdleFrameOptions
+    struct IdleState {
+        uint64_t contentVersion = 0;
+        uint32_t renderableChangeCount = 0;
+        uint32_t renderableComponentsVersion = 0;
+        uint32_t transformChangeCount = 0;
+        uint32_t transformComponentsVersion = 0;
+        uint32_t lightChangeCount = 0;
+        uint32_t lightComponentsVersion = 0;
+        FSwapChain const* swapChain = nullptr;
+        size_t viewsKey = 0;
+        bool operator==(IdleState const& rhs) const noexcept {
+            return contentVersion == rhs.contentVersion &&
+                   renderableChangeCount == rhs.renderableChangeCount &&
+                   renderableComponentsVersion == rhs.renderableComponentsVersion &&
+                   transformChangeCount == rhs.transformChangeCount &&
+                   transformComponentsVersion == rhs.transformComponentsVersion &&
+                   lightChangeCount == rhs.lightChangeCount &&
+                   lightComponentsVersion == rhs.lightComponentsVersion &&
+                   swapChain == rhs.swapChain &&
+                   viewsKey == rhs.viewsKey;
+        }
+    };
+
+    IdleState getIdleState(FSwapChain const* swapChain) const noexcept;
+
+    // whether the frame about to begin on this SwapChain would be identical to the last one
+    bool isIdleFrame(FSwapChain const* swapChain) const noexcept;
+
+#if FILAMENT_ENABLE_MATDBG
+    void publishFrameStats() noexcept;
+#endif
+
     // keep a reference to our engine
     FEngine& mEngine;
     FrameSkipper mFrameSkipper;
     backend::Handle<backend::HwRenderTarget> mRenderTargetHandle;
     FSwapChain* mSwapChain = nullptr;
     size_t mCommandsHighWatermark = 0;
+    size_t mFrameGraphHighWatermark = 0;
     uint32_t mFrameId = 0;
     uint32_t mViewRenderedCount = 0;
     FrameInfoManager mFrameInfoManager;
@@ -202,17 +288,38 @@ private:
     backend::TextureFormat mHdrQualityMedium;
     backend::TextureFormat mHdrQualityHigh;
     bool mIsRGB8Supported : 1;
+    bool mPassTimingEnabled = false;
+    // set while the debug server streams frame statistics
+    bool mFrameStatsEnabled = false;
     Epoch mUserEpoch;
     math::float4 mShaderUserTime{};
     DisplayInfo mDisplayInfo;
     FrameRateOptions mFrameRateOptions;
+    utils::ThermalManager mThermalManager;
+    std::chrono::steady_clock::time_point mThermalHeadroomTime{};
+    float mThermalHeadroom = 0.0f;
     ClearOptions mClearOptions;
+    IdleFrameOptions mIdleFrameOptions;
+    IdleState mIdleState;
+    uint32_t mUnchangedFrameCount = 0;
+    // the views rendered in the last frame that wasn't skipped
+    std::vector<FView const*> mRenderedViews;
     backend::TargetBufferFlags mDiscardStartFlags{};
     backend::TargetBufferFlags mClearFlags{};
     tsl::robin_set<FRenderTarget*> mPreviousRenderTargets;
     std::function<void()> mBeginFrameInternal;
     uint64_t mVsyncSteadyClockTimeNano = 0;
     std::unique_ptr<ResourceAllocator> mResourceAllocator{};
+    // The FrameGraph is rebuilt each frame, keep its arena around so we don't allocate a new one
+    LinearAllocatorArena mFrameGraphArena;
+    // The graph's structure rarely changes from one frame to the next
+    FrameGraph::CompileCache mFrameGraphCompileCache;
+#if FILAMENT_ENABLE_MATDBG
+    matdbg::FrameStats mFrameStats;
+    uint64_t mJobSystemBusyTime = 0;
+    uint64_t mJobSystemIdleTime = 0;
+    bool mJobSystemTracingEnabled = false;
+#endif
 };
 
 FILAMENT_DOWNCAST(Renderer)
@@ -36,6 +36,7 @@
 #include <math/quat.h>
 
 #include <algorithm>
+#include <limits>
 
 using namespace filament::backend;
 using namespace filament::math;
@@ -51,14 +52,20 @@ FScene::FScene(FEngine& engine) :
 
 FScene::~FScene() noexcept = default;
 
+// The model matrix seen by the shaders also dequantizes the positions, see
+// RenderableManager::Builder::positionDequantization().
+static mat4f shaderModelMatrix(FRenderableManager const& rcm, FRenderableManager::Instance ri,
+        FRenderableManager::Visibility visibility, mat4f const& model) noexcept {
+    if (UTILS_LIKELY(!visibility.dequantizePositions)) {
+        return model;
+    }
+    return FRenderableManager::dequantize(model, rcm.getPositionDequantization(ri));
+}
 
 void FScene::prepare(utils::JobSystem& js,
         RootArenaScope& rootArenaScope,
         mat4 const& worldTransform,
         bool shadowReceiversAreCasters) noexcept {
-    // TODO: can we skip this in most cases? Since we rely on indices staying the same,
-    //       we could only skip, if nothing changed in the RCM.
-
     SYSTRACE_CALL();
 
     SYSTRACE_CONTEXT();
@@ -68,15 +75,48 @@ void FScene::prepare(utils::JobSystem& js,
 
     FEngine& engine = mEngine;
     EntityManager const& em = engine.getEntityManager();
-    FRenderableManager const& rcm = engine.getRenderableManager();
-    FTransformManager const& tcm = engine.getTransformManager();
+    FRenderableManager& rcm = engine.getRenderableManager();
+    FTransformManager& tcm = engine.getTransformManager();
     FLightManager const& lcm = engine.getLightManager();
     // go through the list of entities, and gather the data of those that are renderables
     auto& sceneData = mRenderableData;
     auto& lightData = mLightData;
     auto const& entities = mEntities;
 
-    using RenderableContainerData = std::pair<RenderableManager::Instance, TransformManager::Instance>;
+    // everything that changes from now on will be picked up by the next prepare()
+    PrepareState const previous = mPrepareState;
+    mPrepareState = {
+            .renderableVersion = rcm.advanceVersion(),
+            .transformVersion = tcm.advanceVersion(),
+            .renderableComponentsVersion = rcm.getComponentsVersion(),
+            .transformComponentsVersion = tcm.getComponentsVersion(),
+            .lightComponentsVersion = lcm.getComponentsVersion(),
+            .frame = engine.getFrameCount(),
+            .shadowReceiversAreCasters = shadowReceiversAreCasters,
+            .valid = true };
+
+    // If the SoA holds the same renderables as the last time (in any order, since views
+    // partition it), and they are prepared the same way, we only update those that changed.
+    bool incremental = previous.valid && sceneData.capacity() &&
+            previous.renderableComponentsVersion == mPrepareState.renderableComponentsVersion &&
+            previous.transformComponentsVersion == mPrepareState.transformComponentsVersion &&
+            previous.lightComponentsVersion == mPrepareState.lightComponentsVersion &&
+            previous.shadowReceiversAreCasters == shadowReceiversAreCasters &&
+            mWorldTransform[0] == worldTransform[0] && mWorldTransform[1] == worldTransform[1] &&
+            mWorldTransform[2] == worldTransform[2] && mWorldTransform[3] == worldTransform[3];
+
+    // When several views render this scene in the same frame, only the first one prepares
+    // the renderables that didn't change. The others must not consider they didn't move since
+    // the previous frame, i.e. they keep previousWorldFromModelMatrix as is.
+    bool sameFrame = incremental && previous.frame == mPrepareState.frame;
+
+    mWorldTransform = worldTransform;
+
+    struct RenderableContainerData {
+        RenderableManager::Instance ri;
+        TransformManager::Instance ti;
+        uint32_t index; // index in the SoA
+    };
     using RenderableInstanceContainer = FixedCapacityVector<RenderableContainerData,
             utils::STLAllocator< RenderableContainerData, LinearAllocatorArena >, false>;
 
@@ -96,30 +136,83 @@ void FScene::prepare(utils::JobSystem& js,
     float maxIntensity = 0.0f;
     std::pair<LightManager::Instance, TransformManager::Instance> directionalLightInstances{};
 
-    /*
-     * First compute the exact number of renderables and lights in the scene.
-     * Also find the main directional light.
-     */
+    auto addLight = [&](LightManager::Instance li, TransformManager::Instance ti) {
+        // we handle the directional light here because it'd prevent multithreading below
+        if (UTILS_UNLIKELY(lcm.isDirectionalLight(li))) {
+            // we don't store the directional lights, because we only have a single one
+            if (lcm.getIntensity(li) >= maxIntensity) {
+                maxIntensity = lcm.getIntensity(li);
+                directionalLightInstances = { li, ti };
+            }
+        } else {
+            lightInstances.emplace_back(li, ti);
+        }
+    };
 
-    for (Entity const e: entities) {
-        if (UTILS_LIKELY(em.isAlive(e))) {
-            auto ti = tcm.getInstance(e);
-            auto li = lcm.getInstance(e);
-            auto ri = rcm.getInstance(e);
-            if (li) {
-                // we handle the directional light here because it'd prevent multithreading below
-                if (UTILS_UNLIKELY(lcm.isDirectionalLight(li))) {
-                    // we don't store the directional lights, because we only have a single one
-                    if (lcm.getIntensity(li) >= maxIntensity) {
-                        maxIntensity = lcm.getIntensity(li);
-                        directionalLightInstances = { li, ti };
-                    }
-                } else {
-                    lightInstances.emplace_back(li, ti);
+    if (incremental) {
+        /*
+         * Only gather the renderables that changed since the last prepare(). This still looks
+         * at every renderable of the SoA, but that's much cheaper than preparing them.
+         * Lights are few and always prepared.
+         */
+
+        auto const* const instances = sceneData.data<RENDERABLE_INSTANCE>();
+        for (size_t i = 0, c = sceneData.size(); i < c; i++) {
+            auto const ri = instances[i];
+            Entity const e = rcm.getEntity(ri);
+            if (UTILS_UNLIKELY(!em.isAlive(e))) {
+                // this renderable needs to be removed from the SoA
+                incremental = false;
+                sameFrame = false;
+                break;
+            }
+            auto const ti = tcm.getInstance(e);
+            if (rcm.getVersion(ri) > previous.renderableVersion ||
+                    tcm.getVersion(ti) > previous.transformVersion) {
+                renderableInstances.push_back({ ri, ti, uint32_t(i) });
+            } else {
+                sceneData.elementAt<VISIBLE_MASK>(i) = 0;
+                sceneData.elementAt<SUMMED_PRIMITIVE_COUNT>(i) = 0;
+                if (!sameFrame) {
+                    // this renderable didn't move since the last frame
+                    sceneData.elementAt<UBO>(i).previousWorldFromModelMatrix = shaderModelMatrix(
+                            rcm, ri, sceneData.elementAt<VISIBILITY_STATE>(i),
+                            sceneData.elementAt<WORLD_TRANSFORM>(i));
+                }
+            }
+        }
+
+        // when we fall back to the full gather below, it gathers the lights too
+        if (incremental) {
+            for (Entity const e: mLightEntities) {
+                if (UTILS_LIKELY(em.isAlive(e))) {
+                    addLight(lcm.getInstance(e), tcm.getInstance(e));
                 }
             }
-            if (ri) {
-                renderableInstances.emplace_back(ri, ti);
+        }
+    }
+
+    if (!incremental) {
+        /*
+         * First compute the exact number of renderables and lights in the scene.
+         * Also find the main directional light.
+         */
+
+        renderableInstances.clear();
+        mLightEntities.clear();
+        for (Entity const e: entities) {
+            if (UTILS_LIKELY(em.isAlive(e))) {
+                auto ti = tcm.getInstance(e);
+                auto li = lcm.getInstance(e);
+                auto ri = rcm.getInstance(e);
+                if (li) {
+                    addLight(li, ti);
+                    mLightEntities.push_back(e);
+                }
+                if (ri) {
+                    renderableInstances.push_back(
+                            { ri, ti, uint32_t(renderableInstances.size()) });
+                }
             }
         }
     }
@@ -148,7 +241,8 @@ void FScene::prepare(utils::JobSystem& js,
 
     // TODO: the resize below could happen in a job
 
-    if (!sceneData.capacity() || sceneData.size() != renderableInstances.size()) {
+    if (!incremental &&
+            (!sceneData.capacity() || sceneData.size() != renderableInstances.size())) {
         sceneData.clear();
         if (sceneData.capacity() < renderableDataCapacity) {
             sceneData.setCapacity(renderableDataCapacity);
@@ -166,16 +260,30 @@ void FScene::prepare(utils::JobSystem& js,
         lightData.resize(lightInstances.size() + DIRECTIONAL_LIGHTS_COUNT);
     }
 
+    // world-space AABBs for the culling hierarchy, i.e. without worldTransform applied
+    Aabb* const hierarchyBoxes = mCullingHierarchy ?
+            localArenaScope.allocate<Aabb>(sceneData.size()) : nullptr;
+
+    // which of these boxes are updated, when we only prepare the renderables that changed
+    bool* const hierarchyBoxChanged = mCullingHierarchy && incremental ?
+            localArenaScope.allocate<bool>(sceneData.size()) : nullptr;
+    if (hierarchyBoxChanged) {
+        std::fill_n(hierarchyBoxChanged, sceneData.size(), false);
+        for (auto const& instance: renderableInstances) {
+            hierarchyBoxChanged[instance.index] = true;
+        }
+    }
+
     /*
      * Fill the SoA with the JobSystem
      */
 
-    auto renderableWork = [first = renderableInstances.data(), &rcm, &tcm, &worldTransform,
-                 &sceneData, shadowReceiversAreCasters](auto* p, auto c) {
+    auto renderableWork = [&rcm, &tcm, &worldTransform, &sceneData, hierarchyBoxes,
+                 shadowReceiversAreCasters, incremental, sameFrame](auto* p, auto c) {
         SYSTRACE_NAME("renderableWork");
 
         for (size_t i = 0; i < c; i++) {
-            auto [ri, ti] = p[i];
+            auto [ri, ti, index] = p[i];
 
             // this is where we go from double to float for our transforms
             const mat4f shaderWorldTransform{
@@ -190,6 +298,10 @@ void FScene::prepare(utils::JobSystem& js,
             if (shadowReceiversAreCasters && visibility.receiveShadows) {
                 visibility.castShadows = true;
             }
+            if (UTILS_UNLIKELY(visibility.morphing) && rcm.areMorphWeightsIdle(ri)) {
+                // all the morph weights are zero, so morphing would be a no-op in every pass
+                visibility.morphing = false;
+            }
 
             // FIXME: We compute and store the local scale because it's needed for glTF but
             //        we need a better way to handle this
@@ -197,9 +309,23 @@ void FScene::prepare(utils::JobSystem& js,
             float const scale = (length(transform[0].xyz) + length(transform[1].xyz) +
                                  length(transform[2].xyz)) / 3.0f;
 
-            size_t const index = std::distance(first, p) + i;
             assert_invariant(index < sceneData.size());
 
+            if (hierarchyBoxes) {
+                Box const box = rigidTransform(rcm.getAABB(ri),
+                        mat4f{ tcm.getWorldTransformAccurate(ti) });
+                hierarchyBoxes[index] = { box.getMin(), box.getMax() };
+            }
+
+            // Only an incremental prepare() keeps each renderable at the same index of the SoA,
+            // otherwise we don't know where it was and assume it didn't move. Within a frame,
+            // the transform of the previous frame is already there.
+            if (!sameFrame) {
+                sceneData.elementAt<UBO>(index).previousWorldFromModelMatrix = shaderModelMatrix(
+                        rcm, ri, visibility, incremental ?
+                                sceneData.elementAt<WORLD_TRANSFORM>(index) : shaderWorldTransform);
+            }
+
             sceneData.elementAt<RENDERABLE_INSTANCE>(index) = ri;
             sceneData.elementAt<WORLD_TRANSFORM>(index)     = shaderWorldTransform;
             sceneData.elementAt<VISIBILITY_STATE>(index)    = visibility;
@@ -324,6 +450,99 @@ void FScene::prepare(utils::JobSystem& js,
     js.runAndWait(rootJob);
 
     SYSTRACE_NAME_END();
+
+    if (mCullingHierarchy) {
+        updateCullingHierarchy(sceneData.data<RENDERABLE_INSTANCE>(), hierarchyBoxes,
+                hierarchyBoxChanged, sceneData.size());
+    }
+}
+
+void FScene::updateCullingHierarchy(EntityInstance<RenderableManager> const* instances,
+        Aabb const* worldBoxes, bool const* changed, size_t count) noexcept {
+    SYSTRACE_CALL();
+    FRenderableManager const& rcm = mEngine.getRenderableManager();
+    CullingHierarchy& hierarchy = *mCullingHierarchy;
+    AabbTree& tree = hierarchy.tree;
+    uint32_t const generation = ++hierarchy.generation;
+
+    // Most renderables don't move, or move by less than their leaf's margin, in which case
+    // the update below is just a containment test.
+    for (size_t i = 0; i < count; i++) {
+        Entity const e = rcm.getEntity(instances[i]);
+        auto [pos, inserted] = hierarchy.leaves.try_emplace(e);
+        CullingHierarchy::Leaf& leaf = pos.value();
+        if (inserted) {
+            assert_invariant(!changed || changed[i]);
+            leaf.node = tree.insert(worldBoxes[i], uint32_t(i));
+        } else {
+            if (!changed || changed[i]) {
+                tree.update(leaf.node, worldBoxes[i]);
+            }
+            // views reorder the SoA, so the index must always be updated
+            tree.setUserData(leaf.node, uint32_t(i));
+        }
+        leaf.generation = generation;
+    }
+
+    // remove the leaves of renderables that are not in the scene anymore
+    if (hierarchy.leaves.size() != count) {
+        for (auto it = hierarchy.leaves.begin(); it != hierarchy.leaves.end();) {
+            if (it->second.generation != generation) {
+                tree.remove(it->second.node);
+                it = hierarchy.leaves.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    assert_invariant(tree.getLeafCount() == count);
+}
+
+void FScene::cullRenderables(Frustum const& frustum, size_t bit) noexcept {
+    SYSTRACE_CALL();
+    assert_invariant(mCullingHierarchy);
+
+    auto& sceneData = mRenderableData;
+    float3 const* const worldAABBCenter = sceneData.data<WORLD_AABB_CENTER>();
+    float3 const* const worldAABBExtent = sceneData.data<WORLD_AABB_EXTENT>();
+    VisibleMaskType* const visibleArray = sceneData.data<VISIBLE_MASK>();
+    VisibleMaskType const mask = VisibleMaskType(1u << bit);
+
+    // The hierarchy lives in world space, while the frustum has worldTransform applied.
+    // A plane transforms with the transpose of the point transform.
+    float4 const* const planes = frustum.getNormalizedPlanes();
+    mat4 const t = transpose(mWorldTransform);
+    float4 worldPlanes[6];
+    for (size_t j = 0; j < 6; j++) {
+        worldPlanes[j] = float4{ t * double4{ planes[j] }};
+    }
+
+    // only the renderables visited by the query can be visible
+    for (size_t i = 0, c = sceneData.size(); i < c; i++) {
+        visibleArray[i] &= ~mask;
+    }
+
+    mCullingHierarchy->tree.query(worldPlanes, [&](uint32_t index, bool inside) {
+        assert_invariant(index < sceneData.size());
+        // leaves are larger than their renderable, so only trust them when they're inside;
+        // otherwise we use the same test as Culler on the renderable's actual AABB.
+        if (inside || AabbTree::classify(planes, {
+                worldAABBCenter[index] - worldAABBExtent[index],
+                worldAABBCenter[index] + worldAABBExtent[index] })
+                        != AabbTree::Classification::OUTSIDE) {
+            visibleArray[index] |= mask;
+        }
+    });
+}
+
+void FScene::setCullingHierarchyEnabled(bool enabled) noexcept {
+    if (enabled && !mCullingHierarchy) {
+        // the hierarchy will be populated by the next prepare(), which needs to see everything
+        mCullingHierarchy = std::make_unique<CullingHierarchy>();
+        mPrepareState.valid = false;
+    } else if (!enabled) {
+        mCullingHierarchy.reset();
+    }
 }
 
 void FScene::prepareVisibleRenderables(Range<uint32_t> visibleRenderables) noexcept {
@@ -360,7 +579,8 @@ void FScene::prepareVisibleRenderables(Range<uint32_t> visibleRenderables) noexc
             m = -m;
         }
 
-        uboData.worldFromModelMatrix = model;
+        // the normals aren't quantized, so the normal matrix comes from the model matrix alone
+        uboData.worldFromModelMatrix = shaderModelMatrix(rcm, ri, visibility, model);
 
         uboData.worldFromModelNormalMatrix = m;
 
@@ -384,7 +604,8 @@ void FScene::prepareVisibleRenderables(Range<uint32_t> visibleRenderables) noexc
 
 void FScene::updateUBOs(
         Range<uint32_t> visibleRenderables,
-        Handle<HwBufferObject> renderableUbh) noexcept {
+        Handle<HwBufferObject> renderableUbh,
+        Frustum const* instanceCullingFrustum, bool hasShadows) noexcept {
     SYSTRACE_CALL();
     FEngine::DriverApi& driver = mEngine.getDriverApi();
 
@@ -402,16 +623,25 @@ void FScene::updateUBOs(
         }
     }();
 
+    FRenderableManager const& rcm = mEngine.getRenderableManager();
     PerRenderableData const* const uboData = mRenderableData.data<UBO>();
     mat4f const* const worldTransformData = mRenderableData.data<WORLD_TRANSFORM>();
+    auto const* const instanceData = mRenderableData.data<RENDERABLE_INSTANCE>();
 
-    // prepare each InstanceBuffer.
-    FRenderableManager::InstancesInfo const* instancesData = mRenderableData.data<INSTANCES>();
+    // prepare each InstanceBuffer, the draw calls use the number of instances that are visible.
+    FRenderableManager::InstancesInfo* const instancesData = mRenderableData.data<INSTANCES>();
+    FRenderableManager::Visibility const* const visibilityData =
+            mRenderableData.data<VISIBILITY_STATE>();
     for (uint32_t const i : visibleRenderables) {
         auto& instancesInfo = instancesData[i];
         if (UTILS_UNLIKELY(instancesInfo.buffer)) {
-            instancesInfo.buffer->prepare(
-                    mEngine, worldTransformData[i], uboData[i], instancesInfo.handle);
+            Frustum const* const frustum = (hasShadows && visibilityData[i].castShadows) ?
+                    nullptr : instanceCullingFrustum;
+            mat4f const dequantization = shaderModelMatrix(rcm, instanceData[i],
+                    visibilityData[i], mat4f{});
+            instancesInfo.count = uint16_t(instancesInfo.buffer->prepare(mEngine,
+                    worldTransformData[i], dequantization, uboData[i], instancesInfo.handle,
+                    frustum));
         }
     }
 
@@ -527,16 +757,22 @@ inline void FScene::computeLightRanges(
 UTILS_NOINLINE
 void FScene::addEntity(Entity entity) {
     mEntities.insert(entity);
+    mPrepareState.valid = false;
+    mEngine.markContentChanged();
 }
 
 UTILS_NOINLINE
 void FScene::addEntities(const Entity* entities, size_t count) {
     mEntities.insert(entities, entities + count);
+    mPrepareState.valid = false;
+    mEngine.markContentChanged();
 }
 
 UTILS_NOINLINE
 void FScene::remove(Entity entity) {
     mEntities.erase(entity);
+    mPrepareState.valid = false;
+    mEngine.markContentChanged();
 }
 
 UTILS_NOINLINE
@@ -595,9 +831,13 @@ bool FScene::hasContactShadows() const noexcept {
         return false;
     }
 
-    // find out if at least one light has contact-shadow enabled
-    // TODO: we could cache the result of this Loop in the LightManager
+    // no light at all has contact-shadows enabled, we don't need to look at ours
     auto& lcm = mEngine.getLightManager();
+    if (!lcm.getContactShadowsLightCount()) {
+        return false;
+    }
+
+    // find out if at least one of our lights has contact-shadow enabled
     const auto *pFirst = mLightData.begin<LIGHT_INSTANCE>();
     const auto *pLast = mLightData.end<LIGHT_INSTANCE>();
     while (pFirst != pLast) {
@@ -613,6 +853,42 @@ bool FScene::hasContactShadows() const noexcept {
 }
 
 UTILS_NOINLINE
+std::pair<Entity, float> FScene::intersectBoundingBoxes(float3 const origin,
+        float3 const direction, uint8_t const visibleLayers) const noexcept {
+    FRenderableManager const& rcm = mEngine.getRenderableManager();
+    FTransformManager const& tcm = mEngine.getTransformManager();
+
+    // slab test, infinite components of invDirection are handled by the min/max
+    float3 const invDirection = 1.0f / direction;
+    Entity closest;
+    float closestDistance = std::numeric_limits<float>::infinity();
+    for (Entity const entity : mEntities) {
+        auto const ri = rcm.getInstance(entity);
+        if (!ri || !(rcm.getLayerMask(ri) & visibleLayers)) {
+            continue;
+        }
+        auto const ti = tcm.getInstance(entity);
+        Box const box = ti ?
+                rigidTransform(rcm.getAABB(ri), mat4f{ tcm.getWorldTransformAccurate(ti) }) :
+                rcm.getAABB(ri);
+        float3 const t0 = (box.getMin() - origin) * invDirection;
+        float3 const t1 = (box.getMax() - origin) * invDirection;
+        float3 const tmin = min(t0, t1);
+        float3 const tmax = max(t0, t1);
+        float const tnear = std::max(std::max(tmin.x, tmin.y), tmin.z);
+        float const tfar = std::min(std::min(tmax.x, tmax.y), tmax.z);
+        if (tnear <= tfar && tfar >= 0.0f) {
+            // the ray can start inside the box
+            float const distance = std::max(tnear, 0.0f);
+            if (distance < closestDistance) {
+                closestDistance = distance;
+                closest = entity;
+            }
+        }
+    }
+    return { closest, closestDistance };
+}
+
 void FScene::forEach(Invocable<void(Entity)>&& functor) const noexcept {
     std::for_each(mEntities.begin(), mEntities.end(), std::move(functor));
 }
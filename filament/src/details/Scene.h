@@ -19,6 +19,7 @@
 
 #include "downcast.h"
 
+#include "AabbTree.h"
 #include "Allocators.h"
 #include "Culler.h"
 
@@ -29,8 +30,10 @@
 #include "BufferPoolAllocator.h"
 
 #include <filament/Box.h>
+#include <filament/Frustum.h>
 #include <filament/Scene.h>
 
+#include <math/mat4.h>
 #include <math/mathfwd.h>
 
 #include <utils/compiler.h>
@@ -42,9 +45,12 @@
 
 #include <stddef.h>
 
+#include <tsl/robin_map.h>
 #include <tsl/robin_set.h>
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace filament {
 
@@ -182,11 +188,33 @@ public:
     LightSoa const& getLightData() const noexcept { return mLightData; }
     LightSoa& getLightData() noexcept { return mLightData; }
 
+    // Instances of InstanceBuffers are culled against `instanceCullingFrustum` if it's not null.
+    // This leaves out the renderables that cast shadows when `hasShadows` is set, since their
+    // instances must still be drawn in the shadow maps.
     void updateUBOs(utils::Range<uint32_t> visibleRenderables,
-            backend::Handle<backend::HwBufferObject> renderableUbh) noexcept;
+            backend::Handle<backend::HwBufferObject> renderableUbh,
+            Frustum const* instanceCullingFrustum, bool hasShadows) noexcept;
 
     bool hasContactShadows() const noexcept;
 
+    bool hasCullingHierarchy() const noexcept { return bool(mCullingHierarchy); }
+
+    /*
+     * Sets `bit` of VISIBLE_MASK for the renderables intersecting the frustum and clears it
+     * for the others, using the culling hierarchy. The frustum is in the space of the last
+     * call to prepare(). Only valid if hasCullingHierarchy() is true.
+     */
+    void cullRenderables(Frustum const& frustum, size_t bit) noexcept;
+
+    /*
+     * Returns the renderable whose world-space bounding box is hit first by the ray, and the
+     * distance to the hit along `direction`, which must be normalized. Only the renderables in
+     * `visibleLayers` are tested. The entity is null if no bounding box is hit.
+     * This uses the current transforms, not the ones of the last call to prepare().
+     */
+    std::pair<utils::Entity, float> intersectBoundingBoxes(math::float3 origin,
+            math::float3 direction, uint8_t visibleLayers) const noexcept;
+
 private:
     friend class Scene;
     void setSkybox(FSkybox* skybox) noexcept;
@@ -198,12 +226,19 @@ private:
     size_t getEntityCount() const noexcept { return mEntities.size(); }
     size_t getRenderableCount() const noexcept;
     size_t getLightCount() const noexcept;
+    void setCullingHierarchyEnabled(bool enabled) noexcept;
+    bool isCullingHierarchyEnabled() const noexcept { return hasCullingHierarchy(); }
     bool hasEntity(utils::Entity entity) const noexcept;
     void forEach(utils::Invocable<void(utils::Entity)>&& functor) const noexcept;
 
     static inline void computeLightRanges(math::float2* zrange,
             CameraInfo const& camera, const math::float4* spheres, size_t count) noexcept;
 
+    // `changed` tells which boxes are valid, nullptr if they all are
+    void updateCullingHierarchy(
+            utils::EntityInstance<RenderableManager> const* instances,
+            Aabb const* worldBoxes, bool const* changed, size_t count) noexcept;
+
     FEngine& mEngine;
     FSkybox* mSkybox = nullptr;
     FIndirectLight* mIndirectLight = nullptr;
@@ -226,6 +261,45 @@ private:
     LightSoa mLightData;
     bool mHasContactShadows = false;
 
+    // the world transform used by the last prepare()
+    math::mat4 mWorldTransform;
+
+    /*
+     * What the last prepare() saw, so that the next one only updates the renderables that
+     * changed in the meantime. See the change tracking of FRenderableManager and
+     * FTransformManager.
+     */
+    struct PrepareState {
+        uint32_t renderableVersion = 0;
+        uint32_t transformVersion = 0;
+        uint32_t renderableComponentsVersion = 0;
+        uint32_t transformComponentsVersion = 0;
+        uint32_t lightComponentsVersion = 0;
+        uint64_t frame = 0;     // see FEngine::getFrameCount()
+        bool shadowReceiversAreCasters = false;
+        bool valid = false;     // false when the scene's entities have changed
+    };
+    PrepareState mPrepareState;
+
+    // entities of the scene that had a light component during the last full prepare()
+    std::vector<utils::Entity> mLightEntities;
+
+    /*
+     * Optional hierarchy of the renderables' world-space AABBs (i.e. without the view's world
+     * transform applied), it persists across frames and is updated by prepare(). Leaves'
+     * user data is the renderable's index in mRenderableData.
+     */
+    struct CullingHierarchy {
+        struct Leaf {
+            AabbTree::NodeId node;
+            uint32_t generation;
+        };
+        AabbTree tree;
+        tsl::robin_map<utils::Entity, Leaf, utils::Entity::Hasher> leaves;
+        uint32_t generation = 0;
+    };
+    std::unique_ptr<CullingHierarchy> mCullingHierarchy;
+
     // State shared between Scene and driver callbacks.
     struct SharedState {
         BufferPoolAllocator<3> mBufferPoolAllocator = {};
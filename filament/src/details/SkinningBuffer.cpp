@@ -25,7 +25,9 @@
 #include "FilamentAPI-impl.h"
 
 #include <math/half.h>
+#include <math/mat3.h>
 #include <math/mat4.h>
+#include <math/quat.h>
 
 #include <utils/CString.h>
 
@@ -90,7 +92,7 @@ FSkinningBuffer::FSkinningBuffer(FEngine& engine, const Builder& builder)
     if (builder->mInitialize) {
         // initialize the bones to identity (before rounding up)
         auto* out = driver.allocatePod<PerRenderableBoneUib::BoneData>(mBoneCount);
-        std::uninitialized_fill_n(out, mBoneCount, FSkinningBuffer::makeBone({}));
+        std::uninitialized_fill_n(out, mBoneCount, FSkinningBuffer::makeBone(mat4f{}));
         driver.updateBufferObject(mHandle, {
             out, mBoneCount * sizeof(PerRenderableBoneUib::BoneData) }, 0);
     }
@@ -130,13 +132,11 @@ static uint32_t packHalf2x16(half2 v) noexcept {
 
 void FSkinningBuffer::setBones(FEngine& engine, Handle<backend::HwBufferObject> handle,
         RenderableManager::Bone const* transforms, size_t boneCount, size_t offset) noexcept {
+    engine.markContentChanged();
     auto& driverApi = engine.getDriverApi();
     auto* UTILS_RESTRICT out = driverApi.allocatePod<PerRenderableBoneUib::BoneData>(boneCount);
     for (size_t i = 0, c = boneCount; i < c; ++i) {
-        // the transform is stored in row-major, last row is not stored.
-        mat4f transform(transforms[i].unitQuaternion);
-        transform[3] = float4{ transforms[i].translation, 1.0f };
-        out[i] = makeBone(transform);
+        out[i] = makeBone(transforms[i]);
     }
     driverApi.updateBufferObject(handle, {
                     out, boneCount * sizeof(PerRenderableBoneUib::BoneData) },
@@ -157,8 +157,27 @@ PerRenderableBoneUib::BoneData FSkinningBuffer::makeBone(mat4f transform) noexce
     };
 }
 
+PerRenderableBoneUib::BoneData FSkinningBuffer::makeBone(
+        RenderableManager::Bone const& bone) noexcept {
+    // The cofactor matrix of a rotation is the rotation itself, so unlike the general case
+    // there is no 4x4 matrix to build, transpose and invert.
+    const mat3f r(bone.unitQuaternion);
+    const float3 t = bone.translation;
+    // the transform is stored in row-major, last row is not stored.
+    return {
+            .transform = {
+                    float4{ r[0].x, r[1].x, r[2].x, t.x },
+                    float4{ r[0].y, r[1].y, r[2].y, t.y },
+                    float4{ r[0].z, r[1].z, r[2].z, t.z }
+            },
+            .cof0 = r[0],
+            .cof1x = r[1].x
+    };
+}
+
 void FSkinningBuffer::setBones(FEngine& engine, Handle<backend::HwBufferObject> handle,
         mat4f const* transforms, size_t boneCount, size_t offset) noexcept {
+    engine.markContentChanged();
     auto& driverApi = engine.getDriverApi();
     auto* UTILS_RESTRICT out = driverApi.allocatePod<PerRenderableBoneUib::BoneData>(boneCount);
     for (size_t i = 0, c = boneCount; i < c; ++i) {
@@ -261,6 +280,7 @@ FSkinningBuffer::HandleIndicesAndWeights FSkinningBuffer::createIndicesAndWeight
 void FSkinningBuffer::setIndicesAndWeightsData(FEngine& engine,
         backend::Handle<backend::HwTexture> textureHandle,
         const utils::FixedCapacityVector<math::float2>& pairs, size_t count) {
+    engine.markContentChanged();
 
     FEngine::DriverApi& driver = engine.getDriverApi();
     updateDataAt(driver, textureHandle,
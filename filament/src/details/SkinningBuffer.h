@@ -71,6 +71,8 @@ private:
 
     static PerRenderableBoneUib::BoneData makeBone(math::mat4f transform) noexcept;
 
+    static PerRenderableBoneUib::BoneData makeBone(RenderableManager::Bone const& bone) noexcept;
+
     backend::Handle<backend::HwBufferObject> getHwHandle() const noexcept {
         return mHandle;
     }
@@ -22,6 +22,7 @@
 #include "details/Texture.h"
 #include "details/VertexBuffer.h"
 
+#include "EmbeddedPackage.h"
 #include "FilamentAPI-impl.h"
 
 #include <filament/Material.h>
@@ -124,21 +125,23 @@ FSkybox::FSkybox(FEngine& engine, const Builder& builder) noexcept
 }
 
 FMaterial const* FSkybox::createMaterial(FEngine& engine) {
-    Material::Builder builder;
+    void const* data = MATERIALS_SKYBOX_DATA;
+    size_t size = MATERIALS_SKYBOX_SIZE;
 #ifdef FILAMENT_ENABLE_FEATURE_LEVEL_0
     if (UTILS_UNLIKELY(engine.getActiveFeatureLevel() == Engine::FeatureLevel::FEATURE_LEVEL_0)) {
-        builder.package(MATERIALS_SKYBOX_FL0_DATA, MATERIALS_SKYBOX_FL0_SIZE);
+        data = MATERIALS_SKYBOX_FL0_DATA;
+        size = MATERIALS_SKYBOX_FL0_SIZE;
     } else
 #endif
     {
         switch (engine.getConfig().stereoscopicType) {
             case Engine::StereoscopicType::NONE:
             case Engine::StereoscopicType::INSTANCED:
-                builder.package(MATERIALS_SKYBOX_DATA, MATERIALS_SKYBOX_SIZE);
                 break;
             case Engine::StereoscopicType::MULTIVIEW:
 #ifdef FILAMENT_ENABLE_MULTIVIEW
-                builder.package(MATERIALS_SKYBOX_MULTIVIEW_DATA, MATERIALS_SKYBOX_MULTIVIEW_SIZE);
+                data = MATERIALS_SKYBOX_MULTIVIEW_DATA;
+                size = MATERIALS_SKYBOX_MULTIVIEW_SIZE;
 #else
                 PANIC_POSTCONDITION("Multiview is enabled in the Engine, but this build has not "
                                     "been compiled for multiview.");
@@ -146,6 +149,9 @@ FMaterial const* FSkybox::createMaterial(FEngine& engine) {
                 break;
         }
     }
+    EmbeddedPackage const package(data, size);
+    Material::Builder builder;
+    builder.package(package.data(), package.size());
     auto material = builder.build(engine);
     return downcast(material);
 }
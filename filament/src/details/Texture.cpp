@@ -42,10 +42,13 @@
 #include <utils/compiler.h>
 #include <utils/debug.h>
 #include <utils/FixedCapacityVector.h>
+#include <utils/Invocable.h>
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <type_traits>
 #include <utility>
 
@@ -230,6 +233,8 @@ FTexture::FTexture(FEngine& engine, const Builder& builder) {
     mLevelCount = builder->mLevels;
 
     if (UTILS_LIKELY(builder->mImportedId == 0)) {
+        mMemorySize = computeMemorySize();
+        engine.trackTextureMemory(ptrdiff_t(mMemorySize));
         if (UTILS_LIKELY(!builder->mTextureIsSwizzled)) {
             mHandle = driver.createTexture(
                     mTarget, mLevelCount, mFormat, mSampleCount, mWidth, mHeight, mDepth, mUsage);
@@ -250,10 +255,36 @@ FTexture::FTexture(FEngine& engine, const Builder& builder) {
     }
 }
 
+// One prefiltered level of the reflections cubemap, ready to be uploaded.
+struct PrefilteredLevel {
+    ibl::Image image;
+    uint32_t dim = 0;
+    size_t faceOffsets[6] = {};
+};
+
+struct FTexture::PrefilterJob {
+    PixelBufferDescriptor buffer;
+    FaceOffsets faceOffsets;
+    PrefilterOptions options;
+    FixedCapacityVector<PrefilteredLevel> levels;
+    CallbackHandler* handler = nullptr;
+    Invocable<void(Texture*)> callback;
+    JobSystem::Job* job = nullptr;
+    std::atomic_bool done = false;
+};
+
 // frees driver resources, object becomes invalid
 void FTexture::terminate(FEngine& engine) {
+    if (UTILS_UNLIKELY(mPrefilterJob)) {
+        // the prefiltering job uses the texture's data, we need to wait for it to finish
+        engine.getJobSystem().waitAndRelease(mPrefilterJob->job);
+        engine.removePendingPrefilter(this);
+        delete mPrefilterJob;
+        mPrefilterJob = nullptr;
+    }
     FEngine::DriverApi& driver = engine.getDriverApi();
     driver.destroyTexture(mHandle);
+    engine.trackTextureMemory(-ptrdiff_t(mMemorySize));
 }
 
 size_t FTexture::getWidth(size_t level) const noexcept {
@@ -272,6 +303,7 @@ void FTexture::setImage(FEngine& engine, size_t level,
         uint32_t xoffset, uint32_t yoffset, uint32_t zoffset,
         uint32_t width, uint32_t height, uint32_t depth,
         FTexture::PixelBufferDescriptor&& p) const {
+    engine.markContentChanged();
 
     if (UTILS_UNLIKELY(!engine.hasFeatureLevel(FeatureLevel::FEATURE_LEVEL_1))) {
         FILAMENT_CHECK_PRECONDITION(p.stride == 0 || p.stride == width)
@@ -359,6 +391,7 @@ void FTexture::setImage(FEngine& engine, size_t level,
 // deprecated
 void FTexture::setImage(FEngine& engine, size_t level,
         Texture::PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets) const {
+    engine.markContentChanged();
 
     auto validateTarget = [](SamplerType sampler) -> bool {
         switch (sampler) {
@@ -423,6 +456,7 @@ void FTexture::setImage(FEngine& engine, size_t level,
 }
 
 void FTexture::setExternalImage(FEngine& engine, void* image) noexcept {
+    engine.markContentChanged();
     if (mTarget == Sampler::SAMPLER_EXTERNAL) {
         // The call to setupExternalImage is synchronous, and allows the driver to take ownership of
         // the external image on this thread, if necessary.
@@ -432,6 +466,7 @@ void FTexture::setExternalImage(FEngine& engine, void* image) noexcept {
 }
 
 void FTexture::setExternalImage(FEngine& engine, void* image, size_t plane) noexcept {
+    engine.markContentChanged();
     if (mTarget == Sampler::SAMPLER_EXTERNAL) {
         // The call to setupExternalImage is synchronous, and allows the driver to take ownership of
         // the external image on this thread, if necessary.
@@ -441,6 +476,7 @@ void FTexture::setExternalImage(FEngine& engine, void* image, size_t plane) noex
 }
 
 void FTexture::setExternalStream(FEngine& engine, FStream* stream) noexcept {
+    engine.markContentChanged();
     if (stream) {
         FILAMENT_CHECK_PRECONDITION(mTarget == Sampler::SAMPLER_EXTERNAL)
                 << "Texture target must be SAMPLER_EXTERNAL";
@@ -454,6 +490,7 @@ void FTexture::setExternalStream(FEngine& engine, FStream* stream) noexcept {
 }
 
 void FTexture::generateMipmaps(FEngine& engine) const noexcept {
+    engine.markContentChanged();
     FILAMENT_CHECK_PRECONDITION(mTarget != SamplerType::SAMPLER_EXTERNAL)
             << "External Textures are not mipmappable.";
 
@@ -471,6 +508,18 @@ void FTexture::generateMipmaps(FEngine& engine) const noexcept {
     engine.getDriverApi().generateMipmaps(mHandle);
 }
 
+void FTexture::setMinMaxLevels(FEngine& engine, size_t minLevel, size_t maxLevel) {
+    engine.markContentChanged();
+    FILAMENT_CHECK_PRECONDITION(minLevel <= maxLevel && maxLevel < mLevelCount)
+            << "Invalid level range [" << minLevel << ", " << maxLevel << "] for a texture with "
+            << unsigned(mLevelCount) << " levels";
+
+    FILAMENT_CHECK_PRECONDITION(mTarget != SamplerType::SAMPLER_EXTERNAL)
+            << "External Textures don't have levels.";
+
+    engine.getDriverApi().setMinMaxLevels(mHandle, uint32_t(minLevel), uint32_t(maxLevel));
+}
+
 bool FTexture::isTextureFormatSupported(FEngine& engine, InternalFormat format) noexcept {
     return engine.getDriverApi().isTextureFormatSupported(format);
 }
@@ -492,16 +541,32 @@ size_t FTexture::getFormatSize(InternalFormat format) noexcept {
     return backend::getFormatSize(format);
 }
 
+size_t FTexture::computeMemorySize() const noexcept {
+    if (mTarget == Sampler::SAMPLER_EXTERNAL) {
+        // the storage of external textures is owned by the stream or the external image
+        return 0;
+    }
+    // for compressed formats, the format size is the size of a block
+    size_t const formatSize = getFormatSize(mFormat);
+    size_t const blockWidth = std::max(size_t(1), backend::getBlockWidth(mFormat));
+    size_t const blockHeight = std::max(size_t(1), backend::getBlockHeight(mFormat));
+    size_t size = 0;
+    for (uint8_t level = 0; level < mLevelCount; level++) {
+        size_t const w = (valueForLevel(level, mWidth) + blockWidth - 1) / blockWidth;
+        size_t const h = (valueForLevel(level, mHeight) + blockHeight - 1) / blockHeight;
+        size_t const d = mTarget == Sampler::SAMPLER_3D ? valueForLevel(level, mDepth) : mDepth;
+        size += w * h * d * formatSize;
+    }
+    if (mTarget == Sampler::SAMPLER_CUBEMAP || mTarget == Sampler::SAMPLER_CUBEMAP_ARRAY) {
+        size *= 6;
+    }
+    return size * std::max(uint8_t(1), mSampleCount);
+}
 
-void FTexture::generatePrefilterMipmap(FEngine& engine,
-        PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
-        PrefilterOptions const* options) {
-    using namespace ibl;
-    using namespace backend;
-    using namespace math;
 
-    const size_t size = getWidth();
-    const size_t stride = buffer.stride ? buffer.stride : size;
+static size_t checkPrefilterPreconditions(FTexture const& texture,
+        Texture::PixelBufferDescriptor const& buffer) {
+    const size_t size = texture.getWidth();
 
     /* validate input data */
 
@@ -519,13 +584,20 @@ void FTexture::generatePrefilterMipmap(FEngine& engine,
     FILAMENT_CHECK_PRECONDITION(!(size & (size - 1)))
             << "input data cubemap dimensions must be a power-of-two";
 
-    FILAMENT_CHECK_PRECONDITION(!isCompressed()) << "reflections texture cannot be compressed";
+    FILAMENT_CHECK_PRECONDITION(!texture.isCompressed())
+            << "reflections texture cannot be compressed";
 
-    PrefilterOptions const defaultOptions;
-    options = options ? options : &defaultOptions;
+    return size;
+}
 
-    JobSystem& js = engine.getJobSystem();
-    FEngine::DriverApi& driver = engine.getDriverApi();
+// Runs the CPU prefiltering and returns all the levels of the reflections cubemap. This doesn't
+// use the driver, so it can run from any thread.
+static FixedCapacityVector<PrefilteredLevel> prefilterEnvironment(JobSystem& js, size_t size,
+        Texture::PixelBufferDescriptor const& buffer, Texture::FaceOffsets const& faceOffsets,
+        Texture::PrefilterOptions const& options) {
+    using namespace ibl;
+
+    const size_t stride = buffer.stride ? buffer.stride : size;
 
     auto generateMipmaps = [](JobSystem& js,
             FixedCapacityVector<Cubemap>& levels, FixedCapacityVector<Image>& images) {
@@ -619,13 +691,16 @@ void FTexture::generatePrefilterMipmap(FEngine& engine,
      * Create the mipmap chain
      */
 
-    auto images = FixedCapacityVector<Image>::with_capacity(getLevels());
-    auto levels = FixedCapacityVector<Cubemap>::with_capacity(getLevels());
+    const size_t baseExp = ctz(size);
+    const size_t numLevels = baseExp + 1;
+
+    auto images = FixedCapacityVector<Image>::with_capacity(numLevels);
+    auto levels = FixedCapacityVector<Cubemap>::with_capacity(numLevels);
 
     images.push_back(std::move(temp));
     levels.push_back(std::move(cml));
 
-    const float3 mirror = options->mirror ? float3{ -1, 1, 1 } : float3{ 1, 1, 1 };
+    const float3 mirror = options.mirror ? float3{ -1, 1, 1 } : float3{ 1, 1, 1 };
 
     // make the cubemap seamless
     levels[0].makeSeamless();
@@ -634,30 +709,39 @@ void FTexture::generatePrefilterMipmap(FEngine& engine,
     generateMipmaps(js, levels, images);
 
     // Finally generate each pre-filtered mipmap level
-    const size_t baseExp = ctz(size);
-    size_t const numSamples = options->sampleCount;
-    const size_t numLevels = baseExp + 1;
+    auto prefiltered = FixedCapacityVector<PrefilteredLevel>::with_capacity(numLevels);
+    size_t const numSamples = options.sampleCount;
     for (ssize_t i = (ssize_t)baseExp; i >= 0; --i) {
         const size_t dim = 1U << i;
         const size_t level = baseExp - i;
         const float lod = saturate(float(level) / float(numLevels - 1));
         const float linearRoughness = lod * lod;
 
-        Image image;
-        Cubemap dst = CubemapUtils::create(image, dim);
+        PrefilteredLevel result;
+        Cubemap dst = CubemapUtils::create(result.image, dim);
         CubemapIBL::roughnessFilter(js, dst, { levels.begin(), uint32_t(levels.size()) },
                 linearRoughness, numSamples, mirror, true);
 
-        Texture::PixelBufferDescriptor const pbd(image.getData(), image.getSize(),
-                Texture::PixelBufferDescriptor::PixelDataFormat::RGB,
-                Texture::PixelBufferDescriptor::PixelDataType::FLOAT, 1, 0, 0, image.getStride());
-
-        uintptr_t const base = uintptr_t(image.getData());
+        result.dim = uint32_t(dim);
+        uintptr_t const base = uintptr_t(result.image.getData());
         for (size_t j = 0; j < 6; j++) {
             Image const& faceImage = dst.getImageForFace((Cubemap::Face)j);
-            auto offset = uintptr_t(faceImage.getData()) - base;
-            driver.update3DImage(mHandle, level, 0, 0, j, dim, dim, 1, {
-                    (char*)image.getData() + offset, dim * dim * 3 * sizeof(float),
+            result.faceOffsets[j] = uintptr_t(faceImage.getData()) - base;
+        }
+        prefiltered.push_back(std::move(result));
+    }
+    return prefiltered;
+}
+
+static void uploadPrefilteredLevels(FEngine::DriverApi& driver, Handle<HwTexture> handle,
+        FixedCapacityVector<PrefilteredLevel>& levels) {
+    for (size_t level = 0; level < levels.size(); level++) {
+        ibl::Image& image = levels[level].image;
+        uint32_t const dim = levels[level].dim;
+        for (size_t j = 0; j < 6; j++) {
+            driver.update3DImage(handle, level, 0, 0, j, dim, dim, 1, {
+                    (char*)image.getData() + levels[level].faceOffsets[j],
+                    dim * dim * 3 * sizeof(float),
                     Texture::PixelBufferDescriptor::PixelDataFormat::RGB,
                     Texture::PixelBufferDescriptor::PixelDataType::FLOAT, 1,
                     0, 0, uint32_t(image.getStride())
@@ -667,11 +751,90 @@ void FTexture::generatePrefilterMipmap(FEngine& engine,
         // enqueue a commands that holds the image data until it's executed
         driver.queueCommand(make_copyable_function([data = image.detach()]() {}));
     }
+}
+
+void FTexture::generatePrefilterMipmap(FEngine& engine,
+        PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
+        PrefilterOptions const* options) {
+    const size_t size = checkPrefilterPreconditions(*this, buffer);
+
+    PrefilterOptions const defaultOptions;
+    options = options ? options : &defaultOptions;
+
+    auto levels = prefilterEnvironment(engine.getJobSystem(), size, buffer, faceOffsets,
+            *options);
+
+    uploadPrefilteredLevels(engine.getDriverApi(), mHandle, levels);
 
     // no need to call the user callback because buffer is a reference, and it'll be destroyed
     // by the caller (without being move()d here).
 }
 
+void FTexture::generatePrefilterMipmapAsync(FEngine& engine,
+        PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
+        PrefilterOptions const* options,
+        CallbackHandler* handler, Invocable<void(Texture*)>&& callback) {
+    const size_t size = checkPrefilterPreconditions(*this, buffer);
+
+    FILAMENT_CHECK_PRECONDITION(!mPrefilterJob)
+            << "a prefiltering is already pending on this texture";
+
+    PrefilterJob* const prefilterJob = new PrefilterJob{
+            .buffer = std::move(buffer),
+            .faceOffsets = faceOffsets,
+            .options = options ? *options : PrefilterOptions{},
+            .handler = handler,
+            .callback = std::move(callback) };
+
+    JobSystem& js = engine.getJobSystem();
+    prefilterJob->job = jobs::createJob(js, nullptr, [&js, size, prefilterJob]() {
+        prefilterJob->levels = prefilterEnvironment(js, size,
+                prefilterJob->buffer, prefilterJob->faceOffsets, prefilterJob->options);
+        prefilterJob->done.store(true, std::memory_order_release);
+    });
+    js.runAndRetain(prefilterJob->job);
+
+    mPrefilterJob = prefilterJob;
+    engine.addPendingPrefilter(this);
+}
+
+bool FTexture::updatePrefilterMipmap(FEngine& engine) {
+    PrefilterJob* const prefilterJob = mPrefilterJob;
+    if (!prefilterJob) {
+        return true;
+    }
+    if (!prefilterJob->done.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    engine.getJobSystem().waitAndRelease(prefilterJob->job);
+    uploadPrefilteredLevels(engine.getDriverApi(), mHandle, prefilterJob->levels);
+
+    if (prefilterJob->callback) {
+        struct Callback {
+            Invocable<void(Texture*)> f;
+            Texture* t;
+            static void func(void* user) {
+                auto* const c = reinterpret_cast<Callback*>(user);
+                c->f(c->t);
+                delete c;
+            }
+        };
+        auto* const user = new(std::nothrow) Callback{ std::move(prefilterJob->callback), this };
+        if (prefilterJob->handler) {
+            prefilterJob->handler->post(user, &Callback::func);
+        } else {
+            // we're on the engine's thread already
+            Callback::func(user);
+        }
+    }
+
+    // this releases the source buffer, which calls its callback
+    delete prefilterJob;
+    mPrefilterJob = nullptr;
+    return true;
+}
+
 bool FTexture::validatePixelFormatAndType(TextureFormat internalFormat,
         PixelDataFormat format, PixelDataType type) noexcept {
 
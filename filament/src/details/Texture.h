@@ -19,11 +19,13 @@
 
 #include "downcast.h"
 
+#include <backend/CallbackHandler.h>
 #include <backend/Handle.h>
 
 #include <filament/Texture.h>
 
 #include <utils/compiler.h>
+#include <utils/Invocable.h>
 
 namespace filament {
 
@@ -60,12 +62,23 @@ public:
             PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
             PrefilterOptions const* options);
 
+    void generatePrefilterMipmapAsync(FEngine& engine,
+            PixelBufferDescriptor&& buffer, const FaceOffsets& faceOffsets,
+            PrefilterOptions const* options,
+            backend::CallbackHandler* handler, utils::Invocable<void(Texture*)>&& callback);
+
+    // Uploads the result of generatePrefilterMipmapAsync() if it's ready. Returns true if there
+    // is no pending prefiltering left.
+    bool updatePrefilterMipmap(FEngine& engine);
+
     void setExternalImage(FEngine& engine, void* image) noexcept;
     void setExternalImage(FEngine& engine, void* image, size_t plane) noexcept;
     void setExternalStream(FEngine& engine, FStream* stream) noexcept;
 
     void generateMipmaps(FEngine& engine) const noexcept;
 
+    void setMinMaxLevels(FEngine& engine, size_t minLevel, size_t maxLevel);
+
     void setSampleCount(size_t sampleCount) noexcept { mSampleCount = uint8_t(sampleCount); }
     size_t getSampleCount() const noexcept { return mSampleCount; }
     bool isMultisample() const noexcept { return mSampleCount > 1; }
@@ -114,8 +127,13 @@ public:
     static bool validatePixelFormatAndType(backend::TextureFormat internalFormat,
             backend::PixelDataFormat format, backend::PixelDataType type) noexcept;
 
+    // Estimated GPU memory used by all the levels, layers and samples of this texture
+    size_t computeMemorySize() const noexcept;
+
 private:
     friend class Texture;
+    struct PrefilterJob;
+    PrefilterJob* mPrefilterJob = nullptr;
     FStream* mStream = nullptr;
     backend::Handle<backend::HwTexture> mHandle;
     uint32_t mWidth = 1;
@@ -126,6 +144,7 @@ private:
     uint8_t mLevelCount = 1;
     uint8_t mSampleCount = 1;
     Usage mUsage = Usage::DEFAULT;
+    size_t mMemorySize = 0; // 0 for imported textures, which we don't own
 };
 
 
@@ -295,6 +295,7 @@ FVertexBuffer::FVertexBuffer(FEngine& engine, const VertexBuffer::Builder& build
                     }
                     driver.setVertexBufferObject(mHandle, i, bo);
                     mBufferObjects[i] = bo;
+                    mByteCount += bufferSizes[i];
                 }
             }
         }
@@ -318,6 +319,7 @@ FVertexBuffer::FVertexBuffer(FEngine& engine, const VertexBuffer::Builder& build
             }
         }
     }
+    engine.trackBufferMemory(ptrdiff_t(mByteCount));
 }
 
 void FVertexBuffer::terminate(FEngine& engine) {
@@ -329,6 +331,7 @@ void FVertexBuffer::terminate(FEngine& engine) {
     }
     driver.destroyVertexBuffer(mHandle);
     engine.getVertexBufferInfoFactory().destroy(driver, mVertexBufferInfoHandle);
+    engine.trackBufferMemory(-ptrdiff_t(mByteCount));
 }
 
 size_t FVertexBuffer::getVertexCount() const noexcept {
@@ -337,6 +340,7 @@ size_t FVertexBuffer::getVertexCount() const noexcept {
 
 void FVertexBuffer::setBufferAt(FEngine& engine, uint8_t bufferIndex,
         backend::BufferDescriptor&& buffer, uint32_t byteOffset) {
+    engine.markContentChanged();
     FILAMENT_CHECK_PRECONDITION(!mBufferObjectsEnabled) << "Please use setBufferObjectAt()";
     if (bufferIndex < mBufferCount) {
         assert_invariant(mBufferObjects[bufferIndex]);
@@ -350,6 +354,7 @@ void FVertexBuffer::setBufferAt(FEngine& engine, uint8_t bufferIndex,
 
 void FVertexBuffer::setBufferObjectAt(FEngine& engine, uint8_t bufferIndex,
         FBufferObject const * bufferObject) {
+    engine.markContentChanged();
     FILAMENT_CHECK_PRECONDITION(mBufferObjectsEnabled) << "Please use setBufferAt()";
     FILAMENT_CHECK_PRECONDITION(bufferObject->getBindingType() == BufferObject::BindingType::VERTEX)
             << "Binding type must be VERTEX.";
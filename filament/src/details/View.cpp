@@ -39,6 +39,7 @@
 
 #include <utils/compiler.h>
 #include <utils/debug.h>
+#include <utils/Hash.h>
 #include <utils/Profiler.h>
 #include <utils/Slice.h>
 #include <utils/Systrace.h>
@@ -47,9 +48,15 @@
 #include <math/scalar.h>
 #include <math/fast.h>
 
+#include <tsl/robin_map.h>
+
+#include <algorithm>
 #include <array>
 #include <memory>
 #include <tuple>
+#include <vector>
+
+#include <string.h>
 
 using namespace utils;
 
@@ -127,6 +134,8 @@ void FView::terminate(FEngine& engine) {
         FPickingQuery::put(pQuery);
     }
 
+    mOcclusionCuller.terminate();
+
     DriverApi& driver = engine.getDriverApi();
     driver.destroyBufferObject(mLightUbh);
     driver.destroyBufferObject(mRenderableUbh);
@@ -552,8 +561,24 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
          * (this will set the VISIBLE_RENDERABLE bit)
          */
 
-        prepareVisibleRenderables(js, cullingFrustum, renderableData);
+        prepareVisibleRenderables(js, cullingFrustum, *scene);
 
+        /*
+         * Occlusion culling: test the renderables that survived frustum culling against the
+         * depth buffer of a previous frame (this can clear the VISIBLE_RENDERABLE bit)
+         */
+
+        mOcclusionCulledCount = 0;
+        // the depth buffer is rendered from the viewing camera, so it can't be used with a
+        // debug camera.
+        if (UTILS_UNLIKELY(mOcclusionCulling && isFrustumCullingEnabled() && !mViewingCamera)) {
+            SYSTRACE_NAME("Occlusion culling");
+            mOcclusionCulledCount = uint32_t(mOcclusionCuller.cull(cullingMask.data(),
+                    renderableData.data<FScene::WORLD_AABB_CENTER>(),
+                    renderableData.data<FScene::WORLD_AABB_EXTENT>(),
+                    renderableData.size(), VISIBLE_RENDERABLE_BIT,
+                    cameraInfo.worldTransform));
+        }
 
         /*
          * Shadowing: compute the shadow camera and cull shadow casters
@@ -614,8 +639,9 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
          * contain punctual light shadow casters as well. The fourth group contains *only* punctual
          * shadow casters.
          *
-         * This operation is somewhat heavy as it sorts the whole SoA. We use std::partition instead
-         * of sort(), which gives us O(4.N) instead of O(N.log(N)) application of swap().
+         * This operation is somewhat heavy as it reorders the whole SoA. We bucket the
+         * renderables in place in a single pass instead of sorting them, which gives us at most
+         * N applications of swap(), and none for the renderables already in their group.
          */
 
         // TODO: we need to compare performance of doing this partitioning vs not doing it.
@@ -629,36 +655,21 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
         computeVisibilityMasks(getVisibleLayers(), layers, visibility, cullingMask.begin(),
                 renderableData.size());
 
-        auto const beginRenderables = renderableData.begin();
-
-        auto beginDirCasters = partition(beginRenderables, renderableData.end(),
-                VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE,
-                VISIBLE_RENDERABLE);
-
-        auto beginDirCastersOnly = partition(beginDirCasters, renderableData.end(),
-                VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE,
-                VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE);
-
-        auto endDirCastersOnly = partition(beginDirCastersOnly, renderableData.end(),
-                VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE,
-                VISIBLE_DIR_SHADOW_RENDERABLE);
-
-        auto endPotentialSpotCastersOnly = partition(endDirCastersOnly, renderableData.end(),
-                VISIBLE_DYN_SHADOW_RENDERABLE,
-                VISIBLE_DYN_SHADOW_RENDERABLE);
+        auto const groupEnd = partitionVisibility(renderableData);
+        uint32_t const beginDirCasters = groupEnd[VISIBLE_ONLY];
+        uint32_t const beginDirCastersOnly = groupEnd[VISIBLE_AND_DIR_CASTER];
+        uint32_t const endDirCastersOnly = groupEnd[DIR_CASTER_ONLY];
+        uint32_t const endPotentialSpotCastersOnly = groupEnd[DYN_CASTER_ONLY];
 
-        // convert to indices
-        mVisibleRenderables = { 0, uint32_t(beginDirCastersOnly - beginRenderables) };
+        mVisibleRenderables = { 0, beginDirCastersOnly };
 
-        mVisibleDirectionalShadowCasters = {
-                uint32_t(beginDirCasters - beginRenderables),
-                uint32_t(endDirCastersOnly - beginRenderables)};
+        mVisibleDirectionalShadowCasters = { beginDirCasters, endDirCastersOnly };
 
-        merged = { 0, uint32_t(endPotentialSpotCastersOnly - beginRenderables) };
+        merged = { 0, endPotentialSpotCastersOnly };
         if (!needsShadowMap() || !mShadowMapManager->hasSpotShadows()) {
             // we know we don't have spot shadows, we can reduce the range to not even include
             // the potential spot casters
-            merged = { 0, uint32_t(endDirCastersOnly - beginRenderables) };
+            merged = { 0, endDirCastersOnly };
         }
 
         mSpotLightShadowCasters = merged;
@@ -670,6 +681,10 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
         //       e.g. could we deffer some of the prepareVisibleRenderables() to later?
         scene->prepareVisibleRenderables(merged);
 
+        // Select the levels of detail from the main camera, so all passes (including the shadow
+        // passes) draw the same primitives. This must run before RenderPass::appendCommands.
+        updatePrimitivesLod(engine, cameraInfo, renderableData, merged);
+
         // update those UBOs
         const size_t size = merged.size() * sizeof(PerRenderableData);
         if (size) {
@@ -685,7 +700,8 @@ void FView::prepare(FEngine& engine, DriverApi& driver, RootArenaScope& rootAren
                 // TODO: should we shrink the underlying UBO at some point?
             }
             assert_invariant(mRenderableUbh);
-            scene->updateUBOs(merged, mRenderableUbh);
+            scene->updateUBOs(merged, mRenderableUbh,
+                    isFrustumCullingEnabled() ? &cullingFrustum : nullptr, needsShadowMap());
         }
     }
 
@@ -767,15 +783,59 @@ void FView::computeVisibilityMasks(
 }
 
 UTILS_NOINLINE
-/* static */ FScene::RenderableSoa::iterator FView::partition(
-        FScene::RenderableSoa::iterator begin,
-        FScene::RenderableSoa::iterator end,
-        Culler::result_type mask, Culler::result_type value) noexcept {
-    return std::partition(begin, end, [mask, value](auto it) {
-        // Mask VISIBLE_MASK to ignore higher bits related to spot shadows. We only partition based
-        // on renderable and directional shadow visibility.
-        return (it.template get<FScene::VISIBLE_MASK>() & mask) == value;
-    });
+/* static */ std::array<uint32_t, FView::VISIBILITY_GROUP_COUNT> FView::partitionVisibility(
+        FScene::RenderableSoa& renderableData) noexcept {
+    // Group of a renderable indexed by the lowest three bits of its VISIBLE_MASK. Higher bits
+    // are related to spot shadows and are ignored. The first three groups only depend on
+    // VISIBLE_RENDERABLE and VISIBLE_DIR_SHADOW_RENDERABLE, and thus can also contain punctual
+    // light shadow casters.
+    constexpr uint8_t groups[8] = {
+            INVISIBLE,                  // 0
+            VISIBLE_ONLY,               // VISIBLE_RENDERABLE
+            DIR_CASTER_ONLY,            // VISIBLE_DIR_SHADOW_RENDERABLE
+            VISIBLE_AND_DIR_CASTER,     // VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE
+            DYN_CASTER_ONLY,            // VISIBLE_DYN_SHADOW_RENDERABLE
+            VISIBLE_ONLY,
+            DIR_CASTER_ONLY,
+            VISIBLE_AND_DIR_CASTER,
+    };
+    static_assert((VISIBLE_RENDERABLE | VISIBLE_DIR_SHADOW_RENDERABLE |
+            VISIBLE_DYN_SHADOW_RENDERABLE) == 7u);
+
+    // note: the mask array stays valid while we swap elements, the SoA doesn't reallocate
+    Culler::result_type const* const mask = renderableData.data<FScene::VISIBLE_MASK>();
+    uint32_t const size = uint32_t(renderableData.size());
+
+    // histogram of the groups, this loop is only reads and gets vectorized
+    std::array<uint32_t, VISIBILITY_GROUP_COUNT> count{};
+    for (uint32_t i = 0; i < size; i++) {
+        count[groups[mask[i] & 7u]]++;
+    }
+
+    std::array<uint32_t, VISIBILITY_GROUP_COUNT> next{};
+    std::array<uint32_t, VISIBILITY_GROUP_COUNT> end{};
+    for (uint32_t g = 0, offset = 0; g < VISIBILITY_GROUP_COUNT; g++) {
+        next[g] = offset;
+        offset += count[g];
+        end[g] = offset;
+    }
+
+    // Swap each misplaced renderable straight to the next free slot of its group. Every swap
+    // places at least one renderable for good. Once all groups but the last are filled, the
+    // last one is too.
+    for (uint32_t g = 0; g < VISIBILITY_GROUP_COUNT - 1; g++) {
+        while (next[g] < end[g]) {
+            uint32_t const i = next[g];
+            uint8_t const group = groups[mask[i] & 7u];
+            if (group == g) {
+                next[g]++;
+            } else {
+                renderableData.swap(i, next[group]++);
+            }
+        }
+    }
+
+    return end;
 }
 
 void FView::prepareUpscaler(float2 scale,
@@ -799,6 +859,9 @@ void FView::prepareUpscaler(float2 scale,
 void FView::prepareCamera(FEngine& engine, const CameraInfo& cameraInfo) const noexcept {
     SYSTRACE_CALL();
     mPerViewUniforms.prepareCamera(engine, cameraInfo);
+    if (UTILS_UNLIKELY(mCameraLateLatchCallback)) {
+        mPerViewUniforms.prepareCameraLateLatch(engine, cameraInfo, mCameraLateLatchCallback);
+    }
 }
 
 void FView::prepareViewport(
@@ -872,10 +935,11 @@ void FView::commitFroxels(DriverApi& driverApi) const noexcept {
 
 UTILS_NOINLINE
 void FView::prepareVisibleRenderables(JobSystem& js,
-        Frustum const& frustum, FScene::RenderableSoa& renderableData) const noexcept {
+        Frustum const& frustum, FScene& scene) const noexcept {
     SYSTRACE_CALL();
+    FScene::RenderableSoa& renderableData = scene.getRenderableData();
     if (UTILS_LIKELY(isFrustumCullingEnabled())) {
-        FView::cullRenderables(js, renderableData, frustum, VISIBLE_RENDERABLE_BIT);
+        FView::cullRenderables(js, scene, frustum, VISIBLE_RENDERABLE_BIT);
     } else {
         std::uninitialized_fill(renderableData.begin<FScene::VISIBLE_MASK>(),
                   renderableData.end<FScene::VISIBLE_MASK>(), VISIBLE_RENDERABLE);
@@ -883,9 +947,16 @@ void FView::prepareVisibleRenderables(JobSystem& js,
 }
 
 void FView::cullRenderables(JobSystem&,
-        FScene::RenderableSoa& renderableData, Frustum const& frustum, size_t bit) noexcept {
+        FScene& scene, Frustum const& frustum, size_t bit) noexcept {
     SYSTRACE_CALL();
 
+    if (scene.hasCullingHierarchy()) {
+        scene.cullRenderables(frustum, bit);
+        return;
+    }
+
+    FScene::RenderableSoa& renderableData = scene.getRenderableData();
+
     float3 const* worldAABBCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
     float3 const* worldAABBExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
     FScene::VisibleMaskType* visibleArray = renderableData.data<FScene::VISIBLE_MASK>();
@@ -1017,13 +1088,33 @@ inline void FView::computeLightCameraDistances(
     }
 }
 
-void FView::updatePrimitivesLod(FEngine& engine, const CameraInfo&,
+void FView::updatePrimitivesLod(FEngine& engine, const CameraInfo& camera,
         FScene::RenderableSoa& renderableData, Range visible) noexcept {
-    FRenderableManager const& rcm = engine.getRenderableManager();
+    FRenderableManager& rcm = engine.getRenderableManager();
+    auto const* const UTILS_RESTRICT instances = renderableData.data<FScene::RENDERABLE_INSTANCE>();
+    float3 const* const UTILS_RESTRICT centers = renderableData.data<FScene::WORLD_AABB_CENTER>();
+    float3 const* const UTILS_RESTRICT extents = renderableData.data<FScene::WORLD_AABB_EXTENT>();
+    Slice<FRenderPrimitive>* const UTILS_RESTRICT primitives =
+            renderableData.data<FScene::PRIMITIVES>();
+
+    // The projected size of the bounding sphere as a fraction of the viewport height is
+    // radius * p[1][1] / distance with a perspective projection, and radius * p[1][1] with an
+    // orthographic one.
+    mat4f const& viewMatrix = camera.view;
+    float const scale = camera.projection[1][1];
+    bool const perspective = camera.projection[2][3] != 0.0f;
+
     for (uint32_t const index : visible) {
-        uint8_t const level = 0; // TODO: pick the proper level of detail
-        auto ri = renderableData.elementAt<FScene::RENDERABLE_INSTANCE>(index);
-        renderableData.elementAt<FScene::PRIMITIVES>(index) = rcm.getRenderPrimitives(ri, level);
+        FRenderableManager::Instance const ri = instances[index];
+        uint8_t level = 0;
+        if (UTILS_UNLIKELY(rcm.getLevelCount(ri) > 1)) {
+            float const radius = length(extents[index]);
+            float const distance = perspective ?
+                    std::max(length((viewMatrix * float4{ centers[index], 1.0f }).xyz), camera.zn) :
+                    1.0f;
+            level = rcm.selectLevelOfDetail(ri, radius * scale / distance);
+        }
+        primitives[index] = rcm.getRenderPrimitives(ri, level);
     }
 }
 
@@ -1042,6 +1133,7 @@ void FView::commitFrameHistory(FEngine& engine) noexcept {
     FrameHistoryEntry& last = frameHistory.back();
     disposer.destroy(std::move(last.taa.color.handle));
     disposer.destroy(std::move(last.ssr.color.handle));
+    disposer.destroy(std::move(last.autoExposure.color.handle));
 
     // and then push the new history entry to the history stack
     frameHistory.commit();
@@ -1055,11 +1147,13 @@ void FView::clearFrameHistory(FEngine& engine) noexcept {
         FrameHistoryEntry& last = frameHistory[i];
         disposer.destroy(std::move(last.taa.color.handle));
         disposer.destroy(std::move(last.ssr.color.handle));
+        disposer.destroy(std::move(last.autoExposure.color.handle));
     }
 }
 
 void FView::executePickingQueries(backend::DriverApi& driver,
-        backend::RenderTargetHandle handle, float2 scale) noexcept {
+        backend::RenderTargetHandle handle, float2 scale,
+        uint32_t const width, uint32_t const height) noexcept {
 
     while (mActivePickingQueriesList) {
         FPickingQuery* const pQuery = mActivePickingQueriesList;
@@ -1106,6 +1200,139 @@ void FView::executePickingQueries(backend::DriverApi& driver,
             });
         }
     }
+
+    bool const fl0 = driver.getFeatureLevel() == FeatureLevel::FEATURE_LEVEL_0;
+    while (mActiveMultiPickingQueriesList) {
+        FMultiPickingQuery* const pQuery = mActiveMultiPickingQueriesList;
+        mActiveMultiPickingQueriesList = pQuery->next;
+
+        // adjust for dynamic resolution and structure buffer scale, and stay within the target
+        uint32_t const x0 = std::min(uint32_t(float(pQuery->x) * scale.x), width - 1);
+        uint32_t const y0 = std::min(uint32_t(float(pQuery->y) * scale.y), height - 1);
+        uint32_t const x1 = std::clamp(
+                uint32_t(float(pQuery->x + pQuery->width - 1) * scale.x) + 1, x0 + 1, width);
+        uint32_t const y1 = std::clamp(
+                uint32_t(float(pQuery->y + pQuery->height - 1) * scale.y) + 1, y0 + 1, height);
+
+        pQuery->scale = scale;
+        pQuery->readX = x0;
+        pQuery->readY = y0;
+        pQuery->readWidth = x1 - x0;
+        pQuery->readHeight = y1 - y0;
+        pQuery->fl0 = fl0;
+
+        size_t const size = pQuery->readWidth * pQuery->readHeight * (fl0 ? 4u : 8u);
+        driver.readPixels(handle, x0, y0, pQuery->readWidth, pQuery->readHeight, {
+                ::malloc(size), size,
+                fl0 ? backend::PixelDataFormat::RGBA : backend::PixelDataFormat::RG,
+                fl0 ? backend::PixelDataType::UBYTE : backend::PixelDataType::FLOAT,
+                pQuery->handler, [](void* buffer, size_t, void* user) {
+                    resolveMultiPickingQuery(static_cast<FMultiPickingQuery*>(user), buffer);
+                    ::free(buffer);
+                }, pQuery
+        });
+    }
+}
+
+View::PickingQueryResult FView::decodePickingPixel(void const* pixel, bool const fl0) noexcept {
+    PickingQueryResult result{};
+    if (UTILS_UNLIKELY(fl0)) {
+        // see executePickingQueries() for the FEATURE_LEVEL_0 encoding
+        uint8_t const* const p = static_cast<uint8_t const*>(pixel);
+        int32_t const identity = int32_t(uint32_t(p[3]) << 16u | (uint32_t(p[2]) << 8u) | p[1]);
+        result.renderable = Entity::import(identity);
+        result.depth = float(p[0]) / 255.0f;
+    } else {
+        // the first channel holds the identity bits, the second the depth
+        uint32_t identity;
+        memcpy(&identity, pixel, sizeof(identity));
+        memcpy(&result.depth, static_cast<uint8_t const*>(pixel) + 4, sizeof(result.depth));
+        result.renderable = Entity::import(int32_t(identity));
+    }
+    return result;
+}
+
+void FView::resolveMultiPickingQuery(FMultiPickingQuery* pQuery, void const* pixels) noexcept {
+    uint8_t const* const data = static_cast<uint8_t const*>(pixels);
+    size_t const pixelSize = pQuery->fl0 ? 4u : 8u;
+    uint32_t const w = pQuery->readWidth;
+    uint32_t const h = pQuery->readHeight;
+    float2 const scale = pQuery->scale;
+
+    std::vector<PickingQueryResult> results;
+    if (!pQuery->rect) {
+        results.reserve(pQuery->coords.size());
+        for (uint2 const c : pQuery->coords) {
+            uint32_t const px = std::clamp(uint32_t(float(c.x) * scale.x) - pQuery->readX,
+                    0u, w - 1);
+            uint32_t const py = std::clamp(uint32_t(float(c.y) * scale.y) - pQuery->readY,
+                    0u, h - 1);
+            PickingQueryResult result = decodePickingPixel(data + (py * w + px) * pixelSize,
+                    pQuery->fl0);
+            result.fragCoords = { c.x, c.y, float(1.0 - result.depth) };
+            results.push_back(result);
+        }
+    } else {
+        // keep the pixel nearest to the camera of each renderable
+        tsl::robin_map<uint32_t, size_t> indices;
+        for (uint32_t py = 0; py < h; py++) {
+            for (uint32_t px = 0; px < w; px++) {
+                PickingQueryResult result = decodePickingPixel(data + (py * w + px) * pixelSize,
+                        pQuery->fl0);
+                if (result.renderable.isNull()) {
+                    continue;
+                }
+                result.fragCoords = {
+                        (float(pQuery->readX + px) + 0.5f) / scale.x,
+                        (float(pQuery->readY + py) + 0.5f) / scale.y,
+                        float(1.0 - result.depth) };
+                auto const [pos, inserted] = indices.insert(
+                        { result.renderable.getId(), results.size() });
+                if (inserted) {
+                    results.push_back(result);
+                } else if (result.depth > results[pos->second].depth) {
+                    // depth is 1 at the near plane
+                    results[pos->second] = result;
+                }
+            }
+        }
+    }
+
+    pQuery->callback(results.empty() ? nullptr : results.data(), results.size(), pQuery);
+    FMultiPickingQuery::put(pQuery);
+}
+
+void FView::readbackOcclusionDepth(backend::DriverApi& driver,
+        backend::RenderTargetHandle handle, uint32_t width, uint32_t height,
+        CameraInfo const& cameraInfo) noexcept {
+    mOcclusionCuller.readback(driver, handle, width, height,
+            mat4{ cameraInfo.projection } * cameraInfo.getUserViewMatrix());
+}
+
+void FView::setShadowDepthFittingEnabled(bool enabled) noexcept {
+    if (mShadowDepthFitting != enabled) {
+        mShadowDepthFitting = enabled;
+        // don't use a stale depth buffer when shadow fitting gets re-enabled
+        mOcclusionCuller.reset();
+    }
+}
+
+float2 FView::getVisibleDistanceRange(CameraInfo const& cameraInfo) const noexcept {
+    // the depth buffer is rendered from the viewing camera, so it can't be used with a
+    // debug camera.
+    if (!mShadowDepthFitting || mViewingCamera) {
+        return {};
+    }
+    return mOcclusionCuller.getVisibleDistanceRange(cameraInfo.getUserViewMatrix());
+}
+
+void FView::setOcclusionCullingEnabled(bool enabled) noexcept {
+    if (mOcclusionCulling != enabled) {
+        mOcclusionCulling = enabled;
+        // don't use a stale depth buffer when occlusion culling gets re-enabled
+        mOcclusionCuller.reset();
+        mOcclusionCulledCount = 0;
+    }
 }
 
 void FView::setTemporalAntiAliasingOptions(TemporalAntiAliasingOptions options) noexcept {
@@ -1125,6 +1352,8 @@ void FView::setScreenSpaceReflectionsOptions(ScreenSpaceReflectionsOptions optio
     options.bias = std::max(0.0f, options.bias);
     options.maxDistance = std::max(0.0f, options.maxDistance);
     options.stride = std::max(1.0f, options.stride);
+    // snap to the closer of 0.5 or 1.0
+    options.resolution = options.resolution < 0.75f ? 0.5f : 1.0f;
     mScreenSpaceReflectionsOptions = options;
 }
 
@@ -1136,9 +1365,9 @@ void FView::setAmbientOcclusionOptions(AmbientOcclusionOptions options) noexcept
     options.radius = math::max(0.0f, options.radius);
     options.power = std::max(0.0f, options.power);
     options.bias = math::clamp(options.bias, 0.0f, 0.1f);
-    // snap to the closer of 0.5 or 1.0
-    options.resolution = std::floor(
-            math::clamp(options.resolution * 2.0f, 1.0f, 2.0f) + 0.5f) * 0.5f;
+    // snap to the closer of 0.25, 0.5 or 1.0
+    options.resolution = options.resolution < 0.375f ? 0.25f :
+            (options.resolution < 0.75f ? 0.5f : 1.0f);
     options.intensity = std::max(0.0f, options.intensity);
     options.bilateralThreshold = std::max(0.0f, options.bilateralThreshold);
     options.minHorizonAngleRad = math::clamp(options.minHorizonAngleRad, 0.0f, math::f::PI_2);
@@ -1196,6 +1425,15 @@ void FView::setVignetteOptions(VignetteOptions options) noexcept {
     mVignetteOptions = options;
 }
 
+void FView::setAutoExposureOptions(AutoExposureOptions options) noexcept {
+    options.maxLogLuminance = std::max(options.maxLogLuminance, options.minLogLuminance + 1.0f);
+    options.lowPercentile = math::saturate(options.lowPercentile);
+    options.highPercentile = math::clamp(options.highPercentile, options.lowPercentile, 1.0f);
+    options.speedUp = std::max(options.speedUp, 0.0f);
+    options.speedDown = std::max(options.speedDown, 0.0f);
+    mAutoExposureOptions = options;
+}
+
 View::PickingQuery& FView::pick(uint32_t x, uint32_t y, backend::CallbackHandler* handler,
         View::PickingQueryResultCallback callback) noexcept {
     FPickingQuery* pQuery = FPickingQuery::get(x, y, handler, callback);
@@ -1204,6 +1442,74 @@ View::PickingQuery& FView::pick(uint32_t x, uint32_t y, backend::CallbackHandler
     return *pQuery;
 }
 
+View::PickingQuery& FView::pick(uint2 const* coords, size_t const count,
+        backend::CallbackHandler* handler,
+        View::MultiPickingQueryResultCallback callback) noexcept {
+    // the readback covers the bounding rectangle of the coordinates
+    uint2 first = count ? coords[0] : uint2{};
+    uint2 last = first;
+    for (size_t i = 1; i < count; i++) {
+        first = min(first, coords[i]);
+        last = max(last, coords[i]);
+    }
+    auto copy = FixedCapacityVector<uint2>::with_capacity(count);
+    for (size_t i = 0; i < count; i++) {
+        copy.push_back(coords[i]);
+    }
+    FMultiPickingQuery* pQuery = FMultiPickingQuery::get(false, std::move(copy),
+            first.x, first.y, last.x - first.x + 1, last.y - first.y + 1, handler, callback);
+    pQuery->next = mActiveMultiPickingQueriesList;
+    mActiveMultiPickingQueriesList = pQuery;
+    return *pQuery;
+}
+
+View::PickingQuery& FView::pickRect(uint32_t const x, uint32_t const y,
+        uint32_t const width, uint32_t const height,
+        backend::CallbackHandler* handler,
+        View::MultiPickingQueryResultCallback callback) noexcept {
+    FMultiPickingQuery* pQuery = FMultiPickingQuery::get(true, {},
+            x, y, std::max(width, 1u), std::max(height, 1u), handler, callback);
+    pQuery->next = mActiveMultiPickingQueriesList;
+    mActiveMultiPickingQueriesList = pQuery;
+    return *pQuery;
+}
+
+View::PickingQueryResult FView::pickBoundingBoxes(uint32_t const x,
+        uint32_t const y) const noexcept {
+    PickingQueryResult result{};
+    filament::Viewport const& vp = mViewport;
+    if (!mScene || !mCullingCamera || vp.empty()) {
+        return result;
+    }
+
+    // un-project the ray through the center of the pixel, between the near and far planes
+    FCamera const& camera = *mCullingCamera;
+    mat4 const viewFromWorld = camera.getViewMatrix();
+    mat4 const worldFromClip = inverse(camera.getCullingProjectionMatrix() * viewFromWorld);
+    double2 const ndc = {
+            (double(x) + 0.5) / double(vp.width) * 2.0 - 1.0,
+            (double(y) + 0.5) / double(vp.height) * 2.0 - 1.0 };
+    double4 const n = worldFromClip * double4{ ndc, -1.0, 1.0 };
+    double4 const f = worldFromClip * double4{ ndc, 1.0, 1.0 };
+    double3 const origin = n.xyz / n.w;
+    double3 const direction = normalize(f.xyz / f.w - origin);
+
+    auto const [entity, distance] = mScene->intersectBoundingBoxes(
+            float3{ origin }, float3{ direction }, mVisibleLayers);
+    if (entity.isNull()) {
+        return result;
+    }
+
+    // use the same depth convention as pick()
+    double3 const hit = origin + direction * double(distance);
+    double4 const clip = camera.getProjectionMatrix() * viewFromWorld * double4{ hit, 1.0 };
+    double const z = clip.z / clip.w * 0.5 + 0.5;
+    result.renderable = entity;
+    result.depth = float(1.0 - z);
+    result.fragCoords = { float(x), float(y), float(z) };
+    return result;
+}
+
 void FView::setStereoscopicOptions(const StereoscopicOptions& options) noexcept {
     mStereoscopicOptions = options;
 }
@@ -1220,4 +1526,69 @@ math::float4 FView::getMaterialGlobal(uint32_t index) const {
     return mMaterialGlobals[index];
 }
 
+size_t FView::getContentKey() const noexcept {
+    // Structures are hashed as bytes, padding included. A padding byte that changes only
+    // produces a spurious difference, which costs a rendered frame, never a missed one.
+    size_t key = 0;
+    auto const combine = [&key](auto const& value) {
+        hash::combine(key, hash::murmurSlow(
+                reinterpret_cast<uint8_t const*>(&value), sizeof(value), 0));
+    };
+    auto const combineCamera = [&combine](FCamera const* camera) {
+        combine(camera);
+        if (camera) {
+            combine(camera->getProjectionMatrix());
+            combine(camera->getCullingProjectionMatrix());
+            combine(camera->getModelMatrix());
+            combine(float4{ camera->getAperture(), camera->getShutterSpeed(),
+                    camera->getSensitivity(), camera->getFocusDistance() });
+        }
+    };
+
+    combine(mScene);
+    if (mScene) {
+        FIndirectLight const* const ibl = mScene->getIndirectLight();
+        combine(ibl);
+        if (ibl) {
+            combine(ibl->getIntensity());
+            combine(ibl->getRotation());
+        }
+        combine(mScene->getSkybox());
+    }
+    combineCamera(mCullingCamera);
+    combineCamera(mViewingCamera);
+
+    combine(mViewport);
+    combine(mRenderTarget);
+    combine(mColorGrading);
+    combine(mVisibleLayers);
+    combine(mBlendMode);
+    combine(mAntiAliasing);
+    combine(mDithering);
+    combine(mShadowType);
+    combine(mShadingRate);
+    combine(std::array<bool, 11>{
+            mCulling, mOcclusionCulling, mOrderIndependentTransparency, mShadowDepthFitting,
+            mFrontFaceWindingInverted, mShadowingEnabled, mShadowMapCachingEnabled,
+            mScreenSpaceRefractionEnabled, mHasPostProcessPass, mStencilBufferEnabled,
+            hasPicking() });
+    combine(mMaterialGlobals);
+    combine(mAmbientOcclusionOptions);
+    combine(mVsmShadowOptions);
+    combine(mSoftShadowOptions);
+    combine(mBloomOptions);
+    combine(mFogOptions);
+    combine(mDepthOfFieldOptions);
+    combine(mVignetteOptions);
+    combine(mAutoExposureOptions);
+    combine(mTemporalAntiAliasingOptions);
+    combine(mMultiSampleAntiAliasingOptions);
+    combine(mScreenSpaceReflectionsOptions);
+    combine(mGuardBandOptions);
+    combine(mStereoscopicOptions);
+    combine(mDynamicResolution);
+    combine(mRenderQuality);
+    return key;
+}
+
 } // namespace filament
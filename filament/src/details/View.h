@@ -27,8 +27,10 @@
 #include "FrameHistory.h"
 #include "FrameInfo.h"
 #include "Froxelizer.h"
+#include "OcclusionCuller.h"
 #include "PerViewUniforms.h"
 #include "PIDController.h"
+#include "RenderPass.h"
 #include "ShadowMap.h"
 #include "ShadowMapManager.h"
 #include "TypedUniformBuffer.h"
@@ -46,13 +48,16 @@
 
 #include <utils/compiler.h>
 #include <utils/Allocator.h>
+#include <utils/FixedCapacityVector.h>
 #include <utils/StructureOfArrays.h>
 #include <utils/Range.h>
 #include <utils/Slice.h>
 
 #include <math/scalar.h>
 #include <math/mat4.h>
+#include <math/vec2.h>
 
+#include <algorithm>
 #include <array>
 #include <memory>
 
@@ -118,9 +123,34 @@ public:
     void setFrustumCullingEnabled(bool culling) noexcept { mCulling = culling; }
     bool isFrustumCullingEnabled() const noexcept { return mCulling; }
 
+    void setOcclusionCullingEnabled(bool enabled) noexcept;
+    bool isOcclusionCullingEnabled() const noexcept { return mOcclusionCulling; }
+    void setShadowDepthFittingEnabled(bool enabled) noexcept;
+    bool isShadowDepthFittingEnabled() const noexcept { return mShadowDepthFitting; }
+    // whether the depth buffer used by occlusion culling and shadow fitting is needed
+    bool needsOcclusionDepth() const noexcept { return mOcclusionCulling || mShadowDepthFitting; }
+    // distances to the nearest and farthest geometry in that depth buffer, 0 if unknown
+    math::float2 getVisibleDistanceRange(CameraInfo const& cameraInfo) const noexcept;
+    size_t getOcclusionCulledRenderableCount() const noexcept { return mOcclusionCulledCount; }
+    void setTransientMemorySize(size_t peak, size_t total) noexcept {
+        mPeakTransientMemorySize = peak;
+        mTotalTransientMemorySize = total;
+    }
+    size_t getPeakTransientMemorySize() const noexcept { return mPeakTransientMemorySize; }
+    size_t getTotalTransientMemorySize() const noexcept { return mTotalTransientMemorySize; }
+    void setOrderIndependentTransparencyEnabled(bool enabled) noexcept {
+        mOrderIndependentTransparency = enabled;
+    }
+    bool isOrderIndependentTransparencyEnabled() const noexcept {
+        return mOrderIndependentTransparency;
+    }
+
     void setFrontFaceWindingInverted(bool inverted) noexcept { mFrontFaceWindingInverted = inverted; }
     bool isFrontFaceWindingInverted() const noexcept { return mFrontFaceWindingInverted; }
 
+    void setShadingRate(ShadingRate rate) noexcept { mShadingRate = rate; }
+    ShadingRate getShadingRate() const noexcept { return mShadingRate; }
+
 
     void setVisibleLayers(uint8_t select, uint8_t values) noexcept;
     uint8_t getVisibleLayers() const noexcept {
@@ -172,7 +202,9 @@ public:
     bool hasVSM() const noexcept { return mShadowType == ShadowType::VSM; }
     bool hasDPCF() const noexcept { return mShadowType == ShadowType::DPCF; }
     bool hasPCSS() const noexcept { return mShadowType == ShadowType::PCSS; }
-    bool hasPicking() const noexcept { return mActivePickingQueriesList != nullptr; }
+    bool hasPicking() const noexcept {
+        return mActivePickingQueriesList != nullptr || mActiveMultiPickingQueriesList != nullptr;
+    }
     bool hasStereo() const noexcept {
         return mIsStereoSupported && mStereoscopicOptions.enabled;
     }
@@ -181,7 +213,9 @@ public:
             CameraInfo const& cameraInfo, math::float4 const& userTime,
             RenderPassBuilder const& passBuilder) noexcept;
 
-    void updatePrimitivesLod(
+    // selects the level of detail of the renderables in `visible` as seen from `camera` and
+    // sets their PRIMITIVES accordingly
+    static void updatePrimitivesLod(
             FEngine& engine, const CameraInfo& camera,
             FScene::RenderableSoa& renderableData, Range visible) noexcept;
 
@@ -189,6 +223,20 @@ public:
 
     bool isShadowingEnabled() const noexcept { return mShadowingEnabled; }
 
+    void setShadowMapCachingEnabled(bool enabled) noexcept { mShadowMapCachingEnabled = enabled; }
+
+    bool isShadowMapCachingEnabled() const noexcept { return mShadowMapCachingEnabled; }
+
+    void setShadowMapUpdateBudget(uint8_t count) noexcept { mShadowMapUpdateBudget = count; }
+
+    uint8_t getShadowMapUpdateBudget() const noexcept { return mShadowMapUpdateBudget; }
+
+    void setFarCascadeUpdateInterval(uint8_t frames) noexcept {
+        mFarCascadeUpdateInterval = std::max(uint8_t(1), frames);
+    }
+
+    uint8_t getFarCascadeUpdateInterval() const noexcept { return mFarCascadeUpdateInterval; }
+
     void setScreenSpaceRefractionEnabled(bool enabled) noexcept { mScreenSpaceRefractionEnabled = enabled; }
 
     bool isScreenSpaceRefractionEnabled() const noexcept { return mScreenSpaceRefractionEnabled; }
@@ -201,6 +249,11 @@ public:
 
     void setStereoscopicOptions(StereoscopicOptions const& options) noexcept;
 
+    void setCameraLateLatchCallback(CameraLateLatchCallback&& callback) noexcept {
+        mCameraLateLatchCallback = callback ?
+                std::make_shared<CameraLateLatchCallback>(std::move(callback)) : nullptr;
+    }
+
     utils::FixedCapacityVector<Camera const*> getDirectionalShadowCameras() const noexcept {
         if (!mShadowMapManager) return {};
         return mShadowMapManager->getDirectionalShadowCameras();
@@ -365,6 +418,12 @@ public:
         return mVignetteOptions;
     }
 
+    void setAutoExposureOptions(AutoExposureOptions options) noexcept;
+
+    AutoExposureOptions getAutoExposureOptions() const noexcept {
+        return mAutoExposureOptions;
+    }
+
     void setBlendMode(BlendMode blendMode) noexcept {
         mBlendMode = blendMode;
     }
@@ -406,7 +465,8 @@ public:
         }
     }
 
-    static void cullRenderables(utils::JobSystem& js, FScene::RenderableSoa& renderableData,
+    // uses the scene's culling hierarchy when it has one
+    static void cullRenderables(utils::JobSystem& js, FScene& scene,
             Frustum const& frustum, size_t bit) noexcept;
 
     PerViewUniforms const& getPerViewUniforms() const noexcept { return mPerViewUniforms; }
@@ -417,6 +477,11 @@ public:
     FrameHistory& getFrameHistory() noexcept { return mFrameHistory; }
     FrameHistory const& getFrameHistory() const noexcept { return mFrameHistory; }
 
+    // Returns the sort cache for the color pass, it retains the commands order across frames.
+    RenderPass::CommandSortCache& getColorPassSortCache() const noexcept {
+        return mColorPassSortCache;
+    }
+
     // Clean-up the oldest frame and save the current frame information.
     // This is typically called after all operations for this View's rendering are complete.
     // (e.g.: after the FrameGraph execution).
@@ -430,13 +495,36 @@ public:
     View::PickingQuery& pick(uint32_t x, uint32_t y, backend::CallbackHandler* handler,
             View::PickingQueryResultCallback callback) noexcept;
 
+    // create a batched picking query
+    View::PickingQuery& pick(math::uint2 const* coords, size_t count,
+            backend::CallbackHandler* handler,
+            View::MultiPickingQueryResultCallback callback) noexcept;
+
+    // create a rectangle selection query
+    View::PickingQuery& pickRect(uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+            backend::CallbackHandler* handler,
+            View::MultiPickingQueryResultCallback callback) noexcept;
+
+    View::PickingQueryResult pickBoundingBoxes(uint32_t x, uint32_t y) const noexcept;
+
+    // `width` and `height` are the dimensions of the picking target
     void executePickingQueries(backend::DriverApi& driver,
-            backend::RenderTargetHandle handle, math::float2 scale) noexcept;
+            backend::RenderTargetHandle handle, math::float2 scale,
+            uint32_t width, uint32_t height) noexcept;
+
+    // read back the last level of the Hi-Z pyramid, used for occlusion culling in later frames
+    void readbackOcclusionDepth(backend::DriverApi& driver, backend::RenderTargetHandle handle,
+            uint32_t width, uint32_t height, CameraInfo const& cameraInfo) noexcept;
 
     void setMaterialGlobal(uint32_t index, math::float4 const& value);
 
     math::float4 getMaterialGlobal(uint32_t index) const;
 
+    // Hash of the state of this view that affects its rendering but isn't tracked by the engine:
+    // options, cameras, scene environment, pending picking queries. FRenderer uses it to detect
+    // idle frames.
+    size_t getContentKey() const noexcept;
+
     utils::Entity getFogEntity() const noexcept {
         return mFogEntity;
     }
@@ -472,8 +560,53 @@ private:
         PickingQueryResult result;
     };
 
+    // A batched or rectangle picking query, resolved with a single readback.
+    struct FMultiPickingQuery : public PickingQuery {
+    private:
+        FMultiPickingQuery(bool rect, utils::FixedCapacityVector<math::uint2> coords,
+                uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                backend::CallbackHandler* handler,
+                View::MultiPickingQueryResultCallback callback) noexcept
+                : PickingQuery{}, rect(rect), coords(std::move(coords)),
+                  x(x), y(y), width(width), height(height),
+                  handler(handler), callback(callback) {}
+        ~FMultiPickingQuery() noexcept = default;
+    public:
+        static FMultiPickingQuery* get(bool rect, utils::FixedCapacityVector<math::uint2> coords,
+                uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                backend::CallbackHandler* handler,
+                View::MultiPickingQueryResultCallback callback) noexcept {
+            return new FMultiPickingQuery(rect, std::move(coords), x, y, width, height,
+                    handler, callback);
+        }
+        static void put(FMultiPickingQuery* pQuery) noexcept {
+            delete pQuery;
+        }
+        mutable FMultiPickingQuery* next = nullptr;
+        // true for a rectangle selection, false for a batch of coordinates
+        bool const rect;
+        utils::FixedCapacityVector<math::uint2> const coords;
+        // queried rectangle, the bounding rectangle of `coords` if there are any
+        uint32_t const x;
+        uint32_t const y;
+        uint32_t const width;
+        uint32_t const height;
+        backend::CallbackHandler* const handler;
+        View::MultiPickingQueryResultCallback const callback;
+        // area of the picking target that is read back, set by executePickingQueries()
+        math::float2 scale{};
+        uint32_t readX = 0;
+        uint32_t readY = 0;
+        uint32_t readWidth = 0;
+        uint32_t readHeight = 0;
+        bool fl0 = false;
+    };
+
+    static View::PickingQueryResult decodePickingPixel(void const* pixel, bool fl0) noexcept;
+    static void resolveMultiPickingQuery(FMultiPickingQuery* pQuery, void const* pixels) noexcept;
+
     void prepareVisibleRenderables(utils::JobSystem& js,
-            Frustum const& frustum, FScene::RenderableSoa& renderableData) const noexcept;
+            Frustum const& frustum, FScene& scene) const noexcept;
 
     static void prepareVisibleLights(FLightManager const& lcm,
             utils::Slice<float> scratch,
@@ -489,12 +622,22 @@ private:
             Culler::result_type* visibleMask,
             size_t count);
 
+    // Visibility groups of the renderable SoA, in the order partitionVisibility() sorts them.
+    enum VisibilityGroup : uint8_t {
+        VISIBLE_ONLY,               // visible (main camera) renderables
+        VISIBLE_AND_DIR_CASTER,     // visible renderables and directional shadow casters
+        DIR_CASTER_ONLY,            // directional shadow casters only
+        DYN_CASTER_ONLY,            // potential punctual light shadow casters only
+        INVISIBLE,                  // definitely invisible renderables
+        VISIBILITY_GROUP_COUNT
+    };
+
+    // Reorders the SoA by VisibilityGroup and returns the end of each group. This is done in
+    // a single pass, which moves each renderable at most once.
     // we don't inline this one, because the function is quite large and there is not much to
     // gain from inlining.
-    static FScene::RenderableSoa::iterator partition(
-            FScene::RenderableSoa::iterator begin,
-            FScene::RenderableSoa::iterator end,
-            Culler::result_type mask, Culler::result_type value) noexcept;
+    static std::array<uint32_t, VISIBILITY_GROUP_COUNT> partitionVisibility(
+            FScene::RenderableSoa& renderableData) noexcept;
 
     // these are accessed in the render loop, keep together
     backend::Handle<backend::HwBufferObject> mLightUbh;
@@ -511,7 +654,15 @@ private:
 
     Viewport mViewport;
     bool mCulling = true;
+    bool mOcclusionCulling = false;
+    bool mOrderIndependentTransparency = false;
+    bool mShadowDepthFitting = false;
     bool mFrontFaceWindingInverted = false;
+    ShadingRate mShadingRate = ShadingRate::RATE_1x1;
+    uint32_t mOcclusionCulledCount = 0;
+    OcclusionCuller mOcclusionCuller;
+    size_t mPeakTransientMemorySize = 0;
+    size_t mTotalTransientMemorySize = 0;
 
     FRenderTarget* mRenderTarget = nullptr;
 
@@ -519,6 +670,9 @@ private:
     AntiAliasing mAntiAliasing = AntiAliasing::FXAA;
     Dithering mDithering = Dithering::TEMPORAL;
     bool mShadowingEnabled = true;
+    bool mShadowMapCachingEnabled = false;
+    uint8_t mShadowMapUpdateBudget = 0;
+    uint8_t mFarCascadeUpdateInterval = 1;
     bool mScreenSpaceRefractionEnabled = true;
     bool mHasPostProcessPass = true;
     bool mStencilBufferEnabled = false;
@@ -530,6 +684,7 @@ private:
     FogOptions mFogOptions;
     DepthOfFieldOptions mDepthOfFieldOptions;
     VignetteOptions mVignetteOptions;
+    AutoExposureOptions mAutoExposureOptions;
     TemporalAntiAliasingOptions mTemporalAntiAliasingOptions;
     MultiSampleAntiAliasingOptions mMultiSampleAntiAliasingOptions;
     ScreenSpaceReflectionsOptions mScreenSpaceReflectionsOptions;
@@ -549,10 +704,15 @@ private:
     RenderQuality mRenderQuality;
 
     mutable PerViewUniforms mPerViewUniforms;
+    // shared with the commands in flight, which are executed on the backend thread
+    std::shared_ptr<CameraLateLatchCallback> mCameraLateLatchCallback;
 
     mutable FrameHistory mFrameHistory{};
 
+    mutable RenderPass::CommandSortCache mColorPassSortCache;
+
     FPickingQuery* mActivePickingQueriesList = nullptr;
+    FMultiPickingQuery* mActiveMultiPickingQueriesList = nullptr;
 
     utils::CString mName;
 
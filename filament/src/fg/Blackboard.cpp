@@ -20,7 +20,8 @@
 
 namespace filament {
 
-Blackboard::Blackboard() noexcept = default;
+Blackboard::Blackboard(LinearAllocatorArena& arena) noexcept : mMap(arena) {
+}
 
 Blackboard::~Blackboard() noexcept = default;
 
@@ -22,10 +22,12 @@
 
 namespace filament {
 
-DependencyGraph::DependencyGraph() noexcept {
-    // Some reasonable defaults size for our vectors
-    mNodes.reserve(8);
-    mEdges.reserve(16);
+DependencyGraph::DependencyGraph(LinearAllocatorArena& arena) noexcept
+        : mArena(arena), mNodes(arena), mEdges(arena) {
+    // Growing a vector wastes the old storage in a linear arena, so start with sizes that
+    // accommodate a typical frame.
+    mNodes.reserve(256);
+    mEdges.reserve(512);
 }
 
 DependencyGraph::~DependencyGraph() noexcept = default;
@@ -38,12 +40,7 @@ void DependencyGraph::registerNode(Node* node, NodeID id) noexcept {
     // Node* is not fully constructed here
     assert_invariant(id == mNodes.size());
 
-    // here we manually grow the fixed-size vector
-    NodeContainer& nodes = mNodes;
-    if (UTILS_UNLIKELY(nodes.capacity() == nodes.size())) {
-        nodes.reserve(nodes.capacity() * 2);
-    }
-    nodes.push_back(node);
+    mNodes.push_back(node);
 }
 
 bool DependencyGraph::isEdgeValid(DependencyGraph::Edge const* edge) const noexcept {
@@ -54,12 +51,7 @@ bool DependencyGraph::isEdgeValid(DependencyGraph::Edge const* edge) const noexc
 }
 
 void DependencyGraph::link(DependencyGraph::Edge* edge) noexcept {
-    // here we manually grow the fixed-size vector
-    EdgeContainer& edges = mEdges;
-    if (UTILS_UNLIKELY(edges.capacity() == edges.size())) {
-        edges.reserve(edges.capacity() * 2);
-    }
-    edges.push_back(edge);
+    mEdges.push_back(edge);
 }
 
 DependencyGraph::EdgeContainer const& DependencyGraph::getEdges() const noexcept {
@@ -73,8 +65,7 @@ DependencyGraph::NodeContainer const& DependencyGraph::getNodes() const noexcept
 
 DependencyGraph::EdgeContainer DependencyGraph::getIncomingEdges(
         DependencyGraph::Node const* node) const noexcept {
-    // TODO: we might need something more efficient
-    auto result = EdgeContainer::with_capacity(mEdges.size());
+    EdgeContainer result(mArena);
     NodeID const nodeId = node->getId();
     std::copy_if(mEdges.begin(), mEdges.end(),
             std::back_insert_iterator<EdgeContainer>(result),
@@ -84,8 +75,7 @@ DependencyGraph::EdgeContainer DependencyGraph::getIncomingEdges(
 
 DependencyGraph::EdgeContainer DependencyGraph::getOutgoingEdges(
         DependencyGraph::Node const* node) const noexcept {
-    // TODO: we might need something more efficient
-    auto result = EdgeContainer::with_capacity(mEdges.size());
+    EdgeContainer result(mArena);
     NodeID const nodeId = node->getId();
     std::copy_if(mEdges.begin(), mEdges.end(),
             std::back_insert_iterator<EdgeContainer>(result),
@@ -115,7 +105,8 @@ void DependencyGraph::cull() noexcept {
     }
 
     // cull nodes with a 0 reference count
-    auto stack = NodeContainer::with_capacity(nodes.size());
+    NodeContainer stack(mArena);
+    stack.reserve(nodes.size());
     for (Node* const pNode : nodes) {
         if (pNode->getRefCount() == 0) {
             stack.push_back(pNode);
@@ -124,13 +115,25 @@ void DependencyGraph::cull() noexcept {
     while (!stack.empty()) {
         Node* const pNode = stack.back();
         stack.pop_back();
-        EdgeContainer const& incoming = getIncomingEdges(pNode);
-        for (Edge* edge : incoming) {
+        forEachIncomingEdge(pNode, [this, &stack](Edge const* edge) {
             Node* pLinkedNode = getNode(edge->from);
             if (--pLinkedNode->mRefCount == 0) {
                 stack.push_back(pLinkedNode);
             }
-        }
+            return false;
+        });
+    }
+}
+
+void DependencyGraph::getCullState(uint32_t* refCounts) const noexcept {
+    for (Node const* const pNode : mNodes) {
+        *refCounts++ = pNode->mRefCount;
+    }
+}
+
+void DependencyGraph::setCullState(uint32_t const* refCounts) noexcept {
+    for (Node* const pNode : mNodes) {
+        pNode->mRefCount = *refCounts++;
     }
 }
 
@@ -194,7 +197,7 @@ void DependencyGraph::export_graphviz(utils::io::ostream& out, char const* name)
 bool DependencyGraph::isAcyclic() const noexcept {
 #ifndef NDEBUG
     // We work on a copy of the graph
-    DependencyGraph graph;
+    DependencyGraph graph(mArena);
     graph.mEdges = mEdges;
     graph.mNodes = mNodes;
     return DependencyGraph::isAcyclicInternal(graph);
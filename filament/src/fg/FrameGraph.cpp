@@ -33,6 +33,7 @@
 
 #include <utils/compiler.h>
 #include <utils/debug.h>
+#include <utils/Hash.h>
 #include <utils/ostream.h>
 #include <utils/Panic.h>
 #include <utils/Systrace.h>
@@ -75,8 +76,24 @@ FrameGraphId<FrameGraphTexture> FrameGraph::Builder::declareRenderPass(
 // ------------------------------------------------------------------------------------------------
 
 FrameGraph::FrameGraph(ResourceAllocatorInterface& resourceAllocator, Mode mode)
+        : FrameGraph(resourceAllocator,
+                std::make_unique<LinearAllocatorArena>("FrameGraph Arena", 262144), nullptr, mode) {
+}
+
+FrameGraph::FrameGraph(ResourceAllocatorInterface& resourceAllocator,
+        LinearAllocatorArena& arena, Mode mode)
+        : FrameGraph(resourceAllocator, nullptr, &arena, mode) {
+}
+
+FrameGraph::FrameGraph(ResourceAllocatorInterface& resourceAllocator,
+        std::unique_ptr<LinearAllocatorArena> ownedArena, LinearAllocatorArena* arena, Mode mode)
         : mResourceAllocator(resourceAllocator),
-          mArena("FrameGraph Arena", 262144),
+          mOwnedArena(std::move(ownedArena)),
+          mArena(arena ? *arena : *mOwnedArena),
+          mArenaBegin(mArena.getCurrent()),
+          mArenaScope(mArena),
+          mBlackboard(mArena),
+          mGraph(mArena),
           mMode(mode),
           mResourceSlots(mArena),
           mResources(mArena),
@@ -116,14 +133,85 @@ void FrameGraph::reset() noexcept {
     mResourceSlots.clear();
 }
 
+FrameGraph::CompileCache::CompileCache() noexcept = default;
+
+FrameGraph::CompileCache::~CompileCache() noexcept = default;
+
+FrameGraph::CompileCache::Entry* FrameGraph::CompileCache::find(
+        size_t hash, uint32_t nodeCount, uint32_t edgeCount) noexcept {
+    mTime++;
+    for (Entry& entry : mEntries) {
+        if (entry.lastUsed && entry.hash == hash &&
+                entry.nodeCount == nodeCount && entry.edgeCount == edgeCount) {
+            entry.lastUsed = mTime;
+            mHitCount++;
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+FrameGraph::CompileCache::Entry& FrameGraph::CompileCache::acquire(
+        size_t hash, uint32_t nodeCount, uint32_t edgeCount) noexcept {
+    // evict the least recently used entry, its vectors keep their capacity
+    Entry& entry = *std::min_element(mEntries.begin(), mEntries.end(),
+            [](Entry const& lhs, Entry const& rhs) { return lhs.lastUsed < rhs.lastUsed; });
+    entry.hash = hash;
+    entry.lastUsed = mTime;
+    entry.nodeCount = nodeCount;
+    entry.edgeCount = edgeCount;
+    return entry;
+}
+
 FrameGraph& FrameGraph::compile() noexcept {
+    return compileInternal(nullptr);
+}
+
+FrameGraph& FrameGraph::compile(CompileCache& cache) noexcept {
+    return compileInternal(&cache);
+}
+
+size_t FrameGraph::computeStructureHash() const noexcept {
+    // Everything compile() derives the culling and the lifetimes from: the nodes (and whether
+    // they're targets), which resource each resource node refers to, and the edges.
+    size_t hash = mResources.size();
+    for (DependencyGraph::Node const* const pNode : mGraph.getNodes()) {
+        utils::hash::combine(hash, pNode->isTarget());
+    }
+    for (PassNode const* const pPassNode : mPassNodes) {
+        utils::hash::combine(hash, pPassNode->getId());
+    }
+    for (ResourceNode* const pResourceNode : mResourceNodes) {
+        utils::hash::combine(hash, pResourceNode->getId());
+        utils::hash::combine(hash, pResourceNode->resourceHandle.index);
+        utils::hash::combine(hash, pResourceNode->getParentHandle().index);
+    }
+    for (DependencyGraph::Edge const* const pEdge : mGraph.getEdges()) {
+        utils::hash::combine(hash, pEdge->from);
+        utils::hash::combine(hash, pEdge->to);
+    }
+    return hash;
+}
+
+FrameGraph& FrameGraph::compileInternal(CompileCache* const cache) noexcept {
 
     SYSTRACE_CALL();
 
     DependencyGraph& dependencyGraph = mGraph;
 
-    // first we cull unreachable nodes
-    dependencyGraph.cull();
+    uint32_t const nodeCount = dependencyGraph.getNodes().size();
+    uint32_t const edgeCount = dependencyGraph.getEdges().size();
+    size_t const hash = cache ? computeStructureHash() : 0;
+    CompileCache::Entry const* const entry = cache ?
+            cache->find(hash, nodeCount, edgeCount) : nullptr;
+
+    if (entry) {
+        // same structure as a previous FrameGraph, restore its culling...
+        dependencyGraph.setCullState(entry->refCounts.data());
+    } else {
+        // first we cull unreachable nodes
+        dependencyGraph.cull();
+    }
 
     /*
      * update the reference counter of the resource themselves and
@@ -137,32 +225,77 @@ FrameGraph& FrameGraph::compile() noexcept {
 
     auto first = mPassNodes.begin();
     const auto activePassNodesEnd = mActivePassNodesEnd;
+
+    if (entry) {
+        // ...and the resource lifetimes
+        for (size_t i = 0, c = mResources.size(); i < c; i++) {
+            VirtualResource* const resource = mResources[i];
+            CompileCache::Lifetime const& lifetime = entry->lifetimes[i];
+            resource->refcount = lifetime.refcount;
+            resource->first = lifetime.first == CompileCache::NONE ? nullptr :
+                    static_cast<PassNode*>(dependencyGraph.getNode(lifetime.first));
+            resource->last = lifetime.last == CompileCache::NONE ? nullptr :
+                    static_cast<PassNode*>(dependencyGraph.getNode(lifetime.last));
+        }
+        FrameGraphHandle::Index const* declaredHandles = entry->declaredHandles.data();
+        while (first != activePassNodesEnd) {
+            PassNode* const passNode = *first;
+            first++;
+            size_t const count = *declaredHandles++;
+            passNode->mDeclaredHandles.insert(declaredHandles, declaredHandles + count);
+            declaredHandles += count;
+            passNode->resolve();
+        }
+    }
+
     while (first != activePassNodesEnd) {
         PassNode* const passNode = *first;
         first++;
         assert_invariant(!passNode->isCulled());
 
 
-        auto const& reads = dependencyGraph.getIncomingEdges(passNode);
-        for (auto const& edge : reads) {
+        dependencyGraph.forEachIncomingEdge(passNode,
+                [&dependencyGraph, passNode](DependencyGraph::Edge const* edge) {
             // all incoming edges should be valid by construction
             assert_invariant(dependencyGraph.isEdgeValid(edge));
             auto pNode = static_cast<ResourceNode*>(dependencyGraph.getNode(edge->from));
             passNode->registerResource(pNode->resourceHandle);
-        }
+            return false;
+        });
 
-        auto const& writes = dependencyGraph.getOutgoingEdges(passNode);
-        for (auto const& edge : writes) {
+        dependencyGraph.forEachOutgoingEdge(passNode,
+                [&dependencyGraph, passNode](DependencyGraph::Edge const* edge) {
             // An outgoing edge might be invalid if the node it points to has been culled
             // but because we are not culled, and we're a pass we add a reference to
             // the resource we are writing to.
             auto pNode = static_cast<ResourceNode*>(dependencyGraph.getNode(edge->to));
             passNode->registerResource(pNode->resourceHandle);
-        }
+            return false;
+        });
 
         passNode->resolve();
     }
 
+    if (cache && !entry) {
+        // remember what we just computed for the next FrameGraph with the same structure
+        CompileCache::Entry& e = cache->acquire(hash, nodeCount, edgeCount);
+        e.refCounts.resize(nodeCount);
+        dependencyGraph.getCullState(e.refCounts.data());
+        e.lifetimes.clear();
+        for (VirtualResource const* const resource : mResources) {
+            e.lifetimes.push_back({ resource->refcount,
+                    resource->first ? resource->first->getId() : CompileCache::NONE,
+                    resource->last ? resource->last->getId() : CompileCache::NONE });
+        }
+        e.declaredHandles.clear();
+        for (auto it = mPassNodes.begin(); it != activePassNodesEnd; ++it) {
+            auto const& declaredHandles = (*it)->mDeclaredHandles;
+            e.declaredHandles.push_back(FrameGraphHandle::Index(declaredHandles.size()));
+            e.declaredHandles.insert(e.declaredHandles.end(),
+                    declaredHandles.begin(), declaredHandles.end());
+        }
+    }
+
     // add resource to de-virtualize or destroy to the corresponding list for each active pass
     for (auto* pResource : mResources) {
         VirtualResource* resource = pResource;
@@ -179,6 +312,26 @@ FrameGraph& FrameGraph::compile() noexcept {
         }
     }
 
+    /*
+     * Compute the transient memory needed by the active passes, assuming that the memory of a
+     * resource can be reused as soon as the last pass using it has executed.
+     */
+    TransientMemoryStats stats;
+    size_t live = 0;
+    for (auto it = mPassNodes.begin(); it != activePassNodesEnd; ++it) {
+        PassNode const* const passNode = *it;
+        for (VirtualResource const* resource : passNode->devirtualize) {
+            size_t const size = resource->getMemorySize();
+            live += size;
+            stats.total += size;
+        }
+        stats.peak = std::max(stats.peak, live);
+        for (VirtualResource const* resource : passNode->destroy) {
+            live -= resource->getMemorySize();
+        }
+    }
+    mTransientMemoryStats = stats;
+
     /*
      * Resolve Usage bits
      */
@@ -190,10 +343,18 @@ FrameGraph& FrameGraph::compile() noexcept {
         pNode->resolveResourceUsage(dependencyGraph);
     }
 
+    /*
+     * Attachments whose content doesn't outlive their render pass don't need memory backing
+     * on tiled GPUs
+     */
+    for (auto it = mPassNodes.begin(); it != activePassNodesEnd; ++it) {
+        (*it)->resolveMemorylessAttachments();
+    }
+
     return *this;
 }
 
-void FrameGraph::execute(backend::DriverApi& driver) noexcept {
+void FrameGraph::execute(backend::DriverApi& driver, PassListener* const listener) noexcept {
 
     bool const useProtectedMemory = mMode == Mode::PROTECTED;
     auto const& passNodes = mPassNodes;
@@ -219,8 +380,14 @@ void FrameGraph::execute(backend::DriverApi& driver) noexcept {
         }
 
         // call execute
+        if (UTILS_UNLIKELY(listener)) {
+            listener->onBeginPass(driver, node->getName());
+        }
         FrameGraphResources const resources(*this, *node);
         node->execute(resources, driver);
+        if (UTILS_UNLIKELY(listener)) {
+            listener->onEndPass(driver);
+        }
 
         // destroy concrete resources
         for (VirtualResource* resource : node->destroy) {
@@ -479,6 +646,65 @@ void FrameGraph::export_graphviz(utils::io::ostream& out, char const* name) {
     mGraph.export_graphviz(out, name);
 }
 
+FrameGraph::TileMemoryReport FrameGraph::getTileMemoryReport() const noexcept {
+    // Only textures are used as attachments or subpass inputs, and a texture's edges are always
+    // of this type.
+    using TextureResource = Resource<FrameGraphTexture>;
+    using TextureEdge = TextureResource::ResourceEdge;
+    using Usage = FrameGraphTexture::Usage;
+
+    TileMemoryReport report;
+    auto const first = mPassNodes.begin();
+    auto const last = mActivePassNodesEnd;
+    for (ResourceNode const* node : mResourceNodes) {
+        auto const* texture = static_cast<TextureResource const*>(getResource(node->resourceHandle));
+        size_t const size = FrameGraphTexture::getMemorySize(texture->descriptor);
+
+        size_t readerCount = 0;
+        PassNode const* sampledBy = nullptr;
+        PassNode const* writtenBy = nullptr;
+        for (auto it = first; it != last; ++it) {
+            auto const* reader = static_cast<TextureEdge const*>(node->getReaderEdgeForPass(*it));
+            if (reader) {
+                readerCount++;
+                if (any(reader->usage & Usage::SUBPASS_INPUT)) {
+                    report.subpassBandwidth += 2 * size;
+                } else if (any(reader->usage & Usage::SAMPLEABLE) &&
+                        it != first && *(it - 1) == writtenBy) {
+                    sampledBy = *it;
+                }
+            }
+            auto const* writer = static_cast<TextureEdge const*>(node->getWriterEdgeForPass(*it));
+            if (writer && any(writer->usage & Usage::COLOR_ATTACHMENT)) {
+                writtenBy = *it;
+            }
+        }
+
+        if (sampledBy && texture->descriptor.levels == 1 && texture->descriptor.depth == 1) {
+            // the store can only be avoided if nobody else needs the attachment
+            bool const transient = readerCount == 1 && !texture->isImported();
+            size_t const bandwidth = transient ? 2 * size : size;
+            report.candidates.push_back({
+                    writtenBy->getName(), sampledBy->getName(), texture->name, bandwidth });
+            report.candidatesBandwidth += bandwidth;
+        }
+    }
+    return report;
+}
+
+void FrameGraph::export_tileMemoryReport(utils::io::ostream& out) const noexcept {
+    TileMemoryReport const report = getTileMemoryReport();
+    out << "FrameGraph tile memory report" << utils::io::endl;
+    out << "  saved by subpasses: " << report.subpassBandwidth / 1024 << " KiB" << utils::io::endl;
+    out << "  saved by merging candidates: "
+        << report.candidatesBandwidth / 1024 << " KiB" << utils::io::endl;
+    for (auto const& candidate : report.candidates) {
+        out << "    " << candidate.producer << " -> " << candidate.consumer
+            << " (" << candidate.resource << "): "
+            << candidate.bandwidth / 1024 << " KiB" << utils::io::endl;
+    }
+}
+
 // ------------------------------------------------------------------------------------------------
 
 /*
@@ -34,7 +34,10 @@
 #include <backend/DriverEnums.h>
 #include <backend/Handle.h>
 
+#include <array>
 #include <functional>
+#include <memory>
+#include <vector>
 
 namespace filament {
 
@@ -225,6 +228,14 @@ public:
 
     explicit FrameGraph(ResourceAllocatorInterface& resourceAllocator,
             Mode mode = Mode::UNPROTECTED);
+
+    /**
+     * Creates a FrameGraph that allocates all of its nodes, passes and bookkeeping from arena.
+     * Everything allocated is released when the FrameGraph is destroyed, so arena can be kept
+     * across frames to avoid allocating a new one each time.
+     */
+    FrameGraph(ResourceAllocatorInterface& resourceAllocator, LinearAllocatorArena& arena,
+            Mode mode = Mode::UNPROTECTED);
     FrameGraph(FrameGraph const&) = delete;
     FrameGraph& operator=(FrameGraph const&) = delete;
     ~FrameGraph() noexcept;
@@ -285,18 +296,100 @@ public:
     template<typename Execute>
     void addTrivialSideEffectPass(const char* name, Execute&& execute);
 
+    /**
+     * Remembers the outcome of compile() for a few graph structures, so that a FrameGraph
+     * declaring the same passes, resources and accesses as a previous one can skip culling and
+     * the computation of resource lifetimes. Descriptors are not part of the structure, the
+     * concrete resources are still resolved and created each frame.
+     */
+    class CompileCache {
+    public:
+        CompileCache() noexcept;
+        ~CompileCache() noexcept;
+        CompileCache(CompileCache const&) = delete;
+        CompileCache& operator=(CompileCache const&) = delete;
+
+        //! number of compile() calls that could reuse a cached schedule
+        size_t getHitCount() const noexcept { return mHitCount; }
+
+    private:
+        friend class FrameGraph;
+        static constexpr size_t ENTRY_COUNT = 4;
+        static constexpr DependencyGraph::NodeID NONE = ~DependencyGraph::NodeID(0);
+
+        struct Lifetime {
+            uint32_t refcount;
+            DependencyGraph::NodeID first;
+            DependencyGraph::NodeID last;
+        };
+
+        struct Entry {
+            size_t hash = 0;
+            uint32_t lastUsed = 0;
+            uint32_t nodeCount = 0;
+            uint32_t edgeCount = 0;
+            std::vector<uint32_t> refCounts;            // indexed by NodeID
+            std::vector<Lifetime> lifetimes;            // indexed like FrameGraph::mResources
+            std::vector<FrameGraphHandle::Index> declaredHandles; // count + indices, per pass
+        };
+
+        Entry* find(size_t hash, uint32_t nodeCount, uint32_t edgeCount) noexcept;
+        Entry& acquire(size_t hash, uint32_t nodeCount, uint32_t edgeCount) noexcept;
+
+        std::array<Entry, ENTRY_COUNT> mEntries;
+        uint32_t mTime = 0;
+        size_t mHitCount = 0;
+    };
+
     /**
      * Allocates concrete resources and culls unreferenced passes.
      * @return a reference to the FrameGraph, for chaining calls.
      */
     FrameGraph& compile() noexcept;
 
+    /**
+     * Same as compile(), but reuses the culling and resource lifetimes computed by a previous
+     * FrameGraph with the same structure, if cache has them.
+     * @return a reference to the FrameGraph, for chaining calls.
+     */
+    FrameGraph& compile(CompileCache& cache) noexcept;
+
+    /**
+     * Interface notified around the execution of each pass, e.g. to time them
+     */
+    class PassListener {
+    public:
+        virtual void onBeginPass(backend::DriverApi& driver, const char* name) noexcept = 0;
+        virtual void onEndPass(backend::DriverApi& driver) noexcept = 0;
+    protected:
+        virtual ~PassListener() noexcept = default;
+    };
+
     /**
      * Execute all referenced passes
      *
      * @param driver a reference to the backend to execute the commands
+     * @param listener optional listener notified before and after each pass executes
      */
-    void execute(backend::DriverApi& driver) noexcept;
+    void execute(backend::DriverApi& driver, PassListener* listener = nullptr) noexcept;
+
+    /**
+     * Estimated memory used by the transient (i.e. not imported) textures of this FrameGraph,
+     * valid after compile().
+     */
+    struct TransientMemoryStats {
+        size_t peak = 0;    // largest size of the transient textures alive at the same time
+        size_t total = 0;   // size of all transient textures, i.e. without any reuse of memory
+    };
+
+    TransientMemoryStats const& getTransientMemoryStats() const noexcept {
+        return mTransientMemoryStats;
+    }
+
+    // number of bytes allocated from the arena by this FrameGraph so far
+    size_t getArenaUsage() const noexcept {
+        return uintptr_t(mArena.getCurrent()) - uintptr_t(mArenaBegin);
+    }
 
     /**
      * Forwards a resource to another one which gets replaced.
@@ -434,6 +527,32 @@ public:
     //! export a graphviz view of the graph
     void export_graphviz(utils::io::ostream& out, const char* name = nullptr);
 
+    /**
+     * Main memory traffic of the render passes' attachments on tiled GPUs.
+     *
+     * A candidate is a color attachment that the render pass executed right after samples. It's
+     * stored to main memory and then loaded back, which merging both passes would avoid, the
+     * second one reading the attachment as a subpass input. This is only possible if the second
+     * pass reads at the current pixel only, which the FrameGraph can't verify.
+     */
+    struct TileMemoryReport {
+        struct Candidate {
+            const char* producer;
+            const char* consumer;
+            const char* resource;
+            size_t bandwidth;           // bytes that wouldn't be stored and loaded every frame
+        };
+        std::vector<Candidate> candidates;
+        size_t candidatesBandwidth = 0; // sum of the candidates' bandwidth
+        size_t subpassBandwidth = 0;    // bytes already saved by passes using subpass inputs
+    };
+
+    //! computes the TileMemoryReport of the active passes, must be called after compile()
+    TileMemoryReport getTileMemoryReport() const noexcept;
+
+    //! writes the TileMemoryReport in a human-readable form
+    void export_tileMemoryReport(utils::io::ostream& out) const noexcept;
+
 private:
     friend class FrameGraphResources;
     friend class PassNode;
@@ -441,6 +560,7 @@ private:
     friend class RenderPassNode;
 
     LinearAllocatorArena& getArena() noexcept { return mArena; }
+
     DependencyGraph& getGraph() noexcept { return mGraph; }
     ResourceAllocatorInterface& getResourceAllocator() noexcept { return mResourceAllocator; }
 
@@ -517,11 +637,22 @@ private:
         return const_cast<FrameGraph*>(this)->getActiveResourceNode(handle);
     }
 
+    FrameGraph(ResourceAllocatorInterface& resourceAllocator,
+            std::unique_ptr<LinearAllocatorArena> ownedArena, LinearAllocatorArena* arena,
+            Mode mode);
+
     void destroyInternal() noexcept;
 
-    Blackboard mBlackboard;
+    FrameGraph& compileInternal(CompileCache* cache) noexcept;
+    size_t computeStructureHash() const noexcept;
+
     ResourceAllocatorInterface& mResourceAllocator;
-    LinearAllocatorArena mArena;
+    std::unique_ptr<LinearAllocatorArena> mOwnedArena;
+    LinearAllocatorArena& mArena;
+    void* const mArenaBegin;
+    // rewinds the arena once all the members below have been destroyed
+    RootArenaScope mArenaScope;
+    Blackboard mBlackboard;
     DependencyGraph mGraph;
     const Mode mMode;
 
@@ -530,6 +661,7 @@ private:
     Vector<ResourceNode*> mResourceNodes;
     Vector<PassNode*> mPassNodes;
     Vector<PassNode*>::iterator mActivePassNodesEnd;
+    TransientMemoryStats mTransientMemoryStats;
 };
 
 template<typename Data, typename Setup, typename Execute>
@@ -18,6 +18,8 @@
 
 #include "ResourceAllocator.h"
 
+#include "details/Texture.h"
+
 #include <algorithm>
 
 namespace filament {
@@ -56,4 +58,15 @@ FrameGraphTexture::Descriptor FrameGraphTexture::generateSubResourceDescriptor(
     return descriptor;
 }
 
+size_t FrameGraphTexture::getMemorySize(Descriptor const& descriptor) noexcept {
+    size_t const pixelCount = size_t(descriptor.width) * descriptor.height * descriptor.depth;
+    size_t size = pixelCount * FTexture::getFormatSize(descriptor.format);
+    size *= std::max(uint8_t(1), descriptor.samples);
+    if (descriptor.levels > 1) {
+        // assume the full pyramid
+        size += size / 3;
+    }
+    return size;
+}
+
 } // namespace filament
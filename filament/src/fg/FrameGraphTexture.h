@@ -22,6 +22,8 @@
 #include <backend/DriverEnums.h>
 #include <backend/Handle.h>
 
+#include <stddef.h>
+
 namespace filament {
 class ResourceAllocatorInterface;
 } // namespace::filament
@@ -37,6 +39,7 @@ namespace filament {
  *      void create(ResourceAllocatorInterface&, const char* name, Descriptor const&, Usage,
  *              bool useProtectedMemory) noexcept;
  *      void destroy(ResourceAllocatorInterface&) noexcept;
+ *      static size_t getMemorySize(Descriptor const&) noexcept;
  */
 struct FrameGraphTexture {
     backend::Handle<backend::HwTexture> handle;
@@ -96,6 +99,13 @@ struct FrameGraphTexture {
      */
     static Descriptor generateSubResourceDescriptor(Descriptor descriptor,
             SubResourceDescriptor const& srd) noexcept;
+
+    /**
+     * Estimates the memory needed by a resource
+     * @param descriptor Descriptor to the resource
+     * @return           an estimate of the size of the resource in bytes
+     */
+    static size_t getMemorySize(Descriptor const& descriptor) noexcept;
 };
 
 } // namespace filament
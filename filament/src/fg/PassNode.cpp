@@ -23,6 +23,8 @@
 
 #include <details/Texture.h>
 
+#include <algorithm>
+#include <iterator>
 #include <string>
 
 using namespace filament::backend;
@@ -32,6 +34,7 @@ namespace filament {
 PassNode::PassNode(FrameGraph& fg) noexcept
         : DependencyGraph::Node(fg.getGraph()),
           mFrameGraph(fg),
+          mDeclaredHandles(fg.getArena()),
           devirtualize(fg.getArena()),
           destroy(fg.getArena()) {
 }
@@ -53,7 +56,8 @@ void PassNode::registerResource(FrameGraphHandle resourceHandle) noexcept {
 // ------------------------------------------------------------------------------------------------
 
 RenderPassNode::RenderPassNode(FrameGraph& fg, const char* name, FrameGraphPassBase* base) noexcept
-        : PassNode(fg), mName(name), mPassBase(base, fg.getArena()) {
+        : PassNode(fg), mName(name), mPassBase(base, fg.getArena()),
+          mRenderTargetData(fg.getArena()) {
 }
 RenderPassNode::RenderPassNode(RenderPassNode&& rhs) noexcept = default;
 RenderPassNode::~RenderPassNode() noexcept = default;
@@ -87,7 +91,6 @@ uint32_t RenderPassNode::declareRenderTarget(FrameGraph& fg, FrameGraph::Builder
     // to compute the discard flags.
 
     DependencyGraph const& dependencyGraph = fg.getGraph();
-    auto incomingEdges = dependencyGraph.getIncomingEdges(this);
 
     for (size_t i = 0; i < RenderPassData::ATTACHMENT_COUNT; i++) {
         FrameGraphId<FrameGraphTexture> const& handle =
@@ -96,20 +99,17 @@ uint32_t RenderPassNode::declareRenderTarget(FrameGraph& fg, FrameGraph::Builder
             data.attachmentInfo[i] = handle;
 
             // TODO: this is not very efficient
-            auto incomingPos = std::find_if(incomingEdges.begin(), incomingEdges.end(),
-                    [&dependencyGraph, handle]
-                            (DependencyGraph::Edge const* edge) {
+            dependencyGraph.forEachIncomingEdge(this,
+                    [&dependencyGraph, &data, handle, i](DependencyGraph::Edge const* edge) {
                         ResourceNode const* node = static_cast<ResourceNode const*>(
                                 dependencyGraph.getNode(edge->from));
-                        return node->resourceHandle == handle;
+                        if (node->resourceHandle == handle) {
+                            data.incoming[i] = const_cast<ResourceNode*>(node);
+                            return true;
+                        }
+                        return false;
                     });
 
-            if (incomingPos != incomingEdges.end()) {
-                data.incoming[i] = const_cast<ResourceNode*>(
-                        static_cast<ResourceNode const*>(
-                                dependencyGraph.getNode((*incomingPos)->from)));
-            }
-
             // this could be either outgoing or incoming (if there are no outgoing)
             data.outgoing[i] = fg.getActiveResourceNode(handle);
             if (data.outgoing[i] == data.incoming[i]) {
@@ -245,6 +245,46 @@ void RenderPassNode::resolve() noexcept {
     }
 }
 
+void RenderPassNode::resolveMemorylessAttachments() noexcept {
+    using namespace backend;
+    constexpr TextureUsage attachmentUsage = TextureUsage::COLOR_ATTACHMENT |
+            TextureUsage::DEPTH_ATTACHMENT | TextureUsage::STENCIL_ATTACHMENT;
+
+    for (auto const& rt : mRenderTargetData) {
+        if (rt.imported) {
+            continue;
+        }
+        // the attachments that are neither loaded nor stored by this render pass
+        TargetBufferFlags const discarded =
+                rt.backend.params.flags.discardStart & rt.backend.params.flags.discardEnd;
+        for (size_t i = 0; i < RenderPassData::ATTACHMENT_COUNT; i++) {
+            FrameGraphHandle const handle = rt.descriptor.attachments.array[i];
+            if (!handle || none(discarded & getTargetBufferFlagsAt(i))) {
+                continue;
+            }
+            VirtualResource* const pResource = mFrameGraph.getResource(handle)->getResource();
+            if (pResource->isImported() || pResource->first != this || pResource->last != this) {
+                continue;
+            }
+            // the texture must not be used by another render pass of ours, it would need to be
+            // stored between them
+            size_t const count = std::count_if(mRenderTargetData.begin(), mRenderTargetData.end(),
+                    [&](RenderPassData const& other) {
+                        return std::any_of(std::begin(other.descriptor.attachments.array),
+                                std::end(other.descriptor.attachments.array),
+                                [&](FrameGraphHandle h) {
+                                    return h && mFrameGraph.getResource(h)->getResource() ==
+                                            pResource;
+                                });
+                    });
+            auto* const pTexture = static_cast<Resource<FrameGraphTexture>*>(pResource);
+            if (count == 1 && none(pTexture->usage & ~attachmentUsage)) {
+                pTexture->usage |= TextureUsage::MEMORYLESS;
+            }
+        }
+    }
+}
+
 void RenderPassNode::RenderPassData::devirtualize(FrameGraph& fg,
         ResourceAllocatorInterface& resourceAllocator) noexcept {
     assert_invariant(any(targetBufferFlags));
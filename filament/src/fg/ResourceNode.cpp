@@ -69,21 +69,18 @@ void ResourceNode::setIncomingEdge(ResourceEdgeBase* edge) noexcept {
 bool ResourceNode::hasActiveReaders() const noexcept {
     // here we don't use mReaderPasses because this wouldn't account for subresources
     DependencyGraph& dependencyGraph = mFrameGraph.getGraph();
-    auto const& readers = dependencyGraph.getOutgoingEdges(this);
-    for (auto const& reader : readers) {
-        if (!dependencyGraph.getNode(reader->to)->isCulled()) {
-            return true;
-        }
-    }
-    return false;
+    return dependencyGraph.forEachOutgoingEdge(this,
+            [&dependencyGraph](DependencyGraph::Edge const* reader) {
+                return !dependencyGraph.getNode(reader->to)->isCulled();
+            });
 }
 
 bool ResourceNode::hasActiveWriters() const noexcept {
     // here we don't use mReaderPasses because this wouldn't account for subresources
     DependencyGraph const& dependencyGraph = mFrameGraph.getGraph();
-    auto const& writers = dependencyGraph.getIncomingEdges(this);
     // writers are not culled by definition if we're not culled ourselves
-    return !writers.empty();
+    return dependencyGraph.forEachIncomingEdge(this,
+            [](DependencyGraph::Edge const*) { return true; });
 }
 
 ResourceEdgeBase* ResourceNode::getReaderEdgeForPass(PassNode const* node) const noexcept {
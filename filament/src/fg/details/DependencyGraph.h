@@ -17,9 +17,10 @@
 #ifndef TNT_FILAMENT_FG_DETAILS_DEPENDENCYGRAPH_H
 #define TNT_FILAMENT_FG_DETAILS_DEPENDENCYGRAPH_H
 
+#include "fg/details/Utilities.h"
+
 #include <utils/ostream.h>
 #include <utils/CString.h>
-#include <utils/FixedCapacityVector.h>
 #include <utils/debug.h>
 
 #include <vector>
@@ -31,7 +32,8 @@ namespace filament {
  */
 class DependencyGraph {
 public:
-    DependencyGraph() noexcept;
+    // all the graph's bookkeeping is allocated from arena
+    explicit DependencyGraph(LinearAllocatorArena& arena) noexcept;
     ~DependencyGraph() noexcept;
     DependencyGraph(const DependencyGraph&) noexcept = delete;
     DependencyGraph& operator=(const DependencyGraph&) noexcept = delete;
@@ -127,8 +129,8 @@ public:
         const NodeID mId;           // unique id
     };
 
-    using EdgeContainer = utils::FixedCapacityVector<Edge*, std::allocator<Edge*>, false>;
-    using NodeContainer = utils::FixedCapacityVector<Node*, std::allocator<Node*>, false>;
+    using EdgeContainer = Vector<Edge*>;
+    using NodeContainer = Vector<Node*>;
 
     /**
      * Removes all edges and nodes from the graph.
@@ -156,6 +158,36 @@ public:
      */
     EdgeContainer getOutgoingEdges(Node const* node) const noexcept;
 
+    /**
+     * Calls f(Edge*) for each incoming edge of a node, without allocating.
+     * Iteration stops early if f returns true, in which case forEachIncomingEdge returns true.
+     */
+    template<typename F>
+    bool forEachIncomingEdge(Node const* node, F&& f) const noexcept {
+        NodeID const nodeId = node->getId();
+        for (Edge* const edge : mEdges) {
+            if (edge->to == nodeId && f(edge)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Calls f(Edge*) for each outgoing edge of a node, without allocating.
+     * Iteration stops early if f returns true, in which case forEachOutgoingEdge returns true.
+     */
+    template<typename F>
+    bool forEachOutgoingEdge(Node const* node, F&& f) const noexcept {
+        NodeID const nodeId = node->getId();
+        for (Edge* const edge : mEdges) {
+            if (edge->from == nodeId && f(edge)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     Node const* getNode(NodeID id) const noexcept;
 
     Node* getNode(NodeID id) noexcept;
@@ -163,6 +195,12 @@ public:
     //! cull unreferenced nodes. Links ARE NOT removed, only reference counts are updated.
     void cull() noexcept;
 
+    //! saves the reference counts computed by cull(), refCounts must hold one entry per node
+    void getCullState(uint32_t* refCounts) const noexcept;
+
+    //! restores reference counts saved by getCullState() from a graph with the same structure
+    void setCullState(uint32_t const* refCounts) noexcept;
+
     /**
      * Return whether an edge is valid, that is if both ends are connected to nodes
      * that are not culled. Valid only after cull() is called.
@@ -181,6 +219,7 @@ private:
     void registerNode(Node* node, NodeID id) noexcept;
     void link(Edge* edge) noexcept;
     static bool isAcyclicInternal(DependencyGraph& graph) noexcept;
+    LinearAllocatorArena& mArena;
     NodeContainer mNodes;
     EdgeContainer mEdges;
 };
@@ -41,9 +41,13 @@ class ResourceNode;
 
 class PassNode : public DependencyGraph::Node {
 protected:
+    friend class FrameGraph;
     friend class FrameGraphResources;
     FrameGraph& mFrameGraph;
-    std::unordered_set<FrameGraphHandle::Index> mDeclaredHandles;
+    std::unordered_set<FrameGraphHandle::Index,
+            std::hash<FrameGraphHandle::Index>,
+            std::equal_to<FrameGraphHandle::Index>,
+            Allocator<FrameGraphHandle::Index>> mDeclaredHandles;
 public:
     explicit PassNode(FrameGraph& fg) noexcept;
     PassNode(PassNode&& rhs) noexcept;
@@ -56,6 +60,8 @@ public:
 
     virtual void execute(FrameGraphResources const& resources, backend::DriverApi& driver) noexcept = 0;
     virtual void resolve() noexcept = 0;
+    // called after the resources' usage is known
+    virtual void resolveMemorylessAttachments() noexcept { }
     utils::CString graphvizifyEdgeColor() const noexcept override;
 
     Vector<VirtualResource*> devirtualize;         // resources we need to create before executing
@@ -98,13 +104,14 @@ private:
     utils::CString graphvizify() const noexcept override;
     void execute(FrameGraphResources const& resources, backend::DriverApi& driver) noexcept override;
     void resolve() noexcept override;
+    void resolveMemorylessAttachments() noexcept override;
 
     // constants
     const char* const mName = nullptr;
     UniquePtr<FrameGraphPassBase, LinearAllocatorArena> mPassBase;
 
     // set during setup
-    std::vector<RenderPassData> mRenderTargetData;
+    Vector<RenderPassData> mRenderTargetData;
 };
 
 class PresentPassNode : public PassNode {
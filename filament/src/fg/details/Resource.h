@@ -97,6 +97,9 @@ public:
 
     virtual bool isImported() const noexcept { return false; }
 
+    /* Estimated size in bytes of the concrete resource, 0 if it's not owned by the FrameGraph */
+    virtual size_t getMemorySize() const noexcept { return 0; }
+
     // this is to workaround our lack of RTTI -- otherwise we could use dynamic_cast
     virtual ImportedRenderTarget* asImportedRenderTarget() noexcept { return nullptr; }
 
@@ -250,6 +253,11 @@ protected:
     utils::CString usageString() const noexcept override {
         return utils::to_string(usage);
     }
+
+    size_t getMemorySize() const noexcept override {
+        // subresources share the memory of their parent
+        return isSubResource() ? 0 : RESOURCE::getMemorySize(descriptor);
+    }
 };
 
 /*
@@ -279,6 +287,8 @@ protected:
 
     bool isImported() const noexcept override { return true; }
 
+    size_t getMemorySize() const noexcept override { return 0; }
+
     UTILS_NOINLINE
     bool connect(DependencyGraph& graph,
             PassNode* passNode, ResourceNode* resourceNode, FrameGraphTexture::Usage u) override {
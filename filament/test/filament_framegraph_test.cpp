@@ -96,7 +96,8 @@ public:
 };
 
 TEST(DependencyGraphTest, Simple) {
-    DependencyGraph graph;
+    LinearAllocatorArena arena("DependencyGraphTest Arena", 65536);
+    DependencyGraph graph(arena);
     Node* n0 = new Node(graph, "node 0");
     Node* n1 = new Node(graph, "node 1");
     Node* n2 = new Node(graph, "node 2");
@@ -128,7 +129,8 @@ TEST(DependencyGraphTest, Simple) {
 }
 
 TEST(DependencyGraphTest, Culling1) {
-    DependencyGraph graph;
+    LinearAllocatorArena arena("DependencyGraphTest Arena", 65536);
+    DependencyGraph graph(arena);
     Node* n0 = new Node(graph, "node 0");
     Node* n1 = new Node(graph, "node 1");
     Node* n2 = new Node(graph, "node 2");
@@ -165,7 +167,8 @@ TEST(DependencyGraphTest, Culling1) {
 }
 
 TEST(DependencyGraphTest, Culling2) {
-    DependencyGraph graph;
+    LinearAllocatorArena arena("DependencyGraphTest Arena", 65536);
+    DependencyGraph graph(arena);
     Node* n0 = new Node(graph, "node 0");
     Node* n1 = new Node(graph, "node 1");
     Node* n2 = new Node(graph, "node 2");
@@ -209,6 +212,76 @@ TEST(DependencyGraphTest, Culling2) {
     for (auto n : nodes) { delete n; }
 }
 
+TEST(FrameGraphArenaTest, ArenaIsReleased) {
+    MockResourceAllocator resourceAllocator;
+    LinearAllocatorArena arena("FrameGraphArenaTest Arena", 262144);
+    void* const begin = arena.getCurrent();
+
+    for (size_t i = 0; i < 2; i++) {
+        FrameGraph fg(resourceAllocator, arena);
+        struct PassData {
+            FrameGraphId<FrameGraphTexture> output;
+        };
+        auto& pass = fg.addPass<PassData>("Pass", [&](FrameGraph::Builder& builder, auto& data) {
+                    data.output = builder.create<FrameGraphTexture>("Output", {.width=16, .height=32});
+                    data.output = builder.write(data.output, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                    builder.sideEffect();
+                },
+                [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {
+                });
+        fg.getBlackboard()["output"] = pass->output;
+        fg.compile();
+
+        EXPECT_FALSE(fg.isCulled(pass));
+        EXPECT_GT(fg.getArenaUsage(), 0);
+    }
+
+    // everything the FrameGraphs allocated was given back to the arena
+    EXPECT_EQ(arena.getCurrent(), begin);
+}
+
+TEST(FrameGraphCompileCacheTest, ReuseSchedule) {
+    MockResourceAllocator resourceAllocator;
+    FrameGraph::CompileCache cache;
+
+    auto build = [&](FrameGraph& fg, bool withUnusedPass) -> auto& {
+        struct PassData {
+            FrameGraphId<FrameGraphTexture> output;
+        };
+        auto& pass = fg.addPass<PassData>("Pass", [&](FrameGraph::Builder& builder, auto& data) {
+                    data.output = builder.create<FrameGraphTexture>("Output", {.width=16, .height=32});
+                    data.output = builder.write(data.output, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                },
+                [=](FrameGraphResources const& resources, auto const& data, backend::DriverApi&) {
+                    EXPECT_EQ(resources.getUsage(data.output), FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                });
+        if (withUnusedPass) {
+            fg.addPass<PassData>("Unused", [&](FrameGraph::Builder& builder, auto& data) {
+                        data.output = builder.create<FrameGraphTexture>("Unused", {.width=16, .height=32});
+                        data.output = builder.write(data.output, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                    },
+                    [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {
+                    });
+        }
+        fg.present(pass->output);
+        fg.compile(cache);
+        return pass;
+    };
+
+    for (size_t i = 0; i < 3; i++) {
+        FrameGraph fg(resourceAllocator);
+        auto& pass = build(fg, false);
+        EXPECT_FALSE(fg.isCulled(pass));
+        EXPECT_EQ(cache.getHitCount(), i);
+    }
+
+    // a different structure isn't a hit
+    FrameGraph fg(resourceAllocator);
+    auto& pass = build(fg, true);
+    EXPECT_FALSE(fg.isCulled(pass));
+    EXPECT_EQ(cache.getHitCount(), 2);
+}
+
 TEST_F(FrameGraphTest, ReadRead) {
     struct PassData {
         FrameGraphId<FrameGraphTexture> input;
@@ -951,3 +1024,115 @@ TEST_F(FrameGraphTest, WriteResourceReadAsAttachment) {
 
     fg.execute(driverApi);
 }
+
+TEST_F(FrameGraphTest, TransientMemoryStats) {
+    struct PassData {
+        FrameGraphId<FrameGraphTexture> input;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    // each texture is 16 * 16 * 4 = 1 KiB
+    FrameGraphTexture::Descriptor const desc{ .width = 16, .height = 16 };
+
+    auto& pass0 = fg.addPass<PassData>("Pass0", [&](FrameGraph::Builder& builder, auto& data) {
+                data.output = builder.create<FrameGraphTexture>("t0", desc);
+                data.output = builder.write(data.output);
+            },
+            [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {});
+
+    auto& pass1 = fg.addPass<PassData>("Pass1", [&](FrameGraph::Builder& builder, auto& data) {
+                data.input = builder.read(pass0->output);
+                data.output = builder.create<FrameGraphTexture>("t1", desc);
+                data.output = builder.write(data.output);
+            },
+            [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {});
+
+    auto& pass2 = fg.addPass<PassData>("Pass2", [&](FrameGraph::Builder& builder, auto& data) {
+                data.input = builder.read(pass1->output);
+                data.output = builder.create<FrameGraphTexture>("t2", desc);
+                data.output = builder.write(data.output);
+            },
+            [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {});
+
+    fg.present(pass2->output);
+
+    fg.compile();
+
+    // t0 is not alive anymore when t2 is created
+    EXPECT_EQ(fg.getTransientMemoryStats().peak, 2048);
+    EXPECT_EQ(fg.getTransientMemoryStats().total, 3072);
+
+    fg.execute(driverApi);
+}
+
+TEST_F(FrameGraphTest, TileMemoryReport) {
+    struct PassData {
+        FrameGraphId<FrameGraphTexture> input;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    // each texture is 16 * 16 * 4 = 1 KiB
+    FrameGraphTexture::Descriptor const desc{ .width = 16, .height = 16 };
+
+    auto& pass0 = fg.addPass<PassData>("Pass0", [&](FrameGraph::Builder& builder, auto& data) {
+                data.output = builder.create<FrameGraphTexture>("t0", desc);
+                data.output = builder.declareRenderPass(
+                        builder.write(data.output, FrameGraphTexture::Usage::COLOR_ATTACHMENT));
+            },
+            [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {});
+
+    auto& pass1 = fg.addPass<PassData>("Pass1", [&](FrameGraph::Builder& builder, auto& data) {
+                data.input = builder.sample(pass0->output);
+                data.output = builder.create<FrameGraphTexture>("t1", desc);
+                data.output = builder.declareRenderPass(
+                        builder.write(data.output, FrameGraphTexture::Usage::COLOR_ATTACHMENT));
+            },
+            [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {});
+
+    fg.present(pass1->output);
+
+    fg.compile();
+
+    // t0 is only read by the next pass, so it wouldn't need to be stored nor loaded
+    auto const report = fg.getTileMemoryReport();
+    ASSERT_EQ(report.candidates.size(), 1);
+    EXPECT_STREQ(report.candidates[0].producer, "Pass0");
+    EXPECT_STREQ(report.candidates[0].consumer, "Pass1");
+    EXPECT_STREQ(report.candidates[0].resource, "t0");
+    EXPECT_EQ(report.candidates[0].bandwidth, 2048);
+    EXPECT_EQ(report.candidatesBandwidth, 2048);
+    EXPECT_EQ(report.subpassBandwidth, 0);
+
+    fg.execute(driverApi);
+}
+
+TEST_F(FrameGraphTest, MemorylessAttachments) {
+    struct PassData {
+        FrameGraphId<FrameGraphTexture> color;
+        FrameGraphId<FrameGraphTexture> depth;
+    };
+
+    FrameGraphTexture::Descriptor const desc{ .width = 16, .height = 16 };
+
+    auto& pass = fg.addPass<PassData>("Pass", [&](FrameGraph::Builder& builder, auto& data) {
+                data.color = builder.create<FrameGraphTexture>("Color", desc);
+                data.depth = builder.create<FrameGraphTexture>("Depth", desc);
+                data.color = builder.write(data.color, FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                data.depth = builder.write(data.depth, FrameGraphTexture::Usage::DEPTH_ATTACHMENT);
+                builder.declareRenderPass("Target", { .attachments = {
+                        .color = { data.color }, .depth = data.depth }});
+            },
+            [=](FrameGraphResources const& resources, auto const& data, backend::DriverApi&) {
+                // the depth buffer is neither loaded nor stored, but the color buffer is presented
+                EXPECT_EQ(resources.getUsage(data.depth),
+                        FrameGraphTexture::Usage::DEPTH_ATTACHMENT |
+                        FrameGraphTexture::Usage::MEMORYLESS);
+                EXPECT_EQ(resources.getUsage(data.color),
+                        FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+            });
+
+    fg.present(pass->color);
+
+    fg.compile();
+    fg.execute(driverApi);
+}
@@ -14,8 +14,11 @@
  * limitations under the License.
  */
 
+#include <chrono>
 #include <iostream>
 #include <random>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -28,19 +31,31 @@
 #include <filament/Box.h>
 #include <filament/Camera.h>
 #include <filament/Color.h>
+#include <filament/ColorGrading.h>
 #include <filament/Frustum.h>
 #include <filament/Material.h>
+#include <filament/ToneMapper.h>
 #include <filament/Engine.h>
+#include <filament/Texture.h>
 
 #include <private/filament/BufferInterfaceBlock.h>
 #include <private/filament/UibStructs.h>
 #include <private/backend/BackendUtils.h>
 
+#include <utils/JobSystem.h>
+
+#include "AabbTree.h"
 #include "Allocators.h"
 #include "details/Material.h"
 #include "details/Camera.h"
+#include "Culler.h"
 #include "Froxelizer.h"
+#include "OcclusionCuller.h"
 #include "details/Engine.h"
+#include "details/IndexBuffer.h"
+#include "details/Scene.h"
+#include "details/SkinningBuffer.h"
+#include "details/VertexBuffer.h"
 #include "components/RenderableManager.h"
 #include "components/TransformManager.h"
 #include "UniformBuffer.h"
@@ -300,6 +315,161 @@ TEST(FilamentTest, TransformManager) {
     EXPECT_EQ(c, tcm.getChildCount(newParent));
 }
 
+TEST(FilamentTest, TransformManagerBulkCreate) {
+    filament::FTransformManager tcm;
+    EntityManager& em = EntityManager::get();
+    Entity root = em.create();
+    tcm.create(root);
+    TransformManager::Instance const parent = tcm.getInstance(root);
+
+    constexpr size_t COUNT = 100;
+    std::array<Entity, COUNT> entities;
+    std::array<mat4f, COUNT> transforms;
+    em.create(COUNT, entities.data());
+    for (size_t i = 0; i < COUNT; i++) {
+        transforms[i] = mat4f::translation(float3{ float(i), 0, 0 });
+    }
+
+    tcm.setTransform(parent, mat4f{ float4{ 2 }});
+    tcm.create(entities.data(), COUNT, parent, transforms.data());
+
+    EXPECT_EQ(tcm.getComponentCount(), COUNT + 1);
+    EXPECT_EQ(tcm.getChildCount(parent), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        TransformManager::Instance const ti = tcm.getInstance(entities[i]);
+        EXPECT_TRUE(bool(ti));
+        EXPECT_EQ(tcm.getParent(ti), root);
+        EXPECT_EQ(tcm.getTransform(ti), transforms[i]);
+        EXPECT_EQ(tcm.getWorldTransform(ti), mat4f{ float4{ 2 }} * transforms[i]);
+    }
+
+    for (Entity e : entities) {
+        tcm.destroy(e);
+    }
+    tcm.destroy(root);
+    em.destroy(COUNT, entities.data());
+    em.destroy(root);
+}
+
+TEST(FilamentTest, TransformManagerVersion) {
+    filament::FTransformManager tcm;
+    EntityManager& em = EntityManager::get();
+    Entity root = em.create();
+    Entity child = em.create();
+    Entity other = em.create();
+    tcm.create(root);
+    tcm.create(child, tcm.getInstance(root), mat4f{});
+    tcm.create(other);
+
+    uint32_t const componentsVersion = tcm.getComponentsVersion();
+    uint32_t const v0 = tcm.advanceVersion();
+    auto const ri = tcm.getInstance(root);
+    auto const ci = tcm.getInstance(child);
+    auto const oi = tcm.getInstance(other);
+    EXPECT_LE(tcm.getVersion(ri), v0);
+    EXPECT_LE(tcm.getVersion(ci), v0);
+    EXPECT_LE(tcm.getVersion(oi), v0);
+
+    // moving a node changes its version and the version of its descendants
+    tcm.setTransform(ri, mat4f::translation(float3{ 1, 2, 3 }));
+    EXPECT_GT(tcm.getVersion(ri), v0);
+    EXPECT_GT(tcm.getVersion(ci), v0);
+    EXPECT_LE(tcm.getVersion(oi), v0);
+
+    // transactions only change the version of the transforms that changed
+    uint32_t const v1 = tcm.advanceVersion();
+    tcm.openLocalTransformTransaction();
+    tcm.setTransform(ci, mat4f::translation(float3{ 1, 0, 0 }));
+    tcm.setTransform(oi, mat4f{});
+    tcm.commitLocalTransformTransaction();
+    EXPECT_LE(tcm.getVersion(tcm.getInstance(root)), v1);
+    EXPECT_GT(tcm.getVersion(tcm.getInstance(child)), v1);
+    EXPECT_LE(tcm.getVersion(tcm.getInstance(other)), v1);
+    EXPECT_EQ(componentsVersion, tcm.getComponentsVersion());
+
+    tcm.destroy(other);
+    EXPECT_NE(componentsVersion, tcm.getComponentsVersion());
+
+    em.destroy(root);
+    em.destroy(child);
+    em.destroy(other);
+}
+
+TEST(FilamentTest, TransformManagerLevels) {
+    // the world transforms are computed level by level, possibly in parallel
+    JobSystem js;
+    js.adopt();
+
+    filament::FTransformManager serial;
+    filament::FTransformManager parallel;
+    parallel.setJobSystem(&js);
+
+    EntityManager& em = EntityManager::get();
+    std::default_random_engine generator(82828); // NOLINT
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    // a few trees, with some parents created after their children
+    constexpr size_t COUNT = 5000;
+    std::vector<Entity> entities(COUNT);
+    em.create(COUNT, entities.data());
+    for (filament::FTransformManager* tcm: { &serial, &parallel }) {
+        tcm->openLocalTransformTransaction();
+        for (size_t i = 0; i < COUNT; i++) {
+            tcm->create(entities[i]);
+        }
+        std::default_random_engine g(1234); // NOLINT
+        for (size_t i = 0; i < COUNT; i++) {
+            if (i % 1000) {
+                // The first half of each tree is wide and shallow, the second half is a chain
+                // of nodes whose parent comes next.
+                size_t const parent = (i % 1000 > 500) ?
+                        (i + 1) : (i / 1000) * 1000 + g() % std::min<size_t>(i % 1000, 4);
+                if (parent < COUNT && parent != i) {
+                    tcm->setParent(tcm->getInstance(entities[i]),
+                            tcm->getInstance(entities[parent]));
+                }
+            }
+        }
+        tcm->commitLocalTransformTransaction();
+    }
+
+    serial.openLocalTransformTransaction();
+    parallel.openLocalTransformTransaction();
+    for (size_t i = 0; i < COUNT; i++) {
+        mat4f const t = mat4f::translation(float3{
+                distribution(generator), distribution(generator), distribution(generator) });
+        serial.setTransform(serial.getInstance(entities[i]), t);
+        parallel.setTransform(parallel.getInstance(entities[i]), t);
+    }
+    serial.commitLocalTransformTransaction();
+    parallel.commitLocalTransformTransaction();
+
+    for (size_t i = 0; i < COUNT; i++) {
+        auto const si = serial.getInstance(entities[i]);
+        auto const pi = parallel.getInstance(entities[i]);
+        EXPECT_EQ(serial.getParent(si), parallel.getParent(pi));
+        EXPECT_EQ(serial.getWorldTransform(si), parallel.getWorldTransform(pi));
+
+        // parents are stored before their children
+        Entity const parent = parallel.getParent(pi);
+        if (parent) {
+            auto const ppi = parallel.getInstance(parent);
+            EXPECT_LT(ppi, pi);
+            mat4f const expected = parallel.getWorldTransform(ppi) * parallel.getTransform(pi);
+            EXPECT_NEAR(expected[3].x, parallel.getWorldTransform(pi)[3].x, 1e-4f);
+            EXPECT_NEAR(expected[3].y, parallel.getWorldTransform(pi)[3].y, 1e-4f);
+            EXPECT_NEAR(expected[3].z, parallel.getWorldTransform(pi)[3].z, 1e-4f);
+        }
+    }
+
+    for (Entity const e: entities) {
+        serial.destroy(e);
+        parallel.destroy(e);
+    }
+    em.destroy(COUNT, entities.data());
+    js.emancipate();
+}
+
 TEST(FilamentTest, UniformInterfaceBlock) {
 
     BufferInterfaceBlock::Builder b;
@@ -532,6 +702,79 @@ TEST(FilamentTest, UniformBufferSize2) {
     buffer.invalidate();
 }
 
+TEST(FilamentTest, AabbTree) {
+    std::default_random_engine generator(82828); // NOLINT
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.1f, 3.0f);
+
+    constexpr size_t COUNT = 1000;
+    AabbTree tree;
+    std::vector<AabbTree::NodeId> leaves(COUNT);
+    std::vector<Aabb> boxes(COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        float3 const c{ position(generator), position(generator), position(generator) };
+        float3 const e{ size(generator), size(generator), size(generator) };
+        boxes[i] = { c - e, c + e };
+        leaves[i] = tree.insert(boxes[i], uint32_t(i));
+    }
+    EXPECT_TRUE(tree.validate());
+    EXPECT_EQ(COUNT, tree.getLeafCount());
+    // a balanced tree of 1000 leaves has a height of at least 10
+    EXPECT_LT(tree.getHeight(), 20);
+
+    // small moves stay within the fat boxes, large moves reinsert the leaves
+    EXPECT_FALSE(tree.update(leaves[0], boxes[0]));
+    Aabb const far{ boxes[1].min + 50.0f, boxes[1].max + 50.0f };
+    EXPECT_TRUE(tree.update(leaves[1], far));
+    boxes[1] = far;
+    for (size_t i = 2; i < COUNT; i++) {
+        float3 const d = float3{ position(generator), position(generator), position(generator) };
+        boxes[i] = { boxes[i].min + d * 0.1f, boxes[i].max + d * 0.1f };
+        tree.update(leaves[i], boxes[i]);
+        EXPECT_TRUE(all(lessThanEqual(tree.getFatBox(leaves[i]).min, boxes[i].min)));
+        EXPECT_TRUE(all(greaterThanEqual(tree.getFatBox(leaves[i]).max, boxes[i].max)));
+    }
+    EXPECT_TRUE(tree.validate());
+
+    for (size_t i = 0; i < COUNT; i += 3) {
+        tree.remove(leaves[i]);
+        leaves[i] = AabbTree::NONE;
+    }
+    EXPECT_TRUE(tree.validate());
+    EXPECT_EQ(COUNT - (COUNT + 2) / 3, tree.getLeafCount());
+
+    // the query must return at least all the boxes that the linear test doesn't reject
+    Frustum const frustum{ mat4f::perspective(45.0f, 1.0f, 0.1f, 100.0f) };
+    float4 const* const planes = frustum.getNormalizedPlanes();
+    std::vector<bool> visited(COUNT);
+    tree.query(planes, [&](uint32_t i, bool inside) {
+        EXPECT_FALSE(visited[i]);
+        visited[i] = true;
+        if (inside) {
+            EXPECT_EQ(AabbTree::Classification::INSIDE, AabbTree::classify(planes, boxes[i]));
+        }
+    });
+    size_t visible = 0;
+    for (size_t i = 0; i < COUNT; i++) {
+        if (leaves[i] == AabbTree::NONE) {
+            EXPECT_FALSE(visited[i]);
+        } else if (AabbTree::classify(planes, boxes[i]) != AabbTree::Classification::OUTSIDE) {
+            EXPECT_TRUE(visited[i]);
+            visible++;
+        }
+    }
+    EXPECT_GT(visible, 0);
+
+    for (size_t i = 0; i < COUNT; i++) {
+        if (leaves[i] != AabbTree::NONE) {
+            tree.remove(leaves[i]);
+        }
+    }
+    EXPECT_TRUE(tree.validate());
+    EXPECT_EQ(0, tree.getLeafCount());
+    EXPECT_EQ(0, tree.getHeight());
+}
+
 TEST(FilamentTest, BoxCulling) {
     Frustum frustum(mat4f::frustum(-1, 1, -1, 1, 1, 100));
 
@@ -612,6 +855,237 @@ TEST(FilamentTest, SphereCulling) {
     EXPECT_TRUE(frustum.intersects({ 0, 200 }));
 }
 
+TEST(FilamentTest, CullerKernels) {
+    Frustum const frustum{ mat4f::perspective(45.0f, 1.0f, 0.1f, 100.0f) };
+    float4 const* planes = frustum.getNormalizedPlanes();
+
+    constexpr size_t count = 1024;
+    std::default_random_engine gen; // NOLINT
+    std::uniform_real_distribution<float> rand(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.1f, 10.0f);
+
+    std::vector<float3> centers(count);
+    std::vector<float3> extents(count);
+    std::vector<float4> spheres(count);
+    for (size_t i = 0; i < count; i++) {
+        centers[i] = { rand(gen), rand(gen), -std::abs(rand(gen)) };
+        extents[i] = { size(gen), size(gen), size(gen) };
+        spheres[i] = { centers[i], size(gen) };
+    }
+
+    // the kernels may round differently, so we ignore primitives too close to a plane
+    auto isAmbiguousBox = [planes](float3 const& c, float3 const& e) {
+        for (size_t j = 0; j < 6; j++) {
+            float const d = dot(planes[j].xyz, c) - dot(abs(planes[j].xyz), e) + planes[j].w;
+            if (std::abs(d) < 1e-3f) {
+                return true;
+            }
+        }
+        return false;
+    };
+    auto isAmbiguousSphere = [planes](float4 const& s) {
+        for (size_t j = 0; j < 6; j++) {
+            float const d = dot(planes[j].xyz, s.xyz) + planes[j].w - s.w;
+            if (std::abs(d) < 1e-3f) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::vector<Culler::result_type> expectedBoxes(count, 0xF0);
+    std::vector<Culler::result_type> expectedSpheres(count);
+    Culler::Test::intersects(Culler::Kernel::GENERIC,
+            expectedBoxes.data(), frustum, centers.data(), extents.data(), count);
+    Culler::Test::intersects(Culler::Kernel::GENERIC,
+            expectedSpheres.data(), frustum, spheres.data(), count);
+
+    EXPECT_TRUE(Culler::isKernelSupported(Culler::Kernel::GENERIC));
+    EXPECT_TRUE(Culler::isKernelSupported(Culler::getKernel()));
+
+    for (auto kernel : { Culler::Kernel::SSE2, Culler::Kernel::AVX2, Culler::Kernel::NEON }) {
+        if (!Culler::isKernelSupported(kernel)) {
+            continue;
+        }
+        std::vector<Culler::result_type> boxes(count, 0xF0);
+        std::vector<Culler::result_type> results(count);
+        Culler::Test::intersects(kernel,
+                boxes.data(), frustum, centers.data(), extents.data(), count);
+        Culler::Test::intersects(kernel,
+                results.data(), frustum, spheres.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            if (!isAmbiguousBox(centers[i], extents[i])) {
+                EXPECT_EQ(expectedBoxes[i], boxes[i]) << "kernel " << int(kernel) << ", " << i;
+            }
+            if (!isAmbiguousSphere(spheres[i])) {
+                EXPECT_EQ(expectedSpheres[i], results[i]) << "kernel " << int(kernel) << ", " << i;
+            }
+        }
+    }
+}
+
+TEST(FilamentTest, CullerMultipleFrustums) {
+    // a few frustums looking in different directions
+    constexpr size_t frustumCount = 5;
+    std::vector<Frustum> frustums;
+    std::vector<float4> planes;
+    for (size_t k = 0; k < frustumCount; k++) {
+        mat4f const view = mat4f::rotation(float(k) * 0.5f, float3{ 0, 1, 0 });
+        frustums.emplace_back(mat4f::perspective(45.0f, 1.0f, 0.1f, 100.0f) * view);
+        float4 const* p = frustums.back().getNormalizedPlanes();
+        planes.insert(planes.end(), p, p + 6);
+    }
+
+    // not a multiple of Culler::MODULO
+    constexpr size_t count = 1021;
+    std::default_random_engine gen; // NOLINT
+    std::uniform_real_distribution<float> rand(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.1f, 10.0f);
+
+    std::vector<float3> centers(Culler::round(count));
+    std::vector<float3> extents(Culler::round(count));
+    for (size_t i = 0; i < count; i++) {
+        centers[i] = { rand(gen), rand(gen), rand(gen) };
+        extents[i] = { size(gen), size(gen), size(gen) };
+    }
+
+    std::vector<uint64_t> masks(count);
+    Culler::intersects(masks.data(), planes.data(), frustumCount,
+            centers.data(), extents.data(), count);
+
+    for (size_t k = 0; k < frustumCount; k++) {
+        std::vector<Culler::result_type> expected(Culler::round(count));
+        Culler::Test::intersects(Culler::Kernel::GENERIC,
+                expected.data(), frustums[k], centers.data(), extents.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_EQ(expected[i] & 1u, (masks[i] >> k) & 1u) << "frustum " << k << ", " << i;
+        }
+    }
+}
+
+TEST(FilamentTest, Bones) {
+    // packing a quaternion-translation pair must match packing the equivalent matrix
+    RenderableManager::Bone const bone{
+            .unitQuaternion = normalize(quatf{ 0.7f, 0.1f, -0.4f, 0.3f }),
+            .translation = { 1.0f, -2.0f, 3.0f }
+    };
+    mat4f transform(bone.unitQuaternion);
+    transform[3] = float4{ bone.translation, 1.0f };
+
+    PerRenderableBoneUib::BoneData const expected = FSkinningBuffer::makeBone(transform);
+    PerRenderableBoneUib::BoneData const actual = FSkinningBuffer::makeBone(bone);
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 4; j++) {
+            EXPECT_NEAR(expected.transform[i][j], actual.transform[i][j], 1e-5f);
+        }
+        EXPECT_NEAR(expected.cof0[i], actual.cof0[i], 1e-5f);
+    }
+    EXPECT_NEAR(expected.cof1x, actual.cof1x, 1e-5f);
+}
+
+TEST(FilamentTest, PositionDequantization) {
+    // folding the dequantization into the model matrix must give the same world positions
+    FRenderableManager::PositionDequantization const q{
+            .scale = { 2.0f, 0.5f, 4.0f },
+            .offset = { -1.0f, 3.0f, 0.25f }
+    };
+    mat4f const model = mat4f::translation(float3{ 5, -2, 1 }) *
+            mat4f::rotation(0.7f, normalize(float3{ 1, 2, 3 })) *
+            mat4f::scaling(float3{ 1.5f, 1.5f, 1.5f });
+    mat4f const m = FRenderableManager::dequantize(model, q);
+
+    float3 const quantized{ 0.25f, -0.75f, 1.0f };
+    float4 const expected = model * float4{ q.offset + q.scale * quantized, 1.0f };
+    float4 const actual = m * float4{ quantized, 1.0f };
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT_NEAR(expected[i], actual[i], 1e-5f);
+    }
+}
+
+TEST(FilamentTest, OcclusionCulling) {
+    // same transform as FCamera::getProjectionMatrix(), i.e.: reversed-Z
+    const mat4 clipFromWorld = mat4{ mat4::row_major_init{
+            1.0, 0.0,  0.0, 0.0,
+            0.0, 1.0,  0.0, 0.0,
+            0.0, 0.0, -0.5, 0.5,
+            0.0, 0.0,  0.0, 1.0
+    }} * mat4::frustum(-1, 1, -1, 1, 1, 100);
+
+    // depth of a wall at z = -10, covering the right half of the depth buffer
+    const float4 p = mat4f{ clipFromWorld } * float4{ 0, 0, -10, 1 };
+    const float wall = p.z / p.w;
+    constexpr uint32_t width = 16;
+    constexpr uint32_t height = 16;
+    std::vector<float> depth(width * height);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            depth[y * width + x] = x < width / 2 ? 0.0f : wall;
+        }
+    }
+
+    OcclusionCuller culler;
+    EXPECT_FALSE(culler.hasDepthBuffer());
+    culler.setDepthBuffer(depth.data(), width, height, clipFromWorld);
+    EXPECT_TRUE(culler.hasDepthBuffer());
+
+    float3 const center[8] = {
+            {  5, 0, -20 },     // behind the wall
+            { -5, 0, -20 },     // behind nothing
+            {  5, 0,  -5 },     // in front of the wall
+            {  0, 0,   0 },     // crosses the camera plane
+            { 20, 0, -20 },     // partially outside of the depth buffer
+            {  5, 0, -20 },     // behind the wall, but already culled
+            {  5, 1, -30 },     // behind the wall
+            {  5, 0, -11 },     // intersects the wall
+    };
+    float3 const extent[8] = {
+            0.5f, 0.5f, 0.5f, 2.0f, 0.5f, 0.5f, 0.5f, 2.0f
+    };
+    Culler::result_type results[8] = { 1, 1, 1, 1, 1, 0, 1, 1 };
+
+    EXPECT_EQ(2, culler.cull(results, center, extent, 8, 0, mat4{}));
+    EXPECT_EQ(0, results[0]);
+    EXPECT_EQ(1, results[1]);
+    EXPECT_EQ(1, results[2]);
+    EXPECT_EQ(1, results[3]);
+    EXPECT_EQ(1, results[4]);
+    EXPECT_EQ(0, results[5]);
+    EXPECT_EQ(0, results[6]);
+    EXPECT_EQ(1, results[7]);
+
+    // the world transform applied to the AABBs is taken into account
+    Culler::result_type moved[1] = { 1 };
+    float3 const movedCenter[1] = { { 105, 0, -20 } };
+    EXPECT_EQ(1, culler.cull(moved, movedCenter, extent, 1, 0, mat4::translation(double3{ 100, 0, 0 })));
+
+    // the empty half of the depth buffer is ignored, the wall is 10 units away, or 15 when
+    // seen from 5 units behind where it was rendered
+    EXPECT_NEAR(10.0f, culler.getVisibleDistanceRange(mat4{})[1], 1e-3f);
+    EXPECT_NEAR(15.0f, culler.getVisibleDistanceRange(
+            mat4::translation(double3{ 0, 0, -5 }))[1], 1e-3f);
+    EXPECT_NEAR(10.0f, culler.getVisibleDistanceRange(mat4{})[0], 1e-3f);
+
+    // with a nearest depth, the range spans from the nearest to the farthest geometry, and
+    // texels which are only partially covered count for the nearest distance
+    const float4 q = mat4f{ clipFromWorld } * float4{ 0, 0, -4, 1 };
+    std::vector<float2> depthRange(width * height);
+    for (uint32_t i = 0; i < width * height; i++) {
+        depthRange[i] = { depth[i], depth[i] };
+    }
+    depthRange[0] = { 0.0f, q.z / q.w };
+    culler.setDepthBuffer(depthRange.data(), width, height, clipFromWorld);
+    EXPECT_NEAR(4.0f, culler.getVisibleDistanceRange(mat4{})[0], 1e-3f);
+    EXPECT_NEAR(10.0f, culler.getVisibleDistanceRange(mat4{})[1], 1e-3f);
+
+    culler.reset();
+    EXPECT_FALSE(culler.hasDepthBuffer());
+    EXPECT_EQ(0.0f, culler.getVisibleDistanceRange(mat4{})[0]);
+    EXPECT_EQ(0.0f, culler.getVisibleDistanceRange(mat4{})[1]);
+    Culler::result_type again[1] = { 1 };
+    EXPECT_EQ(0, culler.cull(again, center, extent, 1, 0, mat4{}));
+    EXPECT_EQ(1, again[0]);
+}
+
 TEST(FilamentTest, ColorConversion) {
     // Linear to Gamma
     // 0.0 stays 0.0
@@ -733,6 +1207,16 @@ TEST(FilamentTest, FroxelData) {
             pointCount += entry.count();
         }
         EXPECT_GT(pointCount, 0);
+
+        // all the froxels touched by the light share the same record, even when not adjacent
+        auto const* const first = std::find_if(froxelBuffer.begin(), froxelBuffer.end(),
+                [](auto const& entry) { return entry.count() > 0; });
+        ASSERT_NE(first, froxelBuffer.end());
+        for (const auto& entry : froxelBuffer) {
+            if (entry.count()) {
+                EXPECT_EQ(entry.offset(), first->offset());
+            }
+        }
     }
 
     {
@@ -758,6 +1242,213 @@ TEST(FilamentTest, FroxelData) {
     Engine::destroy((Engine **)&engine);
 }
 
+TEST(FilamentTest, ColorGradingLutCache) {
+    using namespace filament;
+
+    FEngine* engine = downcast(Engine::create());
+    FColorGrading::LutCache const& cache = engine->getColorGradingLutCache();
+    size_t const hitCount = cache.getHitCount();
+
+    GenericToneMapper toneMapper;
+    auto build = [&]() {
+        return downcast(ColorGrading::Builder()
+                .toneMapper(&toneMapper)
+                .exposure(1.0f)
+                .build(*engine));
+    };
+
+    // the same parameters share the same LUT
+    FColorGrading* a = build();
+    FColorGrading* b = build();
+    EXPECT_EQ(cache.getHitCount(), hitCount + 1);
+    EXPECT_EQ(a->getHwHandle(), b->getHwHandle());
+
+    // and it's kept after it's not used anymore
+    backend::TextureHandle const lut = a->getHwHandle();
+    engine->destroy(a);
+    engine->destroy(b);
+    FColorGrading* c = build();
+    EXPECT_EQ(cache.getHitCount(), hitCount + 2);
+    EXPECT_EQ(c->getHwHandle(), lut);
+
+    // a modified tone mapper needs a new LUT
+    toneMapper.setContrast(1.2f);
+    FColorGrading* d = build();
+    EXPECT_EQ(cache.getHitCount(), hitCount + 2);
+    EXPECT_NE(d->getHwHandle(), lut);
+
+    engine->destroy(c);
+    engine->destroy(d);
+    Engine::destroy((Engine **)&engine);
+}
+
+TEST(FilamentTest, PrefilterMipmapAsync) {
+    using namespace filament;
+
+    FEngine* engine = downcast(Engine::create());
+
+    constexpr uint32_t size = 16;
+    Texture* const texture = Texture::Builder()
+            .width(size).height(size).levels(5)
+            .sampler(Texture::Sampler::SAMPLER_CUBEMAP)
+            .format(Texture::InternalFormat::R11F_G11F_B10F)
+            .build(*engine);
+
+    std::vector<float3> data(size * size * 6, float3{ 1.0f });
+    Texture::PixelBufferDescriptor buffer(data.data(), data.size() * sizeof(float3),
+            Texture::Format::RGB, Texture::Type::FLOAT);
+
+    bool done = false;
+    texture->generatePrefilterMipmapAsync(*engine, std::move(buffer),
+            Texture::FaceOffsets{ size * size * sizeof(float3) }, nullptr, nullptr,
+            [&done, texture](Texture* t) {
+                EXPECT_EQ(t, texture);
+                done = true;
+            });
+
+    // the levels are uploaded, and the callback called, by the engine's thread
+    for (size_t i = 0; i < 1000 && !done; i++) {
+        engine->prepare();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(done);
+
+    engine->destroy(downcast(texture));
+    Engine::destroy((Engine **)&engine);
+}
+
+TEST(FilamentTest, PrefilterMipmapAsyncDestroyed) {
+    using namespace filament;
+
+    FEngine* engine = downcast(Engine::create());
+
+    constexpr uint32_t size = 16;
+    Texture* const texture = Texture::Builder()
+            .width(size).height(size).levels(5)
+            .sampler(Texture::Sampler::SAMPLER_CUBEMAP)
+            .format(Texture::InternalFormat::R11F_G11F_B10F)
+            .build(*engine);
+
+    std::vector<float3> data(size * size * 6, float3{ 1.0f });
+    Texture::PixelBufferDescriptor buffer(data.data(), data.size() * sizeof(float3),
+            Texture::Format::RGB, Texture::Type::FLOAT);
+
+    bool called = false;
+    texture->generatePrefilterMipmapAsync(*engine, std::move(buffer),
+            Texture::FaceOffsets{ size * size * sizeof(float3) }, nullptr, nullptr,
+            [&called](Texture*) { called = true; });
+
+    // destroying the texture waits for the job, and the callback is never called
+    engine->destroy(downcast(texture));
+    engine->prepare();
+    EXPECT_FALSE(called);
+
+    Engine::destroy((Engine **)&engine);
+}
+
+TEST(FilamentTest, StereoscopicCullingFrustum) {
+    using namespace filament;
+
+    FEngine* engine = downcast(Engine::create());
+    ASSERT_EQ(engine->getConfig().stereoscopicEyeCount, 2);
+
+    Entity const entity = EntityManager::get().create();
+    FCamera* const camera = downcast(engine->createCamera(entity));
+
+    // two eyes with a 90 degrees field of view, each turned 30 degrees outwards
+    mat4 const projections[2] = {
+            Camera::projection(Camera::Fov::HORIZONTAL, 90.0, 1.0, 0.1, 100.0),
+            Camera::projection(Camera::Fov::HORIZONTAL, 90.0, 1.0, 0.1, 100.0) };
+    camera->setCustomEyeProjection(projections, 2, 0.1, 100.0);
+    camera->setEyeModelMatrix(0,
+            mat4::translation(double3{ -1, 0, 0 }) * mat4::rotation(F_PI / 6, double3{ 0, 1, 0 }));
+    camera->setEyeModelMatrix(1,
+            mat4::translation(double3{  1, 0, 0 }) * mat4::rotation(-F_PI / 6, double3{ 0, 1, 0 }));
+
+    Frustum const frustum = camera->getCullingFrustum();
+
+    // only visible from the left eye, outside the head's 90 degrees field of view
+    EXPECT_LT(frustum.contains(float3{ -50, 0, -20 }), 0.0f);
+    // only visible from the right eye
+    EXPECT_LT(frustum.contains(float3{  50, 0, -20 }), 0.0f);
+    // in front of both eyes
+    EXPECT_LT(frustum.contains(float3{   0, 0, -50 }), 0.0f);
+    // behind the head, beyond the far plane, or out of the vertical field of view
+    EXPECT_GT(frustum.contains(float3{   0, 0,  10 }), 0.0f);
+    EXPECT_GT(frustum.contains(float3{   0, 0, -200 }), 0.0f);
+    EXPECT_GT(frustum.contains(float3{   0, 100, -20 }), 0.0f);
+
+    engine->destroyCameraComponent(entity);
+    EntityManager::get().destroy(entity);
+    Engine::destroy((Engine **)&engine);
+}
+
+TEST(FilamentTest, ScenePrepareDeadEntity) {
+    using namespace filament;
+
+    FEngine* engine = downcast(Engine::create());
+    EntityManager& em = engine->getEntityManager();
+    LinearAllocatorArena arena("FScene: prepare", 1024 * 1024);
+
+    VertexBuffer* const vb = VertexBuffer::Builder()
+            .vertexCount(3)
+            .bufferCount(1)
+            .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::FLOAT3)
+            .build(*engine);
+    IndexBuffer* const ib = IndexBuffer::Builder()
+            .indexCount(3)
+            .bufferType(IndexBuffer::IndexType::USHORT)
+            .build(*engine);
+
+    Entity renderables[2];
+    em.create(2, renderables);
+    for (Entity const e : renderables) {
+        RenderableManager::Builder(1)
+                .boundingBox({{ -1, -1, -1 }, { 1, 1, 1 }})
+                .geometry(0, RenderableManager::PrimitiveType::TRIANGLES, vb, ib)
+                .build(*engine, e);
+    }
+    Entity lights[3];
+    em.create(3, lights);
+    LightManager::Builder(LightManager::Type::POINT).build(*engine, lights[0]);
+    LightManager::Builder(LightManager::Type::POINT).build(*engine, lights[1]);
+    LightManager::Builder(LightManager::Type::SUN).build(*engine, lights[2]);
+
+    Scene* const s = engine->createScene();
+    s->addEntities(renderables, 2);
+    s->addEntities(lights, 3);
+    FScene* const scene = downcast(s);
+
+    auto const prepare = [&]() {
+        RootArenaScope scope(arena);
+        scene->prepare(engine->getJobSystem(), scope, mat4{}, false);
+    };
+
+    // the second prepare() is incremental
+    prepare();
+    prepare();
+    EXPECT_EQ(scene->getRenderableData().size(), 2);
+    EXPECT_EQ(scene->getLightData().size(), 2 + FScene::DIRECTIONAL_LIGHTS_COUNT);
+
+    // the dead renderable makes prepare() fall back to gathering everything, once
+    em.destroy(renderables[1]);
+    prepare();
+    EXPECT_EQ(scene->getRenderableData().size(), 1);
+    EXPECT_EQ(scene->getLightData().size(), 2 + FScene::DIRECTIONAL_LIGHTS_COUNT);
+
+    engine->destroy(scene);
+    engine->getRenderableManager().destroy(renderables[0]);
+    engine->getRenderableManager().destroy(renderables[1]);
+    for (Entity const e : lights) {
+        engine->getLightManager().destroy(e);
+    }
+    em.destroy(renderables[0]);
+    em.destroy(3, lights);
+    engine->destroy(downcast(vb));
+    engine->destroy(downcast(ib));
+    Engine::destroy((Engine **)&engine);
+}
+
 TEST(FilamentTest, GoogleLineDirective) {
     {
         char s[512] = "#line 10 \"foobar\"";
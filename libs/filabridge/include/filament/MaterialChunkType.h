@@ -71,6 +71,7 @@ enum UTILS_PUBLIC ChunkType : uint64_t {
     MaterialClearCoatIorChange = charTo64bitNum("MAT_CIOR"),
     MaterialDomain = charTo64bitNum("MAT_DOMN"),
     MaterialVariantFilterMask = charTo64bitNum("MAT_VFLT"),
+    MaterialSpecializedVariants = charTo64bitNum("MAT_SPVA"),
     MaterialRefraction = charTo64bitNum("MAT_REFM"),
     MaterialRefractionType = charTo64bitNum("MAT_REFT"),
     MaterialReflectionMode = charTo64bitNum("MAT_REFL"),
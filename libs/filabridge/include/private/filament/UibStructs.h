@@ -58,6 +58,13 @@ struct mat44 : public std::array<vec4, 4> {
         }
         return *this;
     }
+    math::mat4f toMat4f() const noexcept {
+        math::mat4f m;
+        for (int i = 0; i < 4; i++) {
+            m[i] = { (*this)[i][0], (*this)[i][1], (*this)[i][2], (*this)[i][3] };
+        }
+        return m;
+    }
 };
 
 } // std140
@@ -220,8 +227,10 @@ struct PerRenderableData {
     int32_t objectId;                        // used for picking
     // TODO: We need a better solution, this currently holds the average local scale for the renderable
     float userData;
+    // worldFromModelMatrix at the previous Scene::prepare(), for computing motion vectors
+    std140::mat44 previousWorldFromModelMatrix;
 
-    math::float4 reserved[8];
+    math::float4 reserved[4];
 
     static uint32_t packFlagsChannels(
             bool skinning, bool morphing, bool contactShadows, bool hasInstanceBuffer,
@@ -19,12 +19,35 @@
 
 #include <filaflat/ChunkContainer.h>
 
+#include <utils/FixedCapacityVector.h>
+
+#include <stddef.h>
+
 namespace filaflat {
 
 struct DictionaryReader {
     static bool unflatten(ChunkContainer const& container,
             ChunkContainer::Type dictionaryTag,
             BlobDictionary& dictionary);
+
+    // Location of a binary blob inside its dictionary chunk, it points into the container's data.
+    struct Blob {
+        const char* data = nullptr;
+        size_t size = 0;
+    };
+
+    using BlobList = utils::FixedCapacityVector<Blob>;
+
+    // Like unflatten(), but SPIR-V and Metal library blobs are not decoded. `dictionary` is filled
+    // with empty entries and `blobs` with the location of each of them, decode() must be called
+    // on an entry before it's used. Text dictionaries don't support this and return false.
+    static bool unflattenDeferred(ChunkContainer const& container,
+            ChunkContainer::Type dictionaryTag,
+            BlobDictionary& dictionary, BlobList& blobs);
+
+    // Decodes one blob found by unflattenDeferred() into `content`.
+    static bool decode(ChunkContainer::Type dictionaryTag, Blob const& blob,
+            ShaderContent& content);
 };
 
 } // namespace filaflat
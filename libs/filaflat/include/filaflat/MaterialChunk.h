@@ -56,6 +56,11 @@ public:
 
     bool hasShader(ShaderModel model, Variant variant, ShaderStage stage) const noexcept;
 
+    // For binary materials (SPIR-V and Metal libraries), returns the index of the requested
+    // shader in the dictionary, or false if there is no such shader.
+    bool getBlobIndex(ShaderModel model, Variant variant, ShaderStage stage,
+            uint32_t* index) const noexcept;
+
     // These methods are for debugging purposes only (matdbg)
     // @{
     static void decodeKey(uint32_t key,
@@ -24,7 +24,10 @@
 #include <smolv.h>
 #endif
 
+#include <utility>
+
 #include <assert.h>
+#include <string.h>
 
 using namespace filamat;
 
@@ -37,64 +40,16 @@ bool DictionaryReader::unflatten(ChunkContainer const& container,
     auto [start, end] = container.getChunkRange(dictionaryTag);
     Unflattener unflattener(start, end);
 
-    if (dictionaryTag == ChunkType::DictionarySpirv) {
-        uint32_t compressionScheme;
-        if (!unflattener.read(&compressionScheme)) {
-            return false;
-        }
-        // For now, 1 is the only acceptable compression scheme.
-        assert(compressionScheme == 1);
-
-        uint32_t blobCount;
-        if (!unflattener.read(&blobCount)) {
-            return false;
-        }
-
-        dictionary.reserve(blobCount);
-        for (uint32_t i = 0; i < blobCount; i++) {
-            unflattener.skipAlignmentPadding();
-
-            const char* compressed;
-            size_t compressedSize;
-            if (!unflattener.read(&compressed, &compressedSize)) {
-                return false;
-            }
-
-            assert_invariant((intptr_t(compressed) % 8) == 0);
-
-#if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
-            size_t spirvSize = smolv::GetDecodedBufferSize(compressed, compressedSize);
-            if (spirvSize == 0) {
-                return false;
-            }
-            ShaderContent spirv(spirvSize);
-            if (!smolv::Decode(compressed, compressedSize, spirv.data(), spirvSize)) {
-                return false;
-            }
-            dictionary.emplace_back(std::move(spirv));
-#else
-            return false;
-#endif
-
-        }
-        return true;
-    } else if (dictionaryTag == ChunkType::DictionaryMetalLibrary) {
-        uint32_t blobCount;
-        if (!unflattener.read(&blobCount)) {
+    if (dictionaryTag == ChunkType::DictionarySpirv ||
+            dictionaryTag == ChunkType::DictionaryMetalLibrary) {
+        BlobList blobs;
+        if (!unflattenDeferred(container, dictionaryTag, dictionary, blobs)) {
             return false;
         }
-
-        dictionary.reserve(blobCount);
-        for (uint32_t i = 0; i < blobCount; i++) {
-            unflattener.skipAlignmentPadding();
-
-            const char* data;
-            size_t dataSize;
-            if (!unflattener.read(&data, &dataSize)) {
+        for (size_t i = 0, c = blobs.size(); i < c; i++) {
+            if (!decode(dictionaryTag, blobs[i], dictionary[i])) {
                 return false;
             }
-            dictionary.emplace_back(dataSize);
-            memcpy(dictionary.back().data(), data, dictionary.back().size());
         }
         return true;
     } else if (dictionaryTag == ChunkType::DictionaryText) {
@@ -120,4 +75,70 @@ bool DictionaryReader::unflatten(ChunkContainer const& container,
     return false;
 }
 
+bool DictionaryReader::unflattenDeferred(ChunkContainer const& container,
+        ChunkContainer::Type dictionaryTag,
+        BlobDictionary& dictionary, BlobList& blobs) {
+
+    auto [start, end] = container.getChunkRange(dictionaryTag);
+    Unflattener unflattener(start, end);
+
+    if (dictionaryTag == ChunkType::DictionarySpirv) {
+        uint32_t compressionScheme;
+        if (!unflattener.read(&compressionScheme)) {
+            return false;
+        }
+        // For now, 1 is the only acceptable compression scheme.
+        assert(compressionScheme == 1);
+    } else if (dictionaryTag != ChunkType::DictionaryMetalLibrary) {
+        return false;
+    }
+
+    uint32_t blobCount;
+    if (!unflattener.read(&blobCount)) {
+        return false;
+    }
+
+    blobs = BlobList::with_capacity(blobCount);
+    for (uint32_t i = 0; i < blobCount; i++) {
+        unflattener.skipAlignmentPadding();
+
+        Blob blob;
+        if (!unflattener.read(&blob.data, &blob.size)) {
+            return false;
+        }
+
+        assert_invariant((intptr_t(blob.data) % 8) == 0);
+
+        blobs.push_back(blob);
+    }
+
+    dictionary = BlobDictionary(blobCount);
+    return true;
+}
+
+bool DictionaryReader::decode(ChunkContainer::Type dictionaryTag, Blob const& blob,
+        ShaderContent& content) {
+    if (dictionaryTag == ChunkType::DictionarySpirv) {
+#if defined (FILAMENT_DRIVER_SUPPORTS_VULKAN)
+        size_t spirvSize = smolv::GetDecodedBufferSize(blob.data, blob.size);
+        if (spirvSize == 0) {
+            return false;
+        }
+        ShaderContent spirv(spirvSize);
+        if (!smolv::Decode(blob.data, blob.size, spirv.data(), spirvSize)) {
+            return false;
+        }
+        content = std::move(spirv);
+        return true;
+#else
+        return false;
+#endif
+    } else if (dictionaryTag == ChunkType::DictionaryMetalLibrary) {
+        content = ShaderContent(blob.size);
+        memcpy(content.data(), blob.data, blob.size);
+        return true;
+    }
+    return false;
+}
+
 } // namespace filaflat
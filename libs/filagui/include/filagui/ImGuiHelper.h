@@ -74,11 +74,9 @@ public:
     filament::View* getView() const { return mView; }
 
   private:
-      void createBuffers(int numRequiredBuffers);
-      void populateVertexData(size_t bufferIndex, size_t vbSizeInBytes, void* vbData,
-                  size_t ibSizeInBytes, void* ibData);
-      void createVertexBuffer(size_t bufferIndex, size_t capacity);
-      void createIndexBuffer(size_t bufferIndex, size_t capacity);
+      void populateVertexData(ImDrawData* commands);
+      void createVertexBuffer(size_t capacity);
+      void createIndexBuffer(size_t capacity);
       void syncThreads();
       filament::Engine* mEngine;
       filament::View* mView; // The view is owned by the client.
@@ -90,9 +88,10 @@ public:
       std::vector<filament::MaterialInstance*> mMaterialExternalInstances;
 #endif
       filament::Camera* mCamera = nullptr;
-      std::vector<filament::VertexBuffer*> mVertexBuffers;
-      std::vector<filament::IndexBuffer*> mIndexBuffers;
+      filament::VertexBuffer* mVertexBuffer = nullptr;
+      filament::IndexBuffer* mIndexBuffer = nullptr;
       utils::Entity mRenderable;
+      size_t mPrimitiveCount = 0;
       utils::Entity mCameraEntity;
       filament::Texture* mTexture = nullptr;
       bool mHasSynced = false;
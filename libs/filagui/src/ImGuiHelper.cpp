@@ -16,8 +16,9 @@
 
 #include <filagui/ImGuiHelper.h>
 
+#include <algorithm>
+#include <optional>
 #include <vector>
-#include <unordered_map>
 
 #include <imgui.h>
 
@@ -141,12 +142,8 @@ ImGuiHelper::~ImGuiHelper() {
     mEngine->destroy(mMaterialExternal);
 #endif
     mEngine->destroy(mTexture);
-    for (auto& vb : mVertexBuffers) {
-        mEngine->destroy(vb);
-    }
-    for (auto& ib : mIndexBuffers) {
-        mEngine->destroy(ib);
-    }
+    mEngine->destroy(mVertexBuffer);
+    mEngine->destroy(mIndexBuffer);
 
     EntityManager& em = utils::EntityManager::get();
     em.destroy(mRenderable);
@@ -200,30 +197,40 @@ void ImGuiHelper::processImGuiCommands(ImDrawData* commands, const ImGuiIO& io)
         return;
     commands->ScaleClipRects(io.DisplayFramebufferScale);
 
-    // Ensure that we have enough vertex buffers and index buffers.
-    createBuffers(commands->CmdListsCount);
-
-    // Count how many primitives we'll need, then create a Renderable builder.
+    // Count how many primitives we'll need.
     size_t nPrims = 0;
-    std::unordered_map<uint64_t, filament::MaterialInstance*> scissorRects;
     for (int cmdListIndex = 0; cmdListIndex < commands->CmdListsCount; cmdListIndex++) {
         const ImDrawList* cmds = commands->CmdLists[cmdListIndex];
-        nPrims += cmds->CmdBuffer.size();
+        for (const auto& pcmd : cmds->CmdBuffer) {
+            nPrims += pcmd.UserCallback ? 0 : 1;
+        }
     }
-    auto rbuilder = RenderableManager::Builder(nPrims);
-    rbuilder.boundingBox({{ 0, 0, 0 }, { 10000, 10000, 10000 }}).culling(false);
 
-    // Recreate the Renderable component and point it to the vertex buffers.
-    rcm.destroy(mRenderable);
-    int bufferIndex = 0;
+    // All the draw lists share one vertex buffer and one index buffer, which are uploaded at once.
+    populateVertexData(commands);
+
+    // The Renderable component is only rebuilt when the number of primitives changes, otherwise
+    // its primitives are updated in place.
+    std::optional<RenderableManager::Builder> rbuilder;
+    if (nPrims != mPrimitiveCount) {
+        rcm.destroy(mRenderable);
+        mPrimitiveCount = nPrims;
+        if (nPrims == 0) {
+            return;
+        }
+        rbuilder.emplace(nPrims);
+        rbuilder->boundingBox({{ 0, 0, 0 }, { 10000, 10000, 10000 }}).culling(false);
+    } else if (nPrims == 0) {
+        return;
+    }
+    auto const instance = rcm.getInstance(mRenderable);
+
+    size_t indexOffset = 0;
     int primIndex = 0;
     int material2dIndex = 0;
     int materialExternalIndex = 0;
     for (int cmdListIndex = 0; cmdListIndex < commands->CmdListsCount; cmdListIndex++) {
         const ImDrawList* cmds = commands->CmdLists[cmdListIndex];
-        populateVertexData(bufferIndex,
-                cmds->VtxBuffer.Size * sizeof(ImDrawVert), cmds->VtxBuffer.Data,
-                cmds->IdxBuffer.Size * sizeof(ImDrawIdx), cmds->IdxBuffer.Data);
         for (const auto& pcmd : cmds->CmdBuffer) {
             if (pcmd.UserCallback) {
                 pcmd.UserCallback(cmds, &pcmd);
@@ -255,26 +262,33 @@ void ImGuiHelper::processImGuiCommands(ImDrawData* commands, const ImGuiIO& io)
                 } else {
                     materialInstance->setParameter("albedo", mTexture, mSampler);
                 }
-                rbuilder
-                        .geometry(primIndex, RenderableManager::PrimitiveType::TRIANGLES,
-                                mVertexBuffers[bufferIndex], mIndexBuffers[bufferIndex],
-                                pcmd.IdxOffset, pcmd.ElemCount)
-                        .blendOrder(primIndex, primIndex)
-                        .material(primIndex, materialInstance);
+                if (rbuilder) {
+                    rbuilder->geometry(primIndex, RenderableManager::PrimitiveType::TRIANGLES,
+                                    mVertexBuffer, mIndexBuffer,
+                                    indexOffset + pcmd.IdxOffset, pcmd.ElemCount)
+                            .blendOrder(primIndex, primIndex)
+                            .material(primIndex, materialInstance);
+                } else {
+                    rcm.setGeometryAt(instance, primIndex,
+                            RenderableManager::PrimitiveType::TRIANGLES,
+                            mVertexBuffer, mIndexBuffer,
+                            indexOffset + pcmd.IdxOffset, pcmd.ElemCount);
+                    rcm.setMaterialInstanceAt(instance, primIndex, materialInstance);
+                }
                 primIndex++;
             }
         }
-        bufferIndex++;
+        indexOffset += cmds->IdxBuffer.Size;
     }
-    if (commands->CmdListsCount > 0) {
-        rbuilder.build(*mEngine, mRenderable);
+    if (rbuilder) {
+        rbuilder->build(*mEngine, mRenderable);
     }
 }
 
-void ImGuiHelper::createVertexBuffer(size_t bufferIndex, size_t capacity) {
+void ImGuiHelper::createVertexBuffer(size_t capacity) {
     syncThreads();
-    mEngine->destroy(mVertexBuffers[bufferIndex]);
-    mVertexBuffers[bufferIndex] = VertexBuffer::Builder()
+    mEngine->destroy(mVertexBuffer);
+    mVertexBuffer = VertexBuffer::Builder()
             .vertexCount(capacity)
             .bufferCount(1)
             .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::FLOAT2, 0,
@@ -287,75 +301,64 @@ void ImGuiHelper::createVertexBuffer(size_t bufferIndex, size_t capacity) {
             .build(*mEngine);
 }
 
-void ImGuiHelper::createIndexBuffer(size_t bufferIndex, size_t capacity) {
+void ImGuiHelper::createIndexBuffer(size_t capacity) {
     syncThreads();
-    mEngine->destroy(mIndexBuffers[bufferIndex]);
-    mIndexBuffers[bufferIndex] = IndexBuffer::Builder()
+    mEngine->destroy(mIndexBuffer);
+    mIndexBuffer = IndexBuffer::Builder()
             .indexCount(capacity)
-            .bufferType(IndexBuffer::IndexType::USHORT)
+            .bufferType(IndexBuffer::IndexType::UINT)
             .build(*mEngine);
 }
 
-void ImGuiHelper::createBuffers(int numRequiredBuffers) {
-    if (numRequiredBuffers > mVertexBuffers.size()) {
-        size_t previousSize = mVertexBuffers.size();
-        mVertexBuffers.resize(numRequiredBuffers, nullptr);
-        for (size_t i = previousSize; i < mVertexBuffers.size(); i++) {
-            // Pick a reasonable starting capacity; it will grow if needed.
-            createVertexBuffer(i, 1000);
-        }
+void ImGuiHelper::populateVertexData(ImDrawData* commands) {
+    size_t const vertexCount = commands->TotalVtxCount;
+    size_t const indexCount = commands->TotalIdxCount;
+
+    // Grow the buffers geometrically, so that they are rarely recreated.
+    if (!mVertexBuffer || vertexCount > mVertexBuffer->getVertexCount()) {
+        createVertexBuffer(std::max(vertexCount, mVertexBuffer ?
+                mVertexBuffer->getVertexCount() * 2 : size_t(4000)));
     }
-    if (numRequiredBuffers > mIndexBuffers.size()) {
-        size_t previousSize = mIndexBuffers.size();
-        mIndexBuffers.resize(numRequiredBuffers, nullptr);
-        for (size_t i = previousSize; i < mIndexBuffers.size(); i++) {
-            // Pick a reasonable starting capacity; it will grow if needed.
-            createIndexBuffer(i, 5000);
-        }
+    if (!mIndexBuffer || indexCount > mIndexBuffer->getIndexCount()) {
+        createIndexBuffer(std::max(indexCount, mIndexBuffer ?
+                mIndexBuffer->getIndexCount() * 2 : size_t(20000)));
     }
-}
-
-void ImGuiHelper::populateVertexData(size_t bufferIndex, size_t vbSizeInBytes, void* vbImguiData,
-        size_t ibSizeInBytes, void* ibImguiData)
-{
-    // Create a new vertex buffer if the size isn't large enough, then copy the ImGui data into
-    // a staging area since Filament's render thread might consume the data at any time.
-    size_t requiredVertCount = vbSizeInBytes / sizeof(ImDrawVert);
-    size_t capacityVertCount = mVertexBuffers[bufferIndex]->getVertexCount();
-    if (requiredVertCount > capacityVertCount) {
-        createVertexBuffer(bufferIndex, requiredVertCount);
+    if (vertexCount == 0 || indexCount == 0) {
+        return;
     }
-    size_t nVbBytes = requiredVertCount * sizeof(ImDrawVert);
-    void* vbFilamentData = malloc(nVbBytes);
-    memcpy(vbFilamentData, vbImguiData, nVbBytes);
-    mVertexBuffers[bufferIndex]->setBufferAt(*mEngine, 0,
-            VertexBuffer::BufferDescriptor(vbFilamentData, nVbBytes,
-                [](void* buffer, size_t size, void* user) {
-                    free(buffer);
-                }, /* user = */ nullptr));
-
-    // Create a new index buffer if the size isn't large enough, then copy the ImGui data into
-    // a staging area since Filament's render thread might consume the data at any time.
-    size_t requiredIndexCount = ibSizeInBytes / 2;
-    size_t capacityIndexCount = mIndexBuffers[bufferIndex]->getIndexCount();
-    if (requiredIndexCount > capacityIndexCount) {
-        createIndexBuffer(bufferIndex, requiredIndexCount);
+
+    // Copy the ImGui data into a staging area since Filament's render thread might consume the
+    // data at any time. ImGui's indices are relative to their own draw list, so they are rebased
+    // onto the shared vertex buffer, which requires 32-bit indices.
+    size_t const nVbBytes = vertexCount * sizeof(ImDrawVert);
+    size_t const nIbBytes = indexCount * sizeof(uint32_t);
+    ImDrawVert* const vbFilamentData = (ImDrawVert*)malloc(nVbBytes);
+    uint32_t* const ibFilamentData = (uint32_t*)malloc(nIbBytes);
+    ImDrawVert* vertices = vbFilamentData;
+    uint32_t* indices = ibFilamentData;
+    uint32_t vertexOffset = 0;
+    for (int cmdListIndex = 0; cmdListIndex < commands->CmdListsCount; cmdListIndex++) {
+        const ImDrawList* cmds = commands->CmdLists[cmdListIndex];
+        memcpy(vertices, cmds->VtxBuffer.Data, cmds->VtxBuffer.Size * sizeof(ImDrawVert));
+        for (ImDrawIdx index : cmds->IdxBuffer) {
+            *indices++ = vertexOffset + index;
+        }
+        vertices += cmds->VtxBuffer.Size;
+        vertexOffset += cmds->VtxBuffer.Size;
     }
-    size_t nIbBytes = requiredIndexCount * 2;
-    void* ibFilamentData = malloc(nIbBytes);
-    memcpy(ibFilamentData, ibImguiData, nIbBytes);
-    mIndexBuffers[bufferIndex]->setBuffer(*mEngine,
-            IndexBuffer::BufferDescriptor(ibFilamentData, nIbBytes,
-                [](void* buffer, size_t size, void* user) {
-                    free(buffer);
-                }, /* user = */ nullptr));
+
+    auto const freeCallback = [](void* buffer, size_t size, void* user) { free(buffer); };
+    mVertexBuffer->setBufferAt(*mEngine, 0,
+            VertexBuffer::BufferDescriptor(vbFilamentData, nVbBytes, freeCallback, nullptr));
+    mIndexBuffer->setBuffer(*mEngine,
+            IndexBuffer::BufferDescriptor(ibFilamentData, nIbBytes, freeCallback, nullptr));
 }
 
 void ImGuiHelper::syncThreads() {
 #if UTILS_HAS_THREADING
     if (!mHasSynced) {
-        // This is called only when ImGui needs to grow a vertex buffer, which occurs a few times
-        // after launching and rarely (if ever) after that.
+        // This is called only when ImGui needs to grow the vertex or index buffer, which occurs a
+        // few times after launching and rarely (if ever) after that.
         Fence::waitAndDestroy(mEngine->createFence());
         mHasSynced = true;
     }
@@ -134,6 +134,7 @@ protected:
     TargetApi mTargetApi = (TargetApi) 0;
     Optimization mOptimization = Optimization::PERFORMANCE;
     bool mPrintShaders = false;
+    bool mPrintShaderCost = false;
     bool mSaveRawVariants = false;
     bool mGenerateDebugInfo = false;
     bool mIncludeEssl1 = true;
@@ -590,6 +591,9 @@ public:
     //! If true, will output the generated GLSL shader code to stdout.
     MaterialBuilder& printShaders(bool printShaders) noexcept;
 
+    //! If true, will output the static cost (instruction counts) of each Vulkan shader variant.
+    MaterialBuilder& printShaderCost(bool printShaderCost) noexcept;
+
     /**
      * If true, this will write the raw generated GLSL for each variant to a text file in the
      * current directory. The file will be named after the material name and the variant name. Its
@@ -601,9 +605,24 @@ public:
     //! If true, will include debugging information in generated SPIRV.
     MaterialBuilder& generateDebugInfo(bool generateDebugInfo) noexcept;
 
+    /**
+     * Caches the compiled shaders in the given directory, which must exist. A shader is only
+     * compiled again when its generated source or its compilation settings change, which makes
+     * rebuilding many materials much faster. The directory can be shared by several materials
+     * and by several processes building materials at the same time.
+     */
+    MaterialBuilder& shaderCacheDirectory(const char* directory) noexcept;
+
     //! Specifies a list of variants that should be filtered out during code generation.
     MaterialBuilder& variantFilter(filament::UserVariantFilterMask variantFilter) noexcept;
 
+    /**
+     * Specifies a list of variants that are selected with a specialization constant instead of
+     * being compiled into separate shaders, a single shader then serves both the variant and the
+     * variant without it. Only UserVariantFilterBit::FOG is currently supported.
+     */
+    MaterialBuilder& specializedVariants(filament::UserVariantFilterMask variants) noexcept;
+
     //! Adds a new preprocessor macro definition to the shader code. Can be called repeatedly.
     MaterialBuilder& shaderDefine(const char* name, const char* value) noexcept;
 
@@ -761,6 +780,8 @@ public:
 
     filament::UserVariantFilterMask getVariantFilter() const { return mVariantFilter; }
 
+    filament::UserVariantFilterMask getSpecializedVariants() const { return mSpecializedVariants; }
+
     FeatureLevel getFeatureLevel() const noexcept { return mFeatureLevel; }
     /// @endcond
 
@@ -826,6 +847,7 @@ private:
 
     utils::CString mMaterialName;
     utils::CString mFileName;
+    utils::CString mShaderCacheDirectory;
 
     class ShaderCode {
     public:
@@ -929,6 +951,8 @@ private:
 
     filament::UserVariantFilterMask mVariantFilter = {};
 
+    filament::UserVariantFilterMask mSpecializedVariants = {};
+
     bool mNoSamplerValidation = false;
 };
 
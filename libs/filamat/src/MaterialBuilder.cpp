@@ -21,6 +21,8 @@
 #include "Includes.h"
 #include "MaterialVariants.h"
 #include "PushConstantDefinitions.h"
+#include "ShaderCache.h"
+#include "ShaderCost.h"
 #include "shaders/SibGenerator.h"
 #include "shaders/UibGenerator.h"
 
@@ -561,6 +563,11 @@ MaterialBuilder& MaterialBuilder::printShaders(bool printShaders) noexcept {
     return *this;
 }
 
+MaterialBuilder& MaterialBuilder::printShaderCost(bool printShaderCost) noexcept {
+    mPrintShaderCost = printShaderCost;
+    return *this;
+}
+
 MaterialBuilder& MaterialBuilder::saveRawVariants(bool saveRawVariants) noexcept {
     mSaveRawVariants = saveRawVariants;
     return *this;
@@ -571,11 +578,21 @@ MaterialBuilder& MaterialBuilder::generateDebugInfo(bool generateDebugInfo) noex
     return *this;
 }
 
+MaterialBuilder& MaterialBuilder::shaderCacheDirectory(const char* directory) noexcept {
+    mShaderCacheDirectory = CString(directory);
+    return *this;
+}
+
 MaterialBuilder& MaterialBuilder::variantFilter(UserVariantFilterMask variantFilter) noexcept {
     mVariantFilter = variantFilter;
     return *this;
 }
 
+MaterialBuilder& MaterialBuilder::specializedVariants(UserVariantFilterMask variants) noexcept {
+    mSpecializedVariants = variants;
+    return *this;
+}
+
 MaterialBuilder& MaterialBuilder::shaderDefine(const char* name, const char* value) noexcept {
     mDefines.emplace_back(name, value);
     return *this;
@@ -677,6 +694,7 @@ void MaterialBuilder::prepareToBuild(MaterialInfo& info) noexcept {
     info.groupSize = mGroupSize;
     info.stereoscopicType = mStereoscopicType;
     info.stereoscopicEyeCount = mStereoscopicEyeCount;
+    info.specializedVariants = mSpecializedVariants;
 
     // This is determined via static analysis of the glsl after prepareToBuild().
     info.userMaterialHasCustomDepth = false;
@@ -844,6 +862,81 @@ static void showErrorMessage(const char* materialName, filament::Variant variant
             << shaderCode;
 }
 
+// Returns a key describing everything the output of GLSLPostProcessor::process() depends on.
+static void printShaderCostReport(const char* materialName,
+        std::vector<BinaryEntry> const& spirvEntries) {
+    if (spirvEntries.empty()) {
+        slog.w << "The shader cost of " << materialName
+               << " can only be estimated when targeting Vulkan." << io::endl;
+        return;
+    }
+    auto const stageName = [](backend::ShaderStage stage) {
+        switch (stage) {
+            case backend::ShaderStage::VERTEX:      return "vertex";
+            case backend::ShaderStage::FRAGMENT:    return "fragment";
+            case backend::ShaderStage::COMPUTE:     return "compute";
+        }
+        return "";
+    };
+    slog.i << "Shader cost of " << materialName << ":" << io::endl;
+    for (auto const& entry : spirvEntries) {
+        ShaderCost cost;
+        if (!estimateShaderCost(reinterpret_cast<uint32_t const*>(entry.data.data()),
+                entry.data.size() / 4, &cost)) {
+            continue;
+        }
+        char variant[8];
+        snprintf(variant, sizeof(variant), "0x%02x", entry.variant.key);
+        slog.i << "    " << (entry.shaderModel == backend::ShaderModel::MOBILE ? "mobile " : "desktop ")
+               << variant << " " << stageName(entry.stage) << ": "
+               << cost.instructionCount << " instructions, "
+               << cost.aluCount << " ALU, "
+               << cost.textureCount << " texture, "
+               << cost.branchCount << " branches, "
+               << cost.loopCount << " loops, "
+               << cost.memoryCount << " loads/stores, "
+               << cost.idBound << " ids" << io::endl;
+    }
+}
+
+static std::string getShaderCacheKey(std::string const& shader,
+        GLSLPostProcessor::Config const& config, MaterialBuilder::Optimization optimization,
+        bool generateDebugInfo) noexcept {
+    std::string key;
+    auto append = [&key](auto const& value) {
+        key.append(reinterpret_cast<char const*>(&value), sizeof(value));
+    };
+    append(MATERIAL_VERSION);
+    append(config.variant.key);
+    append(config.targetApi);
+    append(config.targetLanguage);
+    append(config.shaderType);
+    append(config.shaderModel);
+    append(config.featureLevel);
+    append(config.domain);
+    append(config.hasFramebufferFetch);
+    append(config.usesClipDistance);
+    append(config.materialInfo->stereoscopicType);
+    append(config.materialInfo->stereoscopicEyeCount);
+    append(optimization);
+    append(generateDebugInfo);
+    for (auto const& [input, location] : config.glsl.subpassInputToColorLocation) {
+        append(input);
+        append(location);
+    }
+    // the material's samplers determine the Metal bindings
+    for (auto const& sampler : config.materialInfo->sib.getSamplerInfoList()) {
+        key.append(sampler.name.c_str(), sampler.name.size() + 1);
+        key.append(sampler.uniformName.c_str(), sampler.uniformName.size() + 1);
+        append(sampler.type);
+        append(sampler.format);
+        append(sampler.precision);
+        append(sampler.multisample);
+    }
+    key.append(shader);
+    return key;
+}
+
 bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Variant>& variants,
         ChunkContainer& container, const MaterialInfo& info) const noexcept {
     // Create a postprocessor to optimize / compile to Spir-V if necessary.
@@ -852,6 +945,7 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
     flags |= mPrintShaders ? GLSLPostProcessor::PRINT_SHADERS : 0;
     flags |= mGenerateDebugInfo ? GLSLPostProcessor::GENERATE_DEBUG_INFO : 0;
     GLSLPostProcessor postProcessor(mOptimization, flags);
+    ShaderCache const shaderCache(mShaderCacheDirectory);
 
     // Start: must be protected by lock
     Mutex entriesLock;
@@ -873,9 +967,12 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
     std::atomic_bool cancelJobs(false);
     bool firstJob = true;
 
+    // All the permutations are compiled concurrently, entries are sorted below.
+    JobSystem::Job* parent = jobSystem.createJob();
+
     for (const auto& params : mCodeGenPermutations) {
         if (cancelJobs.load()) {
-            return false;
+            break;
         }
 
         const ShaderModel shaderModel = ShaderModel(params.shaderModel);
@@ -891,11 +988,10 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
         const bool targetApiNeedsMsl = targetApi == TargetApi::METAL;
         const bool targetApiNeedsGlsl = targetApi == TargetApi::OPENGL;
 
-        // Set when a job fails
-        JobSystem::Job* parent = jobSystem.createJob();
-
         for (const auto& v : variants) {
-            JobSystem::Job* job = jobs::createJob(jobSystem, parent, [&]() {
+            JobSystem::Job* job = jobs::createJob(jobSystem, parent, [&, shaderModel, targetApi,
+                    targetLanguage, featureLevel, targetApiNeedsSpirv, targetApiNeedsMsl,
+                    targetApiNeedsGlsl, initializesGlslang = firstJob]() {
                 if (cancelJobs.load()) {
                     return;
                 }
@@ -984,15 +1080,33 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
                     config.glsl.subpassInputToColorLocation.emplace_back(0, 0);
                 }
 
-                bool const ok = postProcessor.process(shader, config, pGlsl, pSpirv, pMsl);
-                if (!ok) {
-                    showErrorMessage(mMaterialName.c_str_safe(), v.variant, targetApi, v.stage,
-                                     featureLevel, shader);
-                    cancelJobs = true;
-                    if (mPrintShaders) {
-                        slog.e << shader << io::endl;
+                std::string cacheKey;
+                ShaderCache::Entry cached;
+                if (shaderCache.isEnabled()) {
+                    cacheKey = getShaderCacheKey(shader, config, mOptimization,
+                            mGenerateDebugInfo);
+                }
+                // the first job must run glslang, see below
+                if (!initializesGlslang && shaderCache.get(cacheKey, &cached)) {
+                    if (pGlsl) {
+                        shader = std::move(cached.glsl);
+                    }
+                    spirv = std::move(cached.spirv);
+                    msl = std::move(cached.msl);
+                } else {
+                    bool const ok = postProcessor.process(shader, config, pGlsl, pSpirv, pMsl);
+                    if (!ok) {
+                        showErrorMessage(mMaterialName.c_str_safe(), v.variant, targetApi,
+                                v.stage, featureLevel, shader);
+                        cancelJobs = true;
+                        if (mPrintShaders) {
+                            slog.e << shader << io::endl;
+                        }
+                        return;
+                    }
+                    if (shaderCache.isEnabled()) {
+                        shaderCache.put(cacheKey, { pGlsl ? shader : std::string{}, spirv, msl });
                     }
-                    return;
                 }
 
                 if (targetApi == TargetApi::OPENGL) {
@@ -1052,10 +1166,10 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
                 jobSystem.run(job);
             }
         }
-
-        jobSystem.runAndWait(parent);
     }
 
+    jobSystem.runAndWait(parent);
+
     if (cancelJobs.load()) {
         return false;
     }
@@ -1073,6 +1187,10 @@ bool MaterialBuilder::generateShaders(JobSystem& jobSystem, const std::vector<Va
     std::sort(spirvEntries.begin(), spirvEntries.end(), compare);
     std::sort(metalEntries.begin(), metalEntries.end(), compare);
 
+    if (mPrintShaderCost) {
+        printShaderCostReport(mMaterialName.c_str_safe(), spirvEntries);
+    }
+
     // Generate the dictionaries.
     for (const auto& s : glslEntries) {
         textDictionary.addText(s.shader);
@@ -1212,6 +1330,17 @@ error:
         goto error;
     }
 
+    if (mSpecializedVariants & ~UserVariantFilterMask(UserVariantFilterBit::FOG)) {
+        slog.e << "Error: only the fog variant can be specialized." << io::endl;
+        goto error;
+    }
+
+    // a variant that is filtered out doesn't need to be specialized
+    if (mMaterialDomain != MaterialDomain::SURFACE) {
+        mSpecializedVariants = {};
+    }
+    mSpecializedVariants &= ~mVariantFilter;
+
     // prepareToBuild must be called first, to populate mCodeGenPermutations.
     MaterialInfo info{};
     prepareToBuild(info);
@@ -1269,7 +1398,9 @@ error:
     std::vector<Variant> variants;
     switch (mMaterialDomain) {
         case MaterialDomain::SURFACE:
-            variants = determineSurfaceVariants(mVariantFilter, isLit(), mShadowMultiplier);
+            // specialized variants are served by the shaders of the variants without them
+            variants = determineSurfaceVariants(mVariantFilter | mSpecializedVariants,
+                    isLit(), mShadowMultiplier);
             break;
         case MaterialDomain::POST_PROCESS:
             variants = determinePostProcessVariants();
@@ -1664,6 +1795,9 @@ void MaterialBuilder::writeSurfaceChunks(ChunkContainer& container) const noexce
     container.emplace<uint8_t>(ChunkType::MaterialVertexDomain, static_cast<uint8_t>(mVertexDomain));
     container.emplace<uint8_t>(ChunkType::MaterialInterpolation,
             static_cast<uint8_t>(mInterpolation));
+    if (mSpecializedVariants) {
+        container.emplace<uint32_t>(ChunkType::MaterialSpecializedVariants, mSpecializedVariants);
+    }
 }
 
 MaterialBuilder& MaterialBuilder::noSamplerValidation(bool enabled) noexcept {
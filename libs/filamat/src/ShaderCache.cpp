@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ShaderCache.h"
+
+#include <utils/Hash.h>
+
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <stdio.h>
+#include <string.h>
+
+namespace filamat {
+
+using namespace utils;
+
+namespace {
+
+struct EntryHeader {
+    char magic[8];
+    uint64_t keySize;
+    uint32_t keyHash;
+    uint32_t glslSize;
+    uint32_t spirvSize;     // in words
+    uint32_t mslSize;
+};
+
+constexpr char MAGIC[8] = { 'F', 'M', 'A', 'T', 'S', 'H', 'C', '1' };
+
+uint32_t hashKey(std::string const& key, uint32_t seed) noexcept {
+    return hash::murmurSlow(reinterpret_cast<uint8_t const*>(key.data()), key.size(), seed);
+}
+
+} // anonymous namespace
+
+ShaderCache::ShaderCache(CString directory) noexcept : mDirectory(std::move(directory)) {
+}
+
+std::string ShaderCache::getPath(std::string const& key) const noexcept {
+    char name[32];
+    snprintf(name, sizeof(name), "%08x%08x.bin", hashKey(key, 0), hashKey(key, 0x9e3779b9u));
+    return std::string(mDirectory.c_str(), mDirectory.size()) + "/" + name;
+}
+
+bool ShaderCache::get(std::string const& key, Entry* entry) const noexcept {
+    if (!isEnabled()) {
+        return false;
+    }
+
+    std::ifstream in(getPath(key), std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    EntryHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header.keySize != key.size() || header.keyHash != hashKey(key, 0x85ebca6bu)) {
+        return false;
+    }
+
+    entry->glsl.resize(header.glslSize);
+    entry->spirv.resize(header.spirvSize);
+    entry->msl.resize(header.mslSize);
+    in.read(entry->glsl.data(), std::streamsize(header.glslSize));
+    in.read(reinterpret_cast<char*>(entry->spirv.data()),
+            std::streamsize(header.spirvSize * sizeof(uint32_t)));
+    in.read(entry->msl.data(), std::streamsize(header.mslSize));
+    return bool(in);
+}
+
+void ShaderCache::put(std::string const& key, Entry const& entry) const noexcept {
+    if (!isEnabled()) {
+        return;
+    }
+
+    EntryHeader header{};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.keySize = key.size();
+    header.keyHash = hashKey(key, 0x85ebca6bu);
+    header.glslSize = uint32_t(entry.glsl.size());
+    header.spirvSize = uint32_t(entry.spirv.size());
+    header.mslSize = uint32_t(entry.msl.size());
+
+    // Write to a temporary file first, so that a concurrent get() never sees a partial entry.
+    // Several threads or processes can be writing the same entry, their temporary files must
+    // have different names.
+    std::string const path = getPath(key);
+    std::string const tmp = path + "." + std::to_string(std::random_device{}()) + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return;
+        }
+        out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        out.write(entry.glsl.data(), std::streamsize(entry.glsl.size()));
+        out.write(reinterpret_cast<char const*>(entry.spirv.data()),
+                std::streamsize(entry.spirv.size() * sizeof(uint32_t)));
+        out.write(entry.msl.data(), std::streamsize(entry.msl.size()));
+        if (!out) {
+            out.close();
+            remove(tmp.c_str());
+            return;
+        }
+    }
+    if (rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+    }
+}
+
+} // namespace filamat
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMAT_SHADERCACHE_H
+#define TNT_FILAMAT_SHADERCACHE_H
+
+#include <utils/CString.h>
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace filamat {
+
+// On-disk cache of the output of GLSLPostProcessor, so that shaders whose generated source and
+// compilation settings didn't change since the last build are not compiled again.
+//
+// The key must describe everything the output depends on, including the generated source. Each
+// entry is stored in its own file named after a hash of the key, which makes the cache safe to
+// use from several threads, and several processes, at once.
+class ShaderCache {
+public:
+    struct Entry {
+        std::string glsl;
+        std::vector<uint32_t> spirv;
+        std::string msl;
+    };
+
+    explicit ShaderCache(utils::CString directory) noexcept;
+
+    bool isEnabled() const noexcept { return !mDirectory.empty(); }
+
+    // Returns false if there is no entry for this key.
+    bool get(std::string const& key, Entry* entry) const noexcept;
+
+    // Failures are ignored, the shader will simply be compiled again next time.
+    void put(std::string const& key, Entry const& entry) const noexcept;
+
+private:
+    std::string getPath(std::string const& key) const noexcept;
+    utils::CString mDirectory;
+};
+
+} // namespace filamat
+
+#endif // TNT_FILAMAT_SHADERCACHE_H
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ShaderCost.h"
+
+#include <spirv.hpp>
+
+namespace filamat {
+
+bool estimateShaderCost(uint32_t const* spirv, size_t wordCount, ShaderCost* outCost) noexcept {
+    constexpr size_t HEADER_SIZE = 5;
+    if (wordCount < HEADER_SIZE || spirv[0] != spv::MagicNumber) {
+        return false;
+    }
+
+    ShaderCost cost;
+    cost.idBound = spirv[3];
+
+    bool inFunction = false;
+    for (size_t i = HEADER_SIZE; i < wordCount;) {
+        uint32_t const instructionSize = spirv[i] >> spv::WordCountShift;
+        auto const op = spv::Op(spirv[i] & spv::OpCodeMask);
+        if (instructionSize == 0 || i + instructionSize > wordCount) {
+            return false;
+        }
+        i += instructionSize;
+
+        if (op == spv::OpFunction) {
+            inFunction = true;
+            continue;
+        }
+        if (op == spv::OpFunctionEnd) {
+            inFunction = false;
+            continue;
+        }
+        if (!inFunction || op == spv::OpLabel || op == spv::OpFunctionParameter ||
+                op == spv::OpLine || op == spv::OpNoLine) {
+            continue;
+        }
+
+        cost.instructionCount++;
+        switch (op) {
+            case spv::OpImageSampleImplicitLod:
+            case spv::OpImageSampleExplicitLod:
+            case spv::OpImageSampleDrefImplicitLod:
+            case spv::OpImageSampleDrefExplicitLod:
+            case spv::OpImageSampleProjImplicitLod:
+            case spv::OpImageSampleProjExplicitLod:
+            case spv::OpImageSampleProjDrefImplicitLod:
+            case spv::OpImageSampleProjDrefExplicitLod:
+            case spv::OpImageFetch:
+            case spv::OpImageGather:
+            case spv::OpImageDrefGather:
+            case spv::OpImageRead:
+            case spv::OpImageSparseSampleImplicitLod:
+            case spv::OpImageSparseSampleExplicitLod:
+            case spv::OpImageSparseSampleDrefImplicitLod:
+            case spv::OpImageSparseSampleDrefExplicitLod:
+            case spv::OpImageSparseSampleProjImplicitLod:
+            case spv::OpImageSparseSampleProjExplicitLod:
+            case spv::OpImageSparseSampleProjDrefImplicitLod:
+            case spv::OpImageSparseSampleProjDrefExplicitLod:
+            case spv::OpImageSparseFetch:
+            case spv::OpImageSparseGather:
+            case spv::OpImageSparseDrefGather:
+            case spv::OpImageSparseRead:
+                cost.textureCount++;
+                break;
+            case spv::OpBranchConditional:
+            case spv::OpSwitch:
+                cost.branchCount++;
+                break;
+            case spv::OpLoopMerge:
+                cost.loopCount++;
+                break;
+            case spv::OpLoad:
+            case spv::OpStore:
+                cost.memoryCount++;
+                break;
+            case spv::OpExtInst:
+                cost.aluCount++;
+                break;
+            default:
+                // conversions, then arithmetic, bit, relational, logical and derivative
+                // instructions are in two contiguous ranges of opcodes
+                if ((op >= spv::OpConvertFToU && op <= spv::OpBitcast) ||
+                        (op >= spv::OpSNegate && op <= spv::OpFwidthCoarse)) {
+                    cost.aluCount++;
+                }
+                break;
+        }
+    }
+
+    *outCost = cost;
+    return true;
+}
+
+} // namespace filamat
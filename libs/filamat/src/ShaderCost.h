@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_SHADERCOST_H
+#define TNT_SHADERCOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filamat {
+
+/**
+ * Static instruction counts of a SPIR-V module, used to compare the cost of shaders offline.
+ *
+ * The counts are those of the instructions in the module, i.e. loops are counted once and
+ * function calls are not followed (the optimizer inlines all functions). They don't account for
+ * the target GPU, but they are a good way to find the heavy variants of a set of materials.
+ */
+struct ShaderCost {
+    //! all instructions inside functions, except labels and debug instructions
+    uint32_t instructionCount = 0;
+    //! arithmetic, logical, conversion and extended (e.g. GLSL.std.450) instructions
+    uint32_t aluCount = 0;
+    //! texture samples, fetches, gathers and image reads
+    uint32_t textureCount = 0;
+    //! conditional branches and switches
+    uint32_t branchCount = 0;
+    //! loops
+    uint32_t loopCount = 0;
+    //! loads and stores
+    uint32_t memoryCount = 0;
+    //! upper bound of the ids used by the module, a rough indication of register pressure
+    uint32_t idBound = 0;
+};
+
+/**
+ * Computes the static cost of a SPIR-V module.
+ *
+ * @param spirv the SPIR-V words
+ * @param wordCount number of words in spirv
+ * @param outCost receives the cost
+ * @return false if spirv isn't a valid SPIR-V module
+ */
+bool estimateShaderCost(uint32_t const* spirv, size_t wordCount, ShaderCost* outCost) noexcept;
+
+} // namespace filamat
+
+#endif  // TNT_SHADERCOST_H
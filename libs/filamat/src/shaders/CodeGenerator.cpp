@@ -335,6 +335,12 @@ utils::io::sstream& CodeGenerator::generateProlog(utils::io::sstream& out, Shade
     generateSpecializationConstant(out, "CONFIG_SH_BANDS_COUNT",
             +ReservedSpecializationConstants::CONFIG_SH_BANDS_COUNT, 3);
 
+    if (material.specializedVariants & UserVariantFilterMask(UserVariantFilterBit::FOG)) {
+        // selects the fog variant, see ShaderGenerator
+        generateSpecializationConstant(out, "CONFIG_VARIANT_FOG",
+                +ReservedSpecializationConstants::CONFIG_VARIANT_FOG, false);
+    }
+
     // CONFIG_MAX_STEREOSCOPIC_EYES is used to size arrays and on Adreno GPUs + vulkan, this has to
     // be explicitly, statically defined (as in #define). Otherwise (using const int for
     // example), we'd run into a GPU crash.
@@ -55,6 +55,7 @@ struct UTILS_PUBLIC MaterialInfo {
     bool vertexDomainDeviceJittered;
     bool userMaterialHasCustomDepth;
     int stereoscopicEyeCount;
+    filament::UserVariantFilterMask specializedVariants;
     filament::SpecularAmbientOcclusion specularAO;
     filament::RefractionMode refractionMode;
     filament::RefractionType refractionType;
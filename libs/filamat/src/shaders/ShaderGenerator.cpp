@@ -37,6 +37,17 @@ using namespace filament;
 using namespace filament::backend;
 using namespace utils;
 
+static bool isFogSpecialized(MaterialInfo const& material) noexcept {
+    return material.specializedVariants & UserVariantFilterMask(UserVariantFilterBit::FOG);
+}
+
+// When the fog variant is specialized, the fog code is in all the color fragment shaders and
+// CONFIG_VARIANT_FOG selects whether it runs.
+static bool hasFog(MaterialInfo const& material, filament::Variant variant) noexcept {
+    return filament::Variant::isFogVariant(variant) ||
+           (isFogSpecialized(material) && !filament::Variant::isValidDepthVariant(variant));
+}
+
 void ShaderGenerator::generateSurfaceMaterialVariantDefines(utils::io::sstream& out,
         ShaderStage stage, MaterialBuilder::FeatureLevel featureLevel,
         MaterialInfo const& material, filament::Variant variant) noexcept {
@@ -60,8 +71,7 @@ void ShaderGenerator::generateSurfaceMaterialVariantDefines(utils::io::sstream&
                 hasSkinningOrMorphing(variant, featureLevel));
             break;
         case ShaderStage::FRAGMENT:
-            CodeGenerator::generateDefine(out, "VARIANT_HAS_FOG",
-                    filament::Variant::isFogVariant(variant));
+            CodeGenerator::generateDefine(out, "VARIANT_HAS_FOG", hasFog(material, variant));
             CodeGenerator::generateDefine(out, "VARIANT_HAS_PICKING",
                     filament::Variant::isPickingVariant(variant));
             CodeGenerator::generateDefine(out, "VARIANT_HAS_SSR",
@@ -594,8 +604,12 @@ std::string ShaderGenerator::createFragmentProgram(ShaderModel shaderModel,
     CodeGenerator::generateCommonMaterial(fs, ShaderStage::FRAGMENT);
     CodeGenerator::generateParameters(fs, ShaderStage::FRAGMENT);
 
-    if (filament::Variant::isFogVariant(variant)) {
+    if (hasFog(material, variant)) {
         CodeGenerator::generateFog(fs, ShaderStage::FRAGMENT);
+        if (isFogSpecialized(material)) {
+            // fog() doesn't expand recursively, so this only guards the call made by main()
+            fs << "#define fog(color, view) (CONFIG_VARIANT_FOG ? fog(color, view) : (color))\n";
+        }
     }
 
     // shading model
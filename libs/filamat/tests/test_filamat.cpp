@@ -891,6 +891,22 @@ TEST_F(MaterialCompiler, FeatureLevel0Ess3CallFails) {
   EXPECT_FALSE(result.isValid());
 }
 
+TEST_F(MaterialCompiler, SpecializedVariantsFog) {
+    filamat::MaterialBuilder builder;
+    builder.specializedVariants(filament::UserVariantFilterMask(
+            filament::UserVariantFilterBit::FOG));
+    filamat::Package result = builder.build(*jobSystem);
+    EXPECT_TRUE(result.isValid());
+}
+
+TEST_F(MaterialCompiler, SpecializedVariantsOnlyFog) {
+    filamat::MaterialBuilder builder;
+    builder.specializedVariants(filament::UserVariantFilterMask(
+            filament::UserVariantFilterBit::SKINNING));
+    filamat::Package result = builder.build(*jobSystem);
+    EXPECT_FALSE(result.isValid());
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ShaderCost.h"
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace {
+
+constexpr uint32_t op(uint32_t opcode, uint32_t wordCount) {
+    return (wordCount << 16u) | opcode;
+}
+
+// The cost only depends on the opcodes, so the operands below are arbitrary.
+std::vector<uint32_t> const spirv = {
+        0x07230203, 0x00010000, 0, 10, 0,   // header, with an id bound of 10
+        op(17, 2), 1,                       // OpCapability Shader
+        op(54, 5), 1, 2, 0, 3,              // OpFunction
+        op(248, 2), 4,                      // OpLabel
+        op(61, 4), 5, 6, 7,                 // OpLoad
+        op(129, 5), 5, 8, 6, 6,             // OpFAdd
+        op(12, 6), 5, 9, 1, 4, 8,           // OpExtInst
+        op(87, 5), 5, 9, 6, 8,              // OpImageSampleImplicitLod
+        op(246, 4), 4, 4, 0,                // OpLoopMerge
+        op(250, 4), 9, 4, 4,                // OpBranchConditional
+        op(253, 1),                         // OpReturn
+        op(56, 1),                          // OpFunctionEnd
+};
+
+} // anonymous namespace
+
+TEST(ShaderCost, Counts) {
+    filamat::ShaderCost cost;
+    EXPECT_TRUE(filamat::estimateShaderCost(spirv.data(), spirv.size(), &cost));
+    EXPECT_EQ(cost.instructionCount, 7);
+    EXPECT_EQ(cost.aluCount, 2);
+    EXPECT_EQ(cost.textureCount, 1);
+    EXPECT_EQ(cost.branchCount, 1);
+    EXPECT_EQ(cost.loopCount, 1);
+    EXPECT_EQ(cost.memoryCount, 1);
+    EXPECT_EQ(cost.idBound, 10);
+}
+
+TEST(ShaderCost, InvalidModule) {
+    filamat::ShaderCost cost;
+    std::vector<uint32_t> invalid = spirv;
+    invalid[0] = 0;
+    EXPECT_FALSE(filamat::estimateShaderCost(invalid.data(), invalid.size(), &cost));
+
+    // truncated in the middle of an instruction
+    EXPECT_FALSE(filamat::estimateShaderCost(spirv.data(), spirv.size() - 3, &cost));
+}
@@ -943,7 +943,7 @@ void FilamentApp::Window::configureCamerasForWindow() {
         // simulate foveated rendering
         projections[2] = Camera::projection(mFilamentApp->mCameraFocalLength * 2.0, 1.0, near, far);
         projections[3] = projections[2];
-        mMainCamera->setCustomEyeProjection(projections, 4, projections[0], near, far);
+        mMainCamera->setCustomEyeProjection(projections, 4, near, far);
     } else {
         mMainCamera->setLensProjection(mFilamentApp->mCameraFocalLength, 1.0, near, far);
     }
@@ -128,15 +128,14 @@ bool IBL::loadFromKtx(const std::string& prefix) {
         return false;
     }
 
-    auto createKtx = [] (Path path) {
-        using namespace std;
-        ifstream file(path.getPath(), ios::binary);
-        vector<uint8_t> contents((istreambuf_iterator<char>(file)), {});
-        return new image::Ktx1Bundle(contents.data(), contents.size());
-    };
-
-    Ktx1Bundle* iblKtx = createKtx(iblPath);
-    Ktx1Bundle* skyKtx = createKtx(skyPath);
+    // The files are mapped, their levels are uploaded straight from the mappings.
+    Ktx1Bundle* iblKtx = Ktx1Reader::createBundleFromFile(iblPath.c_str());
+    Ktx1Bundle* skyKtx = Ktx1Reader::createBundleFromFile(skyPath.c_str());
+    if (!iblKtx || !skyKtx) {
+        delete iblKtx;
+        delete skyKtx;
+        return false;
+    }
 
     mSkyboxTexture = Ktx1Reader::createTexture(&mEngine, skyKtx, false);
     mTexture = Ktx1Reader::createTexture(&mEngine, iblKtx, false);
@@ -89,6 +89,10 @@ public:
      * file cannot be matched to a material in the registry, a default material is
      * used instead. The default material can be overridden by adding a material
      * named "DefaultMaterial" to the registry.
+     *
+     * The file is memory-mapped: uncompressed vertices and indices are uploaded
+     * straight from the mapping, compressed ones are decoded from it. The mapping
+     * is released once the data has been consumed.
      */
     static Mesh loadMeshFromFile(filament::Engine* engine,
             const utils::Path& path,
@@ -37,10 +37,15 @@
 #include <map>
 #include <string>
 
+#include <atomic>
+
 #include <fcntl.h>
 #if !defined(WIN32)
+#    include <sys/mman.h>
 #    include <unistd.h>
 #else
+#    define NOMINMAX
+#    include <windows.h>
 #    include <io.h>
 #endif
 
@@ -157,6 +162,47 @@ static size_t fileSize(int fd) {
     return filesize;
 }
 
+static void* mapFile(int fd, size_t size) {
+#if !defined(WIN32)
+    void* const data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    return data == MAP_FAILED ? nullptr : data;
+#else
+    HANDLE const mapping = CreateFileMappingA((HANDLE) _get_osfhandle(fd), nullptr,
+            PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        return nullptr;
+    }
+    void* const data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    // the view keeps the mapping alive
+    CloseHandle(mapping);
+    return data;
+#endif
+}
+
+static void unmapFile(void* data, size_t size) {
+#if !defined(WIN32)
+    munmap(data, size);
+#else
+    UnmapViewOfFile(data);
+#endif
+}
+
+// The file is mapped rather than read, and the mapping is handed as is to the vertex and index
+// buffers, which each release it once their data has been consumed.
+struct MappedFile {
+    void* address;
+    size_t size;
+    std::atomic<uint32_t> references;
+};
+
+static void releaseMappedFile(void*, size_t, void* user) {
+    MappedFile* file = (MappedFile*) user;
+    if (file->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        unmapFile(file->address, file->size);
+        delete file;
+    }
+}
+
 namespace filamesh {
 
 MeshReader::Mesh MeshReader::loadMeshFromFile(filament::Engine* engine, const utils::Path& path,
@@ -165,25 +211,30 @@ MeshReader::Mesh MeshReader::loadMeshFromFile(filament::Engine* engine, const ut
     Mesh mesh;
 
     int fd = open(path.c_str(), O_RDONLY);
-
-    size_t size = fileSize(fd);
-    char* data = (char*) malloc(size);
-    read(fd, data, size);
-
-    if (data) {
-        char *p = data;
-        char *magic = p;
-        p += sizeof(MAGICID);
-
-        if (!strncmp(MAGICID, magic, 8)) {
-            mesh = loadMeshFromBuffer(engine, data, nullptr, nullptr, materials);
-        }
-
-        Fence::waitAndDestroy(engine->createFence());
-        free(data);
+    if (fd < 0) {
+        utils::slog.e << "Unable to open " << path.c_str() << utils::io::endl;
+        return mesh;
     }
+
+    size_t const size = fileSize(fd);
+    void* const data = size >= sizeof(MAGICID) ? mapFile(fd, size) : nullptr;
     close(fd);
+    if (!data) {
+        return mesh;
+    }
+    if (strncmp(MAGICID, (const char*) data, 8)) {
+        unmapFile(data, size);
+        return mesh;
+    }
 
+#if !defined(WIN32)
+    // all of the file is read right away, either to decode it or to upload it
+    madvise(data, size, MADV_WILLNEED);
+#endif
+
+    // loadMeshFromBuffer() releases the data once for the vertices and once for the indices.
+    MappedFile* file = new MappedFile{ data, size, 2 };
+    mesh = loadMeshFromBuffer(engine, data, releaseMappedFile, file, materials);
     return mesh;
 }
 
@@ -249,6 +300,12 @@ MeshReader::Mesh MeshReader::loadMeshFromBuffer(filament::Engine* engine,
                 indicesSize);
         if (err) {
             utils::slog.e << "Unable to decode index buffer." << utils::io::endl;
+            free(uncompressed);
+            engine->destroy(mesh.indexBuffer);
+            if (destructor) {
+                destructor((void*) indices, indicesSize, user);
+                destructor((void*) vertexData, header->vertexSize, user);
+            }
             return {};
         }
         if (destructor) {
@@ -336,6 +393,12 @@ MeshReader::Mesh MeshReader::loadMeshFromBuffer(filament::Engine* engine,
         }
         if (err) {
             utils::slog.e << "Unable to decode vertex buffer." << utils::io::endl;
+            free(uncompressed);
+            engine->destroy(mesh.vertexBuffer);
+            engine->destroy(mesh.indexBuffer);
+            if (destructor) {
+                destructor((void*) vertexData, verticesSize, user);
+            }
             return {};
         }
         if (destructor) {
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <geometry/TangentSpaceMesh.h>
+
+#include <utils/JobSystem.h>
+
+#include <math/vec2.h>
+#include <math/vec3.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace filament::geometry;
+using namespace filament::math;
+using namespace utils;
+
+namespace {
+
+// A bumpy grid of size x size vertices with normals and uvs.
+struct Grid {
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> uvs;
+    std::vector<uint3> triangles;
+
+    explicit Grid(uint32_t size) {
+        for (uint32_t y = 0; y < size; ++y) {
+            for (uint32_t x = 0; x < size; ++x) {
+                float2 const uv{ float(x) / float(size - 1), float(y) / float(size - 1) };
+                float const h = 0.1f * std::sin(uv.x * 20.0f) * std::cos(uv.y * 20.0f);
+                positions.push_back({ uv.x, h, uv.y });
+                normals.push_back(normalize(float3{ -std::cos(uv.x * 20.0f), 1.0f,
+                        std::sin(uv.y * 20.0f) }));
+                uvs.push_back(uv);
+            }
+        }
+        for (uint32_t y = 0; y < size - 1; ++y) {
+            for (uint32_t x = 0; x < size - 1; ++x) {
+                uint32_t const i = y * size + x;
+                triangles.push_back({ i, i + size, i + 1 });
+                triangles.push_back({ i + 1, i + size, i + size + 1 });
+            }
+        }
+    }
+};
+
+// Arguments are the grid size, the algorithm and whether to use a JobSystem.
+void BM_tangentSpaceMesh(benchmark::State& state) {
+    Grid const grid(uint32_t(state.range(0)));
+    auto const algorithm = TangentSpaceMesh::Algorithm(state.range(1));
+
+    JobSystem js;
+    js.adopt();
+    JobSystem* const jobSystem = state.range(2) ? &js : nullptr;
+
+    for (auto _ : state) {
+        TangentSpaceMesh* mesh = TangentSpaceMesh::Builder()
+                .vertexCount(grid.positions.size())
+                .normals(grid.normals.data())
+                .positions(grid.positions.data())
+                .uvs(grid.uvs.data())
+                .triangleCount(grid.triangles.size())
+                .triangles(grid.triangles.data())
+                .algorithm(algorithm)
+                .jobSystem(jobSystem)
+                .build();
+        benchmark::DoNotOptimize(mesh);
+        TangentSpaceMesh::destroy(mesh);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * grid.triangles.size()));
+
+    js.emancipate();
+}
+
+void tangentSpaceMeshArgs(benchmark::internal::Benchmark* b) {
+    for (int size : { 256, 1024 }) {
+        for (auto algorithm : { TangentSpaceMesh::Algorithm::MIKKTSPACE,
+                TangentSpaceMesh::Algorithm::LENGYEL, TangentSpaceMesh::Algorithm::HUGHES_MOLLER,
+                TangentSpaceMesh::Algorithm::FRISVAD }) {
+            for (int jobs : { 0, 1 }) {
+                b->Args({ size, int(algorithm), jobs });
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+BENCHMARK(BM_tangentSpaceMesh)
+        ->ArgNames({ "size", "algorithm", "jobs" })
+        ->Apply(tangentSpaceMeshArgs)
+        ->Unit(benchmark::kMillisecond);
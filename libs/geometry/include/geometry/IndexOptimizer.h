@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TNT_GEOMETRY_INDEXOPTIMIZER_H
+#define TNT_GEOMETRY_INDEXOPTIMIZER_H
+
+#include <utils/compiler.h>
+#include <utils/FixedCapacityVector.h>
+
+#include <math/vec3.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+namespace geometry {
+
+/**
+ * Creates a function object that reorders the triangles of an indexed triangle list so that it
+ * renders faster: first to improve the hit rate of the GPU's post-transform vertex cache, then
+ * to reduce overdraw, as long as the cache efficiency doesn't degrade by more than
+ * Config::overdrawThreshold.
+ *
+ * Only the order of the triangles changes, so the vertex buffers can be left untouched. To also
+ * improve the locality of vertex fetches, vertices can then be renumbered in the order they are
+ * first used with optimizeVertexFetch(), and each vertex stream reordered with remapVertices().
+ *
+ * Usage Example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * using filament::geometry::IndexOptimizer;
+ *
+ * IndexOptimizer::Metrics before = IndexOptimizer::analyze(indices, indexCount, vertexCount);
+ * IndexOptimizer({})(indices, indexCount, positions, vertexCount);
+ * IndexOptimizer::Metrics after = IndexOptimizer::analyze(indices, indexCount, vertexCount);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class UTILS_PUBLIC IndexOptimizer {
+public:
+    struct Config {
+        //! Allowed degradation of the cache efficiency to reduce overdraw, 1.05 means 5% worse.
+        //! Overdraw optimization is disabled below 1.
+        float overdrawThreshold = 1.05f;
+    };
+
+    struct Metrics {
+        //! Average cache miss ratio: vertices transformed per triangle, 0.5 at best, 3 at worst
+        float acmr;
+        //! Average transformed vertex ratio: transformations per vertex, 1 at best, 6 at worst
+        float atvr;
+        //! Pixels shaded per pixel covered, 1 at best. Only computed when positions are given.
+        float overdraw;
+    };
+
+    IndexOptimizer(Config config) noexcept : mConfig(config) {}
+
+    /**
+     * Reorders the triangles of a triangle list in place.
+     *
+     * @param indices Triangle list indices, 3 per triangle
+     * @param indexCount Number of indices
+     * @param positions Vertex positions, used for overdraw optimization. Can be null.
+     * @param vertexCount Number of vertices
+     * @param positionStride Stride in bytes between positions, 0 means tightly packed
+     */
+    void operator()(uint32_t* indices, size_t indexCount,
+            math::float3 const* positions, size_t vertexCount, size_t positionStride = 0) const;
+
+    void operator()(uint16_t* indices, size_t indexCount,
+            math::float3 const* positions, size_t vertexCount, size_t positionStride = 0) const;
+
+    /**
+     * Measures the efficiency of a triangle list, for a vertex cache of 16 entries.
+     *
+     * @param indices Triangle list indices, 3 per triangle
+     * @param indexCount Number of indices
+     * @param vertexCount Number of vertices
+     * @param positions Vertex positions, used to measure overdraw. Can be null.
+     * @param positionStride Stride in bytes between positions, 0 means tightly packed
+     */
+    static Metrics analyze(uint32_t const* indices, size_t indexCount, size_t vertexCount,
+            math::float3 const* positions = nullptr, size_t positionStride = 0);
+
+    static Metrics analyze(uint16_t const* indices, size_t indexCount, size_t vertexCount,
+            math::float3 const* positions = nullptr, size_t positionStride = 0);
+
+    /**
+     * Renumbers the vertices in the order they are first referenced by the triangle list, and
+     * updates the indices accordingly. Unreferenced vertices are moved at the end.
+     *
+     * @param indices Triangle list indices, rewritten in place
+     * @param indexCount Number of indices
+     * @param vertexCount Number of vertices
+     * @return The new index of each vertex, to be passed to remapVertices()
+     */
+    static utils::FixedCapacityVector<uint32_t> optimizeVertexFetch(
+            uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+    /**
+     * Reorders a vertex stream following the table returned by optimizeVertexFetch().
+     * In-place reordering is supported, i.e. destination can be equal to vertices.
+     *
+     * @param destination Reordered vertices, vertexCount * vertexSize bytes
+     * @param vertices Vertices to reorder
+     * @param vertexCount Number of vertices
+     * @param vertexSize Size in bytes of a vertex
+     * @param remap Table returned by optimizeVertexFetch()
+     */
+    static void remapVertices(void* destination, void const* vertices,
+            size_t vertexCount, size_t vertexSize, uint32_t const* remap);
+
+private:
+    template<typename T>
+    void optimize(T* indices, size_t indexCount,
+            math::float3 const* positions, size_t vertexCount, size_t positionStride) const;
+
+    template<typename T>
+    static Metrics measure(T const* indices, size_t indexCount, size_t vertexCount,
+            math::float3 const* positions, size_t positionStride);
+
+    const Config mConfig;
+};
+
+} // namespace geometry
+} // namespace filament
+
+#endif // TNT_GEOMETRY_INDEXOPTIMIZER_H
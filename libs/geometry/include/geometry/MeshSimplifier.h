@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TNT_GEOMETRY_MESHSIMPLIFIER_H
+#define TNT_GEOMETRY_MESHSIMPLIFIER_H
+
+#include <utils/compiler.h>
+#include <utils/FixedCapacityVector.h>
+
+#include <math/vec3.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+namespace geometry {
+
+/**
+ * One level of a LevelsOfDetail chain.
+ */
+struct LevelOfDetail {
+    uint32_t indexOffset;   //!< offset of the first index in LevelsOfDetail::indices
+    uint32_t indexCount;    //!< number of indices, 3 per triangle
+    float error;            //!< deviation from the original mesh, relative to the mesh's extent
+};
+
+/**
+ * The result of MeshSimplifier: a chain of increasingly coarse versions of a mesh, which all use
+ * the original vertices. Level 0 is the original mesh.
+ *
+ * Since all the levels are stored in a single index buffer, they can be given to
+ * RenderableManager::Builder as consecutive primitives sharing the same VertexBuffer and
+ * IndexBuffer, each with its own offset and count.
+ *
+ * A level with a relative error e drawn with a projected size s (a fraction of the viewport
+ * height) deviates from the original mesh by about e * s * viewportHeight pixels. Hence, to
+ * keep that deviation under p pixels, the level can be used below a screen size of
+ * p / (e * viewportHeight).
+ */
+struct LevelsOfDetail {
+    utils::FixedCapacityVector<LevelOfDetail> levels;
+    utils::FixedCapacityVector<uint32_t> indices;   //!< uses the vertex indices of the input
+};
+
+/**
+ * Creates a function object that generates levels of detail of an indexed triangle mesh.
+ *
+ * Each level is obtained by collapsing the edges of the previous one, until its triangle count
+ * is reduced by Config::reduction or its error exceeds Config::maxError. Vertices are neither
+ * moved nor added, so a single vertex buffer can be used for all the levels. The chain stops
+ * early when the mesh can't be simplified further within the error bound.
+ *
+ * Usage Example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * using filament::geometry::MeshSimplifier;
+ *
+ * MeshSimplifier simplifier({ .levelCount = 4, .reduction = 0.5f });
+ * LevelsOfDetail lods = simplifier(indices, indexCount, positions, vertexCount);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class UTILS_PUBLIC MeshSimplifier {
+public:
+    struct Config {
+        uint32_t levelCount = 4;    //!< maximum number of levels, including the original mesh
+        float reduction = 0.5f;     //!< target triangle count of a level, relative to the previous
+        float maxError = 0.05f;     //!< maximum error of a level, relative to the mesh's extent
+        bool lockBorder = false;    //!< keep the mesh's open edges in place, e.g. for tiles
+    };
+
+    MeshSimplifier(Config config) noexcept : mConfig(config) {}
+
+    /**
+     * Generates the levels of detail of a triangle list.
+     *
+     * @param indices Triangle list indices, 3 per triangle
+     * @param indexCount Number of indices
+     * @param positions Vertex positions
+     * @param vertexCount Number of vertices
+     * @param positionStride Stride in bytes between positions, 0 means tightly packed
+     */
+    LevelsOfDetail operator()(uint32_t const* indices, size_t indexCount,
+            math::float3 const* positions, size_t vertexCount, size_t positionStride = 0) const;
+
+    LevelsOfDetail operator()(uint16_t const* indices, size_t indexCount,
+            math::float3 const* positions, size_t vertexCount, size_t positionStride = 0) const;
+
+private:
+    template<typename T>
+    LevelsOfDetail build(T const* indices, size_t indexCount,
+            math::float3 const* positions, size_t vertexCount, size_t positionStride) const;
+
+    const Config mConfig;
+};
+
+} // namespace geometry
+} // namespace filament
+
+#endif // TNT_GEOMETRY_MESHSIMPLIFIER_H
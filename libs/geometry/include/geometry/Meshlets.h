@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TNT_GEOMETRY_MESHLETS_H
+#define TNT_GEOMETRY_MESHLETS_H
+
+#include <utils/compiler.h>
+#include <utils/FixedCapacityVector.h>
+
+#include <math/vec3.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+namespace geometry {
+
+/**
+ * A small cluster of triangles with bounds that allow culling it as a whole.
+ */
+struct Meshlet {
+    uint32_t indexOffset;           //!< offset of the first index in Meshlets::indices
+    uint32_t triangleCount;         //!< number of triangles, i.e. 3 * triangleCount indices
+    math::float3 center;            //!< center of the bounding sphere, for frustum and occlusion
+    float radius;                   //!< radius of the bounding sphere
+    math::float3 coneApex;          //!< apex of the normal cone
+    math::float3 coneAxis;          //!< axis of the normal cone
+    float coneCutoff;               //!< cos(angle/2) of the normal cone
+
+    /**
+     * Returns true if all the triangles of the meshlet face away from the given position, in
+     * which case the meshlet can be skipped when rendering with back-face culling.
+     *
+     * @param eye Position of the camera, in the same space as the positions the meshlet was
+     *            built from.
+     */
+    bool isBackFacing(math::float3 const& eye) const noexcept {
+        math::float3 const d = coneApex - eye;
+        return dot(d, coneAxis) >= coneCutoff * length(d);
+    }
+};
+
+/**
+ * The result of MeshletBuilder: a mesh whose triangles were reordered so that the triangles of
+ * each meshlet are contiguous.
+ */
+struct Meshlets {
+    utils::FixedCapacityVector<Meshlet> meshlets;
+    utils::FixedCapacityVector<uint32_t> indices;   //!< uses the vertex indices of the input
+};
+
+/**
+ * Creates a function object that splits an indexed triangle mesh into meshlets.
+ *
+ * Triangles are grouped so that each meshlet is spatially compact and has a narrow normal cone,
+ * which makes it effective to cull meshlets against the frustum, the depth buffer, or with
+ * Meshlet::isBackFacing(). Vertices are not duplicated, so the index buffer returned can be
+ * used with the original vertex buffer, and a meshlet can be drawn with its index offset and
+ * count.
+ *
+ * Usage Example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * using filament::geometry::MeshletBuilder;
+ *
+ * MeshletBuilder builder({ .maxVertices = 64, .maxTriangles = 124 });
+ * Meshlets result = builder(indices, indexCount, positions, vertexCount);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class UTILS_PUBLIC MeshletBuilder {
+public:
+    struct Config {
+        uint32_t maxVertices = 64;      //!< at most 255
+        uint32_t maxTriangles = 124;    //!< at most 512, must be a multiple of 4
+        float coneWeight = 0.25f;       //!< 0 favors compact meshlets, 1 favors narrow cones
+    };
+
+    MeshletBuilder(Config config) noexcept : mConfig(config) {}
+
+    /**
+     * Builds the meshlets of a triangle list.
+     *
+     * @param indices Triangle list indices, 3 per triangle
+     * @param indexCount Number of indices
+     * @param positions Vertex positions
+     * @param vertexCount Number of vertices
+     * @param positionStride Stride in bytes between positions, 0 means tightly packed
+     */
+    Meshlets operator()(uint32_t const* indices, size_t indexCount,
+            math::float3 const* positions, size_t vertexCount, size_t positionStride = 0) const;
+
+    Meshlets operator()(uint16_t const* indices, size_t indexCount,
+            math::float3 const* positions, size_t vertexCount, size_t positionStride = 0) const;
+
+private:
+    template<typename T>
+    Meshlets build(T const* indices, size_t indexCount,
+            math::float3 const* positions, size_t vertexCount, size_t positionStride) const;
+
+    const Config mConfig;
+};
+
+} // namespace geometry
+} // namespace filament
+
+#endif // TNT_GEOMETRY_MESHLETS_H
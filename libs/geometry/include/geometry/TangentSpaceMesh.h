@@ -23,6 +23,10 @@
 
 #include <variant>
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace filament {
 namespace geometry {
 
@@ -223,6 +227,17 @@ public:
          */
         Builder& algorithm(Algorithm algorithm) noexcept;
 
+        /**
+         * Optional JobSystem used to split the computation of large meshes into chunks that are
+         * processed in parallel. build() still returns only once the computation is complete,
+         * and can be called from one of the JobSystem's threads. MikkTSpace's own tangent
+         * generation is always serial, only the work around it is split.
+         *
+         * @param jobSystem The JobSystem to use, or nullptr to compute on the calling thread.
+         * @return Builder
+         */
+        Builder& jobSystem(utils::JobSystem* jobSystem) noexcept;
+
         /**
          * Computes the tangent space mesh. The resulting mesh object is owned by the callee. The
          * callee must call TangentSpaceMesh::destroy on the object once they are finished with it.
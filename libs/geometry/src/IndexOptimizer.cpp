@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <geometry/IndexOptimizer.h>
+
+#include <utils/Panic.h>
+
+#include <meshoptimizer.h>
+
+namespace filament {
+namespace geometry {
+
+using namespace filament::math;
+
+// this is the cache size of most mobile GPUs, and what meshoptimizer's optimizer assumes
+static constexpr unsigned int VERTEX_CACHE_SIZE = 16;
+
+template<typename T>
+void IndexOptimizer::optimize(T* indices, size_t indexCount,
+        float3 const* positions, size_t vertexCount, size_t positionStride) const {
+    FILAMENT_CHECK_PRECONDITION(indexCount % 3 == 0) << "Only triangle lists are supported";
+
+    meshopt_optimizeVertexCache(indices, indices, indexCount, vertexCount);
+
+    if (positions && mConfig.overdrawThreshold >= 1.0f) {
+        positionStride = positionStride ? positionStride : sizeof(float3);
+        meshopt_optimizeOverdraw(indices, indices, indexCount, &positions->x, vertexCount,
+                positionStride, mConfig.overdrawThreshold);
+    }
+}
+
+template<typename T>
+IndexOptimizer::Metrics IndexOptimizer::measure(T const* indices, size_t indexCount,
+        size_t vertexCount, float3 const* positions, size_t positionStride) {
+    FILAMENT_CHECK_PRECONDITION(indexCount % 3 == 0) << "Only triangle lists are supported";
+
+    meshopt_VertexCacheStatistics const cache = meshopt_analyzeVertexCache(indices, indexCount,
+            vertexCount, VERTEX_CACHE_SIZE, 0, 0);
+
+    float overdraw = 0.0f;
+    if (positions) {
+        positionStride = positionStride ? positionStride : sizeof(float3);
+        overdraw = meshopt_analyzeOverdraw(indices, indexCount, &positions->x, vertexCount,
+                positionStride).overdraw;
+    }
+    return { cache.acmr, cache.atvr, overdraw };
+}
+
+void IndexOptimizer::operator()(uint32_t* indices, size_t indexCount,
+        float3 const* positions, size_t vertexCount, size_t positionStride) const {
+    optimize(indices, indexCount, positions, vertexCount, positionStride);
+}
+
+void IndexOptimizer::operator()(uint16_t* indices, size_t indexCount,
+        float3 const* positions, size_t vertexCount, size_t positionStride) const {
+    optimize(indices, indexCount, positions, vertexCount, positionStride);
+}
+
+IndexOptimizer::Metrics IndexOptimizer::analyze(uint32_t const* indices, size_t indexCount,
+        size_t vertexCount, float3 const* positions, size_t positionStride) {
+    return measure(indices, indexCount, vertexCount, positions, positionStride);
+}
+
+IndexOptimizer::Metrics IndexOptimizer::analyze(uint16_t const* indices, size_t indexCount,
+        size_t vertexCount, float3 const* positions, size_t positionStride) {
+    return measure(indices, indexCount, vertexCount, positions, positionStride);
+}
+
+utils::FixedCapacityVector<uint32_t> IndexOptimizer::optimizeVertexFetch(
+        uint32_t* indices, size_t indexCount, size_t vertexCount) {
+    utils::FixedCapacityVector<uint32_t> remap(vertexCount);
+    size_t const usedCount = meshopt_optimizeVertexFetchRemap(remap.data(), indices,
+            indexCount, vertexCount);
+
+    // meshoptimizer marks unreferenced vertices with ~0u, give them the remaining slots instead
+    // so that the table stays a permutation and remapVertices() doesn't drop any vertex.
+    uint32_t next = uint32_t(usedCount);
+    for (uint32_t& index : remap) {
+        if (index == ~0u) {
+            index = next++;
+        }
+    }
+
+    meshopt_remapIndexBuffer(indices, indices, indexCount, remap.data());
+    return remap;
+}
+
+void IndexOptimizer::remapVertices(void* destination, void const* vertices,
+        size_t vertexCount, size_t vertexSize, uint32_t const* remap) {
+    meshopt_remapVertexBuffer(destination, vertices, vertexCount, vertexSize, remap);
+}
+
+} // namespace geometry
+} // namespace filament
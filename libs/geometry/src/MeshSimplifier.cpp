@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <geometry/MeshSimplifier.h>
+
+#include <utils/Panic.h>
+
+#include <meshoptimizer.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace filament {
+namespace geometry {
+
+using namespace filament::math;
+
+template<typename T>
+LevelsOfDetail MeshSimplifier::build(T const* indices, size_t indexCount,
+        float3 const* positions, size_t vertexCount, size_t positionStride) const {
+    FILAMENT_CHECK_PRECONDITION(indexCount % 3 == 0) << "Only triangle lists are supported";
+    FILAMENT_CHECK_PRECONDITION(mConfig.levelCount >= 1) << "levelCount must be at least 1";
+    FILAMENT_CHECK_PRECONDITION(mConfig.reduction > 0.0f && mConfig.reduction < 1.0f)
+            << "reduction must be in ]0, 1[";
+
+    positionStride = positionStride ? positionStride : sizeof(float3);
+    unsigned int const options = mConfig.lockBorder ? meshopt_SimplifyLockBorder : 0;
+
+    std::vector<uint32_t> source(indices, indices + indexCount);
+    std::vector<uint32_t> all(source);
+    std::vector<LevelOfDetail> levels{{ 0, uint32_t(indexCount), 0.0f }};
+
+    // Every level is simplified from the original mesh rather than from the previous level, so
+    // that errors don't accumulate and the reported error is relative to the original.
+    std::vector<uint32_t> simplified(indexCount);
+    size_t targetIndexCount = indexCount;
+    while (levels.size() < mConfig.levelCount) {
+        targetIndexCount = size_t(float(targetIndexCount / 3) * mConfig.reduction) * 3;
+        if (targetIndexCount < 3) {
+            break;
+        }
+        float error = 0.0f;
+        size_t const count = meshopt_simplify(simplified.data(), source.data(), indexCount,
+                &positions->x, vertexCount, positionStride, targetIndexCount, mConfig.maxError,
+                options, &error);
+
+        // stop when the error bound (or topology) doesn't allow a meaningfully coarser level
+        size_t const previousCount = levels.back().indexCount;
+        if (count == 0 || count > previousCount - previousCount / 20) {
+            break;
+        }
+        levels.push_back({ uint32_t(all.size()), uint32_t(count), error });
+        all.insert(all.end(), simplified.begin(), simplified.begin() + count);
+    }
+
+    LevelsOfDetail result{
+        utils::FixedCapacityVector<LevelOfDetail>(levels.size()),
+        utils::FixedCapacityVector<uint32_t>(all.size())
+    };
+    std::copy(levels.begin(), levels.end(), result.levels.begin());
+    std::copy(all.begin(), all.end(), result.indices.begin());
+    return result;
+}
+
+LevelsOfDetail MeshSimplifier::operator()(uint32_t const* indices, size_t indexCount,
+        float3 const* positions, size_t vertexCount, size_t positionStride) const {
+    return build(indices, indexCount, positions, vertexCount, positionStride);
+}
+
+LevelsOfDetail MeshSimplifier::operator()(uint16_t const* indices, size_t indexCount,
+        float3 const* positions, size_t vertexCount, size_t positionStride) const {
+    return build(indices, indexCount, positions, vertexCount, positionStride);
+}
+
+} // namespace geometry
+} // namespace filament
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <geometry/Meshlets.h>
+
+#include <utils/Panic.h>
+
+#include <meshoptimizer.h>
+
+#include <vector>
+
+namespace filament {
+namespace geometry {
+
+using namespace filament::math;
+
+template<typename T>
+Meshlets MeshletBuilder::build(T const* indices, size_t indexCount,
+        float3 const* positions, size_t vertexCount, size_t positionStride) const {
+    FILAMENT_CHECK_PRECONDITION(indexCount % 3 == 0) << "Only triangle lists are supported";
+    FILAMENT_CHECK_PRECONDITION(mConfig.maxVertices >= 3 && mConfig.maxVertices <= 255)
+            << "maxVertices must be in [3, 255]";
+    FILAMENT_CHECK_PRECONDITION(mConfig.maxTriangles >= 4 && mConfig.maxTriangles <= 512 &&
+            mConfig.maxTriangles % 4 == 0)
+            << "maxTriangles must be a multiple of 4 in [4, 512]";
+
+    positionStride = positionStride ? positionStride : sizeof(float3);
+
+    size_t const maxMeshlets = meshopt_buildMeshletsBound(indexCount,
+            mConfig.maxVertices, mConfig.maxTriangles);
+    std::vector<meshopt_Meshlet> meshlets(maxMeshlets);
+    std::vector<uint32_t> meshletVertices(maxMeshlets * mConfig.maxVertices);
+    std::vector<uint8_t> meshletTriangles(maxMeshlets * mConfig.maxTriangles * 3);
+
+    size_t const meshletCount = meshopt_buildMeshlets(meshlets.data(), meshletVertices.data(),
+            meshletTriangles.data(), indices, indexCount, &positions->x, vertexCount,
+            positionStride, mConfig.maxVertices, mConfig.maxTriangles, mConfig.coneWeight);
+
+    Meshlets result{
+        utils::FixedCapacityVector<Meshlet>::with_capacity(meshletCount),
+        utils::FixedCapacityVector<uint32_t>::with_capacity(indexCount)
+    };
+
+    for (size_t i = 0; i < meshletCount; ++i) {
+        meshopt_Meshlet const& meshlet = meshlets[i];
+        uint32_t const* vertices = meshletVertices.data() + meshlet.vertex_offset;
+        uint8_t const* triangles = meshletTriangles.data() + meshlet.triangle_offset;
+
+        meshopt_Bounds const bounds = meshopt_computeMeshletBounds(vertices, triangles,
+                meshlet.triangle_count, &positions->x, vertexCount, positionStride);
+
+        result.meshlets.push_back({
+                .indexOffset = uint32_t(result.indices.size()),
+                .triangleCount = meshlet.triangle_count,
+                .center = { bounds.center[0], bounds.center[1], bounds.center[2] },
+                .radius = bounds.radius,
+                .coneApex = { bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2] },
+                .coneAxis = { bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2] },
+                .coneCutoff = bounds.cone_cutoff,
+        });
+
+        // meshlets reference their vertices through a local table, map them back to the input
+        for (size_t j = 0, c = meshlet.triangle_count * 3; j < c; ++j) {
+            result.indices.push_back(vertices[triangles[j]]);
+        }
+    }
+
+    return result;
+}
+
+Meshlets MeshletBuilder::operator()(uint32_t const* indices, size_t indexCount,
+        float3 const* positions, size_t vertexCount, size_t positionStride) const {
+    return build(indices, indexCount, positions, vertexCount, positionStride);
+}
+
+Meshlets MeshletBuilder::operator()(uint16_t const* indices, size_t indexCount,
+        float3 const* positions, size_t vertexCount, size_t positionStride) const {
+    return build(indices, indexCount, positions, vertexCount, positionStride);
+}
+
+} // namespace geometry
+} // namespace filament
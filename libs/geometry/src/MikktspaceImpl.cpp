@@ -20,11 +20,12 @@
 #include <math/norm.h>
 #include <utils/Panic.h>
 
-#include <meshoptimizer.h>
 #include <mikktspace/mikktspace.h>
 
+#include <tuple>
 #include <vector>
 
+#include <stdint.h>
 #include <string.h>  // memcpy
 
 namespace filament::geometry {
@@ -74,39 +75,17 @@ void MikktspaceImpl::setTSpaceBasic(SMikkTSpaceContext const* context, float con
         float const fSign, int const iFace, int const iVert) noexcept {
     auto const wrapper = MikktspaceImpl::getThis(context);
     uint32_t const vertInd = wrapper->getTriangle(iFace)[iVert];
-    float3 const pos = *pointerAdd(wrapper->mPositions, vertInd, wrapper->mPositionStride);
     float3 const n = normalize(*pointerAdd(wrapper->mNormals, vertInd, wrapper->mNormalStride));
-    float2 const uv = *pointerAdd(wrapper->mUVs, vertInd, wrapper->mUVStride);
     float3 const t { fvTangent[0], fvTangent[1], fvTangent[2] };
     float3 const b = fSign * normalize(cross(n, t));
 
     // TODO: packTangentFrame actually changes the orientation of b.
-    quatf const quat = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-
-    auto& output = wrapper->mOutputData;
-    auto const& EMPTY_ELEMENT = wrapper->EMPTY_ELEMENT;
-
-    size_t const outputCurSize = output.size();
-
-    // Prepare for the next element
-    output.insert(output.end(), EMPTY_ELEMENT.begin(), EMPTY_ELEMENT.end());
-
-    uint8_t* cursor = output.data() + outputCurSize;
-
-    *((float3*) (cursor + POS_OFFSET)) = pos;
-    *((float2*) (cursor + UV_OFFSET)) = uv;
-    *((quatf*) (cursor + TBN_OFFSET)) = quat;
-
-    cursor += BASE_OUTPUT_SIZE;
-    for (auto const& inputAttrib: wrapper->mInputAttribArrays) {
-        uint8_t const* input = pointerAdd(inputAttrib.data, vertInd, inputAttrib.stride);
-        memcpy(cursor, input, inputAttrib.size);
-        cursor += inputAttrib.size;
-    }
+    wrapper->mCornerQuats[iFace * 3 + iVert] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
 }
 
 MikktspaceImpl::MikktspaceImpl(const TangentSpaceMeshInput* input) noexcept
-    : mFaceCount((int) input->triangleCount),
+    : mInput(input),
+      mFaceCount((int) input->triangleCount),
       mPositions(input->positions()),
       mPositionStride(input->positionsStride()),
       mNormals(input->normals()),
@@ -116,27 +95,15 @@ MikktspaceImpl::MikktspaceImpl(const TangentSpaceMeshInput* input) noexcept
       mIsTriangle16(input->triangles16),
       mTriangles(
               input->triangles16 ? (uint8_t*) input->triangles16 : (uint8_t*) input->triangles32),
-      mOutputElementSize(BASE_OUTPUT_SIZE) {
-
-    // We don't know how many attributes there are so we have to create an ordering of the
-    // output components.  The first three components are
-    //   - float3 positions
-    //   - float2 uv
-    //   - quatf tangent
+      mCornerQuats(input->triangleCount * 3) {
     for (auto attrib: input->getAuxAttributes()) {
-        size_t const attribSize =input->attributeSize(attrib);
-        mOutputElementSize += attribSize;
         mInputAttribArrays.push_back({
             .attrib = attrib,
             .data = input->raw(attrib),
             .stride = input->stride(attrib),
-            .size = attribSize,
+            .size = input->attributeSize(attrib),
         });
     }
-    mOutputData.reserve(mFaceCount * 3 * mOutputElementSize);
-
-    // We will insert 0s to signify a new element being added to the output.
-    EMPTY_ELEMENT = std::vector<uint8_t>(mOutputElementSize);
 }
 
 MikktspaceImpl* MikktspaceImpl::getThis(SMikkTSpaceContext const* context) noexcept {
@@ -161,66 +128,94 @@ void MikktspaceImpl::run(TangentSpaceMeshOutput* output) noexcept {
     SMikkTSpaceContext context{.m_pInterface = &interface, .m_pUserData = this};
     genTangSpaceDefault(&context);
 
-    size_t oVertexCount = mOutputData.size() / mOutputElementSize;
-    std::vector<unsigned int> remap;
-    remap.resize(oVertexCount);
-    size_t vertexCount = meshopt_generateVertexRemap(remap.data(), NULL, remap.size(),
-            mOutputData.data(), oVertexCount, mOutputElementSize);
-
-    std::vector<uint8_t> newVertices(vertexCount * mOutputElementSize);
-    meshopt_remapVertexBuffer((void*) newVertices.data(), mOutputData.data(), oVertexCount,
-            mOutputElementSize, remap.data());
+    // The input is already indexed and the corners of an input vertex almost always end up with
+    // the same tangent frame, so rather than welding all the corners back together, we reuse the
+    // input vertex and only split it for corners whose tangent frame differs. Splits of the same
+    // input vertex are chained through `nextSplit`.
+    constexpr uint32_t NONE = UINT32_MAX;
+    size_t const inputVertexCount = mInput->vertexCount;
+    std::vector<uint32_t> firstSplit(inputVertexCount, NONE);
+    std::vector<uint32_t> nextSplit;
+    std::vector<uint32_t> source;
+    std::vector<quatf> quats;
+    nextSplit.reserve(inputVertexCount);
+    source.reserve(inputVertexCount);
+    quats.reserve(inputVertexCount);
+
+    auto const addVertex = [&](uint32_t inputIndex, quatf const& quat) {
+        source.push_back(inputIndex);
+        quats.push_back(quat);
+        nextSplit.push_back(NONE);
+        return uint32_t(source.size() - 1);
+    };
 
     uint3* triangles32 = output->triangles32.allocate(mFaceCount);
-    meshopt_remapIndexBuffer((uint32_t*) triangles32, NULL, remap.size(), remap.data());
+    for (int face = 0; face < mFaceCount; ++face) {
+        uint3 const triangle = getTriangle(face);
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t const inputIndex = triangle[corner];
+            quatf const& quat = mCornerQuats[face * 3 + corner];
+            uint32_t vertex = firstSplit[inputIndex];
+            if (vertex == NONE) {
+                vertex = firstSplit[inputIndex] = addVertex(inputIndex, quat);
+            } else {
+                while (memcmp(&quats[vertex], &quat, sizeof(quatf)) != 0) {
+                    if (nextSplit[vertex] == NONE) {
+                        uint32_t const split = addVertex(inputIndex, quat);
+                        nextSplit[vertex] = split;
+                        vertex = split;
+                        break;
+                    }
+                    vertex = nextSplit[vertex];
+                }
+            }
+            triangles32[face][corner] = vertex;
+        }
+    }
 
+    size_t const vertexCount = source.size();
     float3* outPositions = output->positions().allocate(vertexCount);
     float2* outUVs = output->uvs().allocate(vertexCount);
     quatf* outQuats = output->tspace().allocate(vertexCount);
 
-    uint8_t* const verts = newVertices.data();
-
-    std::vector<std::tuple<AttributeImpl, void*, size_t>> attributes;
+    std::vector<std::tuple<InputAttribute, void*>> attributes;
 
     for (auto const& inputAttrib: mInputAttribArrays) {
         auto const attrib = inputAttrib.attrib;
         switch(attrib) {
             case AttributeImpl::UV1:
-                attributes.push_back(
-                        {attrib, output->data<DATA_TYPE_UV1>(attrib).allocate(vertexCount),
-                                inputAttrib.size});
+                attributes.push_back({inputAttrib,
+                        output->data<DATA_TYPE_UV1>(attrib).allocate(vertexCount)});
                 break;
             case AttributeImpl::COLORS:
-                attributes.push_back(
-                        {attrib, output->data<DATA_TYPE_COLORS>(attrib).allocate(vertexCount),
-                                inputAttrib.size});
+                attributes.push_back({inputAttrib,
+                        output->data<DATA_TYPE_COLORS>(attrib).allocate(vertexCount)});
                 break;
             case AttributeImpl::JOINTS:
-                attributes.push_back(
-                        {attrib, output->data<DATA_TYPE_JOINTS>(attrib).allocate(vertexCount),
-                                inputAttrib.size});
+                attributes.push_back({inputAttrib,
+                        output->data<DATA_TYPE_JOINTS>(attrib).allocate(vertexCount)});
                 break;
             case AttributeImpl::WEIGHTS:
-                attributes.push_back(
-                        {attrib, output->data<DATA_TYPE_WEIGHTS>(attrib).allocate(vertexCount),
-                                inputAttrib.size});
+                attributes.push_back({inputAttrib,
+                        output->data<DATA_TYPE_WEIGHTS>(attrib).allocate(vertexCount)});
                 break;
             default:
                 PANIC_POSTCONDITION("Unexpected attribute=%d", (int) inputAttrib.attrib);
         }
     }
 
-    for (size_t i = 0, vi=0; i < vertexCount; ++i, vi+=mOutputElementSize) {
-        outPositions[i] =  *((float3*) (verts + vi + POS_OFFSET));
-        outUVs[i] = *((float2*) (verts + vi + UV_OFFSET));
-        outQuats[i] = *((quatf*) (verts + vi + TBN_OFFSET));
-
-        uint8_t* cursor = verts + vi + BASE_OUTPUT_SIZE;
-        for (auto const [attrib, outdata, size] : attributes) {
-            memcpy((uint8_t*) outdata + (i * size), cursor, size);
-            cursor += size;
+    parallelFor(mInput, vertexCount, [&](uint32_t start, uint32_t count) {
+        for (size_t i = start; i < start + count; ++i) {
+            uint32_t const vi = source[i];
+            outPositions[i] = *pointerAdd(mPositions, vi, mPositionStride);
+            outUVs[i] = *pointerAdd(mUVs, vi, mUVStride);
+            outQuats[i] = quats[i];
+            for (auto const& [inputAttrib, outdata] : attributes) {
+                memcpy((uint8_t*) outdata + (i * inputAttrib.size),
+                        pointerAdd(inputAttrib.data, vi, inputAttrib.stride), inputAttrib.size);
+            }
         }
-    }
+    });
 
     output->vertexCount = vertexCount;
     output->triangleCount = mFaceCount;
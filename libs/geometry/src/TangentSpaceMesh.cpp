@@ -190,12 +190,13 @@ void frisvadMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutput* o
     float3 const* UTILS_RESTRICT normals = input->normals();
     size_t const nstride = input->normalsStride();
 
-    for (size_t qindex = 0; qindex < vertexCount; ++qindex) {
-        float3 const n = *normals;
-        auto const [b, t] = frisvadKernel(n);
-        quats[qindex] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-        normals = pointerAdd(normals, 1, nstride);
-    }
+    parallelFor(input, vertexCount, [=](uint32_t start, uint32_t count) {
+        for (size_t qindex = start; qindex < start + count; ++qindex) {
+            float3 const n = *pointerAdd(normals, qindex, nstride);
+            auto const [b, t] = frisvadKernel(n);
+            quats[qindex] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
+        }
+    });
     output->vertexCount = input->vertexCount;
     output->triangleCount = input->triangleCount;
     output->passthrough(input->attributeData, {AttributeImpl::UV0, AttributeImpl::POSITIONS});
@@ -212,21 +213,22 @@ void hughesMollerMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutp
     float3 const* UTILS_RESTRICT normals = input->normals();
     size_t const nstride = input->normalsStride();
 
-    for (size_t qindex = 0; qindex < vertexCount; ++qindex) {
-        float3 const n = *normals;
-        float3 b, t;
+    parallelFor(input, vertexCount, [=](uint32_t start, uint32_t count) {
+        for (size_t qindex = start; qindex < start + count; ++qindex) {
+            float3 const n = *pointerAdd(normals, qindex, nstride);
+            float3 b, t;
 
-        if (abs(n.x) > abs(n.z) + std::numeric_limits<float>::epsilon()) {
-            t = float3{-n.y, n.x, 0.0f};
-        } else {
-            t = float3{0.0f, -n.z, n.y};
-        }
-        t = normalize(t);
-        b = cross(n, t);
+            if (abs(n.x) > abs(n.z) + std::numeric_limits<float>::epsilon()) {
+                t = float3{-n.y, n.x, 0.0f};
+            } else {
+                t = float3{0.0f, -n.z, n.y};
+            }
+            t = normalize(t);
+            b = cross(n, t);
 
-        quats[qindex] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-        normals = pointerAdd(normals, 1, nstride);
-    }
+            quats[qindex] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
+        }
+    });
     output->vertexCount = input->vertexCount;
     output->triangleCount = input->triangleCount;
     output->passthrough(input->attributeData, {AttributeImpl::UV0, AttributeImpl::POSITIONS});
@@ -309,66 +311,69 @@ void flatShadingMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutpu
     size_t const outTriangleCount = triangleCount;
     uint3* outTriangles = output->triangles32.allocate(outTriangleCount);
 
-    size_t vindex = 0;
-    for (size_t tindex = 0; tindex < triangleCount; ++tindex) {
-        uint3 tri = isTriangle16 ?
-                uint3(*(ushort3*)(pointerAdd(triangles, tindex, tstride))) :
-                *(uint3*)(pointerAdd(triangles, tindex, tstride));
-
-        float3 const pa = *pointerAdd(positions, tri.x, pstride);
-        float3 const pb = *pointerAdd(positions, tri.y, pstride);
-        float3 const pc = *pointerAdd(positions, tri.z, pstride);
-
-        uint32_t i0 = vindex++, i1 = vindex++, i2 = vindex++;
-        outTriangles[tindex] = uint3{i0, i1, i2};
-
-        outPositions[i0] = pa;
-        outPositions[i1] = pb;
-        outPositions[i2] = pc;
-
-        float3 const n = normalize(cross(pc - pb, pa - pb));
-        const auto [t, b] = frisvadKernel(n);
-
-        quatf const tspace = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-        quats[i0] = tspace;
-        quats[i1] = tspace;
-        quats[i2] = tspace;
-
-        // We need to make sure that the aux data is ported to the new mesh
-        for (auto& [indata, outdata, attrib, stride]: outAttributes) {
-            if (std::holds_alternative<float2 const*>(indata)) {
-                float2* out = std::get<float2*>(outdata);
-                float2 const* in = std::get<float2 const*>(indata);
-                out[i0] = *pointerAdd(in, tri.x, stride);
-                out[i1] = *pointerAdd(in, tri.y, stride);
-                out[i2] = *pointerAdd(in, tri.z, stride);
-            } else if (std::holds_alternative<float3 const*>(indata)) {
-                float3* out = std::get<float3*>(outdata);
-                float3 const* in = std::get<float3 const*>(indata);
-                out[i0] = *pointerAdd(in, tri.x, stride);
-                out[i1] = *pointerAdd(in, tri.y, stride);
-                out[i2] = *pointerAdd(in, tri.z, stride);
-            } else if (std::holds_alternative<float4 const*>(indata)) {
-                float4* out = std::get<float4*>(outdata);
-                float4 const* in = std::get<float4 const*>(indata);
-                out[i0] = *pointerAdd(in, tri.x, stride);
-                out[i1] = *pointerAdd(in, tri.y, stride);
-                out[i2] = *pointerAdd(in, tri.z, stride);
-            } else if (std::holds_alternative<ushort3 const*>(indata)) {
-                ushort3* out = std::get<ushort3*>(outdata);
-                ushort3 const* in = std::get<ushort3 const*>(indata);
-                out[i0] = *pointerAdd(in, tri.x, stride);
-                out[i1] = *pointerAdd(in, tri.y, stride);
-                out[i2] = *pointerAdd(in, tri.z, stride);
-            } else if (std::holds_alternative<ushort4 const*>(indata)) {
-                ushort4* out = std::get<ushort4*>(outdata);
-                ushort4 const* in = std::get<ushort4 const*>(indata);
-                out[i0] = *pointerAdd(in, tri.x, stride);
-                out[i1] = *pointerAdd(in, tri.y, stride);
-                out[i2] = *pointerAdd(in, tri.z, stride);
+    // Each triangle gets its own 3 vertices, so triangles can be processed independently.
+    auto const processTriangles = [&](uint32_t start, uint32_t count) {
+        for (size_t tindex = start; tindex < start + count; ++tindex) {
+            uint3 tri = isTriangle16 ?
+                    uint3(*(ushort3*)(pointerAdd(triangles, tindex, tstride))) :
+                    *(uint3*)(pointerAdd(triangles, tindex, tstride));
+
+            float3 const pa = *pointerAdd(positions, tri.x, pstride);
+            float3 const pb = *pointerAdd(positions, tri.y, pstride);
+            float3 const pc = *pointerAdd(positions, tri.z, pstride);
+
+            uint32_t const i0 = tindex * 3, i1 = i0 + 1, i2 = i0 + 2;
+            outTriangles[tindex] = uint3{i0, i1, i2};
+
+            outPositions[i0] = pa;
+            outPositions[i1] = pb;
+            outPositions[i2] = pc;
+
+            float3 const n = normalize(cross(pc - pb, pa - pb));
+            const auto [t, b] = frisvadKernel(n);
+
+            quatf const tspace = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
+            quats[i0] = tspace;
+            quats[i1] = tspace;
+            quats[i2] = tspace;
+
+            // We need to make sure that the aux data is ported to the new mesh
+            for (auto& [indata, outdata, attrib, stride]: outAttributes) {
+                if (std::holds_alternative<float2 const*>(indata)) {
+                    float2* out = std::get<float2*>(outdata);
+                    float2 const* in = std::get<float2 const*>(indata);
+                    out[i0] = *pointerAdd(in, tri.x, stride);
+                    out[i1] = *pointerAdd(in, tri.y, stride);
+                    out[i2] = *pointerAdd(in, tri.z, stride);
+                } else if (std::holds_alternative<float3 const*>(indata)) {
+                    float3* out = std::get<float3*>(outdata);
+                    float3 const* in = std::get<float3 const*>(indata);
+                    out[i0] = *pointerAdd(in, tri.x, stride);
+                    out[i1] = *pointerAdd(in, tri.y, stride);
+                    out[i2] = *pointerAdd(in, tri.z, stride);
+                } else if (std::holds_alternative<float4 const*>(indata)) {
+                    float4* out = std::get<float4*>(outdata);
+                    float4 const* in = std::get<float4 const*>(indata);
+                    out[i0] = *pointerAdd(in, tri.x, stride);
+                    out[i1] = *pointerAdd(in, tri.y, stride);
+                    out[i2] = *pointerAdd(in, tri.z, stride);
+                } else if (std::holds_alternative<ushort3 const*>(indata)) {
+                    ushort3* out = std::get<ushort3*>(outdata);
+                    ushort3 const* in = std::get<ushort3 const*>(indata);
+                    out[i0] = *pointerAdd(in, tri.x, stride);
+                    out[i1] = *pointerAdd(in, tri.y, stride);
+                    out[i2] = *pointerAdd(in, tri.z, stride);
+                } else if (std::holds_alternative<ushort4 const*>(indata)) {
+                    ushort4* out = std::get<ushort4*>(outdata);
+                    ushort4 const* in = std::get<ushort4 const*>(indata);
+                    out[i0] = *pointerAdd(in, tri.x, stride);
+                    out[i1] = *pointerAdd(in, tri.y, stride);
+                    out[i2] = *pointerAdd(in, tri.z, stride);
+                }
             }
         }
-    }
+    };
+    parallelFor(input, triangleCount, processTriangles);
 
     output->vertexCount = outVertexCount;
     output->triangleCount = outTriangleCount;
@@ -385,20 +390,22 @@ void tangentsProvidedMethod(TangentSpaceMeshInput const* input, TangentSpaceMesh
     float4 const* tanvec = input->tangents();
     size_t const tstride = input->tangentsStride();
 
-    for (size_t qindex = 0; qindex < vertexCount; ++qindex) {
-        float3 const& n = *pointerAdd(normal, qindex, nstride);
-        float4 const& t4 = *pointerAdd(tanvec, qindex, nstride);
-        float3 tv = t4.xyz;
-        float3 b = t4.w > 0 ? cross(tv, n) : cross(n, tv);
+    parallelFor(input, vertexCount, [=](uint32_t start, uint32_t count) {
+        for (size_t qindex = start; qindex < start + count; ++qindex) {
+            float3 const& n = *pointerAdd(normal, qindex, nstride);
+            float4 const& t4 = *pointerAdd(tanvec, qindex, tstride);
+            float3 tv = t4.xyz;
+            float3 b = t4.w > 0 ? cross(tv, n) : cross(n, tv);
 
-        // Some assets do not provide perfectly orthogonal tangents and normals, so we adjust the
-        // tangent to enforce orthonormality. We would rather honor the exact normal vector than
-        // the exact tangent vector since the latter is only used for bump mapping and anisotropic
-        // lighting.
-        tv = t4.w > 0 ? cross(n, b) : cross(b, n);
+            // Some assets do not provide perfectly orthogonal tangents and normals, so we adjust
+            // the tangent to enforce orthonormality. We would rather honor the exact normal vector
+            // than the exact tangent vector since the latter is only used for bump mapping and
+            // anisotropic lighting.
+            tv = t4.w > 0 ? cross(n, b) : cross(b, n);
 
-        quats[qindex] = mat3f::packTangentFrame({tv, b, n});
-    }
+            quats[qindex] = mat3f::packTangentFrame({tv, b, n});
+        }
+    });
 
     output->vertexCount = vertexCount;
     output->triangleCount = input->triangleCount;
@@ -479,21 +486,25 @@ void lengyelMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutput* o
         tan2[tri.z] += tdir;
     }
 
+    // The accumulation above scatters to shared vertices, but each vertex can then be finalized
+    // independently.
     quatf* quats = output->tspace().allocate(vertexCount);
-    for (size_t a = 0; a < vertexCount; a++) {
-        float3 const& n = *pointerAdd(normals, a, normalStride);
-        float3 const& t1 = tan1[a];
-        float3 const& t2 = tan2[a];
+    parallelFor(input, vertexCount, [&](uint32_t start, uint32_t count) {
+        for (size_t a = start; a < start + count; a++) {
+            float3 const& n = *pointerAdd(normals, a, normalStride);
+            float3 const& t1 = tan1[a];
+            float3 const& t2 = tan2[a];
 
-        // Gram-Schmidt orthogonalize
-        float3 const t = normalize(t1 - n * dot(n, t1));
+            // Gram-Schmidt orthogonalize
+            float3 const t = normalize(t1 - n * dot(n, t1));
 
-        // Calculate handedness
-        float const w = (dot(cross(n, t1), t2) < 0.0f) ? -1.0f : 1.0f;
+            // Calculate handedness
+            float const w = (dot(cross(n, t1), t2) < 0.0f) ? -1.0f : 1.0f;
 
-        float3 b = w < 0 ? cross(t, n) : cross(n, t);
-        quats[a] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-    }
+            float3 b = w < 0 ? cross(t, n) : cross(n, t);
+            quats[a] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
+        }
+    });
 
     output->vertexCount = vertexCount;
     output->triangleCount = triangleCount;
@@ -579,6 +590,11 @@ Builder& Builder::algorithm(Algorithm algo) noexcept {
     return *this;
 }
 
+Builder& Builder::jobSystem(utils::JobSystem* jobSystem) noexcept {
+    mMesh->mInput->jobSystem = jobSystem;
+    return *this;
+}
+
 TangentSpaceMesh* Builder::build() {
     FILAMENT_CHECK_PRECONDITION(!mMesh->mInput->triangles32 || !mMesh->mInput->triangles16)
             << "Cannot provide both uint32 triangles and uint16 triangles";
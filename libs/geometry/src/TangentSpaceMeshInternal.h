@@ -23,8 +23,10 @@
 #include <math/norm.h>
 #include <math/quat.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 
+#include <functional>
 #include <unordered_map>
 #include <utility>
 #include <variant>
@@ -184,6 +186,8 @@ struct TangentSpaceMeshInput {
 
     size_t triangleCount = 0;
 
+    utils::JobSystem* jobSystem = nullptr;
+
     inline float3 const* positions() const {
         return data<DATA_TYPE_POSITIONS>(AttributeImpl::POSITIONS);
     }
@@ -421,6 +425,22 @@ struct TangentSpaceMeshOutput {
     std::unordered_map<AttributeImpl, ArrayType> attributeData;
 };
 
+// Calls func(start, count) over [0, count). When the input has a JobSystem and the mesh is large
+// enough, the range is split into chunks processed in parallel, so func must only write to the
+// elements of its own range.
+template<typename Func>
+void parallelFor(TangentSpaceMeshInput const* input, size_t count, Func const& func) {
+    constexpr size_t CHUNK_SIZE = 4096;
+    utils::JobSystem* const js = input->jobSystem;
+    if (!js || count < CHUNK_SIZE * 2) {
+        func(0, uint32_t(count));
+        return;
+    }
+    auto* job = utils::jobs::parallel_for(*js, nullptr, 0, uint32_t(count), std::cref(func),
+            utils::jobs::CountSplitter<CHUNK_SIZE>());
+    js->runAndWait(job);
+}
+
 }// namespace filament::geometry
 
 #endif//TNT_GEOMETRY_TANGENTSPACEMESHIMPL_H
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <geometry/IndexOptimizer.h>
+
+#include <math/vec3.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+class IndexOptimizerTest : public testing::Test {};
+
+using namespace filament::geometry;
+using namespace filament::math;
+
+namespace {
+
+// A flat grid of size x size vertices in the XZ plane, with its triangles in random order.
+struct ShuffledGrid {
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+
+    explicit ShuffledGrid(uint32_t size) {
+        for (uint32_t y = 0; y < size; ++y) {
+            for (uint32_t x = 0; x < size; ++x) {
+                positions.push_back({ float(x), 0.0f, float(y) });
+            }
+        }
+        std::vector<uint3> triangles;
+        for (uint32_t y = 0; y < size - 1; ++y) {
+            for (uint32_t x = 0; x < size - 1; ++x) {
+                uint32_t const i = y * size + x;
+                triangles.push_back({ i, i + size, i + 1 });
+                triangles.push_back({ i + 1, i + size, i + size + 1 });
+            }
+        }
+        std::shuffle(triangles.begin(), triangles.end(), std::default_random_engine(1));
+        for (uint3 const& t : triangles) {
+            indices.insert(indices.end(), { t.x, t.y, t.z });
+        }
+    }
+};
+
+std::vector<std::vector<float3>> sortedTriangles(std::vector<uint32_t> const& indices,
+        std::vector<float3> const& positions) {
+    std::vector<std::vector<float3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        // rotate the triangle so that its smallest index comes first, preserving winding
+        std::vector<float3> t{
+                positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]] };
+        auto const less = [](float3 const& a, float3 const& b) {
+            return std::lexicographical_compare(&a[0], &a[0] + 3, &b[0], &b[0] + 3);
+        };
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end(), less), t.end());
+        triangles.push_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end(), [](auto const& a, auto const& b) {
+        return std::lexicographical_compare(&a[0][0], &a[0][0] + 9, &b[0][0], &b[0][0] + 9);
+    });
+    return triangles;
+}
+
+} // anonymous namespace
+
+TEST_F(IndexOptimizerTest, ImprovesVertexCache) {
+    ShuffledGrid grid(33);
+    auto const triangles = sortedTriangles(grid.indices, grid.positions);
+
+    IndexOptimizer::Metrics const before = IndexOptimizer::analyze(grid.indices.data(),
+            grid.indices.size(), grid.positions.size(), grid.positions.data());
+
+    IndexOptimizer const optimizer({});
+    optimizer(grid.indices.data(), grid.indices.size(),
+            grid.positions.data(), grid.positions.size());
+
+    IndexOptimizer::Metrics const after = IndexOptimizer::analyze(grid.indices.data(),
+            grid.indices.size(), grid.positions.size(), grid.positions.data());
+
+    EXPECT_LT(after.acmr, before.acmr * 0.6f);
+    EXPECT_LT(after.atvr, before.atvr);
+    EXPECT_GE(after.overdraw, 1.0f);
+    EXPECT_EQ(sortedTriangles(grid.indices, grid.positions), triangles);
+}
+
+TEST_F(IndexOptimizerTest, VertexFetch) {
+    ShuffledGrid grid(17);
+    // add an unreferenced vertex, which must be kept
+    grid.positions.push_back({ -1.0f, -1.0f, -1.0f });
+    auto const triangles = sortedTriangles(grid.indices, grid.positions);
+
+    auto const remap = IndexOptimizer::optimizeVertexFetch(grid.indices.data(),
+            grid.indices.size(), grid.positions.size());
+    IndexOptimizer::remapVertices(grid.positions.data(), grid.positions.data(),
+            grid.positions.size(), sizeof(float3), remap.data());
+
+    // the vertices are now numbered in the order they are first used
+    uint32_t next = 0;
+    for (uint32_t index : grid.indices) {
+        EXPECT_LE(index, next);
+        next = std::max(next, index + 1);
+    }
+    EXPECT_EQ(grid.positions.back(), (float3{ -1.0f, -1.0f, -1.0f }));
+    EXPECT_EQ(sortedTriangles(grid.indices, grid.positions), triangles);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <geometry/MeshSimplifier.h>
+
+#include <math/vec3.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <math.h>
+
+class MeshSimplifierTest : public testing::Test {};
+
+using namespace filament::geometry;
+using namespace filament::math;
+
+namespace {
+
+// A grid of size x size vertices in the XZ plane, displaced along Y by height(x, z).
+struct Grid {
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+
+    template<typename F>
+    Grid(uint32_t size, F height) {
+        for (uint32_t y = 0; y < size; ++y) {
+            for (uint32_t x = 0; x < size; ++x) {
+                positions.push_back({ float(x), height(float(x), float(y)), float(y) });
+            }
+        }
+        for (uint32_t y = 0; y < size - 1; ++y) {
+            for (uint32_t x = 0; x < size - 1; ++x) {
+                uint32_t const i = y * size + x;
+                indices.insert(indices.end(), { i, i + size, i + 1 });
+                indices.insert(indices.end(), { i + 1, i + size, i + size + 1 });
+            }
+        }
+    }
+};
+
+} // anonymous namespace
+
+TEST_F(MeshSimplifierTest, ChainOfLevels) {
+    Grid const grid(33, [](float, float) { return 0.0f; });
+    MeshSimplifier const simplifier({ .levelCount = 4, .reduction = 0.5f });
+    LevelsOfDetail const lods = simplifier(grid.indices.data(), grid.indices.size(),
+            grid.positions.data(), grid.positions.size());
+
+    // a plane can be simplified without error, so we get all the levels
+    ASSERT_EQ(lods.levels.size(), 4u);
+
+    // level 0 is the original mesh
+    EXPECT_EQ(lods.levels[0].indexOffset, 0u);
+    EXPECT_EQ(lods.levels[0].indexCount, grid.indices.size());
+    EXPECT_TRUE(std::equal(grid.indices.begin(), grid.indices.end(), lods.indices.begin()));
+
+    uint32_t offset = 0;
+    for (size_t i = 0; i < lods.levels.size(); ++i) {
+        LevelOfDetail const& level = lods.levels[i];
+        EXPECT_EQ(level.indexOffset, offset);
+        EXPECT_EQ(level.indexCount % 3, 0u);
+        EXPECT_LT(level.error, 1e-3f);
+        if (i > 0) {
+            EXPECT_LE(level.indexCount, lods.levels[i - 1].indexCount / 2 + 3);
+        }
+        offset += level.indexCount;
+    }
+    EXPECT_EQ(offset, lods.indices.size());
+
+    for (uint32_t index : lods.indices) {
+        EXPECT_LT(index, grid.positions.size());
+    }
+}
+
+TEST_F(MeshSimplifierTest, ErrorBound) {
+    Grid const grid(33, [](float x, float z) { return 2.0f * sinf(x) * cosf(z); });
+    std::vector<uint16_t> indices(grid.indices.begin(), grid.indices.end());
+    MeshSimplifier const simplifier({ .levelCount = 8, .reduction = 0.5f, .maxError = 0.01f });
+    LevelsOfDetail const lods = simplifier(indices.data(), indices.size(),
+            grid.positions.data(), grid.positions.size());
+
+    // the bumps can't be flattened within the error bound, the chain stops early
+    ASSERT_GE(lods.levels.size(), 1u);
+    EXPECT_LT(lods.levels.size(), 8u);
+    for (LevelOfDetail const& level : lods.levels) {
+        EXPECT_LE(level.error, 0.01f);
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
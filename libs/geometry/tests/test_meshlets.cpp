@@ -0,0 +1,119 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <geometry/Meshlets.h>
+
+#include <math/vec3.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+class MeshletsTest : public testing::Test {};
+
+using namespace filament::geometry;
+using namespace filament::math;
+
+namespace {
+
+// A flat grid of size x size vertices in the XZ plane, facing +Y.
+struct Grid {
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+
+    explicit Grid(uint32_t size) {
+        for (uint32_t y = 0; y < size; ++y) {
+            for (uint32_t x = 0; x < size; ++x) {
+                positions.push_back({ float(x), 0.0f, float(y) });
+            }
+        }
+        for (uint32_t y = 0; y < size - 1; ++y) {
+            for (uint32_t x = 0; x < size - 1; ++x) {
+                uint32_t const i = y * size + x;
+                indices.insert(indices.end(), { i, i + size, i + 1 });
+                indices.insert(indices.end(), { i + 1, i + size, i + size + 1 });
+            }
+        }
+    }
+};
+
+std::vector<uint3> sortedTriangles(uint32_t const* indices, size_t count) {
+    std::vector<uint3> triangles;
+    for (size_t i = 0; i < count; i += 3) {
+        // rotate the triangle so that its smallest index comes first, preserving winding
+        uint3 t{ indices[i], indices[i + 1], indices[i + 2] };
+        while (t.x > t.y || t.x > t.z) {
+            t = uint3{ t.y, t.z, t.x };
+        }
+        triangles.push_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end(), [](uint3 const& a, uint3 const& b) {
+        return std::lexicographical_compare(&a[0], &a[0] + 3, &b[0], &b[0] + 3);
+    });
+    return triangles;
+}
+
+} // anonymous namespace
+
+TEST_F(MeshletsTest, PreservesTriangles) {
+    Grid const grid(33);
+    MeshletBuilder const builder({ .maxVertices = 64, .maxTriangles = 124 });
+    Meshlets const result = builder(grid.indices.data(), grid.indices.size(),
+            grid.positions.data(), grid.positions.size());
+
+    ASSERT_EQ(result.indices.size(), grid.indices.size());
+    EXPECT_EQ(sortedTriangles(result.indices.data(), result.indices.size()),
+            sortedTriangles(grid.indices.data(), grid.indices.size()));
+
+    uint32_t offset = 0;
+    for (Meshlet const& meshlet : result.meshlets) {
+        EXPECT_EQ(meshlet.indexOffset, offset);
+        EXPECT_LE(meshlet.triangleCount, 124u);
+        offset += meshlet.triangleCount * 3;
+
+        std::vector<uint32_t> vertices(result.indices.begin() + meshlet.indexOffset,
+                result.indices.begin() + meshlet.indexOffset + meshlet.triangleCount * 3);
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        EXPECT_LE(vertices.size(), 64u);
+
+        for (uint32_t v : vertices) {
+            EXPECT_LE(distance(grid.positions[v], meshlet.center), meshlet.radius * 1.0001f);
+        }
+    }
+    EXPECT_EQ(offset, result.indices.size());
+}
+
+TEST_F(MeshletsTest, BackFacing) {
+    Grid const grid(17);
+    std::vector<uint16_t> indices(grid.indices.begin(), grid.indices.end());
+    MeshletBuilder const builder({});
+    Meshlets const result = builder(indices.data(), indices.size(),
+            grid.positions.data(), grid.positions.size());
+
+    ASSERT_FALSE(result.meshlets.empty());
+    for (Meshlet const& meshlet : result.meshlets) {
+        EXPECT_FALSE(meshlet.isBackFacing(meshlet.center + float3{ 0, 10, 0 }));
+        EXPECT_TRUE(meshlet.isBackFacing(meshlet.center - float3{ 0, 10, 0 }));
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
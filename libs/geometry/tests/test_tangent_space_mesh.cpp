@@ -21,8 +21,10 @@
 
 #include <gtest/gtest.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 
+#include <cmath>
 #include <vector>
 
 class TangentSpaceMeshTest : public testing::Test {};
@@ -427,6 +429,101 @@ TEST_F(TangentSpaceMeshTest, Lengyel) {
     TangentSpaceMesh::destroy(mesh);
 }
 
+TEST_F(TangentSpaceMeshTest, JobSystemMatchesSerial) {
+    // A bumpy grid, large enough to be split into several chunks.
+    constexpr uint32_t SIZE = 128;
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> uvs;
+    for (uint32_t y = 0; y < SIZE; ++y) {
+        for (uint32_t x = 0; x < SIZE; ++x) {
+            float2 const uv{ float(x) / (SIZE - 1), float(y) / (SIZE - 1) };
+            float const h = 0.1f * std::sin(uv.x * 20.0f) * std::cos(uv.y * 20.0f);
+            positions.push_back({ uv.x, h, uv.y });
+            normals.push_back(normalize(float3{ -std::cos(uv.x * 20.0f), 1.0f,
+                    std::sin(uv.y * 20.0f) }));
+            uvs.push_back(uv);
+        }
+    }
+    std::vector<uint3> triangles;
+    for (uint32_t y = 0; y < SIZE - 1; ++y) {
+        for (uint32_t x = 0; x < SIZE - 1; ++x) {
+            uint32_t const i = y * SIZE + x;
+            triangles.push_back({ i, i + SIZE, i + 1 });
+            triangles.push_back({ i + 1, i + SIZE, i + SIZE + 1 });
+        }
+    }
+
+    utils::JobSystem js;
+    js.adopt();
+
+    for (auto algorithm: { TangentSpaceMesh::Algorithm::MIKKTSPACE,
+            TangentSpaceMesh::Algorithm::LENGYEL, TangentSpaceMesh::Algorithm::FRISVAD }) {
+        auto const build = [&](utils::JobSystem* jobSystem) {
+            return TangentSpaceMesh::Builder()
+                    .vertexCount(positions.size())
+                    .normals(normals.data())
+                    .positions(positions.data())
+                    .uvs(uvs.data())
+                    .triangleCount(triangles.size())
+                    .triangles(triangles.data())
+                    .algorithm(algorithm)
+                    .jobSystem(jobSystem)
+                    .build();
+        };
+        TangentSpaceMesh* serial = build(nullptr);
+        TangentSpaceMesh* parallel = build(&js);
+
+        ASSERT_EQ(serial->getVertexCount(), parallel->getVertexCount());
+        ASSERT_EQ(serial->getTriangleCount(), parallel->getTriangleCount());
+
+        size_t const vertexCount = serial->getVertexCount();
+        std::vector<quatf> serialQuats(vertexCount);
+        std::vector<quatf> parallelQuats(vertexCount);
+        serial->getQuats(serialQuats.data());
+        parallel->getQuats(parallelQuats.data());
+        for (size_t i = 0; i < vertexCount; ++i) {
+            EXPECT_EQ(serialQuats[i], parallelQuats[i]);
+        }
+
+        TangentSpaceMesh::destroy(serial);
+        TangentSpaceMesh::destroy(parallel);
+    }
+
+    js.emancipate();
+}
+
+TEST_F(TangentSpaceMeshTest, MikktspaceKeepsInputIndexing) {
+    // A single quad split in two triangles, with continuous uvs, should not be split.
+    std::vector<float3> const positions { {0, 0, 0}, {1, 0, 0}, {0, 0, 1}, {1, 0, 1} };
+    std::vector<float3> const normals(4, float3{0, 1, 0});
+    std::vector<float2> const uvs { {0, 0}, {1, 0}, {0, 1}, {1, 1} };
+    std::vector<uint3> const triangles { {0, 2, 1}, {1, 2, 3} };
+
+    TangentSpaceMesh* mesh = TangentSpaceMesh::Builder()
+            .vertexCount(positions.size())
+            .normals(normals.data())
+            .positions(positions.data())
+            .uvs(uvs.data())
+            .triangleCount(triangles.size())
+            .triangles(triangles.data())
+            .algorithm(TangentSpaceMesh::Algorithm::MIKKTSPACE)
+            .build();
+
+    ASSERT_EQ(mesh->getVertexCount(), positions.size());
+    std::vector<uint3> outTriangles(mesh->getTriangleCount());
+    mesh->getTriangles(outTriangles.data());
+    std::vector<float3> outPositions(mesh->getVertexCount());
+    mesh->getPositions(outPositions.data());
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_PRED2(isAlmostEqual3, outPositions[outTriangles[i][j]],
+                    positions[triangles[i][j]]);
+        }
+    }
+    TangentSpaceMesh::destroy(mesh);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -133,16 +133,36 @@ public:
      */
     math::mat4f const* getInverseBindMatricesAt(size_t skinIndex) const;
 
+    /**
+     * How recomputeBoundingBoxes() bounds skinned primitives.
+     */
+    enum class SkinnedBounds : uint8_t {
+        //! Skins every vertex, this gives the tightest box.
+        VERTICES,
+        /**
+         * Transforms a box per joint, enclosing the vertices influenced by that joint in its bind
+         * space. The result is conservative, and its cost only depends on the number of joints,
+         * which makes it cheap enough to call every frame. The boxes are computed by the first
+         * call that uses this mode.
+         */
+        JOINTS,
+    };
+
     /**
      * Resets the AABB on all renderables by manually computing the bounding box.
      *
-     * THIS IS ONLY USEFUL FOR MALFORMED ASSETS THAT DO NOT HAVE MIN/MAX SET UP CORRECTLY.
+     * This is useful for malformed assets that do not have min/max set up correctly, and for
+     * skinned assets whose pose differs a lot from their bind pose, e.g. ragdolls. The source
+     * data of the primitives is cached by the first call, so that later calls only redo the
+     * skinning.
      *
      * Does not affect the return value of getBoundingBox() on the owning asset.
      * Cannot be called after releaseSourceData() on the owning asset.
      * Can only be called after loadResources() or asyncBeginLoad().
+     *
+     * @param skinnedBounds how to bound skinned primitives
      */
-    void recomputeBoundingBoxes();
+    void recomputeBoundingBoxes(SkinnedBounds skinnedBounds = SkinnedBounds::VERTICES);
 
     /**
      * Gets the axis-aligned bounding box from the supplied min / max values in glTF accessors.
@@ -205,6 +205,24 @@ void processShaderString(std::string* shader, const UvMap& uvmap,
 UTILS_PUBLIC
 MaterialProvider* createJitShaderProvider(Engine* engine, bool optimizeShaders = false);
 
+/**
+ * Creates a material provider that builds materials on the fly, and stores the generated material
+ * packages in the given directory. Materials found in this cache are loaded as is rather than
+ * built from scratch, so that only the first run of an application pays for them.
+ *
+ * Cached packages are keyed by the MaterialKey, the UV map, the material version and the engine's
+ * backend and stereo configuration. The directory must exist and be writable.
+ *
+ * @param optimizeShaders Optimizes shaders, but at significant cost to construction time.
+ * @param cacheDirectory Path to the directory that holds the cached materials.
+ * @return New material provider that can build materials at run time.
+ *
+ * Requires \c libfilamat to be linked in. Not available in \c libgltfio_core.
+ */
+UTILS_PUBLIC
+MaterialProvider* createJitShaderProvider(Engine* engine, bool optimizeShaders,
+        const char* cacheDirectory);
+
 /**
  * Creates a material provider that loads a small set of pre-built materials.
  *
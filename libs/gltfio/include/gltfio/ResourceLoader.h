@@ -49,6 +49,28 @@ struct ResourceConfiguration {
     //! If true, adjusts skinning weights to sum to 1. Well formed glTF files do not need this,
     //! but it is useful for robustness.
     bool normalizeSkinningWeights;
+
+    //! If true, reorders the triangles of indexed triangle lists to improve the hit rate of the
+    //! GPU's post-transform vertex cache and to reduce overdraw, see geometry::IndexOptimizer.
+    //! Vertices are left untouched. This is best done offline, e.g. with gltfpack, when possible.
+    bool optimizeIndices = false;
+
+    //! If true, textures with identical image content are decoded and uploaded only once and
+    //! shared by all the assets loaded with this ResourceLoader, even across glTF files. A shared
+    //! texture is destroyed along with the last asset that uses it. The content of every image is
+    //! hashed, which is cheap compared to decoding it.
+    bool shareTextures = false;
+
+    //! If non-zero, the PNG and JPEG base color textures of unlit and metallic-roughness materials
+    //! that have no other texture are packed into atlases of this size (a power of two), and the
+    //! UVs of their primitives are remapped accordingly. The primitives that end up with the same
+    //! material and atlas page then share a material instance, which lets the renderer batch them.
+    //! Only square power-of-two images no larger than textureAtlasMaxImageSize are packed, and
+    //! only when their UVs stay within [0, 1] since the atlas can't repeat them.
+    uint32_t textureAtlasSize = 0;
+
+    //! The size of the largest image that can go into an atlas, see textureAtlasSize.
+    uint32_t textureAtlasMaxImageSize = 256;
 };
 
 /**
@@ -61,9 +83,8 @@ struct ResourceConfiguration {
  * because it listens to filament::backend::BufferDescriptor callbacks in order to determine when to
  * free CPU-side data blobs.
  *
- * \todo If clients persist their ResourceLoader, Filament textures are currently re-created upon
- * subsequent re-loads of the same asset. To fix this, we would need to enable shared ownership
- * of Texture objects between ResourceLoader and FilamentAsset.
+ * If clients persist their ResourceLoader, Filament textures are re-created upon subsequent
+ * loads of the same images, unless ResourceConfiguration::shareTextures is enabled.
  */
 class UTILS_PUBLIC ResourceLoader {
 public:
@@ -173,6 +173,35 @@ public:
  */
 TextureProvider* createStbProvider(filament::Engine* engine);
 
+/**
+ * Optional settings for createStbProvider().
+ */
+struct StbProviderConfig {
+    /**
+     * Re-encodes the decoded images into a compressed format supported by the engine, which
+     * reduces their GPU memory by 4x (8x for images without an alpha channel). Opaque images
+     * prefer ETC2 or BC1, the others ASTC 4x4, ETC2 EAC or BC3 in that order. If none of these
+     * are supported, textures are uploaded uncompressed.
+     *
+     * The mipmap chain is generated on the CPU. Encoding is lossy and much slower than decoding,
+     * see cacheFolder.
+     */
+    bool compressTextures = false;
+
+    /**
+     * Optional folder where compressed textures are stored after being encoded, and loaded from
+     * on subsequent runs. Entries are keyed by a hash of the source image and the target format.
+     * The folder must exist. Ignored unless compressTextures is true.
+     */
+    const char* cacheFolder = nullptr;
+};
+
+/**
+ * Creates a decoder based on stb_image that can handle "image/png" and "image/jpeg", and which can
+ * optionally compress the decoded images at load time.
+ */
+TextureProvider* createStbProvider(filament::Engine* engine, StbProviderConfig const& config);
+
 /**
  * Creates a decoder that can handle certain types of "image/ktx2" content as specified in
  * the KHR_texture_basisu specification.
@@ -22,10 +22,12 @@
 #include "FTrsTransformManager.h"
 #include "downcast.h"
 
+#include <filament/Engine.h>
 #include <filament/VertexBuffer.h>
 #include <filament/RenderableManager.h>
 #include <filament/TransformManager.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 
 #include <math/mat4.h>
@@ -34,7 +36,7 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
-#include <map>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -45,7 +47,7 @@ using namespace utils;
 
 namespace filament::gltfio {
 
-using TimeValues = map<float, size_t>;
+using TimeValues = vector<float>;
 using SourceValues = vector<float>;
 using BoneVector = vector<mat4f>;
 
@@ -53,6 +55,9 @@ struct Sampler {
     TimeValues times;
     SourceValues values;
     enum { LINEAR, STEP, CUBIC } interpolation;
+    // index of the keyframe found by the last lookup, the next lookup usually finds the same one
+    // or the one after it since the time generally moves forward by less than a keyframe.
+    mutable size_t cursor = 0;
 };
 
 struct Channel {
@@ -85,10 +90,15 @@ struct AnimatorImpl {
     void applyCrossFade(float alpha);
     void resetBoneMatrices(FFilamentInstance* instance);
     void updateBoneMatrices(FFilamentInstance* instance);
+    // computes the bone matrices of every target of every skin, in the order setBones() uses them
+    void computeBoneMatrices(FFilamentInstance const* instance, BoneVector& matrices) const;
+    void setBones(FFilamentInstance const* instance, BoneVector const& matrices);
+    vector<BoneVector> instanceBoneMatrices;
 };
 
 static void createSampler(const cgltf_animation_sampler& src, Sampler& dst) {
-    // Copy the time values into a red-black tree.
+    // Copy the time values, glTF requires them to be strictly increasing so they can be searched
+    // directly.
     const cgltf_accessor* timelineAccessor = src.input;
     const uint8_t* timelineBlob = nullptr;
     const float* timelineFloats = nullptr;
@@ -100,8 +110,9 @@ static void createSampler(const cgltf_animation_sampler& src, Sampler& dst) {
         timelineFloats = (const float*) (timelineBlob + timelineAccessor->offset +
                 timelineAccessor->buffer_view->offset);
     }
-    for (size_t i = 0, len = timelineAccessor->count; i < len; ++i) {
-        dst.times[timelineFloats[i]] = i;
+    dst.times.assign(timelineFloats, timelineFloats + timelineAccessor->count);
+    if (!std::is_sorted(dst.times.begin(), dst.times.end())) {
+        GLTFIO_WARN("Animation keyframe times are not increasing.");
     }
 
     // Convert source data to float.
@@ -222,7 +233,7 @@ Animator::Animator(FFilamentAsset const* asset, FFilamentInstance* instance) {
             Sampler& dstSampler = dstAnim.samplers[j];
             createSampler(srcSampler, dstSampler);
             if (dstSampler.times.size() > 1) {
-                float maxtime = (--dstSampler.times.end())->first;
+                float maxtime = dstSampler.times.back();
                 dstAnim.duration = std::max(dstAnim.duration, maxtime);
             }
         }
@@ -258,6 +269,24 @@ Animator::~Animator() {
     delete mImpl;
 }
 
+// Returns the index of the first keyframe at or after the given time, or the number of keyframes
+// if there is none.
+static size_t findKeyframe(const Sampler& sampler, float time) {
+    const TimeValues& times = sampler.times;
+    const size_t count = times.size();
+    const size_t cursor = sampler.cursor;
+    const auto isKeyframe = [&times, count, time](size_t i) {
+        return i < count && times[i] >= time && (i == 0 || times[i - 1] < time);
+    };
+    if (isKeyframe(cursor)) {
+        return cursor;
+    }
+    if (isKeyframe(cursor + 1)) {
+        return sampler.cursor = cursor + 1;
+    }
+    return sampler.cursor = size_t(lower_bound(times.begin(), times.end(), time) - times.begin());
+}
+
 size_t Animator::getAnimationCount() const {
     return mImpl->animations.size();
 }
@@ -276,24 +305,23 @@ void Animator::applyAnimation(size_t animationIndex, float time) const {
         const TimeValues& times = sampler->times;
 
         // Find the first keyframe after the given time, or the keyframe that matches it exactly.
-        TimeValues::const_iterator iter = times.lower_bound(time);
+        const size_t index = findKeyframe(*sampler, time);
 
         // Compute the interpolant (between 0 and 1) and determine the keyframe pair.
         float t = 0.0f;
         size_t nextIndex;
         size_t prevIndex;
-        if (iter == times.end()) {
+        if (index == times.size()) {
             nextIndex = times.size() - 1;
             prevIndex = nextIndex;
-        } else if (iter == times.begin()) {
+        } else if (index == 0) {
             nextIndex = 0;
             prevIndex = 0;
         } else {
-            TimeValues::const_iterator prev = iter; --prev;
-            nextIndex = iter->second;
-            prevIndex = prev->second;
-            const float nextTime = iter->first;
-            const float prevTime = prev->first;
+            nextIndex = index;
+            prevIndex = index - 1;
+            const float nextTime = times[nextIndex];
+            const float prevTime = times[prevIndex];
             float deltaTime = nextTime - prevTime;
             assert(deltaTime >= 0);
             if (deltaTime > 0) {
@@ -330,9 +358,31 @@ void Animator::updateBoneMatrices() {
         return;
     }
 
-    // If this is a broadcast animator, then update all instances.
-    for (FFilamentInstance* instance : mImpl->asset->mInstances) {
-        mImpl->updateBoneMatrices(instance);
+    // If this is a broadcast animator, then update all instances. The matrices of each instance are
+    // computed in parallel, which only reads the transforms, but setting them must be serialized.
+    auto const& instances = mImpl->asset->mInstances;
+    if (instances.size() < 2) {
+        for (FFilamentInstance* instance : instances) {
+            mImpl->updateBoneMatrices(instance);
+        }
+        return;
+    }
+
+    auto& instanceBoneMatrices = mImpl->instanceBoneMatrices;
+    instanceBoneMatrices.resize(instances.size());
+
+    JobSystem& js = mImpl->asset->mEngine->getJobSystem();
+    auto* job = jobs::parallel_for(js, nullptr, 0, uint32_t(instances.size()),
+            [impl = mImpl](uint32_t start, uint32_t count) {
+                for (uint32_t i = start; i < start + count; i++) {
+                    impl->computeBoneMatrices(impl->asset->mInstances[i],
+                            impl->instanceBoneMatrices[i]);
+                }
+            }, jobs::AdaptiveSplitter(1));
+    js.runAndWait(job);
+
+    for (size_t i = 0, n = instances.size(); i < n; i++) {
+        mImpl->setBones(instances[i], instanceBoneMatrices[i]);
     }
 }
 
@@ -543,12 +593,29 @@ void AnimatorImpl::resetBoneMatrices(FFilamentInstance* instance) {
 }
 
 void AnimatorImpl::updateBoneMatrices(FFilamentInstance* instance) {
+    computeBoneMatrices(instance, boneMatrices);
+    setBones(instance, boneMatrices);
+}
+
+void AnimatorImpl::computeBoneMatrices(FFilamentInstance const* instance,
+        BoneVector& matrices) const {
     assert_invariant(instance->mSkins.size() == asset->mSkins.size());
+    matrices.clear();
+    vector<mat4> globalJointTransforms;
     size_t skinIndex = 0;
     for (const auto& skin : instance->mSkins) {
         const auto& assetSkin = asset->mSkins[skinIndex++];
         size_t njoints = skin.joints.size();
-        boneMatrices.resize(njoints);
+
+        // the joint transforms are the same for all the targets of the skin
+        globalJointTransforms.resize(njoints);
+        for (size_t boneIndex = 0; boneIndex < njoints; ++boneIndex) {
+            TransformManager::Instance jointInstance =
+                    transformManager->getInstance(skin.joints[boneIndex]);
+            globalJointTransforms[boneIndex] =
+                    transformManager->getWorldTransformAccurate(jointInstance);
+        }
+
         for (Entity entity : skin.targets) {
             auto renderable = renderableManager->getInstance(entity);
             if (!renderable) {
@@ -560,15 +627,27 @@ void AnimatorImpl::updateBoneMatrices(FFilamentInstance* instance) {
                 inverseGlobalTransform = inverse(transformManager->getWorldTransformAccurate(xformable));
             }
             for (size_t boneIndex = 0; boneIndex < njoints; ++boneIndex) {
-                const auto& joint = skin.joints[boneIndex];
                 const mat4f& inverseBindMatrix = assetSkin.inverseBindMatrices[boneIndex];
-                TransformManager::Instance jointInstance = transformManager->getInstance(joint);
-                mat4 globalJointTransform = transformManager->getWorldTransformAccurate(jointInstance);
-                boneMatrices[boneIndex] =
-                        mat4f{ inverseGlobalTransform * globalJointTransform } *
-                        inverseBindMatrix;
+                matrices.push_back(
+                        mat4f{ inverseGlobalTransform * globalJointTransforms[boneIndex] } *
+                        inverseBindMatrix);
+            }
+        }
+    }
+}
+
+void AnimatorImpl::setBones(FFilamentInstance const* instance, BoneVector const& matrices) {
+    size_t offset = 0;
+    for (const auto& skin : instance->mSkins) {
+        size_t njoints = skin.joints.size();
+        for (Entity entity : skin.targets) {
+            auto renderable = renderableManager->getInstance(entity);
+            if (!renderable) {
+                continue;
             }
-            renderableManager->setBones(renderable, boneMatrices.data(), boneMatrices.size());
+            assert_invariant(offset + njoints <= matrices.size());
+            renderableManager->setBones(renderable, matrices.data() + offset, njoints);
+            offset += njoints;
         }
     }
 }
@@ -30,8 +30,6 @@
 #include <utils/memalign.h>
 #include <utils/ostream.h>
 
-#include <zstd.h>
-
 #include <stdint.h>
 #include <stddef.h>
 #include <string.h>
@@ -60,17 +58,37 @@ static bool strIsEqual(const CString& a, const char* b) {
 
 void ArchiveCache::load(const void* archiveData, uint64_t archiveByteCount) {
     assert_invariant(mArchive == nullptr && "Do not call load() twice");
-    const uint64_t decompSize = ZSTD_getFrameContentSize(archiveData, archiveByteCount);
-    if (decompSize == ZSTD_CONTENTSIZE_UNKNOWN || decompSize == ZSTD_CONTENTSIZE_ERROR) {
+    mArchive = decompressArchive(archiveData, archiveByteCount);
+    if (mArchive == nullptr) {
         PANIC_POSTCONDITION("Decompression error.");
     }
-    uint64_t* basePointer = (uint64_t*) utils::aligned_alloc(decompSize, 8);
-    ZSTD_decompress(basePointer, decompSize, archiveData, archiveByteCount);
-    mArchive = (ReadableArchive*) basePointer;
-    convertOffsetsToPointers(mArchive);
+    if (mArchive->isFramed()) {
+        // The caller doesn't have to keep the archive alive, so we keep a copy of it, which is
+        // still much smaller than the decompressed packages.
+        mFramedData = FixedCapacityVector<uint8_t>(archiveByteCount);
+        memcpy(mFramedData.data(), archiveData, archiveByteCount);
+    }
     mMaterials = FixedCapacityVector<Material*>(mArchive->specsCount, nullptr);
 }
 
+Material* ArchiveCache::createMaterial(size_t specIndex) {
+    const ArchiveSpec& spec = mArchive->specs[specIndex];
+    if (!mArchive->isFramed()) {
+        return Material::Builder()
+            .package(spec.package, spec.packageByteCount)
+            .build(mEngine);
+    }
+    // The package is only needed until the material is built, Material::Builder makes a copy.
+    FixedCapacityVector<uint8_t> package(spec.packageByteCount);
+    if (!decompressPackage(mArchive, spec, mFramedData.data(), mFramedData.size(),
+            package.data())) {
+        PANIC_POSTCONDITION("Decompression error.");
+    }
+    return Material::Builder()
+        .package(package.data(), package.size())
+        .build(mEngine);
+}
+
 // This loops though all ubershaders and returns the first one that meets the given requirements.
 Material* ArchiveCache::getMaterial(const ArchiveRequirements& reqs) {
     assert_invariant(mArchive && "Please call load() before requesting any materials.");
@@ -132,9 +150,7 @@ Material* ArchiveCache::getMaterial(const ArchiveRequirements& reqs) {
 
         if (specIsSuitable) {
             if (mMaterials[i] == nullptr) {
-                mMaterials[i] = Material::Builder()
-                    .package(spec.package, spec.packageByteCount)
-                    .build(mEngine);
+                mMaterials[i] = createMaterial(i);
             }
 
             return mMaterials[i];
@@ -148,9 +164,7 @@ Material* ArchiveCache::getDefaultMaterial() {
     assert_invariant(!mMaterials.empty() && "Archive must have at least one material.");
     if (!mArchive) return nullptr;
     if (mMaterials[0] == nullptr) {
-        mMaterials[0] = Material::Builder()
-            .package(mArchive->specs[0].package, mArchive->specs[0].packageByteCount)
-            .build(mEngine);
+        mMaterials[0] = createMaterial(0);
     }
     return mMaterials[0];
 }
@@ -50,9 +50,14 @@ namespace filament::gltfio {
         FeatureMap getFeatureMap(Material* material) const;
 
     private:
+        Material* createMaterial(size_t specIndex);
+
         Engine& mEngine;
         utils::FixedCapacityVector<Material*> mMaterials;
         uberz::ReadableArchive* mArchive = nullptr;
+
+        // Framed archives keep their compressed packages, which are decompressed on demand.
+        utils::FixedCapacityVector<uint8_t> mFramedData;
     };
 
     struct ArchiveRequirements {
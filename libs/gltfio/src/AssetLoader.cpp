@@ -90,6 +90,18 @@ static constexpr cgltf_material kDefaultMat = {
     },
 };
 
+// Returns the number of instances of a node that uses EXT_mesh_gpu_instancing, or 0. Skinned and
+// morphed meshes are drawn without the extension since they are driven by the Animator, which only
+// knows about the node's own entity.
+static size_t getGpuInstanceCount(cgltf_node const* node) {
+    if (!node->mesh || !node->has_mesh_gpu_instancing || node->skin ||
+            node->mesh->primitives[0].targets_count > 0) {
+        return 0;
+    }
+    cgltf_mesh_gpu_instancing const& ext = node->mesh_gpu_instancing;
+    return ext.attributes_count > 0 ? ext.attributes[0].data->count : 0;
+}
+
 static std::string getNodeName(cgltf_node const* node, char const* defaultNodeName) {
     auto const getNameImpl = [node, defaultNodeName]() -> char const* {
         if (node->name) return node->name;
@@ -314,7 +326,7 @@ private:
     void recurseEntities(const cgltf_node* node, SceneMask scenes, Entity parent,
             FFilamentAsset* fAsset, FFilamentInstance* instance);
     void createRenderable(const cgltf_node* node, Entity entity, const char* name,
-            FFilamentAsset* fAsset);
+            FFilamentAsset* fAsset, size_t instanceOffset = 0, size_t instanceCount = 0);
     void createLight(const cgltf_light* light, Entity entity, FFilamentAsset* fAsset);
     void createCamera(const cgltf_camera* camera, Entity entity, FFilamentAsset* fAsset);
     void addTextureBinding(MaterialInstance* materialInstance, const char* parameterName,
@@ -558,7 +570,10 @@ void FAssetLoader::recursePrimitives(const cgltf_node* node, FFilamentAsset* fAs
 
     if (node->mesh) {
         createPrimitives(node, name, fAsset);
-        fAsset->mRenderableCount++;
+        const size_t chunkSize = mEngine.getMaxAutomaticInstances();
+        const size_t instanceCount = getGpuInstanceCount(node);
+        const size_t chunkCount = (instanceCount + chunkSize - 1) / chunkSize;
+        fAsset->mRenderableCount += std::max(size_t(1), chunkCount);
     }
 
     for (cgltf_size i = 0, len = node->children_count; i < len; ++i) {
@@ -638,10 +653,28 @@ void FAssetLoader::recurseEntities(const cgltf_node* node, SceneMask scenes, Ent
 
     // If the node has a mesh, then create a renderable component.
     if (node->mesh) {
-        createRenderable(node, entity, name, fAsset);
+        const size_t chunkSize = mEngine.getMaxAutomaticInstances();
+        const size_t instanceCount = getGpuInstanceCount(node);
+        createRenderable(node, entity, name, fAsset, 0, std::min(instanceCount, chunkSize));
         if (srcAsset->variants_count > 0) {
             createMaterialVariants(node->mesh, entity, fAsset, instance);
         }
+
+        // A renderable can only draw a limited number of instances, the others are drawn by
+        // children of the node that share its geometry and materials.
+        for (size_t offset = chunkSize; offset < instanceCount; offset += chunkSize) {
+            const Entity child = mEntityManager.create();
+            nm.create(child);
+            nm.setSceneMembership(nm.getInstance(child), scenes);
+            mTransformManager.create(child, mTransformManager.getInstance(entity));
+            fAsset->mEntities.push_back(child);
+            instance->mEntities.push_back(child);
+            createRenderable(node, child, name, fAsset, offset,
+                    std::min(instanceCount - offset, chunkSize));
+            if (srcAsset->variants_count > 0) {
+                createMaterialVariants(node->mesh, child, fAsset, instance);
+            }
+        }
     }
 
     if (node->light) {
@@ -725,7 +758,7 @@ void FAssetLoader::createPrimitives(const cgltf_node* node, const char* name,
  }
 
 void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity, const char* name,
-        FFilamentAsset* fAsset) {
+        FFilamentAsset* fAsset, size_t instanceOffset, size_t instanceCount) {
     const cgltf_data* srcAsset = fAsset->mSourceAsset->hierarchy;
     const cgltf_mesh* mesh = node->mesh;
     const cgltf_size primitiveCount = mesh->primitives_count;
@@ -881,6 +914,15 @@ void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity, const
         box = Box().set(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
     }
 
+    InstanceBuffer* instanceBuffer = nullptr;
+    if (instanceCount > 0) {
+        instanceBuffer = InstanceBuffer::Builder(instanceCount)
+                .instanceBoundingBox(box)
+                .build(mEngine);
+        fAsset->mInstanceBuffers.push_back(instanceBuffer);
+        builder.instances(instanceCount, instanceBuffer);
+    }
+
     builder
         .boundingBox(box)
         .culling(true)
@@ -888,6 +930,23 @@ void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity, const
         .receiveShadows(true)
         .build(mEngine, entity);
 
+    // The instance transforms can only be read once the buffers are loaded, which is already the
+    // case for instances of the asset created after its resources.
+    if (instanceBuffer) {
+        const FFilamentAsset::GpuInstancing instancing = {
+            .node = node,
+            .entity = entity,
+            .instanceBuffer = instanceBuffer,
+            .offset = uint32_t(instanceOffset),
+            .count = uint32_t(instanceCount),
+        };
+        if (fAsset->mResourcesLoaded) {
+            fAsset->applyGpuInstancing(instancing);
+        } else {
+            fAsset->mPendingGpuInstancing.push_back(instancing);
+        }
+    }
+
     // According to the spec, the mesh may or may not specify default weights, regardless of whether
     // it actually has morph targets. If it has morphing enabled then the default weights are 0. If
     // node weights are provided, they override the ones specified on the mesh.
@@ -1082,7 +1141,13 @@ bool FAssetLoader::createPrimitive(const cgltf_primitive& inPrim, const char* na
             slog.e << "Unsupported accessor type in " << name << io::endl;
             return false;
         }
-        const int stride = (fatype == actualType) ? accessor->stride : 0;
+        int stride = (fatype == actualType) ? accessor->stride : 0;
+
+        // Quantized vec3 attributes are padded to 4 components rather than converted to floats.
+        if (utility::requiresPadding(accessor)) {
+            getPaddedElementType(accessor->type, accessor->component_type, &fatype);
+            stride = 0;
+        }
 
         // The cgltf library provides a stride value for all accessors, even though they do not
         // exist in the glTF file. It is computed from the type and the stride of the buffer view.
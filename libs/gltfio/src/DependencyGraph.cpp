@@ -96,7 +96,8 @@ void DependencyGraph::checkReadiness(Material* material) {
 void DependencyGraph::markAsReady(Texture* texture) {
     assert_invariant(texture);
     auto iter = mTextureNodes.find(texture);
-    if (iter == mTextureNodes.end()) {
+    // Textures can be popped after they were marked ready, e.g. when shared between assets.
+    if (iter == mTextureNodes.end() || iter.value()->ready) {
         return;
     }
     iter.value()->ready = true;
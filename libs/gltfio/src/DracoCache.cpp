@@ -21,8 +21,11 @@
 #endif
 
 #include <utils/compiler.h>
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 
+#include <algorithm>
+
 #if GLTFIO_DRACO_SUPPORTED
 
 #include <memory>
@@ -49,6 +52,36 @@ DracoMesh* DracoCache::findOrCreateMesh(const cgltf_buffer_view* key) {
     return mesh;
 }
 
+void DracoCache::decodeMeshes(std::vector<const cgltf_buffer_view*> keys, JobSystem& js) {
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    keys.erase(std::remove_if(keys.begin(), keys.end(), [this](const cgltf_buffer_view* key) {
+        return mCache.find(key) != mCache.end();
+    }), keys.end());
+
+    if (keys.empty()) {
+        return;
+    }
+
+    // The decoder doesn't share any state between meshes, so each one can be decoded by its own
+    // job. The cache itself is only modified once they are all done.
+    std::vector<DracoMesh*> meshes(keys.size());
+    JobSystem::Job* parent = js.createJob();
+    for (size_t i = 0, n = keys.size(); i < n; i++) {
+        JobSystem::Job* job = jobs::createJob(js, parent, [key = keys[i], mesh = &meshes[i]] {
+            assert(key->buffer && key->buffer->data);
+            const uint8_t* compressedData = key->offset + (uint8_t*) key->buffer->data;
+            *mesh = DracoMesh::decode(compressedData, key->size);
+        });
+        js.run(job);
+    }
+    js.runAndWait(parent);
+
+    for (size_t i = 0, n = keys.size(); i < n; i++) {
+        mCache.emplace(keys[i], meshes[i]);
+    }
+}
+
 DracoMesh::DracoMesh(struct DracoMeshDetails* details) : mDetails(details) {}
 
 #if GLTFIO_DRACO_SUPPORTED
@@ -22,11 +22,16 @@
 #include <tsl/robin_map.h>
 
 #include <memory>
+#include <vector>
 
 #ifndef GLTFIO_DRACO_SUPPORTED
 #define GLTFIO_DRACO_SUPPORTED 0
 #endif
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace filament::gltfio {
 
 class DracoMesh;
@@ -38,6 +43,11 @@ class DracoMesh;
 class DracoCache {
 public:
     DracoMesh* findOrCreateMesh(const cgltf_buffer_view* key);
+
+    // Decodes the given meshes concurrently on the JobSystem and adds them to the cache, so that
+    // the subsequent calls to findOrCreateMesh() are simple lookups. Keys that are already in the
+    // cache, or duplicated in the list, are decoded only once.
+    void decodeMeshes(std::vector<const cgltf_buffer_view*> keys, utils::JobSystem& js);
 private:
     tsl::robin_map<const cgltf_buffer_view*, std::unique_ptr<DracoMesh>> mCache;
 };
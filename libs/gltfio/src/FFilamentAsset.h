@@ -23,6 +23,7 @@
 
 #include <filament/Engine.h>
 #include <filament/IndexBuffer.h>
+#include <filament/InstanceBuffer.h>
 #include <filament/MaterialInstance.h>
 #include <filament/RenderableManager.h>
 #include <filament/Texture.h>
@@ -45,6 +46,7 @@
 #include "DependencyGraph.h"
 #include "DracoCache.h"
 #include "FFilamentInstance.h"
+#include "TextureCache.h"
 #include "Utility.h"
 
 #include <string>
@@ -246,6 +248,19 @@ struct FFilamentAsset : public FilamentAsset {
     // to the dependency graph used for gradual reveal of entities.
     void applyTextureBinding(size_t textureIndex,const TextureSlot& tb, bool addDependency = true);
 
+    // A renderable that draws some of the instances of a node with EXT_mesh_gpu_instancing.
+    struct GpuInstancing {
+        const cgltf_node* node;
+        utils::Entity entity;
+        InstanceBuffer* instanceBuffer;
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    // Reads the instance transforms from the source data into the InstanceBuffer, and grows the
+    // bounding box of the renderable so that it encloses all of its instances.
+    void applyGpuInstancing(GpuInstancing const& instancing);
+
     struct Skin {
         utils::CString name;
         utils::FixedCapacityVector<math::mat4f> inverseBindMatrices;
@@ -264,6 +279,7 @@ struct FFilamentAsset : public FilamentAsset {
     std::vector<BufferObject*> mBufferObjects;
     std::vector<IndexBuffer*> mIndexBuffers;
     std::vector<MorphTargetBuffer*> mMorphTargetBuffers;
+    std::vector<InstanceBuffer*> mInstanceBuffers;
     utils::FixedCapacityVector<Skin> mSkins;
     utils::FixedCapacityVector<utils::CString> mScenes;
     Aabb mBoundingBox;
@@ -304,23 +320,36 @@ struct FFilamentAsset : public FilamentAsset {
     // Stores all information related to a single cgltf_texture.
     // Note that more than one cgltf_texture can map to a single Filament texture,
     // e.g. if several have the same URL or bufferView. For each Filament texture,
-    // only one of its corresponding TextureInfo slots will have isOwner=true.
+    // only one of its corresponding TextureInfo slots will have isOwner=true. When textures are
+    // shared between assets, the owner holds a reference in mTextureCache instead.
+    // A packed texture points to its page in mAtlasTextures, see
+    // ResourceConfiguration::textureAtlasSize.
     struct TextureInfo {
         std::vector<TextureSlot> bindings;
         Texture* texture;
         TextureProvider::TextureFlags flags;
         bool isOwner;
+        bool isPacked = false;
     };
 
     // Mapping from cgltf_texture to Texture* is required when creating new instances.
     utils::FixedCapacityVector<TextureInfo> mTextures;
 
+    // The pages of the texture atlases created by ResourceLoader, they're owned by the asset.
+    std::vector<Texture*> mAtlasTextures;
+
+    // Set by ResourceLoader when ResourceConfiguration::shareTextures is enabled.
+    TextureCacheHandle mTextureCache;
+
     // Resource URIs can be queried by the end user.
     utils::FixedCapacityVector<const char*> mResourceUris;
 
     // The mapping from cgltf_mesh to VertexBuffer* (etc) is required when creating new instances.
     MeshCache mMeshCache;
 
+    // Instanced renderables whose transforms are waiting for the buffers to be loaded.
+    std::vector<GpuInstancing> mPendingGpuInstancing;
+
     // Asset information that is produced by AssetLoader and consumed by ResourceLoader:
     struct ResourceInfo {
         // Encapsulates VertexBuffer::setBufferAt() or IndexBuffer::setBuffer().
@@ -27,6 +27,7 @@
 
 #include <tsl/robin_set.h>
 
+#include <memory>
 #include <vector>
 
 #include "downcast.h"
@@ -107,6 +108,10 @@ struct FFilamentInstance : public FilamentInstance {
 
     Aabb mBoundingBox;
 
+    // Source data of the primitives, created by the first call to recomputeBoundingBoxes().
+    struct BoundsCache;
+    std::unique_ptr<BoundsCache> mBoundsCache;
+
     utils::FixedCapacityVector<MaterialInstance*> mMaterialInstances;
 
     void createAnimator();
@@ -119,7 +124,8 @@ struct FFilamentInstance : public FilamentInstance {
     void detachSkin(size_t skinIndex, utils::Entity target) noexcept;
     math::mat4f const* getInverseBindMatricesAt(size_t skinIndex) const;
 
-    void recomputeBoundingBoxes();
+    void recomputeBoundingBoxes(SkinnedBounds skinnedBounds);
+    void releaseBoundsCache() noexcept;
 };
 
 FILAMENT_DOWNCAST(FilamentInstance)
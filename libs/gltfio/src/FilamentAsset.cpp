@@ -17,17 +17,21 @@
 #include "FFilamentAsset.h"
 
 #include <gltfio/Animator.h>
+#include <gltfio/math.h>
 
 #include <filament/RenderableManager.h>
 #include <filament/Scene.h>
 
 #include <utils/EntityManager.h>
+#include <utils/FixedCapacityVector.h>
 #include <utils/Log.h>
 #include <utils/NameComponentManager.h>
 
 #include "GltfEnums.h"
 #include "Wireframe.h"
 
+#include <string.h>
+
 using namespace filament;
 using namespace utils;
 
@@ -87,12 +91,74 @@ FFilamentAsset::~FFilamentAsset() {
     }
     for (auto tx : mTextures) {
         if (UTILS_LIKELY(tx.isOwner)) {
-            mEngine->destroy(tx.texture);
+            if (mTextureCache) {
+                mTextureCache->release(tx.texture);
+            } else {
+                mEngine->destroy(tx.texture);
+            }
         }
     }
+    for (auto tx : mAtlasTextures) {
+        mEngine->destroy(tx);
+    }
     for (auto tb : mMorphTargetBuffers) {
         mEngine->destroy(tb);
     }
+    for (auto ib : mInstanceBuffers) {
+        mEngine->destroy(ib);
+    }
+}
+
+void FFilamentAsset::applyGpuInstancing(GpuInstancing const& instancing) {
+    const cgltf_mesh_gpu_instancing& ext = instancing.node->mesh_gpu_instancing;
+    const cgltf_accessor* translations = nullptr;
+    const cgltf_accessor* rotations = nullptr;
+    const cgltf_accessor* scales = nullptr;
+    for (cgltf_size i = 0; i < ext.attributes_count; i++) {
+        const cgltf_attribute& attribute = ext.attributes[i];
+        if (!strcmp(attribute.name, "TRANSLATION")) {
+            translations = attribute.data;
+        } else if (!strcmp(attribute.name, "ROTATION")) {
+            rotations = attribute.data;
+        } else if (!strcmp(attribute.name, "SCALE")) {
+            scales = attribute.data;
+        }
+    }
+
+    // cgltf_accessor_read_float() takes care of the normalized integer rotations allowed by the
+    // extension.
+    FixedCapacityVector<math::mat4f> transforms(instancing.count);
+    for (uint32_t i = 0; i < instancing.count; i++) {
+        const cgltf_size index = instancing.offset + i;
+        math::float3 translation{ 0.0f };
+        math::quatf rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+        math::float3 scale{ 1.0f };
+        if (translations) {
+            cgltf_accessor_read_float(translations, index, &translation.x, 3);
+        }
+        if (rotations) {
+            math::float4 xyzw;
+            cgltf_accessor_read_float(rotations, index, &xyzw.x, 4);
+            rotation = math::quatf{ xyzw.w, xyzw.x, xyzw.y, xyzw.z };
+        }
+        if (scales) {
+            cgltf_accessor_read_float(scales, index, &scale.x, 3);
+        }
+        transforms[i] = composeMatrix(translation, rotation, scale);
+    }
+    instancing.instanceBuffer->setLocalTransforms(transforms.data(), transforms.size());
+
+    // All the instances are culled together, so the bounding box must enclose all of them.
+    RenderableManager& rm = mEngine->getRenderableManager();
+    const RenderableManager::Instance ri = rm.getInstance(instancing.entity);
+    const Box box = rm.getAxisAlignedBoundingBox(ri);
+    Aabb aabb;
+    for (math::mat4f const& transform : transforms) {
+        const Box instanceBox = Box::transform(transform.upperLeft(), transform[3].xyz, box);
+        aabb.min = min(aabb.min, instanceBox.getMin());
+        aabb.max = max(aabb.max, instanceBox.getMax());
+    }
+    rm.setAxisAlignedBoundingBox(ri, Box().set(aabb.min, aabb.max));
 }
 
 const char* FFilamentAsset::getExtras(utils::Entity entity) const noexcept {
@@ -150,6 +216,11 @@ void FFilamentAsset::applyTextureBinding(size_t textureIndex, const TextureSlot&
         sampler.setMagFilter(TextureSampler::MagFilter::LINEAR);
         sampler.setMinFilter(TextureSampler::MinFilter::LINEAR_MIPMAP_LINEAR);
     }
+    if (info.isPacked) {
+        // The UVs were remapped to the page of the atlas and never leave it.
+        sampler.setWrapModeS(TextureSampler::WrapMode::CLAMP_TO_EDGE);
+        sampler.setWrapModeT(TextureSampler::WrapMode::CLAMP_TO_EDGE);
+    }
     tb.materialInstance->setParameter(tb.materialParameter, info.texture, sampler);
     if (addDependency) {
         mDependencyGraph.addEdge(info.texture, tb.materialInstance, tb.materialParameter);
@@ -195,6 +266,9 @@ void FFilamentAsset::releaseSourceData() noexcept {
     }
     mMeshCache = {};
     mResourceUris = {};
+    for (FFilamentInstance* instance : mInstances) {
+        instance->releaseBoundsCache();
+    }
     mSourceAsset.reset();
 }
 
@@ -22,6 +22,9 @@
 #include <utils/JobSystem.h>
 #include <utils/Log.h>
 
+#include <algorithm>
+#include <memory>
+
 using namespace filament;
 using namespace filament::math;
 using namespace utils;
@@ -97,208 +100,329 @@ mat4f const* FFilamentInstance::getInverseBindMatricesAt(size_t skinIndex) const
     return mOwner->mSkins[skinIndex].inverseBindMatrices.data();
 }
 
-void FFilamentInstance::recomputeBoundingBoxes() {
-    FILAMENT_CHECK_PRECONDITION(mOwner->mSourceAsset)
-            << "Do not call releaseSourceData before recomputeBoundingBoxes";
-
-    FILAMENT_CHECK_PRECONDITION(mOwner->mResourcesLoaded)
-            << "Do not call recomputeBoundingBoxes before loadResources or asyncBeginLoad";
-
-    auto& rm = mOwner->mEngine->getRenderableManager();
-    auto& tm = mOwner->mEngine->getTransformManager();
-
-    // The purpose of the root node is to give the client a place for custom transforms.
-    // Since it is not part of the source model, it should be ignored when computing the
-    // bounding box.
-    TransformManager::Instance root = tm.getInstance(mOwner->getRoot());
-    utils::FixedCapacityVector<Entity> modelRoots(tm.getChildCount(root));
-    tm.getChildren(root, modelRoots.data(), modelRoots.size());
-    for (auto e : modelRoots) {
-        tm.setParent(tm.getInstance(e), 0);
-    }
-
-    struct Prim {
+struct FFilamentInstance::BoundsCache {
+    struct Primitive {
         cgltf_primitive const* prim;
         Entity node;
         ssize_t skinIndex;
-    };
 
-    auto computeBoundingBox = [](const cgltf_primitive* prim) -> Aabb {
-        Aabb aabb;
-        for (cgltf_size slot = 0; slot < prim->attributes_count; slot++) {
-            const cgltf_attribute& attr = prim->attributes[slot];
-            const cgltf_accessor* accessor = attr.data;
-            const size_t dim = cgltf_num_components(accessor->type);
-            if (attr.type == cgltf_attribute_type_position && dim >= 3) {
-                utils::FixedCapacityVector<float> unpacked(accessor->count * dim);
-                cgltf_accessor_unpack_floats(accessor, unpacked.data(), unpacked.size());
-                for (cgltf_size i = 0, j = 0, n = accessor->count; i < n; ++i, j += dim) {
-                    float3 pt(unpacked[j + 0], unpacked[j + 1], unpacked[j + 2]);
-                    aabb.min = min(aabb.min, pt);
-                    aabb.max = max(aabb.max, pt);
-                }
+        // bounds of an unskinned primitive, they never change
+        Aabb bounds;
 
-                if (!prim->targets_count) {
-                    break;
-                }
-
-                Aabb baseAabb(aabb);
-                for (cgltf_size targetIndex = 0; targetIndex < prim->targets_count; ++targetIndex) {
-                    const cgltf_morph_target& target = prim->targets[targetIndex];
-                    for (cgltf_size attribIndex = 0; attribIndex < target.attributes_count; ++attribIndex) {
-                        const cgltf_attribute& targetAttribute = target.attributes[attribIndex];
-                        if (targetAttribute.type != cgltf_attribute_type_position) {
-                            continue;
-                        }
+        // unpacked attributes of a skinned primitive
+        FixedCapacityVector<float3> positions;
+        FixedCapacityVector<uint4> joints;
+        FixedCapacityVector<float4> weights;
 
-                        const cgltf_accessor* targetAccessor = targetAttribute.data;
+        // bounds of the vertices influenced by each joint, in the bind space of that joint,
+        // computed by the first call using SkinnedBounds::JOINTS
+        FixedCapacityVector<Aabb> jointBounds;
+    };
+    FixedCapacityVector<Primitive> primitives;
+};
+
+static Aabb computeBoundingBox(const cgltf_primitive* prim) {
+    Aabb aabb;
+    for (cgltf_size slot = 0; slot < prim->attributes_count; slot++) {
+        const cgltf_attribute& attr = prim->attributes[slot];
+        const cgltf_accessor* accessor = attr.data;
+        const size_t dim = cgltf_num_components(accessor->type);
+        if (attr.type == cgltf_attribute_type_position && dim >= 3) {
+            utils::FixedCapacityVector<float> unpacked(accessor->count * dim);
+            cgltf_accessor_unpack_floats(accessor, unpacked.data(), unpacked.size());
+            for (cgltf_size i = 0, j = 0, n = accessor->count; i < n; ++i, j += dim) {
+                float3 pt(unpacked[j + 0], unpacked[j + 1], unpacked[j + 2]);
+                aabb.min = min(aabb.min, pt);
+                aabb.max = max(aabb.max, pt);
+            }
 
-                        assert_invariant(targetAccessor);
-                        assert_invariant(targetAccessor->count == accessor->count);
-                        assert_invariant(cgltf_num_components(targetAccessor->type) == dim);
+            if (!prim->targets_count) {
+                break;
+            }
 
-                        cgltf_accessor_unpack_floats(targetAccessor, unpacked.data(), unpacked.size());
+            Aabb baseAabb(aabb);
+            for (cgltf_size targetIndex = 0; targetIndex < prim->targets_count; ++targetIndex) {
+                const cgltf_morph_target& target = prim->targets[targetIndex];
+                for (cgltf_size attribIndex = 0; attribIndex < target.attributes_count; ++attribIndex) {
+                    const cgltf_attribute& targetAttribute = target.attributes[attribIndex];
+                    if (targetAttribute.type != cgltf_attribute_type_position) {
+                        continue;
+                    }
 
-                        Aabb targetAabb;
-                        for (cgltf_size i = 0, j = 0, n = accessor->count; i < n; ++i, j += dim) {
-                            float3 delta(unpacked[j + 0], unpacked[j + 1], unpacked[j + 2]);
-                            targetAabb.min = min(targetAabb.min, delta);
-                            targetAabb.max = max(targetAabb.max, delta);
-                        }
+                    const cgltf_accessor* targetAccessor = targetAttribute.data;
 
-                        targetAabb.min += baseAabb.min;
-                        targetAabb.max += baseAabb.max;
+                    assert_invariant(targetAccessor);
+                    assert_invariant(targetAccessor->count == accessor->count);
+                    assert_invariant(cgltf_num_components(targetAccessor->type) == dim);
 
-                        aabb.min = min(aabb.min, targetAabb.min);
-                        aabb.max = max(aabb.max, targetAabb.max);
+                    cgltf_accessor_unpack_floats(targetAccessor, unpacked.data(), unpacked.size());
 
-                        break;
+                    Aabb targetAabb;
+                    for (cgltf_size i = 0, j = 0, n = accessor->count; i < n; ++i, j += dim) {
+                        float3 delta(unpacked[j + 0], unpacked[j + 1], unpacked[j + 2]);
+                        targetAabb.min = min(targetAabb.min, delta);
+                        targetAabb.max = max(targetAabb.max, delta);
                     }
-                }
-                break;
-            }
-        }
-        return aabb;
-    };
 
-    auto computeBoundingBoxSkinned = [&tm, this](const Prim& prim) -> Aabb {
-        FixedCapacityVector<float3> verts;
-        FixedCapacityVector<uint4> joints;
-        FixedCapacityVector<float4> weights;
-        for (cgltf_size slot = 0, n = prim.prim->attributes_count; slot < n; ++slot) {
-            const cgltf_attribute& attr = prim.prim->attributes[slot];
-            const cgltf_accessor& accessor = *attr.data;
-            switch (attr.type) {
-            case cgltf_attribute_type_position:
-                verts = FixedCapacityVector<float3>(accessor.count);
-                cgltf_accessor_unpack_floats(&accessor, &verts.data()->x, accessor.count * 3);
-                break;
-            case cgltf_attribute_type_joints: {
-                FixedCapacityVector<float4> tmp(accessor.count);
-                cgltf_accessor_unpack_floats(&accessor, &tmp.data()->x, accessor.count * 4);
-                joints = FixedCapacityVector<uint4>(accessor.count);
-                for (size_t i = 0, n = accessor.count; i < n; ++i) {
-                    joints[i] = uint4(tmp[i]);
+                    targetAabb.min += baseAabb.min;
+                    targetAabb.max += baseAabb.max;
+
+                    aabb.min = min(aabb.min, targetAabb.min);
+                    aabb.max = max(aabb.max, targetAabb.max);
+
+                    break;
                 }
-                break;
-            }
-            case cgltf_attribute_type_weights:
-                weights = FixedCapacityVector<float4>(accessor.count);
-                cgltf_accessor_unpack_floats(&accessor, &weights.data()->x, accessor.count * 4);
-                break;
-            default:
-                break;
             }
+            break;
         }
+    }
+    return aabb;
+}
 
-        Aabb aabb;
-        TransformManager::Instance transformable = tm.getInstance(prim.node);
-        const mat4f inverseGlobalTransform = inverse(tm.getWorldTransform(transformable));
-        const Skin& instanceSkin = mSkins[prim.skinIndex];
-        const FFilamentAsset::Skin& assetSkin = mOwner->mSkins[prim.skinIndex];
-        for (size_t i = 0, n = verts.size(); i < n; i++) {
-            mat4f tmp = mat4f(0.0f);
-            for (size_t j = 0; j < 4; j++) {
-                size_t jointIndex = joints[i][j];
-                Entity jointEntity = instanceSkin.joints[jointIndex];
-                mat4f globalJointTransform = tm.getWorldTransform(tm.getInstance(jointEntity));
-                mat4f inverseBindMatrix = assetSkin.inverseBindMatrices[jointIndex];
-                tmp += weights[i][j] *  globalJointTransform * inverseBindMatrix;
+static void unpackSkinnedAttributes(FFilamentInstance::BoundsCache::Primitive& prim) {
+    for (cgltf_size slot = 0, n = prim.prim->attributes_count; slot < n; ++slot) {
+        const cgltf_attribute& attr = prim.prim->attributes[slot];
+        const cgltf_accessor& accessor = *attr.data;
+        // only the first set of joints and weights is used, like the renderable does
+        if (attr.index != 0) {
+            continue;
+        }
+        switch (attr.type) {
+        case cgltf_attribute_type_position:
+            prim.positions = FixedCapacityVector<float3>(accessor.count);
+            cgltf_accessor_unpack_floats(&accessor, &prim.positions.data()->x, accessor.count * 3);
+            break;
+        case cgltf_attribute_type_joints: {
+            FixedCapacityVector<float4> tmp(accessor.count);
+            cgltf_accessor_unpack_floats(&accessor, &tmp.data()->x, accessor.count * 4);
+            prim.joints = FixedCapacityVector<uint4>(accessor.count);
+            for (size_t i = 0, n = accessor.count; i < n; ++i) {
+                prim.joints[i] = uint4(tmp[i]);
             }
-            const mat4f skinMatrix = inverseGlobalTransform * tmp;
+            break;
+        }
+        case cgltf_attribute_type_weights:
+            prim.weights = FixedCapacityVector<float4>(accessor.count);
+            cgltf_accessor_unpack_floats(&accessor, &prim.weights.data()->x, accessor.count * 4);
+            break;
+        default:
+            break;
+        }
+    }
+}
 
-            const float3 point = verts[i];
+void FFilamentInstance::recomputeBoundingBoxes(SkinnedBounds skinnedBounds) {
+    FILAMENT_CHECK_PRECONDITION(mOwner->mSourceAsset)
+            << "Do not call releaseSourceData before recomputeBoundingBoxes";
 
-            // NOTE: Filament's vertex shader assumes that last row is [0,0,0,1]
-            // so we make the same assumption in the following transformation.
+    FILAMENT_CHECK_PRECONDITION(mOwner->mResourcesLoaded)
+            << "Do not call recomputeBoundingBoxes before loadResources or asyncBeginLoad";
 
-            const float3 skinnedPoint =
-                    point.x * skinMatrix[0].xyz +
-                    point.y * skinMatrix[1].xyz +
-                    point.z * skinMatrix[2].xyz +
-                    skinMatrix[3].xyz;
+    // vertices of skinned primitives are processed by jobs of this many vertices
+    constexpr size_t VERTICES_PER_JOB = 16384;
 
-            aabb.min = min(aabb.min, skinnedPoint);
-            aabb.max = max(aabb.max, skinnedPoint);
-        }
-        return aabb;
-    };
+    auto& rm = mOwner->mEngine->getRenderableManager();
+    auto& tm = mOwner->mEngine->getTransformManager();
+    JobSystem& js = mOwner->mEngine->getJobSystem();
 
-    // Collect all mesh primitives that we wish to find bounds for. For each mesh primitive, we also
-    // collect the skin it is bound to (nullptr if not skinned) for bounds computation.
-    size_t primCount = 0;
     const cgltf_data* hierarchy = mOwner->mSourceAsset->hierarchy;
     const cgltf_node* nodes = hierarchy->nodes;
-    for (size_t i = 0, n = hierarchy->nodes_count; i < n; ++i) {
-        if (const cgltf_mesh* mesh = nodes[i].mesh; mesh) {
-            primCount += mesh->primitives_count;
+
+    // Collect all mesh primitives that we wish to find bounds for, along with the skin they are
+    // bound to (-1 if not skinned), then compute what doesn't depend on the pose. This is only
+    // done once, which makes this function cheap enough to be called every frame.
+    if (!mBoundsCache) {
+        mBoundsCache = std::make_unique<BoundsCache>();
+        size_t primCount = 0;
+        for (size_t i = 0, n = hierarchy->nodes_count; i < n; ++i) {
+            if (const cgltf_mesh* mesh = nodes[i].mesh; mesh && !mNodeMap[i].isNull()) {
+                primCount += mesh->primitives_count;
+            }
         }
-    }
-    auto primitives = FixedCapacityVector<Prim>::with_capacity(primCount);
-    const cgltf_skin* baseSkin = &hierarchy->skins[0];
-    for (size_t i = 0, n = hierarchy->nodes_count; i < n; ++i) {
-        const cgltf_node& node = nodes[i];
-        const Entity entity = mNodeMap[i];
-        if (entity.isNull()) {
-            continue;
+        auto& primitives = mBoundsCache->primitives;
+        primitives = FixedCapacityVector<BoundsCache::Primitive>::with_capacity(primCount);
+        const cgltf_skin* baseSkin = &hierarchy->skins[0];
+        for (size_t i = 0, n = hierarchy->nodes_count; i < n; ++i) {
+            const cgltf_node& node = nodes[i];
+            const Entity entity = mNodeMap[i];
+            if (entity.isNull()) {
+                continue;
+            }
+            if (const cgltf_mesh* mesh = node.mesh; mesh) {
+                for (cgltf_size j = 0, nprims = mesh->primitives_count; j < nprims; ++j) {
+                    primitives.push_back({
+                        .prim = &mesh->primitives[j],
+                        .node = entity,
+                        .skinIndex = node.skin ? (node.skin - baseSkin) : -1
+                    });
+                }
+            }
         }
-        if (const cgltf_mesh* mesh = node.mesh; mesh) {
-            for (cgltf_size j = 0, nprims = mesh->primitives_count; j < nprims; ++j) {
-                primitives.push_back({
-                    .prim = &mesh->primitives[j],
-                    .node = entity,
-                    .skinIndex = node.skin ? (node.skin - baseSkin) : -1
-                });
+
+        JobSystem::Job* parent = js.createJob();
+        for (auto& prim : primitives) {
+            js.run(jobs::createJob(js, parent, [&prim] {
+                if (prim.skinIndex >= 0) {
+                    unpackSkinnedAttributes(prim);
+                }
+                // a primitive without joints or weights is not skinned, whatever its node says
+                if (prim.joints.empty() || prim.weights.empty()) {
+                    prim.skinIndex = -1;
+                    prim.positions.clear();
+                    prim.bounds = computeBoundingBox(prim.prim);
+                }
+            }));
+        }
+        js.runAndWait(parent);
+    }
+
+    auto& primitives = mBoundsCache->primitives;
+
+    if (skinnedBounds == SkinnedBounds::JOINTS) {
+        JobSystem::Job* parent = js.createJob();
+        for (auto& prim : primitives) {
+            if (prim.skinIndex < 0 || !prim.jointBounds.empty()) {
+                continue;
             }
+            js.run(jobs::createJob(js, parent, [&prim, this] {
+                auto const& inverseBindMatrices =
+                        mOwner->mSkins[prim.skinIndex].inverseBindMatrices;
+                prim.jointBounds = FixedCapacityVector<Aabb>(inverseBindMatrices.size());
+                for (size_t i = 0, n = prim.positions.size(); i < n; i++) {
+                    for (size_t j = 0; j < 4; j++) {
+                        if (prim.weights[i][j] > 0.0f) {
+                            size_t const jointIndex = prim.joints[i][j];
+                            mat4f const& m = inverseBindMatrices[jointIndex];
+                            float3 const p = (m * float4(prim.positions[i], 1.0f)).xyz;
+                            Aabb& aabb = prim.jointBounds[jointIndex];
+                            aabb.min = min(aabb.min, p);
+                            aabb.max = max(aabb.max, p);
+                        }
+                    }
+                }
+            }));
         }
+        js.runAndWait(parent);
     }
 
-    // Kick off a bounding box job for every primitive.
+    // The purpose of the root node is to give the client a place for custom transforms.
+    // Since it is not part of the source model, it should be ignored when computing the
+    // bounding box.
+    TransformManager::Instance root = tm.getInstance(mOwner->getRoot());
+    utils::FixedCapacityVector<Entity> modelRoots(tm.getChildCount(root));
+    tm.getChildren(root, modelRoots.data(), modelRoots.size());
+    for (auto e : modelRoots) {
+        tm.setParent(tm.getInstance(e), 0);
+    }
+
+    // The world transform of each joint is only looked up once, rather than for each vertex.
+    FixedCapacityVector<FixedCapacityVector<mat4f>> jointTransforms(mSkins.size());
+    for (size_t i = 0, n = mSkins.size(); i < n; i++) {
+        auto const& joints = mSkins[i].joints;
+        jointTransforms[i] = FixedCapacityVector<mat4f>(joints.size());
+        for (size_t j = 0, c = joints.size(); j < c; j++) {
+            jointTransforms[i][j] = tm.getWorldTransform(tm.getInstance(joints[j]));
+        }
+    }
+
+    // Transforms from the bind space of each joint to the space of the skinned primitive, with
+    // the inverse bind matrices included for SkinnedBounds::VERTICES.
+    FixedCapacityVector<FixedCapacityVector<mat4f>> skinMatrices(primitives.size());
     FixedCapacityVector<Aabb> bounds(primitives.size());
-    JobSystem& js = mOwner->mEngine->getJobSystem();
-    JobSystem::Job* parent = js.createJob();
-    for (size_t i = 0; i < primitives.size(); ++i) {
-        Aabb& result = bounds[i];
-        const Prim& prim = primitives[i];
-        if (primitives[i].skinIndex < 0) {
-            js.run(jobs::createJob(js, parent, [&prim, &result, computeBoundingBox] {
-                result = computeBoundingBox(prim.prim);
-            }));
+    size_t jobCount = 0;
+    for (size_t i = 0, n = primitives.size(); i < n; i++) {
+        auto const& prim = primitives[i];
+        if (prim.skinIndex < 0) {
+            bounds[i] = prim.bounds;
+            continue;
+        }
+        auto const& inverseBindMatrices = mOwner->mSkins[prim.skinIndex].inverseBindMatrices;
+        auto const& transforms = jointTransforms[prim.skinIndex];
+        mat4f const inverseGlobalTransform =
+                inverse(tm.getWorldTransform(tm.getInstance(prim.node)));
+        auto& matrices = skinMatrices[i];
+        matrices = FixedCapacityVector<mat4f>(transforms.size());
+        for (size_t j = 0, c = transforms.size(); j < c; j++) {
+            matrices[j] = skinnedBounds == SkinnedBounds::VERTICES ?
+                    inverseGlobalTransform * transforms[j] * inverseBindMatrices[j] :
+                    inverseGlobalTransform * transforms[j];
+        }
+        if (skinnedBounds == SkinnedBounds::JOINTS) {
+            // NOTE: the weights add up to 1, so every skinned vertex is inside the convex hull
+            // of its transformed joint boxes.
+            Aabb aabb;
+            size_t const count = std::min(prim.jointBounds.size(), matrices.size());
+            for (size_t j = 0; j < count; j++) {
+                Aabb const& jointBounds = prim.jointBounds[j];
+                if (jointBounds.min.x <= jointBounds.max.x) {
+                    mat4f const& m = matrices[j];
+                    Aabb const transformed = Aabb::transform(m.upperLeft(), m[3].xyz, jointBounds);
+                    aabb.min = min(aabb.min, transformed.min);
+                    aabb.max = max(aabb.max, transformed.max);
+                }
+            }
+            bounds[i] = aabb;
         } else {
-            js.run(jobs::createJob(js, parent, [&prim, &result, computeBoundingBoxSkinned] {
-                result = computeBoundingBoxSkinned(prim);
-            }));
+            jobCount += (prim.positions.size() + VERTICES_PER_JOB - 1) / VERTICES_PER_JOB;
         }
     }
-    js.runAndWait(parent);
 
-    // Compute the asset-level bounding box.
+    // Skin the vertices in parallel, each job bounds a range of vertices of a primitive, the
+    // ranges are then merged.
+    if (jobCount) {
+        FixedCapacityVector<Aabb> partialBounds(jobCount);
+        FixedCapacityVector<size_t> partialPrims(jobCount);
+        JobSystem::Job* parent = js.createJob();
+        size_t job = 0;
+        for (size_t i = 0, n = primitives.size(); i < n; i++) {
+            auto const& prim = primitives[i];
+            if (prim.skinIndex < 0) {
+                continue;
+            }
+            size_t const count = prim.positions.size();
+            for (size_t begin = 0; begin < count; begin += VERTICES_PER_JOB) {
+                size_t const end = std::min(begin + VERTICES_PER_JOB, count);
+                Aabb& result = partialBounds[job];
+                partialPrims[job++] = i;
+                auto const& matrices = skinMatrices[i];
+                js.run(jobs::createJob(js, parent, [&prim, &matrices, &result, begin, end] {
+                    // NOTE: Filament's vertex shader assumes that last row is [0,0,0,1]
+                    // so we make the same assumption in the following transformation.
+                    Aabb aabb;
+                    for (size_t v = begin; v < end; v++) {
+                        float3 const point = prim.positions[v];
+                        float3 skinnedPoint = 0.0f;
+                        for (size_t j = 0; j < 4; j++) {
+                            mat4f const& m = matrices[prim.joints[v][j]];
+                            skinnedPoint += prim.weights[v][j] * (
+                                    point.x * m[0].xyz +
+                                    point.y * m[1].xyz +
+                                    point.z * m[2].xyz +
+                                    m[3].xyz);
+                        }
+                        aabb.min = min(aabb.min, skinnedPoint);
+                        aabb.max = max(aabb.max, skinnedPoint);
+                    }
+                    result = aabb;
+                }));
+            }
+        }
+        js.runAndWait(parent);
+        for (size_t j = 0; j < jobCount; j++) {
+            Aabb& aabb = bounds[partialPrims[j]];
+            aabb.min = min(aabb.min, partialBounds[j].min);
+            aabb.max = max(aabb.max, partialBounds[j].max);
+        }
+    }
+
+    // Compute the asset-level bounding box. Primitives were collected in node order, so the
+    // primitives of a mesh are contiguous.
     size_t primIndex = 0;
     Aabb assetBounds;
-    for (size_t i = 0, n = mOwner->mSourceAsset->hierarchy->nodes_count; i < n; ++i) {
+    for (size_t i = 0, n = hierarchy->nodes_count; i < n; ++i) {
         const cgltf_node& node = nodes[i];
         const Entity entity = mNodeMap[i];
-        if (const cgltf_mesh* mesh = node.mesh; mesh) {
+        if (const cgltf_mesh* mesh = node.mesh; mesh && !entity.isNull()) {
             // Find the object-space bounds for the renderable by unioning the bounds of each prim.
             Aabb aabb;
             for (cgltf_size j = 0, nprims = mesh->primitives_count; j < nprims; ++j) {
@@ -326,6 +450,10 @@ void FFilamentInstance::recomputeBoundingBoxes() {
     mBoundingBox = assetBounds;
 }
 
+void FFilamentInstance::releaseBoundsCache() noexcept {
+    mBoundsCache.reset();
+}
+
 size_t FFilamentInstance::getMaterialVariantCount() const noexcept {
     return mVariants.size();
 }
@@ -426,8 +554,8 @@ math::mat4f const* FilamentInstance::getInverseBindMatricesAt(size_t skinIndex)
     return downcast(this)->getInverseBindMatricesAt(skinIndex);
 }
 
-void FilamentInstance::recomputeBoundingBoxes() {
-    return downcast(this)->recomputeBoundingBoxes();
+void FilamentInstance::recomputeBoundingBoxes(SkinnedBounds skinnedBounds) {
+    return downcast(this)->recomputeBoundingBoxes(skinnedBounds);
 }
 
 Aabb FilamentInstance::getBoundingBox() const noexcept {
@@ -265,4 +265,29 @@ inline bool getElementType(cgltf_type type, cgltf_component_type ctype,
     return false;
 }
 
+// The 8-bit and unsigned 16-bit vec3 types allowed by KHR_mesh_quantization are not aligned to 4
+// bytes, so getElementType() doesn't permit them. Rather than converting them to floats, they can
+// be padded to 4 components which keeps them compact on the GPU.
+//
+// Returns false if the given type doesn't need padding.
+inline bool getPaddedElementType(cgltf_type type, cgltf_component_type ctype,
+        filament::VertexBuffer::AttributeType* paddedType) {
+    if (type != cgltf_type_vec3) {
+        return false;
+    }
+    switch (ctype) {
+        case cgltf_component_type_r_8:
+            *paddedType = filament::VertexBuffer::AttributeType::BYTE4;
+            return true;
+        case cgltf_component_type_r_8u:
+            *paddedType = filament::VertexBuffer::AttributeType::UBYTE4;
+            return true;
+        case cgltf_component_type_r_16u:
+            *paddedType = filament::VertexBuffer::AttributeType::USHORT4;
+            return true;
+        default:
+            return false;
+    }
+}
+
 #endif // GLTFIO_GLTFENUMS_H
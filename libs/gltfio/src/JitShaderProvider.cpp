@@ -18,11 +18,20 @@
 
 #include <filamat/MaterialBuilder.h>
 
+#include <filament/MaterialEnums.h>
+
 #include <utils/Hash.h>
+#include <utils/Log.h>
+#include <utils/Path.h>
 
 #include <tsl/robin_map.h>
 
+#include <fstream>
 #include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <string.h>
 
 using namespace filamat;
 using namespace filament;
@@ -31,9 +40,27 @@ using namespace utils;
 
 namespace {
 
+// Written at the start of every file in the on-disk cache. Everything but packageSize must match
+// for the cached package to be used, this guards against hash collisions and stale files.
+struct CacheHeader {
+    char magic[8];
+    uint32_t materialVersion;
+    uint8_t backend;
+    uint8_t stereoscopicType;
+    uint8_t stereoscopicEyeCount;
+    uint8_t optimizeShaders;
+    MaterialKey config;
+    UvMap uvmap;
+    uint32_t packageSize;
+};
+
+static_assert(sizeof(CacheHeader) % 4 == 0, "CacheHeader must be word-aligned for murmur3.");
+
+constexpr char CACHE_MAGIC[8] = { 'G', 'L', 'T', 'F', 'J', 'I', 'T', '1' };
+
 class JitShaderProvider : public MaterialProvider {
 public:
-    explicit JitShaderProvider(Engine* engine, bool optimizeShaders);
+    JitShaderProvider(Engine* engine, bool optimizeShaders, const char* cacheDirectory);
     ~JitShaderProvider() override;
 
     MaterialInstance* createMaterialInstance(MaterialKey* config, UvMap* uvmap,
@@ -54,13 +81,91 @@ public:
     std::vector<Material*> mMaterials;
     Engine* const mEngine;
     const bool mOptimizeShaders;
+    const utils::Path mCacheDirectory;
+
+private:
+    CacheHeader makeCacheHeader(MaterialKey const& config, UvMap const& uvmap,
+            bool optimizeShaders) const noexcept;
+    utils::Path getCachePath(CacheHeader const& header) const;
+    Material* loadCachedMaterial(CacheHeader const& header) const;
+    void storeCachedMaterial(CacheHeader header, filamat::Package const& pkg) const;
 };
 
-JitShaderProvider::JitShaderProvider(Engine* engine, bool optimizeShaders) : mEngine(engine),
-        mOptimizeShaders(optimizeShaders) {
+JitShaderProvider::JitShaderProvider(Engine* engine, bool optimizeShaders,
+        const char* cacheDirectory) : mEngine(engine), mOptimizeShaders(optimizeShaders),
+        mCacheDirectory(cacheDirectory ? cacheDirectory : "") {
     MaterialBuilder::init();
 }
 
+CacheHeader JitShaderProvider::makeCacheHeader(MaterialKey const& config, UvMap const& uvmap,
+        bool optimizeShaders) const noexcept {
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.materialVersion = uint32_t(MATERIAL_VERSION);
+    header.backend = uint8_t(mEngine->getBackend());
+    header.stereoscopicType = uint8_t(mEngine->getConfig().stereoscopicType);
+    header.stereoscopicEyeCount = mEngine->getConfig().stereoscopicEyeCount;
+    header.optimizeShaders = optimizeShaders;
+    header.config = config;
+    header.uvmap = uvmap;
+    return header;
+}
+
+utils::Path JitShaderProvider::getCachePath(CacheHeader const& header) const {
+    // The package size is not known until the material is built, so it's not part of the hash.
+    constexpr size_t wordCount = offsetof(CacheHeader, packageSize) / 4;
+    uint32_t const* const words = reinterpret_cast<uint32_t const*>(&header);
+    char name[32];
+    snprintf(name, sizeof(name), "%08x%08x.filamat",
+            hash::murmur3(words, wordCount, 0), hash::murmur3(words, wordCount, 0x9e3779b9u));
+    return mCacheDirectory.concat(name);
+}
+
+Material* JitShaderProvider::loadCachedMaterial(CacheHeader const& header) const {
+    std::ifstream in(getCachePath(header).c_str(), std::ios::binary | std::ios::ate);
+    if (!in) {
+        return nullptr;
+    }
+    size_t const size = size_t(in.tellg());
+    if (size <= sizeof(CacheHeader)) {
+        return nullptr;
+    }
+    in.seekg(0);
+    std::vector<char> data(size);
+    if (!in.read(data.data(), std::streamsize(size))) {
+        return nullptr;
+    }
+    CacheHeader const* const cached = reinterpret_cast<CacheHeader const*>(data.data());
+    if (memcmp(cached, &header, offsetof(CacheHeader, packageSize)) != 0 ||
+            cached->packageSize != size - sizeof(CacheHeader)) {
+        return nullptr;
+    }
+    return Material::Builder()
+            .package(data.data() + sizeof(CacheHeader), cached->packageSize)
+            .build(*mEngine);
+}
+
+void JitShaderProvider::storeCachedMaterial(CacheHeader header, Package const& pkg) const {
+    // Write to a temporary file first so that a partially written file is never picked up.
+    utils::Path const path = getCachePath(header);
+    std::string const tmp = path.getPath() + ".tmp";
+    header.packageSize = uint32_t(pkg.getSize());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        out.write(reinterpret_cast<char const*>(pkg.getData()), std::streamsize(pkg.getSize()));
+        if (!out) {
+            slog.w << "Unable to write material cache file " << tmp << io::endl;
+            return;
+        }
+    }
+    remove(path.c_str());
+    if (rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+    }
+}
+
 JitShaderProvider::~JitShaderProvider() {
     MaterialBuilder::shutdown();
 }
@@ -343,7 +448,7 @@ std::string shaderFromKey(const MaterialKey& config) {
     return shader;
 }
 
-Material* createMaterial(Engine* engine, const MaterialKey& config, const UvMap& uvmap,
+Package createPackage(Engine* engine, const MaterialKey& config, const UvMap& uvmap,
         const char* name, bool optimizeShaders) {
     std::string shader = shaderFromKey(config);
     processShaderString(&shader, uvmap, config);
@@ -581,8 +686,7 @@ Material* createMaterial(Engine* engine, const MaterialKey& config, const UvMap&
         builder.shading(Shading::LIT);
     }
 
-    Package pkg = builder.build(engine->getJobSystem());
-    return Material::Builder().package(pkg.getData(), pkg.getSize()).build(*engine);
+    return builder.build(engine->getJobSystem());
 }
 
 Material* JitShaderProvider::getMaterial(MaterialKey* config, UvMap* uvmap, const char* label) {
@@ -595,7 +699,19 @@ Material* JitShaderProvider::getMaterial(MaterialKey* config, UvMap* uvmap, cons
         optimizeShaders = false;
 #endif
 
-        Material* mat = createMaterial(mEngine, *config, *uvmap, label, optimizeShaders);
+        Material* mat = nullptr;
+        CacheHeader header;
+        if (!mCacheDirectory.isEmpty()) {
+            header = makeCacheHeader(*config, *uvmap, optimizeShaders);
+            mat = loadCachedMaterial(header);
+        }
+        if (!mat) {
+            Package pkg = createPackage(mEngine, *config, *uvmap, label, optimizeShaders);
+            if (!mCacheDirectory.isEmpty() && pkg.isValid()) {
+                storeCachedMaterial(header, pkg);
+            }
+            mat = Material::Builder().package(pkg.getData(), pkg.getSize()).build(*mEngine);
+        }
         mCache.emplace(std::make_pair(*config, mat));
         mMaterials.push_back(mat);
         return mat;
@@ -613,7 +729,12 @@ MaterialInstance* JitShaderProvider::createMaterialInstance(MaterialKey* config,
 namespace filament::gltfio {
 
 MaterialProvider* createJitShaderProvider(filament::Engine* engine, bool optimizeShaders) {
-    return new JitShaderProvider(engine, optimizeShaders);
+    return new JitShaderProvider(engine, optimizeShaders, nullptr);
+}
+
+MaterialProvider* createJitShaderProvider(filament::Engine* engine, bool optimizeShaders,
+        const char* cacheDirectory) {
+    return new JitShaderProvider(engine, optimizeShaders, cacheDirectory);
 }
 
 } // namespace filament::gltfio
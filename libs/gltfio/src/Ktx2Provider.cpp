@@ -70,6 +70,8 @@ private:
         ktxreader::Ktx2Reader::Async* async;
         QueueItemState state;
         atomic<TranscoderState> transcoderState;
+        atomic<uint32_t> pendingLevelCount;
+        atomic<bool> failed;
         JobSystem::Job* job;
     };
 
@@ -115,12 +117,27 @@ Texture* Ktx2Provider::pushTexture(const uint8_t* data, size_t byteCount,
         return async->getTexture();
     }
 
+    // Each level is transcoded in its own job, smallest first, and the last one to finish
+    // publishes the result. The item's job is their parent, so waiting on it waits for all levels,
+    // and cancelling it makes the levels that haven't started skip their transcoding.
     JobSystem* js = &mEngine->getJobSystem();
-    item->job = jobs::createJob(*js, mDecoderRootJob, [item] {
-        using Result = ktxreader::Ktx2Reader::Result;
-        const bool success = Result::SUCCESS == item->async->doTranscoding();
-        item->transcoderState.store(success ? TranscoderState::SUCCESS : TranscoderState::ERROR);
-    });
+    const uint32_t levelCount = async->getLevelCount();
+    item->pendingLevelCount.store(levelCount);
+    item->failed.store(false);
+    item->job = js->createJob(mDecoderRootJob);
+    for (uint32_t levelIndex = levelCount; levelIndex-- > 0;) {
+        js->run(jobs::createJob(*js, item->job, [item, levelIndex] {
+            using Result = ktxreader::Ktx2Reader::Result;
+            if (JobSystem::isCancellationRequested(item->job) ||
+                    Result::SUCCESS != item->async->doTranscoding(levelIndex)) {
+                item->failed.store(true);
+            }
+            if (item->pendingLevelCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                item->transcoderState.store(item->failed.load() ?
+                        TranscoderState::ERROR : TranscoderState::SUCCESS);
+            }
+        }));
+    }
 
     js->runAndRetain(item->job);
     return async->getTexture();
@@ -160,7 +177,11 @@ void Ktx2Provider::updateQueue() {
         }
         item->async->getTexture();
         const TranscoderState state = item->transcoderState.load();
-        if (state != TranscoderState::NOT_STARTED) {
+        if (state == TranscoderState::NOT_STARTED) {
+            // Upload the levels transcoded so far, smallest first, so the texture can be used at
+            // a lower resolution until it's complete.
+            item->async->uploadImages();
+        } else {
             if (item->job) {
                 js->waitAndRelease(item->job);
             }
@@ -193,9 +214,12 @@ void Ktx2Provider::waitForCompletion() {
 }
 
 void Ktx2Provider::cancelDecoding() {
-    // TODO: Currently, Ktx2Provider runs jobs eagerly and JobSystem does not allow cancellation of
-    // in-flight jobs. We should consider throttling the number of simultaneous decoder jobs, which
-    // would allow for actual cancellation.
+    // Levels that haven't started yet are skipped, the ones that are transcoding must still finish.
+    for (auto& item : mQueueItems) {
+        if (item->job) {
+            JobSystem::requestCancellation(item->job);
+        }
+    }
     waitForCompletion();
 
     // For cancelled jobs, we need to set the QueueItemState to POPPED and free the decoded data
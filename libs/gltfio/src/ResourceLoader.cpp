@@ -20,6 +20,7 @@
 #include "GltfEnums.h"
 #include "FFilamentAsset.h"
 #include "TangentsJob.h"
+#include "TextureAtlas.h"
 #include "downcast.h"
 #include "Utility.h"
 #include "extended/ResourceLoaderExtended.h"
@@ -27,11 +28,14 @@
 #include <filament/BufferObject.h>
 #include <filament/Engine.h>
 #include <filament/IndexBuffer.h>
+#include <filament/Material.h>
 #include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
 #include <filament/Texture.h>
 #include <filament/VertexBuffer.h>
 #include <filament/MorphTargetBuffer.h>
 
+#include <geometry/IndexOptimizer.h>
 #include <geometry/Transcoder.h>
 
 #include <utils/compiler.h>
@@ -49,10 +53,17 @@
 
 #include <tsl/robin_map.h>
 
+#include <stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <fstream>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 using namespace filament;
 using namespace filament::math;
@@ -68,12 +79,16 @@ using BufferTextureCache = tsl::robin_map<const void*, Texture*>;
 using FilepathTextureCache = tsl::robin_map<std::string, Texture*>;
 using TextureProviderList = tsl::robin_map<std::string, TextureProvider*>;
 
+// The scale (xy) and offset (zw) to apply to each UV set whose texture was packed into an atlas.
+using AtlasUvTransforms = tsl::robin_map<cgltf_accessor const*, float4>;
+
 namespace {
 enum class CacheResult {
     ERROR,
     NOT_READY,
     FOUND,
     MISS,
+    SHARED,
 };
 } // anonymous namespace
 
@@ -81,11 +96,21 @@ struct ResourceLoader::Impl {
     explicit Impl(const ResourceConfiguration& config) :
         mEngine(config.engine),
         mNormalizeSkinningWeights(config.normalizeSkinningWeights),
+        mOptimizeIndices(config.optimizeIndices),
+        mTextureAtlasSize(config.textureAtlasSize),
+        mTextureAtlasMaxImageSize(config.textureAtlasMaxImageSize),
         mGltfPath(config.gltfPath ? config.gltfPath : ""),
-        mUriDataCache(std::make_shared<UriDataCache>()) {}
+        mUriDataCache(std::make_shared<UriDataCache>()) {
+        if (config.shareTextures) {
+            mTextureCache = std::make_shared<TextureCache>(mEngine);
+        }
+    }
 
     Engine* const mEngine;
     bool mNormalizeSkinningWeights;
+    bool mOptimizeIndices;
+    uint32_t mTextureAtlasSize;
+    uint32_t mTextureAtlasMaxImageSize;
     std::string mGltfPath;
 
     // User-provided resource data with URI string keys, populated with addResourceData().
@@ -99,15 +124,28 @@ struct ResourceLoader::Impl {
     BufferTextureCache mBufferTextureCache;
     FilepathTextureCache mFilepathTextureCache;
 
+    // Textures shared between all the assets loaded with this loader, keyed by their content.
+    // This is null unless ResourceConfiguration::shareTextures is enabled.
+    TextureCacheHandle mTextureCache;
+
+    // Shared textures found while loading the current asset, they are fully decoded already.
+    std::vector<Texture*> mSharedTextures;
+
     FFilamentAsset* mAsyncAsset = nullptr;
     size_t mRemainingTextureDownloads = 0;
 
     void addResourceData(const char* uri, BufferDescriptor&& buffer);
     void computeTangents(FFilamentAsset* asset);
     void createTextures(FFilamentAsset* asset, bool async);
+    AtlasUvTransforms packTextures(FFilamentAsset* asset);
+    bool getImageData(FFilamentAsset* asset, size_t textureIndex, std::string* mime,
+            std::vector<uint8_t>* data);
     void cancelTextureDecoding();
+    void markSharedTexturesReady(FFilamentAsset* asset);
     std::pair<Texture*, CacheResult> getOrCreateTexture(FFilamentAsset* asset, size_t textureIndex,
             TextureProvider::TextureFlags flags);
+    std::pair<Texture*, CacheResult> pushTexture(TextureProvider* provider, const uint8_t* data,
+            size_t byteCount, const std::string& mime, TextureProvider::TextureFlags flags);
     ~Impl();
 };
 
@@ -227,15 +265,268 @@ inline void createSkins(cgltf_data const* gltf, bool normalize,
     }
 }
 
+// Returns a copy of the indices of a triangle list, with its triangles reordered for the vertex
+// cache and overdraw, or nullptr if the primitive can't be optimized. The copy uses 16-bit indices
+// unless the accessor has 32-bit indices, and must be freed with free().
+template<typename T>
+T* optimizeIndices(cgltf_primitive const* prim, size_t* size) {
+    cgltf_accessor const* const indices = prim->indices;
+    cgltf_accessor const* positions = nullptr;
+    for (cgltf_size i = 0; i < prim->attributes_count; i++) {
+        if (prim->attributes[i].type == cgltf_attribute_type_position) {
+            positions = prim->attributes[i].data;
+        }
+    }
+    if (!positions || positions->type != cgltf_type_vec3 || indices->count % 3 != 0) {
+        return nullptr;
+    }
+
+    std::vector<float3> vertices(positions->count);
+    cgltf_accessor_unpack_floats(positions, &vertices.data()->x, positions->count * 3);
+
+    *size = indices->count * sizeof(T);
+    T* const data = (T*) malloc(*size);
+    for (cgltf_size i = 0; i < indices->count; i++) {
+        data[i] = T(cgltf_accessor_read_index(indices, i));
+        if (UTILS_UNLIKELY(data[i] >= vertices.size())) {
+            free(data);
+            return nullptr;
+        }
+    }
+    geometry::IndexOptimizer({})(data, indices->count, vertices.data(), vertices.size());
+    return data;
+}
+
+// Uploads a morph target stored as sparse deltas over zeros, the accessor has no buffer view.
+void uploadSparseMorphTarget(Engine& engine,
+        FFilamentAsset::ResourceInfo::BufferSlot const& slot) {
+    cgltf_accessor const* const accessor = slot.accessor;
+    cgltf_accessor_sparse const& sparse = accessor->sparse;
+    uint8_t const* indices = cgltf_buffer_view_data(sparse.indices_buffer_view);
+    uint8_t const* values = cgltf_buffer_view_data(sparse.values_buffer_view);
+    if (accessor->type != cgltf_type_vec3 || !indices || !values) {
+        return;
+    }
+
+    if (accessor->component_type != cgltf_component_type_r_32f || accessor->normalized) {
+        // let cgltf convert the values, the buffer is dense in this case
+        std::vector<float3> positions(accessor->count);
+        cgltf_accessor_unpack_floats(accessor, &positions.data()->x, accessor->count * 3);
+        slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex, positions.data(),
+                slot.morphTargetCount, slot.morphTargetOffset);
+        return;
+    }
+
+    indices += sparse.indices_byte_offset;
+    values += sparse.values_byte_offset;
+    std::vector<uint32_t> vertices(sparse.count);
+    for (cgltf_size i = 0; i < sparse.count; i++) {
+        switch (sparse.indices_component_type) {
+            case cgltf_component_type_r_8u:
+                vertices[i] = indices[i];
+                break;
+            case cgltf_component_type_r_16u:
+                vertices[i] = ((uint16_t const*) indices)[i];
+                break;
+            default:
+                vertices[i] = ((uint32_t const*) indices)[i];
+                break;
+        }
+    }
+    slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex, vertices.data(),
+            (float3 const*) values, sparse.count, slot.morphTargetOffset, slot.morphTargetCount);
+}
+
+// Returns all the texture views of a material, the base color comes first.
+std::array<cgltf_texture_view const*, 19> getTextureViews(cgltf_material const& material) {
+    return {
+            &material.pbr_metallic_roughness.base_color_texture,
+            &material.pbr_metallic_roughness.metallic_roughness_texture,
+            &material.pbr_specular_glossiness.diffuse_texture,
+            &material.pbr_specular_glossiness.specular_glossiness_texture,
+            &material.clearcoat.clearcoat_texture,
+            &material.clearcoat.clearcoat_roughness_texture,
+            &material.clearcoat.clearcoat_normal_texture,
+            &material.transmission.transmission_texture,
+            &material.specular.specular_texture,
+            &material.specular.specular_color_texture,
+            &material.volume.thickness_texture,
+            &material.sheen.sheen_color_texture,
+            &material.sheen.sheen_roughness_texture,
+            &material.iridescence.iridescence_texture,
+            &material.iridescence.iridescence_thickness_texture,
+            &material.anisotropy.anisotropy_texture,
+            &material.normal_texture,
+            &material.occlusion_texture,
+            &material.emissive_texture,
+    };
+}
+
+// Returns the texture of a material that could sample it from an atlas, or nullptr. The material
+// must have a single texture, which is an untransformed base color texture.
+cgltf_texture const* getPackableTexture(cgltf_material const* material) {
+    if (!material || !material->has_pbr_metallic_roughness ||
+            material->has_pbr_specular_glossiness) {
+        return nullptr;
+    }
+    auto const views = getTextureViews(*material);
+    cgltf_texture_view const& baseColor = *views[0];
+    if (!baseColor.texture || baseColor.has_transform || !baseColor.texture->image ||
+            baseColor.texture->basisu_image) {
+        return nullptr;
+    }
+    for (size_t i = 1; i < views.size(); i++) {
+        if (views[i]->texture) {
+            return nullptr;
+        }
+    }
+    return baseColor.texture;
+}
+
+cgltf_accessor const* getTexCoords(cgltf_primitive const* prim, cgltf_int set) {
+    for (cgltf_size i = 0; i < prim->attributes_count; i++) {
+        cgltf_attribute const& attribute = prim->attributes[i];
+        if (attribute.type == cgltf_attribute_type_texcoord && attribute.index == set) {
+            return attribute.data;
+        }
+    }
+    return nullptr;
+}
+
+// Checks that a UV set can be remapped to an atlas in place. Bytes don't have enough precision
+// for an atlas, and the UVs must stay within the image since the atlas can't repeat it.
+bool isPackableUvSet(cgltf_accessor const* uvs) {
+    if (uvs->type != cgltf_type_vec2 || uvs->is_sparse || !uvs->buffer_view ||
+            !cgltf_buffer_view_data(uvs->buffer_view)) {
+        return false;
+    }
+    bool const supported = uvs->component_type == cgltf_component_type_r_32f ||
+            (uvs->component_type == cgltf_component_type_r_16u && uvs->normalized);
+    if (!supported || utility::requiresConversion(uvs)) {
+        return false;
+    }
+    constexpr float epsilon = 0.001f;
+    for (cgltf_size i = 0; i < uvs->count; i++) {
+        float2 uv;
+        cgltf_accessor_read_float(uvs, i, &uv.x, 2);
+        if (any(lessThan(uv, float2(-epsilon))) || any(greaterThan(uv, float2(1.0f + epsilon)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns a copy of the vertex data of a UV set, with its UVs moved to their place in an atlas.
+void* remapUvs(cgltf_accessor const* uvs, uint8_t const* data, uint32_t size, float4 transform) {
+    uint8_t* const result = (uint8_t*) malloc(size);
+    memcpy(result, data, size);
+    for (cgltf_size i = 0; i < uvs->count; i++) {
+        float2 uv;
+        cgltf_accessor_read_float(uvs, i, &uv.x, 2);
+        uv = saturate(uv) * transform.xy + transform.zw;
+        uint8_t* const element = result + i * uvs->stride;
+        if (uvs->component_type == cgltf_component_type_r_32f) {
+            memcpy(element, &uv, sizeof(uv));
+        } else {
+            ushort2 const quantized = ushort2(round(uv * float(UINT16_MAX)));
+            memcpy(element, &quantized, sizeof(quantized));
+        }
+    }
+    return result;
+}
+
+// Lets the primitives whose materials only differ by their base color texture share a material
+// instance when their textures were packed into the same page, so that they can be batched.
+void shareMaterialInstances(FFilamentAsset* asset) {
+    cgltf_data const* const gltf = asset->mSourceAsset->hierarchy;
+    RenderableManager& rcm = asset->mEngine->getRenderableManager();
+    for (FFilamentInstance* instance : asset->mInstances) {
+        tsl::robin_map<std::string, MaterialInstance*> sharedInstances;
+        for (cgltf_size nodeIndex = 0; nodeIndex < gltf->nodes_count; nodeIndex++) {
+            cgltf_mesh const* const mesh = gltf->nodes[nodeIndex].mesh;
+            auto const ri = rcm.getInstance(instance->mNodeMap[nodeIndex]);
+            if (!mesh || !ri) {
+                continue;
+            }
+            size_t const count = std::min(rcm.getPrimitiveCount(ri), mesh->primitives_count);
+            for (size_t index = 0; index < count; index++) {
+                cgltf_primitive const& prim = mesh->primitives[index];
+                cgltf_texture const* const texture = getPackableTexture(prim.material);
+                if (!texture || prim.mappings_count) {
+                    continue;
+                }
+                FFilamentAsset::TextureInfo const& info =
+                        asset->mTextures[size_t(texture - gltf->textures)];
+                if (!info.isPacked) {
+                    continue;
+                }
+
+                // The key is the material without the things that don't reach the shader. The
+                // copy keeps the padding bytes, which cgltf zeroes.
+                cgltf_material material;
+                memcpy(&material, prim.material, sizeof(material));
+                material.name = nullptr;
+                material.extras = {};
+                material.extensions_count = 0;
+                material.extensions = nullptr;
+                material.pbr_metallic_roughness.base_color_texture.texture = nullptr;
+
+                MaterialInstance* const mi = rcm.getMaterialInstanceAt(ri, index);
+                Material const* const ma = mi->getMaterial();
+                bool const hasVertexColor =
+                        utility::primitiveHasVertexColor(const_cast<cgltf_primitive*>(&prim));
+                std::string key((char const*) &material, sizeof(material));
+                key.append((char const*) &ma, sizeof(ma));
+                key.append((char const*) &info.texture, sizeof(info.texture));
+                key.push_back(char(hasVertexColor));
+
+                auto const [iter, inserted] = sharedInstances.emplace(std::move(key), mi);
+                if (!inserted && iter->second != mi) {
+                    rcm.setMaterialInstanceAt(ri, index, iter->second);
+                }
+            }
+        }
+    }
+}
+
 inline void uploadBuffers(FFilamentAsset* asset, Engine& engine,
-        UriDataCacheHandle uriDataCache) {
+        UriDataCacheHandle uriDataCache, bool optimize, AtlasUvTransforms const& uvTransforms) {
+    // Find the triangle lists whose index buffers can be optimized.
+    tsl::robin_map<cgltf_accessor const*, cgltf_primitive const*> trianglesByIndices;
+    if (optimize) {
+        auto const& primitives =
+                std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mPrimitives;
+        for (auto const& [prim, vertexBuffer]: primitives) {
+            if (prim->indices && prim->type == cgltf_primitive_type_triangles) {
+                trianglesByIndices.emplace(prim->indices, prim);
+            }
+        }
+    }
+
     // Upload VertexBuffer and IndexBuffer data to the GPU.
     auto& slots = std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mBufferSlots;
     for (auto const& slot: slots) {
         const cgltf_accessor* accessor = slot.accessor;
         if (!accessor->buffer_view) {
+            if (slot.morphTargetBuffer && accessor->is_sparse) {
+                uploadSparseMorphTarget(engine, slot);
+            }
             continue;
         }
+        if (slot.indexBuffer && optimize) {
+            // The triangles order doesn't matter to other primitives sharing the index buffer.
+            if (auto it = trianglesByIndices.find(accessor); it != trianglesByIndices.end()) {
+                size_t size = 0;
+                void* const data = accessor->component_type == cgltf_component_type_r_32u ?
+                        (void*) optimizeIndices<uint32_t>(it->second, &size) :
+                        (void*) optimizeIndices<uint16_t>(it->second, &size);
+                if (data) {
+                    slot.indexBuffer->setBuffer(engine,
+                            IndexBuffer::BufferDescriptor(data, size, FREE_CALLBACK));
+                    continue;
+                }
+            }
+        }
         const uint8_t* bufferData = nullptr;
         const uint8_t* data = nullptr;
         if (accessor->buffer_view->has_meshopt_compression) {
@@ -248,6 +539,18 @@ inline void uploadBuffers(FFilamentAsset* asset, Engine& engine,
         assert_invariant(bufferData);
         const uint32_t size = utility::computeBindingSize(accessor);
         if (slot.vertexBuffer) {
+            if (utility::requiresPadding(accessor)) {
+                const size_t paddedByteCount = accessor->count * 4 *
+                        cgltf_component_size(accessor->component_type);
+                void* paddedData = malloc(paddedByteCount);
+                utility::padAttributes(paddedData, data, accessor);
+                BufferObject* bo = BufferObject::Builder().size(paddedByteCount).build(engine);
+                asset->mBufferObjects.push_back(bo);
+                bo->setBuffer(engine, BufferDescriptor(paddedData, paddedByteCount, FREE_CALLBACK));
+                slot.vertexBuffer->setBufferObjectAt(engine, slot.bufferIndex, bo);
+                continue;
+            }
+
             if (utility::requiresConversion(accessor)) {
                 const size_t floatsCount = accessor->count * cgltf_num_components(accessor->type);
                 const size_t floatsByteCount = sizeof(float) * floatsCount;
@@ -260,6 +563,15 @@ inline void uploadBuffers(FFilamentAsset* asset, Engine& engine,
                 continue;
             }
 
+            if (auto it = uvTransforms.find(accessor); it != uvTransforms.end()) {
+                void* const uvs = remapUvs(accessor, data, size, it->second);
+                BufferObject* bo = BufferObject::Builder().size(size).build(engine);
+                asset->mBufferObjects.push_back(bo);
+                bo->setBuffer(engine, BufferDescriptor(uvs, size, FREE_CALLBACK));
+                slot.vertexBuffer->setBufferObjectAt(engine, slot.bufferIndex, bo);
+                continue;
+            }
+
             BufferObject* bo = BufferObject::Builder().size(size).build(engine);
             asset->mBufferObjects.push_back(bo);
             bo->setBuffer(engine, BufferDescriptor(data, size, uploadCallback,
@@ -328,7 +640,16 @@ ResourceLoader::~ResourceLoader() {
 
 void ResourceLoader::setConfiguration(const ResourceConfiguration& config) {
     pImpl->mNormalizeSkinningWeights = config.normalizeSkinningWeights;
+    pImpl->mOptimizeIndices = config.optimizeIndices;
+    pImpl->mTextureAtlasSize = config.textureAtlasSize;
+    pImpl->mTextureAtlasMaxImageSize = config.textureAtlasMaxImageSize;
     pImpl->mGltfPath = config.gltfPath;
+    // Assets that were loaded with sharing enabled keep their handle to the cache.
+    if (!config.shareTextures) {
+        pImpl->mTextureCache.reset();
+    } else if (!pImpl->mTextureCache) {
+        pImpl->mTextureCache = std::make_shared<TextureCache>(pImpl->mEngine);
+    }
 }
 
 void ResourceLoader::addResourceData(const char* uri, BufferDescriptor&& buffer) {
@@ -379,6 +700,7 @@ void ResourceLoader::Impl::addResourceData(const char* uri, BufferDescriptor&& b
     // If this is a texture and async loading has already started, add a new decoder job.
     if (isTexture(uri) && mAsyncAsset && mRemainingTextureDownloads > 0) {
         createTextures(mAsyncAsset, true);
+        markSharedTexturesReady(mAsyncAsset);
     }
 }
 
@@ -434,6 +756,16 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
         // as tangent generation.
         DracoCache* dracoCache = &asset->mSourceAsset->dracoCache;
         auto& primitives = std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mPrimitives;
+        // Decode all the Draco meshes concurrently first, this is by far the most expensive step.
+        std::vector<const cgltf_buffer_view*> dracoViews;
+        for (auto& [prim, vertexBuffer]: primitives) {
+            if (prim->has_draco_mesh_compression) {
+                dracoViews.push_back(prim->draco_mesh_compression.buffer_view);
+            }
+        }
+        if (!dracoViews.empty()) {
+            dracoCache->decodeMeshes(std::move(dracoViews), pImpl->mEngine->getJobSystem());
+        }
         // Go through every primitive and check if it has a Draco mesh.
         for (auto& [prim, vertexBuffer]: primitives) {
             if (!prim->has_draco_mesh_compression) {
@@ -441,9 +773,15 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
             }
             utility::decodeDracoMeshes(gltf, prim, dracoCache);
         }
-        utility::decodeMeshoptCompression((cgltf_data*) gltf);
-
-        uploadBuffers(asset, *pImpl->mEngine, pImpl->mUriDataCache);
+        utility::decodeMeshoptCompression((cgltf_data*) gltf, pImpl->mEngine->getJobSystem());
+
+        // The UVs of the packed textures are remapped while they're uploaded.
+        AtlasUvTransforms const uvTransforms = pImpl->packTextures(asset);
+        uploadBuffers(asset, *pImpl->mEngine, pImpl->mUriDataCache, pImpl->mOptimizeIndices,
+                uvTransforms);
+        if (!uvTransforms.empty()) {
+            shareMaterialInstances(asset);
+        }
 
         // Compute surface orientation quaternions if necessary. This is similar to sparse data in
         // that we need to generate the contents of a GPU buffer by processing one or more CPU
@@ -459,6 +797,11 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
 
     createSkins(gltf, pImpl->mNormalizeSkinningWeights, asset->mSkins);
 
+    for (auto const& instancing: asset->mPendingGpuInstancing) {
+        asset->applyGpuInstancing(instancing);
+    }
+    asset->mPendingGpuInstancing.clear();
+
     // If any decoding jobs are still underway from a previous load, wait for them to finish.
     for (const auto& iter: pImpl->mTextureProviders) {
         iter.second->waitForCompletion();
@@ -466,12 +809,22 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
     }
 
     // Finally, create Filament Textures and begin loading image files.
+    if (pImpl->mTextureCache) {
+        pImpl->mTextureCache->commit();
+        asset->mTextureCache = pImpl->mTextureCache;
+    }
     pImpl->createTextures(asset, async);
 
     // Non-textured renderables are now considered ready, and we can guarantee that no new
     // materials or textures will be added. Notify the dependency graph.
     asset->mDependencyGraph.commitEdges();
 
+    // This must come after commitEdges(), which would otherwise count their materials twice.
+    pImpl->markSharedTexturesReady(asset);
+    for (Texture* texture : asset->mAtlasTextures) {
+        asset->mDependencyGraph.markAsReady(texture);
+    }
+
     for (FFilamentInstance* instance : asset->mInstances) {
         instance->createAnimator();
     }
@@ -486,6 +839,9 @@ bool ResourceLoader::asyncBeginLoad(FilamentAsset* asset) {
 
 void ResourceLoader::asyncCancelLoad() {
     pImpl->cancelTextureDecoding();
+    if (pImpl->mTextureCache) {
+        pImpl->mTextureCache->discardPending();
+    }
     pImpl->mAsyncAsset = nullptr;
     pImpl->mEngine->flushAndWait();
 }
@@ -559,9 +915,10 @@ std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilam
             return {iter->second, CacheResult::FOUND};
         }
         const uint32_t totalSize = uint32_t(bv ? bv->size : 0);
-        if (Texture* texture = provider->pushTexture(sourceData, totalSize, mime.c_str(), flags); texture) {
+        if (auto [texture, result] = pushTexture(provider, sourceData, totalSize, mime, flags);
+                texture) {
             mBufferTextureCache[sourceData] = texture;
-            return {texture, CacheResult::MISS};
+            return {texture, result};
         }
     }
 
@@ -573,10 +930,11 @@ std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilam
             free((void*)dataUriContent);
             return {iter->second, CacheResult::FOUND};
         }
-        if (Texture* texture = provider->pushTexture(dataUriContent, dataUriSize, mime.c_str(), flags); texture) {
+        if (auto [texture, result] = pushTexture(provider, dataUriContent, dataUriSize, mime,
+                flags); texture) {
             free((void*)dataUriContent);
             mBufferTextureCache[uri] = texture;
-            return {texture, CacheResult::MISS};
+            return {texture, result};
         }
         free((void*)dataUriContent);
     }
@@ -587,9 +945,10 @@ std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilam
         if (auto iter = mBufferTextureCache.find(sourceData); iter != mBufferTextureCache.end()) {
             return {iter->second, CacheResult::FOUND};
         }
-        if (Texture* texture = provider->pushTexture(sourceData, iter->second.size, mime.c_str(), flags); texture) {
+        if (auto [texture, result] = pushTexture(provider, sourceData, iter->second.size, mime,
+                flags); texture) {
             mBufferTextureCache[sourceData] = texture;
-            return {texture, CacheResult::MISS};
+            return {texture, result};
         }
     }
 
@@ -610,9 +969,10 @@ std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilam
         buffer.reserve((size_t) filest.tellg());
         filest.seekg(0, ios::beg);
         buffer.assign((istreambuf_iterator<char>(filest)), istreambuf_iterator<char>());
-        if (Texture* texture = provider->pushTexture(buffer.data(), buffer.size(), mime.c_str(), flags); texture) {
+        if (auto [texture, result] = pushTexture(provider, buffer.data(), buffer.size(), mime,
+                flags); texture) {
             mFilepathTextureCache[uri] = texture;
-            return {texture, CacheResult::MISS};
+            return {texture, result};
         }
 
     } else {
@@ -626,6 +986,30 @@ std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilam
     return {};
 }
 
+std::pair<Texture*, CacheResult> ResourceLoader::Impl::pushTexture(TextureProvider* provider,
+        const uint8_t* data, size_t byteCount, const std::string& mime,
+        TextureProvider::TextureFlags flags) {
+    if (!mTextureCache) {
+        return {provider->pushTexture(data, byteCount, mime.c_str(), flags), CacheResult::MISS};
+    }
+    TextureCache::Key key = TextureCache::makeKey(data, byteCount, mime.c_str(), flags);
+    if (Texture* texture = mTextureCache->acquire(key); texture) {
+        return {texture, CacheResult::SHARED};
+    }
+    Texture* texture = provider->pushTexture(data, byteCount, mime.c_str(), flags);
+    if (texture) {
+        mTextureCache->add(std::move(key), texture);
+    }
+    return {texture, CacheResult::MISS};
+}
+
+void ResourceLoader::Impl::markSharedTexturesReady(FFilamentAsset* asset) {
+    for (Texture* texture : mSharedTextures) {
+        asset->mDependencyGraph.markAsReady(texture);
+    }
+    mSharedTextures.clear();
+}
+
 void ResourceLoader::Impl::cancelTextureDecoding() {
     for (const auto& iter : mTextureProviders) {
         iter.second->cancelDecoding();
@@ -633,12 +1017,216 @@ void ResourceLoader::Impl::cancelTextureDecoding() {
     mAsyncAsset = nullptr;
 }
 
+bool ResourceLoader::Impl::getImageData(FFilamentAsset* asset, size_t textureIndex,
+        std::string* mime, std::vector<uint8_t>* data) {
+    const cgltf_image* image = asset->mSourceAsset->hierarchy->textures[textureIndex].image;
+    const cgltf_buffer_view* bv = image->buffer_view;
+    const char* uri = image->uri;
+
+    *mime = image->mime_type ? image->mime_type : "";
+    size_t dataUriSize;
+    const uint8_t* dataUriContent = uri ? parseDataUri(uri, mime, &dataUriSize) : nullptr;
+    if (mime->empty() && uri) {
+        const std::string extension = Path(uri).getExtension();
+        *mime = extension == "jpg" ? "image/jpeg" : "image/" + extension;
+    }
+
+    if (bv) {
+        const uint8_t* sourceData = cgltf_buffer_view_data(bv);
+        if (!sourceData) {
+            return false;
+        }
+        data->assign(sourceData, sourceData + bv->size);
+    } else if (dataUriContent) {
+        data->assign(dataUriContent, dataUriContent + dataUriSize);
+        free((void*) dataUriContent);
+    } else if (auto iter = mUriDataCache->find(uri); iter != mUriDataCache->end()) {
+        const uint8_t* sourceData = (const uint8_t*) iter->second.buffer;
+        data->assign(sourceData, sourceData + iter->second.size);
+    } else if constexpr (GLTFIO_USE_FILESYSTEM) {
+        Path fullpath = Path(mGltfPath).getParent() + uri;
+        std::ifstream filest(fullpath, std::ifstream::in | std::ifstream::binary);
+        if (!filest) {
+            return false;
+        }
+        data->assign(std::istreambuf_iterator<char>(filest), std::istreambuf_iterator<char>());
+    } else {
+        return false;
+    }
+    return !data->empty();
+}
+
+AtlasUvTransforms ResourceLoader::Impl::packTextures(FFilamentAsset* asset) {
+    AtlasUvTransforms uvTransforms;
+    if (mTextureAtlasSize == 0) {
+        return uvTransforms;
+    }
+    SYSTRACE_CALL();
+
+    cgltf_data const* const gltf = asset->mSourceAsset->hierarchy;
+    auto const indexOf = [gltf](cgltf_texture const* texture) {
+        return size_t(texture - gltf->textures);
+    };
+
+    // A texture can be packed if every material that uses it can sample it from an atlas.
+    enum class State : uint8_t { UNUSED, CANDIDATE, REJECTED };
+    std::vector<State> states(asset->mTextures.size(), State::UNUSED);
+    auto const reject = [&](cgltf_material const* material) {
+        for (cgltf_texture_view const* view : getTextureViews(*material)) {
+            if (view->texture) {
+                states[indexOf(view->texture)] = State::REJECTED;
+            }
+        }
+    };
+    for (cgltf_size i = 0; i < gltf->materials_count; i++) {
+        if (cgltf_texture const* texture = getPackableTexture(&gltf->materials[i])) {
+            if (states[indexOf(texture)] == State::UNUSED) {
+                states[indexOf(texture)] = State::CANDIDATE;
+            }
+        } else {
+            reject(&gltf->materials[i]);
+        }
+    }
+
+    // The UVs of a primitive are remapped for its texture, so a UV set can't be shared with a
+    // primitive that samples another texture with it. Null marks the UV sets used by materials
+    // that can't be packed.
+    tsl::robin_map<cgltf_accessor const*, cgltf_texture const*> uvTextures;
+    auto const& primitives =
+            std::get<FFilamentAsset::ResourceInfo>(asset->mResourceInfo).mPrimitives;
+    for (auto const& [prim, vertexBuffer] : primitives) {
+        if (!prim->material) {
+            continue;
+        }
+        // The material instances of variants are switched at runtime, they can't be shared.
+        if (prim->mappings_count) {
+            reject(prim->material);
+            for (cgltf_size i = 0; i < prim->mappings_count; i++) {
+                reject(prim->mappings[i].material);
+            }
+        }
+        cgltf_texture const* const texture = getPackableTexture(prim->material);
+        if (!texture) {
+            for (cgltf_size i = 0; i < prim->attributes_count; i++) {
+                if (prim->attributes[i].type == cgltf_attribute_type_texcoord) {
+                    auto [iter, inserted] = uvTextures.emplace(prim->attributes[i].data, nullptr);
+                    if (!inserted && iter->second) {
+                        states[indexOf(iter->second)] = State::REJECTED;
+                        iter.value() = nullptr;
+                    }
+                }
+            }
+            continue;
+        }
+        cgltf_accessor const* const uvs = getTexCoords(prim,
+                prim->material->pbr_metallic_roughness.base_color_texture.texcoord);
+        if (!uvs || prim->targets_count || !isPackableUvSet(uvs)) {
+            states[indexOf(texture)] = State::REJECTED;
+            continue;
+        }
+        auto [iter, inserted] = uvTextures.emplace(uvs, texture);
+        if (!inserted && iter->second != texture) {
+            states[indexOf(texture)] = State::REJECTED;
+            if (iter->second) {
+                states[indexOf(iter->second)] = State::REJECTED;
+                iter.value() = nullptr;
+            }
+        }
+    }
+
+    // Only the images that are available now, in a format stb can decode, are packed.
+    struct Candidate {
+        size_t textureIndex;
+        std::vector<uint8_t> data;
+        uint8_t* texels = nullptr;
+        uint32_t size = 0;
+    };
+    std::vector<Candidate> candidates;
+    for (size_t i = 0; i < states.size(); i++) {
+        if (states[i] != State::CANDIDATE) {
+            continue;
+        }
+        Candidate candidate{ i };
+        std::string mime;
+        if (!getImageData(asset, i, &mime, &candidate.data) ||
+                (mime != "image/png" && mime != "image/jpeg")) {
+            continue;
+        }
+        int width, height, channels;
+        if (!stbi_info_from_memory(candidate.data.data(), int(candidate.data.size()),
+                &width, &height, &channels)) {
+            continue;
+        }
+        uint32_t const size = uint32_t(width);
+        if (width != height || (size & (size - 1)) || size > mTextureAtlasMaxImageSize ||
+                size > mTextureAtlasSize) {
+            continue;
+        }
+        candidate.size = size;
+        candidates.push_back(std::move(candidate));
+    }
+    if (candidates.empty()) {
+        return uvTransforms;
+    }
+
+    JobSystem& js = mEngine->getJobSystem();
+    JobSystem::Job* parent = js.createJob();
+    for (Candidate& candidate : candidates) {
+        Candidate* const pcandidate = &candidate;
+        js.run(jobs::createJob(js, parent, [pcandidate] {
+            int width, height, channels;
+            pcandidate->texels = stbi_load_from_memory(pcandidate->data.data(),
+                    int(pcandidate->data.size()), &width, &height, &channels, 4);
+        }));
+    }
+    js.runAndWait(parent);
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+            [](Candidate const& candidate) { return !candidate.texels; }), candidates.end());
+
+    std::vector<TextureAtlas::Image> images;
+    std::vector<uint32_t> sizes;
+    for (Candidate const& candidate : candidates) {
+        images.push_back({ candidate.texels, candidate.size });
+        sizes.push_back(candidate.size);
+    }
+    TextureAtlas const atlas(mTextureAtlasSize);
+    std::vector<TextureAtlas::Placement> const placements = atlas.place(sizes);
+    std::vector<Texture*> const pages = atlas.createPages(*mEngine, true, images.data(),
+            placements.data(), images.size());
+    asset->mAtlasTextures.insert(asset->mAtlasTextures.end(), pages.begin(), pages.end());
+
+    tsl::robin_map<cgltf_texture const*, float4> textureTransforms;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        size_t const textureIndex = candidates[i].textureIndex;
+        FFilamentAsset::TextureInfo& info = asset->mTextures[textureIndex];
+        info.texture = pages[placements[i].page];
+        info.isOwner = false;
+        info.isPacked = true;
+        for (const TextureSlot& slot : info.bindings) {
+            asset->applyTextureBinding(textureIndex, slot);
+        }
+        textureTransforms[&gltf->textures[textureIndex]] =
+                atlas.getUvTransform(images[i], placements[i]);
+        stbi_image_free(candidates[i].texels);
+    }
+
+    for (auto const& [uvs, texture] : uvTextures) {
+        if (auto iter = textureTransforms.find(texture); iter != textureTransforms.end()) {
+            uvTransforms[uvs] = iter->second;
+        }
+    }
+    return uvTransforms;
+}
+
 void ResourceLoader::Impl::createTextures(FFilamentAsset* asset, bool async) {
     mRemainingTextureDownloads = 0;
 
     // Create new texture objects if they are not cached and kick off decoding jobs.
     for (size_t textureIndex = 0, n = asset->mTextures.size(); textureIndex < n; ++textureIndex) {
         FFilamentAsset::TextureInfo& info = asset->mTextures[textureIndex];
+        if (info.isPacked) {
+            continue;
+        }
         auto [texture, cacheResult] = getOrCreateTexture(asset, textureIndex, info.flags);
         if (texture == nullptr) {
             if (cacheResult == CacheResult::NOT_READY) {
@@ -651,7 +1239,10 @@ void ResourceLoader::Impl::createTextures(FFilamentAsset* asset, bool async) {
         // and note if the Texture was created or re-used.
         if (info.texture == nullptr) {
             info.texture = texture;
-            info.isOwner = cacheResult == CacheResult::MISS;
+            info.isOwner = cacheResult == CacheResult::MISS || cacheResult == CacheResult::SHARED;
+        }
+        if (cacheResult == CacheResult::SHARED) {
+            mSharedTextures.push_back(texture);
         }
 
         // For each binding to a material instance, call setParameter(...) on the material.
@@ -768,6 +1359,9 @@ ResourceLoader::Impl::~Impl() {
     for (const auto& iter : mTextureProviders) {
         iter.second->cancelDecoding();
     }
+    if (mTextureCache) {
+        mTextureCache->discardPending();
+    }
 }
 
 } // namespace filament::gltfio
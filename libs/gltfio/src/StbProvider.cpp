@@ -16,15 +16,30 @@
 
 #include <gltfio/TextureProvider.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 #include <string>
 #include <vector>
 
+#include <utils/Hash.h>
 #include <utils/JobSystem.h>
 #include <utils/Log.h>
+#include <utils/Path.h>
 
 #include <filament/Engine.h>
 #include <filament/Texture.h>
 
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Warray-bounds"
+#pragma clang diagnostic ignored "-Wunused-value"
+#include <basisu_enc.h>
+#include <basisu_transcoder.h>
+#include <basisu_uastc_enc.h>
+#pragma clang diagnostic pop
+
 #include <stb_image.h>
 
 using namespace filament;
@@ -36,9 +51,184 @@ using std::unique_ptr;
 
 namespace filament::gltfio {
 
+namespace {
+
+using InternalFormat = Texture::InternalFormat;
+using CompressedType = Texture::CompressedType;
+using TranscoderFormat = basist::transcoder_texture_format;
+
+// Images are first encoded to UASTC, which basisu can quickly transcode to all of these.
+struct CompressedFormat {
+    InternalFormat format;
+    InternalFormat srgbFormat;
+    CompressedType type;
+    CompressedType srgbType;
+    TranscoderFormat transcoderFormat;
+    bool hasAlpha;
+};
+
+// In order of preference, the first one supported by the engine is used. BC7 is not listed
+// because our basisu build doesn't transcode to it.
+constexpr CompressedFormat COMPRESSED_FORMATS[] = {
+    { InternalFormat::ETC2_RGB8, InternalFormat::ETC2_SRGB8,
+      CompressedType::ETC2_RGB8, CompressedType::ETC2_SRGB8,
+      TranscoderFormat::cTFETC1_RGB, false },
+    { InternalFormat::DXT1_RGB, InternalFormat::DXT1_SRGB,
+      CompressedType::DXT1_RGB, CompressedType::DXT1_SRGB,
+      TranscoderFormat::cTFBC1_RGB, false },
+    { InternalFormat::RGBA_ASTC_4x4, InternalFormat::SRGB8_ALPHA8_ASTC_4x4,
+      CompressedType::RGBA_ASTC_4x4, CompressedType::SRGB8_ALPHA8_ASTC_4x4,
+      TranscoderFormat::cTFASTC_4x4_RGBA, true },
+    { InternalFormat::ETC2_EAC_RGBA8, InternalFormat::ETC2_EAC_SRGBA8,
+      CompressedType::ETC2_EAC_RGBA8, CompressedType::ETC2_EAC_SRGBA8,
+      TranscoderFormat::cTFETC2_RGBA, true },
+    { InternalFormat::DXT5_RGBA, InternalFormat::DXT5_SRGBA,
+      CompressedType::DXT5_RGBA, CompressedType::DXT5_SRGBA,
+      TranscoderFormat::cTFBC3_RGBA, true },
+};
+
+CompressedFormat const* pickCompressedFormat(Engine& engine, bool hasAlpha, bool srgb) {
+    for (CompressedFormat const& candidate : COMPRESSED_FORMATS) {
+        // Opaque formats can't be used for images with alpha, but the reverse is fine.
+        if (candidate.hasAlpha < hasAlpha) {
+            continue;
+        }
+        if (Texture::isTextureFormatSupported(engine,
+                srgb ? candidate.srgbFormat : candidate.format) &&
+                basist::basis_is_format_supported(candidate.transcoderFormat,
+                        basist::basis_tex_format::cUASTC4x4)) {
+            return &candidate;
+        }
+    }
+    return nullptr;
+}
+
+// Averages 2x2 texels, in the encoded space of the source, to create the next level.
+vector<uint8_t> downsample(uint8_t const* src, uint32_t width, uint32_t height) {
+    const uint32_t dstWidth = std::max(1u, width / 2);
+    const uint32_t dstHeight = std::max(1u, height / 2);
+    vector<uint8_t> dst(dstWidth * dstHeight * 4);
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        uint8_t const* row0 = src + std::min(y * 2, height - 1) * width * 4;
+        uint8_t const* row1 = src + std::min(y * 2 + 1, height - 1) * width * 4;
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            const uint32_t x0 = std::min(x * 2, width - 1) * 4;
+            const uint32_t x1 = std::min(x * 2 + 1, width - 1) * 4;
+            for (uint32_t c = 0; c < 4; c++) {
+                dst[(y * dstWidth + x) * 4 + c] = uint8_t(
+                        (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+// Encodes one level with the fastest UASTC settings, each row of blocks can be encoded in
+// parallel. Texels outside of the image are clamped to its edges.
+vector<uint8_t> encodeLevel(JobSystem& js, uint8_t const* texels, uint32_t width, uint32_t height,
+        CompressedFormat const& format) {
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    vector<basist::uastc_block> blocks(blocksX * blocksY);
+
+    auto encodeRows = [&](uint32_t start, uint32_t count) {
+        uint8_t pixels[16 * 4];
+        for (uint32_t by = start; by < start + count; by++) {
+            for (uint32_t bx = 0; bx < blocksX; bx++) {
+                for (uint32_t i = 0; i < 16; i++) {
+                    const uint32_t x = std::min(bx * 4 + i % 4, width - 1);
+                    const uint32_t y = std::min(by * 4 + i / 4, height - 1);
+                    std::copy_n(texels + (y * width + x) * 4, 4, pixels + i * 4);
+                }
+                basisu::encode_uastc(pixels, blocks[by * blocksX + bx],
+                        basisu::cPackUASTCLevelFastest);
+            }
+        }
+    };
+
+    JobSystem::Job* job = jobs::parallel_for(js, nullptr, 0, blocksY, std::cref(encodeRows),
+            jobs::CountSplitter<8>());
+    js.runAndWait(job);
+
+    const uint32_t blockCount = blocksX * blocksY;
+    const uint32_t uastcSize = blockCount * sizeof(basist::uastc_block);
+    vector<uint8_t> result(blockCount *
+            basist::basis_get_bytes_per_block_or_pixel(format.transcoderFormat));
+    basist::basisu_lowlevel_uastc_transcoder transcoder;
+    if (!transcoder.transcode_image(format.transcoderFormat, result.data(), blockCount,
+            (uint8_t const*) blocks.data(), uastcSize, blocksX, blocksY, width, height, 0,
+            0, uastcSize, 0, format.hasAlpha)) {
+        result.clear();
+    }
+    return result;
+}
+
+// The cache stores the compressed levels of an image as they are uploaded to the GPU.
+struct CacheHeader {
+    char magic[4];
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t levelCount;
+};
+
+constexpr char CACHE_MAGIC[4] = { 'F', 'T', 'C', '1' };
+
+bool readCache(std::string const& path, uint32_t width, uint32_t height, InternalFormat format,
+        vector<vector<uint8_t>>& levels) {
+    std::ifstream in(path, std::ios::binary);
+    CacheHeader header{};
+    if (!in.read((char*) &header, sizeof(header)) ||
+            !std::equal(CACHE_MAGIC, CACHE_MAGIC + 4, header.magic) ||
+            header.width != width || header.height != height ||
+            header.format != uint32_t(format) || header.levelCount != levels.size()) {
+        return false;
+    }
+    for (auto& level : levels) {
+        uint32_t size = 0;
+        if (!in.read((char*) &size, sizeof(size))) {
+            return false;
+        }
+        level.resize(size);
+        if (!in.read((char*) level.data(), size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void writeCache(std::string const& path, uint32_t width, uint32_t height, InternalFormat format,
+        vector<vector<uint8_t>> const& levels) {
+    // Write to a temporary file first so that a concurrent or interrupted load never sees a
+    // partial entry.
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary);
+        CacheHeader header{};
+        std::copy_n(CACHE_MAGIC, 4, header.magic);
+        header.width = width;
+        header.height = height;
+        header.format = uint32_t(format);
+        header.levelCount = uint32_t(levels.size());
+        out.write((char const*) &header, sizeof(header));
+        for (auto const& level : levels) {
+            const uint32_t size = uint32_t(level.size());
+            out.write((char const*) &size, sizeof(size));
+            out.write((char const*) level.data(), size);
+        }
+        if (!out) {
+            std::remove(tmpPath.c_str());
+            return;
+        }
+    }
+    std::rename(tmpPath.c_str(), path.c_str());
+}
+
+} // anonymous namespace
+
 class StbProvider final : public TextureProvider {
 public:
-    StbProvider(Engine* engine);
+    StbProvider(Engine* engine, StbProviderConfig const& config);
     ~StbProvider();
 
     Texture* pushTexture(const uint8_t* data, size_t byteCount,
@@ -67,12 +257,22 @@ private:
         atomic<intptr_t> decodedTexelsBaseMipmap;
         vector<uint8_t> sourceBuffer;
         JobSystem::Job*  decoderJob;
+
+        // Only used when the texture is compressed at load time.
+        CompressedFormat const* compressedFormat;
+        bool srgb;
+        std::string cachePath;
+        vector<vector<uint8_t>> compressedLevels;
     };
 
     // Declare some sentinel values for the "decodedTexelsBaseMipmap" field.
     // Note that the "state" field can be modified only on the foreground thread.
     static const intptr_t DECODING_NOT_READY = 0x0;
     static const intptr_t DECODING_ERROR = 0x1;
+    static const intptr_t DECODING_COMPRESSED = 0x2; // levels are in "compressedLevels"
+
+    static void decode(TextureInfo* info, JobSystem& js);
+    static void decodeCompressed(TextureInfo* info, JobSystem& js);
 
     void decodeSingleTexture();
 
@@ -83,7 +283,9 @@ private:
     JobSystem::Job* mDecoderRootJob;
     std::string mRecentPushMessage;
     std::string mRecentPopMessage;
+    std::string mCacheFolder;
     Engine* const mEngine;
+    const bool mCompressTextures;
 };
 
 Texture* StbProvider::pushTexture(const uint8_t* data, size_t byteCount,
@@ -94,13 +296,24 @@ Texture* StbProvider::pushTexture(const uint8_t* data, size_t byteCount,
         return nullptr;
     }
 
-    using InternalFormat = Texture::InternalFormat;
+    const bool srgb = any(flags & TextureFlags::sRGB);
+    const bool hasAlpha = numComponents == 2 || numComponents == 4;
+    CompressedFormat const* compressedFormat = mCompressTextures ?
+            pickCompressedFormat(*mEngine, hasAlpha, srgb) : nullptr;
+
+    InternalFormat format = srgb ? InternalFormat::SRGB8_A8 : InternalFormat::RGBA8;
+    uint8_t levels = 0xff;
+    if (compressedFormat) {
+        // Compressed textures can't use generateMipmaps(), we provide all the levels.
+        format = srgb ? compressedFormat->srgbFormat : compressedFormat->format;
+        levels = uint8_t(std::log2(std::max(width, height))) + 1;
+    }
 
     Texture* texture = Texture::Builder()
             .width(width)
             .height(height)
-            .levels(0xff)
-            .format(any(flags & TextureFlags::sRGB) ? InternalFormat::SRGB8_A8 : InternalFormat::RGBA8)
+            .levels(levels)
+            .format(format)
             .build(*mEngine);
 
     if (texture == nullptr) {
@@ -116,6 +329,14 @@ Texture* StbProvider::pushTexture(const uint8_t* data, size_t byteCount,
     info->state = TextureState::DECODING;
     info->sourceBuffer.assign(data, data + byteCount);
     info->decodedTexelsBaseMipmap.store(DECODING_NOT_READY);
+    info->compressedFormat = compressedFormat;
+    info->srgb = srgb;
+    if (compressedFormat && !mCacheFolder.empty()) {
+        char name[64];
+        snprintf(name, sizeof(name), "%08x-%zx-%u.ftc",
+                utils::hash::murmurSlow(data, byteCount, 0), byteCount, unsigned(format));
+        info->cachePath = utils::Path(mCacheFolder).concat(name).getPath();
+    }
 
     // On single threaded systems, it is usually fine to create jobs because the job system will
     // simply execute serially. However in our case, we wish to amortize the decoder cost across
@@ -126,18 +347,11 @@ Texture* StbProvider::pushTexture(const uint8_t* data, size_t byteCount,
     }
 
     JobSystem* js = &mEngine->getJobSystem();
-    info->decoderJob = jobs::createJob(*js, mDecoderRootJob, [info] {
-        auto& source = info->sourceBuffer;
-        int width, height, comp;
-
+    info->decoderJob = jobs::createJob(*js, mDecoderRootJob, [info, js] {
         // Test asynchronous loading by uncommenting this line.
         // std::this_thread::sleep_for(std::chrono::milliseconds(rand() % 10000));
 
-        stbi_uc* texels = stbi_load_from_memory(source.data(), source.size(),
-                &width, &height, &comp, 4);
-        source.clear();
-        source.shrink_to_fit();
-        info->decodedTexelsBaseMipmap.store(texels ? intptr_t(texels) : DECODING_ERROR);
+        decode(info, *js);
     });
 
     js->runAndRetain(info->decoderJob);
@@ -183,6 +397,22 @@ void StbProvider::updateQueue() {
                 ++mDecodedCount;
                 continue;
             }
+            if (data == DECODING_COMPRESSED) {
+                const CompressedType type = info->srgb ?
+                        info->compressedFormat->srgbType : info->compressedFormat->type;
+                for (size_t level = 0; level < info->compressedLevels.size(); level++) {
+                    auto* texels = new vector<uint8_t>(std::move(info->compressedLevels[level]));
+                    Texture::PixelBufferDescriptor pbd(texels->data(), texels->size(), type,
+                            uint32_t(texels->size()), [](void*, size_t, void* user) {
+                                delete (vector<uint8_t>*) user;
+                            }, texels);
+                    texture->setImage(*mEngine, level, std::move(pbd));
+                }
+                info->compressedLevels.clear();
+                info->state = TextureState::READY;
+                ++mDecodedCount;
+                continue;
+            }
             Texture::PixelBufferDescriptor pbd((uint8_t*) data,
                     texture->getWidth() * texture->getHeight() * 4, Texture::Format::RGBA,
                     Texture::Type::UBYTE, [](void* mem, size_t, void*) { stbi_image_free(mem); });
@@ -215,9 +445,12 @@ void StbProvider::waitForCompletion() {
 }
 
 void StbProvider::cancelDecoding() {
-    // TODO: Currently, StbProvider runs jobs eagerly and JobSystem does not allow cancellation of
-    // in-flight jobs. We should consider throttling the number of simultaneous decoder jobs, which
-    // would allow for actual cancellation.
+    // Jobs that haven't started yet are skipped, the ones that are decoding must still finish.
+    for (auto& info : mTextures) {
+        if (info->decoderJob) {
+            JobSystem::requestCancellation(info->decoderJob);
+        }
+    }
     waitForCompletion();
 
     // For cancelled jobs, we need to set the TextureInfo to the popped state and free the decoded
@@ -230,9 +463,11 @@ void StbProvider::cancelDecoding() {
         // decodedTexelsBaseMipmap is loaded is in the job threads, and we have waited them to
         // completion above. We also expect the TextureProvider API calls to be made only from one
         // thread.
-        if (intptr_t data = info->decodedTexelsBaseMipmap.load()) {
-            delete [] (uint8_t*) data;
+        const intptr_t data = info->decodedTexelsBaseMipmap.load();
+        if (data != DECODING_NOT_READY && data != DECODING_ERROR && data != DECODING_COMPRESSED) {
+            stbi_image_free((void*) data);
         }
+        info->compressedLevels.clear();
         info->state = TextureState::POPPED;
     }
 }
@@ -249,19 +484,81 @@ void StbProvider::decodeSingleTexture() {
     assert_invariant(!UTILS_HAS_THREADING);
     for (auto& info : mTextures) {
         if (info->state == TextureState::DECODING) {
-            auto& source = info->sourceBuffer;
-            int width, height, comp;
-            stbi_uc* texels = stbi_load_from_memory(source.data(), source.size(),
-                    &width, &height, &comp, 4);
-            source.clear();
-            source.shrink_to_fit();
-            info->decodedTexelsBaseMipmap.store(texels ? intptr_t(texels) : DECODING_ERROR);
+            decode(info.get(), mEngine->getJobSystem());
             break;
         }
     }
 }
 
-StbProvider::StbProvider(Engine* engine) : mEngine(engine) {
+void StbProvider::decode(TextureInfo* info, JobSystem& js) {
+    if (info->compressedFormat) {
+        decodeCompressed(info, js);
+        return;
+    }
+    auto& source = info->sourceBuffer;
+    int width, height, comp;
+    stbi_uc* texels = stbi_load_from_memory(source.data(), source.size(),
+            &width, &height, &comp, 4);
+    source.clear();
+    source.shrink_to_fit();
+    info->decodedTexelsBaseMipmap.store(texels ? intptr_t(texels) : DECODING_ERROR);
+}
+
+void StbProvider::decodeCompressed(TextureInfo* info, JobSystem& js) {
+    CompressedFormat const& compressedFormat = *info->compressedFormat;
+    Texture const* texture = info->texture;
+    const InternalFormat format = texture->getFormat();
+    uint32_t width = texture->getWidth();
+    uint32_t height = texture->getHeight();
+    auto& levels = info->compressedLevels;
+    levels.resize(texture->getLevels());
+
+    auto& source = info->sourceBuffer;
+    if (!info->cachePath.empty() && readCache(info->cachePath, width, height, format, levels)) {
+        source.clear();
+        source.shrink_to_fit();
+        info->decodedTexelsBaseMipmap.store(DECODING_COMPRESSED);
+        return;
+    }
+
+    int w, h, comp;
+    stbi_uc* texels = stbi_load_from_memory(source.data(), source.size(), &w, &h, &comp, 4);
+    source.clear();
+    source.shrink_to_fit();
+    if (!texels) {
+        info->decodedTexelsBaseMipmap.store(DECODING_ERROR);
+        return;
+    }
+
+    vector<uint8_t> level(texels, texels + width * height * 4);
+    stbi_image_free(texels);
+    for (size_t index = 0; index < levels.size(); index++) {
+        levels[index] = encodeLevel(js, level.data(), width, height, compressedFormat);
+        if (levels[index].empty()) {
+            levels.clear();
+            info->decodedTexelsBaseMipmap.store(DECODING_ERROR);
+            return;
+        }
+        if (index + 1 < levels.size()) {
+            level = downsample(level.data(), width, height);
+            width = std::max(1u, width / 2);
+            height = std::max(1u, height / 2);
+        }
+    }
+
+    if (!info->cachePath.empty()) {
+        writeCache(info->cachePath, texture->getWidth(), texture->getHeight(), format, levels);
+    }
+    info->decodedTexelsBaseMipmap.store(DECODING_COMPRESSED);
+}
+
+StbProvider::StbProvider(Engine* engine, StbProviderConfig const& config)
+        : mCacheFolder(config.cacheFolder ? config.cacheFolder : ""),
+          mEngine(engine),
+          mCompressTextures(config.compressTextures) {
+    if (mCompressTextures) {
+        basisu::basisu_encoder_init();
+    }
     mDecoderRootJob = mEngine->getJobSystem().createJob();
 #ifndef NDEBUG
     slog.i << "Texture Decoder has "
@@ -276,7 +573,11 @@ StbProvider::~StbProvider() {
 }
 
 TextureProvider* createStbProvider(Engine* engine) {
-    return new StbProvider(engine);
+    return new StbProvider(engine, {});
+}
+
+TextureProvider* createStbProvider(Engine* engine, StbProviderConfig const& config) {
+    return new StbProvider(engine, config);
 }
 
 } // namespace filament::gltfio
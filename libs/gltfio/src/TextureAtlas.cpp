@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TextureAtlas.h"
+
+#include <filament/Engine.h>
+#include <filament/Texture.h>
+
+#include <utils/debug.h>
+
+#include <algorithm>
+#include <numeric>
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace filament::gltfio {
+
+// Keeps the even bits of a Morton code, i.e. one of its two coordinates.
+static uint32_t compactBits(uint32_t v) noexcept {
+    v &= 0x55555555u;
+    v = (v ^ (v >> 1u)) & 0x33333333u;
+    v = (v ^ (v >> 2u)) & 0x0f0f0f0fu;
+    v = (v ^ (v >> 4u)) & 0x00ff00ffu;
+    v = (v ^ (v >> 8u)) & 0x0000ffffu;
+    return v;
+}
+
+std::vector<TextureAtlas::Placement> TextureAtlas::place(std::vector<uint32_t> const& sizes) const {
+    std::vector<Placement> placements(sizes.size());
+    if (sizes.empty()) {
+        return placements;
+    }
+
+    std::vector<uint32_t> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&sizes](uint32_t lhs, uint32_t rhs) {
+        return sizes[lhs] > sizes[rhs];
+    });
+
+    // The cursor counts the cells of the smallest image in Z-order. Since the images come by
+    // decreasing size, it's always at the start of a node of the current size.
+    uint32_t const cell = sizes[order.back()];
+    uint32_t const cellsPerPage = (mPageSize / cell) * (mPageSize / cell);
+    uint32_t page = 0;
+    uint32_t cursor = 0;
+    for (uint32_t const i : order) {
+        assert_invariant(sizes[i] <= mPageSize);
+        uint32_t const cells = (sizes[i] / cell) * (sizes[i] / cell);
+        if (cursor + cells > cellsPerPage) {
+            page++;
+            cursor = 0;
+        }
+        placements[i] = { page, compactBits(cursor) * cell, compactBits(cursor >> 1u) * cell };
+        cursor += cells;
+    }
+    return placements;
+}
+
+std::vector<Texture*> TextureAtlas::createPages(Engine& engine, bool srgb, Image const* images,
+        Placement const* placements, size_t count) const {
+    uint32_t pageCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        pageCount = std::max(pageCount, placements[i].page + 1);
+    }
+
+    std::vector<Texture*> pages(pageCount);
+    for (uint32_t page = 0; page < pageCount; page++) {
+        // the mip levels stop at the 1x1 level of the smallest image, below it they'd mix images
+        uint32_t smallest = mPageSize;
+        size_t const byteCount = size_t(mPageSize) * mPageSize * 4;
+        uint8_t* const texels = (uint8_t*) calloc(byteCount, 1);
+        for (size_t i = 0; i < count; i++) {
+            if (placements[i].page != page) {
+                continue;
+            }
+            Image const& image = images[i];
+            Placement const& placement = placements[i];
+            smallest = std::min(smallest, image.size);
+            for (uint32_t y = 0; y < image.size; y++) {
+                size_t const offset = (size_t(placement.y + y) * mPageSize + placement.x) * 4;
+                memcpy(texels + offset, image.texels + size_t(y) * image.size * 4, image.size * 4);
+            }
+        }
+
+        uint8_t const levels = uint8_t(__builtin_ctz(smallest) + 1);
+        Texture* const texture = Texture::Builder()
+                .width(mPageSize)
+                .height(mPageSize)
+                .levels(levels)
+                .format(srgb ? Texture::InternalFormat::SRGB8_A8 : Texture::InternalFormat::RGBA8)
+                .build(engine);
+        texture->setImage(engine, 0, Texture::PixelBufferDescriptor(texels, byteCount,
+                Texture::Format::RGBA, Texture::Type::UBYTE,
+                [](void* buffer, size_t, void*) { free(buffer); }));
+        if (levels > 1) {
+            texture->generateMipmaps(engine);
+        }
+        pages[page] = texture;
+    }
+    return pages;
+}
+
+math::float4 TextureAtlas::getUvTransform(Image const& image,
+        Placement const& placement) const noexcept {
+    float const pageSize = float(mPageSize);
+    return {
+            float(image.size - 1) / pageSize,
+            float(image.size - 1) / pageSize,
+            (float(placement.x) + 0.5f) / pageSize,
+            (float(placement.y) + 0.5f) / pageSize };
+}
+
+} // namespace filament::gltfio
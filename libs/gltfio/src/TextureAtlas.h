@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_TEXTURE_ATLAS_H
+#define GLTFIO_TEXTURE_ATLAS_H
+
+#include <math/vec4.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+class Engine;
+class Texture;
+} // namespace filament
+
+namespace filament::gltfio {
+
+// Packs square power-of-two RGBA8 images into the pages of texture atlases.
+//
+// Like filament's AtlasAllocator, the pages are quadtrees. The images are inserted from the
+// largest to the smallest, so each one simply goes to the next free node of its size in Z-order
+// and the pages never fragment. Every image is aligned to its own size, which keeps it apart from
+// its neighbors in all the mip levels down to the 1x1 level of the smallest image of the page.
+class TextureAtlas {
+public:
+    struct Image {
+        uint8_t const* texels;  // RGBA8, size * size texels
+        uint32_t size;          // a power of two, no larger than the page size
+    };
+
+    struct Placement {
+        uint32_t page;
+        uint32_t x;
+        uint32_t y;
+    };
+
+    explicit TextureAtlas(uint32_t pageSize) noexcept : mPageSize(pageSize) {}
+
+    // Returns where each image goes, in the order of the given sizes.
+    std::vector<Placement> place(std::vector<uint32_t> const& sizes) const;
+
+    // Creates the pages of the atlas, copies the images into them and generates their mipmaps.
+    // The textures belong to the caller.
+    std::vector<Texture*> createPages(Engine& engine, bool srgb, Image const* images,
+            Placement const* placements, size_t count) const;
+
+    // Returns the scale (xy) and offset (zw) that move the UVs of an image to its place in the
+    // atlas. The UVs are inset by half a texel, so bilinear filtering doesn't reach the neighbors.
+    math::float4 getUvTransform(Image const& image, Placement const& placement) const noexcept;
+
+private:
+    uint32_t const mPageSize;
+};
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_TEXTURE_ATLAS_H
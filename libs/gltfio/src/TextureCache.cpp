@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TextureCache.h"
+
+#include <filament/Engine.h>
+#include <filament/Texture.h>
+
+#include <utils/debug.h>
+#include <utils/Hash.h>
+
+#include <utility>
+
+namespace filament::gltfio {
+
+TextureCache::~TextureCache() {
+    // Every asset holds a shared pointer to the cache, so all references are gone by now.
+    assert_invariant(mEntries.empty());
+}
+
+TextureCache::Key TextureCache::makeKey(const uint8_t* data, size_t size, const char* mime,
+        TextureProvider::TextureFlags flags) noexcept {
+    // Two 32-bit hashes with different seeds make collisions between distinct images of the same
+    // size vanishingly unlikely.
+    uint64_t const hi = utils::hash::murmurSlow(data, size, 0x9e3779b9u);
+    uint64_t const lo = utils::hash::murmurSlow(data, size, 0x85ebca6bu);
+    return { (hi << 32u) | lo, size, flags, mime };
+}
+
+Texture* TextureCache::acquire(Key const& key) {
+    auto iter = mTexturesByKey.find(key);
+    if (iter == mTexturesByKey.end()) {
+        return nullptr;
+    }
+    Texture* texture = iter->second;
+    Entry& entry = mEntries.at(texture);
+    if (!entry.complete) {
+        return nullptr;
+    }
+    entry.references++;
+    return texture;
+}
+
+void TextureCache::add(Key key, Texture* texture) {
+    assert_invariant(mEntries.find(texture) == mEntries.end());
+    // If an identical texture is still being decoded, keep the first one available.
+    bool const available = mTexturesByKey.find(key) == mTexturesByKey.end();
+    if (available) {
+        mTexturesByKey[key] = texture;
+    }
+    mEntries[texture] = { std::move(key), 1, false, available };
+}
+
+void TextureCache::commit() noexcept {
+    for (auto iter = mEntries.begin(); iter != mEntries.end(); ++iter) {
+        iter.value().complete = true;
+    }
+}
+
+void TextureCache::discardPending() {
+    for (auto iter = mEntries.begin(); iter != mEntries.end(); ++iter) {
+        Entry& entry = iter.value();
+        if (!entry.complete && entry.available) {
+            mTexturesByKey.erase(entry.key);
+            entry.available = false;
+        }
+    }
+}
+
+void TextureCache::release(Texture* texture) {
+    auto iter = mEntries.find(texture);
+    assert_invariant(iter != mEntries.end());
+    if (--iter.value().references > 0) {
+        return;
+    }
+    if (iter->second.available) {
+        mTexturesByKey.erase(iter->second.key);
+    }
+    mEntries.erase(iter);
+    mEngine->destroy(texture);
+}
+
+} // namespace filament::gltfio
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_TEXTURE_CACHE_H
+#define GLTFIO_TEXTURE_CACHE_H
+
+#include <gltfio/TextureProvider.h>
+
+#include <tsl/robin_map.h>
+
+#include <memory>
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+class Engine;
+class Texture;
+} // namespace filament
+
+namespace filament::gltfio {
+
+// Reference-counted set of textures that can be shared by several assets.
+//
+// The cache key is a hash of the encoded image content (along with its size, mime type and
+// texture flags), which allows identical images to be decoded and uploaded only once, even when
+// they come from different glTF files. Each asset holds one reference to every texture it uses,
+// and the texture is destroyed when the last reference is released.
+//
+// Assets hold a shared pointer to the cache so that it can outlive the ResourceLoader. It must
+// only be used from the thread that owns the Engine.
+class TextureCache {
+public:
+    struct Key {
+        uint64_t hash;
+        size_t size;
+        TextureProvider::TextureFlags flags;
+        std::string mime;
+        bool operator==(Key const& rhs) const noexcept {
+            return hash == rhs.hash && size == rhs.size && flags == rhs.flags && mime == rhs.mime;
+        }
+    };
+
+    explicit TextureCache(Engine* engine) noexcept : mEngine(engine) {}
+    ~TextureCache();
+
+    TextureCache(TextureCache const&) = delete;
+    TextureCache& operator=(TextureCache const&) = delete;
+
+    static Key makeKey(const uint8_t* data, size_t size, const char* mime,
+            TextureProvider::TextureFlags flags) noexcept;
+
+    // Returns the complete texture that matches the given key and adds a reference to it, or null.
+    Texture* acquire(Key const& key);
+
+    // Adds a texture whose decoding has just started, with a single reference.
+    void add(Key key, Texture* texture);
+
+    // Marks all the textures added so far as complete, i.e. their decoding has finished.
+    void commit() noexcept;
+
+    // Makes the textures that are still being decoded unavailable to acquire(), this is used when
+    // decoding is cancelled. The references to these textures are kept.
+    void discardPending();
+
+    // Releases a reference and destroys the texture if it was the last one.
+    void release(Texture* texture);
+
+private:
+    struct KeyHash {
+        size_t operator()(Key const& key) const noexcept { return size_t(key.hash); }
+    };
+    struct Entry {
+        Key key;
+        uint32_t references;
+        bool complete;
+        bool available;
+    };
+
+    Engine* const mEngine;
+    tsl::robin_map<Key, Texture*, KeyHash> mTexturesByKey;
+    tsl::robin_map<Texture*, Entry> mEntries;
+};
+
+using TextureCacheHandle = std::shared_ptr<TextureCache>;
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_TEXTURE_CACHE_H
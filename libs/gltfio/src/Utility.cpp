@@ -20,6 +20,7 @@
 #include "FFilamentAsset.h"
 #include "GltfEnums.h"
 
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 #include <utils/Systrace.h>
 
@@ -27,6 +28,11 @@
 #include <cgltf.h>
 #include <meshoptimizer.h>
 
+#include <vector>
+
+#include <stdint.h>
+#include <string.h>
+
 namespace filament::gltfio::utility {
 
 using namespace utils;
@@ -83,61 +89,78 @@ void decodeDracoMeshes(cgltf_data const* gltf, cgltf_primitive const* prim,
     }
 }
 
-void decodeMeshoptCompression(cgltf_data* data) {
+static void decodeMeshoptBufferView(cgltf_buffer_view* view) {
+    cgltf_meshopt_compression* compression = &view->meshopt_compression;
+    const uint8_t* source = (const uint8_t*) compression->buffer->data;
+    assert_invariant(source);
+    source += compression->offset;
+
+    // This memory is freed by cgltf.
+    void* destination = malloc(compression->count * compression->stride);
+    assert_invariant(destination);
+
+    UTILS_UNUSED_IN_RELEASE int error = 0;
+    switch (compression->mode) {
+        case cgltf_meshopt_compression_mode_invalid:
+            break;
+        case cgltf_meshopt_compression_mode_attributes:
+            error = meshopt_decodeVertexBuffer(destination, compression->count,
+                    compression->stride, source, compression->size);
+            break;
+        case cgltf_meshopt_compression_mode_triangles:
+            error = meshopt_decodeIndexBuffer(destination, compression->count,
+                    compression->stride, source, compression->size);
+            break;
+        case cgltf_meshopt_compression_mode_indices:
+            error = meshopt_decodeIndexSequence(destination, compression->count,
+                    compression->stride, source, compression->size);
+            break;
+        default:
+            assert_invariant(false);
+            break;
+    }
+    assert_invariant(!error);
+
+    switch (compression->filter) {
+        case cgltf_meshopt_compression_filter_none:
+            break;
+        case cgltf_meshopt_compression_filter_octahedral:
+            meshopt_decodeFilterOct(destination, compression->count, compression->stride);
+            break;
+        case cgltf_meshopt_compression_filter_quaternion:
+            meshopt_decodeFilterQuat(destination, compression->count, compression->stride);
+            break;
+        case cgltf_meshopt_compression_filter_exponential:
+            meshopt_decodeFilterExp(destination, compression->count, compression->stride);
+            break;
+        default:
+            assert_invariant(false);
+            break;
+    }
+
+    view->data = destination;
+}
+
+void decodeMeshoptCompression(cgltf_data* data, JobSystem& js) {
+    std::vector<cgltf_buffer_view*> views;
     for (size_t i = 0; i < data->buffer_views_count; ++i) {
-        if (!data->buffer_views[i].has_meshopt_compression) {
-            continue;
-        }
-        cgltf_meshopt_compression* compression = &data->buffer_views[i].meshopt_compression;
-        const uint8_t* source = (const uint8_t*) compression->buffer->data;
-        assert_invariant(source);
-        source += compression->offset;
-
-        // This memory is freed by cgltf.
-        void* destination = malloc(compression->count * compression->stride);
-        assert_invariant(destination);
-
-        UTILS_UNUSED_IN_RELEASE int error = 0;
-        switch (compression->mode) {
-            case cgltf_meshopt_compression_mode_invalid:
-                break;
-            case cgltf_meshopt_compression_mode_attributes:
-                error = meshopt_decodeVertexBuffer(destination, compression->count,
-                        compression->stride, source, compression->size);
-                break;
-            case cgltf_meshopt_compression_mode_triangles:
-                error = meshopt_decodeIndexBuffer(destination, compression->count,
-                        compression->stride, source, compression->size);
-                break;
-            case cgltf_meshopt_compression_mode_indices:
-                error = meshopt_decodeIndexSequence(destination, compression->count,
-                        compression->stride, source, compression->size);
-                break;
-            default:
-                assert_invariant(false);
-                break;
+        if (data->buffer_views[i].has_meshopt_compression) {
+            views.push_back(&data->buffer_views[i]);
         }
-        assert_invariant(!error);
-
-        switch (compression->filter) {
-            case cgltf_meshopt_compression_filter_none:
-                break;
-            case cgltf_meshopt_compression_filter_octahedral:
-                meshopt_decodeFilterOct(destination, compression->count, compression->stride);
-                break;
-            case cgltf_meshopt_compression_filter_quaternion:
-                meshopt_decodeFilterQuat(destination, compression->count, compression->stride);
-                break;
-            case cgltf_meshopt_compression_filter_exponential:
-                meshopt_decodeFilterExp(destination, compression->count, compression->stride);
-                break;
-            default:
-                assert_invariant(false);
-                break;
+    }
+    if (views.size() <= 1) {
+        for (cgltf_buffer_view* view: views) {
+            decodeMeshoptBufferView(view);
         }
+        return;
+    }
 
-        data->buffer_views[i].data = destination;
+    // Each buffer view is decoded into its own allocation, so they can all be decoded concurrently.
+    JobSystem::Job* parent = js.createJob();
+    for (cgltf_buffer_view* view: views) {
+        js.run(jobs::createJob(js, parent, [view] { decodeMeshoptBufferView(view); }));
     }
+    js.runAndWait(parent);
 }
 
 bool primitiveHasVertexColor(cgltf_primitive* inPrim) {
@@ -205,6 +228,43 @@ bool requiresPacking(cgltf_accessor const* accessor) {
     }
 }
 
+bool requiresPadding(cgltf_accessor const* accessor) {
+    filament::VertexBuffer::AttributeType padded;
+    return !accessor->is_sparse &&
+            getPaddedElementType(accessor->type, accessor->component_type, &padded);
+}
+
+template<typename T>
+static void padVec3(T* dst, uint8_t const* src, size_t stride, size_t count, T w) {
+    for (size_t i = 0; i < count; i++, src += stride, dst += 4) {
+        memcpy(dst, src, sizeof(T) * 3);
+        dst[3] = w;
+    }
+}
+
+void padAttributes(void* dst, uint8_t const* src, cgltf_accessor const* accessor) {
+    assert_invariant(requiresPadding(accessor));
+    // The fourth component reads as 1.0 in the shader. This matters for positions, which are
+    // multiplied by the model matrix as is.
+    const bool normalized = accessor->normalized;
+    const size_t stride = accessor->stride;
+    const size_t count = accessor->count;
+    switch (accessor->component_type) {
+        case cgltf_component_type_r_8:
+            padVec3((int8_t*) dst, src, stride, count, int8_t(normalized ? INT8_MAX : 1));
+            break;
+        case cgltf_component_type_r_8u:
+            padVec3((uint8_t*) dst, src, stride, count, uint8_t(normalized ? UINT8_MAX : 1));
+            break;
+        case cgltf_component_type_r_16u:
+            padVec3((uint16_t*) dst, src, stride, count, uint16_t(normalized ? UINT16_MAX : 1));
+            break;
+        default:
+            assert_invariant(false);
+            break;
+    }
+}
+
 bool loadCgltfBuffers(cgltf_data const* gltf, char const* gltfPath,
         UriDataCacheHandle uriDataCacheHandle) {
     SYSTRACE_CONTEXT();
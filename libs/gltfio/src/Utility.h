@@ -31,6 +31,10 @@ class DracoCache;
 
 struct cgltf_accessor;
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace filament::gltfio {
 
 // Referenced in ResourceLoader and AssetLoaderExtended
@@ -44,13 +48,15 @@ namespace filament::gltfio::utility {
 
 // Functions that are shared between the original implementation and the extended implementation.
 void decodeDracoMeshes(cgltf_data const* gltf, cgltf_primitive const* prim, DracoCache* dracoCache);
-void decodeMeshoptCompression(cgltf_data* data);
+void decodeMeshoptCompression(cgltf_data* data, utils::JobSystem& js);
 bool primitiveHasVertexColor(cgltf_primitive* inPrim);
 uint32_t computeBindingSize(cgltf_accessor const* accessor);
 void convertBytesToShorts(uint16_t* dst, uint8_t const* src, size_t count);
 uint32_t computeBindingOffset(cgltf_accessor const* accessor);
 bool requiresConversion(cgltf_accessor const* accessor);
 bool requiresPacking(cgltf_accessor const* accessor);
+bool requiresPadding(cgltf_accessor const* accessor);
+void padAttributes(void* dst, uint8_t const* src, cgltf_accessor const* accessor);
 bool loadCgltfBuffers(cgltf_data const* gltf, char const* gltfPath,
         UriDataCacheHandle uriDataCacheHandle);
 
@@ -23,6 +23,7 @@
 #include "TangentsJobExtended.h"
 
 #include <filament/BufferObject.h>
+#include <filament/Engine.h>
 
 #include <utils/JobSystem.h>
 #include <utils/Log.h>
@@ -530,7 +531,7 @@ bool AssetLoaderExtended::createPrimitive(Input* input, Output* out,
         if (!mCgltfBuffersLoaded) {
             return false;
         }
-        utility::decodeMeshoptCompression(gltf);
+        utility::decodeMeshoptCompression(gltf, mEngine->getJobSystem());
     }
 
     utility::decodeDracoMeshes(gltf, prim, input->dracoCache);
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <ibl/Cubemap.h>
+#include <ibl/CubemapIBL.h>
+#include <ibl/CubemapSH.h>
+#include <ibl/CubemapUtils.h>
+#include <ibl/Image.h>
+
+#include <utils/JobSystem.h>
+
+#include <math/vec3.h>
+
+#include <benchmark/benchmark.h>
+
+#include <utility>
+#include <vector>
+
+using namespace filament::ibl;
+using namespace filament::math;
+using namespace utils;
+
+namespace {
+
+// A cubemap filled with a gradient, with all its mipmap levels, as cmgen would prepare it.
+struct Environment {
+    std::vector<Image> images;
+    std::vector<Cubemap> levels;
+
+    Environment(JobSystem& js, size_t dim) {
+        Image image;
+        Cubemap base = CubemapUtils::create(image, dim);
+        CubemapUtils::process<CubemapUtils::EmptyState>(base, js,
+                [&](CubemapUtils::EmptyState&, size_t y, Cubemap::Face f,
+                        Cubemap::Texel* data, size_t dim) {
+                    for (size_t x = 0; x < dim; ++x, ++data) {
+                        float3 const N = base.getDirectionFor(f, x, y);
+                        Cubemap::writeAt(data, abs(N) * 16.0f);
+                    }
+                });
+        base.makeSeamless();
+        images.push_back(std::move(image));
+        levels.push_back(std::move(base));
+
+        while (dim > 1) {
+            dim >>= 1u;
+            Image temp;
+            Cubemap dst = CubemapUtils::create(temp, dim);
+            CubemapUtils::downsampleCubemapLevelBoxFilter(js, dst, levels.back());
+            dst.makeSeamless();
+            images.push_back(std::move(temp));
+            levels.push_back(std::move(dst));
+        }
+    }
+};
+
+} // anonymous namespace
+
+static void BM_roughnessFilter(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+
+    Environment const environment(js, 256);
+    size_t const dim = size_t(state.range(0));
+    size_t const sampleCount = size_t(state.range(1));
+
+    Image image;
+    Cubemap dst = CubemapUtils::create(image, dim);
+    for (auto _ : state) {
+        CubemapIBL::roughnessFilter(js, dst, environment.levels, 0.5f, sampleCount,
+                float3{ 1, 1, 1 }, true);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * dim * dim * 6));
+
+    js.emancipate();
+}
+
+static void BM_computeSH(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+
+    Environment const environment(js, size_t(state.range(0)));
+
+    for (auto _ : state) {
+        auto sh = CubemapSH::computeSH(js, environment.levels[0], 3, true);
+        benchmark::DoNotOptimize(sh);
+    }
+    size_t const dim = environment.levels[0].getDimensions();
+    state.SetItemsProcessed(int64_t(state.iterations() * dim * dim * 6));
+
+    js.emancipate();
+}
+
+BENCHMARK(BM_roughnessFilter)->Args({ 64, 64 })->Args({ 128, 256 })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_computeSH)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
@@ -28,7 +28,6 @@
 #include <math/mat3.h>
 #include <math/scalar.h>
 
-#include <random>
 #include <vector>
 
 using namespace filament::math;
@@ -71,6 +70,20 @@ static float3 UTILS_UNUSED hemisphereUniformSample(float2 u) { // pdf = 1.0 / (2
     return { sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta };
 }
 
+/*
+ * Returns a pseudo-random angle in [-pi, pi) that only depends on the texel's coordinates.
+ * Unlike a random number generator, this doesn't need any per-thread state, which lets us
+ * process all the scanlines of a face in parallel, and the result is deterministic.
+ */
+static float texelRandomAngle(Cubemap::Face f, size_t x, size_t y) noexcept {
+    // PCG hash, see "Hash Functions for GPU Rendering", Jarzynski & Olano, 2020
+    uint32_t h = (uint32_t(f) * 4096u + uint32_t(y)) * 4096u + uint32_t(x);
+    h = h * 747796405u + 2891336453u;
+    h = ((h >> ((h >> 28u) + 4u)) ^ h) * 277803737u;
+    h = (h >> 22u) ^ h;
+    return float(h >> 8u) * (2.0f * (float) F_PI / float(1u << 24u)) - (float) F_PI;
+}
+
 /*
  *
  * Importance sampling Charlie
@@ -416,13 +429,7 @@ void CubemapIBL::roughnessFilter(
     });
 
 
-    struct State {
-        // maybe blue-noise instead would look even better
-        std::default_random_engine gen;
-        std::uniform_real_distribution<float> distribution{ -F_PI, F_PI };
-    };
-
-    auto scanline = [&](State& state, size_t y,
+    auto scanline = [&](CubemapUtils::EmptyState&, size_t y,
             Cubemap::Face f, Cubemap::Texel* data, size_t dim) {
         if (UTILS_UNLIKELY(updater)) {
             size_t p = progress.fetch_add(1, std::memory_order_relaxed) + 1;
@@ -440,7 +447,8 @@ void CubemapIBL::roughnessFilter(
             R[1] = cross(N, R[0]);
             R[2] = N;
 
-            R *= mat3f::rotation(state.distribution(state.gen), float3{0,0,1});
+            // maybe blue-noise instead would look even better
+            R *= mat3f::rotation(texelRandomAngle(f, x, y), float3{0,0,1});
 
             float3 Li = 0;
             for (size_t sample = 0; sample < numSamples; sample++) {
@@ -458,9 +466,10 @@ void CubemapIBL::roughnessFilter(
     // don't use the jobsystem unless we have enough work per scanline -- or the overhead of
     // launching jobs will prevail.
     if (dst.getDimensions() * maxNumSamples <= 256) {
-        CubemapUtils::processSingleThreaded<State>(dst, js, std::ref(scanline));
+        CubemapUtils::processSingleThreaded<CubemapUtils::EmptyState>(
+                dst, js, std::ref(scanline));
     } else {
-        CubemapUtils::process<State>(dst, js, std::ref(scanline));
+        CubemapUtils::process<CubemapUtils::EmptyState>(dst, js, std::ref(scanline));
     }
 }
 
@@ -22,6 +22,9 @@
 
 #include <filament/Texture.h>
 
+#include <stddef.h>
+#include <stdint.h>
+
 namespace filament {
 class Engine;
 class View;
@@ -320,17 +323,54 @@ public:
                 filament::Texture const* environmentCubemap,
                 filament::Texture* outReflectionsTexture = nullptr);
 
-        // TODO: option for progressive filtering
+        /**
+         * Starts generating a prefiltered cubemap progressively. The work is split in slices
+         * (half the faces of one level) which are rendered one at a time by calling step(),
+         * typically once per frame, so that updating the environment at runtime doesn't cause
+         * a hitch.
+         *
+         * The parameters are the same as operator(). environmentCubemap must stay valid until
+         * isComplete() returns true. Calling start() again abandons the pending work.
+         *
+         * @return returns outReflectionsTexture, its content is only valid once isComplete()
+         *         returns true.
+         * @see step(), isComplete()
+         */
+        filament::Texture* start(Options options,
+                filament::Texture const* environmentCubemap,
+                filament::Texture* outReflectionsTexture = nullptr);
+
+        /**
+         * Renders the next slice of the work started with start(). Does nothing if there is
+         * no pending work.
+         * @return true if the prefiltered cubemap is complete.
+         */
+        bool step();
 
-        // TODO: add a callback for when the processing is done?
+        /**
+         * @return true if there is no pending work started with start().
+         */
+        bool isComplete() const noexcept { return mPendingSlice == mPendingSliceCount; }
 
     private:
+        filament::Texture* prepare(Options const& options,
+                filament::Texture const* environmentCubemap,
+                filament::Texture* outReflectionsTexture);
+        void renderSlice(Options const& options,
+                filament::Texture const* environmentCubemap,
+                filament::Texture* outReflectionsTexture, size_t slice);
         filament::Texture* createReflectionsTexture();
         IBLPrefilterContext& mContext;
         filament::Material* mKernelMaterial = nullptr;
         filament::Texture* mKernelTexture = nullptr;
         uint32_t mSampleCount = 0u;
         uint8_t mLevelCount = 1u;
+        // state of the progressive filtering
+        Options mPendingOptions;
+        filament::Texture const* mPendingEnvironment = nullptr;
+        filament::Texture* mPendingReflections = nullptr;
+        uint8_t mPendingSlice = 0u;
+        uint8_t mPendingSliceCount = 0u;
     };
 
 private:
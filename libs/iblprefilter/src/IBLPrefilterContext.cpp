@@ -567,6 +567,11 @@ IBLPrefilterContext::SpecularFilter::operator=(SpecularFilter&& rhs) noexcept {
         swap(mKernelTexture, rhs.mKernelTexture);
         mSampleCount = rhs.mSampleCount;
         mLevelCount = rhs.mLevelCount;
+        mPendingOptions = rhs.mPendingOptions;
+        swap(mPendingEnvironment, rhs.mPendingEnvironment);
+        swap(mPendingReflections, rhs.mPendingReflections);
+        swap(mPendingSlice, rhs.mPendingSlice);
+        swap(mPendingSliceCount, rhs.mPendingSliceCount);
     }
     return *this;
 }
@@ -600,7 +605,54 @@ Texture* IBLPrefilterContext::SpecularFilter::operator()(
         Texture const* environmentCubemap, Texture* outReflectionsTexture) {
 
     SYSTRACE_CALL();
-    using namespace backend;
+
+    outReflectionsTexture = prepare(options, environmentCubemap, outReflectionsTexture);
+
+    // each level is rendered in two slices, the positive and negative faces
+    const size_t sliceCount = outReflectionsTexture->getLevels() * 2;
+    for (size_t slice = 0; slice < sliceCount; slice++) {
+        renderSlice(options, environmentCubemap, outReflectionsTexture, slice);
+    }
+
+    return outReflectionsTexture;
+}
+
+Texture* IBLPrefilterContext::SpecularFilter::start(
+        IBLPrefilterContext::SpecularFilter::Options options,
+        Texture const* environmentCubemap, Texture* outReflectionsTexture) {
+
+    SYSTRACE_CALL();
+
+    outReflectionsTexture = prepare(options, environmentCubemap, outReflectionsTexture);
+
+    mPendingOptions = options;
+    mPendingEnvironment = environmentCubemap;
+    mPendingReflections = outReflectionsTexture;
+    mPendingSlice = 0;
+    mPendingSliceCount = uint8_t(outReflectionsTexture->getLevels() * 2);
+
+    return outReflectionsTexture;
+}
+
+bool IBLPrefilterContext::SpecularFilter::step() {
+    if (isComplete()) {
+        return true;
+    }
+
+    SYSTRACE_CALL();
+
+    renderSlice(mPendingOptions, mPendingEnvironment, mPendingReflections, mPendingSlice);
+
+    mPendingSlice++;
+    if (isComplete()) {
+        mPendingEnvironment = nullptr;
+        mPendingReflections = nullptr;
+    }
+    return isComplete();
+}
+
+Texture* IBLPrefilterContext::SpecularFilter::prepare(Options const& options,
+        Texture const* environmentCubemap, Texture* outReflectionsTexture) {
 
     FILAMENT_CHECK_PRECONDITION(environmentCubemap != nullptr) << "environmentCubemap is null!";
 
@@ -626,6 +678,20 @@ Texture* IBLPrefilterContext::SpecularFilter::operator()(
             << "outReflectionsTexture has " << +outReflectionsTexture->getLevels() << " levels but "
             << +mLevelCount << " are requested.";
 
+    if (options.generateMipmap) {
+        // We need mipmaps for prefiltering
+        environmentCubemap->generateMipmaps(mContext.mEngine);
+    }
+
+    return outReflectionsTexture;
+}
+
+void IBLPrefilterContext::SpecularFilter::renderSlice(Options const& options,
+        Texture const* environmentCubemap, Texture* outReflectionsTexture, size_t slice) {
+
+    SYSTRACE_NAME("executeFilterLOD");
+    using namespace backend;
+
     const TextureCubemapFace faces[2][3] = {
             { TextureCubemapFace::POSITIVE_X, TextureCubemapFace::POSITIVE_Y, TextureCubemapFace::POSITIVE_Z },
             { TextureCubemapFace::NEGATIVE_X, TextureCubemapFace::NEGATIVE_Y, TextureCubemapFace::NEGATIVE_Z }
@@ -636,16 +702,17 @@ Texture* IBLPrefilterContext::SpecularFilter::operator()(
     Renderer* const renderer = mContext.mRenderer;
     MaterialInstance* const mi = mContext.mIntegrationMaterial->getDefaultInstance();
 
+    // the material instance is shared, so all parameters are set again for each slice
     RenderableManager& rcm = engine.getRenderableManager();
     rcm.setMaterialInstanceAt(
             rcm.getInstance(mContext.mFullScreenQuadEntity), 0, mi);
 
-    const uint32_t sampleCount = mSampleCount;
-    const float linear = options.hdrLinear;
-    const float compress = options.hdrMax;
+    const size_t lod = slice / 2;
+    const size_t i = slice % 2;
     const uint8_t levels = outReflectionsTexture->getLevels();
-    uint32_t dim = outReflectionsTexture->getWidth();
-    const float omegaP = (4.0f * f::PI) / float(6 * dim * dim);
+    const uint32_t baseDim = outReflectionsTexture->getWidth();
+    const uint32_t dim = std::max(1u, baseDim >> lod);
+    const float omegaP = (4.0f * f::PI) / float(6 * baseDim * baseDim);
 
     TextureSampler environmentSampler;
     environmentSampler.setMagFilter(SamplerMagFilter::LINEAR);
@@ -653,53 +720,35 @@ Texture* IBLPrefilterContext::SpecularFilter::operator()(
 
     mi->setParameter("environment", environmentCubemap, environmentSampler);
     mi->setParameter("kernel", mKernelTexture, TextureSampler{ SamplerMagFilter::NEAREST });
-    mi->setParameter("compress", float2{ linear, compress });
-    mi->setParameter("lodOffset", options.lodOffset - log4(omegaP));
-
-    if (options.generateMipmap) {
-        // We need mipmaps for prefiltering
-        environmentCubemap->generateMipmaps(engine);
+    mi->setParameter("compress", float2{ options.hdrLinear, options.hdrMax });
+    mi->setParameter("sampleCount", uint32_t(lod == 0 ? 1u : mSampleCount));
+    mi->setParameter("attachmentLevel", uint32_t(lod));
+
+    if (lod == levels - 1) {
+        // this is the last lod, use a more aggressive filtering because this level is also
+        // used for the diffuse brdf by filament, and we need it to be very smooth.
+        // So we set the lod offset to at least 2.
+        mi->setParameter("lodOffset", std::max(2.0f, options.lodOffset) - log4(omegaP));
+    } else {
+        mi->setParameter("lodOffset", options.lodOffset - log4(omegaP));
     }
 
-    RenderTarget::Builder builder;
-    builder.texture(RenderTarget::AttachmentPoint::COLOR0, outReflectionsTexture)
-           .texture(RenderTarget::AttachmentPoint::COLOR1, outReflectionsTexture)
-           .texture(RenderTarget::AttachmentPoint::COLOR2, outReflectionsTexture);
-
-    for (size_t lod = 0; lod < levels; lod++) {
-        SYSTRACE_NAME("executeFilterLOD");
-
-        mi->setParameter("sampleCount", uint32_t(lod == 0 ? 1u : sampleCount));
-        mi->setParameter("attachmentLevel", uint32_t(lod));
-
-        if (lod == levels - 1) {
-            // this is the last lod, use a more aggressive filtering because this level is also
-            // used for the diffuse brdf by filament, and we need it to be very smooth.
-            // So we set the lod offset to at least 2.
-            mi->setParameter("lodOffset", std::max(2.0f, options.lodOffset) - log4(omegaP));
-        }
-
-        builder.mipLevel(RenderTarget::AttachmentPoint::COLOR0, lod)
-               .mipLevel(RenderTarget::AttachmentPoint::COLOR1, lod)
-               .mipLevel(RenderTarget::AttachmentPoint::COLOR2, lod);
-
-        view->setViewport({ 0, 0, dim, dim });
-
-        for (size_t i = 0; i < 2; i++) {
-            mi->setParameter("side", i == 0 ? 1.0f : -1.0f);
-
-            builder.face(RenderTarget::AttachmentPoint::COLOR0, faces[i][0])
-                   .face(RenderTarget::AttachmentPoint::COLOR1, faces[i][1])
-                   .face(RenderTarget::AttachmentPoint::COLOR2, faces[i][2]);
-
-            RenderTarget* const rt = builder.build(engine);
-            view->setRenderTarget(rt);
-            renderer->renderStandaloneView(view);
-            engine.destroy(rt);
-        }
+    mi->setParameter("side", i == 0 ? 1.0f : -1.0f);
 
-        dim >>= 1;
-    }
+    RenderTarget* const rt = RenderTarget::Builder()
+            .texture(RenderTarget::AttachmentPoint::COLOR0, outReflectionsTexture)
+            .texture(RenderTarget::AttachmentPoint::COLOR1, outReflectionsTexture)
+            .texture(RenderTarget::AttachmentPoint::COLOR2, outReflectionsTexture)
+            .mipLevel(RenderTarget::AttachmentPoint::COLOR0, lod)
+            .mipLevel(RenderTarget::AttachmentPoint::COLOR1, lod)
+            .mipLevel(RenderTarget::AttachmentPoint::COLOR2, lod)
+            .face(RenderTarget::AttachmentPoint::COLOR0, faces[i][0])
+            .face(RenderTarget::AttachmentPoint::COLOR1, faces[i][1])
+            .face(RenderTarget::AttachmentPoint::COLOR2, faces[i][2])
+            .build(engine);
 
-    return outReflectionsTexture;
+    view->setViewport({ 0, 0, dim, dim });
+    view->setRenderTarget(rt);
+    renderer->renderStandaloneView(view);
+    engine.destroy(rt);
 }
@@ -24,6 +24,10 @@
 #include <cstddef>
 #include <initializer_list>
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace image {
 
 // Concatenates images horizontally to create a filmstrip atlas, similar to numpy's hstack.
@@ -72,6 +76,12 @@ using PresenceCallback = bool(*)(const LinearImage& img, uint32_t col, uint32_t
 UTILS_PUBLIC
 LinearImage computeCoordField(const LinearImage& src, PresenceCallback presence, void* user);
 
+// Same as above, but the distance transform of each row and column is computed concurrently using
+// the given JobSystem. The presence callback is only called from the calling thread.
+UTILS_PUBLIC
+LinearImage computeCoordField(utils::JobSystem& js, const LinearImage& src,
+        PresenceCallback presence, void* user);
+
 // Generates a single-channel Euclidean distance field with positive values outside the region
 // of interest in the source image, and zero values inside. If sqrt is false, the computed
 // distances are squared. If signed distance (SDF) is desired, this function can be called a second
@@ -65,6 +65,7 @@ struct KtxMetadata;
  */
 class UTILS_PUBLIC Ktx1Bundle {
 public:
+    using ReleaseCallback = void(*)(void* user);
 
     ~Ktx1Bundle();
 
@@ -80,6 +81,15 @@ public:
      */
     Ktx1Bundle(uint8_t const* bytes, uint32_t nbytes);
 
+    /**
+     * Creates a new bundle whose blobs reference the given serialized data instead of copying it,
+     * e.g. to upload the levels of a memory-mapped KTX file without an intermediate copy.
+     *
+     * The data must outlive the bundle, which calls the release callback (if any) once it is
+     * destroyed. The blobs of such a bundle are read-only: setBlob() and allocateBlob() fail.
+     */
+    Ktx1Bundle(uint8_t const* bytes, uint32_t nbytes, ReleaseCallback release, void* user);
+
     /**
      * Serializes the bundle into the given target memory. Returns false if there's not enough
      * memory.
@@ -136,13 +146,13 @@ public:
 
     /**
      * Copies the given data into the blob at the given index, replacing whatever is already there.
-     * Returns false if the given blob index is out of bounds.
+     * Returns false if the given blob index is out of bounds, or if the bundle references its data.
      */
     bool setBlob(KtxBlobIndex index, uint8_t const* data, uint32_t size);
 
     /**
      * Allocates the blob at the given index to the given number of bytes. This allows subsequent
-     * calls to setBlob to be thread-safe.
+     * calls to setBlob to be thread-safe. Returns false if the bundle references its data.
      */
     bool allocateBlob(KtxBlobIndex index, uint32_t size);
 
@@ -276,6 +286,8 @@ public:
     static constexpr uint32_t SRGB8_ALPHA8_ETC2_EAC = 0x9279;
 
 private:
+    void deserialize(uint8_t const* bytes, uint32_t nbytes);
+
     image::KtxInfo mInfo = {};
     uint32_t mNumMipLevels;
     uint32_t mArrayLength;
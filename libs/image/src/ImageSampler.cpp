@@ -21,6 +21,7 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 
 #include <memory>
@@ -348,6 +349,23 @@ void generateMipmaps(const LinearImage& source, Filter filter, LinearImage* resu
     }
 }
 
+void generateMipmaps(utils::JobSystem& js, const LinearImage& source, Filter filter,
+        LinearImage* result, uint32_t mips) {
+    using namespace utils;
+    mips = std::min(mips, getMipmapCount(source));
+    JobSystem::Job* parent = js.createJob();
+    uint32_t width = source.getWidth();
+    uint32_t height = source.getHeight();
+    for (uint32_t n = 0; n < mips; ++n) {
+        width = std::max(width >> 1u, 1u);
+        height = std::max(height >> 1u, 1u);
+        js.run(jobs::createJob(js, parent, [&source, filter, dst = result + n, width, height]() {
+            *dst = resampleImage(source, width, height, filter);
+        }));
+    }
+    js.runAndWait(parent);
+}
+
 uint32_t getMipmapCount(const LinearImage& source) {
     uint32_t width = source.getWidth();
     uint32_t height = source.getHeight();
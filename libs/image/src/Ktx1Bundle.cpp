@@ -61,8 +61,24 @@ struct KtxBlobList {
     std::vector<uint8_t> blobs;
     std::vector<uint32_t> sizes;
 
+    // Serialized data referenced by the blobs instead of the above storage, with the offset of
+    // each blob. The levels aren't contiguous there, each one starts with its size.
+    uint8_t const* external = nullptr;
+    std::vector<uint32_t> offsets;
+    Ktx1Bundle::ReleaseCallback release = nullptr;
+    void* releaseUser = nullptr;
+
+    ~KtxBlobList() {
+        if (release) {
+            release(releaseUser);
+        }
+    }
+
     // Obtains a pointer to the given blob.
     uint8_t* get(uint32_t blobIndex) {
+        if (external) {
+            return const_cast<uint8_t*>(external) + offsets[blobIndex];
+        }
         uint8_t* result = blobs.data();
         for (uint32_t i = 0; i < blobIndex; ++i) {
             result += sizes[i];
@@ -109,6 +125,18 @@ Ktx1Bundle::Ktx1Bundle(uint32_t numMipLevels, uint32_t arrayLength, bool isCubem
 
 Ktx1Bundle::Ktx1Bundle(uint8_t const* bytes, uint32_t nbytes) :
         mBlobs(new KtxBlobList), mMetadata(new KtxMetadata) {
+    deserialize(bytes, nbytes);
+}
+
+Ktx1Bundle::Ktx1Bundle(uint8_t const* bytes, uint32_t nbytes, ReleaseCallback release,
+        void* user) : mBlobs(new KtxBlobList), mMetadata(new KtxMetadata) {
+    mBlobs->external = bytes;
+    mBlobs->release = release;
+    mBlobs->releaseUser = user;
+    deserialize(bytes, nbytes);
+}
+
+void Ktx1Bundle::deserialize(uint8_t const* bytes, uint32_t nbytes) {
     FILAMENT_CHECK_PRECONDITION(sizeof(SerializationHeader) <= nbytes) << "KTX buffer is too small";
 
     // First, "parse" the header by casting it to a struct.
@@ -151,18 +179,30 @@ Ktx1Bundle::Ktx1Bundle(uint8_t const* bytes, uint32_t nbytes) :
     const bool isNonArrayCube = mNumCubeFaces > 1 && mArrayLength == 1;
     const uint32_t facesPerMip = mArrayLength * mNumCubeFaces;
 
-    // Extract blobs from the serialized byte stream.
+    // Extract blobs from the serialized byte stream, or just locate them when they're referenced.
     const uint32_t totalSize = nbytes - (pdata - bytes);
-    mBlobs->blobs.resize(totalSize);
+    if (mBlobs->external) {
+        mBlobs->offsets.resize(mBlobs->sizes.size());
+    } else {
+        mBlobs->blobs.resize(totalSize);
+    }
     for (uint32_t mipmap = 0; mipmap < mNumMipLevels; ++mipmap) {
         const uint32_t imageSize = *((uint32_t const*) pdata);
         const uint32_t faceSize = isNonArrayCube ? imageSize : (imageSize / facesPerMip);
         const uint32_t levelSize = faceSize * mNumCubeFaces * mArrayLength;
         pdata += sizeof(uint32_t);
-        memcpy(mBlobs->get(flatten(this, {mipmap, 0, 0})), pdata, levelSize);
+        FILAMENT_CHECK_PRECONDITION(pdata + levelSize <= bytes + nbytes)
+                << "KTX buffer is too small";
+        if (!mBlobs->external) {
+            memcpy(mBlobs->get(flatten(this, {mipmap, 0, 0})), pdata, levelSize);
+        }
         for (uint32_t layer = 0; layer < mArrayLength; ++layer) {
             for (uint32_t face = 0; face < mNumCubeFaces; ++face) {
-                mBlobs->sizes[flatten(this, {mipmap, layer, face})] = faceSize;
+                const uint32_t blobIndex = flatten(this, {mipmap, layer, face});
+                mBlobs->sizes[blobIndex] = faceSize;
+                if (mBlobs->external) {
+                    mBlobs->offsets[blobIndex] = uint32_t(pdata - bytes);
+                }
                 pdata += faceSize;
                 pdata += cubePadding;
             }
@@ -324,7 +364,7 @@ bool Ktx1Bundle::getBlob(KtxBlobIndex index, uint8_t** data, uint32_t* size) con
 
 bool Ktx1Bundle::setBlob(KtxBlobIndex index, uint8_t const* data, uint32_t size) {
     if (index.mipLevel >= mNumMipLevels || index.arrayIndex >= mArrayLength ||
-            index.cubeFace >= mNumCubeFaces) {
+            index.cubeFace >= mNumCubeFaces || mBlobs->external) {
         return false;
     }
     uint32_t flatIndex = flatten(this, index);
@@ -338,7 +378,7 @@ bool Ktx1Bundle::setBlob(KtxBlobIndex index, uint8_t const* data, uint32_t size)
 
 bool Ktx1Bundle::allocateBlob(KtxBlobIndex index, uint32_t size) {
     if (index.mipLevel >= mNumMipLevels || index.arrayIndex >= mArrayLength ||
-            index.cubeFace >= mNumCubeFaces) {
+            index.cubeFace >= mNumCubeFaces || mBlobs->external) {
         return false;
     }
     uint32_t flatIndex = flatten(this, index);
@@ -427,6 +427,51 @@ TEST_F(ImageTest, Ktx) { // NOLINT
     }
 }
 
+TEST_F(ImageTest, KtxReference) { // NOLINT
+    uint8_t level0[16] = {};
+    uint8_t level1[4] = {};
+    Ktx1Bundle nascent(2, 1, true);
+    for (uint32_t face = 0; face < 6; ++face) {
+        level0[0] = level1[0] = uint8_t(face);
+        ASSERT_TRUE(nascent.setBlob({0, 0, face}, level0, sizeof(level0)));
+        ASSERT_TRUE(nascent.setBlob({1, 0, face}, level1, sizeof(level1)));
+    }
+    nascent.setMetadata("foo", "bar");
+    vector<uint8_t> buffer(nascent.getSerializedLength());
+    ASSERT_TRUE(nascent.serialize(buffer.data(), buffer.size()));
+
+    int releaseCount = 0;
+    {
+        Ktx1Bundle reference(buffer.data(), buffer.size(),
+                [](void* user) { ++*(int*) user; }, &releaseCount);
+        ASSERT_EQ(reference.getNumMipLevels(), 2);
+        ASSERT_TRUE(reference.isCubemap());
+        ASSERT_EQ(string(reference.getMetadata("foo")), "bar");
+
+        // The blobs point into the buffer, and the faces of a level are contiguous.
+        uint8_t* data;
+        uint8_t* face5;
+        uint32_t size;
+        ASSERT_TRUE(reference.getBlob({0, 0, 0}, &data, &size));
+        ASSERT_EQ(size, sizeof(level0));
+        ASSERT_TRUE(reference.getBlob({0, 0, 5}, &face5, &size));
+        ASSERT_EQ(face5, data + 5 * sizeof(level0));
+        ASSERT_GE(data, buffer.data());
+        ASSERT_LT(face5, buffer.data() + buffer.size());
+        ASSERT_TRUE(reference.getBlob({1, 0, 3}, &data, &size));
+        ASSERT_EQ(size, sizeof(level1));
+        ASSERT_EQ(data[0], 3);
+
+        ASSERT_FALSE(reference.setBlob({0, 0, 0}, level0, sizeof(level0)));
+
+        vector<uint8_t> reserialized(reference.getSerializedLength());
+        ASSERT_TRUE(reference.serialize(reserialized.data(), reserialized.size()));
+        ASSERT_EQ(reserialized, buffer);
+        ASSERT_EQ(releaseCount, 0);
+    }
+    ASSERT_EQ(releaseCount, 1);
+}
+
 TEST_F(ImageTest, getSphericalHarmonics) {
     Ktx1Bundle ktx(2, 1, true);
 
@@ -23,6 +23,7 @@
 #include <limits>
 #include <memory>
 #include <iostream> // for cerr
+#include <vector>
 
 #if defined(WIN32)
     #include <Winsock2.h>
@@ -1029,13 +1030,11 @@ bool DDSEncoder::encode(const LinearImage& image) {
                 break;
             }
             case DXGI_FORMAT_R16_FLOAT: {
+                std::vector<half> row(width);
                 for (uint32_t y = 0; y < height; y++) {
                     const float* data = image.getPixelRef(0, y);
-                    for (size_t x = 0; x < width; x++) {
-                        half p = half(*data);
-                        mStream.write((const char*) &p, 2);
-                        data++;
-                    }
+                    floatToHalf(row.data(), data, width);
+                    mStream.write((const char*) row.data(), width * sizeof(half));
                 }
                 break;
             }
@@ -1078,13 +1077,11 @@ bool DDSEncoder::encode(const LinearImage& image) {
                 break;
             }
             case DXGI_FORMAT_R16G16_FLOAT: {
+                std::vector<half> row(width * 2);
                 for (uint32_t y = 0; y < height; y++) {
-                    const float2* data = reinterpret_cast<float2 const*>(image.getPixelRef(0, y));
-                    for (size_t x = 0; x < width; x++) {
-                        half2 p = half2(*data);
-                        mStream.write((const char*) &p, sizeof(p));
-                        data++;
-                    }
+                    const float* data = image.getPixelRef(0, y);
+                    floatToHalf(row.data(), data, width * 2);
+                    mStream.write((const char*) row.data(), width * sizeof(half2));
                 }
                 break;
             }
@@ -1128,13 +1125,15 @@ bool DDSEncoder::encode(const LinearImage& image) {
                 break;
             }
             case DXGI_FORMAT_R16G16B16A16_FLOAT: {
+                std::vector<float4> rgba(width);
+                std::vector<half> row(width * 4);
                 for (uint32_t y = 0; y < height; y++) {
                     auto data = image.get<float3>(0, y);
                     for (size_t x = 0; x < width; x++) {
-                        half4 p = half4(half3(*data), 1);
-                        mStream.write((const char*) &p, sizeof(ushort4));
-                        data++;
+                        rgba[x] = float4{ data[x], 1.0f };
                     }
+                    floatToHalf(row.data(), &rgba[0].x, width * 4);
+                    mStream.write((const char*) row.data(), width * sizeof(half4));
                 }
                 break;
             }
@@ -131,6 +131,16 @@ namespace Ktx1Reader {
      */
     Texture* createTexture(Engine* engine, Ktx1Bundle* ktx, bool srgb);
 
+    /**
+     * Memory-maps a KTX file into a bundle whose blobs reference the mapping rather than a copy
+     * of the file. The file is unmapped when the bundle is destroyed, so passing the bundle to
+     * createTexture(Engine*, Ktx1Bundle*, bool) uploads every miplevel straight from the mapping,
+     * and then releases it. Returns nullptr if the file can't be mapped or isn't a KTX file.
+     *
+     * @param path Path to a KTX file
+     */
+    Ktx1Bundle* createBundleFromFile(const char* path);
+
     CompressedPixelDataType toCompressedPixelDataType(const KtxInfo& info);
 
     PixelDataType toPixelDataType(const KtxInfo& info);
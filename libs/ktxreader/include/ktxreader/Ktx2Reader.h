@@ -117,7 +117,9 @@ class Ktx2Reader {
              * Retrieves the Texture object.
              *
              * The texture is available immediately, but does not have its miplevels ready until
-             * after doTranscoding() and the subsequent uploadImages() have been completed. The
+             * after doTranscoding() and the subsequent uploadImages() have been completed. Levels
+             * are transcoded from the smallest to the largest, and the texture only samples the
+             * levels uploaded so far, so it can be used at a lower resolution in the meantime. The
              * caller has ownership over this texture and is responsible for freeing it after all
              * miplevels have been uploaded.
              */
@@ -131,6 +133,21 @@ class Ktx2Reader {
              */
             Result doTranscoding();
 
+            /**
+             * Returns the number of mipmap levels in the KTX2 file.
+             */
+            uint32_t getLevelCount() const noexcept;
+
+            /**
+             * Transcodes a single mipmap level to the resolved format.
+             *
+             * Different levels can be transcoded concurrently from several threads, which lets a
+             * job system spread the work of a large texture. Each level must be transcoded only
+             * once. Smaller levels should be transcoded first, so that uploadImages() can make the
+             * texture available sooner.
+             */
+            Result doTranscoding(uint32_t levelIndex);
+
             /**
              * Uploads pending mipmaps to the texture.
              *
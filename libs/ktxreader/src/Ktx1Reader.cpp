@@ -20,9 +20,63 @@
 #include <filament/Engine.h>
 #include <filament/Texture.h>
 
+#include <string.h>
+
+#include <fcntl.h>
+#if !defined(WIN32)
+#    include <sys/mman.h>
+#    include <unistd.h>
+#else
+#    define NOMINMAX
+#    include <windows.h>
+#    include <io.h>
+#endif
+
 namespace ktxreader {
 namespace Ktx1Reader {
 
+namespace {
+
+struct MappedFile {
+    void* address;
+    size_t size;
+};
+
+void* mapFile(int fd, size_t size) {
+#if !defined(WIN32)
+    void* const data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    return data == MAP_FAILED ? nullptr : data;
+#else
+    HANDLE const mapping = CreateFileMappingA((HANDLE) _get_osfhandle(fd), nullptr,
+            PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        return nullptr;
+    }
+    void* const data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    // the view keeps the mapping alive
+    CloseHandle(mapping);
+    return data;
+#endif
+}
+
+void unmapFile(void* user) {
+    MappedFile* file = (MappedFile*) user;
+#if !defined(WIN32)
+    munmap(file->address, file->size);
+#else
+    UnmapViewOfFile(file->address);
+#endif
+    delete file;
+}
+
+const uint8_t KTX1_MAGIC[] = {
+        0xab, 0x4b, 0x54, 0x58, 0x20, 0x31, 0x31, 0xbb, 0x0d, 0x0a, 0x1a, 0x0a };
+
+// the size of the header of a KTX1 file, which precedes the metadata
+constexpr size_t KTX1_HEADER_SIZE = 16 * 4;
+
+} // anonymous namespace
+
 Texture* createTexture(Engine* engine, const Ktx1Bundle& ktx, bool srgb,
         Callback callback, void* userdata) {
     using Sampler = Texture::Sampler;
@@ -120,6 +174,36 @@ Texture* createTexture(Engine* engine, Ktx1Bundle* ktx, bool srgb) {
     return createTexture(engine, *ktx, srgb, freeKtx, ktx);
 }
 
+Ktx1Bundle* createBundleFromFile(const char* path) {
+    int const fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        utils::slog.e << "Unable to open " << path << utils::io::endl;
+        return nullptr;
+    }
+    size_t const size = (size_t) lseek(fd, 0, SEEK_END);
+    lseek(fd, 0, SEEK_SET);
+    void* const data = size >= KTX1_HEADER_SIZE && size <= UINT32_MAX ?
+            mapFile(fd, size) : nullptr;
+    close(fd);
+    if (!data) {
+        utils::slog.e << "Unable to map " << path << utils::io::endl;
+        return nullptr;
+    }
+    if (memcmp(data, KTX1_MAGIC, sizeof(KTX1_MAGIC)) != 0) {
+        utils::slog.e << path << " is not a KTX1 file" << utils::io::endl;
+        unmapFile(new MappedFile{ data, size });
+        return nullptr;
+    }
+
+#if !defined(WIN32)
+    // all of the file is uploaded right away
+    madvise(data, size, MADV_WILLNEED);
+#endif
+
+    return new Ktx1Bundle((uint8_t const*) data, uint32_t(size), unmapFile,
+            new MappedFile{ data, size });
+}
+
 CompressedPixelDataType toCompressedPixelDataType(const KtxInfo& info) {
     return toCompressedFilamentEnum<CompressedPixelDataType>(info.glInternalFormat);
 }
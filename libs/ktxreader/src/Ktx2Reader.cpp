@@ -113,6 +113,20 @@ static void freeCallback(void* buf, size_t, void* userdata) {
     free(buf);
 }
 
+// Returns the calling thread's transcoder state. It is reused between levels and textures to
+// avoid reallocating its scratch buffers every time, we only need to invalidate the level whose
+// uncompressed data it holds, since that belongs to another transcoder.
+static ktx2_transcoder_state& getThreadTranscoderState() {
+    // don't hold on to the uncompressed data of very large levels
+    constexpr size_t MAX_RETAINED_SIZE = 4u * 1024u * 1024u;
+    thread_local ktx2_transcoder_state state;
+    if (state.m_level_uncomp_data.capacity() > MAX_RETAINED_SIZE) {
+        state.m_level_uncomp_data.clear();
+    }
+    state.m_uncomp_data_level_index = -1;
+    return state;
+}
+
 // This helper is used by both the asynchronous and synchronous API's.
 static Result transcodeImageLevel(ktx2_transcoder& transcoder,
         ktx2_transcoder_state& transcoderState, Texture::InternalFormat format,
@@ -170,6 +184,8 @@ public:
             mSourceBuffer(std::move(buf)) {}
     Texture* getTexture() const noexcept { return mTexture; }
     Result doTranscoding();
+    uint32_t getLevelCount() const noexcept { return mTranscoder->get_levels(); }
+    Result doTranscoding(uint32_t levelIndex);
     void uploadImages();
 
 protected:
@@ -183,6 +199,11 @@ private:
     // miplevel in the texture.
     TranscoderResult mTranscoderResults[KTX2_MAX_SUPPORTED_LEVEL_COUNT] = {};
 
+    // Levels already uploaded by uploadImages(), and the largest level such that all the
+    // levels below it are resident, which is the first level the texture samples.
+    bool mUploaded[KTX2_MAX_SUPPORTED_LEVEL_COUNT] = {};
+    uint32_t mFirstResidentLevel = KTX2_MAX_SUPPORTED_LEVEL_COUNT;
+
     Texture* const mTexture;
     Engine& mEngine;
 
@@ -244,8 +265,7 @@ Texture* Ktx2Reader::load(const void* data, size_t size, TransferFunction transf
         return nullptr;
     }
 
-    ktx2_transcoder_state basisThreadState;
-    basisThreadState.clear();
+    ktx2_transcoder_state& basisThreadState = getThreadTranscoderState();
 
     for (uint32_t levelIndex = 0, n = mTranscoder->get_levels(); levelIndex < n; levelIndex++) {
         Texture::PixelBufferDescriptor* pbd;
@@ -273,20 +293,30 @@ FAsync::~FAsync() {
 }
 
 Result FAsync::doTranscoding() {
-    ktx2_transcoder_state basisThreadState;
-    basisThreadState.clear();
-    for (uint32_t levelIndex = 0, n = mTranscoder->get_levels(); levelIndex < n; levelIndex++) {
-        Texture::PixelBufferDescriptor* pbd;
-        Result result = transcodeImageLevel(*mTranscoder, basisThreadState, mTexture->getFormat(),
-                levelIndex, &pbd);
+    // transcode the smallest levels first, so that uploadImages() can make the texture
+    // available at a low resolution as soon as possible
+    for (uint32_t levelIndex = mTranscoder->get_levels(); levelIndex-- > 0;) {
+        Result result = doTranscoding(levelIndex);
         if (UTILS_UNLIKELY(result != Result::SUCCESS)) {
             return result;
         }
-        mTranscoderResults[levelIndex].store(pbd);
     }
     return Result::SUCCESS;
 }
 
+Result FAsync::doTranscoding(uint32_t levelIndex) {
+    assert_invariant(levelIndex < mTranscoder->get_levels());
+    ktx2_transcoder_state& basisThreadState = getThreadTranscoderState();
+    Texture::PixelBufferDescriptor* pbd;
+    Result result = transcodeImageLevel(*mTranscoder, basisThreadState, mTexture->getFormat(),
+            levelIndex, &pbd);
+    if (UTILS_UNLIKELY(result != Result::SUCCESS)) {
+        return result;
+    }
+    mTranscoderResults[levelIndex].store(pbd);
+    return Result::SUCCESS;
+}
+
 void FAsync::uploadImages() {
     size_t levelIndex = 0;
     UTILS_NOUNROLL
@@ -295,10 +325,22 @@ void FAsync::uploadImages() {
         if (pbd) {
             level.store(nullptr);
             mTexture->setImage(mEngine, levelIndex, std::move(*pbd));
+            mUploaded[levelIndex] = true;
             delete pbd;
         }
         ++levelIndex;
     }
+
+    // only sample the levels that have been uploaded, from the smallest one up
+    uint32_t const levelCount = mTranscoder->get_levels();
+    uint32_t firstResidentLevel = levelCount;
+    while (firstResidentLevel > 0 && mUploaded[firstResidentLevel - 1]) {
+        --firstResidentLevel;
+    }
+    if (firstResidentLevel < levelCount && firstResidentLevel != mFirstResidentLevel) {
+        mFirstResidentLevel = firstResidentLevel;
+        mTexture->setMinMaxLevels(mEngine, firstResidentLevel, levelCount - 1);
+    }
 }
 
 Async* Ktx2Reader::asyncCreate(const void* data, size_t size, TransferFunction transfer) {
@@ -434,6 +476,14 @@ Result Async::doTranscoding() {
     return static_cast<FAsync*>(this)->doTranscoding();
 }
 
+uint32_t Async::getLevelCount() const noexcept {
+    return static_cast<FAsync const*>(this)->getLevelCount();
+}
+
+Result Async::doTranscoding(uint32_t levelIndex) {
+    return static_cast<FAsync*>(this)->doTranscoding(levelIndex);
+}
+
 void Async::uploadImages() {
     return static_cast<FAsync*>(this)->uploadImages();
 }
@@ -26,6 +26,9 @@
 #include <tsl/robin_map.h>
 #include <utils/Mutex.h>
 
+#include <atomic>
+#include <vector>
+
 class CivetServer;
 
 namespace filament::matdbg {
@@ -41,6 +44,44 @@ struct MaterialRecord {
     VariantList activeVariants;
 };
 
+/**
+ * Runtime statistics of one frame, gathered by the engine while a client is watching them.
+ */
+struct FrameStats {
+    struct Pass {
+        const char* name;               // static string
+        int64_t gpuTime;                // in nanoseconds
+    };
+    struct Material {
+        uint32_t drawCount = 0;
+        uint64_t triangleCount = 0;
+    };
+
+    uint32_t frameId = 0;
+
+    // GPU timings are only available a few frames later, they belong to frame gpuFrameId
+    uint32_t gpuFrameId = 0;
+    int64_t gpuFrameTime = 0;           // in nanoseconds
+    std::vector<Pass> passes;
+
+    uint32_t drawCount = 0;
+    uint64_t triangleCount = 0;
+
+    // number of programs created by this frame, i.e. shader compilations
+    uint32_t programCount = 0;
+
+    size_t commandBufferSize = 0;       // bytes flushed to the command stream
+    uint32_t commandBufferWaitCount = 0;
+    uint64_t commandBufferWaitTime = 0; // in nanoseconds
+
+    // fraction of the JobSystem threads time spent running jobs, negative if unknown
+    float jobSystemUtilization = -1.0f;
+
+    tsl::robin_map<MaterialKey, Material> materials;
+
+    void clear() noexcept;
+};
+
 /**
  * Server-side material debugger.
  *
@@ -84,6 +125,17 @@ public:
 
     bool isReady() const { return mServer; }
 
+    /**
+     * Returns true if a client has requested frame statistics recently. The engine only gathers
+     * them in that case, so that they cost nothing when nobody is watching.
+     */
+    bool isStreamingStats() const;
+
+    /**
+     * Publishes the statistics of the last frame, served by /api/stats.
+     */
+    void setFrameStats(FrameStats const& stats);
+
 private:
     MaterialRecord const* getRecord(const MaterialKey& key) const;
 
@@ -110,6 +162,12 @@ private:
     utils::CString mChunkedMessage;
     size_t mChunkedMessageRemaining = 0;
 
+    FrameStats mFrameStats;
+    mutable utils::Mutex mFrameStatsMutex;
+
+    // time of the last /api/stats request, in nanoseconds since the epoch of steady_clock
+    std::atomic<int64_t> mLastStatsRequest = 0;
+
     EditCallback mEditCallback = nullptr;
     QueryCallback mQueryCallback = nullptr;
 
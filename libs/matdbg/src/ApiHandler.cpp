@@ -244,6 +244,60 @@ bool ApiHandler::handleGetStatus(struct mg_connection* conn,
     return true;
 }
 
+// Returns the statistics of the last frame, the engine gathers them only while this is being polled.
+bool ApiHandler::handleGetStats(struct mg_connection* conn) {
+    mServer->mLastStatsRequest.store(
+            std::chrono::steady_clock::now().time_since_epoch().count(),
+            std::memory_order_relaxed);
+
+    FrameStats stats;
+    {
+        std::unique_lock const lock(mServer->mFrameStatsMutex);
+        stats = mServer->mFrameStats;
+    }
+
+    std::ostringstream json;
+    json << "{ \"frameId\": " << stats.frameId
+         << ", \"gpuFrameId\": " << stats.gpuFrameId
+         << ", \"gpuFrameTime\": " << stats.gpuFrameTime
+         << ", \"drawCount\": " << stats.drawCount
+         << ", \"triangleCount\": " << stats.triangleCount
+         << ", \"programCount\": " << stats.programCount
+         << ", \"commandBufferSize\": " << stats.commandBufferSize
+         << ", \"commandBufferWaitCount\": " << stats.commandBufferWaitCount
+         << ", \"commandBufferWaitTime\": " << stats.commandBufferWaitTime
+         << ", \"jobSystemUtilization\": " << stats.jobSystemUtilization
+         << ", \"passes\": [";
+    for (size_t i = 0; i < stats.passes.size(); i++) {
+        auto const& pass = stats.passes[i];
+        json << (i ? ", " : "") << "{ \"name\": \"" << (pass.name ? pass.name : "")
+             << "\", \"gpuTime\": " << pass.gpuTime << " }";
+    }
+    json << "], \"materials\": [";
+    {
+        std::unique_lock const lock(mServer->mMaterialRecordsMutex);
+        char matid[9];
+        bool first = true;
+        for (auto const& [key, material] : stats.materials) {
+            auto const iter = mServer->mMaterialRecords.find(key);
+            char const* name = iter != mServer->mMaterialRecords.end() ?
+                    iter->second.name.c_str_safe() : "";
+            snprintf(matid, sizeof(matid), "%8.8x", key);
+            json << (first ? "" : ", ") << "{ \"matid\": \"" << matid
+                 << "\", \"name\": \"" << name
+                 << "\", \"drawCount\": " << material.drawCount
+                 << ", \"triangleCount\": " << material.triangleCount << " }";
+            first = false;
+        }
+    }
+    json << "] }";
+
+    std::string const str = json.str();
+    mg_printf(conn, kSuccessHeader.data(), "application/json");
+    mg_write(conn, str.data(), str.size());
+    return true;
+}
+
 bool ApiHandler::handlePost(CivetServer* server, struct mg_connection* conn) {
     struct mg_request_info const* request = mg_get_request_info(conn);
     std::string const& uri = request->local_uri;
@@ -394,6 +448,10 @@ bool ApiHandler::handleGet(CivetServer* server, struct mg_connection* conn) {
         return handleGetStatus(conn, request);
     }
 
+    if (uri == "/api/stats") {
+        return handleGetStats(conn);
+    }
+
     return error(__LINE__, uri);
 }
 
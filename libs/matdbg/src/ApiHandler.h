@@ -36,6 +36,7 @@ struct MaterialRecord;
 //    GET /api/shader?matid={id}&type=[glsl|spirv]&[glindex|vkindex|metalindex]={index}
 //    GET /api/active
 //    GET /api/status
+//    GET /api/stats
 //    POST /api/edit
 //
 class ApiHandler : public CivetHandler {
@@ -51,6 +52,7 @@ public:
 private:
     bool handleGetApiShader(struct mg_connection* conn, struct mg_request_info const* request);
     bool handleGetStatus(struct mg_connection* conn, struct mg_request_info const* request);
+    bool handleGetStats(struct mg_connection* conn);
     MaterialRecord const* getMaterialRecord(struct mg_request_info const* request);
 
     DebugServer* mServer;
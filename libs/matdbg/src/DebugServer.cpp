@@ -40,6 +40,7 @@
 
 #include "sca/GLSLTools.h"
 
+#include <chrono>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -213,6 +214,26 @@ void DebugServer::removeMaterial(MaterialKey key) {
     mMaterialRecords.erase(key);
 }
 
+void FrameStats::clear() noexcept {
+    passes.clear();
+    materials.clear();
+    *this = { .passes = std::move(passes), .materials = std::move(materials) };
+}
+
+bool DebugServer::isStreamingStats() const {
+    // The web UI polls /api/stats a few times per second, stop gathering statistics shortly
+    // after it stops doing so.
+    using namespace std::chrono;
+    int64_t const now = steady_clock::now().time_since_epoch().count();
+    return now - mLastStatsRequest.load(std::memory_order_relaxed) <
+           duration_cast<steady_clock::duration>(2s).count();
+}
+
+void DebugServer::setFrameStats(FrameStats const& stats) {
+    std::unique_lock<utils::Mutex> lock(mFrameStatsMutex);
+    mFrameStats = stats;
+}
+
 const MaterialRecord* DebugServer::getRecord(const MaterialKey& key) const {
     std::unique_lock<utils::Mutex> lock(mMaterialRecordsMutex);
     const auto& iter = mMaterialRecords.find(key);
@@ -113,6 +113,7 @@ static bool printMaterial(ostream& text, const ChunkContainer& container) {
     printChunk<Shading, uint8_t>(text, container, MaterialShading, "Model: ");
     printChunk<MaterialDomain, uint8_t>(text, container, ChunkType::MaterialDomain, "Material domain: ");
     printChunk<UserVariantFilterMask, uint32_t>(text, container, ChunkType::MaterialVariantFilterMask, "Material Variant Filter: ");
+    printChunk<UserVariantFilterMask, uint32_t>(text, container, ChunkType::MaterialSpecializedVariants, "Material Specialized Variants: ");
     printChunk<VertexDomain, uint8_t>(text, container, MaterialVertexDomain, "Vertex domain: ");
     printChunk<Interpolation, uint8_t>(text, container, MaterialInterpolation, "Interpolation: ");
     printChunk<bool, bool>(text, container, MaterialShadowMultiplier, "Shadow multiply: ");
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <vector>
+
+#include <stddef.h>
+
+using namespace filament::math;
+
+static void init(std::vector<mat4f>& v) noexcept {
+    for (size_t i = 0; i < v.size(); i++) {
+        float const a = float(i) / float(v.size());
+        v[i] = mat4f::translation(float3{ a, 2.0f * a, 3.0f }) *
+               mat4f::eulerZYX(a, 2.0f * a, 3.0f * a) *
+               mat4f::scaling(float3{ 1.0f + a });
+    }
+}
+
+struct Multiply {
+    using result_type = mat4f;
+    mat4f operator()(mat4f const& lhs, mat4f const& rhs) { return lhs * rhs; }
+    static const char* label() { return "mat4f * mat4f"; }
+};
+
+struct MultiplyScalar {
+    using result_type = mat4f;
+    mat4f operator()(mat4f const& lhs, mat4f const& rhs) {
+        mat4f res;
+        for (size_t col = 0; col < 4; ++col) {
+            float4 r{};
+            for (size_t k = 0; k < 4; ++k) {
+                r += lhs[k] * rhs[col][k];
+            }
+            res[col] = r;
+        }
+        return res;
+    }
+    static const char* label() { return "mat4f * mat4f (scalar)"; }
+};
+
+struct MultiplyVector {
+    using result_type = float4;
+    float4 operator()(mat4f const& lhs, mat4f const& rhs) { return lhs * rhs[3]; }
+    static const char* label() { return "mat4f * float4"; }
+};
+
+struct Inverse {
+    using result_type = mat4f;
+    mat4f operator()(mat4f const& lhs, mat4f const&) { return inverse(lhs); }
+    static const char* label() { return "inverse(mat4f)"; }
+};
+
+struct InverseGaussJordan {
+    using result_type = mat4f;
+    mat4f operator()(mat4f const& lhs, mat4f const&) {
+        return details::matrix::gaussJordanInverse(lhs);
+    }
+    static const char* label() { return "inverse(mat4f) (gauss-jordan)"; }
+};
+
+template <typename T>
+static void BM_mat4(benchmark::State& state) noexcept {
+    T f;
+    state.SetLabel(T::label());
+    std::vector<mat4f> data(1024);
+    std::vector<typename T::result_type> res(data.size());
+    init(data);
+
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            for (size_t i = 0, c = data.size(); i < c; i++) {
+                res[i] = f(data[i], data[(i + 1) % c]);
+            }
+            benchmark::ClobberMemory();
+            benchmark::DoNotOptimize(res);
+        }
+        pc.stop();
+        state.SetItemsProcessed(state.iterations() * data.size());
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_mat4, Multiply);
+BENCHMARK_TEMPLATE(BM_mat4, MultiplyScalar);
+BENCHMARK_TEMPLATE(BM_mat4, MultiplyVector);
+BENCHMARK_TEMPLATE(BM_mat4, Inverse);
+BENCHMARK_TEMPLATE(BM_mat4, InverseGaussJordan);
@@ -28,6 +28,24 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#if defined(__ARM_NEON)
+#   include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#   include <wasm_simd128.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#   include <xmmintrin.h>
+#endif
+
+// Whether 4x4 float matrix products use SIMD kernels, this needs to know when a product is
+// evaluated at runtime, since the kernels can't be constexpr.
+#if MATH_HAS_IS_CONSTANT_EVALUATED && \
+        (defined(__ARM_NEON) || defined(__wasm_simd128__) || defined(__SSE__) || \
+         defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#   define MATH_HAS_SIMD_MAT4 1
+#else
+#   define MATH_HAS_SIMD_MAT4 0
+#endif
+
 namespace filament {
 namespace math {
 namespace details {
@@ -94,6 +112,66 @@ constexpr MATRIX MATH_PURE gaussJordanInverse(MATRIX src) {
     return inverted;
 }
 
+//------------------------------------------------------------------------------
+// 4x4 matrix inverse, by expanding the cofactors along the first row. All the 2x2 minors are
+// computed once, and the columns of the result are computed with vector operations.
+template<typename MATRIX>
+constexpr MATRIX MATH_PURE fastInverse4(const MATRIX& m) {
+    typedef typename MATRIX::value_type T;
+    typedef typename MATRIX::col_type V;
+
+    // Importantly, our matrices are column-major!
+
+    const T c00 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+    const T c02 = m[1][2] * m[3][3] - m[3][2] * m[1][3];
+    const T c03 = m[1][2] * m[2][3] - m[2][2] * m[1][3];
+    const T c04 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+    const T c06 = m[1][1] * m[3][3] - m[3][1] * m[1][3];
+    const T c07 = m[1][1] * m[2][3] - m[2][1] * m[1][3];
+    const T c08 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+    const T c10 = m[1][1] * m[3][2] - m[3][1] * m[1][2];
+    const T c11 = m[1][1] * m[2][2] - m[2][1] * m[1][2];
+    const T c12 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+    const T c14 = m[1][0] * m[3][3] - m[3][0] * m[1][3];
+    const T c15 = m[1][0] * m[2][3] - m[2][0] * m[1][3];
+    const T c16 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+    const T c18 = m[1][0] * m[3][2] - m[3][0] * m[1][2];
+    const T c19 = m[1][0] * m[2][2] - m[2][0] * m[1][2];
+    const T c20 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+    const T c22 = m[1][0] * m[3][1] - m[3][0] * m[1][1];
+    const T c23 = m[1][0] * m[2][1] - m[2][0] * m[1][1];
+
+    const V f0{ c00, c00, c02, c03 };
+    const V f1{ c04, c04, c06, c07 };
+    const V f2{ c08, c08, c10, c11 };
+    const V f3{ c12, c12, c14, c15 };
+    const V f4{ c16, c16, c18, c19 };
+    const V f5{ c20, c20, c22, c23 };
+
+    const V v0{ m[1][0], m[0][0], m[0][0], m[0][0] };
+    const V v1{ m[1][1], m[0][1], m[0][1], m[0][1] };
+    const V v2{ m[1][2], m[0][2], m[0][2], m[0][2] };
+    const V v3{ m[1][3], m[0][3], m[0][3], m[0][3] };
+
+    const V signA{ 1, -1, 1, -1 };
+    const V signB{ -1, 1, -1, 1 };
+
+    MATRIX inverted{};
+    inverted[0] = (v1 * f0 - v2 * f1 + v3 * f2) * signA;
+    inverted[1] = (v0 * f0 - v2 * f3 + v3 * f4) * signB;
+    inverted[2] = (v0 * f1 - v1 * f3 + v3 * f5) * signA;
+    inverted[3] = (v0 * f2 - v1 * f4 + v2 * f5) * signB;
+
+    const V row0{ inverted[0][0], inverted[1][0], inverted[2][0], inverted[3][0] };
+    const V d = m[0] * row0;
+    const T det = (d[0] + d[1]) + (d[2] + d[3]);
+    const T oneOverDet = T(1) / det;
+    for (size_t col = 0; col < 4; ++col) {
+        inverted[col] *= oneOverDet;
+    }
+    return inverted;
+}
+
 //------------------------------------------------------------------------------
 // 2x2 matrix inverse is easy.
 template<typename MATRIX>
@@ -399,11 +477,75 @@ inline constexpr typename MATRIX::value_type MATH_PURE det(const MATRIX& matrix)
 template<typename MATRIX,
         typename = std::enable_if_t<MATRIX::NUM_ROWS == MATRIX::NUM_COLS, int>>
 inline constexpr MATRIX MATH_PURE inverse(const MATRIX& matrix) {
-    return (MATRIX::NUM_ROWS == 2) ? fastInverse2<MATRIX>(matrix) :
-           ((MATRIX::NUM_ROWS == 3) ? fastInverse3<MATRIX>(matrix) :
-            gaussJordanInverse<MATRIX>(matrix));
+    if constexpr (MATRIX::NUM_ROWS == 2) {
+        return fastInverse2<MATRIX>(matrix);
+    } else if constexpr (MATRIX::NUM_ROWS == 3) {
+        return fastInverse3<MATRIX>(matrix);
+    } else if constexpr (MATRIX::NUM_ROWS == 4) {
+        return fastInverse4<MATRIX>(matrix);
+    } else {
+        return gaussJordanInverse<MATRIX>(matrix);
+    }
+}
+
+#if MATH_HAS_SIMD_MAT4
+
+template<typename MATRIX>
+constexpr bool isSimdMat4() noexcept {
+    return MATRIX::NUM_ROWS == 4 && MATRIX::NUM_COLS == 4 &&
+           std::is_same_v<typename MATRIX::value_type, float>;
+}
+
+/*
+ * Multiplies the column-major 4x4 matrix `lhs` by `count` 4-components column vectors stored
+ * contiguously in `rhs`, i.e. each result is a linear combination of the columns of `lhs`.
+ * `dst` can be the same as `rhs`.
+ */
+inline void multiplySimd4(float* dst, float const* lhs, float const* rhs, size_t count) noexcept {
+#if defined(__ARM_NEON)
+    float32x4_t const c0 = vld1q_f32(lhs + 0);
+    float32x4_t const c1 = vld1q_f32(lhs + 4);
+    float32x4_t const c2 = vld1q_f32(lhs + 8);
+    float32x4_t const c3 = vld1q_f32(lhs + 12);
+    for (size_t i = 0; i < count; i++) {
+        float32x4_t const v = vld1q_f32(rhs + i * 4);
+        float32x4_t r = vmulq_n_f32(c0, vgetq_lane_f32(v, 0));
+        r = vmlaq_n_f32(r, c1, vgetq_lane_f32(v, 1));
+        r = vmlaq_n_f32(r, c2, vgetq_lane_f32(v, 2));
+        r = vmlaq_n_f32(r, c3, vgetq_lane_f32(v, 3));
+        vst1q_f32(dst + i * 4, r);
+    }
+#elif defined(__wasm_simd128__)
+    v128_t const c0 = wasm_v128_load(lhs + 0);
+    v128_t const c1 = wasm_v128_load(lhs + 4);
+    v128_t const c2 = wasm_v128_load(lhs + 8);
+    v128_t const c3 = wasm_v128_load(lhs + 12);
+    for (size_t i = 0; i < count; i++) {
+        v128_t const v = wasm_v128_load(rhs + i * 4);
+        v128_t r = wasm_f32x4_mul(c0, wasm_i32x4_shuffle(v, v, 0, 0, 0, 0));
+        r = wasm_f32x4_add(r, wasm_f32x4_mul(c1, wasm_i32x4_shuffle(v, v, 1, 1, 1, 1)));
+        r = wasm_f32x4_add(r, wasm_f32x4_mul(c2, wasm_i32x4_shuffle(v, v, 2, 2, 2, 2)));
+        r = wasm_f32x4_add(r, wasm_f32x4_mul(c3, wasm_i32x4_shuffle(v, v, 3, 3, 3, 3)));
+        wasm_v128_store(dst + i * 4, r);
+    }
+#else
+    __m128 const c0 = _mm_loadu_ps(lhs + 0);
+    __m128 const c1 = _mm_loadu_ps(lhs + 4);
+    __m128 const c2 = _mm_loadu_ps(lhs + 8);
+    __m128 const c3 = _mm_loadu_ps(lhs + 12);
+    for (size_t i = 0; i < count; i++) {
+        __m128 const v = _mm_loadu_ps(rhs + i * 4);
+        __m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_storeu_ps(dst + i * 4, r);
+    }
+#endif
 }
 
+#endif // MATH_HAS_SIMD_MAT4
+
 template<typename MATRIX_R, typename MATRIX_A, typename MATRIX_B,
         typename = std::enable_if_t<
                 MATRIX_A::NUM_COLS == MATRIX_B::NUM_ROWS &&
@@ -415,6 +557,14 @@ constexpr MATRIX_R MATH_PURE multiply(MATRIX_A lhs, MATRIX_B rhs) {
     //  rhs : C columns, D rows
     //  res : C columns, R rows
     MATRIX_R res{};
+#if MATH_HAS_SIMD_MAT4
+    if constexpr (isSimdMat4<MATRIX_R>() && isSimdMat4<MATRIX_A>() && isSimdMat4<MATRIX_B>()) {
+        if (!MATH_IS_CONSTANT_EVALUATED()) {
+            multiplySimd4(&res[0][0], &lhs[0][0], &rhs[0][0], 4);
+            return res;
+        }
+    }
+#endif
     for (size_t col = 0; col < MATRIX_R::NUM_COLS; ++col) {
         res[col] = lhs * rhs[col];
     }
@@ -564,6 +714,14 @@ private:
     friend inline constexpr typename BASE<arithmetic_result_t<T, U>>::col_type MATH_PURE
     operator*(const BASE<T>& lhs, const VEC<U>& rhs) {
         typename BASE<arithmetic_result_t<T, U>>::col_type result{};
+#if MATH_HAS_SIMD_MAT4
+        if constexpr (matrix::isSimdMat4<BASE<T>>() && std::is_same_v<U, float>) {
+            if (!MATH_IS_CONSTANT_EVALUATED()) {
+                matrix::multiplySimd4(&result[0], &lhs[0][0], &rhs[0], 1);
+                return result;
+            }
+        }
+#endif
         for (size_t col = 0; col < BASE<T>::NUM_COLS; ++col) {
             result += lhs[col] * rhs[col];
         }
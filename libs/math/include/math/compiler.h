@@ -60,6 +60,16 @@
 #   define MATH_UNLIKELY( exp )  (exp)
 #endif
 
+// Whether the current evaluation is a constant evaluation, this allows constexpr functions to
+// use SIMD intrinsics when they're evaluated at runtime.
+#if __has_builtin(__builtin_is_constant_evaluated) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#   define MATH_HAS_IS_CONSTANT_EVALUATED 1
+#   define MATH_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#   define MATH_HAS_IS_CONSTANT_EVALUATED 0
+#   define MATH_IS_CONSTANT_EVALUATED() true
+#endif
+
 #if __has_attribute(unused)
 #   define MATH_UNUSED __attribute__((unused))
 #else
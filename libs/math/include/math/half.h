@@ -164,6 +164,14 @@ inline constexpr half operator""_h(long double v) {
     return half( static_cast<float>(v) );
 }
 
+/*
+ * Converts `count` floats to half-floats and vice-versa. These use the F16C instructions on x86
+ * when the CPU supports them and the NEON conversion instructions on ARMv8, which is much
+ * faster than converting each element in turn. `dst` and `src` must not overlap.
+ */
+void floatToHalf(half* dst, float const* src, size_t count) noexcept;
+void halfToFloat(float* dst, half const* src, size_t count) noexcept;
+
 template<> struct is_arithmetic<filament::math::half> : public std::true_type {};
 
 } // namespace math
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math/half.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#   define MATH_HALF_NEON 1
+#   include <arm_neon.h>
+#elif (defined(__x86_64__) || defined(_M_X64)) && \
+        (defined(__clang__) || defined(__GNUC__)) && !defined(_MSC_VER)
+    // we need the target attribute and __builtin_cpu_supports()
+#   define MATH_HALF_F16C 1
+#   include <immintrin.h>
+#endif
+
+namespace filament::math {
+
+namespace {
+
+void floatToHalfGeneric(half* dst, float const* src, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = half(src[i]);
+    }
+}
+
+void halfToFloatGeneric(float* dst, half const* src, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = float(src[i]);
+    }
+}
+
+#if MATH_HALF_F16C
+
+__attribute__((target("avx,f16c")))
+void floatToHalfF16C(half* dst, float const* src, size_t count) noexcept {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i const h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+    }
+    floatToHalfGeneric(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx,f16c")))
+void halfToFloatF16C(float* dst, half const* src, size_t count) noexcept {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i const h = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    halfToFloatGeneric(dst + i, src + i, count - i);
+}
+
+bool hasF16C() noexcept {
+    static bool const supported = __builtin_cpu_supports("f16c") &&
+                                  __builtin_cpu_supports("avx");
+    return supported;
+}
+
+#endif
+
+} // anonymous namespace
+
+void floatToHalf(half* dst, float const* src, size_t count) noexcept {
+#if MATH_HALF_NEON
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1_f16(dst + i, vcvt_f16_f32(vld1q_f32(src + i)));
+    }
+    floatToHalfGeneric(dst + i, src + i, count - i);
+#elif MATH_HALF_F16C
+    if (hasF16C()) {
+        floatToHalfF16C(dst, src, count);
+        return;
+    }
+    floatToHalfGeneric(dst, src, count);
+#else
+    floatToHalfGeneric(dst, src, count);
+#endif
+}
+
+void halfToFloat(float* dst, half const* src, size_t count) noexcept {
+#if MATH_HALF_NEON
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vcvt_f32_f16(vld1_f16(src + i)));
+    }
+    halfToFloatGeneric(dst + i, src + i, count - i);
+#elif MATH_HALF_F16C
+    if (hasF16C()) {
+        halfToFloatF16C(dst, src, count);
+        return;
+    }
+    halfToFloatGeneric(dst, src, count);
+#else
+    halfToFloatGeneric(dst, src, count);
+#endif
+}
+
+} // namespace filament::math
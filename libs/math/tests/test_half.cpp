@@ -21,6 +21,11 @@
 #include <math/half.h>
 #include <math/vec4.h>
 
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+
 using namespace filament::math;
 
 class HalfTest : public testing::Test {
@@ -92,6 +97,31 @@ TEST_F(HalfTest, Vec) {
 }
 
 
+TEST_F(HalfTest, Bulk) {
+    // an odd count, so that the conversions have a remainder
+    std::vector<float> f(1027);
+    for (size_t i = 0; i < f.size(); i++) {
+        f[i] = (float(i) - 513.0f) * 0.37f;
+    }
+    f[0] = 65504.0f;
+    f[1] = -0.0f;
+    f[2] = std::numeric_limits<float>::infinity();
+
+    std::vector<half> h(f.size());
+    floatToHalf(h.data(), f.data(), f.size());
+    for (size_t i = 0; i < f.size(); i++) {
+        // the hardware rounds to nearest even, so allow a difference of one ulp
+        EXPECT_LE(abs(int(getBits(h[i])) - int(getBits(half(f[i])))), 1) << i;
+    }
+
+    std::vector<float> r(h.size());
+    halfToFloat(r.data(), h.data(), h.size());
+    for (size_t i = 0; i < h.size(); i++) {
+        // converting to float is exact
+        EXPECT_EQ(float(h[i]), r[i]) << i;
+    }
+}
+
 using fp10 = fp<0, 5, 5>;
 using fp11 = fp<0, 5, 6>;
 
@@ -871,6 +871,82 @@ TYPED_TEST(MatTestT, cofactor) {
     }
 }
 
+TYPED_TEST(MatTestT, Multiply4) {
+    static constexpr TypeParam value_eps =
+            TypeParam(1000) * std::numeric_limits<TypeParam>::epsilon();
+
+    typedef filament::math::details::TMat44<TypeParam> M44T;
+    typedef filament::math::details::TVec4<TypeParam> V4T;
+
+    std::default_random_engine generator(171717); // NOLINT
+    std::uniform_real_distribution<TypeParam> distribution(-1.0, 1.0);
+    auto rand_gen = std::bind(distribution, generator);
+
+    for (size_t i = 0; i < 100; ++i) {
+        M44T a, b;
+        V4T v;
+        for (size_t c = 0; c < 4; c++) {
+            a[c] = V4T{ rand_gen(), rand_gen(), rand_gen(), rand_gen() };
+            b[c] = V4T{ rand_gen(), rand_gen(), rand_gen(), rand_gen() };
+            v[c] = rand_gen();
+        }
+
+        // reference implementation
+        M44T ab;
+        V4T av;
+        for (size_t r = 0; r < 4; r++) {
+            for (size_t c = 0; c < 4; c++) {
+                TypeParam s = 0;
+                for (size_t k = 0; k < 4; k++) {
+                    s += a[k][r] * b[c][k];
+                }
+                ab[c][r] = s;
+            }
+            TypeParam s = 0;
+            for (size_t k = 0; k < 4; k++) {
+                s += a[k][r] * v[k];
+            }
+            av[r] = s;
+        }
+
+        M44T const m = a * b;
+        EXPECT_VEC_NEAR(m[0], ab[0], value_eps);
+        EXPECT_VEC_NEAR(m[1], ab[1], value_eps);
+        EXPECT_VEC_NEAR(m[2], ab[2], value_eps);
+        EXPECT_VEC_NEAR(m[3], ab[3], value_eps);
+        EXPECT_VEC_NEAR(a * v, av, value_eps);
+
+        M44T c = a;
+        c *= b;
+        EXPECT_VEC_NEAR(c[0], ab[0], value_eps);
+        EXPECT_VEC_NEAR(c[3], ab[3], value_eps);
+    }
+}
+
+TYPED_TEST(MatTestT, FastInverse4) {
+    static constexpr TypeParam value_eps =
+            TypeParam(1000) * std::numeric_limits<TypeParam>::epsilon();
+
+    typedef filament::math::details::TMat44<TypeParam> M44T;
+    typedef filament::math::details::TVec3<TypeParam> V3T;
+
+    std::default_random_engine generator(281828); // NOLINT
+    std::uniform_real_distribution<TypeParam> distribution(-10.0, 10.0);
+    auto rand_gen = std::bind(distribution, generator);
+
+    for (size_t i = 0; i < 100; ++i) {
+        M44T const m = M44T::translation(V3T{ rand_gen(), rand_gen(), rand_gen() }) *
+                M44T::eulerZYX(rand_gen(), rand_gen(), rand_gen()) *
+                M44T::scaling(V3T{ 1 + std::abs(rand_gen()), 1, 0.5 });
+        M44T const i0 = details::matrix::gaussJordanInverse(m);
+        M44T const i1 = details::matrix::fastInverse4(m);
+        EXPECT_VEC_NEAR(i0[0], i1[0], value_eps);
+        EXPECT_VEC_NEAR(i0[1], i1[1], value_eps);
+        EXPECT_VEC_NEAR(i0[2], i1[2], value_eps);
+        EXPECT_VEC_NEAR(i0[3], i1[3], value_eps);
+    }
+}
+
 
 
 #undef TEST_MATRIX_INVERSE
@@ -25,11 +25,27 @@
 
 namespace filament::uberz {
 
+// Version 0 archives are a single zstd frame that contains everything, including the packages.
+// Framed archives start with a zstd frame that contains the specs and flags, followed by one zstd
+// frame per material package. This lets the client decompress only the packages it needs.
+static constexpr uint32_t FRAMED_ARCHIVE_VERSION = 1;
+
 // ArchiveSpec is a parse-free binary format. The client simply casts a word-aligned content blob
 // into a ReadableArchive struct pointer, then calls the following function to convert all the
-// offset fields into pointers.
+// offset fields into pointers. In framed archives, packageOffset is the offset of the package
+// frame relative to the end of the first frame and is left as is.
 void convertOffsetsToPointers(struct ReadableArchive* archive);
 
+// Decompresses the first frame of an archive file into a word-aligned blob and converts its
+// offsets into pointers. Returns null if the archive is invalid; the returned archive must be
+// freed with utils::aligned_free().
+struct ReadableArchive* decompressArchive(const void* data, uint64_t byteCount);
+
+// Decompresses the package of a spec from a framed archive file into a buffer of at least
+// packageByteCount bytes. Returns false if the archive is invalid.
+bool decompressPackage(const struct ReadableArchive* archive, const struct ArchiveSpec& spec,
+        const void* data, uint64_t byteCount, uint8_t* package);
+
 UTILS_WARNING_PUSH
 UTILS_WARNING_ENABLE_PADDED
 
@@ -44,6 +60,8 @@ struct ReadableArchive {
         struct ArchiveSpec* specs;
         uint64_t specsOffset;
     };
+
+    bool isFramed() const noexcept { return version == FRAMED_ARCHIVE_VERSION; }
 };
 
 static constexpr Shading INVALID_SHADING_MODEL = (Shading) 0xff;
@@ -40,7 +40,10 @@ public:
 
     void addMaterial(const char* name, const uint8_t* package, size_t packageSize);
     void addSpecLine(std::string_view line);
-    utils::FixedCapacityVector<uint8_t> serialize() const;
+
+    // Produces a compressed archive. When framed is true, each package is compressed in its own
+    // zstd frame so that clients can decompress them on demand, at the cost of a larger archive.
+    utils::FixedCapacityVector<uint8_t> serialize(bool framed = false) const;
 
     // Low-level alternatives to addSpecLine that do not involve parsing:
     void setShadingModel(Shading sm);
@@ -17,6 +17,9 @@
 #include <uberz/ReadableArchive.h>
 
 #include <utils/debug.h>
+#include <utils/memalign.h>
+
+#include <zstd.h>
 
 using namespace filament;
 using namespace utils;
@@ -36,7 +39,9 @@ void convertOffsetsToPointers(ReadableArchive* archive) {
         ArchiveSpec& spec = archive->specs[i];
         assert_invariant(spec.flagsOffset % wordSize == 0);
         spec.flags = (ArchiveFlag*) (basePointer + (spec.flagsOffset / wordSize));
-        spec.package = ((uint8_t*) basePointer) + spec.packageOffset;
+        if (!archive->isFramed()) {
+            spec.package = ((uint8_t*) basePointer) + spec.packageOffset;
+        }
         for (uint64_t j = 0; j < spec.flagsCount; ++j) {
             ArchiveFlag& flag = spec.flags[j];
             flag.name = ((const char*) basePointer) + flag.nameOffset;
@@ -44,4 +49,44 @@ void convertOffsetsToPointers(ReadableArchive* archive) {
     }
 }
 
+ReadableArchive* decompressArchive(const void* data, uint64_t byteCount) {
+    // Framed archives have more than one frame, only the first one holds the specs.
+    const size_t frameSize = ZSTD_findFrameCompressedSize(data, byteCount);
+    if (ZSTD_isError(frameSize)) {
+        return nullptr;
+    }
+    const uint64_t decompSize = ZSTD_getFrameContentSize(data, frameSize);
+    if (decompSize == ZSTD_CONTENTSIZE_UNKNOWN || decompSize == ZSTD_CONTENTSIZE_ERROR ||
+            decompSize < sizeof(ReadableArchive)) {
+        return nullptr;
+    }
+    uint64_t* basePointer = (uint64_t*) utils::aligned_alloc(decompSize, 8);
+    const size_t result = ZSTD_decompress(basePointer, decompSize, data, frameSize);
+    ReadableArchive* archive = (ReadableArchive*) basePointer;
+    if (ZSTD_isError(result) || result != decompSize || archive->magic != 'UBER' ||
+            archive->version > FRAMED_ARCHIVE_VERSION) {
+        utils::aligned_free(basePointer);
+        return nullptr;
+    }
+    convertOffsetsToPointers(archive);
+    return archive;
+}
+
+bool decompressPackage(const ReadableArchive* archive, const ArchiveSpec& spec,
+        const void* data, uint64_t byteCount, uint8_t* package) {
+    assert_invariant(archive->isFramed());
+    const size_t archiveFrameSize = ZSTD_findFrameCompressedSize(data, byteCount);
+    if (ZSTD_isError(archiveFrameSize) || archiveFrameSize + spec.packageOffset >= byteCount) {
+        return false;
+    }
+    const uint8_t* frame = (const uint8_t*) data + archiveFrameSize + spec.packageOffset;
+    const size_t frameSize = ZSTD_findFrameCompressedSize(frame,
+            byteCount - archiveFrameSize - spec.packageOffset);
+    if (ZSTD_isError(frameSize)) {
+        return false;
+    }
+    const size_t result = ZSTD_decompress(package, spec.packageByteCount, frame, frameSize);
+    return !ZSTD_isError(result) && result == spec.packageByteCount;
+}
+
 } // namespace filament::uberz
@@ -226,7 +226,29 @@ void WritableArchive::addSpecLine(string_view line) {
     ++mLineNumber;
 }
 
-FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
+static FixedCapacityVector<uint8_t> compress(const uint8_t* data, size_t size) {
+    FixedCapacityVector<uint8_t> compressedBuf(ZSTD_compressBound(size));
+
+    // Maximum zstd compression is slow, but that's okay since uberz is invoked during the build,
+    // not at run time.  However in debug builds it is debilitatingly slow, and we're fine with
+    // larger archives, so we use minimum compression.
+#ifdef NDEBUG
+    const int compressionLevel = ZSTD_maxCLevel();
+#else
+    const int compressionLevel = ZSTD_minCLevel();
+#endif
+
+    size_t zstdResult = ZSTD_compress(compressedBuf.data(), compressedBuf.size(), data, size,
+            compressionLevel);
+    if (ZSTD_isError(zstdResult)) {
+        PANIC_POSTCONDITION("Error during archive compression: %s", ZSTD_getErrorName(zstdResult));
+    }
+
+    compressedBuf.resize(zstdResult);
+    return compressedBuf;
+}
+
+FixedCapacityVector<uint8_t> WritableArchive::serialize(bool framed) const {
     size_t byteCount = sizeof(ReadableArchive);
     for (const auto& mat : mMaterials) {
         byteCount += sizeof(ArchiveSpec);
@@ -244,13 +266,26 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
         }
     }
     size_t filamatOffset = byteCount;
-    for (const auto& mat : mMaterials) {
-        byteCount += mat.package.size();
+    if (!framed) {
+        for (const auto& mat : mMaterials) {
+            byteCount += mat.package.size();
+        }
+    }
+
+    // In framed archives, the package frames follow the archive frame, and their offsets are
+    // relative to its end since its compressed size isn't known yet.
+    auto packageFrames = FixedCapacityVector<FixedCapacityVector<uint8_t>>::with_capacity(
+            framed ? mMaterials.size() : 0);
+    if (framed) {
+        filamatOffset = 0;
+        for (const auto& mat : mMaterials) {
+            packageFrames.push_back(compress(mat.package.data(), mat.package.size()));
+        }
     }
 
     ReadableArchive archive;
     archive.magic = 'UBER';
-    archive.version = 0;
+    archive.version = framed ? FRAMED_ARCHIVE_VERSION : 0;
     archive.specsCount = mMaterials.size();
     archive.specsOffset = sizeof(ReadableArchive);
 
@@ -265,7 +300,7 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
         spec.packageByteCount = mat.package.size();
         spec.packageOffset = filamatOffset;
         specs.push_back(spec);
-        filamatOffset += mat.package.size();
+        filamatOffset += framed ? packageFrames[specs.size() - 1].size() : mat.package.size();
         flagCount += mat.flags.size();
     }
 
@@ -301,30 +336,30 @@ FixedCapacityVector<uint8_t> WritableArchive::serialize() const {
     writeCursor += sizeof(ArchiveFlag) * flags.size();
     memcpy(writeCursor, flagNames.data(), charCount);
     writeCursor += charCount;
-    for (const auto& mat : mMaterials) {
-        memcpy(writeCursor, mat.package.data(), mat.package.size());
-        writeCursor += mat.package.size();
+    if (!framed) {
+        for (const auto& mat : mMaterials) {
+            memcpy(writeCursor, mat.package.data(), mat.package.size());
+            writeCursor += mat.package.size();
+        }
     }
     assert_invariant(writeCursor - outputBuf.data() == outputBuf.size());
 
-    FixedCapacityVector<uint8_t> compressedBuf(ZSTD_compressBound(outputBuf.size()));
-
-    // Maximum zstd compression is slow, but that's okay since uberz is invoked during the build,
-    // not at run time.  However in debug builds it is debilitatingly slow, and we're fine with
-    // larger archives, so we use minimum compression.
-#ifdef NDEBUG
-    const int compressionLevel = ZSTD_maxCLevel();
-#else
-    const int compressionLevel = ZSTD_minCLevel();
-#endif
-
-    size_t zstdResult = ZSTD_compress(compressedBuf.data(), compressedBuf.size(), outputBuf.data(),
-            outputBuf.size(), compressionLevel);
-    if (ZSTD_isError(zstdResult)) {
-        PANIC_POSTCONDITION("Error during archive compression: %s", ZSTD_getErrorName(zstdResult));
+    FixedCapacityVector<uint8_t> compressedBuf = compress(outputBuf.data(), outputBuf.size());
+    if (framed) {
+        size_t size = compressedBuf.size();
+        for (const auto& frame : packageFrames) {
+            size += frame.size();
+        }
+        FixedCapacityVector<uint8_t> framedBuf(size);
+        uint8_t* cursor = framedBuf.data();
+        memcpy(cursor, compressedBuf.data(), compressedBuf.size());
+        cursor += compressedBuf.size();
+        for (const auto& frame : packageFrames) {
+            memcpy(cursor, frame.data(), frame.size());
+            cursor += frame.size();
+        }
+        return framedBuf;
     }
-
-    compressedBuf.resize(zstdResult);
     return compressedBuf;
 }
 
@@ -21,6 +21,21 @@
 
 #include <utils/Profiler.h>
 
+#include <stdint.h>
+
+/*
+ * Records the hardware performance counters of the calling thread for the lifetime of this
+ * object and reports them as per-iteration benchmark counters:
+ *   C   cpu cycles
+ *   I   instructions
+ *   CM  cache misses
+ *   BPU branch misses
+ *   CPI cycles per instruction
+ *
+ * Counters are only available on Linux and Android, and only the ones supported by the
+ * current cpu/kernel are reported. Like the other user counters, they are part of the
+ * benchmark's output in all formats, including --benchmark_format=json.
+ */
 class PerformanceCounters {
     benchmark::State& state;
     utils::Profiler profiler;
@@ -29,19 +44,32 @@ class PerformanceCounters {
 public:
     explicit PerformanceCounters(benchmark::State& state)
             : state(state) {
-        profiler.resetEvents(utils::Profiler::EV_CPU_CYCLES | utils::Profiler::EV_BPU_MISSES);
+        profiler.resetEvents(utils::Profiler::EV_CPU_CYCLES |
+                             utils::Profiler::EV_L1D_MISSES |
+                             utils::Profiler::EV_BPU_MISSES);
         profiler.start();
     }
+
     ~PerformanceCounters() {
         profiler.stop();
         counters = profiler.readCounters();
-        if (profiler.isValid()) {
-            state.counters.insert({
-                    { "C",   { (double)counters.getCpuCycles(),    benchmark::Counter::kAvgIterations }},
-                    { "I",   { (double)counters.getInstructions(), benchmark::Counter::kAvgIterations }},
-                    { "BPU", { (double)counters.getBranchMisses(), benchmark::Counter::kAvgIterations }},
-                    { "CPI", { (double)counters.getCPI(),          benchmark::Counter::kAvgThreads }},
-            });
+        if (!profiler.isValid()) {
+            return;
+        }
+        using utils::Profiler;
+        using benchmark::Counter;
+        uint32_t const events = profiler.getEnabledEvents();
+        auto& c = state.counters;
+        c["I"] = { (double)counters.getInstructions(), Counter::kAvgIterations };
+        if (events & Profiler::EV_CPU_CYCLES) {
+            c["C"]   = { (double)counters.getCpuCycles(), Counter::kAvgIterations };
+            c["CPI"] = { (double)counters.getCPI(), Counter::kAvgThreads };
+        }
+        if (events & Profiler::EV_L1D_MISSES) {
+            c["CM"]  = { (double)counters.getL1DMisses(), Counter::kAvgIterations };
+        }
+        if (events & Profiler::EV_BPU_MISSES) {
+            c["BPU"] = { (double)counters.getBranchMisses(), Counter::kAvgIterations };
         }
     }
 };
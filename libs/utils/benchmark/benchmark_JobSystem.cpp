@@ -21,6 +21,8 @@
 
 #include <benchmark/benchmark.h>
 
+#include <vector>
+
 using namespace utils;
 
 
@@ -78,7 +80,57 @@ static void BM_JobSystemParallelFor(benchmark::State& state) {
     js.emancipate();
 }
 
+// the cost of an item grows with its index, which is the typical case where splitting the range
+// in equal parts leaves most threads idle
+UTILS_NOINLINE
+static uint32_t skewedWork(uint32_t i) {
+    uint32_t v = i;
+    for (uint32_t j = 0, n = i * i / 4096; j < n; j++) {
+        v = v * 1664525u + 1013904223u;
+    }
+    return v;
+}
+
+template<typename S>
+static void parallelForSkewed(benchmark::State& state, S const& splitter) {
+    JobSystem js;
+    js.adopt();
+
+    std::vector<uint32_t> results(4096);
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            auto job = jobs::parallel_for(js, nullptr, 0, uint32_t(results.size()),
+                    [&results](uint32_t start, uint32_t count) {
+                        for (uint32_t i = start; i < start + count; i++) {
+                            results[i] = skewedWork(i);
+                        }
+                    }, splitter);
+            js.runAndWait(job);
+            benchmark::DoNotOptimize(results.data());
+        }
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * 4096);
+
+    js.emancipate();
+}
+
+static void BM_JobSystemParallelForSkewed(benchmark::State& state) {
+    parallelForSkewed(state, jobs::CountSplitter<64>());
+}
+
+static void BM_JobSystemParallelForAdaptive1(benchmark::State& state) {
+    parallelForSkewed(state, jobs::AdaptiveSplitter(1));
+}
+
+static void BM_JobSystemParallelForAdaptive16(benchmark::State& state) {
+    parallelForSkewed(state, jobs::AdaptiveSplitter(16));
+}
+
 
 BENCHMARK(BM_JobSystem);
 BENCHMARK(BM_JobSystemAsChildren4k);
 BENCHMARK(BM_JobSystemParallelFor);
+BENCHMARK(BM_JobSystemParallelForSkewed);
+BENCHMARK(BM_JobSystemParallelForAdaptive1);
+BENCHMARK(BM_JobSystemParallelForAdaptive16);
@@ -22,6 +22,12 @@
 
 #include <benchmark/benchmark.h>
 
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+#include <string.h>
+
 using namespace utils;
 
 
@@ -99,3 +105,38 @@ BENCHMARK_REGISTER_F(Allocators, poolAllocator_utils_mutex)
 BENCHMARK_REGISTER_F(Allocators, poolAllocator_atomic)
         ->ThreadRange(1, 4)
         ->Threads(benchmark::CPUInfo::Get().num_cpus * 2);
+
+// Writes one cache line in each 4 KiB page of a large area, in a random order, like a
+// render pass writing commands all over the per render pass arena. With regular pages, nearly
+// every write misses the dTLB; with huge pages, the whole area fits in a few TLB entries.
+static void hugePageArea_writes(benchmark::State& state) {
+    constexpr size_t AREA_SIZE = 64u * 1024u * 1024u;
+    constexpr size_t PAGE_SIZE = 4096u;
+    AreaPolicy::HugePageArea area(AREA_SIZE, state.range(0) != 0);
+    state.SetLabel(area.hasHugePages() ? "huge pages" : "regular pages");
+
+    char* const data = static_cast<char*>(area.data());
+    memset(data, 0, area.size());
+
+    // a permutation of all the pages, so that the hardware prefetcher can't help
+    std::vector<uint32_t> pages(AREA_SIZE / PAGE_SIZE);
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < pages.size(); i++) {
+        pages[i] = i;
+    }
+    for (size_t i = pages.size() - 1; i > 0; i--) {
+        seed = seed * 1664525u + 1013904223u;
+        std::swap(pages[i], pages[seed % (i + 1)]);
+    }
+
+    PerformanceCounters pc(state);
+    for (auto _ : state) {
+        for (uint32_t const page : pages) {
+            data[page * PAGE_SIZE] += 1;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * pages.size()));
+}
+
+BENCHMARK(hugePageArea_writes)->Arg(0)->Arg(1);
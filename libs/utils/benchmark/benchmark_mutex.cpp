@@ -17,10 +17,16 @@
 #include "PerformanceCounters.h"
 
 #include <utils/Allocator.h>
+#include <utils/Futex.h>
+#include <utils/MpscQueue.h>
 #include <utils/Mutex.h>
+#include <utils/SpscQueue.h>
 
 #include <benchmark/benchmark.h>
 
+#include <mutex>
+#include <vector>
+
 using namespace utils;
 
 static void BM_std_mutex(benchmark::State& state) {
@@ -41,6 +47,61 @@ static void BM_utils_mutex(benchmark::State& state) {
     }
 }
 
+// push/pop round-trips on a single thread, this measures the uncontended cost of each queue
+
+static void BM_mutex_queue(benchmark::State& state) {
+    std::mutex l;
+    std::vector<int> queue;
+    queue.reserve(1024);
+    PerformanceCounters pc(state);
+    for (auto _ : state) {
+        { std::lock_guard const lock(l); queue.push_back(0); }
+        { std::lock_guard const lock(l); queue.pop_back(); }
+    }
+}
+
+static void BM_spsc_queue(benchmark::State& state) {
+    SpscQueue<int> queue(1024);
+    PerformanceCounters pc(state);
+    int item;
+    for (auto _ : state) {
+        queue.push(0);
+        queue.pop(item);
+    }
+    benchmark::DoNotOptimize(item);
+}
+
+static void BM_mpsc_queue(benchmark::State& state) {
+    MpscQueue<int> queue(1024);
+    PerformanceCounters pc(state);
+    int item;
+    for (auto _ : state) {
+        queue.push(0);
+        queue.pop(item);
+    }
+    benchmark::DoNotOptimize(item);
+}
+
+// the cost of signaling a consumer which is not waiting
+static void BM_futex_notify(benchmark::State& state) {
+    static Futex f;
+    PerformanceCounters pc(state);
+    for (auto _ : state) {
+        f.fetch_add(1);
+        f.notify_one();
+    }
+}
+
+BENCHMARK(BM_mutex_queue);
+BENCHMARK(BM_spsc_queue);
+BENCHMARK(BM_mpsc_queue);
+
+BENCHMARK(BM_futex_notify)
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(8)
+    ->ThreadPerCpu();
+
 BENCHMARK(BM_std_mutex)
     ->Threads(1)
     ->Threads(2)
@@ -557,6 +557,64 @@ private:
     void* mEnd = nullptr;
 };
 
+/*
+ * A HeapArea that can be backed by huge pages (2 MiB on Linux and Android, the system's large
+ * pages on Windows), which reduces TLB misses when a large area is written all over, like the
+ * engine's per-frame arena. Explicit huge pages (MAP_HUGETLB, MEM_LARGE_PAGES) are tried first,
+ * then transparent huge pages, and when neither is available this behaves like a HeapArea.
+ * When huge pages are used, the size is rounded up to a multiple of their size.
+ */
+class HugePageArea {
+public:
+    HugePageArea() noexcept = default;
+
+    explicit HugePageArea(size_t size, bool hugePages = false);
+
+    ~HugePageArea() noexcept;
+
+    HugePageArea(const HugePageArea& rhs) = delete;
+    HugePageArea& operator=(const HugePageArea& rhs) = delete;
+
+    HugePageArea(HugePageArea&& rhs) noexcept {
+        swap(*this, rhs);
+    }
+
+    HugePageArea& operator=(HugePageArea&& rhs) noexcept {
+        swap(*this, rhs);
+        return *this;
+    }
+
+    void* data() const noexcept { return mBegin; }
+    void* begin() const noexcept { return mBegin; }
+    void* end() const noexcept { return mEnd; }
+    size_t size() const noexcept { return uintptr_t(mEnd) - uintptr_t(mBegin); }
+
+    // true if the memory was requested with huge pages and the system accepted it. With
+    // transparent huge pages this is only a hint, the kernel may still use small pages.
+    bool hasHugePages() const noexcept { return mType != Type::HEAP; }
+
+    friend void swap(HugePageArea& lhs, HugePageArea& rhs) noexcept {
+        using std::swap;
+        swap(lhs.mBegin, rhs.mBegin);
+        swap(lhs.mEnd, rhs.mEnd);
+        swap(lhs.mMapping, rhs.mMapping);
+        swap(lhs.mMappingSize, rhs.mMappingSize);
+        swap(lhs.mType, rhs.mType);
+    }
+
+private:
+    enum class Type : uint8_t {
+        HEAP,           // malloc()
+        HUGE_PAGES,     // MAP_HUGETLB or MEM_LARGE_PAGES
+        TRANSPARENT,    // mmap() + MADV_HUGEPAGE
+    };
+    void* mBegin = nullptr;
+    void* mEnd = nullptr;
+    void* mMapping = nullptr;
+    size_t mMappingSize = 0;
+    Type mType = Type::HEAP;
+};
+
 class NullArea {
 public:
     void* data() const noexcept { return nullptr; }
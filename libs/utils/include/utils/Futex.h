@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_UTILS_FUTEX_H
+#define TNT_UTILS_FUTEX_H
+
+#include <utils/compiler.h>
+
+#include <atomic>
+
+#if !defined(__linux__)
+#   include <condition_variable>
+#   include <mutex>
+#endif
+
+#include <stdint.h>
+
+namespace utils {
+
+/*
+ * A 32-bit atomic value that threads can sleep on until it changes. This is a futex on Linux and
+ * Android, elsewhere it falls back to a mutex and condition variable.
+ *
+ * Notifying is free when no thread is waiting, which makes this suitable for lock-free queues
+ * where the consumer only sleeps when it runs out of work.
+ */
+class Futex {
+public:
+    explicit Futex(uint32_t value = 0) noexcept : mValue(value) {}
+    Futex(Futex const&) = delete;
+    Futex& operator=(Futex const&) = delete;
+
+    uint32_t load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+        return mValue.load(order);
+    }
+
+    void store(uint32_t value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        mValue.store(value, order);
+    }
+
+    uint32_t fetch_add(uint32_t value,
+            std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return mValue.fetch_add(value, order);
+    }
+
+    // Blocks while the value is `expected`, this can return spuriously.
+    void wait(uint32_t expected) noexcept;
+
+    // Wakes up the threads blocked in wait(), this must be called after the value is changed.
+    void notify_one() noexcept {
+        if (UTILS_UNLIKELY(mWaiters.load())) {
+            wake(1);
+        }
+    }
+
+    void notify_all() noexcept {
+        if (UTILS_UNLIKELY(mWaiters.load())) {
+            wake(INT32_MAX);
+        }
+    }
+
+private:
+    void wake(int32_t count) noexcept;
+
+    std::atomic<uint32_t> mValue;
+    std::atomic<uint32_t> mWaiters = { 0 };
+#if !defined(__linux__)
+    std::mutex mLock;
+    std::condition_variable mCondition;
+#endif
+};
+
+} // namespace utils
+
+#endif // TNT_UTILS_FUTEX_H
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_UTILS_GENERATIONALCACHE_H
+#define TNT_UTILS_GENERATIONALCACHE_H
+
+#include <utils/compiler.h>
+#include <utils/debug.h>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace utils {
+
+/*
+ * A hash map for caches of GPU objects, using robin-hood open addressing with backward shift
+ * deletion. Each entry keeps its hash, so probing rarely needs to compare keys, and the
+ * generation it was last found in, so that entries unused for a number of generations (typically
+ * frames) can be evicted.
+ *
+ * Lookups and evictions are counted, see getAndResetStats().
+ *
+ * Key and Value must be default-constructible, and are expected to be small and cheap to move.
+ * Pointers returned by find() and insert() are invalidated by insert() and evict().
+ */
+template<typename Key, typename Value,
+        typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class GenerationalCache {
+public:
+    struct Stats {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t evictions;
+    };
+
+    GenerationalCache() noexcept = default;
+
+    // Reserves room for `capacity` entries.
+    explicit GenerationalCache(size_t capacity) {
+        rehash(capacityFor(capacity));
+    }
+
+    size_t size() const noexcept { return mSize; }
+
+    bool empty() const noexcept { return mSize == 0; }
+
+    uint32_t getGeneration() const noexcept { return mGeneration; }
+
+    // Starts a new generation, this is typically called once per frame.
+    void nextGeneration() noexcept { mGeneration++; }
+
+    // Returns the value associated to `key` and marks it as used in this generation, or nullptr.
+    Value* find(Key const& key) noexcept {
+        uint32_t const hash = hashOf(key);
+        if (UTILS_LIKELY(mSize)) {
+            size_t const mask = mSlots.size() - 1;
+            size_t index = hash & mask;
+            for (uint32_t distance = 1; mSlots[index].distance >= distance; distance++) {
+                Slot& slot = mSlots[index];
+                if (slot.hash == hash && KeyEqual{}(slot.key, key)) {
+                    slot.generation = mGeneration;
+                    mStats.hits++;
+                    return &slot.value;
+                }
+                index = (index + 1) & mask;
+            }
+        }
+        mStats.misses++;
+        return nullptr;
+    }
+
+    // Adds an entry used in this generation, `key` must not be in the cache already.
+    Value& insert(Key const& key, Value value) {
+        if (UTILS_UNLIKELY((mSize + 1) * 5 > mSlots.size() * 4)) {
+            rehash(capacityFor(mSize + 1));
+        }
+        Slot entry{ key, std::move(value), hashOf(key), mGeneration, 1 };
+        return place(std::move(entry));
+    }
+
+    // Removes the entries which were last used more than `maxAge` generations ago and for which
+    // `evictor(key, value)` returns true, it's expected to free the value.
+    template<typename Evictor>
+    size_t evict(uint32_t maxAge, Evictor&& evictor) {
+        size_t count = 0;
+        for (size_t i = 0, n = mSlots.size(); i < n;) {
+            Slot& slot = mSlots[i];
+            if (slot.distance && mGeneration - slot.generation > maxAge &&
+                    evictor(slot.key, slot.value)) {
+                // the next entry is shifted in this slot, so it must be looked at again
+                erase(i);
+                count++;
+            } else {
+                i++;
+            }
+        }
+        mStats.evictions += count;
+        return count;
+    }
+
+    // Calls `f(key, value)` for all entries, in no particular order.
+    template<typename F>
+    void forEach(F&& f) {
+        for (Slot& slot : mSlots) {
+            if (slot.distance) {
+                f(slot.key, slot.value);
+            }
+        }
+    }
+
+    void clear() noexcept {
+        for (Slot& slot : mSlots) {
+            slot = {};
+        }
+        mSize = 0;
+    }
+
+    Stats getAndResetStats() noexcept {
+        Stats const stats = mStats;
+        mStats = {};
+        return stats;
+    }
+
+private:
+    struct Slot {
+        Key key{};
+        Value value{};
+        uint32_t hash = 0;
+        uint32_t generation = 0;
+        // 1 + distance to the slot the hash maps to, 0 when the slot is empty
+        uint32_t distance = 0;
+    };
+
+    static uint32_t hashOf(Key const& key) noexcept {
+        size_t const hash = Hash{}(key);
+        return uint32_t(hash ^ (uint64_t(hash) >> 32u));
+    }
+
+    // smallest power-of-two capacity keeping the load factor below 80%
+    static size_t capacityFor(size_t count) noexcept {
+        size_t capacity = 16;
+        while (count * 5 > capacity * 4) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    Value& place(Slot&& entry) noexcept {
+        size_t const mask = mSlots.size() - 1;
+        Value* result = nullptr;
+        for (size_t index = entry.hash & mask;; index = (index + 1) & mask, entry.distance++) {
+            Slot& slot = mSlots[index];
+            if (!slot.distance) {
+                slot = std::move(entry);
+                mSize++;
+                return result ? *result : slot.value;
+            }
+            if (slot.distance < entry.distance) {
+                // take from the rich: the entry further from its slot gets this one
+                std::swap(slot, entry);
+                if (!result) {
+                    result = &slot.value;
+                }
+            }
+        }
+    }
+
+    void erase(size_t index) noexcept {
+        size_t const mask = mSlots.size() - 1;
+        size_t next = (index + 1) & mask;
+        while (mSlots[next].distance > 1) {
+            mSlots[index] = std::move(mSlots[next]);
+            mSlots[index].distance--;
+            index = next;
+            next = (next + 1) & mask;
+        }
+        mSlots[index] = {};
+        mSize--;
+    }
+
+    void rehash(size_t capacity) {
+        assert_invariant(!(capacity & (capacity - 1)));
+        std::vector<Slot> slots(capacity);
+        std::swap(slots, mSlots);
+        mSize = 0;
+        for (Slot& slot : slots) {
+            if (slot.distance) {
+                slot.distance = 1;
+                place(std::move(slot));
+            }
+        }
+    }
+
+    std::vector<Slot> mSlots;
+    size_t mSize = 0;
+    uint32_t mGeneration = 0;
+    Stats mStats = {};
+};
+
+} // namespace utils
+
+#endif // TNT_UTILS_GENERATIONALCACHE_H
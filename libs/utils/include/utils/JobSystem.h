@@ -30,6 +30,7 @@
 
 #include <tsl/robin_map.h>
 
+#include <algorithm>
 #include <atomic>
 #include <functional>
 #include <mutex>
@@ -47,6 +48,8 @@ class JobSystem {
     static constexpr size_t MAX_JOB_COUNT = 1 << 14; // 16384
     static constexpr uint32_t JOB_COUNT_MASK = MAX_JOB_COUNT - 1;
     static constexpr uint32_t WAITER_COUNT_SHIFT = 24;
+    static constexpr uint32_t CANCELLATION_REQUESTED_BIT = 1u << (WAITER_COUNT_SHIFT - 1);
+    static_assert(CANCELLATION_REQUESTED_BIT > JOB_COUNT_MASK);
     static_assert(MAX_JOB_COUNT <= 0x7FFE, "MAX_JOB_COUNT must be <= 0x7FFE");
     using WorkQueue = WorkStealingDequeue<uint16_t, MAX_JOB_COUNT>;
     using Mutex = utils::Mutex;
@@ -95,7 +98,13 @@ public:
     static_assert(sizeof(Job) == 64);
 #endif
 
-    explicit JobSystem(size_t threadCount = 0, size_t adoptableThreadsCount = 1) noexcept;
+    enum class ThreadPlacement : uint8_t {
+        ANY,                // threads can run on any core
+        PERFORMANCE_CORES   // threads only run on the performance cores, if there are any
+    };
+
+    explicit JobSystem(size_t threadCount = 0, size_t adoptableThreadsCount = 1,
+            ThreadPlacement placement = ThreadPlacement::ANY) noexcept;
 
     ~JobSystem();
 
@@ -107,6 +116,38 @@ public:
     // adopt more thread.
     void emancipate();
 
+    struct ThreadStatistics {
+        uint32_t executedJobCount = 0;  // jobs executed by this thread
+        uint32_t stolenJobCount = 0;    // jobs this thread stole from other threads
+        uint32_t maxQueueDepth = 0;     // maximum number of jobs seen in this thread's queue
+        uint64_t busyTime = 0;          // time spent executing jobs, in nanoseconds
+        uint64_t idleTime = 0;          // time spent sleeping, in nanoseconds (pool threads only)
+    };
+
+    // Starts or stops recording the execution of jobs. When enabled, each thread records the
+    // statistics above and the start and end time of its most recent jobs. This must be called
+    // while no jobs are running. When disabled (the default), the cost is a single branch per
+    // executed job.
+    void setTracingEnabled(bool enabled) noexcept;
+
+    bool isTracingEnabled() const noexcept {
+        return mTracer.load(std::memory_order_relaxed) != nullptr;
+    }
+
+    // Returns the statistics of thread `index` (pool threads first, then adopted threads)
+    // since tracing was enabled or resetTracing() was called.
+    ThreadStatistics getThreadStatistics(size_t index) const noexcept;
+
+    // Returns the number of threads getThreadStatistics() accepts.
+    size_t getTracedThreadCount() const noexcept { return mThreadStates.size(); }
+
+    // Clears the recorded statistics and trace events. Must be called while no jobs are running.
+    void resetTracing() noexcept;
+
+    // Writes the recorded jobs in the Chrome trace event format, which can be loaded in
+    // chrome://tracing or Perfetto. Must be called while no jobs are running.
+    void writeTrace(io::ostream& out) const noexcept;
+
 
     // If a parent is not specified when creating a job, that job will automatically take the
     // root job as a parent.
@@ -190,7 +231,9 @@ public:
     Job* createJob(Job* parent, T* data) noexcept {
         Job* job = create(parent, +[](void* storage, JobSystem& js, Job* job) {
             T* const that = static_cast<T*>(reinterpret_cast<void**>(storage)[0]);
-            (that->*method)(js, job);
+            if (UTILS_LIKELY(!isCancellationRequested(job))) {
+                (that->*method)(js, job);
+            }
         });
         if (job) {
             job->storage[0] = data;
@@ -204,7 +247,9 @@ public:
         static_assert(sizeof(data) <= sizeof(Job::storage), "user data too large");
         Job* job = create(parent, [](void* storage, JobSystem& js, Job* job) {
             T* const that = static_cast<T*>(storage);
-            (that->*method)(js, job);
+            if (UTILS_LIKELY(!isCancellationRequested(job))) {
+                (that->*method)(js, job);
+            }
             that->~T();
         });
         if (job) {
@@ -219,7 +264,9 @@ public:
         static_assert(sizeof(T) <= sizeof(Job::storage), "user data too large");
         Job* job = create(parent, [](void* storage, JobSystem& js, Job* job) {
             T* const that = static_cast<T*>(storage);
-            (that->*method)(js, job);
+            if (UTILS_LIKELY(!isCancellationRequested(job))) {
+                (that->*method)(js, job);
+            }
             that->~T();
         });
         if (job) {
@@ -234,7 +281,9 @@ public:
         static_assert(sizeof(functor) <= sizeof(Job::storage), "functor too large");
         Job* job = create(parent, [](void* storage, JobSystem& js, Job* job){
             T* const that = static_cast<T*>(storage);
-            that->operator()(js, job);
+            if (UTILS_LIKELY(!isCancellationRequested(job))) {
+                that->operator()(js, job);
+            }
             that->~T();
         });
         if (job) {
@@ -249,7 +298,9 @@ public:
         static_assert(sizeof(T) <= sizeof(Job::storage), "functor too large");
         Job* job = create(parent, [](void* storage, JobSystem& js, Job* job){
             T* const that = static_cast<T*>(storage);
-            that->operator()(js, job);
+            if (UTILS_LIKELY(!isCancellationRequested(job))) {
+                that->operator()(js, job);
+            }
             that->~T();
         });
         if (job) {
@@ -266,6 +317,25 @@ public:
      */
     void cancel(Job*& job) noexcept;
 
+    /*
+     * Requests the cancellation of a job. If the job hasn't started yet, the functor or method it
+     * was created with is skipped (but still destroyed), and the job completes normally and can be
+     * waited on. Functions passed to create() must check isCancellationRequested() themselves. A job that is already executing
+     * can poll isCancellationRequested() to return early.
+     *
+     * Once run() has been called, the caller must hold a reference to the job, see runAndRetain()
+     * and retain(). Children of the job are not affected.
+     */
+    static void requestCancellation(Job* job) noexcept;
+
+    /*
+     * Returns whether requestCancellation() was called on this job. This can be called from the
+     * job's function.
+     */
+    static bool isCancellationRequested(Job const* job) noexcept {
+        return job->runningJobCount.load(std::memory_order_relaxed) & CANCELLATION_REQUESTED_BIT;
+    }
+
     /*
      * Adds a reference to a Job.
      *
@@ -362,12 +432,23 @@ public:
     static void setThreadPriority(Priority priority) noexcept;
     static void setThreadAffinityById(size_t id) noexcept;
 
+    // Returns a mask of the CPUs that have more capacity than the others (e.g. the big cores of
+    // a big.LITTLE SoC), or 0 if all CPUs are identical or the topology couldn't be determined.
+    // Only the first 64 CPUs are considered.
+    static uint64_t getPerformanceCoreMask() noexcept;
+
     size_t getParallelSplitCount() const noexcept {
         return mParallelSplitCount;
     }
 
     size_t getThreadCount() const { return mThreadCount; }
 
+    // Returns whether some jobs are waiting in a queue. When there are none, idle threads (if
+    // any) have nothing to steal, which is when an adaptive parallel_for splits its range.
+    bool hasQueuedJobs() const noexcept {
+        return mActiveJobs.load(std::memory_order_relaxed) > 0;
+    }
+
     // returns the current ThreadId, which can be used with run(). This method can only be
     // called from a job's function.
     static ThreadId getThreadId(Job const* job) noexcept {
@@ -464,6 +545,10 @@ private:
     Job* const mJobStorageBase;                         // Base for conversion to indices
     uint16_t mThreadCount = 0;                          // total # of threads in the pool
     uint8_t mParallelSplitCount = 0;                    // # of split allowable in parallel_for
+    uint64_t mAffinityMask = 0;                         // CPUs the pool threads run on, 0 = any
+    struct Tracer;
+    std::atomic<Tracer*> mTracer = { nullptr };        // non-null when tracing is enabled
+    std::atomic<uint32_t> mTracerGeneration = { 0 };   // incremented when mTracer changes
     Job* mRootJob = nullptr;
 
     Mutex mThreadMapLock; // this should have very little contention
@@ -511,6 +596,29 @@ JobSystem::Job* createJob(JobSystem& js, JobSystem::Job* parent,
 }
 
 
+template<size_t COUNT, size_t MAX_SPLITS = 12>
+class CountSplitter {
+public:
+    bool split(size_t splits, size_t count) const noexcept {
+        return (splits < MAX_SPLITS && count >= COUNT * 2);
+    }
+};
+
+/*
+ * A splitter for loops whose items have very uneven costs. Instead of splitting the range
+ * upfront, parallel_for processes it `grain` items at a time and hands half of what's left to
+ * the other threads whenever they have run out of work.
+ *
+ *   jobs::parallel_for(js, parent, 0, count, functor, jobs::AdaptiveSplitter(16));
+ */
+class AdaptiveSplitter {
+public:
+    explicit AdaptiveSplitter(uint32_t grain = 1) noexcept : mGrain(grain ? grain : 1) {}
+    uint32_t getGrainSize() const noexcept { return mGrain; }
+private:
+    uint32_t mGrain;
+};
+
 namespace details {
 
 template<typename S, typename F>
@@ -569,6 +677,59 @@ private:
     SplitterType splitter;      // 1
 };
 
+template<typename F>
+struct AdaptiveParallelForJobData {
+    using Functor = F;
+    using JobData = AdaptiveParallelForJobData;
+    using size_type = uint32_t;
+
+    AdaptiveParallelForJobData(size_type start, size_type count, uint8_t,
+            Functor functor, const AdaptiveSplitter& splitter) noexcept
+            : start(start), count(count),
+              functor(std::move(functor)),
+              grain(splitter.getGrainSize()) {
+    }
+
+    void parallelWithJobs(JobSystem& js, JobSystem::Job* parent) noexcept {
+        assert(parent);
+
+        while (count) {
+            // Split only when nothing is waiting to be stolen, this way the range is divided
+            // as threads become idle, rather than upfront: ranges with expensive items end
+            // up split more finely than the cheap ones.
+            if (count >= grain * 2 && !js.hasQueuedJobs()) {
+                const size_type rc = count / 2;
+                JobSystem::Job* r = js.emplaceJob<JobData, &JobData::parallelWithJobs>(parent,
+                        start + count - rc, rc, uint8_t(0), functor, AdaptiveSplitter(grain));
+                if (UTILS_LIKELY(r)) {
+                    js.run(r, JobSystem::getThreadId(parent));
+                    count -= rc;
+                }
+            }
+            const size_type c = std::min(count, grain);
+            functor(start, c);
+            start += c;
+            count -= c;
+        }
+    }
+
+private:
+    size_type start;            // 4
+    size_type count;            // 4
+    Functor functor;            // ?
+    size_type grain;            // 4
+};
+
+template<typename S, typename F>
+struct ParallelForTraits {
+    using JobData = ParallelForJobData<S, F>;
+};
+
+template<typename F>
+struct ParallelForTraits<AdaptiveSplitter, F> {
+    using JobData = AdaptiveParallelForJobData<F>;
+};
+
 } // namespace details
 
 
@@ -576,7 +737,7 @@ private:
 template<typename S, typename F>
 JobSystem::Job* parallel_for(JobSystem& js, JobSystem::Job* parent,
         uint32_t start, uint32_t count, F functor, const S& splitter) noexcept {
-    using JobData = details::ParallelForJobData<S, F>;
+    using JobData = typename details::ParallelForTraits<S, F>::JobData;
     return js.emplaceJob<JobData, &JobData::parallelWithJobs>(parent,
             start, count, 0, std::move(functor), splitter);
 }
@@ -588,7 +749,7 @@ JobSystem::Job* parallel_for(JobSystem& js, JobSystem::Job* parent,
     auto user = [data, f = std::move(functor)](uint32_t s, uint32_t c) {
         f(data + s, c);
     };
-    using JobData = details::ParallelForJobData<S, decltype(user)>;
+    using JobData = typename details::ParallelForTraits<S, decltype(user)>::JobData;
     return js.emplaceJob<JobData, &JobData::parallelWithJobs>(parent,
             0, count, 0, std::move(user), splitter);
 }
@@ -601,14 +762,6 @@ JobSystem::Job* parallel_for(JobSystem& js, JobSystem::Job* parent,
 }
 
 
-template<size_t COUNT, size_t MAX_SPLITS = 12>
-class CountSplitter {
-public:
-    bool split(size_t splits, size_t count) const noexcept {
-        return (splits < MAX_SPLITS && count >= COUNT * 2);
-    }
-};
-
 } // namespace jobs
 } // namespace utils
 
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_UTILS_MPSCQUEUE_H
+#define TNT_UTILS_MPSCQUEUE_H
+
+#include <utils/architecture.h>
+#include <utils/compiler.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace utils {
+
+/*
+ * A bounded lock-free queue for any number of producer threads and a single consumer thread.
+ *
+ * This is D. Vyukov's bounded queue: each cell has a sequence number telling whether it's ready
+ * to be written or read for a given position, producers reserve a position with a CAS. Neither
+ * side blocks, see Futex for sleeping on an empty or full queue.
+ */
+template<typename T>
+class MpscQueue {
+public:
+    // the capacity is rounded up to a power of two
+    explicit MpscQueue(size_t capacity)
+            : mCapacity(roundUp(capacity)),
+              mCells(std::make_unique<Cell[]>(mCapacity)) {
+        for (size_t i = 0; i < mCapacity; i++) {
+            mCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(MpscQueue const&) = delete;
+    MpscQueue& operator=(MpscQueue const&) = delete;
+
+    size_t capacity() const noexcept { return mCapacity; }
+
+    // consumer only; an item being pushed concurrently may or may not be seen
+    bool empty() const noexcept {
+        Cell const& cell = mCells[mHead & (mCapacity - 1)];
+        return cell.sequence.load(std::memory_order_acquire) != mHead + 1;
+    }
+
+    // any thread; returns false if the queue is full
+    bool push(T item) noexcept {
+        size_t position = mTail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &mCells[position & (mCapacity - 1)];
+            size_t const sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t const diff = intptr_t(sequence) - intptr_t(position);
+            if (diff == 0) {
+                if (mTail.compare_exchange_weak(position, position + 1,
+                        std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // this cell still holds the item pushed one lap earlier
+                return false;
+            } else {
+                position = mTail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->item = std::move(item);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only; returns false if the queue is empty or the next item isn't written yet
+    bool pop(T& item) noexcept {
+        size_t const position = mHead;
+        Cell& cell = mCells[position & (mCapacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+        item = std::move(cell.item);
+        cell.sequence.store(position + mCapacity, std::memory_order_release);
+        mHead = position + 1;
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    static size_t roundUp(size_t capacity) noexcept {
+        size_t result = 1;
+        while (result < capacity) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    size_t const mCapacity;
+    std::unique_ptr<Cell[]> mCells;
+
+    // consumer only
+    alignas(CACHELINE_SIZE) size_t mHead = 0;
+
+    // shared by the producers
+    alignas(CACHELINE_SIZE) std::atomic<size_t> mTail = { 0 };
+};
+
+} // namespace utils
+
+#endif // TNT_UTILS_MPSCQUEUE_H
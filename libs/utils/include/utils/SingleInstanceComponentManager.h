@@ -121,6 +121,19 @@ public:
     // This invalidates all pointers components.
     inline Instance addComponent(Entity e);
 
+    // Makes room for `count` more components, so that adding them doesn't reallocate.
+    // This is a no-op if there is already enough room.
+    // This invalidates all pointers components.
+    void reserve(size_t count) {
+        mData.ensureCapacity(mData.size() + count);
+        auto& map = mInstanceMap;
+        size_t const size = map.size() + count;
+        if (UTILS_UNLIKELY(float(size) > float(map.bucket_count()) * map.max_load_factor())) {
+            // reserve() always rehashes the map
+            map.reserve(size);
+        }
+    }
+
     // Removes a component from the given entity.
     // This invalidates all pointers components.
     inline Instance removeComponent(Entity e);
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_UTILS_SPSCQUEUE_H
+#define TNT_UTILS_SPSCQUEUE_H
+
+#include <utils/architecture.h>
+#include <utils/compiler.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include <stddef.h>
+
+namespace utils {
+
+/*
+ * A bounded lock-free queue for exactly one producer thread and one consumer thread.
+ *
+ * Each side caches the other side's index, so that it only touches the other side's cache line
+ * when the queue looks full (or empty). Neither side blocks, see Futex for sleeping on an empty
+ * or full queue.
+ */
+template<typename T>
+class SpscQueue {
+public:
+    // the capacity is rounded up to a power of two
+    explicit SpscQueue(size_t capacity)
+            : mCapacity(roundUp(capacity)),
+              mData(std::make_unique<T[]>(mCapacity)) {
+    }
+
+    SpscQueue(SpscQueue const&) = delete;
+    SpscQueue& operator=(SpscQueue const&) = delete;
+
+    size_t capacity() const noexcept { return mCapacity; }
+
+    // consumer or producer
+    bool empty() const noexcept {
+        return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+    }
+
+    // producer only, returns false if the queue is full
+    bool push(T item) noexcept {
+        size_t const tail = mTail.load(std::memory_order_relaxed);
+        if (UTILS_UNLIKELY(tail - mHeadCache == mCapacity)) {
+            mHeadCache = mHead.load(std::memory_order_acquire);
+            if (tail - mHeadCache == mCapacity) {
+                return false;
+            }
+        }
+        mData[tail & (mCapacity - 1)] = std::move(item);
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only, returns false if the queue is empty
+    bool pop(T& item) noexcept {
+        size_t const head = mHead.load(std::memory_order_relaxed);
+        if (UTILS_UNLIKELY(head == mTailCache)) {
+            mTailCache = mTail.load(std::memory_order_acquire);
+            if (head == mTailCache) {
+                return false;
+            }
+        }
+        item = std::move(mData[head & (mCapacity - 1)]);
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static size_t roundUp(size_t capacity) noexcept {
+        size_t result = 1;
+        while (result < capacity) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    size_t const mCapacity;
+    std::unique_ptr<T[]> mData;
+
+    // written by the consumer
+    alignas(CACHELINE_SIZE) std::atomic<size_t> mHead = { 0 };
+    size_t mTailCache = 0;
+
+    // written by the producer
+    alignas(CACHELINE_SIZE) std::atomic<size_t> mTail = { 0 };
+    size_t mHeadCache = 0;
+};
+
+} // namespace utils
+
+#endif // TNT_UTILS_SPSCQUEUE_H
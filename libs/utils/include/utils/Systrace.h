@@ -37,11 +37,22 @@
 #define FILAMENT_APPLE_SYSTRACE 0
 #endif
 
+// Elsewhere the markers are recorded by utils::TraceRecorder, which costs a check per marker.
+#ifndef FILAMENT_TRACE_RECORDER
+#define FILAMENT_TRACE_RECORDER 1
+#endif
+
 #if defined(__ANDROID__)
 #include <utils/android/Systrace.h>
+#define UTILS_HAS_TRACE_RECORDER 0
 #elif defined(__APPLE__) && FILAMENT_APPLE_SYSTRACE
 #include <utils/darwin/Systrace.h>
+#define UTILS_HAS_TRACE_RECORDER 0
+#elif FILAMENT_TRACE_RECORDER
+#include <utils/generic/Systrace.h>
+#define UTILS_HAS_TRACE_RECORDER 1
 #else
+#define UTILS_HAS_TRACE_RECORDER 0
 
 #define SYSTRACE_ENABLE()
 #define SYSTRACE_DISABLE()
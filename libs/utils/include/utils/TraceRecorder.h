@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_UTILS_TRACERECORDER_H
+#define TNT_UTILS_TRACERECORDER_H
+
+#include <utils/compiler.h>
+
+namespace utils {
+
+/**
+ * TraceRecorder keeps the SYSTRACE markers of every thread in memory, each thread writing into
+ * its own ring buffer without locking, and exports them in the JSON trace event format, which
+ * ui.perfetto.dev and chrome://tracing can open.
+ *
+ * It backs the SYSTRACE macros on the platforms without a system tracer, that is everywhere
+ * except on Android, where the markers go to atrace, and on Apple platforms when
+ * FILAMENT_APPLE_SYSTRACE is set. Only the most recent events of each thread are kept.
+ */
+class UTILS_PUBLIC TraceRecorder {
+public:
+    //! Number of events kept per thread, older events are overwritten.
+    static constexpr unsigned int EVENTS_PER_THREAD = 8192;
+
+    //! Returns whether the SYSTRACE markers can be recorded on this platform.
+    static bool isSupported() noexcept;
+
+    //! Starts recording the markers of all threads, discarding the previously recorded ones.
+    static void start() noexcept;
+
+    //! Stops recording.
+    static void stop() noexcept;
+
+    //! Returns whether the markers are being recorded.
+    static bool isRecording() noexcept;
+
+    /**
+     * Writes the recorded markers into a JSON trace file. This is best called after stop(),
+     * the events recorded while writing may be missing.
+     *
+     * @return false if the file couldn't be written or if recording isn't supported.
+     */
+    static bool write(const char* UTILS_NONNULL path) noexcept;
+
+    //! Sets the name of the calling thread in the traces, see JobSystem::setThreadName().
+    static void setThreadName(const char* UTILS_NONNULL name) noexcept;
+};
+
+} // namespace utils
+
+#endif // TNT_UTILS_TRACERECORDER_H
@@ -49,6 +49,11 @@ public:
 
     ThermalStatus getCurrentThermalStatus() const noexcept;
 
+    // Returns the forecast thermal headroom in `forecastSeconds` seconds (0 for the current
+    // headroom), 1.0 means throttling is about to start. Returns NaN when this isn't supported
+    // or when it's called more than once per second.
+    float getThermalHeadroom(int forecastSeconds) const noexcept;
+
 private:
     AThermalManager* mThermalManager = nullptr;
 };
@@ -134,6 +134,16 @@
 #   define UTILS_HAS_THREADING 1
 #endif
 
+// JobSystem worker threads only need pthreads, unlike the driver thread which on the web also
+// needs the WebGL context, so they're available in any wasm build with pthreads enabled.
+#if UTILS_HAS_THREADING
+#   define UTILS_HAS_JOB_THREADS 1
+#elif defined(__EMSCRIPTEN_PTHREADS__) && !defined(FILAMENT_SINGLE_THREADED)
+#   define UTILS_HAS_JOB_THREADS 1
+#else
+#   define UTILS_HAS_JOB_THREADS 0
+#endif
+
 #if __has_attribute(noinline)
 #define UTILS_NOINLINE __attribute__((noinline))
 #else
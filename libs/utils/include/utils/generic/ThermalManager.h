@@ -17,6 +17,8 @@
 #ifndef TNT_UTILS_GENERIC_THERMALMANAGER_H
 #define TNT_UTILS_GENERIC_THERMALMANAGER_H
 
+#include <limits>
+
 #include <stdint.h>
 
 namespace utils {
@@ -47,6 +49,10 @@ public:
     ThermalStatus getCurrentThermalStatus() const noexcept {
         return ThermalStatus::NONE;
     }
+
+    float getThermalHeadroom(int) const noexcept {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
 };
 
 } // namespace utils
@@ -22,6 +22,13 @@
 
 #include <algorithm>
 
+#if defined(__linux__)
+#   include <sys/mman.h>
+#elif defined(WIN32)
+#   include <windows.h>
+#   include <utils/unwindows.h>
+#endif
+
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
@@ -223,4 +230,82 @@ void TrackingPolicy::Debug::onRewind(void* addr) noexcept {
     memset(addr, 0x55, uintptr_t(mBase) + mSize - uintptr_t(addr));
 }
 
+// ------------------------------------------------------------------------------------------------
+// HugePageArea
+// ------------------------------------------------------------------------------------------------
+
+AreaPolicy::HugePageArea::HugePageArea(size_t size, bool hugePages) {
+    if (!size) {
+        return;
+    }
+#if defined(__linux__)
+    if (hugePages) {
+        constexpr size_t HUGE_PAGE_SIZE = 2u * 1024u * 1024u;
+        size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        // this only succeeds if huge pages were reserved by the administrator
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            mMapping = p;
+            mMappingSize = size;
+            mType = Type::HUGE_PAGES;
+        } else {
+            // transparent huge pages need a 2 MiB aligned range, so over-allocate and align
+            p = mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p != MAP_FAILED) {
+                mMapping = p;
+                mMappingSize = size + HUGE_PAGE_SIZE;
+                void* const aligned = (void*)((uintptr_t(p) + HUGE_PAGE_SIZE - 1) &
+                        ~uintptr_t(HUGE_PAGE_SIZE - 1));
+                if (madvise(aligned, size, MADV_HUGEPAGE) == 0) {
+                    mType = Type::TRANSPARENT;
+                    mBegin = aligned;
+                    mEnd = pointermath::add(aligned, size);
+                    return;
+                }
+                munmap(p, size + HUGE_PAGE_SIZE);
+                mMapping = nullptr;
+                mMappingSize = 0;
+            }
+        }
+    }
+#elif defined(WIN32)
+    if (hugePages) {
+        // this needs the SeLockMemoryPrivilege, which applications must acquire themselves
+        size_t const largePageSize = GetLargePageMinimum();
+        if (largePageSize) {
+            size = (size + largePageSize - 1) & ~(largePageSize - 1);
+            void* const p = VirtualAlloc(nullptr, size,
+                    MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (p) {
+                mMapping = p;
+                mMappingSize = size;
+                mType = Type::HUGE_PAGES;
+            }
+        }
+    }
+#else
+    (void)hugePages;
+#endif
+    if (mType == Type::HEAP) {
+        mMapping = malloc(size);
+        mMappingSize = size;
+    }
+    mBegin = mMapping;
+    mEnd = pointermath::add(mBegin, size);
+}
+
+AreaPolicy::HugePageArea::~HugePageArea() noexcept {
+    if (mType == Type::HEAP) {
+        free(mMapping);
+        return;
+    }
+#if defined(__linux__)
+    munmap(mMapping, mMappingSize);
+#elif defined(WIN32)
+    VirtualFree(mMapping, 0, MEM_RELEASE);
+#endif
+}
+
 } // namespace utils
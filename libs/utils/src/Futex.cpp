@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <utils/Futex.h>
+
+#if defined(__linux__)
+#   include "linux/futex.h"
+#endif
+
+namespace utils {
+
+// The waiter count is incremented before the value is checked, and notify() reads it after the
+// value has changed. Both being sequentially consistent, either notify() sees the waiter, or the
+// waiter sees the new value.
+
+#if defined(__linux__)
+
+void Futex::wait(uint32_t expected) noexcept {
+    mWaiters.fetch_add(1);
+    linuxutil::futex_wait_ex(&mValue, false, int(expected), false, nullptr);
+    mWaiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void Futex::wake(int32_t count) noexcept {
+    linuxutil::futex_wake_ex(&mValue, false, count);
+}
+
+#else
+
+void Futex::wait(uint32_t expected) noexcept {
+    mWaiters.fetch_add(1);
+    std::unique_lock<std::mutex> lock(mLock);
+    while (mValue.load() == expected) {
+        mCondition.wait(lock);
+    }
+    lock.unlock();
+    mWaiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void Futex::wake(int32_t count) noexcept {
+    std::lock_guard<std::mutex> const lock(mLock);
+    if (count == 1) {
+        mCondition.notify_one();
+    } else {
+        mCondition.notify_all();
+    }
+}
+
+#endif
+
+} // namespace utils
@@ -25,12 +25,14 @@
 
 #include <utils/JobSystem.h>
 
+#include <utils/algorithm.h>
 #include <utils/compiler.h>
 #include <utils/debug.h>
 #include <utils/Log.h>
 #include <utils/ostream.h>
 #include <utils/Panic.h>
 #include <utils/Systrace.h>
+#include <utils/TraceRecorder.h>
 
 #include <algorithm>
 #include <atomic>
@@ -39,12 +41,15 @@
 #include <cmath>
 #include <condition_variable>
 #include <iterator>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <random>
 #include <thread>
 
 #include <assert.h>
 #include <math.h>
+#include <stdio.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -93,6 +98,7 @@
 namespace utils {
 
 void JobSystem::setThreadName(const char* name) noexcept {
+    TraceRecorder::setThreadName(name);
 #if defined(__linux__)
     pthread_setname_np(pthread_self(), name);
 #elif defined(__APPLE__)
@@ -146,17 +152,79 @@ void JobSystem::setThreadAffinityById(size_t id) noexcept {
 #endif
 }
 
-JobSystem::JobSystem(const size_t userThreadCount, const size_t adoptableThreadsCount) noexcept
+#if defined(__linux__)
+static uint32_t readCpuValue(uint32_t cpu, const char* name) noexcept {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/%s", cpu, name);
+    uint32_t value = 0;
+    FILE* const file = fopen(path, "r");
+    if (file) {
+        if (fscanf(file, "%u", &value) != 1) {
+            value = 0;
+        }
+        fclose(file);
+    }
+    return value;
+}
+
+static void setThreadAffinityByMask(uint64_t mask) noexcept {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i = 0; i < 64; i++) {
+        if (mask & (uint64_t(1) << i)) {
+            CPU_SET(i, &set);
+        }
+    }
+    sched_setaffinity(gettid(), sizeof(set), &set);
+}
+#endif
+
+uint64_t JobSystem::getPerformanceCoreMask() noexcept {
+    uint64_t mask = 0;
+#if defined(__linux__)
+    uint32_t const count = std::min(64u, std::thread::hardware_concurrency());
+
+    // cpu_capacity is the scheduler's own view of the topology, but it's not exposed by all
+    // kernels, in which case the maximum frequencies are used.
+    uint32_t capacities[64] = {};
+    for (const char* name : { "cpu_capacity", "cpufreq/cpuinfo_max_freq" }) {
+        bool valid = count > 0;
+        for (uint32_t i = 0; i < count && valid; i++) {
+            capacities[i] = readCpuValue(i, name);
+            valid = capacities[i] != 0;
+        }
+        if (valid) {
+            uint32_t const minCapacity = *std::min_element(capacities, capacities + count);
+            for (uint32_t i = 0; i < count; i++) {
+                if (capacities[i] > minCapacity) {
+                    mask |= uint64_t(1) << i;
+                }
+            }
+            break;
+        }
+    }
+#endif
+    return mask;
+}
+
+JobSystem::JobSystem(const size_t userThreadCount, const size_t adoptableThreadsCount,
+        ThreadPlacement placement) noexcept
     : mJobPool("JobSystem Job pool", MAX_JOB_COUNT * sizeof(Job)),
       mJobStorageBase(static_cast<Job *>(mJobPool.getAllocator().getCurrent()))
 {
     SYSTRACE_ENABLE();
 
+    if (placement == ThreadPlacement::PERFORMANCE_CORES) {
+        mAffinityMask = getPerformanceCoreMask();
+    }
+
     unsigned int threadPoolCount = userThreadCount;
     if (threadPoolCount == 0) {
         // default value, system dependant
         unsigned int hwThreads = std::thread::hardware_concurrency();
-        if (UTILS_HAS_HYPER_THREADING) {
+        if (mAffinityMask) {
+            hwThreads = popcount(mAffinityMask);
+        } else if (UTILS_HAS_HYPER_THREADING) {
             // For now we avoid using HT, this simplifies profiling.
             // TODO: figure-out what to do with Hyper-threading
             // since we assumed HT, always round-up to an even number of cores (to play it safe)
@@ -168,7 +236,7 @@ JobSystem::JobSystem(const size_t userThreadCount, const size_t adoptableThreads
     // make sure we have at least one thread in the thread pool
     threadPoolCount = std::max(1u, threadPoolCount);
     // and also limit the pool to 32 threads
-    threadPoolCount = std::min(UTILS_HAS_THREADING ? 32u : 0u, threadPoolCount);
+    threadPoolCount = std::min(UTILS_HAS_JOB_THREADS ? 32u : 0u, threadPoolCount);
 
     mThreadStates = aligned_vector<ThreadState>(threadPoolCount + adoptableThreadsCount);
     mThreadCount = uint16_t(threadPoolCount);
@@ -203,8 +271,115 @@ JobSystem::~JobSystem() {
             state.thread.join();
         }
     }
+
+    delete mTracer.load(std::memory_order_relaxed);
 }
 
+// -------------------------------------------------------------------------------------------------
+
+struct JobSystem::Tracer {
+    // number of jobs recorded per thread, the oldest are overwritten
+    static constexpr size_t EVENT_COUNT = 2048;
+
+    struct Event {
+        uint64_t begin;
+        uint64_t end;
+        bool stolen;
+    };
+
+    struct alignas(CACHELINE_SIZE) Thread {
+        ThreadStatistics statistics;
+        uint32_t eventCount = 0;
+        Event events[EVENT_COUNT];
+    };
+
+    explicit Tracer(size_t count) : threads(new Thread[count]), count(count) {
+    }
+
+    uint64_t now() const noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    // nanoseconds elapsed since `begin`, or since the last reset() if it came after `begin`
+    uint64_t elapsedSince(std::chrono::steady_clock::time_point begin) const noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - std::max(begin, epoch)).count();
+    }
+
+    void reset() noexcept {
+        for (size_t i = 0; i < count; i++) {
+            threads[i].statistics = {};
+            threads[i].eventCount = 0;
+        }
+        epoch = std::chrono::steady_clock::now();
+    }
+
+    // each thread only writes its own entry, so this doesn't need to be synchronized
+    void record(size_t index, uint64_t begin, bool stolen, uint32_t queueDepth) noexcept {
+        uint64_t const end = now();
+        Thread& thread = threads[index];
+        thread.events[thread.eventCount++ % EVENT_COUNT] = { begin, end, stolen };
+        thread.statistics.executedJobCount++;
+        thread.statistics.stolenJobCount += stolen ? 1 : 0;
+        thread.statistics.maxQueueDepth = std::max(thread.statistics.maxQueueDepth, queueDepth);
+        thread.statistics.busyTime += end - begin;
+    }
+
+    std::unique_ptr<Thread[]> threads;
+    size_t const count;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+void JobSystem::setTracingEnabled(bool enabled) noexcept {
+    Tracer* const tracer = mTracer.load(std::memory_order_relaxed);
+    if (enabled && !tracer) {
+        mTracer.store(new(std::nothrow) Tracer(mThreadStates.size()), std::memory_order_release);
+        mTracerGeneration.fetch_add(1, std::memory_order_release);
+    } else if (!enabled && tracer) {
+        mTracer.store(nullptr, std::memory_order_relaxed);
+        mTracerGeneration.fetch_add(1, std::memory_order_release);
+        delete tracer;
+    }
+}
+
+JobSystem::ThreadStatistics JobSystem::getThreadStatistics(size_t index) const noexcept {
+    Tracer const* const tracer = mTracer.load(std::memory_order_acquire);
+    if (!tracer || index >= tracer->count) {
+        return {};
+    }
+    return tracer->threads[index].statistics;
+}
+
+void JobSystem::resetTracing() noexcept {
+    if (Tracer* const tracer = mTracer.load(std::memory_order_acquire)) {
+        tracer->reset();
+    }
+}
+
+void JobSystem::writeTrace(io::ostream& out) const noexcept {
+    Tracer const* const tracer = mTracer.load(std::memory_order_acquire);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (size_t i = 0, n = tracer ? tracer->count : 0; i < n; i++) {
+        Tracer::Thread const& thread = tracer->threads[i];
+        uint32_t const count = std::min(thread.eventCount, uint32_t(Tracer::EVENT_COUNT));
+        for (uint32_t j = thread.eventCount - count; j != thread.eventCount; j++) {
+            Tracer::Event const& event = thread.events[j % Tracer::EVENT_COUNT];
+            // timestamps are in microseconds
+            out << (first ? "" : ",")
+                << "{\"name\":\"" << (event.stolen ? "stolen job" : "job")
+                << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << i
+                << ",\"ts\":" << double(event.begin) * 1e-3
+                << ",\"dur\":" << double(event.end - event.begin) * 1e-3 << "}";
+            first = false;
+        }
+    }
+    out << "]}" << io::endl;
+}
+
+// -------------------------------------------------------------------------------------------------
+
 inline void JobSystem::incRef(Job const* job) noexcept {
     // no action is taken when incrementing the reference counter, therefore we can safely use
     // memory_order_relaxed.
@@ -389,7 +564,11 @@ JobSystem::Job* JobSystem::steal(JobSystem::ThreadState& state) noexcept {
 bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
     HEAVY_SYSTRACE_CALL();
 
+    Tracer* const tracer = mTracer.load(std::memory_order_acquire);
+    uint32_t const queueDepth = UTILS_UNLIKELY(tracer) ? uint32_t(state.workQueue.getCount()) : 0;
+
     Job* job = pop(state.workQueue);
+    bool const stolen = !job;
 
     // It is beneficial for some benchmarks to poll on steal() for a bit, because going back to
     // sleep and waking up is pretty expensive. However, it is unclear it helps in practice with
@@ -405,7 +584,11 @@ bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
         if (UTILS_LIKELY(job->function)) {
             HEAVY_SYSTRACE_NAME("job->function");
             job->id = std::distance(mThreadStates.data(), &state);
+            uint64_t const begin = UTILS_UNLIKELY(tracer) ? tracer->now() : 0;
             job->function(job->storage, *this, job);
+            if (UTILS_UNLIKELY(tracer)) {
+                tracer->record(job->id, begin, stolen, queueDepth);
+            }
             job->id = invalidThreadId;
         }
         finish(job);
@@ -416,6 +599,11 @@ bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
 void JobSystem::loop(ThreadState* state) noexcept {
     setThreadName("JobSystem::loop");
     setThreadPriority(Priority::DISPLAY);
+#if defined(__linux__)
+    if (mAffinityMask) {
+        setThreadAffinityByMask(mAffinityMask);
+    }
+#endif
 
     // record our work queue
     std::unique_lock<Mutex> lock(mThreadMapLock);
@@ -427,10 +615,25 @@ void JobSystem::loop(ThreadState* state) noexcept {
     // run our main loop...
     do {
         if (!execute(*state)) {
+            uint32_t const generation = mTracerGeneration.load(std::memory_order_acquire);
+            bool const tracing = mTracer.load(std::memory_order_acquire) != nullptr;
+            std::chrono::steady_clock::time_point begin;
+            if (UTILS_UNLIKELY(tracing)) {
+                begin = std::chrono::steady_clock::now();
+            }
             std::unique_lock<Mutex> lock(mWaiterLock);
             while (!exitRequested() && !hasActiveJobs()) {
                 wait(lock);
             }
+            // Tracing could have been disabled, or disabled and enabled again with a new tracer
+            // at the same address, while we were sleeping. A reset only moves the epoch.
+            if (UTILS_UNLIKELY(tracing) &&
+                    generation == mTracerGeneration.load(std::memory_order_acquire)) {
+                if (Tracer* const tracer = mTracer.load(std::memory_order_acquire)) {
+                    size_t const index = std::distance(mThreadStates.data(), state);
+                    tracer->threads[index].statistics.idleTime += tracer->elapsedSince(begin);
+                }
+            }
         }
     } while (!exitRequested());
 }
@@ -505,6 +708,10 @@ void JobSystem::cancel(Job*& job) noexcept {
     job = nullptr;
 }
 
+void JobSystem::requestCancellation(Job* job) noexcept {
+    job->runningJobCount.fetch_or(CANCELLATION_REQUESTED_BIT, std::memory_order_relaxed);
+}
+
 JobSystem::Job* JobSystem::retain(JobSystem::Job* job) noexcept {
     JobSystem::Job* retained = job;
     incRef(retained);
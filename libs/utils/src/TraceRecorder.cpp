@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <utils/TraceRecorder.h>
+
+#include <utils/Systrace.h>
+
+#if UTILS_HAS_TRACE_RECORDER
+
+#include <utils/Mutex.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#endif
+
+namespace utils {
+
+#if UTILS_HAS_TRACE_RECORDER
+
+namespace {
+
+using Event = details::Systrace::Event;
+
+struct Record {
+    int64_t timestamp;      // in nanoseconds
+    int64_t value;          // counter value, async cookie or frame id
+    Event event;
+    char name[47];          // copied, the markers can be built on the stack
+};
+
+static_assert(sizeof(Record) == 64);
+
+constexpr size_t THREAD_NAME_SIZE = 32;
+
+struct ThreadBuffer {
+    explicit ThreadBuffer(uint32_t tid) noexcept : tid(tid) {}
+    // number of records written so far, only the thread owning this buffer writes it
+    std::atomic<uint64_t> head{ 0 };
+    uint32_t const tid;
+    char name[THREAD_NAME_SIZE] = {};   // protected by Registry::lock
+    Record records[TraceRecorder::EVENTS_PER_THREAD];
+};
+
+struct Registry {
+    Mutex lock;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    uint32_t enabledTags = SYSTRACE_TAG_ALWAYS;
+    bool recording = false;
+    int64_t startTime = 0;
+};
+
+// never destroyed, threads can still be tracing while the process exits
+Registry& getRegistry() noexcept {
+    static Registry* const registry = new Registry();
+    return *registry;
+}
+
+thread_local ThreadBuffer* tBuffer = nullptr;
+thread_local char tThreadName[THREAD_NAME_SIZE] = {};
+
+int64_t now() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// the buffer is only allocated the first time the thread records an event
+ThreadBuffer* getThreadBuffer() noexcept {
+    if (UTILS_UNLIKELY(!tBuffer)) {
+        Registry& registry = getRegistry();
+        std::lock_guard const lock(registry.lock);
+        registry.buffers.push_back(
+                std::make_unique<ThreadBuffer>(uint32_t(registry.buffers.size() + 1)));
+        tBuffer = registry.buffers.back().get();
+        memcpy(tBuffer->name, tThreadName, THREAD_NAME_SIZE);
+    }
+    return tBuffer;
+}
+
+void writeString(FILE* file, const char* s) noexcept {
+    fputc('"', file);
+    for (; *s; s++) {
+        char const c = *s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+            fputc(c, file);
+        } else if (uint8_t(c) >= 0x20) {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+} // anonymous namespace
+
+std::atomic<uint32_t> details::Systrace::sActiveTags{ 0 };
+
+void details::Systrace::enable(uint32_t tags) noexcept {
+    Registry& registry = getRegistry();
+    std::lock_guard const lock(registry.lock);
+    registry.enabledTags |= tags;
+    if (registry.recording) {
+        sActiveTags.store(registry.enabledTags, std::memory_order_relaxed);
+    }
+}
+
+void details::Systrace::disable(uint32_t tags) noexcept {
+    Registry& registry = getRegistry();
+    std::lock_guard const lock(registry.lock);
+    registry.enabledTags &= ~tags;
+    if (registry.recording) {
+        sActiveTags.store(registry.enabledTags, std::memory_order_relaxed);
+    }
+}
+
+void details::Systrace::record(Event event, const char* name, int64_t value) noexcept {
+    ThreadBuffer* const buffer = getThreadBuffer();
+    uint64_t const head = buffer->head.load(std::memory_order_relaxed);
+    Record& record = buffer->records[head % TraceRecorder::EVENTS_PER_THREAD];
+    record.timestamp = now();
+    record.value = value;
+    record.event = event;
+    strncpy(record.name, name ? name : "", sizeof(record.name) - 1);
+    record.name[sizeof(record.name) - 1] = 0;
+    // publishes the record to write()
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+bool TraceRecorder::isSupported() noexcept {
+    return true;
+}
+
+void TraceRecorder::start() noexcept {
+    Registry& registry = getRegistry();
+    std::lock_guard const lock(registry.lock);
+    // the previous records are filtered out by write(), the buffers are never cleared since
+    // their threads can be writing
+    registry.startTime = now();
+    registry.recording = true;
+    details::Systrace::sActiveTags.store(registry.enabledTags, std::memory_order_relaxed);
+}
+
+void TraceRecorder::stop() noexcept {
+    Registry& registry = getRegistry();
+    std::lock_guard const lock(registry.lock);
+    registry.recording = false;
+    details::Systrace::sActiveTags.store(0, std::memory_order_relaxed);
+}
+
+bool TraceRecorder::isRecording() noexcept {
+    Registry& registry = getRegistry();
+    std::lock_guard const lock(registry.lock);
+    return registry.recording;
+}
+
+bool TraceRecorder::write(const char* path) noexcept {
+    struct Thread {
+        ThreadBuffer* buffer;
+        char name[THREAD_NAME_SIZE];
+    };
+
+    Registry& registry = getRegistry();
+    std::vector<Thread> threads;
+    int64_t startTime;
+    {
+        // the buffers are never freed, so they can be read without holding the lock
+        std::lock_guard const lock(registry.lock);
+        startTime = registry.startTime;
+        threads.reserve(registry.buffers.size());
+        for (auto const& buffer : registry.buffers) {
+            Thread& thread = threads.emplace_back();
+            thread.buffer = buffer.get();
+            memcpy(thread.name, buffer->name, THREAD_NAME_SIZE);
+        }
+    }
+
+    FILE* const file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+    constexpr size_t N = EVENTS_PER_THREAD;
+    fputs("{\"traceEvents\":[\n", file);
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"filament\"}}",
+            file);
+
+    std::vector<Record> records;
+    for (Thread const& thread : threads) {
+        ThreadBuffer const& buffer = *thread.buffer;
+        uint32_t const tid = buffer.tid;
+        if (thread.name[0]) {
+            fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                    "\"args\":{\"name\":", tid);
+            writeString(file, thread.name);
+            fputs("}}", file);
+        }
+
+        // copy the records without stopping the thread, then discard the ones it overwrote
+        // meanwhile, including the one it may have been writing
+        uint64_t const end = buffer.head.load(std::memory_order_acquire);
+        uint64_t const begin = end > N ? end - N : 0;
+        records.resize(end - begin);
+        for (uint64_t i = begin; i < end; i++) {
+            records[i - begin] = buffer.records[i % N];
+        }
+        uint64_t const head = buffer.head.load(std::memory_order_acquire);
+        uint64_t const first = std::max(begin, head >= N ? head - N + 1 : 0);
+
+        // ends whose beginning was overwritten or predates start() are dropped
+        uint32_t depth = 0;
+        for (uint64_t i = first; i < end; i++) {
+            Record const& record = records[i - begin];
+            if (record.timestamp < startTime) {
+                continue;
+            }
+            double const ts = double(record.timestamp - startTime) * 1e-3;
+            switch (record.event) {
+                case Event::BEGIN:
+                    depth++;
+                    fputs(",\n{\"name\":", file);
+                    writeString(file, record.name);
+                    fprintf(file, ",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", ts, tid);
+                    break;
+                case Event::END:
+                    if (depth) {
+                        depth--;
+                        fprintf(file, ",\n{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                                ts, tid);
+                    }
+                    break;
+                case Event::ASYNC_BEGIN:
+                case Event::ASYNC_END:
+                    fputs(",\n{\"name\":", file);
+                    writeString(file, record.name);
+                    fprintf(file, ",\"cat\":\"async\",\"ph\":\"%c\",\"id\":%lld,\"ts\":%.3f,"
+                            "\"pid\":1,\"tid\":%u}", record.event == Event::ASYNC_BEGIN ? 'b' : 'e',
+                            (long long)record.value, ts, tid);
+                    break;
+                case Event::COUNTER:
+                    fputs(",\n{\"name\":", file);
+                    writeString(file, record.name);
+                    fprintf(file, ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,"
+                            "\"args\":{\"value\":%lld}}", ts, tid, (long long)record.value);
+                    break;
+                case Event::FRAME:
+                    fprintf(file, ",\n{\"name\":\"frame %lld\",\"ph\":\"i\",\"s\":\"g\","
+                            "\"ts\":%.3f,\"pid\":1,\"tid\":%u}", (long long)record.value, ts, tid);
+                    break;
+            }
+        }
+    }
+
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+    bool const success = !ferror(file);
+    return fclose(file) == 0 && success;
+}
+
+void TraceRecorder::setThreadName(const char* name) noexcept {
+    strncpy(tThreadName, name, THREAD_NAME_SIZE - 1);
+    if (tBuffer) {
+        std::lock_guard const lock(getRegistry().lock);
+        memcpy(tBuffer->name, tThreadName, THREAD_NAME_SIZE);
+    }
+}
+
+#else
+
+bool TraceRecorder::isSupported() noexcept {
+    return false;
+}
+
+void TraceRecorder::start() noexcept {
+}
+
+void TraceRecorder::stop() noexcept {
+}
+
+bool TraceRecorder::isRecording() noexcept {
+    return false;
+}
+
+bool TraceRecorder::write(const char*) noexcept {
+    return false;
+}
+
+void TraceRecorder::setThreadName(const char*) noexcept {
+}
+
+#endif // UTILS_HAS_TRACE_RECORDER
+
+} // namespace utils
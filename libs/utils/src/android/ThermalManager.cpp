@@ -18,6 +18,7 @@
 
 #include <android/thermal.h>
 
+#include <limits>
 #include <utility>
 
 namespace utils {
@@ -52,4 +53,12 @@ ThermalManager::ThermalStatus ThermalManager::getCurrentThermalStatus() const no
     }
 }
 
+float ThermalManager::getThermalHeadroom(int forecastSeconds) const noexcept {
+    if (__builtin_available(android 30, *)) {
+        return AThermal_getThermalHeadroom(mThermalManager, forecastSeconds);
+    } else {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+}
+
 } // namespace utils
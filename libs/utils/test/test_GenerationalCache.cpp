@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <utils/GenerationalCache.h>
+
+#include <unordered_map>
+
+using namespace utils;
+
+namespace {
+// a poor hash, to exercise collisions and displacements
+struct BadHash {
+    size_t operator()(int key) const noexcept { return key % 7; }
+};
+} // anonymous namespace
+
+TEST(GenerationalCacheTest, FindInsert) {
+    GenerationalCache<int, int> cache;
+    EXPECT_TRUE(cache.empty());
+    EXPECT_EQ(cache.find(1), nullptr);
+
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+    EXPECT_EQ(cache.size(), 2);
+    ASSERT_NE(cache.find(1), nullptr);
+    EXPECT_EQ(*cache.find(1), 10);
+    EXPECT_EQ(*cache.find(2), 20);
+    EXPECT_EQ(cache.find(3), nullptr);
+
+    auto const stats = cache.getAndResetStats();
+    EXPECT_EQ(stats.hits, 3);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(cache.getAndResetStats().hits, 0);
+}
+
+TEST(GenerationalCacheTest, Growth) {
+    GenerationalCache<int, int, BadHash> cache;
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(cache.insert(i, i * 2), i * 2);
+    }
+    EXPECT_EQ(cache.size(), 1000);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_NE(cache.find(i), nullptr);
+        EXPECT_EQ(*cache.find(i), i * 2);
+    }
+    EXPECT_EQ(cache.find(1000), nullptr);
+}
+
+TEST(GenerationalCacheTest, Evict) {
+    GenerationalCache<int, int, BadHash> cache;
+    for (int i = 0; i < 100; i++) {
+        cache.insert(i, i);
+    }
+
+    // use the even entries during the next 3 generations
+    for (int g = 0; g < 3; g++) {
+        cache.nextGeneration();
+        for (int i = 0; i < 100; i += 2) {
+            cache.find(i);
+        }
+    }
+
+    // the odd entries are 3 generations old, only evict those that aren't multiples of 3
+    std::unordered_map<int, int> evicted;
+    size_t const count = cache.evict(2, [&](int key, int value) {
+        if (key % 3 == 0) {
+            return false;
+        }
+        evicted[key] = value;
+        return true;
+    });
+    EXPECT_EQ(count, evicted.size());
+    EXPECT_EQ(cache.size(), 100 - count);
+    EXPECT_EQ(cache.getAndResetStats().evictions, count);
+
+    for (int i = 0; i < 100; i++) {
+        bool const expectEvicted = (i & 1) && (i % 3);
+        EXPECT_EQ(evicted.count(i) == 1, expectEvicted) << i;
+        EXPECT_EQ(cache.find(i) == nullptr, expectEvicted) << i;
+    }
+
+    size_t visited = 0;
+    cache.forEach([&](int key, int value) {
+        EXPECT_EQ(key, value);
+        visited++;
+    });
+    EXPECT_EQ(visited, cache.size());
+
+    cache.clear();
+    EXPECT_TRUE(cache.empty());
+    EXPECT_EQ(cache.find(0), nullptr);
+}
@@ -23,7 +23,9 @@
 #include <math/mat3.h>
 
 #include <array>
+#include <chrono>
 #include <thread>
+#include <vector>
 #include <utils/Allocator.h>
 
 using namespace utils;
@@ -219,6 +221,20 @@ TEST(JobSystem, JobSystemParallelChildren) {
 }
 
 
+TEST(JobSystem, JobSystemCancellation) {
+    JobSystem js;
+    js.adopt();
+
+    bool executed = false;
+    JobSystem::Job* job = jobs::createJob(js, nullptr, [&executed] { executed = true; });
+    JobSystem::requestCancellation(job);
+    EXPECT_TRUE(JobSystem::isCancellationRequested(job));
+    js.runAndWait(job);
+    EXPECT_FALSE(executed);
+
+    js.emancipate();
+}
+
 TEST(JobSystem, JobSystemSequentialChildren) {
     JobSystem js;
     js.adopt();
@@ -284,6 +300,101 @@ TEST(JobSystem, JobSystemParallelFor) {
     js.emancipate();
 }
 
+TEST(JobSystem, JobSystemParallelForAdaptive) {
+    JobSystem js;
+    js.adopt();
+
+    // items are much more expensive at the end of the range
+    std::vector<uint32_t> values(4096);
+    JobSystem::Job* job = jobs::parallel_for(js, nullptr, 0, uint32_t(values.size()),
+            [&values](uint32_t start, uint32_t count) {
+                for (uint32_t i = start; i < start + count; i++) {
+                    uint32_t v = 0;
+                    for (uint32_t j = 0; j < i / 16; j++) {
+                        v += j;
+                    }
+                    values[i] = v + 1;
+                }
+            }, jobs::AdaptiveSplitter(8));
+    js.runAndWait(job);
+
+    for (uint32_t i = 0; i < values.size(); i++) {
+        uint32_t const n = i / 16;
+        EXPECT_EQ(values[i], (n ? n * (n - 1) / 2 : 0) + 1);
+    }
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemPerformanceCores) {
+    uint64_t const mask = JobSystem::getPerformanceCoreMask();
+    uint32_t const cpuCount = std::thread::hardware_concurrency();
+    if (cpuCount < 64) {
+        EXPECT_EQ(mask >> cpuCount, 0u);
+    }
+
+    // the placement is only a hint, jobs must run regardless of the topology
+    JobSystem js(0, 1, JobSystem::ThreadPlacement::PERFORMANCE_CORES);
+    js.adopt();
+
+    std::atomic<int> result = 0;
+    JobSystem::Job* root = js.createJob();
+    for (int i = 0; i < 64; i++) {
+        js.run(jobs::createJob(js, root, [&result]() { result++; }));
+    }
+    js.runAndWait(root);
+    EXPECT_EQ(result, 64);
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemTracing) {
+    JobSystem js;
+    js.adopt();
+    js.setTracingEnabled(true);
+    EXPECT_TRUE(js.isTracingEnabled());
+
+    JobSystem::Job* root = js.createJob();
+    for (int i = 0; i < 16; i++) {
+        js.run(jobs::createJob(js, root, []() {}));
+    }
+    js.runAndWait(root);
+
+    uint32_t executed = 0;
+    for (size_t i = 0; i < js.getTracedThreadCount(); i++) {
+        JobSystem::ThreadStatistics const stats = js.getThreadStatistics(i);
+        EXPECT_LE(stats.stolenJobCount, stats.executedJobCount);
+        executed += stats.executedJobCount;
+    }
+    EXPECT_EQ(executed, 16);
+
+    // Let the pool threads fall asleep before the reset, the idle time they report when they
+    // wake up must only account for the time since the reset.
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto const reset = std::chrono::steady_clock::now();
+    js.resetTracing();
+    EXPECT_EQ(js.getThreadStatistics(0).executedJobCount, 0);
+
+    root = js.createJob();
+    for (int i = 0; i < 16; i++) {
+        js.run(jobs::createJob(js, root, []() {}));
+    }
+    js.runAndWait(root);
+
+    for (size_t i = 0; i < js.getTracedThreadCount(); i++) {
+        // threads can still be waking up, so the elapsed time is measured after the idle time
+        uint64_t const idleTime = js.getThreadStatistics(i).idleTime;
+        uint64_t const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - reset).count();
+        EXPECT_LE(idleTime, elapsed);
+    }
+
+    js.setTracingEnabled(false);
+    EXPECT_FALSE(js.isTracingEnabled());
+
+    js.emancipate();
+}
+
 TEST(JobSystem, JobSystemDelegates) {
     JobSystem js;
     js.adopt();
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <utils/Futex.h>
+#include <utils/MpscQueue.h>
+#include <utils/SpscQueue.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+using namespace utils;
+
+TEST(SpscQueueTest, Simple) {
+    SpscQueue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4);
+    EXPECT_TRUE(queue.empty());
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.push(i));
+    }
+    EXPECT_FALSE(queue.push(4));
+
+    int item;
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.pop(item));
+        EXPECT_EQ(item, i);
+    }
+    EXPECT_FALSE(queue.pop(item));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, Threads) {
+    constexpr uint32_t COUNT = 100000;
+    SpscQueue<uint32_t> queue(64);
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < COUNT; i++) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    while (expected < COUNT) {
+        uint32_t item;
+        if (queue.pop(item)) {
+            ASSERT_EQ(item, expected);
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueueTest, Simple) {
+    MpscQueue<int> queue(4);
+    EXPECT_TRUE(queue.empty());
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.push(i));
+    }
+    EXPECT_FALSE(queue.push(4));
+
+    int item;
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.pop(item));
+        EXPECT_EQ(item, i);
+    }
+    EXPECT_FALSE(queue.pop(item));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueueTest, Threads) {
+    constexpr uint32_t THREADS = 4;
+    constexpr uint32_t COUNT = 25000;
+    MpscQueue<uint32_t> queue(64);
+
+    std::vector<std::thread> producers;
+    for (uint32_t t = 0; t < THREADS; t++) {
+        producers.emplace_back([&queue, t]() {
+            for (uint32_t i = 0; i < COUNT; i++) {
+                while (!queue.push(t * COUNT + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // items from a given producer must come out in order
+    std::vector<uint32_t> next(THREADS, 0);
+    for (uint32_t received = 0; received < THREADS * COUNT;) {
+        uint32_t item;
+        if (queue.pop(item)) {
+            uint32_t const t = item / COUNT;
+            ASSERT_EQ(item % COUNT, next[t]);
+            next[t]++;
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(FutexTest, WaitNotify) {
+    constexpr uint32_t COUNT = 1000;
+    Futex events;
+    std::atomic<uint32_t> received = 0;
+
+    std::thread consumer([&]() {
+        uint32_t seen = 0;
+        while (seen < COUNT) {
+            uint32_t const value = events.load();
+            if (value == seen) {
+                events.wait(value);
+                continue;
+            }
+            seen = value;
+        }
+        received = seen;
+    });
+
+    for (uint32_t i = 0; i < COUNT; i++) {
+        events.fetch_add(1);
+        events.notify_one();
+    }
+    consumer.join();
+    EXPECT_EQ(received, COUNT);
+}
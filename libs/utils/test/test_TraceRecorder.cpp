@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <utils/Path.h>
+#include <utils/Systrace.h>
+#include <utils/TraceRecorder.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+using namespace utils;
+
+static std::string readFile(Path const& path) {
+    std::ifstream in(path.c_str());
+    return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+}
+
+static size_t count(std::string const& s, std::string const& pattern) {
+    size_t n = 0;
+    for (size_t pos = s.find(pattern); pos != std::string::npos; pos = s.find(pattern, pos + 1)) {
+        n++;
+    }
+    return n;
+}
+
+TEST(TraceRecorderTest, RecordsAllThreads) {
+    if (!TraceRecorder::isSupported()) {
+        GTEST_SKIP() << "the systrace markers aren't recorded on this platform";
+    }
+
+    {
+        SYSTRACE_NAME("beforeStart");
+    }
+
+    TraceRecorder::start();
+    EXPECT_TRUE(TraceRecorder::isRecording());
+    {
+        SYSTRACE_NAME("main \"scope\"");
+        SYSTRACE_CONTEXT();
+        SYSTRACE_VALUE32("counter", 42);
+        std::thread worker([]() {
+            TraceRecorder::setThreadName("worker");
+            SYSTRACE_NAME("work");
+            SYSTRACE_FRAME_ID(7u);
+        });
+        worker.join();
+    }
+    TraceRecorder::stop();
+    EXPECT_FALSE(TraceRecorder::isRecording());
+    {
+        SYSTRACE_NAME("afterStop");
+    }
+
+    Path path = Path::getTemporaryDirectory() + "test_trace_recorder.json";
+    ASSERT_TRUE(TraceRecorder::write(path.c_str()));
+    std::string const trace = readFile(path);
+    path.unlinkFile();
+
+    EXPECT_EQ(trace.find("beforeStart"), std::string::npos);
+    EXPECT_EQ(trace.find("afterStop"), std::string::npos);
+    EXPECT_NE(trace.find(R"("name":"main \"scope\"")"), std::string::npos);
+    EXPECT_NE(trace.find(R"("name":"work")"), std::string::npos);
+    EXPECT_NE(trace.find(R"("args":{"name":"worker"})"), std::string::npos);
+    EXPECT_NE(trace.find(R"("args":{"value":42})"), std::string::npos);
+    EXPECT_NE(trace.find(R"("name":"frame 7")"), std::string::npos);
+    EXPECT_EQ(count(trace, R"("ph":"B")"), count(trace, R"("ph":"E")"));
+}
+
+TEST(TraceRecorderTest, KeepsTheLatestEvents) {
+    if (!TraceRecorder::isSupported()) {
+        GTEST_SKIP() << "the systrace markers aren't recorded on this platform";
+    }
+
+    TraceRecorder::start();
+    std::thread worker([]() {
+        SYSTRACE_NAME("outer");
+        for (size_t i = 0; i < TraceRecorder::EVENTS_PER_THREAD; i++) {
+            SYSTRACE_NAME("inner");
+        }
+    });
+    worker.join();
+    TraceRecorder::stop();
+
+    Path path = Path::getTemporaryDirectory() + "test_trace_recorder.json";
+    ASSERT_TRUE(TraceRecorder::write(path.c_str()));
+    std::string const trace = readFile(path);
+    path.unlinkFile();
+
+    // the beginning of "outer" was overwritten, so its end must be dropped
+    EXPECT_EQ(trace.find(R"("name":"outer")"), std::string::npos);
+    EXPECT_EQ(count(trace, R"("ph":"B")"), count(trace, R"("ph":"E")"));
+}
@@ -19,6 +19,11 @@
 
 #include <viewer/AutomationSpec.h>
 
+#include <filament/Renderer.h>
+
+#include <string>
+#include <vector>
+
 namespace filament {
 
 class ColorGrading;
@@ -45,6 +50,9 @@ namespace viewer {
  * The time to sleep between tests is configurable and can be set to zero. Automation also waits a
  * specified minimum number of frames between tests.
  *
+ * In benchmark mode (see Options::benchmarkFrameCount), the time between tests is a warm-up, then
+ * each test is measured over a number of frames and a report is written after the last test.
+ *
  * Batch mode is meant for non-interactive applications. In batch mode, automation defers applying
  * the first test case until the client unblocks it via signalBatchMode(). This is useful when
  * waiting for a large model file to become fully loaded. Batch mode also offers a query
@@ -82,6 +90,19 @@ public:
          * If true, the tick function writes out a settings JSON file before advancing.
          */
         bool exportSettings = false;
+
+        /**
+         * If greater than zero, each test is measured over this many frames once the minimum
+         * sleep time and frame count have elapsed, which then act as a warm-up. The warm-up
+         * should cover the few frames it takes for GPU timings to become available.
+         *
+         * After the last test, a report is written to benchmark.json and benchmark.csv. It
+         * contains, for each test, the CPU frame interval, the main and backend thread times
+         * and the GPU frame time. The JSON report also has the GPU time of each pass.
+         *
+         * @see Renderer::getFrameInfoHistory()
+         */
+        int benchmarkFrameCount = 0;
     };
 
     /**
@@ -255,6 +276,22 @@ private:
     bool mTerminated = false;
     bool mOwnsSettings = false;
 
+    // Frames recorded for one test in benchmark mode.
+    struct BenchmarkResult {
+        std::string name;
+        std::vector<float> frameIntervals; // from tick()'s deltaTime, in seconds
+        std::vector<Renderer::FrameInfo> frames;
+    };
+
+    // Returns true once the current test has been measured over benchmarkFrameCount frames.
+    bool measureFrame(Renderer* renderer, float deltaTime);
+    void exportBenchmark() const;
+
+    std::vector<BenchmarkResult> mBenchmarkResults;
+    uint32_t mLastFrameId = 0;
+    int mMeasuredFrames = 0;
+    bool mMeasuring = false;
+
 public:
     // For internal use from a screenshot callback.
     void requestClose() { mShouldClose = true; }
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VIEWER_CELL_STREAMER_H
+#define VIEWER_CELL_STREAMER_H
+
+#include <filament/Box.h>
+#include <filament/IndexBuffer.h>
+#include <filament/RenderableManager.h>
+#include <filament/VertexBuffer.h>
+
+#include <utils/compiler.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+class Engine;
+class Material;
+class MaterialInstance;
+class Scene;
+
+namespace viewer {
+
+/**
+ * The CellStreamer loads and unloads the cells of a large world around the eye, without hitching
+ * the main thread.
+ *
+ * A cell is a bounding box. When the eye comes within Options::loadDistance of it, the Loader runs
+ * on the engine's JobSystem and stages the content of the cell: its vertex and index buffers with
+ * their data, its material instances and its renderables. None of this touches the engine.
+ * update() then commits the staged content on the main thread one step at a time, where a step
+ * creates one buffer, material instance or renderable, until the time budget of the frame is
+ * spent. The cells that go beyond Options::unloadDistance are removed from the scene and destroyed
+ * under the same budget.
+ *
+ * Cells that aren't loaded have no entity at all, so they cost nothing to the renderer.
+ */
+class UTILS_PUBLIC CellStreamer {
+public:
+    using CellId = uint32_t;
+
+    /**
+     * The content of a cell, staged by the Loader off the main thread.
+     */
+    class UTILS_PUBLIC Staging {
+    public:
+        //! Marks a primitive whose geometry or material was set on the renderable's builder.
+        static constexpr uint32_t SHARED = UINT32_MAX;
+
+        struct Primitive {
+            size_t index;                               //!< primitive of the renderable
+            RenderableManager::PrimitiveType type = RenderableManager::PrimitiveType::TRIANGLES;
+            uint32_t vertexBuffer = SHARED;             //!< staged in this cell, or SHARED
+            uint32_t indexBuffer = SHARED;              //!< staged in this cell
+            uint32_t materialInstance = SHARED;         //!< staged in this cell, or SHARED
+        };
+
+        /**
+         * Stages a vertex buffer and the data of each of its buffers, in the order of their index.
+         * @return the index of the vertex buffer in this cell
+         */
+        uint32_t addVertexBuffer(VertexBuffer::Builder&& builder,
+                std::vector<VertexBuffer::BufferDescriptor>&& buffers);
+
+        /**
+         * Stages an index buffer and its data.
+         * @return the index of the index buffer in this cell
+         */
+        uint32_t addIndexBuffer(IndexBuffer::Builder&& builder,
+                IndexBuffer::BufferDescriptor&& buffer);
+
+        /**
+         * Stages an instance of the given material. The optional setup function is called on
+         * the main thread right after the instance is created, e.g. to set its parameters.
+         * @return the index of the material instance in this cell
+         */
+        uint32_t addMaterialInstance(Material const* material,
+                std::function<void(MaterialInstance*)> setup = {});
+
+        /**
+         * Stages a renderable at the given world transform. The builder gets the geometry and
+         * material of each primitive from the staged objects when the renderable is committed.
+         * Geometry and materials shared by several cells are set on the builder instead, and
+         * marked SHARED in the primitives.
+         */
+        void addRenderable(RenderableManager::Builder&& builder, math::mat4f const& transform,
+                std::vector<Primitive>&& primitives = {});
+
+    private:
+        friend class CellStreamer;
+        struct StagedVertexBuffer {
+            VertexBuffer::Builder builder;
+            std::vector<VertexBuffer::BufferDescriptor> buffers;
+        };
+        struct StagedIndexBuffer {
+            IndexBuffer::Builder builder;
+            IndexBuffer::BufferDescriptor buffer;
+        };
+        struct StagedMaterialInstance {
+            Material const* material;
+            std::function<void(MaterialInstance*)> setup;
+        };
+        struct StagedRenderable {
+            RenderableManager::Builder builder;
+            math::mat4f transform;
+            std::vector<Primitive> primitives;
+        };
+        std::vector<StagedVertexBuffer> mVertexBuffers;
+        std::vector<StagedIndexBuffer> mIndexBuffers;
+        std::vector<StagedMaterialInstance> mMaterialInstances;
+        std::vector<StagedRenderable> mRenderables;
+    };
+
+    /**
+     * Stages the content of a cell. It runs on a thread of the engine's JobSystem and must not
+     * call into the engine.
+     */
+    using Loader = std::function<void(CellId cell, Staging& staging)>;
+
+    struct Options {
+        /**
+         * Cells closer than this to the eye are loaded, in world units.
+         */
+        float loadDistance = 100.0f;
+
+        /**
+         * Cells farther than this from the eye are unloaded. It must be larger than
+         * loadDistance, so that cells at the boundary don't keep loading and unloading.
+         */
+        float unloadDistance = 150.0f;
+
+        /**
+         * Time spent committing and destroying cells in each update(), in milliseconds. At least
+         * one step is taken per update, so that streaming always progresses.
+         */
+        float budget = 2.0f;
+
+        /**
+         * Maximum number of Loaders running at once, the nearest cells are loaded first.
+         */
+        uint32_t maxConcurrentLoads = 2;
+    };
+
+    enum class State : uint8_t {
+        UNLOADED,       //!< the cell has no content
+        LOADING,        //!< the Loader is staging the content of the cell
+        COMMITTING,     //!< the staged content is being added to the scene
+        LOADED,         //!< all of the content is in the scene
+        UNLOADING,      //!< the content is being removed from the scene and destroyed
+    };
+
+    CellStreamer(Engine& engine, Scene& scene, Loader loader, Options const& options);
+
+    /**
+     * Waits for the Loaders that are running, then destroys all the content of the cells.
+     */
+    ~CellStreamer();
+
+    CellStreamer(CellStreamer const&) = delete;
+    CellStreamer& operator=(CellStreamer const&) = delete;
+
+    void setOptions(Options const& options) noexcept { mOptions = options; }
+    Options const& getOptions() const noexcept { return mOptions; }
+
+    /**
+     * Adds a cell of the world, it's loaded by a later update() if it's close to the eye.
+     */
+    CellId addCell(Box const& bounds);
+
+    /**
+     * Starts loading the cells near the eye and unloading the ones far from it, then commits
+     * or destroys their content within the time budget. Must be called on the main thread,
+     * typically once per frame.
+     */
+    void update(math::float3 const& eye);
+
+    State getState(CellId cell) const noexcept;
+
+    size_t getCellCount() const noexcept { return mCells.size(); }
+
+private:
+    struct Cell;
+    void commitStep(Cell& cell);
+    void unloadStep(Cell& cell);
+
+    Engine& mEngine;
+    Scene& mScene;
+    Loader mLoader;
+    Options mOptions;
+    std::vector<std::unique_ptr<Cell>> mCells;
+};
+
+} // namespace viewer
+} // namespace filament
+
+#endif // VIEWER_CELL_STREAMER_H
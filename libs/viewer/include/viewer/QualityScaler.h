@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VIEWER_QUALITY_SCALER_H
+#define VIEWER_QUALITY_SCALER_H
+
+#include <viewer/Settings.h>
+
+#include <filament/Renderer.h>
+
+#include <utils/compiler.h>
+
+#include <array>
+#include <functional>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+namespace viewer {
+
+/**
+ * The QualityScaler lowers or restores the quality of individual effects to keep the GPU frame
+ * time within a budget. It complements DynamicResolutionOptions, which only scales the viewport.
+ *
+ * Clients enable Renderer::setPassTimingEnabled(), feed each FrameInfo to update(), and push the
+ * settings they want through apply() before calling applySettings() on them. Settings are never
+ * raised above the ones given to apply(), the scaler only ever degrades them.
+ *
+ * When the frame is over budget, the effect whose passes cost the most on the GPU is lowered by
+ * one level. When the frame has enough headroom to afford the cost saved by the last lowered
+ * effect, it is restored by one level. Changes are spaced by a number of frames, so that their
+ * effect can be measured before the next decision.
+ */
+class UTILS_PUBLIC QualityScaler {
+public:
+    enum class Feature : uint8_t {
+        SSAO,       //!< 1: full resolution to half resolution and fewer samples, 2: disabled
+        SHADOWS,    //!< each level halves the shadow map size, down to 256
+        BLOOM,      //!< 1: two fewer levels, 2: disabled
+        SSR,        //!< 1: disabled
+        MSAA,       //!< 1: 2 samples, 2: disabled
+    };
+
+    static constexpr size_t FEATURE_COUNT = 5;
+
+    struct Options {
+        /**
+         * GPU frame time to stay under, in milliseconds.
+         */
+        float targetFrameTime = 1000.0f / 60.0f;
+
+        /**
+         * Fraction of the target frame time that must remain free, after accounting for the
+         * cost of an effect, before that effect is restored. Avoids oscillating between two
+         * levels.
+         */
+        float hysteresis = 0.1f;
+
+        /**
+         * Minimum number of frames between two changes.
+         */
+        uint32_t cooldownFrames = 30;
+
+        /**
+         * Weight of the newest frame in the running averages of the frame and effect costs.
+         */
+        float smoothing = 0.1f;
+    };
+
+    /**
+     * Called before a feature changes level, the change is only made if this returns true.
+     * Lets the application veto changes, or react to them.
+     */
+    using Callback = std::function<bool(Feature feature, uint8_t oldLevel, uint8_t newLevel)>;
+
+    QualityScaler() noexcept;
+    explicit QualityScaler(Options const& options) noexcept;
+
+    void setOptions(Options const& options) noexcept { mOptions = options; }
+    Options const& getOptions() const noexcept { return mOptions; }
+
+    void setCallback(Callback callback) noexcept { mCallback = std::move(callback); }
+
+    /**
+     * Accounts for a frame's timings and possibly changes the level of one feature.
+     * @return true if a level changed, in which case the settings should be applied again.
+     */
+    bool update(Renderer::FrameInfo const& info) noexcept;
+
+    /**
+     * Degrades view and light according to the current levels. Features that are disabled in
+     * the given settings are left alone, and won't be picked by update() until they're enabled.
+     */
+    void apply(ViewSettings* view, LightSettings* light) noexcept;
+
+    /**
+     * Current level of a feature, 0 means the quality requested by the application.
+     */
+    uint8_t getLevel(Feature feature) const noexcept { return mLevels[size_t(feature)]; }
+
+    /**
+     * Restores all features to level 0.
+     */
+    void reset() noexcept;
+
+    /**
+     * Returns the feature a FrameGraph pass is accounted to, or false if it's none of them.
+     */
+    static bool getFeatureForPass(const char* name, Feature* feature) noexcept;
+
+private:
+    static uint8_t getMaxLevel(Feature feature) noexcept;
+    bool setLevel(Feature feature, uint8_t level) noexcept;
+
+    Options mOptions;
+    Callback mCallback;
+    float mFrameTime = 0.0f;                            // running average, in ms
+    std::array<float, FEATURE_COUNT> mCosts{};          // running averages, in ms
+    std::array<uint8_t, FEATURE_COUNT> mLevels{};
+    std::array<bool, FEATURE_COUNT> mEnabled{};         // as of the last apply()
+    struct Change {
+        Feature feature;
+        float costBefore;   // what restoring the feature is expected to cost
+    };
+    // changes in the order they were made, the last one is undone first
+    std::array<Change, 16> mHistory{};
+    size_t mHistorySize = 0;
+    uint32_t mFramesSinceChange = 0;
+};
+
+} // namespace viewer
+} // namespace filament
+
+#endif // VIEWER_QUALITY_SCALER_H
@@ -66,6 +66,7 @@ enum class ToneMapping : uint8_t {
 using AmbientOcclusionOptions = filament::View::AmbientOcclusionOptions;
 using ScreenSpaceReflectionsOptions = filament::View::ScreenSpaceReflectionsOptions;
 using AntiAliasing = filament::View::AntiAliasing;
+using AutoExposureOptions = filament::View::AutoExposureOptions;
 using BloomOptions = filament::View::BloomOptions;
 using DepthOfFieldOptions = filament::View::DepthOfFieldOptions;
 using Dithering = filament::View::Dithering;
@@ -192,6 +193,7 @@ struct ViewSettings {
     RenderQuality renderQuality;
     TemporalAntiAliasingOptions taa;
     VignetteOptions vignette;
+    AutoExposureOptions autoExposure;
     VsmShadowOptions vsmShadowOptions;
     GuardBandOptions guardBand;
     StereoscopicOptions stereoscopicOptions;
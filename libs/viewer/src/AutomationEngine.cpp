@@ -26,9 +26,11 @@
 #include <utils/Log.h>
 #include <utils/Path.h>
 
+#include <algorithm>
 #include <iomanip>
 #include <fstream>
 #include <sstream>
+#include <utility>
 
 using namespace utils;
 
@@ -97,6 +99,145 @@ void AutomationEngine::exportScreenshot(View* view, Renderer* renderer, std::str
             std::move(buffer));
 }
 
+struct Statistics {
+    double mean = 0.0;
+    double median = 0.0;
+};
+
+static Statistics computeStatistics(std::vector<double> values) {
+    Statistics result;
+    if (values.empty()) {
+        return result;
+    }
+    for (double const v : values) {
+        result.mean += v;
+    }
+    result.mean /= double(values.size());
+    auto const middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    result.median = *middle;
+    return result;
+}
+
+static std::ostream& operator<<(std::ostream& out, Statistics const& stats) {
+    return out << "{ \"mean\": " << stats.mean << ", \"median\": " << stats.median << " }";
+}
+
+bool AutomationEngine::measureFrame(Renderer* renderer, float deltaTime) {
+    // the history starts with the most recent frame whose timings are available
+    auto const history = renderer->getFrameInfoHistory(renderer->getMaxFrameHistorySize());
+
+    if (!mMeasuring) {
+        // the warm-up just ended, only the frames after this one are recorded
+        mMeasuring = true;
+        mMeasuredFrames = 0;
+        mLastFrameId = history.empty() ? 0 : history[0].frameId;
+        mBenchmarkResults.push_back({ mSpec->getName(mCurrentTest) });
+        return false;
+    }
+
+    BenchmarkResult& result = mBenchmarkResults.back();
+    result.frameIntervals.push_back(deltaTime);
+    for (size_t i = history.size(); i > 0; i--) {
+        Renderer::FrameInfo const& info = history[i - 1];
+        if (info.frameId > mLastFrameId) {
+            result.frames.push_back(info);
+            mLastFrameId = info.frameId;
+        }
+    }
+
+    if (++mMeasuredFrames < mOptions.benchmarkFrameCount) {
+        return false;
+    }
+    mMeasuring = false;
+    return true;
+}
+
+void AutomationEngine::exportBenchmark() const {
+    std::ofstream json("benchmark.json");
+    std::ofstream csv("benchmark.csv");
+    if (!json || !csv) {
+        gStatus = "Failed to export benchmark report.";
+        return;
+    }
+
+    // all durations are reported in milliseconds
+    constexpr double NS_TO_MS = 1e-6;
+
+    csv << "test,frames,interval_mean,interval_median,main_thread_mean,main_thread_median,"
+           "backend_thread_mean,backend_thread_median,gpu_mean,gpu_median" << std::endl;
+    json << "{\n  \"tests\": [";
+
+    for (size_t t = 0; t < mBenchmarkResults.size(); t++) {
+        BenchmarkResult const& result = mBenchmarkResults[t];
+
+        std::vector<double> intervals;
+        for (float const dt : result.frameIntervals) {
+            intervals.push_back(dt * 1e3);
+        }
+
+        std::vector<double> mainThread;
+        std::vector<double> backendThread;
+        std::vector<double> gpu;
+        // passes with the same name (e.g. from several views) are added together
+        std::vector<std::pair<std::string, std::vector<double>>> passes;
+        for (Renderer::FrameInfo const& info : result.frames) {
+            mainThread.push_back(double(info.endFrame - info.beginFrame) * NS_TO_MS);
+            backendThread.push_back(
+                    double(info.backendEndFrame - info.backendBeginFrame) * NS_TO_MS);
+            if (info.frameTime > 0) {
+                gpu.push_back(double(info.frameTime) * NS_TO_MS);
+            }
+            std::vector<std::pair<std::string, double>> framePasses;
+            for (size_t i = 0; i < info.passTimingCount; i++) {
+                auto const& pass = info.passTimings[i];
+                auto pos = std::find_if(framePasses.begin(), framePasses.end(),
+                        [&pass](auto const& p) { return p.first == pass.name; });
+                if (pos == framePasses.end()) {
+                    pos = framePasses.insert(pos, { pass.name, 0.0 });
+                }
+                pos->second += double(pass.gpuTime) * NS_TO_MS;
+            }
+            for (auto const& [name, time] : framePasses) {
+                auto pos = std::find_if(passes.begin(), passes.end(),
+                        [&name = name](auto const& p) { return p.first == name; });
+                if (pos == passes.end()) {
+                    pos = passes.insert(pos, { name, {} });
+                }
+                pos->second.push_back(time);
+            }
+        }
+
+        Statistics const intervalStats = computeStatistics(intervals);
+        Statistics const mainThreadStats = computeStatistics(mainThread);
+        Statistics const backendThreadStats = computeStatistics(backendThread);
+        Statistics const gpuStats = computeStatistics(gpu);
+
+        csv << result.name << "," << intervals.size() << ","
+            << intervalStats.mean << "," << intervalStats.median << ","
+            << mainThreadStats.mean << "," << mainThreadStats.median << ","
+            << backendThreadStats.mean << "," << backendThreadStats.median << ","
+            << gpuStats.mean << "," << gpuStats.median << std::endl;
+
+        json << (t ? "," : "") << "\n    {\n"
+             << "      \"name\": \"" << result.name << "\",\n"
+             << "      \"frames\": " << intervals.size() << ",\n"
+             << "      \"interval\": " << intervalStats << ",\n"
+             << "      \"mainThread\": " << mainThreadStats << ",\n"
+             << "      \"backendThread\": " << backendThreadStats << ",\n"
+             << "      \"gpu\": " << gpuStats << ",\n"
+             << "      \"passes\": {";
+        for (size_t i = 0; i < passes.size(); i++) {
+            json << (i ? "," : "") << "\n        \"" << passes[i].first << "\": "
+                 << computeStatistics(passes[i].second);
+        }
+        json << (passes.empty() ? "}" : "\n      }") << "\n    }";
+    }
+    json << "\n  ]\n}" << std::endl;
+
+    gStatus = "Exported benchmark.json and benchmark.csv in the current folder.";
+}
+
 AutomationEngine* AutomationEngine::createFromJSON(const char* jsonSpec, size_t size) {
     AutomationSpec* spec = AutomationSpec::generate(jsonSpec, size);
     if (!spec) {
@@ -206,6 +347,9 @@ void AutomationEngine::tick(Engine* engine, const ViewerContent& content, float
         for (size_t i = 0; i < content.materialCount; i++) {
             viewer::applySettings(engine, mSettings->material, content.materials[i]);
         }
+        if (mOptions.benchmarkFrameCount > 0) {
+            content.renderer->setPassTimingEnabled(true);
+        }
         if (mOptions.verbose) {
             utils::slog.i << "Running test " << mCurrentTest << utils::io::endl;
         }
@@ -217,6 +361,7 @@ void AutomationEngine::tick(Engine* engine, const ViewerContent& content, float
                 mIsRunning = true;
                 mRequestStart = false;
                 mCurrentTest = 0;
+                mBenchmarkResults.clear();
                 activateTest();
             }
         }
@@ -230,6 +375,10 @@ void AutomationEngine::tick(Engine* engine, const ViewerContent& content, float
         return;
     }
 
+    if (mOptions.benchmarkFrameCount > 0 && !measureFrame(content.renderer, deltaTime)) {
+        return;
+    }
+
     const bool isLastTest = mCurrentTest == mSpec->size() - 1;
 
     const int digits = (int) log10 ((double) mSpec->size()) + 1;
@@ -250,6 +399,10 @@ void AutomationEngine::tick(Engine* engine, const ViewerContent& content, float
 
     if (isLastTest) {
         mIsRunning = false;
+        if (mOptions.benchmarkFrameCount > 0) {
+            content.renderer->setPassTimingEnabled(false);
+            exportBenchmark();
+        }
         if (mBatchModeEnabled && !mOptions.exportScreenshots) {
             mShouldClose = true;
         }
@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <viewer/CellStreamer.h>
+
+#include <filament/Engine.h>
+#include <filament/Material.h>
+#include <filament/MaterialInstance.h>
+#include <filament/Scene.h>
+#include <filament/TransformManager.h>
+
+#include <utils/Entity.h>
+#include <utils/EntityManager.h>
+#include <utils/JobSystem.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace filament::viewer {
+
+using namespace math;
+using namespace utils;
+
+struct CellStreamer::Cell {
+    CellId id;
+    Box bounds;
+    State state = State::UNLOADED;
+    float distance = 0.0f;
+
+    // Set by the Loader's job, the staging belongs to it until then.
+    std::unique_ptr<Staging> staging;
+    JobSystem::Job* job = nullptr;
+    std::atomic<bool> staged{ false };
+
+    // The next staged object to commit, they're committed in the order of the Staging fields.
+    size_t next = 0;
+
+    // The committed objects, in the order they were staged.
+    std::vector<VertexBuffer*> vertexBuffers;
+    std::vector<IndexBuffer*> indexBuffers;
+    std::vector<MaterialInstance*> materialInstances;
+    std::vector<Entity> entities;
+};
+
+uint32_t CellStreamer::Staging::addVertexBuffer(VertexBuffer::Builder&& builder,
+        std::vector<VertexBuffer::BufferDescriptor>&& buffers) {
+    mVertexBuffers.push_back({ std::move(builder), std::move(buffers) });
+    return uint32_t(mVertexBuffers.size() - 1);
+}
+
+uint32_t CellStreamer::Staging::addIndexBuffer(IndexBuffer::Builder&& builder,
+        IndexBuffer::BufferDescriptor&& buffer) {
+    mIndexBuffers.push_back({ std::move(builder), std::move(buffer) });
+    return uint32_t(mIndexBuffers.size() - 1);
+}
+
+uint32_t CellStreamer::Staging::addMaterialInstance(Material const* material,
+        std::function<void(MaterialInstance*)> setup) {
+    mMaterialInstances.push_back({ material, std::move(setup) });
+    return uint32_t(mMaterialInstances.size() - 1);
+}
+
+void CellStreamer::Staging::addRenderable(RenderableManager::Builder&& builder,
+        mat4f const& transform, std::vector<Primitive>&& primitives) {
+    mRenderables.push_back({ std::move(builder), transform, std::move(primitives) });
+}
+
+// Distance from a point to a box, zero inside of it.
+static float distance(Box const& box, float3 const& point) noexcept {
+    return length(max(abs(point - box.center) - box.halfExtent, float3(0.0f)));
+}
+
+CellStreamer::CellStreamer(Engine& engine, Scene& scene, Loader loader, Options const& options)
+        : mEngine(engine), mScene(scene), mLoader(std::move(loader)), mOptions(options) {
+}
+
+CellStreamer::~CellStreamer() {
+    JobSystem& js = mEngine.getJobSystem();
+    for (auto& cell : mCells) {
+        if (cell->job) {
+            js.waitAndRelease(cell->job);
+        }
+        cell->staging.reset();
+        while (cell->state != State::UNLOADED) {
+            unloadStep(*cell);
+        }
+    }
+}
+
+CellStreamer::CellId CellStreamer::addCell(Box const& bounds) {
+    auto cell = std::make_unique<Cell>();
+    cell->id = CellId(mCells.size());
+    cell->bounds = bounds;
+    mCells.push_back(std::move(cell));
+    return mCells.back()->id;
+}
+
+CellStreamer::State CellStreamer::getState(CellId cell) const noexcept {
+    return cell < mCells.size() ? mCells[cell]->state : State::UNLOADED;
+}
+
+void CellStreamer::update(float3 const& eye) {
+    using clock = std::chrono::steady_clock;
+    auto const start = clock::now();
+    JobSystem& js = mEngine.getJobSystem();
+
+    // Move the cells along, depending on how far they are from the eye.
+    std::vector<Cell*> toLoad;
+    uint32_t loadCount = 0;
+    for (auto& cell : mCells) {
+        cell->distance = distance(cell->bounds, eye);
+        bool const far = cell->distance > mOptions.unloadDistance;
+        switch (cell->state) {
+            case State::UNLOADED:
+                if (cell->distance < mOptions.loadDistance) {
+                    toLoad.push_back(cell.get());
+                }
+                break;
+            case State::LOADING:
+                if (!cell->staged.load(std::memory_order_acquire)) {
+                    loadCount++;
+                    break;
+                }
+                js.waitAndRelease(cell->job);
+                if (far) {
+                    // the eye went away while the cell was loading, nothing was committed yet
+                    cell->staging.reset();
+                    cell->state = State::UNLOADED;
+                } else {
+                    cell->next = 0;
+                    cell->state = State::COMMITTING;
+                }
+                break;
+            case State::COMMITTING:
+            case State::LOADED:
+                if (far) {
+                    cell->staging.reset();
+                    cell->state = State::UNLOADING;
+                }
+                break;
+            case State::UNLOADING:
+                break;
+        }
+    }
+
+    // Start loading the nearest cells first.
+    std::sort(toLoad.begin(), toLoad.end(), [](Cell const* lhs, Cell const* rhs) {
+        return lhs->distance < rhs->distance;
+    });
+    for (Cell* cell : toLoad) {
+        if (loadCount >= mOptions.maxConcurrentLoads) {
+            break;
+        }
+        loadCount++;
+        cell->staging = std::make_unique<Staging>();
+        cell->staged.store(false, std::memory_order_relaxed);
+        cell->state = State::LOADING;
+        Loader const* const loader = &mLoader;
+        cell->job = js.runAndRetain(jobs::createJob(js, nullptr, [loader, cell]() {
+            (*loader)(cell->id, *cell->staging);
+            cell->staged.store(true, std::memory_order_release);
+        }));
+    }
+
+    // Spend the budget, on unloading first to release memory, then on committing the nearest
+    // cells first.
+    std::vector<Cell*> work;
+    for (auto& cell : mCells) {
+        if (cell->state == State::UNLOADING || cell->state == State::COMMITTING) {
+            work.push_back(cell.get());
+        }
+    }
+    std::sort(work.begin(), work.end(), [](Cell const* lhs, Cell const* rhs) {
+        bool const lhsUnloading = lhs->state == State::UNLOADING;
+        bool const rhsUnloading = rhs->state == State::UNLOADING;
+        if (lhsUnloading != rhsUnloading) {
+            return lhsUnloading;
+        }
+        return lhs->distance < rhs->distance;
+    });
+    std::chrono::duration<float, std::milli> const budget(mOptions.budget);
+    for (Cell* cell : work) {
+        while (cell->state == State::UNLOADING || cell->state == State::COMMITTING) {
+            if (cell->state == State::UNLOADING) {
+                unloadStep(*cell);
+            } else {
+                commitStep(*cell);
+            }
+            if (clock::now() - start >= budget) {
+                return;
+            }
+        }
+    }
+}
+
+void CellStreamer::commitStep(Cell& cell) {
+    Staging& staging = *cell.staging;
+    size_t const vertexBufferCount = staging.mVertexBuffers.size();
+    size_t const indexBufferCount = staging.mIndexBuffers.size();
+    size_t const materialInstanceCount = staging.mMaterialInstances.size();
+    size_t const count = vertexBufferCount + indexBufferCount + materialInstanceCount +
+            staging.mRenderables.size();
+
+    if (cell.next < count) {
+        size_t index = cell.next++;
+        if (index < vertexBufferCount) {
+            auto& staged = staging.mVertexBuffers[index];
+            VertexBuffer* const vb = staged.builder.build(mEngine);
+            for (size_t i = 0; i < staged.buffers.size(); i++) {
+                vb->setBufferAt(mEngine, uint8_t(i), std::move(staged.buffers[i]));
+            }
+            cell.vertexBuffers.push_back(vb);
+        } else if ((index -= vertexBufferCount) < indexBufferCount) {
+            auto& staged = staging.mIndexBuffers[index];
+            IndexBuffer* const ib = staged.builder.build(mEngine);
+            ib->setBuffer(mEngine, std::move(staged.buffer));
+            cell.indexBuffers.push_back(ib);
+        } else if ((index -= indexBufferCount) < materialInstanceCount) {
+            auto const& staged = staging.mMaterialInstances[index];
+            MaterialInstance* const mi = staged.material->createInstance();
+            if (staged.setup) {
+                staged.setup(mi);
+            }
+            cell.materialInstances.push_back(mi);
+        } else {
+            auto& staged = staging.mRenderables[index - materialInstanceCount];
+            for (auto const& primitive : staged.primitives) {
+                if (primitive.vertexBuffer != Staging::SHARED) {
+                    staged.builder.geometry(primitive.index, primitive.type,
+                            cell.vertexBuffers[primitive.vertexBuffer],
+                            cell.indexBuffers[primitive.indexBuffer]);
+                }
+                if (primitive.materialInstance != Staging::SHARED) {
+                    staged.builder.material(primitive.index,
+                            cell.materialInstances[primitive.materialInstance]);
+                }
+            }
+            Entity const entity = EntityManager::get().create();
+            staged.builder.build(mEngine, entity);
+            mEngine.getTransformManager().create(entity, {}, staged.transform);
+            mScene.addEntity(entity);
+            cell.entities.push_back(entity);
+        }
+    }
+
+    if (cell.next == count) {
+        cell.staging.reset();
+        cell.state = State::LOADED;
+    }
+}
+
+void CellStreamer::unloadStep(Cell& cell) {
+    // the renderables go first, they use all the other objects
+    if (!cell.entities.empty()) {
+        Entity const entity = cell.entities.back();
+        cell.entities.pop_back();
+        mScene.remove(entity);
+        mEngine.destroy(entity);
+        EntityManager::get().destroy(entity);
+    } else if (!cell.materialInstances.empty()) {
+        mEngine.destroy(cell.materialInstances.back());
+        cell.materialInstances.pop_back();
+    } else if (!cell.indexBuffers.empty()) {
+        mEngine.destroy(cell.indexBuffers.back());
+        cell.indexBuffers.pop_back();
+    } else if (!cell.vertexBuffers.empty()) {
+        mEngine.destroy(cell.vertexBuffers.back());
+        cell.vertexBuffers.pop_back();
+    }
+    if (cell.entities.empty() && cell.materialInstances.empty() &&
+            cell.indexBuffers.empty() && cell.vertexBuffers.empty()) {
+        cell.state = State::UNLOADED;
+    }
+}
+
+} // namespace filament::viewer
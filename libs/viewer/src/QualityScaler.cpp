@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <viewer/QualityScaler.h>
+
+#include <algorithm>
+
+#include <string.h>
+
+namespace filament {
+namespace viewer {
+
+static constexpr uint32_t MIN_SHADOW_MAP_SIZE = 256;
+
+QualityScaler::QualityScaler() noexcept = default;
+
+QualityScaler::QualityScaler(Options const& options) noexcept : mOptions(options) {
+}
+
+void QualityScaler::reset() noexcept {
+    mLevels = {};
+    mHistorySize = 0;
+    mFramesSinceChange = 0;
+}
+
+bool QualityScaler::getFeatureForPass(const char* name, Feature* feature) noexcept {
+    struct Mapping {
+        const char* name;
+        Feature feature;
+    };
+    static constexpr Mapping MAPPINGS[] = {
+            { "SSAO Pass",                  Feature::SSAO },
+            { "Separable Blur Pass",        Feature::SSAO },
+            { "Shadow Pass",                Feature::SHADOWS },
+            { "VSM Generate Mipmap Pass",   Feature::SHADOWS },
+            { "Bloom Downsample",           Feature::BLOOM },
+            { "Bloom Upsample",             Feature::BLOOM },
+            { "SSR Pass",                   Feature::SSR },
+            { "Prepare MipmapSSR Pass",     Feature::SSR },
+            // MSAA mostly shows up in the cost of the color pass
+            { "Color Pass",                 Feature::MSAA },
+            { "Color Pass (opaque)",        Feature::MSAA },
+            { "Color Pass (transparent)",   Feature::MSAA },
+            { "resolve",                    Feature::MSAA },
+            { "resolveDepth",               Feature::MSAA },
+    };
+    for (Mapping const& mapping : MAPPINGS) {
+        if (!strcmp(name, mapping.name)) {
+            *feature = mapping.feature;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t QualityScaler::getMaxLevel(Feature feature) noexcept {
+    switch (feature) {
+        case Feature::SSAO:     return 2;
+        case Feature::SHADOWS:  return 4;
+        case Feature::BLOOM:    return 2;
+        case Feature::SSR:      return 1;
+        case Feature::MSAA:     return 2;
+    }
+    return 0;
+}
+
+bool QualityScaler::setLevel(Feature feature, uint8_t level) noexcept {
+    uint8_t& current = mLevels[size_t(feature)];
+    if (mCallback && !mCallback(feature, current, level)) {
+        return false;
+    }
+    current = level;
+    mFramesSinceChange = 0;
+    return true;
+}
+
+bool QualityScaler::update(Renderer::FrameInfo const& info) noexcept {
+    float const alpha = mOptions.smoothing;
+
+    std::array<float, FEATURE_COUNT> costs{};
+    for (size_t i = 0; i < info.passTimingCount; i++) {
+        Renderer::FrameInfo::PassTiming const& timing = info.passTimings[i];
+        Feature feature;
+        if (timing.name && getFeatureForPass(timing.name, &feature)) {
+            costs[size_t(feature)] += float(timing.gpuTime) * 1e-6f;
+        }
+    }
+    for (size_t i = 0; i < FEATURE_COUNT; i++) {
+        mCosts[i] += alpha * (costs[i] - mCosts[i]);
+    }
+    float const frameTime = float(info.frameTime) * 1e-6f;
+    mFrameTime = mFrameTime ? mFrameTime + alpha * (frameTime - mFrameTime) : frameTime;
+
+    if (++mFramesSinceChange < mOptions.cooldownFrames) {
+        return false;
+    }
+
+    float const target = mOptions.targetFrameTime;
+    if (mFrameTime > target) {
+        // over budget: lower the most expensive feature that can still be lowered
+        std::array<Feature, FEATURE_COUNT> candidates;
+        size_t count = 0;
+        for (size_t i = 0; i < FEATURE_COUNT; i++) {
+            Feature const feature = Feature(i);
+            if (mEnabled[i] && mCosts[i] > 0.0f && mLevels[i] < getMaxLevel(feature)) {
+                candidates[count++] = feature;
+            }
+        }
+        std::sort(candidates.begin(), candidates.begin() + count, [this](Feature lhs, Feature rhs) {
+            return mCosts[size_t(lhs)] > mCosts[size_t(rhs)];
+        });
+        for (size_t i = 0; i < count && mHistorySize < mHistory.size(); i++) {
+            Feature const feature = candidates[i];
+            float const costBefore = mCosts[size_t(feature)];
+            if (setLevel(feature, mLevels[size_t(feature)] + 1)) {
+                mHistory[mHistorySize++] = { feature, costBefore };
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (mHistorySize) {
+        // restore the last lowered feature if we can afford what it saved us
+        Change const& change = mHistory[mHistorySize - 1];
+        float const cost = std::max(0.0f, change.costBefore - mCosts[size_t(change.feature)]);
+        if (mFrameTime + cost < target * (1.0f - mOptions.hysteresis)) {
+            if (setLevel(change.feature, mLevels[size_t(change.feature)] - 1)) {
+                mHistorySize--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void QualityScaler::apply(ViewSettings* view, LightSettings* light) noexcept {
+    auto level = [this](Feature feature) { return mLevels[size_t(feature)]; };
+
+    mEnabled[size_t(Feature::SSAO)] = view->ssao.enabled;
+    if (view->ssao.enabled) {
+        if (level(Feature::SSAO) >= 2) {
+            view->ssao.enabled = false;
+        } else if (level(Feature::SSAO) == 1) {
+            view->ssao.resolution = 0.5f;
+            view->ssao.quality = std::min(view->ssao.quality, View::QualityLevel::LOW);
+        }
+    }
+
+    uint32_t& mapSize = light->shadowOptions.mapSize;
+    mEnabled[size_t(Feature::SHADOWS)] = light->enableShadows && mapSize > MIN_SHADOW_MAP_SIZE;
+    if (light->enableShadows && mapSize > MIN_SHADOW_MAP_SIZE) {
+        mapSize = std::max(MIN_SHADOW_MAP_SIZE, mapSize >> level(Feature::SHADOWS));
+    }
+
+    mEnabled[size_t(Feature::BLOOM)] = view->bloom.enabled;
+    if (view->bloom.enabled) {
+        if (level(Feature::BLOOM) >= 2) {
+            view->bloom.enabled = false;
+        } else if (level(Feature::BLOOM) == 1) {
+            view->bloom.levels = uint8_t(std::max(1, view->bloom.levels - 2));
+        }
+    }
+
+    mEnabled[size_t(Feature::SSR)] = view->screenSpaceReflections.enabled;
+    if (level(Feature::SSR) >= 1) {
+        view->screenSpaceReflections.enabled = false;
+    }
+
+    mEnabled[size_t(Feature::MSAA)] = view->msaa.enabled;
+    if (view->msaa.enabled) {
+        if (level(Feature::MSAA) >= 2) {
+            view->msaa.enabled = false;
+        } else if (level(Feature::MSAA) == 1) {
+            view->msaa.sampleCount = std::min(view->msaa.sampleCount, uint8_t(2));
+        }
+    }
+}
+
+} // namespace viewer
+} // namespace filament
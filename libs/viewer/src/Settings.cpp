@@ -289,6 +289,8 @@ static int parse(jsmntok_t const* tokens, int i, const char* jsonChunk, ViewSett
             i = parse(tokens, i + 1, jsonChunk, &out->dof);
         } else if (compare(tok, jsonChunk, "vignette") == 0) {
             i = parse(tokens, i + 1, jsonChunk, &out->vignette);
+        } else if (compare(tok, jsonChunk, "autoExposure") == 0) {
+            i = parse(tokens, i + 1, jsonChunk, &out->autoExposure);
         } else if (compare(tok, jsonChunk, "dithering") == 0) {
             i = parse(tokens, i + 1, jsonChunk, &out->dithering);
         } else if (compare(tok, jsonChunk, "renderQuality") == 0) {
@@ -572,6 +574,7 @@ void applySettings(Engine* engine, const ViewSettings& settings, View* dest) {
     dest->setFogOptions(settings.fog);
     dest->setDepthOfFieldOptions(settings.dof);
     dest->setVignetteOptions(settings.vignette);
+    dest->setAutoExposureOptions(settings.autoExposure);
     dest->setDithering(settings.dithering);
     dest->setRenderQuality(settings.renderQuality);
     dest->setDynamicLightingOptions(settings.dynamicLighting.zLightNear,
@@ -916,6 +919,7 @@ static std::ostream& operator<<(std::ostream& out, const ViewSettings& in) {
         << "\"fog\": " << (in.fog) << ",\n"
         << "\"dof\": " << (in.dof) << ",\n"
         << "\"vignette\": " << (in.vignette) << ",\n"
+        << "\"autoExposure\": " << (in.autoExposure) << ",\n"
         << "\"dithering\": " << (in.dithering) << ",\n"
         << "\"renderQuality\": " << (in.renderQuality) << ",\n"
         << "\"dynamicLighting\": " << (in.dynamicLighting) << ",\n"
@@ -248,6 +248,8 @@ int parse(jsmntok_t const* tokens, int i, const char* jsonChunk, BloomOptions* o
             i = parse(tokens, i + 1, jsonChunk, &out->enabled);
         } else if (compare(tok, jsonChunk, "highlight") == 0) {
             i = parse(tokens, i + 1, jsonChunk, &out->highlight);
+        } else if (compare(tok, jsonChunk, "quarterResolution") == 0) {
+            i = parse(tokens, i + 1, jsonChunk, &out->quarterResolution);
         } else if (compare(tok, jsonChunk, "quality") == 0) {
             i = parse(tokens, i + 1, jsonChunk, &out->quality);
         } else if (compare(tok, jsonChunk, "lensFlare") == 0) {
@@ -291,6 +293,7 @@ std::ostream& operator<<(std::ostream& out, const BloomOptions& in) {
         << "\"threshold\": " << to_string(in.threshold) << ",\n"
         << "\"enabled\": " << to_string(in.enabled) << ",\n"
         << "\"highlight\": " << (in.highlight) << ",\n"
+        << "\"quarterResolution\": " << to_string(in.quarterResolution) << ",\n"
         << "\"quality\": " << (in.quality) << ",\n"
         << "\"lensFlare\": " << to_string(in.lensFlare) << ",\n"
         << "\"starburst\": " << to_string(in.starburst) << ",\n"
@@ -478,6 +481,53 @@ std::ostream& operator<<(std::ostream& out, const VignetteOptions& in) {
         << "}";
 }
 
+int parse(jsmntok_t const* tokens, int i, const char* jsonChunk, AutoExposureOptions* out) {
+    CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+    int size = tokens[i++].size;
+    for (int j = 0; j < size; ++j) {
+        const jsmntok_t tok = tokens[i];
+        CHECK_KEY(tok);
+        if (compare(tok, jsonChunk, "minLogLuminance") == 0) {
+            i = parse(tokens, i + 1, jsonChunk, &out->minLogLuminance);
+        } else if (compare(tok, jsonChunk, "maxLogLuminance") == 0) {
+            i = parse(tokens, i + 1, jsonChunk, &out->maxLogLuminance);
+        } else if (compare(tok, jsonChunk, "lowPercentile") == 0) {
+            i = parse(tokens, i + 1, jsonChunk, &out->lowPercentile);
+        } else if (compare(tok, jsonChunk, "highPercentile") == 0) {
+            i = parse(tokens, i + 1, jsonChunk, &out->highPercentile);
+        } else if (compare(tok, jsonChunk, "speedUp") == 0) {
+            i = parse(tokens, i + 1, jsonChunk, &out->speedUp);
+        } else if (compare(tok, jsonChunk, "speedDown") == 0) {
+            i = parse(tokens, i + 1, jsonChunk, &out->speedDown);
+        } else if (compare(tok, jsonChunk, "compensation") == 0) {
+            i = parse(tokens, i + 1, jsonChunk, &out->compensation);
+        } else if (compare(tok, jsonChunk, "enabled") == 0) {
+            i = parse(tokens, i + 1, jsonChunk, &out->enabled);
+        } else {
+            slog.w << "Invalid AutoExposureOptions key: '" << STR(tok, jsonChunk) << "'" << io::endl;
+            i = parse(tokens, i + 1);
+        }
+        if (i < 0) {
+            slog.e << "Invalid AutoExposureOptions value: '" << STR(tok, jsonChunk) << "'" << io::endl;
+            return i;
+        }
+    }
+    return i;
+}
+
+std::ostream& operator<<(std::ostream& out, const AutoExposureOptions& in) {
+    return out << "{\n"
+        << "\"minLogLuminance\": " << (in.minLogLuminance) << ",\n"
+        << "\"maxLogLuminance\": " << (in.maxLogLuminance) << ",\n"
+        << "\"lowPercentile\": " << (in.lowPercentile) << ",\n"
+        << "\"highPercentile\": " << (in.highPercentile) << ",\n"
+        << "\"speedUp\": " << (in.speedUp) << ",\n"
+        << "\"speedDown\": " << (in.speedDown) << ",\n"
+        << "\"compensation\": " << (in.compensation) << ",\n"
+        << "\"enabled\": " << to_string(in.enabled) << "\n"
+        << "}";
+}
+
 int parse(jsmntok_t const* tokens, int i, const char* jsonChunk, RenderQuality* out) {
     CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
     int size = tokens[i++].size;
@@ -794,6 +844,8 @@ int parse(jsmntok_t const* tokens, int i, const char* jsonChunk, ScreenSpaceRefl
             i = parse(tokens, i + 1, jsonChunk, &out->maxDistance);
         } else if (compare(tok, jsonChunk, "stride") == 0) {
             i = parse(tokens, i + 1, jsonChunk, &out->stride);
+        } else if (compare(tok, jsonChunk, "resolution") == 0) {
+            i = parse(tokens, i + 1, jsonChunk, &out->resolution);
         } else if (compare(tok, jsonChunk, "enabled") == 0) {
             i = parse(tokens, i + 1, jsonChunk, &out->enabled);
         } else {
@@ -814,6 +866,7 @@ std::ostream& operator<<(std::ostream& out, const ScreenSpaceReflectionsOptions&
         << "\"bias\": " << (in.bias) << ",\n"
         << "\"maxDistance\": " << (in.maxDistance) << ",\n"
         << "\"stride\": " << (in.stride) << ",\n"
+        << "\"resolution\": " << (in.resolution) << ",\n"
         << "\"enabled\": " << to_string(in.enabled) << "\n"
         << "}";
 }
@@ -57,6 +57,9 @@ std::ostream& operator<<(std::ostream& out, const DepthOfFieldOptions& in);
 int parse(jsmntok_t const* tokens, int i, const char* jsonChunk, VignetteOptions* out);
 std::ostream& operator<<(std::ostream& out, const VignetteOptions& in);
 
+int parse(jsmntok_t const* tokens, int i, const char* jsonChunk, AutoExposureOptions* out);
+std::ostream& operator<<(std::ostream& out, const AutoExposureOptions& in);
+
 int parse(jsmntok_t const* tokens, int i, const char* jsonChunk, RenderQuality* out);
 std::ostream& operator<<(std::ostream& out, const RenderQuality& in);
 
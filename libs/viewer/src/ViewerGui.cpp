@@ -794,6 +794,7 @@ void ViewerGui::updateUserInterface() {
         int quality = (int) mSettings.view.bloom.quality;
         ImGui::SliderInt("Bloom Quality", &quality, 0, 3);
         mSettings.view.bloom.quality = (View::QualityLevel) quality;
+        ImGui::Checkbox("Quarter resolution", &mSettings.view.bloom.quarterResolution);
 
         ImGui::Checkbox("Lens Flare", &mSettings.view.bloom.lensFlare);
     }
@@ -863,6 +864,9 @@ void ViewerGui::updateUserInterface() {
         ImGui::SliderFloat("Bias", &ssrefl.bias, 0.001f, 0.5f);
         ImGui::SliderFloat("Max distance", &ssrefl.maxDistance, 0.1, 10.0f);
         ImGui::SliderFloat("Stride", &ssrefl.stride, 1.0, 10.0f);
+        bool halfRes = ssrefl.resolution < 1.0f;
+        ImGui::Checkbox("Half resolution##ssrefl", &halfRes);
+        ssrefl.resolution = halfRes ? 0.5f : 1.0f;
     }
 
     if (ImGui::CollapsingHeader("Dynamic Resolution")) {
@@ -1066,6 +1070,16 @@ void ViewerGui::updateUserInterface() {
             ImGui::ColorEdit3("Color##vignetteColor", &mSettings.view.vignette.color.r);
         }
 
+        if (ImGui::CollapsingHeader("Auto Exposure")) {
+            auto& autoExposure = mSettings.view.autoExposure;
+            ImGui::Checkbox("Enabled##autoExposureEnabled", &autoExposure.enabled);
+            ImGui::SliderFloat("Compensation (EV)", &autoExposure.compensation, -4.0f, 4.0f);
+            ImGui::SliderFloat("Low percentile", &autoExposure.lowPercentile, 0.0f, 1.0f);
+            ImGui::SliderFloat("High percentile", &autoExposure.highPercentile, 0.0f, 1.0f);
+            ImGui::SliderFloat("Speed up", &autoExposure.speedUp, 0.0f, 10.0f);
+            ImGui::SliderFloat("Speed down", &autoExposure.speedDown, 0.0f, 10.0f);
+        }
+
         // We do not yet support camera selection in the remote UI. To support this feature, we
         // would need to send a message from DebugServer to the WebSockets client.
         if (!isRemoteMode()) {
@@ -15,6 +15,7 @@
  */
 
 #include <viewer/AutomationSpec.h>
+#include <viewer/QualityScaler.h>
 #include <viewer/Settings.h>
 
 #include <gtest/gtest.h>
@@ -135,6 +136,12 @@ static const char* JSON_TEST_DEFAULTS = R"TXT(
             "feather": 0.5,
             "color": [0, 0, 0, 1]
         },
+        "autoExposure": {
+            "enabled": false,
+            "compensation": 0.0,
+            "speedUp": 3.0,
+            "speedDown": 1.0
+        },
         "dithering": "TEMPORAL",
         "renderQuality": {
             "hdrColorBuffer": "HIGH"
@@ -217,6 +224,63 @@ TEST_F(ViewSettingsTest, CustomAutomationSpec) {
     delete spec;
 }
 
+static filament::Renderer::FrameInfo makeFrameInfo(float frameTimeMs, float ssaoMs, float bloomMs) {
+    filament::Renderer::FrameInfo info{};
+    info.frameTime = int64_t(frameTimeMs * 1e6f);
+    info.passTimingCount = 2;
+    info.passTimings[0] = { "SSAO Pass", int64_t(ssaoMs * 1e6f) };
+    info.passTimings[1] = { "Bloom Upsample", int64_t(bloomMs * 1e6f) };
+    return info;
+}
+
+TEST(QualityScalerTest, LowersMostExpensiveFeatureAndRestoresIt) {
+    QualityScaler scaler({ .targetFrameTime = 16.0f, .hysteresis = 0.1f,
+            .cooldownFrames = 2, .smoothing = 1.0f });
+    ViewSettings view;
+    LightSettings light;
+    view.ssao.enabled = true;
+    view.ssao.resolution = 1.0f;
+    view.bloom.enabled = true;
+    scaler.apply(&view, &light);
+
+    // over budget, SSAO is the most expensive
+    EXPECT_FALSE(scaler.update(makeFrameInfo(20.0f, 6.0f, 2.0f)));
+    EXPECT_TRUE(scaler.update(makeFrameInfo(20.0f, 6.0f, 2.0f)));
+    EXPECT_EQ(scaler.getLevel(QualityScaler::Feature::SSAO), 1);
+    EXPECT_EQ(scaler.getLevel(QualityScaler::Feature::BLOOM), 0);
+
+    ViewSettings applied = view;
+    LightSettings appliedLight = light;
+    scaler.apply(&applied, &appliedLight);
+    EXPECT_TRUE(applied.ssao.enabled);
+    EXPECT_EQ(applied.ssao.resolution, 0.5f);
+
+    // within budget but not enough headroom to pay for SSAO again
+    EXPECT_FALSE(scaler.update(makeFrameInfo(12.0f, 2.0f, 2.0f)));
+    EXPECT_FALSE(scaler.update(makeFrameInfo(12.0f, 2.0f, 2.0f)));
+    EXPECT_EQ(scaler.getLevel(QualityScaler::Feature::SSAO), 1);
+
+    // enough headroom, the cooldown has already elapsed
+    EXPECT_TRUE(scaler.update(makeFrameInfo(8.0f, 2.0f, 2.0f)));
+    EXPECT_EQ(scaler.getLevel(QualityScaler::Feature::SSAO), 0);
+}
+
+TEST(QualityScalerTest, CallbackCanVeto) {
+    QualityScaler scaler({ .targetFrameTime = 16.0f, .cooldownFrames = 1, .smoothing = 1.0f });
+    scaler.setCallback([](QualityScaler::Feature feature, uint8_t, uint8_t) {
+        return feature != QualityScaler::Feature::SSAO;
+    });
+    ViewSettings view;
+    LightSettings light;
+    view.ssao.enabled = true;
+    view.bloom.enabled = true;
+    scaler.apply(&view, &light);
+
+    EXPECT_TRUE(scaler.update(makeFrameInfo(20.0f, 6.0f, 2.0f)));
+    EXPECT_EQ(scaler.getLevel(QualityScaler::Feature::SSAO), 0);
+    EXPECT_EQ(scaler.getLevel(QualityScaler::Feature::BLOOM), 1);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filament/Camera.h>
+#include <filament/Color.h>
+#include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/InstanceBuffer.h>
+#include <filament/LightManager.h>
+#include <filament/Material.h>
+#include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
+#include <filament/Scene.h>
+#include <filament/Skybox.h>
+#include <filament/Texture.h>
+#include <filament/TextureSampler.h>
+#include <filament/TransformManager.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
+
+#include <utils/EntityManager.h>
+
+#include <filamentapp/Config.h>
+#include <filamentapp/FilamentApp.h>
+
+#define STB_PERLIN_IMPLEMENTATION
+#include <stb_perlin.h>
+
+#include <math/mat4.h>
+#include <math/norm.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include "generated/resources/resources.h"
+
+using namespace filament;
+using namespace filament::math;
+
+using utils::Entity;
+using utils::EntityManager;
+
+using AttributeType = VertexBuffer::AttributeType;
+
+// Renders a large terrain with geometry clipmaps: a set of nested square levels centered on the
+// camera, each one twice as coarse as the previous one. All levels are drawn with the same small
+// grid block, instanced with an InstanceBuffer, and the clipmapTerrain material displaces it with
+// heights sampled from a texture array, one layer per level. As the camera moves, only the rows
+// and columns of heights that scroll into view are uploaded. The vertex cost is the same
+// regardless of the size of the terrain.
+
+static constexpr int CELLS_PER_BLOCK = 32;          // grid block, in cells
+static constexpr int LEVEL_COUNT = 5;
+static constexpr float BASE_SPACING = 1.0f;         // size of a cell of the finest level [m]
+static constexpr float HEIGHT_SCALE = 60.0f;        // [m]
+
+// each level is a 4x4 arrangement of blocks, the finer levels fill the center 2x2 blocks of the
+// coarser ones.
+static constexpr int CELLS_PER_LEVEL = 4 * CELLS_PER_BLOCK;
+static constexpr uint32_t BLOCK_COUNT = 16 + 12 * (LEVEL_COUNT - 1);
+
+// heights of a level cover its vertices plus a border of one texel for the normals
+static constexpr int TEXTURE_SIZE = CELLS_PER_LEVEL + 3;
+
+struct Level {
+    int2 origin;            // lattice coordinates of the first vertex, in units of the level
+    int2 uploaded;          // origin of the heights currently in the texture
+    bool valid = false;
+};
+
+struct App {
+    VertexBuffer* vb;
+    IndexBuffer* ib;
+    InstanceBuffer* instances;
+    Texture* heights;
+    Material* mat;
+    MaterialInstance* matInstance;
+    Skybox* skybox;
+    Entity renderable;
+    Entity sun;
+    Level levels[LEVEL_COUNT];
+    int2 center = { std::numeric_limits<int>::max(), 0 };
+};
+
+struct Vertex {
+    float3 position;
+    short4 tangents;
+};
+
+static float terrainHeight(float x, float z) {
+    return stb_perlin_fbm_noise3(x * 0.004f, 0.0f, z * 0.004f, 2.0f, 0.5f, 6) * HEIGHT_SCALE;
+}
+
+static float spacing(int level) {
+    return BASE_SPACING * float(1 << level);
+}
+
+static int wrap(int v) {
+    return ((v % TEXTURE_SIZE) + TEXTURE_SIZE) % TEXTURE_SIZE;
+}
+
+// Uploads the heights of the lattice region [x0, x0 + width) x [z0, z0 + height) of a level.
+// The texture is addressed toroidally, so the region is split where it wraps around.
+static void uploadRegion(Engine& engine, Texture* texture, int level,
+        int x0, int z0, int width, int height) {
+    for (int z = z0; z < z0 + height;) {
+        int const tz = wrap(z);
+        int const h = std::min(z0 + height - z, TEXTURE_SIZE - tz);
+        for (int x = x0; x < x0 + width;) {
+            int const tx = wrap(x);
+            int const w = std::min(x0 + width - x, TEXTURE_SIZE - tx);
+
+            size_t const size = size_t(w) * h * sizeof(float);
+            float* const data = (float*)malloc(size);
+            float const s = spacing(level);
+            for (int j = 0; j < h; j++) {
+                for (int i = 0; i < w; i++) {
+                    data[j * w + i] = terrainHeight(float(x + i) * s, float(z + j) * s);
+                }
+            }
+            texture->setImage(engine, 0, tx, tz, level, w, h, 1,
+                    Texture::PixelBufferDescriptor(data, size,
+                            Texture::Format::R, Texture::Type::FLOAT,
+                            [](void* buffer, size_t, void*) { free(buffer); }));
+            x += w;
+        }
+        z += h;
+    }
+}
+
+// Uploads the heights that scrolled into a level since the last update.
+static void updateLevel(Engine& engine, Texture* texture, int level, Level& state) {
+    int2 const first = state.origin - 1;
+    if (state.valid && state.uploaded == state.origin) {
+        return;
+    }
+    int2 const delta = state.origin - state.uploaded;
+    if (!state.valid || std::abs(delta.x) >= TEXTURE_SIZE || std::abs(delta.y) >= TEXTURE_SIZE) {
+        uploadRegion(engine, texture, level, first.x, first.y, TEXTURE_SIZE, TEXTURE_SIZE);
+    } else {
+        int2 const previous = state.uploaded - 1;
+        if (delta.x > 0) {
+            uploadRegion(engine, texture, level, previous.x + TEXTURE_SIZE, first.y,
+                    delta.x, TEXTURE_SIZE);
+        } else if (delta.x < 0) {
+            uploadRegion(engine, texture, level, first.x, first.y, -delta.x, TEXTURE_SIZE);
+        }
+        if (delta.y > 0) {
+            uploadRegion(engine, texture, level, first.x, previous.y + TEXTURE_SIZE,
+                    TEXTURE_SIZE, delta.y);
+        } else if (delta.y < 0) {
+            uploadRegion(engine, texture, level, first.x, first.y, TEXTURE_SIZE, -delta.y);
+        }
+    }
+    state.uploaded = state.origin;
+    state.valid = true;
+}
+
+// Recenters the clipmap on the camera. All levels share the same center, snapped to the lattice
+// of the coarsest level, so that each level exactly fills the hole of the next coarser one.
+static void update(App& app, Engine& engine, float3 const& eye) {
+    constexpr int top = LEVEL_COUNT - 1;
+    int2 const center = int2(floor(float2{ eye.x, eye.z } / spacing(top) + 0.5f));
+    if (center == app.center) {
+        return;
+    }
+    app.center = center;
+
+    app.levels[top].origin = center - CELLS_PER_LEVEL / 2;
+    for (int level = top; level > 0; level--) {
+        app.levels[level - 1].origin = (app.levels[level].origin + CELLS_PER_BLOCK) * 2;
+    }
+
+    mat4f transforms[BLOCK_COUNT];
+    uint32_t count = 0;
+    for (int level = 0; level < LEVEL_COUNT; level++) {
+        float const s = spacing(level);
+        for (int bz = 0; bz < 4; bz++) {
+            for (int bx = 0; bx < 4; bx++) {
+                bool const inner = bx == 1 || bx == 2;
+                if (level > 0 && inner && (bz == 1 || bz == 2)) {
+                    continue;   // covered by the finer level
+                }
+                int2 const origin = app.levels[level].origin + int2{ bx, bz } * CELLS_PER_BLOCK;
+                transforms[count++] =
+                        mat4f::translation(float3{ float(origin.x) * s, 0, float(origin.y) * s }) *
+                        mat4f::scaling(float3{ s, 1, s });
+            }
+        }
+        updateLevel(engine, app.heights, level, app.levels[level]);
+    }
+    app.instances->setLocalTransforms(transforms, count);
+
+    app.matInstance->setParameter("center", float2(center) * spacing(top));
+}
+
+static void setup(App& app, Engine* engine, View* view, Scene* scene) {
+    // A single grid block shared by all the instances, in cells. Its normal points up.
+    constexpr int N = CELLS_PER_BLOCK + 1;
+    static std::vector<Vertex> vertices(N * N);
+    static std::vector<uint16_t> indices(CELLS_PER_BLOCK * CELLS_PER_BLOCK * 6);
+    const short4 up = packSnorm16(float4{ -float(M_SQRT1_2), 0, 0, float(M_SQRT1_2) });
+    for (int z = 0; z < N; z++) {
+        for (int x = 0; x < N; x++) {
+            vertices[z * N + x] = { float3{ x, 0, z }, up };
+        }
+    }
+    uint16_t* p = indices.data();
+    for (int z = 0; z < CELLS_PER_BLOCK; z++) {
+        for (int x = 0; x < CELLS_PER_BLOCK; x++) {
+            uint16_t const q = uint16_t(z * N + x);
+            p[0] = q;     p[1] = q + N;     p[2] = q + 1;
+            p[3] = q + 1; p[4] = q + N;     p[5] = q + N + 1;
+            p += 6;
+        }
+    }
+
+    app.vb = VertexBuffer::Builder()
+            .vertexCount(vertices.size())
+            .bufferCount(1)
+            .attribute(VertexAttribute::POSITION, 0, AttributeType::FLOAT3, 0, sizeof(Vertex))
+            .attribute(VertexAttribute::TANGENTS, 0, AttributeType::SHORT4,
+                    offsetof(Vertex, tangents), sizeof(Vertex))
+            .normalized(VertexAttribute::TANGENTS)
+            .build(*engine);
+
+    app.vb->setBufferAt(*engine, 0, VertexBuffer::BufferDescriptor(
+            vertices.data(), vertices.size() * sizeof(Vertex), nullptr));
+
+    app.ib = IndexBuffer::Builder()
+            .indexCount(indices.size())
+            .bufferType(IndexBuffer::IndexType::USHORT)
+            .build(*engine);
+
+    app.ib->setBuffer(*engine, IndexBuffer::BufferDescriptor(
+            indices.data(), indices.size() * sizeof(uint16_t), nullptr));
+
+    app.heights = Texture::Builder()
+            .width(TEXTURE_SIZE)
+            .height(TEXTURE_SIZE)
+            .depth(LEVEL_COUNT)
+            .levels(1)
+            .sampler(Texture::Sampler::SAMPLER_2D_ARRAY)
+            .format(Texture::InternalFormat::R32F)
+            .build(*engine);
+
+    app.mat = Material::Builder()
+            .package(RESOURCES_CLIPMAPTERRAIN_DATA, RESOURCES_CLIPMAPTERRAIN_SIZE)
+            .build(*engine);
+
+    // the heights are fetched per texel, R32F isn't always filterable
+    TextureSampler const sampler(TextureSampler::MinFilter::NEAREST,
+            TextureSampler::MagFilter::NEAREST);
+    app.matInstance = app.mat->createInstance();
+    app.matInstance->setParameter("heights", app.heights, sampler);
+    app.matInstance->setParameter("baseSpacing", BASE_SPACING);
+    app.matInstance->setParameter("cellsPerBlock", float(CELLS_PER_BLOCK));
+    app.matInstance->setParameter("levelCount", float(LEVEL_COUNT));
+    app.matInstance->setParameter("textureSize", float(TEXTURE_SIZE));
+
+    // The instances are culled individually, with the bounds of a block before its transform
+    // (which doesn't scale y).
+    app.instances = InstanceBuffer::Builder(BLOCK_COUNT)
+            .instanceBoundingBox(Box().set(
+                    float3{ 0, -HEIGHT_SCALE, 0 },
+                    float3{ CELLS_PER_BLOCK, HEIGHT_SCALE, CELLS_PER_BLOCK }))
+            .build(*engine);
+
+    app.renderable = EntityManager::get().create();
+    RenderableManager::Builder(1)
+            .boundingBox({{ -1e5f, -HEIGHT_SCALE, -1e5f }, { 1e5f, HEIGHT_SCALE, 1e5f }})
+            .material(0, app.matInstance)
+            .geometry(0, RenderableManager::PrimitiveType::TRIANGLES, app.vb, app.ib)
+            .instances(BLOCK_COUNT, app.instances)
+            .receiveShadows(true)
+            .castShadows(false)
+            .build(*engine, app.renderable);
+    scene->addEntity(app.renderable);
+
+    // the camera starts at the origin, move the terrain a little below it
+    auto& tcm = engine->getTransformManager();
+    tcm.setTransform(tcm.getInstance(app.renderable),
+            mat4f::translation(float3{ 0, -terrainHeight(0, 0) - 10.0f, 0 }));
+
+    app.sun = EntityManager::get().create();
+    LightManager::Builder(LightManager::Type::SUN)
+            .color(Color::toLinear<ACCURATE>(sRGBColor(0.98f, 0.92f, 0.89f)))
+            .intensity(110000)
+            .direction({ 0.6, -0.5, -0.6 })
+            .castShadows(false)
+            .build(*engine, app.sun);
+    scene->addEntity(app.sun);
+
+    app.skybox = Skybox::Builder().color({ 0.45, 0.6, 0.8, 1.0 }).build(*engine);
+    scene->setSkybox(app.skybox);
+
+    update(app, *engine, view->getCamera().getPosition());
+}
+
+static void cleanup(App& app, Engine* engine) {
+    engine->destroy(app.skybox);
+    engine->destroy(app.sun);
+    engine->destroy(app.renderable);
+    engine->destroy(app.matInstance);
+    engine->destroy(app.mat);
+    engine->destroy(app.heights);
+    engine->destroy(app.instances);
+    engine->destroy(app.vb);
+    engine->destroy(app.ib);
+    EntityManager::get().destroy(app.sun);
+    EntityManager::get().destroy(app.renderable);
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    config.title = "clipmap_terrain";
+    config.cameraMode = camutils::Mode::FREE_FLIGHT;
+
+    App app;
+    FilamentApp::get().setCameraNearFar(0.5f, 5000.0f);
+    FilamentApp::get().animate([&app](Engine* engine, View* view, double) {
+        update(app, *engine, view->getCamera().getPosition());
+    });
+    FilamentApp::get().run(config,
+            [&app](Engine* engine, View* view, Scene* scene) { setup(app, engine, view, scene); },
+            [&app](Engine* engine, View*, Scene*) { cleanup(app, engine); });
+
+    return 0;
+}
@@ -136,6 +136,7 @@ struct App {
     std::string messageBoxText;
     std::string settingsFile;
     std::string batchFile;
+    int benchmarkFrameCount = 0;
 
     AutomationSpec* automationSpec = nullptr;
     AutomationEngine* automationEngine = nullptr;
@@ -173,6 +174,9 @@ static void printUsage(char* name) {
         "       Start automation using the given JSON spec, then quit the app\n\n"
         "   --headless, -e\n"
         "       Use a headless swapchain; ignored if --batch is not present\n\n"
+        "   --benchmark=<frame count>, -k <frame count>\n"
+        "       Measure each test of --batch over the given number of frames instead of\n"
+        "       taking screenshots, then write benchmark.json and benchmark.csv\n\n"
         "   --ibl=<path>, -i <path>\n"
         "       Override the built-in IBL\n"
         "       path can either be a directory containing IBL data files generated by cmgen,\n"
@@ -216,13 +220,14 @@ static std::ifstream::pos_type getFileSize(const char* filename) {
 }
 
 static int handleCommandLineArguments(int argc, char* argv[], App* app) {
-    static constexpr const char* OPTSTR = "ha:f:i:usc:rt:b:evg:";
+    static constexpr const char* OPTSTR = "ha:f:i:usc:rt:b:ek:vg:";
     static const struct option OPTIONS[] = {
         { "help",            no_argument,          nullptr, 'h' },
         { "api",             required_argument,    nullptr, 'a' },
         { "feature-level",   required_argument,    nullptr, 'f' },
         { "batch",           required_argument,    nullptr, 'b' },
         { "headless",        no_argument,          nullptr, 'e' },
+        { "benchmark",       required_argument,    nullptr, 'k' },
         { "ibl",             required_argument,    nullptr, 'i' },
         { "ubershader",      no_argument,          nullptr, 'u' },
         { "actual-size",     no_argument,          nullptr, 's' },
@@ -309,6 +314,14 @@ static int handleCommandLineArguments(int argc, char* argv[], App* app) {
                 app->batchFile = arg;
                 break;
             }
+            case 'k': {
+                try {
+                    app->benchmarkFrameCount = std::stoi(arg);
+                } catch (std::exception const&) {
+                    std::cerr << "Invalid frame count for --benchmark: " << arg << std::endl;
+                }
+                break;
+            }
             case 'v': {
                 app->config.splitView = true;
                 break;
@@ -319,6 +332,10 @@ static int handleCommandLineArguments(int argc, char* argv[], App* app) {
             }
         }
     }
+    if (app->benchmarkFrameCount > 0 && app->batchFile.empty()) {
+        std::cerr << "--benchmark is allowed only when --batch is present." << std::endl;
+        app->benchmarkFrameCount = 0;
+    }
     if (app->config.headless && app->batchFile.empty()) {
         std::cerr << "--headless is allowed only when --batch is present." << std::endl;
         app->config.headless = false;
@@ -762,6 +779,13 @@ int main(int argc, char** argv) {
             options.sleepDuration = 0.0;
             options.exportScreenshots = true;
             options.exportSettings = true;
+            if (app.benchmarkFrameCount > 0) {
+                // readbacks would skew the timings, and the warm-up must cover the latency of
+                // the GPU timings
+                options.exportScreenshots = false;
+                options.minFrameCount = std::max(options.minFrameCount, 10);
+                options.benchmarkFrameCount = app.benchmarkFrameCount;
+            }
             app.automationEngine->setOptions(options);
             app.viewer->stopAnimation();
         }
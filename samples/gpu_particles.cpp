@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filament/Color.h>
+#include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/LightManager.h>
+#include <filament/Material.h>
+#include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
+#include <filament/Scene.h>
+#include <filament/Skybox.h>
+#include <filament/TransformManager.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
+
+#include <utils/EntityManager.h>
+
+#include <filamentapp/Config.h>
+#include <filamentapp/FilamentApp.h>
+
+#include <math/norm.h>
+
+#include <cmath>
+#include <vector>
+
+#include "generated/resources/resources.h"
+
+using namespace filament;
+using namespace filament::math;
+
+using utils::Entity;
+using utils::EntityManager;
+
+using AttributeType = VertexBuffer::AttributeType;
+
+// Renders many particles without any per-frame CPU work: the vertex buffer is uploaded once,
+// and the gpuParticles material computes every particle's position from the time and a per
+// particle seed. This replaces simulating particles on the CPU and calling setBufferAt()
+// every frame.
+
+struct App {
+    VertexBuffer* vb;
+    IndexBuffer* ib;
+    Material* mat;
+    MaterialInstance* matInstance;
+    Skybox* skybox;
+    Entity renderable;
+    Entity light;
+};
+
+struct Vertex {
+    float4 position;    // xy: quad corner, z: particle seed
+    short4 tangents;    // identity tangent frame, the quad faces the camera
+};
+
+static constexpr uint32_t NUM_PARTICLES = 100000;
+
+static void setup(App& app, Engine* engine, View* view, Scene* scene) {
+    static std::vector<Vertex> vertices(NUM_PARTICLES * 4);
+    static std::vector<uint32_t> indices(NUM_PARTICLES * 6);
+
+    constexpr float2 kCorners[4] = { { -1, -1 }, { 1, -1 }, { -1, 1 }, { 1, 1 } };
+    const short4 identity = packSnorm16(float4{ 0, 0, 0, 1 });
+    for (uint32_t i = 0; i < NUM_PARTICLES; i++) {
+        const float seed = float(i) / float(NUM_PARTICLES);
+        for (uint32_t c = 0; c < 4; c++) {
+            vertices[i * 4 + c] = { float4{ kCorners[c], seed, 0 }, identity };
+        }
+        const uint32_t v = i * 4;
+        uint32_t* const p = indices.data() + i * 6;
+        p[0] = v; p[1] = v + 1; p[2] = v + 2;
+        p[3] = v + 2; p[4] = v + 1; p[5] = v + 3;
+    }
+
+    app.vb = VertexBuffer::Builder()
+            .vertexCount(vertices.size())
+            .bufferCount(1)
+            .attribute(VertexAttribute::POSITION, 0, AttributeType::FLOAT4, 0, sizeof(Vertex))
+            .attribute(VertexAttribute::TANGENTS, 0, AttributeType::SHORT4,
+                    offsetof(Vertex, tangents), sizeof(Vertex))
+            .normalized(VertexAttribute::TANGENTS)
+            .build(*engine);
+
+    app.vb->setBufferAt(*engine, 0, VertexBuffer::BufferDescriptor(
+            vertices.data(), vertices.size() * sizeof(Vertex), nullptr));
+
+    app.ib = IndexBuffer::Builder()
+            .indexCount(indices.size())
+            .bufferType(IndexBuffer::IndexType::UINT)
+            .build(*engine);
+
+    app.ib->setBuffer(*engine, IndexBuffer::BufferDescriptor(
+            indices.data(), indices.size() * sizeof(uint32_t), nullptr));
+
+    app.mat = Material::Builder()
+            .package(RESOURCES_GPUPARTICLES_DATA, RESOURCES_GPUPARTICLES_SIZE)
+            .build(*engine);
+
+    app.matInstance = app.mat->createInstance();
+    app.matInstance->setParameter("gravity", float3{ 0, -2, 0 });
+    app.matInstance->setParameter("speed", 3.0f);
+    app.matInstance->setParameter("spread", float(M_PI / 8));
+    app.matInstance->setParameter("lifetime", 3.0f);
+    app.matInstance->setParameter("size", 0.02f);
+    app.matInstance->setParameter("color", float4{ 1.0f, 0.6f, 0.2f, 0.8f });
+
+    // the particles move in the vertex shader, so their bounds aren't known to the culler
+    app.renderable = EntityManager::get().create();
+    RenderableManager::Builder(1)
+            .boundingBox({{ -4, -4, -4 }, { 4, 4, 4 }})
+            .material(0, app.matInstance)
+            .geometry(0, RenderableManager::PrimitiveType::TRIANGLES, app.vb, app.ib)
+            .culling(false)
+            .receiveShadows(false)
+            .castShadows(false)
+            .build(*engine, app.renderable);
+    scene->addEntity(app.renderable);
+
+    auto& tcm = engine->getTransformManager();
+    tcm.setTransform(tcm.getInstance(app.renderable), mat4f::translation(float3{ 0, -1, -4 }));
+
+    // the particles are lit like any other renderable, including by the froxelized lights
+    app.light = EntityManager::get().create();
+    LightManager::Builder(LightManager::Type::POINT)
+            .color(Color::toLinear<ACCURATE>(sRGBColor(0.98f, 0.92f, 0.89f)))
+            .intensity(2000.0f, LightManager::EFFICIENCY_LED)
+            .position({ 0.0f, 0.5f, -3.0f })
+            .falloff(4.0f)
+            .build(*engine, app.light);
+    scene->addEntity(app.light);
+
+    app.skybox = Skybox::Builder().color({ 0.02, 0.02, 0.05, 1.0 }).build(*engine);
+    scene->setSkybox(app.skybox);
+
+    view->setPostProcessingEnabled(true);
+}
+
+static void cleanup(App& app, Engine* engine) {
+    engine->destroy(app.skybox);
+    engine->destroy(app.light);
+    engine->destroy(app.renderable);
+    engine->destroy(app.matInstance);
+    engine->destroy(app.mat);
+    engine->destroy(app.vb);
+    engine->destroy(app.ib);
+    EntityManager::get().destroy(app.light);
+    EntityManager::get().destroy(app.renderable);
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    config.title = "gpu_particles";
+
+    App app;
+    FilamentApp::get().run(config,
+            [&app](Engine* engine, View* view, Scene* scene) { setup(app, engine, view, scene); },
+            [&app](Engine* engine, View*, Scene*) { cleanup(app, engine); });
+
+    return 0;
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filament/Box.h>
+#include <filament/Camera.h>
+#include <filament/Color.h>
+#include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/LightManager.h>
+#include <filament/Material.h>
+#include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
+#include <filament/Renderer.h>
+#include <filament/RenderTarget.h>
+#include <filament/Scene.h>
+#include <filament/Skybox.h>
+#include <filament/Texture.h>
+#include <filament/TextureSampler.h>
+#include <filament/TransformManager.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
+
+#include <filameshio/MeshReader.h>
+
+#include <filamentapp/Config.h>
+#include <filamentapp/FilamentApp.h>
+
+#include <utils/EntityManager.h>
+#include <utils/Path.h>
+
+#include <math/mat3.h>
+#include <math/mat4.h>
+#include <math/vec2.h>
+#include <math/vec3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "generated/resources/resources.h"
+#include "generated/resources/monkey.h"
+
+using namespace filament;
+using namespace filament::math;
+
+using utils::Entity;
+using utils::EntityManager;
+using utils::Path;
+
+// Renders a forest of monkey heads, where the distant ones are drawn as octahedral impostors.
+//
+// At startup, the mesh is rendered from FRAMES x FRAMES directions spread over the sphere by an
+// octahedral mapping, into the layers of two texture arrays: one for the base color and one for
+// the model-space normals. Each head is then a renderable with two levels of detail: the mesh, and
+// a single quad with the impostor material, which faces the eye and blends the four frames closest
+// to the view direction. The engine selects the level of each renderable from its projected size
+// during culling, and uses the same level in the shadow maps, so the distant heads cost two
+// triangles in every pass.
+//
+// Usage: impostors [projected size below which impostors are drawn, 0.1 by default]
+
+struct App {
+    Material* meshMaterial;
+    MaterialInstance* meshMatInstance;
+    Material* impostorMaterial;
+    MaterialInstance* impostorMatInstance;
+    Texture* baseColorAtlas;
+    Texture* normalAtlas;
+    VertexBuffer* quadVb;
+    IndexBuffer* quadIb;
+    filamesh::MeshReader::Mesh mesh;
+    Box bounds;
+    std::vector<Entity> heads;
+    Skybox* skybox;
+    Entity sun;
+    bool baked = false;
+};
+
+struct QuadVertex {
+    float3 position;
+    short4 tangents;
+};
+
+static constexpr uint32_t FRAMES = 12;
+static constexpr uint32_t FRAME_SIZE = 128;
+static constexpr uint32_t FOREST_SIZE = 48;
+static constexpr float3 BASE_COLOR = { 0.6f, 0.45f, 0.3f };
+static constexpr float ROUGHNESS = 0.6f;
+
+static float g_screenSize = 0.1f;
+
+// These must match the functions of the same name in impostor.mat. The octahedron has its poles
+// on the Y axis, so the upper hemisphere is the inner diamond of the atlas.
+static float3 octahedralDecode(float2 uv) {
+    float2 const p = uv * 2.0f - 1.0f;
+    float3 d = { p.x, 1.0f - std::abs(p.x) - std::abs(p.y), p.y };
+    if (d.y < 0.0f) {
+        float const x = d.x;
+        float const z = d.z;
+        d.x = (1.0f - std::abs(z)) * (x >= 0.0f ? 1.0f : -1.0f);
+        d.z = (1.0f - std::abs(x)) * (z >= 0.0f ? 1.0f : -1.0f);
+    }
+    return normalize(d);
+}
+
+static void frameBasis(float3 d, float3& right, float3& up) {
+    float3 const worldUp = std::abs(d.y) < 0.999f ? float3{ 0, 1, 0 } : float3{ 0, 0, 1 };
+    right = normalize(cross(worldUp, d));
+    up = cross(d, right);
+}
+
+static Texture* createAtlas(Engine& engine, Texture::InternalFormat format) {
+    return Texture::Builder()
+            .width(FRAME_SIZE)
+            .height(FRAME_SIZE)
+            .depth(FRAMES * FRAMES)
+            .levels(uint8_t(std::log2(FRAME_SIZE) + 1))
+            .sampler(Texture::Sampler::SAMPLER_2D_ARRAY)
+            .format(format)
+            // the blits are needed by generateMipmaps() on some backends
+            .usage(Texture::Usage::COLOR_ATTACHMENT | Texture::Usage::SAMPLEABLE |
+                    Texture::Usage::BLIT_SRC | Texture::Usage::BLIT_DST)
+            .build(engine);
+}
+
+// Renders the frames of the impostor into the atlases, with one orthographic view per frame
+// that tightly frames the bounding sphere of the mesh.
+static void bakeImpostor(App& app, Engine& engine, Renderer& renderer) {
+    auto& em = EntityManager::get();
+    auto& rcm = engine.getRenderableManager();
+    float3 const center = app.bounds.center;
+    float const radius = length(app.bounds.halfExtent);
+
+    Material* const material = Material::Builder()
+            .package(RESOURCES_IMPOSTORBAKE_DATA, RESOURCES_IMPOSTORBAKE_SIZE)
+            .build(engine);
+    MaterialInstance* const baseColorMi = material->createInstance();
+    baseColorMi->setParameter("baseColor", BASE_COLOR);
+    baseColorMi->setParameter("normals", false);
+    MaterialInstance* const normalMi = material->createInstance();
+    normalMi->setParameter("normals", true);
+
+    Entity const renderable = em.create();
+    RenderableManager::Builder(1)
+            .boundingBox(app.bounds)
+            .material(0, baseColorMi)
+            .geometry(0, RenderableManager::PrimitiveType::TRIANGLES,
+                    app.mesh.vertexBuffer, app.mesh.indexBuffer)
+            .culling(false)
+            .castShadows(false)
+            .receiveShadows(false)
+            .build(engine, renderable);
+    Scene* const scene = engine.createScene();
+    scene->addEntity(renderable);
+
+    Texture* const depth = Texture::Builder()
+            .width(FRAME_SIZE)
+            .height(FRAME_SIZE)
+            .levels(1)
+            .usage(Texture::Usage::DEPTH_ATTACHMENT)
+            .format(Texture::InternalFormat::DEPTH24)
+            .build(engine);
+
+    uint32_t const frameCount = FRAMES * FRAMES;
+    std::vector<View*> views(frameCount);
+    std::vector<Entity> cameras(frameCount);
+    std::vector<RenderTarget*> baseColorTargets(frameCount);
+    std::vector<RenderTarget*> normalTargets(frameCount);
+    for (uint32_t layer = 0; layer < frameCount; layer++) {
+        float2 const cell = { float(layer % FRAMES), float(layer / FRAMES) };
+        float3 const d = octahedralDecode((cell + 0.5f) / float(FRAMES));
+        float3 right;
+        float3 up;
+        frameBasis(d, right, up);
+
+        cameras[layer] = em.create();
+        Camera* const camera = engine.createCamera(cameras[layer]);
+        camera->setProjection(Camera::Projection::ORTHO,
+                -radius, radius, -radius, radius, radius, 3.0 * radius);
+        camera->setModelMatrix(mat4f{ mat3f{ right, up, d }, center + d * (2.0f * radius) });
+
+        baseColorTargets[layer] = RenderTarget::Builder()
+                .texture(RenderTarget::AttachmentPoint::COLOR, app.baseColorAtlas)
+                .layer(RenderTarget::AttachmentPoint::COLOR, layer)
+                .texture(RenderTarget::AttachmentPoint::DEPTH, depth)
+                .build(engine);
+        normalTargets[layer] = RenderTarget::Builder()
+                .texture(RenderTarget::AttachmentPoint::COLOR, app.normalAtlas)
+                .layer(RenderTarget::AttachmentPoint::COLOR, layer)
+                .texture(RenderTarget::AttachmentPoint::DEPTH, depth)
+                .build(engine);
+
+        // without post-processing, the views write the values of the bake material as they are
+        View* const view = views[layer] = engine.createView();
+        view->setScene(scene);
+        view->setCamera(camera);
+        view->setViewport({ 0, 0, FRAME_SIZE, FRAME_SIZE });
+        view->setPostProcessingEnabled(false);
+        view->setShadowingEnabled(false);
+        view->setRenderTarget(baseColorTargets[layer]);
+    }
+
+    // the background of the frames must be transparent, it's where the impostor is cut out
+    Renderer::ClearOptions const clearOptions = renderer.getClearOptions();
+    renderer.setClearOptions({ .clearColor = {}, .clear = true });
+    renderer.renderStandaloneViews(views.data(), views.size());
+    rcm.setMaterialInstanceAt(rcm.getInstance(renderable), 0, normalMi);
+    for (uint32_t layer = 0; layer < frameCount; layer++) {
+        views[layer]->setRenderTarget(normalTargets[layer]);
+    }
+    renderer.renderStandaloneViews(views.data(), views.size());
+    renderer.setClearOptions(clearOptions);
+
+    app.baseColorAtlas->generateMipmaps(engine);
+    app.normalAtlas->generateMipmaps(engine);
+
+    for (uint32_t layer = 0; layer < frameCount; layer++) {
+        engine.destroy(views[layer]);
+        engine.destroy(baseColorTargets[layer]);
+        engine.destroy(normalTargets[layer]);
+        engine.destroyCameraComponent(cameras[layer]);
+        em.destroy(cameras[layer]);
+    }
+    engine.destroy(depth);
+    engine.destroy(scene);
+    engine.destroy(renderable);
+    em.destroy(renderable);
+    engine.destroy(baseColorMi);
+    engine.destroy(normalMi);
+    engine.destroy(material);
+}
+
+static void setup(App& app, Engine* engine, View* view, Scene* scene) {
+    auto& em = EntityManager::get();
+    auto& rcm = engine->getRenderableManager();
+    auto& tcm = engine->getTransformManager();
+
+    app.meshMaterial = Material::Builder()
+            .package(RESOURCES_AIDEFAULTMAT_DATA, RESOURCES_AIDEFAULTMAT_SIZE)
+            .build(*engine);
+    app.meshMatInstance = app.meshMaterial->createInstance();
+    app.meshMatInstance->setParameter("baseColor", RgbType::LINEAR, BASE_COLOR);
+    app.meshMatInstance->setParameter("metallic", 0.0f);
+    app.meshMatInstance->setParameter("roughness", ROUGHNESS);
+    app.meshMatInstance->setParameter("reflectance", 0.5f);
+
+    // MeshReader creates a renderable, but the heads have two levels of detail, so we only keep
+    // its buffers and its bounds.
+    app.mesh = filamesh::MeshReader::loadMeshFromBuffer(engine, MONKEY_SUZANNE_DATA,
+            nullptr, nullptr, app.meshMatInstance);
+    app.bounds = rcm.getAxisAlignedBoundingBox(rcm.getInstance(app.mesh.renderable));
+    engine->destroy(app.mesh.renderable);
+    em.destroy(app.mesh.renderable);
+
+    // The frames are baked by the first preRender(), since renderStandaloneViews() can't be
+    // called in the middle of a frame.
+    app.baseColorAtlas = createAtlas(*engine, Texture::InternalFormat::SRGB8_A8);
+    app.normalAtlas = createAtlas(*engine, Texture::InternalFormat::RGBA8);
+
+    app.impostorMaterial = Material::Builder()
+            .package(RESOURCES_IMPOSTOR_DATA, RESOURCES_IMPOSTOR_SIZE)
+            .build(*engine);
+    TextureSampler const sampler(TextureSampler::MinFilter::LINEAR_MIPMAP_LINEAR,
+            TextureSampler::MagFilter::LINEAR);
+    app.impostorMatInstance = app.impostorMaterial->createInstance();
+    app.impostorMatInstance->setParameter("baseColorAtlas", app.baseColorAtlas, sampler);
+    app.impostorMatInstance->setParameter("normalAtlas", app.normalAtlas, sampler);
+    app.impostorMatInstance->setParameter("frames", float(FRAMES));
+    app.impostorMatInstance->setParameter("center", app.bounds.center);
+    app.impostorMatInstance->setParameter("radius", length(app.bounds.halfExtent));
+    app.impostorMatInstance->setParameter("roughness", ROUGHNESS);
+
+    // The impostor's quad is turned to face the eye by its material. Its identity tangent frame
+    // makes the model-space normals of the atlas usable as tangent-space normals.
+    static QuadVertex const quadVertices[4] = {
+            { { -1, -1, 0 }, { 0, 0, 0, 32767 } },
+            { {  1, -1, 0 }, { 0, 0, 0, 32767 } },
+            { { -1,  1, 0 }, { 0, 0, 0, 32767 } },
+            { {  1,  1, 0 }, { 0, 0, 0, 32767 } },
+    };
+    static uint16_t const quadIndices[6] = { 0, 1, 2, 3, 2, 1 };
+    app.quadVb = VertexBuffer::Builder()
+            .vertexCount(4)
+            .bufferCount(1)
+            .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::FLOAT3,
+                    offsetof(QuadVertex, position), sizeof(QuadVertex))
+            .attribute(VertexAttribute::TANGENTS, 0, VertexBuffer::AttributeType::SHORT4,
+                    offsetof(QuadVertex, tangents), sizeof(QuadVertex))
+            .normalized(VertexAttribute::TANGENTS)
+            .build(*engine);
+    app.quadVb->setBufferAt(*engine, 0,
+            VertexBuffer::BufferDescriptor(quadVertices, sizeof(quadVertices)));
+    app.quadIb = IndexBuffer::Builder()
+            .indexCount(6)
+            .bufferType(IndexBuffer::IndexType::USHORT)
+            .build(*engine);
+    app.quadIb->setBuffer(*engine,
+            IndexBuffer::BufferDescriptor(quadIndices, sizeof(quadIndices)));
+
+    // Each head is a renderable with the mesh as level 0 and the impostor as level 1.
+    float const spacing = 2.0f * std::max(app.bounds.halfExtent.x, app.bounds.halfExtent.z) + 1.0f;
+    app.heads.resize(FOREST_SIZE * FOREST_SIZE);
+    em.create(app.heads.size(), app.heads.data());
+    for (size_t i = 0; i < app.heads.size(); i++) {
+        RenderableManager::Builder(2)
+                .boundingBox(app.bounds)
+                .geometry(0, RenderableManager::PrimitiveType::TRIANGLES,
+                        app.mesh.vertexBuffer, app.mesh.indexBuffer)
+                .material(0, app.meshMatInstance)
+                .geometry(1, RenderableManager::PrimitiveType::TRIANGLES,
+                        app.quadVb, app.quadIb)
+                .material(1, app.impostorMatInstance)
+                .levelOfDetail(0, 1, 1.0f)
+                .levelOfDetail(1, 1, g_screenSize)
+                .castShadows(true)
+                .receiveShadows(true)
+                .build(*engine, app.heads[i]);
+
+        float const x = (float(i % FOREST_SIZE) - 0.5f * FOREST_SIZE) * spacing;
+        float const z = -float(i / FOREST_SIZE) * spacing;
+        float const angle = float(std::rand()) / float(RAND_MAX) * float(2.0 * M_PI);
+        float const scale = 0.8f + 0.4f * float(std::rand()) / float(RAND_MAX);
+        tcm.create(app.heads[i], {}, mat4f::translation(float3{ x, 0, z }) *
+                mat4f::rotation(angle, float3{ 0, 1, 0 }) * mat4f::scaling(scale));
+    }
+    scene->addEntities(app.heads.data(), app.heads.size());
+
+    app.sun = em.create();
+    LightManager::Builder(LightManager::Type::SUN)
+            .color(Color::toLinear<ACCURATE>(sRGBColor(0.98f, 0.92f, 0.89f)))
+            .intensity(110000)
+            .direction({ 0.6, -1.0, -0.8 })
+            .castShadows(true)
+            .build(*engine, app.sun);
+    scene->addEntity(app.sun);
+
+    app.skybox = Skybox::Builder().color({ 0.45, 0.6, 0.8, 1.0 }).build(*engine);
+    scene->setSkybox(app.skybox);
+
+    view->setPostProcessingEnabled(true);
+}
+
+static void cleanup(App& app, Engine* engine) {
+    auto& em = EntityManager::get();
+    for (Entity const head : app.heads) {
+        engine->destroy(head);
+    }
+    em.destroy(app.heads.size(), app.heads.data());
+    engine->destroy(app.skybox);
+    engine->destroy(app.sun);
+    em.destroy(app.sun);
+    engine->destroy(app.impostorMatInstance);
+    engine->destroy(app.impostorMaterial);
+    engine->destroy(app.meshMatInstance);
+    engine->destroy(app.meshMaterial);
+    engine->destroy(app.baseColorAtlas);
+    engine->destroy(app.normalAtlas);
+    engine->destroy(app.quadVb);
+    engine->destroy(app.quadIb);
+    engine->destroy(app.mesh.vertexBuffer);
+    engine->destroy(app.mesh.indexBuffer);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        g_screenSize = float(std::atof(argv[1]));
+        if (g_screenSize <= 0.0f || g_screenSize >= 1.0f) {
+            std::cerr << "Usage: " << Path(argv[0]).getName()
+                      << " [projected size below which impostors are drawn, in (0, 1)]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    Config config;
+    config.title = "impostors";
+
+    App app;
+    FilamentApp::get().setCameraNearFar(0.1f, 500.0f);
+    FilamentApp::get().run(config,
+            [&app](Engine* engine, View* view, Scene* scene) { setup(app, engine, view, scene); },
+            [&app](Engine* engine, View*, Scene*) { cleanup(app, engine); },
+            FilamentApp::ImGuiCallback(),
+            [&app](Engine* engine, View*, Scene*, Renderer* renderer) {
+                if (!app.baked) {
+                    bakeImpostor(app, *engine, *renderer);
+                    app.baked = true;
+                }
+            });
+
+    return 0;
+}
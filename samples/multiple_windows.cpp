@@ -35,10 +35,17 @@
 #include <utils/EntityManager.h>
 #include <utils/Panic.h>
 
+#include <getopt/getopt.h>
+
 #include <functional>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+#include <string.h>
+
 #include "generated/resources/resources.h"
 #include "generated/resources/monkey.h"
 
@@ -57,6 +64,45 @@ namespace {
     static constexpr math::float3 kCameraUp = {0.0f, 1.0f, 0.0f};
     static constexpr float kCameraDist = 3.0f;
 
+    // Program binaries shared by all the Engines, so that a program is only compiled by the
+    // first Engine that needs it and the others load its binary. Each backend calls these from
+    // its own threads.
+    class ProgramCache {
+    public:
+        void attach(Engine::Platform* platform) {
+            platform->setBlobFunc(
+                    [this](void const* key, size_t keySize, void const* value, size_t valueSize) {
+                        std::lock_guard const lock(mLock);
+                        auto const* const p = static_cast<uint8_t const*>(value);
+                        mBlobs[std::string(static_cast<char const*>(key), keySize)].assign(
+                                p, p + valueSize);
+                    },
+                    [this](void const* key, size_t keySize, void* value, size_t valueSize) {
+                        std::lock_guard const lock(mLock);
+                        auto const pos = mBlobs.find(
+                                std::string(static_cast<char const*>(key), keySize));
+                        if (pos == mBlobs.end()) {
+                            return size_t(0);
+                        }
+                        if (pos->second.size() <= valueSize) {
+                            memcpy(value, pos->second.data(), pos->second.size());
+                        }
+                        return pos->second.size();
+                    });
+        }
+
+    private:
+        std::mutex mLock;
+        std::unordered_map<std::string, std::vector<uint8_t>> mBlobs;
+    };
+
+    // Filament objects belong to the Engine that created them: windows rendered by the same
+    // Engine share its material, and each Engine builds its own.
+    struct Context {
+        Engine* engine = nullptr;
+        Material* material = nullptr;
+    };
+
     struct Window {
         std::function<void(Window&, double)> onNewFrame;
 
@@ -68,7 +114,7 @@ namespace {
         View* view = nullptr;
         Scene* scene = nullptr;
         IBL* ibl = nullptr;
-        Material* material = nullptr;
+        Context* context = nullptr;
         MaterialInstance* materialInstance = nullptr;
         filamesh::MeshReader::Mesh mesh;
 
@@ -87,10 +133,55 @@ void setup_animating_scene(Window& w, Engine* engine);
 void animation_new_frame(Window& w, double dt);
 IBL* load_IBL(const utils::Path& iblDirectory, Engine* engine);
 
+static void printUsage(char* name) {
+    std::string exec_name(utils::Path(name).getName());
+    std::string usage(
+            "MULTIPLE_WINDOWS renders two windows\n"
+            "Usage:\n"
+            "    MULTIPLE_WINDOWS [options]\n"
+            "Options:\n"
+            "   --help, -h\n"
+            "       Prints this message\n\n"
+            "   --engine-per-window, -e\n"
+            "       Render each window with its own Engine, the Engines share program binaries\n\n"
+    );
+    const std::string from("MULTIPLE_WINDOWS");
+    for (size_t pos = usage.find(from); pos != std::string::npos; pos = usage.find(from, pos)) {
+        usage.replace(pos, from.length(), exec_name);
+    }
+    std::cout << usage;
+}
+
+static bool handleCommandLineArguments(int argc, char* argv[]) {
+    static constexpr const char* OPTSTR = "he";
+    static const struct option OPTIONS[] = {
+            { "help",              no_argument, nullptr, 'h' },
+            { "engine-per-window", no_argument, nullptr, 'e' },
+            { nullptr, 0, nullptr, 0 }  // termination of the option list
+    };
+    bool enginePerWindow = false;
+    int opt;
+    int option_index = 0;
+    while ((opt = getopt_long(argc, argv, OPTSTR, OPTIONS, &option_index)) >= 0) {
+        switch (opt) {
+            default:
+            case 'h':
+                printUsage(argv[0]);
+                exit(0);
+            case 'e':
+                enginePerWindow = true;
+                break;
+        }
+    }
+    return enginePerWindow;
+}
+
 #ifdef __cplusplus
 extern "C"
 #endif
 int main(int argc, char *argv[]) {
+    bool const enginePerWindow = handleCommandLineArguments(argc, argv);
+
     // ---- initialize ----
     FILAMENT_CHECK_POSTCONDITION(SDL_Init(SDL_INIT_EVENTS) == 0) << "SDL_Init Failure";
 
@@ -111,13 +202,25 @@ int main(int argc, char *argv[]) {
     // Create SDL windows first, so that the Engine's context is current
     // if we are single-threaded. But we can't create the Filament objects
     // until after we have created the engine.
-    auto engine = Engine::create(kBackend);
+    ProgramCache programCache;
+    std::vector<Context> contexts(enginePerWindow ? windows.size() : 1);
+    for (auto& c : contexts) {
+        c.engine = Engine::create(kBackend);
+        if (enginePerWindow) {
+            // this must be done before the Engine compiles any program
+            programCache.attach(c.engine->getPlatform());
+        }
+        c.material = Material::Builder().package(RESOURCES_SANDBOXLIT_DATA,
+                                                 RESOURCES_SANDBOXLIT_SIZE)
+                                        .build(*c.engine);
+    }
 
-    for (auto &w : windows) {
-        setup_window(w, engine);
+    for (size_t i = 0; i < windows.size(); i++) {
+        windows[i].context = &contexts[enginePerWindow ? i : 0];
+        setup_window(windows[i], windows[i].context->engine);
     }
-    setup_animating_scene(windows[0], engine);
-    setup_static_scene(windows[1], engine);
+    setup_animating_scene(windows[0], windows[0].context->engine);
+    setup_static_scene(windows[1], windows[1].context->engine);
 
     // ---- event loop ----
     size_t nClosed = 0;
@@ -127,7 +230,9 @@ int main(int argc, char *argv[]) {
 
     while (nClosed < windows.size()) {
         if (!UTILS_HAS_THREADING) {
-            engine->execute();
+            for (auto const& c : contexts) {
+                c.engine->execute();
+            }
         }
 
         while (SDL_PollEvent(&event) != 0) {
@@ -140,7 +245,7 @@ int main(int argc, char *argv[]) {
                         case SDL_WINDOWEVENT_RESIZED:
                             for (auto &w : windows) {
                                 if (event.window.windowID == SDL_GetWindowID(w.sdl_window)) {
-                                    resize_window(w, engine);
+                                    resize_window(w, w.context->engine);
                                     break;
                                 }
                             }
@@ -189,10 +294,13 @@ int main(int argc, char *argv[]) {
 
     // ---- cleanup ----
     for (auto &w : windows) {
-        destroy_window(w, engine);
+        destroy_window(w, w.context->engine);
     }
 
-    Engine::destroy(&engine);
+    for (auto& c : contexts) {
+        c.engine->destroy(c.material);
+        Engine::destroy(&c.engine);
+    }
 
     SDL_Quit();
     return 0;
@@ -237,7 +345,6 @@ void destroy_window(Window& w, Engine* engine) {
 
     engine->destroy(w.mesh.renderable);
     engine->destroy(w.materialInstance);
-    engine->destroy(w.material);
     w.view->setScene(nullptr);
     engine->destroy(w.scene);
     engine->destroy(w.view);
@@ -281,10 +388,7 @@ void setup_static_scene(Window& w, Engine* engine) {
         w.scene->setSkybox(w.ibl->getSkybox());
     }
 
-    w.material = Material::Builder().package(RESOURCES_SANDBOXLIT_DATA,
-                                             RESOURCES_SANDBOXLIT_SIZE)
-                                    .build(*engine);
-    w.materialInstance = w.material->createInstance();
+    w.materialInstance = w.context->material->createInstance();
     w.materialInstance->setParameter("baseColor", RgbType::sRGB,
                                      {0.50f, 0.90f, 0.80f});
     w.materialInstance->setParameter("roughness", 0.90f);
@@ -314,10 +418,7 @@ void setup_animating_scene(Window& w, Engine* engine) {
         w.scene->setSkybox(w.ibl->getSkybox());
     }
 
-    w.material = Material::Builder().package(RESOURCES_SANDBOXLIT_DATA,
-                                             RESOURCES_SANDBOXLIT_SIZE)
-                                    .build(*engine);
-    w.materialInstance = w.material->createInstance();
+    w.materialInstance = w.context->material->createInstance();
     w.materialInstance->setParameter("baseColor", RgbType::sRGB,
                                      {1.00f, 0.85f, 0.57f});
     w.materialInstance->setParameter("roughness", 0.40f);
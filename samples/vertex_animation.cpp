@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filament/Box.h>
+#include <filament/Color.h>
+#include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/InstanceBuffer.h>
+#include <filament/LightManager.h>
+#include <filament/Material.h>
+#include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
+#include <filament/Scene.h>
+#include <filament/Skybox.h>
+#include <filament/Texture.h>
+#include <filament/TextureSampler.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
+
+#include <filameshio/MeshReader.h>
+
+#include <filamentapp/Config.h>
+#include <filamentapp/FilamentApp.h>
+
+#include <image/Ktx1Bundle.h>
+
+#include <ktxreader/Ktx1Reader.h>
+
+#include <utils/EntityManager.h>
+#include <utils/Path.h>
+
+#include <math/mat4.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "generated/resources/resources.h"
+
+using namespace filament;
+using namespace filament::math;
+
+using utils::Entity;
+using utils::EntityManager;
+using utils::Path;
+
+// Plays a crowd baked by vatbaker. Every character is an instance of a single renderable, and
+// the vertexAnimation material reads the pose of each vertex from the vertex animation texture.
+// The clip of each instance is set once at startup, so the crowd is animated without any bones
+// or CPU work per frame.
+//
+// Usage: vertex_animation <output of vatbaker, without extension>
+
+struct App {
+    Texture* vertices;
+    Texture* clips;
+    Material* mat;
+    MaterialInstance* matInstance;
+    InstanceBuffer* instances;
+    filamesh::MeshReader::Mesh mesh;
+    Skybox* skybox;
+    Entity renderable;
+    Entity sun;
+};
+
+// what vatbaker stores in the KTX metadata
+struct Layout {
+    uint32_t frameCount = 0;
+    uint32_t rowsPerFrame = 0;
+    float fps = 0;
+    float3 boundsMin;
+    float3 boundsMax;
+    std::vector<uint2> clips; // first frame, frame count
+};
+
+static constexpr uint32_t CROWD_SIZE = 32;
+static constexpr uint32_t INSTANCE_COUNT = CROWD_SIZE * CROWD_SIZE;
+
+static std::string g_basePath;
+
+static std::vector<uint8_t> readFile(std::string const& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Unable to open " << path << std::endl;
+        exit(1);
+    }
+    return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+}
+
+static Layout readLayout(image::Ktx1Bundle const& ktx) {
+    auto const get = [&ktx](char const* key) {
+        char const* value = ktx.getMetadata(key);
+        if (!value) {
+            std::cerr << "Missing " << key << ", the texture wasn't baked by vatbaker" << std::endl;
+            exit(1);
+        }
+        return std::istringstream(value);
+    };
+    Layout layout;
+    get("vat.frameCount") >> layout.frameCount;
+    get("vat.rowsPerFrame") >> layout.rowsPerFrame;
+    get("vat.fps") >> layout.fps;
+    auto min = get("vat.boundsMin");
+    min >> layout.boundsMin.x >> layout.boundsMin.y >> layout.boundsMin.z;
+    auto max = get("vat.boundsMax");
+    max >> layout.boundsMax.x >> layout.boundsMax.y >> layout.boundsMax.z;
+    auto clips = get("vat.clips");
+    for (std::string line; std::getline(clips, line);) {
+        uint2 clip;
+        if (std::istringstream(line) >> clip.x >> clip.y) {
+            layout.clips.push_back(clip);
+        }
+    }
+    return layout;
+}
+
+static void setup(App& app, Engine* engine, View* view, Scene* scene) {
+    std::vector<uint8_t> const ktxData = readFile(g_basePath + ".ktx");
+    auto* const ktx = new image::Ktx1Bundle(ktxData.data(), uint32_t(ktxData.size()));
+    Layout const layout = readLayout(*ktx);
+    // this takes ownership of the bundle
+    app.vertices = ktxreader::Ktx1Reader::createTexture(engine, ktx, false);
+
+    // Each instance plays a clip from a random time and at a slightly different speed, this is
+    // the only per-instance animation data.
+    static std::vector<float4> clips(INSTANCE_COUNT);
+    for (uint32_t i = 0; i < INSTANCE_COUNT; i++) {
+        uint2 const clip = layout.clips[i % layout.clips.size()];
+        float const start = -float(std::rand()) / float(RAND_MAX) * 10.0f;
+        float const speed = 0.8f + 0.4f * float(std::rand()) / float(RAND_MAX);
+        clips[i] = { float(clip.x), float(clip.y), start, layout.fps * speed };
+    }
+    app.clips = Texture::Builder()
+            .width(CROWD_SIZE)
+            .height(CROWD_SIZE)
+            .levels(1)
+            .format(Texture::InternalFormat::RGBA32F)
+            .build(*engine);
+    app.clips->setImage(*engine, 0, Texture::PixelBufferDescriptor(
+            clips.data(), clips.size() * sizeof(float4),
+            Texture::Format::RGBA, Texture::Type::FLOAT));
+
+    app.mat = Material::Builder()
+            .package(RESOURCES_VERTEXANIMATION_DATA, RESOURCES_VERTEXANIMATION_SIZE)
+            .build(*engine);
+
+    // the textures are fetched per texel, 32-bit floats aren't always filterable
+    TextureSampler const sampler(TextureSampler::MinFilter::NEAREST,
+            TextureSampler::MagFilter::NEAREST);
+    app.matInstance = app.mat->createInstance();
+    app.matInstance->setParameter("vertices", app.vertices, sampler);
+    app.matInstance->setParameter("clips", app.clips, sampler);
+    app.matInstance->setParameter("boundsMin", layout.boundsMin);
+    app.matInstance->setParameter("boundsExtent", layout.boundsMax - layout.boundsMin);
+    app.matInstance->setParameter("rowsPerFrame", float(layout.rowsPerFrame));
+    app.matInstance->setParameter("frameCount", float(layout.frameCount));
+    app.matInstance->setParameter("baseColor",
+            Color::toLinear<ACCURATE>(sRGBColor(0.8f, 0.5f, 0.3f)));
+
+    // The vertices of the mesh are in the order of the texture. MeshReader also creates a
+    // renderable, but it isn't instanced, so we only keep its buffers.
+    auto* const meshData = new std::vector<uint8_t>(readFile(g_basePath + ".filamesh"));
+    app.mesh = filamesh::MeshReader::loadMeshFromBuffer(engine, meshData->data(),
+            [](void*, size_t, void* user) { delete (std::vector<uint8_t>*) user; }, meshData,
+            app.matInstance);
+    engine->destroy(app.mesh.renderable);
+    EntityManager::get().destroy(app.mesh.renderable);
+
+    // the characters stand on a grid, each facing a random direction
+    Box const bounds = Box().set(layout.boundsMin, layout.boundsMax);
+    float const spacing = 2.0f * std::max(bounds.halfExtent.x, bounds.halfExtent.z) + 0.5f;
+    static std::vector<mat4f> transforms(INSTANCE_COUNT);
+    for (uint32_t i = 0; i < INSTANCE_COUNT; i++) {
+        float const x = (float(i % CROWD_SIZE) - 0.5f * CROWD_SIZE) * spacing;
+        float const z = -float(i / CROWD_SIZE) * spacing;
+        float const angle = float(std::rand()) / float(RAND_MAX) * float(2.0 * M_PI);
+        transforms[i] = mat4f::translation(float3{ x, 0, z }) *
+                mat4f::rotation(angle, float3{ 0, 1, 0 });
+    }
+
+    app.instances = InstanceBuffer::Builder(INSTANCE_COUNT)
+            .instanceBoundingBox(bounds)
+            .build(*engine);
+    app.instances->setLocalTransforms(transforms.data(), INSTANCE_COUNT);
+
+    float const crowdSize = CROWD_SIZE * spacing;
+    app.renderable = EntityManager::get().create();
+    RenderableManager::Builder(1)
+            .boundingBox(Box().set(
+                    float3{ -crowdSize, layout.boundsMin.y, -crowdSize - spacing },
+                    float3{ crowdSize, layout.boundsMax.y, spacing }))
+            .material(0, app.matInstance)
+            .geometry(0, RenderableManager::PrimitiveType::TRIANGLES,
+                    app.mesh.vertexBuffer, app.mesh.indexBuffer)
+            .instances(INSTANCE_COUNT, app.instances)
+            .receiveShadows(true)
+            .castShadows(true)
+            .build(*engine, app.renderable);
+    scene->addEntity(app.renderable);
+
+    app.sun = EntityManager::get().create();
+    LightManager::Builder(LightManager::Type::SUN)
+            .color(Color::toLinear<ACCURATE>(sRGBColor(0.98f, 0.92f, 0.89f)))
+            .intensity(110000)
+            .direction({ 0.6, -1.0, -0.8 })
+            .castShadows(true)
+            .build(*engine, app.sun);
+    scene->addEntity(app.sun);
+
+    app.skybox = Skybox::Builder().color({ 0.45, 0.6, 0.8, 1.0 }).build(*engine);
+    scene->setSkybox(app.skybox);
+
+    view->setPostProcessingEnabled(true);
+}
+
+static void cleanup(App& app, Engine* engine) {
+    engine->destroy(app.skybox);
+    engine->destroy(app.sun);
+    engine->destroy(app.renderable);
+    engine->destroy(app.matInstance);
+    engine->destroy(app.mat);
+    engine->destroy(app.vertices);
+    engine->destroy(app.clips);
+    engine->destroy(app.instances);
+    engine->destroy(app.mesh.vertexBuffer);
+    engine->destroy(app.mesh.indexBuffer);
+    EntityManager::get().destroy(app.sun);
+    EntityManager::get().destroy(app.renderable);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << Path(argv[0]).getName()
+                  << " <output of vatbaker, without extension>" << std::endl;
+        return 1;
+    }
+    g_basePath = argv[1];
+
+    Config config;
+    config.title = "vertex_animation";
+
+    App app;
+    FilamentApp::get().run(config,
+            [&app](Engine* engine, View* view, Scene* scene) { setup(app, engine, view, scene); },
+            [&app](Engine* engine, View*, Scene*) { cleanup(app, engine); });
+
+    return 0;
+}
@@ -18,9 +18,16 @@
 
 #include <filameshio/filamesh.h>
 
+#include <geometry/IndexOptimizer.h>
+
+#include <utils/FixedCapacityVector.h>
+
 #include <meshoptimizer.h>
 
+#include <algorithm>
+
 using namespace filamesh;
+using namespace filament::geometry;
 using namespace filament::math;
 using namespace std;
 
@@ -40,6 +47,13 @@ size_t write(unsigned char* out, const vector<T>& data) {
     return data.size() * sizeof(T);
 }
 
+static void printMetrics(const char* label, Mesh const& mesh, vector<float3> const& positions) {
+    IndexOptimizer::Metrics const metrics = IndexOptimizer::analyze(mesh.indices.data(),
+            mesh.indices.size(), mesh.vertexCount, positions.data());
+    printf("%s: ACMR %.3f, ATVR %.3f, overdraw %.3f\n", label,
+            metrics.acmr, metrics.atvr, metrics.overdraw);
+}
+
 void MeshWriter::optimize(Mesh& mesh) {
     // In debug builds, non-triangular data will assert in meshopt, but we need to have
     // a safety check here anyway to prevent potential OOB reads in release builds.
@@ -48,48 +62,63 @@ void MeshWriter::optimize(Mesh& mesh) {
         exit(1);
     }
 
-    // First, re-order triangles to improve cache locality and reduce the number of VS invocations.
-    // Note that assimp already has aiProcess_ImproveCacheLocality, but MeshWriter doesn't know
-    // about assimp, and it doesn't hurt to do it again here since this generally runs offline.
-    meshopt_optimizeVertexCache(mesh.indices.data(), mesh.indices.data(), mesh.indices.size(),
-                mesh.vertexCount);
+    const uint32_t vertexCount = mesh.vertexCount;
+
+    // the positions are stored as half-floats, but the optimizer needs floats
+    vector<float3> positions(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++) {
+        half4 const& p = (mFlags & INTERLEAVED) ? mesh.vertices[i].position : mesh.positions[i];
+        positions[i] = float3(p.xyz);
+    }
+
+    if (mPrintMetrics) {
+        printMetrics("Before optimization", mesh, positions);
+    }
+
+    // First, re-order triangles to improve cache locality and reduce the number of VS invocations,
+    // then to reduce overdraw. Note that assimp already has aiProcess_ImproveCacheLocality, but
+    // MeshWriter doesn't know about assimp, and it doesn't hurt to do it again here since this
+    // generally runs offline. Each part is optimized on its own so that it stays contiguous.
+    IndexOptimizer const optimizer({});
+    for (Part const& part : mesh.parts) {
+        optimizer(mesh.indices.data() + part.offset, part.indexCount,
+                positions.data(), vertexCount);
+    }
 
     // At this point, triangle order has been established but we still need to shuffle vertices to
     // optimize the fetch. This makes it so that lower-numbered indices generally come before
     // higher-numbered indices.
+    utils::FixedCapacityVector<uint32_t> const remap = IndexOptimizer::optimizeVertexFetch(
+            mesh.indices.data(), mesh.indices.size(), vertexCount);
+    auto remapStream = [&remap, vertexCount](auto& stream) {
+        IndexOptimizer::remapVertices(stream.data(), stream.data(), vertexCount,
+                sizeof(stream[0]), remap.data());
+    };
     if (mFlags & INTERLEAVED) {
-        meshopt_optimizeVertexFetch(mesh.vertices.data(), mesh.indices.data(),
-                mesh.indices.size(), mesh.vertices.data(), mesh.vertices.size(),
-                sizeof(Vertex));
+        remapStream(mesh.vertices);
     } else {
-        const uint32_t vertexCount = mesh.vertexCount;
-
-        // Allocate a remapping table and create a copy of the index buffer.
-        vector<uint32_t> remappingVector(vertexCount);
-        vector<uint32_t> indicesVector = mesh.indices;
-        uint32_t* remapping = remappingVector.data();
-        const uint32_t* indices = indicesVector.data();
-
-        // Populate the remapping table.
-        meshopt_optimizeVertexFetchRemap(remapping, mesh.indices.data(),
-                mesh.indices.size(), vertexCount);
-
-        // Apply the remapping table.
-        meshopt_remapIndexBuffer(mesh.indices.data(), indices, mesh.indices.size(), remapping);
-        meshopt_remapVertexBuffer(mesh.positions.data(), mesh.positions.data(),
-                vertexCount, sizeof(decltype(Vertex::position)), remapping);
-        meshopt_remapVertexBuffer(mesh.tangents.data(), mesh.tangents.data(),
-                vertexCount, sizeof(decltype(Vertex::tangents)), remapping);
-        meshopt_remapVertexBuffer(mesh.colors.data(), mesh.colors.data(),
-                vertexCount, sizeof(decltype(Vertex::color)), remapping);
-        meshopt_remapVertexBuffer(mesh.uv0.data(), mesh.uv0.data(),
-                vertexCount, sizeof(decltype(Vertex::uv0)), remapping);
+        remapStream(mesh.positions);
+        remapStream(mesh.tangents);
+        remapStream(mesh.colors);
+        remapStream(mesh.uv0);
         if (!mesh.uv1.empty()) {
-            meshopt_remapVertexBuffer(mesh.uv1.data(), mesh.uv1.data(),
-                    vertexCount, sizeof(decltype(Vertex::uv0)), remapping);
+            remapStream(mesh.uv1);
         }
     }
 
+    // the vertices of each part moved, so its index range must be updated
+    for (Part& part : mesh.parts) {
+        auto const first = mesh.indices.begin() + part.offset;
+        auto const [minIndex, maxIndex] = minmax_element(first, first + part.indexCount);
+        part.minIndex = *minIndex;
+        part.maxIndex = *maxIndex;
+    }
+
+    if (mPrintMetrics) {
+        remapStream(positions);
+        printMetrics("After optimization", mesh, positions);
+    }
+
     // As a last step, the meshoptimizer README recommends applying individual meshopt_quantize*
     // functions as needed, but we actually already quantized the data according to our constraints
     // e.g. we already (potentially) use snorm16 for uvs, half-floats for tangents, etc.
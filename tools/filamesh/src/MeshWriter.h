@@ -57,9 +57,12 @@ struct Mesh {
 
 class MeshWriter {
     uint32_t mFlags;
+    bool mPrintMetrics;
     void optimize(Mesh& mesh);
 public:
-    MeshWriter(uint32_t flags) : mFlags(flags) {}
+    // printMetrics prints the vertex cache and overdraw metrics before and after optimization
+    MeshWriter(uint32_t flags, bool printMetrics = false)
+            : mFlags(flags), mPrintMetrics(printMetrics) {}
     bool serialize(std::ostream&, Mesh& mesh);
 };
 
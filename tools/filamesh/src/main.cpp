@@ -47,6 +47,7 @@ using Assimp::Importer;
 bool g_interleaved = false;
 bool g_snormUVs = false;
 bool g_compression = false;
+bool g_metrics = false;
 bool g_ignore_uv1 = false;
 
 Mesh g_mesh;
@@ -273,6 +274,9 @@ static void printUsage(const char* name) {
                     "       enable compression\n\n"
                     "   --ignore-uv1, -g\n"
                     "       Ignore the second set of UV coordinates\n\n"
+                    "   --metrics, -m\n"
+                    "       Print the vertex cache (ACMR, ATVR) and overdraw metrics of the mesh\n"
+                    "       before and after optimization\n\n"
 
     );
 
@@ -295,13 +299,14 @@ static void license() {
 }
 
 static int handleArguments(int argc, char* argv[]) {
-    static constexpr const char* OPTSTR = "hilcg";
+    static constexpr const char* OPTSTR = "hilcgm";
     static const struct option OPTIONS[] = {
             { "help",        no_argument, 0, 'h' },
             { "license",     no_argument, 0, 'l' },
             { "interleaved", no_argument, 0, 'i' },
             { "compress",    no_argument, 0, 'c' },
             { "ignore-uv1",  no_argument, 0, 'g' },
+            { "metrics",     no_argument, 0, 'm' },
             { 0, 0, 0, 0 }  // termination of the option list
     };
 
@@ -329,6 +334,9 @@ static int handleArguments(int argc, char* argv[]) {
             case 'g':
                 g_ignore_uv1 = true;
                 break;
+            case 'm':
+                g_metrics = true;
+                break;
         }
     }
 
@@ -441,7 +449,7 @@ int main(int argc, char* argv[]) {
     if (g_compression) {
         flags |= filamesh::COMPRESSION;
     }
-    MeshWriter(flags).serialize(out, g_mesh);
+    MeshWriter(flags, g_metrics).serialize(out, g_mesh);
 
     out.flush();
     out.close();
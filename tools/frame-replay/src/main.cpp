@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "private/backend/CommandBufferQueue.h"
+#include "private/backend/CommandReplay.h"
+#include "private/backend/CommandStream.h"
+#include "private/backend/PlatformFactory.h"
+
+#include <backend/Platform.h>
+
+#include <utils/Path.h>
+
+#include <getopt/getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace filament::backend;
+using namespace utils;
+
+static constexpr size_t MIN_COMMAND_BUFFERS_SIZE = 1 * 1024 * 1024;
+static constexpr size_t COMMAND_BUFFERS_SIZE     = 3 * MIN_COMMAND_BUFFERS_SIZE;
+
+static Backend g_backend = Backend::DEFAULT;
+static uint32_t g_frameCount = 100;
+static CommandReplay::Config g_config;
+
+static const char* USAGE = R"TXT(
+FRAME-REPLAY replays a frame captured with Engine::Config::commandCaptureFile, directly on a
+backend and without the application that rendered it, and prints how long it takes.
+
+The commands preceding the last captured frame are replayed once to create its resources, then
+the frame is replayed repeatedly. The captured SwapChains are replaced by headless ones.
+
+Usage:
+    FRAME-REPLAY [options] <capture file>
+
+Options:
+   --api, -a
+       Specify the backend API: opengl, vulkan, metal or noop (default: platform default)
+   --frames=<count>, -n <count>
+       Number of times the frame is replayed (default: 100)
+   --size=<width>x<height>, -s <width>x<height>
+       Size of the headless SwapChains (default: 1920x1080)
+   --help, -h
+       Print this message
+   --license, -L
+       Print copyright and license information
+)TXT";
+
+static void printUsage(const char* name) {
+    std::string execName(Path(name).getName());
+    const std::string from("FRAME-REPLAY");
+    std::string usage(USAGE);
+    for (size_t pos = usage.find(from); pos != std::string::npos; pos = usage.find(from, pos)) {
+        usage.replace(pos, from.length(), execName);
+    }
+    puts(usage.c_str());
+}
+
+static void license() {
+    static const char *license[] = {
+        #include "licenses/licenses.inc"
+        nullptr
+    };
+
+    const char **p = &license[0];
+    while (*p)
+        std::cout << *p++ << std::endl;
+}
+
+static int handleArguments(int argc, char* argv[]) {
+    static constexpr const char* OPTSTR = "ha:n:s:L";
+    static const struct option OPTIONS[] = {
+            { "help",    no_argument,       0, 'h' },
+            { "api",     required_argument, 0, 'a' },
+            { "frames",  required_argument, 0, 'n' },
+            { "size",    required_argument, 0, 's' },
+            { "license", no_argument,       0, 'L' },
+            { 0, 0, 0, 0 }  // termination of the option list
+    };
+
+    int opt;
+    int optionIndex = 0;
+
+    while ((opt = getopt_long(argc, argv, OPTSTR, OPTIONS, &optionIndex)) >= 0) {
+        std::string arg(optarg ? optarg : "");
+        switch (opt) {
+            default:
+            case 'h':
+                printUsage(argv[0]);
+                exit(0);
+            case 'a':
+                if (arg == "opengl") {
+                    g_backend = Backend::OPENGL;
+                } else if (arg == "vulkan") {
+                    g_backend = Backend::VULKAN;
+                } else if (arg == "metal") {
+                    g_backend = Backend::METAL;
+                } else if (arg == "noop") {
+                    g_backend = Backend::NOOP;
+                } else {
+                    std::cerr << "Unrecognized backend. "
+                            "Must be 'opengl'|'vulkan'|'metal'|'noop'.\n";
+                }
+                break;
+            case 'n':
+                g_frameCount = std::max(atoi(arg.c_str()), 1);
+                break;
+            case 's':
+                if (sscanf(arg.c_str(), "%ux%u", &g_config.width, &g_config.height) != 2) {
+                    std::cerr << "The size must be <width>x<height>.\n";
+                }
+                break;
+            case 'L':
+                license();
+                exit(0);
+        }
+    }
+
+    return optind;
+}
+
+int main(int argc, char* argv[]) {
+    const int optionIndex = handleArguments(argc, argv);
+    if (optionIndex >= argc) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    CommandReplay replay(g_config);
+    if (!replay.load(argv[optionIndex])) {
+        return 1;
+    }
+
+    Platform* platform = PlatformFactory::create(&g_backend);
+    if (!platform) {
+        std::cerr << "The backend isn't supported on this platform.\n";
+        return 1;
+    }
+    Driver* const driver = platform->createDriver(nullptr, {});
+    if (!driver) {
+        std::cerr << "Couldn't create the driver.\n";
+        PlatformFactory::destroy(&platform);
+        return 1;
+    }
+
+    // the commands are executed on this thread, there is no driver thread
+    CommandBufferQueue queue(MIN_COMMAND_BUFFERS_SIZE, COMMAND_BUFFERS_SIZE, false);
+    CommandStream stream(*driver, queue.getCircularBuffer());
+    auto flush = [&]() {
+        if (queue.getCircularBuffer().empty()) {
+            return;
+        }
+        queue.flush();
+        for (auto& item : queue.waitForCommands()) {
+            if (UTILS_LIKELY(item.begin)) {
+                stream.execute(item.begin);
+                queue.releaseBuffer(item);
+            }
+        }
+        driver->purge();
+    };
+
+    replay.replaySetup(stream, flush);
+
+    std::vector<double> durations;
+    durations.reserve(g_frameCount);
+    for (uint32_t i = 0; i < g_frameCount; i++) {
+        auto const start = std::chrono::steady_clock::now();
+        replay.replayFrame(stream, flush);
+        // include the GPU time
+        stream.finish();
+        flush();
+        auto const end = std::chrono::steady_clock::now();
+        durations.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::sort(durations.begin(), durations.end());
+    double total = 0.0;
+    for (double const d : durations) {
+        total += d;
+    }
+    printf("Replayed the last of %zu captured frame(s) %u times\n",
+            replay.getFrameCount(), g_frameCount);
+    printf("    min    %8.3f ms\n", durations.front());
+    printf("    median %8.3f ms\n", durations[durations.size() / 2]);
+    printf("    mean   %8.3f ms\n", total / double(durations.size()));
+    printf("    max    %8.3f ms\n", durations.back());
+
+    stream.terminate();
+    delete driver;
+    PlatformFactory::destroy(&platform);
+    return 0;
+}
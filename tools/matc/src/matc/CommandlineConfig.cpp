@@ -81,6 +81,9 @@ static void usage(char* name) {
             "           MATC -PflipUV=false -PshadingModel=lit -Pname=myMat ...\n\n"
             "   --reflect, -r\n"
             "       Reflect the specified metadata as JSON: parameters\n\n"
+            "   --cache-dir <directory>, -c <directory>\n"
+            "       Cache the compiled shaders in the given directory, which must exist, so that\n"
+            "       unchanged shaders are not compiled again. It can be shared by several materials.\n\n"
             "   --variant-filter=<filter>, -V <filter>\n"
             "       Filter out specified comma-separated variants:\n"
             "           directionalLighting, dynamicLighting, shadowReceiver, skinning, vsm, fog,"
@@ -103,6 +106,8 @@ static void usage(char* name) {
             "       Skip validation of number of sampler used\n\n"
             "   --print, -t\n"
             "       Print generated shaders for debugging\n\n"
+            "   --print-cost, -C\n"
+            "       Print the instruction counts of each Vulkan shader (requires --api vulkan or all)\n\n"
             "   --save-raw-variants, -R\n"
             "       Write the raw generated GLSL for each variant to a text file in the current directory.\n\n"
     );
@@ -181,7 +186,7 @@ static void parseDefine(std::string defineString, Config::StringReplacementMap&
 }
 
 bool CommandlineConfig::parse() {
-    static constexpr const char* OPTSTR = "hLxo:f:dm:a:l:p:D:T:P:OSEr:vV:gtwF1R";
+    static constexpr const char* OPTSTR = "hLxo:f:dm:a:l:p:D:T:P:OSEr:vV:gtCwF1Rc:";
     static const struct option OPTIONS[] = {
             { "help",                    no_argument, nullptr, 'h' },
             { "license",                 no_argument, nullptr, 'L' },
@@ -203,10 +208,12 @@ bool CommandlineConfig::parse() {
             { "material-parameter",required_argument, nullptr, 'P' },
             { "reflect",           required_argument, nullptr, 'r' },
             { "print",                   no_argument, nullptr, 't' },
+            { "print-cost",              no_argument, nullptr, 'C' },
             { "version",                 no_argument, nullptr, 'v' },
             { "raw",                     no_argument, nullptr, 'w' },
             { "no-sampler-validation",   no_argument, nullptr, 'F' },
             { "save-raw-variants",       no_argument, nullptr, 'R' },
+            { "cache-dir",         required_argument, nullptr, 'c' },
             { nullptr, 0, nullptr, 0 }  // termination of the option list
     };
 
@@ -324,6 +331,9 @@ bool CommandlineConfig::parse() {
             case 't':
                 mPrintShaders = true;
                 break;
+            case 'C':
+                mPrintShaderCost = true;
+                break;
             case 'w':
                 mRawShaderMode = true;
                 break;
@@ -332,6 +342,9 @@ bool CommandlineConfig::parse() {
             case 'R':
                 mSaveRawVariants = true;
                 break;
+            case 'c':
+                mShaderCacheDirectory = arg;
+                break;
         }
     }
 
@@ -25,6 +25,7 @@
 #include <map>
 #include <memory>
 #include <ostream>
+#include <string>
 
 #include <utils/compiler.h>
 
@@ -111,6 +112,10 @@ public:
         return mPrintShaders;
     }
 
+    bool printShaderCost() const noexcept {
+        return mPrintShaderCost;
+    }
+
     bool saveRawVariants() const noexcept {
         return mSaveRawVariants;
     }
@@ -147,10 +152,15 @@ public:
         return mFeatureLevel;
     }
 
+    const std::string& getShaderCacheDirectory() const noexcept {
+        return mShaderCacheDirectory;
+    }
+
 protected:
     bool mDebug = false;
     bool mIsValid = true;
     bool mPrintShaders = false;
+    bool mPrintShaderCost = false;
     bool mRawShaderMode = false;
     bool mNoSamplerValidation = false;
     bool mSaveRawVariants = false;
@@ -165,6 +175,7 @@ protected:
     StringReplacementMap mMaterialParameters;
     filament::UserVariantFilterMask mVariantFilter = 0;
     bool mIncludeEssl1 = true;
+    std::string mShaderCacheDirectory;
 };
 
 }
@@ -409,7 +409,9 @@ bool MaterialCompiler::run(const Config& config) {
         .targetApi(config.getTargetApi())
         .optimization(config.getOptimizationLevel())
         .printShaders(config.printShaders())
+        .printShaderCost(config.printShaderCost())
         .saveRawVariants(config.saveRawVariants())
+        .shaderCacheDirectory(config.getShaderCacheDirectory().c_str())
         .generateDebugInfo(config.isDebug())
         .variantFilter(config.getVariantFilter() | builder.getVariantFilter());
 
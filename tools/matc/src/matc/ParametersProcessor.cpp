@@ -1267,6 +1267,38 @@ static bool processVariantFilter(MaterialBuilder& builder, const JsonishValue& v
     return true;
 }
 
+static bool processSpecializedVariants(MaterialBuilder& builder, const JsonishValue& value) {
+    static const std::unordered_map<std::string, filament::UserVariantFilterBit> strToEnum  = [] {
+        std::unordered_map<std::string, filament::UserVariantFilterBit> strToEnum;
+        strToEnum["fog"]                    = filament::UserVariantFilterBit::FOG;
+        return strToEnum;
+    }();
+
+    filament::UserVariantFilterMask specializedVariants = {};
+    const JsonishArray* jsonArray = value.toJsonArray();
+    const auto& elements = jsonArray->getElements();
+
+    for (size_t i = 0; i < elements.size(); i++) {
+        auto elementValue = elements[i];
+        if (elementValue->getType() != JsonishValue::Type::STRING) {
+            std::cerr << "specializedVariants: array index " << i <<
+                      " is not a STRING. found:" <<
+                      JsonishValue::typeToString(elementValue->getType()) << std::endl;
+            return false;
+        }
+
+        const std::string& s = elementValue->toJsonString()->getString();
+        if (!isStringValidEnum(strToEnum, s)) {
+            return logEnumIssue("specializedVariants", *elementValue->toJsonString(), strToEnum);
+        }
+
+        specializedVariants |= (uint32_t)strToEnum.at(s);
+    }
+
+    builder.specializedVariants(specializedVariants);
+    return true;
+}
+
 ParametersProcessor::ParametersProcessor() {
     using Type = JsonishValue::Type;
     mParameters["name"]                          = { &processName, Type::STRING };
@@ -1295,6 +1327,7 @@ ParametersProcessor::ParametersProcessor() {
     mParameters["transparentShadow"]             = { &processTransparentShadow, Type::BOOL };
     mParameters["shadingModel"]                  = { &processShading, Type::STRING };
     mParameters["variantFilter"]                 = { &processVariantFilter, Type::ARRAY };
+    mParameters["specializedVariants"]           = { &processSpecializedVariants, Type::ARRAY };
     mParameters["specularAntiAliasing"]          = { &processSpecularAntiAliasing, Type::BOOL };
     mParameters["specularAntiAliasingVariance"]  = { &processSpecularAntiAliasingVariance, Type::NUMBER };
     mParameters["specularAntiAliasingThreshold"] = { &processSpecularAntiAliasingThreshold, Type::NUMBER };
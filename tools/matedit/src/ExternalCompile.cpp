@@ -15,6 +15,7 @@
  */
 
 #include "ExternalCompile.h"
+#include "MaterialChunks.h"
 
 #include "backend/DriverEnums.h"
 #include "eiff/BlobDictionary.h"
@@ -45,20 +46,6 @@ using filamat::Flattener;
 using filamat::Package;
 using namespace filament;
 
-class PassthroughChunk final : public filamat::Chunk {
-public:
-    explicit PassthroughChunk(const char* data, size_t size, filamat::ChunkType type)
-        : filamat::Chunk(type), data(data), size(size) {}
-
-    ~PassthroughChunk() = default;
-
-private:
-    void flatten(Flattener& f) override { f.writeRaw(data, size); }
-
-    const char* data;
-    size_t size;
-};
-
 namespace matedit {
 
 static std::ifstream::pos_type getFileSize(const char* filename) {
@@ -91,41 +78,6 @@ static bool readBinary(utils::Path filename, std::vector<uint8_t>& buffer) {
     return true;
 }
 
-template <typename T>
-static std::vector<T> getShaderRecords(const filaflat::ChunkContainer& container,
-        const filaflat::BlobDictionary& dictionary, filamat::ChunkType chunkType) {
-    if (!container.hasChunk(chunkType)) {
-        return {};
-    }
-    std::vector<T> shaderRecords;
-    filaflat::MaterialChunk materialChunk(container);
-    materialChunk.initialize(chunkType);
-    materialChunk.visitShaders(
-            [&materialChunk, &dictionary, &shaderRecords](
-                    backend::ShaderModel shaderModel, Variant variant, backend::ShaderStage stage) {
-                filaflat::ShaderContent content;
-                UTILS_UNUSED_IN_RELEASE bool success =
-                        materialChunk.getShader(content, dictionary, shaderModel, variant, stage);
-
-                std::string source { content.data(), content.data() + content.size() - 1u };
-                assert_invariant(success);
-
-                if constexpr (std::is_same_v<T, filamat::TextEntry>) {
-                    shaderRecords.push_back({ shaderModel, variant, stage, std::move(source) });
-                }
-                if constexpr (std::is_same_v<T, filamat::BinaryEntry>) {
-                    filamat::BinaryEntry e {};
-                    e.shaderModel = shaderModel;
-                    e.variant = variant;
-                    e.stage = stage;
-                    e.dictionaryIndex = 0;
-                    e.data = std::vector<uint8_t>(content.begin(), content.end());
-                    shaderRecords.push_back(std::move(e));
-                }
-            });
-    return shaderRecords;
-}
-
 static std::string toString(backend::ShaderModel model) {
     switch (model) {
         case backend::ShaderModel::DESKTOP:
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_MATEDIT_MATERIALCHUNKS_H
+#define TNT_MATEDIT_MATERIALCHUNKS_H
+
+#include "eiff/Chunk.h"
+#include "eiff/ShaderEntry.h"
+
+#include <filaflat/ChunkContainer.h>
+#include <filaflat/DictionaryReader.h>
+#include <filaflat/MaterialChunk.h>
+
+#include <private/filament/Variant.h>
+
+#include <backend/DriverEnums.h>
+
+#include <utils/compiler.h>
+#include <utils/debug.h>
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+
+namespace matedit {
+
+// A chunk copied as-is from the input material.
+class PassthroughChunk final : public filamat::Chunk {
+public:
+    explicit PassthroughChunk(const char* data, size_t size, filamat::ChunkType type)
+        : filamat::Chunk(type), data(data), size(size) {}
+
+    ~PassthroughChunk() = default;
+
+private:
+    void flatten(filamat::Flattener& f) override { f.writeRaw(data, size); }
+
+    const char* data;
+    size_t size;
+};
+
+// Extracts all the shaders of the given chunk type, T is either filamat::TextEntry or
+// filamat::BinaryEntry.
+template <typename T>
+std::vector<T> getShaderRecords(const filaflat::ChunkContainer& container,
+        const filaflat::BlobDictionary& dictionary, filamat::ChunkType chunkType) {
+    using namespace filament;
+    if (!container.hasChunk(chunkType)) {
+        return {};
+    }
+    std::vector<T> shaderRecords;
+    filaflat::MaterialChunk materialChunk(container);
+    materialChunk.initialize(chunkType);
+    materialChunk.visitShaders(
+            [&materialChunk, &dictionary, &shaderRecords](
+                    backend::ShaderModel shaderModel, Variant variant, backend::ShaderStage stage) {
+                filaflat::ShaderContent content;
+                UTILS_UNUSED_IN_RELEASE bool success =
+                        materialChunk.getShader(content, dictionary, shaderModel, variant, stage);
+
+                std::string source { content.data(), content.data() + content.size() - 1u };
+                assert_invariant(success);
+
+                if constexpr (std::is_same_v<T, filamat::TextEntry>) {
+                    shaderRecords.push_back({ shaderModel, variant, stage, std::move(source) });
+                }
+                if constexpr (std::is_same_v<T, filamat::BinaryEntry>) {
+                    filamat::BinaryEntry e {};
+                    e.shaderModel = shaderModel;
+                    e.variant = variant;
+                    e.stage = stage;
+                    e.dictionaryIndex = 0;
+                    e.data = std::vector<uint8_t>(content.begin(), content.end());
+                    shaderRecords.push_back(std::move(e));
+                }
+            });
+    return shaderRecords;
+}
+
+} // namespace matedit
+
+#endif // TNT_MATEDIT_MATERIALCHUNKS_H
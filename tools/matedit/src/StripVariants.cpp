@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StripVariants.h"
+#include "MaterialChunks.h"
+
+#include "eiff/BlobDictionary.h"
+#include "eiff/ChunkContainer.h"
+#include "eiff/DictionaryMetalLibraryChunk.h"
+#include "eiff/DictionarySpirvChunk.h"
+#include "eiff/DictionaryTextChunk.h"
+#include "eiff/LineDictionary.h"
+#include "eiff/MaterialBinaryChunk.h"
+#include "eiff/MaterialTextChunk.h"
+#include "eiff/ShaderEntry.h"
+
+#include <filaflat/ChunkContainer.h>
+#include <filaflat/DictionaryReader.h>
+#include <filaflat/Unflattener.h>
+
+#include <filamat/Package.h>
+
+#include <backend/DriverEnums.h>
+
+#include <utils/bitset.h>
+#include <utils/CString.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using filamat::Flattener;
+using filamat::Package;
+using namespace filament;
+
+namespace matedit {
+
+namespace {
+
+struct UsedVariants {
+    utils::bitset256 vertex;
+    utils::bitset256 fragment;
+
+    bool isUsed(Variant variant, backend::ShaderStage stage) const noexcept {
+        switch (stage) {
+            case backend::ShaderStage::VERTEX:
+                return vertex.test(variant.key);
+            case backend::ShaderStage::FRAGMENT:
+                return fragment.test(variant.key);
+            case backend::ShaderStage::COMPUTE:
+                // compute shaders don't have variants
+                return true;
+        }
+        return true;
+    }
+};
+
+// A material can appear several times in a profile, e.g. if it was created more than once, the
+// variants used by all of them are kept.
+bool readProfile(utils::Path const& path, std::string_view materialName, UsedVariants* used) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::cerr << "Could not open the profile " << path << std::endl;
+        return false;
+    }
+    bool found = false;
+    bool current = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream words(line);
+        std::string word;
+        if (!(words >> word) || word[0] == '#') {
+            continue;
+        }
+        if (word == "material") {
+            std::string name;
+            std::getline(words >> std::ws, name);
+            current = name == materialName;
+            found = found || current;
+        } else if (current && (word == "vertex" || word == "fragment")) {
+            utils::bitset256& keys = word == "vertex" ? used->vertex : used->fragment;
+            unsigned int key;
+            while (words >> key) {
+                if (key < keys.size()) {
+                    keys.set(key);
+                }
+            }
+        }
+    }
+    return found;
+}
+
+template<typename T>
+size_t removeUnused(std::vector<T>& entries, UsedVariants const& used) {
+    size_t const count = entries.size();
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [&used](T const& entry) {
+        return !used.isUsed(entry.variant, entry.stage);
+    }), entries.end());
+    return count - entries.size();
+}
+
+} // anonymous namespace
+
+int stripVariants(utils::Path input, utils::Path output, utils::Path profile) {
+    std::ifstream in(input.c_str(), std::ifstream::binary | std::ifstream::ate);
+    if (!in.is_open()) {
+        std::cerr << "Could not open the source material " << input << std::endl;
+        return 1;
+    }
+    std::vector<char> buffer(size_t(in.tellg()));
+    in.seekg(0);
+    if (!in.read(buffer.data(), std::streamsize(buffer.size()))) {
+        std::cerr << "Could not read the source material." << std::endl;
+        return 1;
+    }
+
+    filaflat::ChunkContainer container(buffer.data(), buffer.size());
+    if (!container.parse()) {
+        return 1;
+    }
+
+    utils::CString name;
+    if (container.hasChunk(filamat::ChunkType::MaterialName)) {
+        auto [start, end] = container.getChunkRange(filamat::ChunkType::MaterialName);
+        filaflat::Unflattener unflattener(start, end);
+        unflattener.read(&name);
+    }
+
+    UsedVariants used;
+    if (!readProfile(profile, { name.c_str_safe(), name.size() }, &used)) {
+        std::cerr << "The material '" << name.c_str_safe() << "' is not in the profile "
+                  << profile << ", no shaders were removed." << std::endl;
+        return 1;
+    }
+
+    filaflat::BlobDictionary stringBlobs;
+    filaflat::BlobDictionary spirvBlobs;
+    filaflat::BlobDictionary metalLibraryBlobs;
+    filaflat::DictionaryReader reader;
+    if (container.hasChunk(filamat::ChunkType::DictionaryText)) {
+        reader.unflatten(container, filamat::ChunkType::DictionaryText, stringBlobs);
+    }
+    if (container.hasChunk(filamat::ChunkType::DictionarySpirv)) {
+        reader.unflatten(container, filamat::ChunkType::DictionarySpirv, spirvBlobs);
+    }
+    if (container.hasChunk(filamat::ChunkType::DictionaryMetalLibrary)) {
+        reader.unflatten(container, filamat::ChunkType::DictionaryMetalLibrary,
+                metalLibraryBlobs);
+    }
+    auto glslEntries = getShaderRecords<filamat::TextEntry>(
+            container, stringBlobs, filamat::ChunkType::MaterialGlsl);
+    auto essl1Entries = getShaderRecords<filamat::TextEntry>(
+            container, stringBlobs, filamat::ChunkType::MaterialEssl1);
+    auto mslEntries = getShaderRecords<filamat::TextEntry>(
+            container, stringBlobs, filamat::ChunkType::MaterialMetal);
+    auto spirvEntries = getShaderRecords<filamat::BinaryEntry>(
+            container, spirvBlobs, filamat::ChunkType::MaterialSpirv);
+    auto metalLibraryEntries = getShaderRecords<filamat::BinaryEntry>(
+            container, metalLibraryBlobs, filamat::ChunkType::MaterialMetalLibrary);
+
+    size_t const total = glslEntries.size() + essl1Entries.size() + mslEntries.size() +
+            spirvEntries.size() + metalLibraryEntries.size();
+    size_t const removed = removeUnused(glslEntries, used) + removeUnused(essl1Entries, used) +
+            removeUnused(mslEntries, used) + removeUnused(spirvEntries, used) +
+            removeUnused(metalLibraryEntries, used);
+
+    // Pass through the chunks that don't contain shaders, the others are all regenerated since
+    // the dictionaries shrink.
+    filamat::ChunkContainer outputChunks;
+    for (size_t i = 0; i < container.getChunkCount(); i++) {
+        filaflat::ChunkContainer::Chunk const c = container.getChunk(i);
+        switch (c.type) {
+            case filamat::ChunkType::DictionaryText:
+            case filamat::ChunkType::DictionarySpirv:
+            case filamat::ChunkType::DictionaryMetalLibrary:
+            case filamat::ChunkType::MaterialGlsl:
+            case filamat::ChunkType::MaterialEssl1:
+            case filamat::ChunkType::MaterialMetal:
+            case filamat::ChunkType::MaterialSpirv:
+            case filamat::ChunkType::MaterialMetalLibrary:
+                break;
+            default:
+                outputChunks.push<PassthroughChunk>(
+                        reinterpret_cast<const char*>(c.desc.start), c.desc.size, c.type);
+                break;
+        }
+    }
+
+    filamat::LineDictionary textDictionary;
+    for (auto const* entries : { &glslEntries, &essl1Entries, &mslEntries }) {
+        for (const auto& s : *entries) {
+            textDictionary.addText(s.shader);
+        }
+    }
+    if (!textDictionary.isEmpty()) {
+        const auto& dictionaryChunk = outputChunks.push<filamat::DictionaryTextChunk>(
+                std::move(textDictionary), filamat::ChunkType::DictionaryText);
+        if (!glslEntries.empty()) {
+            outputChunks.push<filamat::MaterialTextChunk>(std::move(glslEntries),
+                    dictionaryChunk.getDictionary(), filamat::ChunkType::MaterialGlsl);
+        }
+        if (!essl1Entries.empty()) {
+            outputChunks.push<filamat::MaterialTextChunk>(std::move(essl1Entries),
+                    dictionaryChunk.getDictionary(), filamat::ChunkType::MaterialEssl1);
+        }
+        if (!mslEntries.empty()) {
+            outputChunks.push<filamat::MaterialTextChunk>(std::move(mslEntries),
+                    dictionaryChunk.getDictionary(), filamat::ChunkType::MaterialMetal);
+        }
+    }
+
+    if (!spirvEntries.empty()) {
+        filamat::BlobDictionary spirvDictionary;
+        for (auto& s : spirvEntries) {
+            std::vector<uint8_t> spirv = std::move(s.data);
+            s.dictionaryIndex = spirvDictionary.addBlob(spirv);
+        }
+        // the blobs are copied from the input, which was already stripped if needed
+        const bool stripInfo = false;
+        outputChunks.push<filamat::DictionarySpirvChunk>(std::move(spirvDictionary), stripInfo);
+        outputChunks.push<filamat::MaterialBinaryChunk>(
+                std::move(spirvEntries), filamat::ChunkType::MaterialSpirv);
+    }
+
+    if (!metalLibraryEntries.empty()) {
+        filamat::BlobDictionary metalLibraryDictionary;
+        for (auto& e : metalLibraryEntries) {
+            std::vector<uint8_t> data = std::move(e.data);
+            e.dictionaryIndex = metalLibraryDictionary.addBlob(data);
+        }
+        outputChunks.push<filamat::DictionaryMetalLibraryChunk>(
+                std::move(metalLibraryDictionary));
+        outputChunks.push<filamat::MaterialBinaryChunk>(
+                std::move(metalLibraryEntries), filamat::ChunkType::MaterialMetalLibrary);
+    }
+
+    Package package(outputChunks.getSize());
+    Flattener f { package.getData() };
+    outputChunks.flatten(f);
+
+    assert_invariant(package.isValid());
+
+    std::ofstream out(output.c_str(), std::ofstream::binary);
+    out.write(reinterpret_cast<const char*>(package.getData()), std::streamsize(package.getSize()));
+    if (!out) {
+        std::cerr << "Could not write the output material " << output << std::endl;
+        return 1;
+    }
+
+    std::cout << "Removed " << removed << " of " << total << " shaders from '"
+              << name.c_str_safe() << "'." << std::endl;
+    return 0;
+}
+
+} // namespace matedit
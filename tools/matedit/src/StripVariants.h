@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_MATEDIT_STRIPVARIANTS_H
+#define TNT_MATEDIT_STRIPVARIANTS_H
+
+#include <utils/Path.h>
+
+namespace matedit {
+
+// Removes the shaders that the variant usage profile written by
+// Engine::writeVariantUsageProfile() doesn't list for this material.
+int stripVariants(utils::Path input, utils::Path output, utils::Path profile);
+
+} // namespace matedit
+
+#endif
@@ -17,6 +17,7 @@
 #include <getopt/getopt.h>
 
 #include "ExternalCompile.h"
+#include "StripVariants.h"
 
 #include <utils/Path.h>
 
@@ -43,6 +44,7 @@ static void printUsage(const char* name) {
         "\n"
         "Usage:\n"
         "    MATEDIT [options] -o <output file> -i <input file> external-compile -- <script> [<script args>...]\n"
+        "    MATEDIT -o <output file> -i <input file> strip-variants <profile>\n"
         "\n"
         "Options:\n"
         "   --help, -h\n"
@@ -90,8 +92,15 @@ static void printUsage(const char* name) {
         "       If script exits with a non-zero exit code, MATEDIT will terminate with error. Multiple\n"
         "       invocations of script may be launched in parallel.\n"
         "\n"
+        "   strip-variants\n"
+        "       Removes the shaders of the variants that the given profile doesn't list for this material.\n"
+        "       The profile is written by the application with Engine::writeVariantUsageProfile(), it\n"
+        "       must be recorded while all the features the application relies on are exercised (e.g.\n"
+        "       shadows, fog, stereo), since the engine cannot load the variants that are removed.\n"
+        "\n"
         "Example:\n"
         "   MATEDIT -o out.cmat -i in.cmat --type metal external-compile -- ./my_compile-script.sh --sdk iphones\n"
+        "   MATEDIT -o out.filamat -i in.filamat strip-variants variants.txt\n"
     );
 
     const std::string from("MATEDIT");
@@ -182,13 +191,13 @@ int main(int argc, char* argv[]) {
     }
 
     const std::string command = argv[optionIndex++];
-    if (command != "external-compile") {
-        std::cerr << "Unrecognized command: '" << command << "'. Must be 'external-compile'"
-                  << std::endl;
+    if (command != "external-compile" && command != "strip-variants") {
+        std::cerr << "Unrecognized command: '" << command
+                  << "'. Must be 'external-compile' or 'strip-variants'" << std::endl;
         return 1;
     }
 
-    // Ignore any "--" arguments between "external-compile" and the name of the script.
+    // Ignore any "--" arguments between the command and its arguments.
     int i = optionIndex;
     while (i < argc && strcmp(argv[i], "--") == 0) {
         i++;
@@ -198,6 +207,17 @@ int main(int argc, char* argv[]) {
         config.commandArgs.emplace_back(argv[i]);
     }
 
+    if (command == "strip-variants") {
+        if (config.commandArgs.size() != 1) {
+            std::cerr << "strip-variants requires the path to a variant usage profile" << std::endl
+                      << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        return matedit::stripVariants(
+                config.inputFile, config.outputFile, config.commandArgs[0]);
+    }
+
     if (config.commandArgs.empty()) {
         std::cerr << "external-compile requires the path to a script to execute" << std::endl
                   << std::endl;
@@ -25,6 +25,8 @@
 #include <matdbg/ShaderInfo.h>
 #include <matdbg/TextWriter.h>
 
+#include <ShaderCost.h>
+
 #include <spirv_glsl.hpp>
 #include <spirv-tools/libspirv.h>
 
@@ -57,6 +59,9 @@ struct Config {
     bool transpile = false;
     bool binary = false;
     bool analyze = false;
+    bool printCost = false;
+    uint32_t maxAluCount = 0;       // 0 means no limit
+    uint32_t maxTextureCount = 0;   // 0 means no limit
     uint64_t shaderIndex;
     int serverPort = 0;
 };
@@ -104,6 +109,12 @@ static void printUsage(const char* name) {
             "       Print copyright and license information\n\n"
             "   --analyze-spirv=[index], -a\n"
             "       Print annotated GLSL for the nth shader (0 is the first Vulkan shader)\n\n"
+            "   --print-cost, -c\n"
+            "       Print the static instruction counts of every Vulkan shader\n\n"
+            "   --max-alu=[count]\n"
+            "       With --print-cost, fail if a shader has more ALU instructions than this\n\n"
+            "   --max-texture=[count]\n"
+            "       With --print-cost, fail if a shader has more texture instructions than this\n\n"
     );
 
     const std::string from("MATINFO");
@@ -125,8 +136,10 @@ static void license() {
 }
 
 static int handleArguments(int argc, char* argv[], Config* config) {
-    static constexpr const char* OPTSTR = "hla:g:G:s:v:b:m:b:w:Xxyz";
+    static constexpr const char* OPTSTR = "hla:cg:G:s:v:b:m:b:w:Xxyz";
     constexpr int DUMP_METAL_LIBRARY_OPTION = 1000;
+    constexpr int MAX_ALU_OPTION = 1001;
+    constexpr int MAX_TEXTURE_OPTION = 1002;
     static const struct option OPTIONS[] = {
             { "help",               no_argument,       nullptr, 'h' },
             { "license",            no_argument,       nullptr, 'l' },
@@ -144,6 +157,9 @@ static int handleArguments(int argc, char* argv[], Config* config) {
             { "dump-spirv-binary",  required_argument, nullptr, 'b' },
             { "dump-metal-library",  required_argument, nullptr,  DUMP_METAL_LIBRARY_OPTION },
             { "web-server",         required_argument, nullptr, 'w' },
+            { "print-cost",         no_argument,       nullptr, 'c' },
+            { "max-alu",            required_argument, nullptr,  MAX_ALU_OPTION },
+            { "max-texture",        required_argument, nullptr,  MAX_TEXTURE_OPTION },
             { nullptr, 0, nullptr, 0 }  // termination of the option list
     };
 
@@ -212,6 +228,15 @@ static int handleArguments(int argc, char* argv[], Config* config) {
                 config->shaderIndex = static_cast<uint64_t>(std::stoi(arg));
                 config->binary = true;
                 break;
+            case 'c':
+                config->printCost = true;
+                break;
+            case MAX_ALU_OPTION:
+                config->maxAluCount = static_cast<uint32_t>(std::stoul(arg));
+                break;
+            case MAX_TEXTURE_OPTION:
+                config->maxTextureCount = static_cast<uint32_t>(std::stoul(arg));
+                break;
         }
     }
 
@@ -413,6 +438,80 @@ static void dumpBinary(const uint8_t* data, size_t size, const std::string& file
     out.write(reinterpret_cast<const char*>(data), size);
 }
 
+static const char* toString(filament::backend::ShaderModel model) {
+    switch (model) {
+        case filament::backend::ShaderModel::MOBILE: return "mobile";
+        case filament::backend::ShaderModel::DESKTOP: return "desktop";
+    }
+    return "--";
+}
+
+static const char* toString(filament::backend::ShaderStage stage) {
+    switch (stage) {
+        case filament::backend::ShaderStage::VERTEX: return "vertex";
+        case filament::backend::ShaderStage::FRAGMENT: return "fragment";
+        case filament::backend::ShaderStage::COMPUTE: return "compute";
+    }
+    return "--";
+}
+
+// Prints the static cost of every Vulkan shader of the material, and returns false if one of them
+// exceeds the limits given on the command line, so that heavy materials can fail a build.
+static bool printShaderCost(const Config& config, void* data, size_t size,
+        const ChunkContainer& container) {
+    using namespace std;
+
+    ShaderExtractor parser(filament::backend::ShaderLanguage::SPIRV, data, size);
+    vector<ShaderInfo> info(getShaderCount(container, filamat::ChunkType::MaterialSpirv));
+    if (info.empty() || !parser.parse() ||
+            !getShaderInfo(container, info.data(), filamat::ChunkType::MaterialSpirv)) {
+        cerr << "The shader cost can only be estimated for materials compiled for Vulkan." << endl;
+        return false;
+    }
+
+    cout << "    #    Model   Stage    Variant  Instr.    ALU  Tex.  Branch  Loops  Ld/St    Ids"
+         << endl;
+
+    size_t exceeded = 0;
+    for (size_t i = 0; i < info.size(); i++) {
+        const auto& item = info[i];
+        filaflat::ShaderContent content;
+        parser.getShader(item.shaderModel, item.variant, item.pipelineStage, content);
+
+        filamat::ShaderCost cost;
+        if (!filamat::estimateShaderCost(reinterpret_cast<uint32_t const*>(content.data()),
+                content.size() / 4, &cost)) {
+            cerr << "Shader " << i << " is not a valid SPIR-V module." << endl;
+            return false;
+        }
+
+        bool const tooHeavy =
+                (config.maxAluCount && cost.aluCount > config.maxAluCount) ||
+                (config.maxTextureCount && cost.textureCount > config.maxTextureCount);
+        exceeded += tooHeavy ? 1 : 0;
+
+        cout << "    #" << setw(4) << left << i
+             << setw(8) << toString(item.shaderModel)
+             << setw(9) << toString(item.pipelineStage)
+             << "0x" << hex << setfill('0') << setw(2) << right << +item.variant.key
+             << setfill(' ') << dec
+             << setw(11) << cost.instructionCount
+             << setw(7) << cost.aluCount
+             << setw(6) << cost.textureCount
+             << setw(8) << cost.branchCount
+             << setw(7) << cost.loopCount
+             << setw(7) << cost.memoryCount
+             << setw(7) << cost.idBound
+             << (tooHeavy ? "  exceeds the limits" : "") << endl;
+    }
+
+    if (exceeded) {
+        cerr << exceeded << " shader(s) exceed the cost limits." << endl;
+        return false;
+    }
+    return true;
+}
+
 static bool parseChunks(Config config, void* data, size_t size) {
     using namespace filament::matdbg;
     ChunkContainer container(data, size);
@@ -440,6 +539,10 @@ static bool parseChunks(Config config, void* data, size_t size) {
         return true;
     }
 
+    if (config.printCost) {
+        return printShaderCost(config, data, size, container);
+    }
+
     if (config.printGLSL || config.printESSL1 || config.printSPIRV || config.printMetal) {
         filaflat::ShaderContent content;
         std::vector<ShaderInfo> info;
@@ -18,6 +18,8 @@
 
 #include <getopt/getopt.h>
 
+#include <zstd.h>
+
 #include <algorithm>
 #include <cstdint>
 #include <fstream>
@@ -40,6 +42,7 @@ static bool g_appendNull = false;
 static bool g_generateC = false;
 static bool g_quietMode = false;
 static bool g_embedJson = false;
+static bool g_compress = false;
 
 static const char* USAGE = R"TXT(
 RESGEN aggregates a sequence of binary blobs, each of which becomes a "resource" whose id
@@ -72,6 +75,11 @@ Options:
    --json, -j
        Embed a JSON string in the output that provides a summary
        of all resource sizes and names. Useful for size analysis.
+   --compress, -z
+       Compress each resource into its own zstd frame. The header
+       defines <PACKAGE>_COMPRESSED, and the sizes are those of the
+       frames, so that each resource can be decompressed when it is
+       first used with ZSTD_decompress().
     --quiet, -q
         Suppress console output
 
@@ -118,7 +126,7 @@ static void license() {
 }
 
 static int handleArguments(int argc, char* argv[]) {
-    static constexpr const char* OPTSTR = "hLp:x:ktcqj";
+    static constexpr const char* OPTSTR = "hLp:x:ktcqjz";
     static const struct option OPTIONS[] = {
             { "help",                 no_argument, 0, 'h' },
             { "license",              no_argument, 0, 'L' },
@@ -129,6 +137,7 @@ static int handleArguments(int argc, char* argv[]) {
             { "cfile",                no_argument, 0, 'c' },
             { "quiet",                no_argument, 0, 'q' },
             { "json",                 no_argument, 0, 'j' },
+            { "compress",             no_argument, 0, 'z' },
             { 0, 0, 0, 0 }  // termination of the option list
     };
 
@@ -166,6 +175,9 @@ static int handleArguments(int argc, char* argv[]) {
             case 'j':
                 g_embedJson = true;
                 break;
+            case 'z':
+                g_compress = true;
+                break;
         }
     }
 
@@ -245,7 +257,11 @@ int main(int argc, char* argv[]) {
     ostringstream headerStream;
     headerStream << "#ifndef " << packagePrefix << "H_" << endl
             << "#define " << packagePrefix << "H_" << endl << endl
-            << "#include <stdint.h>" << endl << endl
+            << "#include <stdint.h>" << endl << endl;
+    if (g_compress) {
+        headerStream << "#define " << packagePrefix << "COMPRESSED 1" << endl << endl;
+    }
+    headerStream
             << "extern \"C\" {" << endl
             << "    extern const uint8_t " << package << "[];" << endl;
 
@@ -295,6 +311,19 @@ int main(int argc, char* argv[]) {
             content.push_back(0);
         }
 
+        // The JSON summary is left uncompressed so that it can be found in the binary.
+        if (g_compress && inPath != g_jsonMagicString) {
+            vector<uint8_t> compressed(ZSTD_compressBound(content.size()));
+            const size_t size = ZSTD_compress(compressed.data(), compressed.size(),
+                    content.data(), content.size(), 19);
+            if (ZSTD_isError(size)) {
+                cerr << "Unable to compress " << inPath << ": " << ZSTD_getErrorName(size) << endl;
+                exit(1);
+            }
+            compressed.resize(size);
+            content = std::move(compressed);
+        }
+
         // Formulate the resource name and the prefixed resource name.
         std::string rname = g_keepExtension ? inPath.getName() : inPath.getNameWithoutExtension();
         replace(rname.begin(), rname.end(), '.', '_');
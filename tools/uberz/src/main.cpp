@@ -30,8 +30,6 @@
 #include <uberz/ReadableArchive.h>
 #include <uberz/WritableArchive.h>
 
-#include <zstd.h>
-
 using namespace std;
 using namespace utils;
 using namespace filament::uberz;
@@ -40,6 +38,7 @@ using StringMap = tsl::robin_map<std::string, std::string>;
 
 static std::string g_outputFile = "materials.uberz";
 static bool g_appendMode = false;
+static bool g_framedMode = false;
 static bool g_quietMode = false;
 static bool g_verboseMode = false;
 static StringMap g_templateMap;
@@ -61,6 +60,8 @@ For more information on the format of the spec file, see the gltfio README.
 Options:
    --append, -a
        Enable append mode
+   --framed, -f
+       Compress each material separately so that they can be decompressed on demand
    --help, -h
        Print this message
    --license, -L
@@ -111,9 +112,10 @@ static void insertMapEntry(std::string assignment, StringMap& map, std::string d
 }
 
 static int handleArguments(int argc, char* argv[]) {
-    static constexpr const char* OPTSTR = "ahLqvo:T:";
+    static constexpr const char* OPTSTR = "afhLqvo:T:";
     static const struct option OPTIONS[] = {
             { "append",   no_argument,       0, 'a' },
+            { "framed",   no_argument,       0, 'f' },
             { "help",     no_argument,       0, 'h' },
             { "license",  no_argument,       0, 'L' },
             { "quiet",    no_argument,       0, 'q' },
@@ -133,6 +135,9 @@ static int handleArguments(int argc, char* argv[]) {
             case 'a':
                 g_appendMode = true;
                 break;
+            case 'f':
+                g_framedMode = true;
+                break;
             case 'h':
                 printUsage(argv[0]);
                 exit(0);
@@ -172,25 +177,21 @@ int main(int argc, char* argv[]) {
 
     size_t existingMaterialsCount = 0;
     ReadableArchive* existingArchive = nullptr;
+    FixedCapacityVector<uint8_t> archiveBuffer;
 
     // In append mode, the first step is to consume the output file.
     if (g_appendMode) {
         const size_t archiveSize = getFileSize(g_outputFile.c_str());
-        FixedCapacityVector<uint8_t> archiveBuffer(archiveSize);
-        uint8_t* archiveData = archiveBuffer.data();
+        archiveBuffer = FixedCapacityVector<uint8_t>(archiveSize);
         std::ifstream in(g_outputFile.c_str(), std::ifstream::in | std::ifstream::binary);
-        if (!in.read((char*) archiveData, archiveSize)) {
+        if (!in.read((char*) archiveBuffer.data(), archiveSize)) {
             cerr << "Unable to consume " << g_outputFile << endl;
             exit(1);
         }
-        const uint64_t decompSize = ZSTD_getFrameContentSize(archiveData, archiveSize);
-        if (decompSize == ZSTD_CONTENTSIZE_UNKNOWN || decompSize == ZSTD_CONTENTSIZE_ERROR) {
+        existingArchive = decompressArchive(archiveBuffer.data(), archiveSize);
+        if (!existingArchive) {
             PANIC_POSTCONDITION("Decompression error.");
         }
-        uint64_t* basePointer = (uint64_t*) utils::aligned_alloc(decompSize, 8);
-        ZSTD_decompress(basePointer, decompSize, archiveData, archiveSize);
-        existingArchive = (ReadableArchive*) basePointer;
-        convertOffsetsToPointers(existingArchive);
         existingMaterialsCount = existingArchive->specsCount;
     }
 
@@ -203,7 +204,17 @@ int main(int argc, char* argv[]) {
             // a made-up string (it is only used for error messages).
             std::string materialName = "mat" + to_string(specIndex);
             const ArchiveSpec& spec = existingArchive->specs[specIndex];
-            outputArchive.addMaterial(materialName.c_str(), spec.package, spec.packageByteCount);
+            if (existingArchive->isFramed()) {
+                FixedCapacityVector<uint8_t> package(spec.packageByteCount);
+                if (!decompressPackage(existingArchive, spec, archiveBuffer.data(),
+                        archiveBuffer.size(), package.data())) {
+                    PANIC_POSTCONDITION("Decompression error.");
+                }
+                outputArchive.addMaterial(materialName.c_str(), package.data(), package.size());
+            } else {
+                outputArchive.addMaterial(materialName.c_str(), spec.package,
+                        spec.packageByteCount);
+            }
             outputArchive.setShadingModel(spec.shadingModel);
             outputArchive.setBlendingModel(spec.blendingMode);
             for (uint16_t flagIndex = 0; flagIndex < spec.flagsCount; ++flagIndex) {
@@ -259,7 +270,7 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    FixedCapacityVector<uint8_t> binBuffer = outputArchive.serialize();
+    FixedCapacityVector<uint8_t> binBuffer = outputArchive.serialize(g_framedMode);
 
     ofstream binStream(g_outputFile, ios::binary);
     if (!binStream) {
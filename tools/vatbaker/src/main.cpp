@@ -0,0 +1,638 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define CGLTF_IMPLEMENTATION
+#include <cgltf.h>
+
+#include <filameshio/filamesh.h>
+
+#include <image/Ktx1Bundle.h>
+
+#include <math/half.h>
+#include <math/mat3.h>
+#include <math/mat4.h>
+#include <math/norm.h>
+#include <math/quat.h>
+#include <math/vec2.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <utils/Path.h>
+
+#include <getopt/getopt.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace filament::math;
+using namespace filamesh;
+using namespace image;
+using namespace std;
+using namespace utils;
+
+static float g_fps = 30.0f;
+static uint32_t g_maxSize = 2048;
+static std::string g_meshName;
+
+static const char* USAGE = R"TXT(
+VATBAKER bakes the skinned animations of a glTF mesh into a vertex animation texture (VAT), so
+that crowds can be animated by the vertex shader, without any bones or CPU work per instance.
+
+Every animation of the file becomes a looping clip, sampled at a fixed frame rate. Two files are
+written:
+    <output>.ktx       RGBA16F texture with the position of every vertex at every frame, followed
+                       by the normals. The layout and the clips are stored in the KTX metadata.
+    <output>.filamesh  the mesh in its rest pose, with its vertices in the order of the texture.
+
+Usage:
+    VATBAKER [options] <input.gltf|input.glb> <output>
+
+Options:
+   --help, -h
+       print this message
+   --license, -L
+       print copyright and license information
+   --fps=N, -f N
+       number of frames sampled per second of animation (default: 30)
+   --size=N, -s N
+       maximum width and height of the texture (default: 2048)
+   --mesh=NAME, -m NAME
+       name of the node of the skinned mesh to bake (default: the first skinned mesh)
+
+Example:
+    VATBAKER --fps=24 character.glb crowd
+)TXT";
+
+static void printUsage(const char* name) {
+    std::string execName(Path(name).getName());
+    const std::string from("VATBAKER");
+    std::string usage(USAGE);
+    for (size_t pos = usage.find(from); pos != std::string::npos; pos = usage.find(from, pos)) {
+        usage.replace(pos, from.length(), execName);
+    }
+    puts(usage.c_str());
+}
+
+static void license() {
+    static const char *license[] = {
+        #include "licenses/licenses.inc"
+        nullptr
+    };
+
+    const char **p = &license[0];
+    while (*p)
+        std::cout << *p++ << std::endl;
+}
+
+static int handleArguments(int argc, char* argv[]) {
+    static constexpr const char* OPTSTR = "hLf:s:m:";
+    static const struct option OPTIONS[] = {
+            { "help",                 no_argument, 0, 'h' },
+            { "license",              no_argument, 0, 'L' },
+            { "fps",            required_argument, 0, 'f' },
+            { "size",           required_argument, 0, 's' },
+            { "mesh",           required_argument, 0, 'm' },
+            { 0, 0, 0, 0 }  // termination of the option list
+    };
+
+    int opt;
+    int optionIndex = 0;
+
+    while ((opt = getopt_long(argc, argv, OPTSTR, OPTIONS, &optionIndex)) >= 0) {
+        std::string arg(optarg ? optarg : "");
+        switch (opt) {
+            default:
+            case 'h':
+                printUsage(argv[0]);
+                exit(0);
+            case 'L':
+                license();
+                exit(0);
+            case 'f':
+                g_fps = std::max(1.0f, std::stof(arg));
+                break;
+            case 's':
+                g_maxSize = std::max(1, std::stoi(arg));
+                break;
+            case 'm':
+                g_meshName = arg;
+                break;
+        }
+    }
+
+    return optind;
+}
+
+// All the triangle primitives of the mesh, merged.
+struct SkinnedMesh {
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> uvs;
+    std::vector<uint4> joints;
+    std::vector<float4> weights;
+    std::vector<uint32_t> indices;
+};
+
+struct Clip {
+    std::string name;
+    uint32_t firstFrame;
+    uint32_t frameCount;
+};
+
+static void computeNormals(SkinnedMesh& mesh, size_t firstVertex, size_t firstIndex) {
+    for (size_t i = firstVertex; i < mesh.normals.size(); i++) {
+        mesh.normals[i] = float3{};
+    }
+    for (size_t i = firstIndex; i + 2 < mesh.indices.size(); i += 3) {
+        uint32_t const a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+        // area weighted
+        float3 const n = cross(mesh.positions[b] - mesh.positions[a],
+                mesh.positions[c] - mesh.positions[a]);
+        mesh.normals[a] += n;
+        mesh.normals[b] += n;
+        mesh.normals[c] += n;
+    }
+    for (size_t i = firstVertex; i < mesh.normals.size(); i++) {
+        float const l = length(mesh.normals[i]);
+        mesh.normals[i] = l > 0.0f ? mesh.normals[i] / l : float3{ 0, 0, 1 };
+    }
+}
+
+static bool loadMesh(cgltf_mesh const& gltfMesh, SkinnedMesh& mesh) {
+    for (cgltf_size p = 0; p < gltfMesh.primitives_count; p++) {
+        cgltf_primitive const& primitive = gltfMesh.primitives[p];
+        if (primitive.type != cgltf_primitive_type_triangles) {
+            cerr << "Warning: skipping a primitive that isn't made of triangles." << endl;
+            continue;
+        }
+        cgltf_accessor const* positions = nullptr;
+        cgltf_accessor const* normals = nullptr;
+        cgltf_accessor const* uvs = nullptr;
+        cgltf_accessor const* joints = nullptr;
+        cgltf_accessor const* weights = nullptr;
+        for (cgltf_size a = 0; a < primitive.attributes_count; a++) {
+            cgltf_attribute const& attribute = primitive.attributes[a];
+            switch (attribute.type) {
+                case cgltf_attribute_type_position: positions = attribute.data; break;
+                case cgltf_attribute_type_normal: normals = attribute.data; break;
+                case cgltf_attribute_type_texcoord:
+                    uvs = attribute.index == 0 ? attribute.data : uvs;
+                    break;
+                case cgltf_attribute_type_joints:
+                    joints = attribute.index == 0 ? attribute.data : joints;
+                    break;
+                case cgltf_attribute_type_weights:
+                    weights = attribute.index == 0 ? attribute.data : weights;
+                    break;
+                default: break;
+            }
+        }
+        if (!positions || !joints || !weights) {
+            cerr << "Primitives must have positions, joints and weights." << endl;
+            return false;
+        }
+
+        size_t const firstVertex = mesh.positions.size();
+        size_t const firstIndex = mesh.indices.size();
+        for (cgltf_size i = 0; i < positions->count; i++) {
+            float3 position{};
+            float3 normal{ 0, 0, 1 };
+            float2 uv{};
+            uint4 joint{};
+            float4 weight{};
+            cgltf_accessor_read_float(positions, i, &position.x, 3);
+            if (normals) {
+                cgltf_accessor_read_float(normals, i, &normal.x, 3);
+            }
+            if (uvs) {
+                cgltf_accessor_read_float(uvs, i, &uv.x, 2);
+            }
+            cgltf_accessor_read_uint(joints, i, &joint.x, 4);
+            cgltf_accessor_read_float(weights, i, &weight.x, 4);
+            mesh.positions.push_back(position);
+            mesh.normals.push_back(normal);
+            mesh.uvs.push_back(uv);
+            mesh.joints.push_back(joint);
+            mesh.weights.push_back(weight);
+        }
+
+        uint32_t const base = uint32_t(firstVertex);
+        if (primitive.indices) {
+            for (cgltf_size i = 0; i < primitive.indices->count; i++) {
+                mesh.indices.push_back(
+                        base + uint32_t(cgltf_accessor_read_index(primitive.indices, i)));
+            }
+        } else {
+            for (cgltf_size i = 0; i < positions->count; i++) {
+                mesh.indices.push_back(base + uint32_t(i));
+            }
+        }
+
+        if (!normals) {
+            computeNormals(mesh, firstVertex, firstIndex);
+        }
+    }
+    return !mesh.positions.empty();
+}
+
+// Evaluates an animation sampler, n is the number of components of the animated property.
+static void sample(cgltf_animation_sampler const& sampler, float time, float* out, size_t n) {
+    cgltf_accessor const* input = sampler.input;
+    cgltf_accessor const* output = sampler.output;
+    bool const cubic = sampler.interpolation == cgltf_interpolation_type_cubic_spline;
+    // cubic splines store an in-tangent, a value and an out-tangent per key
+    cgltf_size const stride = cubic ? 3 : 1;
+    cgltf_size const offset = cubic ? 1 : 0;
+
+    auto const keyTime = [input](cgltf_size k) {
+        float t = 0;
+        cgltf_accessor_read_float(input, k, &t, 1);
+        return t;
+    };
+
+    cgltf_size const count = input->count;
+    if (count == 1 || time <= keyTime(0)) {
+        cgltf_accessor_read_float(output, offset, out, n);
+        return;
+    }
+    if (time >= keyTime(count - 1)) {
+        cgltf_accessor_read_float(output, (count - 1) * stride + offset, out, n);
+        return;
+    }
+
+    cgltf_size k = 0;
+    while (k + 2 < count && keyTime(k + 1) <= time) {
+        k++;
+    }
+    float const t0 = keyTime(k);
+    float const t1 = keyTime(k + 1);
+    float const dt = t1 - t0;
+    float const t = dt > 0.0f ? (time - t0) / dt : 0.0f;
+
+    float4 v0{}, v1{};
+    cgltf_accessor_read_float(output, k * stride + offset, &v0.x, n);
+    cgltf_accessor_read_float(output, (k + 1) * stride + offset, &v1.x, n);
+
+    float4 result;
+    if (sampler.interpolation == cgltf_interpolation_type_step) {
+        result = v0;
+    } else if (cubic) {
+        float4 m0{}, m1{};
+        cgltf_accessor_read_float(output, k * stride + 2, &m0.x, n);
+        cgltf_accessor_read_float(output, (k + 1) * stride, &m1.x, n);
+        float const t2 = t * t;
+        float const t3 = t2 * t;
+        result = (2 * t3 - 3 * t2 + 1) * v0 + (t3 - 2 * t2 + t) * dt * m0 +
+                 (-2 * t3 + 3 * t2) * v1 + (t3 - t2) * dt * m1;
+        if (n == 4) {
+            result = normalize(result);
+        }
+    } else if (n == 4) {
+        // rotations are the only 4 components properties
+        quatf const q = slerp(quatf{ v0.w, v0.x, v0.y, v0.z }, quatf{ v1.w, v1.x, v1.y, v1.z }, t);
+        result = { q.x, q.y, q.z, q.w };
+    } else {
+        result = mix(v0, v1, t);
+    }
+    std::copy_n(&result.x, n, out);
+}
+
+static void applyAnimation(cgltf_animation const& animation, float time) {
+    for (cgltf_size c = 0; c < animation.channels_count; c++) {
+        cgltf_animation_channel const& channel = animation.channels[c];
+        cgltf_node* const node = channel.target_node;
+        if (!node) {
+            continue;
+        }
+        switch (channel.target_path) {
+            case cgltf_animation_path_type_translation:
+                sample(*channel.sampler, time, node->translation, 3);
+                node->has_translation = true;
+                break;
+            case cgltf_animation_path_type_rotation:
+                sample(*channel.sampler, time, node->rotation, 4);
+                node->has_rotation = true;
+                break;
+            case cgltf_animation_path_type_scale:
+                sample(*channel.sampler, time, node->scale, 3);
+                node->has_scale = true;
+                break;
+            default:
+                // morph target weights aren't baked
+                break;
+        }
+    }
+}
+
+static void getTimeRange(cgltf_animation const& animation, float* start, float* end) {
+    *start = std::numeric_limits<float>::max();
+    *end = 0.0f;
+    for (cgltf_size s = 0; s < animation.samplers_count; s++) {
+        cgltf_accessor const* input = animation.samplers[s].input;
+        if (input->has_min && input->has_max) {
+            *start = std::min(*start, input->min[0]);
+            *end = std::max(*end, input->max[0]);
+        }
+    }
+    *start = std::min(*start, *end);
+}
+
+template<typename T>
+static void write(ostream& out, T const* data, size_t count) {
+    out.write((char const*) data, std::streamsize(sizeof(T) * count));
+}
+
+// Writes the rest pose, non-interleaved and without optimization so that the order of the
+// vertices matches the texture.
+static bool writeMesh(std::string const& path, SkinnedMesh const& mesh, Box const& aabb) {
+    ofstream out(path, ios::binary);
+    if (!out) {
+        return false;
+    }
+
+    uint32_t const vertexCount = uint32_t(mesh.positions.size());
+    bool const index16 = vertexCount <= std::numeric_limits<uint16_t>::max();
+
+    std::vector<half4> positions(vertexCount);
+    std::vector<short4> tangents(vertexCount);
+    std::vector<ubyte4> colors(vertexCount, ubyte4{ 255 });
+    std::vector<half2> uvs(vertexCount);
+    // The normals come from the texture. With an identity tangent frame, the normal of the
+    // texture is also the normal in tangent space, which is what the material outputs.
+    short4 const identity = packSnorm16(float4{ 0, 0, 0, 1 });
+    for (size_t i = 0; i < vertexCount; i++) {
+        positions[i] = half4{ float4{ mesh.positions[i], 1.0f }};
+        tangents[i] = identity;
+        uvs[i] = half2{ mesh.uvs[i] };
+    }
+
+    Header header{};
+    header.version = VERSION;
+    header.parts = 1;
+    header.aabb = aabb;
+    header.flags = 0;
+    header.offsetPosition = 0;
+    header.offsetTangents = vertexCount * sizeof(half4);
+    header.offsetColor = header.offsetTangents + vertexCount * sizeof(short4);
+    header.offsetUV0 = header.offsetColor + vertexCount * sizeof(ubyte4);
+    header.offsetUV1 = std::numeric_limits<uint32_t>::max();
+    header.strideUV1 = std::numeric_limits<uint32_t>::max();
+    header.vertexCount = vertexCount;
+    header.vertexSize = vertexCount * uint32_t(
+            sizeof(half4) + sizeof(short4) + sizeof(ubyte4) + sizeof(half2));
+    header.indexType = index16 ? UI16 : UI32;
+    header.indexCount = uint32_t(mesh.indices.size());
+    header.indexSize = header.indexCount * (index16 ? sizeof(uint16_t) : sizeof(uint32_t));
+
+    Part const part{
+            .offset = 0,
+            .indexCount = header.indexCount,
+            .minIndex = 0,
+            .maxIndex = vertexCount - 1,
+            .material = 0,
+            .aabb = aabb
+    };
+
+    write(out, MAGICID, sizeof(MAGICID));
+    write(out, &header, 1);
+    write(out, positions.data(), positions.size());
+    write(out, tangents.data(), tangents.size());
+    write(out, colors.data(), colors.size());
+    write(out, uvs.data(), uvs.size());
+    if (index16) {
+        std::vector<uint16_t> const indices(mesh.indices.begin(), mesh.indices.end());
+        write(out, indices.data(), indices.size());
+    } else {
+        write(out, mesh.indices.data(), mesh.indices.size());
+    }
+    write(out, &part, 1);
+
+    std::string const material("DefaultMaterial");
+    uint32_t const materialCount = 1;
+    uint32_t const nameLength = uint32_t(material.size());
+    write(out, &materialCount, 1);
+    write(out, &nameLength, 1);
+    write(out, material.c_str(), material.size() + 1);
+    return bool(out);
+}
+
+int main(int argc, char* argv[]) {
+    int const optionIndex = handleArguments(argc, argv);
+    if (argc - optionIndex < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    Path const input(argv[optionIndex]);
+    std::string const output(argv[optionIndex + 1]);
+
+    cgltf_options options{};
+    cgltf_data* data = nullptr;
+    if (cgltf_parse_file(&options, input.c_str(), &data) != cgltf_result_success ||
+            cgltf_load_buffers(&options, data, input.c_str()) != cgltf_result_success) {
+        cerr << "Unable to load " << input << endl;
+        cgltf_free(data);
+        return 1;
+    }
+
+    cgltf_node const* meshNode = nullptr;
+    for (cgltf_size i = 0; i < data->nodes_count && !meshNode; i++) {
+        cgltf_node const& node = data->nodes[i];
+        if (node.mesh && node.skin &&
+                (g_meshName.empty() || (node.name && g_meshName == node.name))) {
+            meshNode = &node;
+        }
+    }
+    if (!meshNode) {
+        cerr << "No skinned mesh found in " << input << endl;
+        cgltf_free(data);
+        return 1;
+    }
+    if (data->animations_count == 0) {
+        cerr << "No animations found in " << input << endl;
+        cgltf_free(data);
+        return 1;
+    }
+
+    SkinnedMesh mesh;
+    if (!loadMesh(*meshNode->mesh, mesh)) {
+        cgltf_free(data);
+        return 1;
+    }
+
+    cgltf_skin const& skin = *meshNode->skin;
+    std::vector<mat4f> inverseBindMatrices(skin.joints_count);
+    if (skin.inverse_bind_matrices) {
+        for (cgltf_size j = 0; j < skin.joints_count; j++) {
+            cgltf_accessor_read_float(skin.inverse_bind_matrices, j,
+                    &inverseBindMatrices[j][0][0], 16);
+        }
+    }
+
+    // every clip starts from the rest pose, for the nodes it doesn't animate
+    std::vector<cgltf_node> const restPose(data->nodes, data->nodes + data->nodes_count);
+
+    size_t const vertexCount = mesh.positions.size();
+    std::vector<Clip> clips;
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<mat4f> jointMatrices(skin.joints_count);
+    std::vector<mat3f> normalMatrices(skin.joints_count);
+    float3 boundsMin{ std::numeric_limits<float>::max() };
+    float3 boundsMax{ std::numeric_limits<float>::lowest() };
+
+    for (cgltf_size a = 0; a < data->animations_count; a++) {
+        cgltf_animation const& animation = data->animations[a];
+        std::copy(restPose.begin(), restPose.end(), data->nodes);
+
+        float start, end;
+        getTimeRange(animation, &start, &end);
+        // the clips loop, the frame after the last one is the first one
+        uint32_t const frameCount = std::max(1u, uint32_t(std::lround((end - start) * g_fps)));
+
+        std::string name = animation.name ? animation.name : "clip" + std::to_string(a);
+        std::replace(name.begin(), name.end(), ' ', '_');
+        clips.push_back({ name, uint32_t(positions.size() / vertexCount), frameCount });
+
+        for (uint32_t f = 0; f < frameCount; f++) {
+            applyAnimation(animation, start + float(f) / g_fps);
+
+            // the transform of the skinned mesh's node doesn't apply, only the joints' do
+            for (cgltf_size j = 0; j < skin.joints_count; j++) {
+                mat4f world;
+                cgltf_node_transform_world(skin.joints[j], &world[0][0]);
+                jointMatrices[j] = world * inverseBindMatrices[j];
+                normalMatrices[j] = cof(jointMatrices[j].upperLeft());
+            }
+
+            for (size_t v = 0; v < vertexCount; v++) {
+                float4 const weights = mesh.weights[v];
+                float const sum = weights.x + weights.y + weights.z + weights.w;
+                float3 position = mesh.positions[v];
+                float3 normal = mesh.normals[v];
+                if (sum > 0.0f) {
+                    position = float3{};
+                    normal = float3{};
+                    for (size_t k = 0; k < 4; k++) {
+                        uint32_t const joint = mesh.joints[v][k];
+                        if (weights[k] == 0.0f || joint >= skin.joints_count) {
+                            continue;
+                        }
+                        float const w = weights[k] / sum;
+                        position += w * (jointMatrices[joint] *
+                                float4{ mesh.positions[v], 1.0f }).xyz;
+                        normal += w * (normalMatrices[joint] * mesh.normals[v]);
+                    }
+                    float const l = length(normal);
+                    normal = l > 0.0f ? normal / l : mesh.normals[v];
+                }
+                boundsMin = min(boundsMin, position);
+                boundsMax = max(boundsMax, position);
+                positions.push_back(position);
+                normals.push_back(normal);
+            }
+        }
+    }
+
+    // Each frame takes rowsPerFrame rows of the texture, all the positions come first, then all
+    // the normals.
+    uint32_t const frameCount = uint32_t(positions.size() / vertexCount);
+    uint32_t const width = std::min(uint32_t(vertexCount), g_maxSize);
+    uint32_t const rowsPerFrame = uint32_t((vertexCount + width - 1) / width);
+    uint32_t const height = 2 * frameCount * rowsPerFrame;
+    if (height > g_maxSize) {
+        cerr << "The texture would be " << width << "x" << height << ", lower the frame rate or "
+                "increase the maximum size." << endl;
+        cgltf_free(data);
+        return 1;
+    }
+
+    // The positions are normalized to the bounds, which makes the most of the half floats.
+    float3 const extent = max(boundsMax - boundsMin, float3{ std::numeric_limits<float>::min() });
+    std::vector<half4> texels(size_t(width) * height, half4{ 0.0f });
+    for (uint32_t f = 0; f < frameCount; f++) {
+        for (size_t v = 0; v < vertexCount; v++) {
+            size_t const x = v % width;
+            size_t const y = f * rowsPerFrame + v / width;
+            size_t const i = f * vertexCount + v;
+            texels[y * width + x] = half4{ float4{ (positions[i] - boundsMin) / extent, 1.0f }};
+            texels[(y + frameCount * rowsPerFrame) * width + x] =
+                    half4{ float4{ normals[i], 0.0f }};
+        }
+    }
+
+    Ktx1Bundle ktx(1, 1, false);
+    ktx.info() = {
+            .endianness = Ktx1Bundle::ENDIAN_DEFAULT,
+            .glType = Ktx1Bundle::HALF_FLOAT,
+            .glTypeSize = 2,
+            .glFormat = Ktx1Bundle::RGBA,
+            .glInternalFormat = Ktx1Bundle::RGBA16F,
+            .glBaseInternalFormat = Ktx1Bundle::RGBA,
+            .pixelWidth = width,
+            .pixelHeight = height,
+            .pixelDepth = 0,
+    };
+    ktx.setBlob({}, (uint8_t const*) texels.data(), uint32_t(texels.size() * sizeof(half4)));
+
+    auto const toString = [](float3 v) {
+        std::ostringstream s;
+        s << v.x << " " << v.y << " " << v.z;
+        return s.str();
+    };
+    std::ostringstream clipList;
+    for (Clip const& clip : clips) {
+        clipList << clip.firstFrame << " " << clip.frameCount << " " << clip.name << "\n";
+    }
+    ktx.setMetadata("vat.vertexCount", std::to_string(vertexCount).c_str());
+    ktx.setMetadata("vat.frameCount", std::to_string(frameCount).c_str());
+    ktx.setMetadata("vat.rowsPerFrame", std::to_string(rowsPerFrame).c_str());
+    ktx.setMetadata("vat.fps", std::to_string(g_fps).c_str());
+    ktx.setMetadata("vat.boundsMin", toString(boundsMin).c_str());
+    ktx.setMetadata("vat.boundsMax", toString(boundsMax).c_str());
+    ktx.setMetadata("vat.clips", clipList.str().c_str());
+
+    std::vector<uint8_t> bytes(ktx.getSerializedLength());
+    ktx.serialize(bytes.data(), uint32_t(bytes.size()));
+    ofstream ktxFile(output + ".ktx", ios::binary);
+    write(ktxFile, bytes.data(), bytes.size());
+    if (!ktxFile) {
+        cerr << "Unable to write " << output << ".ktx" << endl;
+        cgltf_free(data);
+        return 1;
+    }
+
+    if (!writeMesh(output + ".filamesh", mesh, Box().set(boundsMin, boundsMax))) {
+        cerr << "Unable to write " << output << ".filamesh" << endl;
+        cgltf_free(data);
+        return 1;
+    }
+
+    cout << "Baked " << clips.size() << " clips, " << frameCount << " frames of " << vertexCount
+         << " vertices into a " << width << "x" << height << " texture." << endl;
+    for (Clip const& clip : clips) {
+        cout << "    " << clip.name << ": frames " << clip.firstFrame << " to "
+             << clip.firstFrame + clip.frameCount - 1 << endl;
+    }
+
+    cgltf_free(data);
+    return 0;
+}
@@ -333,6 +333,12 @@ Filament.loadClassExtensions = function() {
         this._setVignetteOptions(options);
     };
 
+    /// setAutoExposureOptions ::method::
+    Filament.View.prototype.setAutoExposureOptions = function(overrides) {
+        const options = this.setAutoExposureOptionsDefaults(overrides);
+        this._setAutoExposureOptions(options);
+    };
+
     /// setGuardBandOptions ::method::
     Filament.View.prototype.setGuardBandOptions = function(overrides) {
         const options = this.setGuardBandOptionsDefaults(overrides);
@@ -382,6 +388,57 @@ Filament.loadClassExtensions = function() {
         buffer.delete();
     };
 
+    /// TransformManager ::core class::
+
+    /// setTransforms ::method:: Sets the local transforms of many entities with a single call, \
+    /// in one local transform transaction.
+    /// entities ::argument:: Uint32Array of entity ids, see [Entity] getId()
+    /// matrices ::argument:: Float32Array of 16 numbers (mat4) per entity
+    Filament.TransformManager.prototype.setTransforms = function(entities, matrices) {
+        const ids = Filament.Buffer(entities);
+        const values = Filament.Buffer(matrices);
+        this._setTransforms(ids, values);
+        ids.delete();
+        values.delete();
+    };
+
+    /// MaterialInstance ::core class::
+
+    function setParameters(setter, instances, name, values) {
+        const buffer = Filament.Buffer(values);
+        setter(instances, name, buffer);
+        buffer.delete();
+    }
+
+    /// setFloatParameters ::static method:: Sets the same parameter on many material instances \
+    /// with a single call.
+    /// instances ::argument:: [MaterialInstanceVector]
+    /// name ::argument:: string
+    /// values ::argument:: Float32Array with one value per instance
+    Filament.MaterialInstance.setFloatParameters = function(instances, name, values) {
+        setParameters(Filament.MaterialInstance._setFloatParameters, instances, name, values);
+    };
+
+    /// setFloat2Parameters ::static method:: Like setFloatParameters, 2 numbers per instance.
+    Filament.MaterialInstance.setFloat2Parameters = function(instances, name, values) {
+        setParameters(Filament.MaterialInstance._setFloat2Parameters, instances, name, values);
+    };
+
+    /// setFloat3Parameters ::static method:: Like setFloatParameters, 3 numbers per instance.
+    Filament.MaterialInstance.setFloat3Parameters = function(instances, name, values) {
+        setParameters(Filament.MaterialInstance._setFloat3Parameters, instances, name, values);
+    };
+
+    /// setFloat4Parameters ::static method:: Like setFloatParameters, 4 numbers per instance.
+    Filament.MaterialInstance.setFloat4Parameters = function(instances, name, values) {
+        setParameters(Filament.MaterialInstance._setFloat4Parameters, instances, name, values);
+    };
+
+    /// setMat4Parameters ::static method:: Like setFloatParameters, 16 numbers per instance.
+    Filament.MaterialInstance.setMat4Parameters = function(instances, name, values) {
+        setParameters(Filament.MaterialInstance._setMat4Parameters, instances, name, values);
+    };
+
     Filament.LightManager$Builder.prototype.shadowOptions = function(overrides) {
         return this._shadowOptions(Filament.shadowOptions(overrides));
     };
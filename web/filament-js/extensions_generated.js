@@ -25,6 +25,7 @@ Filament.loadGeneratedExtensions = function() {
             threshold: true,
             enabled: false,
             highlight: 1000.0,
+            quarterResolution: false,
             quality: Filament.View$QualityLevel.LOW,
             lensFlare: false,
             starburst: true,
@@ -85,6 +86,20 @@ Filament.loadGeneratedExtensions = function() {
         return Object.assign(options, overrides);
     };
 
+    Filament.View.prototype.setAutoExposureOptionsDefaults = function(overrides) {
+        const options = {
+            minLogLuminance: -8.0,
+            maxLogLuminance: 8.0,
+            lowPercentile: 0.5,
+            highPercentile: 0.95,
+            speedUp: 3.0,
+            speedDown: 1.0,
+            compensation: 0.0,
+            enabled: false,
+        };
+        return Object.assign(options, overrides);
+    };
+
     Filament.View.prototype.setRenderQualityDefaults = function(overrides) {
         const options = {
             hdrColorBuffer: Filament.View$QualityLevel.HIGH,
@@ -163,6 +178,7 @@ Filament.loadGeneratedExtensions = function() {
             bias: 0.01,
             maxDistance: 3.0,
             stride: 2.0,
+            resolution: 1.0,
             enabled: false,
         };
         return Object.assign(options, overrides);
@@ -27,6 +27,7 @@ export as namespace Filament;
 
 export function getSupportedFormatSuffix(desired: string): void;
 export function init(assets: string[], onready?: (() => void) | null): void;
+export function isMultithreadingSupported(): boolean;
 export function fetch(assets: string[], onDone?: (() => void) | null, onFetched?: ((name: string) => void) | null): void;
 export function clearAssetCache(): void;
 export function vectorToArray<T>(vector: Vector<T>): T[];
@@ -191,6 +192,16 @@ export class MaterialInstance {
     public setStencilReferenceValue(value: Number, face?: StencilFace): void;
     public setStencilReadMask(readMask: Number, face?: StencilFace): void;
     public setStencilWriteMask(writeMask: Number, face?: StencilFace): void;
+    public static setFloatParameters(instances: MaterialInstanceVector, name: string,
+            values: Float32Array): void;
+    public static setFloat2Parameters(instances: MaterialInstanceVector, name: string,
+            values: Float32Array): void;
+    public static setFloat3Parameters(instances: MaterialInstanceVector, name: string,
+            values: Float32Array): void;
+    public static setFloat4Parameters(instances: MaterialInstanceVector, name: string,
+            values: Float32Array): void;
+    public static setMat4Parameters(instances: MaterialInstanceVector, name: string,
+            values: Float32Array): void;
 }
 
 export class EntityManager {
@@ -504,6 +515,7 @@ export class View {
     public setBloomOptions(options: View$BloomOptions): void;
     public setFogOptions(options: View$FogOptions): void;
     public setVignetteOptions(options: View$VignetteOptions): void;
+    public setAutoExposureOptions(options: View$AutoExposureOptions): void;
     public setGuardBandOptions(options: View$GuardBandOptions): void;
     public setStereoscopicOptions(options: View$StereoscopicOptions): void;
     public setAmbientOcclusion(ambientOcclusion: View$AmbientOcclusion): void;
@@ -523,6 +535,7 @@ export class TransformManager {
     public destroy(entity: Entity): void;
     public setParent(instance: TransformManager$Instance, parent: TransformManager$Instance): void;
     public setTransform(instance: TransformManager$Instance, xform: mat4): void;
+    public setTransforms(entities: Uint32Array, matrices: Float32Array): void;
     public getTransform(instance: TransformManager$Instance): mat4;
     public getWorldTransform(instance: TransformManager$Instance): mat4;
     public openLocalTransformTransaction(): void;
@@ -1250,6 +1263,10 @@ export interface View$BloomOptions {
      * limit highlights to this value before bloom [10, +inf]
      */
     highlight?: number;
+    /**
+     * downsample 4x per pass, faster but more aliasing
+     */
+    quarterResolution?: boolean;
     /**
      * Bloom quality level.
      * LOW (default): use a more optimized down-sampling filter, however there can be artifacts
@@ -1496,6 +1513,48 @@ export interface View$VignetteOptions {
     enabled?: boolean;
 }
 
+/**
+ * Options for automatic exposure, which scales the HDR color buffer before color grading so that
+ * the average luminance of the scene maps to middle gray. The average is computed on the GPU
+ * from a histogram of the color buffer and adapts smoothly over time.
+ *
+ * Automatic exposure is applied on top of the camera's exposure.
+ */
+export interface View$AutoExposureOptions {
+    /**
+     * lowest log2 luminance tracked by the histogram
+     */
+    minLogLuminance?: number;
+    /**
+     * highest log2 luminance tracked by the histogram
+     */
+    maxLogLuminance?: number;
+    /**
+     * darker pixels are ignored when averaging, between 0 and 1
+     */
+    lowPercentile?: number;
+    /**
+     * brighter pixels are ignored when averaging, between 0 and 1
+     */
+    highPercentile?: number;
+    /**
+     * adaptation speed when the scene gets brighter, in 1/s
+     */
+    speedUp?: number;
+    /**
+     * adaptation speed when the scene gets darker, in 1/s
+     */
+    speedDown?: number;
+    /**
+     * exposure compensation, in EV
+     */
+    compensation?: number;
+    /**
+     * enables or disables automatic exposure
+     */
+    enabled?: boolean;
+}
+
 /**
  * Structure used to set the precision of the color buffer and related quality settings.
  *
@@ -1579,7 +1638,7 @@ export interface View$AmbientOcclusionOptions {
      */
     bias?: number;
     /**
-     * How each dimension of the AO buffer is scaled. Must be either 0.5 or 1.0.
+     * How each dimension of the AO buffer is scaled. Must be either 0.25, 0.5 or 1.0.
      */
     resolution?: number;
     /**
@@ -1749,6 +1808,10 @@ export interface View$ScreenSpaceReflectionsOptions {
      * stride, in texels, for samples along the ray.
      */
     stride?: number;
+    /**
+     * how each dimension of the reflections buffer is scaled, either 0.5 or 1.0.
+     */
+    resolution?: number;
     enabled?: boolean;
 }
 
@@ -87,6 +87,11 @@
 #include <emscripten.h>
 #include <emscripten/bind.h>
 
+#include <algorithm>
+#include <vector>
+
+#include <string.h>
+
 // Avoid warnings for deprecated Filament APIs.
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
@@ -246,6 +251,20 @@ DecodedImage decodeImage(BufferDescriptor encoded_data, int requested_ncomp) {
     return result;
 }
 
+// Sets the same parameter on many material instances with one call from JavaScript, `values`
+// holds one T per instance.
+template<typename T>
+void setParameters(std::vector<MaterialInstance*> const& instances, std::string const& name,
+        BufferDescriptor const& values) {
+    T const* const data = (T const*) values.bd->buffer;
+    size_t const count = std::min(instances.size(), values.bd->size / sizeof(T));
+    for (size_t i = 0; i < count; i++) {
+        T value;
+        memcpy(&value, data + i, sizeof(T));
+        instances[i]->setParameter(name.c_str(), value);
+    }
+}
+
 } // anonymous namespace
 
 EMSCRIPTEN_BINDINGS(jsbindings) {
@@ -669,6 +688,7 @@ class_<View>("View")
     .function("_setBloomOptions", &View::setBloomOptions)
     .function("_setFogOptions", &View::setFogOptions)
     .function("_setVignetteOptions", &View::setVignetteOptions)
+    .function("_setAutoExposureOptions", &View::setAutoExposureOptions)
     .function("_setGuardBandOptions", &View::setGuardBandOptions)
     .function("_setStereoscopicOptions", &View::setStereoscopicOptions)
     .function("setAmbientOcclusion", &View::setAmbientOcclusion)
@@ -1162,6 +1182,25 @@ class_<TransformManager>("TransformManager")
             (TransformManager* self, TransformManager::Instance instance), {
         return flatmat4 { self->getWorldTransform(instance) } ; }), allow_raw_pointers())
 
+    .function("_setTransforms", EMBIND_LAMBDA(void,
+            (TransformManager* self, BufferDescriptor entities, BufferDescriptor matrices), {
+        // entities holds uint32 entity ids, matrices 16 floats per entity (column-major)
+        uint32_t const* const ids = (uint32_t const*) entities.bd->buffer;
+        float const* const values = (float const*) matrices.bd->buffer;
+        size_t const count = std::min(entities.bd->size / sizeof(uint32_t),
+                matrices.bd->size / sizeof(filament::math::mat4f));
+        self->openLocalTransformTransaction();
+        for (size_t i = 0; i < count; i++) {
+            auto const ti = self->getInstance(utils::Entity::import(int32_t(ids[i])));
+            if (ti) {
+                filament::math::mat4f m;
+                memcpy(&m, values + i * 16, sizeof(m));
+                self->setTransform(ti, m);
+            }
+        }
+        self->commitLocalTransformTransaction();
+    }), allow_raw_pointers())
+
     .function("openLocalTransformTransaction", &TransformManager::openLocalTransformTransaction)
     .function("commitLocalTransformTransaction",
             &TransformManager::commitLocalTransformTransaction);
@@ -1368,6 +1407,21 @@ class_<MaterialInstance>("MaterialInstance")
     .function("setMat4Parameter", EMBIND_LAMBDA(void,
             (MaterialInstance* self, std::string name, flatmat4 value), {
         self->setParameter(name.c_str(), value.m); }), allow_raw_pointers())
+    .class_function("_setFloatParameters", EMBIND_LAMBDA(void,
+            (std::vector<MaterialInstance*> instances, std::string name, BufferDescriptor values), {
+        setParameters<float>(instances, name, values); }), allow_raw_pointers())
+    .class_function("_setFloat2Parameters", EMBIND_LAMBDA(void,
+            (std::vector<MaterialInstance*> instances, std::string name, BufferDescriptor values), {
+        setParameters<filament::math::float2>(instances, name, values); }), allow_raw_pointers())
+    .class_function("_setFloat3Parameters", EMBIND_LAMBDA(void,
+            (std::vector<MaterialInstance*> instances, std::string name, BufferDescriptor values), {
+        setParameters<filament::math::float3>(instances, name, values); }), allow_raw_pointers())
+    .class_function("_setFloat4Parameters", EMBIND_LAMBDA(void,
+            (std::vector<MaterialInstance*> instances, std::string name, BufferDescriptor values), {
+        setParameters<filament::math::float4>(instances, name, values); }), allow_raw_pointers())
+    .class_function("_setMat4Parameters", EMBIND_LAMBDA(void,
+            (std::vector<MaterialInstance*> instances, std::string name, BufferDescriptor values), {
+        setParameters<filament::math::mat4f>(instances, name, values); }), allow_raw_pointers())
     .function("setTextureParameter", EMBIND_LAMBDA(void,
             (MaterialInstance* self, std::string name, Texture* value, TextureSampler sampler), {
         self->setParameter(name.c_str(), value, sampler); }), allow_raw_pointers())
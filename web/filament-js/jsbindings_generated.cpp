@@ -29,6 +29,7 @@ value_object<View::BloomOptions>("View$BloomOptions")
     .field("threshold", &View::BloomOptions::threshold)
     .field("enabled", &View::BloomOptions::enabled)
     .field("highlight", &View::BloomOptions::highlight)
+    .field("quarterResolution", &View::BloomOptions::quarterResolution)
     .field("quality", &View::BloomOptions::quality)
     .field("lensFlare", &View::BloomOptions::lensFlare)
     .field("starburst", &View::BloomOptions::starburst)
@@ -78,6 +79,17 @@ value_object<View::VignetteOptions>("View$VignetteOptions")
     .field("enabled", &View::VignetteOptions::enabled)
     ;
 
+value_object<View::AutoExposureOptions>("View$AutoExposureOptions")
+    .field("minLogLuminance", &View::AutoExposureOptions::minLogLuminance)
+    .field("maxLogLuminance", &View::AutoExposureOptions::maxLogLuminance)
+    .field("lowPercentile", &View::AutoExposureOptions::lowPercentile)
+    .field("highPercentile", &View::AutoExposureOptions::highPercentile)
+    .field("speedUp", &View::AutoExposureOptions::speedUp)
+    .field("speedDown", &View::AutoExposureOptions::speedDown)
+    .field("compensation", &View::AutoExposureOptions::compensation)
+    .field("enabled", &View::AutoExposureOptions::enabled)
+    ;
+
 value_object<View::RenderQuality>("View$RenderQuality")
     .field("hdrColorBuffer", &View::RenderQuality::hdrColorBuffer)
     ;
@@ -140,6 +152,7 @@ value_object<View::ScreenSpaceReflectionsOptions>("View$ScreenSpaceReflectionsOp
     .field("bias", &View::ScreenSpaceReflectionsOptions::bias)
     .field("maxDistance", &View::ScreenSpaceReflectionsOptions::maxDistance)
     .field("stride", &View::ScreenSpaceReflectionsOptions::stride)
+    .field("resolution", &View::ScreenSpaceReflectionsOptions::resolution)
     .field("enabled", &View::ScreenSpaceReflectionsOptions::enabled)
     ;
 
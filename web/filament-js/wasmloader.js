@@ -18,6 +18,24 @@ Filament.onReadyListeners = [];
 
 Filament.isReady = false;
 
+// URL of the script that defines this module, used to locate the single-threaded variant.
+Filament.scriptUrl = typeof document !== 'undefined' && document.currentScript ?
+        document.currentScript.src : undefined;
+
+/// isMultithreadingSupported ::function:: Checks if the browser can run filament-mt.js.
+///
+/// The multithreaded variant of the module requires WebAssembly SIMD and SharedArrayBuffer, which
+/// browsers only expose to cross-origin isolated pages, i.e. pages served with the
+/// `Cross-Origin-Opener-Policy: same-origin` and `Cross-Origin-Embedder-Policy: require-corp`
+/// headers.
+Filament.isMultithreadingSupported = () => {
+    // smallest module using a SIMD instruction (i8x16.popcnt)
+    const simd = new Uint8Array([0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0,
+            10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11]);
+    return typeof SharedArrayBuffer !== 'undefined' && self.crossOriginIsolated === true &&
+            typeof WebAssembly === 'object' && WebAssembly.validate(simd);
+};
+
 /// init ::function:: Downloads assets, loads the Filament module, and invokes a callback when done.
 ///
 /// All JavaScript clients must call the init function, passing in a list of asset URL's and a
@@ -28,10 +46,24 @@ Filament.isReady = false;
 /// When the callback is called, each downloaded asset is available in the `Filament.assets` global
 /// object, which contains a mapping from URL's to Uint8Array objects.
 ///
+/// When called from filament-mt.js on a browser that can't run it (see isMultithreadingSupported),
+/// init loads filament.js from the same folder instead, which replaces the Filament global.
+///
 /// assets ::argument:: Array of strings containing URL's of required assets.
 /// onready ::argument:: callback that gets invoked after all assets have been downloaded and the \
 /// Filament WebAssembly module has been loaded.
 Filament.init = (assets, onready) => {
+    if (Filament.variant === 'mt' && Filament.scriptUrl && !Filament.isMultithreadingSupported()) {
+        if (!Filament.fallbackCalls) {
+            const calls = Filament.fallbackCalls = [];
+            const script = document.createElement('script');
+            script.src = Filament.scriptUrl.replace(/filament-mt\.js$/, 'filament.js');
+            script.onload = () => calls.forEach(args => Filament.init(...args));
+            document.head.appendChild(script);
+        }
+        Filament.fallbackCalls.push([assets, onready]);
+        return;
+    }
     if (onready) {
         Filament.onReadyListeners.push(onready);
     }